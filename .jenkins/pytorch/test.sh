@@ -121,6 +121,8 @@ test_libtorch() {
      fi
      python tools/download_mnist.py --quiet -d test/cpp/api/mnist
      OMP_NUM_THREADS=2 "$CPP_BUILD"/caffe2/bin/test_api
+     # a short run, so that the benchmark keeps building and running
+     "$CPP_BUILD"/caffe2/bin/overhead_benchmark --iters 2 --repeat 1
   fi
 }
 
@@ -13,6 +13,7 @@
 #include "ATen/Functions.h"
 #include "ATen/Generator.h"
 #include "ATen/Layout.h"
+#include "ATen/MemoryFormat.h"
 #include "ATen/OptionsGuard.h"
 #include "ATen/Scalar.h"
 #include "ATen/Storage.h"
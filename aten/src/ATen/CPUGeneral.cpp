@@ -1,4 +1,5 @@
 #include <ATen/CPUGeneral.h>
+#include <ATen/core/ThreadPool.h>
 #include <atomic>
 #include <memory>
 #include <thread>
@@ -10,6 +11,10 @@ std::atomic<int> num_threads(-1);
 void set_num_threads(int num_threads_) {
   if (num_threads_ >= 0)
     num_threads.store(num_threads_);
+  // The calling thread participates in native parallel regions, so the
+  // shared pool needs one worker fewer than the requested parallelism.
+  if (num_threads_ > 0)
+    set_intra_op_pool_size(num_threads_ - 1);
 }
 
 int get_num_threads() { return num_threads.load(); }
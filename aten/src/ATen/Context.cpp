@@ -71,6 +71,22 @@ void Context::setBenchmarkCuDNN(bool b) {
   benchmark_cudnn = b;
 }
 
+bool Context::persistentRNNCuDNN() const {
+  return persistent_rnn_cudnn;
+}
+
+void Context::setPersistentRNNCuDNN(bool b) {
+  persistent_rnn_cudnn = b;
+}
+
+bool Context::allowReducedPrecisionCuBLAS() const {
+  return allow_reduced_precision_cublas;
+}
+
+void Context::setAllowReducedPrecisionCuBLAS(bool b) {
+  allow_reduced_precision_cublas = b;
+}
+
 bool Context::hasMKL() const {
 #if AT_MKL_ENABLED()
   return true;
@@ -79,6 +95,14 @@ bool Context::hasMKL() const {
 #endif
 }
 
+bool Context::hasMKLDNN() const {
+#if AT_MKLDNN_ENABLED()
+  return true;
+#else
+  return false;
+#endif
+}
+
 bool Context::setFlushDenormal(bool on) {
 #ifdef USE_SSE3
   // Setting flush-to-zero (FTZ) flag
@@ -50,6 +50,7 @@ public:
     return *generator;
   }
   bool hasMKL() const;
+  bool hasMKLDNN() const;
   bool hasCUDA() const {
     return detail::getCUDAHooks().hasCUDA();
   }
@@ -94,6 +95,15 @@ public:
   void setBenchmarkCuDNN(bool);
   bool deterministicCuDNN() const;
   void setDeterministicCuDNN(bool);
+  // Whether cuDNN RNNs may use persistent kernels for small minibatches; see
+  // Note [Persistent cuDNN RNN kernels] in native/cudnn/RNN.cpp
+  bool persistentRNNCuDNN() const;
+  void setPersistentRNNCuDNN(bool);
+  // Whether cuBLAS may trade precision for tensor core throughput: float GEMMs
+  // may round their inputs (to TF32 from CUDA 11, to fp16 before) and half
+  // GEMMs may accumulate in half. Off by default.
+  bool allowReducedPrecisionCuBLAS() const;
+  void setAllowReducedPrecisionCuBLAS(bool);
   std::unique_ptr<Generator>
     generator_registry[static_cast<int>(DeviceType::COMPILE_TIME_MAX_DEVICE_TYPES)];
 private:
@@ -111,6 +121,8 @@ private:
   bool enabled_cudnn = true;
   bool deterministic_cudnn = false;
   bool benchmark_cudnn = false;
+  bool persistent_rnn_cudnn = false;
+  bool allow_reduced_precision_cublas = false;
   std::atomic<size_t> next_id;
   std::unique_ptr<THCState, void(*)(THCState*)> thc_state;
   friend struct Type;
@@ -157,6 +169,10 @@ static inline bool hasMKL() {
   return globalContext().hasMKL();
 }
 
+static inline bool hasMKLDNN() {
+  return globalContext().hasMKLDNN();
+}
+
 static inline int64_t current_device() {
   return globalContext().current_device();
 }
@@ -1,4 +1,6 @@
 #include "ATen/DLConvertor.h"
+#include "ATen/ExternalMemory.h"
+#include "ATen/detail/CUDAHooksInterface.h"
 
 #include <iostream>
 #include <sstream>
@@ -137,7 +139,10 @@ void deleter(DLManagedTensor * arg) {
 
 // This function returns a shared_ptr to memory managed DLpack tensor constructed
 // out of ATen tensor
-DLManagedTensor* toDLPack(const Tensor& src) {
+DLManagedTensor* toDLPack(const Tensor& src, void* stream) {
+  if (stream && src.type().is_cuda()) {
+    detail::getCUDAHooks().streamWaitStream(src.get_device(), stream, nullptr);
+  }
   ATenDLMTensor * atDLMTensor(new ATenDLMTensor);
   atDLMTensor->handle = src;
   atDLMTensor->tensor.manager_ctx = atDLMTensor;
@@ -157,16 +162,21 @@ DLManagedTensor* toDLPack(const Tensor& src) {
 }
 
 
-Tensor fromDLPack(const DLManagedTensor* src) {
+Tensor fromDLPack(const DLManagedTensor* src, void* stream) {
   Backend backend = getATenBackend(src->dl_tensor.ctx);
   ScalarType stype = toScalarType(src->dl_tensor.dtype);
   auto deleter = [src](void * self) {
     src->deleter(const_cast<DLManagedTensor*>(src));
   };
-  return getType(backend, stype).tensorFromBlob(
+  auto tensor = fromExternalMemory(
+      getType(backend, stype),
       src->dl_tensor.data,
       IntList(src->dl_tensor.shape, src->dl_tensor.ndim),
       IntList(src->dl_tensor.strides, src->dl_tensor.ndim),
       deleter);
+  if (stream && tensor.type().is_cuda()) {
+    detail::getCUDAHooks().streamWaitStream(tensor.get_device(), nullptr, stream);
+  }
+  return tensor;
 }
 } //namespace at
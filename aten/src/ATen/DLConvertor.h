@@ -10,8 +10,19 @@
 
 namespace at {
 
+// The stream arguments make the exchange of CUDA tensors stream aware: they
+// are the raw cudaStream_t the other side of the exchange uses (pass
+// cudaStreamLegacy, i.e. 1, for the legacy default stream). With a null
+// stream, synchronizing is left to the caller.
+//
+// toDLPack: the consumer will use the tensor on stream, which waits for the
+// work queued on the current stream of the tensor's device so far.
+// fromDLPack: the producer queued its work on stream; the current stream of
+// the tensor's device waits for it. The memory is wrapped with
+// fromExternalMemory (see ExternalMemory.h).
+
 AT_API ScalarType toScalarType(const DLDataType& dtype);
-AT_API DLManagedTensor * toDLPack(const Tensor& src);
-AT_API Tensor fromDLPack(const DLManagedTensor* src);
+AT_API DLManagedTensor * toDLPack(const Tensor& src, void* stream = nullptr);
+AT_API Tensor fromDLPack(const DLManagedTensor* src, void* stream = nullptr);
 
 } //namespace at
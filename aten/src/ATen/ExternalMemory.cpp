@@ -0,0 +1,38 @@
+#include "ATen/ExternalMemory.h"
+
+#include "ATen/detail/CUDAHooksInterface.h"
+
+namespace at {
+
+// The number of bytes spanned by a tensor of the given sizes and strides.
+static size_t spannedBytes(const Type& type, IntList sizes, IntList strides) {
+  int64_t span = 1;
+  for (size_t i = 0; i < sizes.size(); i++) {
+    if (sizes[i] == 0) {
+      return 0;
+    }
+    span += (sizes[i] - 1) * strides[i];
+  }
+  return span * type.elementSizeInBytes();
+}
+
+Tensor fromExternalMemory(
+    const Type& type,
+    void* data,
+    IntList sizes,
+    IntList strides,
+    const std::function<void(void*)>& deleter) {
+  if (!type.is_cuda() || data == nullptr) {
+    return type.tensorFromBlob(data, sizes, strides, deleter);
+  }
+  auto unregistering_deleter = [deleter](void* ptr) {
+    detail::getCUDAHooks().unregisterExternalAllocation(ptr);
+    deleter(ptr);
+  };
+  auto tensor = type.tensorFromBlob(data, sizes, strides, unregistering_deleter);
+  detail::getCUDAHooks().registerExternalAllocation(
+      data, spannedBytes(type, sizes, strides), tensor.get_device());
+  return tensor;
+}
+
+} //namespace at
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "ATen/ATen.h"
+
+#include <functional>
+
+// Wrapping memory that something other than ATen allocated (e.g. another
+// framework) into a tensor without copying it.
+
+namespace at {
+
+// Returns a tensor of the given type over data, which deleter frees once the
+// tensor's storage is freed. Like Type::tensorFromBlob, but device memory is
+// registered with the CUDA caching allocator while the storage is alive: it
+// counts towards the allocator's `external` statistic of its device, and
+// recordStream() on it is accepted (the deleter isn't delayed by it, so the
+// owner must not reuse the memory before the work using it is done).
+AT_API Tensor fromExternalMemory(
+    const Type& type,
+    void* data,
+    IntList sizes,
+    IntList strides,
+    const std::function<void(void*)>& deleter);
+
+} //namespace at
@@ -0,0 +1,236 @@
+#include "ATen/HugePageAllocator.h"
+
+#include "TH/THGeneral.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#define AT_HUGE_PAGES_SUPPORTED
+#endif
+
+namespace at {
+
+namespace {
+
+constexpr size_t kDefaultThreshold = kHugePageSize;
+
+HugePageMode modeFromEnv() {
+#ifdef AT_HUGE_PAGES_SUPPORTED
+  const char* env = std::getenv("PYTORCH_CPU_HUGE_PAGES");
+  if (env) {
+    if (std::strcmp(env, "thp") == 0 || std::strcmp(env, "1") == 0) {
+      return HugePageMode::Transparent;
+    }
+    if (std::strcmp(env, "hugetlb") == 0) {
+      return HugePageMode::Explicit;
+    }
+  }
+#endif
+  return HugePageMode::Disabled;
+}
+
+size_t thresholdFromEnv() {
+  const char* env = std::getenv("PYTORCH_CPU_HUGE_PAGE_THRESHOLD");
+  if (env) {
+    char* end;
+    auto threshold = std::strtoull(env, &end, 10);
+    if (*end == '\0') {
+      return threshold;
+    }
+  }
+  return kDefaultThreshold;
+}
+
+std::atomic<HugePageMode>& modeRef() {
+  static std::atomic<HugePageMode> mode(modeFromEnv());
+  return mode;
+}
+
+std::atomic<size_t>& thresholdRef() {
+  static std::atomic<size_t> threshold(thresholdFromEnv());
+  return threshold;
+}
+
+struct HugePageBlock {
+  void* ptr;
+  size_t size;
+};
+
+struct HugePagePool {
+  std::mutex mutex;
+  std::unordered_map<size_t, std::vector<HugePageBlock*>> free_blocks;
+  HugePageStats stats;
+};
+
+HugePagePool& pool() {
+  // leaked, since tensors may be freed while the process exits
+  static HugePagePool* pool = new HugePagePool();
+  return *pool;
+}
+
+// size is a multiple of kHugePageSize
+void* mapBlock(size_t size, HugePageMode mode, bool& fell_back) {
+  fell_back = false;
+#ifdef AT_HUGE_PAGES_SUPPORTED
+#ifdef MAP_HUGETLB
+  if (mode == HugePageMode::Explicit) {
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (ptr != MAP_FAILED) {
+      return ptr;
+    }
+    // the reserved huge pages ran out
+    fell_back = true;
+  }
+#endif
+  // The kernel can only back 2 MB aligned ranges with huge pages, so map a
+  // bit more and trim both ends.
+  const size_t mapped_size = size + kHugePageSize;
+  void* mapped = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapped == MAP_FAILED) {
+    AT_ERROR("$ Torch: not enough memory: you tried to allocate ",
+             size / 1073741824, "GB. Buy new RAM!");
+  }
+  auto begin = reinterpret_cast<uintptr_t>(mapped);
+  auto aligned = (begin + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+  auto end = begin + mapped_size;
+  if (aligned > begin) {
+    munmap(mapped, aligned - begin);
+  }
+  if (end > aligned + size) {
+    munmap(reinterpret_cast<void*>(aligned + size), end - aligned - size);
+  }
+  auto ptr = reinterpret_cast<void*>(aligned);
+#ifdef MADV_HUGEPAGE
+  // fails if transparent huge pages are disabled, which just leaves us with
+  // normal pages
+  madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+  return ptr;
+#else
+  return THAlloc(size);
+#endif
+}
+
+void unmapBlock(HugePageBlock* block) {
+#ifdef AT_HUGE_PAGES_SUPPORTED
+  munmap(block->ptr, block->size);
+#else
+  THFree(block->ptr);
+#endif
+  delete block;
+}
+
+void freeHugePageBlock(void* ctx) {
+  auto* block = static_cast<HugePageBlock*>(ctx);
+  if (!block) {
+    return;
+  }
+  auto& p = pool();
+  std::lock_guard<std::mutex> lock(p.mutex);
+  p.free_blocks[block->size].push_back(block);
+  p.stats.allocated_bytes -= block->size;
+  p.stats.cached_bytes += block->size;
+}
+
+struct HugePageAllocator final : public Allocator {
+  DataPtr allocate(size_t size) const override {
+    if (size == 0) {
+      return {nullptr, nullptr, &freeHugePageBlock, DeviceType::CPU};
+    }
+    const size_t rounded = (size + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+    auto& p = pool();
+    {
+      std::lock_guard<std::mutex> lock(p.mutex);
+      p.stats.allocations++;
+      p.stats.allocated_bytes += rounded;
+      auto it = p.free_blocks.find(rounded);
+      if (it != p.free_blocks.end() && !it->second.empty()) {
+        HugePageBlock* block = it->second.back();
+        it->second.pop_back();
+        p.stats.cached_bytes -= rounded;
+        p.stats.cache_hits++;
+        return {block->ptr, block, &freeHugePageBlock, DeviceType::CPU};
+      }
+    }
+    bool fell_back;
+    void* ptr;
+    try {
+      ptr = mapBlock(rounded, hugePageMode(), fell_back);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(p.mutex);
+      p.stats.allocated_bytes -= rounded;
+      throw;
+    }
+    {
+      std::lock_guard<std::mutex> lock(p.mutex);
+      p.stats.mapped_blocks++;
+      if (fell_back) {
+        p.stats.hugetlb_fallbacks++;
+      }
+    }
+    auto* block = new HugePageBlock{ptr, rounded};
+    return {block->ptr, block, &freeHugePageBlock, DeviceType::CPU};
+  }
+};
+
+HugePageAllocator huge_page_allocator;
+
+} // anonymous namespace
+
+HugePageMode hugePageMode() {
+  return modeRef().load(std::memory_order_relaxed);
+}
+
+void setHugePageMode(HugePageMode mode) {
+#ifdef AT_HUGE_PAGES_SUPPORTED
+  modeRef() = mode;
+#endif
+}
+
+size_t hugePageThreshold() {
+  return thresholdRef().load(std::memory_order_relaxed);
+}
+
+void setHugePageThreshold(size_t bytes) {
+  thresholdRef() = bytes;
+}
+
+bool useHugePages(size_t size) {
+  return hugePageMode() != HugePageMode::Disabled && size >= hugePageThreshold();
+}
+
+Allocator* getHugePageAllocator() {
+  return &huge_page_allocator;
+}
+
+HugePageStats hugePageStats() {
+  auto& p = pool();
+  std::lock_guard<std::mutex> lock(p.mutex);
+  return p.stats;
+}
+
+void hugePageEmptyCache() {
+  std::unordered_map<size_t, std::vector<HugePageBlock*>> free_blocks;
+  {
+    auto& p = pool();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    std::swap(free_blocks, p.free_blocks);
+    p.stats.cached_bytes = 0;
+  }
+  for (auto& entry : free_blocks) {
+    for (auto block : entry.second) {
+      unmapBlock(block);
+    }
+  }
+}
+
+} // namespace at
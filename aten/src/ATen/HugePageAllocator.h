@@ -0,0 +1,59 @@
+#pragma once
+
+#include "ATen/ATenGeneral.h"
+#include "ATen/Allocator.h"
+
+#include <cstddef>
+
+namespace at {
+
+// Backs large CPU buffers with 2 MB huge pages, so that walking over big
+// activations and weights takes far fewer TLB misses.
+//
+// When enabled, the default CPU allocator sends every allocation of at least
+// hugePageThreshold() bytes here. Blocks are rounded up to a multiple of 2 MB
+// and mmap'ed, either as transparent huge pages (madvise(MADV_HUGEPAGE)) or
+// from the explicitly reserved huge page pool (MAP_HUGETLB; falls back to
+// transparent huge pages once the reserve runs out). Freed blocks are cached
+// and reused by later allocations of the same rounded size, so a training
+// loop doesn't mmap and munmap the same buffers every iteration.
+//
+// Disabled by default. Set PYTORCH_CPU_HUGE_PAGES to "thp" or "hugetlb"
+// (and optionally PYTORCH_CPU_HUGE_PAGE_THRESHOLD to a size in bytes) or call
+// setHugePageMode. Only supported on Linux; elsewhere the mode stays Disabled.
+enum class HugePageMode {
+  Disabled,
+  Transparent,
+  Explicit,
+};
+
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+struct HugePageStats {
+  // bytes in blocks that are in use, and in blocks that are cached
+  size_t allocated_bytes = 0;
+  size_t cached_bytes = 0;
+  // allocations served, and how many of them came from the cache
+  size_t allocations = 0;
+  size_t cache_hits = 0;
+  // blocks mmap'ed, and how many of them fell back from MAP_HUGETLB to
+  // transparent huge pages
+  size_t mapped_blocks = 0;
+  size_t hugetlb_fallbacks = 0;
+};
+
+AT_API HugePageMode hugePageMode();
+// Blocks allocated in the previous mode stay valid.
+AT_API void setHugePageMode(HugePageMode mode);
+AT_API size_t hugePageThreshold();
+AT_API void setHugePageThreshold(size_t bytes);
+
+// Whether the default CPU allocator should use huge pages for size bytes.
+AT_API bool useHugePages(size_t size);
+AT_API Allocator* getHugePageAllocator();
+
+AT_API HugePageStats hugePageStats();
+// munmaps the cached blocks
+AT_API void hugePageEmptyCache();
+
+} // namespace at
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <ATen/ArrayRef.h>
+#include <ATen/core/Error.h>
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+// Note [Channels last]
+// ~~~~~~~~~~~~~~~~~~~~
+// A 4-d tensor of sizes (N, C, H, W) is "channels last" if its strides are
+// those of a contiguous (N, H, W, C) tensor permuted to (N, C, H, W), i.e.
+// (H*W*C, 1, W*C, C). The memory format isn't stored in TensorImpl, because
+// the TH functions update sizes and strides directly; it is always computed
+// from the strides.
+//
+// The sizes and strides stay in NCHW order, so channels-last tensors work
+// with every operator. Element-wise operations built on TensorIterator
+// preserve the layout of their inputs. The cuDNN and MKL-DNN convolutions and
+// the cuDNN batch norm run channels-last inputs natively and return
+// channels-last outputs; other kernels make their inputs contiguous.
+//
+// Tensors where a dimension of size 1 makes both layouts coincide (e.g.
+// C == 1) are treated as contiguous.
+
+namespace at {
+enum class MemoryFormat { Contiguous, ChannelsLast };
+
+inline std::vector<int64_t> get_channels_last_strides(IntList sizes) {
+  AT_CHECK(sizes.size() == 4, "channels last is only supported for 4-d tensors, but got sizes ", sizes);
+  std::vector<int64_t> strides(4);
+  strides[1] = 1;
+  strides[3] = sizes[1];
+  strides[2] = strides[3] * sizes[3];
+  strides[0] = strides[2] * sizes[2];
+  return strides;
+}
+
+// Strides of size 1 dimensions are ignored, like in is_contiguous
+inline bool is_channels_last_strides(IntList sizes, IntList strides) {
+  if (sizes.size() != 4) {
+    return false;
+  }
+  int64_t expected = 1;
+  for (auto dim : {1, 3, 2, 0}) {
+    if (sizes[dim] != 1 && strides[dim] != expected) {
+      return false;
+    }
+    expected *= sizes[dim];
+  }
+  return true;
+}
+
+inline bool is_contiguous_strides(IntList sizes, IntList strides) {
+  int64_t expected = 1;
+  for (int64_t dim = (int64_t)sizes.size() - 1; dim >= 0; dim--) {
+    if (sizes[dim] != 1 && strides[dim] != expected) {
+      return false;
+    }
+    expected *= sizes[dim];
+  }
+  return true;
+}
+
+// The memory format kernels should use for a tensor with the given sizes and
+// strides: ChannelsLast for channels-last tensors that aren't also
+// contiguous, and Contiguous otherwise.
+inline MemoryFormat suggest_memory_format(IntList sizes, IntList strides) {
+  if (is_channels_last_strides(sizes, strides) && !is_contiguous_strides(sizes, strides)) {
+    return MemoryFormat::ChannelsLast;
+  }
+  return MemoryFormat::Contiguous;
+}
+
+inline std::ostream& operator<<(std::ostream& stream, at::MemoryFormat memory_format) {
+  switch (memory_format) {
+    case MemoryFormat::Contiguous:
+      return stream << "Contiguous";
+    case MemoryFormat::ChannelsLast:
+      return stream << "ChannelsLast";
+    default:
+      AT_ERROR("Unknown memory format");
+  }
+}
+
+} // namespace at
@@ -0,0 +1,250 @@
+#include "ATen/NUMA.h"
+
+#include "ATen/Config.h"
+#include "TH/THGeneral.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if AT_NUMA_ENABLED()
+#include <numa.h>
+#include <numaif.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+namespace at {
+
+namespace {
+
+// Blocks are cached by their size rounded up to this, or to the page size for
+// blocks of at least a page.
+constexpr size_t kSmallRounding = 64;
+// mbind takes a bit mask of nodes; one word is plenty for today's hosts.
+constexpr int kMaxNUMANodes = 64;
+
+thread_local int current_numa_node = kFirstTouchNUMANode;
+
+size_t pageSize() {
+#if AT_NUMA_ENABLED()
+  static const size_t size = sysconf(_SC_PAGESIZE);
+  return size;
+#else
+  return 4096;
+#endif
+}
+
+size_t roundSize(size_t size) {
+  const size_t rounding = size < pageSize() ? kSmallRounding : pageSize();
+  return (size + rounding - 1) / rounding * rounding;
+}
+
+void checkNode(int node) {
+  AT_CHECK(node == kFirstTouchNUMANode || (node >= 0 && node < numaNodeCount()),
+           "NUMA node ", node, " doesn't exist; this host has ", numaNodeCount(),
+           " node(s)");
+}
+
+void* allocOnNode(size_t size, int node) {
+#if AT_NUMA_ENABLED()
+  if (size >= pageSize() && node != kFirstTouchNUMANode && numaAvailable()) {
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, pageSize(), size) != 0) {
+      AT_ERROR("NUMA allocator: failed to allocate ", size, " bytes on node ", node);
+    }
+    // The block may reuse pages malloc already faulted in somewhere else, so
+    // those are moved. The rest are placed on the node when first touched.
+    unsigned long mask = 1UL << node;
+    if (mbind(ptr, size, MPOL_BIND, &mask, sizeof(mask) * 8, MPOL_MF_MOVE) != 0) {
+      THFree(ptr);
+      AT_ERROR("NUMA allocator: failed to bind ", size, " bytes to node ", node);
+    }
+    return ptr;
+  }
+#endif
+  return THAlloc(size);
+}
+
+struct NUMABlock {
+  void* ptr;
+  size_t size;
+  int node;
+};
+
+void freeNUMABlock(void* ctx);
+
+struct NUMAAllocator final : public Allocator {
+  explicit NUMAAllocator(int node) : node_(node) {}
+
+  DataPtr allocate(size_t size) const override {
+    if (size == 0) {
+      return {nullptr, nullptr, &freeNUMABlock, DeviceType::CPU};
+    }
+    const size_t rounded = roundSize(size);
+    NUMABlock* block = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = free_blocks_.find(rounded);
+      if (it != free_blocks_.end() && !it->second.empty()) {
+        block = it->second.back();
+        it->second.pop_back();
+        cached_bytes_ -= rounded;
+      }
+    }
+    if (!block) {
+      block = new NUMABlock{allocOnNode(rounded, node_), rounded, node_};
+    }
+    return {block->ptr, block, &freeNUMABlock, DeviceType::CPU};
+  }
+
+  void free(NUMABlock* block) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_blocks_[block->size].push_back(block);
+    cached_bytes_ += block->size;
+  }
+
+  void emptyCache() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : free_blocks_) {
+      for (auto block : entry.second) {
+        THFree(block->ptr);
+        delete block;
+      }
+    }
+    free_blocks_.clear();
+    cached_bytes_ = 0;
+  }
+
+  size_t cachedBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cached_bytes_;
+  }
+
+ private:
+  int node_;
+  mutable std::mutex mutex_;
+  mutable std::unordered_map<size_t, std::vector<NUMABlock*>> free_blocks_;
+  mutable size_t cached_bytes_ = 0;
+};
+
+// Indexed by node + 1, so the first-touch allocator comes first. Leaked, since
+// tensors may be freed while the process exits.
+const std::vector<std::unique_ptr<NUMAAllocator>>& numaAllocators() {
+  static auto* allocators = [] {
+    auto* allocators = new std::vector<std::unique_ptr<NUMAAllocator>>();
+    for (int node = kFirstTouchNUMANode; node < numaNodeCount(); node++) {
+      allocators->emplace_back(new NUMAAllocator(node));
+    }
+    return allocators;
+  }();
+  return *allocators;
+}
+
+NUMAAllocator& numaAllocator(int node) {
+  checkNode(node);
+  return *numaAllocators()[node + 1];
+}
+
+void freeNUMABlock(void* ctx) {
+  auto* block = static_cast<NUMABlock*>(ctx);
+  if (block) {
+    numaAllocators()[block->node + 1]->free(block);
+  }
+}
+
+// Called from inside OpenMP parallel regions, so it must not throw.
+bool bindCurrentThread(int node) noexcept {
+#if AT_NUMA_ENABLED()
+  if (!numaAvailable()) {
+    return true;
+  }
+  // numa_run_on_node(-1) lets the thread run anywhere again
+  return numa_run_on_node(node) == 0;
+#else
+  return true;
+#endif
+}
+
+} // anonymous namespace
+
+bool numaAvailable() {
+#if AT_NUMA_ENABLED()
+  static const bool available = numa_available() >= 0;
+  return available;
+#else
+  return false;
+#endif
+}
+
+int numaNodeCount() {
+#if AT_NUMA_ENABLED()
+  if (numaAvailable()) {
+    static const int count = std::min(numa_max_node() + 1, kMaxNUMANodes);
+    return count;
+  }
+#endif
+  return 1;
+}
+
+int numaNodeOfCurrentCPU() {
+#if AT_NUMA_ENABLED()
+  if (numaAvailable()) {
+    return numa_node_of_cpu(sched_getcpu());
+  }
+#endif
+  return kFirstTouchNUMANode;
+}
+
+Allocator* getNUMAAllocator(int node) {
+  return &numaAllocator(node);
+}
+
+void numaEmptyCache(int node) {
+  numaAllocator(node).emptyCache();
+}
+
+size_t numaCachedBytes(int node) {
+  return numaAllocator(node).cachedBytes();
+}
+
+void numaBindCurrentThread(int node) {
+  checkNode(node);
+  AT_CHECK(bindCurrentThread(node), "failed to bind the current thread to NUMA node ", node);
+}
+
+void numaBindIntraOpThreads(int node) {
+  checkNode(node);
+  bool ok = bindCurrentThread(node);
+#ifdef _OPENMP
+  // Each thread that starts parallel regions gets its own team of OpenMP
+  // threads, so this doesn't affect the threads of other replicas.
+  #pragma omp parallel reduction(&&: ok)
+  {
+    ok = bindCurrentThread(node) && ok;
+  }
+#endif
+  AT_CHECK(ok, "failed to bind the intra-op threads to NUMA node ", node);
+}
+
+int currentNUMANode() {
+  return current_numa_node;
+}
+
+NUMANodeGuard::NUMANodeGuard(int node) : prev_node_(current_numa_node) {
+  checkNode(node);
+  current_numa_node = node;
+}
+
+NUMANodeGuard::~NUMANodeGuard() {
+  current_numa_node = prev_node_;
+}
+
+} // namespace at
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "ATen/ATenGeneral.h"
+#include "ATen/Allocator.h"
+
+#include <cstddef>
+
+namespace at {
+
+// NUMA support for the CPU backend, for hosts with more than one socket.
+//
+// Memory from getNUMAAllocator(node) is bound to that node. Freed blocks go
+// back to a pool kept per node and are reused by later allocations of the
+// same (page-rounded) size, so a steady-state workload doesn't pay for mmap
+// and page faults again. Allocations smaller than a page aren't bound, since
+// binding works on whole pages; they end up on the node of the thread that
+// first writes them, which is the right one once the thread is bound too.
+//
+// To run one model replica per socket in a single process, give each replica
+// its own thread and, on it, call numaBindIntraOpThreads(node) and hold a
+// NUMANodeGuard(node) while running the model. Every tensor created on the
+// thread then lives on the node, and the OpenMP threads that run its ops are
+// pinned to the node's cores.
+//
+// Without libnuma, or on a host without NUMA, everything still works but
+// nothing is bound: numaAvailable() is false and numaNodeCount() is 1.
+
+// Lets the kernel place memory on the node of the thread that first touches it.
+constexpr int kFirstTouchNUMANode = -1;
+
+AT_API bool numaAvailable();
+AT_API int numaNodeCount();
+// The node of the CPU the calling thread is running on, or kFirstTouchNUMANode
+// if NUMA isn't available.
+AT_API int numaNodeOfCurrentCPU();
+
+// node is in [0, numaNodeCount()) or kFirstTouchNUMANode. The allocator lives
+// as long as the process.
+AT_API Allocator* getNUMAAllocator(int node);
+// Returns the cached free blocks of node's pool to the system.
+AT_API void numaEmptyCache(int node);
+AT_API size_t numaCachedBytes(int node);
+
+// Restricts the calling thread to the cores of node.
+AT_API void numaBindCurrentThread(int node);
+// Restricts the calling thread and the OpenMP threads that run the parallel
+// regions it starts to the cores of node.
+AT_API void numaBindIntraOpThreads(int node);
+
+// The node CPU tensors created on the calling thread are allocated on, or
+// kFirstTouchNUMANode if none was set with a NUMANodeGuard.
+AT_API int currentNUMANode();
+
+struct AT_API NUMANodeGuard {
+  explicit NUMANodeGuard(int node);
+  ~NUMANodeGuard();
+
+  NUMANodeGuard(const NUMANodeGuard&) = delete;
+  NUMANodeGuard& operator=(const NUMANodeGuard&) = delete;
+
+ private:
+  int prev_node_;
+};
+
+} // namespace at
@@ -0,0 +1,328 @@
+#include <ATen/Parallel.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace at {
+
+namespace {
+
+thread_local bool in_parallel_region_ = false;
+
+ParallelBackend default_parallel_backend() {
+  const char* env = std::getenv("ATEN_PARALLEL_BACKEND");
+  if (env) {
+    if (std::strcmp(env, "native") == 0) {
+      return ParallelBackend::Native;
+    }
+    if (std::strcmp(env, "openmp") == 0) {
+      return ParallelBackend::OpenMP;
+    }
+    AT_WARN("ignoring unknown ATEN_PARALLEL_BACKEND value '", env, "'");
+  }
+#ifdef _OPENMP
+  return ParallelBackend::OpenMP;
+#else
+  return ParallelBackend::Native;
+#endif
+}
+
+std::atomic<ParallelBackend>& parallel_backend() {
+  static std::atomic<ParallelBackend> backend(default_parallel_backend());
+  return backend;
+}
+
+// Upper bound on the number of chunks handed to the pool per worker thread.
+// A few chunks per thread let work stealing even out imbalanced ranges
+// without paying scheduling overhead for tiny chunks.
+constexpr int64_t kChunksPerThread = 4;
+
+int64_t native_chunk_size(int64_t begin, int64_t end, int64_t grain_size) {
+  const int64_t max_threads = get_intra_op_pool_size() + 1;
+  return std::max(
+      std::max<int64_t>(grain_size, 1),
+      divup(end - begin, max_threads * kChunksPerThread));
+}
+
+bool default_parallel_autotune() {
+  const char* env = std::getenv("ATEN_PARALLEL_AUTOTUNE");
+  return env && std::strcmp(env, "0") != 0 && std::strcmp(env, "") != 0;
+}
+
+std::atomic<bool>& parallel_autotune() {
+  static std::atomic<bool> enabled(default_parallel_autotune());
+  return enabled;
+}
+
+// Runs smaller than this, in elements times cost, always use the static
+// grain size: they are too short to time reliably.
+constexpr double kMinTunedWork = 1024;
+// Timed runs per candidate; the first one is a warm-up and is not counted.
+constexpr int kTuningRuns = 4;
+
+// Learns, per kernel and size class, the number of chunks to split a
+// parallel_for into. The candidates are 1 (serial), then either powers of two
+// up to max_chunks or only max_chunks itself; they are tried round-robin
+// until each has kTuningRuns runs.
+class ParallelTuner {
+ public:
+  ParallelTuner() {
+    const char* env = std::getenv("ATEN_PARALLEL_AUTOTUNE_FILE");
+    if (env && *env) {
+      file_ = env;
+      std::ifstream in(file_);
+      if (in) {
+        load(in);
+      }
+    }
+  }
+
+  ~ParallelTuner() {
+    if (!file_.empty()) {
+      std::ofstream out(file_);
+      if (out) {
+        save(out);
+      }
+    }
+  }
+
+  // Returns the number of chunks for the next run and the candidate index to
+  // report its time with, or -1 if the run does not need to be timed.
+  int64_t num_chunks(
+      const std::string& name,
+      int size_class,
+      int64_t max_chunks,
+      bool try_fewer_chunks,
+      int* candidate) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& entry = entries_[Key(name, size_class)];
+    if (entry.chosen > 0) {
+      *candidate = -1;
+      return std::min(entry.chosen, max_chunks);
+    }
+    if (entry.candidates.empty()) {
+      entry.candidates.push_back(1);
+      for (int64_t chunks = 2; try_fewer_chunks && chunks < max_chunks;
+           chunks *= 2) {
+        entry.candidates.push_back(chunks);
+      }
+      entry.candidates.push_back(max_chunks);
+      entry.runs.assign(entry.candidates.size(), 0);
+      entry.total_ns.assign(entry.candidates.size(), 0);
+    }
+    *candidate = entry.next;
+    entry.next = (entry.next + 1) % entry.candidates.size();
+    return entry.candidates[*candidate];
+  }
+
+  void report(
+      const std::string& name,
+      int size_class,
+      int candidate,
+      int64_t elapsed_ns) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& entry = entries_[Key(name, size_class)];
+    if (entry.chosen > 0 || candidate >= (int)entry.candidates.size()) {
+      return;
+    }
+    if (entry.runs[candidate]++ > 0) {
+      entry.total_ns[candidate] += elapsed_ns;
+    }
+    for (auto runs : entry.runs) {
+      if (runs < kTuningRuns) {
+        return;
+      }
+    }
+    size_t best = 0;
+    for (size_t i = 1; i < entry.candidates.size(); i++) {
+      if (entry.total_ns[i] < entry.total_ns[best]) {
+        best = i;
+      }
+    }
+    entry.chosen = entry.candidates[best];
+  }
+
+  void save(std::ostream& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& kv : entries_) {
+      if (kv.second.chosen > 0) {
+        out << kv.first.first << " " << kv.first.second << " "
+            << kv.second.chosen << "\n";
+      }
+    }
+  }
+
+  void load(std::istream& in) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string name;
+    int size_class;
+    int64_t chosen;
+    while (in >> name >> size_class >> chosen) {
+      if (chosen > 0) {
+        entries_[Key(name, size_class)] = Entry();
+        entries_[Key(name, size_class)].chosen = chosen;
+      }
+    }
+  }
+
+  void reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+  }
+
+ private:
+  using Key = std::pair<std::string, int>;
+
+  struct Entry {
+    int64_t chosen = 0;
+    std::vector<int64_t> candidates;
+    std::vector<int> runs;
+    std::vector<int64_t> total_ns;
+    size_t next = 0;
+  };
+
+  std::mutex mutex_;
+  std::map<Key, Entry> entries_;
+  std::string file_;
+};
+
+ParallelTuner& parallel_tuner() {
+  static ParallelTuner tuner;
+  return tuner;
+}
+
+int size_class(int64_t numel) {
+  int result = 0;
+  while (numel >>= 1) {
+    result++;
+  }
+  return result;
+}
+
+} // namespace
+
+void set_parallel_autotune(bool enabled) {
+  parallel_autotune().store(enabled);
+}
+
+bool get_parallel_autotune() {
+  return parallel_autotune().load();
+}
+
+void save_parallel_tuning(const std::string& path) {
+  std::ofstream out(path);
+  AT_CHECK(out, "could not open ", path, " to save parallel tuning");
+  parallel_tuner().save(out);
+}
+
+void load_parallel_tuning(const std::string& path) {
+  std::ifstream in(path);
+  AT_CHECK(in, "could not open ", path, " to load parallel tuning");
+  parallel_tuner().load(in);
+}
+
+void reset_parallel_tuning() {
+  parallel_tuner().reset();
+}
+
+void set_parallel_backend(ParallelBackend backend) {
+#ifndef _OPENMP
+  AT_CHECK(
+      backend != ParallelBackend::OpenMP,
+      "ATen was not compiled with OpenMP support");
+#endif
+  parallel_backend().store(backend);
+}
+
+ParallelBackend get_parallel_backend() {
+  return parallel_backend().load();
+}
+
+bool in_parallel_region() {
+  return in_parallel_region_;
+}
+
+namespace internal {
+
+ParallelRegionGuard::ParallelRegionGuard() : prev_(in_parallel_region_) {
+  in_parallel_region_ = true;
+}
+
+ParallelRegionGuard::~ParallelRegionGuard() {
+  in_parallel_region_ = prev_;
+}
+
+int64_t native_num_chunks(int64_t begin, int64_t end, int64_t grain_size) {
+  if (begin >= end) {
+    return 0;
+  }
+  return divup(end - begin, native_chunk_size(begin, end, grain_size));
+}
+
+int64_t parallel_run_native(
+    int64_t begin,
+    int64_t end,
+    int64_t grain_size,
+    const std::function<void(int64_t, int64_t, int64_t)>& f) {
+  if (begin >= end) {
+    return 0;
+  }
+  const int64_t chunk_size = native_chunk_size(begin, end, grain_size);
+  const int64_t num_chunks = divup(end - begin, chunk_size);
+  auto pool = intra_op_thread_pool();
+  pool->run(num_chunks, [&](size_t id) {
+    ParallelRegionGuard guard;
+    const int64_t chunk_begin = begin + id * chunk_size;
+    const int64_t chunk_end = std::min(end, chunk_begin + chunk_size);
+    if (chunk_begin < chunk_end) {
+      f(id, chunk_begin, chunk_end);
+    }
+  });
+  return num_chunks;
+}
+
+void parallel_for_tuned(
+    int64_t begin,
+    int64_t end,
+    const ParallelCostHint& hint,
+    const std::function<void(int64_t, int64_t)>& f) {
+  const int64_t numel = end - begin;
+  // OpenMP runs every parallel region on all threads, whatever the grain
+  // size, so it can only choose between serial and parallel
+  const bool native = get_parallel_backend() == ParallelBackend::Native;
+  const int64_t max_chunks =
+      native ? get_intra_op_pool_size() + 1 : get_num_threads();
+  if (numel * hint.cost < kMinTunedWork || max_chunks <= 1) {
+    parallel_for(begin, end, grain_size_for_cost(hint.cost), f);
+    return;
+  }
+
+  int candidate;
+  const int size = size_class(numel);
+  const int64_t num_chunks = parallel_tuner().num_chunks(
+      hint.name, size, max_chunks, native, &candidate);
+  // a grain size above numel runs serially
+  const int64_t grain_size =
+      num_chunks <= 1 ? numel + 1 : divup(numel, num_chunks);
+  if (candidate < 0) {
+    parallel_for(begin, end, grain_size, f);
+    return;
+  }
+  const auto start = std::chrono::steady_clock::now();
+  parallel_for(begin, end, grain_size, f);
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  parallel_tuner().report(
+      hint.name,
+      size,
+      candidate,
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+}
+
+} // namespace internal
+} // namespace at
@@ -1,6 +1,10 @@
 #pragma once
 #include <ATen/ATen.h>
+#include <ATen/core/ThreadPool.h>
+#include <algorithm>
 #include <cstddef>
+#include <functional>
+#include <string>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -16,19 +20,130 @@ namespace internal {
 constexpr int64_t GRAIN_SIZE = 32768;
 } // namespace internal
 
+// Cost hint of a parallel kernel, passed to parallel_for instead of a fixed
+// grain size.
+//
+// `cost` is the cost of one element relative to a simple elementwise
+// operation such as add (cost 1), which is what GRAIN_SIZE is tuned for: a
+// kernel of cost 16 (e.g. exp) is parallelised over arrays of 2048 elements
+// already. `name` identifies the kernel to the autotuner; it must live as
+// long as the process, e.g. a string literal.
+struct ParallelCostHint {
+  const char* name;
+  double cost;
+};
+
+// Online autotuning of parallel_for calls made with a ParallelCostHint.
+//
+// The static grain size derived from the cost hint is only a guess: the best
+// threshold depends on the machine, the number of threads and the memory
+// traffic of the kernel. When autotuning is enabled, the first runs of each
+// kernel and size class (a power of two of the number of elements) try
+// running serially and on increasing numbers of chunks, up to one per thread,
+// and the fastest is used from then on.
+//
+// Autotuning is off by default. It is enabled with set_parallel_autotune or
+// the ATEN_PARALLEL_AUTOTUNE=1 environment variable. Tuned values can be
+// saved and loaded with save_parallel_tuning and load_parallel_tuning; if
+// ATEN_PARALLEL_AUTOTUNE_FILE is set, they are loaded from that file on
+// first use and saved back to it at exit.
+AT_API void set_parallel_autotune(bool enabled);
+AT_API bool get_parallel_autotune();
+AT_API void save_parallel_tuning(const std::string& path);
+AT_API void load_parallel_tuning(const std::string& path);
+// Forgets all tuned values, e.g. after changing the number of threads or the
+// parallel backend.
+AT_API void reset_parallel_tuning();
+
+// The implementation used by parallel_for and parallel_reduce.
+//
+// OpenMP forks a team of threads for every parallel region, which is cheap
+// when a single thread drives ATen but oversubscribes the machine when many
+// request threads call into ATen concurrently. The Native backend instead
+// submits chunks of at most grain_size elements to the process-wide
+// work-stealing at::ThreadPool, which is shared with Caffe2.
+//
+// The default is OpenMP when ATen is built with it and Native otherwise; it
+// can be overridden with set_parallel_backend or the ATEN_PARALLEL_BACKEND
+// environment variable ("openmp" or "native").
+enum class ParallelBackend { OpenMP, Native };
+
+AT_API void set_parallel_backend(ParallelBackend backend);
+AT_API ParallelBackend get_parallel_backend();
+
+// Returns true if the calling thread is currently executing the body of a
+// parallel_for or parallel_reduce. Nested parallel constructs run serially
+// on the calling thread instead of forking more work.
+AT_API bool in_parallel_region();
+
 inline int64_t divup(int64_t x, int64_t y) {
   return (x + y - 1) / y;
 }
 
+namespace internal {
+
+// RAII guard marking the current thread as inside a parallel region.
+struct AT_API ParallelRegionGuard {
+  ParallelRegionGuard();
+  ~ParallelRegionGuard();
+
+ private:
+  bool prev_;
+};
+
+// Splits [begin, end) into chunks of at least grain_size elements and runs
+// them on the native thread pool. f is called as f(chunk_index, chunk_begin,
+// chunk_end); returns the number of chunks used.
+AT_API int64_t parallel_run_native(
+    int64_t begin,
+    int64_t end,
+    int64_t grain_size,
+    const std::function<void(int64_t, int64_t, int64_t)>& f);
+
+// Number of chunks parallel_run_native will split [begin, end) into.
+AT_API int64_t native_num_chunks(int64_t begin, int64_t end, int64_t grain_size);
+
+// Static grain size for a kernel of the given relative cost per element.
+inline int64_t grain_size_for_cost(double cost) {
+  if (cost <= 0) {
+    return GRAIN_SIZE;
+  }
+  return std::max<int64_t>(1, static_cast<int64_t>(GRAIN_SIZE / cost));
+}
+
+// parallel_for with autotuning, see set_parallel_autotune.
+AT_API void parallel_for_tuned(
+    int64_t begin,
+    int64_t end,
+    const ParallelCostHint& hint,
+    const std::function<void(int64_t, int64_t)>& f);
+
+} // namespace internal
+
 template <class F>
 inline void parallel_for(
     const int64_t begin,
     const int64_t end,
     const int64_t grain_size,
     const F& f) {
+  if (begin >= end) {
+    return;
+  }
+  if ((end - begin) < grain_size || in_parallel_region()) {
+    f(begin, end);
+    return;
+  }
+  if (get_parallel_backend() == ParallelBackend::Native) {
+    internal::parallel_run_native(
+        begin, end, grain_size, [&f](int64_t, int64_t b, int64_t e) {
+          f(b, e);
+        });
+    return;
+  }
 #ifdef _OPENMP
-#pragma omp parallel if ((end - begin) >= grain_size)
+#pragma omp parallel
   {
+    internal::ParallelRegionGuard guard;
     int64_t num_threads = omp_get_num_threads();
     int64_t tid = omp_get_thread_num();
     int64_t chunk_size = divup((end - begin), num_threads);
@@ -37,12 +152,23 @@ inline void parallel_for(
       f(begin_tid, std::min(end, chunk_size + begin_tid));
   }
 #else
-  if (begin < end) {
-    f(begin, end);
-  }
+  f(begin, end);
 #endif
 }
 
+template <class F>
+inline void parallel_for(
+    const int64_t begin,
+    const int64_t end,
+    const ParallelCostHint& hint,
+    const F& f) {
+  if (get_parallel_autotune() && !in_parallel_region()) {
+    internal::parallel_for_tuned(begin, end, hint, f);
+    return;
+  }
+  parallel_for(begin, end, internal::grain_size_for_cost(hint.cost), f);
+}
+
 template <class scalar_t, class F, class SF>
 inline scalar_t parallel_reduce(
     const int64_t begin,
@@ -51,14 +177,30 @@ inline scalar_t parallel_reduce(
     const scalar_t ident,
     const F f,
     const SF sf) {
-  if (get_num_threads() == 1) {
+  if (get_num_threads() == 1 || (end - begin) < grain_size ||
+      in_parallel_region()) {
     return f(begin, end, ident);
+  } else if (get_parallel_backend() == ParallelBackend::Native) {
+    const int64_t num_results =
+        internal::native_num_chunks(begin, end, grain_size);
+    std::vector<scalar_t> results(num_results, ident);
+    scalar_t* results_data = results.data();
+    internal::parallel_run_native(
+        begin,
+        end,
+        grain_size,
+        [&f, results_data, ident](int64_t id, int64_t b, int64_t e) {
+          results_data[id] = f(b, e, ident);
+        });
+    return std::accumulate(
+        results_data, results_data + results.size(), ident, sf);
   } else {
     const int64_t num_results = divup((end - begin), grain_size);
     std::vector<scalar_t> results(num_results);
     scalar_t* results_data = results.data();
-#pragma omp parallel for if ((end - begin) >= grain_size)
+#pragma omp parallel for
     for (int64_t id = 0; id < num_results; id++) {
+      internal::ParallelRegionGuard guard;
       int64_t i = begin + id * grain_size;
       results_data[id] = f(i, i + std::min(end - i, grain_size), ident);
     }
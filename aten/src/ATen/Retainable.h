@@ -12,6 +12,13 @@ struct Retainable {
     ++refcount;
   }
   void release() {
+    // The sole owner of an object with no weak references can skip the
+    // atomic decrements: nobody else can observe or revive it.
+    if (refcount.load(std::memory_order_acquire) == 1 &&
+        weak_refcount.load(std::memory_order_acquire) == 1) {
+      delete this;
+      return;
+    }
     if(--refcount == 0) {
       // If we know that this is the last reference then we can skip
       // all the decrements and release_resources().
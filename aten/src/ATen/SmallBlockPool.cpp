@@ -0,0 +1,188 @@
+#include "ATen/SmallBlockPool.h"
+
+#include "TH/THGeneral.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+namespace at {
+
+namespace {
+
+// Keeps the blocks as aligned as malloc would.
+constexpr size_t kHeaderSize = 16;
+// Size classes are 16, 32, ..., kSmallBlockMaxSize bytes.
+constexpr uint32_t kNumSizeClasses = 6;
+// Marks blocks that came from THAlloc.
+constexpr uint32_t kLargeBlock = kNumSizeClasses;
+// Fresh blocks are carved off chunks of this size.
+constexpr size_t kChunkSize = 64 * 1024;
+// A thread gives half of its free blocks of a size class to the shared pool
+// when it has more than this many.
+constexpr size_t kMaxCachedBlocks = 1024;
+// How many blocks a thread takes from the shared pool at once.
+constexpr size_t kRefillBlocks = 64;
+
+static_assert((size_t(16) << (kNumSizeClasses - 1)) == kSmallBlockMaxSize,
+  "size classes don't end at kSmallBlockMaxSize");
+
+struct BlockHeader {
+  uint32_t size_class;
+};
+static_assert(sizeof(BlockHeader) <= kHeaderSize, "BlockHeader doesn't fit");
+
+// free blocks are linked through their data
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+struct FreeList {
+  FreeBlock* head = nullptr;
+  size_t length = 0;
+
+  void push(FreeBlock* block) {
+    block->next = head;
+    head = block;
+    length++;
+  }
+  FreeBlock* pop() {
+    FreeBlock* block = head;
+    head = block->next;
+    length--;
+    return block;
+  }
+  // moves up to n blocks from the front of this list to the front of other
+  void moveTo(FreeList& other, size_t n) {
+    while (n-- > 0 && head) {
+      other.push(pop());
+    }
+  }
+};
+
+inline size_t classSize(uint32_t size_class) {
+  return size_t(16) << size_class;
+}
+
+inline uint32_t sizeClass(size_t size) {
+  uint32_t size_class = 0;
+  while (classSize(size_class) < size) {
+    size_class++;
+  }
+  return size_class;
+}
+
+inline BlockHeader* headerOf(void* ptr) {
+  return reinterpret_cast<BlockHeader*>(static_cast<char*>(ptr) - kHeaderSize);
+}
+
+bool poolEnabled() {
+  static const bool enabled = [] {
+    const char* env = std::getenv("PYTORCH_CPU_SMALL_BLOCK_POOL");
+    return !(env && std::strcmp(env, "0") == 0);
+  }();
+  return enabled;
+}
+
+struct SharedPool {
+  std::mutex mutex;
+  FreeList lists[kNumSizeClasses];
+};
+
+SharedPool& sharedPool() {
+  // leaked, since threads give their blocks back while the process exits
+  static SharedPool* pool = new SharedPool();
+  return *pool;
+}
+
+// set once the calling thread's ThreadCache is destroyed; trivially
+// destructible, so it can still be read afterwards
+thread_local bool thread_cache_destroyed = false;
+
+struct ThreadCache {
+  FreeList lists[kNumSizeClasses];
+  char* chunk_pos = nullptr;
+  char* chunk_end = nullptr;
+
+  ~ThreadCache() {
+    auto& pool = sharedPool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    for (uint32_t c = 0; c < kNumSizeClasses; c++) {
+      lists[c].moveTo(pool.lists[c], lists[c].length);
+    }
+    // the rest of the current chunk is lost
+    thread_cache_destroyed = true;
+  }
+
+  void* alloc(uint32_t size_class) {
+    auto& list = lists[size_class];
+    if (!list.head) {
+      auto& pool = sharedPool();
+      std::lock_guard<std::mutex> lock(pool.mutex);
+      pool.lists[size_class].moveTo(list, kRefillBlocks);
+    }
+    if (list.head) {
+      return list.pop();
+    }
+    const size_t block_size = kHeaderSize + classSize(size_class);
+    if (static_cast<size_t>(chunk_end - chunk_pos) < block_size) {
+      chunk_pos = static_cast<char*>(THAlloc(kChunkSize));
+      chunk_end = chunk_pos + kChunkSize;
+    }
+    char* block = chunk_pos + kHeaderSize;
+    chunk_pos += block_size;
+    headerOf(block)->size_class = size_class;
+    return block;
+  }
+
+  void free(void* ptr, uint32_t size_class) {
+    auto& list = lists[size_class];
+    list.push(static_cast<FreeBlock*>(ptr));
+    if (list.length > kMaxCachedBlocks) {
+      auto& pool = sharedPool();
+      std::lock_guard<std::mutex> lock(pool.mutex);
+      list.moveTo(pool.lists[size_class], kMaxCachedBlocks / 2);
+    }
+  }
+};
+
+ThreadCache& threadCache() {
+  thread_local ThreadCache cache;
+  return cache;
+}
+
+void* largeAlloc(size_t size) {
+  char* block = static_cast<char*>(THAlloc(size + kHeaderSize)) + kHeaderSize;
+  headerOf(block)->size_class = kLargeBlock;
+  return block;
+}
+
+} // anonymous namespace
+
+void* smallBlockAlloc(size_t size) {
+  if (size > kSmallBlockMaxSize || !poolEnabled() || thread_cache_destroyed) {
+    return largeAlloc(size);
+  }
+  return threadCache().alloc(sizeClass(size));
+}
+
+void smallBlockFree(void* ptr) {
+  if (!ptr) {
+    return;
+  }
+  const uint32_t size_class = headerOf(ptr)->size_class;
+  if (size_class == kLargeBlock) {
+    THFree(headerOf(ptr));
+    return;
+  }
+  if (thread_cache_destroyed) {
+    auto& pool = sharedPool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    pool.lists[size_class].push(static_cast<FreeBlock*>(ptr));
+    return;
+  }
+  threadCache().free(ptr, size_class);
+}
+
+} // namespace at
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "ATen/ATenGeneral.h"
+
+#include <cstddef>
+
+namespace at {
+
+// A thread-caching allocator for the many small CPU allocations made when
+// working with scalar-sized tensors: their data buffers (through the default
+// CPU allocator) and their TensorImpl and StorageImpl objects.
+//
+// Blocks of up to kSmallBlockMaxSize bytes are rounded up to a power of two
+// and handed out from per-thread free lists, or carved off a per-thread chunk
+// by bumping a pointer when the list is empty, so allocating and freeing them
+// doesn't lock or call malloc. A thread that caches too many free blocks of a
+// size, or exits, gives them to a shared pool other threads refill from.
+// Memory in the pool is never returned to the system.
+//
+// Larger blocks come from THAlloc. Every block starts 16 bytes after a small
+// header, so it is 16-byte aligned, and can be freed by any thread.
+//
+// Setting PYTORCH_CPU_SMALL_BLOCK_POOL=0 makes every allocation go to THAlloc,
+// e.g. to track down memory errors with tools that intercept malloc.
+constexpr size_t kSmallBlockMaxSize = 512;
+
+AT_API void* smallBlockAlloc(size_t size);
+AT_API void smallBlockFree(void* ptr);
+
+} // namespace at
@@ -95,6 +95,7 @@ void SparseTensorImpl::set_indices_and_values(const Tensor& indices, const Tenso
   // more explicit this way.)
   nnz_ = empty ? 0 : values.size(0);
   coalesced_ = false;
+  clear_csr_cache();
 }
 
 
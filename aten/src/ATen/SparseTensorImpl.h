@@ -46,6 +46,22 @@ struct AT_API SparseTensorImpl : public TensorImpl {
   // because many algorithms proceed by merging two sorted lists (of indices).
   bool coalesced_ = false;
 
+  // The CSR form of the indices of a coalesced sparse matrix, which sparse x
+  // dense matrix multiplication needs and which is expensive to recompute on
+  // every call (see _crow_indices()). crow_indices_ are the int64 row
+  // pointers; crow_indices_int_ and col_indices_int_ are the int32 row
+  // pointers and column indices that cuSPARSE takes. They are computed on
+  // demand and dropped whenever the indices may change.
+  Tensor crow_indices_;
+  Tensor crow_indices_int_;
+  Tensor col_indices_int_;
+
+  void clear_csr_cache() {
+    crow_indices_ = Tensor();
+    crow_indices_int_ = Tensor();
+    col_indices_int_ = Tensor();
+  }
+
 public:
   // Public for now...
   explicit SparseTensorImpl(at::TensorTypeId, at::ScalarType);
@@ -83,6 +99,7 @@ public:
     }
     sparseDims_ = sparseDims;
     denseDims_ = denseDims;
+    clear_csr_cache();
   }
 
   // TODO: I hate these two setters, please get rid of them!!!
@@ -90,14 +107,32 @@ public:
     AT_ASSERT(indices.type().backend() == at::toDense(type().backend()));
     AT_ASSERT(indices.type().scalarType() == kLong);
     indices_ = indices;
+    clear_csr_cache();
   }
   void set_values(const Tensor& values) {
     AT_ASSERT(values.type().toSparse() == type());
     values_ = values;
   }
 
-  void set_coalesced(bool coalesced) { coalesced_ = coalesced; }
-  void set_nnz(int64_t nnz) { nnz_ = nnz; }
+  // Ops that write to the indices in place set these afterwards, so they
+  // also drop the CSR cache.
+  void set_coalesced(bool coalesced) {
+    coalesced_ = coalesced;
+    clear_csr_cache();
+  }
+  void set_nnz(int64_t nnz) {
+    nnz_ = nnz;
+    clear_csr_cache();
+  }
+
+  const Tensor& crow_indices() const { return crow_indices_; }
+  void set_crow_indices(const Tensor& crow_indices) { crow_indices_ = crow_indices; }
+  const Tensor& crow_indices_int() const { return crow_indices_int_; }
+  const Tensor& col_indices_int() const { return col_indices_int_; }
+  void set_csr_int(const Tensor& crow_indices_int, const Tensor& col_indices_int) {
+    crow_indices_int_ = crow_indices_int;
+    col_indices_int_ = col_indices_int;
+  }
 
   // This used to be called THSTensor_(_move)
   // NB: This used to be able to avoid a refcount bump, but I was too lazy to
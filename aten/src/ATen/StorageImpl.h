@@ -4,6 +4,7 @@
 #include <ATen/ScalarType.h>
 #include <ATen/ScalarTypeUtils.h>
 #include <ATen/Retainable.h>
+#include <ATen/SmallBlockPool.h>
 #include <TH/THTypeConversion.hpp>
 #include <atomic>
 
@@ -41,6 +42,14 @@ struct AT_API StorageImpl : public Retainable {
  public:
   StorageImpl() = delete;
   virtual ~StorageImpl() {};
+
+  // see the comment on TensorImpl::operator new
+  static void* operator new(size_t size) {
+    return smallBlockAlloc(size);
+  }
+  static void operator delete(void* ptr) {
+    smallBlockFree(ptr);
+  }
   StorageImpl(
       at::ScalarType scalar_type,
       ptrdiff_t size,
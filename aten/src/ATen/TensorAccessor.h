@@ -3,47 +3,131 @@
 #include <cstddef>
 #include <stdint.h>
 
-namespace at {
+#ifndef AT_HOSTDEVICE
+#ifdef __CUDACC__
+#define AT_HOSTDEVICE __host__ __device__
+#else
+#define AT_HOSTDEVICE
+#endif
+#endif
 
+namespace at {
 
-template<typename T, size_t N>
+// TensorAccessorBase and TensorAccessor index N-dimensional data through
+// pointers to sizes and strides held elsewhere: by the tensor for
+// Tensor::accessor, or by the enclosing PackedTensorAccessor when indexing
+// one. index_t is the type of the sizes, strides and offsets; see
+// PackedTensorAccessor for when it is int32_t.
+template<typename T, size_t N, typename index_t = int64_t>
 class TensorAccessorBase {
 public:
-  TensorAccessorBase(T * data_, const int64_t * sizes_, const int64_t * strides_)
+  AT_HOSTDEVICE TensorAccessorBase(T * data_, const index_t * sizes_, const index_t * strides_)
   : data_(data_), sizes_(sizes_), strides_(strides_) {}
-  IntList sizes() {
+  IntList sizes() const {
     return IntList(sizes_,N);
   }
-  IntList strides() {
+  IntList strides() const {
     return IntList(strides_,N);
   }
-  int64_t stride(int64_t i) { return strides()[i]; }
-  int64_t size(int64_t i) { return sizes()[i]; }
+  AT_HOSTDEVICE index_t stride(index_t i) const { return strides_[i]; }
+  AT_HOSTDEVICE index_t size(index_t i) const { return sizes_[i]; }
+  AT_HOSTDEVICE T * data() { return data_; }
+  AT_HOSTDEVICE const T * data() const { return data_; }
 protected:
   T * data_;
-  const int64_t* sizes_;
-  const int64_t* strides_;
+  const index_t* sizes_;
+  const index_t* strides_;
 };
 
-template<typename T, size_t N>
-class TensorAccessor : public TensorAccessorBase<T,N> {
+template<typename T, size_t N, typename index_t = int64_t>
+class TensorAccessor : public TensorAccessorBase<T,N,index_t> {
 public:
-  TensorAccessor(T * data_, const int64_t * sizes_, const int64_t * strides_)
-  : TensorAccessorBase<T,N>(data_,sizes_,strides_) {}
+  AT_HOSTDEVICE TensorAccessor(T * data_, const index_t * sizes_, const index_t * strides_)
+  : TensorAccessorBase<T,N,index_t>(data_,sizes_,strides_) {}
 
-  TensorAccessor<T,N-1> operator[](int64_t i) {
-    return TensorAccessor<T,N-1>(this->data_ + this->strides_[0]*i,this->sizes_+1,this->strides_+1);
+  AT_HOSTDEVICE TensorAccessor<T,N-1,index_t> operator[](index_t i) {
+    return TensorAccessor<T,N-1,index_t>(this->data_ + this->strides_[0]*i,this->sizes_+1,this->strides_+1);
+  }
+  AT_HOSTDEVICE const TensorAccessor<T,N-1,index_t> operator[](index_t i) const {
+    return TensorAccessor<T,N-1,index_t>(this->data_ + this->strides_[0]*i,this->sizes_+1,this->strides_+1);
   }
 };
 
-template<typename T>
-class TensorAccessor<T,1> : public TensorAccessorBase<T,1> {
+template<typename T, typename index_t>
+class TensorAccessor<T,1,index_t> : public TensorAccessorBase<T,1,index_t> {
 public:
-  TensorAccessor(T * data_, const int64_t * sizes_, const   int64_t * strides_)
-  : TensorAccessorBase<T,1>(data_,sizes_,strides_) {}
-  T & operator[](int64_t i) {
+  AT_HOSTDEVICE TensorAccessor(T * data_, const index_t * sizes_, const index_t * strides_)
+  : TensorAccessorBase<T,1,index_t>(data_,sizes_,strides_) {}
+  AT_HOSTDEVICE T & operator[](index_t i) {
     return this->data_[this->strides_[0]*i];
   }
+  AT_HOSTDEVICE const T & operator[](index_t i) const {
+    return this->data_[this->strides_[0]*i];
+  }
+};
+
+// PackedTensorAccessor holds copies of the sizes and strides instead of
+// pointers to the tensor's, so it can be passed by value to a CUDA kernel
+// (TensorAccessor's pointers would point to host memory). Indexing it gives
+// TensorAccessors pointing into its own sizes and strides, so they must not
+// outlive it.
+//
+// With index_t = int32_t all the address arithmetic is 32-bit, which is
+// noticeably cheaper on GPUs. It is only correct when every offset into the
+// tensor fits in an int32_t: check cuda::detail::canUse32BitIndexMath, or let
+// AT_DISPATCH_INDEX_TYPES (ATen/cuda/detail/IndexUtils.cuh) do it.
+template<typename T, size_t N, typename index_t = int64_t>
+class PackedTensorAccessor {
+public:
+  template<typename source_index_t>
+  PackedTensorAccessor(T * data_, const source_index_t * sizes_, const source_index_t * strides_)
+  : data_(data_) {
+    for (size_t i = 0; i < N; i++) {
+      this->sizes_[i] = static_cast<index_t>(sizes_[i]);
+      this->strides_[i] = static_cast<index_t>(strides_[i]);
+    }
+  }
+  AT_HOSTDEVICE index_t stride(index_t i) const { return strides_[i]; }
+  AT_HOSTDEVICE index_t size(index_t i) const { return sizes_[i]; }
+  AT_HOSTDEVICE T * data() { return data_; }
+  AT_HOSTDEVICE const T * data() const { return data_; }
+
+  AT_HOSTDEVICE TensorAccessor<T,N-1,index_t> operator[](index_t i) {
+    return TensorAccessor<T,N-1,index_t>(data_ + strides_[0]*i, sizes_+1, strides_+1);
+  }
+  AT_HOSTDEVICE const TensorAccessor<T,N-1,index_t> operator[](index_t i) const {
+    return TensorAccessor<T,N-1,index_t>(data_ + strides_[0]*i, sizes_+1, strides_+1);
+  }
+protected:
+  T * data_;
+  index_t sizes_[N];
+  index_t strides_[N];
+};
+
+template<typename T, typename index_t>
+class PackedTensorAccessor<T,1,index_t> {
+public:
+  template<typename source_index_t>
+  PackedTensorAccessor(T * data_, const source_index_t * sizes_, const source_index_t * strides_)
+  : data_(data_) {
+    this->sizes_[0] = static_cast<index_t>(sizes_[0]);
+    this->strides_[0] = static_cast<index_t>(strides_[0]);
+  }
+  AT_HOSTDEVICE index_t stride(index_t i) const { return strides_[i]; }
+  AT_HOSTDEVICE index_t size(index_t i) const { return sizes_[i]; }
+  AT_HOSTDEVICE T * data() { return data_; }
+  AT_HOSTDEVICE const T * data() const { return data_; }
+
+  AT_HOSTDEVICE T & operator[](index_t i) {
+    return data_[strides_[0]*i];
+  }
+  AT_HOSTDEVICE const T & operator[](index_t i) const {
+    return data_[strides_[0]*i];
+  }
+protected:
+  T * data_;
+  index_t sizes_[1];
+  index_t strides_[1];
 };
 
 }
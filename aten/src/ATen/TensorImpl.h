@@ -3,6 +3,8 @@
 #include <atomic>
 #include <memory>
 
+#include "ATen/DimVector.h"
+#include "ATen/SmallBlockPool.h"
 #include "ATen/StorageImpl.h"
 #include "ATen/core/optional.h"
 #include "ATen/core/TensorTypeId.h"
@@ -24,6 +26,16 @@ struct AT_API TensorImpl : public Retainable {
 
   virtual ~TensorImpl();
 
+  // Tensors are created and destroyed at a high rate, so their impls (and
+  // those of subclasses, as long as they are small) come from the per-thread
+  // free lists of the small block pool.
+  static void* operator new(size_t size) {
+    return smallBlockAlloc(size);
+  }
+  static void operator delete(void* ptr) {
+    smallBlockFree(ptr);
+  }
+
   virtual void release_resources() override;
 
   // The implementation of this method will have to be hoisted out and
@@ -98,8 +110,10 @@ struct AT_API TensorImpl : public Retainable {
   at::StorageImpl* storage_;
   int64_t storage_offset_;
 
-  std::vector<int64_t> sizes_;
-  std::vector<int64_t> strides_;
+  // Stored inline for up to 5 dimensions, so that creating a view doesn't
+  // allocate for its metadata.
+  DimVector sizes_;
+  DimVector strides_;
 
   template <typename T>
   inline T * data() const {
@@ -65,6 +65,7 @@ FUNCTION = CodeTemplate("""\
 Tensor & ${Type}::s_copy_(Tensor & dst, const Tensor & src, bool non_blocking) const {
   // code generated by copy_wrapper
   ${checked_cast_dst}
+  ${native_copy}
   switch (src.type().ID()) {
     ${copy_body}
     default:
@@ -75,6 +76,15 @@ Tensor & ${Type}::s_copy_(Tensor & dst, const Tensor & src, bool non_blocking) c
 }
 """)
 
+# Dense CPU to CPU copies first try the native kernel (see native/Copy.h),
+# which only leaves some of them to the TH copies below.
+NATIVE_COPY_CPU = """\
+if (src.type().backend() == Backend::CPU && native::_copy_cpu_(dst, src)) {
+    dst.pImpl->maybe_zero_dim(src.pImpl->dim() == 0);
+    return dst;
+}
+"""
+
 FUNCTION_FALLTHROUGH_REDISPATCH = "return src.type()._s_copy_from(src, dst, non_blocking);"
 
 FUNCTION_FALLTHROUGH_ERROR = """\
@@ -147,8 +157,10 @@ def create_one_copy(dst_type, all_types):
         # (Backend == CPU implies Dense)
         assert dst_type['Density'] == 'Dense'
         function_fallthrough = FUNCTION_FALLTHROUGH_REDISPATCH
+        native_copy = NATIVE_COPY_CPU
     else:
         function_fallthrough = FUNCTION_FALLTHROUGH_ERROR
+        native_copy = ''
 
     # Note [checked_cast_tensor is for dense only]
     # ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -167,6 +179,7 @@ def create_one_copy(dst_type, all_types):
     env = nested_dict({
         'function_fallthrough': function_fallthrough,
         'checked_cast_dst': checked_cast_dst,
+        'native_copy': native_copy,
     }, dst_type)
     return FUNCTION.substitute(env, copy_body=copy_body)
 
@@ -239,6 +252,9 @@ def create(all_types, backend):
             '#include "ATen/{}.h"'.format(the_type['Type']))
     top_env['copy_includes'].append(
         '#include "ATen/TensorImpl.h"')
+    if backend == 'CPU':
+        top_env['copy_includes'].append(
+            '#include "ATen/native/Copy.h"')
 
     # Code generation
     for the_type in all_types:
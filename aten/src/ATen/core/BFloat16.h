@@ -0,0 +1,113 @@
+#pragma once
+
+/// Defines the BFloat16 type (brain floating-point): the upper 16 bits of an
+/// IEEE float32, i.e. the same 8-bit exponent with a 7-bit mantissa. Like
+/// Half, arithmetic converts to float32 and back. Conversions from float
+/// round to nearest even; NaNs stay (quiet) NaNs.
+///
+/// NB: BFloat16 is a storage and compute type for CPU kernels (see
+/// cpu/vec256/vec256_half.h); it is not a ScalarType of ATen tensors.
+
+#include <ATen/core/Macros.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iosfwd>
+#include <ostream>
+
+#ifndef AT_HOSTDEVICE
+#ifdef __CUDACC__
+#define AT_HOSTDEVICE __host__ __device__
+#else
+#define AT_HOSTDEVICE
+#endif
+#endif
+
+namespace at {
+
+namespace detail {
+
+inline AT_HOSTDEVICE float bfloat16bits2float(uint16_t bits) {
+  uint32_t value = static_cast<uint32_t>(bits) << 16;
+  float result;
+  std::memcpy(&result, &value, sizeof(result));
+  return result;
+}
+
+inline AT_HOSTDEVICE uint16_t float2bfloat16bits(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  if ((bits & 0x7fffffffu) > 0x7f800000u) {
+    // NaN: keep the sign and make sure the truncated mantissa stays non-zero
+    return static_cast<uint16_t>((bits >> 16) | 0x0040u);
+  }
+  // round to nearest even
+  uint32_t rounding_bias = 0x7fffu + ((bits >> 16) & 1);
+  return static_cast<uint16_t>((bits + rounding_bias) >> 16);
+}
+
+} // namespace detail
+
+struct alignas(2) BFloat16 {
+  uint16_t x;
+
+  struct from_bits_t {};
+  static constexpr from_bits_t from_bits = from_bits_t();
+
+  BFloat16() = default;
+  constexpr AT_HOSTDEVICE BFloat16(uint16_t bits, from_bits_t) : x(bits){};
+  inline AT_HOSTDEVICE BFloat16(float value) : x(detail::float2bfloat16bits(value)) {}
+  inline AT_HOSTDEVICE operator float() const {
+    return detail::bfloat16bits2float(x);
+  }
+};
+
+/// Arithmetic
+
+inline AT_HOSTDEVICE BFloat16 operator+(const BFloat16& a, const BFloat16& b) {
+  return (float)a + (float)b;
+}
+
+inline AT_HOSTDEVICE BFloat16 operator-(const BFloat16& a, const BFloat16& b) {
+  return (float)a - (float)b;
+}
+
+inline AT_HOSTDEVICE BFloat16 operator*(const BFloat16& a, const BFloat16& b) {
+  return (float)a * (float)b;
+}
+
+inline AT_HOSTDEVICE BFloat16 operator/(const BFloat16& a, const BFloat16& b) {
+  return (float)a / (float)b;
+}
+
+inline AT_HOSTDEVICE BFloat16 operator-(const BFloat16& a) {
+  return -(float)a;
+}
+
+inline AT_HOSTDEVICE BFloat16& operator+=(BFloat16& a, const BFloat16& b) {
+  a = a + b;
+  return a;
+}
+
+inline AT_HOSTDEVICE BFloat16& operator-=(BFloat16& a, const BFloat16& b) {
+  a = a - b;
+  return a;
+}
+
+inline AT_HOSTDEVICE BFloat16& operator*=(BFloat16& a, const BFloat16& b) {
+  a = a * b;
+  return a;
+}
+
+inline AT_HOSTDEVICE BFloat16& operator/=(BFloat16& a, const BFloat16& b) {
+  a = a / b;
+  return a;
+}
+
+inline std::ostream& operator<<(std::ostream& out, const BFloat16& value) {
+  out << (float)value;
+  return out;
+}
+
+} // namespace at
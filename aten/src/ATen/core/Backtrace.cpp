@@ -1,6 +1,7 @@
 #include <ATen/core/Backtrace.h>
 #include <ATen/core/optional.h>
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <sstream>
@@ -160,10 +161,9 @@ at::optional<FrameInformation> parse_frame_information(
 } // anonymous namespace
 #endif // SUPPORTS_BACKTRACE
 
-std::string get_backtrace(
+std::vector<void*> capture_backtrace(
     size_t frames_to_skip,
-    size_t maximum_number_of_frames,
-    bool skip_python_frames) {
+    size_t maximum_number_of_frames) {
 #if SUPPORTS_BACKTRACE
 
   // We always skip this frame (backtrace).
@@ -177,17 +177,23 @@ std::string get_backtrace(
   auto number_of_frames =
       ::backtrace(callstack.data(), static_cast<int>(callstack.size()));
 
-  // Skip as many frames as requested. This is not efficient, but the sizes here
-  // are small and it makes the code nicer and safer.
-  for (; frames_to_skip > 0 && number_of_frames > 0;
-       --frames_to_skip, --number_of_frames) {
-    callstack.erase(callstack.begin());
-  }
+  // Skip as many frames as requested.
+  auto skipped = std::min(frames_to_skip, static_cast<size_t>(number_of_frames));
+  callstack.erase(callstack.begin(), callstack.begin() + skipped);
+  callstack.resize(static_cast<size_t>(number_of_frames) - skipped);
+  return callstack;
+#else // !SUPPORTS_BACKTRACE
+  return {};
+#endif // SUPPORTS_BACKTRACE
+}
 
-  // `number_of_frames` is strictly less than the current capacity of
-  // `callstack`, so this is just a pointer subtraction and makes the subsequent
-  // code safer.
-  callstack.resize(static_cast<size_t>(number_of_frames));
+std::string symbolize_backtrace(
+    const std::vector<void*>& callstack,
+    bool skip_python_frames) {
+#if SUPPORTS_BACKTRACE
+  if (callstack.empty()) {
+    return "";
+  }
 
   // `backtrace_symbols` takes the return addresses obtained from `backtrace()`
   // and fetches string representations of each stack. Unfortunately it doesn't
@@ -240,4 +246,14 @@ std::string get_backtrace(
 #endif // SUPPORTS_BACKTRACE
 }
 
+std::string get_backtrace(
+    size_t frames_to_skip,
+    size_t maximum_number_of_frames,
+    bool skip_python_frames) {
+  // We always skip this frame (get_backtrace).
+  return symbolize_backtrace(
+      capture_backtrace(frames_to_skip + 1, maximum_number_of_frames),
+      skip_python_frames);
+}
+
 } // namespace at
@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <string>
 #include <typeinfo>
+#include <vector>
 
 #include <ATen/core/Macros.h>
 
@@ -25,4 +26,17 @@ AT_CORE_API std::string get_backtrace(
     size_t frames_to_skip = 0,
     size_t maximum_number_of_frames = 64,
     bool skip_python_frames = true);
+
+/// Returns the return addresses of the current call stack. This is a lot
+/// cheaper than get_backtrace, which also looks up and demangles the function
+/// of every frame: that can be left to symbolize_backtrace, for when the
+/// backtrace is actually printed.
+AT_CORE_API std::vector<void*> capture_backtrace(
+    size_t frames_to_skip = 0,
+    size_t maximum_number_of_frames = 64);
+
+/// Formats a call stack returned by capture_backtrace like get_backtrace.
+AT_CORE_API std::string symbolize_backtrace(
+    const std::vector<void*>& callstack,
+    bool skip_python_frames = true);
 } // namespace at
@@ -2,6 +2,7 @@
 #include <ATen/core/Backtrace.h>
 
 #include <iostream>
+#include <mutex>
 #include <numeric>
 #include <string>
 
@@ -19,6 +20,26 @@ std::string StripBasename(const std::string& full_path) {
   }
 }
 
+struct LazyBacktrace {
+  explicit LazyBacktrace(std::vector<void*> callstack)
+      : callstack(std::move(callstack)) {}
+
+  const std::string& str() {
+    std::call_once(symbolized, [this] {
+      str_ = symbolize_backtrace(callstack);
+    });
+    return str_;
+  }
+
+  const std::vector<void*> callstack;
+  // guards the msg_ of the errors sharing this backtrace
+  std::mutex msg_mutex;
+
+ private:
+  std::once_flag symbolized;
+  std::string str_;
+};
+
 } // namespace detail
 
 std::ostream& operator<<(std::ostream& out, const SourceLocation& loc) {
@@ -30,19 +51,29 @@ Error::Error(
     const std::string& new_msg,
     const std::string& backtrace,
     const void* caller)
-    : msg_stack_{new_msg}, backtrace_(backtrace), caller_(caller) {
+    : msg_stack_{new_msg},
+      backtrace_(backtrace),
+      msg_valid_(true),
+      caller_(caller) {
   msg_ = msg();
   msg_without_backtrace_ = msg_without_backtrace();
 }
 
 // PyTorch-style error message
 Error::Error(SourceLocation source_location, const std::string& msg)
-    : Error(
-          msg,
-          str(" (",
-              source_location,
-              ")\n",
-              get_backtrace(/*frames_to_skip=*/2))) {}
+    : msg_stack_{msg},
+      backtrace_(str(" (", source_location, ")\n")),
+      msg_valid_(false),
+      caller_(nullptr) {
+  if (ExpectedErrorGuard::is_enabled()) {
+    msg_ = this->msg();
+    msg_valid_ = true;
+  } else {
+    lazy_backtrace_ = std::make_shared<detail::LazyBacktrace>(
+        capture_backtrace(/*frames_to_skip=*/1));
+  }
+  msg_without_backtrace_ = msg_without_backtrace();
+}
 
 // Caffe2-style error message
 Error::Error(
@@ -67,7 +98,24 @@ Error::Error(
 std::string Error::msg() const {
   return std::accumulate(
              msg_stack_.begin(), msg_stack_.end(), std::string("")) +
-      backtrace_;
+      backtrace_ + (lazy_backtrace_ ? lazy_backtrace_->str() : "");
+}
+
+const char* Error::what() const noexcept {
+  if (!lazy_backtrace_) {
+    return msg_.c_str();
+  }
+  std::lock_guard<std::mutex> guard(lazy_backtrace_->msg_mutex);
+  if (!msg_valid_) {
+    try {
+      msg_ = msg();
+    } catch (...) {
+      // e.g. out of memory while symbolizing
+      msg_ = msg_without_backtrace_ + backtrace_;
+    }
+    msg_valid_ = true;
+  }
+  return msg_.c_str();
 }
 
 std::string Error::msg_without_backtrace() const {
@@ -76,14 +124,34 @@ std::string Error::msg_without_backtrace() const {
 
 void Error::AppendMessage(const std::string& new_msg) {
   msg_stack_.push_back(new_msg);
-  // Refresh the cache
+  // Refresh the cache; with a lazy backtrace, what() recomputes msg_
   // TODO: Calling AppendMessage O(n) times has O(n^2) cost.  We can fix
   // this perf problem by populating the fields lazily... if this ever
   // actually is a problem.
-  msg_ = msg();
+  if (lazy_backtrace_) {
+    msg_valid_ = false;
+  } else {
+    msg_ = msg();
+  }
   msg_without_backtrace_ = msg_without_backtrace();
 }
 
+namespace {
+thread_local bool expected_error = false;
+} // namespace
+
+ExpectedErrorGuard::ExpectedErrorGuard() : prev_(expected_error) {
+  expected_error = true;
+}
+
+ExpectedErrorGuard::~ExpectedErrorGuard() {
+  expected_error = prev_;
+}
+
+bool ExpectedErrorGuard::is_enabled() {
+  return expected_error;
+}
+
 void Warning::warn(SourceLocation source_location, std::string msg) {
   warning_handler_(source_location, msg.c_str());
 }
@@ -5,6 +5,7 @@
 
 #include <cstddef>
 #include <exception>
+#include <memory>
 #include <ostream>
 #include <sstream>
 #include <string>
@@ -64,6 +65,10 @@ struct SourceLocation {
 
 std::ostream& operator<<(std::ostream& out, const SourceLocation& loc);
 
+namespace detail {
+struct LazyBacktrace;
+} // namespace detail
+
 /// The primary ATen error class.
 /// Provides a complete error message with source location information via
 /// `what()`, and a more concise message via `what_without_backtrace()`. Should
@@ -71,14 +76,24 @@ std::ostream& operator<<(std::ostream& out, const SourceLocation& loc);
 ///
 /// NB: at::Error is handled specially by the default torch to suppress the
 /// backtrace, see torch/csrc/Exceptions.h
+///
+/// Errors constructed from a `SourceLocation` only capture the return
+/// addresses of the stack; they are symbolized by the first call to `what()`,
+/// so throwing an error that is caught without being printed stays cheap.
+/// No backtrace at all is captured while an `ExpectedErrorGuard` is alive.
 class AT_CORE_API Error : public std::exception {
   std::vector<std::string> msg_stack_;
   std::string backtrace_;
+  // The stack at the throw site, symbolized when the full message is first
+  // needed. Shared by the copies of the error.
+  std::shared_ptr<detail::LazyBacktrace> lazy_backtrace_;
 
   // These two are derived fields from msg_stack_ and backtrace_, but we need
   // fields for the strings so that we can return a const char* (as the
-  // signature of std::exception requires).
-  std::string msg_;
+  // signature of std::exception requires). msg_ is computed by what() when
+  // the backtrace is lazy.
+  mutable std::string msg_;
+  mutable bool msg_valid_;
   std::string msg_without_backtrace_;
 
   // This is a little debugging trick: you can stash a relevant pointer
@@ -114,9 +129,7 @@ class AT_CORE_API Error : public std::exception {
   }
 
   /// Returns the complete error message, including the source location.
-  const char* what() const noexcept override {
-    return msg_.c_str();
-  }
+  const char* what() const noexcept override;
 
   const void* caller() const noexcept {
     return caller_;
@@ -128,6 +141,18 @@ class AT_CORE_API Error : public std::exception {
   }
 };
 
+/// While an ExpectedErrorGuard is alive, the errors thrown on its thread don't
+/// capture a backtrace. Use it around code that is expected to throw, e.g.
+/// when trying an operation and falling back to another one if it fails.
+struct AT_CORE_API ExpectedErrorGuard {
+  ExpectedErrorGuard();
+  ~ExpectedErrorGuard();
+  static bool is_enabled();
+
+ private:
+  bool prev_;
+};
+
 class AT_CORE_API Warning {
   using handler_t =
       void (*)(const SourceLocation& source_location, const char* msg);
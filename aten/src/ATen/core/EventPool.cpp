@@ -0,0 +1,38 @@
+#include <ATen/core/EventPool.h>
+
+namespace at {
+
+void* EventPool::acquire(int64_t device) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (device < 0 || static_cast<size_t>(device) >= events_.size() ||
+      events_[device].empty()) {
+    return nullptr;
+  }
+  void* event = events_[device].back();
+  events_[device].pop_back();
+  return event;
+}
+
+void EventPool::release(int64_t device, void* event) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (static_cast<size_t>(device) >= events_.size()) {
+    events_.resize(device + 1);
+  }
+  events_[device].push_back(event);
+}
+
+size_t EventPool::size(int64_t device) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (device < 0 || static_cast<size_t>(device) >= events_.size()) {
+    return 0;
+  }
+  return events_[device].size();
+}
+
+EventPool& cuda_event_pool() {
+  // Leaked, so that events can still be released from static destructors
+  static EventPool* pool = new EventPool();
+  return *pool;
+}
+
+} // namespace at
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <ATen/core/Macros.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace at {
+
+/**
+ * A per-device pool of reusable device event handles, e.g. `cudaEvent_t`.
+ *
+ * Creating and destroying a CUDA event costs much more than recording one, so
+ * ATen's `CUDAEvent` and Caffe2's CUDA events give their events back to the
+ * pool instead of destroying them, and take them from the pool when they are
+ * created. ATen/core doesn't depend on CUDA, so the pool keeps the events as
+ * opaque pointers and the callers create a new event when it has none for
+ * their device. Events in one pool must have been created with the same
+ * flags.
+ *
+ * The events in the pool are never destroyed; they go away with the device
+ * context at exit, like the memory of the caching allocators.
+ */
+class AT_CORE_API EventPool {
+ public:
+  EventPool() = default;
+
+  AT_DISABLE_COPY_AND_ASSIGN(EventPool);
+
+  /// Returns an event of `device`, or nullptr if the pool has none.
+  void* acquire(int64_t device);
+
+  /// Gives `event`, an event of `device`, back to the pool.
+  void release(int64_t device, void* event);
+
+  /// Number of events of `device` in the pool.
+  size_t size(int64_t device);
+
+ private:
+  std::mutex mutex_;
+  std::vector<std::vector<void*>> events_;
+};
+
+/// Returns the process-wide pool of the CUDA events created with
+/// `cudaEventDisableTiming`, shared by ATen and Caffe2.
+AT_CORE_API EventPool& cuda_event_pool();
+
+} // namespace at
@@ -0,0 +1 @@
+#include <ATen/core/StaticTracepoint.h>
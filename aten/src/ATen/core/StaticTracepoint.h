@@ -0,0 +1,41 @@
+#pragma once
+
+// Static tracepoints (USDT probes) under the "pytorch" provider. A probe
+// compiles to a single nop and costs nothing while no tracer is attached,
+// e.g. with bpftrace:
+//
+//   bpftrace -e 'usdt:libcaffe2.so:pytorch:op_start { @[str(arg0)] = count(); }'
+//
+// AT_SDT(name, args...) fires the probe `name` with up to 8 integer or
+// pointer arguments. Probes whose arguments are expensive to compute should
+// have a semaphore, defined in exactly one translation unit with
+// AT_SDT_DEFINE_SEMAPHORE(name), and be fired as
+//
+//   if (AT_SDT_IS_ENABLED(name)) {
+//     AT_SDT_WITH_SEMAPHORE(name, compute_args()...);
+//   }
+//
+// On platforms other than ELF x86 the probes compile to nothing and are
+// never enabled.
+
+#if defined(__ELF__) && (defined(__x86_64__) || defined(__i386__))
+#include <ATen/core/StaticTracepointElfX86.h>
+
+#define AT_SDT(name, ...)                                                      \
+  AT_SDT_PROBE_N(                                                              \
+    pytorch, name, 0, AT_SDT_NARG(0, ##__VA_ARGS__), ##__VA_ARGS__)
+#define AT_SDT_WITH_SEMAPHORE(name, ...)                                       \
+  AT_SDT_PROBE_N(                                                              \
+    pytorch, name, 1, AT_SDT_NARG(0, ##__VA_ARGS__), ##__VA_ARGS__)
+#define AT_SDT_DEFINE_SEMAPHORE(name)                                          \
+  AT_SDT_DEFINE_SEMAPHORE_(pytorch, name)
+#define AT_SDT_DECLARE_SEMAPHORE(name)                                         \
+  AT_SDT_DECLARE_SEMAPHORE_(pytorch, name)
+#define AT_SDT_IS_ENABLED(name) (AT_SDT_SEMAPHORE(pytorch, name) > 0)
+#else
+#define AT_SDT(name, ...) do {} while(0)
+#define AT_SDT_WITH_SEMAPHORE(name, ...) do {} while(0)
+#define AT_SDT_DEFINE_SEMAPHORE(name)
+#define AT_SDT_DECLARE_SEMAPHORE(name)
+#define AT_SDT_IS_ENABLED(name) (false)
+#endif
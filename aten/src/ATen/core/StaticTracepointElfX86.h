@@ -0,0 +1,125 @@
+#pragma once
+
+// Emits SystemTap (USDT) probes: a nop at the probe site plus an ELF note
+// describing where the nop is and how to find its arguments, which
+// bpftrace, bcc, perf and gdb understand. Include StaticTracepoint.h rather
+// than this file.
+
+// Default constraint for the probe arguments as operands.
+#ifndef AT_SDT_ARG_CONSTRAINT
+#define AT_SDT_ARG_CONSTRAINT      "nor"
+#endif
+
+// Instruction to emit for the probe.
+#define AT_SDT_NOP                 nop
+
+// Note section properties.
+#define AT_SDT_NOTE_NAME           "stapsdt"
+#define AT_SDT_NOTE_TYPE           3
+
+// Semaphore variables are put in this section
+#define AT_SDT_SEMAPHORE_SECTION   ".probes"
+
+// Size of address depending on platform.
+#ifdef __LP64__
+#define AT_SDT_ASM_ADDR            .8byte
+#else
+#define AT_SDT_ASM_ADDR            .4byte
+#endif
+
+// Assembler helper Macros.
+#define AT_SDT_S(x)                #x
+#define AT_SDT_ASM_1(x)            AT_SDT_S(x) "\n"
+#define AT_SDT_ASM_2(a, b)         AT_SDT_S(a) "," AT_SDT_S(b) "\n"
+#define AT_SDT_ASM_3(a, b, c)      AT_SDT_S(a) "," AT_SDT_S(b) ","             \
+                                   AT_SDT_S(c) "\n"
+#define AT_SDT_ASM_STRING(x)       AT_SDT_ASM_1(.asciz AT_SDT_S(x))
+
+// Helper to determine the size of an argument.
+#define AT_SDT_ISARRAY(x)  (__builtin_classify_type(x) == 14)
+#define AT_SDT_ARGSIZE(x)  (AT_SDT_ISARRAY(x) ? sizeof(void*) : sizeof(x))
+
+// Format of each probe arguments as operand.
+// Size of the arugment tagged with AT_SDT_Sn, with "n" constraint.
+// Value of the argument tagged with AT_SDT_An, with configured constraint.
+#define AT_SDT_ARG(n, x)                                                       \
+  [AT_SDT_S##n] "n"                ((size_t)AT_SDT_ARGSIZE(x)),                \
+  [AT_SDT_A##n] AT_SDT_ARG_CONSTRAINT (x)
+
+// Templates to append arguments as operands.
+#define AT_SDT_OPERANDS_0()        [__sdt_dummy] "g" (0)
+#define AT_SDT_OPERANDS_1(_1)      AT_SDT_ARG(1, _1)
+#define AT_SDT_OPERANDS_2(_1, _2)                                              \
+  AT_SDT_OPERANDS_1(_1), AT_SDT_ARG(2, _2)
+#define AT_SDT_OPERANDS_3(_1, _2, _3)                                          \
+  AT_SDT_OPERANDS_2(_1, _2), AT_SDT_ARG(3, _3)
+#define AT_SDT_OPERANDS_4(_1, _2, _3, _4)                                      \
+  AT_SDT_OPERANDS_3(_1, _2, _3), AT_SDT_ARG(4, _4)
+#define AT_SDT_OPERANDS_5(_1, _2, _3, _4, _5)                                  \
+  AT_SDT_OPERANDS_4(_1, _2, _3, _4), AT_SDT_ARG(5, _5)
+#define AT_SDT_OPERANDS_6(_1, _2, _3, _4, _5, _6)                              \
+  AT_SDT_OPERANDS_5(_1, _2, _3, _4, _5), AT_SDT_ARG(6, _6)
+#define AT_SDT_OPERANDS_7(_1, _2, _3, _4, _5, _6, _7)                          \
+  AT_SDT_OPERANDS_6(_1, _2, _3, _4, _5, _6), AT_SDT_ARG(7, _7)
+#define AT_SDT_OPERANDS_8(_1, _2, _3, _4, _5, _6, _7, _8)                      \
+  AT_SDT_OPERANDS_7(_1, _2, _3, _4, _5, _6, _7), AT_SDT_ARG(8, _8)
+
+// Templates to reference the arguments from operands in note section.
+#define AT_SDT_ARGFMT(no)        %n[AT_SDT_S##no]@%[AT_SDT_A##no]
+#define AT_SDT_ARG_TEMPLATE_0    /*No arguments*/
+#define AT_SDT_ARG_TEMPLATE_1    AT_SDT_ARGFMT(1)
+#define AT_SDT_ARG_TEMPLATE_2    AT_SDT_ARG_TEMPLATE_1 AT_SDT_ARGFMT(2)
+#define AT_SDT_ARG_TEMPLATE_3    AT_SDT_ARG_TEMPLATE_2 AT_SDT_ARGFMT(3)
+#define AT_SDT_ARG_TEMPLATE_4    AT_SDT_ARG_TEMPLATE_3 AT_SDT_ARGFMT(4)
+#define AT_SDT_ARG_TEMPLATE_5    AT_SDT_ARG_TEMPLATE_4 AT_SDT_ARGFMT(5)
+#define AT_SDT_ARG_TEMPLATE_6    AT_SDT_ARG_TEMPLATE_5 AT_SDT_ARGFMT(6)
+#define AT_SDT_ARG_TEMPLATE_7    AT_SDT_ARG_TEMPLATE_6 AT_SDT_ARGFMT(7)
+#define AT_SDT_ARG_TEMPLATE_8    AT_SDT_ARG_TEMPLATE_7 AT_SDT_ARGFMT(8)
+
+// Semaphore of a probe, which tracers increment while they are attached to
+// it, so that probes with expensive arguments can be skipped otherwise.
+#define AT_SDT_SEMAPHORE(provider, name)                                       \
+  at_sdt_semaphore_##provider##_##name
+#define AT_SDT_DEFINE_SEMAPHORE_(provider, name)                               \
+  extern "C" {                                                                 \
+    volatile unsigned short AT_SDT_SEMAPHORE(provider, name)                   \
+    __attribute__((section(AT_SDT_SEMAPHORE_SECTION), used)) = 0;              \
+  }
+#define AT_SDT_DECLARE_SEMAPHORE_(provider, name)                              \
+  extern "C" volatile unsigned short AT_SDT_SEMAPHORE(provider, name)
+#define AT_SDT_SEMAPHORE_NOTE_0(provider, name)                                \
+  AT_SDT_ASM_1(     AT_SDT_ASM_ADDR 0) /*No Semaphore*/
+#define AT_SDT_SEMAPHORE_NOTE_1(provider, name)                                \
+  AT_SDT_ASM_1(     AT_SDT_ASM_ADDR AT_SDT_SEMAPHORE(provider, name))
+
+// Structure of note section for the probe.
+#define AT_SDT_NOTE_CONTENT(provider, name, has_semaphore, arg_template)       \
+  AT_SDT_ASM_1(990: AT_SDT_NOP)                                                \
+  AT_SDT_ASM_3(     .pushsection .note.stapsdt,"","note")                      \
+  AT_SDT_ASM_1(     .balign 4)                                                 \
+  AT_SDT_ASM_3(     .4byte 992f-991f, 994f-993f, AT_SDT_NOTE_TYPE)             \
+  AT_SDT_ASM_1(991: .asciz AT_SDT_NOTE_NAME)                                   \
+  AT_SDT_ASM_1(992: .balign 4)                                                 \
+  AT_SDT_ASM_1(993: AT_SDT_ASM_ADDR 990b)                                      \
+  AT_SDT_ASM_1(     AT_SDT_ASM_ADDR 0) /*Reserved for Base Address*/           \
+  AT_SDT_SEMAPHORE_NOTE_##has_semaphore(provider, name)                        \
+  AT_SDT_ASM_STRING(provider)                                                  \
+  AT_SDT_ASM_STRING(name)                                                      \
+  AT_SDT_ASM_STRING(arg_template)                                              \
+  AT_SDT_ASM_1(994: .balign 4)                                                 \
+  AT_SDT_ASM_1(     .popsection)
+
+// Main probe Macro.
+#define AT_SDT_PROBE(provider, name, has_semaphore, n, arglist)                \
+    __asm__ __volatile__ (                                                     \
+      AT_SDT_NOTE_CONTENT(                                                     \
+        provider, name, has_semaphore, AT_SDT_ARG_TEMPLATE_##n)                \
+      :: AT_SDT_OPERANDS_##n arglist                                           \
+    )                                                                          \
+
+// Helper Macros to handle variadic arguments.
+#define AT_SDT_NARG_(_0, _1, _2, _3, _4, _5, _6, _7, _8, N, ...) N
+#define AT_SDT_NARG(...)                                                       \
+  AT_SDT_NARG_(__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define AT_SDT_PROBE_N(provider, name, has_semaphore, N, ...)                  \
+  AT_SDT_PROBE(provider, name, has_semaphore, N, (__VA_ARGS__))
@@ -0,0 +1,281 @@
+#include <ATen/core/ThreadPool.h>
+
+#include <exception>
+
+namespace at {
+
+namespace {
+thread_local int current_worker = -1;
+} // namespace
+
+struct ThreadPool::Job {
+  const std::function<void(size_t)>* fn;
+  size_t remaining;
+  std::mutex mutex;
+  std::condition_variable done;
+  std::exception_ptr eptr;
+};
+
+ThreadPool::ThreadPool(size_t num_threads)
+    : pending_(0), next_queue_(0), stop_(false) {
+  queues_.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    queues_.emplace_back(new TaskQueue());
+  }
+  threads_.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads_.emplace_back([this, i]() { worker_loop(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> guard(wake_mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+int ThreadPool::current_worker_id() {
+  return current_worker;
+}
+
+bool ThreadPool::pop_task(size_t id, Task& task) {
+  auto& queue = *queues_[id];
+  std::lock_guard<std::mutex> guard(queue.mutex);
+  if (queue.tasks.empty()) {
+    return false;
+  }
+  task = queue.tasks.back();
+  queue.tasks.pop_back();
+  pending_--;
+  return true;
+}
+
+bool ThreadPool::steal_task(size_t id, Task& task) {
+  const size_t n = queues_.size();
+  for (size_t offset = 1; offset <= n; ++offset) {
+    auto& queue = *queues_[(id + offset) % n];
+    std::lock_guard<std::mutex> guard(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = queue.tasks.front();
+      queue.tasks.pop_front();
+      pending_--;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::push_task(Task task) {
+  const size_t n = queues_.size();
+  const int self = current_worker;
+  // Workers push to their own deque to keep dependent work cache-local;
+  // external threads spread their work round-robin.
+  const size_t id = self >= 0 && static_cast<size_t>(self) < n
+      ? static_cast<size_t>(self)
+      : next_queue_.fetch_add(1) % n;
+  {
+    auto& queue = *queues_[id];
+    std::lock_guard<std::mutex> guard(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  }
+  {
+    std::lock_guard<std::mutex> guard(wake_mutex_);
+    pending_++;
+  }
+  wake_.notify_one();
+}
+
+void ThreadPool::submit(std::function<void()> fn) {
+  if (threads_.empty()) {
+    fn();
+    return;
+  }
+  push_task(Task{nullptr, 0, std::move(fn)});
+}
+
+bool ThreadPool::run_pending_task() {
+  if (queues_.empty()) {
+    return false;
+  }
+  Task task;
+  const int self = current_worker;
+  const size_t home = self >= 0 ? static_cast<size_t>(self) % queues_.size()
+                                : next_queue_.load() % queues_.size();
+  if (steal_task(home, task)) {
+    execute(task);
+    return true;
+  }
+  return false;
+}
+
+void ThreadPool::execute(const Task& task) {
+  if (!task.job) {
+    task.fn();
+    return;
+  }
+  Job* job = task.job;
+  std::exception_ptr eptr;
+  try {
+    (*job->fn)(task.index);
+  } catch (...) {
+    eptr = std::current_exception();
+  }
+  // The job lives on the stack of the thread that called run(); it may only
+  // be touched while holding its mutex, because that thread returns as soon
+  // as it observes remaining == 0.
+  std::lock_guard<std::mutex> guard(job->mutex);
+  if (eptr && !job->eptr) {
+    job->eptr = eptr;
+  }
+  if (--job->remaining == 0) {
+    job->done.notify_all();
+  }
+}
+
+void ThreadPool::worker_loop(size_t id) {
+  current_worker = static_cast<int>(id);
+  while (true) {
+    Task task;
+    if (pop_task(id, task) || steal_task(id, task)) {
+      execute(task);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    wake_.wait(lock, [this]() { return stop_ || pending_.load() > 0; });
+    if (stop_ && pending_.load() == 0) {
+      return;
+    }
+  }
+}
+
+void ThreadPool::run(size_t num_tasks, const std::function<void(size_t)>& fn) {
+  if (num_tasks == 0) {
+    return;
+  }
+  if (threads_.empty() || num_tasks == 1) {
+    for (size_t i = 0; i < num_tasks; ++i) {
+      fn(i);
+    }
+    return;
+  }
+
+  Job job;
+  job.fn = &fn;
+  job.remaining = num_tasks;
+
+  // Keep the last task for the calling thread so that it starts working
+  // immediately instead of racing the workers for the first steal.
+  const size_t n = queues_.size();
+  const size_t start = next_queue_.fetch_add(1) % n;
+  for (size_t i = 0; i + 1 < num_tasks; ++i) {
+    auto& queue = *queues_[(start + i) % n];
+    std::lock_guard<std::mutex> guard(queue.mutex);
+    queue.tasks.push_back(Task{&job, i, nullptr});
+  }
+  {
+    std::lock_guard<std::mutex> guard(wake_mutex_);
+    pending_ += num_tasks - 1;
+  }
+  wake_.notify_all();
+
+  execute(Task{&job, num_tasks - 1, nullptr});
+
+  // Help out until every task of this job has run; the tasks we pick up may
+  // belong to other jobs, which is fine since they all make progress.
+  const int self = current_worker;
+  const size_t home = self >= 0 ? static_cast<size_t>(self) % n : start;
+  while (true) {
+    {
+      std::lock_guard<std::mutex> guard(job.mutex);
+      if (job.remaining == 0) {
+        break;
+      }
+    }
+    Task task;
+    if (steal_task(home, task)) {
+      execute(task);
+    } else {
+      std::unique_lock<std::mutex> lock(job.mutex);
+      job.done.wait(lock, [&job]() { return job.remaining == 0; });
+      break;
+    }
+  }
+
+  std::lock_guard<std::mutex> guard(job.mutex);
+  if (job.eptr) {
+    std::rethrow_exception(job.eptr);
+  }
+}
+
+namespace {
+
+std::mutex& intra_op_pool_mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+// -1 until the size is first queried or set.
+int& intra_op_pool_size() {
+  static int size = -1;
+  return size;
+}
+
+std::shared_ptr<ThreadPool>& intra_op_pool_instance() {
+  static std::shared_ptr<ThreadPool> pool;
+  return pool;
+}
+
+int default_intra_op_pool_size() {
+  const int cores = static_cast<int>(std::thread::hardware_concurrency());
+  // The calling thread always participates, so leave a core for it.
+  return cores > 1 ? cores - 1 : 0;
+}
+
+int resolved_intra_op_pool_size() {
+  auto& size = intra_op_pool_size();
+  if (size < 0) {
+    size = default_intra_op_pool_size();
+  }
+  return size;
+}
+
+} // namespace
+
+std::shared_ptr<ThreadPool> intra_op_thread_pool() {
+  std::lock_guard<std::mutex> guard(intra_op_pool_mutex());
+  auto& pool = intra_op_pool_instance();
+  if (!pool) {
+    pool = std::make_shared<ThreadPool>(resolved_intra_op_pool_size());
+  }
+  return pool;
+}
+
+void set_intra_op_pool_size(int num_threads) {
+  if (num_threads < 0) {
+    num_threads = default_intra_op_pool_size();
+  }
+  std::shared_ptr<ThreadPool> old_pool;
+  {
+    std::lock_guard<std::mutex> guard(intra_op_pool_mutex());
+    if (num_threads == resolved_intra_op_pool_size()) {
+      return;
+    }
+    intra_op_pool_size() = num_threads;
+    old_pool = std::move(intra_op_pool_instance());
+    intra_op_pool_instance().reset();
+  }
+  // old_pool is released outside the lock; its threads are joined once the
+  // last in-flight user drops its reference.
+}
+
+size_t get_intra_op_pool_size() {
+  std::lock_guard<std::mutex> guard(intra_op_pool_mutex());
+  return resolved_intra_op_pool_size();
+}
+
+} // namespace at
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <ATen/core/Macros.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace at {
+
+/**
+ * A work-stealing thread pool.
+ *
+ * Every worker owns a deque of tasks. Work submitted through `run` is spread
+ * round-robin over the deques; a worker pops from the back of its own deque
+ * and, once that is empty, steals from the front of the others. The thread
+ * that calls `run` also executes tasks until its own job is finished, so a
+ * pool of N threads gives N + 1 way parallelism and a `run` issued from inside
+ * a worker can never deadlock waiting for itself.
+ *
+ * The pool lives in ATen/core so that both ATen's `parallel_for` and Caffe2's
+ * `caffe2::ThreadPool` can share a single set of threads in one process.
+ */
+class AT_CORE_API ThreadPool {
+ public:
+  explicit ThreadPool(size_t num_threads);
+  ~ThreadPool();
+
+  AT_DISABLE_COPY_AND_ASSIGN(ThreadPool);
+
+  /// Number of worker threads owned by the pool (not counting callers).
+  size_t size() const {
+    return threads_.size();
+  }
+
+  /// Invokes `fn(i)` for every `i` in `[0, num_tasks)` and blocks until all of
+  /// them have completed. If any invocation throws, the first exception is
+  /// rethrown on the calling thread after all tasks have finished.
+  void run(size_t num_tasks, const std::function<void(size_t)>& fn);
+
+  /// Enqueues `fn` to run asynchronously on the pool. `fn` must not throw;
+  /// callers that need to report errors have to capture them themselves.
+  /// With no worker threads `fn` runs inline.
+  void submit(std::function<void()> fn);
+
+  /// Runs one queued task on the calling thread, if there is one. Threads
+  /// that wait on work submitted to the pool should call this in their wait
+  /// loop so that waiting never starves the pool of threads.
+  bool run_pending_task();
+
+  /// Returns the index of the worker thread the caller is running on, or -1
+  /// if the caller is not a worker of any `ThreadPool`.
+  static int current_worker_id();
+
+ private:
+  struct Job;
+  // A task is either one index of a run() job, or (job == nullptr) a
+  // function passed to submit().
+  struct Task {
+    Job* job;
+    size_t index;
+    std::function<void()> fn;
+  };
+  struct TaskQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void worker_loop(size_t id);
+  bool pop_task(size_t id, Task& task);
+  bool steal_task(size_t id, Task& task);
+  void push_task(Task task);
+  static void execute(const Task& task);
+
+  std::vector<std::unique_ptr<TaskQueue>> queues_;
+  std::vector<std::thread> threads_;
+  std::atomic<size_t> pending_;
+  std::atomic<size_t> next_queue_;
+  std::mutex wake_mutex_;
+  std::condition_variable wake_;
+  bool stop_;
+};
+
+/// Returns the process-wide intra-op pool shared by ATen and Caffe2. The pool
+/// is created lazily with `get_intra_op_pool_size()` threads.
+AT_CORE_API std::shared_ptr<ThreadPool> intra_op_thread_pool();
+
+/// Resizes the process-wide intra-op pool to `num_threads` workers. Callers
+/// that already hold the old pool keep using it until they release it. A
+/// negative size selects a default based on
+/// `std::thread::hardware_concurrency()`.
+AT_CORE_API void set_intra_op_pool_size(int num_threads);
+AT_CORE_API size_t get_intra_op_pool_size();
+
+} // namespace at
@@ -0,0 +1,27 @@
+#include "ATen/core/EventPool.h"
+
+#include <gtest/gtest.h>
+
+using at::EventPool;
+
+TEST(EventPoolTest, ReusesReleasedEvents) {
+  EventPool pool;
+  int a, b;
+  EXPECT_EQ(nullptr, pool.acquire(0));
+  pool.release(0, &a);
+  pool.release(0, &b);
+  EXPECT_EQ(2u, pool.size(0));
+  EXPECT_EQ(&b, pool.acquire(0));
+  EXPECT_EQ(&a, pool.acquire(0));
+  EXPECT_EQ(nullptr, pool.acquire(0));
+}
+
+TEST(EventPoolTest, KeepsDevicesApart) {
+  EventPool pool;
+  int a;
+  pool.release(2, &a);
+  EXPECT_EQ(0u, pool.size(0));
+  EXPECT_EQ(nullptr, pool.acquire(0));
+  EXPECT_EQ(nullptr, pool.acquire(3));
+  EXPECT_EQ(&a, pool.acquire(2));
+}
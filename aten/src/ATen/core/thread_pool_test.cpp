@@ -0,0 +1,92 @@
+#include "ATen/core/ThreadPool.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+
+using at::ThreadPool;
+
+TEST(ThreadPoolTest, RunsEveryTaskOnce) {
+  ThreadPool pool(3);
+  std::vector<std::atomic<int>> hits(1000);
+  for (auto& h : hits) {
+    h = 0;
+  }
+  pool.run(hits.size(), [&](size_t i) { hits[i]++; });
+  for (auto& h : hits) {
+    EXPECT_EQ(1, h.load());
+  }
+}
+
+TEST(ThreadPoolTest, EmptyPoolRunsInline) {
+  ThreadPool pool(0);
+  int sum = 0;
+  pool.run(10, [&](size_t i) { sum += i; });
+  EXPECT_EQ(45, sum);
+}
+
+TEST(ThreadPoolTest, NestedRunDoesNotDeadlock) {
+  ThreadPool pool(2);
+  std::atomic<int> count(0);
+  pool.run(8, [&](size_t) { pool.run(8, [&](size_t) { count++; }); });
+  EXPECT_EQ(64, count.load());
+}
+
+TEST(ThreadPoolTest, PropagatesExceptions) {
+  ThreadPool pool(2);
+  std::atomic<int> count(0);
+  EXPECT_THROW(
+      pool.run(
+          16,
+          [&](size_t i) {
+            count++;
+            if (i == 5) {
+              throw std::runtime_error("task failed");
+            }
+          }),
+      std::runtime_error);
+  EXPECT_EQ(16, count.load());
+}
+
+TEST(ThreadPoolTest, ConcurrentCallers) {
+  ThreadPool pool(2);
+  std::atomic<int> count(0);
+  std::vector<std::thread> callers;
+  for (int t = 0; t < 4; ++t) {
+    callers.emplace_back([&]() {
+      for (int r = 0; r < 50; ++r) {
+        pool.run(10, [&](size_t) { count++; });
+      }
+    });
+  }
+  for (auto& c : callers) {
+    c.join();
+  }
+  EXPECT_EQ(4 * 50 * 10, count.load());
+}
+
+TEST(ThreadPoolTest, IntraOpPoolResize) {
+  at::set_intra_op_pool_size(2);
+  auto pool = at::intra_op_thread_pool();
+  EXPECT_EQ(2u, pool->size());
+  at::set_intra_op_pool_size(1);
+  // The old pool stays valid for holders of the shared_ptr.
+  std::atomic<int> count(0);
+  pool->run(4, [&](size_t) { count++; });
+  EXPECT_EQ(4, count.load());
+  EXPECT_EQ(1u, at::intra_op_thread_pool()->size());
+}
+
+TEST(ThreadPoolTest, SubmitAndHelp) {
+  ThreadPool pool(2);
+  std::atomic<int> count(0);
+  for (int i = 0; i < 100; ++i) {
+    pool.submit([&]() { count++; });
+  }
+  while (count.load() < 100) {
+    if (!pool.run_pending_task()) {
+      std::this_thread::yield();
+    }
+  }
+  EXPECT_EQ(100, count.load());
+}
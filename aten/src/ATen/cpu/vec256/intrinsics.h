@@ -12,8 +12,9 @@
 #elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
 /* GCC-compatible compiler, targeting x86/x86-64 */
 #include <x86intrin.h>
-#elif defined(__GNUC__) && defined(__ARM_NEON__)
-/* GCC-compatible compiler, targeting ARM with NEON */
+#elif defined(__GNUC__) && (defined(__ARM_NEON__) || defined(__ARM_NEON))
+/* GCC-compatible compiler, targeting ARM with NEON (AArch64 only defines
+   __ARM_NEON) */
 #include <arm_neon.h>
 #elif defined(__GNUC__) && defined(__IWMMXT__)
 /* GCC-compatible compiler, targeting ARM with WMMX */
@@ -5,7 +5,10 @@
 #include "vec256_base.h"
 #include "vec256_float.h"
 #include "vec256_double.h"
+#include "vec256_float_neon.h"
+#include "vec256_double_neon.h"
 #include "vec256_int.h"
+#include "vec256_half.h"
 
 #include <algorithm>
 #include <cstddef>
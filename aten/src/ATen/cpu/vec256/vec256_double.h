@@ -109,17 +109,20 @@ public:
   Vec256<double> log1p() const {
     return Vec256<double>(Sleef_log1pd4_u10(values));
   }
+  Vec256<double> lgamma() const {
+    return Vec256<double>(Sleef_lgammad4_u10(values));
+  }
   Vec256<double> sin() const {
-    return map(std::sin);
+    return Vec256<double>(Sleef_sind4_u10(values));
   }
   Vec256<double> sinh() const {
-    return map(std::sinh);
+    return Vec256<double>(Sleef_sinhd4_u10(values));
   }
   Vec256<double> cos() const {
-    return map(std::cos);
+    return Vec256<double>(Sleef_cosd4_u10(values));
   }
   Vec256<double> cosh() const {
-    return map(std::cos);
+    return Vec256<double>(Sleef_coshd4_u10(values));
   }
   Vec256<double> ceil() const {
     return _mm256_ceil_pd(values);
@@ -134,7 +137,7 @@ public:
     return _mm256_round_pd(values, (_MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
   }
   Vec256<double> tan() const {
-    return map(std::tan);
+    return Vec256<double>(Sleef_tand4_u10(values));
   }
   Vec256<double> tanh() const {
     return Vec256<double>(Sleef_tanhd4_u10(values));
@@ -178,6 +181,23 @@ Vec256<double> inline max(const Vec256<double>& a, const Vec256<double>& b) {
   return _mm256_max_pd(a, b);
 }
 
+// The min/max instructions return the second operand if either one is NaN.
+template <>
+Vec256<double> inline clamp(const Vec256<double>& a, const Vec256<double>& min, const Vec256<double>& max) {
+  return _mm256_blendv_pd(
+      _mm256_min_pd(max, a), min, _mm256_cmp_pd(a, min, _CMP_LT_OQ));
+}
+
+template <>
+Vec256<double> inline clamp_max(const Vec256<double>& a, const Vec256<double>& max) {
+  return _mm256_min_pd(max, a);
+}
+
+template <>
+Vec256<double> inline clamp_min(const Vec256<double>& a, const Vec256<double>& min) {
+  return _mm256_max_pd(min, a);
+}
+
 #ifdef __AVX2__
 template <>
 Vec256<double> fmadd(const Vec256<double>& a, const Vec256<double>& b, const Vec256<double>& c) {
@@ -0,0 +1,230 @@
+#pragma once
+
+#include "intrinsics.h"
+#include "vec256_base.h"
+#if defined(__aarch64__) && defined(__ARM_NEON) && !defined(_MSC_VER)
+#include <sleef.h>
+#endif
+
+namespace at {
+namespace vec256 {
+namespace {
+
+// See vec256_float_neon.h.
+
+#if defined(__aarch64__) && defined(__ARM_NEON) && !defined(_MSC_VER)
+
+template <> class Vec256<double> {
+private:
+  float64x2x2_t values;
+  static uint64x2_t lane_mask(int64_t mask) {
+    const uint64_t lanes[2] = {
+        mask & 1 ? ~uint64_t(0) : 0, mask & 2 ? ~uint64_t(0) : 0};
+    return vld1q_u64(lanes);
+  }
+public:
+  static constexpr int size = 4;
+  Vec256() {}
+  Vec256(float64x2_t lo, float64x2_t hi) {
+    values.val[0] = lo;
+    values.val[1] = hi;
+  }
+  Vec256(double val) {
+    values.val[0] = vdupq_n_f64(val);
+    values.val[1] = vdupq_n_f64(val);
+  }
+  float64x2_t lo() const {
+    return values.val[0];
+  }
+  float64x2_t hi() const {
+    return values.val[1];
+  }
+  template <int64_t mask>
+  static Vec256<double> blend(Vec256<double> a, Vec256<double> b) {
+    return Vec256<double>(
+        vbslq_f64(lane_mask(mask), b.lo(), a.lo()),
+        vbslq_f64(lane_mask(mask >> 2), b.hi(), a.hi()));
+  }
+  static Vec256<double> set(Vec256<double> a, Vec256<double> b, int64_t count = size) {
+    const uint64_t lanes[4] = {0, 1, 2, 3};
+    const uint64x2_t n = vdupq_n_u64(static_cast<uint64_t>(count));
+    return Vec256<double>(
+        vbslq_f64(vcltq_u64(vld1q_u64(lanes), n), b.lo(), a.lo()),
+        vbslq_f64(vcltq_u64(vld1q_u64(lanes + 2), n), b.hi(), a.hi()));
+  }
+  static Vec256<double> loadu(const void* ptr, int64_t count = size) {
+    if (count == size) {
+      const double* p = reinterpret_cast<const double*>(ptr);
+      return Vec256<double>(vld1q_f64(p), vld1q_f64(p + 2));
+    }
+    __at_align32__ double tmp_values[size] = {0};
+    std::memcpy(
+        tmp_values, reinterpret_cast<const double*>(ptr), count * sizeof(double));
+    return Vec256<double>(vld1q_f64(tmp_values), vld1q_f64(tmp_values + 2));
+  }
+  void store(void* ptr, int64_t count = size) const {
+    if (count == size) {
+      double* p = reinterpret_cast<double*>(ptr);
+      vst1q_f64(p, values.val[0]);
+      vst1q_f64(p + 2, values.val[1]);
+    } else {
+      double tmp_values[size];
+      vst1q_f64(tmp_values, values.val[0]);
+      vst1q_f64(tmp_values + 2, values.val[1]);
+      std::memcpy(ptr, tmp_values, count * sizeof(double));
+    }
+  }
+  const double& operator[](int idx) const  = delete;
+  double& operator[](int idx) = delete;
+  Vec256<double> map(double (*f)(double)) const {
+    __at_align32__ double tmp[4];
+    store(tmp);
+    for (int64_t i = 0; i < 4; i++) {
+      tmp[i] = f(tmp[i]);
+    }
+    return loadu(tmp);
+  }
+  // For the SLEEF functions. The NEON intrinsics are called directly, since
+  // GCC's are inline only and their address can't be taken.
+  Vec256<double> map(float64x2_t (*f)(float64x2_t)) const {
+    return Vec256<double>(f(values.val[0]), f(values.val[1]));
+  }
+  Vec256<double> abs() const {
+    return Vec256<double>(vabsq_f64(values.val[0]), vabsq_f64(values.val[1]));
+  }
+  Vec256<double> acos() const {
+    return map(Sleef_acosd2_u10);
+  }
+  Vec256<double> asin() const {
+    return map(Sleef_asind2_u10);
+  }
+  Vec256<double> atan() const {
+    return map(Sleef_atand2_u10);
+  }
+  Vec256<double> erf() const {
+    return map(Sleef_erfd2_u10);
+  }
+  Vec256<double> erfc() const {
+    return map(Sleef_erfcd2_u15);
+  }
+  Vec256<double> exp() const {
+    return map(Sleef_expd2_u10);
+  }
+  Vec256<double> expm1() const {
+    return map(Sleef_expm1d2_u10);
+  }
+  Vec256<double> log() const {
+    return map(Sleef_logd2_u10);
+  }
+  Vec256<double> log2() const {
+    return map(Sleef_log2d2_u10);
+  }
+  Vec256<double> log10() const {
+    return map(Sleef_log10d2_u10);
+  }
+  Vec256<double> log1p() const {
+    return map(Sleef_log1pd2_u10);
+  }
+  Vec256<double> lgamma() const {
+    return map(Sleef_lgammad2_u10);
+  }
+  Vec256<double> sin() const {
+    return map(Sleef_sind2_u10);
+  }
+  Vec256<double> sinh() const {
+    return map(Sleef_sinhd2_u10);
+  }
+  Vec256<double> cos() const {
+    return map(Sleef_cosd2_u10);
+  }
+  Vec256<double> cosh() const {
+    return map(Sleef_coshd2_u10);
+  }
+  Vec256<double> ceil() const {
+    return Vec256<double>(vrndpq_f64(values.val[0]), vrndpq_f64(values.val[1]));
+  }
+  Vec256<double> floor() const {
+    return Vec256<double>(vrndmq_f64(values.val[0]), vrndmq_f64(values.val[1]));
+  }
+  Vec256<double> neg() const {
+    return Vec256<double>(vnegq_f64(values.val[0]), vnegq_f64(values.val[1]));
+  }
+  // Ties to even, like the AVX specialization.
+  Vec256<double> round() const {
+    return Vec256<double>(vrndnq_f64(values.val[0]), vrndnq_f64(values.val[1]));
+  }
+  Vec256<double> tan() const {
+    return map(Sleef_tand2_u10);
+  }
+  Vec256<double> tanh() const {
+    return map(Sleef_tanhd2_u10);
+  }
+  Vec256<double> trunc() const {
+    return Vec256<double>(vrndq_f64(values.val[0]), vrndq_f64(values.val[1]));
+  }
+  Vec256<double> sqrt() const {
+    return Vec256<double>(vsqrtq_f64(values.val[0]), vsqrtq_f64(values.val[1]));
+  }
+  Vec256<double> reciprocal() const {
+    const float64x2_t one = vdupq_n_f64(1);
+    return Vec256<double>(
+        vdivq_f64(one, values.val[0]), vdivq_f64(one, values.val[1]));
+  }
+  Vec256<double> rsqrt() const {
+    return sqrt().reciprocal();
+  }
+};
+
+template <>
+Vec256<double> inline operator+(const Vec256<double>& a, const Vec256<double>& b) {
+  return Vec256<double>(vaddq_f64(a.lo(), b.lo()), vaddq_f64(a.hi(), b.hi()));
+}
+
+template <>
+Vec256<double> inline operator-(const Vec256<double>& a, const Vec256<double>& b) {
+  return Vec256<double>(vsubq_f64(a.lo(), b.lo()), vsubq_f64(a.hi(), b.hi()));
+}
+
+template <>
+Vec256<double> inline operator*(const Vec256<double>& a, const Vec256<double>& b) {
+  return Vec256<double>(vmulq_f64(a.lo(), b.lo()), vmulq_f64(a.hi(), b.hi()));
+}
+
+template <>
+Vec256<double> inline operator/(const Vec256<double>& a, const Vec256<double>& b) {
+  return Vec256<double>(vdivq_f64(a.lo(), b.lo()), vdivq_f64(a.hi(), b.hi()));
+}
+
+// Unlike the x86 instructions, FMAX and FMIN return NaN if either operand is
+// NaN, which is what clamp, clamp_min and clamp_max need for `a`.
+template <>
+Vec256<double> inline max(const Vec256<double>& a, const Vec256<double>& b) {
+  return Vec256<double>(vmaxq_f64(a.lo(), b.lo()), vmaxq_f64(a.hi(), b.hi()));
+}
+
+template <>
+Vec256<double> inline clamp(const Vec256<double>& a, const Vec256<double>& min, const Vec256<double>& max) {
+  return Vec256<double>(
+      vminq_f64(max.lo(), vmaxq_f64(min.lo(), a.lo())),
+      vminq_f64(max.hi(), vmaxq_f64(min.hi(), a.hi())));
+}
+
+template <>
+Vec256<double> inline clamp_max(const Vec256<double>& a, const Vec256<double>& max) {
+  return Vec256<double>(vminq_f64(max.lo(), a.lo()), vminq_f64(max.hi(), a.hi()));
+}
+
+template <>
+Vec256<double> inline clamp_min(const Vec256<double>& a, const Vec256<double>& min) {
+  return Vec256<double>(vmaxq_f64(min.lo(), a.lo()), vmaxq_f64(min.hi(), a.hi()));
+}
+
+template <>
+Vec256<double> inline fmadd(const Vec256<double>& a, const Vec256<double>& b, const Vec256<double>& c) {
+  return Vec256<double>(
+      vfmaq_f64(c.lo(), a.lo(), b.lo()), vfmaq_f64(c.hi(), a.hi(), b.hi()));
+}
+
+#endif
+
+}}}
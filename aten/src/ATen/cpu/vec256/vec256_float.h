@@ -114,17 +114,20 @@ public:
   Vec256<float> log1p() const {
     return Vec256<float>(Sleef_log1pf8_u10(values));
   }
+  Vec256<float> lgamma() const {
+    return Vec256<float>(Sleef_lgammaf8_u10(values));
+  }
   Vec256<float> sin() const {
-    return map(std::sin);
+    return Vec256<float>(Sleef_sinf8_u10(values));
   }
   Vec256<float> sinh() const {
-    return map(std::sinh);
+    return Vec256<float>(Sleef_sinhf8_u10(values));
   }
   Vec256<float> cos() const {
-    return map(std::cos);
+    return Vec256<float>(Sleef_cosf8_u10(values));
   }
   Vec256<float> cosh() const {
-    return map(std::cosh);
+    return Vec256<float>(Sleef_coshf8_u10(values));
   }
   Vec256<float> ceil() const {
     return _mm256_ceil_ps(values);
@@ -139,7 +142,7 @@ public:
     return _mm256_round_ps(values, (_MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
   }
   Vec256<float> tan() const {
-    return map(std::tan);
+    return Vec256<float>(Sleef_tanf8_u10(values));
   }
   Vec256<float> tanh() const {
     return Vec256<float>(Sleef_tanhf8_u10(values));
@@ -183,6 +186,23 @@ Vec256<float> inline max(const Vec256<float>& a, const Vec256<float>& b) {
   return _mm256_max_ps(a, b);
 }
 
+// The min/max instructions return the second operand if either one is NaN.
+template <>
+Vec256<float> inline clamp(const Vec256<float>& a, const Vec256<float>& min, const Vec256<float>& max) {
+  return _mm256_blendv_ps(
+      _mm256_min_ps(max, a), min, _mm256_cmp_ps(a, min, _CMP_LT_OQ));
+}
+
+template <>
+Vec256<float> inline clamp_max(const Vec256<float>& a, const Vec256<float>& max) {
+  return _mm256_min_ps(max, a);
+}
+
+template <>
+Vec256<float> inline clamp_min(const Vec256<float>& a, const Vec256<float>& min) {
+  return _mm256_max_ps(min, a);
+}
+
 #ifdef __AVX2__
 template <>
 Vec256<float> fmadd(const Vec256<float>& a, const Vec256<float>& b, const Vec256<float>& c) {
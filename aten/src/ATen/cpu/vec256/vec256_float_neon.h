@@ -0,0 +1,235 @@
+#pragma once
+
+#include "intrinsics.h"
+#include "vec256_base.h"
+#if defined(__aarch64__) && defined(__ARM_NEON) && !defined(_MSC_VER)
+#include <sleef.h>
+#endif
+
+namespace at {
+namespace vec256 {
+namespace {
+
+// AdvSIMD (NEON) is part of the AArch64 base ISA, so the DEFAULT capability
+// uses it on ARM64 and no separate dispatch level is needed. A Vec256<float>
+// is a pair of 128-bit registers.
+
+#if defined(__aarch64__) && defined(__ARM_NEON) && !defined(_MSC_VER)
+
+template <> class Vec256<float> {
+private:
+  float32x4x2_t values;
+  static uint32x4_t lane_mask(int64_t mask) {
+    const uint32_t lanes[4] = {
+        mask & 1 ? ~0u : 0u,
+        mask & 2 ? ~0u : 0u,
+        mask & 4 ? ~0u : 0u,
+        mask & 8 ? ~0u : 0u};
+    return vld1q_u32(lanes);
+  }
+public:
+  static constexpr int64_t size = 8;
+  Vec256() {}
+  Vec256(float32x4_t lo, float32x4_t hi) {
+    values.val[0] = lo;
+    values.val[1] = hi;
+  }
+  Vec256(float val) {
+    values.val[0] = vdupq_n_f32(val);
+    values.val[1] = vdupq_n_f32(val);
+  }
+  float32x4_t lo() const {
+    return values.val[0];
+  }
+  float32x4_t hi() const {
+    return values.val[1];
+  }
+  template <int64_t mask>
+  static Vec256<float> blend(Vec256<float> a, Vec256<float> b) {
+    return Vec256<float>(
+        vbslq_f32(lane_mask(mask), b.lo(), a.lo()),
+        vbslq_f32(lane_mask(mask >> 4), b.hi(), a.hi()));
+  }
+  static Vec256<float> set(Vec256<float> a, Vec256<float> b, int64_t count = size) {
+    const uint32_t lanes[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+    const uint32x4_t n = vdupq_n_u32(static_cast<uint32_t>(count));
+    return Vec256<float>(
+        vbslq_f32(vcltq_u32(vld1q_u32(lanes), n), b.lo(), a.lo()),
+        vbslq_f32(vcltq_u32(vld1q_u32(lanes + 4), n), b.hi(), a.hi()));
+  }
+  static Vec256<float> loadu(const void* ptr, int64_t count = size) {
+    if (count == size) {
+      const float* p = reinterpret_cast<const float*>(ptr);
+      return Vec256<float>(vld1q_f32(p), vld1q_f32(p + 4));
+    }
+    __at_align32__ float tmp_values[size] = {0};
+    std::memcpy(
+        tmp_values, reinterpret_cast<const float*>(ptr), count * sizeof(float));
+    return Vec256<float>(vld1q_f32(tmp_values), vld1q_f32(tmp_values + 4));
+  }
+  void store(void* ptr, int64_t count = size) const {
+    if (count == size) {
+      float* p = reinterpret_cast<float*>(ptr);
+      vst1q_f32(p, values.val[0]);
+      vst1q_f32(p + 4, values.val[1]);
+    } else {
+      float tmp_values[size];
+      vst1q_f32(tmp_values, values.val[0]);
+      vst1q_f32(tmp_values + 4, values.val[1]);
+      std::memcpy(ptr, tmp_values, count * sizeof(float));
+    }
+  }
+  const float& operator[](int idx) const  = delete;
+  float& operator[](int idx) = delete;
+  Vec256<float> map(float (*f)(float)) const {
+    __at_align32__ float tmp[8];
+    store(tmp);
+    for (int64_t i = 0; i < 8; i++) {
+      tmp[i] = f(tmp[i]);
+    }
+    return loadu(tmp);
+  }
+  // For the SLEEF functions. The NEON intrinsics are called directly, since
+  // GCC's are inline only and their address can't be taken.
+  Vec256<float> map(float32x4_t (*f)(float32x4_t)) const {
+    return Vec256<float>(f(values.val[0]), f(values.val[1]));
+  }
+  Vec256<float> abs() const {
+    return Vec256<float>(vabsq_f32(values.val[0]), vabsq_f32(values.val[1]));
+  }
+  Vec256<float> acos() const {
+    return map(Sleef_acosf4_u10);
+  }
+  Vec256<float> asin() const {
+    return map(Sleef_asinf4_u10);
+  }
+  Vec256<float> atan() const {
+    return map(Sleef_atanf4_u10);
+  }
+  Vec256<float> erf() const {
+    return map(Sleef_erff4_u10);
+  }
+  Vec256<float> erfc() const {
+    return map(Sleef_erfcf4_u15);
+  }
+  Vec256<float> exp() const {
+    return map(Sleef_expf4_u10);
+  }
+  Vec256<float> expm1() const {
+    return map(Sleef_expm1f4_u10);
+  }
+  Vec256<float> log() const {
+    return map(Sleef_logf4_u10);
+  }
+  Vec256<float> log2() const {
+    return map(Sleef_log2f4_u10);
+  }
+  Vec256<float> log10() const {
+    return map(Sleef_log10f4_u10);
+  }
+  Vec256<float> log1p() const {
+    return map(Sleef_log1pf4_u10);
+  }
+  Vec256<float> lgamma() const {
+    return map(Sleef_lgammaf4_u10);
+  }
+  Vec256<float> sin() const {
+    return map(Sleef_sinf4_u10);
+  }
+  Vec256<float> sinh() const {
+    return map(Sleef_sinhf4_u10);
+  }
+  Vec256<float> cos() const {
+    return map(Sleef_cosf4_u10);
+  }
+  Vec256<float> cosh() const {
+    return map(Sleef_coshf4_u10);
+  }
+  Vec256<float> ceil() const {
+    return Vec256<float>(vrndpq_f32(values.val[0]), vrndpq_f32(values.val[1]));
+  }
+  Vec256<float> floor() const {
+    return Vec256<float>(vrndmq_f32(values.val[0]), vrndmq_f32(values.val[1]));
+  }
+  Vec256<float> neg() const {
+    return Vec256<float>(vnegq_f32(values.val[0]), vnegq_f32(values.val[1]));
+  }
+  // Ties to even, like the AVX specialization.
+  Vec256<float> round() const {
+    return Vec256<float>(vrndnq_f32(values.val[0]), vrndnq_f32(values.val[1]));
+  }
+  Vec256<float> tan() const {
+    return map(Sleef_tanf4_u10);
+  }
+  Vec256<float> tanh() const {
+    return map(Sleef_tanhf4_u10);
+  }
+  Vec256<float> trunc() const {
+    return Vec256<float>(vrndq_f32(values.val[0]), vrndq_f32(values.val[1]));
+  }
+  Vec256<float> sqrt() const {
+    return Vec256<float>(vsqrtq_f32(values.val[0]), vsqrtq_f32(values.val[1]));
+  }
+  Vec256<float> reciprocal() const {
+    const float32x4_t one = vdupq_n_f32(1);
+    return Vec256<float>(
+        vdivq_f32(one, values.val[0]), vdivq_f32(one, values.val[1]));
+  }
+  Vec256<float> rsqrt() const {
+    return sqrt().reciprocal();
+  }
+};
+
+template <>
+Vec256<float> inline operator+(const Vec256<float>& a, const Vec256<float>& b) {
+  return Vec256<float>(vaddq_f32(a.lo(), b.lo()), vaddq_f32(a.hi(), b.hi()));
+}
+
+template <>
+Vec256<float> inline operator-(const Vec256<float>& a, const Vec256<float>& b) {
+  return Vec256<float>(vsubq_f32(a.lo(), b.lo()), vsubq_f32(a.hi(), b.hi()));
+}
+
+template <>
+Vec256<float> inline operator*(const Vec256<float>& a, const Vec256<float>& b) {
+  return Vec256<float>(vmulq_f32(a.lo(), b.lo()), vmulq_f32(a.hi(), b.hi()));
+}
+
+template <>
+Vec256<float> inline operator/(const Vec256<float>& a, const Vec256<float>& b) {
+  return Vec256<float>(vdivq_f32(a.lo(), b.lo()), vdivq_f32(a.hi(), b.hi()));
+}
+
+// Unlike the x86 instructions, FMAX and FMIN return NaN if either operand is
+// NaN, which is what clamp, clamp_min and clamp_max need for `a`.
+template <>
+Vec256<float> inline max(const Vec256<float>& a, const Vec256<float>& b) {
+  return Vec256<float>(vmaxq_f32(a.lo(), b.lo()), vmaxq_f32(a.hi(), b.hi()));
+}
+
+template <>
+Vec256<float> inline clamp(const Vec256<float>& a, const Vec256<float>& min, const Vec256<float>& max) {
+  return Vec256<float>(
+      vminq_f32(max.lo(), vmaxq_f32(min.lo(), a.lo())),
+      vminq_f32(max.hi(), vmaxq_f32(min.hi(), a.hi())));
+}
+
+template <>
+Vec256<float> inline clamp_max(const Vec256<float>& a, const Vec256<float>& max) {
+  return Vec256<float>(vminq_f32(max.lo(), a.lo()), vminq_f32(max.hi(), a.hi()));
+}
+
+template <>
+Vec256<float> inline clamp_min(const Vec256<float>& a, const Vec256<float>& min) {
+  return Vec256<float>(vmaxq_f32(min.lo(), a.lo()), vmaxq_f32(min.hi(), a.hi()));
+}
+
+template <>
+Vec256<float> inline fmadd(const Vec256<float>& a, const Vec256<float>& b, const Vec256<float>& c) {
+  return Vec256<float>(
+      vfmaq_f32(c.lo(), a.lo(), b.lo()), vfmaq_f32(c.hi(), a.hi(), b.hi()));
+}
+
+#endif
+
+}}}
@@ -0,0 +1,87 @@
+#pragma once
+
+// Conversions between float and the 16-bit floating point types, Half and
+// BFloat16, for kernels that load reduced precision, compute in float and
+// store reduced precision again. With AVX2 they convert 8 elements at a
+// time, using F16C for Half (every AVX2 CPU has it).
+
+#include "intrinsics.h"
+
+#include <ATen/core/BFloat16.h>
+#include <ATen/core/Half.h>
+
+#include <cstdint>
+
+namespace at {
+namespace vec256 {
+namespace {
+
+inline void convert(const Half* src, float* dst, int64_t n) {
+  int64_t i = 0;
+#if defined(__AVX2__) && defined(__F16C__) && !defined(_MSC_VER)
+  for (; i + 8 <= n; i += 8) {
+    __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+  }
+#endif
+  for (; i < n; i++) {
+    dst[i] = static_cast<float>(src[i]);
+  }
+}
+
+inline void convert(const float* src, Half* dst, int64_t n) {
+  int64_t i = 0;
+#if defined(__AVX2__) && defined(__F16C__) && !defined(_MSC_VER)
+  for (; i + 8 <= n; i += 8) {
+    __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+  }
+#endif
+  for (; i < n; i++) {
+    dst[i] = static_cast<Half>(src[i]);
+  }
+}
+
+inline void convert(const BFloat16* src, float* dst, int64_t n) {
+  int64_t i = 0;
+#if defined(__AVX2__) && !defined(_MSC_VER)
+  for (; i + 8 <= n; i += 8) {
+    // widen to 32 bits and move the bits up to the top half
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m256i f = _mm256_slli_epi32(_mm256_cvtepu16_epi32(b), 16);
+    _mm256_storeu_ps(dst + i, _mm256_castsi256_ps(f));
+  }
+#endif
+  for (; i < n; i++) {
+    dst[i] = static_cast<float>(src[i]);
+  }
+}
+
+inline void convert(const float* src, BFloat16* dst, int64_t n) {
+  int64_t i = 0;
+#if defined(__AVX2__) && !defined(_MSC_VER)
+  const __m256i ones = _mm256_set1_epi32(1);
+  const __m256i bias = _mm256_set1_epi32(0x7fff);
+  const __m256i quiet = _mm256_set1_epi32(0x00400000);
+  for (; i + 8 <= n; i += 8) {
+    __m256 f = _mm256_loadu_ps(src + i);
+    __m256i bits = _mm256_castps_si256(f);
+    // round to nearest even, as detail::float2bfloat16bits does
+    __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(bits, 16), ones);
+    __m256i rounded = _mm256_add_epi32(bits, _mm256_add_epi32(bias, lsb));
+    // NaNs are truncated instead, with a mantissa bit set to keep them NaN
+    __m256i nan_mask = _mm256_castps_si256(_mm256_cmp_ps(f, f, _CMP_UNORD_Q));
+    __m256i nan = _mm256_or_si256(bits, quiet);
+    __m256i result = _mm256_srli_epi32(_mm256_blendv_epi8(rounded, nan, nan_mask), 16);
+    // pack the low 16 bits of the 8 lanes; packus works within 128-bit lanes
+    __m256i packed = _mm256_packus_epi32(result, result);
+    packed = _mm256_permute4x64_epi64(packed, 0x08);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm256_castsi256_si128(packed));
+  }
+#endif
+  for (; i < n; i++) {
+    dst[i] = static_cast<BFloat16>(src[i]);
+  }
+}
+
+}}}
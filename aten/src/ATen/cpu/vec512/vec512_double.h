@@ -0,0 +1,190 @@
+#pragma once
+
+#include "ATen/cpu/vec256/intrinsics.h"
+#include "vec512_base.h"
+
+namespace at {
+namespace vec512 {
+namespace {
+
+#if defined(__AVX512F__) && !defined(_MSC_VER)
+
+template <> class Vec512<double> {
+private:
+  __m512d values;
+public:
+  static constexpr int size = 8;
+  Vec512() {}
+  Vec512(__m512d v) : values(v) {}
+  Vec512(double val) {
+    values = _mm512_set1_pd(val);
+  }
+  operator __m512d() const {
+    return values;
+  }
+  template <int64_t mask>
+  static Vec512<double> blend(Vec512<double> a, Vec512<double> b) {
+    return _mm512_mask_blend_pd(mask, a.values, b.values);
+  }
+  static Vec512<double> set(Vec512<double> a, Vec512<double> b, int64_t count = size) {
+    return _mm512_mask_blend_pd((__mmask8)((1ULL << count) - 1), a.values, b.values);
+  }
+  // Masked loads and stores do not touch the memory of the masked out
+  // elements, so partial vectors don't need to go through a buffer.
+  static Vec512<double> loadu(const void* ptr, int64_t count = size) {
+    if (count == size)
+      return _mm512_loadu_pd(ptr);
+    return _mm512_maskz_loadu_pd((__mmask8)((1ULL << count) - 1), ptr);
+  }
+  void store(void* ptr, int64_t count = size) const {
+    if (count == size) {
+      _mm512_storeu_pd(ptr, values);
+    } else {
+      _mm512_mask_storeu_pd(ptr, (__mmask8)((1ULL << count) - 1), values);
+    }
+  }
+  const double& operator[](int idx) const  = delete;
+  double& operator[](int idx) = delete;
+  Vec512<double> map(double (*f)(double)) const {
+    __at_align64__ double tmp[size];
+    store(tmp);
+    for (int64_t i = 0; i < size; i++) {
+      tmp[i] = f(tmp[i]);
+    }
+    return loadu(tmp);
+  }
+  Vec512<double> abs() const {
+    return _mm512_abs_pd(values);
+  }
+  Vec512<double> acos() const {
+    return map(std::acos);
+  }
+  Vec512<double> asin() const {
+    return map(std::asin);
+  }
+  Vec512<double> atan() const {
+    return map(std::atan);
+  }
+  Vec512<double> erf() const {
+    return map(std::erf);
+  }
+  Vec512<double> erfc() const {
+    return map(std::erfc);
+  }
+  Vec512<double> exp() const {
+    return map(std::exp);
+  }
+  Vec512<double> expm1() const {
+    return map(std::expm1);
+  }
+  Vec512<double> log() const {
+    return map(std::log);
+  }
+  Vec512<double> log2() const {
+    return map(std::log2);
+  }
+  Vec512<double> log10() const {
+    return map(std::log10);
+  }
+  Vec512<double> log1p() const {
+    return map(std::log1p);
+  }
+  Vec512<double> lgamma() const {
+    return map(std::lgamma);
+  }
+  Vec512<double> sin() const {
+    return map(std::sin);
+  }
+  Vec512<double> sinh() const {
+    return map(std::sinh);
+  }
+  Vec512<double> cos() const {
+    return map(std::cos);
+  }
+  Vec512<double> cosh() const {
+    return map(std::cosh);
+  }
+  Vec512<double> ceil() const {
+    return _mm512_roundscale_pd(values, (_MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC));
+  }
+  Vec512<double> floor() const {
+    return _mm512_roundscale_pd(values, (_MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC));
+  }
+  Vec512<double> neg() const {
+    // AVX512F has no floating point xor, flip the sign bit as integers
+    return _mm512_castsi512_pd(_mm512_xor_si512(
+        _mm512_castpd_si512(values), _mm512_castpd_si512(_mm512_set1_pd(-0.))));
+  }
+  Vec512<double> round() const {
+    return _mm512_roundscale_pd(values, (_MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+  }
+  Vec512<double> tan() const {
+    return map(std::tan);
+  }
+  Vec512<double> tanh() const {
+    return map(std::tanh);
+  }
+  Vec512<double> trunc() const {
+    return _mm512_roundscale_pd(values, (_MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC));
+  }
+  Vec512<double> sqrt() const {
+    return _mm512_sqrt_pd(values);
+  }
+  Vec512<double> reciprocal() const {
+    return _mm512_div_pd(_mm512_set1_pd(1), values);
+  }
+  Vec512<double> rsqrt() const {
+    return _mm512_div_pd(_mm512_set1_pd(1), _mm512_sqrt_pd(values));
+  }
+};
+
+template <>
+Vec512<double> inline operator+(const Vec512<double>& a, const Vec512<double>& b) {
+  return _mm512_add_pd(a, b);
+}
+
+template <>
+Vec512<double> inline operator-(const Vec512<double>& a, const Vec512<double>& b) {
+  return _mm512_sub_pd(a, b);
+}
+
+template <>
+Vec512<double> inline operator*(const Vec512<double>& a, const Vec512<double>& b) {
+  return _mm512_mul_pd(a, b);
+}
+
+template <>
+Vec512<double> inline operator/(const Vec512<double>& a, const Vec512<double>& b) {
+  return _mm512_div_pd(a, b);
+}
+
+template <>
+Vec512<double> inline max(const Vec512<double>& a, const Vec512<double>& b) {
+  return _mm512_max_pd(a, b);
+}
+
+// The min/max instructions return the second operand if either one is NaN.
+template <>
+Vec512<double> inline clamp(const Vec512<double>& a, const Vec512<double>& min, const Vec512<double>& max) {
+  return _mm512_mask_blend_pd(
+      _mm512_cmp_pd_mask(a, min, _CMP_LT_OQ), _mm512_min_pd(max, a), min);
+}
+
+template <>
+Vec512<double> inline clamp_max(const Vec512<double>& a, const Vec512<double>& max) {
+  return _mm512_min_pd(max, a);
+}
+
+template <>
+Vec512<double> inline clamp_min(const Vec512<double>& a, const Vec512<double>& min) {
+  return _mm512_max_pd(min, a);
+}
+
+template <>
+Vec512<double> inline fmadd(const Vec512<double>& a, const Vec512<double>& b, const Vec512<double>& c) {
+  return _mm512_fmadd_pd(a, b, c);
+}
+
+#endif
+
+}}}
@@ -0,0 +1,190 @@
+#pragma once
+
+#include "ATen/cpu/vec256/intrinsics.h"
+#include "vec512_base.h"
+
+namespace at {
+namespace vec512 {
+namespace {
+
+#if defined(__AVX512F__) && !defined(_MSC_VER)
+
+template <> class Vec512<float> {
+private:
+  __m512 values;
+public:
+  static constexpr int size = 16;
+  Vec512() {}
+  Vec512(__m512 v) : values(v) {}
+  Vec512(float val) {
+    values = _mm512_set1_ps(val);
+  }
+  operator __m512() const {
+    return values;
+  }
+  template <int64_t mask>
+  static Vec512<float> blend(Vec512<float> a, Vec512<float> b) {
+    return _mm512_mask_blend_ps(mask, a.values, b.values);
+  }
+  static Vec512<float> set(Vec512<float> a, Vec512<float> b, int64_t count = size) {
+    return _mm512_mask_blend_ps((__mmask16)((1ULL << count) - 1), a.values, b.values);
+  }
+  // Masked loads and stores do not touch the memory of the masked out
+  // elements, so partial vectors don't need to go through a buffer.
+  static Vec512<float> loadu(const void* ptr, int64_t count = size) {
+    if (count == size)
+      return _mm512_loadu_ps(ptr);
+    return _mm512_maskz_loadu_ps((__mmask16)((1ULL << count) - 1), ptr);
+  }
+  void store(void* ptr, int64_t count = size) const {
+    if (count == size) {
+      _mm512_storeu_ps(ptr, values);
+    } else {
+      _mm512_mask_storeu_ps(ptr, (__mmask16)((1ULL << count) - 1), values);
+    }
+  }
+  const float& operator[](int idx) const  = delete;
+  float& operator[](int idx) = delete;
+  Vec512<float> map(float (*f)(float)) const {
+    __at_align64__ float tmp[size];
+    store(tmp);
+    for (int64_t i = 0; i < size; i++) {
+      tmp[i] = f(tmp[i]);
+    }
+    return loadu(tmp);
+  }
+  Vec512<float> abs() const {
+    return _mm512_abs_ps(values);
+  }
+  Vec512<float> acos() const {
+    return map(std::acos);
+  }
+  Vec512<float> asin() const {
+    return map(std::asin);
+  }
+  Vec512<float> atan() const {
+    return map(std::atan);
+  }
+  Vec512<float> erf() const {
+    return map(std::erf);
+  }
+  Vec512<float> erfc() const {
+    return map(std::erfc);
+  }
+  Vec512<float> exp() const {
+    return map(std::exp);
+  }
+  Vec512<float> expm1() const {
+    return map(std::expm1);
+  }
+  Vec512<float> log() const {
+    return map(std::log);
+  }
+  Vec512<float> log2() const {
+    return map(std::log2);
+  }
+  Vec512<float> log10() const {
+    return map(std::log10);
+  }
+  Vec512<float> log1p() const {
+    return map(std::log1p);
+  }
+  Vec512<float> lgamma() const {
+    return map(std::lgamma);
+  }
+  Vec512<float> sin() const {
+    return map(std::sin);
+  }
+  Vec512<float> sinh() const {
+    return map(std::sinh);
+  }
+  Vec512<float> cos() const {
+    return map(std::cos);
+  }
+  Vec512<float> cosh() const {
+    return map(std::cosh);
+  }
+  Vec512<float> ceil() const {
+    return _mm512_roundscale_ps(values, (_MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC));
+  }
+  Vec512<float> floor() const {
+    return _mm512_roundscale_ps(values, (_MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC));
+  }
+  Vec512<float> neg() const {
+    // AVX512F has no floating point xor, flip the sign bit as integers
+    return _mm512_castsi512_ps(_mm512_xor_si512(
+        _mm512_castps_si512(values), _mm512_castps_si512(_mm512_set1_ps(-0.))));
+  }
+  Vec512<float> round() const {
+    return _mm512_roundscale_ps(values, (_MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+  }
+  Vec512<float> tan() const {
+    return map(std::tan);
+  }
+  Vec512<float> tanh() const {
+    return map(std::tanh);
+  }
+  Vec512<float> trunc() const {
+    return _mm512_roundscale_ps(values, (_MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC));
+  }
+  Vec512<float> sqrt() const {
+    return _mm512_sqrt_ps(values);
+  }
+  Vec512<float> reciprocal() const {
+    return _mm512_div_ps(_mm512_set1_ps(1), values);
+  }
+  Vec512<float> rsqrt() const {
+    return _mm512_div_ps(_mm512_set1_ps(1), _mm512_sqrt_ps(values));
+  }
+};
+
+template <>
+Vec512<float> inline operator+(const Vec512<float>& a, const Vec512<float>& b) {
+  return _mm512_add_ps(a, b);
+}
+
+template <>
+Vec512<float> inline operator-(const Vec512<float>& a, const Vec512<float>& b) {
+  return _mm512_sub_ps(a, b);
+}
+
+template <>
+Vec512<float> inline operator*(const Vec512<float>& a, const Vec512<float>& b) {
+  return _mm512_mul_ps(a, b);
+}
+
+template <>
+Vec512<float> inline operator/(const Vec512<float>& a, const Vec512<float>& b) {
+  return _mm512_div_ps(a, b);
+}
+
+template <>
+Vec512<float> inline max(const Vec512<float>& a, const Vec512<float>& b) {
+  return _mm512_max_ps(a, b);
+}
+
+// The min/max instructions return the second operand if either one is NaN.
+template <>
+Vec512<float> inline clamp(const Vec512<float>& a, const Vec512<float>& min, const Vec512<float>& max) {
+  return _mm512_mask_blend_ps(
+      _mm512_cmp_ps_mask(a, min, _CMP_LT_OQ), _mm512_min_ps(max, a), min);
+}
+
+template <>
+Vec512<float> inline clamp_max(const Vec512<float>& a, const Vec512<float>& max) {
+  return _mm512_min_ps(max, a);
+}
+
+template <>
+Vec512<float> inline clamp_min(const Vec512<float>& a, const Vec512<float>& min) {
+  return _mm512_max_ps(min, a);
+}
+
+template <>
+Vec512<float> inline fmadd(const Vec512<float>& a, const Vec512<float>& b, const Vec512<float>& c) {
+  return _mm512_fmadd_ps(a, b, c);
+}
+
+#endif
+
+}}}
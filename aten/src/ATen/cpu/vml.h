@@ -52,9 +52,18 @@ namespace {
 
 using namespace vec256;
 
+// Relative costs per element of the operations, used as their parallel_for
+// cost hints (see ParallelCostHint). Rounding and sign operations cost about
+// as much as a copy, sqrt and division a few times more and the
+// transcendental functions, which are evaluated with polynomials, about 16.
+constexpr double kCheapCost = 1;
+constexpr double kSqrtCost = 4;
+constexpr double kTranscendentalCost = 16;
+
 template <typename scalar_t>
 inline void vrsqrt(scalar_t* out, scalar_t* in, int64_t size) {
-  parallel_for(0, size, 2048, [out, in](int64_t begin, int64_t end) {
+  constexpr ParallelCostHint hint{"vml::rsqrt", kSqrtCost};
+  parallel_for(0, size, hint, [out, in](int64_t begin, int64_t end) {
     map(
         [](const Vec256<scalar_t>& x) {
           return Vec256<scalar_t>((scalar_t)(1)) / x.sqrt();
@@ -73,11 +82,12 @@ inline void vrsqrt(scalar_t* out, scalar_t* in, int64_t size) {
 // this. This duplication is also necessary since not all functions (e.g. rsqrt)
 // might be part of cmath.
 
-#define IMPLEMENT_VML_BUG(op)                                          \
+#define IMPLEMENT_VML_BUG(op, cost)                                     \
   template <typename scalar_t>                                          \
   inline void v##op(scalar_t* out, const scalar_t* in, int64_t size) {  \
     DL_RUNTIME_BUG(op, scalar_t)                                        \
-    parallel_for(0, size, 2048, [out, in](int64_t begin, int64_t end) { \
+    constexpr ParallelCostHint hint{"vml::" #op, cost};                 \
+    parallel_for(0, size, hint, [out, in](int64_t begin, int64_t end) { \
       map([](const Vec256<scalar_t>& x) { return x.op(); },             \
           out + begin,                                                  \
           in + begin,                                                   \
@@ -85,10 +95,11 @@ inline void vrsqrt(scalar_t* out, scalar_t* in, int64_t size) {
     });                                                                 \
   }
 
-#define IMPLEMENT_VML(op)                                              \
+#define IMPLEMENT_VML(op, cost)                                         \
   template <typename scalar_t>                                          \
   inline void v##op(scalar_t* out, const scalar_t* in, int64_t size) {  \
-    parallel_for(0, size, 2048, [out, in](int64_t begin, int64_t end) { \
+    constexpr ParallelCostHint hint{"vml::" #op, cost};                 \
+    parallel_for(0, size, hint, [out, in](int64_t begin, int64_t end) { \
       map([](const Vec256<scalar_t>& x) { return x.op(); },             \
           out + begin,                                                  \
           in + begin,                                                   \
@@ -96,32 +107,33 @@ inline void vrsqrt(scalar_t* out, scalar_t* in, int64_t size) {
     });                                                                 \
   }
 
-IMPLEMENT_VML_BUG(abs)
-IMPLEMENT_VML_BUG(acos)
-IMPLEMENT_VML_BUG(asin)
-IMPLEMENT_VML_BUG(atan)
-IMPLEMENT_VML_BUG(ceil)
-IMPLEMENT_VML_BUG(cos)
-// IMPLEMENT_VML_BUG(cosh)
-IMPLEMENT_VML_BUG(erf)
-IMPLEMENT_VML_BUG(erfc)
-IMPLEMENT_VML_BUG(exp)
-IMPLEMENT_VML_BUG(expm1)
-IMPLEMENT_VML_BUG(floor)
-IMPLEMENT_VML(reciprocal)
-IMPLEMENT_VML_BUG(log)
-IMPLEMENT_VML_BUG(log10)
-IMPLEMENT_VML_BUG(log1p)
-IMPLEMENT_VML_BUG(log2)
-IMPLEMENT_VML(neg)
-IMPLEMENT_VML_BUG(sin)
-// IMPLEMENT_VML_BUG(sinh)
-IMPLEMENT_VML_BUG(sqrt)
-IMPLEMENT_VML_BUG(round)
-IMPLEMENT_VML(rsqrt)
-IMPLEMENT_VML_BUG(tan)
-IMPLEMENT_VML_BUG(tanh)
-IMPLEMENT_VML_BUG(trunc)
+IMPLEMENT_VML_BUG(abs, kCheapCost)
+IMPLEMENT_VML_BUG(acos, kTranscendentalCost)
+IMPLEMENT_VML_BUG(asin, kTranscendentalCost)
+IMPLEMENT_VML_BUG(atan, kTranscendentalCost)
+IMPLEMENT_VML_BUG(ceil, kCheapCost)
+IMPLEMENT_VML_BUG(cos, kTranscendentalCost)
+IMPLEMENT_VML_BUG(cosh, kTranscendentalCost)
+IMPLEMENT_VML_BUG(erf, kTranscendentalCost)
+IMPLEMENT_VML_BUG(erfc, kTranscendentalCost)
+IMPLEMENT_VML_BUG(exp, kTranscendentalCost)
+IMPLEMENT_VML_BUG(expm1, kTranscendentalCost)
+IMPLEMENT_VML_BUG(floor, kCheapCost)
+IMPLEMENT_VML(reciprocal, kSqrtCost)
+IMPLEMENT_VML_BUG(lgamma, kTranscendentalCost)
+IMPLEMENT_VML_BUG(log, kTranscendentalCost)
+IMPLEMENT_VML_BUG(log10, kTranscendentalCost)
+IMPLEMENT_VML_BUG(log1p, kTranscendentalCost)
+IMPLEMENT_VML_BUG(log2, kTranscendentalCost)
+IMPLEMENT_VML(neg, kCheapCost)
+IMPLEMENT_VML_BUG(sin, kTranscendentalCost)
+IMPLEMENT_VML_BUG(sinh, kTranscendentalCost)
+IMPLEMENT_VML_BUG(sqrt, kSqrtCost)
+IMPLEMENT_VML_BUG(round, kCheapCost)
+IMPLEMENT_VML(rsqrt, kSqrtCost)
+IMPLEMENT_VML_BUG(tan, kTranscendentalCost)
+IMPLEMENT_VML_BUG(tanh, kTranscendentalCost)
+IMPLEMENT_VML_BUG(trunc, kCheapCost)
 
 #if AT_MKL_ENABLED() && !defined(__APPLE__)
 
@@ -36,6 +36,18 @@ CUDAStream createCUDAStreamWithOptions(int32_t flags, int32_t priority) {
   return detail::CUDAStream_createAndRetainWithOptions(flags, priority);
 }
 
+CUDAStream getStreamFromPool(bool isHighPriority, int64_t device) {
+  return detail::CUDAStream_getStreamFromPool(isHighPriority, device);
+}
+
+void setPerThreadCUDAStreams(bool enabled) {
+  detail::CUDAStream_setPerThreadStreams(enabled);
+}
+
+bool perThreadCUDAStreams() {
+  return detail::CUDAStream_perThreadStreams();
+}
+
 CUDAStream getDefaultCUDAStream() {
   return detail::CUDAStream_getDefaultStream();
 }
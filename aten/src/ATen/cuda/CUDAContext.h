@@ -8,6 +8,7 @@
 #include <cstdint>
 
 #include "cuda_runtime_api.h"
+#include "cublas_v2.h"
 #include "cusparse.h"
 
 namespace at {
@@ -48,6 +49,21 @@ AT_API CUDAStream createCUDAStream();
 
 AT_API CUDAStream createCUDAStreamWithOptions(int32_t flags, int32_t priority);
 
+// Returns a stream from the pool of the device (the current device by
+// default). The pool has a fixed number of low and high priority streams,
+// created on first use and handed out round-robin, so this is much cheaper
+// than creating a stream; streams from the pool may be shared with other
+// callers.
+AT_API CUDAStream getStreamFromPool(bool isHighPriority = false, int64_t device = -1);
+
+// With per-thread streams enabled, the current stream of a thread on a
+// device starts out as a stream from the pool instead of the default
+// stream, so that work submitted from different threads can run
+// concurrently. It only affects threads that haven't used CUDA streams yet.
+AT_API void setPerThreadCUDAStreams(bool enabled);
+
+AT_API bool perThreadCUDAStreams();
+
 AT_API CUDAStream getDefaultCUDAStream();
 
 AT_API CUDAStream getDefaultCUDAStreamOnDevice(int64_t device);
@@ -67,6 +83,15 @@ AT_API void uncheckedSetCurrentCUDAStreamOnDevice(int64_t device, CUDAStream str
   AT_API cusparseHandle_t getCurrentCUDASparseHandle();
 #endif
 
+// Returns the cuBLAS handle for the current device and stream. There is one
+// handle per (device, stream) pair and math mode, created on first use and
+// already bound to its stream, so callers don't call cublasSetStream and
+// threads working on different streams never share a handle. The handle's
+// state must not be changed: use the tensor_op_math handle, which has
+// CUBLAS_TENSOR_OP_MATH set (CUBLAS_TF32_TENSOR_OP_MATH from CUDA 11), instead
+// of toggling cublasSetMathMode.
+AT_API cublasHandle_t getCurrentCUDABlasHandle(bool tensor_op_math = false);
+
 
 } // namespace cuda
 } // namespace at
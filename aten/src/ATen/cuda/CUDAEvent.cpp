@@ -3,6 +3,7 @@
 #include "ATen/cuda/CUDAStream.h"
 #include "ATen/cuda/Exceptions.h"
 #include "ATen/core/Error.h"
+#include "ATen/core/EventPool.h"
 
 #include <mutex>
 #include <atomic>
@@ -11,6 +12,7 @@
 struct CUDAEventInternals {
   std::atomic<int> refcount;
   int64_t device; // Note: cudaGetDevice works with int32_t, not int64_t
+  unsigned int flags;
   cudaEvent_t event;
 };
 
@@ -26,7 +28,17 @@ CUDAEventInternals* CUDAEvent_create(unsigned int flags) {
   std::unique_ptr<CUDAEventInternals> internals { new CUDAEventInternals() };
   internals->refcount = 1;
   internals->device = current_device();
-  AT_CUDA_CHECK(cudaEventCreateWithFlags(&internals->event, flags));
+  internals->flags = flags;
+  // Events with the default flags come from the pool shared with Caffe2
+  void* pooled = nullptr;
+  if (flags == CUDAEvent::DEFAULT_FLAGS) {
+    pooled = cuda_event_pool().acquire(internals->device);
+  }
+  if (pooled) {
+    internals->event = static_cast<cudaEvent_t>(pooled);
+  } else {
+    AT_CUDA_CHECK(cudaEventCreateWithFlags(&internals->event, flags));
+  }
   return internals.release();
 }
 
@@ -35,10 +47,17 @@ void CUDAEvent_retain(CUDAEventInternals* internals) {
 }
 
 void CUDAEvent_uncheckedFree(CUDAEventInternals* internals) {
-  if (--internals->refcount) {
+  if (!internals || --internals->refcount) {
+    return;
+  }
+  if (internals->flags == CUDAEvent::DEFAULT_FLAGS) {
+    cuda_event_pool().release(internals->device, internals->event);
+  } else {
     cudaEventDestroy(internals->event);
   }
+  delete internals;
 }
+
 cudaEvent_t CUDAEvent_event(CUDAEventInternals* internals) {
   return internals->event;
 }
@@ -48,7 +48,7 @@ struct CUDAEvent {
     internals_ = other.internals_;
   }
 
-  CUDAEvent(CUDAEvent&& other) {
+  CUDAEvent(CUDAEvent&& other) : internals_(nullptr) {
     std::swap(internals_, other.internals_);
   }
 
@@ -0,0 +1,150 @@
+#include "ATen/cuda/CUDAGraph.h"
+#include "ATen/cuda/CUDAContext.h"
+#include "ATen/cuda/CUDAEvent.h"
+#include "ATen/cuda/Exceptions.h"
+#include "ATen/Context.h"
+#include "ATen/Functions.h"
+
+#include <THC/THCCachingAllocator.h>
+#include <THC/THCGeneral.h>
+#include <THC/THCGenerator.hpp>
+
+#include <mutex>
+
+THCGenerator* THCRandom_getGenerator(THCState* state);
+
+namespace at {
+namespace cuda {
+
+namespace {
+
+// the graph being captured, if any; guarded by capture_mutex
+std::mutex capture_mutex;
+CUDAGraph* capturing_graph = nullptr;
+
+THCGenerator* generator() {
+  return THCRandom_getGenerator(globalContext().getTHCState());
+}
+
+} // namespace
+
+PhiloxCudaState philox_cuda_state(uint64_t increment) {
+  auto gen = generator();
+  {
+    std::lock_guard<std::mutex> lock(capture_mutex);
+    if (capturing_graph &&
+        getCurrentCUDAStream().stream() == capturing_graph->capture_stream_.stream()) {
+      uint64_t offset = capturing_graph->offset_intragraph_;
+      capturing_graph->offset_intragraph_ += increment;
+      return {gen->state.initial_seed, offset,
+              capturing_graph->offset_extragraph_.data<int64_t>()};
+    }
+  }
+  uint64_t offset = gen->state.philox_seed_offset.fetch_add(increment);
+  return {gen->state.initial_seed, offset, nullptr};
+}
+
+bool philox_capture_underway() {
+  std::lock_guard<std::mutex> lock(capture_mutex);
+  return capturing_graph &&
+    getCurrentCUDAStream().stream() == capturing_graph->capture_stream_.stream();
+}
+
+CUDAGraph::~CUDAGraph() {
+  try {
+    reset();
+  } catch (...) {
+    // destructors must not throw
+  }
+}
+
+void CUDAGraph::capture_begin() {
+#if CUDART_VERSION >= 10010
+  AT_CHECK(!has_graph_, "CUDAGraph::capture_begin: the graph was already captured, reset() it first");
+  std::lock_guard<std::mutex> lock(capture_mutex);
+  AT_CHECK(!capturing_graph, "CUDAGraph::capture_begin: another graph is being captured");
+
+  offset_extragraph_ = at::zeros({1}, TensorOptions(kCUDA).dtype(kLong));
+  offset_intragraph_ = 0;
+
+  prev_stream_ = getCurrentCUDAStream();
+  capture_stream_ = createCUDAStream();
+  THCCachingAllocator_retainPrivatePool(capture_stream_.stream());
+
+  // the captured work comes after whatever was queued before
+  CUDAEvent ready;
+  ready.record(prev_stream_);
+  capture_stream_.synchronize_with(ready);
+
+  setCurrentCUDAStream(capture_stream_);
+  // relaxed, so that other threads may keep using the allocator, which
+  // queries events, while a graph is being captured
+  AT_CUDA_CHECK(cudaStreamBeginCapture(capture_stream_, cudaStreamCaptureModeRelaxed));
+  capturing_graph = this;
+#else
+  AT_ERROR("CUDA graphs require CUDA 10.1 or later");
+#endif
+}
+
+void CUDAGraph::capture_end() {
+#if CUDART_VERSION >= 10010
+  cudaError_t err;
+  {
+    std::lock_guard<std::mutex> lock(capture_mutex);
+    AT_CHECK(capturing_graph == this, "CUDAGraph::capture_end: the graph isn't being captured");
+    err = cudaStreamEndCapture(capture_stream_, &graph_);
+    capturing_graph = nullptr;
+  }
+  setCurrentCUDAStream(prev_stream_);
+  has_graph_ = true;
+  if (err == cudaSuccess) {
+    err = cudaGraphInstantiate(&graph_exec_, graph_, nullptr, nullptr, 0);
+  }
+  if (err != cudaSuccess) {
+    // clear the error, which would otherwise be reported by the next check
+    cudaGetLastError();
+    reset();
+    AT_ERROR("CUDA graph capture failed: ", cudaGetErrorString(err));
+  }
+#else
+  AT_ERROR("CUDA graphs require CUDA 10.1 or later");
+#endif
+}
+
+void CUDAGraph::replay() {
+#if CUDART_VERSION >= 10010
+  AT_CHECK(has_graph_, "CUDAGraph::replay: there is no captured graph");
+  if (offset_intragraph_ > 0) {
+    auto offset = generator()->state.philox_seed_offset.fetch_add(offset_intragraph_);
+    offset_extragraph_.fill_(static_cast<int64_t>(offset));
+  }
+  AT_CUDA_CHECK(cudaGraphLaunch(graph_exec_, getCurrentCUDAStream()));
+#else
+  AT_ERROR("CUDA graphs require CUDA 10.1 or later");
+#endif
+}
+
+void CUDAGraph::reset() {
+#if CUDART_VERSION >= 10010
+  if (!has_graph_) {
+    return;
+  }
+  has_graph_ = false;
+  if (graph_exec_) {
+    AT_CUDA_CHECK(cudaGraphExecDestroy(graph_exec_));
+    graph_exec_ = nullptr;
+  }
+  if (graph_) {
+    AT_CUDA_CHECK(cudaGraphDestroy(graph_));
+    graph_ = nullptr;
+  }
+  // pending replays may still use the pool
+  AT_CUDA_CHECK(cudaDeviceSynchronize());
+  THCCachingAllocator_releasePrivatePool(capture_stream_.stream());
+  capture_stream_ = CUDAStream();
+  offset_extragraph_ = Tensor();
+#endif
+}
+
+} // namespace cuda
+} // namespace at
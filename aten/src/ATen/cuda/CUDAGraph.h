@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+
+#include "cuda_runtime_api.h"
+
+#include <ATen/ATenGeneral.h>
+#include <ATen/Tensor.h>
+#include <ATen/cuda/CUDAStream.h>
+#include <ATen/cuda/PhiloxCudaState.h>
+
+namespace at {
+namespace cuda {
+
+/*
+* Captures the CUDA work launched by ATen ops between capture_begin() and
+* capture_end() into a CUDA graph, which replay() launches again as a whole,
+* saving the launch overhead of every kernel. Requires CUDA 10.1 or later.
+*
+* - Work is captured on a stream that the graph owns: capture_begin() makes
+*   it the current stream and capture_end() restores the previous one. Ops
+*   that synchronize with the host (e.g. copies to the CPU) can't be captured,
+*   and only one graph can be captured at a time.
+* - Replays read and write the memory the captured ops did, so new inputs
+*   are copied into the tensors the captured ops read before replay(), and
+*   results are read from the tensors they wrote. Memory allocated while
+*   capturing comes from a private pool of the caching allocator, which is
+*   kept until reset().
+* - Random ops using the Philox generator (see PhiloxCudaState.h) advance the
+*   generator on every replay, like running the ops would, and draw new
+*   numbers. The seed is the one at capture time.
+* - Replays launched on different streams are not ordered with respect to
+*   each other.
+*/
+struct AT_API CUDAGraph {
+  CUDAGraph() = default;
+  ~CUDAGraph();
+
+  CUDAGraph(const CUDAGraph&) = delete;
+  CUDAGraph& operator=(const CUDAGraph&) = delete;
+
+  void capture_begin();
+  // Ends the capture and instantiates the graph. If the capture failed, the
+  // graph is reset before the error is thrown.
+  void capture_end();
+  // Launches the graph on the current stream.
+  void replay();
+  // Destroys the graph and releases its memory pool.
+  void reset();
+
+  bool has_graph() const { return has_graph_; }
+
+private:
+  friend PhiloxCudaState philox_cuda_state(uint64_t increment);
+  friend bool philox_capture_underway();
+
+#if CUDART_VERSION >= 10010
+  cudaGraph_t graph_ = nullptr;
+  cudaGraphExec_t graph_exec_ = nullptr;
+#endif
+  bool has_graph_ = false;
+
+  // the stream work is captured on; its allocations form the private pool
+  CUDAStream capture_stream_;
+  // the current stream before capture_begin()
+  CUDAStream prev_stream_;
+
+  // the generator offset of a replay, read by the captured random kernels
+  Tensor offset_extragraph_;
+  // total offset reserved by the captured random kernels
+  uint64_t offset_intragraph_ = 0;
+};
+
+} // namespace cuda
+} // namespace at
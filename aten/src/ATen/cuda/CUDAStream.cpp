@@ -4,8 +4,10 @@
 #include "ATen/cuda/Exceptions.h"
 #include "ATen/core/Error.h"
 
-#include <mutex>
+#include <array>
 #include <atomic>
+#include <cstdint>
+#include <mutex>
 
 // Internal implementation is entirely hidden
 struct CUDAStreamInternals {
@@ -30,6 +32,29 @@ namespace detail {
   static CUDAStreamInternals* default_streams;
   static thread_local CUDAStreamInternals** current_streams = nullptr;
 
+  // Stream pools: every device has kStreamsPerPool low priority and
+  // kStreamsPerPool high priority streams, created the first time a stream
+  // of the device is requested from the pool and handed out round-robin.
+  // Like the default streams they are never destroyed, so getting a stream
+  // from the pool doesn't call into the CUDA driver (cudaStreamCreate
+  // synchronizes the device).
+  static constexpr int kStreamsPerPool = 32;
+  struct CUDAStreamPool {
+    std::once_flag init_flag;
+    std::array<CUDAStreamInternals, kStreamsPerPool> low_priority_streams;
+    std::array<CUDAStreamInternals, kStreamsPerPool> high_priority_streams;
+    std::atomic<uint32_t> low_priority_counter;
+    std::atomic<uint32_t> high_priority_counter;
+  };
+  static CUDAStreamPool* stream_pools;
+
+  // With per-thread streams, the current stream of a thread on a device
+  // starts out as a stream from the pool rather than the default stream, so
+  // that work submitted by different threads can overlap. It is picked when
+  // the thread first uses the device (a null current stream stands for "not
+  // picked yet") and stays the thread's own until it sets another one.
+  static std::atomic<bool> per_thread_streams{false};
+
   // Creates a(n indestructible) default stream for each device
   // Note: the default stream on each device is signified by a zero
   // value for the pointer, and so is not actually created as usual.
@@ -44,6 +69,11 @@ namespace detail {
       default_streams[i].device = i;
       default_streams[i].stream = DEFAULT_STREAM;
     }
+    stream_pools = new CUDAStreamPool[num_gpus];
+    for (auto i = decltype(num_gpus){0}; i < num_gpus; ++i) {
+      stream_pools[i].low_priority_counter = 0;
+      stream_pools[i].high_priority_counter = 0;
+    }
   }
 
   // Init front-end to ensure initialization only occurs once
@@ -54,9 +84,46 @@ namespace detail {
     // Inits current streams (thread local) to default streams
     if (current_streams) return;
     current_streams = (CUDAStreamInternals**) malloc(num_gpus * sizeof(CUDAStreamInternals*));
+    const bool per_thread = per_thread_streams.load();
     for (auto i = decltype(num_gpus){0}; i < num_gpus; ++i) {
-      current_streams[i] = &default_streams[i];
+      current_streams[i] = per_thread ? nullptr : &default_streams[i];
+    }
+  }
+
+  // Creates the pool streams of the given device, which is switched to (and
+  // back) since streams belong to the device that is current when they are
+  // created.
+  static void initDeviceStreamPool(int64_t device) {
+    int prev_device;
+    AT_CUDA_CHECK(cudaGetDevice(&prev_device));
+    AT_CUDA_CHECK(cudaSetDevice(device));
+
+    int least_priority = 0, greatest_priority = 0;
+    #ifndef __HIP_PLATFORM_HCC__
+      AT_CUDA_CHECK(cudaDeviceGetStreamPriorityRange(&least_priority, &greatest_priority));
+    #endif // __HIP_PLATFORM_HCC__
+
+    auto& pool = stream_pools[device];
+    for (auto i = 0; i < kStreamsPerPool; ++i) {
+      for (auto high_priority : {false, true}) {
+        auto& internals = high_priority
+          ? pool.high_priority_streams[i]
+          : pool.low_priority_streams[i];
+        internals.is_destructible = false;
+        internals.refcount = 0;
+        internals.device = device;
+        #ifndef __HIP_PLATFORM_HCC__
+          AT_CUDA_CHECK(cudaStreamCreateWithPriority(
+            &internals.stream,
+            CUDAStream::DEFAULT_FLAGS,
+            high_priority ? greatest_priority : least_priority));
+        #else
+          AT_CUDA_CHECK(cudaStreamCreateWithFlags(&internals.stream, CUDAStream::DEFAULT_FLAGS));
+        #endif // __HIP_PLATFORM_HCC__
+      }
     }
+
+    AT_CUDA_CHECK(cudaSetDevice(prev_device));
   }
 
   /*
@@ -68,6 +135,16 @@ namespace detail {
     AT_ASSERT(device >= 0 && device < num_gpus);
   }
 
+  // The current stream of this thread on the device, picking it from the
+  // pool first with per-thread streams (see per_thread_streams).
+  static inline CUDAStreamInternals* current_stream(int64_t device) {
+    auto& cur = current_streams[device];
+    if (!cur) {
+      cur = CUDAStream_getStreamFromPool(/*isHighPriority=*/false, device);
+    }
+    return cur;
+  }
+
   CUDAStreamInternals* CUDAStream_getDefaultStreamOnDevice(int64_t device) {
     initCUDAStreamsOnce();
     check_gpu(device);
@@ -91,6 +168,30 @@ namespace detail {
     return internals;
   }
 
+  CUDAStreamInternals* CUDAStream_getStreamFromPool(bool isHighPriority, int64_t device) {
+    initCUDAStreamsOnce();
+    if (device == -1) device = current_device();
+    check_gpu(device);
+
+    auto& pool = stream_pools[device];
+    std::call_once(pool.init_flag, initDeviceStreamPool, device);
+
+    if (isHighPriority) {
+      const auto idx = pool.high_priority_counter++ % kStreamsPerPool;
+      return &pool.high_priority_streams[idx];
+    }
+    const auto idx = pool.low_priority_counter++ % kStreamsPerPool;
+    return &pool.low_priority_streams[idx];
+  }
+
+  void CUDAStream_setPerThreadStreams(bool enabled) {
+    per_thread_streams = enabled;
+  }
+
+  bool CUDAStream_perThreadStreams() {
+    return per_thread_streams;
+  }
+
   // Note: despite not being "unsafe," is using these methods in a multithreaded
   // environment then the caller must be sure that streams are valid
   // when they're requested. These methods will throw an error if an
@@ -98,7 +199,7 @@ namespace detail {
   CUDAStreamInternals* CUDAStream_getAndRetainCurrentStreamOnDevice(int64_t device) {
     initCUDAStreamsOnce();
     check_gpu(device);
-    auto cur = current_streams[device];
+    auto cur = current_stream(device);
     AT_ASSERT(CUDAStream_retain(cur));
     return cur;
   }
@@ -112,7 +213,7 @@ namespace detail {
   CUDAStreamInternals* CUDAStream_getCurrentStreamOnDeviceUnsafe(int64_t device) {
     initCUDAStreamsOnce();
     check_gpu(device);
-    return current_streams[device];
+    return current_stream(device);
   }
   CUDAStreamInternals* CUDAStream_getCurrentStreamUnsafe() {
     return CUDAStream_getCurrentStreamOnDeviceUnsafe(current_device());
@@ -31,6 +31,13 @@ AT_API CUDAStreamInternals* CUDAStream_getDefaultStream();
 
 AT_API CUDAStreamInternals* CUDAStream_createAndRetainWithOptions(int32_t flags, int32_t priority);
 
+// Streams from the per-device pools are created once and never destroyed,
+// so they need not be retained. device == -1 is the current device.
+AT_API CUDAStreamInternals* CUDAStream_getStreamFromPool(bool isHighPriority, int64_t device);
+
+AT_API void CUDAStream_setPerThreadStreams(bool enabled);
+AT_API bool CUDAStream_perThreadStreams();
+
 AT_API CUDAStreamInternals* CUDAStream_getAndRetainCurrentStreamOnDevice(int64_t device);
 AT_API CUDAStreamInternals* CUDAStream_getAndRetainCurrentStream();
 
@@ -0,0 +1,79 @@
+#include "ATen/cuda/CUDAContext.h"
+#include "ATen/cuda/Exceptions.h"
+
+#include "cuda.h"
+
+#include <map>
+#include <mutex>
+#include <tuple>
+
+// The cuBLAS handles returned by getCurrentCUDABlasHandle. They used to come
+// from THCState, one per device, with every caller setting the stream (and
+// for half GEMMs the math mode) on the shared handle before each call, so
+// threads on different streams raced on the handle's state.
+
+namespace at { namespace cuda {
+
+namespace {
+
+// (device, stream, tensor_op_math)
+using HandleKey = std::tuple<int, cudaStream_t, bool>;
+
+std::mutex handle_pool_mutex;
+// Handles are never destroyed: the pool lives until the process exits, and
+// destroying them from a static destructor can run after the CUDA runtime has
+// been torn down. A stream that gets destroyed leaves its handles behind,
+// which a new stream with the same cudaStream_t reuses.
+std::map<HandleKey, cublasHandle_t> handle_pool;
+
+// The last handle each thread got, for each math mode, so that the common
+// case of repeated GEMMs on the same stream doesn't take the lock.
+struct CachedHandle {
+  int device = -1;
+  cudaStream_t stream = nullptr;
+  cublasHandle_t handle = nullptr;
+};
+thread_local CachedHandle last_handles[2];
+
+cublasHandle_t createHandle(cudaStream_t stream, bool tensor_op_math) {
+  cublasHandle_t handle;
+  AT_CUBLAS_CHECK(cublasCreate(&handle));
+  AT_CUBLAS_CHECK(cublasSetStream(handle, stream));
+#if defined(CUDA_VERSION) && CUDA_VERSION >= 11000
+  if (tensor_op_math) {
+    AT_CUBLAS_CHECK(cublasSetMathMode(handle, CUBLAS_TF32_TENSOR_OP_MATH));
+  }
+#elif defined(CUDA_VERSION) && CUDA_VERSION >= 9000 && !defined(__HIP_PLATFORM_HCC__)
+  if (tensor_op_math) {
+    AT_CUBLAS_CHECK(cublasSetMathMode(handle, CUBLAS_TENSOR_OP_MATH));
+  }
+#endif
+  return handle;
+}
+
+} // anonymous namespace
+
+cublasHandle_t getCurrentCUDABlasHandle(bool tensor_op_math) {
+  int device;
+  AT_CUDA_CHECK(cudaGetDevice(&device));
+  cudaStream_t stream = detail::CUDAStream_stream(
+      detail::CUDAStream_getCurrentStreamOnDeviceUnsafe(device));
+
+  CachedHandle& cached = last_handles[tensor_op_math];
+  if (cached.handle && cached.device == device && cached.stream == stream) {
+    return cached.handle;
+  }
+
+  std::lock_guard<std::mutex> lock(handle_pool_mutex);
+  auto key = std::make_tuple(device, stream, tensor_op_math);
+  auto it = handle_pool.find(key);
+  if (it == handle_pool.end()) {
+    it = handle_pool.emplace(key, createHandle(stream, tensor_op_math)).first;
+  }
+  cached.device = device;
+  cached.stream = stream;
+  cached.handle = it->second;
+  return it->second;
+}
+
+}} // namespace at::cuda
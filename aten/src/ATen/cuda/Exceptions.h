@@ -18,3 +18,11 @@
   if (STATUS != cudaSuccess) {                            \
     AT_ERROR("CUDA error: ", cudaGetErrorString(STATUS)); \
   }
+
+#define AT_CUBLAS_CHECK(EXPR)                                   \
+  do {                                                          \
+    cublasStatus_t __status = EXPR;                             \
+    if (__status != CUBLAS_STATUS_SUCCESS) {                    \
+      AT_ERROR("cuBLAS error: ", static_cast<int>(__status));   \
+    }                                                           \
+  } while (0)
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+#include <ATen/ATenGeneral.h>
+
+namespace at {
+namespace cuda {
+
+// The Philox seed and offset of one kernel launch of a random op.
+//
+// Normally the offset is reserved from the generator when the kernel is
+// launched and passed by value. A kernel captured into a CUDA graph (see
+// CUDAGraph.h) can't take a value that changes from one replay to the next,
+// so it reads the generator offset of the replay from offset_extragraph,
+// which the graph updates before every replay, and adds its own offset
+// within the graph.
+struct PhiloxCudaState {
+  uint64_t seed;
+  uint64_t offset;                   // offset_intragraph while capturing
+  const int64_t* offset_extragraph;  // null unless captured
+};
+
+// Reserves increment offsets for a launch on the current stream.
+AT_API PhiloxCudaState philox_cuda_state(uint64_t increment);
+
+// True if work on the current stream is being captured into a CUDA graph;
+// random ops that pass their offset elsewhere than through PhiloxCudaState
+// can't be captured.
+AT_API bool philox_capture_underway();
+
+#ifdef __CUDACC__
+__device__ __forceinline__ uint64_t philox_offset(const PhiloxCudaState& state) {
+  return state.offset_extragraph
+    ? static_cast<uint64_t>(*state.offset_extragraph) + state.offset
+    : state.offset;
+}
+#endif
+
+} // namespace cuda
+} // namespace at
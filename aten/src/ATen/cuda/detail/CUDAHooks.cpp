@@ -2,9 +2,12 @@
 
 #include <ATen/CUDAGenerator.h>
 #include <ATen/Context.h>
+#include <ATen/DeviceGuard.h>
 #include <ATen/RegisterCUDA.h>
 #include <ATen/core/Error.h>
 #include <ATen/cuda/CUDAConfig.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/CUDAEvent.h>
 #include <ATen/cuda/PinnedMemoryAllocator.h>
 #include <ATen/detail/CUDAHooksInterface.h>
 #include <ATen/native/cuda/CuFFTPlanCache.h>
@@ -14,6 +17,7 @@
 
 #if AT_CUDNN_ENABLED()
 #include "ATen/cudnn/cudnn-wrapper.h"
+#include <ATen/native/cudnn/ConvBenchmarkCache.h>
 #endif
 
 #include <cuda.h>
@@ -150,38 +154,86 @@ double CUDAHooks::batchnormMinEpsilonCuDNN() const {
 #endif
 }
 
-int64_t CUDAHooks::cuFFTGetPlanCacheMaxSize() const {
+int64_t CUDAHooks::cuFFTGetPlanCacheMaxSize(int64_t device_index) const {
 #ifndef __HIP_PLATFORM_HCC__
-  return at::native::detail::cufft_get_plan_cache_max_size_impl();
+  return at::native::detail::cufft_get_plan_cache_max_size_impl(device_index);
 #else
   AT_ERROR("cuFFT with HIP is not supported");
 #endif
 }
 
-void CUDAHooks::cuFFTSetPlanCacheMaxSize(int64_t max_size) const {
+void CUDAHooks::cuFFTSetPlanCacheMaxSize(int64_t device_index, int64_t max_size) const {
 #ifndef __HIP_PLATFORM_HCC__
-  at::native::detail::cufft_set_plan_cache_max_size_impl(max_size);
+  at::native::detail::cufft_set_plan_cache_max_size_impl(device_index, max_size);
 #else
   AT_ERROR("cuFFT with HIP is not supported");
 #endif
 }
 
-int64_t CUDAHooks::cuFFTGetPlanCacheSize() const {
+int64_t CUDAHooks::cuFFTGetPlanCacheSize(int64_t device_index) const {
 #ifndef __HIP_PLATFORM_HCC__
-  return at::native::detail::cufft_get_plan_cache_size_impl();
+  return at::native::detail::cufft_get_plan_cache_size_impl(device_index);
 #else
   AT_ERROR("cuFFT with HIP is not supported");
 #endif
 }
 
-void CUDAHooks::cuFFTClearPlanCache() const {
+int64_t CUDAHooks::cuFFTGetPlanCacheHits(int64_t device_index) const {
 #ifndef __HIP_PLATFORM_HCC__
-  at::native::detail::cufft_clear_plan_cache_impl();
+  return at::native::detail::cufft_get_plan_cache_hits_impl(device_index);
 #else
   AT_ERROR("cuFFT with HIP is not supported");
 #endif
 }
 
+int64_t CUDAHooks::cuFFTGetPlanCacheMisses(int64_t device_index) const {
+#ifndef __HIP_PLATFORM_HCC__
+  return at::native::detail::cufft_get_plan_cache_misses_impl(device_index);
+#else
+  AT_ERROR("cuFFT with HIP is not supported");
+#endif
+}
+
+void CUDAHooks::cuFFTClearPlanCache(int64_t device_index) const {
+#ifndef __HIP_PLATFORM_HCC__
+  at::native::detail::cufft_clear_plan_cache_impl(device_index);
+#else
+  AT_ERROR("cuFFT with HIP is not supported");
+#endif
+}
+
+void CUDAHooks::cuDNNSaveBenchmarkCache(const std::string& path) const {
+#if AT_CUDNN_ENABLED()
+  at::native::detail::cudnn_save_benchmark_cache_impl(path);
+#else
+  AT_ERROR("Cannot access cuDNN benchmark cache if ATen_cuda is not built with CuDNN");
+#endif
+}
+
+int64_t CUDAHooks::cuDNNLoadBenchmarkCache(const std::string& path) const {
+#if AT_CUDNN_ENABLED()
+  return at::native::detail::cudnn_load_benchmark_cache_impl(path);
+#else
+  AT_ERROR("Cannot access cuDNN benchmark cache if ATen_cuda is not built with CuDNN");
+#endif
+}
+
+int64_t CUDAHooks::cuDNNGetBenchmarkCacheSize() const {
+#if AT_CUDNN_ENABLED()
+  return at::native::detail::cudnn_get_benchmark_cache_size_impl();
+#else
+  AT_ERROR("Cannot access cuDNN benchmark cache if ATen_cuda is not built with CuDNN");
+#endif
+}
+
+void CUDAHooks::cuDNNClearBenchmarkCache() const {
+#if AT_CUDNN_ENABLED()
+  at::native::detail::cudnn_clear_benchmark_cache_impl();
+#else
+  AT_ERROR("Cannot access cuDNN benchmark cache if ATen_cuda is not built with CuDNN");
+#endif
+}
+
 int CUDAHooks::getNumGPUs() const {
   int count;
   auto err = cudaGetDeviceCount(&count);
@@ -194,6 +246,27 @@ int CUDAHooks::getNumGPUs() const {
   return count;
 }
 
+void CUDAHooks::registerExternalAllocation(void* ptr, size_t size, int64_t device) const {
+  THCCachingAllocator_registerExternalAllocation(ptr, size, device);
+}
+
+void CUDAHooks::unregisterExternalAllocation(void* ptr) const {
+  THCCachingAllocator_unregisterExternalAllocation(ptr);
+}
+
+void CUDAHooks::streamWaitStream(int64_t device, void* stream, void* producer_stream) const {
+  at::DeviceGuard device_guard(device);
+  cudaStream_t current = at::cuda::getCurrentCUDAStream().stream();
+  cudaStream_t consumer = stream ? static_cast<cudaStream_t>(stream) : current;
+  cudaStream_t producer = producer_stream ? static_cast<cudaStream_t>(producer_stream) : current;
+  if (consumer == producer) {
+    return;
+  }
+  CUDAEvent event;
+  AT_CUDA_CHECK(cudaEventRecord(event, producer));
+  AT_CUDA_CHECK(cudaStreamWaitEvent(consumer, event, 0));
+}
+
 // Sigh, the registry doesn't support namespaces :(
 using at::CUDAHooksRegistry;
 using at::RegistererCUDAHooksRegistry;
@@ -21,11 +21,20 @@ struct CUDAHooks : public at::CUDAHooksInterface {
   bool supportsDilatedConvolutionWithCuDNN() const override;
   long versionCuDNN() const override;
   double batchnormMinEpsilonCuDNN() const override;
-  int64_t cuFFTGetPlanCacheMaxSize() const override;
-  void cuFFTSetPlanCacheMaxSize(int64_t max_size) const override;
-  int64_t cuFFTGetPlanCacheSize() const override;
-  void cuFFTClearPlanCache() const override;
+  int64_t cuFFTGetPlanCacheMaxSize(int64_t device_index) const override;
+  void cuFFTSetPlanCacheMaxSize(int64_t device_index, int64_t max_size) const override;
+  int64_t cuFFTGetPlanCacheSize(int64_t device_index) const override;
+  int64_t cuFFTGetPlanCacheHits(int64_t device_index) const override;
+  int64_t cuFFTGetPlanCacheMisses(int64_t device_index) const override;
+  void cuFFTClearPlanCache(int64_t device_index) const override;
+  void cuDNNSaveBenchmarkCache(const std::string& path) const override;
+  int64_t cuDNNLoadBenchmarkCache(const std::string& path) const override;
+  int64_t cuDNNGetBenchmarkCacheSize() const override;
+  void cuDNNClearBenchmarkCache() const override;
   int getNumGPUs() const override;
+  void registerExternalAllocation(void* ptr, size_t size, int64_t device) const override;
+  void unregisterExternalAllocation(void* ptr) const override;
+  void streamWaitStream(int64_t device, void* stream, void* producer_stream) const override;
 };
 
 }}} // at::cuda::detail
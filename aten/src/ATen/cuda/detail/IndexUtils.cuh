@@ -9,7 +9,26 @@ namespace cuda {
 namespace detail {
 
 bool maybeOverlappingIndices(const at::Tensor& t);
-bool canUse32BitIndexMath(const at::Tensor &t, int64_t max_elem=std::numeric_limits<int64_t>::max());
+bool canUse32BitIndexMath(const at::Tensor &t, int64_t max_elem=std::numeric_limits<int32_t>::max());
+
+// Runs the lambda __VA_ARGS__ with index_t defined as int32_t if USE_32BIT,
+// and as int64_t otherwise, typically to pick the index type of
+// PackedTensorAccessors:
+//
+//   const bool use_32bit = canUse32BitIndexMath(input) && canUse32BitIndexMath(output);
+//   AT_DISPATCH_INDEX_TYPES(use_32bit, [&] {
+//     kernel<<<...>>>(input.packed_accessor<scalar_t, 4, index_t>(), ...);
+//   });
+#define AT_DISPATCH_INDEX_TYPES(USE_32BIT, ...) \
+  [&] {                                         \
+    if (USE_32BIT) {                            \
+      using index_t = int32_t;                  \
+      return __VA_ARGS__();                     \
+    } else {                                    \
+      using index_t = int64_t;                  \
+      return __VA_ARGS__();                     \
+    }                                           \
+  }()
 
 template <typename scalar, typename IndexType>
 TensorInfo<scalar, IndexType>
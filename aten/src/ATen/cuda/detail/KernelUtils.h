@@ -2,23 +2,34 @@
 
 #include "ATen/ATen.h"
 
+#include <algorithm>
+#include <limits>
+
 // Contents of this file are copied from THCUNN/common.h for the ease of porting
 // THCUNN functions into ATen.
 
 namespace at { namespace cuda { namespace detail {
 
-// CUDA: grid stride looping
-#define CUDA_KERNEL_LOOP(i, n) \
-  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < (n); i += blockDim.x * gridDim.x)
+// CUDA: grid stride looping, with i of type index_type (which must be able to
+// hold n plus the number of threads)
+#define CUDA_KERNEL_LOOP_TYPE(i, n, index_type)                             \
+  for (index_type i = static_cast<index_type>(blockIdx.x) * blockDim.x + threadIdx.x; \
+       i < (n);                                                             \
+       i += static_cast<index_type>(blockDim.x) * gridDim.x)
+
+#define CUDA_KERNEL_LOOP(i, n) CUDA_KERNEL_LOOP_TYPE(i, n, int)
 
 // Use 1024 threads per block, which requires cuda sm_2x or above
 constexpr int CUDA_NUM_THREADS = 1024;
 
-// CUDA: number of blocks for threads.
-inline int GET_BLOCKS(const int N)
+// CUDA: number of blocks for threads. Capped at the maximum grid size, so the
+// kernels must use grid stride loops when N can be larger than that many
+// blocks of threads.
+inline int GET_BLOCKS(const int64_t N)
 {
   AT_ASSERTM(N > 0, "CUDA kernel launch blocks must be positive, but got N=", N);
-  return (N + CUDA_NUM_THREADS - 1) / CUDA_NUM_THREADS;
+  constexpr int64_t max_blocks = std::numeric_limits<int>::max();
+  return static_cast<int>(std::min(max_blocks, (N + CUDA_NUM_THREADS - 1) / CUDA_NUM_THREADS));
 }
 
 }}}  // namespace at::cuda::detail
@@ -114,12 +114,17 @@ void FilterDescriptor::set(const at::Tensor &t, int64_t pad) {
     throw std::runtime_error("cuDNN supports only up to " STR(CUDNN_DIM_MAX) " dimensions");
 #undef _STR
 #undef STR
-  if (!t.is_contiguous()) {
+  // Channels-last filters are described as NHWC; the sizes stay in NCHW
+  // order either way. See Note [Channels last].
+  auto filter_format = CUDNN_TENSOR_NCHW;
+  if (dim == 4 && suggest_memory_format(t.sizes(), t.strides()) == MemoryFormat::ChannelsLast) {
+    filter_format = CUDNN_TENSOR_NHWC;
+  } else if (!t.is_contiguous()) {
     // NB: It is possible for this test to be insufficient, because the
     // Tensor passed in to set the filter descriptor may not be the actual
     // Tensor whose data pointer is passed to cuDNN.  Nevertheless,
     // that is the common case, so we can catch most client errors with this test.
-    throw std::runtime_error("cuDNN filters (a.k.a. weights) must be contiguous");
+    throw std::runtime_error("cuDNN filters (a.k.a. weights) must be contiguous or channels last");
   }
   int size[CUDNN_DIM_MAX];
   for (int i = 0; i < dim; ++i) {
@@ -129,7 +134,7 @@ void FilterDescriptor::set(const at::Tensor &t, int64_t pad) {
     size[i] = (int) 1;
   }
   dim = std::max(dim, pad);
-  set(getDataType(t), (int) dim, size);
+  set(getDataType(t), (int) dim, size, filter_format);
 }
 
 }}
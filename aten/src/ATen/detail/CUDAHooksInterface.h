@@ -8,6 +8,7 @@
 #include <cstddef>
 #include <functional>
 #include <memory>
+#include <string>
 
 // Forward-declares THCState
 struct THCState;
@@ -98,25 +99,65 @@ struct AT_API CUDAHooksInterface {
         "Cannot query batchnormMinEpsilonCuDNN() without ATen_cuda library. ", CUDA_HELP);
   }
 
-  virtual int64_t cuFFTGetPlanCacheMaxSize() const {
+  virtual int64_t cuFFTGetPlanCacheMaxSize(int64_t device_index) const {
     AT_ERROR("Cannot access cuFFT plan cache without ATen_cuda library. ", CUDA_HELP);
   }
 
-  virtual void cuFFTSetPlanCacheMaxSize(int64_t max_size) const {
+  virtual void cuFFTSetPlanCacheMaxSize(int64_t device_index, int64_t max_size) const {
     AT_ERROR("Cannot access cuFFT plan cache without ATen_cuda library. ", CUDA_HELP);
   }
 
-  virtual int64_t cuFFTGetPlanCacheSize() const {
+  virtual int64_t cuFFTGetPlanCacheSize(int64_t device_index) const {
     AT_ERROR("Cannot access cuFFT plan cache without ATen_cuda library. ", CUDA_HELP);
   }
 
-  virtual void cuFFTClearPlanCache() const {
+  virtual int64_t cuFFTGetPlanCacheHits(int64_t device_index) const {
     AT_ERROR("Cannot access cuFFT plan cache without ATen_cuda library. ", CUDA_HELP);
   }
 
+  virtual int64_t cuFFTGetPlanCacheMisses(int64_t device_index) const {
+    AT_ERROR("Cannot access cuFFT plan cache without ATen_cuda library. ", CUDA_HELP);
+  }
+
+  virtual void cuFFTClearPlanCache(int64_t device_index) const {
+    AT_ERROR("Cannot access cuFFT plan cache without ATen_cuda library. ", CUDA_HELP);
+  }
+
+  virtual void cuDNNSaveBenchmarkCache(const std::string& path) const {
+    AT_ERROR("Cannot access cuDNN benchmark cache without ATen_cuda library. ", CUDA_HELP);
+  }
+
+  virtual int64_t cuDNNLoadBenchmarkCache(const std::string& path) const {
+    AT_ERROR("Cannot access cuDNN benchmark cache without ATen_cuda library. ", CUDA_HELP);
+  }
+
+  virtual int64_t cuDNNGetBenchmarkCacheSize() const {
+    AT_ERROR("Cannot access cuDNN benchmark cache without ATen_cuda library. ", CUDA_HELP);
+  }
+
+  virtual void cuDNNClearBenchmarkCache() const {
+    AT_ERROR("Cannot access cuDNN benchmark cache without ATen_cuda library. ", CUDA_HELP);
+  }
+
   virtual int getNumGPUs() const {
     return 0;
   }
+
+  // See THCCachingAllocator_registerExternalAllocation.
+  virtual void registerExternalAllocation(void* ptr, size_t size, int64_t device) const {
+    AT_ERROR("Cannot register external CUDA memory without ATen_cuda library. ", CUDA_HELP);
+  }
+
+  virtual void unregisterExternalAllocation(void* ptr) const {
+    AT_ERROR("Cannot register external CUDA memory without ATen_cuda library. ", CUDA_HELP);
+  }
+
+  // Makes the work queued on stream from now on wait for the work queued on
+  // producer_stream so far, both on the given device. Null streams stand for
+  // the current stream of the device.
+  virtual void streamWaitStream(int64_t device, void* stream, void* producer_stream) const {
+    AT_ERROR("Cannot synchronize CUDA streams without ATen_cuda library. ", CUDA_HELP);
+  }
 };
 
 // NB: dummy argument to suppress "ISO C++11 requires at least one argument
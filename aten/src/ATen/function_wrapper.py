@@ -471,6 +471,7 @@ FunctionOption = TypedDict('FunctionOption', {
     'with_gil': bool,
     'cpu_half': bool,
     'deprecated': bool,
+    'python_module': str,
     'formals_list': List[AtFormal],
     'formals_with_defaults': List[str],
     'formals': List[str],
@@ -518,6 +519,7 @@ OutputDeclaration = NamedTuple('OutputDeclaration', [
     ('device_guard', bool),
     ('with_gil', bool),
     ('deprecated', bool),
+    ('python_module', str),
 ])
 
 
@@ -875,7 +877,8 @@ def create_generic(top_env, declarations):
             abstract=abstract,
             device_guard=option.get('device_guard', True),
             with_gil=option.get('with_gil', False),
-            deprecated=option.get('deprecated', False)
+            deprecated=option.get('deprecated', False),
+            python_module=option.get('python_module', ''),
         ))
 
     def native_get_formals(option, include_constants=False):
@@ -946,8 +949,9 @@ def create_generic(top_env, declarations):
                 t = t_raw['type']
                 name = t_raw['name']
 
-            # can't actually return a TensorList (since it's a reference object)
-            actual_return_type = {'TensorList': 'std::vector<Tensor>'}.get(t, t)
+            # can't actually return a TensorList (since it's a reference object);
+            # a BoolTensor is a Tensor that only differs in its dynamic type
+            actual_return_type = {'TensorList': 'std::vector<Tensor>', 'BoolTensor': 'Tensor'}.get(t, t)
 
             if actual_return_type == 'Tensor' and (option['inplace'] or option['api_name'].endswith('_out')):
                 # follow normal ATen convention of returning Tensor & for inplace functions.
@@ -1108,6 +1112,7 @@ def create_generic(top_env, declarations):
             device_guard=option.get('device_guard', True),
             with_gil=option.get('with_gil', False),
             deprecated=option['deprecated'],
+            python_module=option['python_module'],
         ))
 
     output_declarations = []  # type: List[OutputDeclaration]
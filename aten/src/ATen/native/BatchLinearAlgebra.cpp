@@ -0,0 +1,203 @@
+#include "ATen/ATen.h"
+#include "ATen/Dispatch.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
+
+#include "ATen/native/LinearAlgebraUtils.h"
+#include "ATen/native/BatchLinearAlgebra.h"
+
+#include "TH.h"  // for USE_LAPACK
+
+#include <algorithm>
+#include <vector>
+
+#ifdef USE_LAPACK
+extern "C" void dgetrf_(int* m, int* n, double* a, int* lda, int* ipiv, int* info);
+extern "C" void sgetrf_(int* m, int* n, float* a, int* lda, int* ipiv, int* info);
+extern "C" void dgetri_(
+    int* n, double* a, int* lda, int* ipiv, double* work, int* lwork, int* info);
+extern "C" void sgetri_(
+    int* n, float* a, int* lda, int* ipiv, float* work, int* lwork, int* info);
+extern "C" void dpotrf_(char* uplo, int* n, double* a, int* lda, int* info);
+extern "C" void spotrf_(char* uplo, int* n, float* a, int* lda, int* info);
+#endif
+
+namespace at { namespace native {
+
+template<class scalar_t>
+void lapackGetrf(int m, int n, scalar_t* a, int lda, int* ipiv, int* info) {
+  AT_ERROR("getrf only takes float or double Tensors");
+}
+
+template<class scalar_t>
+void lapackGetri(
+    int n, scalar_t* a, int lda, int* ipiv, scalar_t* work, int lwork, int* info) {
+  AT_ERROR("getri only takes float or double Tensors");
+}
+
+template<class scalar_t>
+void lapackPotrf(char uplo, int n, scalar_t* a, int lda, int* info) {
+  AT_ERROR("potrf only takes float or double Tensors");
+}
+
+#ifdef USE_LAPACK
+template<> void lapackGetrf<float>(
+    int m, int n, float* a, int lda, int* ipiv, int* info) {
+  sgetrf_(&m, &n, a, &lda, ipiv, info);
+}
+
+template<> void lapackGetrf<double>(
+    int m, int n, double* a, int lda, int* ipiv, int* info) {
+  dgetrf_(&m, &n, a, &lda, ipiv, info);
+}
+
+template<> void lapackGetri<float>(
+    int n, float* a, int lda, int* ipiv, float* work, int lwork, int* info) {
+  sgetri_(&n, a, &lda, ipiv, work, &lwork, info);
+}
+
+template<> void lapackGetri<double>(
+    int n, double* a, int lda, int* ipiv, double* work, int lwork, int* info) {
+  dgetri_(&n, a, &lda, ipiv, work, &lwork, info);
+}
+
+template<> void lapackPotrf<float>(char uplo, int n, float* a, int lda, int* info) {
+  spotrf_(&uplo, &n, a, &lda, info);
+}
+
+template<> void lapackPotrf<double>(char uplo, int n, double* a, int lda, int* info) {
+  dpotrf_(&uplo, &n, a, &lda, info);
+}
+#endif
+
+// Matrices of a batch are independent, so chunks of the batch are
+// factorized in parallel, with grains of about GRAIN_SIZE flops.
+static inline int64_t batchGrainSize(int64_t n) {
+  return std::max<int64_t>(1, internal::GRAIN_SIZE / (n * n * n));
+}
+
+template <typename scalar_t>
+static void applyTinyInverse(const Tensor& self, Tensor& result, std::vector<int64_t>& infos) {
+  auto self_data = self.data<scalar_t>();
+  auto result_data = result.data<scalar_t>();
+  auto n = self.size(-1);
+  auto batch_size = batchCount(self);
+  AT_DISPATCH_TINY_MATRIX_SIZE(n, "inverse", [&] {
+    parallel_for(0, batch_size, batchGrainSize(n), [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        infos[i] = tiny_inverse<scalar_t, matrix_size>(
+            &self_data[i * n * n], &result_data[i * n * n]);
+      }
+    });
+  });
+}
+
+template <typename scalar_t>
+static void applyInverse(Tensor& self, std::vector<int64_t>& infos) {
+#ifndef USE_LAPACK
+  AT_ERROR("inverse: LAPACK library not found in compilation");
+#endif
+  auto self_data = self.data<scalar_t>();
+  auto self_mat_stride = matrixStride(self);
+  auto batch_size = batchCount(self);
+  int n = self.size(-2);
+
+  // workspace size query
+  int info;
+  scalar_t wkopt;
+  lapackGetri<scalar_t>(n, self_data, n, nullptr, &wkopt, -1, &info);
+  int lwork = std::max<int>(1, static_cast<int>(wkopt));
+
+  parallel_for(0, batch_size, batchGrainSize(n), [&](int64_t begin, int64_t end) {
+    std::vector<int> ipiv(n);
+    std::vector<scalar_t> work(lwork);
+    for (int64_t i = begin; i < end; i++) {
+      int info;
+      scalar_t* self_working_ptr = &self_data[i * self_mat_stride];
+      lapackGetrf<scalar_t>(n, n, self_working_ptr, n, ipiv.data(), &info);
+      if (info == 0) {
+        lapackGetri<scalar_t>(n, self_working_ptr, n, ipiv.data(),
+            work.data(), lwork, &info);
+      }
+      infos[i] = info;
+    }
+  });
+}
+
+Tensor _inverse_helper_cpu(const Tensor& self) {
+  std::vector<int64_t> infos(batchCount(self), 0);
+  Tensor result;
+  if (self.size(-1) <= kTinyMatrixSize) {
+    auto self_contig = self.contiguous();
+    result = at::empty_like(self_contig);
+    AT_DISPATCH_FLOATING_TYPES(self.type(), "inverse", [&]{
+      applyTinyInverse<scalar_t>(self_contig, result, infos);
+    });
+  } else {
+    result = cloneBatchedColumnMajor(self);
+    AT_DISPATCH_FLOATING_TYPES(self.type(), "inverse", [&]{
+      applyInverse<scalar_t>(result, infos);
+    });
+  }
+  checkInverseErrors(infos);
+  return result;
+}
+
+template <typename scalar_t>
+static void applyTinyCholesky(
+    const Tensor& self, Tensor& result, bool upper, std::vector<int64_t>& infos) {
+  auto self_data = self.data<scalar_t>();
+  auto result_data = result.data<scalar_t>();
+  auto n = self.size(-1);
+  auto batch_size = batchCount(self);
+  AT_DISPATCH_TINY_MATRIX_SIZE(n, "cholesky", [&] {
+    parallel_for(0, batch_size, batchGrainSize(n), [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        infos[i] = tiny_cholesky<scalar_t, matrix_size>(
+            &self_data[i * n * n], &result_data[i * n * n], upper);
+      }
+    });
+  });
+}
+
+template <typename scalar_t>
+static void applyCholesky(Tensor& self, bool upper, std::vector<int64_t>& infos) {
+#ifndef USE_LAPACK
+  AT_ERROR("cholesky: LAPACK library not found in compilation");
+#endif
+  auto self_data = self.data<scalar_t>();
+  auto self_mat_stride = matrixStride(self);
+  auto batch_size = batchCount(self);
+  int n = self.size(-2);
+  char uplo = upper ? 'U' : 'L';
+
+  parallel_for(0, batch_size, batchGrainSize(n), [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      int info;
+      lapackPotrf<scalar_t>(uplo, n, &self_data[i * self_mat_stride], n, &info);
+      infos[i] = info;
+    }
+  });
+}
+
+Tensor _cholesky_helper_cpu(const Tensor& self, bool upper) {
+  std::vector<int64_t> infos(batchCount(self), 0);
+  Tensor result;
+  if (self.size(-1) <= kTinyMatrixSize) {
+    auto self_contig = self.contiguous();
+    result = at::empty_like(self_contig);
+    AT_DISPATCH_FLOATING_TYPES(self.type(), "cholesky", [&]{
+      applyTinyCholesky<scalar_t>(self_contig, result, upper, infos);
+    });
+  } else {
+    result = cloneBatchedColumnMajor(self);
+    AT_DISPATCH_FLOATING_TYPES(self.type(), "cholesky", [&]{
+      applyCholesky<scalar_t>(result, upper, infos);
+    });
+    zeroOtherTriangle(result, upper);
+  }
+  checkCholeskyErrors(infos);
+  return result;
+}
+
+}}  // namespace at::native
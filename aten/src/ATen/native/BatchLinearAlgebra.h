@@ -0,0 +1,204 @@
+#pragma once
+
+#include "ATen/ATen.h"
+
+#include <math.h>
+#include <vector>
+
+// Shared pieces of the batched linear algebra functions (inverse and
+// cholesky of batches of matrices) on CPU and CUDA.
+//
+// LAPACK and MAGMA have a large per-matrix overhead, which dominates for
+// batches of tiny matrices.  Those use the kernels below instead, which keep
+// a whole matrix in registers.  The kernels are plain loops over
+// compile-time sizes, so they compile for both the CPU and CUDA, where each
+// thread handles one matrix.
+
+namespace at { namespace native {
+
+// Matrices up to this size use the tiny kernels
+constexpr int64_t kTinyMatrixSize = 8;
+
+// Calls the lambda with a constexpr int matrix_size equal to n, which must
+// be between 1 and kTinyMatrixSize.
+#define AT_TINY_MATRIX_CASE(N, ...)                   \
+  case N: {                                           \
+    constexpr int matrix_size = N;                    \
+    return __VA_ARGS__();                             \
+  }
+
+#define AT_DISPATCH_TINY_MATRIX_SIZE(n, NAME, ...)                      \
+  [&] {                                                                 \
+    switch (n) {                                                        \
+      AT_TINY_MATRIX_CASE(1, __VA_ARGS__)                               \
+      AT_TINY_MATRIX_CASE(2, __VA_ARGS__)                               \
+      AT_TINY_MATRIX_CASE(3, __VA_ARGS__)                               \
+      AT_TINY_MATRIX_CASE(4, __VA_ARGS__)                               \
+      AT_TINY_MATRIX_CASE(5, __VA_ARGS__)                               \
+      AT_TINY_MATRIX_CASE(6, __VA_ARGS__)                               \
+      AT_TINY_MATRIX_CASE(7, __VA_ARGS__)                               \
+      AT_TINY_MATRIX_CASE(8, __VA_ARGS__)                               \
+      default:                                                          \
+        AT_ERROR(NAME, ": no tiny matrix kernel for size ", n);         \
+    }                                                                   \
+  }()
+
+AT_HOSTDEVICE inline float tiny_sqrt(float x) { return sqrtf(x); }
+AT_HOSTDEVICE inline double tiny_sqrt(double x) { return sqrt(x); }
+
+template <typename scalar_t>
+AT_HOSTDEVICE inline scalar_t tiny_abs(scalar_t x) { return x < 0 ? -x : x; }
+
+// Inverts the row-major N x N matrix in, writing the row-major inverse to
+// out, by Gauss-Jordan elimination with partial pivoting.  Returns 0, or
+// like LAPACK's getrf k if the k-th pivot (1-based) is zero.
+template <typename scalar_t, int N>
+AT_HOSTDEVICE inline int tiny_inverse(const scalar_t* in, scalar_t* out) {
+  scalar_t a[N][N];
+  scalar_t b[N][N];
+  #pragma unroll
+  for (int i = 0; i < N; i++) {
+    #pragma unroll
+    for (int j = 0; j < N; j++) {
+      a[i][j] = in[i * N + j];
+      b[i][j] = i == j ? scalar_t(1) : scalar_t(0);
+    }
+  }
+
+  #pragma unroll
+  for (int k = 0; k < N; k++) {
+    int p = k;
+    scalar_t p_abs = tiny_abs(a[k][k]);
+    #pragma unroll
+    for (int i = k + 1; i < N; i++) {
+      if (tiny_abs(a[i][k]) > p_abs) {
+        p = i;
+        p_abs = tiny_abs(a[i][k]);
+      }
+    }
+    if (p_abs == scalar_t(0)) {
+      return k + 1;
+    }
+    // Swap rows k and p.  The rows are only indexed by loop counters (and
+    // not by p), so that the matrices can stay in registers.
+    #pragma unroll
+    for (int i = k + 1; i < N; i++) {
+      if (i == p) {
+        #pragma unroll
+        for (int j = 0; j < N; j++) {
+          scalar_t t = a[k][j]; a[k][j] = a[i][j]; a[i][j] = t;
+          t = b[k][j]; b[k][j] = b[i][j]; b[i][j] = t;
+        }
+      }
+    }
+
+    scalar_t inv_pivot = scalar_t(1) / a[k][k];
+    #pragma unroll
+    for (int j = 0; j < N; j++) {
+      a[k][j] *= inv_pivot;
+      b[k][j] *= inv_pivot;
+    }
+    #pragma unroll
+    for (int i = 0; i < N; i++) {
+      if (i != k) {
+        scalar_t f = a[i][k];
+        #pragma unroll
+        for (int j = 0; j < N; j++) {
+          a[i][j] -= f * a[k][j];
+          b[i][j] -= f * b[k][j];
+        }
+      }
+    }
+  }
+
+  #pragma unroll
+  for (int i = 0; i < N; i++) {
+    #pragma unroll
+    for (int j = 0; j < N; j++) {
+      out[i * N + j] = b[i][j];
+    }
+  }
+  return 0;
+}
+
+// Cholesky decomposition of the row-major N x N matrix in, writing the
+// row-major factor to out (upper or lower triangular, the other triangle is
+// zeroed).  Like LAPACK's potrf, only the triangle of in that is asked for
+// is read.  Returns 0, or k if the leading minor of order k is not positive
+// definite.
+template <typename scalar_t, int N>
+AT_HOSTDEVICE inline int tiny_cholesky(const scalar_t* in, scalar_t* out, bool upper) {
+  // the lower triangular factor L, with A = L * L^T
+  scalar_t l[N][N];
+  #pragma unroll
+  for (int j = 0; j < N; j++) {
+    scalar_t d = in[j * N + j];
+    #pragma unroll
+    for (int k = 0; k < j; k++) {
+      d -= l[j][k] * l[j][k];
+    }
+    if (!(d > scalar_t(0))) {
+      return j + 1;
+    }
+    d = tiny_sqrt(d);
+    l[j][j] = d;
+    #pragma unroll
+    for (int i = j + 1; i < N; i++) {
+      scalar_t s = upper ? in[j * N + i] : in[i * N + j];
+      #pragma unroll
+      for (int k = 0; k < j; k++) {
+        s -= l[i][k] * l[j][k];
+      }
+      l[i][j] = s / d;
+    }
+  }
+
+  #pragma unroll
+  for (int i = 0; i < N; i++) {
+    #pragma unroll
+    for (int j = 0; j < N; j++) {
+      if (upper) {
+        out[i * N + j] = j >= i ? l[j][i] : scalar_t(0);
+      } else {
+        out[i * N + j] = j <= i ? l[i][j] : scalar_t(0);
+      }
+    }
+  }
+  return 0;
+}
+
+static inline void checkInverseErrors(const std::vector<int64_t>& infos) {
+  for (size_t i = 0; i < infos.size(); i++) {
+    auto info = infos[i];
+    if (info < 0) {
+      AT_ERROR("inverse: For batch %lld: Argument %lld has illegal value",
+          (long long)i, -info);
+    } else if (info > 0) {
+      AT_ERROR("inverse: For batch %lld: U(%lld,%lld) is zero, singular U.",
+          (long long)i, info, info);
+    }
+  }
+}
+
+static inline void checkCholeskyErrors(const std::vector<int64_t>& infos) {
+  for (size_t i = 0; i < infos.size(); i++) {
+    auto info = infos[i];
+    if (info < 0) {
+      AT_ERROR("cholesky: For batch %lld: Argument %lld has illegal value",
+          (long long)i, -info);
+    } else if (info > 0) {
+      AT_ERROR("cholesky: For batch %lld: The leading minor of order %lld "
+          "is not positive definite.", (long long)i, info);
+    }
+  }
+}
+
+// Zeroes the triangle of a batch of matrices that a Cholesky factorization
+// in place leaves untouched.
+static inline void zeroOtherTriangle(Tensor& factor, bool upper) {
+  auto n = factor.size(-1);
+  auto mask = at::ones({n, n}, factor.options());
+  factor.mul_(upper ? mask.triu() : mask.tril());
+}
+
+}}  // namespace at::native
@@ -25,6 +25,8 @@ struct ConvParams {
   void view1d_as_2d();
   bool use_cudnn(const at::Tensor& input) const;
   bool use_mkldnn(const at::Tensor& input) const;
+  bool use_nnpack(const at::Tensor& input, const at::Tensor& weight) const;
+  bool use_cpu_native(const at::Tensor& input) const;
   bool is_depthwise(const at::Tensor& input, const at::Tensor& weight) const;
 };
 
@@ -129,6 +131,35 @@ auto ConvParams::use_mkldnn(const at::Tensor& input) const -> bool {
   return false;
 }
 
+// Small batches of 3x3 convolutions, which NNPACK runs as Winograd or FFT
+// convolutions with its inference API. Larger batches amortize the GEMM
+// setup of the other backends.
+constexpr int64_t nnpack_max_batch_size = 16;
+
+auto ConvParams::use_nnpack(const at::Tensor& input, const at::Tensor& weight) const -> bool {
+#if AT_NNPACK_ENABLED()
+  return at::_nnpack_available() &&
+         input.type().backend() == at::Backend::CPU &&
+         input.type().scalarType() == kFloat && // only on CPU Float Tensors
+         !is_strided() && // doesn't support strides
+         !is_dilated() && // or dilation
+         !transposed && // or transposed tensors
+         groups == 1 &&
+         input.ndimension() == 4 && // must be in NCHW format
+         input.size(0) < nnpack_max_batch_size &&
+         weight.size(2) == 3 && weight.size(3) == 3;
+#endif
+  return false;
+}
+
+// The native CPU convolution, for 2d convolutions that MKL-DNN does not take.
+auto ConvParams::use_cpu_native(const at::Tensor& input) const -> bool {
+  return input.type().backend() == at::Backend::CPU &&
+         (input.type().scalarType() == kFloat || input.type().scalarType() == kDouble) &&
+         !transposed &&
+         input.ndimension() == 4;
+}
+
 // We currently only have depthwise support for the case where groups ==
 // nInputPlane and nInputPlane == nOutputPlane (the latter due to the lack of
 // a depthwise multiplier)
@@ -291,7 +322,7 @@ at::Tensor _convolution(
     bool transposed_, IntList output_padding_, int64_t groups_,
     bool benchmark, bool deterministic, bool cudnn_enabled) {
 
-  auto input = input_r.contiguous();
+  auto input = input_r;
   auto weight = weight_r;
   auto bias = bias_r;
   auto k = weight.ndimension();
@@ -315,6 +346,17 @@ at::Tensor _convolution(
   if (params.is_padding_neg()) throw std::runtime_error("negative padding is not supported");
   if (params.is_output_padding_neg()) throw std::runtime_error("negative output_padding is not supported");
 
+  // cuDNN and MKL-DNN take channels-last inputs and produce channels-last
+  // outputs, see Note [Channels last]. Everything else wants contiguous inputs.
+  bool keep_channels_last =
+      suggest_memory_format(input.sizes(), input.strides()) == MemoryFormat::ChannelsLast &&
+      !params.is_depthwise(input, weight) &&
+      !params.use_nnpack(input, weight) &&
+      (params.use_cudnn(input) || params.use_mkldnn(input));
+  if (!keep_channels_last) {
+    input = input.contiguous();
+  }
+
   check_input_shape_forward(input, weight, bias, params.groups, params.transposed);
 
   if (k == 3) {
@@ -355,6 +397,19 @@ at::Tensor _convolution(
           input, weight, bias,
           params.padding, params.stride, params.dilation, params.groups, params.benchmark, params.deterministic);
     }
+  } else if (params.use_nnpack(input, weight)) {
+    if (input.type() != weight.type()){
+      std::stringstream ss;
+      ss << "Input type (" << input.toString() << ") and weight type (" << weight.toString() << ") should be the same";
+      throw std::runtime_error(ss.str());
+    }
+    if (bias.defined() && input.type() != bias.type()){
+      std::stringstream ss;
+      ss << "Input type (" << input.toString() << ") and bias type (" << bias.toString() << ") should be the same";
+      throw std::runtime_error(ss.str());
+    }
+
+    output = at::_nnpack_spatial_convolution(input, weight, bias, params.padding);
   } else if (params.use_mkldnn(input)) {
 #if AT_MKLDNN_ENABLED()
     if (input.type() != weight.type()){
@@ -370,6 +425,8 @@ at::Tensor _convolution(
 
     output = at::mkldnn_convolution(input, weight, bias, params.padding, params.stride, params.dilation, params.groups);
 #endif
+  } else if (params.use_cpu_native(input)) {
+    output = at::cpu_convolution(input, weight, bias, params.padding, params.stride, params.dilation, params.groups);
   } else {
     if (params.groups == 1) {
       output = at::_convolution_nogroup(
@@ -484,16 +541,19 @@ std::tuple<Tensor,Tensor,Tensor> _convolution_double_backward(
   params.deterministic = deterministic;
   params.cudnn_enabled = cudnn_enabled;
 
+  // Only the outputs selected by output_mask are computed, autodiff uses
+  // this function to compute first-order gradients.
+
   // Compute ggO = conv(ggI, w) + conv(i, ggW) + ggb
   Tensor ggO;
-  if (ggI.defined()) {
+  if (output_mask[0] && ggI.defined()) {
     if (weight.type().is_cuda()) {
       weight = weight.contiguous();
     }
     ggO = at::_convolution(ggI, weight, Tensor(), params.stride, params.padding, params.dilation, params.transposed, params.output_padding, params.groups, params.benchmark, params.deterministic, params.cudnn_enabled);
   }
 
-  if (ggW.defined()) {
+  if (output_mask[0] && ggW.defined()) {
     if (ggW.type().is_cuda()) {
       ggW = ggW.contiguous();
     }
@@ -505,7 +565,7 @@ std::tuple<Tensor,Tensor,Tensor> _convolution_double_backward(
     }
   }
 
-  if (ggb.defined()) {
+  if (output_mask[0] && ggb.defined()) {
     // View as (1, ggb.size(0), 1, 1...)
 
     // Expand
@@ -526,7 +586,7 @@ std::tuple<Tensor,Tensor,Tensor> _convolution_double_backward(
 
   // Compute gW = conv(ggI, gO)
   Tensor gW;
-  if (ggI.defined()) {
+  if (output_mask[2] && ggI.defined()) {
     // Modified params with correct padding
     ConvParams gw_conv_params(params);
 
@@ -593,7 +653,7 @@ std::tuple<Tensor,Tensor,Tensor> _convolution_double_backward(
   // Compute gI = convT(ggW, gO.t()) if !transposed
   //         gI = conv(go, ggw)      if transposed
   Tensor gI;
-  if (ggW.defined()) {
+  if (output_mask[1] && ggW.defined()) {
     ConvParams gi_conv_params(params);
     gi_conv_params.transposed = !params.transposed;
 
@@ -682,4 +742,23 @@ std::tuple<Tensor,Tensor,Tensor> _convolution_double_backward(
   return std::tuple<Tensor,Tensor,Tensor>{ggO, gI, gW};
 }
 
+// We call the following methods via CUDA hooks because they are really only
+// valid when cuDNN is available. See Note [Persistent benchmark cache] in
+// native/cudnn/Conv.cpp for more details.
+void _cudnn_save_benchmark_cache(std::string path) {
+  detail::getCUDAHooks().cuDNNSaveBenchmarkCache(path);
+}
+
+int64_t _cudnn_load_benchmark_cache(std::string path) {
+  return detail::getCUDAHooks().cuDNNLoadBenchmarkCache(path);
+}
+
+int64_t _cudnn_get_benchmark_cache_size() {
+  return detail::getCUDAHooks().cuDNNGetBenchmarkCacheSize();
+}
+
+void _cudnn_clear_benchmark_cache() {
+  detail::getCUDAHooks().cuDNNClearBenchmarkCache();
+}
+
 }} // at::native
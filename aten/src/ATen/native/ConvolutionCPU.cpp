@@ -0,0 +1,311 @@
+#include "ATen/ATen.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
+#include "ATen/native/ConvolutionCPU.h"
+
+#include <algorithm>
+#include <cstring>
+
+// 2d convolution on CPU without MKL-DNN.
+//
+// The input of each (sample, group) is unfolded (im2col) a tile of output rows
+// at a time, into a column buffer that is sized to stay in L2, and multiplied
+// with the weight of the group by a GEMM that writes the tile of the output in
+// place. The (sample, group, tile) items are run in parallel, each thread
+// reusing its own column buffer. 1x1 convolutions without stride or padding
+// multiply the input directly, and depthwise 3x3 convolutions use a direct
+// vectorized kernel.
+
+namespace at { namespace native {
+
+DEFINE_DISPATCH(depthwise3x3_stub);
+
+namespace {
+
+// The size of the column buffer of a thread, which should fit in L2 together
+// with the tile of the output.
+constexpr int64_t kColumnBufferBytes = 256 * 1024;
+
+struct ConvShape {
+  int64_t batch, groups;
+  int64_t in_channels, height, width;      // per group
+  int64_t out_channels, out_height, out_width;  // per group
+  int64_t kernel_h, kernel_w;
+  int64_t stride_h, stride_w, pad_h, pad_w, dilation_h, dilation_w;
+  int64_t tile_rows, tiles;
+
+  ConvShape(const Tensor& input, const Tensor& weight,
+            IntList padding, IntList stride, IntList dilation, int64_t groups_)
+    : batch(input.size(0)), groups(groups_),
+      in_channels(input.size(1) / groups_), height(input.size(2)), width(input.size(3)),
+      out_channels(weight.size(0) / groups_),
+      kernel_h(weight.size(2)), kernel_w(weight.size(3)),
+      stride_h(stride[0]), stride_w(stride[1]), pad_h(padding[0]), pad_w(padding[1]),
+      dilation_h(dilation[0]), dilation_w(dilation[1]) {
+    out_height = (height + 2 * pad_h - dilation_h * (kernel_h - 1) - 1) / stride_h + 1;
+    out_width = (width + 2 * pad_w - dilation_w * (kernel_w - 1) - 1) / stride_w + 1;
+    const int64_t row_bytes = std::max<int64_t>(1, columns() * out_width * input.type().elementSizeInBytes());
+    tile_rows = std::max<int64_t>(1, std::min(out_height, kColumnBufferBytes / row_bytes));
+    tiles = out_height > 0 ? (out_height + tile_rows - 1) / tile_rows : 0;
+  }
+
+  // The number of rows of the column matrix, which is the reduction dimension
+  // of the GEMM.
+  int64_t columns() const {
+    return in_channels * kernel_h * kernel_w;
+  }
+
+  // Whether the input is its own column matrix.
+  bool pointwise() const {
+    return kernel_h == 1 && kernel_w == 1 && stride_h == 1 && stride_w == 1 &&
+           pad_h == 0 && pad_w == 0;
+  }
+};
+
+// The range [begin, end) of output columns whose input column
+// ow * stride - pad + offset lies in [0, width).
+static inline void valid_range(
+    int64_t width, int64_t out_width, int64_t stride, int64_t pad, int64_t offset,
+    int64_t* begin, int64_t* end) {
+  const int64_t shift = pad - offset;
+  *begin = shift > 0 ? std::min(out_width, (shift + stride - 1) / stride) : 0;
+  *end = std::min(out_width, std::max(*begin, (width + shift + stride - 1) / stride));
+}
+
+// Unfolds the output rows [row_begin, row_end) of one (sample, group) input
+// into a (columns, (row_end - row_begin) * out_width) matrix.
+template <typename scalar_t>
+static void im2col_tile(
+    const ConvShape& s, const scalar_t* input, scalar_t* cols,
+    int64_t row_begin, int64_t row_end) {
+  const int64_t tile_width = (row_end - row_begin) * s.out_width;
+  for (int64_t c = 0; c < s.in_channels; c++) {
+    for (int64_t kh = 0; kh < s.kernel_h; kh++) {
+      for (int64_t kw = 0; kw < s.kernel_w; kw++) {
+        scalar_t* dst = cols + ((c * s.kernel_h + kh) * s.kernel_w + kw) * tile_width;
+        int64_t ow_begin, ow_end;
+        valid_range(s.width, s.out_width, s.stride_w, s.pad_w, kw * s.dilation_w, &ow_begin, &ow_end);
+        for (int64_t oh = row_begin; oh < row_end; oh++, dst += s.out_width) {
+          const int64_t ih = oh * s.stride_h - s.pad_h + kh * s.dilation_h;
+          if (ih < 0 || ih >= s.height) {
+            std::fill(dst, dst + s.out_width, scalar_t(0));
+            continue;
+          }
+          const scalar_t* src = input + (c * s.height + ih) * s.width - s.pad_w + kw * s.dilation_w;
+          std::fill(dst, dst + ow_begin, scalar_t(0));
+          if (s.stride_w == 1) {
+            std::memcpy(dst + ow_begin, src + ow_begin, (ow_end - ow_begin) * sizeof(scalar_t));
+          } else {
+            for (int64_t ow = ow_begin; ow < ow_end; ow++) {
+              dst[ow] = src[ow * s.stride_w];
+            }
+          }
+          std::fill(dst + ow_end, dst + s.out_width, scalar_t(0));
+        }
+      }
+    }
+  }
+}
+
+// The adjoint of im2col_tile: adds the columns back into the input.
+template <typename scalar_t>
+static void col2im_tile(
+    const ConvShape& s, const scalar_t* cols, scalar_t* input,
+    int64_t row_begin, int64_t row_end) {
+  const int64_t tile_width = (row_end - row_begin) * s.out_width;
+  for (int64_t c = 0; c < s.in_channels; c++) {
+    for (int64_t kh = 0; kh < s.kernel_h; kh++) {
+      for (int64_t kw = 0; kw < s.kernel_w; kw++) {
+        const scalar_t* src = cols + ((c * s.kernel_h + kh) * s.kernel_w + kw) * tile_width;
+        int64_t ow_begin, ow_end;
+        valid_range(s.width, s.out_width, s.stride_w, s.pad_w, kw * s.dilation_w, &ow_begin, &ow_end);
+        for (int64_t oh = row_begin; oh < row_end; oh++, src += s.out_width) {
+          const int64_t ih = oh * s.stride_h - s.pad_h + kh * s.dilation_h;
+          if (ih < 0 || ih >= s.height) {
+            continue;
+          }
+          scalar_t* dst = input + (c * s.height + ih) * s.width - s.pad_w + kw * s.dilation_w;
+          for (int64_t ow = ow_begin; ow < ow_end; ow++) {
+            dst[ow * s.stride_w] += src[ow];
+          }
+        }
+      }
+    }
+  }
+}
+
+// The (channels, rows * out_width) view of the output rows [row_begin,
+// row_end) of one (sample, group) of a (N, groups * channels, OH, OW) tensor.
+static Tensor output_tile(
+    const Tensor& t, const ConvShape& s, int64_t n, int64_t g, int64_t channels,
+    int64_t row_begin, int64_t row_end) {
+  return t[n].narrow(0, g * channels, channels)
+             .view({channels, s.out_height * s.out_width})
+             .narrow(1, row_begin * s.out_width, (row_end - row_begin) * s.out_width);
+}
+
+// The column matrix of a tile, either unfolded into buffer or, for pointwise
+// convolutions, a view of the input.
+static Tensor columns_tile(
+    const Tensor& input, const ConvShape& s, Tensor& buffer,
+    int64_t n, int64_t g, int64_t row_begin, int64_t row_end) {
+  if (s.pointwise()) {
+    return output_tile(input, s, n, g, s.in_channels, row_begin, row_end);
+  }
+  const int64_t tile_width = (row_end - row_begin) * s.out_width;
+  auto cols = buffer.narrow(0, 0, s.columns() * tile_width).view({s.columns(), tile_width});
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "im2col", [&] {
+    const scalar_t* in = input.data<scalar_t>() +
+        (n * s.groups + g) * s.in_channels * s.height * s.width;
+    im2col_tile<scalar_t>(s, in, cols.data<scalar_t>(), row_begin, row_end);
+  });
+  return cols;
+}
+
+static Tensor column_buffer(const Tensor& input, const ConvShape& s) {
+  return s.pointwise() ? Tensor() : input.type().tensor({s.columns() * s.tile_rows * s.out_width});
+}
+
+static void check_cpu_convolution(
+    const Tensor& input, const Tensor& weight, const Tensor& bias,
+    IntList padding, IntList stride, IntList dilation, int64_t groups) {
+  AT_CHECK(input.dim() == 4, "cpu_convolution: expected a 4-dimensional input, but got ", input.dim());
+  AT_CHECK(weight.dim() == 4, "cpu_convolution: expected a 4-dimensional weight, but got ", weight.dim());
+  AT_CHECK(input.type() == weight.type(), "cpu_convolution: input type (", input.type().toString(),
+           ") and weight type (", weight.type().toString(), ") should be the same");
+  AT_CHECK(!bias.defined() || input.type() == bias.type(), "cpu_convolution: input type (",
+           input.type().toString(), ") and bias type (", bias.type().toString(), ") should be the same");
+  AT_CHECK(padding.size() == 2 && stride.size() == 2 && dilation.size() == 2,
+           "cpu_convolution: expected 2-dimensional padding, stride and dilation");
+  AT_CHECK(groups > 0 && input.size(1) == weight.size(1) * groups && weight.size(0) % groups == 0,
+           "cpu_convolution: input ", input.sizes(), " does not match weight ", weight.sizes(),
+           " with ", groups, " groups");
+}
+
+} // namespace
+
+Tensor cpu_convolution(
+    const Tensor& input_, const Tensor& weight_, const Tensor& bias,
+    IntList padding, IntList stride, IntList dilation, int64_t groups) {
+  check_cpu_convolution(input_, weight_, bias, padding, stride, dilation, groups);
+  auto input = input_.contiguous();
+  auto weight = weight_.contiguous();
+  const ConvShape s(input, weight, padding, stride, dilation, groups);
+  AT_CHECK(s.out_height > 0 && s.out_width > 0,
+           "cpu_convolution: input ", input.sizes(), " is too small for weight ", weight.sizes());
+  auto output = input.type().tensor({s.batch, groups * s.out_channels, s.out_height, s.out_width});
+
+  if (groups == input.size(1) && s.out_channels == 1 && s.kernel_h == 3 && s.kernel_w == 3 &&
+      s.dilation_h == 1 && s.dilation_w == 1) {
+    depthwise3x3_stub(kCPU, output, input, weight, bias.defined() ? bias.contiguous() : bias,
+                      stride, padding);
+    return output;
+  }
+
+  const auto weight_g = weight.view({groups, s.out_channels, s.columns()});
+  const int64_t items = s.batch * groups * s.tiles;
+  parallel_for(0, items, 1, [&](int64_t begin, int64_t end) {
+    auto buffer = column_buffer(input, s);
+    for (int64_t item = begin; item < end; item++) {
+      const int64_t tile = item % s.tiles;
+      const int64_t g = (item / s.tiles) % groups;
+      const int64_t n = item / (s.tiles * groups);
+      const int64_t row_begin = tile * s.tile_rows;
+      const int64_t row_end = std::min(s.out_height, row_begin + s.tile_rows);
+      auto cols = columns_tile(input, s, buffer, n, g, row_begin, row_end);
+      auto out = output_tile(output, s, n, g, s.out_channels, row_begin, row_end);
+      if (bias.defined()) {
+        out.copy_(bias.narrow(0, g * s.out_channels, s.out_channels).view({s.out_channels, 1}).expand_as(out));
+        at::addmm_out(out, out, weight_g[g], cols);
+      } else {
+        at::mm_out(out, weight_g[g], cols);
+      }
+    }
+  });
+  return output;
+}
+
+static Tensor cpu_convolution_backward_input(
+    const Tensor& input, const Tensor& grad_output, const Tensor& weight, const ConvShape& s) {
+  auto grad_input = at::zeros_like(input);
+  const auto weight_t = weight.view({s.groups, s.out_channels, s.columns()}).transpose(1, 2);
+  // The tiles of a (sample, group) overlap in the input, so they are added
+  // by the same thread.
+  parallel_for(0, s.batch * s.groups, 1, [&](int64_t begin, int64_t end) {
+    auto buffer = column_buffer(input, s);
+    for (int64_t item = begin; item < end; item++) {
+      const int64_t g = item % s.groups;
+      const int64_t n = item / s.groups;
+      for (int64_t tile = 0; tile < s.tiles; tile++) {
+        const int64_t row_begin = tile * s.tile_rows;
+        const int64_t row_end = std::min(s.out_height, row_begin + s.tile_rows);
+        auto grad_out = output_tile(grad_output, s, n, g, s.out_channels, row_begin, row_end);
+        if (s.pointwise()) {
+          auto grad_in = output_tile(grad_input, s, n, g, s.in_channels, row_begin, row_end);
+          at::mm_out(grad_in, weight_t[g], grad_out);
+          continue;
+        }
+        const int64_t tile_width = (row_end - row_begin) * s.out_width;
+        auto cols = buffer.narrow(0, 0, s.columns() * tile_width).view({s.columns(), tile_width});
+        at::mm_out(cols, weight_t[g], grad_out);
+        AT_DISPATCH_FLOATING_TYPES(input.type(), "col2im", [&] {
+          scalar_t* in = grad_input.data<scalar_t>() +
+              (n * s.groups + g) * s.in_channels * s.height * s.width;
+          col2im_tile<scalar_t>(s, cols.data<scalar_t>(), in, row_begin, row_end);
+        });
+      }
+    }
+  });
+  return grad_input;
+}
+
+static Tensor cpu_convolution_backward_weight(
+    const Tensor& input, const Tensor& grad_output, const Tensor& weight, const ConvShape& s) {
+  // Each chunk of the batch accumulates into its own copy of the gradient,
+  // which are summed at the end.
+  const int64_t chunks = std::max<int64_t>(1, std::min<int64_t>(s.batch, get_num_threads()));
+  auto partial = at::zeros({chunks, s.groups, s.out_channels, s.columns()}, input.options());
+  parallel_for(0, chunks, 1, [&](int64_t begin, int64_t end) {
+    auto buffer = column_buffer(input, s);
+    for (int64_t chunk = begin; chunk < end; chunk++) {
+      auto grad_weight = partial[chunk];
+      for (int64_t n = chunk; n < s.batch; n += chunks) {
+        for (int64_t g = 0; g < s.groups; g++) {
+          auto grad_weight_g = grad_weight[g];
+          for (int64_t tile = 0; tile < s.tiles; tile++) {
+            const int64_t row_begin = tile * s.tile_rows;
+            const int64_t row_end = std::min(s.out_height, row_begin + s.tile_rows);
+            auto cols = columns_tile(input, s, buffer, n, g, row_begin, row_end);
+            auto grad_out = output_tile(grad_output, s, n, g, s.out_channels, row_begin, row_end);
+            at::addmm_out(grad_weight_g, grad_weight_g, grad_out, cols.t());
+          }
+        }
+      }
+    }
+  });
+  return partial.sum(0).view(weight.sizes());
+}
+
+std::tuple<Tensor, Tensor, Tensor> cpu_convolution_backward(
+    const Tensor& input_, const Tensor& grad_output_, const Tensor& weight_,
+    IntList padding, IntList stride, IntList dilation, int64_t groups,
+    std::array<bool, 3> output_mask) {
+  auto input = input_.contiguous();
+  auto grad_output = grad_output_.contiguous();
+  auto weight = weight_.contiguous();
+  const ConvShape s(input, weight, padding, stride, dilation, groups);
+
+  Tensor grad_input, grad_weight, grad_bias;
+  if (output_mask[0]) {
+    grad_input = cpu_convolution_backward_input(input, grad_output, weight, s);
+  }
+  if (output_mask[1]) {
+    grad_weight = cpu_convolution_backward_weight(input, grad_output, weight, s);
+  }
+  if (output_mask[2]) {
+    grad_bias = grad_output.sum({0, 2, 3});
+  }
+  return std::tuple<Tensor, Tensor, Tensor>{grad_input, grad_weight, grad_bias};
+}
+
+}} // namespace at::native
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// Depthwise 3x3 convolution of a contiguous (N, C, H, W) input with a
+// contiguous (C, 1, 3, 3) weight into a contiguous (N, C, OH, OW) output,
+// without dilation. bias may be undefined.
+using depthwise3x3_fn = void(*)(
+    Tensor& output, const Tensor& input, const Tensor& weight, const Tensor& bias,
+    IntList stride, IntList padding);
+
+DECLARE_DISPATCH(depthwise3x3_fn, depthwise3x3_stub);
+
+}} // namespace at::native
@@ -0,0 +1,38 @@
+#include "ATen/native/Copy.h"
+
+#include <ATen/ATen.h>
+#include <ATen/native/TensorIterator.h>
+
+namespace at {
+namespace native {
+
+DEFINE_DISPATCH(copy_stub);
+
+// Below this many elements building a TensorIterator costs about as much as
+// the copy itself, so small copies stay in TH.
+static constexpr int64_t kMinNativeCopySize = 4096;
+
+bool _copy_cpu_(Tensor& dst, const Tensor& src) {
+  if (dst.numel() < kMinNativeCopySize) {
+    return false;
+  }
+  // TH copies tensors of the same numel but different sizes; copy_ expands
+  // src to the sizes of dst before getting here.
+  if (!dst.sizes().equals(src.sizes())) {
+    return false;
+  }
+  // TH copies these with a single memcpy
+  if (dst.type() == src.type() && dst.is_contiguous() && src.is_contiguous()) {
+    return false;
+  }
+  // src keeps its own scalar type, so it doesn't take part in the common
+  // type of the iterator, which is just the type of dst.
+  auto iter = TensorIterator::Builder()
+    .add_output(dst)
+    .add_input(src, src.type().scalarType())
+    .build();
+  copy_stub(kCPU, *iter);
+  return true;
+}
+
+}} // namespace at::native
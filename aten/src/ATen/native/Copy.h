@@ -0,0 +1,20 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { struct TensorIterator; }
+
+namespace at { namespace native {
+
+using copy_fn = void(*)(TensorIterator&);
+
+DECLARE_DISPATCH(copy_fn, copy_stub);
+
+// Copies src into dst, two dense CPU tensors of the same sizes, converting
+// between scalar types as needed. Called from the generated s_copy_ of the
+// CPU types before they fall back to the TH copies; returns false, without
+// copying anything, for the copies that are left to TH.
+bool _copy_cpu_(Tensor& dst, const Tensor& src);
+
+}} // namespace at::native
@@ -0,0 +1,209 @@
+// Fused log_softmax + nll_loss over the classes of a 2D input.
+//
+// log_softmax followed by nll_loss materializes the N x C log-probabilities,
+// and the backward another N x C tensor for their gradient, which dominates
+// the memory of models with large vocabularies. Only the logsumexp of each
+// row is needed though: the loss of row i is lse_i - x[i, t_i], and its
+// gradient is softmax(x_i) - onehot(t_i) = exp(x_i - lse_i) - onehot(t_i).
+// The forward keeps the N logsumexps for the backward, which writes the
+// gradient directly.
+//
+// On CPU the logsumexp is computed in a single pass over each row with a
+// running maximum. Other backends use tensor ops over chunks of chunk_size
+// classes, so that the temporaries stay N x chunk_size.
+
+#include "ATen/ATen.h"
+#include "ATen/AccumulateType.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
+
+#include <cmath>
+#include <limits>
+#include <tuple>
+
+namespace at { namespace native {
+
+namespace {
+
+void check_cross_entropy_inputs(
+    const char* fn, const Tensor& self, const Tensor& target, const Tensor& weight) {
+  AT_CHECK(self.dim() == 2, fn, ": expected a 2D input, but got ", self.dim(), "D");
+  AT_CHECK(target.type().scalarType() == kLong,
+           fn, ": expected a Long target, but got ", target.type().toString());
+  AT_CHECK(target.dim() == 1 && target.size(0) == self.size(0),
+           fn, ": expected a target of size ", self.size(0), ", but got ", target.sizes());
+  AT_CHECK(!weight.defined() || (weight.dim() == 1 && weight.size(0) == self.size(1)),
+           fn, ": expected a weight of size ", self.size(1), ", but got ", weight.sizes());
+}
+
+// The targets, with the ignored ones replaced by class 0 so that they can be
+// gathered, and the weight of each row: weight[target], or 1 without weights,
+// and 0 for the ignored rows.
+std::tuple<Tensor, Tensor> target_weights(
+    const Tensor& self, const Tensor& target, const Tensor& weight, int64_t ignore_index) {
+  auto ignored = target.eq(ignore_index);
+  auto safe_target = target.clone().masked_fill_(ignored, 0);
+  auto valid = safe_target.ge(0).__and__(safe_target.lt(self.size(1)));
+  AT_CHECK(valid.all().toCByte(), "cross_entropy: target out of bounds");
+  Tensor row_weight;
+  if (weight.defined()) {
+    row_weight = weight.index_select(0, safe_target);
+  } else {
+    row_weight = at::ones({self.size(0)}, self.options());
+  }
+  row_weight.masked_fill_(ignored, 0);
+  return std::make_tuple(safe_target, row_weight);
+}
+
+Tensor reduce_losses(const Tensor& losses, const Tensor& row_weight, int64_t reduction) {
+  if (reduction == Reduction::ElementwiseMean) {
+    return losses.sum() / row_weight.sum();
+  } else if (reduction == Reduction::Sum) {
+    return losses.sum();
+  }
+  return losses;
+}
+
+// The factor of the softmax - onehot(target) gradient of each row
+Tensor gradient_scale(const Tensor& grad, const Tensor& row_weight, int64_t reduction) {
+  if (reduction == Reduction::ElementwiseMean) {
+    return row_weight * (grad / row_weight.sum());
+  }
+  return row_weight * grad;
+}
+
+template <typename scalar_t>
+void cross_entropy_logsumexp_cpu(const Tensor& self, Tensor& lse) {
+  using acc_t = acc_type<scalar_t, false>;
+  const int64_t n = self.size(0);
+  const int64_t c = self.size(1);
+  const scalar_t* input = self.data<scalar_t>();
+  scalar_t* lse_data = lse.data<scalar_t>();
+  parallel_for(0, n, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      const scalar_t* row = input + i * c;
+      // Sum of exp(x - max), rescaled when the maximum grows
+      acc_t max = -std::numeric_limits<acc_t>::infinity();
+      acc_t sum = 0;
+      for (int64_t j = 0; j < c; j++) {
+        const acc_t x = row[j];
+        if (x > max) {
+          sum = sum * std::exp(max - x) + 1;
+          max = x;
+        } else {
+          sum += std::exp(x - max);
+        }
+      }
+      lse_data[i] = static_cast<scalar_t>(max + std::log(sum));
+    }
+  });
+}
+
+template <typename scalar_t>
+void cross_entropy_backward_cpu_kernel(
+    const Tensor& self, const Tensor& target, const Tensor& lse, const Tensor& scale,
+    Tensor& grad_input) {
+  const int64_t n = self.size(0);
+  const int64_t c = self.size(1);
+  const scalar_t* input = self.data<scalar_t>();
+  const int64_t* target_data = target.data<int64_t>();
+  const scalar_t* lse_data = lse.data<scalar_t>();
+  const scalar_t* scale_data = scale.data<scalar_t>();
+  scalar_t* grad_data = grad_input.data<scalar_t>();
+  parallel_for(0, n, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      const scalar_t* row = input + i * c;
+      scalar_t* grad_row = grad_data + i * c;
+      const scalar_t s = scale_data[i];
+      if (s == 0) {
+        std::fill(grad_row, grad_row + c, scalar_t(0));
+        continue;
+      }
+      const scalar_t row_lse = lse_data[i];
+      for (int64_t j = 0; j < c; j++) {
+        grad_row[j] = s * std::exp(row[j] - row_lse);
+      }
+      grad_row[target_data[i]] -= s;
+    }
+  });
+}
+
+} // namespace
+
+Tensor cross_entropy(const Tensor& self, const Tensor& target, const Tensor& weight,
+                     int64_t reduction, int64_t ignore_index, int64_t chunk_size) {
+  return std::get<0>(at::_cross_entropy_forward(
+      self, target, weight, reduction, ignore_index, chunk_size));
+}
+
+std::tuple<Tensor, Tensor> cross_entropy_forward_cpu(
+    const Tensor& self_, const Tensor& target_, const Tensor& weight,
+    int64_t reduction, int64_t ignore_index, int64_t chunk_size) {
+  check_cross_entropy_inputs("cross_entropy", self_, target_, weight);
+  auto self = self_.contiguous();
+  auto lse = at::empty({self.size(0)}, self.options());
+  AT_DISPATCH_FLOATING_TYPES(self.type(), "cross_entropy_forward", [&] {
+    cross_entropy_logsumexp_cpu<scalar_t>(self, lse);
+  });
+  Tensor target, row_weight;
+  std::tie(target, row_weight) = target_weights(self, target_, weight, ignore_index);
+  auto target_logit = self.gather(1, target.unsqueeze(1)).squeeze(1);
+  auto losses = (lse - target_logit) * row_weight;
+  return std::make_tuple(reduce_losses(losses, row_weight, reduction), lse);
+}
+
+Tensor cross_entropy_backward_cpu(
+    const Tensor& grad, const Tensor& self_, const Tensor& target_, const Tensor& weight,
+    int64_t reduction, int64_t ignore_index, int64_t chunk_size, const Tensor& lse) {
+  check_cross_entropy_inputs("cross_entropy_backward", self_, target_, weight);
+  auto self = self_.contiguous();
+  Tensor target, row_weight;
+  std::tie(target, row_weight) = target_weights(self, target_, weight, ignore_index);
+  auto scale = gradient_scale(grad, row_weight, reduction).contiguous();
+  auto grad_input = at::empty_like(self);
+  AT_DISPATCH_FLOATING_TYPES(self.type(), "cross_entropy_backward", [&] {
+    cross_entropy_backward_cpu_kernel<scalar_t>(
+        self, target.contiguous(), lse.contiguous(), scale, grad_input);
+  });
+  return grad_input;
+}
+
+std::tuple<Tensor, Tensor> cross_entropy_forward_chunked(
+    const Tensor& self, const Tensor& target_, const Tensor& weight,
+    int64_t reduction, int64_t ignore_index, int64_t chunk_size) {
+  check_cross_entropy_inputs("cross_entropy", self, target_, weight);
+  const int64_t c = self.size(1);
+  const int64_t chunk = chunk_size > 0 ? chunk_size : c;
+  Tensor lse;
+  for (int64_t start = 0; start < c; start += chunk) {
+    auto chunk_lse = self.narrow(1, start, std::min(chunk, c - start)).logsumexp(1);
+    lse = lse.defined() ? at::stack({lse, chunk_lse}, 1).logsumexp(1) : chunk_lse;
+  }
+  Tensor target, row_weight;
+  std::tie(target, row_weight) = target_weights(self, target_, weight, ignore_index);
+  auto target_logit = self.gather(1, target.unsqueeze(1)).squeeze(1);
+  auto losses = (lse - target_logit) * row_weight;
+  return std::make_tuple(reduce_losses(losses, row_weight, reduction), lse);
+}
+
+Tensor cross_entropy_backward_chunked(
+    const Tensor& grad, const Tensor& self, const Tensor& target_, const Tensor& weight,
+    int64_t reduction, int64_t ignore_index, int64_t chunk_size, const Tensor& lse) {
+  check_cross_entropy_inputs("cross_entropy_backward", self, target_, weight);
+  const int64_t c = self.size(1);
+  const int64_t chunk = chunk_size > 0 ? chunk_size : c;
+  Tensor target, row_weight;
+  std::tie(target, row_weight) = target_weights(self, target_, weight, ignore_index);
+  auto scale = gradient_scale(grad, row_weight, reduction).unsqueeze(1);
+  auto grad_input = at::empty_like(self);
+  for (int64_t start = 0; start < c; start += chunk) {
+    const int64_t length = std::min(chunk, c - start);
+    auto grad_chunk = grad_input.narrow(1, start, length);
+    at::sub_out(grad_chunk, self.narrow(1, start, length), lse.unsqueeze(1));
+    grad_chunk.exp_().mul_(scale);
+  }
+  grad_input.scatter_add_(1, target.unsqueeze(1), -scale);
+  return grad_input;
+}
+
+}}  // namespace at::native
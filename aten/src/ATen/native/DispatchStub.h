@@ -28,7 +28,7 @@
 // To call:
 //   stub(kCPU, tensor);
 
-// ignore warnings about DispatchStub::DEFAULT, AVX, AVX2 defined elsewhere
+// ignore warnings about DispatchStub::DEFAULT, AVX, AVX2, AVX512 defined elsewhere
 #if defined(__clang__)
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wundefined-var-template"
@@ -40,10 +40,11 @@ enum class CPUCapability {
   DEFAULT = 0,
   AVX = 1,
   AVX2 = 2,
+  AVX512 = 3,
   NUM_OPTIONS
 };
 
-CPUCapability get_cpu_capability();
+AT_API CPUCapability get_cpu_capability();
 
 template <typename FnPtr, typename T>
 struct AT_API DispatchStub {
@@ -67,6 +68,12 @@ struct AT_API DispatchStub {
   FnPtr choose_cpu_impl() {
     auto capability = static_cast<int>(get_cpu_capability());
     (void)capability;
+#ifdef HAVE_AVX512_CPU_DEFINITION
+    if (capability >= static_cast<int>(CPUCapability::AVX512)) {
+      AT_ASSERTM(AVX512, "DispatchStub: missing AVX512 kernel");
+      return AVX512;
+    }
+#endif
 #ifdef HAVE_AVX2_CPU_DEFINITION
     if (capability >= static_cast<int>(CPUCapability::AVX2)) {
       AT_ASSERTM(AVX2, "DispatchStub: missing AVX2 kernel");
@@ -92,6 +99,9 @@ struct AT_API DispatchStub {
 #ifdef HAVE_AVX2_CPU_DEFINITION
   static FnPtr AVX2;
 #endif
+#ifdef HAVE_AVX512_CPU_DEFINITION
+  static FnPtr AVX512;
+#endif
 };
 
 namespace {
@@ -124,10 +134,17 @@ struct RegisterDispatch {
 #define REGISTER_AVX2_DISPATCH(name, fn)
 #endif
 
+#ifdef HAVE_AVX512_CPU_DEFINITION
+#define REGISTER_AVX512_DISPATCH(name, fn) REGISTER_ARCH_DISPATCH(name, AVX512, fn)
+#else
+#define REGISTER_AVX512_DISPATCH(name, fn)
+#endif
+
 #define REGISTER_NO_CPU_DISPATCH(name, fn_type)                                \
   REGISTER_ARCH_DISPATCH(name, DEFAULT, static_cast<fn_type>(nullptr))         \
   REGISTER_AVX_DISPATCH(name, static_cast<fn_type>(nullptr))                   \
-  REGISTER_AVX2_DISPATCH(name, static_cast<fn_type>(nullptr))
+  REGISTER_AVX2_DISPATCH(name, static_cast<fn_type>(nullptr))                  \
+  REGISTER_AVX512_DISPATCH(name, static_cast<fn_type>(nullptr))
 
 #define REGISTER_CUDA_DISPATCH(name, fn) \
   static RegisterDispatch<decltype(fn), struct name> name ## __register(name, fn);
@@ -1,10 +1,119 @@
 #include "ATen/ATen.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/native/Distance.h"
 
+#include <algorithm>
 
 namespace at { namespace native {
 
+DEFINE_DISPATCH(cdist_stub);
+DEFINE_DISPATCH(cdist_backward_stub);
+
+// Rows of at least this many features compute Euclidean distances with one
+// GEMM: ||x - y||^2 = ||x||^2 + ||y||^2 - 2 x.y. Below it, the direct kernel
+// is as fast and does not lose precision for nearby points.
+constexpr int64_t kEuclideanGemmMinDim = 16;
+// cdist_topk computes the distances to about this many rows of x2 at a time
+constexpr int64_t kTopkBlockElems = 1 << 22;
+
 Tensor pairwise_distance(const Tensor& x1, const Tensor& x2, double p, double eps, bool keepdim) {
   return at::norm(x1 - x2 + eps, p, 1, keepdim);
 }
+
+static void check_cdist_args(const char* fn, const Tensor& x1, const Tensor& x2, double p) {
+  AT_CHECK(x1.dim() == 2 && x2.dim() == 2,
+           fn, ": expected 2D tensors, but got x1 of size ", x1.sizes(),
+           " and x2 of size ", x2.sizes());
+  AT_CHECK(x1.size(1) == x2.size(1),
+           fn, ": x1 and x2 must have the same number of columns, but got ",
+           x1.size(1), " and ", x2.size(1));
+  AT_CHECK(x1.type() == x2.type(),
+           fn, ": expected x1 and x2 of the same type, but got ", x1.type(),
+           " and ", x2.type());
+  AT_CHECK(at::isFloatingType(x1.type().scalarType()),
+           fn, ": expected floating point tensors, but got ", x1.type());
+  AT_CHECK(p >= 0, fn, ": p must be non-negative, but got ", p);
+}
+
+static inline bool use_euclidean_gemm(const Tensor& x1, double p) {
+  return p == 2 && x1.size(1) >= kEuclideanGemmMinDim;
+}
+
+Tensor cdist(const Tensor& x1, const Tensor& x2, double p) {
+  check_cdist_args("cdist", x1, x2, p);
+  return at::_cdist_forward(x1, x2, p);
+}
+
+Tensor _cdist_forward(const Tensor& x1, const Tensor& x2, double p) {
+  auto N = x1.size(0);
+  auto M = x2.size(0);
+  if (N == 0 || M == 0 || x1.size(1) == 0) {
+    return at::zeros({N, M}, x1.options());
+  }
+  if (use_euclidean_gemm(x1, p)) {
+    // rounding can make the squared distance of nearby points negative
+    auto x1_norm = x1.pow(2).sum(1, /*keepdim=*/true);
+    auto x2_norm = x2.pow(2).sum(1, /*keepdim=*/true);
+    auto result = at::addmm(x2_norm.t(), x1, x2.t(), 1, -2);
+    return result.add_(x1_norm).clamp_min_(0).sqrt_();
+  }
+  auto result = at::empty({N, M}, x1.options());
+  cdist_stub(x1.type().device_type(), result, x1.contiguous(), x2.contiguous(), p);
+  return result;
+}
+
+Tensor _cdist_backward(const Tensor& grad, const Tensor& x1, const Tensor& x2, double p, const Tensor& cdist) {
+  if (p == 0 || x1.numel() == 0 || x2.size(0) == 0) {
+    return at::zeros_like(x1);
+  }
+  if (use_euclidean_gemm(x1, p)) {
+    // d cdist(i, j) / d x1(i) = (x1(i) - x2(j)) / cdist(i, j), and 0 for
+    // coinciding points
+    auto w = grad.div(cdist).masked_fill_(cdist == 0, 0);
+    return x1 * w.sum(1, /*keepdim=*/true) - w.mm(x2);
+  }
+  auto grad_x1 = at::empty({x1.size(0), x1.size(1)}, x1.options());
+  cdist_backward_stub(x1.type().device_type(), grad_x1, grad.contiguous(),
+                      x1.contiguous(), x2.contiguous(), p, cdist.contiguous());
+  return grad_x1;
+}
+
+// The k nearest (or, with largest, farthest) rows of x2 for every row of x1.
+// The distances are computed for blocks of rows of x2 and merged into the
+// running top k, so that the full (N, M) matrix is never materialized.
+std::tuple<Tensor, Tensor> cdist_topk(const Tensor& x1, const Tensor& x2, int64_t k, double p, bool largest) {
+  check_cdist_args("cdist_topk", x1, x2, p);
+  auto N = x1.size(0);
+  auto M = x2.size(0);
+  AT_CHECK(k >= 0 && k <= M, "cdist_topk: k (", k, ") must be between 0 and the number of rows of x2 (", M, ")");
+  if (k == 0) {
+    return std::make_tuple(at::empty({N, 0}, x1.options()),
+                           at::empty({N, 0}, x1.options().dtype(kLong)));
+  }
+
+  auto block = std::max(k, kTopkBlockElems / std::max<int64_t>(N, 1));
+  Tensor values, indices;
+  for (int64_t start = 0; start < M; start += block) {
+    auto length = std::min(block, M - start);
+    auto dist = at::cdist(x1, x2.narrow(0, start, length), p);
+    Tensor block_values, block_indices;
+    std::tie(block_values, block_indices) =
+        dist.topk(std::min(k, length), 1, largest, /*sorted=*/false);
+    block_indices.add_(start);
+    if (!values.defined()) {
+      values = block_values;
+      indices = block_indices;
+      continue;
+    }
+    Tensor merged_values = at::cat({values, block_values}, 1);
+    Tensor merged_indices = at::cat({indices, block_indices}, 1);
+    Tensor pos;
+    std::tie(values, pos) = merged_values.topk(k, 1, largest, /*sorted=*/false);
+    indices = merged_indices.gather(1, pos);
+  }
+  Tensor pos;
+  std::tie(values, pos) = values.sort(1, /*descending=*/largest);
+  return std::make_tuple(values, indices.gather(1, pos));
+}
+
 }}  // namespace at::native
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// Writes the p-norm distances between the rows of the contiguous (N, D) x1
+// and (M, D) x2 to the contiguous (N, M) result. p = 0 counts the differing
+// elements and p = infinity takes the largest difference.
+using cdist_fn = void(*)(Tensor& result, const Tensor& x1, const Tensor& x2, double p);
+// Writes the gradient of cdist with respect to x1 to the contiguous (N, D)
+// grad_x1, given the contiguous (N, M) grad and distances cdist.
+using cdist_backward_fn = void(*)(
+    Tensor& grad_x1, const Tensor& grad, const Tensor& x1, const Tensor& x2,
+    double p, const Tensor& cdist);
+
+DECLARE_DISPATCH(cdist_fn, cdist_stub);
+DECLARE_DISPATCH(cdist_backward_fn, cdist_backward_stub);
+
+}} // namespace at::native
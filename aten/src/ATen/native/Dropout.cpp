@@ -82,7 +82,7 @@ ALIAS_SPECIALIZATION(_feature_alpha_dropout, true,  true )
 
 Tensor dropout(const Tensor& input, double p, bool train) {
   if (train && is_fused_kernel_acceptable(input, p)) {
-    return std::get<0>(input._fused_dropout(1 - p));
+    return std::get<0>(at::_fused_dropout_philox(input, 1 - p));
   }
   return _dropout<false>(input, p, train);
 }
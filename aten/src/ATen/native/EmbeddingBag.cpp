@@ -1,9 +1,12 @@
 #include "ATen/ATen.h"
 #include "ATen/TensorUtils.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
+#include "ATen/native/cpu/EmbeddingBagKernel.h"
 
 #include "TH/THBlasUtils.h"
 
+#include <cmath>
 #include <cstring>
 #include <iostream>
 #include <memory>
@@ -23,6 +26,9 @@ namespace {
 namespace at {
 namespace native {
 
+DEFINE_DISPATCH(embedding_bag_sum_stub);
+DEFINE_DISPATCH(embedding_bag_rowwise_stub);
+
 static void make_offset2bag(const Tensor &offsets, const Tensor &indices,
                             Tensor &offset2bag) {
   offset2bag.index_add_(
@@ -31,31 +37,71 @@ static void make_offset2bag(const Tensor &offsets, const Tensor &indices,
   offset2bag = offset2bag.cumsum(0);     // offset2bag = [0 0 1 1 2]
 }
 
-// This function combines index_select (using select_indices as the index) and
-// index_add (using add_indices as the index), without creating an intermediary
-// tensor to hold the selected embeddings
-template<typename T>
-static void index_select_add(const Tensor &select_indices,
-                             const Tensor &add_indices,
-                             const Tensor &src,
-                             Tensor &output) {
-  auto add_indices_data = add_indices.data<int64_t>();
-  auto select_indices_data = select_indices.data<int64_t>();
-  auto src_data = src.data<T>();
-  auto output_data = output.data<T>();
-  auto numel = add_indices.numel();
-  int64_t ddim = src.size(1);
-  auto src_stride0 = src.stride(0);
-  auto src_stride1 = src.stride(1);
-  auto output_stride0 = output.stride(0);
-  auto output_stride1 = output.stride(1);
-  for (int64_t i = 0; i < numel; i++) {
-    THBlas_axpy<T>(ddim, 1,
-            src_data + src_stride0 * select_indices_data[i], src_stride1,
-            output_data + output_stride0 * add_indices_data[i], output_stride1);
+static Tensor make_offset2bag(const Tensor &offsets, const Tensor &indices) {
+  // If the last entries are empty, that the last offsets are irrelevant as they
+  // won't change anything in the assignment of ID -> bag, but index_add would
+  // throw out of bounds error. So to keep it simple we just add one more
+  // entry to the end then get rid of it after make_offset2bag.
+  auto offset2bag = at::zeros(
+     {indices.sizes()[0] + 1}, indices.options()); // offset2bag = [0 0 0 0 0]
+
+  make_offset2bag(offsets, indices, offset2bag);
+
+  offset2bag.resize_({indices.sizes()[0]});
+  return offset2bag;
+}
+
+// The CPU forward doesn't compute offset2bag for MODE_SUM and MODE_MEAN, see
+// _embedding_bag_cpu. Recomputes it for the backward in that case.
+static Tensor offset2bag_for_backward(const Tensor &offsets,
+                                      const Tensor &indices,
+                                      const Tensor &offset2bag) {
+  if (offset2bag.numel() == 0 && indices.numel() > 0) {
+    return make_offset2bag(offsets, indices);
+  }
+  return offset2bag;
+}
+
+// The kernels reduce the bags in parallel, so the indices and offsets are
+// checked up front.
+static void check_indices_and_offsets(int64_t num_weights,
+                                      const Tensor &indices,
+                                      const Tensor &offsets) {
+  if (indices.numel() > 0) {
+    auto min_index = indices.min().toCLong();
+    auto max_index = indices.max().toCLong();
+    AT_CHECK(min_index >= 0 && max_index < num_weights,
+             "embedding_bag: index out of range, expected indices in [0, ",
+             num_weights, "), got ", min_index < 0 ? min_index : max_index);
+  }
+  if (offsets.numel() > 0) {
+    auto min_offset = offsets.min().toCLong();
+    auto max_offset = offsets.max().toCLong();
+    AT_CHECK(min_offset >= 0 && max_offset <= indices.numel(),
+             "embedding_bag: offset out of range, expected offsets in [0, ",
+             indices.numel(), "], got ", min_offset < 0 ? min_offset : max_offset);
   }
 }
 
+static void check_per_sample_weights(const Tensor &per_sample_weights,
+                                     const Tensor &weight,
+                                     const Tensor &indices,
+                                     const int64_t mode) {
+  AT_CHECK(mode == MODE_SUM,
+           "embedding_bag: per_sample_weights is only supported for mode='sum' "
+           "(got mode=", mode, ")");
+  AT_CHECK(per_sample_weights.dim() == 1,
+           "embedding_bag: expected per_sample_weights to be 1-D, got ",
+           per_sample_weights.dim(), "-D");
+  AT_CHECK(per_sample_weights.numel() == indices.numel(),
+           "embedding_bag: expected per_sample_weights to have the same number "
+           "of elements as indices (", indices.numel(), "), got ",
+           per_sample_weights.numel());
+  AT_CHECK(per_sample_weights.type() == weight.type(),
+           "embedding_bag: expected per_sample_weights to have type ",
+           weight.type().toString(), ", got ", per_sample_weights.type().toString());
+}
+
 static void make_bag_size(const Tensor &offsets, const Tensor &indices,
                           const int64_t mode, Tensor &bag_size) {
   if (mode == MODE_MEAN || mode == MODE_MAX) {
@@ -69,26 +115,6 @@ static void make_bag_size(const Tensor &offsets, const Tensor &indices,
   }
 }
 
-static Tensor apply_bag_size(const Tensor &offsets, const Tensor &indices,
-                             const int64_t mode, Tensor &output,
-                             const Tensor &bag_size) {
-  if (mode == MODE_MEAN) {
-    if (offsets.size(0) == 1) {
-      auto bag_size_ = indices.size(0);
-      output /= bag_size_;
-    } else {
-      // Avoid dividing by 0 for empty bags.
-      // Instead we want empty bags to return all 0s
-      auto bag_size_ = at::max(bag_size, at::ones_like(bag_size))
-                           .toType(output.type())
-                           .unsqueeze(1)
-                           .expand_as(output);
-      output /= bag_size_;
-    }
-  }
-  return output;
-}
-
 static Tensor apply_bag_size_backward(const Tensor &offsets,
                                       const Tensor &indices, const int64_t mode,
                                       Tensor &output, const Tensor &offset2bag,
@@ -155,9 +181,11 @@ std::tuple<Tensor, Tensor, Tensor, Tensor> embedding_bag_cpu_max(
 std::tuple<Tensor, Tensor, Tensor, Tensor>
 embedding_bag(const Tensor &weight, const Tensor &indices,
               const Tensor &offsets, const bool scale_grad_by_freq,
-              const int64_t mode, bool sparse) {
+              const int64_t mode, bool sparse,
+              const Tensor &per_sample_weights) {
   return at::_embedding_bag(weight, indices.contiguous(), offsets.contiguous(),
-                            scale_grad_by_freq, mode, sparse);
+                            scale_grad_by_freq, mode, sparse,
+                            per_sample_weights);
   };
 
 // Assumes all input tensors except for `weight` are contiguous.
@@ -165,39 +193,33 @@ embedding_bag(const Tensor &weight, const Tensor &indices,
 std::tuple<Tensor, Tensor, Tensor, Tensor>
 _embedding_bag_cpu(const Tensor &weight, const Tensor &indices,
                   const Tensor &offsets, const bool scale_grad_by_freq,
-                  const int64_t mode, bool sparse) {
+                  const int64_t mode, bool sparse,
+                  const Tensor &per_sample_weights) {
   auto indices_arg = TensorArg(indices, "indices", 1);
   checkScalarType("embedding_bag", indices_arg, kLong);
   auto offsets_arg = TensorArg(offsets, "offsets", 1);
   checkScalarType("embedding_bag", indices_arg, kLong);
   auto weight_arg = TensorArg(weight, "weight", 1);
   checkScalarTypes("embedding_bag", weight_arg, {kFloat, kDouble});
+  if (per_sample_weights.defined()) {
+    check_per_sample_weights(per_sample_weights, weight, indices, mode);
+  }
 
   auto bag_size = at::zeros(offsets.sizes(), indices.type());
   make_bag_size(offsets, indices, mode, bag_size);
 
-  // If the last entries are empty, that the last offsets are irrelevant as they
-  // won't change anything in the assignment of ID -> bag, but index_add would
-  // throw out of bounds error. So to keep it simple we just add one more
-  // entry to the end then get rid of it after make_offset2bag.
-  auto offset2bag = at::zeros(
-     {indices.sizes()[0] + 1}, indices.options()); // offset2bag = [0 0 0 0 0]
-
-  make_offset2bag(offsets, indices, offset2bag);
-
-  offset2bag.resize_({indices.sizes()[0]});
-
-  auto output = at::zeros({offsets.size(0), weight.size(1)}, weight.options());
-
   if (mode == MODE_MEAN || mode == MODE_SUM) {
-    if (weight.type().scalarType() == kFloat) {
-      index_select_add<float>(indices, offset2bag, weight, output);
-    } else if (weight.type().scalarType() == kDouble) {
-      index_select_add<double>(indices, offset2bag, weight, output);
-    }
-    auto ret = apply_bag_size(offsets, indices, mode, output, bag_size);
-    return std::tuple<Tensor, Tensor, Tensor, Tensor>(ret, offset2bag, bag_size, bag_size);
+    // The kernel reduces every bag straight from `weight`, so offset2bag
+    // isn't needed here; the backward recomputes it.
+    check_indices_and_offsets(weight.size(0), indices, offsets);
+    auto output = at::empty({offsets.size(0), weight.size(1)}, weight.options());
+    embedding_bag_sum_stub(kCPU, output, weight, indices, offsets,
+                           per_sample_weights, mode == MODE_MEAN);
+    auto offset2bag = at::empty({0}, indices.options());
+    return std::tuple<Tensor, Tensor, Tensor, Tensor>(output, offset2bag, bag_size, bag_size);
   } else { // MODE_MAX
+    auto offset2bag = make_offset2bag(offsets, indices);
+    auto output = at::zeros({offsets.size(0), weight.size(1)}, weight.options());
     return AT_DISPATCH_FLOATING_TYPES_AND_HALF(
       weight.type(), "embedding_bag_cpu_max", [&]() {
         return embedding_bag_cpu_max<scalar_t>(weight, indices, offset2bag, output, bag_size, offsets);
@@ -215,7 +237,8 @@ Tensor _embedding_bag_backward(const Tensor &grad, const Tensor &indices,
                               const Tensor &max_indices_,
                               int64_t num_weights,
                               bool scale_grad_by_freq, int64_t mode,
-                              bool sparse) {
+                              bool sparse,
+                              const Tensor &per_sample_weights) {
   auto indices_arg = TensorArg(indices, "indices", 1);
   checkScalarType("embedding_bag", indices_arg, kLong);
   checkContiguous("embedding_bag", indices_arg);
@@ -226,14 +249,15 @@ Tensor _embedding_bag_backward(const Tensor &grad, const Tensor &indices,
   checkScalarType("embedding_bag", offset2bag_arg, kLong);
   checkContiguous("embedding_bag", offset2bag_arg);
 
+  auto offset2bag_ = offset2bag_for_backward(offsets, indices, offset2bag);
   if (sparse) {
     return at::_embedding_bag_sparse_backward(
-        grad, indices, offsets, offset2bag, bag_size_, num_weights,
-        scale_grad_by_freq, mode);
+        grad, indices, offsets, offset2bag_, bag_size_, num_weights,
+        scale_grad_by_freq, mode, per_sample_weights);
   } else {
     return at::_embedding_bag_dense_backward(
-        grad, indices, offsets, offset2bag, bag_size_, max_indices_, num_weights,
-        scale_grad_by_freq, mode);
+        grad, indices, offsets, offset2bag_, bag_size_, max_indices_, num_weights,
+        scale_grad_by_freq, mode, per_sample_weights);
   }
 }
 
@@ -242,7 +266,8 @@ Tensor _embedding_bag_dense_backward_cpu(const Tensor &grad_, const Tensor &indi
                                   const Tensor &offset2bag__,
                                   const Tensor &bag_size_,
                                   const Tensor& max_indices_, int64_t num_weights,
-                                  bool scale_grad_by_freq, int64_t mode) {
+                                  bool scale_grad_by_freq, int64_t mode,
+                                  const Tensor& per_sample_weights_) {
   // indices_, offsets_ and offset2bag__ are assumed having correct dtypes and
   // contiguous here due to the checks in _embedding_bag_backward above.
   // Also see NOTE [ embedding_bag Native Functions ] in native_functions.yaml
@@ -262,8 +287,16 @@ Tensor _embedding_bag_dense_backward_cpu(const Tensor &grad_, const Tensor &indi
   auto indices_data = indices.data<int64_t>();
   auto offsets_data = offsets_.data<int64_t>();
   auto offset2bag_data = offset2bag.data<int64_t>();
+  auto ind_sort_data = ind_sort.data<int64_t>();
   int64_t numel = indices.numel();
 
+  Tensor per_sample_weights;
+  const double* per_sample_weights_data = nullptr;
+  if (per_sample_weights_.defined()) {
+    per_sample_weights = per_sample_weights_.toType(kDouble).contiguous();
+    per_sample_weights_data = per_sample_weights.data<double>();
+  }
+
   std::vector<int64_t> counts(num_weights);
   for (int i = 0; i < numel; i++) {
     counts[indices_data[i]] = 0;
@@ -297,6 +330,9 @@ Tensor _embedding_bag_dense_backward_cpu(const Tensor &grad_, const Tensor &indi
           if (scale_grad_by_freq) {
             scale /= counts[indices_data[i]];
           }
+          if (per_sample_weights_data) {
+            scale *= per_sample_weights_data[ind_sort_data[j]];
+          }
           if (mode == 1) { // MODE_MEAN
             if (offsets_.size(0) == 1) {
               auto bag_size = indices.size(0);
@@ -339,7 +375,7 @@ Tensor _embedding_bag_dense_backward_cpu(const Tensor &grad_, const Tensor &indi
 Tensor _embedding_bag_sparse_backward(
     const Tensor &grad_, const Tensor &indices, const Tensor &offsets,
     const Tensor &offset2bag, const Tensor &bag_size_, int64_t num_weights,
-    bool scale_grad_by_freq, int64_t mode) {
+    bool scale_grad_by_freq, int64_t mode, const Tensor &per_sample_weights) {
   // indices, offsets and offset2bag are assumed having correct dtypes and
   // contiguous here due to the checks in _embedding_bag_backward above.
   // Also see NOTE [ embedding_bag Native Functions ] in native_functions.yaml
@@ -349,8 +385,156 @@ Tensor _embedding_bag_sparse_backward(
   Tensor index_grad = grad_.index_select(0, offset2bag);
   index_grad = apply_bag_size_backward(offsets, indices, mode, index_grad,
                                        offset2bag, bag_size_);
+  if (per_sample_weights.defined()) {
+    AT_ASSERT(mode == MODE_SUM);
+    index_grad.mul_(per_sample_weights.unsqueeze(1));
+  }
   return native::embedding_backward(index_grad, indices, num_weights, -1,
                                     scale_grad_by_freq, true);
 }
+
+Tensor _embedding_bag_per_sample_weights_backward(
+    const Tensor &grad, const Tensor &weight, const Tensor &indices,
+    const Tensor &offsets, const Tensor &offset2bag, int64_t mode) {
+  AT_CHECK(mode == MODE_SUM,
+           "embedding_bag: per_sample_weights is only supported for mode='sum'");
+  auto offset2bag_ = offset2bag_for_backward(offsets, indices, offset2bag);
+  // grad_psw[i] = <grad[offset2bag[i]], weight[indices[i]]>
+  return (grad.index_select(0, offset2bag_) * weight.index_select(0, indices))
+      .sum(1);
+}
+
+// Note [Row-wise quantized embeddings]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// _embedding_bag_pack_rowwise quantizes every row of a float embedding table
+// to `bit_rate` (8 or 4) bits with its own scale and bias, like the fused
+// 8-bit row-wise operators of Caffe2. It returns a Byte tensor with a row of
+//
+//   [embedding_dim * bit_rate / 8 quantized values][float scale][float bias]
+//
+// for every row of the table, so the table is 4 or 8 times smaller (minus
+// the 8 bytes of scale and bias). With 4 bits, the value of dimension d is in
+// the low nibble of byte d / 2 if d is even, and in the high nibble otherwise.
+// A value q stands for q * scale + bias, where bias is the minimum of the row
+// and scale its range divided by 2^bit_rate - 1.
+//
+// _embedding_bag_rowwise computes embedding_bag in mode sum or mean directly
+// from the packed table, and _embedding_bag_unpack_rowwise dequantizes it.
+// Packing is done on the CPU; the packed table can be moved to CUDA.
+
+static int64_t rowwise_embedding_dim(const Tensor &packed, int64_t bit_rate) {
+  AT_CHECK(bit_rate == 8 || bit_rate == 4,
+           "embedding_bag_rowwise: bit_rate has to be 8 or 4, but got ", bit_rate);
+  AT_CHECK(packed.dim() == 2 && packed.type().scalarType() == kByte,
+           "embedding_bag_rowwise: expected a 2-D Byte tensor from "
+           "_embedding_bag_pack_rowwise, but got ", packed.type().toString(),
+           " of sizes ", packed.sizes());
+  int64_t value_bytes = packed.size(1) - 2 * (int64_t)sizeof(float);
+  AT_CHECK(value_bytes >= 0, "embedding_bag_rowwise: packed rows are too short");
+  return value_bytes * (8 / bit_rate);
+}
+
+Tensor _embedding_bag_pack_rowwise_cpu(const Tensor &weight_, int64_t bit_rate) {
+  AT_CHECK(bit_rate == 8 || bit_rate == 4,
+           "embedding_bag_pack_rowwise: bit_rate has to be 8 or 4, but got ", bit_rate);
+  auto weight_arg = TensorArg(weight_, "weight", 1);
+  checkDim("embedding_bag_pack_rowwise", weight_arg, 2);
+  checkScalarType("embedding_bag_pack_rowwise", weight_arg, kFloat);
+  const int64_t elems_per_byte = 8 / bit_rate;
+  int64_t num_weights = weight_.size(0);
+  int64_t ddim = weight_.size(1);
+  AT_CHECK(ddim % elems_per_byte == 0,
+           "embedding_bag_pack_rowwise: embedding_dim has to be a multiple of ",
+           elems_per_byte, " for bit_rate ", bit_rate, ", but got ", ddim);
+
+  auto weight = weight_.contiguous();
+  int64_t row_bytes = ddim / elems_per_byte + 2 * sizeof(float);
+  auto packed = at::empty({num_weights, row_bytes}, weight.options().dtype(kByte));
+  auto weight_data = weight.data<float>();
+  auto packed_data = packed.data<uint8_t>();
+  const float levels = (1 << bit_rate) - 1;
+
+  parallel_for(0, num_weights, std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(1, ddim)),
+               [&](int64_t begin, int64_t end) {
+    for (int64_t r = begin; r < end; r++) {
+      const float* in = weight_data + r * ddim;
+      uint8_t* row = packed_data + r * row_bytes;
+      float min = ddim > 0 ? *std::min_element(in, in + ddim) : 0.f;
+      float max = ddim > 0 ? *std::max_element(in, in + ddim) : 0.f;
+      float scale = (max - min) / levels;
+      float inv_scale = scale > 0 ? 1.f / scale : 0.f;
+      std::memset(row, 0, row_bytes - 2 * sizeof(float));
+      for (int64_t d = 0; d < ddim; d++) {
+        float q = std::nearbyint((in[d] - min) * inv_scale);
+        q = std::max(0.f, std::min(q, levels));
+        row[d / elems_per_byte] |= (uint8_t)q << ((d % elems_per_byte) * bit_rate);
+      }
+      std::memcpy(row + row_bytes - 2 * sizeof(float), &scale, sizeof(float));
+      std::memcpy(row + row_bytes - sizeof(float), &min, sizeof(float));
+    }
+  });
+  return packed;
+}
+
+Tensor _embedding_bag_unpack_rowwise_cpu(const Tensor &packed_, int64_t bit_rate) {
+  int64_t ddim = rowwise_embedding_dim(packed_, bit_rate);
+  const int64_t elems_per_byte = 8 / bit_rate;
+  const int mask = (1 << bit_rate) - 1;
+  auto packed = packed_.contiguous();
+  int64_t num_weights = packed.size(0);
+  int64_t row_bytes = packed.size(1);
+  auto weight = at::empty({num_weights, ddim}, packed.options().dtype(kFloat));
+  auto weight_data = weight.data<float>();
+  auto packed_data = packed.data<uint8_t>();
+
+  parallel_for(0, num_weights, std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(1, ddim)),
+               [&](int64_t begin, int64_t end) {
+    for (int64_t r = begin; r < end; r++) {
+      const uint8_t* row = packed_data + r * row_bytes;
+      float* out = weight_data + r * ddim;
+      float scale, bias;
+      std::memcpy(&scale, row + row_bytes - 2 * sizeof(float), sizeof(float));
+      std::memcpy(&bias, row + row_bytes - sizeof(float), sizeof(float));
+      for (int64_t d = 0; d < ddim; d++) {
+        int q = (row[d / elems_per_byte] >> ((d % elems_per_byte) * bit_rate)) & mask;
+        out[d] = scale * q + bias;
+      }
+    }
+  });
+  return weight;
+}
+
+Tensor _embedding_bag_rowwise_cpu(const Tensor &packed_, const Tensor &indices_,
+                                  const Tensor &offsets_, int64_t bit_rate,
+                                  int64_t mode,
+                                  const Tensor &per_sample_weights) {
+  int64_t ddim = rowwise_embedding_dim(packed_, bit_rate);
+  auto indices = indices_.contiguous();
+  auto offsets = offsets_.contiguous();
+  auto indices_arg = TensorArg(indices, "indices", 2);
+  checkScalarType("embedding_bag_rowwise", indices_arg, kLong);
+  checkDim("embedding_bag_rowwise", indices_arg, 1);
+  auto offsets_arg = TensorArg(offsets, "offsets", 3);
+  checkScalarType("embedding_bag_rowwise", offsets_arg, kLong);
+  checkDim("embedding_bag_rowwise", offsets_arg, 1);
+  AT_CHECK(mode == MODE_SUM || mode == MODE_MEAN,
+           "embedding_bag_rowwise: only mode sum and mean are supported");
+  if (per_sample_weights.defined()) {
+    AT_CHECK(mode == MODE_SUM,
+             "embedding_bag_rowwise: per_sample_weights is only supported for mode='sum'");
+    AT_CHECK(per_sample_weights.dim() == 1 &&
+             per_sample_weights.numel() == indices.numel() &&
+             per_sample_weights.type().scalarType() == kFloat,
+             "embedding_bag_rowwise: expected per_sample_weights to be a 1-D "
+             "Float tensor with ", indices.numel(), " elements");
+  }
+  auto packed = packed_.contiguous();
+  check_indices_and_offsets(packed.size(0), indices, offsets);
+
+  auto output = at::empty({offsets.size(0), ddim}, packed.options().dtype(kFloat));
+  embedding_bag_rowwise_stub(kCPU, output, packed, indices, offsets,
+                             per_sample_weights, bit_rate, mode == MODE_MEAN);
+  return output;
+}
 }
 } // namespace at::native
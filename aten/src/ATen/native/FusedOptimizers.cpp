@@ -0,0 +1,141 @@
+#include "ATen/native/FusedOptimizers.h"
+
+#include "ATen/ATen.h"
+#include "ATen/NativeFunctions.h"
+
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+// See Note [Fused optimizers] in FusedOptimizers.h
+
+namespace at { namespace native {
+
+DEFINE_DISPATCH(fused_sgd_stub);
+DEFINE_DISPATCH(fused_adam_stub);
+DEFINE_DISPATCH(fused_rmsprop_stub);
+
+namespace {
+
+// Checks that every list has one tensor per parameter, of the same sizes,
+// type and device, and that the parameters and buffers, which are updated in
+// place, are contiguous. Returns contiguous gradients.
+std::vector<Tensor> check_fused_optimizer_args(
+    const char* name, TensorList params, TensorList grads,
+    std::initializer_list<std::pair<TensorList, const char*>> buffers) {
+  AT_CHECK(grads.size() == params.size(),
+           name, ": expected one gradient per parameter, but got ",
+           grads.size(), " gradients for ", params.size(), " parameters");
+  for (const auto& buffer : buffers) {
+    AT_CHECK(buffer.first.size() == params.size(),
+             name, ": expected one tensor of ", buffer.second, " per parameter, "
+             "but got ", buffer.first.size(), " for ", params.size(), " parameters");
+  }
+  std::vector<Tensor> contiguous_grads;
+  contiguous_grads.reserve(grads.size());
+  for (size_t i = 0; i < params.size(); i++) {
+    const auto& param = params[i];
+    AT_CHECK(param.defined() && param.is_contiguous(),
+             name, ": expected parameter ", i, " to be contiguous");
+    AT_CHECK(param.type().scalarType() == params[0].type().scalarType() &&
+             param.type().device_type() == params[0].type().device_type() &&
+             param.get_device() == params[0].get_device(),
+             name, ": expected all parameters to have the same type and device, "
+             "but parameter ", i, " is ", param.type().toString(),
+             " and parameter 0 is ", params[0].type().toString());
+    auto check_like_param = [&](const Tensor& t, const char* what) {
+      AT_CHECK(t.defined() && t.type() == param.type() &&
+               t.get_device() == param.get_device() && t.sizes() == param.sizes(),
+               name, ": expected ", what, " ", i, " to have the type, device and "
+               "sizes of its parameter");
+    };
+    check_like_param(grads[i], "gradient");
+    AT_CHECK(!grads[i].is_sparse(),
+             name, ": sparse gradients are not supported");
+    for (const auto& buffer : buffers) {
+      check_like_param(buffer.first[i], buffer.second);
+      AT_CHECK(buffer.first[i].is_contiguous(),
+               name, ": expected ", buffer.second, " ", i, " to be contiguous");
+    }
+    contiguous_grads.push_back(grads[i].contiguous());
+  }
+  return contiguous_grads;
+}
+
+} // anonymous namespace
+
+void _fused_sgd_step(TensorList params, TensorList grads,
+                     TensorList momentum_buffers, double lr, double momentum,
+                     double dampening, double weight_decay, bool nesterov) {
+  std::vector<Tensor> contiguous_grads;
+  if (momentum != 0) {
+    contiguous_grads = check_fused_optimizer_args(
+        "_fused_sgd_step", params, grads, {{momentum_buffers, "momentum_buffers"}});
+  } else {
+    contiguous_grads = check_fused_optimizer_args("_fused_sgd_step", params, grads, {});
+  }
+  if (params.empty()) {
+    return;
+  }
+  fused_sgd_stub(params[0].type().device_type(), params, contiguous_grads,
+                 momentum != 0 ? momentum_buffers : TensorList(),
+                 lr, momentum, dampening, weight_decay, nesterov);
+}
+
+void _fused_adam_step(TensorList params, TensorList grads, TensorList exp_avgs,
+                      TensorList exp_avg_sqs, TensorList max_exp_avg_sqs,
+                      double step_size, double beta1, double beta2, double eps,
+                      double weight_decay, bool amsgrad) {
+  std::vector<Tensor> contiguous_grads;
+  if (amsgrad) {
+    contiguous_grads = check_fused_optimizer_args(
+        "_fused_adam_step", params, grads,
+        {{exp_avgs, "exp_avgs"}, {exp_avg_sqs, "exp_avg_sqs"},
+         {max_exp_avg_sqs, "max_exp_avg_sqs"}});
+  } else {
+    contiguous_grads = check_fused_optimizer_args(
+        "_fused_adam_step", params, grads,
+        {{exp_avgs, "exp_avgs"}, {exp_avg_sqs, "exp_avg_sqs"}});
+  }
+  if (params.empty()) {
+    return;
+  }
+  fused_adam_stub(params[0].type().device_type(), params, contiguous_grads,
+                  exp_avgs, exp_avg_sqs,
+                  amsgrad ? max_exp_avg_sqs : TensorList(),
+                  step_size, beta1, beta2, eps, weight_decay, amsgrad);
+}
+
+void _fused_rmsprop_step(TensorList params, TensorList grads,
+                         TensorList square_avgs, TensorList momentum_buffers,
+                         TensorList grad_avgs, double lr, double alpha, double eps,
+                         double weight_decay, double momentum, bool centered) {
+  std::vector<Tensor> contiguous_grads;
+  if (momentum > 0 && centered) {
+    contiguous_grads = check_fused_optimizer_args(
+        "_fused_rmsprop_step", params, grads,
+        {{square_avgs, "square_avgs"}, {momentum_buffers, "momentum_buffers"},
+         {grad_avgs, "grad_avgs"}});
+  } else if (momentum > 0) {
+    contiguous_grads = check_fused_optimizer_args(
+        "_fused_rmsprop_step", params, grads,
+        {{square_avgs, "square_avgs"}, {momentum_buffers, "momentum_buffers"}});
+  } else if (centered) {
+    contiguous_grads = check_fused_optimizer_args(
+        "_fused_rmsprop_step", params, grads,
+        {{square_avgs, "square_avgs"}, {grad_avgs, "grad_avgs"}});
+  } else {
+    contiguous_grads = check_fused_optimizer_args(
+        "_fused_rmsprop_step", params, grads, {{square_avgs, "square_avgs"}});
+  }
+  if (params.empty()) {
+    return;
+  }
+  fused_rmsprop_stub(params[0].type().device_type(), params, contiguous_grads,
+                     square_avgs,
+                     momentum > 0 ? momentum_buffers : TensorList(),
+                     centered ? grad_avgs : TensorList(),
+                     lr, alpha, eps, weight_decay, momentum, centered);
+}
+
+}} // namespace at::native
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/core/Half.h>
+#include <ATen/native/DispatchStub.h>
+
+#include <cmath>
+
+// Note [Fused optimizers]
+// ~~~~~~~~~~~~~~~~~~~~~~~
+// _fused_sgd_step, _fused_adam_step and _fused_rmsprop_step apply one step
+// of an optimizer to lists of parameters, gradients and state buffers. On
+// CUDA, all tensors are updated by a handful of kernel launches (see
+// native/cuda/MultiTensorApply.cuh) instead of several small kernels per
+// parameter, which dominates the step time of models with many parameters.
+//
+// The updates are the ones of torch.optim.SGD, Adam and RMSprop, but the
+// gradients are left untouched. The step-dependent factors (e.g. the bias
+// corrections of Adam) are computed by the caller, so all parameters passed
+// to one call must be at the same step. Lists of unused buffers (e.g. the
+// momentum buffers if momentum is 0) are empty.
+//
+// The functions below compute the update of one element in the accumulation
+// type `T`, and are shared by the CPU and CUDA kernels.
+
+namespace at { namespace native {
+
+using fused_sgd_fn = void(*)(
+    TensorList params, TensorList grads, TensorList momentum_buffers,
+    double lr, double momentum, double dampening, double weight_decay,
+    bool nesterov);
+using fused_adam_fn = void(*)(
+    TensorList params, TensorList grads, TensorList exp_avgs,
+    TensorList exp_avg_sqs, TensorList max_exp_avg_sqs, double step_size,
+    double beta1, double beta2, double eps, double weight_decay, bool amsgrad);
+using fused_rmsprop_fn = void(*)(
+    TensorList params, TensorList grads, TensorList square_avgs,
+    TensorList momentum_buffers, TensorList grad_avgs, double lr, double alpha,
+    double eps, double weight_decay, double momentum, bool centered);
+
+DECLARE_DISPATCH(fused_sgd_fn, fused_sgd_stub);
+DECLARE_DISPATCH(fused_adam_fn, fused_adam_stub);
+DECLARE_DISPATCH(fused_rmsprop_fn, fused_rmsprop_stub);
+
+namespace detail {
+
+// `momentum_buffer` is null if momentum is 0
+template <typename T>
+AT_HOSTDEVICE inline void sgd_update(
+    T& param, T grad, T* momentum_buffer, T lr, T momentum, T dampening,
+    T weight_decay, bool nesterov) {
+  T d_p = grad + weight_decay * param;
+  if (momentum_buffer) {
+    *momentum_buffer = momentum * *momentum_buffer + (1 - dampening) * d_p;
+    d_p = nesterov ? d_p + momentum * *momentum_buffer : *momentum_buffer;
+  }
+  param -= lr * d_p;
+}
+
+// `max_exp_avg_sq` is null unless amsgrad is used
+template <typename T>
+AT_HOSTDEVICE inline void adam_update(
+    T& param, T grad, T& exp_avg, T& exp_avg_sq, T* max_exp_avg_sq,
+    T step_size, T beta1, T beta2, T eps, T weight_decay) {
+  grad += weight_decay * param;
+  exp_avg = beta1 * exp_avg + (1 - beta1) * grad;
+  exp_avg_sq = beta2 * exp_avg_sq + (1 - beta2) * grad * grad;
+  T denom = exp_avg_sq;
+  if (max_exp_avg_sq) {
+    *max_exp_avg_sq = *max_exp_avg_sq > exp_avg_sq ? *max_exp_avg_sq : exp_avg_sq;
+    denom = *max_exp_avg_sq;
+  }
+  param -= step_size * exp_avg / (std::sqrt(denom) + eps);
+}
+
+// `momentum_buffer` is null if momentum is 0, and `grad_avg` unless centered
+template <typename T>
+AT_HOSTDEVICE inline void rmsprop_update(
+    T& param, T grad, T& square_avg, T* momentum_buffer, T* grad_avg,
+    T lr, T alpha, T eps, T weight_decay, T momentum) {
+  grad += weight_decay * param;
+  square_avg = alpha * square_avg + (1 - alpha) * grad * grad;
+  T avg;
+  if (grad_avg) {
+    *grad_avg = alpha * *grad_avg + (1 - alpha) * grad;
+    avg = std::sqrt(square_avg - *grad_avg * *grad_avg) + eps;
+  } else {
+    avg = std::sqrt(square_avg) + eps;
+  }
+  if (momentum_buffer) {
+    *momentum_buffer = momentum * *momentum_buffer + grad / avg;
+    param -= lr * *momentum_buffer;
+  } else {
+    param -= lr * grad / avg;
+  }
+}
+
+} // namespace detail
+
+}} // namespace at::native
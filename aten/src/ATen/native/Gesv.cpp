@@ -3,12 +3,14 @@
 #include "ATen/Dispatch.h"
 #include "ATen/ExpandUtils.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
 
 #include "ATen/native/LinearAlgebraUtils.h"
 #include "ATen/native/Gesv.h"
 
 #include "TH.h"  // for USE_LAPACK
 
+#include <algorithm>
 #include <vector>
 
 #ifdef USE_LAPACK
@@ -44,7 +46,7 @@ template<> void lapackGesv<double>(
 #endif
 
 template <typename scalar_t>
-static void applyGesv(Tensor& b, Tensor& A, std::vector<int64_t> infos) {
+static void applyGesv(Tensor& b, Tensor& A, std::vector<int64_t>& infos) {
 #ifndef USE_LAPACK
   AT_ERROR("gesv: LAPACK library not found in compilation");
 #endif
@@ -57,19 +59,20 @@ static void applyGesv(Tensor& b, Tensor& A, std::vector<int64_t> infos) {
   auto n = A.size(-2);
   auto nrhs = b.size(-1);
 
-  auto ipiv = at::empty({n}, b.type().toScalarType(kInt));
-
-  for (int64_t i = 0; i < batch_size; i++) {
-    int info;
-    scalar_t* A_working_ptr = &A_data[i * A_mat_stride];
-    scalar_t* b_working_ptr = &b_data[i * b_mat_stride];
-    lapackGesv<scalar_t>(n, nrhs, A_working_ptr, n, ipiv.data<int>(),
-        b_working_ptr, n, &info);
-    infos[i] = info;
-    if (info != 0) {
-      return;
+  // The matrices of a batch are independent, so each chunk of the batch is
+  // solved by its own thread, with its own pivots.
+  auto grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / (n * n * (n + nrhs)));
+  parallel_for(0, batch_size, grain_size, [&](int64_t begin, int64_t end) {
+    std::vector<int> ipiv(n);
+    for (int64_t i = begin; i < end; i++) {
+      int info;
+      scalar_t* A_working_ptr = &A_data[i * A_mat_stride];
+      scalar_t* b_working_ptr = &b_data[i * b_mat_stride];
+      lapackGesv<scalar_t>(n, nrhs, A_working_ptr, n, ipiv.data(),
+          b_working_ptr, n, &info);
+      infos[i] = info;
     }
-  }
+  });
 }
 
 std::tuple<Tensor,Tensor> _gesv_helper_cpu(const Tensor& self, const Tensor& A) {
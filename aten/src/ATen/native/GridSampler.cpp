@@ -2,9 +2,11 @@
 #include "ATen/Layout.h"
 #include "ATen/Device.h"
 #include "ATen/Error.h"
+#include "ATen/MemoryFormat.h"
 #include "ATen/NativeFunctions.h"
 #include "ATen/detail/CUDAHooksInterface.h"
 #include "ATen/native/GridSampler.h"
+#include "ATen/native/cpu/GridSamplerKernel.h"
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -14,99 +16,32 @@ namespace at { namespace native {
 
 using at::native::detail::GridSamplerInterpolation;
 using at::native::detail::GridSamplerPadding;
+using at::native::detail::clip_coordinates;
+using at::native::detail::clip_coordinates_set_grad;
+using at::native::detail::reflect_coordinates;
+using at::native::detail::reflect_coordinates_set_grad;
 
-namespace {
-  template<typename scalar_t>
-  static inline scalar_t clip_coordinates(scalar_t in, int64_t clip_limit) {
-    return std::min(static_cast<scalar_t>(clip_limit - 1), std::max(in, static_cast<scalar_t>(0)));
-  }
-
-  // clip_coordinates_set_grad works similarly to clip_coordinates except that
-  // it also returns the `d output / d input` via pointer argument `grad_in`.
-  // This is useful in the backward pass of grid_sampler.
-  template<typename scalar_t>
-  static inline scalar_t clip_coordinates_set_grad(scalar_t in, int64_t clip_limit,
-                                                   scalar_t *grad_in) {
-    if (in < static_cast<scalar_t>(0)) {
-      *grad_in = static_cast<scalar_t>(0);
-      return static_cast<scalar_t>(0);
-    } else {
-      scalar_t max = static_cast<scalar_t>(clip_limit - 1);
-      if (in > max) {
-        *grad_in = static_cast<scalar_t>(0);
-        return max;
-      } else {
-        *grad_in = static_cast<scalar_t>(1);
-        return in;
-      }
-    }
-  }
+DEFINE_DISPATCH(grid_sampler_2d_stub);
+DEFINE_DISPATCH(grid_sampler_2d_backward_stub);
 
-  template<typename scalar_t>
-  static inline scalar_t reflect_coordinates(scalar_t in, int64_t clip_limit) {
-    if (clip_limit == static_cast<int64_t>(1)) {
-      return static_cast<scalar_t>(0);
-    }
-    in = std::fabs(in);
-    scalar_t max = static_cast<scalar_t>(clip_limit - 1);
-    // `fmod` returns same sign as `in`, which is positive after the `fabs` above.
-    scalar_t extra = std::fmod(in, max);
-    int flips = static_cast<int>(std::floor(in / max));
-    if (flips % 2 == 0) {
-      return extra;
-    } else {
-      return max - extra;
-    }
+namespace {
+  // The 2d CPU kernels take channels-last inputs without a copy, and give
+  // channels-last outputs for them; see Note [Channels last].
+  static inline bool is_channels_last_input(const Tensor& t) {
+    return suggest_memory_format(t.sizes(), t.strides()) == MemoryFormat::ChannelsLast;
   }
 
-  // reflect_coordinates_set_grad works similarly to reflect_coordinates except
-  // that it also returns the `d output / d input` via pointer argument
-  // `grad_in`.
-  // This is useful in the backward pass of grid_sampler.
-  template<typename scalar_t>
-  static inline scalar_t reflect_coordinates_set_grad(scalar_t in, int64_t clip_limit,
-                                                      scalar_t *grad_in) {
-    if (clip_limit == static_cast<int64_t>(1)) {
-      *grad_in = static_cast<scalar_t>(0);
-      return static_cast<scalar_t>(0);
-    }
-    int grad_in_mult_;
-    if (in < static_cast<scalar_t>(0)) {
-      grad_in_mult_ = -1;
-      in = -in;
-    } else {
-      grad_in_mult_ = 1;
-    }
-    scalar_t max = static_cast<scalar_t>(clip_limit - 1);
-    // `fmod` returns same sign as `in`, which is positive after the `if` above.
-    scalar_t extra = std::fmod(in, max);
-    int flips = static_cast<int>(std::floor(in / max));
-    if (flips % 2 == 0) {
-      *grad_in = static_cast<scalar_t>(grad_in_mult_);
-      return extra;
-    } else {
-      *grad_in = static_cast<scalar_t>(-grad_in_mult_);
-      return max - extra;
+  static inline Tensor empty_in_format(const Tensor& t, IntList sizes, bool channels_last) {
+    if (channels_last) {
+      return t.type().tensor(sizes, get_channels_last_strides(sizes));
     }
-  }
-
-  static inline bool within_bounds_2d(int64_t h, int64_t w, int64_t H, int64_t W) {
-    return h >= 0 && h < H && w >= 0 && w < W;
+    return at::empty(sizes, t.options());
   }
 
   static inline bool within_bounds_3d(int64_t d, int64_t h, int64_t w, int64_t D, int64_t H, int64_t W) {
     return d >= 0 && d < D && h >= 0 && h < H && w >= 0 && w < W;
   }
 
-  template<typename scalar_t>
-  static inline void safe_add_2d(scalar_t *data, int64_t h, int64_t w,
-                                 int64_t sH, int64_t sW, int64_t H, int64_t W,
-                                 scalar_t delta) {
-    if (within_bounds_2d(h, w, H, W)) {
-      data[h * sH + w * sW] += delta;
-    }
-  }
-
   template<typename scalar_t>
   static inline void safe_add_3d(scalar_t *data, int64_t d, int64_t h, int64_t w,
                                  int64_t sD, int64_t sH, int64_t sW,
@@ -117,117 +52,6 @@ namespace {
     }
   }
 
-  template<typename scalar_t>
-  Tensor grid_sampler_2d_cpu_impl(const Tensor& input, const Tensor& grid,
-                                 GridSamplerInterpolation interpolation_mode,
-                                 GridSamplerPadding padding_mode) {
-    int64_t N = input.size(0);
-    int64_t C = input.size(1);
-    int64_t inp_H = input.size(2);
-    int64_t inp_W = input.size(3);
-    int64_t out_H = grid.size(1);
-    int64_t out_W = grid.size(2);
-    auto output = at::empty({N, C, out_H, out_W}, input.options());
-    int64_t inp_sN = input.stride(0);
-    int64_t inp_sC = input.stride(1);
-    int64_t inp_sH = input.stride(2);
-    int64_t inp_sW = input.stride(3);
-    int64_t grid_sN = grid.stride(0);
-    int64_t grid_sH = grid.stride(1);
-    int64_t grid_sW = grid.stride(2);
-    int64_t grid_sCoor = grid.stride(3);
-    int64_t out_sN = output.stride(0);
-    int64_t out_sC = output.stride(1);
-    int64_t out_sH = output.stride(2);
-    int64_t out_sW = output.stride(3);
-    scalar_t *inp_ptr = input.data<scalar_t>();
-    scalar_t *out_ptr = output.data<scalar_t>();
-    scalar_t *grid_ptr = grid.data<scalar_t>();
-    // loop over each output pixel
-    #ifdef _OPENMP
-    #pragma omp parallel for
-    #endif
-    for (int64_t n = 0; n < N; ++n) {
-      scalar_t *grid_ptr_N = grid_ptr + n * grid_sN;
-      scalar_t *inp_ptr_N = inp_ptr + n * inp_sN;
-      for (int64_t h = 0; h < out_H; ++h) {
-        for (int64_t w = 0; w < out_W; ++w) {
-          // get the corresponding input x, y co-ordinates from grid
-          scalar_t ix = grid_ptr_N[h * grid_sH + w * grid_sW];
-          scalar_t iy = grid_ptr_N[h * grid_sH + w * grid_sW + grid_sCoor];
-
-          // normalize ix, iy from [-1, 1] to [0, inp_W-1] & [0, inp_H-1]
-          ix = ((ix + 1) / 2) * (inp_W - 1);
-          iy = ((iy + 1) / 2) * (inp_H - 1);
-
-          if (padding_mode == GridSamplerPadding::Border) {
-            // clip coordinates to image borders
-            ix = clip_coordinates(ix, inp_W);
-            iy = clip_coordinates(iy, inp_H);
-          } else if (padding_mode == GridSamplerPadding::Reflection) {
-            // reflect coordinates by image borders
-            ix = reflect_coordinates(ix, inp_W);
-            iy = reflect_coordinates(iy, inp_H);
-          }
-
-          if (interpolation_mode == GridSamplerInterpolation::Bilinear) {
-            // get NE, NW, SE, SW pixel values from (x, y)
-            int64_t ix_nw = static_cast<int64_t>(std::floor(ix));
-            int64_t iy_nw = static_cast<int64_t>(std::floor(iy));
-            int64_t ix_ne = ix_nw + 1;
-            int64_t iy_ne = iy_nw;
-            int64_t ix_sw = ix_nw;
-            int64_t iy_sw = iy_nw + 1;
-            int64_t ix_se = ix_nw + 1;
-            int64_t iy_se = iy_nw + 1;
-
-            // get surfaces to each neighbor:
-            scalar_t nw = (ix_se - ix)    * (iy_se - iy);
-            scalar_t ne = (ix    - ix_sw) * (iy_sw - iy);
-            scalar_t sw = (ix_ne - ix)    * (iy    - iy_ne);
-            scalar_t se = (ix    - ix_nw) * (iy    - iy_nw);
-
-            // calculate bilinear weighted pixel value and set output pixel
-            scalar_t *out_ptr_NCHW = out_ptr + n * out_sN + h * out_sH + w * out_sW;
-            scalar_t *inp_ptr_NC = inp_ptr_N;
-            for (int c = 0; c < C; ++c, out_ptr_NCHW += out_sC, inp_ptr_NC += inp_sC) {
-              //   (c, iy_nw, ix_nw) * nw + (c, iy_ne, ix_ne) * ne
-              // + (c, iy_sw, ix_sw) * sw + (c, iy_se, ix_se) * se
-              *out_ptr_NCHW = static_cast<scalar_t>(0);
-              if (within_bounds_2d(iy_nw, ix_nw, inp_H, inp_W)) {
-                *out_ptr_NCHW += inp_ptr_NC[iy_nw * inp_sH + ix_nw * inp_sW] * nw;
-              }
-              if (within_bounds_2d(iy_ne, ix_ne, inp_H, inp_W)) {
-                *out_ptr_NCHW += inp_ptr_NC[iy_ne * inp_sH + ix_ne * inp_sW] * ne;
-              }
-              if (within_bounds_2d(iy_sw, ix_sw, inp_H, inp_W)) {
-                *out_ptr_NCHW += inp_ptr_NC[iy_sw * inp_sH + ix_sw * inp_sW] * sw;
-              }
-              if (within_bounds_2d(iy_se, ix_se, inp_H, inp_W)) {
-                *out_ptr_NCHW += inp_ptr_NC[iy_se * inp_sH + ix_se * inp_sW] * se;
-              }
-            }
-          } else if (interpolation_mode == GridSamplerInterpolation::Nearest) {
-            int64_t ix_nearest = static_cast<int64_t>(std::round(ix));
-            int64_t iy_nearest = static_cast<int64_t>(std::round(iy));
-
-            // assign nearest neighor pixel value to output pixel
-            scalar_t *out_ptr_NCHW = out_ptr + n * out_sN + h * out_sH + w * out_sW;
-            scalar_t *inp_ptr_NC = inp_ptr_N;
-            for (int c = 0; c < C; ++c, out_ptr_NCHW += out_sC, inp_ptr_NC += inp_sC) {
-              if (within_bounds_2d(iy_nearest, ix_nearest, inp_H, inp_W)) {
-                *out_ptr_NCHW = inp_ptr_NC[iy_nearest * inp_sH + ix_nearest * inp_sW];
-              } else {
-                *out_ptr_NCHW = static_cast<scalar_t>(0);
-              }
-            }
-          }
-        }
-      }
-    }
-    return output;
-  }
-
   template<typename scalar_t>
   Tensor grid_sampler_3d_cpu_impl(const Tensor& input, const Tensor& grid,
                                  GridSamplerInterpolation interpolation_mode,
@@ -395,161 +219,6 @@ namespace {
     return output;
   }
 
-  template<typename scalar_t>
-  std::tuple<Tensor, Tensor>
-  grid_sampler_2d_backward_cpu_impl(const Tensor& grad_output,
-                                   const Tensor& input, const Tensor& grid,
-                                   GridSamplerInterpolation interpolation_mode,
-                                   GridSamplerPadding padding_mode) {
-    auto grad_input = at::zeros_like(input);
-    auto grad_grid = at::empty_like(grid);
-    // If interpolation mode is Nearest, then grad_grid is not filled in the
-    // loop below.
-    if (interpolation_mode == GridSamplerInterpolation::Nearest) {
-      grad_grid.zero_();
-    }
-    int64_t N = input.size(0);
-    int64_t C = input.size(1);
-    int64_t inp_H = input.size(2);
-    int64_t inp_W = input.size(3);
-    int64_t out_H = grid.size(1);
-    int64_t out_W = grid.size(2);
-    int64_t inp_sN = input.stride(0);
-    int64_t inp_sC = input.stride(1);
-    int64_t inp_sH = input.stride(2);
-    int64_t inp_sW = input.stride(3);
-    int64_t grid_sN = grid.stride(0);
-    int64_t grid_sH = grid.stride(1);
-    int64_t grid_sW = grid.stride(2);
-    int64_t grid_sCoor = grid.stride(3);
-    int64_t gOut_sN = grad_output.stride(0);
-    int64_t gOut_sC = grad_output.stride(1);
-    int64_t gOut_sH = grad_output.stride(2);
-    int64_t gOut_sW = grad_output.stride(3);
-    int64_t gInp_sN = grad_input.stride(0);
-    int64_t gInp_sC = grad_input.stride(1);
-    int64_t gInp_sH = grad_input.stride(2);
-    int64_t gInp_sW = grad_input.stride(3);
-    int64_t gGrid_sN = grad_grid.stride(0);
-    int64_t gGrid_sW = grad_grid.stride(2);
-    scalar_t *inp_ptr = input.data<scalar_t>();
-    scalar_t *grid_ptr = grid.data<scalar_t>();
-    scalar_t *gOut_ptr = grad_output.data<scalar_t>();
-    scalar_t *gInp_ptr = grad_input.data<scalar_t>();
-    scalar_t *gGrid_ptr = grad_grid.data<scalar_t>();
-    // loop over each output pixel
-    #ifdef _OPENMP
-    #pragma omp parallel for
-    #endif
-    for (int64_t n = 0; n < N; ++n) {
-      scalar_t *grid_ptr_N = grid_ptr + n * grid_sN;
-      scalar_t *inp_ptr_N = inp_ptr + n * inp_sN;
-      scalar_t *gGrid_ptr_NHW = gGrid_ptr + n * gGrid_sN;
-      for (int64_t h = 0; h < out_H; ++h) {
-        for (int64_t w = 0; w < out_W; ++w, gGrid_ptr_NHW += gGrid_sW /* grad_grid is contiguous */ ) {
-          // get the corresponding input x, y co-ordinates from grid
-          scalar_t ix = grid_ptr_N[h * grid_sH + w * grid_sW];
-          scalar_t iy = grid_ptr_N[h * grid_sH + w * grid_sW + grid_sCoor];
-
-          // normalize ix, iy from [-1, 1] to [0, inp_W-1] & [0, inp_H-1]
-          ix = ((ix + 1) / 2) * (inp_W - 1);
-          iy = ((iy + 1) / 2) * (inp_H - 1);
-
-          // multipliers for gradients on ix and iy
-          // E.g.,  0 for out-of-bound indices when GridSamplerPadding::Border
-          scalar_t gix_mult, giy_mult;
-          if (padding_mode == GridSamplerPadding::Border) {
-            // clip coordinates to image borders
-            ix = clip_coordinates_set_grad(ix, inp_W, &gix_mult);
-            iy = clip_coordinates_set_grad(iy, inp_H, &giy_mult);
-          } else if (padding_mode == GridSamplerPadding::Reflection) {
-            // reflect coordinates by image borders
-            ix = reflect_coordinates_set_grad(ix, inp_W, &gix_mult);
-            iy = reflect_coordinates_set_grad(iy, inp_H, &giy_mult);
-          } else {  // padding_mode == GridSamplerPadding::Zeros
-            gix_mult = static_cast<scalar_t>(1);
-            giy_mult = static_cast<scalar_t>(1);
-          }
-
-          if (interpolation_mode == GridSamplerInterpolation::Bilinear) {
-            // get NE, NW, SE, SW pixel values from (x, y)
-            int64_t ix_nw = static_cast<int64_t>(std::floor(ix));
-            int64_t iy_nw = static_cast<int64_t>(std::floor(iy));
-            int64_t ix_ne = ix_nw + 1;
-            int64_t iy_ne = iy_nw;
-            int64_t ix_sw = ix_nw;
-            int64_t iy_sw = iy_nw + 1;
-            int64_t ix_se = ix_nw + 1;
-            int64_t iy_se = iy_nw + 1;
-
-            // get surfaces to each neighbor:
-            scalar_t nw = (ix_se - ix)    * (iy_se - iy);
-            scalar_t ne = (ix    - ix_sw) * (iy_sw - iy);
-            scalar_t sw = (ix_ne - ix)    * (iy    - iy_ne);
-            scalar_t se = (ix    - ix_nw) * (iy    - iy_nw);
-
-            scalar_t gix = static_cast<scalar_t>(0), giy = static_cast<scalar_t>(0);
-            scalar_t *gOut_ptr_NCHW = gOut_ptr + n * gOut_sN + h * gOut_sH + w * gOut_sW;
-            scalar_t *gInp_ptr_NC = gInp_ptr + n * gInp_sN;
-            scalar_t *inp_ptr_NC = inp_ptr_N;
-            // calculate bilinear weighted pixel value and set output pixel
-            for (int c = 0; c < C; ++c, gOut_ptr_NCHW += gOut_sC, gInp_ptr_NC += gInp_sC, inp_ptr_NC += inp_sC) {
-              scalar_t gOut = *gOut_ptr_NCHW;
-
-              // calculate and set grad_input
-              safe_add_2d(gInp_ptr_NC, iy_nw, ix_nw, gInp_sH, gInp_sW, inp_H, inp_W, nw * gOut);
-              safe_add_2d(gInp_ptr_NC, iy_ne, ix_ne, gInp_sH, gInp_sW, inp_H, inp_W, ne * gOut);
-              safe_add_2d(gInp_ptr_NC, iy_sw, ix_sw, gInp_sH, gInp_sW, inp_H, inp_W, sw * gOut);
-              safe_add_2d(gInp_ptr_NC, iy_se, ix_se, gInp_sH, gInp_sW, inp_H, inp_W, se * gOut);
-
-              // calculate grad_grid
-              if (within_bounds_2d(iy_nw, ix_nw, inp_H, inp_W)) {
-                scalar_t nw_val = inp_ptr_NC[iy_nw * inp_sH + ix_nw * inp_sW];
-                gix -= nw_val * (iy_se - iy) * gOut;
-                giy -= nw_val * (ix_se - ix) * gOut;
-              }
-              if (within_bounds_2d(iy_ne, ix_ne, inp_H, inp_W)) {
-                scalar_t ne_val = inp_ptr_NC[iy_ne * inp_sH + ix_ne * inp_sW];
-                gix += ne_val * (iy_sw - iy) * gOut;
-                giy -= ne_val * (ix - ix_sw) * gOut;
-              }
-              if (within_bounds_2d(iy_sw, ix_sw, inp_H, inp_W)) {
-                scalar_t sw_val = inp_ptr_NC[iy_sw * inp_sH + ix_sw * inp_sW];
-                gix -= sw_val * (iy - iy_ne) * gOut;
-                giy += sw_val * (ix_ne - ix) * gOut;
-              }
-              if (within_bounds_2d(iy_se, ix_se, inp_H, inp_W)) {
-                scalar_t se_val = inp_ptr_NC[iy_se * inp_sH + ix_se * inp_sW];
-                gix += se_val * (iy - iy_nw) * gOut;
-                giy += se_val * (ix - ix_nw) * gOut;
-              }
-            }
-
-            // un-normalize grad_grid values back to [-1, 1] constraints
-            gix = gix * (inp_W - 1) / 2;
-            giy = giy * (inp_H - 1) / 2;
-
-            // assuming grad_grid is contiguous
-            gGrid_ptr_NHW[0] = gix_mult * gix;
-            gGrid_ptr_NHW[1] = giy_mult * giy;
-          } else if (interpolation_mode == GridSamplerInterpolation::Nearest) {
-            int64_t ix_nearest = static_cast<int64_t>(std::round(ix));
-            int64_t iy_nearest = static_cast<int64_t>(std::round(iy));
-
-            // assign nearest neighor pixel value to output pixel
-            scalar_t *gOut_ptr_NCHW = gOut_ptr + n * gOut_sN + h * gOut_sH + w * gOut_sW;
-            scalar_t *gInp_ptr_NC = gInp_ptr + n * gInp_sN;
-            for (int c = 0; c < C; ++c, gOut_ptr_NCHW += gOut_sC, gInp_ptr_NC += gInp_sC) {
-              // calculate and set grad_input
-              safe_add_2d(gInp_ptr_NC, iy_nearest, ix_nearest, gInp_sH, gInp_sW, inp_H, inp_W, *gOut_ptr_NCHW);
-            }
-          }
-        }
-      }
-    }
-    return std::make_tuple(grad_input, grad_grid);
-  }
-
   template<typename scalar_t>
   std::tuple<Tensor, Tensor>
   grid_sampler_3d_backward_cpu_impl(const Tensor& grad_output,
@@ -788,11 +457,12 @@ namespace {
 // No shape checking needed here. See # NOTE [ grid_sampler Native Functions ].
 Tensor grid_sampler_2d_cpu(const Tensor& input, const Tensor& grid,
                            int64_t interpolation_mode, int64_t padding_mode) {
-  return AT_DISPATCH_FLOATING_TYPES(input.type(), "grid_sampler2d_cpu", [&] {
-    return grid_sampler_2d_cpu_impl<scalar_t>(
-      input, grid, static_cast<GridSamplerInterpolation>(interpolation_mode),
-      static_cast<GridSamplerPadding>(padding_mode));
-  });
+  const bool channels_last = is_channels_last_input(input);
+  auto output = empty_in_format(
+      input, {input.size(0), input.size(1), grid.size(1), grid.size(2)}, channels_last);
+  grid_sampler_2d_stub(kCPU, output, channels_last ? input : input.contiguous(),
+                       grid.contiguous(), interpolation_mode, padding_mode);
+  return output;
 }
 
 // No shape checking needed here. See # NOTE [ grid_sampler Native Functions ].
@@ -809,12 +479,15 @@ Tensor grid_sampler_3d_cpu(const Tensor& input, const Tensor& grid,
 std::tuple<Tensor, Tensor>
 grid_sampler_2d_backward_cpu(const Tensor& grad_output, const Tensor& input, const Tensor& grid,
                              int64_t interpolation_mode, int64_t padding_mode) {
-  return AT_DISPATCH_FLOATING_TYPES(input.type(), "grid_sampler_2d_backward_cpu", [&] {
-    return grid_sampler_2d_backward_cpu_impl<scalar_t>(
-      grad_output, input, grid,
-      static_cast<GridSamplerInterpolation>(interpolation_mode),
-      static_cast<GridSamplerPadding>(padding_mode));
-  });
+  const bool channels_last = is_channels_last_input(input);
+  auto grad_input = empty_in_format(input, input.sizes(), channels_last);
+  auto grad_grid = at::empty(grid.sizes(), grid.options());
+  grid_sampler_2d_backward_stub(
+      kCPU, grad_input, grad_grid,
+      channels_last ? grad_output.to_channels_last() : grad_output.contiguous(),
+      channels_last ? input : input.contiguous(), grid.contiguous(),
+      interpolation_mode, padding_mode);
+  return std::make_tuple(grad_input, grad_grid);
 }
 
 // No shape checking needed here. See # NOTE [ grid_sampler Native Functions ].
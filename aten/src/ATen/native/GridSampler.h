@@ -1,9 +1,91 @@
+#pragma once
+
 #include "ATen/ATen.h"
 #include "ATen/NativeFunctions.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace at { namespace native { namespace detail {
 
   enum class GridSamplerInterpolation {Bilinear, Nearest};
   enum class GridSamplerPadding {Zeros, Border, Reflection};
 
+  // Host versions of the coordinate transforms, shared by the CPU kernels in
+  // GridSampler.cpp and cpu/GridSamplerKernel.cpp.
+
+  template<typename scalar_t>
+  static inline scalar_t clip_coordinates(scalar_t in, int64_t clip_limit) {
+    return std::min(static_cast<scalar_t>(clip_limit - 1), std::max(in, static_cast<scalar_t>(0)));
+  }
+
+  // clip_coordinates_set_grad works similarly to clip_coordinates except that
+  // it also returns the `d output / d input` via pointer argument `grad_in`.
+  // This is useful in the backward pass of grid_sampler.
+  template<typename scalar_t>
+  static inline scalar_t clip_coordinates_set_grad(scalar_t in, int64_t clip_limit,
+                                                   scalar_t *grad_in) {
+    if (in < static_cast<scalar_t>(0)) {
+      *grad_in = static_cast<scalar_t>(0);
+      return static_cast<scalar_t>(0);
+    } else {
+      scalar_t max = static_cast<scalar_t>(clip_limit - 1);
+      if (in > max) {
+        *grad_in = static_cast<scalar_t>(0);
+        return max;
+      } else {
+        *grad_in = static_cast<scalar_t>(1);
+        return in;
+      }
+    }
+  }
+
+  template<typename scalar_t>
+  static inline scalar_t reflect_coordinates(scalar_t in, int64_t clip_limit) {
+    if (clip_limit == static_cast<int64_t>(1)) {
+      return static_cast<scalar_t>(0);
+    }
+    in = std::fabs(in);
+    scalar_t max = static_cast<scalar_t>(clip_limit - 1);
+    // `fmod` returns same sign as `in`, which is positive after the `fabs` above.
+    scalar_t extra = std::fmod(in, max);
+    int flips = static_cast<int>(std::floor(in / max));
+    if (flips % 2 == 0) {
+      return extra;
+    } else {
+      return max - extra;
+    }
+  }
+
+  // reflect_coordinates_set_grad works similarly to reflect_coordinates except
+  // that it also returns the `d output / d input` via pointer argument
+  // `grad_in`.
+  // This is useful in the backward pass of grid_sampler.
+  template<typename scalar_t>
+  static inline scalar_t reflect_coordinates_set_grad(scalar_t in, int64_t clip_limit,
+                                                      scalar_t *grad_in) {
+    if (clip_limit == static_cast<int64_t>(1)) {
+      *grad_in = static_cast<scalar_t>(0);
+      return static_cast<scalar_t>(0);
+    }
+    int grad_in_mult_;
+    if (in < static_cast<scalar_t>(0)) {
+      grad_in_mult_ = -1;
+      in = -in;
+    } else {
+      grad_in_mult_ = 1;
+    }
+    scalar_t max = static_cast<scalar_t>(clip_limit - 1);
+    // `fmod` returns same sign as `in`, which is positive after the `if` above.
+    scalar_t extra = std::fmod(in, max);
+    int flips = static_cast<int>(std::floor(in / max));
+    if (flips % 2 == 0) {
+      *grad_in = static_cast<scalar_t>(grad_in_mult_);
+      return extra;
+    } else {
+      *grad_in = static_cast<scalar_t>(-grad_in_mult_);
+      return max - extra;
+    }
+  }
+
 }}}  // namespace at::native::detail
@@ -0,0 +1,38 @@
+#include "ATen/ATen.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/native/cpu/HashingKernel.h"
+
+// Note [Feature hashing]
+// ~~~~~~~~~~~~~~~~~~~~~~
+// murmur3_hash maps integer feature ids to hashes for the hashing trick. Every
+// id is taken as 64 bits and hashed as 8 bytes with MurmurHash3_x64_128, of
+// which the low 64 bits are kept. These are the hashes of the Caffe2
+// MurmurHash operator, so features hashed by either agree.
+//
+// Every seed gives an independent hash. With a single seed, the result has
+// the shape of the input; with k > 1 seeds it has an extra last dimension of
+// size k, holding the hashes of an id with every seed, which is what e.g.
+// multiple hashing or count sketches need. If modulo is positive, the hashes
+// are taken as unsigned and bucketed into [0, modulo); otherwise the result
+// holds their 64 bits as is.
+
+namespace at { namespace native {
+
+DEFINE_DISPATCH(murmur3_hash_stub);
+
+Tensor _murmur3_hash_cpu(const Tensor& self, IntList seeds, int64_t modulo) {
+  AT_CHECK(isIntegralType(self.type().scalarType()),
+           "murmur3_hash: expected an integral tensor, but got ", self.type().toString());
+  AT_CHECK(seeds.size() > 0, "murmur3_hash: seeds must not be empty");
+  AT_CHECK(modulo >= 0, "murmur3_hash: modulo must be >= 0, but got ", modulo);
+  auto keys = self.toType(kLong).contiguous();
+  auto sizes = self.sizes().vec();
+  if (seeds.size() > 1) {
+    sizes.push_back(seeds.size());
+  }
+  auto result = at::empty(sizes, keys.options());
+  murmur3_hash_stub(kCPU, result, keys, seeds, modulo);
+  return result;
+}
+
+}} // namespace at::native
@@ -3,7 +3,7 @@
 // This corresponds to "advanced indexing" in NumPy. The two operations are:
 //
 //  index(Tensor self, indices) -> Tensor
-//  index_put_(Tensor self, indices, value)
+//  index_put_(Tensor self, indices, value, accumulate=false)
 //
 // The index is a TensorList containg kLong or kByte tensors or nulls. Byte
 // tensors (boolean masks) are expanded to long tensors via nonzero(). Null
@@ -20,15 +20,22 @@
 // Note 2: The behavior is more complicated when the index tensors are not all
 // adjacent (e.g. x[[0, 1], :, [2, 3]]). In this case, self and the index
 // tensors are transposed to the front: x.transpose(1, 2)[[0, 1], [2, 3]]
+//
+// Note 3: Both operations are a single TensorIterator kernel over the shape of
+// the result, see AdvancedIndex and Indexing.h. With accumulate=true,
+// index_put_ adds the values to self instead of assigning them, accumulating
+// the values of duplicate indices.
 
 
 #include "ATen/ATen.h"
 #include "ATen/NativeFunctions.h"
 #include "ATen/ExpandUtils.h"
+#include "ATen/WrapDimUtils.h"
+#include "ATen/native/Indexing.h"
+#include "ATen/native/TensorIterator.h"
+#include "ATen/native/cpu/IndexSelectKernel.h"
 
 #include <algorithm>
-#include <functional>
-#include <numeric>
 #include <vector>
 
 namespace at { namespace native {
@@ -122,95 +129,108 @@ transposeToFront(Tensor self, TensorList indices) {
   return std::make_tuple(self.permute(dims), std::move(transposedIndices));
 }
 
-static std::vector<int64_t> computeLinearStride(const Tensor & tensor) {
-  // computes the stride as if tensor were contigous
-  auto sizes = tensor.sizes();
-  std::vector<int64_t> stride(tensor.dim());
-  stride[tensor.dim() - 1] = 1;
-  std::partial_sum(sizes.rbegin(), sizes.rend() - 1, stride.rbegin() + 1, std::multiplies<int64_t>());
-  return stride;
+static Tensor restride_src(const Tensor& src, int64_t dims_before, int64_t dims_indexed,
+                           IntList replacement_shape) {
+  auto shape = src.sizes().vec();
+  auto strides = src.strides().vec();
+  int64_t end = dims_before + dims_indexed;
+  shape.erase(shape.begin() + dims_before, shape.begin() + end);
+  strides.erase(strides.begin() + dims_before, strides.begin() + end);
+  shape.insert(shape.begin() + dims_before, replacement_shape.begin(), replacement_shape.end());
+  strides.insert(strides.begin() + dims_before, replacement_shape.size(), 0);
+  return src.as_strided(shape, strides);
 }
 
-// Unsqueezes src `before` times at the front and `after` times at the end
-static Tensor unsqueezeN(const Tensor & src, int64_t before, int64_t after) {
-  auto srcSizes = src.sizes();
-  auto nDim = src.dim();
-  std::vector<int64_t> sizes(nDim + before + after, 1);
-  for (int64_t i = 0; i < nDim; i++) {
-    sizes[i + before] = srcSizes[i];
-  }
-  return src.view(sizes);
+// Views the index with `before` dimensions of size 1 at the front and `after`
+// at the end, so that it broadcasts against the restrided src
+static Tensor reshape_indexer(const Tensor& index, int64_t before, int64_t after) {
+  auto shape = std::vector<int64_t>(before, 1);
+  auto index_shape = index.sizes();
+  shape.insert(shape.end(), index_shape.begin(), index_shape.end());
+  shape.insert(shape.end(), after, 1);
+  return index.reshape(shape);
 }
 
-static Tensor wrapIndexOnce(const Tensor & index, int64_t dim, int64_t dim_size) {
-  if (index.numel() != 0) {
-    auto max_idx = index.max().toCLong();
-    auto min_idx = index.min().toCLong();
-    if (max_idx >= dim_size) {
-      AT_ERROR("index ", max_idx, " is out of bounds for dimension ", dim, " with size ", dim_size);
-    }
-    if (min_idx < -dim_size) {
-      AT_ERROR("index ", min_idx, " is out of bounds for dimension ", dim, " with size ", dim_size);
+static bool all_strides_match(TensorList tensors) {
+  AT_ASSERT(tensors.size() >= 1);
+  auto strides = tensors[0].strides();
+  for (auto& tensor : tensors.slice(1)) {
+    if (!strides.equals(tensor.strides())) {
+      return false;
     }
   }
-  return index.remainder(dim_size);
+  return true;
 }
 
-static Tensor computeLinearIndex(const Tensor & src, TensorList indices) {
-  auto strides = computeLinearStride(src);
-  Type& longType = src.type().toScalarType(kLong);
-
-  // Compute the linear index by multiplying the indexing tensors by the
-  // stride and summing them. All the indexing tensors have the same shape at
-  // this point. We also compute the number of dimensions before and after that
-  // are not being index.
-  Tensor linearIndex;
-  int64_t emptyBefore = 0, emptyAfter = 0, nElemBefore = 1, nElemAfter = 1;
-  for (int64_t i = 0; i < src.dim(); i++) {
-    if (indices[i].defined()) {
-      // Cast index to the longType matching src's backend
-      // This allows us to support ie indexing a cuda tensor with a cpu tensor
-      Tensor index = (wrapIndexOnce(indices[i], i, src.size(i)) * strides[i]).toType(longType);
-      if (linearIndex.defined()) {
-        linearIndex += index;
+namespace {
+
+// The operands of the indexing kernels (see Indexing.h) for indices whose
+// non-null tensors are adjacent and broadcast together. For example, for a
+// src of shape (5, 6, 7, 8) indexed by [nullptr, a, b, nullptr] where a and b
+// have shape (3, 4):
+//
+//  src is restrided to (5, 3, 4, 8): dimensions 1 and 2 are replaced by the
+//    index shape, with stride 0
+//  indices are {a, b}, viewed with shape (1, 3, 4, 1)
+//  indexed_sizes are (6, 7) and indexed_strides are src's strides of
+//    dimensions 1 and 2, in bytes
+//
+// so that the kernels visit the shape of the result, (5, 3, 4, 8), once.
+struct AdvancedIndex {
+  AdvancedIndex(const Tensor& src, TensorList indices);
+
+  Tensor src;
+  std::vector<Tensor> indices;
+  std::vector<int64_t> indexed_sizes;
+  std::vector<int64_t> indexed_strides;
+};
+
+AdvancedIndex::AdvancedIndex(const Tensor& src, TensorList indices_list) {
+  int64_t element_size_bytes = src.type().elementSizeInBytes();
+  int64_t dims_before = 0, dims_after = 0, dims_indexed = 0;
+  IntList replacement_shape;
+  for (size_t dim = 0; dim < indices_list.size(); dim++) {
+    if (!indices_list[dim].defined()) {
+      if (dims_indexed == 0) {
+        dims_before++;
       } else {
-        linearIndex = index;
+        dims_after++;
       }
-    } else if (linearIndex.defined()) {
-      emptyAfter++;
-      nElemAfter *= src.size(i);
     } else {
-      emptyBefore++;
-      nElemBefore *= src.size(i);
+      dims_indexed++;
+      replacement_shape = indices_list[dim].sizes();
+      indexed_sizes.push_back(src.size(dim));
+      indexed_strides.push_back(src.stride(dim) * element_size_bytes);
     }
   }
 
-  // Compute the linear indices for the parts of the tensor not being indexed
-  Tensor beforeIndex;
-  if (emptyBefore > 0) {
-    auto index = at::arange(0, nElemBefore, longType) * strides[emptyBefore - 1];
-    index = index.view(src.sizes().slice(0, emptyBefore));
-    beforeIndex = unsqueezeN(index, 0, linearIndex.dim() + emptyAfter);
-  }
-  Tensor afterIndex;
-  if (emptyAfter > 0) {
-    auto index = at::arange(0, nElemAfter, longType);
-    index = index.view(src.sizes().slice(src.dim() - emptyAfter, emptyAfter));
-    afterIndex = unsqueezeN(index, linearIndex.dim() + emptyBefore, 0);
+  // An index into a dimension of size 0 is always out of bounds, but the
+  // kernels never see it if there are no indices
+  if (std::find(indexed_sizes.begin(), indexed_sizes.end(), 0) != indexed_sizes.end() &&
+      std::find(replacement_shape.begin(), replacement_shape.end(), 0) == replacement_shape.end()) {
+    AT_ERROR("index is out of bounds for dimension with size 0");
   }
 
-  // Sum with broadcasting to compute the full index
-  linearIndex = unsqueezeN(linearIndex, emptyBefore, emptyAfter);
-  if (beforeIndex.defined()) {
-    linearIndex = linearIndex + beforeIndex;
+  this->src = restride_src(src, dims_before, dims_indexed, replacement_shape);
+
+  for (auto& index : indices_list) {
+    if (index.defined()) {
+      indices.push_back(reshape_indexer(index, dims_before, dims_after));
+    }
   }
-  if (afterIndex.defined()) {
-    linearIndex = linearIndex + afterIndex;
+
+  // The CUDA kernel computes one offset for all the indices, so they must
+  // have the same strides
+  if (indices.size() >= 2 && this->src.type().is_cuda() && !all_strides_match(indices)) {
+    for (auto& index : indices) {
+      index = index.contiguous();
+    }
   }
-  return linearIndex;
 }
 
-static std::tuple<Tensor, Tensor> makeLinearIndex(Tensor self, TensorList orig) {
+} // anonymous namespace
+
+static AdvancedIndex make_info(Tensor self, TensorList orig) {
   checkIndexTensorTypes(orig);
   // first expand ByteTensor (boolean masks) into 1 or more LongTensors
   auto indices = expandByteTensors(self, orig);
@@ -225,41 +245,120 @@ static std::tuple<Tensor, Tensor> makeLinearIndex(Tensor self, TensorList orig)
   if (!hasContiguousSubspace(indices)) {
     std::tie(self, indices) = transposeToFront(self, indices);
   }
-  auto linearIndex = computeLinearIndex(self, indices);
-  return std::make_tuple(self, linearIndex);
+  // This allows us to support ie indexing a cuda tensor with a cpu tensor
+  for (auto& index : indices) {
+    if (index.defined() && index.type().backend() != self.type().backend()) {
+      index = index.toBackend(self.type().backend());
+    }
+  }
+  return AdvancedIndex(self, indices);
 }
 
-Tensor index(const Tensor & self, TensorList indices) {
-  if (indices.size() > (size_t)self.dim()) {
-   AT_ERROR("too many indices for tensor of dimension ", self.dim(), " (got ", indices.size(), ")");
+static std::unique_ptr<TensorIterator> make_index_iterator(const AdvancedIndex& info, Tensor& result) {
+  auto builder = TensorIterator::Builder();
+  builder.add_output(result);
+  builder.add_input(info.src);
+  for (auto& index : info.indices) {
+    builder.add_input(index, kLong);
   }
+  return builder.build();
+}
+
+static std::unique_ptr<TensorIterator> make_index_put_iterator(const AdvancedIndex& info, const Tensor& value) {
+  if (!is_expandable_to(value.sizes(), info.src.sizes())) {
+    AT_ERROR("shape mismatch: value tensor of shape ", value.sizes(),
+             " cannot be expanded to indexing result of shape ", info.src.sizes());
+  }
+  auto builder = TensorIterator::Builder();
+  builder.dont_resize_outputs();
+  builder.add_output(info.src);
+  builder.add_input(value, info.src.type().scalarType());
+  for (auto& index : info.indices) {
+    builder.add_input(index, kLong);
+  }
+  return builder.build();
+}
 
-  Tensor src, linearIndex;
-  std::tie(src, linearIndex) = makeLinearIndex(self, indices);
-  return src.take(linearIndex);
+// Note [Masked fill fast path]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// self[mask] = value, with a single boolean mask and a value of one element,
+// is a masked_fill_. Unlike the general path it doesn't compute the nonzero()
+// of the mask, which on CUDA has to wait for the device to know the number of
+// indices. It doesn't synchronize at all when the value is on the CPU, like
+// the Python numbers of torch/csrc/autograd/python_variable_indexing.cpp.
+// Returns the mask viewed to broadcast against self, or an undefined tensor
+// if the fast path doesn't apply.
+static Tensor maskForFill(const Tensor & self, TensorList indices, const Tensor & value) {
+  if (value.numel() != 1) {
+    return Tensor();
+  }
+  Tensor mask;
+  int64_t dims_before = 0;
+  for (auto& index : indices) {
+    if (!index.defined()) {
+      if (!mask.defined()) {
+        dims_before++;
+      }
+    } else if (mask.defined() || index.type().scalarType() != kByte) {
+      return Tensor();
+    } else {
+      mask = index;
+    }
+  }
+  // masks of the wrong shape take the general path, which reports the error
+  if (!mask.defined() || mask.dim() == 0 || dims_before + mask.dim() > self.dim() ||
+      !mask.sizes().equals(self.sizes().slice(dims_before, mask.dim()))) {
+    return Tensor();
+  }
+  auto shape = mask.sizes().vec();
+  shape.insert(shape.end(), self.dim() - dims_before - mask.dim(), 1);
+  if (mask.type().backend() != self.type().backend()) {
+    mask = mask.toBackend(self.type().backend());
+  }
+  return mask.reshape(shape);
 }
 
-Tensor index_put(const Tensor & self, TensorList indices, const Tensor & value) {
+DEFINE_DISPATCH(index_stub);
+DEFINE_DISPATCH(index_put_stub);
+
+Tensor index(const Tensor & self, TensorList indices) {
   if (indices.size() > (size_t)self.dim()) {
    AT_ERROR("too many indices for tensor of dimension ", self.dim(), " (got ", indices.size(), ")");
   }
 
-  Tensor src, linearIndex, expandedValue;
-  std::tie(src, linearIndex) = makeLinearIndex(self, indices);
-  std::tie(expandedValue) = expand_inplace(linearIndex, value);
-  Tensor dst = src.clone();
-  return dst.put_(linearIndex, expandedValue);
+  auto info = make_info(self, indices);
+  auto result = info.src.type().tensor(info.src.sizes());
+  auto iter = make_index_iterator(info, result);
+  index_stub(iter->device_type(), *iter, info.indexed_sizes, info.indexed_strides);
+  return result;
+}
+
+Tensor index_put(const Tensor & self, TensorList indices, const Tensor & value, bool accumulate) {
+  return self.clone().index_put_(indices, value, accumulate);
 }
 
-Tensor & index_put_(Tensor & self, TensorList indices, const Tensor & value) {
+Tensor & index_put_(Tensor & self, TensorList indices, const Tensor & value, bool accumulate) {
   if (indices.size() > (size_t)self.dim()) {
    AT_ERROR("too many indices for tensor of dimension ", self.dim(), " (got ", indices.size(), ")");
   }
+  if (value.type().scalarType() != self.type().scalarType()) {
+    AT_ERROR("index_put_(): expected a value of scalar type ", self.type().scalarType(),
+             " but got ", value.type().scalarType());
+  }
+
+  if (!accumulate) {
+    auto mask = maskForFill(self, indices, value);
+    if (mask.defined()) {
+      return self.masked_fill_(mask, value.view({}));
+    }
+  }
 
-  Tensor src, linearIndex, expandedValue;
-  std::tie(src, linearIndex) = makeLinearIndex(self, indices);
-  std::tie(expandedValue) = expand_inplace(linearIndex, value);
-  return src.put_(linearIndex, expandedValue);
+  auto info = make_info(self, indices);
+  auto value_ = value.type().backend() != self.type().backend()
+      ? value.toBackend(self.type().backend()) : value;
+  auto iter = make_index_put_iterator(info, value_);
+  index_put_stub(iter->device_type(), *iter, info.indexed_sizes, info.indexed_strides, accumulate);
+  return self;
 }
 
 Tensor & index_copy_(Tensor & self, int64_t dim, const Tensor & index, const Tensor & source) {
@@ -304,4 +403,37 @@ Tensor & index_copy_(Tensor & self, int64_t dim, const Tensor & index, const Ten
   return self._indexCopy_(dim, index, source);
 }
 
+DEFINE_DISPATCH(index_select_stub);
+
+Tensor & index_select_out_cpu(Tensor & result, const Tensor & self, int64_t dim, const Tensor & index) {
+  // TH handles the rest, including the error messages for bad arguments
+  if (self.dim() == 0 || index.dim() != 1 || index.type().scalarType() != kLong ||
+      !self.is_contiguous()) {
+    return at::_th_index_select_out(result, self, dim, index);
+  }
+  dim = maybe_wrap_dim(dim, self.dim());
+  auto sizes = self.sizes().vec();
+  sizes[dim] = index.numel();
+  result.resize_(sizes);
+  if (!result.is_contiguous()) {
+    return at::_th_index_select_out(result, self, dim, index);
+  }
+  auto contig_index = index.contiguous();
+  auto index_data = contig_index.data<int64_t>();
+  int64_t dim_size = self.size(dim);
+  for (int64_t i = 0; i < contig_index.numel(); i++) {
+    if (index_data[i] < 0 || index_data[i] >= dim_size) {
+      AT_ERROR("index_select(): index ", index_data[i], " is out of bounds for dimension ",
+               dim, " with size ", dim_size);
+    }
+  }
+  index_select_stub(kCPU, result, self, dim, contig_index);
+  return result;
+}
+
+Tensor index_select_cpu(const Tensor & self, int64_t dim, const Tensor & index) {
+  Tensor result = self.type().tensor();
+  return at::native::index_select_out_cpu(result, self, dim, index);
+}
+
 }} // at::native
@@ -0,0 +1,28 @@
+#pragma once
+
+// Kernels for advanced indexing, see Indexing.cpp. Both iterate a
+// TensorIterator whose operands are the output, the input and one Long index
+// tensor for each indexed dimension:
+//
+//  index:      (result, src, index_0, ..., index_k)
+//  index_put_: (self, value, index_0, ..., index_k)
+//
+// `src` and `self` are restrided so that the indexed dimensions have stride 0,
+// and the kernels add index_i * indexed_strides[i] (in bytes) to their offset.
+// Negative indices are wrapped with indexed_sizes; out of range indices are
+// errors.
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { struct TensorIterator; }
+
+namespace at { namespace native {
+
+using index_fn = void(*)(TensorIterator&, IntList indexed_sizes, IntList indexed_strides);
+using index_put_fn = void(*)(TensorIterator&, IntList indexed_sizes, IntList indexed_strides, bool accumulate);
+
+DECLARE_DISPATCH(index_fn, index_stub);
+DECLARE_DISPATCH(index_put_fn, index_put_stub);
+
+}} // namespace at::native
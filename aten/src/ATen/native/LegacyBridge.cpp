@@ -170,6 +170,10 @@ Tensor _sparse_coo_tensor_unsafe(const Tensor& indices, const Tensor& values, Ar
   return values.type().toSparse()._native_sparse_coo_tensor_unsafe(indices, values, size);
 }
 
+Tensor _sparse_coo_tensor_from_csr(const Tensor& crow_indices, const Tensor& col_indices, const Tensor& values, ArrayRef<int64_t> size) {
+  return values.type().toSparse()._native_sparse_coo_tensor_from_csr(crow_indices, col_indices, values, size);
+}
+
 int64_t get_device(const Tensor& self) {
   if (_has_native(self)) {
     return native_get_device(self);
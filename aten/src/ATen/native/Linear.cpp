@@ -1,10 +1,12 @@
 #include "ATen/ATen.h"
 #include "ATen/NativeFunctions.h"
 #include "ATen/WrapDimUtilsMulti.h"
+#include "ATen/native/Linear.h"
 #include <cctype>
 
 namespace at { namespace native {
 
+DEFINE_DISPATCH(bias_relu_stub);
 
 // sumproduct_pair computes `(left*right).sum(sumdims)` by means of permutation and
 // batch matrix multiplication
@@ -440,4 +442,23 @@ Tensor bilinear(const Tensor& input1, const Tensor& input2, const Tensor& weight
   return output;
 }
 
+// relu(linear(input, weight, bias)): the bias and the relu are applied by a
+// single pass over the GEMM output instead of an addmm followed by a relu.
+Tensor linear_relu(const Tensor& input, const Tensor& weight, const Tensor& bias) {
+  AT_CHECK(input.dim() >= 1, "linear_relu(): input must have at least 1 dimension");
+  AT_CHECK(weight.dim() == 2, "linear_relu(): weight must be 2-dimensional, but got ", weight.dim());
+  AT_CHECK(input.size(-1) == weight.size(1),
+            "linear_relu(): input size does not match weight size: got ",
+            input.size(-1), " but expected ", weight.size(1));
+  AT_CHECK(!bias.defined() || (bias.dim() == 1 && bias.size(0) == weight.size(0)),
+            "linear_relu(): bias size does not match weight size: got ",
+            bias.sizes(), " but expected ", weight.size(0));
+
+  std::vector<int64_t> output_size(input.sizes().begin(), input.sizes().end() - 1);
+  output_size.push_back(weight.size(0));
+  Tensor output = at::mm(input.reshape({-1, input.size(-1)}), weight.t()).contiguous();
+  bias_relu_stub(output.type().device_type(), output, bias.defined() ? bias.contiguous() : bias);
+  return output.view(output_size);
+}
+
 }}  // namespace at::native
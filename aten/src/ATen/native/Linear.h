@@ -0,0 +1,15 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// The epilogue of linear_relu: out = max(out + bias, 0) in place, for a
+// contiguous (M, N) out and a contiguous bias of N elements, which may be
+// undefined.
+using bias_relu_fn = void(*)(Tensor& out, const Tensor& bias);
+
+DECLARE_DISPATCH(bias_relu_fn, bias_relu_stub);
+
+}} // namespace at::native
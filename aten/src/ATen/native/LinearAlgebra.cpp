@@ -83,15 +83,27 @@ std::tuple<Tensor, Tensor> slogdet(const Tensor& self) {
   return std::make_tuple(det.sign(), diag_U.abs_().log_().sum());
 }
 
+// Supports arbitrary batch dimensions for self
 Tensor inverse(const Tensor& self) {
-  Tensor result = self.type().tensor();
-  return at::native::inverse_out(result, self);
+  if (self.dim() <= 2) {
+    Tensor result = self.type().tensor();
+    return at::native::inverse_out(result, self);
+  }
+  AT_CHECK(self.type().backend() == Backend::CPU || self.type().backend() == Backend::CUDA,
+           "tensor should have CPU or CUDA backend");
+  AT_CHECK(self.size(-1) == self.size(-2), "tensor should be batches of square matrices");
+  AT_CHECK(at::isFloatingType(self.type().scalarType()), "tensor should be of floating-point type");
+  if (self.numel() == 0) {
+    return at::empty_like(self);
+  }
+  return at::_inverse_helper(self);
 }
 
 Tensor& inverse_out(Tensor &result, const Tensor &self) {
   AT_CHECK(self.type().backend() == Backend::CPU || self.type().backend() == Backend::CUDA,
            "tensor should have CPU or CUDA backend");
-  AT_CHECK(self.dim() == 2, "tensor should be 2 dimensional");
+  AT_CHECK(self.dim() == 2, "tensor should be 2 dimensional; torch.inverse() with the "
+           "`out` keyword does not support batching");
   AT_CHECK(self.size(0) == self.size(1), "tensor should be square");
   AT_CHECK(at::isFloatingType(self.type().scalarType()), "tensor should be of floating-point type");
   if (self.size(0) == 0) {
@@ -101,6 +113,22 @@ Tensor& inverse_out(Tensor &result, const Tensor &self) {
   }
 }
 
+// Supports arbitrary batch dimensions for self
+Tensor cholesky(const Tensor& self, bool upper) {
+  AT_CHECK(self.dim() >= 2, "cholesky(", self.type(), "{", self.sizes(), "}): expected "
+           "a tensor of at least 2 dimensions");
+  AT_CHECK(self.size(-1) == self.size(-2), "cholesky(", self.type(), "{", self.sizes(), "}): "
+           "expected batches of square matrices");
+  AT_CHECK(at::isFloatingType(self.type().scalarType()), "tensor should be of floating-point type");
+  if (self.dim() == 2) {
+    return at::potrf(self, upper);
+  }
+  if (self.numel() == 0) {
+    return at::empty_like(self);
+  }
+  return at::_cholesky_helper(self, upper);
+}
+
 Tensor pinverse(const Tensor& self, double rcond) {
   AT_CHECK(at::isFloatingType(self.type().scalarType()) && self.dim() == 2,
            "pinverse(", self.type(), "{", self.sizes(), "}): expected a 2D tensor "
@@ -10,6 +10,8 @@
 #include "ATen/Dispatch.h"
 #include "ATen/TensorUtils.h"
 
+#include <algorithm>
+#include <cmath>
 #include <numeric>
 #include <type_traits>
 
@@ -321,6 +323,10 @@ Tensor ctc_loss_backward_cpu(const Tensor& grad, const Tensor& log_probs, const
   });
 }
 
+// Above this many bytes of log_alpha, the CUDA implementation switches to the checkpointed variant,
+// which doesn't keep all of log_alpha and log_beta (see native/cuda/LossCTC.cu)
+constexpr int64_t CTC_LOSS_CHECKPOINTED_MIN_BYTES = 256 * 1024 * 1024;
+
 // this wrapper function dispatches to the native and cudnn implementations and hides the alpha/grad from the user (by just returning the loss)
 // the gradient is implemented for _cudnn_ctc_loss (just in derivatives.yaml) and _ctc_loss and this function has automatic gradients
 // it also handles the reduction if desired
@@ -347,9 +353,30 @@ Tensor ctc_loss(const Tensor& log_probs, const Tensor& targets, IntList input_le
     }
   }
 
+  bool use_checkpointed = false;
+  int64_t checkpoint_interval = 0;
+  if (!use_cudnn && (log_probs.type().backend() == Backend::CUDA) && (log_probs.dim() == 3)) {
+    int64_t max_input_length = log_probs.size(0);
+    int64_t max_target_length = 0;
+    if (targets.dim() == 1) {
+      for (int64_t b = 0; b < target_lengths.size(); b++) {
+        max_target_length = std::max(max_target_length, target_lengths[b]);
+      }
+    } else if (targets.dim() == 2) {
+      max_target_length = targets.size(1);
+    }
+    int64_t log_alpha_bytes = log_probs.size(1) * max_input_length * (2*max_target_length+1) * log_probs.type().elementSizeInBytes();
+    use_checkpointed = log_alpha_bytes >= CTC_LOSS_CHECKPOINTED_MIN_BYTES;
+    // keeping every sqrt(input_length)-th row of log_alpha balances the checkpoints against the
+    // segments that are recomputed in the backward
+    checkpoint_interval = std::max<int64_t>(1, static_cast<int64_t>(std::ceil(std::sqrt(static_cast<double>(max_input_length)))));
+  }
+
   Tensor res;
   if (use_cudnn) {
     res = std::get<0>(at::_cudnn_ctc_loss(log_probs, targets, input_lengths, target_lengths, BLANK, ctx.deterministicCuDNN()));
+  } else if (use_checkpointed) {
+    res = std::get<0>(at::_ctc_loss_checkpointed(log_probs, targets, input_lengths, target_lengths, BLANK, checkpoint_interval));
   } else {
     res = std::get<0>(at::_ctc_loss(log_probs, targets, input_lengths, target_lengths, BLANK));
   }
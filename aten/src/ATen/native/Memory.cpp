@@ -16,5 +16,36 @@ Tensor pin_memory(const Tensor& self) {
   return tensor;
 }
 
+std::vector<Tensor> _pin_memory_coalesced(TensorList tensors) {
+  if (tensors.empty()) {
+    return {};
+  }
+  auto& type = tensors[0].type();
+  int64_t total_numel = 0;
+  for (auto& t : tensors) {
+    if (t.type() != type) {
+      AT_ERROR("expected all tensors to be of type '", type.toString(), "' but got '", t.type().toString(), "'");
+    }
+    total_numel += t.numel();
+  }
+  if (type.backend() != Backend::CPU) {
+    AT_ERROR("cannot pin '", type.toString(), "' only CPU memory can be pinned");
+  }
+  // a single pinned buffer holds all inputs, so that they share one host
+  // allocation and can be copied to the device together
+  auto* allocator = detail::getCUDAHooks().getPinnedMemoryAllocator();
+  auto flat = type.tensorWithAllocator({total_numel}, {1}, allocator);
+  std::vector<Tensor> result;
+  result.reserve(tensors.size());
+  int64_t offset = 0;
+  for (auto& t : tensors) {
+    auto pinned = flat.narrow(0, offset, t.numel()).view(t.sizes());
+    pinned.copy_(t);
+    result.push_back(pinned);
+    offset += t.numel();
+  }
+  return result;
+}
+
 }
 }
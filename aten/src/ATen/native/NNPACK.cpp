@@ -0,0 +1,335 @@
+#include <ATen/ATen.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/Config.h>
+
+#if !AT_NNPACK_ENABLED()
+
+namespace at { namespace native {
+
+at::Tensor _nnpack_spatial_convolution(
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
+    IntList padding) {
+  throw std::runtime_error("_nnpack_spatial_convolution: ATen not compiled with NNPACK support");
+}
+
+bool _nnpack_available() {
+  return false;
+}
+
+int64_t _nnpack_get_weight_cache_size() {
+  throw std::runtime_error("_nnpack_get_weight_cache_size: ATen not compiled with NNPACK support");
+}
+
+int64_t _nnpack_get_weight_cache_max_size() {
+  throw std::runtime_error("_nnpack_get_weight_cache_max_size: ATen not compiled with NNPACK support");
+}
+
+void _nnpack_set_weight_cache_max_size(int64_t max_size) {
+  throw std::runtime_error("_nnpack_set_weight_cache_max_size: ATen not compiled with NNPACK support");
+}
+
+void _nnpack_clear_weight_cache() {
+  throw std::runtime_error("_nnpack_clear_weight_cache: ATen not compiled with NNPACK support");
+}
+
+}}
+
+#else // AT_NNPACK_ENABLED
+
+#include <ATen/native/utils/ParamsHash.h>
+#include "caffe2/utils/threadpool/ThreadPool.h"
+#include "nnpack.h"
+
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace at { namespace native {
+
+bool _nnpack_available() {
+  // nnp_initialize fails on CPUs that NNPACK doesn't support, e.g. x86 without
+  // AVX2, and is a noop after the first call.
+  static const bool available = nnp_initialize() == nnp_status_success;
+  return available;
+}
+
+// NNPACK parallelizes through the pthreadpool interface, which
+// caffe2/utils/threadpool implements on top of caffe2::ThreadPool, like for
+// Caffe2's NNPACK operators. All the ATen convolutions share one pool.
+static pthreadpool_t nnpack_threadpool() {
+  static std::unique_ptr<caffe2::ThreadPool> pool =
+      caffe2::ThreadPool::defaultThreadPool();
+  return reinterpret_cast<pthreadpool_t>(pool.get());
+}
+
+namespace {
+
+struct ConvolutionShape {
+  size_t input_channels;
+  size_t output_channels;
+  nnp_size input_size;
+  nnp_padding padding;
+  nnp_size kernel_size;
+  nnp_size output_subsampling;
+};
+
+// Winograd (F(6x6, 3x3)) or FFT, whichever NNPACK thinks is faster for the
+// shape. The same choice is made when transforming the weights and when
+// running the convolution.
+constexpr nnp_convolution_algorithm algorithm = nnp_convolution_algorithm_auto;
+
+static nnp_status nnpack_convolution(
+    const ConvolutionShape& shape, nnp_convolution_transform_strategy strategy,
+    const float* input, const void* kernel, const float* bias, float* output,
+    void* workspace, size_t* workspace_size) {
+  return nnp_convolution_inference(
+      algorithm,
+      strategy,
+      shape.input_channels,
+      shape.output_channels,
+      shape.input_size,
+      shape.padding,
+      shape.kernel_size,
+      shape.output_subsampling,
+      input,
+      static_cast<const float*>(kernel),
+      bias,
+      output,
+      workspace,
+      workspace_size,
+      nnp_activation_identity,
+      nullptr /* activation parameters */,
+      nnpack_threadpool(),
+      nullptr /* profile */);
+}
+
+// Returns the weights in the layout of the transform domain, or an undefined
+// tensor if the algorithm NNPACK picked has no weight transform.
+static Tensor transform_weight(const ConvolutionShape& shape, const Tensor& weight) {
+  size_t transformed_size = 0;
+  auto status = nnpack_convolution(
+      shape, nnp_convolution_transform_strategy_precompute,
+      nullptr, nullptr, nullptr, nullptr, nullptr, &transformed_size);
+  if (status != nnp_status_success) {
+    return Tensor();
+  }
+  auto transformed = at::empty({static_cast<int64_t>(transformed_size)}, weight.options().dtype(kByte));
+  status = nnpack_convolution(
+      shape, nnp_convolution_transform_strategy_precompute,
+      nullptr, weight.data_ptr(), nullptr, nullptr, transformed.data_ptr(), &transformed_size);
+  AT_CHECK(status == nnp_status_success, "NNPACK weight transform failed with status ", status);
+  return transformed;
+}
+
+// Note [NNPACK weight cache]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Winograd and FFT convolutions multiply in the transform domain, and
+// transforming the weights on every call is a large part of the cost of
+// small-batch inference. The weight cache keeps the transformed weights of the
+// most recently used convolutions, keyed by the weight's data pointer, the
+// weight and input sizes and the padding. Like the MKL-DNN weight cache (see
+// Note [MKL-DNN weight cache]) it can't notice a weight being modified in
+// place, so it is disabled (max_size is 0) unless it's turned on, and each
+// entry holds a reference to its weight.
+//
+// Without the cache, the weights are still only transformed once per call
+// rather than once per image.
+
+struct WeightCacheKey {
+  void* data;
+  int64_t weight_size[4];
+  int64_t input_size[2];
+  int64_t padding[2];
+};
+
+class WeightCache {
+public:
+  // Returns true and sets `transformed` if there is an entry for `key`
+  bool find(const WeightCacheKey& key, Tensor* transformed) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = map_.find(key);
+    if (it == map_.end()) {
+      return false;
+    }
+    // move to the front of the usage list
+    list_.splice(list_.begin(), list_, it->second);
+    *transformed = it->second->transformed;
+    return true;
+  }
+
+  void insert(const WeightCacheKey& key, const Tensor& weight, const Tensor& transformed) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (max_size_ == 0 || map_.count(key)) {
+      return;
+    }
+    if (list_.size() >= max_size_) {
+      map_.erase(list_.back().key);
+      list_.pop_back();
+    }
+    list_.push_front(Entry{key, weight, transformed});
+    map_.emplace(key, list_.begin());
+  }
+
+  size_t size() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return list_.size();
+  }
+
+  size_t max_size() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return max_size_;
+  }
+
+  void set_max_size(int64_t max_size) {
+    AT_CHECK(max_size >= 0, "NNPACK weight cache size must be non-negative, but got ", max_size);
+    std::lock_guard<std::mutex> guard(mutex_);
+    max_size_ = max_size;
+    while (list_.size() > max_size_) {
+      map_.erase(list_.back().key);
+      list_.pop_back();
+    }
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    map_.clear();
+    list_.clear();
+  }
+
+private:
+  struct Entry {
+    WeightCacheKey key;
+    Tensor weight;
+    // undefined if the weights can't be pre-transformed
+    Tensor transformed;
+  };
+
+  std::mutex mutex_;
+  std::list<Entry> list_;
+  std::unordered_map<WeightCacheKey, std::list<Entry>::iterator,
+                     ParamsHash<WeightCacheKey>, ParamsEqual<WeightCacheKey>> map_;
+  size_t max_size_ = 0;
+};
+
+static WeightCache& weight_cache() {
+  static WeightCache cache;
+  return cache;
+}
+
+static WeightCacheKey weight_cache_key(
+    const Tensor& weight, const Tensor& input, IntList padding) {
+  WeightCacheKey key;
+  // the key is hashed and compared as raw bytes, so clear the padding
+  memset(&key, 0, sizeof(key));
+  key.data = weight.data_ptr();
+  for (int64_t i = 0; i < 4; i++) {
+    key.weight_size[i] = weight.size(i);
+  }
+  key.input_size[0] = input.size(2);
+  key.input_size[1] = input.size(3);
+  key.padding[0] = padding[0];
+  key.padding[1] = padding[1];
+  return key;
+}
+
+} // namespace
+
+// Convolution with stride 1 and no dilation of a (N, C, H, W) float input,
+// one image at a time with NNPACK's inference API, which is what small
+// batches want. The output is contiguous.
+at::Tensor _nnpack_spatial_convolution(
+    const at::Tensor& input_, const at::Tensor& weight_, const at::Tensor& bias_,
+    IntList padding) {
+  AT_CHECK(input_.dim() == 4 && weight_.dim() == 4,
+           "_nnpack_spatial_convolution: expected 4D input and weight, but got ",
+           input_.dim(), "D input and ", weight_.dim(), "D weight");
+  AT_CHECK(input_.size(1) == weight_.size(1),
+           "_nnpack_spatial_convolution: expected input with ", weight_.size(1),
+           " channels, but got ", input_.size(1));
+  AT_CHECK(padding.size() == 2, "_nnpack_spatial_convolution: expected 2 paddings");
+  AT_CHECK(_nnpack_available(), "_nnpack_spatial_convolution: NNPACK doesn't support this CPU");
+
+  auto input = input_.contiguous();
+  auto weight = weight_.contiguous();
+  const int64_t batch_size = input.size(0);
+  const int64_t input_channels = input.size(1);
+  const int64_t output_channels = weight.size(0);
+  const int64_t output_height = input.size(2) + 2 * padding[0] - weight.size(2) + 1;
+  const int64_t output_width = input.size(3) + 2 * padding[1] - weight.size(3) + 1;
+  AT_CHECK(output_height > 0 && output_width > 0,
+           "_nnpack_spatial_convolution: kernel size can't be greater than the padded input size");
+  auto output = at::empty({batch_size, output_channels, output_height, output_width}, input.options());
+  // NNPACK always adds a bias
+  auto bias = bias_.defined() ? bias_.contiguous() : at::zeros({output_channels}, input.options());
+
+  ConvolutionShape shape;
+  shape.input_channels = input_channels;
+  shape.output_channels = output_channels;
+  shape.input_size = {static_cast<size_t>(input.size(3)), static_cast<size_t>(input.size(2))};
+  shape.padding = {static_cast<size_t>(padding[0]), static_cast<size_t>(padding[1]),
+                   static_cast<size_t>(padding[0]), static_cast<size_t>(padding[1])};
+  shape.kernel_size = {static_cast<size_t>(weight.size(3)), static_cast<size_t>(weight.size(2))};
+  shape.output_subsampling = {1, 1};
+
+  // See Note [NNPACK weight cache]
+  Tensor transformed;
+  auto& cache = weight_cache();
+  if (cache.max_size() == 0) {
+    if (batch_size > 1) {
+      transformed = transform_weight(shape, weight);
+    }
+  } else {
+    auto key = weight_cache_key(weight, input, padding);
+    if (!cache.find(key, &transformed)) {
+      transformed = transform_weight(shape, weight);
+      cache.insert(key, weight, transformed);
+    }
+  }
+  const auto strategy = transformed.defined()
+      ? nnp_convolution_transform_strategy_reuse
+      : nnp_convolution_transform_strategy_compute;
+  const void* kernel = transformed.defined() ? transformed.data_ptr() : weight.data_ptr();
+
+  size_t workspace_size = 0;
+  auto status = nnpack_convolution(
+      shape, strategy, nullptr, nullptr, nullptr, nullptr, nullptr, &workspace_size);
+  AT_CHECK(status == nnp_status_success, "NNPACK convolution failed with status ", status);
+  // a null workspace would make NNPACK only query its size
+  auto workspace = at::empty(
+      {static_cast<int64_t>(std::max<size_t>(workspace_size, 1))}, input.options().dtype(kByte));
+
+  const float* input_data = input.data<float>();
+  float* output_data = output.data<float>();
+  const int64_t input_stride = input_channels * input.size(2) * input.size(3);
+  const int64_t output_stride = output_channels * output_height * output_width;
+  for (int64_t n = 0; n < batch_size; n++) {
+    size_t size = workspace.numel();
+    status = nnpack_convolution(
+        shape, strategy, input_data + n * input_stride, kernel, bias.data<float>(),
+        output_data + n * output_stride, workspace.data_ptr(), &size);
+    AT_CHECK(status == nnp_status_success, "NNPACK convolution failed with status ", status);
+  }
+  return output;
+}
+
+int64_t _nnpack_get_weight_cache_size() {
+  return weight_cache().size();
+}
+
+int64_t _nnpack_get_weight_cache_max_size() {
+  return weight_cache().max_size();
+}
+
+void _nnpack_set_weight_cache_max_size(int64_t max_size) {
+  weight_cache().set_max_size(max_size);
+}
+
+void _nnpack_clear_weight_cache() {
+  weight_cache().clear();
+}
+
+}}  // namespace at::native
+
+#endif // AT_NNPACK_ENABLED
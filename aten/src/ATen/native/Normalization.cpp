@@ -4,11 +4,18 @@
 #include "ATen/Config.h"
 
 #include "ATen/detail/CUDAHooksInterface.h"
+#include "ATen/native/cpu/NormalizationKernel.h"
 
+#include <tuple>
 #include <vector>
 
 namespace at { namespace native {
 
+DEFINE_DISPATCH(layer_norm_stub);
+DEFINE_DISPATCH(layer_norm_backward_stub);
+DEFINE_DISPATCH(group_norm_stub);
+DEFINE_DISPATCH(group_norm_backward_stub);
+
 namespace {
   void check_dims_match_num_input_features(const char* arg_name, int64_t expected, int64_t actual){
     if (actual != expected){
@@ -17,6 +24,7 @@ namespace {
       throw std::runtime_error(ss.str());
     }
   }
+
 }
 
 Tensor batch_norm(
@@ -54,8 +62,10 @@ Tensor batch_norm(
                && cudnn_enabled && detail::getCUDAHooks().versionCuDNN() >= 5110L);
 
   if (use_cudnn && eps >= detail::getCUDAHooks().batchnormMinEpsilonCuDNN()) {
+    // cuDNN normalizes channels-last inputs natively, see Note [Channels last]
+    bool channels_last = suggest_memory_format(input.sizes(), input.strides()) == MemoryFormat::ChannelsLast;
     return std::get<0>(at::cudnn_batch_norm(
-                        input.contiguous(), weight.contiguous(),
+                        channels_last ? input : input.contiguous(), weight.contiguous(),
                         bias.contiguous(),
                         running_mean.defined() ? running_mean.contiguous() : running_mean,
                         running_var.defined() ? running_var.contiguous() : running_var,
@@ -112,27 +122,19 @@ Tensor layer_norm(const Tensor& input, IntList normalized_shape,
       throw std::runtime_error(ss.str());
     }
 
-    int64_t n = 1;
+    int64_t M = 1;
     for (int64_t i = 0; i < input_ndim - normalized_ndim; i++) {
-      n *= input_shape[i];
+      M *= input_shape[i];
+    }
+    int64_t N = 1;
+    for (auto size : normalized_shape) {
+      N *= size;
     }
 
     // Apply layer norm
-    auto input_reshaped = input.contiguous().view({1, n, -1});
-
-    auto out = at::batch_norm(input_reshaped, {}, {}, {}, {}, true, 0, eps,
-                              cudnn_enabled);
-    out = out.view(input_shape);
-
-    if (weight.defined() && bias.defined()) {
-      return bias.addcmul(out, weight, 1);
-    } else if (weight.defined()) {
-      return out.mul(weight);
-    } else if (bias.defined()) {
-      return out.add(bias);
-    } else {
-      return out;
-    }
+    return std::get<0>(at::native_layer_norm(
+        input.contiguous(), weight.defined() ? weight.contiguous() : weight,
+        bias.defined() ? bias.contiguous() : bias, M, N, eps));
 }
 
 Tensor group_norm(const Tensor& input, int64_t num_groups,
@@ -168,26 +170,81 @@ Tensor group_norm(const Tensor& input, int64_t num_groups,
     }
 
     // Apply group norm
-    auto input_reshaped = input.contiguous().view({1, b * num_groups, -1});
+    int64_t HxW = b * c == 0 ? 0 : input.numel() / (b * c);
+    return std::get<0>(at::native_group_norm(
+        input.contiguous(), weight.defined() ? weight.contiguous() : weight,
+        bias.defined() ? bias.contiguous() : bias, b, c, HxW, num_groups, eps));
+}
 
-    auto out = at::batch_norm(input_reshaped, {}, {}, {}, {}, true, 0, eps,
-                              cudnn_enabled);
-    out = out.view(input_shape);
+std::tuple<Tensor, Tensor, Tensor> layer_norm_cpu(
+    const Tensor& input, const Tensor& weight /* optional */, const Tensor& bias /* optional */,
+    int64_t M, int64_t N, double eps) {
+  Tensor X = input.contiguous();
+  Tensor Y = at::empty_like(X);
+  Tensor mean = at::empty({M}, X.options());
+  Tensor rstd = at::empty({M}, X.options());
+  if (M > 0) {
+    layer_norm_stub(kCPU, X, weight, bias, M, N, eps, Y, mean, rstd);
+  }
+  return std::make_tuple(Y, mean, rstd);
+}
 
-    if (!weight.defined() && !bias.defined()) {
-      return out;
-    }
+std::tuple<Tensor, Tensor, Tensor> layer_norm_backward_cpu(
+    const Tensor& grad_out, const Tensor& input, const Tensor& mean, const Tensor& rstd,
+    const Tensor& weight /* optional */, int64_t M, int64_t N, std::array<bool,3> output_mask) {
+  Tensor X = input.contiguous();
+  Tensor dX, dgamma, dbeta;
+  if (output_mask[0]) {
+    dX = at::empty_like(X);
+  }
+  if (output_mask[1]) {
+    dgamma = at::zeros({N}, X.options());
+  }
+  if (output_mask[2]) {
+    dbeta = at::zeros({N}, X.options());
+  }
+  if (M > 0) {
+    layer_norm_backward_stub(kCPU, grad_out.contiguous(), X, mean, rstd, weight, M, N, dX, dgamma, dbeta);
+  }
+  if (weight.defined()) {
+    dgamma = dgamma.defined() ? dgamma.view(weight.sizes()) : dgamma;
+    dbeta = dbeta.defined() ? dbeta.view(weight.sizes()) : dbeta;
+  }
+  return std::make_tuple(dX, dgamma, dbeta);
+}
 
-    std::vector<int64_t> affine_param_shape(input.dim(), 1);
-    affine_param_shape[1] = c;
+std::tuple<Tensor, Tensor, Tensor> group_norm_cpu(
+    const Tensor& input, const Tensor& weight /* optional */, const Tensor& bias /* optional */,
+    int64_t N, int64_t C, int64_t HxW, int64_t group, double eps) {
+  Tensor X = input.contiguous();
+  Tensor Y = at::empty_like(X);
+  Tensor mean = at::empty({N, group}, X.options());
+  Tensor rstd = at::empty({N, group}, X.options());
+  if (N > 0) {
+    group_norm_stub(kCPU, X, weight, bias, N, C, HxW, group, eps, Y, mean, rstd);
+  }
+  return std::make_tuple(Y, mean, rstd);
+}
 
-    if (weight.defined() && bias.defined()) {
-      return bias.view(affine_param_shape).addcmul(out, weight.view(affine_param_shape), 1);
-    } else if (weight.defined()) {
-      return out.mul(weight.view(affine_param_shape));
-    } else {
-      return out.add(bias.view(affine_param_shape));
-    }
+std::tuple<Tensor, Tensor, Tensor> group_norm_backward_cpu(
+    const Tensor& grad_out, const Tensor& input, const Tensor& mean, const Tensor& rstd,
+    const Tensor& weight /* optional */, int64_t N, int64_t C, int64_t HxW, int64_t group,
+    std::array<bool,3> output_mask) {
+  Tensor X = input.contiguous();
+  Tensor dX, dgamma, dbeta;
+  if (output_mask[0]) {
+    dX = at::empty_like(X);
+  }
+  if (output_mask[1]) {
+    dgamma = at::zeros({C}, X.options());
+  }
+  if (output_mask[2]) {
+    dbeta = at::zeros({C}, X.options());
+  }
+  if (N > 0) {
+    group_norm_backward_stub(kCPU, grad_out.contiguous(), X, mean, rstd, weight, N, C, HxW, group, dX, dgamma, dbeta);
+  }
+  return std::make_tuple(dX, dgamma, dbeta);
 }
 
 }} // at::native
@@ -0,0 +1,205 @@
+#include "ATen/ATen.h"
+#include "ATen/MemoryFormat.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/native/PoolingCPU.h"
+
+#include <cmath>
+#include <tuple>
+#include <vector>
+
+// 2d max and average pooling on CPU, replacing SpatialDilatedMaxPooling and
+// SpatialAveragePooling in THNN (which the CUDA versions still use, through
+// the thnn_ functions). The output sizes, indices and divisors are the same as
+// in THNN. Channels-last inputs are pooled without a copy and give
+// channels-last outputs, see Note [Channels last].
+
+namespace at { namespace native {
+
+DEFINE_DISPATCH(max_pool2d_stub);
+DEFINE_DISPATCH(max_pool2d_backward_stub);
+DEFINE_DISPATCH(avg_pool2d_stub);
+DEFINE_DISPATCH(avg_pool2d_backward_stub);
+
+namespace {
+
+void check_pool2d(
+    const char* name, const Tensor& input, IntList kernel_size, IntList stride,
+    IntList padding, IntList dilation) {
+  AT_CHECK(kernel_size.size() == 2 && stride.size() == 2 && padding.size() == 2 && dilation.size() == 2,
+           name, ": expected kernel_size, stride, padding and dilation of 2 elements");
+  AT_CHECK(kernel_size[0] > 0 && kernel_size[1] > 0,
+           name, ": kernel size should be greater than zero, but got ", kernel_size);
+  AT_CHECK(stride[0] > 0 && stride[1] > 0,
+           name, ": stride should be greater than zero, but got ", stride);
+  AT_CHECK(dilation[0] > 0 && dilation[1] > 0,
+           name, ": dilation should be greater than zero, but got ", dilation);
+  AT_CHECK(kernel_size[0] / 2 >= padding[0] && kernel_size[1] / 2 >= padding[1],
+           name, ": pad should be smaller than half of kernel size, but got padding ", padding,
+           " and kernel size ", kernel_size);
+  AT_CHECK(input.numel() > 0 && (input.dim() == 3 || input.dim() == 4),
+           name, ": non-empty 3D or 4D input tensor expected but got sizes ", input.sizes());
+}
+
+// Like THNN, drops a last window that would start in the padding when either
+// padding is nonzero, which ceil_mode can give.
+std::vector<int64_t> pool2d_output_size(
+    const char* name, const Tensor& input, IntList kernel_size, IntList stride,
+    IntList padding, IntList dilation, bool ceil_mode) {
+  auto sizes = input.sizes().vec();
+  const int64_t dim = input.dim() - 2;
+  for (int64_t i = 0; i < 2; i++) {
+    const int64_t in = input.size(dim + i);
+    const float extent = in - (dilation[i] * (kernel_size[i] - 1) + 1) + 2 * padding[i];
+    int64_t out = static_cast<int64_t>(
+        ceil_mode ? std::ceil(extent / stride[i]) : std::floor(extent / stride[i])) + 1;
+    if ((padding[0] != 0 || padding[1] != 0) && (out - 1) * stride[i] >= in + padding[i]) {
+      out--;
+    }
+    sizes[dim + i] = out;
+  }
+  AT_CHECK(sizes[dim] >= 1 && sizes[dim + 1] >= 1,
+           name, ": given input size ", input.sizes(), ", the calculated output size ",
+           IntList(sizes), " is too small");
+  return sizes;
+}
+
+bool is_channels_last_input(const Tensor& t) {
+  return suggest_memory_format(t.sizes(), t.strides()) == MemoryFormat::ChannelsLast;
+}
+
+Tensor empty_in_format(const Type& type, IntList sizes, bool channels_last) {
+  if (channels_last) {
+    return type.tensor(sizes, get_channels_last_strides(sizes));
+  }
+  return type.tensor(sizes);
+}
+
+Tensor to_format(const Tensor& t, bool channels_last) {
+  return channels_last ? t.to_channels_last() : t.contiguous();
+}
+
+// The kernels take (N, C, H, W) tensors; a (C, H, W) tensor is a batch of one.
+Tensor batchify(const Tensor& t) {
+  return t.dim() == 3 ? t.unsqueeze(0) : t;
+}
+
+void check_grad_output(const char* name, const Tensor& grad_output, IntList sizes) {
+  AT_CHECK(grad_output.sizes().equals(sizes),
+           name, ": expected grad_output of size ", sizes, ", but got ", grad_output.sizes());
+}
+
+} // anonymous namespace
+
+std::tuple<Tensor&, Tensor&> max_pool2d_with_indices_out_cpu(
+    Tensor& output, Tensor& indices, const Tensor& self, IntList kernel_size,
+    IntList stride, IntList padding, IntList dilation, bool ceil_mode) {
+  if (stride.empty()) {
+    stride = kernel_size;
+  }
+  check_pool2d("max_pool2d_with_indices", self, kernel_size, stride, padding, dilation);
+  auto sizes = pool2d_output_size(
+      "max_pool2d_with_indices", self, kernel_size, stride, padding, dilation, ceil_mode);
+  output.resize_(sizes);
+  indices.resize_(sizes);
+  AT_CHECK(output.is_contiguous() && indices.is_contiguous(),
+           "max_pool2d_with_indices: output and indices must be contiguous");
+  auto output_ = batchify(output);
+  auto indices_ = batchify(indices);
+  max_pool2d_stub(kCPU, output_, indices_, batchify(self.contiguous()),
+                  kernel_size, stride, padding, dilation);
+  return std::forward_as_tuple(output, indices);
+}
+
+std::tuple<Tensor, Tensor> max_pool2d_with_indices_cpu(
+    const Tensor& self, IntList kernel_size, IntList stride, IntList padding,
+    IntList dilation, bool ceil_mode) {
+  if (stride.empty()) {
+    stride = kernel_size;
+  }
+  check_pool2d("max_pool2d_with_indices", self, kernel_size, stride, padding, dilation);
+  auto sizes = pool2d_output_size(
+      "max_pool2d_with_indices", self, kernel_size, stride, padding, dilation, ceil_mode);
+  const bool channels_last = is_channels_last_input(self);
+  auto output = empty_in_format(self.type(), sizes, channels_last);
+  auto indices = empty_in_format(self.type().toScalarType(kLong), sizes, channels_last);
+  auto output_ = batchify(output);
+  auto indices_ = batchify(indices);
+  max_pool2d_stub(kCPU, output_, indices_, batchify(to_format(self, channels_last)),
+                  kernel_size, stride, padding, dilation);
+  return std::make_tuple(output, indices);
+}
+
+Tensor max_pool2d_with_indices_backward_cpu(
+    const Tensor& grad_output, const Tensor& self, IntList kernel_size,
+    IntList stride, IntList padding, IntList dilation, bool ceil_mode,
+    const Tensor& indices) {
+  if (stride.empty()) {
+    stride = kernel_size;
+  }
+  check_pool2d("max_pool2d_with_indices_backward", self, kernel_size, stride, padding, dilation);
+  auto sizes = pool2d_output_size(
+      "max_pool2d_with_indices_backward", self, kernel_size, stride, padding, dilation, ceil_mode);
+  check_grad_output("max_pool2d_with_indices_backward", grad_output, sizes);
+  AT_CHECK(indices.sizes().equals(sizes),
+           "max_pool2d_with_indices_backward: expected indices of size ", IntList(sizes),
+           ", but got ", indices.sizes());
+  const bool channels_last = is_channels_last_input(self);
+  auto grad_input = empty_in_format(self.type(), self.sizes(), channels_last);
+  auto grad_input_ = batchify(grad_input);
+  max_pool2d_backward_stub(
+      kCPU, grad_input_, batchify(to_format(grad_output, channels_last)),
+      batchify(to_format(indices, channels_last)), kernel_size, stride, padding, dilation);
+  return grad_input;
+}
+
+Tensor& avg_pool2d_out_cpu(
+    Tensor& output, const Tensor& self, IntList kernel_size, IntList stride,
+    IntList padding, bool ceil_mode, bool count_include_pad) {
+  if (stride.empty()) {
+    stride = kernel_size;
+  }
+  check_pool2d("avg_pool2d", self, kernel_size, stride, padding, {1, 1});
+  auto sizes = pool2d_output_size("avg_pool2d", self, kernel_size, stride, padding, {1, 1}, ceil_mode);
+  output.resize_(sizes);
+  AT_CHECK(output.is_contiguous(), "avg_pool2d: output must be contiguous");
+  auto output_ = batchify(output);
+  avg_pool2d_stub(kCPU, output_, batchify(self.contiguous()),
+                  kernel_size, stride, padding, count_include_pad);
+  return output;
+}
+
+Tensor avg_pool2d_cpu(
+    const Tensor& self, IntList kernel_size, IntList stride, IntList padding,
+    bool ceil_mode, bool count_include_pad) {
+  if (stride.empty()) {
+    stride = kernel_size;
+  }
+  check_pool2d("avg_pool2d", self, kernel_size, stride, padding, {1, 1});
+  auto sizes = pool2d_output_size("avg_pool2d", self, kernel_size, stride, padding, {1, 1}, ceil_mode);
+  const bool channels_last = is_channels_last_input(self);
+  auto output = empty_in_format(self.type(), sizes, channels_last);
+  auto output_ = batchify(output);
+  avg_pool2d_stub(kCPU, output_, batchify(to_format(self, channels_last)),
+                  kernel_size, stride, padding, count_include_pad);
+  return output;
+}
+
+Tensor avg_pool2d_backward_cpu(
+    const Tensor& grad_output, const Tensor& self, IntList kernel_size,
+    IntList stride, IntList padding, bool ceil_mode, bool count_include_pad) {
+  if (stride.empty()) {
+    stride = kernel_size;
+  }
+  check_pool2d("avg_pool2d_backward", self, kernel_size, stride, padding, {1, 1});
+  auto sizes = pool2d_output_size(
+      "avg_pool2d_backward", self, kernel_size, stride, padding, {1, 1}, ceil_mode);
+  check_grad_output("avg_pool2d_backward", grad_output, sizes);
+  const bool channels_last = is_channels_last_input(self);
+  auto grad_input = empty_in_format(self.type(), self.sizes(), channels_last);
+  auto grad_input_ = batchify(grad_input);
+  avg_pool2d_backward_stub(kCPU, grad_input_, batchify(to_format(grad_output, channels_last)),
+                           kernel_size, stride, padding, count_include_pad);
+  return grad_input;
+}
+
+}} // namespace at::native
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// Kernels for 4-d (N, C, H, W) tensors that are either all contiguous or all
+// channels last (see Note [Channels last]); the layout is taken from the
+// input of the forward and from grad_input of the backward. The output and
+// grad_input are already allocated with the right sizes.
+
+// indices hold the offset h * W + w of the maximum within its input plane,
+// like the THNN kernels. NaN is propagated.
+using max_pool2d_fn = void(*)(
+    Tensor& output, Tensor& indices, const Tensor& input,
+    IntList kernel_size, IntList stride, IntList padding, IntList dilation);
+using max_pool2d_backward_fn = void(*)(
+    Tensor& grad_input, const Tensor& grad_output, const Tensor& indices,
+    IntList kernel_size, IntList stride, IntList padding, IntList dilation);
+
+using avg_pool2d_fn = void(*)(
+    Tensor& output, const Tensor& input,
+    IntList kernel_size, IntList stride, IntList padding, bool count_include_pad);
+using avg_pool2d_backward_fn = void(*)(
+    Tensor& grad_input, const Tensor& grad_output,
+    IntList kernel_size, IntList stride, IntList padding, bool count_include_pad);
+
+DECLARE_DISPATCH(max_pool2d_fn, max_pool2d_stub);
+DECLARE_DISPATCH(max_pool2d_backward_fn, max_pool2d_backward_stub);
+DECLARE_DISPATCH(avg_pool2d_fn, avg_pool2d_stub);
+DECLARE_DISPATCH(avg_pool2d_backward_fn, avg_pool2d_backward_stub);
+
+}} // namespace at::native
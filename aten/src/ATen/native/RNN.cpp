@@ -2,6 +2,7 @@
 
 #include "ATen/ATen.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/TensorUtils.h"
 
 namespace at { namespace native {
 
@@ -38,6 +39,13 @@ struct CellParams {
   CellParams(const Tensor& _w_ih, const Tensor& _w_hh, const Tensor& _b_ih, const Tensor& _b_hh)
     : w_ih(_w_ih), w_hh(_w_hh), b_ih(_b_ih), b_hh(_b_hh) {};
 
+  // The input-to-hidden GEMM of a cell doesn't depend on the hidden state, so
+  // layers do it for all timesteps at once and pass the result to the cell
+  // with pre_compute_input set (the bias is still added by the cell).
+  Tensor matmul_ih(const Tensor& input) const {
+    return at::matmul(input, w_ih.t());
+  }
+
   const Tensor& w_ih;
   const Tensor& w_hh;
   const Tensor& b_ih; /* optional */
@@ -147,35 +155,53 @@ Tensor linear(const Tensor& input, const Tensor& weight, /* optional */ const Te
   return output;
 }
 
+// If pre_compute_input is set, input is already params.matmul_ih(input).
+Tensor linear_ih(const Tensor& input, const CellParams& params, bool pre_compute_input) {
+  if (!pre_compute_input) {
+    return linear(input, params.w_ih, params.b_ih);
+  }
+  return params.b_ih.defined() ? input + params.b_ih : input;
+}
+
+// The fused cell kernels exist for all floating types on CUDA, and for
+// float and double on CPU.
+bool use_fused_cell(const Tensor& input) {
+  auto scalar_type = input.type().scalarType();
+  return input.is_cuda() || scalar_type == kFloat || scalar_type == kDouble;
+}
+
 template<typename hidden_type_tmpl>
 struct Cell {
   using hidden_type = hidden_type_tmpl;
   virtual ~Cell() {} // This is really dumb, but enables projects with -Wnon-virtual-dtor to compile...
-  virtual hidden_type operator()(const Tensor& input, const hidden_type& hidden, const CellParams& params) const = 0;
+  virtual hidden_type operator()(const Tensor& input, const hidden_type& hidden, const CellParams& params,
+                                 bool pre_compute_input = false) const = 0;
 };
 
 template<typename nonlinearity>
 struct SimpleCell : Cell<Tensor> {
-  hidden_type operator()(const Tensor& input, const hidden_type& hidden, const CellParams& params) const override {
-    return nonlinearity{}(linear(input, params.w_ih, params.b_ih) + linear(hidden, params.w_hh, params.b_hh));
+  hidden_type operator()(const Tensor& input, const hidden_type& hidden, const CellParams& params,
+                         bool pre_compute_input = false) const override {
+    return nonlinearity{}(linear_ih(input, params, pre_compute_input) + linear(hidden, params.w_hh, params.b_hh));
   }
 };
 
 // TODO: can use inplace ops?
 struct LSTMCell : Cell<std::tuple<Tensor, Tensor>> {
-  hidden_type operator()(const Tensor& input, const hidden_type& hidden, const CellParams& params) const override {
+  hidden_type operator()(const Tensor& input, const hidden_type& hidden, const CellParams& params,
+                         bool pre_compute_input = false) const override {
     auto hx = std::get<0>(hidden);
     auto cx = std::get<1>(hidden);
 
-    if (input.is_cuda()) {
-      auto igates = at::matmul(input, params.w_ih.t());
+    if (use_fused_cell(input)) {
+      auto igates = pre_compute_input ? input : params.matmul_ih(input);
       auto hgates = at::matmul(hx, params.w_hh.t());
       auto result = at::_thnn_fused_lstm_cell(igates, hgates, cx, params.b_ih, params.b_hh);
       // Slice off the workspace argument (it's needed only for AD).
       return std::make_tuple(std::get<0>(result), std::get<1>(result));
     }
 
-    auto gates = linear(input, params.w_ih, params.b_ih) + linear(hx, params.w_hh, params.b_hh);
+    auto gates = linear_ih(input, params, pre_compute_input) + linear(hx, params.w_hh, params.b_hh);
     auto chunked_gates = gates.chunk(4, 1);
 
     auto ingate = chunked_gates[0].sigmoid();
@@ -191,16 +217,17 @@ struct LSTMCell : Cell<std::tuple<Tensor, Tensor>> {
 };
 
 struct GRUCell : Cell<Tensor> {
-  hidden_type operator()(const Tensor& input, const hidden_type& hidden, const CellParams& params) const override {
-    if (input.is_cuda()) {
-      auto igates = at::matmul(input, params.w_ih.t());
+  hidden_type operator()(const Tensor& input, const hidden_type& hidden, const CellParams& params,
+                         bool pre_compute_input = false) const override {
+    if (use_fused_cell(input)) {
+      auto igates = pre_compute_input ? input : params.matmul_ih(input);
       auto hgates = at::matmul(hidden, params.w_hh.t());
       auto result = at::_thnn_fused_gru_cell(igates, hgates, hidden, params.b_ih, params.b_hh);
       // Slice off the workspace argument (it's needed only for AD).
       return std::get<0>(result);
     }
 
-    auto igates = linear(input, params.w_ih, params.b_ih);
+    auto igates = linear_ih(input, params, pre_compute_input);
     auto hgates = linear(hidden, params.w_hh, params.b_hh);
     auto chunked_igates = igates.chunk(3, 1);
     auto chunked_hgates = hgates.chunk(3, 1);
@@ -245,18 +272,19 @@ struct FullLayer : Layer<Tensor, hidden_type, CellParams> {
   FullLayer(Cell<hidden_type>& cell)
     : cell_(cell) {};
 
-  unstacked_output_type operator()(std::vector<Tensor> step_inputs, const hidden_type& input_hidden, const CellParams& params) const {
+  unstacked_output_type operator()(std::vector<Tensor> step_inputs, const hidden_type& input_hidden, const CellParams& params,
+                                   bool pre_compute_input = false) const {
     std::vector<Tensor> step_outputs;
     auto hidden = input_hidden;
     for (size_t i = 0; i < step_inputs.size(); i++) {
-      hidden = cell_(step_inputs[i], hidden, params);
+      hidden = cell_(step_inputs[i], hidden, params, pre_compute_input);
       step_outputs.push_back(hidden_as_output(hidden));
     }
     return {step_outputs, hidden};
   }
 
   output_type operator()(const Tensor& inputs, const hidden_type& input_hidden, const CellParams& params) const override {
-    auto unstacked_output = (*this)(inputs.unbind(0), input_hidden, params);
+    auto unstacked_output = (*this)(params.matmul_ih(inputs).unbind(0), input_hidden, params, /*pre_compute_input=*/true);
     return {at::stack(unstacked_output.outputs, 0), unstacked_output.final_hidden};
   }
 
@@ -273,12 +301,12 @@ struct FullBidirectionalLayer : Layer<Tensor, pair_of<dir_hidden_type>, pair_of<
     : layer_(cell) {};
 
   output_type operator()(const Tensor& input, const hidden_type& input_hidden, const param_type& params) const override {
-    auto step_inputs = input.unbind(0);
-    auto fw_result = layer_(step_inputs, input_hidden.first, params.first);
+    auto fw_step_inputs = params.first.matmul_ih(input).unbind(0);
+    auto fw_result = layer_(fw_step_inputs, input_hidden.first, params.first, /*pre_compute_input=*/true);
     auto fw_output = at::stack(fw_result.outputs, 0);
 
-    auto rev_step_inputs = reverse(std::move(step_inputs));
-    auto rev_result = layer_(rev_step_inputs, input_hidden.second, params.second);
+    auto rev_step_inputs = reverse(params.second.matmul_ih(input).unbind(0));
+    auto rev_result = layer_(rev_step_inputs, input_hidden.second, params.second, /*pre_compute_input=*/true);
     std::reverse(rev_result.outputs.begin(), rev_result.outputs.end());
     auto rev_output = at::stack(rev_result.outputs, 0);
 
@@ -315,10 +343,11 @@ struct PackedLayer : Layer<PackedSequence, hidden_type, CellParams> {
     // which requires us to slice the hidden state (since some sequences
     // are completed now). The sliced parts are also saved, because we will need
     // to return a tensor of final hidden state.
+    auto input_gates = params.matmul_ih(input.data);
     auto hidden = input_hidden;
     for (int64_t i = 0; i < num_steps; ++i) {
       int64_t batch_size = batch_sizes[i];
-      auto step_input = input.data.narrow(0, input_offset, batch_size);
+      auto step_input = input_gates.narrow(0, input_offset, batch_size);
       input_offset += batch_size;
 
       int64_t dec = last_batch_size - batch_size;
@@ -328,7 +357,7 @@ struct PackedLayer : Layer<PackedSequence, hidden_type, CellParams> {
       }
 
       last_batch_size = batch_size;
-      hidden = cell_(step_input, hidden, params);
+      hidden = cell_(step_input, hidden, params, /*pre_compute_input=*/true);
       step_outputs.push_back(hidden_as_output(hidden));
     }
     hiddens.push_back(hidden);
@@ -358,6 +387,7 @@ struct ReversedPackedLayer : Layer<PackedSequence, hidden_type, CellParams> {
     // the smallest batch size (and a small set of hidden states we actually use),
     // and progressively expand the hidden states, as we move backwards over the
     // 1D list of inputs.
+    auto input_gates = params.matmul_ih(input.data);
     auto hidden = hidden_slice(input_hidden, 0, batch_sizes[num_steps - 1]);
     for (int64_t i = num_steps - 1; i >= 0; --i) {
       int64_t batch_size = batch_sizes[i];
@@ -366,11 +396,11 @@ struct ReversedPackedLayer : Layer<PackedSequence, hidden_type, CellParams> {
         hidden = hidden_concat(ArrayRef<hidden_type>{hidden, hidden_slice(input_hidden, last_batch_size, batch_size)});
       }
 
-      auto step_input = input.data.narrow(0, input_offset - batch_size, batch_size);
+      auto step_input = input_gates.narrow(0, input_offset - batch_size, batch_size);
       input_offset -= batch_size;
 
       last_batch_size = batch_size;
-      hidden = cell_(step_input, hidden, params);
+      hidden = cell_(step_input, hidden, params, /*pre_compute_input=*/true);
       step_outputs.push_back(hidden_as_output(hidden));
     }
     std::reverse(step_outputs.begin(), step_outputs.end());
@@ -625,4 +655,126 @@ Tensor rnn_relu_cell(
   return SimpleCell<relu_f>{}(input, hx, CellParams{w_ih, w_hh, b_ih, b_hh});
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// FUSED CELLS (CPU)
+//
+// CPU counterparts of the fused cells in cuda/RNN.cu, with the same workspace
+// layouts. The pointwise work is done by the kernels in cpu/RNNKernel.cpp.
+////////////////////////////////////////////////////////////////////////////////
+
+DEFINE_DISPATCH(lstm_cell_stub);
+DEFINE_DISPATCH(lstm_cell_backward_stub);
+DEFINE_DISPATCH(gru_cell_stub);
+DEFINE_DISPATCH(gru_cell_backward_stub);
+
+static constexpr int64_t GRU_WORKSPACE_MULTIPLIER = 5;
+
+// Factor will be 3 for GRU and 4 for LSTM
+static void checkFusedCellSizes(CheckedFrom c,
+                                const TensorArg& input_gates, const TensorArg& hidden_gates,
+                                const TensorArg& input_bias, const TensorArg& hidden_bias,
+                                int64_t factor, const TensorArg& prev_hidden) {
+  checkDim(c, input_gates, 2);
+  checkSameSize(c, input_gates, hidden_gates);
+  int64_t gates_size = input_gates->size(1);
+
+  if (input_bias->defined()) {
+    checkDim(c, input_bias, 1);
+    checkNumel(c, input_bias, gates_size);
+    checkSameSize(c, input_bias, hidden_bias);
+  }
+
+  checkDim(c, prev_hidden, 2);
+  checkNumel(c, prev_hidden, input_gates->size(0) * gates_size / factor);
+}
+
+static Tensor contiguous_if_defined(const Tensor& t) {
+  return t.defined() ? t.contiguous() : t;
+}
+
+std::tuple<Tensor, Tensor, Tensor> _thnn_fused_lstm_cell_cpu(
+      const Tensor& input_gates, const Tensor& hidden_gates,
+      const Tensor& cx,
+      const Tensor& input_bias, const Tensor& hidden_bias) {
+  checkFusedCellSizes("_thnn_fused_lstm_cell_cpu",
+                      {input_gates, "input_gates", 1}, {hidden_gates, "hidden_gates", 2},
+                      {input_bias, "input_bias", 3}, {hidden_bias, "hidden_bias", 4},
+                      /*factor=*/4, {cx, "prev_hidden", 5});
+
+  auto workspace = at::empty_like(input_gates);
+  auto hy = at::empty_like(cx);
+  auto cy = at::empty_like(cx);
+  lstm_cell_stub(kCPU, input_gates.contiguous(), hidden_gates.contiguous(),
+                 contiguous_if_defined(input_bias), contiguous_if_defined(hidden_bias),
+                 cx.contiguous(), hy, cy, workspace);
+  return std::make_tuple(hy, cy, workspace);
+}
+
+std::tuple<Tensor, Tensor, Tensor, Tensor, Tensor> _thnn_fused_lstm_cell_backward_cpu(
+      const Tensor& grad_hy, const Tensor& grad_cy,
+      const Tensor& cx, const Tensor& cy,
+      const Tensor& workspace, bool has_bias) {
+  CheckedFrom c = "_thnn_fused_lstm_cell_backward_cpu";
+  TensorArg grad_hy_arg{grad_hy, "grad_hy", 1}, grad_cy_arg{grad_cy, "grad_cy", 2},
+            cx_arg{cx, "cx", 3}, cy_arg{cy, "cy", 4}, workspace_arg{workspace, "workspace", 5};
+  checkDim(c, cx_arg, 2);
+  if (grad_hy.defined()) {
+    checkSize(c, grad_hy_arg, cx.sizes());
+  }
+  if (grad_cy.defined()) {
+    checkSize(c, grad_cy_arg, cx.sizes());
+  }
+  checkSize(c, cy_arg, cx.sizes());
+  checkSize(c, workspace_arg, {cx.size(0), cx.size(1) * 4});
+
+  auto grad_gates = at::empty_like(workspace);
+  auto grad_cx = at::empty_like(cx);
+  lstm_cell_backward_stub(kCPU, contiguous_if_defined(grad_hy), contiguous_if_defined(grad_cy),
+                          cx.contiguous(), cy.contiguous(), workspace.contiguous(),
+                          grad_gates, grad_cx);
+
+  auto grad_bias = has_bias ? grad_gates.sum(0, /*keepdim=*/false) : at::Tensor{};
+  return std::make_tuple(grad_gates, grad_gates, grad_cx, grad_bias, grad_bias);
+}
+
+std::tuple<Tensor, Tensor> _thnn_fused_gru_cell_cpu(
+      const Tensor& input_gates, const Tensor& hidden_gates,
+      const Tensor& hx,
+      const Tensor& input_bias, const Tensor& hidden_bias) {
+  checkFusedCellSizes("_thnn_fused_gru_cell_cpu",
+                      {input_gates, "input_gates", 1}, {hidden_gates, "hidden_gates", 2},
+                      {input_bias, "input_bias", 3}, {hidden_bias, "hidden_bias", 4},
+                      /*factor=*/3, {hx, "prev_hidden", 5});
+
+  auto workspace = at::empty({hx.size(0), hx.size(1) * GRU_WORKSPACE_MULTIPLIER}, hx.options());
+  auto hy = at::empty_like(hx);
+  gru_cell_stub(kCPU, input_gates.contiguous(), hidden_gates.contiguous(),
+                contiguous_if_defined(input_bias), contiguous_if_defined(hidden_bias),
+                hx.contiguous(), hy, workspace);
+  return std::make_tuple(hy, workspace);
+}
+
+std::tuple<Tensor, Tensor, Tensor, Tensor, Tensor> _thnn_fused_gru_cell_backward_cpu(
+      const Tensor& grad_hy, const Tensor& workspace, bool has_bias) {
+  CheckedFrom c = "_thnn_fused_gru_cell_backward_cpu";
+  TensorArg grad_hy_arg{grad_hy, "grad_hy", 1}, workspace_arg{workspace, "workspace", 2};
+  checkDim(c, grad_hy_arg, 2);
+  checkSize(c, workspace_arg, {grad_hy.size(0), grad_hy.size(1) * GRU_WORKSPACE_MULTIPLIER});
+
+  int64_t hidden_size = workspace.size(1) / GRU_WORKSPACE_MULTIPLIER;
+  auto grad_input_gates = at::empty({workspace.size(0), hidden_size * 3}, workspace.options());
+  auto grad_hidden_gates = at::empty({workspace.size(0), hidden_size * 3}, workspace.options());
+  auto grad_hx = at::empty_like(grad_hy);
+  gru_cell_backward_stub(kCPU, grad_hy.contiguous(), workspace.contiguous(),
+                         grad_input_gates, grad_hidden_gates, grad_hx);
+
+  at::Tensor grad_input_bias, grad_hidden_bias;
+  if (has_bias) {
+    grad_input_bias = grad_input_gates.sum(0, /*keepdim=*/false);
+    grad_hidden_bias = grad_hidden_gates.sum(0, /*keepdim=*/false);
+  }
+
+  return std::make_tuple(grad_input_gates, grad_hidden_gates, grad_hx, grad_input_bias, grad_hidden_bias);
+}
+
 }}  // namespace at::native
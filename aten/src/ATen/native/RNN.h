@@ -10,6 +10,23 @@ using rnn_fn = void(*)(Tensor&, Tensor&, const Tensor&, const Tensor&, TensorLis
 using lstm_packed_fn = void(*)(Tensor&, Tensor&, Tensor&, const Tensor&, const Tensor&, TensorList, TensorList, bool, int64_t, double, bool, bool);
 using rnn_packed_fn = void(*)(Tensor&, Tensor&, const Tensor&, const Tensor&, const Tensor&, TensorList, bool, int64_t, double, bool, bool);
 
+// Pointwise parts of the fused LSTM and GRU cells (_thnn_fused_lstm_cell and
+// _thnn_fused_gru_cell) on CPU; all tensors are contiguous, the biases may be
+// undefined. The workspaces have the layout of the CUDA kernels in
+// cuda/RNN.cu.
+using lstm_cell_fn = void(*)(
+    const Tensor& input_gates, const Tensor& hidden_gates, const Tensor& input_bias,
+    const Tensor& hidden_bias, const Tensor& cx, Tensor& hy, Tensor& cy, Tensor& workspace);
+using lstm_cell_backward_fn = void(*)(
+    const Tensor& grad_hy, const Tensor& grad_cy, const Tensor& cx, const Tensor& cy,
+    const Tensor& workspace, Tensor& grad_gates, Tensor& grad_cx);
+using gru_cell_fn = void(*)(
+    const Tensor& input_gates, const Tensor& hidden_gates, const Tensor& input_bias,
+    const Tensor& hidden_bias, const Tensor& hx, Tensor& hy, Tensor& workspace);
+using gru_cell_backward_fn = void(*)(
+    const Tensor& grad_hy, const Tensor& workspace, Tensor& grad_input_gates,
+    Tensor& grad_hidden_gates, Tensor& grad_hx);
+
 DECLARE_DISPATCH(lstm_fn, lstm_cudnn_stub);
 DECLARE_DISPATCH(rnn_fn, gru_cudnn_stub);
 DECLARE_DISPATCH(rnn_fn, rnn_tanh_cudnn_stub);
@@ -19,5 +36,10 @@ DECLARE_DISPATCH(rnn_packed_fn, gru_packed_cudnn_stub);
 DECLARE_DISPATCH(rnn_packed_fn, rnn_tanh_packed_cudnn_stub);
 DECLARE_DISPATCH(rnn_packed_fn, rnn_relu_packed_cudnn_stub);
 
+DECLARE_DISPATCH(lstm_cell_fn, lstm_cell_stub);
+DECLARE_DISPATCH(lstm_cell_backward_fn, lstm_cell_backward_stub);
+DECLARE_DISPATCH(gru_cell_fn, gru_cell_stub);
+DECLARE_DISPATCH(gru_cell_backward_fn, gru_cell_backward_stub);
+
 }} // namespace at::native
 
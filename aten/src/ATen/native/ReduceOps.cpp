@@ -5,6 +5,7 @@
 #include "ATen/WrapDimUtils.h"
 #include "ATen/WrapDimUtilsMulti.h"
 #include "ReduceOpsUtils.h"
+#include "TensorIterator.h"
 #include "cpu/ReduceOpsKernel.h"
 
 #include <algorithm>
@@ -13,12 +14,17 @@
 #include <numeric>
 #include <vector>
 #include <map>
+#include <tuple>
 
 namespace at {
 namespace native {
 
 DEFINE_DISPATCH(sum_kernel);
 DEFINE_DISPATCH(prod_kernel);
+DEFINE_DISPATCH(norm_kernel);
+DEFINE_DISPATCH(std_var_stub);
+DEFINE_DISPATCH(sum_iter_stub);
+DEFINE_DISPATCH(prod_iter_stub);
 
 static inline Tensor integer_upcast(const Tensor& self, optional<ScalarType> dtype) {
   ScalarType scalarType = self.type().scalarType();
@@ -596,9 +602,16 @@ Tensor &norm_out(Tensor &result, const Tensor &self, Scalar p, int64_t dim, bool
   dim = maybe_wrap_dim(dim, self.dim());
   if (_dimreduce_return_trivial(result, self, 0, dim, keepdim)) {
     return result;
-  } else {
-    return at::_th_norm_out(result, self, p, dim, keepdim);
   }
+  auto pvalue = p.toDouble();
+  if (self.type().backend() == Backend::CPU && (pvalue == 1 || pvalue == 2) &&
+      self.is_contiguous() && result.is_contiguous() && result.type() == self.type()) {
+    _dimreduce_setup(result, self, dim);
+    norm_kernel(kCPU, result, self, p, dim);
+    if (!keepdim) result.squeeze_(dim);
+    return result;
+  }
+  return at::_th_norm_out(result, self, p, dim, keepdim);
 }
 
 Tensor all(const Tensor& self, int64_t dim, bool keepdim) {
@@ -635,12 +648,46 @@ Tensor &any_out(Tensor &result, const Tensor &self, int64_t dim, bool keepdim) {
   }
 }
 
+// Computes the variance, or the standard deviation if `take_sqrt`, of a
+// tensor over all dimensions (if `dim` is nullopt) or over `dim`. CUDA
+// tensors that need 64-bit indexing go to the TH kernels.
+static Tensor& _std_var_out(Tensor& result, const Tensor& self, optional<int64_t> dim,
+                            bool unbiased, bool keepdim, bool take_sqrt) {
+  auto shape = self.sizes().vec();
+  if (dim.has_value()) {
+    shape[*dim] = 1;
+  } else {
+    std::fill(shape.begin(), shape.end(), 1);
+  }
+  result.resize_(shape);
+  auto iter = TensorIterator::reduce_op(result, self);
+  if (self.is_cuda() && !iter->can_use_32bit_indexing()) {
+    if (!dim.has_value()) {
+      result.resize_({});
+      return result.copy_(take_sqrt ? at::_th_std(self, unbiased) : at::_th_var(self, unbiased));
+    }
+    return take_sqrt ? at::_th_std_out(result, self, *dim, unbiased, keepdim)
+                     : at::_th_var_out(result, self, *dim, unbiased, keepdim);
+  }
+  std_var_stub(self.type().device_type(), *iter, unbiased, take_sqrt);
+  if (!dim.has_value()) {
+    result.resize_({});
+  } else if (!keepdim) {
+    result.squeeze_(*dim);
+  }
+  return result;
+}
+
 Tensor var(const Tensor& self, bool unbiased) {
   AT_CHECK(self.type().backend() == Backend::CPU || self.type().backend() == Backend::CUDA,
            "var only supports CPU AND CUDA backend, got: ", at::toString(self.type().backend()));
   AT_CHECK(at::isFloatingType(self.type().scalarType()), "var only supports floating-point dtypes");
   auto trivial_return = _allreduce_return_trivial(self, std::numeric_limits<double>::quiet_NaN());
-  return trivial_return.has_value() ? trivial_return.value() : at::_th_var(self, unbiased);
+  if (trivial_return.has_value()) {
+    return trivial_return.value();
+  }
+  Tensor result = self.type().tensor();
+  return _std_var_out(result, self, nullopt, unbiased, false, false);
 }
 
 Tensor var(const Tensor& self, int64_t dim, bool unbiased, bool keepdim) {
@@ -656,7 +703,7 @@ Tensor &var_out(Tensor &result, const Tensor &self, int64_t dim, bool unbiased,
   if (_dimreduce_return_trivial(result, self, std::numeric_limits<double>::quiet_NaN(), dim, keepdim)) {
     return result;
   } else {
-    return at::_th_var_out(result, self, dim, unbiased, keepdim);
+    return _std_var_out(result, self, dim, unbiased, keepdim, false);
   }
 }
 
@@ -665,7 +712,11 @@ Tensor std(const Tensor& self, bool unbiased) {
            "std only supports CPU AND CUDA backend, got: ", at::toString(self.type().backend()));
   AT_CHECK(at::isFloatingType(self.type().scalarType()), "std only supports floating-point dtypes");
   auto trivial_return = _allreduce_return_trivial(self, std::numeric_limits<double>::quiet_NaN());
-  return trivial_return.has_value() ? trivial_return.value() : at::_th_std(self, unbiased);
+  if (trivial_return.has_value()) {
+    return trivial_return.value();
+  }
+  Tensor result = self.type().tensor();
+  return _std_var_out(result, self, nullopt, unbiased, false, true);
 }
 
 Tensor std(const Tensor& self, int64_t dim, bool unbiased, bool keepdim) {
@@ -681,8 +732,73 @@ Tensor &std_out(Tensor &result, const Tensor &self, int64_t dim, bool unbiased,
   if (_dimreduce_return_trivial(result, self, std::numeric_limits<double>::quiet_NaN(), dim, keepdim)) {
     return result;
   } else {
-    return at::_th_std_out(result, self, dim, unbiased, keepdim);
+    return _std_var_out(result, self, dim, unbiased, keepdim, true);
+  }
+}
+
+// Computes the variance, or the standard deviation if `take_sqrt`, and the
+// mean of a tensor in a single pass. CUDA tensors that need 64-bit indexing
+// fall back to separate TH reductions.
+static std::tuple<Tensor, Tensor> _std_var_mean(const Tensor& self, optional<int64_t> dim,
+                                                bool unbiased, bool keepdim, bool take_sqrt,
+                                                const char* fname) {
+  AT_CHECK(self.type().backend() == Backend::CPU || self.type().backend() == Backend::CUDA,
+           fname, " only supports CPU AND CUDA backend, got: ", at::toString(self.type().backend()));
+  AT_CHECK(at::isFloatingType(self.type().scalarType()), fname, " only supports floating-point dtypes");
+  Tensor result = self.type().tensor();
+  Tensor mean = self.type().tensor();
+  auto shape = self.sizes().vec();
+  if (dim.has_value()) {
+    dim = maybe_wrap_dim(*dim, self.dim());
+    if (self.dim() > 0) {
+      shape[*dim] = 1;
+    }
+  } else {
+    std::fill(shape.begin(), shape.end(), 1);
+  }
+  result.resize_(shape);
+  mean.resize_(shape);
+  if (self.numel() == 0) {
+    result.fill_(std::numeric_limits<double>::quiet_NaN());
+    mean.fill_(std::numeric_limits<double>::quiet_NaN());
+  } else {
+    auto iter = TensorIterator::reduce_op(result, mean, self);
+    if (self.is_cuda() && !iter->can_use_32bit_indexing()) {
+      if (dim.has_value()) {
+        result.copy_(take_sqrt ? self.std(*dim, unbiased, true) : self.var(*dim, unbiased, true));
+        mean.copy_(self.mean(*dim, true));
+      } else {
+        result.copy_(take_sqrt ? self.std(unbiased) : self.var(unbiased));
+        mean.copy_(self.mean());
+      }
+    } else {
+      std_var_stub(self.type().device_type(), *iter, unbiased, take_sqrt);
+    }
   }
+  if (!dim.has_value()) {
+    result.resize_({});
+    mean.resize_({});
+  } else if (!keepdim && self.dim() > 0) {
+    result.squeeze_(*dim);
+    mean.squeeze_(*dim);
+  }
+  return std::make_tuple(result, mean);
+}
+
+std::tuple<Tensor, Tensor> var_mean(const Tensor& self, bool unbiased) {
+  return _std_var_mean(self, nullopt, unbiased, false, false, "var_mean");
+}
+
+std::tuple<Tensor, Tensor> var_mean(const Tensor& self, int64_t dim, bool unbiased, bool keepdim) {
+  return _std_var_mean(self, dim, unbiased, keepdim, false, "var_mean");
+}
+
+std::tuple<Tensor, Tensor> std_mean(const Tensor& self, bool unbiased) {
+  return _std_var_mean(self, nullopt, unbiased, false, true, "std_mean");
+}
+
+std::tuple<Tensor, Tensor> std_mean(const Tensor& self, int64_t dim, bool unbiased, bool keepdim) {
+  return _std_var_mean(self, dim, unbiased, keepdim, true, "std_mean");
 }
 
 }} // namespace at::native
@@ -0,0 +1,189 @@
+// CPU sort and topk along a dimension.
+//
+// Both move the dimension to the end and make the input contiguous, so every
+// slice is a row, and then work on the rows in parallel. Sort radix sorts the
+// order-preserving integer encoding of each row (see SortingUtils.h), which is
+// stable and puts NaNs last. Topk selects the k smallest (or largest) keys
+// with a partial heap sort when k is small and a quickselect otherwise.
+
+#include "ATen/ATen.h"
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/WrapDimUtils.h"
+#include "ATen/native/SortingUtils.h"
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace at { namespace native {
+
+namespace {
+
+// Runs f(begin, end) over the rows, in parallel if there are enough of them.
+// A single row runs on the calling thread, so the radix sort can parallelize
+// within it instead.
+template <typename F>
+void for_each_row(int64_t rows, int64_t row_size, const F& f) {
+  if (rows == 1) {
+    f(0, 1);
+    return;
+  }
+  parallel_for(0, rows, divup(internal::GRAIN_SIZE, std::max<int64_t>(row_size, 1)), f);
+}
+
+// Whether results can be written straight into values and indices, which
+// holds when dim is already the last dimension and both are contiguous.
+bool can_write_directly(const Tensor& self, int64_t dim, const Tensor& values, const Tensor& indices) {
+  return dim == self.dim() - 1 && values.is_contiguous() && indices.is_contiguous();
+}
+
+template <typename scalar_t>
+void sort_rows(const Tensor& input, Tensor& values, Tensor& indices, bool descending) {
+  using key_t = typename RadixKey<scalar_t>::type;
+  const int64_t n = input.size(-1);
+  const int64_t rows = input.numel() / n;
+  const scalar_t* input_data = input.data<scalar_t>();
+  scalar_t* values_data = values.data<scalar_t>();
+  int64_t* indices_data = indices.data<int64_t>();
+  // sort_out(self, indices, self) sorts in place
+  const bool aliased = input_data == values_data;
+
+  for_each_row(rows, n, [&](int64_t begin, int64_t end) {
+    std::vector<key_t> keys(n);
+    std::vector<scalar_t> row_copy(aliased ? n : 0);
+    for (int64_t r = begin; r < end; r++) {
+      const scalar_t* row_in = input_data + r * n;
+      scalar_t* row_values = values_data + r * n;
+      int64_t* row_indices = indices_data + r * n;
+      for (int64_t i = 0; i < n; i++) {
+        key_t key = RadixKey<scalar_t>::encode(row_in[i]);
+        keys[i] = descending ? static_cast<key_t>(~key) : key;
+        row_indices[i] = i;
+      }
+      radix_sort_pairs(keys.data(), row_indices, n);
+      if (aliased) {
+        std::copy(row_in, row_in + n, row_copy.begin());
+        row_in = row_copy.data();
+      }
+      for (int64_t i = 0; i < n; i++) {
+        row_values[i] = row_in[row_indices[i]];
+      }
+    }
+  });
+}
+
+template <typename scalar_t>
+void topk_rows(const Tensor& input, Tensor& values, Tensor& indices, int64_t k, bool largest, bool sorted) {
+  using key_t = typename RadixKey<scalar_t>::type;
+  using entry_t = std::pair<key_t, int64_t>;
+  const int64_t n = input.size(-1);
+  const int64_t rows = input.numel() / n;
+  const scalar_t* input_data = input.data<scalar_t>();
+  scalar_t* values_data = values.data<scalar_t>();
+  int64_t* indices_data = indices.data<int64_t>();
+
+  for_each_row(rows, n, [&](int64_t begin, int64_t end) {
+    std::vector<entry_t> entries(n);
+    for (int64_t r = begin; r < end; r++) {
+      const scalar_t* row_in = input_data + r * n;
+      for (int64_t i = 0; i < n; i++) {
+        key_t key = RadixKey<scalar_t>::encode(row_in[i]);
+        entries[i] = {largest ? static_cast<key_t>(~key) : key, i};
+      }
+      // Ties are broken by index, so the result is deterministic.
+      if (sorted && k * 16 <= n) {
+        std::partial_sort(entries.begin(), entries.begin() + k, entries.end());
+      } else {
+        if (k < n) {
+          std::nth_element(entries.begin(), entries.begin() + k, entries.end());
+        }
+        if (sorted) {
+          std::sort(entries.begin(), entries.begin() + k);
+        }
+      }
+      scalar_t* row_values = values_data + r * k;
+      int64_t* row_indices = indices_data + r * k;
+      for (int64_t i = 0; i < k; i++) {
+        row_indices[i] = entries[i].second;
+        row_values[i] = row_in[entries[i].second];
+      }
+    }
+  });
+}
+
+} // anonymous namespace
+
+std::tuple<Tensor&, Tensor&> sort_out_cpu(Tensor& values, Tensor& indices,
+                                          const Tensor& self, int64_t dim, bool descending) {
+  if (self.dim() == 0) {
+    return at::_th_sort_out(values, indices, self, dim, descending);
+  }
+  dim = maybe_wrap_dim(dim, self.dim());
+  values.resize_(self.sizes());
+  indices.resize_(self.sizes());
+  if (self.numel() == 0) {
+    return std::forward_as_tuple(values, indices);
+  }
+
+  Tensor input = self.transpose(dim, -1).contiguous();
+  const bool direct = can_write_directly(self, dim, values, indices);
+  Tensor values_buf = direct ? values : at::empty(input.sizes(), values.options());
+  Tensor indices_buf = direct ? indices : at::empty(input.sizes(), indices.options());
+  AT_DISPATCH_ALL_TYPES(self.type(), "sort", [&] {
+    sort_rows<scalar_t>(input, values_buf, indices_buf, descending);
+  });
+  if (!direct) {
+    values.transpose(dim, -1).copy_(values_buf);
+    indices.transpose(dim, -1).copy_(indices_buf);
+  }
+  return std::forward_as_tuple(values, indices);
+}
+
+std::tuple<Tensor, Tensor> sort_cpu(const Tensor& self, int64_t dim, bool descending) {
+  Tensor values = at::empty({0}, self.options());
+  Tensor indices = at::empty({0}, self.options().dtype(kLong));
+  return at::native::sort_out_cpu(values, indices, self, dim, descending);
+}
+
+std::tuple<Tensor&, Tensor&> topk_out_cpu(Tensor& values, Tensor& indices,
+                                          const Tensor& self, int64_t k, int64_t dim,
+                                          bool largest, bool sorted) {
+  if (self.dim() == 0) {
+    return at::_th_topk_out(values, indices, self, k, dim, largest, sorted);
+  }
+  dim = maybe_wrap_dim(dim, self.dim());
+  AT_CHECK(k >= 0 && k <= self.size(dim), "selected index k out of range");
+  auto result_sizes = self.sizes().vec();
+  result_sizes[dim] = k;
+  values.resize_(result_sizes);
+  indices.resize_(result_sizes);
+  if (values.numel() == 0) {
+    return std::forward_as_tuple(values, indices);
+  }
+
+  Tensor input = self.transpose(dim, -1).contiguous();
+  auto buf_sizes = input.sizes().vec();
+  buf_sizes.back() = k;
+  const bool direct = can_write_directly(self, dim, values, indices);
+  Tensor values_buf = direct ? values : at::empty(buf_sizes, values.options());
+  Tensor indices_buf = direct ? indices : at::empty(buf_sizes, indices.options());
+  AT_DISPATCH_ALL_TYPES(self.type(), "topk", [&] {
+    topk_rows<scalar_t>(input, values_buf, indices_buf, k, largest, sorted);
+  });
+  if (!direct) {
+    values.transpose(dim, -1).copy_(values_buf);
+    indices.transpose(dim, -1).copy_(indices_buf);
+  }
+  return std::forward_as_tuple(values, indices);
+}
+
+std::tuple<Tensor, Tensor> topk_cpu(const Tensor& self, int64_t k, int64_t dim,
+                                    bool largest, bool sorted) {
+  Tensor values = at::empty({0}, self.options());
+  Tensor indices = at::empty({0}, self.options().dtype(kLong));
+  return at::native::topk_out_cpu(values, indices, self, k, dim, largest, sorted);
+}
+
+}} // namespace at::native
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "ATen/Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+namespace at { namespace native {
+
+// Maps values to unsigned integers that compare the same way, so they can be
+// radix sorted: the sign bit of signed integers is flipped, and floating
+// point values are flipped entirely if negative and have their sign bit set
+// otherwise. NaNs map to the largest key, so they sort last, like NumPy.
+template <typename scalar_t, typename Enable = void>
+struct RadixKey;
+
+template <typename scalar_t>
+struct RadixKey<scalar_t, typename std::enable_if<std::is_integral<scalar_t>::value>::type> {
+  using type = typename std::make_unsigned<scalar_t>::type;
+  static type encode(scalar_t value) {
+    constexpr type sign_bit = std::is_signed<scalar_t>::value
+        ? type(1) << (sizeof(type) * 8 - 1) : 0;
+    return static_cast<type>(value) ^ sign_bit;
+  }
+};
+
+template <typename scalar_t>
+struct RadixKey<scalar_t, typename std::enable_if<std::is_floating_point<scalar_t>::value>::type> {
+  using type = typename std::conditional<sizeof(scalar_t) == 4, uint32_t, uint64_t>::type;
+  static type encode(scalar_t value) {
+    constexpr type sign_bit = type(1) << (sizeof(type) * 8 - 1);
+    if (std::isnan(value)) {
+      return ~type(0);
+    }
+    type bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return (bits & sign_bit) ? ~bits : bits | sign_bit;
+  }
+};
+
+namespace detail {
+
+constexpr int kRadixBits = 8;
+constexpr int kRadixBuckets = 1 << kRadixBits;
+// Below this many elements a pass runs on one thread.
+constexpr int64_t kParallelRadixMinSize = 1 << 16;
+
+template <typename key_t>
+inline int radix_digit(key_t key, int shift) {
+  return static_cast<int>((key >> shift) & (kRadixBuckets - 1));
+}
+
+// One stable counting sort pass by the digit at shift, from (keys, values)
+// into (keys_out, values_out). The input is split into chunks that count and
+// scatter their elements in parallel. Returns false, without moving
+// anything, if all keys have the same digit.
+template <typename key_t>
+bool radix_pass(
+    const key_t* keys, const int64_t* values, key_t* keys_out,
+    int64_t* values_out, int64_t n, int shift) {
+  int64_t num_chunks = 1;
+  if (n >= kParallelRadixMinSize && !in_parallel_region()) {
+    num_chunks = std::min<int64_t>(get_num_threads(), n / (kParallelRadixMinSize / 4));
+  }
+  int64_t chunk_size = divup(n, num_chunks);
+  std::vector<int64_t> offsets(num_chunks * kRadixBuckets, 0);
+
+  // runs f over the chunks, without forking threads if there is only one
+  auto for_each_chunk = [&](const std::function<void(int64_t)>& f) {
+    if (num_chunks == 1) {
+      f(0);
+      return;
+    }
+    parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        f(c);
+      }
+    });
+  };
+
+  for_each_chunk([&](int64_t c) {
+    int64_t* counts = offsets.data() + c * kRadixBuckets;
+    for (int64_t i = c * chunk_size; i < std::min(n, (c + 1) * chunk_size); i++) {
+      counts[radix_digit(keys[i], shift)]++;
+    }
+  });
+
+  // Turn the counts into the position each chunk writes its first element
+  // with a given digit to: digits in order, and chunks in order per digit.
+  int64_t total = 0;
+  for (int d = 0; d < kRadixBuckets; d++) {
+    int64_t digit_total = 0;
+    for (int64_t c = 0; c < num_chunks; c++) {
+      int64_t count = offsets[c * kRadixBuckets + d];
+      offsets[c * kRadixBuckets + d] = total + digit_total;
+      digit_total += count;
+    }
+    if (digit_total == n) {
+      return false;
+    }
+    total += digit_total;
+  }
+
+  for_each_chunk([&](int64_t c) {
+    int64_t* positions = offsets.data() + c * kRadixBuckets;
+    for (int64_t i = c * chunk_size; i < std::min(n, (c + 1) * chunk_size); i++) {
+      int64_t pos = positions[radix_digit(keys[i], shift)]++;
+      keys_out[pos] = keys[i];
+      values_out[pos] = values[i];
+    }
+  });
+  return true;
+}
+
+} // namespace detail
+
+// Stably sorts keys in ascending order and permutes values along with them.
+// Passes over digits all keys share are skipped, so e.g. small integers
+// stored as int64 take one or two passes rather than eight.
+template <typename key_t>
+void radix_sort_pairs(key_t* keys, int64_t* values, int64_t n) {
+  static_assert(std::is_unsigned<key_t>::value, "radix sort keys must be unsigned");
+  if (n <= 64) {
+    // insertion sort is faster for tiny inputs, e.g. the rows of a sort
+    // along a short dimension
+    for (int64_t i = 1; i < n; i++) {
+      key_t key = keys[i];
+      int64_t value = values[i];
+      int64_t j = i;
+      for (; j > 0 && keys[j - 1] > key; j--) {
+        keys[j] = keys[j - 1];
+        values[j] = values[j - 1];
+      }
+      keys[j] = key;
+      values[j] = value;
+    }
+    return;
+  }
+  std::vector<key_t> keys_tmp(n);
+  std::vector<int64_t> values_tmp(n);
+  key_t* keys_in = keys;
+  int64_t* values_in = values;
+  key_t* keys_out = keys_tmp.data();
+  int64_t* values_out = values_tmp.data();
+  for (int shift = 0; shift < static_cast<int>(sizeof(key_t) * 8); shift += detail::kRadixBits) {
+    if (detail::radix_pass(keys_in, values_in, keys_out, values_out, n, shift)) {
+      std::swap(keys_in, keys_out);
+      std::swap(values_in, values_out);
+    }
+  }
+  if (keys_in != keys) {
+    std::copy(keys_in, keys_in + n, keys);
+    std::copy(values_in, values_in + n, values);
+  }
+}
+
+}} // namespace at::native
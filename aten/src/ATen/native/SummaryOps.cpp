@@ -2,7 +2,9 @@
 
 #include "ATen/ATen.h"
 #include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
 
+#include <algorithm>
 #include <tuple>
 
 namespace at { namespace native {
@@ -10,6 +12,36 @@ namespace at { namespace native {
 ///////////////// bincount /////////////////
 namespace {
 
+// Counts the values of self_p into nbins bins, adding get_op(i) for element i.
+// Every thread counts into a private histogram, and the histograms are summed
+// at the end, so threads never write to the same bins. When there are more
+// bins than elements per thread, zeroing and summing the private copies costs
+// more than it saves, and one thread counts everything.
+template <typename input_t, typename output_t, typename Op>
+Tensor _histogram_cpu(
+    const input_t* self_p,
+    int64_t numel,
+    int64_t nbins,
+    const TensorOptions& options,
+    const Op& get_op) {
+  const int64_t num_threads = get_num_threads();
+  int64_t grain_size = std::max(internal::GRAIN_SIZE, divup(numel, num_threads));
+  if (nbins * num_threads > numel) {
+    grain_size = numel;
+  }
+  auto count = [&](int64_t begin, int64_t end, const Tensor& ident) {
+    Tensor hist = native::zeros({nbins}, options);
+    output_t* hist_p = hist.data<output_t>();
+    for (int64_t i = begin; i < end; i++) {
+      hist_p[self_p[i]] += get_op(i);
+    }
+    return hist;
+  };
+  return parallel_reduce(
+      0, numel, grain_size, native::zeros({nbins}, options), count,
+      [](const Tensor& a, const Tensor& b) { return a + b; });
+}
+
 template <typename input_t, typename weights_t>
 Tensor _bincount_cpu_template(
     const Tensor& self,
@@ -30,26 +62,21 @@ Tensor _bincount_cpu_template(
     AT_ERROR("input and weights should have the same length");
   }
 
-  Tensor output;
   int64_t nbins = static_cast<int64_t>(*self.max().data<input_t>()) + 1L;
   nbins = std::max(nbins, minlength); // at least minlength # of bins
 
-  const input_t* self_p = self.contiguous().data<input_t>();
+  Tensor self_c = self.contiguous();
+  const input_t* self_p = self_c.data<input_t>();
   if (has_weights) {
-    output = native::zeros({nbins}, weights.options());
-    weights_t* output_p = output.data<weights_t>();
-    const weights_t* weights_p = weights.contiguous().data<weights_t>();
-    for (int64_t i = 0; i < self.size(0); i++) {
-      output_p[self_p[i]] += weights_p[i];
-    }
-  } else {
-    output = native::zeros({nbins}, kLong);
-    int64_t* output_p = output.data<int64_t>();
-    for (int64_t i = 0; i < self.size(0); i++) {
-      output_p[self_p[i]] += 1L;
-    }
+    Tensor weights_c = weights.contiguous();
+    const weights_t* weights_p = weights_c.data<weights_t>();
+    return _histogram_cpu<input_t, weights_t>(
+        self_p, self.size(0), nbins, weights.options(),
+        [weights_p](int64_t i) { return weights_p[i]; });
   }
-  return output;
+  return _histogram_cpu<input_t, int64_t>(
+      self_p, self.size(0), nbins, self.options().dtype(kLong),
+      [](int64_t i) { return 1L; });
 }
 } // namespace
 
@@ -1,37 +1,66 @@
 #include "ATen/ATen.h"
-#include "ATen/CPUApplyUtils.h"
 #include "ATen/Dispatch.h"
 #include "ATen/ExpandUtils.h"
 #include "ATen/NativeFunctions.h"
 #include "ATen/core/Error.h"
 #include "ReduceOpsUtils.h"
+#include "TensorIterator.h"
 #include "cpu/TensorCompareKernel.h"
 
-namespace {
-template <typename scalar_t>
-void where_cpu(
-    at::Tensor& ret,
-    const at::Tensor& condition,
-    const at::Tensor& self,
-    const at::Tensor& other) {
-  at::CPU_tensor_apply4<scalar_t, uint8_t, scalar_t, scalar_t>(
-      ret,
-      condition,
-      self,
-      other,
-      [](scalar_t& ret_val,
-         const uint8_t& cond_val,
-         const scalar_t& self_val,
-         const scalar_t& other_val) {
-        ret_val = cond_val ? self_val : other_val;
-      });
-}
-} // namespace
-
 namespace at { namespace native {
 
 DEFINE_DISPATCH(max_kernel);
 DEFINE_DISPATCH(min_kernel);
+DEFINE_DISPATCH(max_reduce_stub);
+DEFINE_DISPATCH(min_reduce_stub);
+DEFINE_DISPATCH(eq_stub);
+DEFINE_DISPATCH(ge_stub);
+DEFINE_DISPATCH(gt_stub);
+DEFINE_DISPATCH(le_stub);
+DEFINE_DISPATCH(lt_stub);
+DEFINE_DISPATCH(ne_stub);
+DEFINE_DISPATCH(where_stub);
+
+static Tensor scalar_tensor(Scalar scalar) {
+  auto tensor = scalar.toTensor();
+  tensor.get()->set_wrapped_number(true);
+  return tensor;
+}
+
+// The out-of-place comparisons return a Byte mask. The in-place variants
+// write the result into self, which keeps its type.
+#define IMPLEMENT_COMPARISON_OP(op)                                         \
+  Tensor op(const Tensor& self, const Tensor& other) {                     \
+    Tensor result = self.type().toScalarType(kByte).tensor();              \
+    return at::op##_out(result, self, other);                              \
+  }                                                                        \
+  Tensor op(const Tensor& self, Scalar other) {                            \
+    Tensor result = self.type().toScalarType(kByte).tensor();              \
+    return at::op##_out(result, self, other);                              \
+  }                                                                        \
+  Tensor& _##op##_out_cpu(Tensor& result, const Tensor& self, const Tensor& other) { \
+    auto iter = TensorIterator::comparison_op(result, self, other);        \
+    op##_stub(kCPU, *iter);                                                \
+    return result;                                                         \
+  }                                                                        \
+  Tensor& _##op##_out_cpu(Tensor& result, const Tensor& self, Scalar other) { \
+    return native::_##op##_out_cpu(result, self, scalar_tensor(other));    \
+  }                                                                        \
+  Tensor& _##op##__cpu(Tensor& self, const Tensor& other) {                \
+    auto iter = TensorIterator::binary_op(self, self, other);              \
+    op##_stub(kCPU, *iter);                                                \
+    return self;                                                           \
+  }                                                                        \
+  Tensor& _##op##__cpu(Tensor& self, Scalar other) {                       \
+    return native::_##op##__cpu(self, scalar_tensor(other));               \
+  }
+
+IMPLEMENT_COMPARISON_OP(eq)
+IMPLEMENT_COMPARISON_OP(ge)
+IMPLEMENT_COMPARISON_OP(gt)
+IMPLEMENT_COMPARISON_OP(le)
+IMPLEMENT_COMPARISON_OP(lt)
+IMPLEMENT_COMPARISON_OP(ne)
 
 bool allclose(const Tensor& self, const Tensor& other, double rtol, double atol, bool equal_nan) {
   return at::isclose(self, other, rtol, atol, equal_nan).all().toCByte();
@@ -83,10 +112,14 @@ Tensor where(const Tensor& condition, const Tensor& self, const Tensor& other) {
 }
 
 Tensor _s_where_cpu(const Tensor& condition, const Tensor& self, const Tensor& other) {
-  Tensor ret = self.type().tensor(self.sizes());
-  AT_DISPATCH_ALL_TYPES(ret.type(), "where", [&] {
-    where_cpu<scalar_t>(ret, condition, self, other);
-  });
+  Tensor ret;
+  auto iter = TensorIterator::Builder()
+      .add_output(ret)
+      .add_input(condition, ScalarType::Byte)
+      .add_input(self)
+      .add_input(other)
+      .build();
+  where_stub(kCPU, *iter);
   return ret;
 }
 
@@ -152,17 +185,19 @@ std::tuple<Tensor &,Tensor &> mode_out(Tensor& values, Tensor& indices,
 
 std::tuple<Tensor &,Tensor &> _max_out_cpu(Tensor& max, Tensor& max_indices,
                                         const Tensor& self, int64_t dim, bool keepdim) {
+  _dimreduce_setup(max, self, dim);
+  _dimreduce_setup(max_indices, self, dim);
   if (self.is_contiguous() && max.is_contiguous() && max_indices.is_contiguous()) {
-    _dimreduce_setup(max, self, dim);
-    _dimreduce_setup(max_indices, self, dim);
     max_kernel(kCPU, max, max_indices, self, dim);
-    if (!keepdim) {
-      max.squeeze_(dim);
-      max_indices.squeeze_(dim);
-    }
-    return std::tuple<Tensor &,Tensor &>{max, max_indices};
+  } else {
+    auto iter = TensorIterator::reduce_op(max, max_indices, self);
+    max_reduce_stub(kCPU, *iter);
+  }
+  if (!keepdim) {
+    max.squeeze_(dim);
+    max_indices.squeeze_(dim);
   }
-  return at::_th_max_out(max, max_indices, self, dim, keepdim);
+  return std::tuple<Tensor &,Tensor &>{max, max_indices};
 }
 
 std::tuple<Tensor, Tensor> max(const Tensor& self, int64_t dim, bool keepdim) {
@@ -195,17 +230,19 @@ Tensor max_values(const Tensor& self, int64_t dim, bool keepdim) {
 
 std::tuple<Tensor &,Tensor &> _min_out_cpu(Tensor& min, Tensor& min_indices,
                                         const Tensor& self, int64_t dim, bool keepdim) {
+  _dimreduce_setup(min, self, dim);
+  _dimreduce_setup(min_indices, self, dim);
   if (self.is_contiguous() && min.is_contiguous() && min_indices.is_contiguous()) {
-    _dimreduce_setup(min, self, dim);
-    _dimreduce_setup(min_indices, self, dim);
     min_kernel(kCPU, min, min_indices, self, dim);
-    if (!keepdim) {
-      min.squeeze_(dim);
-      min_indices.squeeze_(dim);
-    }
-    return std::tuple<Tensor &,Tensor &>{min, min_indices};
+  } else {
+    auto iter = TensorIterator::reduce_op(min, min_indices, self);
+    min_reduce_stub(kCPU, *iter);
+  }
+  if (!keepdim) {
+    min.squeeze_(dim);
+    min_indices.squeeze_(dim);
   }
-  return at::_th_min_out(min, min_indices, self, dim, keepdim);
+  return std::tuple<Tensor &,Tensor &>{min, min_indices};
 }
 
 std::tuple<Tensor, Tensor> min(const Tensor& self, int64_t dim, bool keepdim) {
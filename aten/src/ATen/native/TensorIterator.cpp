@@ -33,6 +33,15 @@ void TensorIterator::reorder_dimensions() {
     return sum_of_strides[i1] < sum_of_strides[i2];
   });
 
+  if (is_reduction_) {
+    // Move the reduced dimensions (output stride 0) to the front, keeping the
+    // relative order otherwise. See Note [Reductions].
+    auto& output_stride = operands_[0].stride_bytes;
+    std::stable_partition(std::begin(perm_), std::end(perm_), [&](int64_t dim) {
+      return output_stride[dim] == 0;
+    });
+  }
+
   auto reorder = [](IntList data, IntList perm_) {
     auto res = DimVector(data.size(), 0);
     for (size_t i = 0; i < perm_.size(); i++) {
@@ -57,6 +66,7 @@ compute_result_type(at::ArrayRef<OperandInfo> operands, const F& predicate) {
   auto backend = Backend::Undefined;
   for (auto& op : operands) {
     if (!op.tensor->defined()) continue;
+    if (op.required_dtype != ScalarType::Undefined) continue;
     if (!predicate(*op.tensor)) continue;
     auto dtype = op.tensor->type().scalarType();;
     result_type = (result_type == ScalarType::Undefined
@@ -94,11 +104,15 @@ void TensorIterator::compute_common_type() {
 
   for (auto& op : operands_) {
     if (!op.type) {
-      op.type = &type;
-      if (op.tensor->defined() && type != op.tensor->type()) {
+      if (op.required_dtype != ScalarType::Undefined) {
+        op.type = &at::globalContext().getType(backend, op.required_dtype);
+      } else {
+        op.type = &type;
+      }
+      if (op.tensor->defined() && *op.type != op.tensor->type()) {
         if (op.tensor->dim() == 0) {
-          if (type.backend() != at::Backend::CUDA) {
-            *op.tensor = op.tensor->toType(type);
+          if (op.type->backend() != at::Backend::CUDA) {
+            *op.tensor = op.tensor->toType(*op.type);
           }
         } else {
           op.needs_cast = true;
@@ -258,6 +272,73 @@ void TensorIterator::increment_counter(DimVector& counter, int64_t n) const {
   }
 }
 
+int TensorIterator::num_reduce_dims() const {
+  AT_ASSERT(is_reduction_);
+  int count = 0;
+  for (int dim = 0; dim < ndim(); dim++) {
+    if (operands_[0].stride_bytes[dim] != 0) {
+      break;
+    }
+    count++;
+  }
+  return count;
+}
+
+int64_t TensorIterator::num_output_elements() const {
+  int64_t elem = 1;
+  for (int dim = 0; dim < ndim(); dim++) {
+    if (operands_[0].stride_bytes[dim] != 0 || shape_[dim] == 0) {
+      elem *= shape_[dim];
+    }
+  }
+  return elem;
+}
+
+void TensorIterator::foreach_reduced_elt(loop_subiter_t loop) {
+  AT_ASSERT(is_reduction_);
+  int64_t num_outputs = num_output_elements();
+  if (num_outputs == 0 || numel() == 0) {
+    return;
+  }
+  if (num_outputs == 1) {
+    loop(*this);
+    return;
+  }
+
+  int reduce_dims = num_reduce_dims();
+  int64_t reduced_numel = numel() / num_outputs;
+  int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / reduced_numel);
+  at::parallel_for(0, num_outputs, grain_size, [&](int64_t begin, int64_t end) {
+    // The sub-iterator only iterates the reduced dimensions. Its data
+    // pointers are moved to the output element at `counter`.
+    TensorIterator sub_iter(*this);
+    for (int dim = reduce_dims; dim < ndim(); dim++) {
+      sub_iter.shape_[dim] = 1;
+    }
+    auto counter = DimVector();
+    int64_t x = begin;
+    for (int dim = reduce_dims; dim < ndim(); dim++) {
+      counter.push_back(x % shape_[dim]);
+      x /= shape_[dim];
+    }
+    for (int64_t i = begin; i < end; i++) {
+      for (int arg = 0; arg < ntensors(); arg++) {
+        auto& stride = operands_[arg].stride_bytes;
+        char* data = (char*)operands_[arg].data;
+        for (size_t j = 0; j < counter.size(); j++) {
+          data += counter[j] * stride[reduce_dims + j];
+        }
+        sub_iter.operands_[arg].data = data;
+      }
+      loop(sub_iter);
+      for (size_t j = 0; j < counter.size(); j++) {
+        if (++counter[j] < shape_[reduce_dims + j]) break;
+        counter[j] = 0;
+      }
+    }
+  });
+}
+
 void TensorIterator::for_each(loop_t loop) {
   auto inner_strides = get_inner_strides();
   auto base_ptrs = get_base_ptrs();
@@ -322,6 +403,13 @@ void TensorIterator::narrow(int dim, int64_t start, int64_t size) {
   }
 }
 
+std::unique_ptr<TensorIterator> TensorIterator::unary_op(Tensor& out, const Tensor& a) {
+  auto builder = TensorIterator::Builder();
+  builder.add_output(out);
+  builder.add_input(a);
+  return builder.build();
+}
+
 std::unique_ptr<TensorIterator> TensorIterator::binary_op(Tensor& out, const Tensor& a, const Tensor& b) {
   auto builder = TensorIterator::Builder();
   builder.add_output(out);
@@ -330,6 +418,36 @@ std::unique_ptr<TensorIterator> TensorIterator::binary_op(Tensor& out, const Ten
   return builder.build();
 }
 
+std::unique_ptr<TensorIterator> TensorIterator::comparison_op(Tensor& out, const Tensor& a, const Tensor& b) {
+  auto builder = TensorIterator::Builder();
+  builder.add_output(out, ScalarType::Byte);
+  builder.add_input(a);
+  builder.add_input(b);
+  return builder.build();
+}
+
+std::unique_ptr<TensorIterator> TensorIterator::reduce_op(Tensor& out, const Tensor& a) {
+  AT_ASSERT(out.defined());
+  auto builder = TensorIterator::Builder();
+  builder.add_output(out);
+  builder.add_input(a);
+  builder.is_reduction();
+  return builder.build();
+}
+
+std::unique_ptr<TensorIterator> TensorIterator::reduce_op(Tensor& out1, Tensor& out2, const Tensor& a) {
+  AT_ASSERT(out1.defined());
+  AT_ASSERT(out2.defined());
+  AT_CHECK(out1.sizes().equals(out2.sizes()), "reduce_op(): expected both outputs to have the same "
+           "shape, but output1 has ", out1.sizes(), " and output2 has ", out2.sizes());
+  auto builder = TensorIterator::Builder();
+  builder.add_output(out1);
+  builder.add_output(out2, out2.type().scalarType());
+  builder.add_input(a);
+  builder.is_reduction();
+  return builder.build();
+}
+
 void TensorIterator::mark_outputs() {
   for (int i = 0; i < num_outputs_; i++) {
     operands_[i].is_output = true;
@@ -353,7 +471,7 @@ void TensorIterator::compute_shape() {
     // For now, don't include output tensors that are not also input tensors.
     // This preserves the legacy behavior where torch.add(..., out=dst) resizes
     // the destination tensor.
-    if (op.is_output && !op.is_read_write) continue;
+    if (op.is_output && !op.is_read_write && resize_outputs_) continue;
 
     auto shape = op.tensor->sizes();
     if (shape_.empty()) {
@@ -369,8 +487,21 @@ void TensorIterator::compute_shape() {
   // outputs.
   for (int i = 0; i < num_outputs_; i++) {
     auto& tensor = *operands_[i].tensor;
+    if (is_reduction_) {
+      // The outputs of a reduction keep the size 1 of the reduced dimensions
+      AT_ASSERT(tensor.defined());
+      auto shape = tensor.sizes();
+      bool matches = shape.size() == shape_.size();
+      for (size_t dim = 0; matches && dim < shape.size(); dim++) {
+        matches = shape[dim] == shape_[dim] || shape[dim] == 1;
+      }
+      if (!matches) {
+        AT_ERROR("output with shape ", shape, " doesn't match the reduction of shape ", shape_);
+      }
+      continue;
+    }
     if (tensor.defined() && !tensor.sizes().equals(shape_)) {
-      if (!operands_[i].is_read_write) {
+      if (!operands_[i].is_read_write && resize_outputs_) {
         // Preserve legacy resizing behavior of out=... arguments
         // TODO: issue warning
         tensor.resize_(shape_);
@@ -411,7 +542,7 @@ void TensorIterator::compute_strides() {
 void TensorIterator::check_type_conversions() {
   for (auto& op : operands_) {
     if (op.needs_cast) {
-      AT_ERROR("TensorIterator expected type ", type().toString(), " but got ", op.tensor->type().toString(),
+      AT_ERROR("TensorIterator expected type ", op.type->toString(), " but got ", op.tensor->type().toString(),
             op.tensor->sizes());
     }
   }
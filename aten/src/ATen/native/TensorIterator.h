@@ -47,12 +47,30 @@
 //
 // Note that TensorIterator currently supports type conversions on 0-dim
 // tensors. Other type conversions will raise an exception.
+//
+// Note [Reductions]
+// ~~~~~~~~~~~~~~~~~
+// An iterator built with `reduce_op` (or `Builder::is_reduction()`) reduces
+// its input into outputs that already have the shape of the result with
+// `keepdim=true`: the reduced dimensions have size 1, so their output stride
+// is 0. The reduced dimensions are moved to the front (the fastest moving
+// dimensions) and coalesced like any other dimensions. `foreach_reduced_elt`
+// then calls a function with a sub-iterator for every output element, in
+// parallel; each sub-iterator only iterates the reduced dimensions. See
+// cpu/Reduce.h for the kernels.
+//
+// Operands added with an explicit scalar type (e.g. the Byte result of a
+// comparison, or the Byte condition of `where`) don't take part in the result
+// type computation. They are allocated with, or must already have, the given
+// scalar type.
 
 namespace at {
 
 struct AT_API OperandInfo {
   OperandInfo() {}
   OperandInfo(const Tensor& t) : tensor(const_cast<Tensor*>(&t)) {}
+  OperandInfo(const Tensor& t, ScalarType dtype)
+    : tensor(const_cast<Tensor*>(&t)), required_dtype(dtype) {}
 
   /// Stride after broadcasting. The stride is in bytes, not number of elements.
   DimVector stride_bytes;
@@ -68,6 +86,10 @@ struct AT_API OperandInfo {
   /// for type conversions currently: they are only allowed for zero-dim tensors.
   Type* type = nullptr;
 
+  /// The scalar type the operand must have, or Undefined if it should have
+  /// the common type of the operation.
+  ScalarType required_dtype = ScalarType::Undefined;
+
   /// The data pointer. This may be different from tensor.data_ptr() if the
   /// iterator is split.
   void* data = nullptr;
@@ -101,12 +123,21 @@ struct AT_API TensorIterator {
   // parallelization of the inner loop.
   using loop_t = const std::function<void(int ntensors, char** data, const int64_t* strides, int64_t size)>&;
 
+  static std::unique_ptr<TensorIterator> unary_op(Tensor& out, const Tensor& a);
   static std::unique_ptr<TensorIterator> binary_op(Tensor& out, const Tensor& a, const Tensor& b);
+  /// Like binary_op, but the output is a Byte tensor
+  static std::unique_ptr<TensorIterator> comparison_op(Tensor& out, const Tensor& a, const Tensor& b);
+  /// Reduces `a` into `out`, see Note [Reductions]
+  static std::unique_ptr<TensorIterator> reduce_op(Tensor& out, const Tensor& a);
+  /// Like reduce_op, with a second output of out2's dtype (e.g. the Long
+  /// indices of max, or the mean of var_mean)
+  static std::unique_ptr<TensorIterator> reduce_op(Tensor& out1, Tensor& out2, const Tensor& a);
 
   int ndim() const { return shape_.size(); }
   IntList shape() const { return shape_; }
   int64_t numel() const;
   int ntensors() const { return operands_.size(); }
+  int noutputs() const { return num_outputs_; }
 
   /// 1-dimensional iteration and no buffering or type conversion
   bool is_trivial_1d() const;
@@ -147,6 +178,17 @@ struct AT_API TensorIterator {
   void for_each(loop_t loop);
   void serial_for_each(loop_t loop, ArrayRef<char*> base_ptrs, IntList inner_strides, int64_t start, int64_t size);
 
+  /// Reductions: the number of leading (reduced) dimensions, and the number
+  /// of output elements.
+  bool is_reduction() const { return is_reduction_; }
+  int num_reduce_dims() const;
+  int64_t num_output_elements() const;
+
+  /// Calls `loop` with a sub-iterator over the reduced dimensions for every
+  /// output element. Output elements are processed in parallel.
+  using loop_subiter_t = const std::function<void(TensorIterator& subiter)>&;
+  void foreach_reduced_elt(loop_subiter_t loop);
+
   /// Create a strides array for a Tensor with shape of this iterator. The
   /// parameter `element_size` specifies the size of Tensor's data type in
   /// bytes (e.g. `4` for `float`)
@@ -186,6 +228,8 @@ private:
   SmallVector<OperandInfo, 4> operands_;
   int num_outputs_ = 0;
   bool has_coalesced_dimensions_ = false;
+  bool is_reduction_ = false;
+  bool resize_outputs_ = true;
 };
 
 struct TensorIterator::Builder {
@@ -197,11 +241,35 @@ struct TensorIterator::Builder {
     return *this;
   }
 
+  Builder& add_output(const Tensor& output, ScalarType dtype) {
+    iter_->operands_.emplace_back(output, dtype);
+    iter_->num_outputs_++;
+    return *this;
+  }
+
   Builder& add_input(const Tensor& input) {
     iter_->operands_.emplace_back(input);
     return *this;
   }
 
+  Builder& add_input(const Tensor& input, ScalarType dtype) {
+    iter_->operands_.emplace_back(input, dtype);
+    return *this;
+  }
+
+  Builder& is_reduction(bool is_reduction=true) {
+    iter_->is_reduction_ = is_reduction;
+    return *this;
+  }
+
+  /// Broadcast the inputs to the shape of the outputs instead of resizing the
+  /// outputs to the broadcast shape of the inputs. Used when the output is a
+  /// view that must not be resized, like the restrided `self` of index_put_.
+  Builder& dont_resize_outputs() {
+    iter_->resize_outputs_ = false;
+    return *this;
+  }
+
   std::unique_ptr<TensorIterator> build();
 
 private:
@@ -11,6 +11,19 @@ bool is_same_size(const Tensor& self, const Tensor& other) {
   return self.sizes().equals(other.sizes());
 }
 
+bool is_channels_last(const Tensor& self) {
+  return is_channels_last_strides(self.sizes(), self.strides());
+}
+
+Tensor to_channels_last(const Tensor& self) {
+  AT_CHECK(self.dim() == 4, "to_channels_last(): expected a 4-d tensor, but got a tensor with ",
+           self.dim(), " dimensions");
+  if (self.is_channels_last()) {
+    return self;
+  }
+  return self.permute({0, 2, 3, 1}).contiguous().permute({0, 3, 1, 2});
+}
+
 int64_t size(const Tensor& self, int64_t dim) {
   // false is passed to maybe_wrap_dim so behavior is identical to array access (but with wrapping)
   dim = maybe_wrap_dim(dim, self.dim(), false);
@@ -3,12 +3,14 @@
 #include "ATen/ExpandUtils.h"
 #include "ATen/InferSize.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
 #include "ATen/WrapDimUtils.h"
 #include "ATen/core/Error.h"
 #include "ATen/core/optional.h"
 #include <ATen/native/sparse/SparseUtils.h>
 
 #include <algorithm>
+#include <cstring>
 #include <vector>
 
 namespace at {
@@ -27,15 +29,101 @@ static void check_cat_no_zero_dim(TensorList tensors) {
   }
 }
 
+// The common case of cat on CPU: non-empty contiguous tensors of the same
+// type and shape apart from dim. Everything else, including the legacy
+// skipping of empty tensors, is left to TH.
+static bool can_cat_contiguous_cpu(TensorList tensors, int64_t dim) {
+  if (tensors.size() == 0) {
+    return false;
+  }
+  auto& first = tensors[0];
+  if (first.type().backend() != Backend::CPU || dim >= first.dim()) {
+    return false;
+  }
+  for (auto& t : tensors) {
+    if (t.type() != first.type() || t.dim() != first.dim() ||
+        t.numel() == 0 || !t.is_contiguous()) {
+      return false;
+    }
+    for (int64_t d = 0; d < t.dim(); d++) {
+      if (d != dim && t.size(d) != first.size(d)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static std::vector<int64_t> cat_sizes(TensorList tensors, int64_t dim) {
+  auto sizes = tensors[0].sizes().vec();
+  for (size_t i = 1; i < tensors.size(); i++) {
+    sizes[dim] += tensors[i].size(dim);
+  }
+  return sizes;
+}
+
+// Views the result as [outer, size(dim) * inner] rows, to which every input
+// contributes one contiguous block. The (row, input) blocks are memcpy'ed in
+// parallel, so many small inputs are spread over the threads as well as a
+// few large ones.
+static void cat_contiguous_cpu(Tensor& result, TensorList tensors, int64_t dim) {
+  int64_t outer = 1;
+  for (int64_t d = 0; d < dim; d++) {
+    outer *= result.size(d);
+  }
+  int64_t inner_bytes = result.type().elementSizeInBytes();
+  for (int64_t d = dim + 1; d < result.dim(); d++) {
+    inner_bytes *= result.size(d);
+  }
+  int64_t num_inputs = tensors.size();
+  int64_t result_row_bytes = result.size(dim) * inner_bytes;
+  std::vector<const char*> input_data(num_inputs);
+  std::vector<int64_t> block_bytes(num_inputs);
+  std::vector<int64_t> block_offsets(num_inputs);
+  int64_t offset = 0;
+  for (int64_t i = 0; i < num_inputs; i++) {
+    input_data[i] = static_cast<const char*>(tensors[i].data_ptr());
+    block_bytes[i] = tensors[i].size(dim) * inner_bytes;
+    block_offsets[i] = offset;
+    offset += block_bytes[i];
+  }
+  auto result_data = static_cast<char*>(result.data_ptr());
+
+  // Roughly GRAIN_SIZE floats per task
+  int64_t avg_block_bytes = std::max<int64_t>(1, result_row_bytes / num_inputs);
+  int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE * 4 / avg_block_bytes);
+  parallel_for(0, outer * num_inputs, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t k = begin; k < end; k++) {
+      int64_t row = k / num_inputs;
+      int64_t i = k % num_inputs;
+      std::memcpy(result_data + row * result_row_bytes + block_offsets[i],
+                  input_data[i] + row * block_bytes[i],
+                  block_bytes[i]);
+    }
+  });
+}
+
 Tensor & cat_out(Tensor & result, TensorList tensors, int64_t dim) {
   check_cat_no_zero_dim(tensors);
   dim = legacy_cat_wrap_dim(dim, tensors);
+  if (can_cat_contiguous_cpu(tensors, dim) && result.type() == tensors[0].type()) {
+    result.resize_(cat_sizes(tensors, dim));
+    if (result.is_contiguous()) {
+      cat_contiguous_cpu(result, tensors, dim);
+      return result;
+    }
+  }
   return at::_cat_out(result, tensors, dim);
 }
 
 Tensor cat(TensorList tensors, int64_t dim) {
   check_cat_no_zero_dim(tensors);
   dim = legacy_cat_wrap_dim(dim, tensors);
+  if (can_cat_contiguous_cpu(tensors, dim)) {
+    Tensor result = tensors[0].type().tensor(cat_sizes(tensors, dim));
+    cat_contiguous_cpu(result, tensors, dim);
+    return result;
+  }
   return at::_cat(tensors, dim);
 }
 
@@ -98,8 +186,8 @@ Tensor diagonal(const Tensor& self, int64_t offset, int64_t dim1_, int64_t dim2_
 
   // construct new size and stride: we drop dim1 and dim2 (maximum first for not changing the index of the minumum)
   // the new ("joint") dimension is appended to the end of the shape / stride to match numpy semantics
-  auto sizes = self.sizes().vec();
-  auto strides = self.strides().vec();
+  DimVector sizes(self.sizes().begin(), self.sizes().end());
+  DimVector strides(self.strides().begin(), self.strides().end());
   sizes.erase(sizes.begin() + std::max(dim1, dim2));
   strides.erase(strides.begin() + std::max(dim1, dim2));
   sizes.erase(sizes.begin() + std::min(dim1, dim2));
@@ -173,8 +261,8 @@ Tensor permute(const Tensor& self, IntList dims) {
   }
   auto oldSizes = self.sizes();
   auto oldStrides = self.strides();
-  std::vector<int64_t> newSizes(nDims);
-  std::vector<int64_t> newStrides(nDims);
+  DimVector newSizes(nDims);
+  DimVector newStrides(nDims);
   std::vector<bool> seen(nDims);
   for (int64_t i = 0; i < nDims; i++) {
     auto dim = maybe_wrap_dim(dims[i], nDims);
@@ -248,8 +336,8 @@ Tensor select(const Tensor& self, int64_t dim, int64_t index) {
   if (index < 0) {
     index += size;
   }
-  auto sizes = self.sizes().vec();
-  auto strides = self.strides().vec();
+  DimVector sizes(self.sizes().begin(), self.sizes().end());
+  DimVector strides(self.strides().begin(), self.strides().end());
   auto storage_offset = self.storage_offset() + index * strides[dim];
   sizes.erase(sizes.begin() + dim);
   strides.erase(strides.begin() + dim);
@@ -260,8 +348,8 @@ Tensor slice(const Tensor& self, int64_t dim, int64_t start, int64_t end, int64_
   int64_t ndim = self.dim();
   AT_CHECK(ndim > 0, "slice() cannot be applied to a 0-dim tensor.");
   dim = maybe_wrap_dim(dim, ndim);
-  auto sizes = self.sizes().vec();
-  auto strides = self.strides().vec();
+  DimVector sizes(self.sizes().begin(), self.sizes().end());
+  DimVector strides(self.strides().begin(), self.strides().end());
   if (step <= 0) {
     // TODO: support negative strides
     throw std::runtime_error("slice step must be positive");
@@ -411,8 +499,8 @@ Tensor & transpose_(Tensor & self, int64_t dim0, int64_t dim1) {
     return sparse_transpose_(self, dim0, dim1);
   }
 
-  auto strides = self.strides().vec();
-  auto sizes = self.sizes().vec();
+  DimVector strides(self.strides().begin(), self.strides().end());
+  DimVector sizes(self.sizes().begin(), self.sizes().end());
   std::swap(strides[dim0], strides[dim1]);
   std::swap(sizes[dim0], sizes[dim1]);
   return self.as_strided_(sizes, strides);
@@ -431,8 +519,8 @@ Tensor transpose(const Tensor & self, int64_t dim0, int64_t dim1) {
     return sparse_transpose_(self_clone, dim0, dim1);
   }
 
-  auto strides = self.strides().vec();
-  auto sizes = self.sizes().vec();
+  DimVector strides(self.strides().begin(), self.strides().end());
+  DimVector sizes(self.sizes().begin(), self.sizes().end());
   std::swap(strides[dim0], strides[dim1]);
   std::swap(sizes[dim0], sizes[dim1]);
   return self.as_strided(sizes, strides);
@@ -461,10 +549,10 @@ Tensor & t_(Tensor & self) {
   return self.transpose_(0, 1);
 }
 
-std::tuple<std::vector<int64_t>, std::vector<int64_t> >
+std::tuple<DimVector, DimVector>
 inferSqueezeGeometry(const Tensor &tensor) {
-  std::vector<int64_t> sizes;
-  std::vector<int64_t> strides;
+  DimVector sizes;
+  DimVector strides;
 
   for(int64_t d = 0; d < tensor.dim(); d++) {
     if(tensor.sizes()[d] != 1) {
@@ -476,10 +564,10 @@ inferSqueezeGeometry(const Tensor &tensor) {
   return std::make_tuple(sizes, strides);
 }
 
-std::tuple<std::vector<int64_t>, std::vector<int64_t> >
+std::tuple<DimVector, DimVector>
 inferSqueezeGeometry(const Tensor& tensor, int64_t dim) {
-  std::vector<int64_t> sizes;
-  std::vector<int64_t> strides;
+  DimVector sizes;
+  DimVector strides;
 
   for(int64_t d = 0; d < tensor.dim(); d++) {
     if(d != dim || tensor.sizes()[dim] != 1) {
@@ -490,10 +578,10 @@ inferSqueezeGeometry(const Tensor& tensor, int64_t dim) {
   return std::make_tuple(sizes, strides);
 }
 
-std::tuple<std::vector<int64_t>, std::vector<int64_t> >
+std::tuple<DimVector, DimVector>
 inferUnsqueezeGeometry(const Tensor& tensor, int64_t dim) {
-  auto sizes = tensor.sizes().vec();
-  auto strides = tensor.strides().vec();
+  DimVector sizes(tensor.sizes().begin(), tensor.sizes().end());
+  DimVector strides(tensor.strides().begin(), tensor.strides().end());
   int64_t new_stride = dim >= tensor.dim() ? 1 : sizes[dim] * strides[dim];
   sizes.insert(sizes.begin() + dim, 1);
   strides.insert(strides.begin() + dim, new_stride);
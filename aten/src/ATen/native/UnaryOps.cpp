@@ -12,6 +12,7 @@
 
 #include "ATen/CPUApplyUtils.h"
 #include "ATen/Parallel.h"
+#include "ATen/native/TensorIterator.h"
 #include "ATen/native/cpu/UnaryOpsKernel.h"
 
 #include <algorithm>
@@ -46,15 +47,7 @@ Tensor clamp_min(const Tensor& self, Scalar min) {
 }
 
 Tensor& _clamp__cpu(Tensor& self, Scalar min, Scalar max) {
-  if (!std::isnan(min.toDouble()) && !std::isnan(max.toDouble())) {
-    return _th_clamp_out(self, self, min, max);
-  } else if (std::isnan(min.toDouble())) {
-    return _th_clamp_max_out(self, self, max);
-  } else if (std::isnan(max.toDouble())) {
-    return _th_clamp_min_out(self, self, min);
-  } else {
-    return self;
-  }
+  return _clamp_out_cpu(self, self, min, max);
 }
 
 Tensor& _clamp_out_cpu(
@@ -63,29 +56,34 @@ Tensor& _clamp_out_cpu(
     Scalar min,
     Scalar max) {
   if (!std::isnan(min.toDouble()) && !std::isnan(max.toDouble())) {
-    _th_clamp_out(result, self, min, max);
+    auto iter = TensorIterator::unary_op(result, self);
+    clamp_stub(kCPU, *iter, min, max);
   } else if (std::isnan(min.toDouble())) {
-    _th_clamp_max_out(result, self, max);
+    _clamp_max_out_cpu(result, self, max);
   } else if (std::isnan(max.toDouble())) {
-    _th_clamp_min_out(result, self, min);
+    _clamp_min_out_cpu(result, self, min);
   }
   return result;
 }
 
 Tensor& _clamp_max__cpu(Tensor& self, Scalar max) {
-  return _th_clamp_max_out(self, self, max);
+  return _clamp_max_out_cpu(self, self, max);
 }
 
 Tensor& _clamp_max_out_cpu(Tensor& result, const Tensor& self, Scalar max) {
-  return _th_clamp_max_out(result, self, max);
+  auto iter = TensorIterator::unary_op(result, self);
+  clamp_max_stub(kCPU, *iter, max);
+  return result;
 }
 
 Tensor& _clamp_min__cpu(Tensor& self, Scalar min) {
-  return _th_clamp_min_out(self, self, min);
+  return _clamp_min_out_cpu(self, self, min);
 }
 
 Tensor& _clamp_min_out_cpu(Tensor& result, const Tensor& self, Scalar min) {
-  return _th_clamp_min_out(result, self, min);
+  auto iter = TensorIterator::unary_op(result, self);
+  clamp_min_stub(kCPU, *iter, min);
+  return result;
 }
 
 Tensor& fill_(Tensor& self, Scalar value) {
@@ -162,7 +160,7 @@ IMPLEMENT_UNARY_OP_VEC(asin)
 IMPLEMENT_UNARY_OP_VEC(atan)
 IMPLEMENT_UNARY_OP_VEC(ceil)
 IMPLEMENT_UNARY_OP_VEC(cos)
-IMPLEMENT_UNARY_OP_TH(cosh)
+IMPLEMENT_UNARY_OP_VEC(cosh)
 IMPLEMENT_UNARY_OP_VEC(erf)
 IMPLEMENT_UNARY_OP_VEC(erfc)
 IMPLEMENT_UNARY_OP_VEC(exp)
@@ -176,7 +174,7 @@ IMPLEMENT_UNARY_OP_VEC(round)
 IMPLEMENT_UNARY_OP_VEC(rsqrt)
 IMPLEMENT_UNARY_OP_VEC(sigmoid)
 IMPLEMENT_UNARY_OP_VEC(sin)
-IMPLEMENT_UNARY_OP_TH(sinh)
+IMPLEMENT_UNARY_OP_VEC(sinh)
 IMPLEMENT_UNARY_OP_VEC(sqrt)
 IMPLEMENT_UNARY_OP_VEC(tan)
 IMPLEMENT_UNARY_OP_VEC(tanh)
@@ -188,6 +186,7 @@ DEFINE_DISPATCH(asinImpl);
 DEFINE_DISPATCH(atanImpl);
 DEFINE_DISPATCH(ceilImpl);
 DEFINE_DISPATCH(cosImpl);
+DEFINE_DISPATCH(coshImpl);
 DEFINE_DISPATCH(erfImpl);
 DEFINE_DISPATCH(erfcImpl);
 DEFINE_DISPATCH(expImpl);
@@ -201,10 +200,14 @@ DEFINE_DISPATCH(roundImpl);
 DEFINE_DISPATCH(rsqrtImpl);
 DEFINE_DISPATCH(sigmoidImpl);
 DEFINE_DISPATCH(sinImpl);
+DEFINE_DISPATCH(sinhImpl);
 DEFINE_DISPATCH(sqrtImpl);
 DEFINE_DISPATCH(tanImpl);
 DEFINE_DISPATCH(tanhImpl);
 DEFINE_DISPATCH(truncImpl);
+DEFINE_DISPATCH(clamp_stub);
+DEFINE_DISPATCH(clamp_max_stub);
+DEFINE_DISPATCH(clamp_min_stub);
 
 }
 } // namespace at
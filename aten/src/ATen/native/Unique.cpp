@@ -1,58 +1,199 @@
 // Returns unique elements of input tensor.
+//
+// The elements are split into partitions by hash, so that equal values land
+// in the same partition, and each partition is deduplicated with its own hash
+// map in parallel. The partitions' unique values are then concatenated, and
+// only they (not the whole input) are radix sorted if a sorted result is
+// asked for.
 
 #include "ATen/ATen.h"
 #include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/native/SortingUtils.h"
 
-#include <set>
+#include <functional>
 #include <tuple>
 #include <unordered_map>
-#include <unordered_set>
+#include <vector>
 
 namespace at {
 namespace native{
 
 namespace {
 
+// Partitions are handed out to threads whole, so use a few per thread to
+// even out skewed hashes.
+constexpr int64_t kPartitionsPerThread = 4;
+
+template <typename scalar_t>
+int64_t partition_of(scalar_t value, int64_t num_partitions) {
+  // mix the hash, so the partitions don't line up with the maps' buckets
+  uint64_t h = static_cast<uint64_t>(std::hash<scalar_t>()(value)) * 0x9E3779B97F4A7C15ULL;
+  return static_cast<int64_t>((h >> 32) % num_partitions);
+}
+
 template <typename scalar_t>
-std::tuple<Tensor, Tensor> _unique_cpu_template(
+std::tuple<Tensor, Tensor, Tensor> _unique_cpu_template(
     const Tensor& self,
     const bool sorted,
-    const bool return_inverse) {
+    const bool return_inverse,
+    const bool return_counts) {
   const Tensor& input = self.contiguous();
   const scalar_t* input_data = input.data<scalar_t>();
-  std::unordered_set<scalar_t> set(input_data, input_data + input.numel());
-  Tensor output = at::empty({static_cast<int64_t>(set.size())}, input.type());
-  scalar_t* output_data = output.data<scalar_t>();
+  const int64_t n = input.numel();
+
+  int64_t num_partitions = 1;
+  if (n >= internal::GRAIN_SIZE && get_num_threads() > 1 && !in_parallel_region()) {
+    num_partitions = get_num_threads() * kPartitionsPerThread;
+  }
 
-  if (sorted) {
-    std::vector<scalar_t> vec(set.begin(), set.end());
-    std::sort(vec.begin(), vec.end());
-    std::copy(vec.begin(), vec.end(), output_data);
+  // Group the element indices by partition, keeping their order within each
+  // partition, the same way a radix sort pass scatters by digit.
+  std::vector<int64_t> partition_begin(num_partitions + 1, 0);
+  std::vector<int64_t> order;
+  if (num_partitions > 1) {
+    const int64_t num_chunks = get_num_threads();
+    const int64_t chunk_size = divup(n, num_chunks);
+    std::vector<int64_t> offsets(num_chunks * num_partitions, 0);
+    parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        int64_t* counts = offsets.data() + c * num_partitions;
+        for (int64_t i = c * chunk_size; i < std::min(n, (c + 1) * chunk_size); i++) {
+          counts[partition_of(input_data[i], num_partitions)]++;
+        }
+      }
+    });
+    int64_t total = 0;
+    for (int64_t p = 0; p < num_partitions; p++) {
+      partition_begin[p] = total;
+      for (int64_t c = 0; c < num_chunks; c++) {
+        int64_t count = offsets[c * num_partitions + p];
+        offsets[c * num_partitions + p] = total;
+        total += count;
+      }
+    }
+    partition_begin[num_partitions] = total;
+    order.resize(n);
+    parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        int64_t* positions = offsets.data() + c * num_partitions;
+        for (int64_t i = c * chunk_size; i < std::min(n, (c + 1) * chunk_size); i++) {
+          order[positions[partition_of(input_data[i], num_partitions)]++] = i;
+        }
+      }
+    });
   } else {
-    std::copy(set.begin(), set.end(), output_data);
+    partition_begin[1] = n;
   }
+  // the index of the i-th element of the grouped input
+  auto element = [&](int64_t i) {
+    return order.empty() ? i : order[i];
+  };
 
   Tensor inverse_indices = at::empty({0}, self.type().toScalarType(kLong));
+  int64_t* inverse_indices_data = nullptr;
   if (return_inverse) {
     inverse_indices.resize_(input.sizes());
-    int64_t* inverse_indices_data = inverse_indices.data<int64_t>();
-    std::unordered_map<scalar_t, int64_t> inverse_map;
-    inverse_map.reserve(output.numel());
-    for (int i = 0; i < output.numel(); ++i) {
-      inverse_map[output_data[i]] = i;
+    inverse_indices_data = inverse_indices.data<int64_t>();
+  }
+
+  // Deduplicate each partition, numbering its unique values in order of
+  // first occurrence. The inverse indices are partition-local for now.
+  std::vector<std::vector<scalar_t>> partition_values(num_partitions);
+  std::vector<std::vector<int64_t>> partition_counts(num_partitions);
+  parallel_for(0, num_partitions, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t p = begin; p < end; p++) {
+      std::unordered_map<scalar_t, int64_t> ids;
+      auto& values = partition_values[p];
+      auto& counts = partition_counts[p];
+      for (int64_t i = partition_begin[p]; i < partition_begin[p + 1]; i++) {
+        const int64_t e = element(i);
+        auto it = ids.emplace(input_data[e], values.size());
+        const int64_t id = it.first->second;
+        if (it.second) {
+          values.push_back(input_data[e]);
+          counts.push_back(0);
+        }
+        counts[id]++;
+        if (return_inverse) {
+          inverse_indices_data[e] = id;
+        }
+      }
     }
-    for (int i = 0; i < input.numel(); ++i) {
-      inverse_indices_data[i] = inverse_map[input_data[i]];
+  });
+
+  std::vector<int64_t> partition_base(num_partitions + 1, 0);
+  for (int64_t p = 0; p < num_partitions; p++) {
+    partition_base[p + 1] = partition_base[p] + partition_values[p].size();
+  }
+  const int64_t num_unique = partition_base[num_partitions];
+
+  Tensor output = at::empty({num_unique}, input.type());
+  scalar_t* output_data = output.data<scalar_t>();
+  Tensor counts = at::empty({0}, self.type().toScalarType(kLong));
+  int64_t* counts_data = nullptr;
+  if (return_counts) {
+    counts.resize_({num_unique});
+    counts_data = counts.data<int64_t>();
+  }
+
+  // Sorting only the unique values gives each one its rank in the output.
+  std::vector<int64_t> rank;
+  if (sorted && num_unique > 0) {
+    using key_t = typename RadixKey<scalar_t>::type;
+    std::vector<key_t> keys(num_unique);
+    std::vector<int64_t> perm(num_unique);
+    for (int64_t p = 0; p < num_partitions; p++) {
+      for (size_t j = 0; j < partition_values[p].size(); j++) {
+        keys[partition_base[p] + j] = RadixKey<scalar_t>::encode(partition_values[p][j]);
+        perm[partition_base[p] + j] = partition_base[p] + j;
+      }
+    }
+    radix_sort_pairs(keys.data(), perm.data(), num_unique);
+    rank.resize(num_unique);
+    for (int64_t r = 0; r < num_unique; r++) {
+      rank[perm[r]] = r;
     }
   }
-  return std::make_tuple(output, inverse_indices);
+  auto position = [&](int64_t id) {
+    return rank.empty() ? id : rank[id];
+  };
+
+  parallel_for(0, num_partitions, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t p = begin; p < end; p++) {
+      const int64_t base = partition_base[p];
+      for (size_t j = 0; j < partition_values[p].size(); j++) {
+        output_data[position(base + j)] = partition_values[p][j];
+        if (return_counts) {
+          counts_data[position(base + j)] = partition_counts[p][j];
+        }
+      }
+      if (return_inverse) {
+        for (int64_t i = partition_begin[p]; i < partition_begin[p + 1]; i++) {
+          const int64_t e = element(i);
+          inverse_indices_data[e] = position(base + inverse_indices_data[e]);
+        }
+      }
+    }
+  });
+  return std::make_tuple(output, inverse_indices, counts);
 }
 } // namespace
 
 std::tuple<Tensor, Tensor>
 _unique_cpu(const Tensor& self, const bool sorted, const bool return_inverse) {
   return AT_DISPATCH_ALL_TYPES(self.type(), "unique", [&] {
-    return _unique_cpu_template<scalar_t>(self, sorted, return_inverse);
+    Tensor output, inverse_indices;
+    std::tie(output, inverse_indices, std::ignore) =
+        _unique_cpu_template<scalar_t>(self, sorted, return_inverse, false);
+    return std::make_tuple(output, inverse_indices);
+  });
+}
+
+std::tuple<Tensor, Tensor, Tensor>
+_unique2_cpu(const Tensor& self, const bool sorted, const bool return_inverse, const bool return_counts) {
+  return AT_DISPATCH_ALL_TYPES(self.type(), "unique", [&] {
+    return _unique_cpu_template<scalar_t>(self, sorted, return_inverse, return_counts);
   });
 }
 
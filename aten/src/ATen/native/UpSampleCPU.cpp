@@ -0,0 +1,123 @@
+#include "ATen/ATen.h"
+#include "ATen/MemoryFormat.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/native/UpSampleCPU.h"
+
+#include <vector>
+
+// Bilinear and trilinear upsampling on CPU, replacing SpatialUpSamplingBilinear
+// and VolumetricUpSamplingTrilinear in THNN (which the CUDA versions still
+// use, through the thnn_ functions). Channels-last inputs are upsampled
+// without a copy and give channels-last outputs, see Note [Channels last].
+
+namespace at { namespace native {
+
+DEFINE_DISPATCH(upsample_linear_stub);
+DEFINE_DISPATCH(upsample_linear_backward_stub);
+
+namespace {
+
+// The sizes of the output of an input of input_size, checking the arguments.
+std::vector<int64_t> upsample_output_size(
+    const char* name, IntList input_size, IntList output_size) {
+  const size_t spatial_dim = output_size.size();
+  AT_CHECK(input_size.size() == spatial_dim + 2,
+           name, ": expected an input of ", spatial_dim + 2, " dimensions, but got sizes ", input_size);
+  std::vector<int64_t> sizes = input_size.vec();
+  for (size_t i = 0; i < spatial_dim; i++) {
+    AT_CHECK(input_size[i + 2] > 0 && output_size[i] > 0,
+             name, ": input and output sizes should be greater than 0, but got input ",
+             input_size, " and output_size ", output_size);
+    sizes[i + 2] = output_size[i];
+  }
+  AT_CHECK(sizes[0] > 0 && sizes[1] > 0, name, ": non-empty input expected, but got sizes ", input_size);
+  return sizes;
+}
+
+bool is_channels_last_input(const Tensor& t) {
+  return suggest_memory_format(t.sizes(), t.strides()) == MemoryFormat::ChannelsLast;
+}
+
+Tensor empty_in_format(const Tensor& t, IntList sizes, bool channels_last) {
+  if (channels_last) {
+    return t.type().tensor(sizes, get_channels_last_strides(sizes));
+  }
+  return t.type().tensor(sizes);
+}
+
+// output has the layout of input. Same-size upsampling is a copy, like in THNN.
+void upsample_linear_out_cpu_template(Tensor& output, const Tensor& input, bool align_corners) {
+  if (input.sizes().equals(output.sizes())) {
+    output.copy_(input);
+    return;
+  }
+  upsample_linear_stub(kCPU, output, input, align_corners);
+}
+
+Tensor upsample_linear_cpu(const char* name, const Tensor& self, IntList output_size, bool align_corners) {
+  auto sizes = upsample_output_size(name, self.sizes(), output_size);
+  const bool channels_last = is_channels_last_input(self);
+  auto output = empty_in_format(self, sizes, channels_last);
+  upsample_linear_out_cpu_template(
+      output, channels_last ? self : self.contiguous(), align_corners);
+  return output;
+}
+
+Tensor& upsample_linear_out_cpu(
+    const char* name, Tensor& output, const Tensor& self, IntList output_size, bool align_corners) {
+  output.resize_(upsample_output_size(name, self.sizes(), output_size));
+  AT_CHECK(output.is_contiguous(), name, ": output must be contiguous");
+  upsample_linear_out_cpu_template(output, self.contiguous(), align_corners);
+  return output;
+}
+
+Tensor upsample_linear_backward_cpu(
+    const char* name, const Tensor& grad_output, IntList output_size, IntList input_size,
+    bool align_corners) {
+  auto sizes = upsample_output_size(name, input_size, output_size);
+  AT_CHECK(grad_output.sizes().equals(sizes),
+           name, ": expected grad_output of size ", IntList(sizes), ", but got ", grad_output.sizes());
+  const bool channels_last = is_channels_last_input(grad_output);
+  auto grad_input = empty_in_format(grad_output, input_size, channels_last);
+  auto grad_output_ = channels_last ? grad_output : grad_output.contiguous();
+  if (input_size.equals(grad_output.sizes())) {
+    grad_input.copy_(grad_output_);
+    return grad_input;
+  }
+  upsample_linear_backward_stub(kCPU, grad_input, grad_output_, align_corners);
+  return grad_input;
+}
+
+} // anonymous namespace
+
+Tensor upsample_bilinear2d_cpu(const Tensor& self, IntList output_size, bool align_corners) {
+  return upsample_linear_cpu("upsample_bilinear2d", self, output_size, align_corners);
+}
+
+Tensor& upsample_bilinear2d_out_cpu(
+    Tensor& output, const Tensor& self, IntList output_size, bool align_corners) {
+  return upsample_linear_out_cpu("upsample_bilinear2d", output, self, output_size, align_corners);
+}
+
+Tensor upsample_bilinear2d_backward_cpu(
+    const Tensor& grad_output, IntList output_size, IntList input_size, bool align_corners) {
+  return upsample_linear_backward_cpu(
+      "upsample_bilinear2d_backward", grad_output, output_size, input_size, align_corners);
+}
+
+Tensor upsample_trilinear3d_cpu(const Tensor& self, IntList output_size, bool align_corners) {
+  return upsample_linear_cpu("upsample_trilinear3d", self, output_size, align_corners);
+}
+
+Tensor& upsample_trilinear3d_out_cpu(
+    Tensor& output, const Tensor& self, IntList output_size, bool align_corners) {
+  return upsample_linear_out_cpu("upsample_trilinear3d", output, self, output_size, align_corners);
+}
+
+Tensor upsample_trilinear3d_backward_cpu(
+    const Tensor& grad_output, IntList output_size, IntList input_size, bool align_corners) {
+  return upsample_linear_backward_cpu(
+      "upsample_trilinear3d_backward", grad_output, output_size, input_size, align_corners);
+}
+
+}} // namespace at::native
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// Bilinear and trilinear interpolation, with the same source indices and
+// weights as the THNN kernels, of (N, C, H, W) or (N, C, D, H, W) tensors. The
+// tensors are all contiguous, or all channels last (see Note [Channels last])
+// for 4-d tensors; the layout is taken from the input of the forward and from
+// grad_input of the backward. The output and grad_input are already allocated
+// with the right sizes.
+using upsample_linear_fn = void(*)(Tensor& output, const Tensor& input, bool align_corners);
+using upsample_linear_backward_fn = void(*)(
+    Tensor& grad_input, const Tensor& grad_output, bool align_corners);
+
+DECLARE_DISPATCH(upsample_linear_fn, upsample_linear_stub);
+DECLARE_DISPATCH(upsample_linear_backward_fn, upsample_linear_backward_stub);
+
+}} // namespace at::native
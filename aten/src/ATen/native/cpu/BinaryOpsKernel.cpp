@@ -7,6 +7,7 @@
 #include "ATen/native/TensorIterator.h"
 #include "ATen/native/BinaryOps.h"
 #include "ATen/native/cpu/Loops.h"
+#include "ATen/native/cpu/Vectorized.h"
 
 namespace at { namespace native {
 namespace {
@@ -14,13 +15,23 @@ namespace {
 using namespace vec256;
 
 void add_kernel(TensorIterator& iter, Scalar alpha_scalar) {
+  if (iter.type().scalarType() == kHalf) {
+    auto alpha = alpha_scalar.to<float>();
+    auto alpha_vec = Vectorized<float>(alpha);
+    binary_kernel_reduced_float<Half>(iter,
+      [=](float a, float b) -> float { return a + alpha * b; },
+      [=](Vectorized<float> a, Vectorized<float> b) {
+        return vec::fmadd(b, alpha_vec, a);
+      });
+    return;
+  }
   AT_DISPATCH_ALL_TYPES(iter.type(), "add", [&]() {
     auto alpha = alpha_scalar.to<scalar_t>();
-    auto alpha_vec = Vec256<scalar_t>(alpha);
+    auto alpha_vec = Vectorized<scalar_t>(alpha);
     binary_kernel_vec(iter,
       [=](scalar_t a, scalar_t b) -> scalar_t { return a + alpha * b; },
-      [=](Vec256<scalar_t> a, Vec256<scalar_t> b) {
-        return vec256::fmadd(b, alpha_vec, a);
+      [=](Vectorized<scalar_t> a, Vectorized<scalar_t> b) {
+        return vec::fmadd(b, alpha_vec, a);
       });
   });
 }
@@ -30,10 +41,18 @@ void sub_kernel(TensorIterator& iter, Scalar alpha_scalar) {
 }
 
 void mul_kernel(TensorIterator& iter) {
+  if (iter.type().scalarType() == kHalf) {
+    binary_kernel_reduced_float<Half>(iter,
+      [=](float a, float b) -> float { return a * b; },
+      [=](Vectorized<float> a, Vectorized<float> b) {
+        return a * b;
+      });
+    return;
+  }
   AT_DISPATCH_ALL_TYPES(iter.type(), "mul", [&]() {
     binary_kernel_vec(iter,
       [=](scalar_t a, scalar_t b) -> scalar_t { return a * b; },
-      [=](Vec256<scalar_t> a, Vec256<scalar_t> b) {
+      [=](Vectorized<scalar_t> a, Vectorized<scalar_t> b) {
         return a * b;
       });
   });
@@ -48,13 +67,21 @@ void div_kernel(TensorIterator& iter) {
         return a / b;
       });
     });
+  } else if (iter.type().scalarType() == kHalf) {
+    binary_kernel_reduced_float<Half>(iter,
+      [=](float a, float b) __ubsan_ignore_float_divide_by_zero__ -> float {
+         return a / b;
+      },
+      [=](Vectorized<float> a, Vectorized<float> b) {
+        return a / b;
+      });
   } else {
     AT_DISPATCH_FLOATING_TYPES(iter.type(), "div", [&]() {
       binary_kernel_vec(iter,
         [=](scalar_t a, scalar_t b) __ubsan_ignore_float_divide_by_zero__ -> scalar_t {
            return a / b;
         },
-        [=](Vec256<scalar_t> a, Vec256<scalar_t> b) {
+        [=](Vectorized<scalar_t> a, Vectorized<scalar_t> b) {
           return a / b;
         });
     });
@@ -0,0 +1,85 @@
+#include "ATen/native/ConvolutionCPU.h"
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+#include <algorithm>
+
+namespace at { namespace native { namespace {
+
+using namespace vec256;
+
+// The range [begin, end) of output columns whose input column
+// ow * stride - pad + k lies in [0, width).
+static inline void valid_range(
+    int64_t width, int64_t out_width, int64_t stride, int64_t pad, int64_t k,
+    int64_t* begin, int64_t* end) {
+  const int64_t offset = pad - k;
+  *begin = offset > 0 ? std::min(out_width, (offset + stride - 1) / stride) : 0;
+  *end = std::min(out_width, std::max(*begin, (width + offset + stride - 1) / stride));
+}
+
+// Accumulates each of the 9 taps over whole output rows, so that with a stride
+// of 1 the input and output rows are both read contiguously.
+static void depthwise3x3_kernel(
+    Tensor& output, const Tensor& input, const Tensor& weight, const Tensor& bias,
+    IntList stride, IntList padding) {
+  const int64_t C = input.size(1);
+  const int64_t H = input.size(2);
+  const int64_t W = input.size(3);
+  const int64_t OH = output.size(2);
+  const int64_t OW = output.size(3);
+  const int64_t sH = stride[0];
+  const int64_t sW = stride[1];
+  const int64_t pH = padding[0];
+  const int64_t pW = padding[1];
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "depthwise3x3", [&] {
+    using Vec = Vec256<scalar_t>;
+    const scalar_t* in_data = input.data<scalar_t>();
+    const scalar_t* w_data = weight.data<scalar_t>();
+    const scalar_t* b_data = bias.defined() ? bias.data<scalar_t>() : nullptr;
+    scalar_t* out_data = output.data<scalar_t>();
+    parallel_for(0, input.size(0) * C, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t plane = begin; plane < end; plane++) {
+        const int64_t c = plane % C;
+        const scalar_t* in = in_data + plane * H * W;
+        const scalar_t* w = w_data + c * 9;
+        scalar_t* out = out_data + plane * OH * OW;
+        std::fill(out, out + OH * OW, b_data ? b_data[c] : scalar_t(0));
+        for (int64_t kw = 0; kw < 3; kw++) {
+          int64_t ow_begin, ow_end;
+          valid_range(W, OW, sW, pW, kw, &ow_begin, &ow_end);
+          for (int64_t oh = 0; oh < OH; oh++) {
+            scalar_t* out_row = out + oh * OW;
+            for (int64_t kh = 0; kh < 3; kh++) {
+              const int64_t ih = oh * sH - pH + kh;
+              if (ih < 0 || ih >= H) {
+                continue;
+              }
+              const scalar_t wv = w[kh * 3 + kw];
+              const scalar_t* in_row = in + ih * W - pW + kw;
+              int64_t ow = ow_begin;
+              if (sW == 1) {
+                const Vec vw(wv);
+                for (; ow + Vec::size <= ow_end; ow += Vec::size) {
+                  const Vec x = Vec::loadu(in_row + ow);
+                  (Vec::loadu(out_row + ow) + x * vw).store(out_row + ow);
+                }
+              }
+              for (; ow < ow_end; ow++) {
+                out_row[ow] += in_row[ow * sW] * wv;
+              }
+            }
+          }
+        }
+      }
+    });
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(depthwise3x3_stub, &depthwise3x3_kernel);
+
+}} // namespace at::native
@@ -0,0 +1,119 @@
+#include "ATen/native/Copy.h"
+
+#include <algorithm>
+#include <cstring>
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+#include "ATen/native/TensorIterator.h"
+
+namespace at { namespace native {
+namespace {
+
+using namespace vec256;
+
+// Side of the square tiles of transposed copies, in elements. The rows of
+// a source and a destination tile (32 x 32 doubles are 8KB each) stay in
+// L1 while the tile is copied.
+constexpr int64_t kTileSize = 32;
+
+template <typename dst_t, typename src_t>
+static inline void copy_contiguous(dst_t* dst, const src_t* src, int64_t n) {
+  for (int64_t i = 0; i < n; i++) {
+    dst[i] = convert<dst_t, src_t>(src[i]);
+  }
+}
+
+template <typename scalar_t>
+static inline void copy_contiguous(scalar_t* dst, const scalar_t* src, int64_t n) {
+  std::memcpy(dst, src, n * sizeof(scalar_t));
+}
+
+static inline void copy_contiguous(float* dst, const Half* src, int64_t n) {
+  vec256::convert(src, dst, n);
+}
+
+static inline void copy_contiguous(Half* dst, const float* src, int64_t n) {
+  vec256::convert(src, dst, n);
+}
+
+template <typename dst_t, typename src_t>
+static void copy_loop(char** data, const int64_t* strides, int64_t n) {
+  char* dst = data[0];
+  const char* src = data[1];
+  int64_t s0 = strides[0], s1 = strides[1];
+  if (s0 == sizeof(dst_t) && s1 == sizeof(src_t)) {
+    copy_contiguous((dst_t*)dst, (const src_t*)src, n);
+  } else if (s0 == sizeof(dst_t) && s1 == 0) {
+    std::fill_n((dst_t*)dst, n, convert<dst_t, src_t>(*(const src_t*)src));
+  } else {
+    for (int64_t i = 0; i < n; i++) {
+      *(dst_t*)(dst + i * s0) = convert<dst_t, src_t>(*(const src_t*)(src + i * s1));
+    }
+  }
+}
+
+// The iterator orders the dimensions by the strides of dst, so a transposed
+// copy (e.g. `contiguous()` of `t()`) ends up with dst contiguous along
+// dimension 0 and src contiguous along dimension 1. Walking dimension 0 in
+// the inner loop then reads every element of src from a different cache
+// line; transposed_copy walks the tensors in tiles instead.
+static bool is_transposed_2d(const TensorIterator& iter, int64_t dst_size, int64_t src_size) {
+  if (iter.ndim() != 2 || iter.shape()[0] < kTileSize || iter.shape()[1] < kTileSize) {
+    return false;
+  }
+  auto dst_strides = iter.strides(0);
+  auto src_strides = iter.strides(1);
+  return dst_strides[0] == dst_size && src_strides[1] == src_size &&
+         src_strides[0] != src_size && src_strides[0] != 0;
+}
+
+template <typename dst_t, typename src_t>
+static void transposed_copy(TensorIterator& iter) {
+  char* dst = (char*)iter.data_ptr(0);
+  const char* src = (const char*)iter.data_ptr(1);
+  const int64_t size0 = iter.shape()[0];
+  const int64_t size1 = iter.shape()[1];
+  const int64_t dst_stride1 = iter.strides(0)[1];
+  const int64_t src_stride0 = iter.strides(1)[0];
+  const int64_t num_tiles1 = divup(size1, kTileSize);
+  const int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / (kTileSize * size0));
+
+  parallel_for(0, num_tiles1, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t t1 = begin; t1 < end; t1++) {
+      const int64_t j_begin = t1 * kTileSize;
+      const int64_t j_end = std::min(size1, j_begin + kTileSize);
+      for (int64_t i_begin = 0; i_begin < size0; i_begin += kTileSize) {
+        const int64_t i_end = std::min(size0, i_begin + kTileSize);
+        for (int64_t j = j_begin; j < j_end; j++) {
+          dst_t* dst_row = (dst_t*)(dst + j * dst_stride1);
+          const char* src_col = src + j * sizeof(src_t);
+          for (int64_t i = i_begin; i < i_end; i++) {
+            dst_row[i] = convert<dst_t, src_t>(*(const src_t*)(src_col + i * src_stride0));
+          }
+        }
+      }
+    }
+  });
+}
+
+void copy_kernel(TensorIterator& iter) {
+  AT_DISPATCH_ALL_TYPES_AND_HALF(iter.type(0), "copy", [&]() {
+    using dst_t = scalar_t;
+    AT_DISPATCH_ALL_TYPES_AND_HALF(iter.type(1), "copy", [&]() {
+      if (is_transposed_2d(iter, sizeof(dst_t), sizeof(scalar_t))) {
+        transposed_copy<dst_t, scalar_t>(iter);
+      } else {
+        iter.for_each([](int ntensor, char** data, const int64_t* strides, int64_t n) {
+          copy_loop<dst_t, scalar_t>(data, strides, n);
+        });
+      }
+    });
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(copy_stub, &copy_kernel);
+
+}} // namespace at::native
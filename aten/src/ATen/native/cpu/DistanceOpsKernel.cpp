@@ -0,0 +1,232 @@
+#include "ATen/native/Distance.h"
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace at { namespace native { namespace {
+
+using namespace vec256;
+
+// Rows of x1 are split over the threads, and every thread walks x2 in tiles of
+// this many rows, which stay in cache while they are compared to all of its
+// rows of x1.
+constexpr int64_t kTileRows = 64;
+
+// The norms of cdist. map turns a difference into its contribution, which
+// red accumulates, and finish maps the accumulated value to the distance.
+// The differences are vectorized over the features, so map and red take
+// either vectors or scalars.
+template <typename scalar_t>
+struct Dist {
+  using Vec = Vec256<scalar_t>;
+
+  // p = 0: the number of differing features
+  struct zero {
+    static inline Vec map(const Vec& diff, const Vec& p) {
+      scalar_t buf[Vec::size];
+      diff.store(buf);
+      for (int i = 0; i < Vec::size; i++) {
+        buf[i] = buf[i] != 0 ? scalar_t(1) : scalar_t(0);
+      }
+      return Vec::loadu(buf);
+    }
+    static inline scalar_t map(scalar_t diff, scalar_t p) { return diff != 0 ? 1 : 0; }
+    static inline Vec red(const Vec& agg, const Vec& up) { return agg + up; }
+    static inline scalar_t red(scalar_t agg, scalar_t up) { return agg + up; }
+    static inline scalar_t finish(scalar_t agg, scalar_t p) { return agg; }
+  };
+
+  // p = 1
+  struct one {
+    static inline Vec map(const Vec& diff, const Vec& p) { return diff.abs(); }
+    static inline scalar_t map(scalar_t diff, scalar_t p) { return std::abs(diff); }
+    static inline Vec red(const Vec& agg, const Vec& up) { return agg + up; }
+    static inline scalar_t red(scalar_t agg, scalar_t up) { return agg + up; }
+    static inline scalar_t finish(scalar_t agg, scalar_t p) { return agg; }
+  };
+
+  // p = 2
+  struct two {
+    static inline Vec map(const Vec& diff, const Vec& p) { return diff * diff; }
+    static inline scalar_t map(scalar_t diff, scalar_t p) { return diff * diff; }
+    static inline Vec red(const Vec& agg, const Vec& up) { return agg + up; }
+    static inline scalar_t red(scalar_t agg, scalar_t up) { return agg + up; }
+    static inline scalar_t finish(scalar_t agg, scalar_t p) { return std::sqrt(agg); }
+  };
+
+  // p = infinity: the largest difference
+  struct inf {
+    static inline Vec map(const Vec& diff, const Vec& p) { return diff.abs(); }
+    static inline scalar_t map(scalar_t diff, scalar_t p) { return std::abs(diff); }
+    static inline Vec red(const Vec& agg, const Vec& up) { return max(agg, up); }
+    static inline scalar_t red(scalar_t agg, scalar_t up) { return std::max(agg, up); }
+    static inline scalar_t finish(scalar_t agg, scalar_t p) { return agg; }
+  };
+
+  // any other p; |diff|^p is exp(p * log|diff|), which is 0 for diff = 0
+  struct general {
+    static inline Vec map(const Vec& diff, const Vec& p) { return (diff.abs().log() * p).exp(); }
+    static inline scalar_t map(scalar_t diff, scalar_t p) { return std::pow(std::abs(diff), p); }
+    static inline Vec red(const Vec& agg, const Vec& up) { return agg + up; }
+    static inline scalar_t red(scalar_t agg, scalar_t up) { return agg + up; }
+    static inline scalar_t finish(scalar_t agg, scalar_t p) { return std::pow(agg, 1 / p); }
+  };
+
+  template <typename F>
+  static scalar_t distance(const scalar_t* a, const scalar_t* b, int64_t D, scalar_t p) {
+    const Vec pvec(p);
+    Vec agg(0);
+    int64_t d = 0;
+    for (; d + Vec::size <= D; d += Vec::size) {
+      agg = F::red(agg, F::map(Vec::loadu(a + d) - Vec::loadu(b + d), pvec));
+    }
+    scalar_t buf[Vec::size];
+    agg.store(buf);
+    scalar_t result = 0;
+    for (int i = 0; i < Vec::size; i++) {
+      result = F::red(result, buf[i]);
+    }
+    for (; d < D; d++) {
+      result = F::red(result, F::map(a[d] - b[d], p));
+    }
+    return F::finish(result, p);
+  }
+
+  template <typename F>
+  static void run(Tensor& result, const Tensor& x1, const Tensor& x2, scalar_t p) {
+    const int64_t N = x1.size(0);
+    const int64_t M = x2.size(0);
+    const int64_t D = x1.size(1);
+    const scalar_t* x1_data = x1.data<scalar_t>();
+    const scalar_t* x2_data = x2.data<scalar_t>();
+    scalar_t* res = result.data<scalar_t>();
+    const int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / (M * D));
+    parallel_for(0, N, grain_size, [&](int64_t begin, int64_t end) {
+      for (int64_t j0 = 0; j0 < M; j0 += kTileRows) {
+        const int64_t j1 = std::min(j0 + kTileRows, M);
+        for (int64_t i = begin; i < end; i++) {
+          for (int64_t j = j0; j < j1; j++) {
+            res[i * M + j] = distance<F>(x1_data + i * D, x2_data + j * D, D, p);
+          }
+        }
+      }
+    });
+  }
+
+  static void apply(Tensor& result, const Tensor& x1, const Tensor& x2, double p) {
+    if (p == 0.0) {
+      run<zero>(result, x1, x2, p);
+    } else if (p == 1.0) {
+      run<one>(result, x1, x2, p);
+    } else if (p == 2.0) {
+      run<two>(result, x1, x2, p);
+    } else if (std::isinf(p)) {
+      run<inf>(result, x1, x2, p);
+    } else {
+      run<general>(result, x1, x2, p);
+    }
+  }
+
+  // d dist / d diff for the norms with a gradient
+  struct one_grad {
+    static inline scalar_t grad(scalar_t diff, scalar_t dist, scalar_t p) {
+      return diff > 0 ? 1 : (diff < 0 ? -1 : 0);
+    }
+  };
+
+  struct two_grad {
+    static inline scalar_t grad(scalar_t diff, scalar_t dist, scalar_t p) {
+      return dist == 0 ? 0 : diff / dist;
+    }
+  };
+
+  struct inf_grad {
+    static inline scalar_t grad(scalar_t diff, scalar_t dist, scalar_t p) {
+      return std::abs(diff) == dist ? (diff > 0 ? 1 : (diff < 0 ? -1 : 0)) : 0;
+    }
+  };
+
+  struct general_grad {
+    static inline scalar_t grad(scalar_t diff, scalar_t dist, scalar_t p) {
+      if (dist == 0 || diff == 0) {
+        return 0;
+      }
+      scalar_t g = std::pow(std::abs(diff) / dist, p - 1);
+      return diff > 0 ? g : -g;
+    }
+  };
+
+  template <typename F>
+  static void run_backward(
+      Tensor& grad_x1, const Tensor& grad, const Tensor& x1, const Tensor& x2,
+      scalar_t p, const Tensor& cdist) {
+    const int64_t N = x1.size(0);
+    const int64_t M = x2.size(0);
+    const int64_t D = x1.size(1);
+    const scalar_t* x1_data = x1.data<scalar_t>();
+    const scalar_t* x2_data = x2.data<scalar_t>();
+    const scalar_t* grad_data = grad.data<scalar_t>();
+    const scalar_t* dist_data = cdist.data<scalar_t>();
+    scalar_t* out = grad_x1.data<scalar_t>();
+    const int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / (M * D));
+    // every thread owns its rows of grad_x1, so there is nothing to reduce
+    // across threads
+    parallel_for(0, N, grain_size, [&](int64_t begin, int64_t end) {
+      std::fill(out + begin * D, out + end * D, scalar_t(0));
+      for (int64_t j0 = 0; j0 < M; j0 += kTileRows) {
+        const int64_t j1 = std::min(j0 + kTileRows, M);
+        for (int64_t i = begin; i < end; i++) {
+          const scalar_t* a = x1_data + i * D;
+          scalar_t* g = out + i * D;
+          for (int64_t j = j0; j < j1; j++) {
+            const scalar_t* b = x2_data + j * D;
+            const scalar_t gij = grad_data[i * M + j];
+            const scalar_t dist = dist_data[i * M + j];
+            for (int64_t d = 0; d < D; d++) {
+              g[d] += gij * F::grad(a[d] - b[d], dist, p);
+            }
+          }
+        }
+      }
+    });
+  }
+
+  static void apply_backward(
+      Tensor& grad_x1, const Tensor& grad, const Tensor& x1, const Tensor& x2,
+      double p, const Tensor& cdist) {
+    if (p == 1.0) {
+      run_backward<one_grad>(grad_x1, grad, x1, x2, p, cdist);
+    } else if (p == 2.0) {
+      run_backward<two_grad>(grad_x1, grad, x1, x2, p, cdist);
+    } else if (std::isinf(p)) {
+      run_backward<inf_grad>(grad_x1, grad, x1, x2, p, cdist);
+    } else {
+      run_backward<general_grad>(grad_x1, grad, x1, x2, p, cdist);
+    }
+  }
+};
+
+void cdist_kernel_impl(Tensor& result, const Tensor& x1, const Tensor& x2, double p) {
+  AT_DISPATCH_FLOATING_TYPES(result.type(), "cdist", [&] {
+    Dist<scalar_t>::apply(result, x1, x2, p);
+  });
+}
+
+void cdist_backward_kernel_impl(
+    Tensor& grad_x1, const Tensor& grad, const Tensor& x1, const Tensor& x2,
+    double p, const Tensor& cdist) {
+  AT_DISPATCH_FLOATING_TYPES(grad_x1.type(), "cdist_backward", [&] {
+    Dist<scalar_t>::apply_backward(grad_x1, grad, x1, x2, p, cdist);
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(cdist_stub, &cdist_kernel_impl);
+REGISTER_DISPATCH(cdist_backward_stub, &cdist_backward_kernel_impl);
+
+}} // namespace at::native
@@ -0,0 +1,155 @@
+#include "ATen/native/cpu/EmbeddingBagKernel.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/native/cpu/Vectorized.h"
+
+namespace at { namespace native { namespace {
+
+using namespace vec;
+
+// out[0:n] += alpha * in[0:n * stride:stride]
+template <typename scalar_t>
+static inline void axpy(int64_t n, scalar_t alpha, const scalar_t* in, int64_t stride, scalar_t* out) {
+  using Vec = Vectorized<scalar_t>;
+  int64_t d = 0;
+  if (stride == 1) {
+    Vec alpha_vec(alpha);
+    for (; d + Vec::size <= n; d += Vec::size) {
+      Vec out_vec = fmadd(alpha_vec, Vec::loadu(in + d), Vec::loadu(out + d));
+      out_vec.store(out + d);
+    }
+  }
+  for (; d < n; d++) {
+    out[d] += alpha * in[d * stride];
+  }
+}
+
+// Every bag reads its rows of `weight` straight into its output row, so
+// nothing is materialized per index and the bags can run in parallel.
+template <typename scalar_t>
+static void embedding_bag_sum_kernel(
+    Tensor& output, const Tensor& weight, const Tensor& indices,
+    const Tensor& offsets, const Tensor& per_sample_weights, bool mean) {
+  int64_t num_bags = offsets.numel();
+  int64_t num_indices = indices.numel();
+  int64_t ddim = weight.size(1);
+  auto weight_stride0 = weight.stride(0);
+  auto weight_stride1 = weight.stride(1);
+  auto weight_data = weight.data<scalar_t>();
+  auto output_data = output.data<scalar_t>();
+  auto indices_data = indices.data<int64_t>();
+  auto offsets_data = offsets.data<int64_t>();
+  const scalar_t* psw_data = nullptr;
+  int64_t psw_stride = 0;
+  if (per_sample_weights.defined()) {
+    psw_data = per_sample_weights.data<scalar_t>();
+    psw_stride = per_sample_weights.stride(0);
+  }
+
+  // Roughly GRAIN_SIZE multiply-adds per task
+  int64_t work_per_bag = std::max<int64_t>(1, ddim * num_indices / std::max<int64_t>(1, num_bags));
+  int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / work_per_bag);
+
+  parallel_for(0, num_bags, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t bag = begin; bag < end; bag++) {
+      int64_t start = offsets_data[bag];
+      int64_t stop = bag + 1 < num_bags ? offsets_data[bag + 1] : num_indices;
+      scalar_t* out = output_data + bag * ddim;
+      std::fill(out, out + ddim, scalar_t(0));
+      for (int64_t i = start; i < stop; i++) {
+        scalar_t alpha = psw_data ? psw_data[i * psw_stride] : scalar_t(1);
+        axpy<scalar_t>(ddim, alpha, weight_data + indices_data[i] * weight_stride0, weight_stride1, out);
+      }
+      if (mean && stop > start) {
+        scalar_t scale = scalar_t(1) / (stop - start);
+        for (int64_t d = 0; d < ddim; d++) {
+          out[d] *= scale;
+        }
+      }
+    }
+  });
+}
+
+static void embedding_bag_sum_kernel_impl(
+    Tensor& output, const Tensor& weight, const Tensor& indices,
+    const Tensor& offsets, const Tensor& per_sample_weights, bool mean) {
+  AT_DISPATCH_FLOATING_TYPES(weight.type(), "embedding_bag_sum", [&] {
+    embedding_bag_sum_kernel<scalar_t>(output, weight, indices, offsets, per_sample_weights, mean);
+  });
+}
+
+template <int bit_rate>
+static void embedding_bag_rowwise_kernel(
+    Tensor& output, const Tensor& packed, const Tensor& indices,
+    const Tensor& offsets, const Tensor& per_sample_weights, bool mean) {
+  constexpr int elems_per_byte = 8 / bit_rate;
+  constexpr int mask = (1 << bit_rate) - 1;
+  int64_t num_bags = offsets.numel();
+  int64_t num_indices = indices.numel();
+  int64_t ddim = output.size(1);
+  int64_t row_bytes = packed.size(1);
+  auto packed_data = packed.data<uint8_t>();
+  auto output_data = output.data<float>();
+  auto indices_data = indices.data<int64_t>();
+  auto offsets_data = offsets.data<int64_t>();
+  const float* psw_data = nullptr;
+  int64_t psw_stride = 0;
+  if (per_sample_weights.defined()) {
+    psw_data = per_sample_weights.data<float>();
+    psw_stride = per_sample_weights.stride(0);
+  }
+
+  int64_t work_per_bag = std::max<int64_t>(1, ddim * num_indices / std::max<int64_t>(1, num_bags));
+  int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / work_per_bag);
+
+  parallel_for(0, num_bags, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t bag = begin; bag < end; bag++) {
+      int64_t start = offsets_data[bag];
+      int64_t stop = bag + 1 < num_bags ? offsets_data[bag + 1] : num_indices;
+      float* out = output_data + bag * ddim;
+      std::fill(out, out + ddim, 0.f);
+      for (int64_t i = start; i < stop; i++) {
+        const uint8_t* row = packed_data + indices_data[i] * row_bytes;
+        float scale, bias;
+        std::memcpy(&scale, row + row_bytes - 2 * sizeof(float), sizeof(float));
+        std::memcpy(&bias, row + row_bytes - sizeof(float), sizeof(float));
+        if (psw_data) {
+          scale *= psw_data[i * psw_stride];
+          bias *= psw_data[i * psw_stride];
+        }
+        for (int64_t d = 0; d < ddim; d++) {
+          int q = (row[d / elems_per_byte] >> ((d % elems_per_byte) * bit_rate)) & mask;
+          out[d] += scale * q + bias;
+        }
+      }
+      if (mean && stop > start) {
+        float scale = 1.f / (stop - start);
+        for (int64_t d = 0; d < ddim; d++) {
+          out[d] *= scale;
+        }
+      }
+    }
+  });
+}
+
+static void embedding_bag_rowwise_kernel_impl(
+    Tensor& output, const Tensor& packed, const Tensor& indices,
+    const Tensor& offsets, const Tensor& per_sample_weights, int64_t bit_rate,
+    bool mean) {
+  if (bit_rate == 8) {
+    embedding_bag_rowwise_kernel<8>(output, packed, indices, offsets, per_sample_weights, mean);
+  } else {
+    embedding_bag_rowwise_kernel<4>(output, packed, indices, offsets, per_sample_weights, mean);
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(embedding_bag_sum_stub, &embedding_bag_sum_kernel_impl);
+REGISTER_DISPATCH(embedding_bag_rowwise_stub, &embedding_bag_rowwise_kernel_impl);
+
+}} // namespace at::native
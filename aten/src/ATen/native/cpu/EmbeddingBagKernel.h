@@ -0,0 +1,30 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// Sums (or averages, if `mean` is set) the rows of `weight` selected by
+// `indices` for every bag given by `offsets`, and writes bag i to row i of
+// the contiguous `output`. Empty bags are zero. If `per_sample_weights` is
+// defined, every row is scaled by its entry first. `indices` and `offsets`
+// must be contiguous and the indices in range.
+using embedding_bag_sum_fn = void(*)(
+    Tensor& output, const Tensor& weight, const Tensor& indices,
+    const Tensor& offsets, const Tensor& per_sample_weights, bool mean);
+
+DECLARE_DISPATCH(embedding_bag_sum_fn, embedding_bag_sum_stub);
+
+// Like embedding_bag_sum_fn, but reads the rows from a table `packed` by
+// _embedding_bag_pack_rowwise with the given bit rate, and writes them into
+// the contiguous float `output`. See Note [Row-wise quantized embeddings] in
+// EmbeddingBag.cpp.
+using embedding_bag_rowwise_fn = void(*)(
+    Tensor& output, const Tensor& packed, const Tensor& indices,
+    const Tensor& offsets, const Tensor& per_sample_weights, int64_t bit_rate,
+    bool mean);
+
+DECLARE_DISPATCH(embedding_bag_rowwise_fn, embedding_bag_rowwise_stub);
+
+}} // namespace at::native
@@ -0,0 +1,84 @@
+#include "ATen/native/FusedOptimizers.h"
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+
+namespace at { namespace native { namespace {
+
+// The CPU kernels only save the temporaries of the unfused step: every
+// parameter is still updated separately, in a single pass over its elements.
+
+static void fused_sgd_kernel(
+    TensorList params, TensorList grads, TensorList momentum_buffers,
+    double lr, double momentum, double dampening, double weight_decay,
+    bool nesterov) {
+  for (size_t i = 0; i < params.size(); i++) {
+    AT_DISPATCH_FLOATING_TYPES(params[i].type(), "fused_sgd", [&] {
+      auto param_data = params[i].data<scalar_t>();
+      auto grad_data = grads[i].data<scalar_t>();
+      auto buf_data = momentum_buffers.empty() ? nullptr : momentum_buffers[i].data<scalar_t>();
+      parallel_for(0, params[i].numel(), internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+        for (int64_t j = begin; j < end; j++) {
+          detail::sgd_update<scalar_t>(
+              param_data[j], grad_data[j], buf_data ? buf_data + j : nullptr,
+              lr, momentum, dampening, weight_decay, nesterov);
+        }
+      });
+    });
+  }
+}
+
+static void fused_adam_kernel(
+    TensorList params, TensorList grads, TensorList exp_avgs,
+    TensorList exp_avg_sqs, TensorList max_exp_avg_sqs, double step_size,
+    double beta1, double beta2, double eps, double weight_decay, bool amsgrad) {
+  for (size_t i = 0; i < params.size(); i++) {
+    AT_DISPATCH_FLOATING_TYPES(params[i].type(), "fused_adam", [&] {
+      auto param_data = params[i].data<scalar_t>();
+      auto grad_data = grads[i].data<scalar_t>();
+      auto exp_avg_data = exp_avgs[i].data<scalar_t>();
+      auto exp_avg_sq_data = exp_avg_sqs[i].data<scalar_t>();
+      auto max_exp_avg_sq_data = amsgrad ? max_exp_avg_sqs[i].data<scalar_t>() : nullptr;
+      parallel_for(0, params[i].numel(), internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+        for (int64_t j = begin; j < end; j++) {
+          detail::adam_update<scalar_t>(
+              param_data[j], grad_data[j], exp_avg_data[j], exp_avg_sq_data[j],
+              max_exp_avg_sq_data ? max_exp_avg_sq_data + j : nullptr,
+              step_size, beta1, beta2, eps, weight_decay);
+        }
+      });
+    });
+  }
+}
+
+static void fused_rmsprop_kernel(
+    TensorList params, TensorList grads, TensorList square_avgs,
+    TensorList momentum_buffers, TensorList grad_avgs, double lr, double alpha,
+    double eps, double weight_decay, double momentum, bool centered) {
+  for (size_t i = 0; i < params.size(); i++) {
+    AT_DISPATCH_FLOATING_TYPES(params[i].type(), "fused_rmsprop", [&] {
+      auto param_data = params[i].data<scalar_t>();
+      auto grad_data = grads[i].data<scalar_t>();
+      auto square_avg_data = square_avgs[i].data<scalar_t>();
+      auto buf_data = momentum_buffers.empty() ? nullptr : momentum_buffers[i].data<scalar_t>();
+      auto grad_avg_data = centered ? grad_avgs[i].data<scalar_t>() : nullptr;
+      parallel_for(0, params[i].numel(), internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+        for (int64_t j = begin; j < end; j++) {
+          detail::rmsprop_update<scalar_t>(
+              param_data[j], grad_data[j], square_avg_data[j],
+              buf_data ? buf_data + j : nullptr,
+              grad_avg_data ? grad_avg_data + j : nullptr,
+              lr, alpha, eps, weight_decay, momentum);
+        }
+      });
+    });
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(fused_sgd_stub, &fused_sgd_kernel);
+REGISTER_DISPATCH(fused_adam_stub, &fused_adam_kernel);
+REGISTER_DISPATCH(fused_rmsprop_stub, &fused_rmsprop_kernel);
+
+}} // namespace at::native
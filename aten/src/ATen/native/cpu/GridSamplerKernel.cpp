@@ -0,0 +1,406 @@
+#include "ATen/native/cpu/GridSamplerKernel.h"
+
+#include "ATen/Dispatch.h"
+#include "ATen/MemoryFormat.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+#include "ATen/native/GridSampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// The source coordinates and interpolation weights of an output row are
+// computed once, into structure-of-arrays buffers, and then reused for every
+// channel. Corners that fall outside the input are flagged instead of tested
+// in the loops over the channels.
+//
+// Contiguous tensors are sampled a row at a time for each channel, with the
+// loops over the row innermost; they run without branches so that the
+// compiler vectorizes them in the AVX and AVX2 builds of this file.
+// Channels-last tensors are sampled a pixel at a time, with Vec256 loops over
+// the channels. The forward pass and grad_grid run in parallel over the N *
+// out_H output rows. grad_input is a scatter, so it runs in parallel over the
+// N * C planes instead, each thread owning the channels it writes to.
+//
+// Every sum is taken in the same order as in the scalar kernel this replaces,
+// except for grad_grid of channels-last tensors, which is summed over the
+// channels a vector at a time.
+
+namespace at { namespace native { namespace {
+
+using namespace vec256;
+using at::native::detail::GridSamplerInterpolation;
+using at::native::detail::GridSamplerPadding;
+using at::native::detail::clip_coordinates_set_grad;
+using at::native::detail::reflect_coordinates_set_grad;
+
+// The number of rows or planes to run on a thread, given the work per item.
+static inline int64_t grain_size(int64_t work) {
+  return std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(1, work));
+}
+
+struct GridSampler2dShape {
+  int64_t N, C, inp_H, inp_W, out_H, out_W;
+};
+
+// The input pixels that the locations of one output row read: the nw, ne, sw
+// and se corners for bilinear interpolation, or the nearest pixel. A corner
+// outside the input has inside == 0 and offset 0, and doesn't contribute.
+// Offsets are in pixels, h * inp_W + w.
+template <typename scalar_t>
+struct RowCorners {
+  int64_t num_corners;
+  std::vector<int64_t> offset[4];
+  std::vector<uint8_t> inside[4];
+  std::vector<scalar_t> weight[4];
+  // For grad_grid: the linear weights along x and y, (ix_se - ix, ix - ix_nw)
+  // and (iy_se - iy, iy - iy_nw), and d(ix) / d(x), d(iy) / d(y) of the
+  // padding mode.
+  std::vector<scalar_t> wx0, wx1, wy0, wy1, gx_mult, gy_mult;
+
+  RowCorners(int64_t width, GridSamplerInterpolation interpolation)
+    : num_corners(interpolation == GridSamplerInterpolation::Bilinear ? 4 : 1),
+      wx0(width), wx1(width), wy0(width), wy1(width), gx_mult(width), gy_mult(width) {
+    for (int64_t k = 0; k < num_corners; k++) {
+      offset[k].resize(width);
+      inside[k].resize(width);
+      weight[k].resize(width);
+    }
+  }
+
+  void set_corner(int64_t k, int64_t w, int64_t y, int64_t x, int64_t H, int64_t W, scalar_t wt) {
+    const bool in = y >= 0 && y < H && x >= 0 && x < W;
+    inside[k][w] = in;
+    offset[k][w] = in ? y * W + x : 0;
+    weight[k][w] = wt;
+  }
+
+  // grid_row holds the (x, y) coordinates of the row.
+  void compute(const scalar_t* grid_row, int64_t inp_H, int64_t inp_W, GridSamplerPadding padding) {
+    const int64_t width = wx0.size();
+    for (int64_t w = 0; w < width; w++) {
+      // normalize ix, iy from [-1, 1] to [0, inp_W-1] & [0, inp_H-1]
+      scalar_t ix = ((grid_row[2 * w] + 1) / 2) * (inp_W - 1);
+      scalar_t iy = ((grid_row[2 * w + 1] + 1) / 2) * (inp_H - 1);
+      scalar_t gx = 1, gy = 1;
+      if (padding == GridSamplerPadding::Border) {
+        ix = clip_coordinates_set_grad(ix, inp_W, &gx);
+        iy = clip_coordinates_set_grad(iy, inp_H, &gy);
+      } else if (padding == GridSamplerPadding::Reflection) {
+        ix = reflect_coordinates_set_grad(ix, inp_W, &gx);
+        iy = reflect_coordinates_set_grad(iy, inp_H, &gy);
+      }
+      gx_mult[w] = gx;
+      gy_mult[w] = gy;
+
+      if (num_corners == 1) {
+        set_corner(0, w, static_cast<int64_t>(std::round(iy)), static_cast<int64_t>(std::round(ix)),
+                   inp_H, inp_W, 1);
+        continue;
+      }
+      const int64_t ix_nw = static_cast<int64_t>(std::floor(ix));
+      const int64_t iy_nw = static_cast<int64_t>(std::floor(iy));
+      wx0[w] = (ix_nw + 1) - ix;
+      wx1[w] = ix - ix_nw;
+      wy0[w] = (iy_nw + 1) - iy;
+      wy1[w] = iy - iy_nw;
+      set_corner(0, w, iy_nw, ix_nw, inp_H, inp_W, wx0[w] * wy0[w]);
+      set_corner(1, w, iy_nw, ix_nw + 1, inp_H, inp_W, wx1[w] * wy0[w]);
+      set_corner(2, w, iy_nw + 1, ix_nw, inp_H, inp_W, wx0[w] * wy1[w]);
+      set_corner(3, w, iy_nw + 1, ix_nw + 1, inp_H, inp_W, wx1[w] * wy1[w]);
+    }
+  }
+};
+
+// The value of corner k of location w in a contiguous plane, 0 outside.
+template <typename scalar_t>
+static inline scalar_t corner_value(
+    const scalar_t* in, const RowCorners<scalar_t>& r, int64_t k, int64_t w) {
+  return r.inside[k][w] ? in[r.offset[k][w]] : scalar_t(0);
+}
+
+// One channel of an output row, from the contiguous input plane `in`.
+template <typename scalar_t>
+static void sample_row(scalar_t* out, const scalar_t* in, const RowCorners<scalar_t>& r, int64_t width) {
+  if (r.num_corners == 1) {
+    for (int64_t w = 0; w < width; w++) {
+      out[w] = corner_value(in, r, 0, w);
+    }
+    return;
+  }
+  const scalar_t* w0 = r.weight[0].data();
+  const scalar_t* w1 = r.weight[1].data();
+  const scalar_t* w2 = r.weight[2].data();
+  const scalar_t* w3 = r.weight[3].data();
+  for (int64_t w = 0; w < width; w++) {
+    out[w] = corner_value(in, r, 0, w) * w0[w] + corner_value(in, r, 1, w) * w1[w] +
+             corner_value(in, r, 2, w) * w2[w] + corner_value(in, r, 3, w) * w3[w];
+  }
+}
+
+// The C channels of output pixel w, from the channels-last input image `in`.
+template <typename scalar_t>
+static void sample_pixel_channels_last(
+    scalar_t* out, const scalar_t* in, const RowCorners<scalar_t>& r, int64_t w, int64_t C) {
+  using Vec = Vec256<scalar_t>;
+  for (int64_t c = 0; c < C; c += Vec::size) {
+    const int64_t count = std::min(static_cast<int64_t>(Vec::size), C - c);
+    Vec sum(0);
+    for (int64_t k = 0; k < r.num_corners; k++) {
+      if (r.inside[k][w]) {
+        sum = sum + Vec::loadu(in + r.offset[k][w] * C + c, count) * Vec(r.weight[k][w]);
+      }
+    }
+    sum.store(out + c, count);
+  }
+}
+
+template <typename scalar_t>
+static void grid_sampler_2d_forward(
+    scalar_t* output, const scalar_t* input, const scalar_t* grid, const GridSampler2dShape& s,
+    GridSamplerInterpolation interpolation, GridSamplerPadding padding, bool channels_last) {
+  const int64_t inp_HW = s.inp_H * s.inp_W;
+  parallel_for(0, s.N * s.out_H, grain_size(s.out_W * s.C), [&](int64_t begin, int64_t end) {
+    RowCorners<scalar_t> r(s.out_W, interpolation);
+    for (int64_t nh = begin; nh < end; nh++) {
+      const int64_t n = nh / s.out_H;
+      const int64_t h = nh % s.out_H;
+      r.compute(grid + nh * s.out_W * 2, s.inp_H, s.inp_W, padding);
+      if (channels_last) {
+        for (int64_t w = 0; w < s.out_W; w++) {
+          sample_pixel_channels_last(
+              output + (nh * s.out_W + w) * s.C, input + n * inp_HW * s.C, r, w, s.C);
+        }
+      } else {
+        for (int64_t c = 0; c < s.C; c++) {
+          sample_row(output + ((n * s.C + c) * s.out_H + h) * s.out_W,
+                     input + (n * s.C + c) * inp_HW, r, s.out_W);
+        }
+      }
+    }
+  });
+}
+
+// Adds one channel's share of d(loss) / d(ix) and d(loss) / d(iy) along an
+// output row to gx and gy.
+template <typename scalar_t>
+static void grid_grad_row(
+    scalar_t* gx, scalar_t* gy, const scalar_t* grad_out, const scalar_t* in,
+    const RowCorners<scalar_t>& r, int64_t width) {
+  const scalar_t* wx0 = r.wx0.data();
+  const scalar_t* wx1 = r.wx1.data();
+  const scalar_t* wy0 = r.wy0.data();
+  const scalar_t* wy1 = r.wy1.data();
+  for (int64_t w = 0; w < width; w++) {
+    const scalar_t g = grad_out[w];
+    const scalar_t nw = corner_value(in, r, 0, w);
+    const scalar_t ne = corner_value(in, r, 1, w);
+    const scalar_t sw = corner_value(in, r, 2, w);
+    const scalar_t se = corner_value(in, r, 3, w);
+    gx[w] = gx[w] - nw * wy0[w] * g + ne * wy0[w] * g - sw * wy1[w] * g + se * wy1[w] * g;
+    gy[w] = gy[w] - nw * wx0[w] * g - ne * wx1[w] * g + sw * wx0[w] * g + se * wx1[w] * g;
+  }
+}
+
+// d(loss) / d(ix) and d(loss) / d(iy) of output pixel w, summed over the C
+// channels of the channels-last grad_out pixel and input image.
+template <typename scalar_t>
+static void grid_grad_pixel_channels_last(
+    scalar_t* gx, scalar_t* gy, const scalar_t* grad_out, const scalar_t* in,
+    const RowCorners<scalar_t>& r, int64_t w, int64_t C) {
+  using Vec = Vec256<scalar_t>;
+  const scalar_t* corner[4];
+  for (int64_t k = 0; k < 4; k++) {
+    corner[k] = r.inside[k][w] ? in + r.offset[k][w] * C : nullptr;
+  }
+  // the lanes past a partial load are undefined, so the last channels are
+  // summed one at a time
+  const Vec zero(0);
+  Vec sum_x(0), sum_y(0);
+  int64_t c = 0;
+  for (; c + Vec::size <= C; c += Vec::size) {
+    Vec v[4];
+    for (int64_t k = 0; k < 4; k++) {
+      v[k] = corner[k] ? Vec::loadu(corner[k] + c) : zero;
+    }
+    const Vec g = Vec::loadu(grad_out + c);
+    sum_x = sum_x + ((v[1] - v[0]) * Vec(r.wy0[w]) + (v[3] - v[2]) * Vec(r.wy1[w])) * g;
+    sum_y = sum_y + ((v[2] - v[0]) * Vec(r.wx0[w]) + (v[3] - v[1]) * Vec(r.wx1[w])) * g;
+  }
+  scalar_t buf_x[Vec::size], buf_y[Vec::size];
+  sum_x.store(buf_x);
+  sum_y.store(buf_y);
+  scalar_t sx = 0, sy = 0;
+  for (int64_t i = 0; i < Vec::size; i++) {
+    sx += buf_x[i];
+    sy += buf_y[i];
+  }
+  for (; c < C; c++) {
+    scalar_t v[4];
+    for (int64_t k = 0; k < 4; k++) {
+      v[k] = corner[k] ? corner[k][c] : scalar_t(0);
+    }
+    sx += ((v[1] - v[0]) * r.wy0[w] + (v[3] - v[2]) * r.wy1[w]) * grad_out[c];
+    sy += ((v[2] - v[0]) * r.wx0[w] + (v[3] - v[1]) * r.wx1[w]) * grad_out[c];
+  }
+  *gx = sx;
+  *gy = sy;
+}
+
+// Scatters one channel of a grad_output row into the contiguous grad_input
+// plane.
+template <typename scalar_t>
+static void scatter_row(scalar_t* grad_in, const scalar_t* grad_out, const RowCorners<scalar_t>& r, int64_t width) {
+  for (int64_t w = 0; w < width; w++) {
+    const scalar_t g = grad_out[w];
+    for (int64_t k = 0; k < r.num_corners; k++) {
+      if (r.inside[k][w]) {
+        grad_in[r.offset[k][w]] += r.weight[k][w] * g;
+      }
+    }
+  }
+}
+
+// Scatters channels [c_begin, c_end) of grad_output pixel w into the
+// channels-last grad_input image.
+template <typename scalar_t>
+static void scatter_pixel_channels_last(
+    scalar_t* grad_in, const scalar_t* grad_out, const RowCorners<scalar_t>& r, int64_t w,
+    int64_t C, int64_t c_begin, int64_t c_end) {
+  using Vec = Vec256<scalar_t>;
+  for (int64_t k = 0; k < r.num_corners; k++) {
+    if (!r.inside[k][w]) {
+      continue;
+    }
+    scalar_t* gin = grad_in + r.offset[k][w] * C;
+    const Vec weight(r.weight[k][w]);
+    for (int64_t c = c_begin; c < c_end; c += Vec::size) {
+      const int64_t count = std::min(static_cast<int64_t>(Vec::size), c_end - c);
+      const Vec sum = Vec::loadu(gin + c, count) + weight * Vec::loadu(grad_out + c, count);
+      sum.store(gin + c, count);
+    }
+  }
+}
+
+template <typename scalar_t>
+static void grid_sampler_2d_backward(
+    scalar_t* grad_input, scalar_t* grad_grid, const scalar_t* grad_output,
+    const scalar_t* input, const scalar_t* grid, const GridSampler2dShape& s,
+    GridSamplerInterpolation interpolation, GridSamplerPadding padding, bool channels_last) {
+  const int64_t inp_HW = s.inp_H * s.inp_W;
+  const int64_t out_HW = s.out_H * s.out_W;
+
+  // grad_grid, which nearest interpolation doesn't have
+  if (interpolation == GridSamplerInterpolation::Nearest) {
+    std::fill(grad_grid, grad_grid + s.N * out_HW * 2, scalar_t(0));
+  } else {
+    parallel_for(0, s.N * s.out_H, grain_size(s.out_W * s.C), [&](int64_t begin, int64_t end) {
+      RowCorners<scalar_t> r(s.out_W, interpolation);
+      std::vector<scalar_t> gx(s.out_W), gy(s.out_W);
+      for (int64_t nh = begin; nh < end; nh++) {
+        const int64_t n = nh / s.out_H;
+        const int64_t h = nh % s.out_H;
+        r.compute(grid + nh * s.out_W * 2, s.inp_H, s.inp_W, padding);
+        if (channels_last) {
+          for (int64_t w = 0; w < s.out_W; w++) {
+            grid_grad_pixel_channels_last(
+                &gx[w], &gy[w], grad_output + (nh * s.out_W + w) * s.C,
+                input + n * inp_HW * s.C, r, w, s.C);
+          }
+        } else {
+          std::fill(gx.begin(), gx.end(), scalar_t(0));
+          std::fill(gy.begin(), gy.end(), scalar_t(0));
+          for (int64_t c = 0; c < s.C; c++) {
+            grid_grad_row(gx.data(), gy.data(),
+                          grad_output + ((n * s.C + c) * s.out_H + h) * s.out_W,
+                          input + (n * s.C + c) * inp_HW, r, s.out_W);
+          }
+        }
+        scalar_t* ggrid = grad_grid + nh * s.out_W * 2;
+        for (int64_t w = 0; w < s.out_W; w++) {
+          // un-normalize grad_grid values back to [-1, 1] constraints
+          ggrid[2 * w] = r.gx_mult[w] * (gx[w] * (s.inp_W - 1) / 2);
+          ggrid[2 * w + 1] = r.gy_mult[w] * (gy[w] * (s.inp_H - 1) / 2);
+        }
+      }
+    });
+  }
+
+  // grad_input, in parallel over the channels of each image; a thread
+  // recomputes the corners of each row once for all of its channels.
+  parallel_for(0, s.N * s.C, grain_size(out_HW), [&](int64_t begin, int64_t end) {
+    RowCorners<scalar_t> r(s.out_W, interpolation);
+    for (int64_t nc = begin; nc < end;) {
+      const int64_t n = nc / s.C;
+      const int64_t c_begin = nc % s.C;
+      const int64_t c_end = std::min(s.C, c_begin + (end - nc));
+      nc += c_end - c_begin;
+      if (channels_last) {
+        scalar_t* gin = grad_input + n * inp_HW * s.C;
+        for (int64_t i = 0; i < inp_HW; i++) {
+          std::fill(gin + i * s.C + c_begin, gin + i * s.C + c_end, scalar_t(0));
+        }
+      } else {
+        std::fill(grad_input + (n * s.C + c_begin) * inp_HW,
+                  grad_input + (n * s.C + c_end) * inp_HW, scalar_t(0));
+      }
+      for (int64_t h = 0; h < s.out_H; h++) {
+        r.compute(grid + (n * s.out_H + h) * s.out_W * 2, s.inp_H, s.inp_W, padding);
+        if (channels_last) {
+          for (int64_t w = 0; w < s.out_W; w++) {
+            scatter_pixel_channels_last(
+                grad_input + n * inp_HW * s.C,
+                grad_output + ((n * s.out_H + h) * s.out_W + w) * s.C, r, w, s.C, c_begin, c_end);
+          }
+        } else {
+          for (int64_t c = c_begin; c < c_end; c++) {
+            scatter_row(grad_input + (n * s.C + c) * inp_HW,
+                        grad_output + ((n * s.C + c) * s.out_H + h) * s.out_W, r, s.out_W);
+          }
+        }
+      }
+    }
+  });
+}
+
+static GridSampler2dShape grid_sampler_2d_shape(const Tensor& input, const Tensor& grid) {
+  return {input.size(0), input.size(1), input.size(2), input.size(3), grid.size(1), grid.size(2)};
+}
+
+static bool is_channels_last_input(const Tensor& input) {
+  return suggest_memory_format(input.sizes(), input.strides()) == MemoryFormat::ChannelsLast;
+}
+
+static void grid_sampler_2d_kernel(
+    Tensor& output, const Tensor& input, const Tensor& grid,
+    int64_t interpolation_mode, int64_t padding_mode) {
+  const auto shape = grid_sampler_2d_shape(input, grid);
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "grid_sampler_2d", [&] {
+    grid_sampler_2d_forward(
+        output.data<scalar_t>(), input.data<scalar_t>(), grid.data<scalar_t>(), shape,
+        static_cast<GridSamplerInterpolation>(interpolation_mode),
+        static_cast<GridSamplerPadding>(padding_mode), is_channels_last_input(input));
+  });
+}
+
+static void grid_sampler_2d_backward_kernel(
+    Tensor& grad_input, Tensor& grad_grid, const Tensor& grad_output,
+    const Tensor& input, const Tensor& grid, int64_t interpolation_mode, int64_t padding_mode) {
+  const auto shape = grid_sampler_2d_shape(input, grid);
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "grid_sampler_2d_backward", [&] {
+    grid_sampler_2d_backward(
+        grad_input.data<scalar_t>(), grad_grid.data<scalar_t>(), grad_output.data<scalar_t>(),
+        input.data<scalar_t>(), grid.data<scalar_t>(), shape,
+        static_cast<GridSamplerInterpolation>(interpolation_mode),
+        static_cast<GridSamplerPadding>(padding_mode), is_channels_last_input(input));
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(grid_sampler_2d_stub, &grid_sampler_2d_kernel);
+REGISTER_DISPATCH(grid_sampler_2d_backward_stub, &grid_sampler_2d_backward_kernel);
+
+}} // namespace at::native
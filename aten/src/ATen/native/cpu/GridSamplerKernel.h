@@ -0,0 +1,25 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// 2d grid sampling of an (N, C, H, W) input at the contiguous
+// (N, out_H, out_W, 2) grid, with the interpolation_mode and padding_mode of
+// GridSampler.h. The input, output, grad_output and grad_input are all
+// contiguous, or all channels last (see Note [Channels last]); the layout is
+// taken from the input. grad_grid is contiguous. All outputs are already
+// allocated with the right sizes; grad_input doesn't need to be zeroed.
+using grid_sampler_2d_fn = void(*)(
+    Tensor& output, const Tensor& input, const Tensor& grid,
+    int64_t interpolation_mode, int64_t padding_mode);
+using grid_sampler_2d_backward_fn = void(*)(
+    Tensor& grad_input, Tensor& grad_grid, const Tensor& grad_output,
+    const Tensor& input, const Tensor& grid,
+    int64_t interpolation_mode, int64_t padding_mode);
+
+DECLARE_DISPATCH(grid_sampler_2d_fn, grid_sampler_2d_stub);
+DECLARE_DISPATCH(grid_sampler_2d_backward_fn, grid_sampler_2d_backward_stub);
+
+}} // namespace at::native
@@ -0,0 +1,72 @@
+#include "ATen/native/cpu/HashingKernel.h"
+
+#include <algorithm>
+
+#include "ATen/Parallel.h"
+
+namespace at { namespace native { namespace {
+
+static inline uint64_t fmix64(uint64_t k) {
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+// MurmurHash3_x64_128 of an 8 byte key has no body block, only a tail of a
+// single 64 bit word, which leaves straight line code per key that the
+// compiler vectorizes for every CPU_CAPABILITY.
+static void murmur3_hash64(const uint64_t* keys, int64_t n, uint64_t seed, uint64_t* hashes) {
+  const uint64_t c1 = 0x87c37b91114253d5ULL;
+  const uint64_t c2 = 0x4cf5ad432745937fULL;
+  for (int64_t i = 0; i < n; i++) {
+    uint64_t k1 = keys[i] * c1;
+    k1 = (k1 << 31) | (k1 >> 33);
+    k1 *= c2;
+    uint64_t h1 = (seed ^ k1) ^ 8;
+    uint64_t h2 = seed ^ 8;
+    h1 += h2;
+    h2 += h1;
+    hashes[i] = fmix64(h1) + fmix64(h2);
+  }
+}
+
+static void murmur3_hash_kernel(
+    Tensor& result, const Tensor& self, IntList seeds, int64_t modulo) {
+  // Hashed in chunks small enough for the keys and the hashes to stay in the
+  // L1 cache while they are hashed with every seed and bucketed.
+  constexpr int64_t chunk_size = 1024;
+  int64_t n = self.numel();
+  int64_t k = seeds.size();
+  auto keys = reinterpret_cast<const uint64_t*>(self.data<int64_t>());
+  auto out = reinterpret_cast<uint64_t*>(result.data<int64_t>());
+  uint64_t m = modulo;
+
+  parallel_for(0, n, std::max<int64_t>(chunk_size, internal::GRAIN_SIZE / k), [&](int64_t begin, int64_t end) {
+    uint64_t hashes[chunk_size];
+    for (int64_t start = begin; start < end; start += chunk_size) {
+      int64_t len = std::min(chunk_size, end - start);
+      for (int64_t s = 0; s < k; s++) {
+        murmur3_hash64(keys + start, len, static_cast<uint32_t>(seeds[s]), hashes);
+        uint64_t* dst = out + start * k + s;
+        if (m > 0) {
+          for (int64_t i = 0; i < len; i++) {
+            dst[i * k] = hashes[i] % m;
+          }
+        } else {
+          for (int64_t i = 0; i < len; i++) {
+            dst[i * k] = hashes[i];
+          }
+        }
+      }
+    }
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(murmur3_hash_stub, &murmur3_hash_kernel);
+
+}} // namespace at::native
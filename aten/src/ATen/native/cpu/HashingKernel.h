@@ -0,0 +1,16 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// Writes murmur3_hash(self, seeds, modulo) to the contiguous long `result`,
+// which already has the right size. `self` must be a contiguous long tensor.
+// See Note [Feature hashing] in Hashing.cpp.
+using murmur3_hash_fn = void(*)(
+    Tensor& result, const Tensor& self, IntList seeds, int64_t modulo);
+
+DECLARE_DISPATCH(murmur3_hash_fn, murmur3_hash_stub);
+
+}} // namespace at::native
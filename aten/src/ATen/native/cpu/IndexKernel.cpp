@@ -0,0 +1,141 @@
+#include "ATen/native/Indexing.h"
+
+#include <mutex>
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/native/TensorIterator.h"
+
+namespace at { namespace native { namespace {
+
+// Computes the byte offset into the indexed tensor of the i-th element of an
+// inner loop from the index operands, see Indexing.h.
+struct Indexer {
+  Indexer(int64_t num_indexers, char** indexers, const int64_t* indexer_strides,
+          IntList original_sizes, IntList original_strides)
+    : num_indexers(num_indexers)
+    , indexers(indexers)
+    , indexer_strides(indexer_strides)
+    , original_sizes(original_sizes.data())
+    , original_strides(original_strides.data()) {
+    AT_ASSERT(original_sizes.size() == (size_t)num_indexers);
+    AT_ASSERT(original_strides.size() == (size_t)num_indexers);
+  }
+
+  int64_t num_indexers;
+  char** indexers;
+  const int64_t* indexer_strides;
+  const int64_t* original_sizes;
+  const int64_t* original_strides;
+
+  // Returns false, with the offending index in `bad_dim`, if an index is out
+  // of range
+  bool get(int64_t idx, int64_t& offset, int64_t& bad_dim) {
+    offset = 0;
+    for (int64_t j = 0; j < num_indexers; j++) {
+      int64_t value = *(int64_t*)&indexers[j][idx * indexer_strides[j]];
+      int64_t size = original_sizes[j];
+      if (value < -size || value >= size) {
+        bad_dim = j;
+        return false;
+      }
+      if (value < 0) {
+        value += size;
+      }
+      offset += value * original_strides[j];
+    }
+    return true;
+  }
+};
+
+static bool is_constant_index(int ntensor, const int64_t* strides) {
+  AT_ASSERT(ntensor >= 3);
+  for (int arg = 2; arg < ntensor; arg++) {
+    if (strides[arg] != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Calls f(dst, src, offset) for every element of `iter` (see Indexing.h),
+// with the byte offset computed from the indices. at::parallel_for can't
+// propagate exceptions, so the first out of range index is recorded and
+// reported after the loop.
+template <typename scalar_t, typename func_t>
+void cpu_index_kernel(TensorIterator& iter, IntList index_size, IntList index_stride,
+                      const func_t& f, bool serial_execution=false) {
+  std::mutex error_mutex;
+  int64_t bad_index = 0;
+  int64_t bad_dim = -1;
+
+  auto loop = [&](int ntensor, char** data, const int64_t* strides, int64_t n) {
+    auto indexer = Indexer(ntensor - 2, &data[2], &strides[2], index_size, index_stride);
+    char* dst = data[0];
+    char* src = data[1];
+    int64_t offset = 0;
+    int64_t dim = -1;
+    int64_t i = 0;
+    if (ntensor > 2 && is_constant_index(ntensor, strides)) {
+      // the same indices for the whole inner loop, e.g. when indexing the
+      // first dimension of a matrix
+      if (indexer.get(0, offset, dim)) {
+        for (; i < n; i++) {
+          f(dst + strides[0] * i, src + strides[1] * i, offset);
+        }
+      }
+    } else {
+      for (; i < n && indexer.get(i, offset, dim); i++) {
+        f(dst + strides[0] * i, src + strides[1] * i, offset);
+      }
+    }
+    if (i < n) {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (bad_dim < 0) {
+        bad_dim = dim;
+        bad_index = *(int64_t*)&data[2 + dim][i * strides[2 + dim]];
+      }
+    }
+  };
+
+  if (serial_execution) {
+    iter.serial_for_each(loop, iter.get_base_ptrs(), iter.get_inner_strides(), 0, iter.numel());
+  } else {
+    iter.for_each(loop);
+  }
+  if (bad_dim >= 0) {
+    AT_ERROR("index ", bad_index, " is out of bounds for dimension ", bad_dim,
+             " with size ", index_size[bad_dim]);
+  }
+}
+
+void index_kernel(TensorIterator& iter, IntList index_size, IntList index_stride) {
+  AT_DISPATCH_ALL_TYPES_AND_HALF(iter.type(), "index", [&] {
+    cpu_index_kernel<scalar_t>(iter, index_size, index_stride, [](char* dst, char* src, int64_t offset) {
+      *(scalar_t*)dst = *(scalar_t*)(src + offset);
+    });
+  });
+}
+
+void index_put_kernel(TensorIterator& iter, IntList index_size, IntList index_stride, bool accumulate) {
+  AT_DISPATCH_ALL_TYPES_AND_HALF(iter.type(), "index_put", [&] {
+    if (accumulate) {
+      // duplicate indices add to the same element, so this can't be split
+      // over threads
+      cpu_index_kernel<scalar_t>(iter, index_size, index_stride, [](char* dst, char* src, int64_t offset) {
+        *(scalar_t*)(dst + offset) += *(scalar_t*)src;
+      }, /*serial_execution=*/true);
+    } else {
+      cpu_index_kernel<scalar_t>(iter, index_size, index_stride, [](char* dst, char* src, int64_t offset) {
+        *(scalar_t*)(dst + offset) = *(scalar_t*)src;
+      });
+    }
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(index_stub, &index_kernel);
+REGISTER_DISPATCH(index_put_stub, &index_put_kernel);
+
+}} // namespace at::native
@@ -0,0 +1,68 @@
+#include "ATen/native/cpu/IndexSelectKernel.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+
+namespace at { namespace native { namespace {
+
+// Views self as [outer, size(dim), inner] and the result as
+// [outer, num_indices, inner], so that every (outer, index) pair copies one
+// contiguous row of `inner` elements. The pairs are split evenly over the
+// threads, which keeps all of them busy whether there are many indices into
+// a small tensor or few indices into a large one.
+template <typename scalar_t>
+static void index_select_kernel(
+    Tensor& result, const Tensor& self, int64_t dim, const Tensor& index) {
+  int64_t num_indices = index.numel();
+  int64_t self_dim_size = self.size(dim);
+  int64_t outer = 1;
+  for (int64_t d = 0; d < dim; d++) {
+    outer *= self.size(d);
+  }
+  int64_t inner = 1;
+  for (int64_t d = dim + 1; d < self.dim(); d++) {
+    inner *= self.size(d);
+  }
+  auto self_data = self.data<scalar_t>();
+  auto result_data = result.data<scalar_t>();
+  auto index_data = index.data<int64_t>();
+
+  int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / inner);
+  parallel_for(0, outer * num_indices, grain_size, [&](int64_t begin, int64_t end) {
+    int64_t o = begin / num_indices;
+    int64_t i = begin % num_indices;
+    for (int64_t k = begin; k < end; o++, i = 0) {
+      const scalar_t* in = self_data + o * self_dim_size * inner;
+      scalar_t* out = result_data + o * num_indices * inner;
+      int64_t stop = std::min(num_indices, i + (end - k));
+      if (inner == 1) {
+        // a plain gather, which the compiler vectorizes for each type and
+        // CPU capability
+        for (int64_t j = i; j < stop; j++) {
+          out[j] = in[index_data[j]];
+        }
+      } else {
+        for (int64_t j = i; j < stop; j++) {
+          std::memcpy(out + j * inner, in + index_data[j] * inner, inner * sizeof(scalar_t));
+        }
+      }
+      k += stop - i;
+    }
+  });
+}
+
+static void index_select_kernel_impl(
+    Tensor& result, const Tensor& self, int64_t dim, const Tensor& index) {
+  AT_DISPATCH_ALL_TYPES_AND_HALF(self.type(), "index_select", [&] {
+    index_select_kernel<scalar_t>(result, self, dim, index);
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(index_select_stub, &index_select_kernel_impl);
+
+}} // namespace at::native
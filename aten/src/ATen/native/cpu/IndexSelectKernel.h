@@ -0,0 +1,16 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// Writes self.index_select(dim, index) to the contiguous `result`, which
+// already has the right size. `self` and the long `index` must be contiguous
+// and the indices in range.
+using index_select_fn = void(*)(
+    Tensor& result, const Tensor& self, int64_t dim, const Tensor& index);
+
+DECLARE_DISPATCH(index_select_fn, index_select_stub);
+
+}} // namespace at::native
@@ -0,0 +1,48 @@
+#include "ATen/native/Linear.h"
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+#include <algorithm>
+
+namespace at { namespace native { namespace {
+
+using namespace vec256;
+
+// Adds bias to, and clamps at zero, each row of out while it is still in
+// cache after the GEMM wrote it.
+static void bias_relu_kernel(Tensor& out, const Tensor& bias) {
+  const int64_t M = out.size(0);
+  const int64_t N = out.size(1);
+  AT_DISPATCH_FLOATING_TYPES(out.type(), "bias_relu", [&] {
+    using Vec = Vec256<scalar_t>;
+    scalar_t* out_data = out.data<scalar_t>();
+    const scalar_t* bias_data = bias.defined() ? bias.data<scalar_t>() : nullptr;
+    const int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(N, 1));
+    parallel_for(0, M, grain_size, [&](int64_t begin, int64_t end) {
+      const Vec zero(scalar_t(0));
+      for (int64_t i = begin; i < end; i++) {
+        scalar_t* row = out_data + i * N;
+        int64_t j = 0;
+        for (; j + Vec::size <= N; j += Vec::size) {
+          Vec x = Vec::loadu(row + j);
+          if (bias_data) {
+            x = x + Vec::loadu(bias_data + j);
+          }
+          max(x, zero).store(row + j);
+        }
+        for (; j < N; j++) {
+          scalar_t x = bias_data ? row[j] + bias_data[j] : row[j];
+          row[j] = x > 0 ? x : scalar_t(0);
+        }
+      }
+    });
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(bias_relu_stub, &bias_relu_kernel);
+
+}} // namespace at::native
@@ -1,14 +1,23 @@
 #pragma once
 
 #include <stdint.h>
+#include <algorithm>
 #include <ATen/detail/FunctionTraits.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/cpu/vec256/vec256.h>
+#include <ATen/native/cpu/Vectorized.h>
 
 namespace at { namespace native { namespace {
 
 using namespace vec256;
 
+// output and input contiguous
+template <typename traits>
+static inline bool is_unary_contiguous(const int64_t* strides) {
+  return strides[0] == sizeof(typename traits::result_type) &&
+         strides[1] == sizeof(typename traits::arg1_t);
+}
+
 // all three operands contiguous
 template <typename traits>
 static inline bool is_binary_contiguous(const int64_t* strides) {
@@ -33,6 +42,15 @@ static inline bool is_binary_contiguous_s2(const int64_t* strides) {
          strides[2] == 0;
 }
 
+// all four operands contiguous
+template <typename traits>
+static inline bool is_ternary_contiguous(const int64_t* strides) {
+  return strides[0] == sizeof(typename traits::result_type) &&
+         strides[1] == sizeof(typename traits::arg1_t) &&
+         strides[2] == sizeof(typename traits::arg2_t) &&
+         strides[3] == sizeof(typename traits::arg3_t);
+}
+
 #define LOOP_HEADER(traits, data, strides) \
   using arg0_t = typename traits::result_type; \
   using arg1_t = typename traits::arg1_t; \
@@ -44,12 +62,46 @@ static inline bool is_binary_contiguous_s2(const int64_t* strides) {
 
 #define VEC_LOOP_HEADER(traits, data, strides) \
   using scalar_t = typename traits::result_type; \
-  using Vec = Vec256<scalar_t>; \
+  using Vec = Vectorized<scalar_t>; \
   char* out_ptr = data[0]; \
   const char* in1_ptr = data[1]; \
   const char* in2_ptr = data[2]; \
 
 
+// Basic loop unary operation (one input, one output). May be auto-vectorized
+// by the compiler.
+template <typename traits, typename func_t>
+static inline void unary_loop(char** data, const int64_t* strides, int64_t i, int64_t n, func_t op) {
+  using arg0_t = typename traits::result_type;
+  using arg1_t = typename traits::arg1_t;
+  char* out_ptr = data[0];
+  const char* in1_ptr = data[1];
+  int64_t s0 = strides[0], s1 = strides[1];
+  for (; i < n; i++) {
+    arg1_t in1 = *(arg1_t*)(in1_ptr + i * s1);
+    arg0_t out = op(in1);
+    *(arg0_t*)(out_ptr + i * s0) = out;
+  }
+}
+
+template <typename traits, typename func_t, typename vec_func_t>
+static inline void vectorized_unary_loop(char** data, const int64_t* strides, int64_t n, func_t op, vec_func_t vop) {
+  using scalar_t = typename traits::result_type;
+  using Vec = Vectorized<scalar_t>;
+  char* out_ptr = data[0];
+  const char* in1_ptr = data[1];
+  int64_t i = 0;
+  for (; i <= n - 2 * Vec::size; i += 2 * Vec::size) {
+    auto a1 = Vec::loadu(in1_ptr + i * sizeof(scalar_t));
+    auto a2 = Vec::loadu(in1_ptr + (i + Vec::size) * sizeof(scalar_t));
+    auto out1 = vop(a1);
+    auto out2 = vop(a2);
+    out1.store(out_ptr + i * sizeof(scalar_t));
+    out2.store(out_ptr + (i + Vec::size) * sizeof(scalar_t));
+  }
+  unary_loop<traits>(data, strides, i, n, op);
+}
+
 // Basic loop binary operation (two inputs, one output). May be auto-vectorized
 // by the compiler.
 template <typename traits, typename func_t>
@@ -112,6 +164,58 @@ static inline void vectorized_binary_loop_s2(char** data, const int64_t* strides
   binary_loop<traits>(data, strides, i, n, op);
 }
 
+// Basic loop ternary operation (three inputs, one output), e.g. `where`. May
+// be auto-vectorized by the compiler.
+template <typename traits, typename func_t>
+static inline void ternary_loop(char** data, const int64_t* strides, int64_t i, int64_t n, func_t op) {
+  using arg0_t = typename traits::result_type;
+  using arg1_t = typename traits::arg1_t;
+  using arg2_t = typename traits::arg2_t;
+  using arg3_t = typename traits::arg3_t;
+  char* out_ptr = data[0];
+  const char* in1_ptr = data[1];
+  const char* in2_ptr = data[2];
+  const char* in3_ptr = data[3];
+  int64_t s0 = strides[0], s1 = strides[1], s2 = strides[2], s3 = strides[3];
+  for (; i < n; i++) {
+    arg1_t in1 = *(arg1_t*)(in1_ptr + i * s1);
+    arg2_t in2 = *(arg2_t*)(in2_ptr + i * s2);
+    arg3_t in3 = *(arg3_t*)(in3_ptr + i * s3);
+    arg0_t out = op(in1, in2, in3);
+    *(arg0_t*)(out_ptr + i * s0) = out;
+  }
+}
+
+template <typename func_t>
+void unary_kernel(TensorIterator& iter, func_t op) {
+  using traits = unary_function_traits<func_t>;
+
+  iter.for_each([&](int ntensor, char** data, const int64_t* strides, int64_t n) {
+    // Specializations to encourage auto-vectorization (trick from Numpy's loops.c.src)
+    if (is_unary_contiguous<traits>(strides)) {
+      unary_loop<traits>(data, strides, 0, n, op);
+    } else {
+      unary_loop<traits>(data, strides, 0, n, op);
+    }
+  });
+}
+
+template <typename func_t, typename vec_func_t>
+void unary_kernel_vec(TensorIterator& iter, func_t op, vec_func_t vop) {
+  using traits = unary_function_traits<func_t>;
+  static_assert(
+    std::is_same<typename traits::result_type, typename traits::arg1_t>::value,
+    "all types must match");
+
+  iter.for_each([&](int ntensor, char** data, const int64_t* strides, int64_t n) {
+    if (is_unary_contiguous<traits>(strides)) {
+      vectorized_unary_loop<traits>(data, strides, n, op, vop);
+    } else {
+      unary_loop<traits>(data, strides, 0, n, op);
+    }
+  });
+}
+
 template <typename func_t>
 void binary_kernel(TensorIterator& iter, func_t op) {
   using traits = binary_function_traits<func_t>;
@@ -153,4 +257,73 @@ void binary_kernel_vec(TensorIterator& iter, func_t op, vec_func_t vop) {
   });
 }
 
+// Loads n elements of a reduced precision operand with the given byte
+// stride (0 for a scalar) as floats.
+template <typename scalar_t>
+static inline void load_as_float(float* dst, const char* ptr, int64_t stride, int64_t n) {
+  if (stride == 0) {
+    float value = static_cast<float>(*(const scalar_t*)ptr);
+    for (int64_t i = 0; i < n; i++) {
+      dst[i] = value;
+    }
+  } else {
+    vec256::convert((const scalar_t*)ptr, dst, n);
+  }
+}
+
+// Binary kernel for reduced precision floating point types (Half) that
+// computes in float. Contiguous runs are converted to float a block at a
+// time with the vectorized conversions of vec256_half.h, combined with vop
+// on Vectorized<float> and converted back; the memory traffic stays that of
+// the 16-bit type. op and vop take and return float.
+template <typename scalar_t, typename func_t, typename vec_func_t>
+void binary_kernel_reduced_float(TensorIterator& iter, func_t op, vec_func_t vop) {
+  using Vec = Vectorized<float>;
+  constexpr int64_t kBlock = 256;
+  constexpr int64_t size = sizeof(scalar_t);
+
+  iter.for_each([&](int ntensor, char** data, const int64_t* strides, int64_t n) {
+    bool contiguous = strides[0] == size &&
+        (strides[1] == size || strides[1] == 0) &&
+        (strides[2] == size || strides[2] == 0);
+    if (!contiguous) {
+      for (int64_t i = 0; i < n; i++) {
+        float a = static_cast<float>(*(scalar_t*)(data[1] + i * strides[1]));
+        float b = static_cast<float>(*(scalar_t*)(data[2] + i * strides[2]));
+        *(scalar_t*)(data[0] + i * strides[0]) = static_cast<scalar_t>(op(a, b));
+      }
+      return;
+    }
+    float a_buf[kBlock];
+    float b_buf[kBlock];
+    float out_buf[kBlock];
+    for (int64_t begin = 0; begin < n; begin += kBlock) {
+      int64_t len = std::min(kBlock, n - begin);
+      load_as_float<scalar_t>(a_buf, data[1] + begin * strides[1], strides[1], len);
+      load_as_float<scalar_t>(b_buf, data[2] + begin * strides[2], strides[2], len);
+      int64_t i = 0;
+      for (; i <= len - Vec::size; i += Vec::size) {
+        vop(Vec::loadu(a_buf + i), Vec::loadu(b_buf + i)).store(out_buf + i);
+      }
+      for (; i < len; i++) {
+        out_buf[i] = op(a_buf[i], b_buf[i]);
+      }
+      vec256::convert(out_buf, (scalar_t*)(data[0] + begin * size), len);
+    }
+  });
+}
+
+template <typename func_t>
+void ternary_kernel(TensorIterator& iter, func_t op) {
+  using traits = ternary_function_traits<func_t>;
+
+  iter.for_each([&](int ntensor, char** data, const int64_t* strides, int64_t n) {
+    if (is_ternary_contiguous<traits>(strides)) {
+      ternary_loop<traits>(data, strides, 0, n, op);
+    } else {
+      ternary_loop<traits>(data, strides, 0, n, op);
+    }
+  });
+}
+
 }}}  // namespace at::native::<anonymous>
@@ -0,0 +1,409 @@
+#include "ATen/native/cpu/NormalizationKernel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+// LayerNorm and GroupNorm both normalize rows of contiguous elements: the N
+// elements of a LayerNorm row, or the C / group * HxW elements of a sample's
+// group of channels. The forward computes each row's moments in a single
+// vectorized Welford pass and writes the output in a second, while the row is
+// still in cache. The backward computes the input gradient of a row from two
+// sums over it, and accumulates the gamma and beta gradients in the same pass.
+
+namespace at { namespace native {
+namespace {
+
+// Loads count elements, with the rest of the vector zeroed.
+template <typename T>
+inline vec256::Vec256<T> load_zero_padded(const T* ptr, int64_t count) {
+  using Vec = vec256::Vec256<T>;
+  if (count == Vec::size) {
+    return Vec::loadu(ptr);
+  }
+  return Vec::set(Vec(0), Vec::loadu(ptr, count), count);
+}
+
+template <typename T>
+inline T vec_sum(const vec256::Vec256<T>& v) {
+  using Vec = vec256::Vec256<T>;
+  T values[Vec::size];
+  v.store(values);
+  T sum = 0;
+  for (int j = 0; j < Vec::size; j++) {
+    sum += values[j];
+  }
+  return sum;
+}
+
+// Mean and biased variance of X[0..n) in one pass. Every vector lane runs
+// Welford's algorithm over its own elements, and the lanes are then merged
+// with the parallel formula of Chan et al.
+template <typename T>
+std::pair<T, T> row_moments(const T* X, int64_t n) {
+  using Vec = vec256::Vec256<T>;
+  T mean = 0;
+  T m2 = 0;
+  int64_t count = 0;
+  int64_t d = 0;
+  if (n >= Vec::size) {
+    Vec mean_vec(0);
+    Vec m2_vec(0);
+    for (; d + Vec::size <= n; d += Vec::size) {
+      Vec x = Vec::loadu(X + d);
+      count++;
+      Vec delta = x - mean_vec;
+      mean_vec = mean_vec + delta * Vec(T(1) / count);
+      m2_vec = m2_vec + delta * (x - mean_vec);
+    }
+    T means[Vec::size];
+    T m2s[Vec::size];
+    mean_vec.store(means);
+    m2_vec.store(m2s);
+    // every lane saw `count` elements; merge lane j into the first j
+    mean = means[0];
+    m2 = m2s[0];
+    for (int j = 1; j < Vec::size; j++) {
+      T delta = means[j] - mean;
+      T weight = T(1) / (j + 1);
+      mean += delta * weight;
+      m2 += m2s[j] + delta * delta * count * j * weight;
+    }
+    count *= Vec::size;
+  }
+  for (; d < n; d++) {
+    count++;
+    T delta = X[d] - mean;
+    mean += delta / count;
+    m2 += delta * (X[d] - mean);
+  }
+  return std::make_pair(mean, m2 / n);
+}
+
+template <typename T>
+inline T rstd_from_var(T var, T eps) {
+  return T(1) / std::sqrt(std::max(var, T(0)) + eps);
+}
+
+// Y = X * scale + shift over n elements, where scale and shift are either
+// scalars (per row) or additionally multiplied by gamma and offset by beta
+// per element.
+template <typename T>
+inline void normalize_row(
+    const T* X, const T* gamma, const T* beta, T scale, T shift, int64_t n, T* Y) {
+  using Vec = vec256::Vec256<T>;
+  const Vec scale_vec(scale);
+  const Vec shift_vec(shift);
+  for (int64_t j = 0; j < n; j += Vec::size) {
+    const int64_t count = std::min<int64_t>(Vec::size, n - j);
+    Vec y = Vec::loadu(X + j, count) * scale_vec + shift_vec;
+    if (gamma != nullptr) {
+      y = y * Vec::loadu(gamma + j, count);
+    }
+    if (beta != nullptr) {
+      y = y + Vec::loadu(beta + j, count);
+    }
+    y.store(Y + j, count);
+  }
+}
+
+template <typename T>
+void layer_norm_kernel_impl_internal(
+    const Tensor& X, const Tensor& gamma, const Tensor& beta, int64_t M,
+    int64_t N, T eps, Tensor& Y, Tensor& mean, Tensor& rstd) {
+  const T* X_data = X.data<T>();
+  const T* gamma_data = gamma.defined() ? gamma.data<T>() : nullptr;
+  const T* beta_data = beta.defined() ? beta.data<T>() : nullptr;
+  T* Y_data = Y.data<T>();
+  T* mean_data = mean.data<T>();
+  T* rstd_data = rstd.data<T>();
+  parallel_for(0, M, divup(internal::GRAIN_SIZE, std::max<int64_t>(N, 1)), [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      T row_mean, row_var;
+      std::tie(row_mean, row_var) = row_moments(X_data + i * N, N);
+      const T row_rstd = rstd_from_var(row_var, eps);
+      mean_data[i] = row_mean;
+      rstd_data[i] = row_rstd;
+      normalize_row(X_data + i * N, gamma_data, beta_data, row_rstd,
+                    -row_mean * row_rstd, N, Y_data + i * N);
+    }
+  });
+}
+
+static void layer_norm_kernel_impl(
+    const Tensor& X, const Tensor& gamma, const Tensor& beta, int64_t M,
+    int64_t N, double eps, Tensor& Y, Tensor& mean, Tensor& rstd) {
+  AT_DISPATCH_FLOATING_TYPES(X.type(), "layer_norm", [&] {
+    layer_norm_kernel_impl_internal<scalar_t>(
+        X, gamma, beta, M, N, static_cast<scalar_t>(eps), Y, mean, rstd);
+  });
+}
+
+// The sums of dY * gamma * X and dY * gamma over a row, with gamma optional.
+template <typename T>
+inline std::pair<T, T> row_grad_sums(const T* dY, const T* X, const T* gamma, int64_t n) {
+  using Vec = vec256::Vec256<T>;
+  Vec ds_vec(0);
+  Vec db_vec(0);
+  for (int64_t j = 0; j < n; j += Vec::size) {
+    const int64_t count = std::min<int64_t>(Vec::size, n - j);
+    Vec dy = load_zero_padded(dY + j, count);
+    if (gamma != nullptr) {
+      dy = dy * load_zero_padded(gamma + j, count);
+    }
+    ds_vec = ds_vec + dy * load_zero_padded(X + j, count);
+    db_vec = db_vec + dy;
+  }
+  return std::make_pair(vec_sum(ds_vec), vec_sum(db_vec));
+}
+
+// With xhat = (X - mean) * rstd, the input gradient of a row of n elements is
+//   dX = rstd * (dY * gamma - sum(dY * gamma) / n
+//                - xhat * sum(dY * gamma * xhat) / n)
+// which is dX = dY * gamma * rstd + X * b + c in terms of ds and db.
+template <typename T>
+inline std::pair<T, T> input_grad_coefficients(T ds, T db, T mean, T rstd, int64_t n) {
+  const T b = (db * mean - ds) * rstd * rstd * rstd / n;
+  const T c = -b * mean - db * rstd / n;
+  return std::make_pair(b, c);
+}
+
+template <typename T>
+void layer_norm_backward_kernel_impl_internal(
+    const Tensor& dY, const Tensor& X, const Tensor& mean, const Tensor& rstd,
+    const Tensor& gamma, int64_t M, int64_t N, Tensor& dX, Tensor& dgamma,
+    Tensor& dbeta) {
+  using Vec = vec256::Vec256<T>;
+  const T* dY_data = dY.data<T>();
+  const T* X_data = X.data<T>();
+  const T* mean_data = mean.data<T>();
+  const T* rstd_data = rstd.data<T>();
+  const T* gamma_data = gamma.defined() ? gamma.data<T>() : nullptr;
+  T* dX_data = dX.defined() ? dX.data<T>() : nullptr;
+  T* dgamma_data = dgamma.defined() ? dgamma.data<T>() : nullptr;
+  T* dbeta_data = dbeta.defined() ? dbeta.data<T>() : nullptr;
+
+  // dgamma and dbeta sum over the rows. Every chunk of rows sums into its own
+  // buffer, and the buffers are added up at the end.
+  int64_t num_chunks = 1;
+  if (M * N >= internal::GRAIN_SIZE && !in_parallel_region()) {
+    num_chunks = std::min<int64_t>(get_num_threads(), M);
+  }
+  const int64_t rows_per_chunk = divup(M, num_chunks);
+  const bool column_grads = dgamma_data != nullptr || dbeta_data != nullptr;
+  std::vector<T> partials(column_grads ? num_chunks * 2 * N : 0, T(0));
+
+  parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t chunk = begin; chunk < end; chunk++) {
+      T* dgamma_partial = column_grads ? partials.data() + chunk * 2 * N : nullptr;
+      T* dbeta_partial = column_grads ? dgamma_partial + N : nullptr;
+      const int64_t row_end = std::min(M, (chunk + 1) * rows_per_chunk);
+      for (int64_t i = chunk * rows_per_chunk; i < row_end; i++) {
+        const T* dY_ptr = dY_data + i * N;
+        const T* X_ptr = X_data + i * N;
+        const T row_mean = mean_data[i];
+        const T row_rstd = rstd_data[i];
+        if (column_grads) {
+          const Vec mean_vec(row_mean);
+          const Vec rstd_vec(row_rstd);
+          for (int64_t j = 0; j < N; j += Vec::size) {
+            const int64_t count = std::min<int64_t>(Vec::size, N - j);
+            const Vec dy = Vec::loadu(dY_ptr + j, count);
+            const Vec x = Vec::loadu(X_ptr + j, count);
+            (Vec::loadu(dgamma_partial + j, count) + dy * (x - mean_vec) * rstd_vec)
+                .store(dgamma_partial + j, count);
+            (Vec::loadu(dbeta_partial + j, count) + dy).store(dbeta_partial + j, count);
+          }
+        }
+        if (dX_data != nullptr) {
+          T ds, db, b, c;
+          std::tie(ds, db) = row_grad_sums(dY_ptr, X_ptr, gamma_data, N);
+          std::tie(b, c) = input_grad_coefficients(ds, db, row_mean, row_rstd, N);
+          const Vec rstd_vec(row_rstd);
+          const Vec b_vec(b);
+          const Vec c_vec(c);
+          T* dX_ptr = dX_data + i * N;
+          for (int64_t j = 0; j < N; j += Vec::size) {
+            const int64_t count = std::min<int64_t>(Vec::size, N - j);
+            Vec dy = Vec::loadu(dY_ptr + j, count);
+            if (gamma_data != nullptr) {
+              dy = dy * Vec::loadu(gamma_data + j, count);
+            }
+            (dy * rstd_vec + Vec::loadu(X_ptr + j, count) * b_vec + c_vec)
+                .store(dX_ptr + j, count);
+          }
+        }
+      }
+    }
+  });
+
+  if (column_grads) {
+    for (int64_t j = 0; j < N; j++) {
+      T dgamma_sum = 0;
+      T dbeta_sum = 0;
+      for (int64_t chunk = 0; chunk < num_chunks; chunk++) {
+        dgamma_sum += partials[chunk * 2 * N + j];
+        dbeta_sum += partials[chunk * 2 * N + N + j];
+      }
+      if (dgamma_data != nullptr) {
+        dgamma_data[j] = dgamma_sum;
+      }
+      if (dbeta_data != nullptr) {
+        dbeta_data[j] = dbeta_sum;
+      }
+    }
+  }
+}
+
+static void layer_norm_backward_kernel_impl(
+    const Tensor& dY, const Tensor& X, const Tensor& mean, const Tensor& rstd,
+    const Tensor& gamma, int64_t M, int64_t N, Tensor& dX, Tensor& dgamma,
+    Tensor& dbeta) {
+  AT_DISPATCH_FLOATING_TYPES(X.type(), "layer_norm_backward", [&] {
+    layer_norm_backward_kernel_impl_internal<scalar_t>(
+        dY, X, mean, rstd, gamma, M, N, dX, dgamma, dbeta);
+  });
+}
+
+template <typename T>
+void group_norm_kernel_impl_internal(
+    const Tensor& X, const Tensor& gamma, const Tensor& beta, int64_t N,
+    int64_t C, int64_t HxW, int64_t group, T eps, Tensor& Y, Tensor& mean,
+    Tensor& rstd) {
+  const int64_t D = C / group;
+  const int64_t row_size = D * HxW;
+  const T* X_data = X.data<T>();
+  const T* gamma_data = gamma.defined() ? gamma.data<T>() : nullptr;
+  const T* beta_data = beta.defined() ? beta.data<T>() : nullptr;
+  T* Y_data = Y.data<T>();
+  T* mean_data = mean.data<T>();
+  T* rstd_data = rstd.data<T>();
+  parallel_for(0, N * group, divup(internal::GRAIN_SIZE, std::max<int64_t>(row_size, 1)), [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      const T* X_ptr = X_data + i * row_size;
+      T* Y_ptr = Y_data + i * row_size;
+      T row_mean, row_var;
+      std::tie(row_mean, row_var) = row_moments(X_ptr, row_size);
+      const T row_rstd = rstd_from_var(row_var, eps);
+      mean_data[i] = row_mean;
+      rstd_data[i] = row_rstd;
+      // fold the per channel affine transform into the scale and shift
+      const int64_t g = i % group;
+      for (int64_t d = 0; d < D; d++) {
+        const int64_t c = g * D + d;
+        const T scale = gamma_data != nullptr ? row_rstd * gamma_data[c] : row_rstd;
+        const T shift = -row_mean * scale + (beta_data != nullptr ? beta_data[c] : T(0));
+        normalize_row<T>(X_ptr + d * HxW, nullptr, nullptr, scale, shift, HxW, Y_ptr + d * HxW);
+      }
+    }
+  });
+}
+
+static void group_norm_kernel_impl(
+    const Tensor& X, const Tensor& gamma, const Tensor& beta, int64_t N,
+    int64_t C, int64_t HxW, int64_t group, double eps, Tensor& Y, Tensor& mean,
+    Tensor& rstd) {
+  AT_DISPATCH_FLOATING_TYPES(X.type(), "group_norm", [&] {
+    group_norm_kernel_impl_internal<scalar_t>(
+        X, gamma, beta, N, C, HxW, group, static_cast<scalar_t>(eps), Y, mean, rstd);
+  });
+}
+
+template <typename T>
+void group_norm_backward_kernel_impl_internal(
+    const Tensor& dY, const Tensor& X, const Tensor& mean, const Tensor& rstd,
+    const Tensor& gamma, int64_t N, int64_t C, int64_t HxW, int64_t group,
+    Tensor& dX, Tensor& dgamma, Tensor& dbeta) {
+  const int64_t D = C / group;
+  const T* dY_data = dY.data<T>();
+  const T* X_data = X.data<T>();
+  const T* mean_data = mean.data<T>();
+  const T* rstd_data = rstd.data<T>();
+  const T* gamma_data = gamma.defined() ? gamma.data<T>() : nullptr;
+  T* dX_data = dX.defined() ? dX.data<T>() : nullptr;
+  T* dgamma_data = dgamma.defined() ? dgamma.data<T>() : nullptr;
+  T* dbeta_data = dbeta.defined() ? dbeta.data<T>() : nullptr;
+
+  // The sums of dY * X and dY over every (sample, channel), from which all
+  // gradients follow.
+  std::vector<T> ds(N * C);
+  std::vector<T> db(N * C);
+  parallel_for(0, N * group, divup(internal::GRAIN_SIZE, std::max<int64_t>(D * HxW, 1)), [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      const int64_t g = i % group;
+      const int64_t base = i * D;  // (sample, first channel of the group)
+      T ds_group = 0;
+      T db_group = 0;
+      for (int64_t d = 0; d < D; d++) {
+        std::tie(ds[base + d], db[base + d]) =
+            row_grad_sums<T>(dY_data + (base + d) * HxW, X_data + (base + d) * HxW, nullptr, HxW);
+        const T gamma_c = gamma_data != nullptr ? gamma_data[g * D + d] : T(1);
+        ds_group += ds[base + d] * gamma_c;
+        db_group += db[base + d] * gamma_c;
+      }
+      if (dX_data == nullptr) {
+        continue;
+      }
+      T b, c;
+      std::tie(b, c) = input_grad_coefficients(ds_group, db_group, mean_data[i], rstd_data[i], D * HxW);
+      for (int64_t d = 0; d < D; d++) {
+        // dX = dY * (gamma * rstd) + X * b + c; see input_grad_coefficients
+        const T gamma_c = gamma_data != nullptr ? gamma_data[g * D + d] : T(1);
+        const T scale = gamma_c * rstd_data[i];
+        const T* dY_ptr = dY_data + (base + d) * HxW;
+        const T* X_ptr = X_data + (base + d) * HxW;
+        T* dX_ptr = dX_data + (base + d) * HxW;
+        using Vec = vec256::Vec256<T>;
+        for (int64_t j = 0; j < HxW; j += Vec::size) {
+          const int64_t count = std::min<int64_t>(Vec::size, HxW - j);
+          (Vec::loadu(dY_ptr + j, count) * Vec(scale) + Vec::loadu(X_ptr + j, count) * Vec(b) + Vec(c))
+              .store(dX_ptr + j, count);
+        }
+      }
+    }
+  });
+
+  if (dgamma_data != nullptr || dbeta_data != nullptr) {
+    for (int64_t c = 0; c < C; c++) {
+      const int64_t g = c / D;
+      T dgamma_sum = 0;
+      T dbeta_sum = 0;
+      for (int64_t n = 0; n < N; n++) {
+        const int64_t ng = n * group + g;
+        dgamma_sum += (ds[n * C + c] - mean_data[ng] * db[n * C + c]) * rstd_data[ng];
+        dbeta_sum += db[n * C + c];
+      }
+      if (dgamma_data != nullptr) {
+        dgamma_data[c] = dgamma_sum;
+      }
+      if (dbeta_data != nullptr) {
+        dbeta_data[c] = dbeta_sum;
+      }
+    }
+  }
+}
+
+static void group_norm_backward_kernel_impl(
+    const Tensor& dY, const Tensor& X, const Tensor& mean, const Tensor& rstd,
+    const Tensor& gamma, int64_t N, int64_t C, int64_t HxW, int64_t group,
+    Tensor& dX, Tensor& dgamma, Tensor& dbeta) {
+  AT_DISPATCH_FLOATING_TYPES(X.type(), "group_norm_backward", [&] {
+    group_norm_backward_kernel_impl_internal<scalar_t>(
+        dY, X, mean, rstd, gamma, N, C, HxW, group, dX, dgamma, dbeta);
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(layer_norm_stub, &layer_norm_kernel_impl);
+REGISTER_DISPATCH(layer_norm_backward_stub, &layer_norm_backward_kernel_impl);
+REGISTER_DISPATCH(group_norm_stub, &group_norm_kernel_impl);
+REGISTER_DISPATCH(group_norm_backward_stub, &group_norm_backward_kernel_impl);
+
+}} // namespace at::native
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// LayerNorm of the M rows of N elements of contiguous X. gamma and beta have
+// N elements and may be undefined. Writes Y and the M row means and
+// reciprocal standard deviations.
+using layer_norm_fn = void(*)(
+    const Tensor& X, const Tensor& gamma, const Tensor& beta, int64_t M,
+    int64_t N, double eps, Tensor& Y, Tensor& mean, Tensor& rstd);
+
+// Gradients of layer_norm_fn. Outputs that are undefined are not computed.
+using layer_norm_backward_fn = void(*)(
+    const Tensor& dY, const Tensor& X, const Tensor& mean, const Tensor& rstd,
+    const Tensor& gamma, int64_t M, int64_t N, Tensor& dX, Tensor& dgamma,
+    Tensor& dbeta);
+
+// GroupNorm of contiguous X of shape (N, C, HxW), over `group` groups of
+// channels. gamma and beta have C elements and may be undefined. Writes Y and
+// the N * group means and reciprocal standard deviations.
+using group_norm_fn = void(*)(
+    const Tensor& X, const Tensor& gamma, const Tensor& beta, int64_t N,
+    int64_t C, int64_t HxW, int64_t group, double eps, Tensor& Y, Tensor& mean,
+    Tensor& rstd);
+
+// Gradients of group_norm_fn. Outputs that are undefined are not computed.
+using group_norm_backward_fn = void(*)(
+    const Tensor& dY, const Tensor& X, const Tensor& mean, const Tensor& rstd,
+    const Tensor& gamma, int64_t N, int64_t C, int64_t HxW, int64_t group,
+    Tensor& dX, Tensor& dgamma, Tensor& dbeta);
+
+DECLARE_DISPATCH(layer_norm_fn, layer_norm_stub);
+DECLARE_DISPATCH(layer_norm_backward_fn, layer_norm_backward_stub);
+DECLARE_DISPATCH(group_norm_fn, group_norm_stub);
+DECLARE_DISPATCH(group_norm_backward_fn, group_norm_backward_stub);
+
+}} // namespace at::native
@@ -0,0 +1,454 @@
+#include "ATen/native/PoolingCPU.h"
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// Contiguous tensors are processed a plane at a time, in parallel over the
+// N * C planes, with the loops over an output row innermost so that they run
+// along the width. Channels-last tensors are processed in parallel over the
+// rows of the N images, with the loops over the channels of a pixel innermost.
+//
+// The max pooling loops are written without branches so that the compiler
+// vectorizes them in the AVX and AVX2 builds of this file, since there are no
+// Vec256 comparisons to keep the index of the maximum with. Every element of
+// a window is visited in the same order as in THNN, so that ties and NaN pick
+// the same index.
+//
+// The channels-last backward kernels gather: each grad_input pixel sums the
+// grad_output pixels whose window covers it, so that threads never write to
+// the same pixel. The contiguous ones own whole planes, so the max pooling
+// backward scatters through the indices and the average pooling backward
+// gathers to vectorize over the width.
+
+namespace at { namespace native { namespace {
+
+using namespace vec256;
+
+// The number of planes or rows to run on a thread, given the work per item.
+static inline int64_t grain_size(int64_t work) {
+  return std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(1, work));
+}
+
+// The range [begin, end) of outputs o whose input index o * stride - offset
+// lies in [0, size).
+static inline void valid_range(
+    int64_t size, int64_t out_size, int64_t stride, int64_t offset,
+    int64_t* begin, int64_t* end) {
+  *begin = offset > 0 ? std::min(out_size, (offset + stride - 1) / stride) : 0;
+  *end = std::min(out_size, std::max(*begin, (size + offset + stride - 1) / stride));
+}
+
+// For each input index i along one dimension, the outputs [begin[i], end[i])
+// whose window contains i. The windows start and end at nondecreasing input
+// indices, so these are ranges; with dilation they may also contain outputs
+// whose window skips over i.
+struct WindowCover {
+  std::vector<int64_t> begin, end;
+
+  WindowCover(int64_t size, int64_t out_size, int64_t kernel, int64_t stride,
+              int64_t pad, int64_t dilation)
+    : begin(size, out_size), end(size, 0) {
+    for (int64_t o = 0; o < out_size; o++) {
+      for (int64_t k = 0; k < kernel; k++) {
+        const int64_t i = o * stride - pad + k * dilation;
+        if (i >= 0 && i < size) {
+          begin[i] = std::min(begin[i], o);
+          end[i] = std::max(end[i], o + 1);
+        }
+      }
+    }
+  }
+};
+
+// The window of an average pooling output along one dimension, clamped to the
+// input, and its share of the divisor, which is a product over dimensions.
+struct AvgWindow {
+  int64_t start, end, count;
+};
+
+static std::vector<AvgWindow> avg_windows(
+    int64_t size, int64_t out_size, int64_t kernel, int64_t stride, int64_t pad,
+    bool count_include_pad) {
+  std::vector<AvgWindow> windows(out_size);
+  for (int64_t o = 0; o < out_size; o++) {
+    int64_t start = o * stride - pad;
+    int64_t end = std::min(start + kernel, size + pad);
+    const int64_t pool_size = end - start;
+    start = std::max<int64_t>(start, 0);
+    end = std::min(end, size);
+    windows[o] = {start, end, count_include_pad ? pool_size : end - start};
+  }
+  return windows;
+}
+
+template <typename scalar_t>
+static inline void add_row(scalar_t* dst, const scalar_t* src, int64_t n) {
+  using Vec = Vec256<scalar_t>;
+  int64_t i = 0;
+  for (; i + Vec::size <= n; i += Vec::size) {
+    (Vec::loadu(dst + i) + Vec::loadu(src + i)).store(dst + i);
+  }
+  for (; i < n; i++) {
+    dst[i] += src[i];
+  }
+}
+
+// dst[i] += src[i] / divisor
+template <typename scalar_t>
+static inline void add_row_div(scalar_t* dst, const scalar_t* src, scalar_t divisor, int64_t n) {
+  using Vec = Vec256<scalar_t>;
+  const Vec vdivisor(divisor);
+  int64_t i = 0;
+  for (; i + Vec::size <= n; i += Vec::size) {
+    (Vec::loadu(dst + i) + Vec::loadu(src + i) / vdivisor).store(dst + i);
+  }
+  for (; i < n; i++) {
+    dst[i] += src[i] / divisor;
+  }
+}
+
+template <typename scalar_t>
+static inline void div_row(scalar_t* dst, scalar_t divisor, int64_t n) {
+  using Vec = Vec256<scalar_t>;
+  const Vec vdivisor(divisor);
+  int64_t i = 0;
+  for (; i + Vec::size <= n; i += Vec::size) {
+    (Vec::loadu(dst + i) / vdivisor).store(dst + i);
+  }
+  for (; i < n; i++) {
+    dst[i] /= divisor;
+  }
+}
+
+struct Pool2dShape {
+  int64_t N, C, H, W, OH, OW;
+  int64_t kH, kW, sH, sW, pH, pW, dH, dW;
+
+  Pool2dShape(const Tensor& input, const Tensor& output, IntList kernel_size,
+              IntList stride, IntList padding, IntList dilation)
+    : N(input.size(0)), C(input.size(1)), H(input.size(2)), W(input.size(3)),
+      OH(output.size(2)), OW(output.size(3)),
+      kH(kernel_size[0]), kW(kernel_size[1]), sH(stride[0]), sW(stride[1]),
+      pH(padding[0]), pW(padding[1]), dH(dilation[0]), dW(dilation[1]) {}
+};
+
+template <typename scalar_t>
+static void max_pool2d_contiguous(
+    scalar_t* out_data, int64_t* ind_data, const scalar_t* in_data, const Pool2dShape& s) {
+  parallel_for(0, s.N * s.C, grain_size(s.OH * s.OW * s.kH * s.kW), [&](int64_t begin, int64_t end) {
+    for (int64_t plane = begin; plane < end; plane++) {
+      const scalar_t* in = in_data + plane * s.H * s.W;
+      scalar_t* out = out_data + plane * s.OH * s.OW;
+      int64_t* ind = ind_data + plane * s.OH * s.OW;
+      std::fill(out, out + s.OH * s.OW, -std::numeric_limits<scalar_t>::infinity());
+      std::fill(ind, ind + s.OH * s.OW, -1);
+      for (int64_t oh = 0; oh < s.OH; oh++) {
+        scalar_t* out_row = out + oh * s.OW;
+        int64_t* ind_row = ind + oh * s.OW;
+        for (int64_t kh = 0; kh < s.kH; kh++) {
+          const int64_t ih = oh * s.sH - s.pH + kh * s.dH;
+          if (ih < 0 || ih >= s.H) {
+            continue;
+          }
+          const scalar_t* in_row = in + ih * s.W;
+          for (int64_t kw = 0; kw < s.kW; kw++) {
+            const int64_t offset = s.pW - kw * s.dW;
+            int64_t ow_begin, ow_end;
+            valid_range(s.W, s.OW, s.sW, offset, &ow_begin, &ow_end);
+            for (int64_t ow = ow_begin; ow < ow_end; ow++) {
+              const int64_t iw = ow * s.sW - offset;
+              const scalar_t x = in_row[iw];
+              const bool take = x > out_row[ow] || std::isnan(x);
+              out_row[ow] = take ? x : out_row[ow];
+              ind_row[ow] = take ? ih * s.W + iw : ind_row[ow];
+            }
+          }
+        }
+      }
+    }
+  });
+}
+
+template <typename scalar_t>
+static void max_pool2d_channels_last(
+    scalar_t* out_data, int64_t* ind_data, const scalar_t* in_data, const Pool2dShape& s) {
+  const int64_t C = s.C;
+  parallel_for(0, s.N * s.OH, grain_size(s.OW * C * s.kH * s.kW), [&](int64_t begin, int64_t end) {
+    for (int64_t row = begin; row < end; row++) {
+      const int64_t n = row / s.OH;
+      const int64_t oh = row % s.OH;
+      const scalar_t* in = in_data + n * s.H * s.W * C;
+      for (int64_t ow = 0; ow < s.OW; ow++) {
+        scalar_t* out_px = out_data + (row * s.OW + ow) * C;
+        int64_t* ind_px = ind_data + (row * s.OW + ow) * C;
+        std::fill(out_px, out_px + C, -std::numeric_limits<scalar_t>::infinity());
+        std::fill(ind_px, ind_px + C, -1);
+        for (int64_t kh = 0; kh < s.kH; kh++) {
+          const int64_t ih = oh * s.sH - s.pH + kh * s.dH;
+          if (ih < 0 || ih >= s.H) {
+            continue;
+          }
+          for (int64_t kw = 0; kw < s.kW; kw++) {
+            const int64_t iw = ow * s.sW - s.pW + kw * s.dW;
+            if (iw < 0 || iw >= s.W) {
+              continue;
+            }
+            const scalar_t* in_px = in + (ih * s.W + iw) * C;
+            const int64_t index = ih * s.W + iw;
+            for (int64_t c = 0; c < C; c++) {
+              const scalar_t x = in_px[c];
+              const bool take = x > out_px[c] || std::isnan(x);
+              out_px[c] = take ? x : out_px[c];
+              ind_px[c] = take ? index : ind_px[c];
+            }
+          }
+        }
+      }
+    }
+  });
+}
+
+static void max_pool2d_kernel(
+    Tensor& output, Tensor& indices, const Tensor& input,
+    IntList kernel_size, IntList stride, IntList padding, IntList dilation) {
+  const Pool2dShape s(input, output, kernel_size, stride, padding, dilation);
+  const bool contiguous = input.is_contiguous();
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "max_pool2d", [&] {
+    if (contiguous) {
+      max_pool2d_contiguous(output.data<scalar_t>(), indices.data<int64_t>(), input.data<scalar_t>(), s);
+    } else {
+      max_pool2d_channels_last(output.data<scalar_t>(), indices.data<int64_t>(), input.data<scalar_t>(), s);
+    }
+  });
+}
+
+template <typename scalar_t>
+static void max_pool2d_backward_contiguous(
+    scalar_t* gin_data, const scalar_t* gout_data, const int64_t* ind_data, const Pool2dShape& s) {
+  parallel_for(0, s.N * s.C, grain_size(s.H * s.W + s.OH * s.OW), [&](int64_t begin, int64_t end) {
+    for (int64_t plane = begin; plane < end; plane++) {
+      scalar_t* gin = gin_data + plane * s.H * s.W;
+      const scalar_t* gout = gout_data + plane * s.OH * s.OW;
+      const int64_t* ind = ind_data + plane * s.OH * s.OW;
+      std::fill(gin, gin + s.H * s.W, scalar_t(0));
+      for (int64_t o = 0; o < s.OH * s.OW; o++) {
+        if (ind[o] != -1) {
+          gin[ind[o]] += gout[o];
+        }
+      }
+    }
+  });
+}
+
+template <typename scalar_t>
+static void max_pool2d_backward_channels_last(
+    scalar_t* gin_data, const scalar_t* gout_data, const int64_t* ind_data, const Pool2dShape& s) {
+  const int64_t C = s.C;
+  const WindowCover rows(s.H, s.OH, s.kH, s.sH, s.pH, s.dH);
+  const WindowCover cols(s.W, s.OW, s.kW, s.sW, s.pW, s.dW);
+  parallel_for(0, s.N * s.H, grain_size(s.W * C * s.kH * s.kW), [&](int64_t begin, int64_t end) {
+    for (int64_t row = begin; row < end; row++) {
+      const int64_t n = row / s.H;
+      const int64_t ih = row % s.H;
+      const scalar_t* gout = gout_data + n * s.OH * s.OW * C;
+      const int64_t* ind = ind_data + n * s.OH * s.OW * C;
+      for (int64_t iw = 0; iw < s.W; iw++) {
+        scalar_t* gin_px = gin_data + (row * s.W + iw) * C;
+        const int64_t index = ih * s.W + iw;
+        std::fill(gin_px, gin_px + C, scalar_t(0));
+        for (int64_t oh = rows.begin[ih]; oh < rows.end[ih]; oh++) {
+          for (int64_t ow = cols.begin[iw]; ow < cols.end[iw]; ow++) {
+            const scalar_t* gout_px = gout + (oh * s.OW + ow) * C;
+            const int64_t* ind_px = ind + (oh * s.OW + ow) * C;
+            for (int64_t c = 0; c < C; c++) {
+              gin_px[c] += ind_px[c] == index ? gout_px[c] : scalar_t(0);
+            }
+          }
+        }
+      }
+    }
+  });
+}
+
+static void max_pool2d_backward_kernel(
+    Tensor& grad_input, const Tensor& grad_output, const Tensor& indices,
+    IntList kernel_size, IntList stride, IntList padding, IntList dilation) {
+  const Pool2dShape s(grad_input, grad_output, kernel_size, stride, padding, dilation);
+  const bool contiguous = grad_input.is_contiguous();
+  AT_DISPATCH_FLOATING_TYPES(grad_input.type(), "max_pool2d_backward", [&] {
+    if (contiguous) {
+      max_pool2d_backward_contiguous(
+          grad_input.data<scalar_t>(), grad_output.data<scalar_t>(), indices.data<int64_t>(), s);
+    } else {
+      max_pool2d_backward_channels_last(
+          grad_input.data<scalar_t>(), grad_output.data<scalar_t>(), indices.data<int64_t>(), s);
+    }
+  });
+}
+
+// Sums the input rows of each window into a row buffer, vectorized over the
+// width, and then the columns of the window from the buffer.
+template <typename scalar_t>
+static void avg_pool2d_contiguous(
+    scalar_t* out_data, const scalar_t* in_data, const Pool2dShape& s, bool count_include_pad) {
+  const auto rows = avg_windows(s.H, s.OH, s.kH, s.sH, s.pH, count_include_pad);
+  const auto cols = avg_windows(s.W, s.OW, s.kW, s.sW, s.pW, count_include_pad);
+  parallel_for(0, s.N * s.C, grain_size(s.OH * (s.kH * s.W + s.OW * s.kW)), [&](int64_t begin, int64_t end) {
+    std::vector<scalar_t> row_sum(s.W);
+    for (int64_t plane = begin; plane < end; plane++) {
+      const scalar_t* in = in_data + plane * s.H * s.W;
+      scalar_t* out = out_data + plane * s.OH * s.OW;
+      for (int64_t oh = 0; oh < s.OH; oh++) {
+        const AvgWindow& wh = rows[oh];
+        std::fill(row_sum.begin(), row_sum.end(), scalar_t(0));
+        for (int64_t ih = wh.start; ih < wh.end; ih++) {
+          add_row(row_sum.data(), in + ih * s.W, s.W);
+        }
+        for (int64_t ow = 0; ow < s.OW; ow++) {
+          const AvgWindow& ww = cols[ow];
+          scalar_t sum = 0;
+          for (int64_t iw = ww.start; iw < ww.end; iw++) {
+            sum += row_sum[iw];
+          }
+          out[oh * s.OW + ow] = sum / scalar_t(wh.count * ww.count);
+        }
+      }
+    }
+  });
+}
+
+template <typename scalar_t>
+static void avg_pool2d_channels_last(
+    scalar_t* out_data, const scalar_t* in_data, const Pool2dShape& s, bool count_include_pad) {
+  const int64_t C = s.C;
+  const auto rows = avg_windows(s.H, s.OH, s.kH, s.sH, s.pH, count_include_pad);
+  const auto cols = avg_windows(s.W, s.OW, s.kW, s.sW, s.pW, count_include_pad);
+  parallel_for(0, s.N * s.OH, grain_size(s.OW * C * s.kH * s.kW), [&](int64_t begin, int64_t end) {
+    for (int64_t row = begin; row < end; row++) {
+      const int64_t n = row / s.OH;
+      const AvgWindow& wh = rows[row % s.OH];
+      const scalar_t* in = in_data + n * s.H * s.W * C;
+      for (int64_t ow = 0; ow < s.OW; ow++) {
+        const AvgWindow& ww = cols[ow];
+        scalar_t* out_px = out_data + (row * s.OW + ow) * C;
+        std::fill(out_px, out_px + C, scalar_t(0));
+        for (int64_t ih = wh.start; ih < wh.end; ih++) {
+          for (int64_t iw = ww.start; iw < ww.end; iw++) {
+            add_row(out_px, in + (ih * s.W + iw) * C, C);
+          }
+        }
+        div_row(out_px, scalar_t(wh.count * ww.count), C);
+      }
+    }
+  });
+}
+
+static void avg_pool2d_kernel(
+    Tensor& output, const Tensor& input,
+    IntList kernel_size, IntList stride, IntList padding, bool count_include_pad) {
+  const Pool2dShape s(input, output, kernel_size, stride, padding, {1, 1});
+  const bool contiguous = input.is_contiguous();
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "avg_pool2d", [&] {
+    if (contiguous) {
+      avg_pool2d_contiguous(output.data<scalar_t>(), input.data<scalar_t>(), s, count_include_pad);
+    } else {
+      avg_pool2d_channels_last(output.data<scalar_t>(), input.data<scalar_t>(), s, count_include_pad);
+    }
+  });
+}
+
+// Divides grad_output by the divisors, then for each input row sums the rows
+// of the outputs that cover it, vectorized over the output width, and then
+// the columns of the outputs that cover each input column.
+template <typename scalar_t>
+static void avg_pool2d_backward_contiguous(
+    scalar_t* gin_data, const scalar_t* gout_data, const Pool2dShape& s, bool count_include_pad) {
+  const auto rows = avg_windows(s.H, s.OH, s.kH, s.sH, s.pH, count_include_pad);
+  const auto cols = avg_windows(s.W, s.OW, s.kW, s.sW, s.pW, count_include_pad);
+  const WindowCover row_cover(s.H, s.OH, s.kH, s.sH, s.pH, 1);
+  const WindowCover col_cover(s.W, s.OW, s.kW, s.sW, s.pW, 1);
+  parallel_for(0, s.N * s.C, grain_size(s.H * (s.kH * s.OW + s.W * s.kW)), [&](int64_t begin, int64_t end) {
+    std::vector<scalar_t> scaled(s.OH * s.OW);
+    std::vector<scalar_t> row_sum(s.OW);
+    for (int64_t plane = begin; plane < end; plane++) {
+      scalar_t* gin = gin_data + plane * s.H * s.W;
+      const scalar_t* gout = gout_data + plane * s.OH * s.OW;
+      for (int64_t oh = 0; oh < s.OH; oh++) {
+        for (int64_t ow = 0; ow < s.OW; ow++) {
+          scaled[oh * s.OW + ow] = gout[oh * s.OW + ow] / scalar_t(rows[oh].count * cols[ow].count);
+        }
+      }
+      for (int64_t ih = 0; ih < s.H; ih++) {
+        std::fill(row_sum.begin(), row_sum.end(), scalar_t(0));
+        for (int64_t oh = row_cover.begin[ih]; oh < row_cover.end[ih]; oh++) {
+          add_row(row_sum.data(), scaled.data() + oh * s.OW, s.OW);
+        }
+        for (int64_t iw = 0; iw < s.W; iw++) {
+          scalar_t sum = 0;
+          for (int64_t ow = col_cover.begin[iw]; ow < col_cover.end[iw]; ow++) {
+            sum += row_sum[ow];
+          }
+          gin[ih * s.W + iw] = sum;
+        }
+      }
+    }
+  });
+}
+
+template <typename scalar_t>
+static void avg_pool2d_backward_channels_last(
+    scalar_t* gin_data, const scalar_t* gout_data, const Pool2dShape& s, bool count_include_pad) {
+  const int64_t C = s.C;
+  const auto rows = avg_windows(s.H, s.OH, s.kH, s.sH, s.pH, count_include_pad);
+  const auto cols = avg_windows(s.W, s.OW, s.kW, s.sW, s.pW, count_include_pad);
+  const WindowCover row_cover(s.H, s.OH, s.kH, s.sH, s.pH, 1);
+  const WindowCover col_cover(s.W, s.OW, s.kW, s.sW, s.pW, 1);
+  parallel_for(0, s.N * s.H, grain_size(s.W * C * s.kH * s.kW), [&](int64_t begin, int64_t end) {
+    for (int64_t row = begin; row < end; row++) {
+      const int64_t n = row / s.H;
+      const int64_t ih = row % s.H;
+      const scalar_t* gout = gout_data + n * s.OH * s.OW * C;
+      for (int64_t iw = 0; iw < s.W; iw++) {
+        scalar_t* gin_px = gin_data + (row * s.W + iw) * C;
+        std::fill(gin_px, gin_px + C, scalar_t(0));
+        for (int64_t oh = row_cover.begin[ih]; oh < row_cover.end[ih]; oh++) {
+          for (int64_t ow = col_cover.begin[iw]; ow < col_cover.end[iw]; ow++) {
+            add_row_div(gin_px, gout + (oh * s.OW + ow) * C,
+                        scalar_t(rows[oh].count * cols[ow].count), C);
+          }
+        }
+      }
+    }
+  });
+}
+
+static void avg_pool2d_backward_kernel(
+    Tensor& grad_input, const Tensor& grad_output,
+    IntList kernel_size, IntList stride, IntList padding, bool count_include_pad) {
+  const Pool2dShape s(grad_input, grad_output, kernel_size, stride, padding, {1, 1});
+  const bool contiguous = grad_input.is_contiguous();
+  AT_DISPATCH_FLOATING_TYPES(grad_input.type(), "avg_pool2d_backward", [&] {
+    if (contiguous) {
+      avg_pool2d_backward_contiguous(
+          grad_input.data<scalar_t>(), grad_output.data<scalar_t>(), s, count_include_pad);
+    } else {
+      avg_pool2d_backward_channels_last(
+          grad_input.data<scalar_t>(), grad_output.data<scalar_t>(), s, count_include_pad);
+    }
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(max_pool2d_stub, &max_pool2d_kernel);
+REGISTER_DISPATCH(max_pool2d_backward_stub, &max_pool2d_backward_kernel);
+REGISTER_DISPATCH(avg_pool2d_stub, &avg_pool2d_kernel);
+REGISTER_DISPATCH(avg_pool2d_backward_stub, &avg_pool2d_backward_kernel);
+
+}} // namespace at::native
@@ -0,0 +1,235 @@
+#include "ATen/native/RNN.h"
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+#include <algorithm>
+
+// CPU versions of the fused LSTM and GRU cell kernels of cuda/RNN.cu. The
+// gates of each hidden element are computed in one vectorized pass, which
+// replaces the chain of add, chunk, sigmoid, tanh and mul ops (and their
+// temporaries) of the unfused cells.
+
+namespace at { namespace native { namespace {
+
+using namespace vec256;
+
+// The cells are parallel over (batch row, chunk of the hidden state), so that
+// small batches with a large hidden size still use every thread.
+constexpr int64_t kHiddenChunk = 256;
+// Every element costs a few exp/tanh, so tasks can be smaller than the usual
+// grain size.
+constexpr int64_t kGrainChunks = internal::GRAIN_SIZE / (8 * kHiddenChunk) > 0
+    ? internal::GRAIN_SIZE / (8 * kHiddenChunk)
+    : 1;
+
+template <typename F>
+void parallel_for_cells(int64_t batch, int64_t hidden, const F& f) {
+  const int64_t chunks = divup(hidden, kHiddenChunk);
+  parallel_for(0, batch * chunks, kGrainChunks, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      const int64_t row = i / chunks;
+      const int64_t j = (i % chunks) * kHiddenChunk;
+      f(row, j, std::min(j + kHiddenChunk, hidden));
+    }
+  });
+}
+
+template <typename scalar_t>
+inline Vec256<scalar_t> sigmoid(const Vec256<scalar_t>& x) {
+  return (Vec256<scalar_t>(1) + x.neg().exp()).reciprocal();
+}
+
+// input_gates + hidden_gates (+ both biases) of gate g of count elements
+// starting at hidden element j. The gate rows are laid out as g * hidden + j.
+template <typename scalar_t>
+inline Vec256<scalar_t> load_gate(
+    const scalar_t* igates, const scalar_t* hgates, const scalar_t* ibias,
+    const scalar_t* hbias, int64_t offset, int64_t count) {
+  using Vec = Vec256<scalar_t>;
+  Vec x = Vec::loadu(igates + offset, count) + Vec::loadu(hgates + offset, count);
+  if (ibias) {
+    x = x + Vec::loadu(ibias + offset, count) + Vec::loadu(hbias + offset, count);
+  }
+  return x;
+}
+
+template <typename scalar_t>
+const scalar_t* data_or_null(const Tensor& t) {
+  return t.defined() ? t.data<scalar_t>() : nullptr;
+}
+
+void lstm_cell_kernel(
+    const Tensor& input_gates, const Tensor& hidden_gates, const Tensor& input_bias,
+    const Tensor& hidden_bias, const Tensor& cx, Tensor& hy, Tensor& cy, Tensor& workspace) {
+  const int64_t batch = cx.size(0);
+  const int64_t H = cx.size(1);
+  AT_DISPATCH_FLOATING_TYPES(cx.type(), "lstm_cell", [&] {
+    using Vec = Vec256<scalar_t>;
+    const scalar_t* igates = input_gates.data<scalar_t>();
+    const scalar_t* hgates = hidden_gates.data<scalar_t>();
+    const scalar_t* ibias = data_or_null<scalar_t>(input_bias);
+    const scalar_t* hbias = data_or_null<scalar_t>(hidden_bias);
+    const scalar_t* cx_data = cx.data<scalar_t>();
+    scalar_t* hy_data = hy.data<scalar_t>();
+    scalar_t* cy_data = cy.data<scalar_t>();
+    scalar_t* ws = workspace.data<scalar_t>();
+    parallel_for_cells(batch, H, [&](int64_t b, int64_t begin, int64_t end) {
+      const int64_t g_row = b * 4 * H;
+      for (int64_t j = begin; j < end; j += Vec::size) {
+        const int64_t count = std::min<int64_t>(Vec::size, end - j);
+        auto gate = [&](int64_t g) {
+          return load_gate(igates + g_row, hgates + g_row, ibias, hbias, g * H + j, count);
+        };
+        Vec ig = sigmoid(gate(0));
+        Vec fg = sigmoid(gate(1));
+        Vec cg = gate(2).tanh();
+        Vec og = sigmoid(gate(3));
+        Vec c = fg * Vec::loadu(cx_data + b * H + j, count) + ig * cg;
+        Vec h = og * c.tanh();
+        c.store(cy_data + b * H + j, count);
+        h.store(hy_data + b * H + j, count);
+        ig.store(ws + g_row + 0 * H + j, count);
+        fg.store(ws + g_row + 1 * H + j, count);
+        cg.store(ws + g_row + 2 * H + j, count);
+        og.store(ws + g_row + 3 * H + j, count);
+      }
+    });
+  });
+}
+
+void lstm_cell_backward_kernel(
+    const Tensor& grad_hy, const Tensor& grad_cy, const Tensor& cx, const Tensor& cy,
+    const Tensor& workspace, Tensor& grad_gates, Tensor& grad_cx) {
+  const int64_t batch = cx.size(0);
+  const int64_t H = cx.size(1);
+  AT_DISPATCH_FLOATING_TYPES(cx.type(), "lstm_cell_backward", [&] {
+    using Vec = Vec256<scalar_t>;
+    const scalar_t* ghy = data_or_null<scalar_t>(grad_hy);
+    const scalar_t* gcy = data_or_null<scalar_t>(grad_cy);
+    const scalar_t* cx_data = cx.data<scalar_t>();
+    const scalar_t* cy_data = cy.data<scalar_t>();
+    const scalar_t* ws = workspace.data<scalar_t>();
+    scalar_t* gg = grad_gates.data<scalar_t>();
+    scalar_t* gcx_data = grad_cx.data<scalar_t>();
+    parallel_for_cells(batch, H, [&](int64_t b, int64_t begin, int64_t end) {
+      const Vec one(1);
+      const int64_t g_row = b * 4 * H;
+      for (int64_t j = begin; j < end; j += Vec::size) {
+        const int64_t count = std::min<int64_t>(Vec::size, end - j);
+        const int64_t h = b * H + j;
+        Vec ig = Vec::loadu(ws + g_row + 0 * H + j, count);
+        Vec fg = Vec::loadu(ws + g_row + 1 * H + j, count);
+        Vec cg = Vec::loadu(ws + g_row + 2 * H + j, count);
+        Vec og = Vec::loadu(ws + g_row + 3 * H + j, count);
+        Vec go = ghy ? Vec::loadu(ghy + h, count) : Vec(0);
+        Vec goc = gcy ? Vec::loadu(gcy + h, count) : Vec(0);
+
+        Vec tanh_cy = Vec::loadu(cy_data + h, count).tanh();
+        Vec gog = go * tanh_cy;
+        Vec gc = go * og * (one - tanh_cy * tanh_cy) + goc;
+        Vec gig = gc * cg * (one - ig) * ig;
+        Vec gfg = gc * Vec::loadu(cx_data + h, count) * (one - fg) * fg;
+        Vec gcg = gc * ig * (one - cg * cg);
+        gog = gog * (one - og) * og;
+
+        gig.store(gg + g_row + 0 * H + j, count);
+        gfg.store(gg + g_row + 1 * H + j, count);
+        gcg.store(gg + g_row + 2 * H + j, count);
+        gog.store(gg + g_row + 3 * H + j, count);
+        (gc * fg).store(gcx_data + h, count);
+      }
+    });
+  });
+}
+
+void gru_cell_kernel(
+    const Tensor& input_gates, const Tensor& hidden_gates, const Tensor& input_bias,
+    const Tensor& hidden_bias, const Tensor& hx, Tensor& hy, Tensor& workspace) {
+  const int64_t batch = hx.size(0);
+  const int64_t H = hx.size(1);
+  AT_DISPATCH_FLOATING_TYPES(hx.type(), "gru_cell", [&] {
+    using Vec = Vec256<scalar_t>;
+    const scalar_t* igates = input_gates.data<scalar_t>();
+    const scalar_t* hgates = hidden_gates.data<scalar_t>();
+    const scalar_t* ibias = data_or_null<scalar_t>(input_bias);
+    const scalar_t* hbias = data_or_null<scalar_t>(hidden_bias);
+    const scalar_t* hx_data = hx.data<scalar_t>();
+    scalar_t* hy_data = hy.data<scalar_t>();
+    scalar_t* ws = workspace.data<scalar_t>();
+    parallel_for_cells(batch, H, [&](int64_t b, int64_t begin, int64_t end) {
+      const int64_t g_row = b * 3 * H;
+      const int64_t w_row = b * 5 * H;
+      for (int64_t j = begin; j < end; j += Vec::size) {
+        const int64_t count = std::min<int64_t>(Vec::size, end - j);
+        Vec rg = sigmoid(load_gate(igates + g_row, hgates + g_row, ibias, hbias, 0 * H + j, count));
+        Vec ig = sigmoid(load_gate(igates + g_row, hgates + g_row, ibias, hbias, 1 * H + j, count));
+        Vec in = Vec::loadu(igates + g_row + 2 * H + j, count);
+        Vec hn = Vec::loadu(hgates + g_row + 2 * H + j, count);
+        if (ibias) {
+          in = in + Vec::loadu(ibias + 2 * H + j, count);
+          hn = hn + Vec::loadu(hbias + 2 * H + j, count);
+        }
+        Vec ng = (in + rg * hn).tanh();
+        Vec h = Vec::loadu(hx_data + b * H + j, count);
+        (ng + ig * (h - ng)).store(hy_data + b * H + j, count);
+        rg.store(ws + w_row + 0 * H + j, count);
+        ig.store(ws + w_row + 1 * H + j, count);
+        ng.store(ws + w_row + 2 * H + j, count);
+        h.store(ws + w_row + 3 * H + j, count);
+        hn.store(ws + w_row + 4 * H + j, count);
+      }
+    });
+  });
+}
+
+void gru_cell_backward_kernel(
+    const Tensor& grad_hy, const Tensor& workspace, Tensor& grad_input_gates,
+    Tensor& grad_hidden_gates, Tensor& grad_hx) {
+  const int64_t batch = grad_hy.size(0);
+  const int64_t H = grad_hy.size(1);
+  AT_DISPATCH_FLOATING_TYPES(grad_hy.type(), "gru_cell_backward", [&] {
+    using Vec = Vec256<scalar_t>;
+    const scalar_t* go_data = grad_hy.data<scalar_t>();
+    const scalar_t* ws = workspace.data<scalar_t>();
+    scalar_t* gi = grad_input_gates.data<scalar_t>();
+    scalar_t* gh = grad_hidden_gates.data<scalar_t>();
+    scalar_t* ghx_data = grad_hx.data<scalar_t>();
+    parallel_for_cells(batch, H, [&](int64_t b, int64_t begin, int64_t end) {
+      const Vec one(1);
+      const int64_t g_row = b * 3 * H;
+      const int64_t w_row = b * 5 * H;
+      for (int64_t j = begin; j < end; j += Vec::size) {
+        const int64_t count = std::min<int64_t>(Vec::size, end - j);
+        Vec rg = Vec::loadu(ws + w_row + 0 * H + j, count);
+        Vec ig = Vec::loadu(ws + w_row + 1 * H + j, count);
+        Vec ng = Vec::loadu(ws + w_row + 2 * H + j, count);
+        Vec hx = Vec::loadu(ws + w_row + 3 * H + j, count);
+        Vec hn = Vec::loadu(ws + w_row + 4 * H + j, count);
+        Vec go = Vec::loadu(go_data + b * H + j, count);
+
+        Vec gig = go * (hx - ng) * (one - ig) * ig;
+        Vec gin = go * (one - ig) * (one - ng * ng);
+        Vec grg = gin * hn * (one - rg) * rg;
+
+        grg.store(gi + g_row + 0 * H + j, count);
+        gig.store(gi + g_row + 1 * H + j, count);
+        gin.store(gi + g_row + 2 * H + j, count);
+        grg.store(gh + g_row + 0 * H + j, count);
+        gig.store(gh + g_row + 1 * H + j, count);
+        (gin * rg).store(gh + g_row + 2 * H + j, count);
+        (go * ig).store(ghx_data + b * H + j, count);
+      }
+    });
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(lstm_cell_stub, &lstm_cell_kernel);
+REGISTER_DISPATCH(lstm_cell_backward_stub, &lstm_cell_backward_kernel);
+REGISTER_DISPATCH(gru_cell_stub, &gru_cell_kernel);
+REGISTER_DISPATCH(gru_cell_backward_stub, &gru_cell_backward_kernel);
+
+}} // namespace at::native
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <ATen/Parallel.h>
+#include <ATen/detail/FunctionTraits.h>
+#include <ATen/native/TensorIterator.h>
+
+#include <tuple>
+#include <utility>
+
+// Kernels for reductions built with TensorIterator::reduce_op. See
+// Note [Reductions] in TensorIterator.h.
+//
+// A reduction is described by an `ops` object with three const member
+// functions:
+//
+//   acc_t reduce(acc_t acc, data_t data, int64_t idx)  // folds in one element
+//   acc_t combine(acc_t a, acc_t b)                    // merges two partials
+//   out_t project(acc_t acc)                           // computes the result
+//
+// `idx` is the linear index of the element within the reduced dimensions.
+// The accumulator is usually of type acc_type<scalar_t, false>, or a struct
+// of such values. `project` returns a std::pair for reductions with two
+// outputs, such as max with indices.
+//
+// See WelfordOps in ReduceOpsKernel.cpp and ArgReduceOps in
+// TensorCompareKernel.cpp for examples.
+
+namespace at { namespace native { namespace {
+
+template <typename out_t>
+static inline void set_results(const out_t& result, char** outputs) {
+  *(out_t*)outputs[0] = result;
+}
+
+template <typename T1, typename T2>
+static inline void set_results(const std::pair<T1, T2>& result, char** outputs) {
+  *(T1*)outputs[0] = result.first;
+  *(T2*)outputs[1] = result.second;
+}
+
+template <typename ops_t, typename acc_t, typename data_t>
+static inline acc_t reduce_range(
+    TensorIterator& sub_iter, const ops_t& ops, acc_t init, int64_t begin, int64_t size) {
+  acc_t acc = init;
+  int input = sub_iter.noutputs();
+  int64_t idx = begin;
+  auto base_ptrs = sub_iter.get_base_ptrs();
+  auto inner_strides = sub_iter.get_inner_strides();
+  sub_iter.serial_for_each([&](int ntensors, char** data, const int64_t* strides, int64_t n) {
+    const char* in = data[input];
+    int64_t stride = strides[input];
+    for (int64_t i = 0; i < n; i++) {
+      acc = ops.reduce(acc, *(const data_t*)(in + i * stride), idx + i);
+    }
+    idx += n;
+  }, base_ptrs, inner_strides, begin, size);
+  return acc;
+}
+
+template <typename ops_t, typename init_t>
+void binary_kernel_reduce(TensorIterator& iter, ops_t ops, init_t init) {
+  using traits = function_traits<decltype(&ops_t::reduce)>;
+  using acc_t = typename traits::result_type;
+  using data_t = typename traits::template arg<1>::type;
+  static_assert(
+    std::is_convertible<init_t, acc_t>::value,
+    "the initial value must be convertible to the accumulator type");
+
+  iter.foreach_reduced_elt([&](TensorIterator& sub_iter) {
+    int64_t numel = sub_iter.numel();
+    acc_t total;
+    if (numel < internal::GRAIN_SIZE || get_num_threads() == 1 || in_parallel_region()) {
+      total = reduce_range<ops_t, acc_t, data_t>(sub_iter, ops, init, 0, numel);
+    } else {
+      // A single output element with a large reduction: split the input
+      // across threads and combine the partial results in order.
+      total = parallel_reduce(0, numel, internal::GRAIN_SIZE, (acc_t)init,
+        [&](int64_t begin, int64_t end, acc_t ident) {
+          return reduce_range<ops_t, acc_t, data_t>(sub_iter, ops, ident, begin, end - begin);
+        },
+        [&](acc_t a, acc_t b) { return ops.combine(a, b); });
+    }
+    AT_ASSERT(sub_iter.noutputs() <= 2);
+    char* outputs[2];
+    for (int arg = 0; arg < sub_iter.noutputs(); arg++) {
+      outputs[arg] = (char*)sub_iter.data_ptr(arg);
+    }
+    set_results(ops.project(total), outputs);
+  });
+}
+
+}}}  // namespace at::native::<anonymous>
@@ -3,15 +3,19 @@
 #include <numeric>
 #include <iterator>
 #include <algorithm>
+#include <cmath>
 
+#include "ATen/AccumulateType.h"
 #include "ATen/Dispatch.h"
 #include "ATen/Parallel.h"
 #include "ATen/core/optional.h"
-#include "ATen/cpu/vec256/vec256.h"
+#include "ATen/native/TensorIterator.h"
+#include "ATen/native/cpu/Reduce.h"
+#include "ATen/native/cpu/Vectorized.h"
 
 namespace at { namespace native { namespace {
 
-using namespace vec256;
+using namespace vec;
 
 static inline int64_t round_down(int64_t a, int64_t m) {
   return a - (a % m);
@@ -42,7 +46,9 @@ struct Reduction {
   // reduction width in number of scalar elements
   static constexpr int WIDTH = 128 / sizeof(scalar_t);
 
-  using Vec = Vec256<scalar_t>;
+  using Vec = Vectorized<scalar_t>;
+  // number of vectors covering the reduction width
+  static constexpr int NUM_VECS = 128 / sizeof(Vec);
   using Reduce = Op<Vec>;
   using ReduceScalar = Op<scalar_t>;
 
@@ -157,20 +163,209 @@ struct Reduction {
   // Reduce down a column of WIDTH elements (128 bytes) with the given number
   // of rows. Stores the results in out[0 ... WIDTH-1].
   static void reduce128(const scalar_t* data, scalar_t* out, int64_t rows, int64_t stride) {
-    Vec acc[4] = {ident, ident, ident, ident};  // 128 bytes (two cache lines)
+    Vec acc[NUM_VECS];  // 128 bytes (two cache lines)
     static_assert(sizeof(acc) == 128, "accumulator should be 128 bytes");
+    for (int j = 0; j != NUM_VECS; j++) {
+      acc[j] = Vec(ident);
+    }
     for (int64_t row = 0; row != rows; row++) {
-      for (int j = 0; j != 4; j++) {
+      for (int j = 0; j != NUM_VECS; j++) {
         auto val = Vec::loadu(&data[row * stride + j * Vec::size]);
         acc[j] = Reduce()(acc[j], val);
       }
     }
-    for (int j = 0; j != 4; j++) {
+    for (int j = 0; j != NUM_VECS; j++) {
       acc[j].store(&out[j * Vec::size]);
     }
   }
 };
 
+// Vectorized p-norm for p = 1 and p = 2. The absolute values (or squares) of
+// the elements are summed up like in `Reduction`, 128 bytes at a time, and
+// the root is taken when a result is stored.
+template<typename scalar_t, int p>
+struct NormReduction {
+  // reduction width in number of scalar elements
+  static constexpr int WIDTH = 128 / sizeof(scalar_t);
+
+  using Vec = Vectorized<scalar_t>;
+  // number of vectors covering the reduction width
+  static constexpr int NUM_VECS = 128 / sizeof(Vec);
+
+  static Vec map(Vec x) {
+    return p == 1 ? x.abs() : x * x;
+  }
+
+  static scalar_t map(scalar_t x) {
+    return p == 1 ? std::abs(x) : x * x;
+  }
+
+  static scalar_t finish(scalar_t x) {
+    return p == 1 ? x : std::sqrt(x);
+  }
+
+  static void apply(Tensor& res, const Tensor& self, int64_t dim) {
+    auto out_ = res.data<scalar_t>();
+    auto data_ = self.data<scalar_t>();
+    auto numel = self.numel();
+
+    int64_t n = self.size(dim);
+    int64_t stride = self.stride(dim);
+    // A contiguous tensor does not need to hold a meaningful stride
+    // if the corresponding size is 1
+    if (n == 1) {
+      stride = 1;
+      for (int64_t i = self.ndimension() - 1; i > dim; i--) {
+        stride *= self.size(i);
+      }
+    }
+    int64_t batch = numel / (n * stride);
+    if (stride == 1) {
+      int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / n);
+      parallel_for(0, batch, grain_size, [=](int64_t begin, int64_t end) {
+        for (int64_t b = begin; b < end; b++) {
+          const scalar_t* data = &data_[b * n];
+          scalar_t buf[WIDTH];
+          int64_t cols_rounded = n / WIDTH;
+          reduce128(data, buf, cols_rounded, WIDTH);
+          scalar_t result = std::accumulate(buf, buf + WIDTH, (scalar_t)0);
+          for (int64_t col = cols_rounded * WIDTH; col != n; col++) {
+            result += map(data[col]);
+          }
+          out_[b] = finish(result);
+        }
+      });
+    } else {
+      int64_t cols_rounded = round_down(stride, WIDTH);
+      int64_t blocks = cols_rounded / WIDTH + (cols_rounded != stride);
+      int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / (n * WIDTH));
+      parallel_for(0, batch * blocks, grain_size, [=](int64_t begin, int64_t end) {
+        for (int64_t bi = begin; bi < end; bi++) {
+          int64_t b = bi / blocks;
+          int64_t k = (bi % blocks) * WIDTH;
+          const scalar_t* data = &data_[b * n * stride + k];
+          scalar_t* out = &out_[b * stride + k];
+          int64_t cols = std::min<int64_t>(WIDTH, stride - k);
+          if (cols == WIDTH) {
+            reduce128(data, out, n, stride);
+          } else {
+            scalar_t buf[WIDTH] = {0};
+            for (int64_t row = 0; row != n; row++) {
+              for (int64_t j = 0; j != cols; j++) {
+                buf[j] += map(data[row * stride + j]);
+              }
+            }
+            std::copy(buf, buf + cols, out);
+          }
+          for (int64_t j = 0; j != cols; j++) {
+            out[j] = finish(out[j]);
+          }
+        }
+      });
+    }
+  }
+
+  // Sums up `map` of a column of WIDTH elements (128 bytes) with the given
+  // number of rows. Stores the results in out[0 ... WIDTH-1].
+  static void reduce128(const scalar_t* data, scalar_t* out, int64_t rows, int64_t stride) {
+    Vec acc[NUM_VECS];  // 128 bytes (two cache lines)
+    static_assert(sizeof(acc) == 128, "accumulator should be 128 bytes");
+    for (int j = 0; j != NUM_VECS; j++) {
+      acc[j] = Vec(0);
+    }
+    for (int64_t row = 0; row != rows; row++) {
+      for (int j = 0; j != NUM_VECS; j++) {
+        auto val = Vec::loadu(&data[row * stride + j * Vec::size]);
+        acc[j] = acc[j] + map(val);
+      }
+    }
+    for (int j = 0; j != NUM_VECS; j++) {
+      acc[j].store(&out[j * Vec::size]);
+    }
+  }
+};
+
+template <typename acc_scalar_t>
+struct WelfordData {
+  acc_scalar_t mean = 0;
+  acc_scalar_t m2 = 0;
+  int64_t n = 0;
+};
+
+// Welford's algorithm, like the TH kernels. Partial results are merged with
+// the parallel formula of Chan et al.
+template <typename scalar_t, typename acc_scalar_t>
+struct WelfordOps {
+  using acc_t = WelfordData<acc_scalar_t>;
+  bool unbiased;
+  bool take_sqrt;
+
+  acc_t reduce(acc_t acc, scalar_t data, int64_t /*idx*/) const {
+    acc_scalar_t delta = data - acc.mean;
+    acc.n++;
+    acc.mean += delta / acc.n;
+    acc.m2 += delta * (data - acc.mean);
+    return acc;
+  }
+
+  acc_t combine(acc_t a, acc_t b) const {
+    if (a.n == 0) {
+      return b;
+    }
+    if (b.n == 0) {
+      return a;
+    }
+    acc_t result;
+    acc_scalar_t delta = b.mean - a.mean;
+    result.n = a.n + b.n;
+    acc_scalar_t nb_over_n = (acc_scalar_t)b.n / result.n;
+    result.mean = a.mean + delta * nb_over_n;
+    result.m2 = a.m2 + b.m2 + delta * delta * a.n * nb_over_n;
+    return result;
+  }
+
+  // One element has variance 0 when biased, and NaN (0 / 0) when unbiased.
+  acc_scalar_t std_var(acc_t acc) const {
+    int64_t divisor = unbiased ? acc.n - 1 : acc.n;
+    acc_scalar_t var = acc.m2 / divisor;
+    return take_sqrt ? std::sqrt(var) : var;
+  }
+
+  scalar_t project(acc_t acc) const {
+    return std_var(acc);
+  }
+};
+
+// Like WelfordOps, with the mean as a second output (var_mean, std_mean).
+template <typename scalar_t, typename acc_scalar_t>
+struct WelfordMeanOps : public WelfordOps<scalar_t, acc_scalar_t> {
+  using acc_t = WelfordData<acc_scalar_t>;
+
+  WelfordMeanOps(bool unbiased, bool take_sqrt)
+    : WelfordOps<scalar_t, acc_scalar_t>{unbiased, take_sqrt} {}
+
+  std::pair<scalar_t, scalar_t> project(acc_t acc) const {
+    return std::pair<scalar_t, scalar_t>(this->std_var(acc), acc.mean);
+  }
+};
+
+static void std_var_kernel_impl(TensorIterator& iter, bool unbiased, bool take_sqrt) {
+  AT_DISPATCH_FLOATING_TYPES(iter.type(), "std", [&] {
+    using accscalar_t = acc_type<scalar_t, false>;
+    if (iter.noutputs() == 2) {
+      binary_kernel_reduce(
+          iter,
+          WelfordMeanOps<scalar_t, accscalar_t>(unbiased, take_sqrt),
+          WelfordData<accscalar_t>());
+    } else {
+      binary_kernel_reduce(
+          iter,
+          WelfordOps<scalar_t, accscalar_t> { unbiased, take_sqrt },
+          WelfordData<accscalar_t>());
+    }
+  });
+}
+
 static void sum_kernel_impl(Tensor& result, const Tensor& self, at::optional<int64_t> dim) {
   AT_DISPATCH_ALL_TYPES(self.type(), "sum", [&] {
     Reduction<scalar_t, std::plus, 0>::apply(result, self, dim);
@@ -183,9 +378,21 @@ static void prod_kernel_impl(Tensor& result, const Tensor& self, at::optional<in
   });
 }
 
+static void norm_kernel_impl(Tensor& result, const Tensor& self, Scalar p, int64_t dim) {
+  AT_DISPATCH_FLOATING_TYPES(self.type(), "norm", [&] {
+    if (p.toDouble() == 1) {
+      NormReduction<scalar_t, 1>::apply(result, self, dim);
+    } else {
+      NormReduction<scalar_t, 2>::apply(result, self, dim);
+    }
+  });
+}
+
 }  // anonymous namespace
 
 REGISTER_DISPATCH(sum_kernel, &sum_kernel_impl);
 REGISTER_DISPATCH(prod_kernel, &prod_kernel_impl);
+REGISTER_DISPATCH(norm_kernel, &norm_kernel_impl);
+REGISTER_DISPATCH(std_var_stub, &std_var_kernel_impl);
 
 }}  // namespace at::native
@@ -4,6 +4,8 @@
 #include <ATen/core/optional.h>
 #include <ATen/native/DispatchStub.h>
 
+namespace at { struct TensorIterator; }
+
 namespace at { namespace native {
 
 using reduce_fn = void(*)(Tensor &, const Tensor &, at::optional<int64_t>);
@@ -11,4 +13,24 @@ using reduce_fn = void(*)(Tensor &, const Tensor &, at::optional<int64_t>);
 DECLARE_DISPATCH(reduce_fn, sum_kernel);
 DECLARE_DISPATCH(reduce_fn, prod_kernel);
 
+// p-norm along a dimension of a contiguous floating point tensor; p must be
+// 1 or 2.
+using norm_fn = void(*)(Tensor &, const Tensor &, Scalar, int64_t);
+
+DECLARE_DISPATCH(norm_fn, norm_kernel);
+
+// Variance or standard deviation of a TensorIterator reduction, computed in
+// one pass with Welford's algorithm. If the iterator has a second output, the
+// mean is written to it.
+using std_var_fn = void(*)(TensorIterator&, bool unbiased, bool take_sqrt);
+
+DECLARE_DISPATCH(std_var_fn, std_var_stub);
+
+// Sum or product of a TensorIterator reduction. Only implemented for CUDA,
+// where the iterator must use 32-bit indexing.
+using reduce_iter_fn = void(*)(TensorIterator&);
+
+DECLARE_DISPATCH(reduce_iter_fn, sum_iter_stub);
+DECLARE_DISPATCH(reduce_iter_fn, prod_iter_stub);
+
 }} // namespace at::native
@@ -3,10 +3,16 @@
 #include <numeric>
 #include <iterator>
 #include <algorithm>
+#include <cmath>
+#include <functional>
+#include <utility>
 
 #include "ATen/Dispatch.h"
 #include "ATen/Parallel.h"
 #include "ATen/optional.h"
+#include "ATen/native/TensorIterator.h"
+#include "ATen/native/cpu/Loops.h"
+#include "ATen/native/cpu/Reduce.h"
 
 namespace at { namespace native { namespace {
 
@@ -25,9 +31,75 @@ bool _isnan(double val) {
   return std::isnan(val);
 }
 
-template <typename scalar_t, typename index_t>
+// Reduction keeping the first NaN or otherwise the value `v` for which
+// `Compare()(v, other)` holds for all others, together with its index. Among
+// equal values the one with the highest index is kept.
+//
+// The inner loops are written so that the compiler can vectorize them: rows
+// are reduced in LANES interleaved lanes that are combined at the end, and
+// reductions over an outer dimension update a whole contiguous row of results
+// at a time instead of walking down every column separately.
+template <typename scalar_t, typename index_t, typename Compare>
 struct Reduction {
-  static void apply(Tensor& res, Tensor& res_indices, const Tensor& self, at::optional<int64_t> dim, bool greater) {
+  static constexpr int64_t LANES = 16;
+
+  using Result = std::pair<scalar_t, index_t>;
+
+  // Whether `current` is kept over `value`, which comes after it.
+  static inline bool keep(scalar_t current, scalar_t value) {
+    return Compare()(current, value) || _isnan<scalar_t>(current);
+  }
+
+  // Combines the results of two consecutive ranges. An index of -1 marks an
+  // empty range.
+  static Result combine(Result a, Result b) {
+    if (a.second < 0) return b;
+    if (b.second < 0) return a;
+    return keep(a.first, b.first) ? a : b;
+  }
+
+  // Combines the results of two interleaved ranges.
+  static Result combine_lanes(Result a, Result b) {
+    bool a_nan = _isnan<scalar_t>(a.first);
+    bool b_nan = _isnan<scalar_t>(b.first);
+    if (a_nan || b_nan) {
+      return a_nan && (!b_nan || a.second < b.second) ? a : b;
+    }
+    if (Compare()(a.first, b.first)) return a;
+    if (Compare()(b.first, a.first)) return b;
+    return a.second > b.second ? a : b;
+  }
+
+  static Result reduce_row(const scalar_t* data, int64_t begin, int64_t end) {
+    Result result {data[begin], begin};
+    int64_t k = begin + 1;
+    if (end - begin >= 2 * LANES) {
+      scalar_t values[LANES];
+      index_t indices[LANES];
+      for (int64_t l = 0; l < LANES; l++) {
+        values[l] = data[begin + l];
+        indices[l] = begin + l;
+      }
+      for (k = begin + LANES; k + LANES <= end; k += LANES) {
+        for (int64_t l = 0; l < LANES; l++) {
+          scalar_t value = data[k + l];
+          bool cmp = keep(values[l], value);
+          values[l] = cmp ? values[l] : value;
+          indices[l] = cmp ? indices[l] : k + l;
+        }
+      }
+      result = {values[0], indices[0]};
+      for (int64_t l = 1; l < LANES; l++) {
+        result = combine_lanes(result, {values[l], indices[l]});
+      }
+    }
+    for (; k < end; k++) {
+      result = combine(result, {data[k], k});
+    }
+    return result;
+  }
+
+  static void apply(Tensor& res, Tensor& res_indices, const Tensor& self, at::optional<int64_t> dim) {
     auto out_ = res.data<scalar_t>();
     auto indices_ = res_indices.data<index_t>();
     auto data_ = self.data<scalar_t>();
@@ -43,44 +115,54 @@ struct Reduction {
       }
     }
     int64_t batch = numel / (n * stride);
-    if (stride == 1) {
-      parallel_for(0, batch, 1, [=](int64_t begin, int64_t end) {
+    if (stride == 1 && batch == 1) {
+      // A single long row (e.g. argmax of a flattened tensor) is split up
+      auto result = parallel_reduce(
+          0,
+          n,
+          internal::GRAIN_SIZE,
+          Result(0, -1),
+          [data_](int64_t begin, int64_t end, Result ident) {
+            return reduce_row(data_, begin, end);
+          },
+          combine);
+      *out_ = result.first;
+      *indices_ = result.second;
+    } else if (stride == 1) {
+      int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / n);
+      parallel_for(0, batch, grain_size, [=](int64_t begin, int64_t end) {
         for (int64_t b = begin; b < end; b++) {
-          const scalar_t* data = &data_[b * n];
-          scalar_t result = data[0];
-          index_t result_index = 0;
-          for (int64_t k = 0; k < n; k++) {
-            scalar_t value = data[k];
-            bool cmp = greater ? (result > value) : (result < value);
-            result = cmp ? result : value;
-            result_index = cmp ? result_index : k;
-            if (_isnan<scalar_t>(result)) {
-              break;
-            }
-          }
-          out_[b] = result;
-          indices_[b] = result_index;
-        }             
+          auto result = reduce_row(&data_[b * n], 0, n);
+          out_[b] = result.first;
+          indices_[b] = result.second;
+        }
       });
     } else {
-      parallel_for(0, batch * stride, 1, [=](int64_t begin, int64_t end) {
-        for (int64_t bi = begin; bi < end; bi++) {
+      int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / n);
+      parallel_for(0, batch * stride, grain_size, [=](int64_t begin, int64_t end) {
+        int64_t bi = begin;
+        while (bi < end) {
+          // Columns [i, i_end) of batch b
           int64_t b = bi / stride;
           int64_t i = bi % stride;
-          const scalar_t* data = &data_[b * n * stride + i];
-          scalar_t result = data[0];
-          index_t result_index = 0;
-          for (int64_t k = 0; k < n; k++) {
-            scalar_t value = data[k * stride];
-            bool cmp = greater ? (result > value) : (result < value);
-            result = cmp ? result : value;
-            result_index = cmp ? result_index : k;
-            if (_isnan<scalar_t>(result)) {
-              break;
+          int64_t i_end = std::min(stride, i + (end - bi));
+          const scalar_t* data = &data_[b * n * stride];
+          scalar_t* out = &out_[b * stride];
+          index_t* indices = &indices_[b * stride];
+          for (int64_t j = i; j < i_end; j++) {
+            out[j] = data[j];
+            indices[j] = 0;
+          }
+          for (int64_t k = 1; k < n; k++) {
+            const scalar_t* row = &data[k * stride];
+            for (int64_t j = i; j < i_end; j++) {
+              scalar_t value = row[j];
+              bool cmp = keep(out[j], value);
+              out[j] = cmp ? out[j] : value;
+              indices[j] = cmp ? indices[j] : k;
             }
           }
-          out_[b * stride + i] = result;
-          indices_[b * stride + i] = result_index;
+          bi += i_end - i;
         }
       });
     }
@@ -89,13 +171,55 @@ struct Reduction {
 
 static void max_kernel_impl(Tensor& max, Tensor& max_indices, const Tensor& self, at::optional<int64_t> dim) {
   AT_DISPATCH_ALL_TYPES(self.type(), "max", [&] {
-    Reduction<scalar_t, int64_t>::apply(max, max_indices, self, dim, true);
+    Reduction<scalar_t, int64_t, std::greater<scalar_t>>::apply(max, max_indices, self, dim);
   });
 }
 
 static void min_kernel_impl(Tensor& min, Tensor& min_indices, const Tensor& self, at::optional<int64_t> dim) {
   AT_DISPATCH_ALL_TYPES(self.type(), "min", [&] {
-    Reduction<scalar_t, int64_t>::apply(min, min_indices, self, dim, false);
+    Reduction<scalar_t, int64_t, std::less<scalar_t>>::apply(min, min_indices, self, dim);
+  });
+}
+
+// The same reduction for arbitrary strides, as a TensorIterator reduction
+// with the values and indices as outputs.
+template <typename scalar_t, typename Compare>
+struct ArgReduceOps {
+  using R = Reduction<scalar_t, int64_t, Compare>;
+  using acc_t = typename R::Result;
+
+  acc_t reduce(acc_t acc, scalar_t data, int64_t idx) const {
+    return R::combine(acc, acc_t(data, idx));
+  }
+
+  acc_t combine(acc_t a, acc_t b) const {
+    return R::combine(a, b);
+  }
+
+  acc_t project(acc_t acc) const {
+    return acc;
+  }
+};
+
+static void max_reduce_kernel_impl(TensorIterator& iter) {
+  AT_DISPATCH_ALL_TYPES(iter.type(), "max", [&] {
+    using ops_t = ArgReduceOps<scalar_t, std::greater<scalar_t>>;
+    binary_kernel_reduce(iter, ops_t(), typename ops_t::acc_t(0, -1));
+  });
+}
+
+static void min_reduce_kernel_impl(TensorIterator& iter) {
+  AT_DISPATCH_ALL_TYPES(iter.type(), "min", [&] {
+    using ops_t = ArgReduceOps<scalar_t, std::less<scalar_t>>;
+    binary_kernel_reduce(iter, ops_t(), typename ops_t::acc_t(0, -1));
+  });
+}
+
+static void where_kernel_impl(TensorIterator& iter) {
+  AT_DISPATCH_ALL_TYPES(iter.type(), "where", [&] {
+    ternary_kernel(iter, [](uint8_t cond, scalar_t a, scalar_t b) -> scalar_t {
+      return cond ? a : b;
+    });
   });
 }
 
@@ -103,5 +227,33 @@ static void min_kernel_impl(Tensor& min, Tensor& min_indices, const Tensor& self
 
 REGISTER_DISPATCH(max_kernel, &max_kernel_impl);
 REGISTER_DISPATCH(min_kernel, &min_kernel_impl);
+REGISTER_DISPATCH(max_reduce_stub, &max_reduce_kernel_impl);
+REGISTER_DISPATCH(min_reduce_stub, &min_reduce_kernel_impl);
+REGISTER_DISPATCH(where_stub, &where_kernel_impl);
+
+// The inputs have the type of operand 1. The output is either a Byte mask or
+// has the same type for the in-place variants.
+#define IMPLEMENT_COMPARISON_KERNEL(op, cmp)                             \
+  static void op##_kernel(TensorIterator& iter) {                        \
+    AT_DISPATCH_ALL_TYPES(iter.type(1), #op, [&] {                       \
+      if (iter.dtype(0) == iter.dtype(1)) {                              \
+        binary_kernel(iter, [](scalar_t a, scalar_t b) -> scalar_t {     \
+          return a cmp b;                                                \
+        });                                                              \
+      } else {                                                           \
+        binary_kernel(iter, [](scalar_t a, scalar_t b) -> uint8_t {      \
+          return a cmp b;                                                \
+        });                                                              \
+      }                                                                  \
+    });                                                                  \
+  }                                                                      \
+  REGISTER_DISPATCH(op##_stub, &op##_kernel)
+
+IMPLEMENT_COMPARISON_KERNEL(eq, ==);
+IMPLEMENT_COMPARISON_KERNEL(ge, >=);
+IMPLEMENT_COMPARISON_KERNEL(gt, >);
+IMPLEMENT_COMPARISON_KERNEL(le, <=);
+IMPLEMENT_COMPARISON_KERNEL(lt, <);
+IMPLEMENT_COMPARISON_KERNEL(ne, !=);
 
 }} // namespace at::native
@@ -4,6 +4,8 @@
 #include <ATen/native/DispatchStub.h>
 #include <ATen/optional.h>
 
+namespace at { struct TensorIterator; }
+
 namespace at { namespace native {
 
 using reduce_fn = void(*)(Tensor &, Tensor &, const Tensor &, at::optional<int64_t>);
@@ -11,4 +13,26 @@ using reduce_fn = void(*)(Tensor &, Tensor &, const Tensor &, at::optional<int64
 DECLARE_DISPATCH(reduce_fn, max_kernel);
 DECLARE_DISPATCH(reduce_fn, min_kernel);
 
+// max and min with indices along a dimension for any strides, as a
+// TensorIterator reduction with the values and the Long indices as outputs.
+using reduce_with_indices_fn = void(*)(TensorIterator&);
+
+DECLARE_DISPATCH(reduce_with_indices_fn, max_reduce_stub);
+DECLARE_DISPATCH(reduce_with_indices_fn, min_reduce_stub);
+
+// Element-wise kernels built on TensorIterator. The comparisons write either
+// a Byte mask or, for the in-place variants, the type of the inputs.
+using compare_fn = void(*)(TensorIterator&);
+
+DECLARE_DISPATCH(compare_fn, eq_stub);
+DECLARE_DISPATCH(compare_fn, ge_stub);
+DECLARE_DISPATCH(compare_fn, gt_stub);
+DECLARE_DISPATCH(compare_fn, le_stub);
+DECLARE_DISPATCH(compare_fn, lt_stub);
+DECLARE_DISPATCH(compare_fn, ne_stub);
+
+using where_fn = void(*)(TensorIterator&);
+
+DECLARE_DISPATCH(where_fn, where_stub);
+
 }} // namespace at::native
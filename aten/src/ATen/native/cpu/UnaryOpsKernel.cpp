@@ -5,6 +5,9 @@
 #include "ATen/cpu/vml.h"
 #include "ATen/CPUApplyUtils.h"
 #include "ATen/native/DispatchStub.h"
+#include "ATen/native/TensorIterator.h"
+#include "ATen/native/cpu/Loops.h"
+#include "ATen/native/cpu/Vectorized.h"
 #ifdef __AVX2__
 #include "ATen/native/cpu/avx_mathfun.h"
 #endif
@@ -140,9 +143,78 @@ static void sigmoid_kernel(Tensor& result, const Tensor& self) {
   }                                                                        \
   REGISTER_DISPATCH(op##Impl, &op##_kernel)
 
+// There's no SIMD min/max for the integral Vec256 types, so integral clamps
+// use the scalar loops. Like TH, the clamps propagate NaN in the input.
+static void clamp_kernel(TensorIterator& iter, Scalar min_scalar, Scalar max_scalar) {
+  if (isIntegralType(iter.dtype(0))) {
+    AT_DISPATCH_INTEGRAL_TYPES(iter.type(), "clamp", [&]() {
+      auto min = min_scalar.to<scalar_t>();
+      auto max = max_scalar.to<scalar_t>();
+      unary_kernel(iter, [=](scalar_t a) -> scalar_t {
+        return a < min ? min : (a > max ? max : a);
+      });
+    });
+  } else {
+    AT_DISPATCH_FLOATING_TYPES(iter.type(), "clamp", [&]() {
+      auto min = min_scalar.to<scalar_t>();
+      auto max = max_scalar.to<scalar_t>();
+      auto min_vec = Vectorized<scalar_t>(min);
+      auto max_vec = Vectorized<scalar_t>(max);
+      unary_kernel_vec(iter,
+        [=](scalar_t a) -> scalar_t {
+          return a < min ? min : (a > max ? max : a);
+        },
+        [=](Vectorized<scalar_t> a) {
+          return vec::clamp(a, min_vec, max_vec);
+        });
+    });
+  }
+}
+
+static void clamp_max_kernel(TensorIterator& iter, Scalar max_scalar) {
+  if (isIntegralType(iter.dtype(0))) {
+    AT_DISPATCH_INTEGRAL_TYPES(iter.type(), "clamp_max", [&]() {
+      auto max = max_scalar.to<scalar_t>();
+      unary_kernel(iter, [=](scalar_t a) -> scalar_t {
+        return a > max ? max : a;
+      });
+    });
+  } else {
+    AT_DISPATCH_FLOATING_TYPES(iter.type(), "clamp_max", [&]() {
+      auto max = max_scalar.to<scalar_t>();
+      auto max_vec = Vectorized<scalar_t>(max);
+      unary_kernel_vec(iter,
+        [=](scalar_t a) -> scalar_t { return a > max ? max : a; },
+        [=](Vectorized<scalar_t> a) { return vec::clamp_max(a, max_vec); });
+    });
+  }
+}
+
+static void clamp_min_kernel(TensorIterator& iter, Scalar min_scalar) {
+  if (isIntegralType(iter.dtype(0))) {
+    AT_DISPATCH_INTEGRAL_TYPES(iter.type(), "clamp_min", [&]() {
+      auto min = min_scalar.to<scalar_t>();
+      unary_kernel(iter, [=](scalar_t a) -> scalar_t {
+        return a < min ? min : a;
+      });
+    });
+  } else {
+    AT_DISPATCH_FLOATING_TYPES(iter.type(), "clamp_min", [&]() {
+      auto min = min_scalar.to<scalar_t>();
+      auto min_vec = Vectorized<scalar_t>(min);
+      unary_kernel_vec(iter,
+        [=](scalar_t a) -> scalar_t { return a < min ? min : a; },
+        [=](Vectorized<scalar_t> a) { return vec::clamp_min(a, min_vec); });
+    });
+  }
+}
+
 } // anonymous namespace
 
 REGISTER_DISPATCH(sigmoidImpl, &sigmoid_kernel)
+REGISTER_DISPATCH(clamp_stub, &clamp_kernel);
+REGISTER_DISPATCH(clamp_max_stub, &clamp_max_kernel);
+REGISTER_DISPATCH(clamp_min_stub, &clamp_min_kernel);
 
 // IMPLEMENT_FLOAT_KERNEL(ALL, abs)
 IMPLEMENT_FLOAT_KERNEL(FLOATING, acos)
@@ -150,7 +222,7 @@ IMPLEMENT_FLOAT_KERNEL(FLOATING, asin)
 IMPLEMENT_FLOAT_KERNEL(FLOATING, atan)
 IMPLEMENT_FLOAT_KERNEL(FLOATING, ceil)
 IMPLEMENT_FLOAT_KERNEL(FLOATING, cos)
-// IMPLEMENT_FLOAT_KERNEL(FLOATING, cosh)
+IMPLEMENT_FLOAT_KERNEL(FLOATING, cosh)
 IMPLEMENT_FLOAT_KERNEL(FLOATING, erf)
 IMPLEMENT_FLOAT_KERNEL(FLOATING, erfc)
 IMPLEMENT_FLOAT_KERNEL(FLOATING, exp)
@@ -163,7 +235,7 @@ IMPLEMENT_FLOAT_KERNEL(FLOATING, log2)
 IMPLEMENT_FLOAT_KERNEL(FLOATING, round)
 IMPLEMENT_FLOAT_KERNEL(FLOATING, rsqrt)
 IMPLEMENT_FLOAT_KERNEL(FLOATING, sin)
-// IMPLEMENT_FLOAT_KERNEL(FLOATING, sinh)
+IMPLEMENT_FLOAT_KERNEL(FLOATING, sinh)
 IMPLEMENT_FLOAT_KERNEL(FLOATING, sqrt)
 IMPLEMENT_FLOAT_KERNEL(FLOATING, tan)
 IMPLEMENT_FLOAT_KERNEL(FLOATING, tanh)
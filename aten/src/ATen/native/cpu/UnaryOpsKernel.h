@@ -4,6 +4,8 @@
 #include <ATen/native/DispatchStub.h>
 #include <stdexcept>
 
+namespace at { struct TensorIterator; }
+
 namespace at { namespace native {
 
 using unary_fn = void(*)(Tensor&, const Tensor&);
@@ -14,7 +16,7 @@ DECLARE_DISPATCH(unary_fn, asinImpl);
 DECLARE_DISPATCH(unary_fn, atanImpl);
 DECLARE_DISPATCH(unary_fn, ceilImpl);
 DECLARE_DISPATCH(unary_fn, cosImpl);
-// DECLARE_DISPATCH(unary_fn, coshImpl);
+DECLARE_DISPATCH(unary_fn, coshImpl);
 DECLARE_DISPATCH(unary_fn, erfImpl);
 DECLARE_DISPATCH(unary_fn, erfcImpl);
 DECLARE_DISPATCH(unary_fn, expImpl);
@@ -28,12 +30,19 @@ DECLARE_DISPATCH(unary_fn, roundImpl);
 DECLARE_DISPATCH(unary_fn, rsqrtImpl);
 DECLARE_DISPATCH(unary_fn, sigmoidImpl);
 DECLARE_DISPATCH(unary_fn, sinImpl);
-// DECLARE_DISPATCH(unary_fn, sinhImpl);
+DECLARE_DISPATCH(unary_fn, sinhImpl);
 DECLARE_DISPATCH(unary_fn, sqrtImpl);
 DECLARE_DISPATCH(unary_fn, tanImpl);
 DECLARE_DISPATCH(unary_fn, tanhImpl);
 DECLARE_DISPATCH(unary_fn, truncImpl);
 
+using clamp_fn = void(*)(TensorIterator&, Scalar, Scalar);
+using clamp_bound_fn = void(*)(TensorIterator&, Scalar);
+
+DECLARE_DISPATCH(clamp_fn, clamp_stub);
+DECLARE_DISPATCH(clamp_bound_fn, clamp_max_stub);
+DECLARE_DISPATCH(clamp_bound_fn, clamp_min_stub);
+
 
 // Missing unary functions
 // digamma
@@ -45,7 +54,6 @@ DECLARE_DISPATCH(unary_fn, truncImpl);
 // frac
 // clone
 // contiguous
-// clamp/_min/_max
 // neg
 // reciprocal
 // sigmoid
@@ -0,0 +1,316 @@
+#include "ATen/native/UpSampleCPU.h"
+
+#include "ATen/AccumulateType.h"
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+#include <algorithm>
+#include <vector>
+
+// Linear interpolation is separable: each output row (or (depth, row) pair)
+// is a weighted sum of at most two (four) input rows, and each output column
+// of at most two input columns. The weights along each dimension are kept as
+// a sparse matrix.
+//
+// Contiguous tensors are processed a plane at a time, in parallel over the
+// N * C planes: the input rows are first combined into a row buffer,
+// vectorized over the width, and the columns of each output are then read
+// from the buffer. Channels-last tensors are processed in parallel over the
+// rows of the N images, vectorized over the channels.
+//
+// The backward kernels gather with the transposed weights: each grad_input
+// row or pixel sums the grad_output rows or pixels that read it, so that no
+// two threads write to the same element.
+
+namespace at { namespace native { namespace {
+
+using namespace vec256;
+
+// The number of planes or rows to run on a thread, given the work per item.
+static inline int64_t grain_size(int64_t work) {
+  return std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(1, work));
+}
+
+// Same as linear_upsampling_compute_scale and
+// linear_upsampling_compute_source_index in THNN.
+template <typename accscalar_t>
+static inline accscalar_t compute_scale(int64_t input_size, int64_t output_size, bool align_corners) {
+  if (output_size > 1) {
+    return align_corners ? accscalar_t(input_size - 1) / (output_size - 1)
+                         : accscalar_t(input_size) / output_size;
+  }
+  return accscalar_t(0);
+}
+
+template <typename accscalar_t>
+static inline accscalar_t compute_source_index(accscalar_t scale, int64_t dst_index, bool align_corners) {
+  if (align_corners) {
+    return scale * dst_index;
+  }
+  const accscalar_t src_index = scale * (dst_index + 0.5) - 0.5;
+  return src_index < 0 ? accscalar_t(0) : src_index;
+}
+
+// A sparse matrix in compressed rows: row i has the (column, weight) entries
+// [offsets[i], offsets[i + 1]).
+template <typename scalar_t>
+struct Interpolation {
+  std::vector<int64_t> offsets{0};
+  std::vector<int64_t> columns;
+  std::vector<scalar_t> weights;
+
+  int64_t rows() const {
+    return offsets.size() - 1;
+  }
+
+  // Merges the weights of the same column within a row, which THNN reads twice
+  // at the last input index.
+  void add(int64_t column, scalar_t weight) {
+    if (offsets.back() < (int64_t)columns.size() && columns.back() == column) {
+      weights.back() += weight;
+      return;
+    }
+    columns.push_back(column);
+    weights.push_back(weight);
+  }
+
+  void end_row() {
+    offsets.push_back(columns.size());
+  }
+
+  Interpolation transpose(int64_t num_columns) const {
+    Interpolation t;
+    t.offsets.assign(num_columns + 1, 0);
+    for (auto column : columns) {
+      t.offsets[column + 1]++;
+    }
+    for (int64_t i = 0; i < num_columns; i++) {
+      t.offsets[i + 1] += t.offsets[i];
+    }
+    t.columns.resize(columns.size());
+    t.weights.resize(weights.size());
+    std::vector<int64_t> next(t.offsets.begin(), t.offsets.end() - 1);
+    for (int64_t row = 0; row < rows(); row++) {
+      for (int64_t e = offsets[row]; e < offsets[row + 1]; e++) {
+        const int64_t pos = next[columns[e]]++;
+        t.columns[pos] = row;
+        t.weights[pos] = weights[e];
+      }
+    }
+    return t;
+  }
+};
+
+template <typename scalar_t>
+static Interpolation<scalar_t> linear_interpolation(
+    int64_t input_size, int64_t output_size, bool align_corners) {
+  using accscalar_t = acc_type<scalar_t, false>;
+  Interpolation<scalar_t> interp;
+  const accscalar_t scale = compute_scale<accscalar_t>(input_size, output_size, align_corners);
+  for (int64_t o = 0; o < output_size; o++) {
+    const accscalar_t src = compute_source_index(scale, o, align_corners);
+    const int64_t i = static_cast<int64_t>(src);
+    const scalar_t lambda1 = src - i;
+    const scalar_t lambda0 = scalar_t(1) - lambda1;
+    interp.add(i, lambda0);
+    interp.add(i < input_size - 1 ? i + 1 : i, lambda1);
+    interp.end_row();
+  }
+  return interp;
+}
+
+// The weights of the (depth, row) pairs, with the input pairs numbered
+// depth * num_rows + row.
+template <typename scalar_t>
+static Interpolation<scalar_t> outer(
+    const Interpolation<scalar_t>& depth, const Interpolation<scalar_t>& rows, int64_t num_rows) {
+  Interpolation<scalar_t> interp;
+  for (int64_t d = 0; d < depth.rows(); d++) {
+    for (int64_t r = 0; r < rows.rows(); r++) {
+      for (int64_t i = depth.offsets[d]; i < depth.offsets[d + 1]; i++) {
+        for (int64_t j = rows.offsets[r]; j < rows.offsets[r + 1]; j++) {
+          interp.add(depth.columns[i] * num_rows + rows.columns[j], depth.weights[i] * rows.weights[j]);
+        }
+      }
+      interp.end_row();
+    }
+  }
+  return interp;
+}
+
+// dst = a * src
+template <typename scalar_t>
+static inline void scale_row(scalar_t* dst, scalar_t a, const scalar_t* src, int64_t n) {
+  using Vec = Vec256<scalar_t>;
+  const Vec va(a);
+  int64_t i = 0;
+  for (; i + Vec::size <= n; i += Vec::size) {
+    (va * Vec::loadu(src + i)).store(dst + i);
+  }
+  for (; i < n; i++) {
+    dst[i] = a * src[i];
+  }
+}
+
+// dst += a * src
+template <typename scalar_t>
+static inline void axpy_row(scalar_t* dst, scalar_t a, const scalar_t* src, int64_t n) {
+  using Vec = Vec256<scalar_t>;
+  const Vec va(a);
+  int64_t i = 0;
+  for (; i + Vec::size <= n; i += Vec::size) {
+    (Vec::loadu(dst + i) + va * Vec::loadu(src + i)).store(dst + i);
+  }
+  for (; i < n; i++) {
+    dst[i] += a * src[i];
+  }
+}
+
+// Interpolates planes of in_rows x W into planes of rows.rows() x cols.rows().
+template <typename scalar_t>
+static void upsample_linear_contiguous(
+    scalar_t* out_data, const scalar_t* in_data, int64_t planes, int64_t in_rows, int64_t W,
+    const Interpolation<scalar_t>& rows, const Interpolation<scalar_t>& cols) {
+  const int64_t out_rows = rows.rows();
+  const int64_t OW = cols.rows();
+  parallel_for(0, planes, grain_size(out_rows * (2 * W + 2 * OW)), [&](int64_t begin, int64_t end) {
+    std::vector<scalar_t> row(W);
+    for (int64_t plane = begin; plane < end; plane++) {
+      const scalar_t* in = in_data + plane * in_rows * W;
+      scalar_t* out = out_data + plane * out_rows * OW;
+      for (int64_t r = 0; r < out_rows; r++) {
+        const int64_t first = rows.offsets[r];
+        scale_row(row.data(), rows.weights[first], in + rows.columns[first] * W, W);
+        for (int64_t e = first + 1; e < rows.offsets[r + 1]; e++) {
+          axpy_row(row.data(), rows.weights[e], in + rows.columns[e] * W, W);
+        }
+        for (int64_t ow = 0; ow < OW; ow++) {
+          scalar_t sum = 0;
+          for (int64_t e = cols.offsets[ow]; e < cols.offsets[ow + 1]; e++) {
+            sum += cols.weights[e] * row[cols.columns[e]];
+          }
+          out[r * OW + ow] = sum;
+        }
+      }
+    }
+  });
+}
+
+template <typename scalar_t>
+static void upsample_linear_backward_contiguous(
+    scalar_t* gin_data, const scalar_t* gout_data, int64_t planes, int64_t in_rows, int64_t W,
+    const Interpolation<scalar_t>& rows, const Interpolation<scalar_t>& cols) {
+  const int64_t out_rows = rows.rows();
+  const int64_t OW = cols.rows();
+  const auto rows_t = rows.transpose(in_rows);
+  const auto cols_t = cols.transpose(W);
+  parallel_for(0, planes, grain_size(out_rows * 2 * OW + in_rows * 2 * W), [&](int64_t begin, int64_t end) {
+    std::vector<scalar_t> row(OW);
+    for (int64_t plane = begin; plane < end; plane++) {
+      scalar_t* gin = gin_data + plane * in_rows * W;
+      const scalar_t* gout = gout_data + plane * out_rows * OW;
+      for (int64_t q = 0; q < in_rows; q++) {
+        std::fill(row.begin(), row.end(), scalar_t(0));
+        for (int64_t e = rows_t.offsets[q]; e < rows_t.offsets[q + 1]; e++) {
+          axpy_row(row.data(), rows_t.weights[e], gout + rows_t.columns[e] * OW, OW);
+        }
+        for (int64_t iw = 0; iw < W; iw++) {
+          scalar_t sum = 0;
+          for (int64_t e = cols_t.offsets[iw]; e < cols_t.offsets[iw + 1]; e++) {
+            sum += cols_t.weights[e] * row[cols_t.columns[e]];
+          }
+          gin[q * W + iw] = sum;
+        }
+      }
+    }
+  });
+}
+
+// Both the forward and the backward: each pixel of the N images of
+// dst_rows x cols.rows() is a weighted sum of pixels of src_rows x src_cols.
+template <typename scalar_t>
+static void interpolate_channels_last(
+    scalar_t* dst_data, const scalar_t* src_data, int64_t N, int64_t C,
+    int64_t src_rows, int64_t src_cols,
+    const Interpolation<scalar_t>& rows, const Interpolation<scalar_t>& cols) {
+  const int64_t dst_rows = rows.rows();
+  const int64_t dst_cols = cols.rows();
+  parallel_for(0, N * dst_rows, grain_size(dst_cols * C * 4), [&](int64_t begin, int64_t end) {
+    for (int64_t row = begin; row < end; row++) {
+      const int64_t n = row / dst_rows;
+      const int64_t r = row % dst_rows;
+      const scalar_t* src = src_data + n * src_rows * src_cols * C;
+      for (int64_t c = 0; c < dst_cols; c++) {
+        scalar_t* dst_px = dst_data + (row * dst_cols + c) * C;
+        std::fill(dst_px, dst_px + C, scalar_t(0));
+        for (int64_t i = rows.offsets[r]; i < rows.offsets[r + 1]; i++) {
+          for (int64_t j = cols.offsets[c]; j < cols.offsets[c + 1]; j++) {
+            axpy_row(dst_px, rows.weights[i] * cols.weights[j],
+                     src + (rows.columns[i] * src_cols + cols.columns[j]) * C, C);
+          }
+        }
+      }
+    }
+  });
+}
+
+// The interpolation of the rows, or of the (depth, row) pairs of 5-d tensors.
+template <typename scalar_t>
+static Interpolation<scalar_t> row_interpolation(
+    const Tensor& input, const Tensor& output, bool align_corners) {
+  const int64_t H = input.size(-2);
+  auto rows = linear_interpolation<scalar_t>(H, output.size(-2), align_corners);
+  if (input.dim() == 5) {
+    return outer(linear_interpolation<scalar_t>(input.size(2), output.size(2), align_corners), rows, H);
+  }
+  return rows;
+}
+
+static void upsample_linear_kernel(Tensor& output, const Tensor& input, bool align_corners) {
+  const int64_t N = input.size(0);
+  const int64_t C = input.size(1);
+  const int64_t H = input.size(-2);
+  const int64_t W = input.size(-1);
+  const bool contiguous = input.is_contiguous();
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "upsample_linear", [&] {
+    const auto rows = row_interpolation<scalar_t>(input, output, align_corners);
+    const auto cols = linear_interpolation<scalar_t>(W, output.size(-1), align_corners);
+    if (contiguous) {
+      upsample_linear_contiguous(
+          output.data<scalar_t>(), input.data<scalar_t>(), N * C, input.numel() / (N * C * W), W, rows, cols);
+    } else {
+      interpolate_channels_last(
+          output.data<scalar_t>(), input.data<scalar_t>(), N, C, H, W, rows, cols);
+    }
+  });
+}
+
+static void upsample_linear_backward_kernel(
+    Tensor& grad_input, const Tensor& grad_output, bool align_corners) {
+  const int64_t N = grad_input.size(0);
+  const int64_t C = grad_input.size(1);
+  const int64_t H = grad_input.size(-2);
+  const int64_t W = grad_input.size(-1);
+  const bool contiguous = grad_input.is_contiguous();
+  AT_DISPATCH_FLOATING_TYPES(grad_input.type(), "upsample_linear_backward", [&] {
+    const auto rows = row_interpolation<scalar_t>(grad_input, grad_output, align_corners);
+    const auto cols = linear_interpolation<scalar_t>(W, grad_output.size(-1), align_corners);
+    if (contiguous) {
+      upsample_linear_backward_contiguous(
+          grad_input.data<scalar_t>(), grad_output.data<scalar_t>(), N * C,
+          grad_input.numel() / (N * C * W), W, rows, cols);
+    } else {
+      interpolate_channels_last(
+          grad_input.data<scalar_t>(), grad_output.data<scalar_t>(), N, C,
+          grad_output.size(2), grad_output.size(3), rows.transpose(H), cols.transpose(W));
+    }
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(upsample_linear_stub, &upsample_linear_kernel);
+REGISTER_DISPATCH(upsample_linear_backward_stub, &upsample_linear_backward_kernel);
+
+}} // namespace at::native
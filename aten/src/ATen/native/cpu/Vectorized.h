@@ -0,0 +1,23 @@
+#pragma once
+
+#include <ATen/cpu/vec256/vec256.h>
+#include <ATen/cpu/vec512/vec512.h>
+
+// Vector type of the CPU capability a kernel in this directory is compiled
+// for: Vec512 for AVX512 and Vec256 otherwise. Kernels written against
+// Vectorized<scalar_t> and the `vec` namespace (for free functions such as
+// vec::fmadd) use the full SIMD width of every capability.
+
+namespace at { namespace native { namespace {
+
+#if defined(CPU_CAPABILITY_AVX512)
+namespace vec = vec512;
+template <typename scalar_t>
+using Vectorized = vec512::Vec512<scalar_t>;
+#else
+namespace vec = vec256;
+template <typename scalar_t>
+using Vectorized = vec256::Vec256<scalar_t>;
+#endif
+
+}}}  // namespace at::native::<anonymous>
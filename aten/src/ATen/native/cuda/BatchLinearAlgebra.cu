@@ -0,0 +1,285 @@
+#include "ATen/Context.h"
+#include "ATen/cuda/CUDAContext.h"
+#include "ATen/Dispatch.h"
+#include "ATen/NativeFunctions.h"
+
+#include "ATen/native/LinearAlgebraUtils.h"
+#include "ATen/native/BatchLinearAlgebra.h"
+#include "ATen/native/cuda/MagmaUtils.h"
+
+#include "THC.h" // for USE_MAGMA
+
+#include <algorithm>
+
+#ifdef USE_MAGMA
+#include <magma.h>
+#include <magma_types.h>
+#endif
+
+namespace at {
+namespace native {
+
+#ifdef USE_MAGMA
+template<class scalar_t>
+void magmaGetrfBatched(
+    magma_int_t m, magma_int_t n, scalar_t** dA_array, magma_int_t ldda,
+    magma_int_t** ipiv_array, magma_int_t* info_array, magma_int_t batchsize,
+    magma_queue_t queue) {
+  AT_ERROR("getrf only takes float or double Tensors");
+}
+
+template<class scalar_t>
+void magmaGetriBatched(
+    magma_int_t n, scalar_t** dA_array, magma_int_t ldda,
+    magma_int_t** ipiv_array, scalar_t** dinvA_array, magma_int_t lddia,
+    magma_int_t* info_array, magma_int_t batchsize, magma_queue_t queue) {
+  AT_ERROR("getri only takes float or double Tensors");
+}
+
+template<class scalar_t>
+void magmaPotrfBatched(
+    magma_uplo_t uplo, magma_int_t n, scalar_t** dA_array, magma_int_t ldda,
+    magma_int_t* info_array, magma_int_t batchsize, magma_queue_t queue) {
+  AT_ERROR("potrf only takes float or double Tensors");
+}
+
+template<>
+void magmaGetrfBatched<float>(
+    magma_int_t m, magma_int_t n, float** dA_array, magma_int_t ldda,
+    magma_int_t** ipiv_array, magma_int_t* info_array, magma_int_t batchsize,
+    magma_queue_t queue) {
+  magma_sgetrf_batched(m, n, dA_array, ldda, ipiv_array, info_array, batchsize, queue);
+}
+
+template<>
+void magmaGetrfBatched<double>(
+    magma_int_t m, magma_int_t n, double** dA_array, magma_int_t ldda,
+    magma_int_t** ipiv_array, magma_int_t* info_array, magma_int_t batchsize,
+    magma_queue_t queue) {
+  magma_dgetrf_batched(m, n, dA_array, ldda, ipiv_array, info_array, batchsize, queue);
+}
+
+template<>
+void magmaGetriBatched<float>(
+    magma_int_t n, float** dA_array, magma_int_t ldda,
+    magma_int_t** ipiv_array, float** dinvA_array, magma_int_t lddia,
+    magma_int_t* info_array, magma_int_t batchsize, magma_queue_t queue) {
+  magma_sgetri_outofplace_batched(
+      n, dA_array, ldda, ipiv_array, dinvA_array, lddia, info_array, batchsize, queue);
+}
+
+template<>
+void magmaGetriBatched<double>(
+    magma_int_t n, double** dA_array, magma_int_t ldda,
+    magma_int_t** ipiv_array, double** dinvA_array, magma_int_t lddia,
+    magma_int_t* info_array, magma_int_t batchsize, magma_queue_t queue) {
+  magma_dgetri_outofplace_batched(
+      n, dA_array, ldda, ipiv_array, dinvA_array, lddia, info_array, batchsize, queue);
+}
+
+template<>
+void magmaPotrfBatched<float>(
+    magma_uplo_t uplo, magma_int_t n, float** dA_array, magma_int_t ldda,
+    magma_int_t* info_array, magma_int_t batchsize, magma_queue_t queue) {
+  magma_spotrf_batched(uplo, n, dA_array, ldda, info_array, batchsize, queue);
+}
+
+template<>
+void magmaPotrfBatched<double>(
+    magma_uplo_t uplo, magma_int_t n, double** dA_array, magma_int_t ldda,
+    magma_int_t* info_array, magma_int_t batchsize, magma_queue_t queue) {
+  magma_dpotrf_batched(uplo, n, dA_array, ldda, info_array, batchsize, queue);
+}
+#endif
+
+// One thread per matrix; the matrices are small enough to live in registers.
+template <typename scalar_t, int N>
+__global__ void tiny_inverse_kernel(
+    const scalar_t* self, scalar_t* result, int* infos, int64_t batch_size) {
+  int64_t i = blockIdx.x * (int64_t)blockDim.x + threadIdx.x;
+  if (i < batch_size) {
+    infos[i] = tiny_inverse<scalar_t, N>(self + i * N * N, result + i * N * N);
+  }
+}
+
+template <typename scalar_t, int N>
+__global__ void tiny_cholesky_kernel(
+    const scalar_t* self, scalar_t* result, int* infos, int64_t batch_size, bool upper) {
+  int64_t i = blockIdx.x * (int64_t)blockDim.x + threadIdx.x;
+  if (i < batch_size) {
+    infos[i] = tiny_cholesky<scalar_t, N>(self + i * N * N, result + i * N * N, upper);
+  }
+}
+
+constexpr int kTinyBlockSize = 128;
+
+static void copyInfos(const Tensor& info_tensor, std::vector<int64_t>& infos) {
+  auto info_cpu = info_tensor.toBackend(Backend::CPU);
+  auto info_data = info_cpu.data<int>();
+  std::copy(info_data, info_data + infos.size(), infos.begin());
+}
+
+template <typename scalar_t>
+static void applyTinyInverse(const Tensor& self, Tensor& result, std::vector<int64_t>& infos) {
+  auto n = self.size(-1);
+  auto batch_size = batchCount(self);
+  auto info_tensor = at::empty({batch_size}, self.options().dtype(kInt));
+  dim3 grid((batch_size + kTinyBlockSize - 1) / kTinyBlockSize);
+  auto stream = at::cuda::getCurrentCUDAStream();
+  AT_DISPATCH_TINY_MATRIX_SIZE(n, "inverse", [&] {
+    tiny_inverse_kernel<scalar_t, matrix_size><<<grid, kTinyBlockSize, 0, stream>>>(
+        self.data<scalar_t>(), result.data<scalar_t>(), info_tensor.data<int>(), batch_size);
+  });
+  THCudaCheck(cudaGetLastError());
+  copyInfos(info_tensor, infos);
+}
+
+template <typename scalar_t>
+static void applyTinyCholesky(
+    const Tensor& self, Tensor& result, bool upper, std::vector<int64_t>& infos) {
+  auto n = self.size(-1);
+  auto batch_size = batchCount(self);
+  auto info_tensor = at::empty({batch_size}, self.options().dtype(kInt));
+  dim3 grid((batch_size + kTinyBlockSize - 1) / kTinyBlockSize);
+  auto stream = at::cuda::getCurrentCUDAStream();
+  AT_DISPATCH_TINY_MATRIX_SIZE(n, "cholesky", [&] {
+    tiny_cholesky_kernel<scalar_t, matrix_size><<<grid, kTinyBlockSize, 0, stream>>>(
+        self.data<scalar_t>(), result.data<scalar_t>(), info_tensor.data<int>(),
+        batch_size, upper);
+  });
+  THCudaCheck(cudaGetLastError());
+  copyInfos(info_tensor, infos);
+}
+
+template <typename scalar_t>
+static void applyInverse(Tensor& self, Tensor& self_inv, std::vector<int64_t>& infos) {
+#ifndef USE_MAGMA
+AT_ERROR("inverse: MAGMA library not found in "
+    "compilation. Please rebuild with MAGMA.");
+#else
+  auto self_data = self.data<scalar_t>();
+  auto self_inv_data = self_inv.data<scalar_t>();
+  auto self_mat_stride = matrixStride(self);
+  auto self_inv_mat_stride = matrixStride(self_inv);
+
+  magma_int_t batch_size = magma_int_cast(batchCount(self), "batchCount");
+  magma_int_t n = magma_int_cast(self.size(-2), "self.size(-2)");
+
+  magma_int_t* info_array;
+  magma_int_t* ipiv_data;
+  magma_int_t** ipiv_array;
+  scalar_t** self_array;
+  scalar_t** self_inv_array;
+
+  ALLOCATE_ARRAY(info_array, magma_int_t, batch_size, self);
+  ALLOCATE_ARRAY(ipiv_data, magma_int_t, batch_size * n, self);
+  ALLOCATE_ARRAY(ipiv_array, magma_int_t*, batch_size, self);
+  ALLOCATE_ARRAY(self_array, scalar_t*, batch_size, self);
+  ALLOCATE_ARRAY(self_inv_array, scalar_t*, batch_size, self_inv);
+
+  // Set up the created arrays
+  for (int64_t i = 0; i < batch_size; i++) {
+    self_array[i] = &self_data[i * self_mat_stride];
+    self_inv_array[i] = &self_inv_data[i * self_inv_mat_stride];
+    ipiv_array[i] = &ipiv_data[i * n];
+  }
+
+  magma_queue_t queue = createMagmaQueue(self);
+  magmaGetrfBatched<scalar_t>(
+      n, n, self_array, n, ipiv_array, info_array, batch_size, queue);
+  magma_queue_sync(queue);
+
+  // getri does not check for singular factors, so skip it if there is one
+  bool singular = false;
+  for (int64_t i = 0; i < batch_size; i++) {
+    infos[i] = info_array[i];
+    singular |= info_array[i] != 0;
+  }
+  if (!singular) {
+    magmaGetriBatched<scalar_t>(
+        n, self_array, n, ipiv_array, self_inv_array, n, info_array, batch_size, queue);
+    magma_queue_sync(queue);
+    for (int64_t i = 0; i < batch_size; i++) {
+      infos[i] = info_array[i];
+    }
+  }
+  magma_queue_destroy(queue);
+#endif
+}
+
+template <typename scalar_t>
+static void applyCholesky(Tensor& self, bool upper, std::vector<int64_t>& infos) {
+#ifndef USE_MAGMA
+AT_ERROR("cholesky: MAGMA library not found in "
+    "compilation. Please rebuild with MAGMA.");
+#else
+  auto self_data = self.data<scalar_t>();
+  auto self_mat_stride = matrixStride(self);
+
+  magma_int_t batch_size = magma_int_cast(batchCount(self), "batchCount");
+  magma_int_t n = magma_int_cast(self.size(-2), "self.size(-2)");
+  magma_uplo_t uplo = upper ? MagmaUpper : MagmaLower;
+
+  magma_int_t* info_array;
+  scalar_t** self_array;
+
+  ALLOCATE_ARRAY(info_array, magma_int_t, batch_size, self);
+  ALLOCATE_ARRAY(self_array, scalar_t*, batch_size, self);
+
+  for (int64_t i = 0; i < batch_size; i++) {
+    self_array[i] = &self_data[i * self_mat_stride];
+  }
+
+  magma_queue_t queue = createMagmaQueue(self);
+  magmaPotrfBatched<scalar_t>(
+      uplo, n, self_array, n, info_array, batch_size, queue);
+  magma_queue_sync(queue);
+  magma_queue_destroy(queue);
+
+  for (int64_t i = 0; i < batch_size; i++) {
+    infos[i] = info_array[i];
+  }
+#endif
+}
+
+Tensor _inverse_helper_cuda(const Tensor& self) {
+  std::vector<int64_t> infos(batchCount(self), 0);
+  Tensor result;
+  if (self.size(-1) <= kTinyMatrixSize) {
+    auto self_contig = self.contiguous();
+    result = at::empty_like(self_contig);
+    AT_DISPATCH_FLOATING_TYPES(self.type(), "inverse", [&]{
+      applyTinyInverse<scalar_t>(self_contig, result, infos);
+    });
+  } else {
+    auto self_working_copy = cloneBatchedColumnMajor(self);
+    result = cloneBatchedColumnMajor(self);
+    AT_DISPATCH_FLOATING_TYPES(self.type(), "inverse", [&]{
+      applyInverse<scalar_t>(self_working_copy, result, infos);
+    });
+  }
+  checkInverseErrors(infos);
+  return result;
+}
+
+Tensor _cholesky_helper_cuda(const Tensor& self, bool upper) {
+  std::vector<int64_t> infos(batchCount(self), 0);
+  Tensor result;
+  if (self.size(-1) <= kTinyMatrixSize) {
+    auto self_contig = self.contiguous();
+    result = at::empty_like(self_contig);
+    AT_DISPATCH_FLOATING_TYPES(self.type(), "cholesky", [&]{
+      applyTinyCholesky<scalar_t>(self_contig, result, upper, infos);
+    });
+  } else {
+    result = cloneBatchedColumnMajor(self);
+    AT_DISPATCH_FLOATING_TYPES(self.type(), "cholesky", [&]{
+      applyCholesky<scalar_t>(result, upper, infos);
+    });
+    zeroOtherTriangle(result, upper);
+  }
+  checkCholeskyErrors(infos);
+  return result;
+}
+
+}}  // namespace at::native
@@ -0,0 +1,28 @@
+#include "ATen/ATen.h"
+
+namespace at { namespace native {
+
+// These are just forwarding stubs
+
+#define IMPLEMENT_COMPARISON_OP_PREQUEL(op)                                         \
+  Tensor& _##op##__cuda(Tensor& self, Scalar other) {                               \
+    return at::_th_##op##_(self, other);                                            \
+  }                                                                                 \
+  Tensor& _##op##__cuda(Tensor& self, const Tensor& other) {                        \
+    return at::_th_##op##_(self, other);                                            \
+  }                                                                                 \
+  Tensor& _##op##_out_cuda(Tensor& result, const Tensor& self, Scalar other) {      \
+    return at::_th_##op##_out(result, self, other);                                 \
+  }                                                                                 \
+  Tensor& _##op##_out_cuda(Tensor& result, const Tensor& self, const Tensor& other) { \
+    return at::_th_##op##_out(result, self, other);                                 \
+  }
+
+IMPLEMENT_COMPARISON_OP_PREQUEL(eq)
+IMPLEMENT_COMPARISON_OP_PREQUEL(ge)
+IMPLEMENT_COMPARISON_OP_PREQUEL(gt)
+IMPLEMENT_COMPARISON_OP_PREQUEL(le)
+IMPLEMENT_COMPARISON_OP_PREQUEL(lt)
+IMPLEMENT_COMPARISON_OP_PREQUEL(ne)
+
+}}
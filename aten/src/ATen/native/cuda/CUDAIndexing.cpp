@@ -0,0 +1,13 @@
+#include "ATen/ATen.h"
+
+namespace at { namespace native {
+
+Tensor & index_select_out_cuda(Tensor & result, const Tensor & self, int64_t dim, const Tensor & index) {
+  return at::_th_index_select_out(result, self, dim, index);
+}
+
+Tensor index_select_cuda(const Tensor & self, int64_t dim, const Tensor & index) {
+  return at::_th_index_select(self, dim, index);
+}
+
+}} // namespace at::native
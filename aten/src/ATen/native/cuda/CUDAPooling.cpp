@@ -0,0 +1,57 @@
+#include "ATen/ATen.h"
+#include "ATen/NativeFunctions.h"
+
+#include <tuple>
+
+// The CUDA pooling kernels are still the THCUNN ones, see PoolingCPU.cpp.
+
+namespace at { namespace native {
+
+std::tuple<Tensor&, Tensor&> max_pool2d_with_indices_out_cuda(
+    Tensor& output, Tensor& indices, const Tensor& self, IntList kernel_size,
+    IntList stride, IntList padding, IntList dilation, bool ceil_mode) {
+  return at::thnn_max_pool2d_with_indices_out(
+      output, indices, self, kernel_size, stride, padding, dilation, ceil_mode);
+}
+
+std::tuple<Tensor, Tensor> max_pool2d_with_indices_cuda(
+    const Tensor& self, IntList kernel_size, IntList stride, IntList padding,
+    IntList dilation, bool ceil_mode) {
+  return at::thnn_max_pool2d_with_indices(self, kernel_size, stride, padding, dilation, ceil_mode);
+}
+
+Tensor max_pool2d_with_indices_backward_cuda(
+    const Tensor& grad_output, const Tensor& self, IntList kernel_size,
+    IntList stride, IntList padding, IntList dilation, bool ceil_mode,
+    const Tensor& indices) {
+  if (stride.empty()) {
+    stride = kernel_size;
+  }
+  return at::thnn_max_pool2d_with_indices_backward(
+      grad_output, self, kernel_size, stride, padding, dilation, ceil_mode, indices);
+}
+
+Tensor& avg_pool2d_out_cuda(
+    Tensor& output, const Tensor& self, IntList kernel_size, IntList stride,
+    IntList padding, bool ceil_mode, bool count_include_pad) {
+  return at::thnn_avg_pool2d_out(
+      output, self, kernel_size, stride, padding, ceil_mode, count_include_pad);
+}
+
+Tensor avg_pool2d_cuda(
+    const Tensor& self, IntList kernel_size, IntList stride, IntList padding,
+    bool ceil_mode, bool count_include_pad) {
+  return at::thnn_avg_pool2d(self, kernel_size, stride, padding, ceil_mode, count_include_pad);
+}
+
+Tensor avg_pool2d_backward_cuda(
+    const Tensor& grad_output, const Tensor& self, IntList kernel_size,
+    IntList stride, IntList padding, bool ceil_mode, bool count_include_pad) {
+  if (stride.empty()) {
+    stride = kernel_size;
+  }
+  return at::thnn_avg_pool2d_backward(
+      grad_output, self, kernel_size, stride, padding, ceil_mode, count_include_pad);
+}
+
+}} // namespace at::native
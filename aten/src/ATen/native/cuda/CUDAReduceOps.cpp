@@ -1,16 +1,75 @@
 #include <ATen/ATen.h>
+#include "ATen/WrapDimUtils.h"
 #include "ATen/native/ReduceOpsUtils.h"
+#include "ATen/native/TensorIterator.h"
+#include "ATen/native/cpu/ReduceOpsKernel.h"
+
+#include <algorithm>
 
 namespace at { namespace native {
 
-Tensor _sum_cuda(const Tensor &self_) { return self_._sumall(); }
+namespace {
+
+// Reduces self over dim, or over all dimensions if dim is nullopt, into
+// result with one of the TensorIterator reduction kernels (see Reduce.cuh).
+// Returns false, leaving result for the TH kernels, if self is too large for
+// 32-bit indexing.
+template <typename Stub>
+bool _reduce_out_cuda(Stub& stub, Tensor& result, const Tensor& self,
+                      optional<int64_t> dim, bool keepdim) {
+  auto shape = self.sizes().vec();
+  if (dim.has_value()) {
+    shape[*dim] = 1;
+  } else {
+    std::fill(shape.begin(), shape.end(), 1);
+  }
+  result.resize_(shape);
+  auto iter = TensorIterator::reduce_op(result, self);
+  if (!iter->can_use_32bit_indexing()) {
+    return false;
+  }
+  stub(kCUDA, *iter);
+  if (!dim.has_value()) {
+    result.resize_({});
+  } else if (!keepdim) {
+    result.squeeze_(*dim);
+  }
+  return true;
+}
 
-Tensor _prod_cuda(const Tensor &self_) { return self_._prodall(); }
+} // anonymous namespace
+
+Tensor _sum_cuda(const Tensor &self_) {
+  auto trivial_return = _allreduce_return_trivial(self_, 0);
+  if (trivial_return.has_value()) {
+    return trivial_return.value();
+  }
+  Tensor result = self_.type().tensor();
+  if (_reduce_out_cuda(sum_iter_stub, result, self_, nullopt, false)) {
+    return result;
+  }
+  return self_._sumall();
+}
+
+Tensor _prod_cuda(const Tensor &self_) {
+  auto trivial_return = _allreduce_return_trivial(self_, 1);
+  if (trivial_return.has_value()) {
+    return trivial_return.value();
+  }
+  Tensor result = self_.type().tensor();
+  if (_reduce_out_cuda(prod_iter_stub, result, self_, nullopt, false)) {
+    return result;
+  }
+  return self_._prodall();
+}
 
 Tensor &_sum_out_cuda(Tensor &result, const Tensor &self, int64_t dim,
                       bool keepdim) {
+  dim = maybe_wrap_dim(dim, self.dim());
   if (_dimreduce_return_trivial(result, self, 0, dim, keepdim)) {
     return result;
+  } else if (_reduce_out_cuda(sum_iter_stub, result, self, dim, keepdim)) {
+    return result;
   } else {
     return at::_th_sum_out(result, self, dim, keepdim);
   }
@@ -18,8 +77,11 @@ Tensor &_sum_out_cuda(Tensor &result, const Tensor &self, int64_t dim,
 
 Tensor &_prod_out_cuda(Tensor &result, const Tensor &self, int64_t dim,
                        bool keepdim) {
+  dim = maybe_wrap_dim(dim, self.dim());
   if (_dimreduce_return_trivial(result, self, 1, dim, keepdim)) {
     return result;
+  } else if (_reduce_out_cuda(prod_iter_stub, result, self, dim, keepdim)) {
+    return result;
   } else {
     return at::_th_prod_out(result, self, dim, keepdim);
   }
@@ -0,0 +1,36 @@
+#include "ATen/ATen.h"
+#include "ATen/NativeFunctions.h"
+
+// The CUDA upsampling kernels are still the THCUNN ones, see UpSampleCPU.cpp.
+
+namespace at { namespace native {
+
+Tensor upsample_bilinear2d_cuda(const Tensor& self, IntList output_size, bool align_corners) {
+  return at::thnn_upsample_bilinear2d(self, output_size, align_corners);
+}
+
+Tensor& upsample_bilinear2d_out_cuda(
+    Tensor& output, const Tensor& self, IntList output_size, bool align_corners) {
+  return at::thnn_upsample_bilinear2d_out(output, self, output_size, align_corners);
+}
+
+Tensor upsample_bilinear2d_backward_cuda(
+    const Tensor& grad_output, IntList output_size, IntList input_size, bool align_corners) {
+  return at::thnn_upsample_bilinear2d_backward(grad_output, output_size, input_size, align_corners);
+}
+
+Tensor upsample_trilinear3d_cuda(const Tensor& self, IntList output_size, bool align_corners) {
+  return at::thnn_upsample_trilinear3d(self, output_size, align_corners);
+}
+
+Tensor& upsample_trilinear3d_out_cuda(
+    Tensor& output, const Tensor& self, IntList output_size, bool align_corners) {
+  return at::thnn_upsample_trilinear3d_out(output, self, output_size, align_corners);
+}
+
+Tensor upsample_trilinear3d_backward_cuda(
+    const Tensor& grad_output, IntList output_size, IntList input_size, bool align_corners) {
+  return at::thnn_upsample_trilinear3d_backward(grad_output, output_size, input_size, align_corners);
+}
+
+}} // namespace at::native
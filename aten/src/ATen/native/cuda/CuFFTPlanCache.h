@@ -2,10 +2,8 @@
 #include "ATen/cuda/CUDAContext.h"
 #include "ATen/Config.h"
 #include "ATen/native/cuda/CuFFTUtils.h"
-#include "ATen/native/utils/ParamsHash.h"
+#include "ATen/native/utils/ParamsLRUCache.h"
 
-#include <list>
-#include <unordered_map>
 #include <string>
 #include <stdexcept>
 #include <sstream>
@@ -291,110 +289,31 @@ constexpr int64_t CUFFT_MAX_PLAN_NUM = 1023;
 static_assert(CUFFT_MAX_PLAN_NUM >= 0 && CUFFT_MAX_PLAN_NUM <= std::numeric_limits<size_t>::max(),
               "CUFFT_MAX_PLAN_NUM not in size_t range");
 
-// This cache assumes that the mapping from key to value never changes.
-// This is **NOT** thread-safe. Please use a mutex when using it **AND** the
-// value returned from try_emplace_value.
-// The contract of using this cache is that try_emplace_value should only be
-// used when the max_size is positive.
-class CuFFTParamsLRUCache {
+// One of these caches exists per device, because cuFFT plans can only
+// execute on the device they were created on. See ParamsLRUCache.h for how to
+// use it.
+class CuFFTParamsLRUCache : public ParamsLRUCache<CuFFTParams, CuFFTConfig> {
 public:
-  using kv_t = typename std::pair<CuFFTParams, CuFFTConfig>;
-  using map_t = typename std::unordered_map<std::reference_wrapper<CuFFTParams>,
-                                            typename std::list<kv_t>::iterator,
-                                            ParamsHash<CuFFTParams>,
-                                            ParamsEqual<CuFFTParams>>;
-  using map_kkv_iter_t = typename map_t::iterator;
-
-
   CuFFTParamsLRUCache() : CuFFTParamsLRUCache(CUFFT_MAX_PLAN_NUM) {}
 
-  CuFFTParamsLRUCache(int64_t max_size) {
-    _set_max_size(max_size);
-  }
-
-  // If key is in this cache, return the cached config. Otherwise, emplace the
-  // config in this cache using value_args and return it.
-  // Return const reference because CuFFTConfig shouldn't be tampered with once
-  // created.
-  // This is similar to c++ 17 try_emplace.
-  template<typename K, class ...VArgs>
-  const CuFFTConfig &try_emplace_value(K&& key, VArgs&&... value_args) {
-    AT_ASSERT(_max_size > 0);
-
-    map_kkv_iter_t map_it = _cache_map.find(key);
-    // Hit, put to list front
-    if (map_it != _cache_map.end()) {
-      _usage_list.splice(_usage_list.begin(), _usage_list, map_it->second);
-      return map_it->second->second;
-    }
-
-    // Miss
-    // remove if needed
-    if (_usage_list.size() >= _max_size) {
-      auto last = _usage_list.end();
-      last--;
-      _cache_map.erase(last->first);
-      _usage_list.pop_back();
-    }
-
-    // construct new plan at list front, then insert into _cache_map
-    _usage_list.emplace_front(std::piecewise_construct,
-                       std::forward_as_tuple(key),
-                       std::forward_as_tuple(value_args...));
-    auto kv_it = _usage_list.begin();
-    _cache_map.emplace(std::piecewise_construct,
-                std::forward_as_tuple(kv_it->first),
-                std::forward_as_tuple(kv_it));
-    return kv_it->second;
-  }
-
-  void clear() {
-    _cache_map.clear();
-    _usage_list.clear();
-  }
-
-  void resize(int64_t new_size) {
-    _set_max_size(new_size);
-
-    auto cur_size = _usage_list.size();
-    if (cur_size > _max_size) {
-      auto delete_it = _usage_list.end();
-      for (size_t i = 0; i < cur_size - _max_size; i++) {
-        delete_it--;
-        _cache_map.erase(delete_it->first);
-      }
-      _usage_list.erase(delete_it, _usage_list.end());
-    }
-  }
-
-  size_t size() const { return _cache_map.size(); }
-
-  size_t max_size() const noexcept { return _max_size; }
-
-private:
-  // Only sets size and does value check. Does not resize the data structures.
-  void _set_max_size(int64_t new_size) {
-    AT_CHECK(new_size <= CUFFT_MAX_PLAN_NUM,
-             "cuFFT plan cache size can not be larger than ", CUFFT_MAX_PLAN_NUM, ", but got ", new_size);
-    AT_CHECK(new_size >= 0,
-             "cuFFT plan cache size must be non-negative, but got ", new_size);
-    _max_size = static_cast<size_t>(new_size);
-  }
-
-  std::list<kv_t> _usage_list;
-  map_t _cache_map;
-  size_t _max_size;
+  CuFFTParamsLRUCache(int64_t max_size)
+    : ParamsLRUCache<CuFFTParams, CuFFTConfig>(
+        "cuFFT plan cache", max_size, CUFFT_MAX_PLAN_NUM) {}
 };
 
 // Since ATen is separated into CPU build and CUDA build, we need a way to call
 // these functions only when CUDA is loaded. We use CUDA hooks for this purpose
 // (at cuda/detail/CUDAHooks.cpp), and call the hooked functions from the actual
 // native function counterparts (at native/SpectralOps.cpp), i.e.,
-// _cufft_get_plan_cache_max_size, _cufft_set_plan_cache_max_size
-// _cufft_get_plan_cache_size, and _cufft_clear_plan_cache.
-int64_t cufft_get_plan_cache_max_size_impl();
-void cufft_set_plan_cache_max_size_impl(int64_t max_size);
-int64_t cufft_get_plan_cache_size_impl();
-void cufft_clear_plan_cache_impl();
+// _cufft_get_plan_cache_max_size, _cufft_set_plan_cache_max_size,
+// _cufft_get_plan_cache_size, _cufft_clear_plan_cache,
+// _cufft_get_plan_cache_hits and _cufft_get_plan_cache_misses. All of them act
+// on the cache of the device with the given index.
+int64_t cufft_get_plan_cache_max_size_impl(int64_t device_index);
+void cufft_set_plan_cache_max_size_impl(int64_t device_index, int64_t max_size);
+int64_t cufft_get_plan_cache_size_impl(int64_t device_index);
+void cufft_clear_plan_cache_impl(int64_t device_index);
+int64_t cufft_get_plan_cache_hits_impl(int64_t device_index);
+int64_t cufft_get_plan_cache_misses_impl(int64_t device_index);
 
 }}} // namespace at::native::detail
@@ -0,0 +1,198 @@
+#include "ATen/native/Distance.h"
+
+#include "ATen/AccumulateType.h"
+#include "ATen/Dispatch.h"
+#include "ATen/cuda/CUDAContext.h"
+
+#include <THC/THCGeneral.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace at { namespace native {
+
+namespace {
+
+// The forward kernel computes tiles of kTile x kTile distances per block,
+// staging kTile features of the matching rows of x1 and x2 in shared memory
+// at a time, like a tiled matrix multiply.
+constexpr int kTile = 16;
+
+// The norms of cdist: map turns a difference into its contribution, which
+// red accumulates, and finish maps the accumulated value to the distance.
+// grad is d dist / d diff.
+template <typename scalar_t>
+struct Dist {
+  struct zero {
+    static __device__ scalar_t map(scalar_t diff, scalar_t p) { return diff != 0 ? 1 : 0; }
+    static __device__ scalar_t red(scalar_t agg, scalar_t up) { return agg + up; }
+    static __device__ scalar_t finish(scalar_t agg, scalar_t p) { return agg; }
+  };
+
+  struct one {
+    static __device__ scalar_t map(scalar_t diff, scalar_t p) { return ::abs(diff); }
+    static __device__ scalar_t red(scalar_t agg, scalar_t up) { return agg + up; }
+    static __device__ scalar_t finish(scalar_t agg, scalar_t p) { return agg; }
+    static __device__ scalar_t grad(scalar_t diff, scalar_t dist, scalar_t p) {
+      return diff > 0 ? 1 : (diff < 0 ? -1 : 0);
+    }
+  };
+
+  struct two {
+    static __device__ scalar_t map(scalar_t diff, scalar_t p) { return diff * diff; }
+    static __device__ scalar_t red(scalar_t agg, scalar_t up) { return agg + up; }
+    static __device__ scalar_t finish(scalar_t agg, scalar_t p) { return ::sqrt(agg); }
+    static __device__ scalar_t grad(scalar_t diff, scalar_t dist, scalar_t p) {
+      return dist == 0 ? 0 : diff / dist;
+    }
+  };
+
+  struct inf {
+    static __device__ scalar_t map(scalar_t diff, scalar_t p) { return ::abs(diff); }
+    static __device__ scalar_t red(scalar_t agg, scalar_t up) { return agg > up ? agg : up; }
+    static __device__ scalar_t finish(scalar_t agg, scalar_t p) { return agg; }
+    static __device__ scalar_t grad(scalar_t diff, scalar_t dist, scalar_t p) {
+      return ::abs(diff) == dist ? (diff > 0 ? 1 : (diff < 0 ? -1 : 0)) : 0;
+    }
+  };
+
+  struct general {
+    static __device__ scalar_t map(scalar_t diff, scalar_t p) { return ::pow(::abs(diff), p); }
+    static __device__ scalar_t red(scalar_t agg, scalar_t up) { return agg + up; }
+    static __device__ scalar_t finish(scalar_t agg, scalar_t p) { return ::pow(agg, 1 / p); }
+    static __device__ scalar_t grad(scalar_t diff, scalar_t dist, scalar_t p) {
+      if (dist == 0 || diff == 0) {
+        return 0;
+      }
+      scalar_t g = ::pow(::abs(diff) / dist, p - 1);
+      return diff > 0 ? g : -g;
+    }
+  };
+};
+
+template <typename scalar_t, typename accscalar_t, typename F>
+__global__ void cdist_kernel_cuda_impl(
+    scalar_t* result, const scalar_t* x1, const scalar_t* x2, accscalar_t p,
+    int64_t N, int64_t M, int64_t D) {
+  __shared__ accscalar_t x1_tile[kTile][kTile + 1];
+  __shared__ accscalar_t x2_tile[kTile][kTile + 1];
+  const int tx = threadIdx.x;
+  const int ty = threadIdx.y;
+  const int64_t j = (int64_t)blockIdx.x * kTile + tx;
+  for (int64_t i0 = (int64_t)blockIdx.y * kTile; i0 < N; i0 += (int64_t)gridDim.y * kTile) {
+    const int64_t i = i0 + ty;
+    accscalar_t agg = 0;
+    for (int64_t d0 = 0; d0 < D; d0 += kTile) {
+      // thread (ty, tx) loads feature d0 + tx of row ty of both tiles
+      const int64_t d = d0 + tx;
+      const int64_t x2_row = (int64_t)blockIdx.x * kTile + ty;
+      x1_tile[ty][tx] = (i < N && d < D) ? static_cast<accscalar_t>(x1[i * D + d]) : accscalar_t(0);
+      x2_tile[ty][tx] = (x2_row < M && d < D) ? static_cast<accscalar_t>(x2[x2_row * D + d]) : accscalar_t(0);
+      __syncthreads();
+      const int count = D - d0 < kTile ? D - d0 : kTile;
+      for (int k = 0; k < count; k++) {
+        agg = F::red(agg, F::map(x1_tile[ty][k] - x2_tile[tx][k], p));
+      }
+      __syncthreads();
+    }
+    if (i < N && j < M) {
+      result[i * M + j] = static_cast<scalar_t>(F::finish(agg, p));
+    }
+  }
+}
+
+// One thread per element of grad_x1, summing over the rows of x2.
+template <typename scalar_t, typename accscalar_t, typename F>
+__global__ void cdist_backward_kernel_cuda_impl(
+    scalar_t* grad_x1, const scalar_t* grad, const scalar_t* x1, const scalar_t* x2,
+    const scalar_t* dist, accscalar_t p, int64_t N, int64_t M, int64_t D) {
+  for (int64_t index = (int64_t)blockIdx.x * blockDim.x + threadIdx.x; index < N * D;
+       index += (int64_t)blockDim.x * gridDim.x) {
+    const int64_t i = index / D;
+    const int64_t d = index % D;
+    const accscalar_t a = static_cast<accscalar_t>(x1[index]);
+    accscalar_t g = 0;
+    for (int64_t j = 0; j < M; j++) {
+      const accscalar_t diff = a - static_cast<accscalar_t>(x2[j * D + d]);
+      g += static_cast<accscalar_t>(grad[i * M + j]) *
+          F::grad(diff, static_cast<accscalar_t>(dist[i * M + j]), p);
+    }
+    grad_x1[index] = static_cast<scalar_t>(g);
+  }
+}
+
+template <typename scalar_t, typename accscalar_t, typename F>
+void launch_cdist(Tensor& result, const Tensor& x1, const Tensor& x2, double p) {
+  const int64_t N = x1.size(0);
+  const int64_t M = x2.size(0);
+  const int64_t D = x1.size(1);
+  const int64_t max_grid_y = 65535;
+  dim3 block(kTile, kTile);
+  dim3 grid((M + kTile - 1) / kTile, std::min<int64_t>((N + kTile - 1) / kTile, max_grid_y));
+  cdist_kernel_cuda_impl<scalar_t, accscalar_t, F>
+      <<<grid, block, 0, at::cuda::getCurrentCUDAStream()>>>(
+      result.data<scalar_t>(), x1.data<scalar_t>(), x2.data<scalar_t>(),
+      static_cast<accscalar_t>(p), N, M, D);
+  THCudaCheck(cudaGetLastError());
+}
+
+template <typename scalar_t, typename accscalar_t, typename F>
+void launch_cdist_backward(
+    Tensor& grad_x1, const Tensor& grad, const Tensor& x1, const Tensor& x2,
+    double p, const Tensor& cdist) {
+  const int64_t N = x1.size(0);
+  const int64_t M = x2.size(0);
+  const int64_t D = x1.size(1);
+  const int threads = 256;
+  const int64_t max_blocks = at::cuda::getCurrentDeviceProperties()->multiProcessorCount *
+      (at::cuda::getCurrentDeviceProperties()->maxThreadsPerMultiProcessor / threads);
+  const int64_t blocks = std::min((N * D + threads - 1) / threads, max_blocks);
+  cdist_backward_kernel_cuda_impl<scalar_t, accscalar_t, F>
+      <<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(
+      grad_x1.data<scalar_t>(), grad.data<scalar_t>(), x1.data<scalar_t>(),
+      x2.data<scalar_t>(), cdist.data<scalar_t>(), static_cast<accscalar_t>(p), N, M, D);
+  THCudaCheck(cudaGetLastError());
+}
+
+void cdist_kernel_cuda(Tensor& result, const Tensor& x1, const Tensor& x2, double p) {
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(result.type(), "cdist_cuda", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    using Dists = Dist<accscalar_t>;
+    if (p == 0.0) {
+      launch_cdist<scalar_t, accscalar_t, typename Dists::zero>(result, x1, x2, p);
+    } else if (p == 1.0) {
+      launch_cdist<scalar_t, accscalar_t, typename Dists::one>(result, x1, x2, p);
+    } else if (p == 2.0) {
+      launch_cdist<scalar_t, accscalar_t, typename Dists::two>(result, x1, x2, p);
+    } else if (std::isinf(p)) {
+      launch_cdist<scalar_t, accscalar_t, typename Dists::inf>(result, x1, x2, p);
+    } else {
+      launch_cdist<scalar_t, accscalar_t, typename Dists::general>(result, x1, x2, p);
+    }
+  });
+}
+
+void cdist_backward_kernel_cuda(
+    Tensor& grad_x1, const Tensor& grad, const Tensor& x1, const Tensor& x2,
+    double p, const Tensor& cdist) {
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(grad_x1.type(), "cdist_backward_cuda", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    using Dists = Dist<accscalar_t>;
+    if (p == 1.0) {
+      launch_cdist_backward<scalar_t, accscalar_t, typename Dists::one>(grad_x1, grad, x1, x2, p, cdist);
+    } else if (p == 2.0) {
+      launch_cdist_backward<scalar_t, accscalar_t, typename Dists::two>(grad_x1, grad, x1, x2, p, cdist);
+    } else if (std::isinf(p)) {
+      launch_cdist_backward<scalar_t, accscalar_t, typename Dists::inf>(grad_x1, grad, x1, x2, p, cdist);
+    } else {
+      launch_cdist_backward<scalar_t, accscalar_t, typename Dists::general>(grad_x1, grad, x1, x2, p, cdist);
+    }
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(cdist_stub, &cdist_kernel_cuda);
+REGISTER_DISPATCH(cdist_backward_stub, &cdist_backward_kernel_cuda);
+
+}} // namespace at::native
@@ -1,6 +1,7 @@
 #include "ATen/Dispatch.h"
 #include "ATen/NativeFunctions.h"
 #include "ATen/cuda/CUDAApplyUtils.cuh"
+#include "ATen/cuda/PhiloxCudaState.h"
 #include "ATen/AccumulateType.h"
 
 #include <curand.h>
@@ -21,30 +22,22 @@
 #include <limits>
 #include <utility>
 
-THCGenerator* THCRandom_getGenerator(THCState* state);
-
 namespace {
-std::pair<uint64_t, uint64_t> next_philox_seed(at::Generator* gen, uint64_t increment) {
-  auto gen_ = THCRandom_getGenerator(at::globalContext().getTHCState());
-  uint64_t offset = gen_->state.philox_seed_offset.fetch_add(increment);
-  return std::make_pair(gen_->state.initial_seed, offset);
-}
-
 template <typename scalar_t>
 void poisson_cuda_kernel(
     at::Tensor& ret,
     const at::Tensor& lambda,
-    std::pair<uint64_t, uint64_t> seeds) {
+    at::cuda::PhiloxCudaState philox) {
   at::cuda::CUDA_tensor_apply2<scalar_t, scalar_t>(
       ret,
       lambda,
-      [seeds] __device__(
+      [philox] __device__(
           scalar_t & ret_val, const scalar_t& lambda) {
         curandStatePhilox4_32_10_t state;
         curand_init(
-            seeds.first,
+            philox.seed,
             blockIdx.x * blockDim.x + threadIdx.x,
-            seeds.second,
+            at::cuda::philox_offset(philox),
             &state);
         ret_val = static_cast<scalar_t>(curand_poisson(&state, lambda));
       });
@@ -54,18 +47,18 @@ template <typename scalar_t>
 void gamma_cuda_kernel(
     at::Tensor& ret,
     const at::Tensor& alpha,
-    std::pair<uint64_t, uint64_t> seeds) {
+    at::cuda::PhiloxCudaState philox) {
   using accscalar_t = at::acc_type<scalar_t, true>;
   at::cuda::CUDA_tensor_apply2<scalar_t, scalar_t>(
       ret,
       alpha,
-      [seeds] __device__(
+      [philox] __device__(
           scalar_t & ret_val, const scalar_t& alpha) {
         curandStatePhilox4_32_10_t state;
         curand_init(
-            seeds.first,
+            philox.seed,
             blockIdx.x * blockDim.x + threadIdx.x,
-            seeds.second,
+            at::cuda::philox_offset(philox),
             &state);
         BaseSampler<accscalar_t> standard_uniform([&state] __device__ () {
           return curand_uniform(&state);
@@ -98,7 +91,7 @@ namespace at { namespace native {
 Tensor _s_poisson_cuda(const Tensor& lambda, Generator* gen) {
   Tensor ret = lambda.type().tensor(lambda.sizes());
   AT_DISPATCH_FLOATING_TYPES_AND_HALF(ret.type(), "poisson", [&] {
-    poisson_cuda_kernel<scalar_t>(ret, lambda, next_philox_seed(gen, 20));
+    poisson_cuda_kernel<scalar_t>(ret, lambda, at::cuda::philox_cuda_state(20));
   });
   return ret;
 }
@@ -106,7 +99,7 @@ Tensor _s_poisson_cuda(const Tensor& lambda, Generator* gen) {
 Tensor _s_gamma_cuda(const Tensor& alpha, Generator* gen) {
   Tensor ret = alpha.type().tensor(alpha.sizes());
   AT_DISPATCH_FLOATING_TYPES_AND_HALF(ret.type(), "gamma", [&] {
-     gamma_cuda_kernel<scalar_t>(ret, alpha, next_philox_seed(gen, 10));
+     gamma_cuda_kernel<scalar_t>(ret, alpha, at::cuda::philox_cuda_state(10));
    });
   return ret;
 }
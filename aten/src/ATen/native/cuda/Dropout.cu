@@ -1,6 +1,7 @@
 #include "ATen/ATen.h"
 #include "ATen/AccumulateType.h"
 #include "ATen/cuda/CUDAApplyUtils.cuh"
+#include "ATen/cuda/PhiloxCudaState.h"
 #include "ATen/cuda/detail/IndexUtils.cuh"
 #include "ATen/cuda/detail/TensorInfo.cuh"
 #include "curand_kernel.h"
@@ -40,16 +41,16 @@ __global__ void
 fused_dropout_kernel(cuda::detail::TensorInfo<scalar_t, IndexType> a,
                       cuda::detail::TensorInfo<scalar_t, IndexType> b,
                       cuda::detail::TensorInfo<uint8_t, IndexType> c,
-                      IndexType totalElements, accscalar_t p, std::pair<uint64_t, uint64_t> seeds
+                      IndexType totalElements, accscalar_t p, at::cuda::PhiloxCudaState philox
                       ) {
 
   accscalar_t pinv = accscalar_t(1)/p;
   IndexType idx = blockIdx.x * blockDim.x + threadIdx.x;
   curandStatePhilox4_32_10_t state;
     curand_init(
-        seeds.first,
+        philox.seed,
         idx,
-        seeds.second,
+        at::cuda::philox_offset(philox),
         &state);
   IndexType rounded_size = ((totalElements - 1)/(blockDim.x * gridDim.x * UNROLL)+1) * 
         blockDim.x * gridDim.x * UNROLL;
@@ -86,6 +87,101 @@ fused_dropout_kernel(cuda::detail::TensorInfo<scalar_t, IndexType> a,
   }
 }
 
+// Same random stream as fused_dropout_kernel, but the mask is only used to
+// scale a into b, so that the backward can replay it from the seed and offset
+// instead of reading a saved mask. b must be contiguous.
+template <
+          typename scalar_t,
+          typename accscalar_t,
+          typename IndexType,
+          int ADims>
+#if __CUDA_ARCH__ >= 350
+__launch_bounds__(256,8)
+#endif
+__global__ void
+philox_dropout_kernel(cuda::detail::TensorInfo<scalar_t, IndexType> a,
+                      scalar_t* b,
+                      IndexType totalElements, accscalar_t p, std::pair<uint64_t, uint64_t> seeds
+                      ) {
+
+  accscalar_t pinv = accscalar_t(1)/p;
+  IndexType idx = blockIdx.x * blockDim.x + threadIdx.x;
+  curandStatePhilox4_32_10_t state;
+  curand_init(
+      seeds.first,
+      idx,
+      seeds.second,
+      &state);
+  IndexType rounded_size = ((totalElements - 1)/(blockDim.x * gridDim.x * UNROLL)+1) *
+        blockDim.x * gridDim.x * UNROLL;
+  for (IndexType linearIndex = idx;
+       linearIndex < rounded_size;
+       linearIndex += gridDim.x * blockDim.x*UNROLL) {
+       float4 rand = curand_uniform4(&state);
+       rand.x = rand.x < p;
+       rand.y = rand.y < p;
+       rand.z = rand.z < p;
+       rand.w = rand.w < p;
+       for (int ii = 0; ii < UNROLL; ii++) {
+           IndexType li = linearIndex + blockDim.x * gridDim.x * ii;
+           if (li < totalElements) {
+               const IndexType aOffset =
+                   cuda::detail::IndexToOffset<scalar_t, IndexType, ADims>::get(li, a);
+               b[li] = a.data[aOffset]*(&rand.x)[ii]*pinv;
+           }
+       }
+  }
+}
+
+// The launch configuration of the fused dropout kernels. The philox
+// dropout backward replays the forward's random stream, so both must derive
+// it from the number of elements alone.
+void dropout_launch_config(int64_t nelem, dim3* grid, dim3* block, int64_t* counter_offset) {
+  const int64_t block_size = 256;
+  unsigned int blocks_per_sm = at::cuda::getCurrentDeviceProperties()->maxThreadsPerMultiProcessor/block_size;
+  *block = dim3(block_size);
+  *grid = dim3((nelem + block_size -1)/block_size);
+  grid->x = std::min((unsigned int)at::cuda::getCurrentDeviceProperties()->multiProcessorCount * blocks_per_sm, grid->x);
+  //number of times random will be generated per thread, to offset philox counter in thc random state
+  *counter_offset = ((nelem - 1)/(block_size*grid->x*UNROLL)+1)*UNROLL;
+}
+
+template <typename IndexType>
+void launch_philox_dropout(const Tensor& self, Tensor& ret, double p, std::pair<uint64_t, uint64_t> seeds) {
+  const int64_t nelem = self.numel();
+  dim3 grid, dim_block;
+  int64_t counter_offset;
+  dropout_launch_config(nelem, &grid, &dim_block, &counter_offset);
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(self.type(), "philox_dropout", [&] {
+      using accscalar_t = acc_type<scalar_t, true>;
+      accscalar_t pa = (accscalar_t)(p);
+      auto self_info = cuda::detail::getTensorInfo<scalar_t, IndexType>(self);
+      self_info.collapseDims();
+      if (self_info.dims == 1) {
+        philox_dropout_kernel<scalar_t, accscalar_t, IndexType, 1><<<grid, dim_block, 0, at::cuda::getCurrentCUDAStream()>>>(
+            self_info, ret.data<scalar_t>(), nelem, pa, seeds);
+      } else {
+        philox_dropout_kernel<scalar_t, accscalar_t, IndexType, -1><<<grid, dim_block, 0, at::cuda::getCurrentCUDAStream()>>>(
+            self_info, ret.data<scalar_t>(), nelem, pa, seeds);
+      }
+  });
+  THCudaCheck(cudaGetLastError());
+}
+
+// Applies the dropout mask of the given seed and offset to self.
+Tensor philox_dropout(const Tensor& self, double p, std::pair<uint64_t, uint64_t> seeds) {
+  Tensor ret = at::empty_like(self);
+  if (self.numel() == 0) {
+    return ret;
+  }
+  if (cuda::detail::canUse32BitIndexMath(self)) {
+    launch_philox_dropout<unsigned int>(self, ret, p, seeds);
+  } else {
+    launch_philox_dropout<uint64_t>(self, ret, p, seeds);
+  }
+  return ret;
+}
+
 template<typename scalar_t, typename accscalar_t>
 void masked_scale_kernel(at::Tensor& ret, const at::Tensor src, const at::Tensor mask, accscalar_t scale){
    at::cuda::CUDA_tensor_apply3<scalar_t, scalar_t, uint8_t>(ret, src, mask, [scale]__device__(scalar_t& ret_val, const scalar_t& src_val, const uint8_t mask_val){
@@ -99,13 +195,10 @@ fused_dropout_cuda(const Tensor& self, double p, Generator * gen){
   Tensor ret = at::empty_like(self);
   Tensor mask = self.type().toScalarType(kByte).tensor(self.sizes());
   const int64_t nelem = self.numel();
-  const int64_t block_size = 256;
-  unsigned int blocks_per_sm = at::cuda::getCurrentDeviceProperties()->maxThreadsPerMultiProcessor/block_size;
-  dim3 dim_block(block_size);
-  dim3 grid((nelem + block_size -1)/block_size);
-  grid.x = std::min((unsigned int)at::cuda::getCurrentDeviceProperties()->multiProcessorCount * blocks_per_sm, grid.x);
-//number of times random will be generated per thread, to offset philox counter in thc random state
-  int64_t counter_offset = ((nelem - 1)/(block_size*grid.x*UNROLL)+1)*UNROLL;
+  dim3 grid, dim_block;
+  int64_t counter_offset;
+  dropout_launch_config(nelem, &grid, &dim_block, &counter_offset);
+  auto philox = at::cuda::philox_cuda_state(counter_offset);
   if (cuda::detail::canUse32BitIndexMath(self)){
   AT_DISPATCH_FLOATING_TYPES_AND_HALF(self.type(), "fused_dropout", [&] {
       using accscalar_t = acc_type<scalar_t, true>;
@@ -118,10 +211,10 @@ fused_dropout_cuda(const Tensor& self, double p, Generator * gen){
       mask_info.collapseDims(); //ret and mask are collapsed to 1d contiguous tensor
       switch (self_info.dims) {
         case 1:
-            fused_dropout_kernel<scalar_t, accscalar_t, unsigned int, 1><<<grid, dim_block, 0, at::cuda::getCurrentCUDAStream()>>>(self_info, ret_info, mask_info, nelem, pa, next_philox_seed(gen,counter_offset));
+            fused_dropout_kernel<scalar_t, accscalar_t, unsigned int, 1><<<grid, dim_block, 0, at::cuda::getCurrentCUDAStream()>>>(self_info, ret_info, mask_info, nelem, pa, philox);
             break;
         default:
-            fused_dropout_kernel<scalar_t, accscalar_t, unsigned int, -1><<<grid, dim_block, 0, at::cuda::getCurrentCUDAStream()>>>(self_info, ret_info, mask_info, nelem, pa, next_philox_seed(gen,counter_offset));
+            fused_dropout_kernel<scalar_t, accscalar_t, unsigned int, -1><<<grid, dim_block, 0, at::cuda::getCurrentCUDAStream()>>>(self_info, ret_info, mask_info, nelem, pa, philox);
       }
    });
   } else {
@@ -136,10 +229,10 @@ fused_dropout_cuda(const Tensor& self, double p, Generator * gen){
       mask_info.collapseDims(); //ret and mask are collapsed to 1d contiguous tensor
       switch (self_info.dims) {
         case 1:
-            fused_dropout_kernel<scalar_t, accscalar_t, uint64_t, 1><<<grid, dim_block, 0, at::cuda::getCurrentCUDAStream()>>>(self_info, ret_info, mask_info, nelem, pa, next_philox_seed(gen,counter_offset));
+            fused_dropout_kernel<scalar_t, accscalar_t, uint64_t, 1><<<grid, dim_block, 0, at::cuda::getCurrentCUDAStream()>>>(self_info, ret_info, mask_info, nelem, pa, philox);
             break;
         default:
-            fused_dropout_kernel<scalar_t, accscalar_t, uint64_t, -1><<<grid, dim_block, 0, at::cuda::getCurrentCUDAStream()>>>(self_info, ret_info, mask_info, nelem, pa, next_philox_seed(gen,counter_offset));
+            fused_dropout_kernel<scalar_t, accscalar_t, uint64_t, -1><<<grid, dim_block, 0, at::cuda::getCurrentCUDAStream()>>>(self_info, ret_info, mask_info, nelem, pa, philox);
       }
    });
   }
@@ -147,6 +240,36 @@ fused_dropout_cuda(const Tensor& self, double p, Generator * gen){
   return std::tuple<Tensor,Tensor>(ret, mask);
 }
 
+std::tuple<Tensor,Tensor>
+fused_dropout_philox_cuda(const Tensor& self, double p, Generator * gen){
+  // Only the seed and offset are kept for the backward, as a CPU tensor.
+  AT_CHECK(!at::cuda::philox_capture_underway(),
+           "_fused_dropout_philox can't be captured in a CUDA graph, since it returns its random offset on the CPU");
+  Tensor philox_state = at::empty({2}, self.options().device(at::Device(at::Device::Type::CPU)).dtype(kLong));
+  std::pair<uint64_t, uint64_t> seeds(0, 0);
+  if (self.numel() > 0) {
+    dim3 grid, dim_block;
+    int64_t counter_offset;
+    dropout_launch_config(self.numel(), &grid, &dim_block, &counter_offset);
+    seeds = next_philox_seed(gen, counter_offset);
+  }
+  philox_state.data<int64_t>()[0] = static_cast<int64_t>(seeds.first);
+  philox_state.data<int64_t>()[1] = static_cast<int64_t>(seeds.second);
+  return std::tuple<Tensor,Tensor>(philox_dropout(self, p, seeds), philox_state);
+}
+
+Tensor fused_dropout_philox_backward_cuda(const Tensor& grad, const Tensor& philox_state, double p){
+  AT_CHECK(philox_state.type().scalarType() == at::ScalarType::Long && philox_state.numel() == 2,
+           "philox_state should be the 2 element torch.int64 tensor returned by _fused_dropout_philox");
+  Tensor state = philox_state.toBackend(Backend::CPU).contiguous();
+  std::pair<uint64_t, uint64_t> seeds(
+      static_cast<uint64_t>(state.data<int64_t>()[0]),
+      static_cast<uint64_t>(state.data<int64_t>()[1]));
+  // The forward output, and so grad, is contiguous, so grad's elements line
+  // up with the forward's random numbers.
+  return philox_dropout(grad.contiguous(), p, seeds);
+}
+
 Tensor masked_scale_cuda(const Tensor& self, const Tensor& mask, double scale){
    Tensor ret = at::empty_like(self);
    AT_CHECK(mask.type().scalarType() == at::ScalarType::Byte, "mask should be torch.uint8 dtype");
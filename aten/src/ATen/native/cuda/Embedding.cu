@@ -3,6 +3,7 @@
 #include "ATen/TensorUtils.h"
 #include "ATen/core/Error.h"
 #include "ATen/cuda/CUDAContext.h"
+#include "ATen/native/cuda/EmbeddingBackwardKernel.cuh"
 
 #include <THC/THCDeviceUtils.cuh>
 #include <THC/THCTensorMathReduce.cuh>
@@ -98,67 +99,6 @@ __global__ void embedding_backward_feature_kernel
 }
 
 
-template <typename scalar_t>
-__global__ void embedding_backward_kernel(
-  int64_t* input, int64_t* indices, scalar_t* grad_output, scalar_t* grad_weight,
-  int64_t* count, int64_t numel, int64_t stride, int padding_idx) {
-
-  using accscalar_t = acc_type<scalar_t, true>;
-  int idx = blockIdx.x * 4 + threadIdx.y;
-
-  // Each warp is responsible for an input into the LookupTable.
-  // If the preceding input has the same as this input, then the warp
-  // exits immediately. The warp also processes subsequent inputs with the
-  // same value.
-  //
-  // Input Warp
-  // 1     <warp 1>
-  // 1     <warp 1> (<warp 2> exits without doing any work)
-  // 5     <warp 3>
-  // 8     <warp 4>
-
-  // Number of values proceessed by each thread (grain size)
-  const int SZ = 4;
-
-  if (idx < numel
-      && (idx == 0 || input[idx] != input[idx - 1])
-      && input[idx] != padding_idx) {
-    do {
-      const int start_feature = threadIdx.x + blockIdx.y * blockDim.x * SZ;
-      const int weight_row = ((int) input[idx]) * stride;
-      const int grad_row = ((int) indices[idx]) * stride;
-      const accscalar_t scale = count ? (accscalar_t)1.0 / count[idx] : 1.0;
-
-      accscalar_t gradient[SZ];
-      accscalar_t weight[SZ];
-
-      #pragma unroll
-      for (int ii = 0; ii < SZ; ii++) {
-        int feature_dim = start_feature + ii * WARP_SIZE;
-        if (feature_dim < stride) {
-          gradient[ii] = static_cast<accscalar_t>(grad_output[grad_row + feature_dim]);
-          weight[ii] = static_cast<accscalar_t>(grad_weight[weight_row + feature_dim]);
-        }
-      }
-
-      #pragma unroll
-      for (int ii = 0; ii < SZ; ii++) {
-        weight[ii] += gradient[ii] * scale;
-      }
-
-      #pragma unroll
-      for (int ii = 0; ii < SZ; ii++) {
-        int feature_dim = start_feature + ii * WARP_SIZE;
-        if (feature_dim < stride) {
-            grad_weight[weight_row + feature_dim] = static_cast<scalar_t>(weight[ii]);
-        }
-      }
-
-      idx++;
-    } while (idx < numel && input[idx] == input[idx - 1]);
-  }
-}
-
 /* Calculate norms of the rows of weight_ptr given by idx_ptr and capture them in norms */
 template <typename scalar_t, typename accscalar_t>
 __global__ void renorm_kernel(
@@ -214,13 +154,12 @@ Tensor embedding_dense_backward_cuda(const Tensor & grad_, const Tensor & indice
 
   auto num_indices = indices.numel();
   auto grad = grad_.contiguous().view({num_indices, grad_.size(-1)});
-  auto grad_weight = at::zeros({num_weights, grad_.size(-1)}, grad_.options());
-
-  int64_t stride = grad_weight.stride(0);
   cudaStream_t stream = at::cuda::getCurrentCUDAStream();
 
   if (num_indices <= 768 && !scale_grad_by_freq) {
     auto indices_contig = indices.contiguous();
+    auto grad_weight = at::zeros({num_weights, grad_.size(-1)}, grad_.options());
+    int64_t stride = grad_weight.stride(0);
 
     dim3 grid(THCCeilDiv(stride, (int64_t)WARP_SIZE));
     dim3 block(WARP_SIZE, BLOCKDIMY);
@@ -266,10 +205,11 @@ Tensor embedding_dense_backward_cuda(const Tensor & grad_, const Tensor & indice
     auto orig_data = device_ptr(orig_indices.data<int64_t>());
     thrust::copy(policy, count_iter, count_iter + num_indices, orig_data);
 
-    // Sort; a stable sort is not required
+    // Sort; a stable sort is not required. thrust::less lets Thrust use a
+    // radix sort.
     auto sorted_data = device_ptr(sorted_indices.data<int64_t>());
     thrust::sort_by_key(policy, sorted_data, sorted_data + num_indices, orig_data,
-                        ThrustLTOp<int64_t>());
+                        thrust::less<int64_t>());
   }
 
   Tensor count;
@@ -306,23 +246,8 @@ Tensor embedding_dense_backward_cuda(const Tensor & grad_, const Tensor & indice
     );
   }
 
-  dim3 grid(THCCeilDiv(num_indices, (int64_t) 4), THCCeilDiv(stride, (int64_t) 128));
-  dim3 block(32, 4);
-
-  AT_DISPATCH_FLOATING_TYPES_AND_HALF(grad.type(), "embedding_backward", [&] {
-    embedding_backward_kernel<<<grid, block, 0, stream>>>(
-      sorted_indices.data<int64_t>(),
-      orig_indices.data<int64_t>(),
-      grad.data<scalar_t>(),
-      grad_weight.data<scalar_t>(),
-      count.defined() ? count.data<int64_t>() : nullptr,
-      num_indices,
-      stride,
-      padding_idx);
-  });
-  THCudaCheck(cudaGetLastError());
-
-  return grad_weight;
+  return embedding_backward_cuda_kernel(grad, orig_indices, sorted_indices,
+                                        count, num_weights, padding_idx);
 }
 
 Tensor & embedding_renorm_cuda_(Tensor & self, const Tensor & indices,
@@ -0,0 +1,234 @@
+#include "ATen/native/cuda/EmbeddingBackwardKernel.cuh"
+
+#include "ATen/AccumulateType.h"
+#include "ATen/cuda/CUDAContext.h"
+
+#include <THC/THCDeviceUtils.cuh>
+#include <THC/THCThrustAllocator.cuh>
+
+#include <thrust/execution_policy.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/scan.h>
+#include <thrust/unique.h>
+
+#include <algorithm>
+#include <type_traits>
+
+namespace at { namespace native {
+
+namespace {
+
+static const int WARP_SIZE = 32;
+static const int MAX_BLOCK_SIZE = 1024;
+
+// A segment is a run of equal sorted indices. Segments are split into
+// partial segments of at most NROWS_PER_THREAD rows, so an index used
+// thousands of times is reduced by many threads instead of one.
+static const int NROWS_PER_THREAD = 10;
+
+__global__ void krn_partials_per_segment(
+    int64_t *ret, const int64_t *segment_offsets,
+    int64_t num_of_segments, int64_t numel) {
+  const int64_t id = (int64_t)blockIdx.x * blockDim.x + threadIdx.x;
+  if (id < num_of_segments) {
+    const int64_t idx_start = segment_offsets[id];
+    const int64_t idx_end = (id == num_of_segments - 1) ? numel : segment_offsets[id + 1];
+    ret[id] = THCCeilDiv(idx_end - idx_start, (int64_t)NROWS_PER_THREAD);
+  }
+}
+
+__global__ void krn_partial_segment_offset(
+    int64_t *ret, const int64_t *partials_per_segment,
+    const int64_t *partials_per_segment_offset,
+    const int64_t *segment_offsets, int64_t num_of_segments) {
+  const int64_t id = (int64_t)blockIdx.x * blockDim.x + threadIdx.x;
+  if (id < num_of_segments) {
+    int64_t idx = partials_per_segment_offset[id];
+    const int64_t num_partials = partials_per_segment[id];
+    const int64_t segment_offset = segment_offsets[id];
+    for (int64_t i = 0; i < num_partials; ++i) {
+      ret[idx++] = segment_offset + i * NROWS_PER_THREAD;
+    }
+  }
+}
+
+// Each warp reduces WARP_SIZE consecutive features of one partial segment,
+// so the loads of `grad` are coalesced. If `direct` is set, every segment is
+// a single partial segment and the result is written to `grad_weight`
+// straight away; otherwise it goes to `grad_weight_per_segment`.
+template <typename scalar_t, typename accscalar_t>
+__global__ void compute_grad_weight(
+    const int64_t *sorted_indices, const int64_t *orig_indices,
+    const scalar_t *grad, const int64_t *count, int64_t numel, int64_t stride,
+    const int64_t *partial_segment_offset, int64_t num_of_partial_segments,
+    accscalar_t *grad_weight_per_segment, scalar_t *grad_weight, bool direct,
+    int padding_idx, const int64_t *offset2bag, const int64_t *bag_size,
+    bool mode_mean, int64_t stride_warped) {
+  const int64_t gid = (int64_t)blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t id = gid / stride_warped;
+  const int64_t feature = gid % stride_warped;
+  if (feature >= stride || id >= num_of_partial_segments) {
+    return;
+  }
+  const int64_t idx_begin = partial_segment_offset[id];
+  const int64_t idx_end = (id == num_of_partial_segments - 1) ? numel : partial_segment_offset[id + 1];
+
+  accscalar_t weight = 0;
+  for (int64_t idx = idx_begin; idx < idx_end; ++idx) {
+    const int64_t orig_row = orig_indices[idx];
+    const int64_t grad_row = offset2bag ? offset2bag[orig_row] : orig_row;
+    accscalar_t scale = count ? (accscalar_t)1.0 / count[idx] : 1.0;
+    if (mode_mean) {
+      scale /= bag_size[grad_row];
+    }
+    weight += static_cast<accscalar_t>(grad[grad_row * stride + feature]) * scale;
+  }
+
+  if (direct) {
+    const int64_t target_row = sorted_indices[idx_begin];
+    if (target_row != padding_idx) {
+      grad_weight[target_row * stride + feature] = static_cast<scalar_t>(weight);
+    }
+  } else {
+    grad_weight_per_segment[id * stride + feature] = weight;
+  }
+}
+
+// Sums the partial segments of every segment, in order.
+template <typename scalar_t, typename accscalar_t>
+__global__ void sum_and_scatter(
+    const int64_t *sorted_indices, scalar_t *grad_weight, int64_t stride,
+    const int64_t *segment_offsets, int64_t num_of_segments,
+    const accscalar_t *grad_weight_per_segment,
+    const int64_t *partials_per_segment_offset, int64_t num_of_partial_segments,
+    int padding_idx, int64_t stride_warped) {
+  const int64_t gid = (int64_t)blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t id = gid / stride_warped;
+  const int64_t feature = gid % stride_warped;
+  if (feature >= stride || id >= num_of_segments) {
+    return;
+  }
+  const int64_t idx_begin = partials_per_segment_offset[id];
+  const int64_t idx_end = (id == num_of_segments - 1) ? num_of_partial_segments : partials_per_segment_offset[id + 1];
+
+  accscalar_t weight = 0;
+  for (int64_t idx = idx_begin; idx < idx_end; ++idx) {
+    weight += grad_weight_per_segment[idx * stride + feature];
+  }
+  const int64_t target_row = sorted_indices[segment_offsets[id]];
+  if (target_row != padding_idx) {
+    grad_weight[target_row * stride + feature] = static_cast<scalar_t>(weight);
+  }
+}
+
+} // anonymous namespace
+
+Tensor embedding_backward_cuda_kernel(
+    const Tensor &grad,
+    const Tensor &orig_indices,
+    const Tensor &sorted_indices,
+    const Tensor &count,
+    int64_t num_weights,
+    int padding_idx,
+    bool mode_mean,
+    const Tensor &offset2bag,
+    const Tensor &bag_size) {
+  auto grad_weight = at::zeros({num_weights, grad.size(-1)}, grad.options());
+  const int64_t numel = sorted_indices.numel();
+  const int64_t stride = grad_weight.stride(0);
+  if (numel == 0 || stride == 0) {
+    return grad_weight;
+  }
+
+  cudaStream_t stream = at::cuda::getCurrentCUDAStream();
+  auto allocator = THCThrustAllocator(globalContext().lazyInitCUDA());
+  auto policy = thrust::cuda::par(allocator).on(stream);
+  using device_ptr = thrust::device_ptr<int64_t>;
+
+  // Compute the start of every segment:
+  // sorted:          2 5 5 5 7 7 8 9 9
+  // segment_offsets: 0 1 4 6 7
+  auto segment_offsets = at::empty({numel}, orig_indices.options());
+  int64_t num_of_segments;
+  {
+    auto sorted_data = device_ptr(sorted_indices.data<int64_t>());
+    auto unique_indices = at::empty_like(sorted_indices);
+    auto unique_data = device_ptr(unique_indices.data<int64_t>());
+    auto offsets_data = device_ptr(segment_offsets.data<int64_t>());
+    auto ends = thrust::unique_by_key_copy(
+        policy, sorted_data, sorted_data + numel,
+        thrust::make_counting_iterator<int64_t>(0), unique_data, offsets_data);
+    num_of_segments = thrust::get<0>(ends) - unique_data;
+  }
+
+  // Split the segments into partial segments:
+  // partials_per_segment:        1 2 1 1 1   (with NROWS_PER_THREAD = 2)
+  // partials_per_segment_offset: 0 1 3 4 5
+  // partial_segment_offset:      0 1 3 4 6 7
+  auto partials_per_segment = at::empty({num_of_segments}, orig_indices.options());
+  krn_partials_per_segment<<<THCCeilDiv(num_of_segments, (int64_t)32), 32, 0, stream>>>(
+      partials_per_segment.data<int64_t>(), segment_offsets.data<int64_t>(),
+      num_of_segments, numel);
+
+  auto partials_per_segment_offset = at::empty({num_of_segments}, orig_indices.options());
+  thrust::exclusive_scan(
+      policy,
+      device_ptr(partials_per_segment.data<int64_t>()),
+      device_ptr(partials_per_segment.data<int64_t>() + num_of_segments),
+      device_ptr(partials_per_segment_offset.data<int64_t>()));
+
+  const int64_t num_of_partial_segments =
+      partials_per_segment[num_of_segments - 1].toCLong() +
+      partials_per_segment_offset[num_of_segments - 1].toCLong();
+
+  auto partial_segment_offset = at::empty({num_of_partial_segments}, orig_indices.options());
+  krn_partial_segment_offset<<<THCCeilDiv(num_of_segments, (int64_t)32), 32, 0, stream>>>(
+      partial_segment_offset.data<int64_t>(),
+      partials_per_segment.data<int64_t>(),
+      partials_per_segment_offset.data<int64_t>(),
+      segment_offsets.data<int64_t>(), num_of_segments);
+
+  // When no index is used more than NROWS_PER_THREAD times, every segment
+  // is a single partial segment and the second pass isn't needed.
+  const bool direct = num_of_partial_segments == num_of_segments;
+  const int64_t stride_warped = THCCeilDiv(stride, (int64_t)WARP_SIZE) * WARP_SIZE;
+  const int block = std::min<int64_t>(stride_warped, MAX_BLOCK_SIZE);
+
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(grad.type(), "embedding_backward_cuda_kernel", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    Tensor grad_weight_per_segment;
+    if (!direct) {
+      auto acc_dtype = std::is_same<accscalar_t, double>::value ? kDouble : kFloat;
+      grad_weight_per_segment = at::empty({num_of_partial_segments, stride}, grad.options().dtype(acc_dtype));
+    }
+
+    const int grid = THCCeilDiv(num_of_partial_segments * stride_warped, (int64_t)block);
+    compute_grad_weight<scalar_t, accscalar_t><<<grid, block, 0, stream>>>(
+        sorted_indices.data<int64_t>(), orig_indices.data<int64_t>(),
+        grad.data<scalar_t>(),
+        count.defined() ? count.data<int64_t>() : nullptr,
+        numel, stride, partial_segment_offset.data<int64_t>(),
+        num_of_partial_segments,
+        direct ? nullptr : grad_weight_per_segment.data<accscalar_t>(),
+        grad_weight.data<scalar_t>(), direct, padding_idx,
+        offset2bag.defined() ? offset2bag.data<int64_t>() : nullptr,
+        bag_size.defined() ? bag_size.data<int64_t>() : nullptr,
+        mode_mean, stride_warped);
+    THCudaCheck(cudaGetLastError());
+
+    if (!direct) {
+      const int grid = THCCeilDiv(num_of_segments * stride_warped, (int64_t)block);
+      sum_and_scatter<scalar_t, accscalar_t><<<grid, block, 0, stream>>>(
+          sorted_indices.data<int64_t>(), grad_weight.data<scalar_t>(), stride,
+          segment_offsets.data<int64_t>(), num_of_segments,
+          grad_weight_per_segment.data<accscalar_t>(),
+          partials_per_segment_offset.data<int64_t>(), num_of_partial_segments,
+          padding_idx, stride_warped);
+      THCudaCheck(cudaGetLastError());
+    }
+  });
+
+  return grad_weight;
+}
+
+}} // namespace at::native
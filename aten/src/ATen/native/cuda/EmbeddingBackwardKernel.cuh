@@ -0,0 +1,30 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+namespace at { namespace native {
+
+// Computes the gradient of an embedding (or an embedding_bag in mode sum or
+// mean) with respect to its weight, given the indices sorted in ascending
+// order and the positions they had before sorting. Row i of `grad` is the
+// gradient of index i, or of bag offset2bag[i] if `offset2bag` is defined.
+//
+// The gradients of every unique index are summed in a fixed order, without
+// atomics, so the result is deterministic. Indices used many times are split
+// into segments of a few rows that are reduced in parallel and then summed.
+//
+// If `count` is defined, the gradient of sorted index i is divided by
+// count[i] (see scale_grad_by_freq). In mode mean, it is also divided by the
+// size of its bag. Rows of `padding_idx` get no gradient.
+Tensor embedding_backward_cuda_kernel(
+    const Tensor &grad,
+    const Tensor &orig_indices,
+    const Tensor &sorted_indices,
+    const Tensor &count,
+    int64_t num_weights,
+    int padding_idx = -1,
+    bool mode_mean = false,
+    const Tensor &offset2bag = Tensor(),
+    const Tensor &bag_size = Tensor());
+
+}} // namespace at::native
@@ -2,6 +2,7 @@
 #include "ATen/cuda/CUDAContext.h"
 #include "ATen/TensorUtils.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/native/cuda/EmbeddingBackwardKernel.cuh"
 
 #include "ATen/AccumulateType.h"
 
@@ -14,6 +15,8 @@
 #include <thrust/execution_policy.h>
 #include <thrust/unique.h>
 
+#include <algorithm>
+
 const int WARP_SIZE = 32;
 const int MODE_SUM = 0;
 const int MODE_MEAN = 1;
@@ -94,77 +97,6 @@ __global__ void EmbeddingBag_updateOutputKernel(
 // still be nice to not be slow in that case.
 
 // This kernel assumes that all input tensors are contiguous.
-template <typename scalar_t>
-__global__ void EmbeddingBag_accGradParametersKernel_sum_avg(
-    int64_t *input, int64_t *indices, scalar_t *gradOutput,
-    scalar_t *gradWeight, int64_t *offset2bag, int64_t *count, ptrdiff_t numel,
-    int64_t stride, int mode, int64_t *bag_size) {
-
-  using accscalar_t = acc_type<scalar_t, true>;
-  int idx = blockIdx.x * 4 + threadIdx.y;
-
-  // Each warp is responsible for an input into the LookupTable.
-  // If the preceding input has the same as this input, then the warp
-  // exits immediately. The warp also processes subsequent inputs with the
-  // same value.  //
-  // Input Warp
-  // 1     <warp 1>
-  // 1     <warp 1> (<warp 2> exits without doing any work)
-  // 5     <warp 3>
-  // 8     <warp 4>
-
-  // Number of values proceessed by each thread (grain size)
-  const int SZ = 4;
-
-  if (idx < numel && (idx == 0 || input[idx] != input[idx - 1])) {
-    do {
-      const int startFeature = threadIdx.x + blockIdx.y * blockDim.x * SZ;
-      const int weightRow = ((int)input[idx]) * stride;
-
-      // Note: only this line changes from LookupTable_accgradParametersKernel
-      const int origRow = ((int)indices[idx]);
-      const int seq_number = offset2bag[origRow];
-      const int gradOutputRow = ((int)seq_number) * stride;
-
-      const accscalar_t scale = count ? (accscalar_t)1.0 / count[idx] : 1.0;
-
-      accscalar_t gradient[SZ];
-      accscalar_t weight[SZ];
-
-#pragma unroll
-      for (int ii = 0; ii < SZ; ii++) {
-        int featureDim = startFeature + ii * WARP_SIZE;
-        if (featureDim < stride) {
-          gradient[ii] =
-              static_cast<accscalar_t>(gradOutput[gradOutputRow + featureDim]);
-          if (mode == MODE_MEAN) {
-            gradient[ii] /= bag_size[seq_number];
-          }
-          weight[ii] =
-              static_cast<accscalar_t>(gradWeight[weightRow + featureDim]);
-        }
-      }
-
-#pragma unroll
-      for (int ii = 0; ii < SZ; ii++) {
-        weight[ii] += gradient[ii] * scale;
-      }
-
-#pragma unroll
-      for (int ii = 0; ii < SZ; ii++) {
-        int featureDim = startFeature + ii * WARP_SIZE;
-        if (featureDim < stride) {
-          gradWeight[weightRow + featureDim] =
-              static_cast<scalar_t>(weight[ii]);
-        }
-      }
-
-      idx++;
-    } while (idx < numel && input[idx] == input[idx - 1]);
-  }
-}
-
-
 Tensor embedding_bag_backward_cuda_sum_avg(
                                    const Tensor &grad,
                                    const Tensor &indices,
@@ -175,12 +107,9 @@ Tensor embedding_bag_backward_cuda_sum_avg(
 
   Tensor &bag_size = const_cast<Tensor &>(bag_size_);
 
-  auto grad_weight = at::zeros({num_weights, grad.size(1)}, grad.type());
-
   cudaStream_t stream = at::cuda::getCurrentCUDAStream();
 
   ptrdiff_t numel = indices.numel();
-  int64_t stride = grad_weight.stride(0);
 
   auto sorted_indices = indices.type().tensor(indices.sizes());
   auto orig_indices = indices.type().tensor(indices.sizes());
@@ -200,10 +129,11 @@ Tensor embedding_bag_backward_cuda_sum_avg(
     auto orig_data = device_ptr(orig_indices.data<int64_t>());
     thrust::copy(policy, count_iter, count_iter + numel, orig_data);
 
-    // Sort; a stable sort is not required
+    // Sort; a stable sort is not required. thrust::less lets Thrust use a
+    // radix sort.
     auto sorted_data = device_ptr(sorted_indices.data<int64_t>());
     thrust::sort_by_key(policy, sorted_data, sorted_data + numel, orig_data,
-                        ThrustLTOp<int64_t>());
+                        thrust::less<int64_t>());
   }
 
   Tensor count;
@@ -233,21 +163,9 @@ Tensor embedding_bag_backward_cuda_sum_avg(
         thrust::equal_to<int64_t>(), thrust::maximum<int64_t>());
   }
 
-  dim3 grid(THCCeilDiv(numel, (ptrdiff_t)4), THCCeilDiv(stride, (int64_t)128));
-  dim3 block(32, 4);
-  AT_DISPATCH_FLOATING_TYPES_AND_HALF(
-      grad.type(), "embedding_bag_backward_cuda_sum_avg_kernel", [&] {
-        EmbeddingBag_accGradParametersKernel_sum_avg<
-            scalar_t><<<grid, block, 0, stream>>>(
-            sorted_indices.data<int64_t>(), orig_indices.data<int64_t>(),
-            grad.data<scalar_t>(), grad_weight.data<scalar_t>(),
-            offset2bag.data<int64_t>(),
-            count.defined() ? count.data<int64_t>() : nullptr, numel, stride,
-            mode, bag_size.data<int64_t>());
-      });
-
-  THCudaCheck(cudaGetLastError());
-  return grad_weight;
+  return embedding_backward_cuda_kernel(grad, orig_indices, sorted_indices,
+                                        count, num_weights, /* padding_idx= */ -1,
+                                        mode == MODE_MEAN, offset2bag, bag_size);
 }
 
 template <typename scalar_t>
@@ -300,6 +218,39 @@ Tensor embedding_bag_backward_cuda_max(const Tensor &grad,
   THCudaCheck(cudaGetLastError());
   return grad_weight;
 }
+
+// See Note [Row-wise quantized embeddings] in EmbeddingBag.cpp. Each bag is
+// handled by a block, and each feature by a thread of the block.
+template <int bit_rate>
+__global__ void EmbeddingBag_rowwiseKernel(
+    const uint8_t *packed, const int64_t *input, const int64_t *offsets,
+    const float *per_sample_weights, float *output, int64_t numIndices,
+    int64_t numBags, int64_t featureSize, int64_t rowBytes, bool mean) {
+  constexpr int elemsPerByte = 8 / bit_rate;
+  constexpr int mask = (1 << bit_rate) - 1;
+  for (int64_t bag = blockIdx.x; bag < numBags; bag += gridDim.x) {
+    int64_t begin = offsets[bag];
+    int64_t end = bag + 1 < numBags ? offsets[bag + 1] : numIndices;
+    for (int64_t d = threadIdx.x; d < featureSize; d += blockDim.x) {
+      float acc = 0;
+      for (int64_t i = begin; i < end; i++) {
+        const uint8_t *row = packed + input[i] * rowBytes;
+        // The rows aren't aligned to floats
+        float scale, bias;
+        memcpy(&scale, row + rowBytes - 2 * sizeof(float), sizeof(float));
+        memcpy(&bias, row + rowBytes - sizeof(float), sizeof(float));
+        int q = (row[d / elemsPerByte] >> ((d % elemsPerByte) * bit_rate)) & mask;
+        float value = scale * q + bias;
+        acc += per_sample_weights ? per_sample_weights[i] * value : value;
+      }
+      if (mean && end > begin) {
+        acc /= (end - begin);
+      }
+      output[bag * featureSize + d] = acc;
+    }
+  }
+}
+
 }
 
 // Assumes all input tensors are contiguous.
@@ -307,7 +258,10 @@ Tensor embedding_bag_backward_cuda_max(const Tensor &grad,
 std::tuple<Tensor, Tensor, Tensor, Tensor>
 _embedding_bag_cuda(const Tensor &weight, const Tensor &indices,
                    const Tensor &offsets, const bool scale_grad_by_freq,
-                   const int64_t mode, bool sparse) {
+                   const int64_t mode, bool sparse,
+                   const Tensor &per_sample_weights) {
+  AT_CHECK(!per_sample_weights.defined(),
+           "embedding_bag_cuda: per_sample_weights is not supported on CUDA");
   auto indices_arg = TensorArg(indices, "indices", 1);
   checkScalarType("embedding_bag_cuda", indices_arg, kLong);
   auto offsets_arg = TensorArg(offsets, "offsets", 1);
@@ -358,7 +312,10 @@ Tensor _embedding_bag_dense_backward_cuda(const Tensor &grad_, const Tensor &ind
                                    const Tensor &bag_size_,
                                    const Tensor &max_indices,
                                    int64_t num_weights,
-                                   bool scale_grad_by_freq, int64_t mode) {
+                                   bool scale_grad_by_freq, int64_t mode,
+                                   const Tensor &per_sample_weights) {
+  AT_CHECK(!per_sample_weights.defined(),
+           "embedding_bag_cuda: per_sample_weights is not supported on CUDA");
   // indices, offsets and offset2bag are assumed having correct dtypes and
   // contiguous here due to the checks in _embedding_bag_backward in
   // EmbeddingBag.cpp.
@@ -386,5 +343,73 @@ Tensor _embedding_bag_dense_backward_cuda(const Tensor &grad_, const Tensor &ind
   }
 }
 
+Tensor _embedding_bag_rowwise_cuda(const Tensor &packed_, const Tensor &indices_,
+                                   const Tensor &offsets_, int64_t bit_rate,
+                                   int64_t mode,
+                                   const Tensor &per_sample_weights_) {
+  AT_CHECK(bit_rate == 8 || bit_rate == 4,
+           "embedding_bag_rowwise: bit_rate has to be 8 or 4, but got ", bit_rate);
+  AT_CHECK(packed_.dim() == 2 && packed_.type().scalarType() == kByte &&
+           packed_.size(1) >= 2 * (int64_t)sizeof(float),
+           "embedding_bag_rowwise: expected a 2-D Byte tensor from "
+           "_embedding_bag_pack_rowwise, but got ", packed_.type().toString(),
+           " of sizes ", packed_.sizes());
+  AT_CHECK(mode == MODE_SUM || mode == MODE_MEAN,
+           "embedding_bag_rowwise: only mode sum and mean are supported");
+  auto packed = packed_.contiguous();
+  auto indices = indices_.contiguous();
+  auto offsets = offsets_.contiguous();
+  auto packed_arg = TensorArg(packed, "packed", 1);
+  auto indices_arg = TensorArg(indices, "indices", 2);
+  checkScalarType("embedding_bag_rowwise_cuda", indices_arg, kLong);
+  checkDim("embedding_bag_rowwise_cuda", indices_arg, 1);
+  auto offsets_arg = TensorArg(offsets, "offsets", 3);
+  checkScalarType("embedding_bag_rowwise_cuda", offsets_arg, kLong);
+  checkDim("embedding_bag_rowwise_cuda", offsets_arg, 1);
+  checkSameGPU("embedding_bag_rowwise_cuda", packed_arg, indices_arg);
+  checkSameGPU("embedding_bag_rowwise_cuda", packed_arg, offsets_arg);
+
+  Tensor per_sample_weights;
+  if (per_sample_weights_.defined()) {
+    AT_CHECK(mode == MODE_SUM,
+             "embedding_bag_rowwise: per_sample_weights is only supported for mode='sum'");
+    AT_CHECK(per_sample_weights_.dim() == 1 &&
+             per_sample_weights_.numel() == indices.numel() &&
+             per_sample_weights_.type().scalarType() == kFloat,
+             "embedding_bag_rowwise: expected per_sample_weights to be a 1-D "
+             "Float tensor with ", indices.numel(), " elements");
+    per_sample_weights = per_sample_weights_.contiguous();
+    auto psw_arg = TensorArg(per_sample_weights, "per_sample_weights", 6);
+    checkSameGPU("embedding_bag_rowwise_cuda", packed_arg, psw_arg);
+  }
+
+  int64_t numIndices = indices.size(0);
+  int64_t numBags = offsets.size(0);
+  int64_t rowBytes = packed.size(1);
+  int64_t featureSize = (rowBytes - 2 * sizeof(float)) * (8 / bit_rate);
+  auto output = at::empty({numBags, featureSize}, packed.options().dtype(kFloat));
+  if (numBags == 0) {
+    return output;
+  }
+
+  cudaStream_t stream = at::cuda::getCurrentCUDAStream();
+  int grid = std::min<int64_t>(numBags, 4096);
+  int block = 128;
+  const float *psw_data = per_sample_weights.defined() ? per_sample_weights.data<float>() : nullptr;
+  if (bit_rate == 8) {
+    EmbeddingBag_rowwiseKernel<8><<<grid, block, 0, stream>>>(
+        packed.data<uint8_t>(), indices.data<int64_t>(), offsets.data<int64_t>(),
+        psw_data, output.data<float>(), numIndices, numBags, featureSize,
+        rowBytes, mode == MODE_MEAN);
+  } else {
+    EmbeddingBag_rowwiseKernel<4><<<grid, block, 0, stream>>>(
+        packed.data<uint8_t>(), indices.data<int64_t>(), offsets.data<int64_t>(),
+        psw_data, output.data<float>(), numIndices, numBags, featureSize,
+        rowBytes, mode == MODE_MEAN);
+  }
+  THCudaCheck(cudaGetLastError());
+  return output;
+}
+
 }
 }
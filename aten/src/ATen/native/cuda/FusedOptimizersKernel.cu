@@ -0,0 +1,229 @@
+#include "ATen/native/FusedOptimizers.h"
+
+#include "ATen/AccumulateType.h"
+#include "ATen/Dispatch.h"
+#include "ATen/native/cuda/MultiTensorApply.cuh"
+
+#include <vector>
+
+// See Note [Fused optimizers] in FusedOptimizers.h
+
+namespace at { namespace native {
+
+namespace {
+
+// Tensor lists are laid out as the arguments of the fused functions: the
+// parameters, the gradients, then the state buffers in order. `slot` returns
+// the element of list `d` of the current chunk, or null if `d` is negative,
+// i.e. if the list isn't used.
+template <int depth, typename scalar_t>
+struct Chunk {
+  __device__ Chunk(int64_t chunk_size, TensorListMetadata<depth>& tl) {
+    const int tensor = tl.block_to_tensor[blockIdx.x];
+    const int64_t offset = (int64_t)tl.block_to_chunk[blockIdx.x] * chunk_size;
+    for (int d = 0; d < depth; d++) {
+      data[d] = static_cast<scalar_t*>(tl.addresses[d][tensor]) + offset;
+    }
+    n = tl.sizes[tensor] - offset;
+    if (n > chunk_size) {
+      n = chunk_size;
+    }
+  }
+
+  __device__ scalar_t* slot(int d) const {
+    return d < 0 ? nullptr : data[d];
+  }
+
+  scalar_t* data[depth];
+  int64_t n;
+};
+
+// Loads an optional state buffer into `value` and returns its address, or
+// null if the buffer isn't used.
+template <typename scalar_t, typename accscalar_t>
+__device__ inline accscalar_t* load_optional(scalar_t* ptr, int64_t i, accscalar_t& value) {
+  if (!ptr) {
+    return nullptr;
+  }
+  value = static_cast<accscalar_t>(ptr[i]);
+  return &value;
+}
+
+template <int depth, typename scalar_t>
+struct SGDFunctor {
+  using accscalar_t = acc_type<scalar_t, true>;
+
+  __device__ void operator()(
+      int64_t chunk_size, TensorListMetadata<depth>& tl, accscalar_t lr,
+      accscalar_t momentum, accscalar_t dampening, accscalar_t weight_decay,
+      bool nesterov) {
+    Chunk<depth, scalar_t> chunk(chunk_size, tl);
+    scalar_t* buf = chunk.slot(depth == 3 ? 2 : -1);
+    for (int64_t i = threadIdx.x; i < chunk.n; i += blockDim.x) {
+      accscalar_t param = static_cast<accscalar_t>(chunk.data[0][i]);
+      accscalar_t buf_value;
+      accscalar_t* buf_ptr = load_optional(buf, i, buf_value);
+      detail::sgd_update<accscalar_t>(
+          param, static_cast<accscalar_t>(chunk.data[1][i]), buf_ptr, lr,
+          momentum, dampening, weight_decay, nesterov);
+      chunk.data[0][i] = static_cast<scalar_t>(param);
+      if (buf_ptr) {
+        buf[i] = static_cast<scalar_t>(buf_value);
+      }
+    }
+  }
+};
+
+template <int depth, typename scalar_t>
+struct AdamFunctor {
+  using accscalar_t = acc_type<scalar_t, true>;
+
+  __device__ void operator()(
+      int64_t chunk_size, TensorListMetadata<depth>& tl, accscalar_t step_size,
+      accscalar_t beta1, accscalar_t beta2, accscalar_t eps,
+      accscalar_t weight_decay) {
+    Chunk<depth, scalar_t> chunk(chunk_size, tl);
+    scalar_t* max_exp_avg_sq = chunk.slot(depth == 5 ? 4 : -1);
+    for (int64_t i = threadIdx.x; i < chunk.n; i += blockDim.x) {
+      accscalar_t param = static_cast<accscalar_t>(chunk.data[0][i]);
+      accscalar_t exp_avg = static_cast<accscalar_t>(chunk.data[2][i]);
+      accscalar_t exp_avg_sq = static_cast<accscalar_t>(chunk.data[3][i]);
+      accscalar_t max_value;
+      accscalar_t* max_ptr = load_optional(max_exp_avg_sq, i, max_value);
+      detail::adam_update<accscalar_t>(
+          param, static_cast<accscalar_t>(chunk.data[1][i]), exp_avg,
+          exp_avg_sq, max_ptr, step_size, beta1, beta2, eps, weight_decay);
+      chunk.data[0][i] = static_cast<scalar_t>(param);
+      chunk.data[2][i] = static_cast<scalar_t>(exp_avg);
+      chunk.data[3][i] = static_cast<scalar_t>(exp_avg_sq);
+      if (max_ptr) {
+        max_exp_avg_sq[i] = static_cast<scalar_t>(max_value);
+      }
+    }
+  }
+};
+
+// `buf_slot` and `grad_avg_slot` are the lists of the momentum buffers and
+// of the average gradients, or -1 if they aren't used.
+template <int depth, typename scalar_t>
+struct RMSpropFunctor {
+  using accscalar_t = acc_type<scalar_t, true>;
+
+  __device__ void operator()(
+      int64_t chunk_size, TensorListMetadata<depth>& tl, int buf_slot,
+      int grad_avg_slot, accscalar_t lr, accscalar_t alpha, accscalar_t eps,
+      accscalar_t weight_decay, accscalar_t momentum) {
+    Chunk<depth, scalar_t> chunk(chunk_size, tl);
+    scalar_t* buf = chunk.slot(buf_slot);
+    scalar_t* grad_avg = chunk.slot(grad_avg_slot);
+    for (int64_t i = threadIdx.x; i < chunk.n; i += blockDim.x) {
+      accscalar_t param = static_cast<accscalar_t>(chunk.data[0][i]);
+      accscalar_t square_avg = static_cast<accscalar_t>(chunk.data[2][i]);
+      accscalar_t buf_value, grad_avg_value;
+      accscalar_t* buf_ptr = load_optional(buf, i, buf_value);
+      accscalar_t* grad_avg_ptr = load_optional(grad_avg, i, grad_avg_value);
+      detail::rmsprop_update<accscalar_t>(
+          param, static_cast<accscalar_t>(chunk.data[1][i]), square_avg,
+          buf_ptr, grad_avg_ptr, lr, alpha, eps, weight_decay, momentum);
+      chunk.data[0][i] = static_cast<scalar_t>(param);
+      chunk.data[2][i] = static_cast<scalar_t>(square_avg);
+      if (buf_ptr) {
+        buf[i] = static_cast<scalar_t>(buf_value);
+      }
+      if (grad_avg_ptr) {
+        grad_avg[i] = static_cast<scalar_t>(grad_avg_value);
+      }
+    }
+  }
+};
+
+std::vector<std::vector<Tensor>> make_tensor_lists(std::initializer_list<TensorList> lists) {
+  std::vector<std::vector<Tensor>> tensor_lists;
+  for (const auto& list : lists) {
+    if (!list.empty()) {
+      tensor_lists.emplace_back(list.begin(), list.end());
+    }
+  }
+  return tensor_lists;
+}
+
+void fused_sgd_kernel_cuda(
+    TensorList params, TensorList grads, TensorList momentum_buffers,
+    double lr, double momentum, double dampening, double weight_decay,
+    bool nesterov) {
+  auto tensor_lists = make_tensor_lists({params, grads, momentum_buffers});
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(params[0].type(), "fused_sgd_cuda", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    if (tensor_lists.size() == 3) {
+      multi_tensor_apply<3>(
+          tensor_lists, SGDFunctor<3, scalar_t>(), (accscalar_t)lr,
+          (accscalar_t)momentum, (accscalar_t)dampening,
+          (accscalar_t)weight_decay, nesterov);
+    } else {
+      multi_tensor_apply<2>(
+          tensor_lists, SGDFunctor<2, scalar_t>(), (accscalar_t)lr,
+          (accscalar_t)momentum, (accscalar_t)dampening,
+          (accscalar_t)weight_decay, nesterov);
+    }
+  });
+}
+
+void fused_adam_kernel_cuda(
+    TensorList params, TensorList grads, TensorList exp_avgs,
+    TensorList exp_avg_sqs, TensorList max_exp_avg_sqs, double step_size,
+    double beta1, double beta2, double eps, double weight_decay, bool amsgrad) {
+  auto tensor_lists = make_tensor_lists({params, grads, exp_avgs, exp_avg_sqs, max_exp_avg_sqs});
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(params[0].type(), "fused_adam_cuda", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    if (amsgrad) {
+      multi_tensor_apply<5>(
+          tensor_lists, AdamFunctor<5, scalar_t>(), (accscalar_t)step_size,
+          (accscalar_t)beta1, (accscalar_t)beta2, (accscalar_t)eps,
+          (accscalar_t)weight_decay);
+    } else {
+      multi_tensor_apply<4>(
+          tensor_lists, AdamFunctor<4, scalar_t>(), (accscalar_t)step_size,
+          (accscalar_t)beta1, (accscalar_t)beta2, (accscalar_t)eps,
+          (accscalar_t)weight_decay);
+    }
+  });
+}
+
+void fused_rmsprop_kernel_cuda(
+    TensorList params, TensorList grads, TensorList square_avgs,
+    TensorList momentum_buffers, TensorList grad_avgs, double lr, double alpha,
+    double eps, double weight_decay, double momentum, bool centered) {
+  auto tensor_lists = make_tensor_lists({params, grads, square_avgs, momentum_buffers, grad_avgs});
+  const int buf_slot = momentum_buffers.empty() ? -1 : 3;
+  const int grad_avg_slot = centered ? (momentum_buffers.empty() ? 3 : 4) : -1;
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(params[0].type(), "fused_rmsprop_cuda", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    switch (tensor_lists.size()) {
+      case 5:
+        multi_tensor_apply<5>(
+            tensor_lists, RMSpropFunctor<5, scalar_t>(), buf_slot,
+            grad_avg_slot, (accscalar_t)lr, (accscalar_t)alpha,
+            (accscalar_t)eps, (accscalar_t)weight_decay, (accscalar_t)momentum);
+        break;
+      case 4:
+        multi_tensor_apply<4>(
+            tensor_lists, RMSpropFunctor<4, scalar_t>(), buf_slot,
+            grad_avg_slot, (accscalar_t)lr, (accscalar_t)alpha,
+            (accscalar_t)eps, (accscalar_t)weight_decay, (accscalar_t)momentum);
+        break;
+      default:
+        multi_tensor_apply<3>(
+            tensor_lists, RMSpropFunctor<3, scalar_t>(), buf_slot,
+            grad_avg_slot, (accscalar_t)lr, (accscalar_t)alpha,
+            (accscalar_t)eps, (accscalar_t)weight_decay, (accscalar_t)momentum);
+    }
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(fused_sgd_stub, &fused_sgd_kernel_cuda);
+REGISTER_DISPATCH(fused_adam_stub, &fused_adam_kernel_cuda);
+REGISTER_DISPATCH(fused_rmsprop_stub, &fused_rmsprop_kernel_cuda);
+
+}} // namespace at::native
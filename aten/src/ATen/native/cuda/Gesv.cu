@@ -2,11 +2,11 @@
 #include "ATen/cuda/CUDAContext.h"
 #include "ATen/Dispatch.h"
 #include "ATen/NativeFunctions.h"
-#include "ATen/cuda/PinnedMemoryAllocator.h"
 #include "ATen/cuda/CUDAApplyUtils.cuh"
 
 #include "ATen/native/LinearAlgebraUtils.h"
 #include "ATen/native/Gesv.h"
+#include "ATen/native/cuda/MagmaUtils.h"
 
 #include "THC.h" // for USE_MAGMA
 
@@ -46,45 +46,10 @@ void magmaGesvBatched<double>(
       n, nrhs, dA_array, ldda, dipiv_array,
       dB_array, lddb, dinfo_array, batch_count, queue);
 }
-
-static magma_queue_t createMagmaQueue(const Tensor& tensor) {
-  auto& context = tensor.type().get_context();
-  magma_queue_t magma_queue;
-  magma_queue_create_from_cuda(
-      tensor.get_device(),
-      at::cuda::getCurrentCUDAStream(),
-      THCState_getCurrentBlasHandle(context.getTHCState()),
-      THCState_getCurrentSparseHandle(context.getTHCState()),
-      &magma_queue);
-  return magma_queue;
-}
-
-static inline magma_int_t magma_int_cast(int64_t value, const char* varname) {
-  auto result = static_cast<magma_int_t>(value);
-  if (static_cast<int64_t>(result) != value) {
-    AT_ERROR("magma: The value of %s (%lld) is too large to fit into a magma_int_t (%llu bytes)",
-             varname, (long long)value, sizeof(magma_int_t));
-  }
-  return result;
-}
 #endif
 
-// Creates an array of size elements of type T, backed by pinned memory
-// wrapped in a Storage
-template<class T>
-static inline std::unique_ptr<Storage> pin_memory(int64_t size, Tensor dummy) {
-  int64_t adjusted_size = size * sizeof(T);
-  auto* allocator = cuda::getPinnedMemoryAllocator();
-  auto& backend = dummy.type().toBackend(Backend::CPU).toScalarType(kByte);
-  return backend.storageWithAllocator(adjusted_size, allocator);
-}
-
-#define ALLOCATE_ARRAY(name, type, size, dummy_tensor) \
-  auto storage_##name = pin_memory<type>(size, dummy_tensor); \
-  name = reinterpret_cast<type*>(storage_##name->pImpl()->data());
-
 template <typename scalar_t>
-static void applyGesv(Tensor& b, Tensor& A, std::vector<int64_t> infos) {
+static void applyGesv(Tensor& b, Tensor& A, std::vector<int64_t>& infos) {
 #ifndef USE_MAGMA
 AT_ERROR("gesv: MAGMA library not found in "
     "compilation. Please rebuild with MAGMA.");
@@ -140,4 +105,3 @@ std::tuple<Tensor,Tensor> _gesv_helper_cuda(const Tensor& self, const Tensor& A)
 
 }}  // namespace at::native
 
-#undef ALLOCATE_ARRAY
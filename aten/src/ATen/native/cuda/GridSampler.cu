@@ -2,7 +2,6 @@
 #include "ATen/native/GridSampler.h"
 #include "ATen/cuda/CUDAContext.h"
 #include "ATen/cuda/CUDAApplyUtils.cuh"
-#include "ATen/cuda/detail/TensorInfo.cuh"
 #include "ATen/cuda/detail/IndexUtils.cuh"
 #include "ATen/cuda/detail/KernelUtils.h"
 
@@ -98,63 +97,63 @@ namespace {
     return d >= 0 && d < D && h >= 0 && h < H && w >= 0 && w < W;
   }
 
-  template<typename scalar_t>
+  template<typename scalar_t, typename index_t>
   static __forceinline__ __device__
   void safe_add_2d(scalar_t *data, int h, int w,
-                   int sH, int sW, int H, int W,
+                   index_t sH, index_t sW, int H, int W,
                    scalar_t delta) {
     if (within_bounds_2d(h, w, H, W)) {
       atomicAdd(data + h * sH + w * sW, delta);
     }
   }
 
-  template<typename scalar_t>
+  template<typename scalar_t, typename index_t>
   static __forceinline__ __device__
   void safe_add_3d(scalar_t *data, int d, int h, int w,
-                   int sD, int sH, int sW, int D, int H, int W,
+                   index_t sD, index_t sH, index_t sW, int D, int H, int W,
                    scalar_t delta) {
     if (within_bounds_3d(d, h, w, D, H, W)) {
       atomicAdd(data + d * sD + h * sH + w * sW, delta);
     }
   }
 
-  template <typename scalar_t>
+  template <typename scalar_t, typename index_t>
   __launch_bounds__(1024)
   __global__ void grid_sampler_2d_kernel(
-      const int nthreads,
-      TensorInfo<scalar_t, int> input,
-      TensorInfo<scalar_t, int> grid,
-      TensorInfo<scalar_t, int> output,
+      const index_t nthreads,
+      PackedTensorAccessor<scalar_t, 4, index_t> input,
+      PackedTensorAccessor<scalar_t, 4, index_t> grid,
+      PackedTensorAccessor<scalar_t, 4, index_t> output,
       const GridSamplerInterpolation interpolation_mode,
       const GridSamplerPadding padding_mode) {
 
-    int C = input.sizes[1];
-    int inp_H = input.sizes[2];
-    int inp_W = input.sizes[3];
-    int out_H = grid.sizes[1];
-    int out_W = grid.sizes[2];
-    int inp_sN = input.strides[0];
-    int inp_sC = input.strides[1];
-    int inp_sH = input.strides[2];
-    int inp_sW = input.strides[3];
-    int grid_sN = grid.strides[0];
-    int grid_sH = grid.strides[1];
-    int grid_sW = grid.strides[2];
-    int grid_sCoor = grid.strides[3];
-    int out_sN = output.strides[0];
-    int out_sC = output.strides[1];
-    int out_sH = output.strides[2];
-    int out_sW = output.strides[3];
-
-    CUDA_KERNEL_LOOP(index, nthreads) {
-      const int w = index % out_W;
-      const int h = (index / out_W) % out_H;
-      const int n = index / (out_H * out_W);
-      const int grid_offset = n * grid_sN + h * grid_sH + w * grid_sW;
+    index_t C = input.size(1);
+    int inp_H = input.size(2);
+    int inp_W = input.size(3);
+    index_t out_H = grid.size(1);
+    index_t out_W = grid.size(2);
+    index_t inp_sN = input.stride(0);
+    index_t inp_sC = input.stride(1);
+    index_t inp_sH = input.stride(2);
+    index_t inp_sW = input.stride(3);
+    index_t grid_sN = grid.stride(0);
+    index_t grid_sH = grid.stride(1);
+    index_t grid_sW = grid.stride(2);
+    index_t grid_sCoor = grid.stride(3);
+    index_t out_sN = output.stride(0);
+    index_t out_sC = output.stride(1);
+    index_t out_sH = output.stride(2);
+    index_t out_sW = output.stride(3);
+
+    CUDA_KERNEL_LOOP_TYPE(index, nthreads, index_t) {
+      const index_t w = index % out_W;
+      const index_t h = (index / out_W) % out_H;
+      const index_t n = index / (out_H * out_W);
+      const index_t grid_offset = n * grid_sN + h * grid_sH + w * grid_sW;
 
       // get the corresponding input x, y co-ordinates from grid
-      scalar_t ix = grid.data[grid_offset];
-      scalar_t iy = grid.data[grid_offset + grid_sCoor];
+      scalar_t ix = grid.data()[grid_offset];
+      scalar_t iy = grid.data()[grid_offset + grid_sCoor];
 
       // normalize ix, iy from [-1, 1] to [0, IH-1] & [0, IW-1]
       float ixf = ((ix + 1.f) / 2) * (inp_W - 1);
@@ -190,32 +189,46 @@ namespace {
         scalar_t sw = (ix_ne - ix)    * (iy    - iy_ne);
         scalar_t se = (ix    - ix_nw) * (iy    - iy_nw);
 
+        // The corners, their weights and whether they are inside the input
+        // are the same for every channel, so they are worked out once per
+        // thread; the loop over the channels only loads and accumulates, and
+        // writes each output once.
+        const bool nw_in = within_bounds_2d(iy_nw, ix_nw, inp_H, inp_W);
+        const bool ne_in = within_bounds_2d(iy_ne, ix_ne, inp_H, inp_W);
+        const bool sw_in = within_bounds_2d(iy_sw, ix_sw, inp_H, inp_W);
+        const bool se_in = within_bounds_2d(iy_se, ix_se, inp_H, inp_W);
+        const index_t nw_offset = iy_nw * inp_sH + ix_nw * inp_sW;
+        const index_t ne_offset = iy_ne * inp_sH + ix_ne * inp_sW;
+        const index_t sw_offset = iy_sw * inp_sH + ix_sw * inp_sW;
+        const index_t se_offset = iy_se * inp_sH + ix_se * inp_sW;
+
         // calculate bilinear weighted pixel value and set output pixel
-        auto inp_ptr_NC = input.data + n * inp_sN;
-        auto out_ptr_NCHW = output.data + n * out_sN + h * out_sH + w * out_sW;
-        for (int c = 0; c < C; ++c, inp_ptr_NC += inp_sC, out_ptr_NCHW += out_sC) {
-          *out_ptr_NCHW = static_cast<scalar_t>(0);
-          if (within_bounds_2d(iy_nw, ix_nw, inp_H, inp_W)) {
-            *out_ptr_NCHW += inp_ptr_NC[iy_nw * inp_sH + ix_nw * inp_sW] * nw;
+        auto inp_ptr_NC = input.data() + n * inp_sN;
+        auto out_ptr_NCHW = output.data() + n * out_sN + h * out_sH + w * out_sW;
+        for (index_t c = 0; c < C; ++c, inp_ptr_NC += inp_sC, out_ptr_NCHW += out_sC) {
+          scalar_t out = static_cast<scalar_t>(0);
+          if (nw_in) {
+            out += inp_ptr_NC[nw_offset] * nw;
           }
-          if (within_bounds_2d(iy_ne, ix_ne, inp_H, inp_W)) {
-            *out_ptr_NCHW += inp_ptr_NC[iy_ne * inp_sH + ix_ne * inp_sW] * ne;
+          if (ne_in) {
+            out += inp_ptr_NC[ne_offset] * ne;
           }
-          if (within_bounds_2d(iy_sw, ix_sw, inp_H, inp_W)) {
-            *out_ptr_NCHW += inp_ptr_NC[iy_sw * inp_sH + ix_sw * inp_sW] * sw;
+          if (sw_in) {
+            out += inp_ptr_NC[sw_offset] * sw;
           }
-          if (within_bounds_2d(iy_se, ix_se, inp_H, inp_W)) {
-            *out_ptr_NCHW += inp_ptr_NC[iy_se * inp_sH + ix_se * inp_sW] * se;
+          if (se_in) {
+            out += inp_ptr_NC[se_offset] * se;
           }
+          *out_ptr_NCHW = out;
         }
       } else if (interpolation_mode == GridSamplerInterpolation::Nearest) {
         int ix_nearest = static_cast<int>(::round(ixf));
         int iy_nearest = static_cast<int>(::round(iyf));
 
         // assign nearest neighor pixel value to output pixel
-        auto inp_ptr_NC = input.data + n * inp_sN;
-        auto out_ptr_NCHW = output.data + n * out_sN + h * out_sH + w * out_sW;
-        for (int c = 0; c < C; ++c, inp_ptr_NC += inp_sC, out_ptr_NCHW += out_sC) {
+        auto inp_ptr_NC = input.data() + n * inp_sN;
+        auto out_ptr_NCHW = output.data() + n * out_sN + h * out_sH + w * out_sW;
+        for (index_t c = 0; c < C; ++c, inp_ptr_NC += inp_sC, out_ptr_NCHW += out_sC) {
           if (within_bounds_2d(iy_nearest, ix_nearest, inp_H, inp_W)) {
             *out_ptr_NCHW = inp_ptr_NC[iy_nearest * inp_sH + ix_nearest * inp_sW];
           } else {
@@ -226,50 +239,50 @@ namespace {
     }
   }
 
-  template <typename scalar_t>
+  template <typename scalar_t, typename index_t>
   __launch_bounds__(1024)
   __global__ void grid_sampler_3d_kernel(
-      const int nthreads,
-      TensorInfo<scalar_t, int> input,
-      TensorInfo<scalar_t, int> grid,
-      TensorInfo<scalar_t, int> output,
+      const index_t nthreads,
+      PackedTensorAccessor<scalar_t, 5, index_t> input,
+      PackedTensorAccessor<scalar_t, 5, index_t> grid,
+      PackedTensorAccessor<scalar_t, 5, index_t> output,
       const GridSamplerInterpolation interpolation_mode,
       const GridSamplerPadding padding_mode) {
 
-    int C = input.sizes[1];
-    int inp_D = input.sizes[2];
-    int inp_H = input.sizes[3];
-    int inp_W = input.sizes[4];
-    int out_D = grid.sizes[1];
-    int out_H = grid.sizes[2];
-    int out_W = grid.sizes[3];
-    int inp_sN = input.strides[0];
-    int inp_sC = input.strides[1];
-    int inp_sD = input.strides[2];
-    int inp_sH = input.strides[3];
-    int inp_sW = input.strides[4];
-    int grid_sN = grid.strides[0];
-    int grid_sD = grid.strides[1];
-    int grid_sH = grid.strides[2];
-    int grid_sW = grid.strides[3];
-    int grid_sCoor = grid.strides[4];
-    int out_sN = output.strides[0];
-    int out_sC = output.strides[1];
-    int out_sD = output.strides[2];
-    int out_sH = output.strides[3];
-    int out_sW = output.strides[4];
-
-    CUDA_KERNEL_LOOP(index, nthreads) {
-      const int w = index % out_W;
-      const int h = (index / out_W) % out_H;
-      const int d = (index / (out_H * out_W)) % out_D;
-      const int n = index / (out_D * out_H * out_W);
-      const int grid_offset = n * grid_sN + d * grid_sD + h * grid_sH + w * grid_sW;
+    index_t C = input.size(1);
+    int inp_D = input.size(2);
+    int inp_H = input.size(3);
+    int inp_W = input.size(4);
+    index_t out_D = grid.size(1);
+    index_t out_H = grid.size(2);
+    index_t out_W = grid.size(3);
+    index_t inp_sN = input.stride(0);
+    index_t inp_sC = input.stride(1);
+    index_t inp_sD = input.stride(2);
+    index_t inp_sH = input.stride(3);
+    index_t inp_sW = input.stride(4);
+    index_t grid_sN = grid.stride(0);
+    index_t grid_sD = grid.stride(1);
+    index_t grid_sH = grid.stride(2);
+    index_t grid_sW = grid.stride(3);
+    index_t grid_sCoor = grid.stride(4);
+    index_t out_sN = output.stride(0);
+    index_t out_sC = output.stride(1);
+    index_t out_sD = output.stride(2);
+    index_t out_sH = output.stride(3);
+    index_t out_sW = output.stride(4);
+
+    CUDA_KERNEL_LOOP_TYPE(index, nthreads, index_t) {
+      const index_t w = index % out_W;
+      const index_t h = (index / out_W) % out_H;
+      const index_t d = (index / (out_H * out_W)) % out_D;
+      const index_t n = index / (out_D * out_H * out_W);
+      const index_t grid_offset = n * grid_sN + d * grid_sD + h * grid_sH + w * grid_sW;
 
       // get the corresponding input x, y, z co-ordinates from grid
-      scalar_t ix = grid.data[grid_offset];
-      scalar_t iy = grid.data[grid_offset + grid_sCoor];
-      scalar_t iz = grid.data[grid_offset + 2 * grid_sCoor];
+      scalar_t ix = grid.data()[grid_offset];
+      scalar_t iy = grid.data()[grid_offset + grid_sCoor];
+      scalar_t iz = grid.data()[grid_offset + 2 * grid_sCoor];
 
       // normalize ix, iy, iz from [-1, 1] to [0, inp_W-1] & [0, inp_H-1] & [0, inp_D-1]
       float ixf = ((ix + 1.f) / 2) * (inp_W - 1);
@@ -338,9 +351,9 @@ namespace {
         scalar_t bsw = (ix_tne - ix)    * (iy    - iy_tne) * (iz - iz_tne);
         scalar_t bse = (ix    - ix_tnw) * (iy    - iy_tnw) * (iz - iz_tnw);
 
-        auto inp_ptr_NC = input.data + n * inp_sN;
-        auto out_ptr_NCDHW = output.data + n * out_sN + d * out_sD + h * out_sH + w * out_sW;
-        for (int c = 0; c < C; ++c, inp_ptr_NC += inp_sC, out_ptr_NCDHW += out_sC) {
+        auto inp_ptr_NC = input.data() + n * inp_sN;
+        auto out_ptr_NCDHW = output.data() + n * out_sN + d * out_sD + h * out_sH + w * out_sW;
+        for (index_t c = 0; c < C; ++c, inp_ptr_NC += inp_sC, out_ptr_NCDHW += out_sC) {
           //   (c, iz_tnw, iy_tnw, ix_tnw) * tnw + (c, iz_tne, iy_tne, ix_tne) * tne
           // + (c, iz_tsw, iy_tsw, ix_tsw) * tsw + (c, iz_tse, iy_tse, ix_tse) * tse
           // + (c, iz_bnw, iy_bnw, ix_bnw) * bnw + (c, iz_bne, iy_bne, ix_bne) * bne
@@ -377,9 +390,9 @@ namespace {
         int iz_nearest = static_cast<int>(::round(izf));
 
         // assign nearest neighor pixel value to output pixel
-        auto inp_ptr_NC = input.data + n * inp_sN;
-        auto out_ptr_NCDHW = output.data + n * out_sN + d * out_sD + h * out_sH + w * out_sW;
-        for (int c = 0; c < C; ++c, inp_ptr_NC += inp_sC, out_ptr_NCDHW += out_sC) {
+        auto inp_ptr_NC = input.data() + n * inp_sN;
+        auto out_ptr_NCDHW = output.data() + n * out_sN + d * out_sD + h * out_sH + w * out_sW;
+        for (index_t c = 0; c < C; ++c, inp_ptr_NC += inp_sC, out_ptr_NCDHW += out_sC) {
           if (within_bounds_3d(iz_nearest, iy_nearest, ix_nearest, inp_D, inp_H, inp_W)) {
             *out_ptr_NCDHW = inp_ptr_NC[iz_nearest * inp_sD + iy_nearest * inp_sH + ix_nearest * inp_sW];
           } else {
@@ -390,50 +403,50 @@ namespace {
     }
   }
 
-  template <typename scalar_t>
+  template <typename scalar_t, typename index_t>
   __launch_bounds__(1024)
   __global__ void grid_sampler_2d_backward_kernel(
-      const int nthreads,
-      TensorInfo<scalar_t, int> grad_output,
-      TensorInfo<scalar_t, int> input,
-      TensorInfo<scalar_t, int> grid,
-      TensorInfo<scalar_t, int> grad_input,  // initialized to zeros
-      TensorInfo<scalar_t, int> grad_grid,   // initialized to empty
+      const index_t nthreads,
+      PackedTensorAccessor<scalar_t, 4, index_t> grad_output,
+      PackedTensorAccessor<scalar_t, 4, index_t> input,
+      PackedTensorAccessor<scalar_t, 4, index_t> grid,
+      PackedTensorAccessor<scalar_t, 4, index_t> grad_input,  // initialized to zeros
+      PackedTensorAccessor<scalar_t, 4, index_t> grad_grid,   // initialized to empty
       const GridSamplerInterpolation interpolation_mode,
       const GridSamplerPadding padding_mode) {
 
-    int C = input.sizes[1];
-    int inp_H = input.sizes[2];
-    int inp_W = input.sizes[3];
-    int out_H = grid.sizes[1];
-    int out_W = grid.sizes[2];
-    int inp_sN = input.strides[0];
-    int inp_sC = input.strides[1];
-    int inp_sH = input.strides[2];
-    int inp_sW = input.strides[3];
-    int grid_sN = grid.strides[0];
-    int grid_sH = grid.strides[1];
-    int grid_sW = grid.strides[2];
-    int grid_sCoor = grid.strides[3];
-    int gOut_sN = grad_output.strides[0];
-    int gOut_sC = grad_output.strides[1];
-    int gOut_sH = grad_output.strides[2];
-    int gOut_sW = grad_output.strides[3];
-    int gInp_sN = grad_input.strides[0];
-    int gInp_sC = grad_input.strides[1];
-    int gInp_sH = grad_input.strides[2];
-    int gInp_sW = grad_input.strides[3];
-    int gGrid_sW = grad_grid.strides[2];
-
-    CUDA_KERNEL_LOOP(index, nthreads) {
-      const int w = index % out_W;
-      const int h = (index / out_W) % out_H;
-      const int n = index / (out_H * out_W);
-      const int grid_offset = n * grid_sN + h * grid_sH + w * grid_sW;
+    index_t C = input.size(1);
+    int inp_H = input.size(2);
+    int inp_W = input.size(3);
+    index_t out_H = grid.size(1);
+    index_t out_W = grid.size(2);
+    index_t inp_sN = input.stride(0);
+    index_t inp_sC = input.stride(1);
+    index_t inp_sH = input.stride(2);
+    index_t inp_sW = input.stride(3);
+    index_t grid_sN = grid.stride(0);
+    index_t grid_sH = grid.stride(1);
+    index_t grid_sW = grid.stride(2);
+    index_t grid_sCoor = grid.stride(3);
+    index_t gOut_sN = grad_output.stride(0);
+    index_t gOut_sC = grad_output.stride(1);
+    index_t gOut_sH = grad_output.stride(2);
+    index_t gOut_sW = grad_output.stride(3);
+    index_t gInp_sN = grad_input.stride(0);
+    index_t gInp_sC = grad_input.stride(1);
+    index_t gInp_sH = grad_input.stride(2);
+    index_t gInp_sW = grad_input.stride(3);
+    index_t gGrid_sW = grad_grid.stride(2);
+
+    CUDA_KERNEL_LOOP_TYPE(index, nthreads, index_t) {
+      const index_t w = index % out_W;
+      const index_t h = (index / out_W) % out_H;
+      const index_t n = index / (out_H * out_W);
+      const index_t grid_offset = n * grid_sN + h * grid_sH + w * grid_sW;
 
       // get the corresponding input x, y co-ordinates from grid
-      scalar_t ix = grid.data[grid_offset];
-      scalar_t iy = grid.data[grid_offset + grid_sCoor];
+      scalar_t ix = grid.data()[grid_offset];
+      scalar_t iy = grid.data()[grid_offset + grid_sCoor];
 
       // normalize ix, iy from [-1, 1] to [0, IH-1] & [0, IW-1]
       float ixf = ((ix + 1.f) / 2) * (inp_W - 1);
@@ -475,39 +488,56 @@ namespace {
         scalar_t sw = (ix_ne - ix)    * (iy    - iy_ne);
         scalar_t se = (ix    - ix_nw) * (iy    - iy_nw);
 
+        // Like in the forward kernel, the bounds checks, offsets and the
+        // factors of the grad_grid terms are worked out once for all channels.
+        const bool nw_in = within_bounds_2d(iy_nw, ix_nw, inp_H, inp_W);
+        const bool ne_in = within_bounds_2d(iy_ne, ix_ne, inp_H, inp_W);
+        const bool sw_in = within_bounds_2d(iy_sw, ix_sw, inp_H, inp_W);
+        const bool se_in = within_bounds_2d(iy_se, ix_se, inp_H, inp_W);
+        const index_t nw_offset = iy_nw * inp_sH + ix_nw * inp_sW;
+        const index_t ne_offset = iy_ne * inp_sH + ix_ne * inp_sW;
+        const index_t sw_offset = iy_sw * inp_sH + ix_sw * inp_sW;
+        const index_t se_offset = iy_se * inp_sH + ix_se * inp_sW;
+        const index_t nw_gInp_offset = iy_nw * gInp_sH + ix_nw * gInp_sW;
+        const index_t ne_gInp_offset = iy_ne * gInp_sH + ix_ne * gInp_sW;
+        const index_t sw_gInp_offset = iy_sw * gInp_sH + ix_sw * gInp_sW;
+        const index_t se_gInp_offset = iy_se * gInp_sH + ix_se * gInp_sW;
+        const auto wx0 = ix_se - ix;
+        const auto wx1 = ix - ix_nw;
+        const auto wy0 = iy_se - iy;
+        const auto wy1 = iy - iy_nw;
+
         scalar_t gix = static_cast<scalar_t>(0), giy = static_cast<scalar_t>(0);
-        scalar_t *gOut_ptr_NCHW = grad_output.data + n * gOut_sN + h * gOut_sH + w * gOut_sW;
-        scalar_t *gInp_ptr_NC = grad_input.data + n * gInp_sN;
-        scalar_t *inp_ptr_NC = input.data + n * inp_sN;
-        for (int c = 0; c < C; ++c, inp_ptr_NC += inp_sC, gInp_ptr_NC += gInp_sC, gOut_ptr_NCHW += gOut_sC) {
+        scalar_t *gOut_ptr_NCHW = grad_output.data() + n * gOut_sN + h * gOut_sH + w * gOut_sW;
+        scalar_t *gInp_ptr_NC = grad_input.data() + n * gInp_sN;
+        scalar_t *inp_ptr_NC = input.data() + n * inp_sN;
+        for (index_t c = 0; c < C; ++c, inp_ptr_NC += inp_sC, gInp_ptr_NC += gInp_sC, gOut_ptr_NCHW += gOut_sC) {
           scalar_t gOut = *gOut_ptr_NCHW;
 
-          // calculate and set grad_input
-          safe_add_2d(gInp_ptr_NC, iy_nw, ix_nw, gInp_sH, gInp_sW, inp_H, inp_W, nw * gOut);
-          safe_add_2d(gInp_ptr_NC, iy_ne, ix_ne, gInp_sH, gInp_sW, inp_H, inp_W, ne * gOut);
-          safe_add_2d(gInp_ptr_NC, iy_sw, ix_sw, gInp_sH, gInp_sW, inp_H, inp_W, sw * gOut);
-          safe_add_2d(gInp_ptr_NC, iy_se, ix_se, gInp_sH, gInp_sW, inp_H, inp_W, se * gOut);
-
-          // calculate grad_grid
-          if (within_bounds_2d(iy_nw, ix_nw, inp_H, inp_W)) {
-            scalar_t nw_val = inp_ptr_NC[iy_nw * inp_sH + ix_nw * inp_sW];
-            gix -= nw_val * (iy_se - iy) * gOut;
-            giy -= nw_val * (ix_se - ix) * gOut;
+          // calculate and set grad_input, and calculate grad_grid
+          if (nw_in) {
+            atomicAdd(gInp_ptr_NC + nw_gInp_offset, nw * gOut);
+            scalar_t nw_val = inp_ptr_NC[nw_offset];
+            gix -= nw_val * wy0 * gOut;
+            giy -= nw_val * wx0 * gOut;
           }
-          if (within_bounds_2d(iy_ne, ix_ne, inp_H, inp_W)) {
-            scalar_t ne_val = inp_ptr_NC[iy_ne * inp_sH + ix_ne * inp_sW];
-            gix += ne_val * (iy_sw - iy) * gOut;
-            giy -= ne_val * (ix - ix_sw) * gOut;
+          if (ne_in) {
+            atomicAdd(gInp_ptr_NC + ne_gInp_offset, ne * gOut);
+            scalar_t ne_val = inp_ptr_NC[ne_offset];
+            gix += ne_val * wy0 * gOut;
+            giy -= ne_val * wx1 * gOut;
           }
-          if (within_bounds_2d(iy_sw, ix_sw, inp_H, inp_W)) {
-            scalar_t sw_val = inp_ptr_NC[iy_sw * inp_sH + ix_sw * inp_sW];
-            gix -= sw_val * (iy - iy_ne) * gOut;
-            giy += sw_val * (ix_ne - ix) * gOut;
+          if (sw_in) {
+            atomicAdd(gInp_ptr_NC + sw_gInp_offset, sw * gOut);
+            scalar_t sw_val = inp_ptr_NC[sw_offset];
+            gix -= sw_val * wy1 * gOut;
+            giy += sw_val * wx0 * gOut;
           }
-          if (within_bounds_2d(iy_se, ix_se, inp_H, inp_W)) {
-            scalar_t se_val = inp_ptr_NC[iy_se * inp_sH + ix_se * inp_sW];
-            gix += se_val * (iy - iy_nw) * gOut;
-            giy += se_val * (ix - ix_nw) * gOut;
+          if (se_in) {
+            atomicAdd(gInp_ptr_NC + se_gInp_offset, se * gOut);
+            scalar_t se_val = inp_ptr_NC[se_offset];
+            gix += se_val * wy1 * gOut;
+            giy += se_val * wx1 * gOut;
           }
         }
 
@@ -519,7 +549,7 @@ namespace {
         // thus we can
         //   1. use index with gGrid_sW to diectly compute gGrid_ptr_NHW
         //   2. directly assign to gGrid_ptr_NHW[0], gGrid_ptr_NHW[1]
-        scalar_t *gGrid_ptr_NHW = grad_grid.data + index * gGrid_sW;
+        scalar_t *gGrid_ptr_NHW = grad_grid.data() + index * gGrid_sW;
         gGrid_ptr_NHW[0] = gix_mult * gix;
         gGrid_ptr_NHW[1] = giy_mult * giy;
       } else if (interpolation_mode == GridSamplerInterpolation::Nearest) {
@@ -527,9 +557,9 @@ namespace {
         int iy_nearest = static_cast<int>(::round(iyf));
 
         // assign nearest neighor pixel value to output pixel
-        scalar_t *gOut_ptr_NCHW = grad_output.data + n * gOut_sN + h * gOut_sH + w * gOut_sW;
-        scalar_t *gInp_ptr_NC = grad_input.data + n * gInp_sN;
-        for (int c = 0; c < C; ++c, gInp_ptr_NC += gInp_sC, gOut_ptr_NCHW += gOut_sC) {
+        scalar_t *gOut_ptr_NCHW = grad_output.data() + n * gOut_sN + h * gOut_sH + w * gOut_sW;
+        scalar_t *gInp_ptr_NC = grad_input.data() + n * gInp_sN;
+        for (index_t c = 0; c < C; ++c, gInp_ptr_NC += gInp_sC, gOut_ptr_NCHW += gOut_sC) {
           // calculate and set grad_input
           safe_add_2d(gInp_ptr_NC, iy_nearest, ix_nearest, gInp_sH, gInp_sW, inp_H, inp_W, *gOut_ptr_NCHW);
         }
@@ -538,65 +568,65 @@ namespace {
         // thus we can
         //   1. use index with gGrid_sW to diectly compute gGrid_ptr_NHW
         //   2. directly assign to gGrid_ptr_NHW[0], gGrid_ptr_NHW[1]
-        scalar_t *gGrid_ptr_NHW = grad_grid.data + index * gGrid_sW;
+        scalar_t *gGrid_ptr_NHW = grad_grid.data() + index * gGrid_sW;
         gGrid_ptr_NHW[0] = static_cast<scalar_t>(0);
         gGrid_ptr_NHW[1] = static_cast<scalar_t>(0);
       }
     }
   }
 
-  template <typename scalar_t>
+  template <typename scalar_t, typename index_t>
   __launch_bounds__(1024)
   __global__ void grid_sampler_3d_backward_kernel(
-      const int nthreads,
-      TensorInfo<scalar_t, int> grad_output,
-      TensorInfo<scalar_t, int> input,
-      TensorInfo<scalar_t, int> grid,
-      TensorInfo<scalar_t, int> grad_input,  // initialized to zeros
-      TensorInfo<scalar_t, int> grad_grid,   // initialized to empty
+      const index_t nthreads,
+      PackedTensorAccessor<scalar_t, 5, index_t> grad_output,
+      PackedTensorAccessor<scalar_t, 5, index_t> input,
+      PackedTensorAccessor<scalar_t, 5, index_t> grid,
+      PackedTensorAccessor<scalar_t, 5, index_t> grad_input,  // initialized to zeros
+      PackedTensorAccessor<scalar_t, 5, index_t> grad_grid,   // initialized to empty
       const GridSamplerInterpolation interpolation_mode,
       const GridSamplerPadding padding_mode) {
 
-    int C = input.sizes[1];
-    int inp_D = input.sizes[2];
-    int inp_H = input.sizes[3];
-    int inp_W = input.sizes[4];
-    int out_D = grid.sizes[1];
-    int out_H = grid.sizes[2];
-    int out_W = grid.sizes[3];
-    int inp_sN = input.strides[0];
-    int inp_sC = input.strides[1];
-    int inp_sD = input.strides[2];
-    int inp_sH = input.strides[3];
-    int inp_sW = input.strides[4];
-    int grid_sN = grid.strides[0];
-    int grid_sD = grid.strides[1];
-    int grid_sH = grid.strides[2];
-    int grid_sW = grid.strides[3];
-    int grid_sCoor = grid.strides[4];
-    int gOut_sN = grad_output.strides[0];
-    int gOut_sC = grad_output.strides[1];
-    int gOut_sD = grad_output.strides[2];
-    int gOut_sH = grad_output.strides[3];
-    int gOut_sW = grad_output.strides[4];
-    int gInp_sN = grad_input.strides[0];
-    int gInp_sC = grad_input.strides[1];
-    int gInp_sD = grad_input.strides[2];
-    int gInp_sH = grad_input.strides[3];
-    int gInp_sW = grad_input.strides[4];
-    int gGrid_sW = grad_grid.strides[3];
-
-    CUDA_KERNEL_LOOP(index, nthreads) {
-      const int w = index % out_W;
-      const int h = (index / out_W) % out_H;
-      const int d = (index / (out_H * out_W)) % out_D;
-      const int n = index / (out_D * out_H * out_W);
-      const int grid_offset = n * grid_sN + d * grid_sD + h * grid_sH + w * grid_sW;
+    index_t C = input.size(1);
+    int inp_D = input.size(2);
+    int inp_H = input.size(3);
+    int inp_W = input.size(4);
+    index_t out_D = grid.size(1);
+    index_t out_H = grid.size(2);
+    index_t out_W = grid.size(3);
+    index_t inp_sN = input.stride(0);
+    index_t inp_sC = input.stride(1);
+    index_t inp_sD = input.stride(2);
+    index_t inp_sH = input.stride(3);
+    index_t inp_sW = input.stride(4);
+    index_t grid_sN = grid.stride(0);
+    index_t grid_sD = grid.stride(1);
+    index_t grid_sH = grid.stride(2);
+    index_t grid_sW = grid.stride(3);
+    index_t grid_sCoor = grid.stride(4);
+    index_t gOut_sN = grad_output.stride(0);
+    index_t gOut_sC = grad_output.stride(1);
+    index_t gOut_sD = grad_output.stride(2);
+    index_t gOut_sH = grad_output.stride(3);
+    index_t gOut_sW = grad_output.stride(4);
+    index_t gInp_sN = grad_input.stride(0);
+    index_t gInp_sC = grad_input.stride(1);
+    index_t gInp_sD = grad_input.stride(2);
+    index_t gInp_sH = grad_input.stride(3);
+    index_t gInp_sW = grad_input.stride(4);
+    index_t gGrid_sW = grad_grid.stride(3);
+
+    CUDA_KERNEL_LOOP_TYPE(index, nthreads, index_t) {
+      const index_t w = index % out_W;
+      const index_t h = (index / out_W) % out_H;
+      const index_t d = (index / (out_H * out_W)) % out_D;
+      const index_t n = index / (out_D * out_H * out_W);
+      const index_t grid_offset = n * grid_sN + d * grid_sD + h * grid_sH + w * grid_sW;
 
       // get the corresponding input x, y, z co-ordinates from grid
-      scalar_t ix = grid.data[grid_offset];
-      scalar_t iy = grid.data[grid_offset + grid_sCoor];
-      scalar_t iz = grid.data[grid_offset + 2 * grid_sCoor];
+      scalar_t ix = grid.data()[grid_offset];
+      scalar_t iy = grid.data()[grid_offset + grid_sCoor];
+      scalar_t iz = grid.data()[grid_offset + 2 * grid_sCoor];
 
       // normalize ix, iy, iz from [-1, 1] to [0, inp_W-1] & [0, inp_H-1] & [0, inp_D-1]
       float ixf = ((ix + 1.f) / 2) * (inp_W - 1);
@@ -673,11 +703,11 @@ namespace {
         scalar_t bse = (ix    - ix_tnw) * (iy    - iy_tnw) * (iz - iz_tnw);
 
         scalar_t gix = static_cast<scalar_t>(0), giy = static_cast<scalar_t>(0), giz = static_cast<scalar_t>(0);
-        scalar_t *gOut_ptr_NCDHW = grad_output.data + n * gOut_sN + d * gOut_sD + h * gOut_sH + w * gOut_sW;
-        scalar_t *gInp_ptr_NC = grad_input.data + n * gInp_sN;
-        scalar_t *inp_ptr_NC = input.data + n * inp_sN;
+        scalar_t *gOut_ptr_NCDHW = grad_output.data() + n * gOut_sN + d * gOut_sD + h * gOut_sH + w * gOut_sW;
+        scalar_t *gInp_ptr_NC = grad_input.data() + n * gInp_sN;
+        scalar_t *inp_ptr_NC = input.data() + n * inp_sN;
         // calculate bilinear weighted pixel value and set output pixel
-        for (int c = 0; c < C; ++c, gOut_ptr_NCDHW += gOut_sC, gInp_ptr_NC += gInp_sC, inp_ptr_NC += inp_sC) {
+        for (index_t c = 0; c < C; ++c, gOut_ptr_NCDHW += gOut_sC, gInp_ptr_NC += gInp_sC, inp_ptr_NC += inp_sC) {
           scalar_t gOut = *gOut_ptr_NCDHW;
 
           // calculate and set grad_input
@@ -750,7 +780,7 @@ namespace {
         // thus we can
         //   1. use index with gGrid_sW to diectly compute gGrid_ptr_NDHW
         //   2. directly assign to gGrid_ptr_NDHW[0], gGrid_ptr_NDHW[1], gGrid_ptr_NDHW[2]
-        scalar_t *gGrid_ptr_NDHW = grad_grid.data + index * gGrid_sW;
+        scalar_t *gGrid_ptr_NDHW = grad_grid.data() + index * gGrid_sW;
         gGrid_ptr_NDHW[0] = gix_mult * gix;
         gGrid_ptr_NDHW[1] = giy_mult * giy;
         gGrid_ptr_NDHW[2] = giz_mult * giz;
@@ -760,9 +790,9 @@ namespace {
         int iz_nearest = static_cast<int>(::round(izf));
 
         // assign nearest neighor pixel value to output pixel
-        scalar_t *gOut_ptr_NCDHW = grad_output.data + n * gOut_sN + d * gOut_sD + h * gOut_sH + w * gOut_sW;
-        scalar_t *gInp_ptr_NC = grad_input.data + n * gInp_sN;
-        for (int c = 0; c < C; ++c, gOut_ptr_NCDHW += gOut_sC, gInp_ptr_NC += gInp_sC) {
+        scalar_t *gOut_ptr_NCDHW = grad_output.data() + n * gOut_sN + d * gOut_sD + h * gOut_sH + w * gOut_sW;
+        scalar_t *gInp_ptr_NC = grad_input.data() + n * gInp_sN;
+        for (index_t c = 0; c < C; ++c, gOut_ptr_NCDHW += gOut_sC, gInp_ptr_NC += gInp_sC) {
           // calculate and set grad_input
           safe_add_3d(gInp_ptr_NC, iz_nearest, iy_nearest, ix_nearest,
                       gInp_sD, gInp_sH, gInp_sW, inp_D, inp_H, inp_W, *gOut_ptr_NCDHW);
@@ -772,7 +802,7 @@ namespace {
         // thus we can
         //   1. use index with gGrid_sW to diectly compute gGrid_ptr_NDHW
         //   2. directly assign to gGrid_ptr_NDHW[0], gGrid_ptr_NDHW[1], gGrid_ptr_NDHW[2]
-        scalar_t *gGrid_ptr_NDHW = grad_grid.data + index * gGrid_sW;
+        scalar_t *gGrid_ptr_NDHW = grad_grid.data() + index * gGrid_sW;
         gGrid_ptr_NDHW[0] = static_cast<scalar_t>(0);
         gGrid_ptr_NDHW[1] = static_cast<scalar_t>(0);
         gGrid_ptr_NDHW[2] = static_cast<scalar_t>(0);
@@ -788,17 +818,22 @@ Tensor grid_sampler_2d_cuda(const Tensor& input, const Tensor& grid,
   auto H = grid.size(1);
   auto W = grid.size(2);
   auto output = at::empty({N, input.size(1), H, W}, input.options());
-  int count = static_cast<int>(N * H * W);
+  int64_t count = N * H * W;
   if (count > 0) {
+    const bool use_32bit = canUse32BitIndexMath(input) &&
+                           canUse32BitIndexMath(grid) &&
+                           canUse32BitIndexMath(output);
     AT_DISPATCH_FLOATING_TYPES_AND_HALF(input.type(), "grid_sampler_2d_cuda", [&] {
-      grid_sampler_2d_kernel<scalar_t>
-        <<<GET_BLOCKS(count), CUDA_NUM_THREADS, 0, at::cuda::getCurrentCUDAStream()>>>(
-          count,
-          getTensorInfo<scalar_t, int>(input),
-          getTensorInfo<scalar_t, int>(grid),
-          getTensorInfo<scalar_t, int>(output),
-          static_cast<GridSamplerInterpolation>(interpolation_mode),
-          static_cast<GridSamplerPadding>(padding_mode));
+      AT_DISPATCH_INDEX_TYPES(use_32bit, [&] {
+        grid_sampler_2d_kernel<scalar_t, index_t>
+          <<<GET_BLOCKS(count), CUDA_NUM_THREADS, 0, at::cuda::getCurrentCUDAStream()>>>(
+            static_cast<index_t>(count),
+            input.packed_accessor<scalar_t, 4, index_t>(),
+            grid.packed_accessor<scalar_t, 4, index_t>(),
+            output.packed_accessor<scalar_t, 4, index_t>(),
+            static_cast<GridSamplerInterpolation>(interpolation_mode),
+            static_cast<GridSamplerPadding>(padding_mode));
+      });
     });
   }
   return output;
@@ -812,17 +847,22 @@ Tensor grid_sampler_3d_cuda(const Tensor& input, const Tensor& grid,
   auto H = grid.size(2);
   auto W = grid.size(3);
   auto output = at::empty({N, input.size(1), D, H, W}, input.options());
-  int count = static_cast<int>(N * D * H * W);
+  int64_t count = N * D * H * W;
   if (count > 0) {
+    const bool use_32bit = canUse32BitIndexMath(input) &&
+                           canUse32BitIndexMath(grid) &&
+                           canUse32BitIndexMath(output);
     AT_DISPATCH_FLOATING_TYPES_AND_HALF(input.type(), "grid_sampler_2d_cuda", [&] {
-      grid_sampler_3d_kernel<scalar_t>
-        <<<GET_BLOCKS(count), CUDA_NUM_THREADS, 0, at::cuda::getCurrentCUDAStream()>>>(
-          count,
-          getTensorInfo<scalar_t, int>(input),
-          getTensorInfo<scalar_t, int>(grid),
-          getTensorInfo<scalar_t, int>(output),
-          static_cast<GridSamplerInterpolation>(interpolation_mode),
-          static_cast<GridSamplerPadding>(padding_mode));
+      AT_DISPATCH_INDEX_TYPES(use_32bit, [&] {
+        grid_sampler_3d_kernel<scalar_t, index_t>
+          <<<GET_BLOCKS(count), CUDA_NUM_THREADS, 0, at::cuda::getCurrentCUDAStream()>>>(
+            static_cast<index_t>(count),
+            input.packed_accessor<scalar_t, 5, index_t>(),
+            grid.packed_accessor<scalar_t, 5, index_t>(),
+            output.packed_accessor<scalar_t, 5, index_t>(),
+            static_cast<GridSamplerInterpolation>(interpolation_mode),
+            static_cast<GridSamplerPadding>(padding_mode));
+      });
     });
   }
   return output;
@@ -837,19 +877,26 @@ grid_sampler_2d_backward_cuda(const Tensor& grad_output, const Tensor& input, co
   auto W = grid.size(2);
   auto grad_input = at::zeros_like(input);
   auto grad_grid = at::empty_like(grid);
-  int count = static_cast<int>(N * H * W);
+  int64_t count = N * H * W;
   if (count > 0) {
+    const bool use_32bit = canUse32BitIndexMath(grad_output) &&
+                           canUse32BitIndexMath(input) &&
+                           canUse32BitIndexMath(grid) &&
+                           canUse32BitIndexMath(grad_input) &&
+                           canUse32BitIndexMath(grad_grid);
     AT_DISPATCH_FLOATING_TYPES_AND_HALF(input.type(), "grid_sampler_2d_backward_cuda", [&] {
-      grid_sampler_2d_backward_kernel<scalar_t>
-        <<<GET_BLOCKS(count), CUDA_NUM_THREADS, 0, at::cuda::getCurrentCUDAStream()>>>(
-          count,
-          getTensorInfo<scalar_t, int>(grad_output),
-          getTensorInfo<scalar_t, int>(input),
-          getTensorInfo<scalar_t, int>(grid),
-          getTensorInfo<scalar_t, int>(grad_input),
-          getTensorInfo<scalar_t, int>(grad_grid),
-          static_cast<GridSamplerInterpolation>(interpolation_mode),
-          static_cast<GridSamplerPadding>(padding_mode));
+      AT_DISPATCH_INDEX_TYPES(use_32bit, [&] {
+        grid_sampler_2d_backward_kernel<scalar_t, index_t>
+          <<<GET_BLOCKS(count), CUDA_NUM_THREADS, 0, at::cuda::getCurrentCUDAStream()>>>(
+            static_cast<index_t>(count),
+            grad_output.packed_accessor<scalar_t, 4, index_t>(),
+            input.packed_accessor<scalar_t, 4, index_t>(),
+            grid.packed_accessor<scalar_t, 4, index_t>(),
+            grad_input.packed_accessor<scalar_t, 4, index_t>(),
+            grad_grid.packed_accessor<scalar_t, 4, index_t>(),
+            static_cast<GridSamplerInterpolation>(interpolation_mode),
+            static_cast<GridSamplerPadding>(padding_mode));
+      });
     });
   }
   return std::make_tuple(grad_input, grad_grid);
@@ -865,19 +912,26 @@ grid_sampler_3d_backward_cuda(const Tensor& grad_output, const Tensor& input, co
   auto W = grid.size(3);
   auto grad_input = at::zeros_like(input);
   auto grad_grid = at::empty_like(grid);
-  int count = static_cast<int>(N * D * H * W);
+  int64_t count = N * D * H * W;
   if (count > 0) {
+    const bool use_32bit = canUse32BitIndexMath(grad_output) &&
+                           canUse32BitIndexMath(input) &&
+                           canUse32BitIndexMath(grid) &&
+                           canUse32BitIndexMath(grad_input) &&
+                           canUse32BitIndexMath(grad_grid);
     AT_DISPATCH_FLOATING_TYPES_AND_HALF(input.type(), "grid_sampler_3d_backward_cuda", [&] {
-      grid_sampler_3d_backward_kernel<scalar_t>
-        <<<GET_BLOCKS(count), CUDA_NUM_THREADS, 0, at::cuda::getCurrentCUDAStream()>>>(
-          count,
-          getTensorInfo<scalar_t, int>(grad_output),
-          getTensorInfo<scalar_t, int>(input),
-          getTensorInfo<scalar_t, int>(grid),
-          getTensorInfo<scalar_t, int>(grad_input),
-          getTensorInfo<scalar_t, int>(grad_grid),
-          static_cast<GridSamplerInterpolation>(interpolation_mode),
-          static_cast<GridSamplerPadding>(padding_mode));
+      AT_DISPATCH_INDEX_TYPES(use_32bit, [&] {
+        grid_sampler_3d_backward_kernel<scalar_t, index_t>
+          <<<GET_BLOCKS(count), CUDA_NUM_THREADS, 0, at::cuda::getCurrentCUDAStream()>>>(
+            static_cast<index_t>(count),
+            grad_output.packed_accessor<scalar_t, 5, index_t>(),
+            input.packed_accessor<scalar_t, 5, index_t>(),
+            grid.packed_accessor<scalar_t, 5, index_t>(),
+            grad_input.packed_accessor<scalar_t, 5, index_t>(),
+            grad_grid.packed_accessor<scalar_t, 5, index_t>(),
+            static_cast<GridSamplerInterpolation>(interpolation_mode),
+            static_cast<GridSamplerPadding>(padding_mode));
+      });
     });
   }
   return std::make_tuple(grad_input, grad_grid);
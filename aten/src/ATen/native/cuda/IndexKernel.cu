@@ -0,0 +1,133 @@
+#include <ATen/native/Indexing.h>
+
+#include <ATen/ATen.h>
+#include <ATen/Dispatch.h>
+#include <ATen/native/TensorIterator.h>
+#include <ATen/native/cuda/Loops.cuh>
+#include <THC/THCAtomics.cuh>
+
+#include <assert.h>
+
+// NOTE: CUDA on Windows requires that the enclosing function of a __device__
+// lambda not have internal linkage.
+
+namespace at { namespace native {
+
+// The sizes, strides and data pointers of the indices, passed to the kernel
+// by value
+template <typename T>
+struct IndexArray {
+  static constexpr int MAX_INDICES = 25;
+  __host__ __device__ T& operator[](int i) { return values[i]; }
+  __host__ __device__ const T& operator[](int i) const { return values[i]; }
+  T values[MAX_INDICES];
+};
+
+// Calls f(out, in, offset) for every element of `iter` (see Indexing.h), with
+// the byte offset computed from the indices. The indices have the same
+// strides (see AdvancedIndex), so the offset of the first one is used for
+// all. Out of range indices fail a device-side assert instead of reading the
+// indices back to check them.
+template <typename func_t>
+void gpu_index_kernel(TensorIterator& iter, IntList index_size, IntList index_stride, const func_t& f) {
+  int num_indices = index_size.size();
+  AT_ASSERT(num_indices == (int)index_stride.size());
+  AT_ASSERT(num_indices == iter.ntensors() - 2);
+  AT_CHECK(num_indices <= IndexArray<int64_t>::MAX_INDICES,
+           "index: at most ", IndexArray<int64_t>::MAX_INDICES,
+           " dimensions can be indexed, but got ", num_indices);
+
+  if (iter.numel() == 0) {
+    return;
+  }
+
+  if (!iter.can_use_32bit_indexing()) {
+    for (auto& sub_iter : iter.with_32bit_indexing()) {
+      gpu_index_kernel(sub_iter, index_size, index_stride, f);
+    }
+    return;
+  }
+
+  IndexArray<int64_t> sizes;
+  IndexArray<int64_t> strides;
+  IndexArray<char*> index_ptrs;
+  for (int i = 0; i < num_indices; i++) {
+    sizes[i] = index_size[i];
+    strides[i] = index_stride[i];
+    index_ptrs[i] = (char*)iter.data_ptr(i + 2);
+  }
+
+  char* out_ptr = (char*)iter.data_ptr(0);
+  char* in_ptr = (char*)iter.data_ptr(1);
+
+  if (num_indices == 0) {
+    auto offset_calc = make_offset_calculator<2>(iter);
+    launch_kernel<128, 4>(iter.numel(), [=]__device__(int idx) {
+      auto offsets = offset_calc.get(idx);
+      f(out_ptr + offsets[0], in_ptr + offsets[1], 0);
+    });
+    return;
+  }
+
+  auto offset_calc = make_offset_calculator<3>(iter);
+  launch_kernel<128, 4>(iter.numel(), [=]__device__(int idx) {
+    auto offsets = offset_calc.get(idx);
+    char* out_data = out_ptr + offsets[0];
+    char* in_data = in_ptr + offsets[1];
+
+    int64_t offset = 0;
+    #pragma unroll
+    for (int i = 0; i < num_indices; i++) {
+      int64_t index = *(int64_t*)(index_ptrs[i] + offsets[2]);
+      assert(index >= -sizes[i] && index < sizes[i] && "index out of bounds");
+      if (index < 0) {
+        index += sizes[i];
+      }
+      offset += index * strides[i];
+    }
+
+    f(out_data, in_data, offset);
+  });
+}
+
+template <typename scalar_t>
+void index_kernel_impl(TensorIterator& iter, IntList index_size, IntList index_stride) {
+  gpu_index_kernel(iter, index_size, index_stride, []__device__(char* out_data, char* in_data, int64_t offset) {
+    *(scalar_t*)out_data = *(scalar_t*)(in_data + offset);
+  });
+}
+
+template <typename scalar_t>
+void index_put_kernel_impl(TensorIterator& iter, IntList index_size, IntList index_stride) {
+  gpu_index_kernel(iter, index_size, index_stride, []__device__(char* out_data, char* in_data, int64_t offset) {
+    *(scalar_t*)(out_data + offset) = *(scalar_t*)in_data;
+  });
+}
+
+template <typename scalar_t>
+void index_put_accumulate_kernel_impl(TensorIterator& iter, IntList index_size, IntList index_stride) {
+  gpu_index_kernel(iter, index_size, index_stride, []__device__(char* out_data, char* in_data, int64_t offset) {
+    atomicAdd((scalar_t*)(out_data + offset), *(scalar_t*)in_data);
+  });
+}
+
+static void index_kernel(TensorIterator& iter, IntList index_size, IntList index_stride) {
+  AT_DISPATCH_ALL_TYPES_AND_HALF(iter.type(), "index", [&] {
+    index_kernel_impl<scalar_t>(iter, index_size, index_stride);
+  });
+}
+
+static void index_put_kernel(TensorIterator& iter, IntList index_size, IntList index_stride, bool accumulate) {
+  AT_DISPATCH_ALL_TYPES_AND_HALF(iter.type(), "index_put", [&] {
+    if (accumulate) {
+      index_put_accumulate_kernel_impl<scalar_t>(iter, index_size, index_stride);
+    } else {
+      index_put_kernel_impl<scalar_t>(iter, index_size, index_stride);
+    }
+  });
+}
+
+REGISTER_DISPATCH(index_stub, &index_kernel);
+REGISTER_DISPATCH(index_put_stub, &index_put_kernel);
+
+}} // namespace at::native
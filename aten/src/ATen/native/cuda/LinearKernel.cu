@@ -0,0 +1,49 @@
+#include "ATen/native/Linear.h"
+
+#include "ATen/AccumulateType.h"
+#include "ATen/Dispatch.h"
+#include "ATen/cuda/CUDAContext.h"
+
+#include <THC/THCGeneral.h>
+
+namespace at { namespace native {
+
+namespace {
+
+// One thread per element of the contiguous (M, N) out.
+template <typename scalar_t, typename accscalar_t>
+__global__ void bias_relu_kernel_impl(
+    scalar_t* out, const scalar_t* bias, int64_t numel, int64_t N) {
+  for (int64_t i = (int64_t)blockIdx.x * blockDim.x + threadIdx.x; i < numel;
+       i += (int64_t)blockDim.x * gridDim.x) {
+    accscalar_t x = static_cast<accscalar_t>(out[i]);
+    if (bias != nullptr) {
+      x += static_cast<accscalar_t>(bias[i % N]);
+    }
+    out[i] = static_cast<scalar_t>(x > accscalar_t(0) ? x : accscalar_t(0));
+  }
+}
+
+void bias_relu_kernel_cuda(Tensor& out, const Tensor& bias) {
+  const int64_t numel = out.numel();
+  if (numel == 0) {
+    return;
+  }
+  const int64_t N = out.size(1);
+  const int threads = 256;
+  const int64_t max_blocks = at::cuda::getCurrentDeviceProperties()->multiProcessorCount *
+      (at::cuda::getCurrentDeviceProperties()->maxThreadsPerMultiProcessor / threads);
+  const int64_t blocks = std::min((numel + threads - 1) / threads, max_blocks);
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(out.type(), "bias_relu_cuda", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    bias_relu_kernel_impl<scalar_t, accscalar_t><<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(
+        out.data<scalar_t>(), bias.defined() ? bias.data<scalar_t>() : nullptr, numel, N);
+  });
+  THCudaCheck(cudaGetLastError());
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(bias_relu_stub, &bias_relu_kernel_cuda);
+
+}} // namespace at::native
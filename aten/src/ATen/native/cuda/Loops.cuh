@@ -4,6 +4,8 @@
 #include <ATen/detail/FunctionTraits.h>
 #include <ATen/native/TensorIterator.h>
 
+#include <cstdint>
+
 
 // Marks a lambda as executable on both the host and device. The __host__
 // attribute is important so that we can access static type information from
@@ -38,9 +40,10 @@ __global__ void elementwise_kernel(int N, func_t f) {
   }
 }
 
+// Computes the offsets of the first N operands of iter
 template<int N>
 static OffsetCalculator<N> make_offset_calculator(const TensorIterator& iter) {
-  AT_ASSERT(N == iter.ntensors());
+  AT_ASSERT(N <= iter.ntensors());
   std::array<const int64_t*, N> strides;
   for (int i = 0; i < N; i++) {
     strides[i] = iter.strides(i).data();
@@ -59,20 +62,155 @@ static void launch_kernel(int64_t N, const func_t& f) {
   elementwise_kernel<nt, vt, func_t><<<grid, block, 0, stream>>>(N, f);
 }
 
+// Note [Vectorized elementwise kernels]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// When every operand is contiguous, the kernels index them directly instead
+// of through strides, and when the data pointers are also aligned, each
+// thread loads and stores 128 bits of the widest operand at a time, which
+// memory-bound operations need to come close to peak bandwidth. Each thread
+// handles `vt` such vectors; the last, partial vector is done an element at a
+// time. Operands of other layouts go through the strided 1-d kernels or the
+// OffsetCalculator, which uses IntDivider's fast division.
+
+template <typename scalar_t, int vec_size>
+struct alignas(sizeof(scalar_t) * vec_size) aligned_vector {
+  scalar_t val[vec_size];
+};
+
+template <typename... Ts> struct max_sizeof;
+
+template <typename T>
+struct max_sizeof<T> {
+  static constexpr int value = sizeof(T);
+};
+
+template <typename T, typename... Ts>
+struct max_sizeof<T, Ts...> {
+  static constexpr int value =
+      (int)sizeof(T) > max_sizeof<Ts...>::value ? (int)sizeof(T) : max_sizeof<Ts...>::value;
+};
+
+// The number of elements per vector access, such that the widest of the
+// types is accessed 128 bits at a time.
+template <typename... Ts>
+struct vector_size {
+  static constexpr int value = max_sizeof<Ts...>::value >= 16 ? 1 : 16 / max_sizeof<Ts...>::value;
+};
+
+template <int vec_size, typename T>
+static inline bool is_vector_aligned(const void* ptr) {
+  return reinterpret_cast<uintptr_t>(ptr) % (sizeof(T) * vec_size) == 0;
+}
+
+template<int vec_size, typename func_t>
+void launch_contiguous_nullary_kernel(int N, char* out_data, const func_t& f) {
+  using arg0_t = typename function_traits<func_t>::result_type;
+  using out_vec_t = aligned_vector<arg0_t, vec_size>;
+  launch_kernel<128, 4>((N + vec_size - 1) / vec_size, [=]__device__(int idx) {
+    arg0_t* out = (arg0_t*)out_data + idx * vec_size;
+    int remaining = N - idx * vec_size;
+    if (remaining >= vec_size) {
+      out_vec_t result;
+      #pragma unroll
+      for (int i = 0; i < vec_size; i++) {
+        result.val[i] = f();
+      }
+      *(out_vec_t*)out = result;
+    } else {
+      for (int i = 0; i < remaining; i++) {
+        out[i] = f();
+      }
+    }
+  });
+}
+
+template<int vec_size, typename func_t>
+void launch_contiguous_unary_kernel(int N, char* out_data, const char* in1_data, const func_t& f) {
+  using traits = unary_function_traits<func_t>;
+  using arg0_t = typename traits::result_type;
+  using arg1_t = typename traits::arg1_t;
+  using out_vec_t = aligned_vector<arg0_t, vec_size>;
+  using in1_vec_t = aligned_vector<arg1_t, vec_size>;
+  launch_kernel<128, 4>((N + vec_size - 1) / vec_size, [=]__device__(int idx) {
+    arg0_t* out = (arg0_t*)out_data + idx * vec_size;
+    const arg1_t* in1 = (const arg1_t*)in1_data + idx * vec_size;
+    int remaining = N - idx * vec_size;
+    if (remaining >= vec_size) {
+      in1_vec_t a = *(const in1_vec_t*)in1;
+      out_vec_t result;
+      #pragma unroll
+      for (int i = 0; i < vec_size; i++) {
+        result.val[i] = f(a.val[i]);
+      }
+      *(out_vec_t*)out = result;
+    } else {
+      for (int i = 0; i < remaining; i++) {
+        out[i] = f(in1[i]);
+      }
+    }
+  });
+}
+
+template<int vec_size, typename func_t>
+void launch_contiguous_binary_kernel(
+    int N, char* out_data, const char* in1_data, const char* in2_data, const func_t& f) {
+  using traits = binary_function_traits<func_t>;
+  using arg0_t = typename traits::result_type;
+  using arg1_t = typename traits::arg1_t;
+  using arg2_t = typename traits::arg2_t;
+  using out_vec_t = aligned_vector<arg0_t, vec_size>;
+  using in1_vec_t = aligned_vector<arg1_t, vec_size>;
+  using in2_vec_t = aligned_vector<arg2_t, vec_size>;
+  launch_kernel<128, 4>((N + vec_size - 1) / vec_size, [=]__device__(int idx) {
+    arg0_t* out = (arg0_t*)out_data + idx * vec_size;
+    const arg1_t* in1 = (const arg1_t*)in1_data + idx * vec_size;
+    const arg2_t* in2 = (const arg2_t*)in2_data + idx * vec_size;
+    int remaining = N - idx * vec_size;
+    if (remaining >= vec_size) {
+      in1_vec_t a = *(const in1_vec_t*)in1;
+      in2_vec_t b = *(const in2_vec_t*)in2;
+      out_vec_t result;
+      #pragma unroll
+      for (int i = 0; i < vec_size; i++) {
+        result.val[i] = f(a.val[i], b.val[i]);
+      }
+      *(out_vec_t*)out = result;
+    } else {
+      for (int i = 0; i < remaining; i++) {
+        out[i] = f(in1[i], in2[i]);
+      }
+    }
+  });
+}
+
 template<typename func_t>
 void gpu_nullary_kernel(TensorIterator& iter, const func_t& f) {
   ASSERT_HOST_DEVICE_LAMBDA(func_t);
 
+  if (!iter.can_use_32bit_indexing()) {
+    for (auto& sub_iter : iter.with_32bit_indexing()) {
+      gpu_nullary_kernel(sub_iter, f);
+    }
+    return;
+  }
+
   char* out_data = (char*)iter.data_ptr(0);
 
   using traits = function_traits<func_t>;
   using arg0_t = typename traits::result_type;
 
-  int64_t numel = iter.numel();
+  int numel = iter.numel();
   if (numel == 0) {
     return;
   }
-  if (iter.is_trivial_1d()) {
+  if (iter.is_trivial_1d() && iter.get_inner_strides()[0] == sizeof(arg0_t)) {
+    constexpr int vec_size = vector_size<arg0_t>::value;
+    if (is_vector_aligned<vec_size, arg0_t>(out_data)) {
+      launch_contiguous_nullary_kernel<vec_size>(numel, out_data, f);
+    } else {
+      launch_contiguous_nullary_kernel<1>(numel, out_data, f);
+    }
+  } else if (iter.is_trivial_1d()) {
     auto strides = iter.get_inner_strides();
     int stride0 = strides[0];
     launch_kernel<512, 1>(numel, [=]__device__(int idx) {
@@ -93,6 +231,13 @@ template<typename func_t>
 void gpu_unary_kernel(TensorIterator& iter, const func_t& f) {
   ASSERT_HOST_DEVICE_LAMBDA(func_t);
 
+  if (!iter.can_use_32bit_indexing()) {
+    for (auto& sub_iter : iter.with_32bit_indexing()) {
+      gpu_unary_kernel(sub_iter, f);
+    }
+    return;
+  }
+
   char* out_data = (char*)iter.data_ptr(0);
   const char* in1_data = (char*)iter.data_ptr(1);
 
@@ -100,7 +245,7 @@ void gpu_unary_kernel(TensorIterator& iter, const func_t& f) {
   using arg0_t = typename traits::result_type;
   using arg1_t = typename traits::arg1_t;
 
-  int64_t numel = iter.numel();
+  int numel = iter.numel();
   if (numel == 0) {
     return;
   }
@@ -110,6 +255,16 @@ void gpu_unary_kernel(TensorIterator& iter, const func_t& f) {
     gpu_nullary_kernel(iter, [=]GPU_LAMBDA(void) {
       return f(a);
     });
+  } else if (iter.is_trivial_1d() &&
+             iter.get_inner_strides()[0] == sizeof(arg0_t) &&
+             iter.get_inner_strides()[1] == sizeof(arg1_t)) {
+    constexpr int vec_size = vector_size<arg0_t, arg1_t>::value;
+    if (is_vector_aligned<vec_size, arg0_t>(out_data) &&
+        is_vector_aligned<vec_size, arg1_t>(in1_data)) {
+      launch_contiguous_unary_kernel<vec_size>(numel, out_data, in1_data, f);
+    } else {
+      launch_contiguous_unary_kernel<1>(numel, out_data, in1_data, f);
+    }
   } else if (iter.is_trivial_1d()) {
     auto strides = iter.get_inner_strides();
     int stride0 = strides[0];
@@ -166,6 +321,18 @@ void gpu_binary_kernel(TensorIterator& iter, const func_t& f) {
     gpu_unary_kernel(iter, [=]GPU_LAMBDA(arg1_t a) {
       return f(a, b);
     });
+  } else if (iter.is_trivial_1d() &&
+             iter.get_inner_strides()[0] == sizeof(arg0_t) &&
+             iter.get_inner_strides()[1] == sizeof(arg1_t) &&
+             iter.get_inner_strides()[2] == sizeof(arg2_t)) {
+    constexpr int vec_size = vector_size<arg0_t, arg1_t, arg2_t>::value;
+    if (is_vector_aligned<vec_size, arg0_t>(out_data) &&
+        is_vector_aligned<vec_size, arg1_t>(in1_data) &&
+        is_vector_aligned<vec_size, arg2_t>(in2_data)) {
+      launch_contiguous_binary_kernel<vec_size>(numel, out_data, in1_data, in2_data, f);
+    } else {
+      launch_contiguous_binary_kernel<1>(numel, out_data, in1_data, in2_data, f);
+    }
   } else if (iter.is_trivial_1d()) {
     auto strides = iter.get_inner_strides();
     int stride0 = strides[0];
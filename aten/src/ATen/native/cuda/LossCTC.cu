@@ -15,6 +15,9 @@
 #include "ATen/Dispatch.h"
 #include "ATen/cuda/CUDAApplyUtils.cuh"
 
+#include <THC/THCGeneral.h>
+
+#include <algorithm>
 #include <type_traits>
 #include <numeric>
 
@@ -599,6 +602,393 @@ Tensor ctc_loss_backward_gpu_template(const Tensor& grad_out, const Tensor& log_
   return grad;
 }
 
+// The checkpointed variant below never materializes the full (batch x input_length x 2*max_target_length+1)
+// log_alpha and log_beta, which for long inputs run into gigabytes. The forward keeps a sliding window of the
+// current and previous time step per batch item, in shared memory when it fits, and stores every
+// checkpoint_interval-th row of log_alpha. The backward walks the input backward in segments of
+// checkpoint_interval time steps: it recomputes the segment's log_alpha from its checkpoint and advances
+// log_beta through it with the same sliding window, collecting the gradient as it goes. With an interval of
+// about sqrt(input_length) this needs O(batch * sqrt(input_length) * target_length) memory at the price of
+// computing log_alpha twice.
+// Unlike the kernels above, one row of threads handles all s of a batch item (looping over s), so a block
+// processes several batch items and no time step has to wait for a previous block_s.
+
+// log(exp(a)+exp(b)+exp(c)), which is -inf if all are
+template<typename scalar_t>
+__device__ static inline scalar_t ctc_logsumexp3(scalar_t a, scalar_t b, scalar_t c) {
+  constexpr scalar_t neginf = -INFINITY;
+  scalar_t m = (a > b) ? a : b;
+  m = (m > c) ? m : c;
+  if (m == neginf)
+    return neginf;
+  return std::log(std::exp(a-m)+std::exp(b-m)+std::exp(c-m))+m;
+}
+
+// alpha at (t, s) from the row alpha at t-1 (prev), equations (6) and (7)
+template<typename scalar_t, typename target_t>
+__device__ static inline scalar_t ctc_alpha_step(const scalar_t* prev, int64_t s, const scalar_t* log_probs_t, int64_t lp_char_stride,
+                                                 const target_t* __restrict__ targets_data, int64_t tg_batch_offset, int64_t tg_target_stride,
+                                                 int64_t BLANK) {
+  constexpr scalar_t neginf = -INFINITY;
+  int64_t current_char = get_target_prime(targets_data, tg_batch_offset, tg_target_stride, s, BLANK);
+  bool have_three = ((s > 1) && (get_target_prime(targets_data, tg_batch_offset, tg_target_stride, s-2, BLANK) != current_char));
+  return ctc_logsumexp3(prev[s], (s > 0) ? prev[s-1] : neginf, have_three ? prev[s-2] : neginf)
+    + log_probs_t[lp_char_stride * current_char];
+}
+
+template<typename scalar_t, typename target_t>
+__global__ void ctc_loss_checkpointed_log_alpha_gpu_kernel(scalar_t* __restrict__ log_alpha_data, scalar_t* __restrict__ window_data,
+                                                  const scalar_t*log_probs_data, const int64_t* __restrict__ input_lengths, int64_t max_input_length,
+                                                  const target_t* __restrict__ targets_data, const int64_t* __restrict__ target_lengths, int64_t max_target_length,
+                                                  scalar_t* __restrict__ neg_log_likelihood_data,
+                                                  int64_t lp_input_stride, int64_t lp_batch_stride, int64_t lp_char_stride,
+                                                  int64_t la_batch_stride, int64_t la_input_stride, int64_t la_target_stride,
+                                                  const int64_t* __restrict__ tg_batch_offsets, int64_t tg_target_stride,
+                                                  int64_t batch_size, int64_t BLANK, int64_t checkpoint_interval) {
+  constexpr scalar_t neginf = -INFINITY;
+  extern __shared__ unsigned char ctc_smem[];
+
+  int64_t num_s = 2*max_target_length+1;
+  int64_t b = threadIdx.y + blockIdx.y * blockDim.y;
+  // threads past the batch still have to take part in __syncthreads
+  bool valid = (b < batch_size);
+  int64_t input_length = valid ? input_lengths[b] : 0;
+  int64_t target_length = valid ? target_lengths[b] : 0;
+  int64_t lp_batch_offset = b*lp_batch_stride;
+  int64_t la_batch_offset = b*la_batch_stride;
+  int64_t tg_batch_offset = valid ? tg_batch_offsets[b] : 0;
+
+  // the sliding window of this batch item: log_alpha at t-1 (prev) and t (cur)
+  scalar_t* window = (window_data != nullptr) ? window_data + 2*num_s*b
+                                              : reinterpret_cast<scalar_t*>(ctc_smem) + 2*num_s*threadIdx.y;
+  scalar_t* prev = window;
+  scalar_t* cur = window + num_s;
+
+  // first row (t=0), the three equations for alpha_1 above eq (6)
+  if (valid) {
+    for (int64_t s = threadIdx.x; s < num_s; s += blockDim.x) {
+      scalar_t la = neginf;
+      if (s == 0) {
+        la = log_probs_data[lp_batch_offset + lp_char_stride * BLANK];
+      } else if ((s == 1) && (target_length > 0)) {
+        la = log_probs_data[lp_batch_offset + lp_char_stride * get_target_prime(targets_data, tg_batch_offset, tg_target_stride, 1, BLANK)];
+      }
+      prev[s] = la;
+      log_alpha_data[la_batch_offset + la_target_stride * s] = la;
+    }
+  }
+
+  for (int64_t t = 1; t < max_input_length; t++) {
+    __syncthreads();
+    if (valid) {
+      for (int64_t s = threadIdx.x; s < num_s; s += blockDim.x) {
+        scalar_t la;
+        if (t >= input_length) {
+          // past the end of the input, carry the last row along for the loss
+          la = prev[s];
+        } else if (s < 2*target_length+1) {
+          la = ctc_alpha_step(prev, s, log_probs_data + lp_batch_offset + t * lp_input_stride, lp_char_stride,
+                              targets_data, tg_batch_offset, tg_target_stride, BLANK);
+        } else {
+          la = neginf;
+        }
+        cur[s] = la;
+        if (t % checkpoint_interval == 0) {
+          log_alpha_data[la_batch_offset + la_input_stride * (t / checkpoint_interval) + la_target_stride * s] = la;
+        }
+      }
+    }
+    scalar_t* tmp = prev;
+    prev = cur;
+    cur = tmp;
+  }
+  __syncthreads();
+
+  // compute the loss (eq (8))
+  if (valid && threadIdx.x == 0) {
+    scalar_t l1 = prev[2*target_length];
+    scalar_t l2 = (target_length > 0) ? prev[2*target_length-1] : neginf;
+    neg_log_likelihood_data[b] = -ctc_logsumexp3(l1, l2, neginf);
+  }
+}
+
+// The checkpointed backward. gradient_data has to be zero on entry. For every time step, the block first
+// computes log_beta at t (eq (10) and (11)) and the probs (minuend in (16)), then subtracts the alpha*beta
+// terms. Blanks are at every even s, so their terms are summed in shared memory before touching the gradient.
+template<typename scalar_t, typename target_t>
+__global__ void ctc_loss_checkpointed_backward_gpu_kernel(scalar_t* __restrict__ gradient_data,
+                                                 const scalar_t* __restrict__ grad_out_data, int64_t grad_out_batch_stride,
+                                                 const scalar_t* __restrict__ log_alpha_data, scalar_t* __restrict__ alpha_segment_data,
+                                                 scalar_t* __restrict__ window_data,
+                                                 const scalar_t*log_probs_data, const int64_t* __restrict__ input_lengths, int64_t max_input_length,
+                                                 const target_t* __restrict__ targets_data, const int64_t* __restrict__ target_lengths, int64_t max_target_length,
+                                                 const scalar_t* __restrict__ neg_log_likelihood_data,
+                                                 int64_t gr_input_stride, int64_t gr_batch_stride, int64_t gr_char_stride,
+                                                 int64_t lp_input_stride, int64_t lp_batch_stride, int64_t lp_char_stride,
+                                                 int64_t la_batch_stride, int64_t la_input_stride, int64_t la_target_stride,
+                                                 const int64_t* __restrict__ tg_batch_offsets, int64_t tg_target_stride,
+                                                 int64_t batch_size, int64_t num_labels, int64_t BLANK, int64_t checkpoint_interval) {
+  constexpr scalar_t neginf = -INFINITY;
+  extern __shared__ unsigned char ctc_smem[];
+
+  int64_t num_s = 2*max_target_length+1;
+  int64_t b = threadIdx.y + blockIdx.y * blockDim.y;
+  bool valid = (b < batch_size);
+  int64_t input_length = valid ? input_lengths[b] : 0;
+  int64_t target_length = valid ? target_lengths[b] : 0;
+  int64_t gr_batch_offset = b*gr_batch_stride;
+  int64_t lp_batch_offset = b*lp_batch_stride;
+  int64_t la_batch_offset = b*la_batch_stride;
+  int64_t tg_batch_offset = valid ? tg_batch_offsets[b] : 0;
+  scalar_t nll = valid ? neg_log_likelihood_data[b] : 0;
+  scalar_t gr = valid ? grad_out_data[b * grad_out_batch_stride] : 0;
+
+  scalar_t* blank_sum = reinterpret_cast<scalar_t*>(ctc_smem) + threadIdx.y;
+  // the sliding window of this batch item: log_beta at t+1 (next) and t (cur)
+  scalar_t* window = (window_data != nullptr) ? window_data + 2*num_s*b
+                                              : reinterpret_cast<scalar_t*>(ctc_smem) + blockDim.y + 2*num_s*threadIdx.y;
+  scalar_t* next = window;
+  scalar_t* cur = window + num_s;
+  // log_alpha of the current segment
+  scalar_t* alpha = alpha_segment_data + checkpoint_interval*num_s*b;
+
+  int64_t num_segments = (max_input_length + checkpoint_interval - 1) / checkpoint_interval;
+  for (int64_t segment = num_segments-1; segment >= 0; segment--) {
+    int64_t t0 = segment * checkpoint_interval;
+    int64_t t1 = (t0 + checkpoint_interval < max_input_length) ? t0 + checkpoint_interval : max_input_length;
+
+    // recompute log_alpha of the segment from its checkpoint
+    __syncthreads();
+    if (valid) {
+      for (int64_t s = threadIdx.x; s < num_s; s += blockDim.x) {
+        alpha[s] = log_alpha_data[la_batch_offset + la_input_stride * segment + la_target_stride * s];
+      }
+    }
+    for (int64_t t = t0+1; t < t1; t++) {
+      __syncthreads();
+      if (valid && (t < input_length)) {
+        const scalar_t* prev = alpha + (t-t0-1)*num_s;
+        for (int64_t s = threadIdx.x; s < num_s; s += blockDim.x) {
+          alpha[(t-t0)*num_s + s] = (s < 2*target_length+1)
+            ? ctc_alpha_step(prev, s, log_probs_data + lp_batch_offset + t * lp_input_stride, lp_char_stride,
+                             targets_data, tg_batch_offset, tg_target_stride, BLANK)
+            : neginf;
+        }
+      }
+    }
+
+    for (int64_t t = t1-1; t >= t0; t--) {
+      __syncthreads();
+      bool active = valid && (t < input_length);
+      if (active) {
+        const scalar_t* log_probs_t = log_probs_data + lp_batch_offset + t * lp_input_stride;
+        for (int64_t s = threadIdx.x; s < num_s; s += blockDim.x) {
+          scalar_t lb = neginf;
+          if (s < 2*target_length+1) {
+            int64_t current_target_prime = get_target_prime(targets_data, tg_batch_offset, tg_target_stride, s, BLANK);
+            if (t == input_length-1) {
+              // the beta initialization before eq (10)
+              if ((s == 2*target_length) || (s == 2*target_length-1)) {
+                lb = log_probs_t[lp_char_stride * current_target_prime];
+              }
+            } else {
+              bool have_three = ((s < 2*target_length-1) &&
+                                 (get_target_prime(targets_data, tg_batch_offset, tg_target_stride, s+2, BLANK) !=
+                                  current_target_prime));
+              lb = ctc_logsumexp3(next[s], (s < 2*target_length) ? next[s+1] : neginf, have_three ? next[s+2] : neginf)
+                + log_probs_t[lp_char_stride * current_target_prime];
+            }
+          }
+          cur[s] = lb;
+        }
+        for (int64_t c = threadIdx.x; c < num_labels; c += blockDim.x) {
+          gradient_data[gr_batch_offset + t * gr_input_stride + gr_char_stride * c] = std::exp(log_probs_t[lp_char_stride * c]);
+        }
+        if (threadIdx.x == 0) {
+          *blank_sum = 0;
+        }
+      }
+      __syncthreads();
+      if (active) {
+        const scalar_t* log_probs_t = log_probs_data + lp_batch_offset + t * lp_input_stride;
+        for (int64_t s = threadIdx.x; s < 2*target_length+1; s += blockDim.x) {
+          int64_t current_target_prime = get_target_prime(targets_data, tg_batch_offset, tg_target_stride, s, BLANK);
+          scalar_t lp = log_probs_t[lp_char_stride * current_target_prime];
+          scalar_t v = std::exp(alpha[(t-t0)*num_s + s] + cur[s] + nll - lp) * gr;
+          if (s % 2 == 0) {
+            atomicAdd(blank_sum, v);
+          } else {
+            atomicAdd(&gradient_data[gr_batch_offset + t * gr_input_stride + gr_char_stride * current_target_prime], -v);
+          }
+        }
+      }
+      __syncthreads();
+      if (active && (threadIdx.x == 0)) {
+        gradient_data[gr_batch_offset + t * gr_input_stride + gr_char_stride * BLANK] -= *blank_sum;
+      }
+      scalar_t* tmp = next;
+      next = cur;
+      cur = tmp;
+    }
+  }
+}
+
+// Where the targets of each batch item start and the lengths, on the GPU, for the checkpointed kernels.
+struct CTCTargetsInfo {
+  Tensor tg_batch_offsets;
+  Tensor input_lengths;
+  Tensor target_lengths;
+  int64_t tg_target_stride;
+  int64_t max_target_length;
+};
+
+static CTCTargetsInfo ctc_targets_info(const Tensor& targets, IntList input_lengths, IntList target_lengths, int64_t batch_size) {
+  CTCTargetsInfo info;
+  auto tg_batch_offsets = at::empty({batch_size}, TensorOptions(at::CPU(kLong)));
+  auto tg_batch_offsets_data = tg_batch_offsets.data<int64_t>();
+  if (targets.dim() == 1) { // concatenated targets
+    int64_t pos = 0;
+    info.max_target_length = 0;
+    for (int64_t i = 0; i < batch_size; i++) {
+      tg_batch_offsets_data[i] = pos;
+      pos += target_lengths[i];
+      info.max_target_length = std::max(info.max_target_length, target_lengths[i]);
+    }
+    info.tg_target_stride = targets.stride(0);
+  } else { // batch x max_target_length
+    int64_t tg_batch_stride = targets.stride(0);
+    for (int64_t i = 0; i < batch_size; i++) {
+      tg_batch_offsets_data[i] = i * tg_batch_stride;
+    }
+    info.tg_target_stride = targets.stride(1);
+    info.max_target_length = targets.size(1);
+  }
+  info.tg_batch_offsets = tg_batch_offsets.toType(targets.type().toScalarType(kLong));
+  info.target_lengths = at::tensor(target_lengths, targets.options().device(at::Device(at::Device::Type::CPU)).dtype(kLong)).toType(targets.type().toScalarType(kLong));
+  info.input_lengths = at::tensor(input_lengths, targets.options().device(at::Device(at::Device::Type::CPU)).dtype(kLong)).toType(targets.type().toScalarType(kLong));
+  return info;
+}
+
+// Launch configuration of the checkpointed kernels. A row of threads loops over the s of its batch item,
+// so at most 256 of them are used and the rest of the block takes more batch items. The sliding windows
+// (plus per_item_scalars for each batch item) go to shared memory when they fit, otherwise to window,
+// which is allocated in global memory.
+template<typename scalar_t>
+static void ctc_checkpointed_config(const Tensor& log_probs, int64_t batch_size, int64_t max_target_length, int64_t per_item_scalars,
+                                    dim3& block, dim3& grid, size_t& shared_mem, Tensor& window) {
+  constexpr int max_threads = 256;
+  int64_t num_s = 2*max_target_length+1;
+  int threads_target = 32;
+  while (threads_target < num_s && threads_target < max_threads) {
+    threads_target *= 2;
+  }
+  int threads_batch = std::max(1, std::min(max_threads / threads_target, (int) batch_size));
+  block = dim3(threads_target, threads_batch);
+  grid = dim3(1, (batch_size+threads_batch-1)/threads_batch);
+
+  size_t window_mem = threads_batch * (2*num_s + per_item_scalars) * sizeof(scalar_t);
+  if (window_mem <= at::cuda::getCurrentDeviceProperties()->sharedMemPerBlock) {
+    shared_mem = window_mem;
+  } else {
+    shared_mem = threads_batch * per_item_scalars * sizeof(scalar_t);
+    window = at::empty({grid.y * threads_batch, 2, num_s}, log_probs.options());
+  }
+}
+
+template<typename scalar_t, ScalarType target_scalar_type>
+std::tuple<Tensor, Tensor> ctc_loss_checkpointed_gpu_template(const Tensor& log_probs, const Tensor& targets_, IntList input_lengths, IntList target_lengths,
+                                                              int64_t BLANK, int64_t checkpoint_interval) {
+  CheckedFrom c = "ctc_loss_checkpointed_gpu";
+  using target_t = typename std::conditional<target_scalar_type == kInt, int, int64_t>::type;
+  auto targets = targets_.toType(log_probs.type().toScalarType(target_scalar_type)); // to log_probs cuda if it isn't there already
+  auto log_probs_arg = TensorArg(log_probs, "log_probs", 1);
+  auto targets_arg = TensorArg(targets, "targets", 2);
+  checkAllSameGPU(c, {log_probs_arg, targets_arg});
+
+  checkScalarType(c, targets_arg, target_scalar_type);
+  checkDim(c, log_probs_arg, 3);
+  checkDimRange(c, targets_arg, 1, 3);
+
+  int64_t batch_size = log_probs.size(1);
+  int64_t num_labels = log_probs.size(2);
+  int64_t max_input_length = log_probs.size(0);
+  AT_CHECK((0 <= BLANK) && (BLANK < num_labels), "blank must be in label range");
+  AT_CHECK(input_lengths.size() == batch_size, "input_lengths must be of size batch_size");
+  AT_CHECK(target_lengths.size() == batch_size, "target_lengths must be of size batch_size");
+  AT_CHECK(checkpoint_interval > 0, "checkpoint_interval must be positive, but got ", checkpoint_interval);
+  for (int64_t b = 0; b < batch_size; b++) {
+    AT_CHECK((input_lengths[b] > 0) && (input_lengths[b] <= max_input_length),
+             "Expected input_lengths to be between 1 and ", max_input_length, ", but got ", input_lengths[b]);
+  }
+
+  auto info = ctc_targets_info(targets, input_lengths, target_lengths, batch_size);
+  if (targets.dim() == 1) {
+    checkSize(c, targets_arg, 0, std::accumulate(target_lengths.begin(), target_lengths.end(), int64_t(0)));
+  } else {
+    checkSize(c, targets_arg, 0, batch_size);
+  }
+
+  int64_t num_checkpoints = (max_input_length + checkpoint_interval - 1) / checkpoint_interval;
+  Tensor log_alpha = at::empty({batch_size, num_checkpoints, 2*info.max_target_length+1}, log_probs.options());
+  Tensor neg_log_likelihood = at::empty({batch_size}, log_probs.options());
+
+  dim3 block, grid;
+  size_t shared_mem;
+  Tensor window;
+  ctc_checkpointed_config<scalar_t>(log_probs, batch_size, info.max_target_length, 0, block, grid, shared_mem, window);
+  cudaStream_t stream = at::cuda::getCurrentCUDAStream();
+
+  ctc_loss_checkpointed_log_alpha_gpu_kernel<scalar_t, target_t><<<grid, block, shared_mem, stream>>>(
+                      log_alpha.data<scalar_t>(), window.defined() ? window.data<scalar_t>() : nullptr,
+                      log_probs.data<scalar_t>(), info.input_lengths.data<int64_t>(), max_input_length,
+                      targets.data<target_t>(), info.target_lengths.data<int64_t>(), info.max_target_length,
+                      neg_log_likelihood.data<scalar_t>(),
+                      log_probs.stride(0), log_probs.stride(1), log_probs.stride(2),
+                      log_alpha.stride(0), log_alpha.stride(1), log_alpha.stride(2),
+                      info.tg_batch_offsets.data<int64_t>(), info.tg_target_stride,
+                      batch_size, BLANK, checkpoint_interval);
+  THCudaCheck(cudaGetLastError());
+  return std::make_tuple(neg_log_likelihood, log_alpha);
+}
+
+template<typename scalar_t, ScalarType target_scalar_type>
+Tensor ctc_loss_checkpointed_backward_gpu_template(const Tensor& grad_out, const Tensor& log_probs, const Tensor& targets_, IntList input_lengths, IntList target_lengths,
+                                                   const Tensor& neg_log_likelihood, const Tensor& log_alpha, int64_t BLANK, int64_t checkpoint_interval) {
+  using target_t = typename std::conditional<target_scalar_type == kInt, int, int64_t>::type;
+  auto targets = targets_.toType(log_probs.type().toScalarType(target_scalar_type)); // to cuda if it isn't there already
+  int64_t batch_size = log_probs.size(1);
+  int64_t num_labels = log_probs.size(2);
+  int64_t max_input_length = log_probs.size(0);
+  auto info = ctc_targets_info(targets, input_lengths, target_lengths, batch_size);
+
+  Tensor grad = at::zeros_like(log_probs);
+
+  // one blank sum per batch item in shared memory
+  dim3 block, grid;
+  size_t shared_mem;
+  Tensor window;
+  ctc_checkpointed_config<scalar_t>(log_probs, batch_size, info.max_target_length, 1, block, grid, shared_mem, window);
+  int64_t segment_length = std::min(checkpoint_interval, max_input_length);
+  Tensor alpha_segment = at::empty({grid.y * block.y, segment_length, 2*info.max_target_length+1}, log_probs.options());
+  cudaStream_t stream = at::cuda::getCurrentCUDAStream();
+
+  ctc_loss_checkpointed_backward_gpu_kernel<scalar_t, target_t><<<grid, block, shared_mem, stream>>>
+    (grad.data<scalar_t>(),
+     grad_out.data<scalar_t>(), grad_out.stride(0),
+     log_alpha.data<scalar_t>(), alpha_segment.data<scalar_t>(),
+     window.defined() ? window.data<scalar_t>() : nullptr,
+     log_probs.data<scalar_t>(), info.input_lengths.data<int64_t>(), max_input_length,
+     targets.data<target_t>(), info.target_lengths.data<int64_t>(), info.max_target_length,
+     neg_log_likelihood.data<scalar_t>(),
+     grad.stride(0), grad.stride(1), grad.stride(2),
+     log_probs.stride(0), log_probs.stride(1), log_probs.stride(2),
+     log_alpha.stride(0), log_alpha.stride(1), log_alpha.stride(2),
+     info.tg_batch_offsets.data<int64_t>(), info.tg_target_stride,
+     batch_size, num_labels, BLANK, segment_length);
+  THCudaCheck(cudaGetLastError());
+  return grad;
+}
+
 } // namespace
 
 std::tuple<Tensor, Tensor> ctc_loss_gpu(const Tensor& log_probs, const Tensor& targets, IntList input_lengths, IntList target_lengths, int64_t BLANK) {
@@ -622,4 +1012,28 @@ Tensor ctc_loss_backward_gpu(const Tensor& grad, const Tensor& log_probs, const
     });
 }
 
+std::tuple<Tensor, Tensor> ctc_loss_checkpointed_gpu(const Tensor& log_probs, const Tensor& targets, IntList input_lengths, IntList target_lengths,
+                                                     int64_t BLANK, int64_t checkpoint_interval) {
+  return AT_DISPATCH_FLOATING_TYPES(log_probs.type(), "ctc_loss_checkpointed", [&] {
+      if (targets.type().scalarType() == kLong) {
+        return ctc_loss_checkpointed_gpu_template<scalar_t, kLong>(log_probs, targets, input_lengths, target_lengths, BLANK, checkpoint_interval);
+      } else {
+        return ctc_loss_checkpointed_gpu_template<scalar_t, kInt>(log_probs, targets, input_lengths, target_lengths, BLANK, checkpoint_interval);
+      }
+    });
+}
+
+Tensor ctc_loss_checkpointed_backward_gpu(const Tensor& grad, const Tensor& log_probs, const Tensor& targets, IntList input_lengths, IntList target_lengths,
+                                          const Tensor& neg_log_likelihood, const Tensor& log_alpha, int64_t BLANK, int64_t checkpoint_interval) {
+  return AT_DISPATCH_FLOATING_TYPES(log_probs.type(), "ctc_loss_checkpointed_backward", [&] {
+      if (targets.type().scalarType() == kLong) {
+        return ctc_loss_checkpointed_backward_gpu_template<scalar_t, kLong>(grad, log_probs, targets, input_lengths, target_lengths,
+                                                                             neg_log_likelihood, log_alpha, BLANK, checkpoint_interval);
+      } else {
+        return ctc_loss_checkpointed_backward_gpu_template<scalar_t, kInt>(grad, log_probs, targets, input_lengths, target_lengths,
+                                                                            neg_log_likelihood, log_alpha, BLANK, checkpoint_interval);
+      }
+    });
+}
+
 } } // at::native
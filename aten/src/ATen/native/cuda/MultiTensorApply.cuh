@@ -0,0 +1,110 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/cuda/CUDAContext.h>
+
+#include <THC/THCGeneral.h>
+
+#include <vector>
+
+namespace at { namespace native {
+
+// Note [Multi-tensor apply]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~
+// multi_tensor_apply<depth>(lists, functor, args...) runs `functor` over the
+// elements of `depth` lists of tensors with as few kernel launches as
+// possible. Tensor i of every list must have the same number of elements.
+//
+// The tensors are cut into chunks of kChunkSize elements, and every block of
+// a launch processes one chunk. The addresses and sizes of the tensors, and
+// the chunk of every block, are passed by value in a TensorListMetadata, so a
+// launch is made whenever it runs out of slots for tensors or blocks. The
+// kernel arguments are limited to 4KB, which bounds the number of tensors per
+// launch for every depth.
+//
+// The functor is called on the device as
+//
+//   functor(chunk_size, metadata, args...)
+//
+// and finds its chunk with metadata.block_to_tensor[blockIdx.x] and
+// metadata.block_to_chunk[blockIdx.x].
+
+static constexpr int64_t kChunkSize = 65536;
+static constexpr int kMultiTensorApplyBlockSize = 512;
+
+static constexpr int depth_to_max_tensors[5] = {110, 64, 48, 36, 30};
+static constexpr int depth_to_max_blocks[5] = {320, 320, 320, 320, 320};
+
+template <int n>
+struct TensorListMetadata {
+  void* addresses[n][depth_to_max_tensors[n - 1]];
+  int64_t sizes[depth_to_max_tensors[n - 1]];
+  unsigned char block_to_tensor[depth_to_max_blocks[n - 1]];
+  int block_to_chunk[depth_to_max_blocks[n - 1]];
+};
+
+template <typename T, typename U, typename... ArgTypes>
+__global__ void multi_tensor_apply_kernel(
+    int64_t chunk_size, T metadata, U functor, ArgTypes... args) {
+  functor(chunk_size, metadata, args...);
+}
+
+template <int depth, typename T, typename... ArgTypes>
+void multi_tensor_apply(
+    const std::vector<std::vector<Tensor>>& tensor_lists, T functor,
+    ArgTypes... args) {
+  AT_ASSERT(tensor_lists.size() == depth);
+  const auto num_tensors = tensor_lists[0].size();
+  cudaStream_t stream = at::cuda::getCurrentCUDAStream();
+
+  TensorListMetadata<depth> metadata;
+  int loc_block = 0;
+  int loc_tensor = 0;
+  auto launch = [&] {
+    multi_tensor_apply_kernel<<<loc_block, kMultiTensorApplyBlockSize, 0, stream>>>(
+        kChunkSize, metadata, functor, args...);
+    THCudaCheck(cudaGetLastError());
+  };
+
+  for (size_t t = 0; t < num_tensors; t++) {
+    const int64_t numel = tensor_lists[0][t].numel();
+    if (numel == 0) {
+      continue;
+    }
+    metadata.sizes[loc_tensor] = numel;
+    for (int d = 0; d < depth; d++) {
+      metadata.addresses[d][loc_tensor] = tensor_lists[d][t].data_ptr();
+    }
+    loc_tensor++;
+
+    const int64_t chunks = (numel + kChunkSize - 1) / kChunkSize;
+    for (int64_t chunk = 0; chunk < chunks; chunk++) {
+      metadata.block_to_tensor[loc_block] = loc_tensor - 1;
+      metadata.block_to_chunk[loc_block] = chunk;
+      loc_block++;
+
+      const bool tensors_full = loc_tensor == depth_to_max_tensors[depth - 1] &&
+                                chunk == chunks - 1;
+      const bool blocks_full = loc_block == depth_to_max_blocks[depth - 1];
+      if (tensors_full || blocks_full) {
+        launch();
+        loc_block = 0;
+        if (chunk == chunks - 1) {
+          loc_tensor = 0;
+        } else {
+          // The rest of the current tensor goes to the next launch
+          metadata.sizes[0] = metadata.sizes[loc_tensor - 1];
+          for (int d = 0; d < depth; d++) {
+            metadata.addresses[d][0] = metadata.addresses[d][loc_tensor - 1];
+          }
+          loc_tensor = 1;
+        }
+      }
+    }
+  }
+  if (loc_block != 0) {
+    launch();
+  }
+}
+
+}} // namespace at::native
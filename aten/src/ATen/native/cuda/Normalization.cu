@@ -0,0 +1,565 @@
+#include "ATen/ATen.h"
+#include "ATen/AccumulateType.h"
+#include "ATen/Dispatch.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/ScalarTypeUtils.h"
+#include "ATen/cuda/CUDAContext.h"
+#include "ATen/cuda/Exceptions.h"
+
+#include <THC/THCDeviceUtils.cuh>
+
+#include <tuple>
+
+// CUDA LayerNorm and GroupNorm; see cpu/NormalizationKernel.cpp for the
+// math. A row (the N elements of a LayerNorm row, or a sample's group of
+// channels) is reduced with Welford's algorithm by one warp if it is short,
+// and by one block otherwise, and the same threads then write the normalized
+// row, which is still in cache.
+
+namespace at { namespace native {
+
+namespace {
+
+constexpr int kWarpSize = 32;
+constexpr int kMaxBlockThreads = 512;
+// LayerNorm rows up to this long are reduced by a single warp.
+constexpr int64_t kWarpRowMaxSize = 1024;
+constexpr int kWarpsPerBlock = 4;
+// dgamma and dbeta are reduced over rows by blocks of kColumnThreads x
+// kRowThreads, each covering up to kRowsPerBlock rows.
+constexpr int kColumnThreads = 32;
+constexpr int kRowThreads = 16;
+constexpr int64_t kRowsPerBlock = 512;
+
+template <typename T>
+struct WelfordState {
+  T mean;
+  T m2;
+  T n;
+};
+
+template <typename T>
+struct WelfordCombine {
+  __device__ WelfordState<T> operator()(WelfordState<T> a, WelfordState<T> b) const {
+    if (a.n == 0) {
+      return b;
+    }
+    if (b.n == 0) {
+      return a;
+    }
+    WelfordState<T> result;
+    T delta = b.mean - a.mean;
+    result.n = a.n + b.n;
+    T nb_over_n = b.n / result.n;
+    result.mean = a.mean + delta * nb_over_n;
+    result.m2 = a.m2 + b.m2 + delta * delta * a.n * nb_over_n;
+    return result;
+  }
+};
+
+template <typename T>
+__device__ __forceinline__ WelfordState<T> welford_update(WelfordState<T> s, T x) {
+  s.n += 1;
+  T delta = x - s.mean;
+  s.mean += delta / s.n;
+  s.m2 += delta * (x - s.mean);
+  return s;
+}
+
+template <typename T>
+__device__ __forceinline__ WelfordState<T> shfl_xor(WelfordState<T> s, int mask) {
+  return {WARP_SHFL_XOR(s.mean, mask), WARP_SHFL_XOR(s.m2, mask), WARP_SHFL_XOR(s.n, mask)};
+}
+
+// The sums of dY * gamma * X (ds) and dY * gamma (db) over a row.
+template <typename T>
+struct GradSums {
+  T ds;
+  T db;
+};
+
+template <typename T>
+struct GradSumsCombine {
+  __device__ GradSums<T> operator()(GradSums<T> a, GradSums<T> b) const {
+    return {a.ds + b.ds, a.db + b.db};
+  }
+};
+
+template <typename T>
+__device__ __forceinline__ GradSums<T> shfl_xor(GradSums<T> s, int mask) {
+  return {WARP_SHFL_XOR(s.ds, mask), WARP_SHFL_XOR(s.db, mask)};
+}
+
+// Combines v across the warp; every lane gets the result.
+template <typename V, typename Combine>
+__device__ __forceinline__ V warp_allreduce(V v, const Combine& combine) {
+  #pragma unroll
+  for (int mask = kWarpSize / 2; mask > 0; mask /= 2) {
+    v = combine(v, shfl_xor(v, mask));
+  }
+  return v;
+}
+
+// Combines v across the block; every thread gets the result. blockDim.x must
+// be a multiple of the warp size, and shared hold one V per warp.
+template <typename V, typename Combine>
+__device__ V block_allreduce(V v, V ident, const Combine& combine, V* shared) {
+  const int lane = threadIdx.x % kWarpSize;
+  const int warp = threadIdx.x / kWarpSize;
+  v = warp_allreduce(v, combine);
+  __syncthreads();
+  if (lane == 0) {
+    shared[warp] = v;
+  }
+  __syncthreads();
+  if (warp == 0) {
+    v = lane < blockDim.x / kWarpSize ? shared[lane] : ident;
+    v = warp_allreduce(v, combine);
+    if (lane == 0) {
+      shared[0] = v;
+    }
+  }
+  __syncthreads();
+  return shared[0];
+}
+
+// The row a thread works on, its first element in the row, and the stride
+// between its elements, for a warp or a block per row.
+template <bool kWarpPerRow>
+__device__ __forceinline__ void row_assignment(int64_t* row, int* begin, int* stride) {
+  if (kWarpPerRow) {
+    *row = (int64_t)blockIdx.x * (blockDim.x / kWarpSize) + threadIdx.x / kWarpSize;
+    *begin = threadIdx.x % kWarpSize;
+    *stride = kWarpSize;
+  } else {
+    *row = blockIdx.x;
+    *begin = threadIdx.x;
+    *stride = blockDim.x;
+  }
+}
+
+template <typename T>
+__device__ __forceinline__ T rstd_from_var(T var, T eps) {
+  return T(1) / ::sqrt(var > T(0) ? var + eps : eps);
+}
+
+template <typename scalar_t, typename acc_t, bool kWarpPerRow>
+__global__ void layer_norm_kernel(
+    int64_t M, int64_t N, acc_t eps, const scalar_t* X, const scalar_t* gamma,
+    const scalar_t* beta, scalar_t* Y, scalar_t* mean, scalar_t* rstd) {
+  __shared__ WelfordState<acc_t> shared[kMaxBlockThreads / kWarpSize];
+  int64_t row;
+  int begin, stride;
+  row_assignment<kWarpPerRow>(&row, &begin, &stride);
+  if (row >= M) {
+    // only whole warps of the warp per row layout get here
+    return;
+  }
+  const scalar_t* X_row = X + row * N;
+  scalar_t* Y_row = Y + row * N;
+
+  WelfordState<acc_t> s = {0, 0, 0};
+  for (int64_t j = begin; j < N; j += stride) {
+    s = welford_update(s, static_cast<acc_t>(X_row[j]));
+  }
+  s = kWarpPerRow
+      ? warp_allreduce(s, WelfordCombine<acc_t>())
+      : block_allreduce(s, WelfordState<acc_t>{0, 0, 0}, WelfordCombine<acc_t>(), shared);
+  const acc_t row_mean = s.mean;
+  const acc_t row_rstd = rstd_from_var(s.m2 / N, eps);
+  if (begin == 0) {
+    mean[row] = static_cast<scalar_t>(row_mean);
+    rstd[row] = static_cast<scalar_t>(row_rstd);
+  }
+
+  for (int64_t j = begin; j < N; j += stride) {
+    acc_t y = (static_cast<acc_t>(X_row[j]) - row_mean) * row_rstd;
+    if (gamma != nullptr) {
+      y *= static_cast<acc_t>(gamma[j]);
+    }
+    if (beta != nullptr) {
+      y += static_cast<acc_t>(beta[j]);
+    }
+    Y_row[j] = static_cast<scalar_t>(y);
+  }
+}
+
+template <typename scalar_t, typename acc_t, bool kWarpPerRow>
+__global__ void layer_norm_backward_input_kernel(
+    int64_t M, int64_t N, const scalar_t* dY, const scalar_t* X,
+    const scalar_t* mean, const scalar_t* rstd, const scalar_t* gamma,
+    scalar_t* dX) {
+  __shared__ GradSums<acc_t> shared[kMaxBlockThreads / kWarpSize];
+  int64_t row;
+  int begin, stride;
+  row_assignment<kWarpPerRow>(&row, &begin, &stride);
+  if (row >= M) {
+    return;
+  }
+  const scalar_t* dY_row = dY + row * N;
+  const scalar_t* X_row = X + row * N;
+  scalar_t* dX_row = dX + row * N;
+
+  GradSums<acc_t> s = {0, 0};
+  for (int64_t j = begin; j < N; j += stride) {
+    acc_t dy = static_cast<acc_t>(dY_row[j]);
+    if (gamma != nullptr) {
+      dy *= static_cast<acc_t>(gamma[j]);
+    }
+    s.ds += dy * static_cast<acc_t>(X_row[j]);
+    s.db += dy;
+  }
+  s = kWarpPerRow
+      ? warp_allreduce(s, GradSumsCombine<acc_t>())
+      : block_allreduce(s, GradSums<acc_t>{0, 0}, GradSumsCombine<acc_t>(), shared);
+
+  // dX = dY * gamma * rstd + X * b + c, see input_grad_coefficients in
+  // cpu/NormalizationKernel.cpp
+  const acc_t row_mean = static_cast<acc_t>(mean[row]);
+  const acc_t row_rstd = static_cast<acc_t>(rstd[row]);
+  const acc_t b = (s.db * row_mean - s.ds) * row_rstd * row_rstd * row_rstd / N;
+  const acc_t c = -b * row_mean - s.db * row_rstd / N;
+  for (int64_t j = begin; j < N; j += stride) {
+    acc_t dy = static_cast<acc_t>(dY_row[j]);
+    if (gamma != nullptr) {
+      dy *= static_cast<acc_t>(gamma[j]);
+    }
+    dX_row[j] = static_cast<scalar_t>(dy * row_rstd + static_cast<acc_t>(X_row[j]) * b + c);
+  }
+}
+
+// Partial sums of dY * xhat and dY over blocks of kRowsPerBlock rows, into
+// (gridDim.y, N) buffers.
+template <typename scalar_t, typename acc_t>
+__global__ void layer_norm_backward_params_kernel(
+    int64_t M, int64_t N, const scalar_t* dY, const scalar_t* X,
+    const scalar_t* mean, const scalar_t* rstd, acc_t* dgamma_partial,
+    acc_t* dbeta_partial) {
+  __shared__ acc_t dgamma_shared[kRowThreads][kColumnThreads + 1];
+  __shared__ acc_t dbeta_shared[kRowThreads][kColumnThreads + 1];
+  const int64_t j = (int64_t)blockIdx.x * kColumnThreads + threadIdx.x;
+  const int64_t row_begin = (int64_t)blockIdx.y * kRowsPerBlock;
+  const int64_t row_end = row_begin + kRowsPerBlock < M ? row_begin + kRowsPerBlock : M;
+  acc_t dgamma_sum = 0;
+  acc_t dbeta_sum = 0;
+  if (j < N) {
+    for (int64_t i = row_begin + threadIdx.y; i < row_end; i += kRowThreads) {
+      const acc_t dy = static_cast<acc_t>(dY[i * N + j]);
+      const acc_t xhat = (static_cast<acc_t>(X[i * N + j]) - static_cast<acc_t>(mean[i])) *
+                         static_cast<acc_t>(rstd[i]);
+      dgamma_sum += dy * xhat;
+      dbeta_sum += dy;
+    }
+  }
+  dgamma_shared[threadIdx.y][threadIdx.x] = dgamma_sum;
+  dbeta_shared[threadIdx.y][threadIdx.x] = dbeta_sum;
+  for (int offset = kRowThreads / 2; offset > 0; offset /= 2) {
+    __syncthreads();
+    if (threadIdx.y < offset) {
+      dgamma_shared[threadIdx.y][threadIdx.x] += dgamma_shared[threadIdx.y + offset][threadIdx.x];
+      dbeta_shared[threadIdx.y][threadIdx.x] += dbeta_shared[threadIdx.y + offset][threadIdx.x];
+    }
+  }
+  if (threadIdx.y == 0 && j < N) {
+    dgamma_partial[blockIdx.y * N + j] = dgamma_shared[0][threadIdx.x];
+    dbeta_partial[blockIdx.y * N + j] = dbeta_shared[0][threadIdx.x];
+  }
+}
+
+// A block per (sample, group): the row's moments, then the output with the
+// per channel affine transform.
+template <typename scalar_t, typename acc_t>
+__global__ void group_norm_kernel(
+    int64_t C, int64_t HxW, int64_t group, acc_t eps, const scalar_t* X,
+    const scalar_t* gamma, const scalar_t* beta, scalar_t* Y, scalar_t* mean,
+    scalar_t* rstd) {
+  __shared__ WelfordState<acc_t> shared[kMaxBlockThreads / kWarpSize];
+  const int64_t D = C / group;
+  const int64_t row_size = D * HxW;
+  const int64_t row = blockIdx.x;
+  const int64_t g = row % group;
+  const scalar_t* X_row = X + row * row_size;
+  scalar_t* Y_row = Y + row * row_size;
+
+  WelfordState<acc_t> s = {0, 0, 0};
+  for (int64_t j = threadIdx.x; j < row_size; j += blockDim.x) {
+    s = welford_update(s, static_cast<acc_t>(X_row[j]));
+  }
+  s = block_allreduce(s, WelfordState<acc_t>{0, 0, 0}, WelfordCombine<acc_t>(), shared);
+  const acc_t row_mean = s.mean;
+  const acc_t row_rstd = rstd_from_var(s.m2 / row_size, eps);
+  if (threadIdx.x == 0) {
+    mean[row] = static_cast<scalar_t>(row_mean);
+    rstd[row] = static_cast<scalar_t>(row_rstd);
+  }
+
+  for (int64_t j = threadIdx.x; j < row_size; j += blockDim.x) {
+    const int64_t c = g * D + j / HxW;
+    acc_t y = (static_cast<acc_t>(X_row[j]) - row_mean) * row_rstd;
+    if (gamma != nullptr) {
+      y *= static_cast<acc_t>(gamma[c]);
+    }
+    if (beta != nullptr) {
+      y += static_cast<acc_t>(beta[c]);
+    }
+    Y_row[j] = static_cast<scalar_t>(y);
+  }
+}
+
+// A block per (sample, channel): the sums of dY * X and dY over HxW.
+template <typename scalar_t, typename acc_t>
+__global__ void group_norm_channel_sums_kernel(
+    int64_t HxW, const scalar_t* dY, const scalar_t* X, acc_t* ds, acc_t* db) {
+  __shared__ GradSums<acc_t> shared[kMaxBlockThreads / kWarpSize];
+  const int64_t nc = blockIdx.x;
+  GradSums<acc_t> s = {0, 0};
+  for (int64_t j = threadIdx.x; j < HxW; j += blockDim.x) {
+    const acc_t dy = static_cast<acc_t>(dY[nc * HxW + j]);
+    s.ds += dy * static_cast<acc_t>(X[nc * HxW + j]);
+    s.db += dy;
+  }
+  s = block_allreduce(s, GradSums<acc_t>{0, 0}, GradSumsCombine<acc_t>(), shared);
+  if (threadIdx.x == 0) {
+    ds[nc] = s.ds;
+    db[nc] = s.db;
+  }
+}
+
+// A block per (sample, group): dX from the channel sums.
+template <typename scalar_t, typename acc_t>
+__global__ void group_norm_backward_input_kernel(
+    int64_t C, int64_t HxW, int64_t group, const scalar_t* dY,
+    const scalar_t* X, const scalar_t* mean, const scalar_t* rstd,
+    const scalar_t* gamma, const acc_t* ds, const acc_t* db, scalar_t* dX) {
+  __shared__ GradSums<acc_t> shared[kMaxBlockThreads / kWarpSize];
+  const int64_t D = C / group;
+  const int64_t row_size = D * HxW;
+  const int64_t row = blockIdx.x;
+  const int64_t g = row % group;
+  const int64_t nc_begin = row * D;  // (sample, first channel of the group)
+
+  GradSums<acc_t> s = {0, 0};
+  for (int64_t d = threadIdx.x; d < D; d += blockDim.x) {
+    const acc_t gamma_c = gamma != nullptr ? static_cast<acc_t>(gamma[g * D + d]) : acc_t(1);
+    s.ds += ds[nc_begin + d] * gamma_c;
+    s.db += db[nc_begin + d] * gamma_c;
+  }
+  s = block_allreduce(s, GradSums<acc_t>{0, 0}, GradSumsCombine<acc_t>(), shared);
+
+  const acc_t row_mean = static_cast<acc_t>(mean[row]);
+  const acc_t row_rstd = static_cast<acc_t>(rstd[row]);
+  const acc_t b = (s.db * row_mean - s.ds) * row_rstd * row_rstd * row_rstd / row_size;
+  const acc_t c = -b * row_mean - s.db * row_rstd / row_size;
+  const scalar_t* dY_row = dY + row * row_size;
+  const scalar_t* X_row = X + row * row_size;
+  scalar_t* dX_row = dX + row * row_size;
+  for (int64_t j = threadIdx.x; j < row_size; j += blockDim.x) {
+    const acc_t gamma_c = gamma != nullptr ? static_cast<acc_t>(gamma[g * D + j / HxW]) : acc_t(1);
+    dX_row[j] = static_cast<scalar_t>(
+        static_cast<acc_t>(dY_row[j]) * gamma_c * row_rstd + static_cast<acc_t>(X_row[j]) * b + c);
+  }
+}
+
+// A thread per channel: dgamma and dbeta from the channel sums.
+template <typename scalar_t, typename acc_t>
+__global__ void group_norm_backward_params_kernel(
+    int64_t N, int64_t C, int64_t group, const scalar_t* mean,
+    const scalar_t* rstd, const acc_t* ds, const acc_t* db, scalar_t* dgamma,
+    scalar_t* dbeta) {
+  const int64_t c = (int64_t)blockIdx.x * blockDim.x + threadIdx.x;
+  if (c >= C) {
+    return;
+  }
+  const int64_t g = c / (C / group);
+  acc_t dgamma_sum = 0;
+  acc_t dbeta_sum = 0;
+  for (int64_t n = 0; n < N; n++) {
+    const int64_t ng = n * group + g;
+    dgamma_sum += (ds[n * C + c] - static_cast<acc_t>(mean[ng]) * db[n * C + c]) *
+                  static_cast<acc_t>(rstd[ng]);
+    dbeta_sum += db[n * C + c];
+  }
+  if (dgamma != nullptr) {
+    dgamma[c] = static_cast<scalar_t>(dgamma_sum);
+  }
+  if (dbeta != nullptr) {
+    dbeta[c] = static_cast<scalar_t>(dbeta_sum);
+  }
+}
+
+// Threads for a block that reduces a row: enough warps to cover the row, up
+// to kMaxBlockThreads.
+int block_threads(int64_t row_size) {
+  int threads = kWarpSize;
+  while (threads < kMaxBlockThreads && threads < row_size) {
+    threads *= 2;
+  }
+  return threads;
+}
+
+template <typename scalar_t>
+const scalar_t* optional_data(const Tensor& t) {
+  return t.defined() ? t.data<scalar_t>() : nullptr;
+}
+
+template <typename scalar_t>
+scalar_t* optional_data(Tensor& t) {
+  return t.defined() ? t.data<scalar_t>() : nullptr;
+}
+
+} // anonymous namespace
+
+std::tuple<Tensor, Tensor, Tensor> layer_norm_cuda(
+    const Tensor& input, const Tensor& weight /* optional */, const Tensor& bias /* optional */,
+    int64_t M, int64_t N, double eps) {
+  Tensor X = input.contiguous();
+  Tensor Y = at::empty_like(X);
+  Tensor mean = at::empty({M}, X.options());
+  Tensor rstd = at::empty({M}, X.options());
+  if (M == 0) {
+    return std::make_tuple(Y, mean, rstd);
+  }
+  auto stream = at::cuda::getCurrentCUDAStream();
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(X.type(), "layer_norm_cuda", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    if (N <= kWarpRowMaxSize) {
+      const int64_t blocks = (M + kWarpsPerBlock - 1) / kWarpsPerBlock;
+      layer_norm_kernel<scalar_t, accscalar_t, true><<<blocks, kWarpsPerBlock * kWarpSize, 0, stream>>>(
+          M, N, static_cast<accscalar_t>(eps), X.data<scalar_t>(), optional_data<scalar_t>(weight),
+          optional_data<scalar_t>(bias), Y.data<scalar_t>(), mean.data<scalar_t>(), rstd.data<scalar_t>());
+    } else {
+      layer_norm_kernel<scalar_t, accscalar_t, false><<<M, block_threads(N), 0, stream>>>(
+          M, N, static_cast<accscalar_t>(eps), X.data<scalar_t>(), optional_data<scalar_t>(weight),
+          optional_data<scalar_t>(bias), Y.data<scalar_t>(), mean.data<scalar_t>(), rstd.data<scalar_t>());
+    }
+  });
+  AT_CUDA_CHECK(cudaGetLastError());
+  return std::make_tuple(Y, mean, rstd);
+}
+
+std::tuple<Tensor, Tensor, Tensor> layer_norm_backward_cuda(
+    const Tensor& grad_out, const Tensor& input, const Tensor& mean, const Tensor& rstd,
+    const Tensor& weight /* optional */, int64_t M, int64_t N, std::array<bool,3> output_mask) {
+  Tensor X = input.contiguous();
+  Tensor dY = grad_out.contiguous();
+  Tensor dX, dgamma, dbeta;
+  if (output_mask[0]) {
+    dX = at::empty_like(X);
+  }
+  if (M == 0) {
+    if (output_mask[1]) {
+      dgamma = at::zeros({N}, X.options());
+    }
+    if (output_mask[2]) {
+      dbeta = at::zeros({N}, X.options());
+    }
+  } else {
+    auto stream = at::cuda::getCurrentCUDAStream();
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(X.type(), "layer_norm_backward_cuda", [&] {
+      using accscalar_t = acc_type<scalar_t, true>;
+      if (dX.defined()) {
+        if (N <= kWarpRowMaxSize) {
+          const int64_t blocks = (M + kWarpsPerBlock - 1) / kWarpsPerBlock;
+          layer_norm_backward_input_kernel<scalar_t, accscalar_t, true><<<blocks, kWarpsPerBlock * kWarpSize, 0, stream>>>(
+              M, N, dY.data<scalar_t>(), X.data<scalar_t>(), mean.data<scalar_t>(), rstd.data<scalar_t>(),
+              optional_data<scalar_t>(weight), dX.data<scalar_t>());
+        } else {
+          layer_norm_backward_input_kernel<scalar_t, accscalar_t, false><<<M, block_threads(N), 0, stream>>>(
+              M, N, dY.data<scalar_t>(), X.data<scalar_t>(), mean.data<scalar_t>(), rstd.data<scalar_t>(),
+              optional_data<scalar_t>(weight), dX.data<scalar_t>());
+        }
+      }
+      if (output_mask[1] || output_mask[2]) {
+        const int64_t row_blocks = (M + kRowsPerBlock - 1) / kRowsPerBlock;
+        auto acc_options = X.options().dtype(CTypeToScalarType<accscalar_t>::to());
+        Tensor dgamma_partial = at::empty({row_blocks, N}, acc_options);
+        Tensor dbeta_partial = at::empty({row_blocks, N}, acc_options);
+        const dim3 grid((N + kColumnThreads - 1) / kColumnThreads, row_blocks);
+        const dim3 block(kColumnThreads, kRowThreads);
+        layer_norm_backward_params_kernel<scalar_t, accscalar_t><<<grid, block, 0, stream>>>(
+            M, N, dY.data<scalar_t>(), X.data<scalar_t>(), mean.data<scalar_t>(), rstd.data<scalar_t>(),
+            dgamma_partial.data<accscalar_t>(), dbeta_partial.data<accscalar_t>());
+        if (output_mask[1]) {
+          dgamma = dgamma_partial.sum(0).toType(X.type());
+        }
+        if (output_mask[2]) {
+          dbeta = dbeta_partial.sum(0).toType(X.type());
+        }
+      }
+    });
+    AT_CUDA_CHECK(cudaGetLastError());
+  }
+  if (weight.defined()) {
+    dgamma = dgamma.defined() ? dgamma.view(weight.sizes()) : dgamma;
+    dbeta = dbeta.defined() ? dbeta.view(weight.sizes()) : dbeta;
+  }
+  return std::make_tuple(dX, dgamma, dbeta);
+}
+
+std::tuple<Tensor, Tensor, Tensor> group_norm_cuda(
+    const Tensor& input, const Tensor& weight /* optional */, const Tensor& bias /* optional */,
+    int64_t N, int64_t C, int64_t HxW, int64_t group, double eps) {
+  Tensor X = input.contiguous();
+  Tensor Y = at::empty_like(X);
+  Tensor mean = at::empty({N, group}, X.options());
+  Tensor rstd = at::empty({N, group}, X.options());
+  if (N == 0) {
+    return std::make_tuple(Y, mean, rstd);
+  }
+  auto stream = at::cuda::getCurrentCUDAStream();
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(X.type(), "group_norm_cuda", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    group_norm_kernel<scalar_t, accscalar_t><<<N * group, block_threads(C / group * HxW), 0, stream>>>(
+        C, HxW, group, static_cast<accscalar_t>(eps), X.data<scalar_t>(),
+        optional_data<scalar_t>(weight), optional_data<scalar_t>(bias), Y.data<scalar_t>(),
+        mean.data<scalar_t>(), rstd.data<scalar_t>());
+  });
+  AT_CUDA_CHECK(cudaGetLastError());
+  return std::make_tuple(Y, mean, rstd);
+}
+
+std::tuple<Tensor, Tensor, Tensor> group_norm_backward_cuda(
+    const Tensor& grad_out, const Tensor& input, const Tensor& mean, const Tensor& rstd,
+    const Tensor& weight /* optional */, int64_t N, int64_t C, int64_t HxW, int64_t group,
+    std::array<bool,3> output_mask) {
+  Tensor X = input.contiguous();
+  Tensor dY = grad_out.contiguous();
+  Tensor dX, dgamma, dbeta;
+  if (output_mask[0]) {
+    dX = at::empty_like(X);
+  }
+  if (output_mask[1]) {
+    dgamma = at::zeros({C}, X.options());
+  }
+  if (output_mask[2]) {
+    dbeta = at::zeros({C}, X.options());
+  }
+  if (N == 0) {
+    return std::make_tuple(dX, dgamma, dbeta);
+  }
+  auto stream = at::cuda::getCurrentCUDAStream();
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(X.type(), "group_norm_backward_cuda", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    auto acc_options = X.options().dtype(CTypeToScalarType<accscalar_t>::to());
+    Tensor ds = at::empty({N, C}, acc_options);
+    Tensor db = at::empty({N, C}, acc_options);
+    group_norm_channel_sums_kernel<scalar_t, accscalar_t><<<N * C, block_threads(HxW), 0, stream>>>(
+        HxW, dY.data<scalar_t>(), X.data<scalar_t>(), ds.data<accscalar_t>(), db.data<accscalar_t>());
+    if (dX.defined()) {
+      group_norm_backward_input_kernel<scalar_t, accscalar_t><<<N * group, block_threads(C / group * HxW), 0, stream>>>(
+          C, HxW, group, dY.data<scalar_t>(), X.data<scalar_t>(), mean.data<scalar_t>(),
+          rstd.data<scalar_t>(), optional_data<scalar_t>(weight), ds.data<accscalar_t>(),
+          db.data<accscalar_t>(), dX.data<scalar_t>());
+    }
+    if (dgamma.defined() || dbeta.defined()) {
+      const int threads = 256;
+      group_norm_backward_params_kernel<scalar_t, accscalar_t><<<(C + threads - 1) / threads, threads, 0, stream>>>(
+          N, C, group, mean.data<scalar_t>(), rstd.data<scalar_t>(), ds.data<accscalar_t>(),
+          db.data<accscalar_t>(), optional_data<scalar_t>(dgamma), optional_data<scalar_t>(dbeta));
+    }
+  });
+  AT_CUDA_CHECK(cudaGetLastError());
+  return std::make_tuple(dX, dgamma, dbeta);
+}
+
+}} // namespace at::native
@@ -0,0 +1,402 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/detail/OffsetCalculator.cuh>
+#include <ATen/detail/FunctionTraits.h>
+#include <ATen/native/TensorIterator.h>
+#include <THC/THCDeviceUtils.cuh>
+
+#include <thrust/pair.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+// CUDA kernels for reductions built with TensorIterator::reduce_op. See
+// Note [Reductions] in TensorIterator.h and cpu/Reduce.h for the CPU
+// counterpart.
+//
+// A reduction is described by an `ops` object like on the CPU, whose member
+// functions are __device__:
+//
+//   acc_t reduce(acc_t acc, data_t data, int64_t idx)  // folds in one element
+//   acc_t combine(acc_t a, acc_t b)                    // merges two partials
+//   out_t project(acc_t acc)                           // computes the result
+//   acc_t warp_shfl_down(acc_t acc, int offset)        // WARP_SHFL_DOWN of acc
+//
+// `project` returns a thrust::pair for reductions with two outputs, such as
+// the mean and variance of Welford's algorithm.
+//
+// Each output element is reduced by a group of threads, laid out in one of
+// two ways:
+//
+// - If the reduced dimensions are the fastest striding in the input, a
+//   block's threadIdx.x run along the reduction, threadIdx.y across outputs.
+//   Contiguous inputs are read 4 elements at a time (128-bit loads for
+//   float), and the partials are combined with warp shuffles.
+// - Otherwise threadIdx.x runs across outputs, so that loads are coalesced,
+//   and threadIdx.y along the reduction, combined in shared memory.
+//
+// If there are too few outputs to fill the GPU, the reduction of every output
+// is also split across gridDim.y blocks ("split-K"). Each block writes its
+// partial result to a staging buffer, and the last one to finish combines
+// them.
+
+namespace at { namespace native {
+
+namespace reduce_detail {
+
+constexpr int kMaxThreads = 512;
+constexpr int kWarpSize = 32;
+// elements loaded at once by the vectorized inner loop
+constexpr int kVectorSize = 4;
+
+template <typename scalar_t, int vec_size>
+struct alignas(sizeof(scalar_t) * vec_size) aligned_vector {
+  scalar_t val[vec_size];
+};
+
+inline int last_pow2(int n) {
+  n |= (n >> 1);
+  n |= (n >> 2);
+  n |= (n >> 4);
+  n |= (n >> 8);
+  n |= (n >> 16);
+  return std::max(1, n - (n >> 1));
+}
+
+template <typename out_t>
+struct num_outputs {
+  static constexpr int value = 1;
+};
+
+template <typename T1, typename T2>
+struct num_outputs<thrust::pair<T1, T2>> {
+  static constexpr int value = 2;
+};
+
+template <typename out_t, typename offsets_t>
+__device__ __forceinline__ void set_results(const out_t& result, char* const* dst, offsets_t offsets) {
+  *(out_t*)(dst[0] + offsets[0]) = result;
+}
+
+template <typename T1, typename T2, typename offsets_t>
+__device__ __forceinline__ void set_results(
+    const thrust::pair<T1, T2>& result, char* const* dst, offsets_t offsets) {
+  *(T1*)(dst[0] + offsets[0]) = result.first;
+  *(T2*)(dst[1] + offsets[1]) = result.second;
+}
+
+struct ReduceConfig {
+  int num_inputs;   // per output element
+  int num_outputs;
+  // whether threadIdx.x runs along the reduction (see above)
+  bool reduce_along_x;
+  bool vectorize = false;
+  int ctas_per_output = 1;
+  dim3 block;
+  dim3 grid;
+
+  __host__ __device__ int reduce_threads() const {
+    return reduce_along_x ? block.x : block.y;
+  }
+
+  __device__ int output_idx() const {
+    return reduce_along_x
+        ? blockIdx.x * blockDim.y + threadIdx.y
+        : blockIdx.x * blockDim.x + threadIdx.x;
+  }
+
+  // The first input index of this thread, and the step to the next one.
+  __device__ int input_idx() const {
+    return reduce_along_x
+        ? blockIdx.y * blockDim.x + threadIdx.x
+        : blockIdx.y * blockDim.y + threadIdx.y;
+  }
+
+  __device__ int input_step() const {
+    return reduce_along_x ? blockDim.x * gridDim.y : blockDim.y * gridDim.y;
+  }
+
+  // the thread that writes an output element
+  __device__ bool is_leader() const {
+    return reduce_along_x ? threadIdx.x == 0 : threadIdx.y == 0;
+  }
+};
+
+template <typename scalar_t, typename ops_t, typename acc_t, typename out_t, int NOUT>
+struct ReduceOp {
+  using offsets_t = typename OffsetCalculator<NOUT + 1>::offsets_t;
+
+  ops_t ops;
+  acc_t ident;
+  ReduceConfig config;
+  // offsets of the reduced elements, relative to the first one
+  OffsetCalculator<1> input_calc;
+  // offsets of the output elements, and of the first input element reduced
+  // into each
+  OffsetCalculator<NOUT + 1> output_calc;
+  const char* src;
+  char* dst[NOUT];
+  // split-K staging buffer (num_outputs x ctas_per_output) and per-block
+  // completion counters
+  acc_t* staging;
+  int* semaphores;
+
+  __device__ void run() const {
+    extern __shared__ char shared_memory[];
+    const int output_idx = config.output_idx();
+    const bool valid = output_idx < config.num_outputs;
+    offsets_t offsets = output_calc.get(valid ? output_idx : 0);
+
+    acc_t value = ident;
+    if (valid) {
+      const char* input = src + offsets[NOUT];
+      value = config.vectorize
+          ? vectorized_thread_reduce(reinterpret_cast<const scalar_t*>(input))
+          : thread_reduce(input);
+    }
+    value = config.reduce_along_x
+        ? block_x_reduce(value, shared_memory)
+        : block_y_reduce(value, shared_memory);
+
+    if (config.ctas_per_output > 1) {
+      if (config.is_leader() && valid) {
+        staging[output_idx * config.ctas_per_output + blockIdx.y] = value;
+      }
+      __threadfence();
+      if (!mark_block_finished()) {
+        return;
+      }
+      // the last block of this output combines all the partial results
+      value = ident;
+      const int start = config.reduce_along_x ? threadIdx.x : threadIdx.y;
+      const int step = config.reduce_threads();
+      if (valid) {
+        for (int i = start; i < config.ctas_per_output; i += step) {
+          value = ops.combine(value, staging[output_idx * config.ctas_per_output + i]);
+        }
+      }
+      value = config.reduce_along_x
+          ? block_x_reduce(value, shared_memory)
+          : block_y_reduce(value, shared_memory);
+    }
+
+    if (config.is_leader() && valid) {
+      set_results(ops.project(value), dst, offsets);
+    }
+  }
+
+  __device__ acc_t thread_reduce(const char* input) const {
+    acc_t value = ident;
+    for (int idx = config.input_idx(); idx < config.num_inputs; idx += config.input_step()) {
+      const auto offset = input_calc.get(idx)[0];
+      value = ops.reduce(value, *reinterpret_cast<const scalar_t*>(input + offset), idx);
+    }
+    return value;
+  }
+
+  // For contiguous reductions: reads kVectorSize elements at a time into as
+  // many independent accumulators. The elements before the first aligned
+  // address and after the last full vector are read one at a time.
+  __device__ acc_t vectorized_thread_reduce(const scalar_t* input) const {
+    using vec_t = aligned_vector<scalar_t, kVectorSize>;
+    const int start = config.input_idx();
+    const int step = config.input_step();
+    const int end = config.num_inputs;
+
+    acc_t values[kVectorSize];
+    #pragma unroll
+    for (int j = 0; j < kVectorSize; j++) {
+      values[j] = ident;
+    }
+
+    const int misalignment =
+        (reinterpret_cast<uintptr_t>(input) / sizeof(scalar_t)) % kVectorSize;
+    const int head = misalignment == 0 ? 0 : min(kVectorSize - misalignment, end);
+    for (int idx = start; idx < head; idx += step) {
+      values[0] = ops.reduce(values[0], input[idx], idx);
+    }
+
+    const vec_t* vectors = reinterpret_cast<const vec_t*>(input + head);
+    const int num_vectors = (end - head) / kVectorSize;
+    for (int v = start; v < num_vectors; v += step) {
+      vec_t vec = vectors[v];
+      const int base = head + v * kVectorSize;
+      #pragma unroll
+      for (int j = 0; j < kVectorSize; j++) {
+        values[j] = ops.reduce(values[j], vec.val[j], base + j);
+      }
+    }
+
+    for (int idx = head + num_vectors * kVectorSize + start; idx < end; idx += step) {
+      values[0] = ops.reduce(values[0], input[idx], idx);
+    }
+
+    #pragma unroll
+    for (int j = 1; j < kVectorSize; j++) {
+      values[0] = ops.combine(values[0], values[j]);
+    }
+    return values[0];
+  }
+
+  // Combines the partials along threadIdx.x into threadIdx.x == 0: in shared
+  // memory down to a warp, then with warp shuffles. blockDim.x is a power of
+  // two, so the threads of an output never straddle warps.
+  __device__ acc_t block_x_reduce(acc_t value, char* shared_memory) const {
+    int dim_x = blockDim.x;
+    acc_t* shared = reinterpret_cast<acc_t*>(shared_memory);
+    if (dim_x > kWarpSize) {
+      const int address = threadIdx.x + threadIdx.y * blockDim.x;
+      shared[address] = value;
+      for (int offset = dim_x / 2; offset >= kWarpSize; offset /= 2) {
+        __syncthreads();
+        if (threadIdx.x < offset) {
+          value = ops.combine(value, shared[address + offset]);
+          shared[address] = value;
+        }
+      }
+      dim_x = kWarpSize;
+    }
+    __syncthreads();
+    for (int offset = 1; offset < dim_x; offset *= 2) {
+      acc_t other = ops.warp_shfl_down(value, offset);
+      value = ops.combine(value, other);
+    }
+    return value;
+  }
+
+  // Combines the partials along threadIdx.y into threadIdx.y == 0.
+  __device__ acc_t block_y_reduce(acc_t value, char* shared_memory) const {
+    acc_t* shared = reinterpret_cast<acc_t*>(shared_memory);
+    const int address = threadIdx.x + threadIdx.y * blockDim.x;
+    shared[address] = value;
+    for (int offset = blockDim.y / 2; offset > 0; offset /= 2) {
+      __syncthreads();
+      if (threadIdx.y < offset) {
+        value = ops.combine(value, shared[address + offset * blockDim.x]);
+        shared[address] = value;
+      }
+    }
+    __syncthreads();
+    return value;
+  }
+
+  // Returns true in every thread of the last block to finish its part of the
+  // outputs of blockIdx.x.
+  __device__ bool mark_block_finished() const {
+    __shared__ bool is_last_block_done;
+    __syncthreads();
+    if (threadIdx.x == 0 && threadIdx.y == 0) {
+      int prev_blocks_finished = atomicAdd(&semaphores[blockIdx.x], 1);
+      is_last_block_done = prev_blocks_finished == gridDim.y - 1;
+    }
+    __syncthreads();
+    return is_last_block_done;
+  }
+};
+
+template <int nt, typename R>
+__launch_bounds__(nt, 4)
+__global__ void reduce_kernel(R reduction) {
+  reduction.run();
+}
+
+template <typename scalar_t>
+ReduceConfig make_config(const TensorIterator& iter, int num_reduce_dims) {
+  ReduceConfig config;
+  config.num_outputs = iter.num_output_elements();
+  config.num_inputs = iter.numel() / config.num_outputs;
+
+  const int input_arg = iter.noutputs();
+  auto input_strides = iter.strides(input_arg);
+  config.reduce_along_x = num_reduce_dims > 0 &&
+      (num_reduce_dims == iter.ndim() ||
+       input_strides[0] < input_strides[num_reduce_dims]);
+
+  const int dim0 = config.reduce_along_x ? config.num_inputs : config.num_outputs;
+  const int dim1 = config.reduce_along_x ? config.num_outputs : config.num_inputs;
+  int block_width = std::min(last_pow2(dim0), kWarpSize);
+  int block_height = std::min(last_pow2(dim1), kMaxThreads / block_width);
+  block_width = std::min(last_pow2(dim0), kMaxThreads / block_height);
+  config.block = dim3(block_width, block_height);
+
+  const int outputs_per_block = config.reduce_along_x ? block_height : block_width;
+  config.grid = dim3((config.num_outputs + outputs_per_block - 1) / outputs_per_block);
+
+  // Split the reduction of each output across blocks if there are few
+  // outputs but many values per thread.
+  const int values_per_thread =
+      (config.num_inputs + config.reduce_threads() - 1) / config.reduce_threads();
+  const int target_grid_size =
+      at::cuda::getCurrentDeviceProperties()->multiProcessorCount * 4;
+  if (values_per_thread >= 256 && (int)config.grid.x < target_grid_size) {
+    config.ctas_per_output = std::min(
+        (values_per_thread + 15) / 16,
+        (target_grid_size + (int)config.grid.x - 1) / (int)config.grid.x);
+    config.ctas_per_output = std::min(config.ctas_per_output, 65535);
+    config.grid.y = config.ctas_per_output;
+  }
+
+  config.vectorize = config.reduce_along_x && num_reduce_dims == 1 &&
+      input_strides[0] == sizeof(scalar_t) &&
+      config.num_inputs >= kVectorSize * block_width;
+  return config;
+}
+
+} // namespace reduce_detail
+
+// Runs the reduction described by `ops` on `iter`, which must have been built
+// with TensorIterator::reduce_op, have at least one element and use 32-bit
+// indexing. `ident` is the initial value of every accumulator.
+template <typename scalar_t, typename ops_t, typename ident_t>
+void gpu_reduce_kernel(TensorIterator& iter, const ops_t& ops, ident_t ident) {
+  using namespace reduce_detail;
+  using traits = function_traits<decltype(&ops_t::reduce)>;
+  using acc_t = typename traits::result_type;
+  using out_t = typename function_traits<decltype(&ops_t::project)>::result_type;
+  constexpr int NOUT = num_outputs<out_t>::value;
+  using reduce_op_t = ReduceOp<scalar_t, ops_t, acc_t, out_t, NOUT>;
+
+  AT_ASSERT(iter.is_reduction() && iter.noutputs() == NOUT && iter.ntensors() == NOUT + 1);
+  AT_ASSERT(iter.numel() > 0 && iter.can_use_32bit_indexing());
+
+  const int num_reduce_dims = iter.num_reduce_dims();
+  ReduceConfig config = make_config<scalar_t>(iter, num_reduce_dims);
+
+  // the reduced dimensions come first, see Note [Reductions]
+  auto shape = iter.shape();
+  std::array<const int64_t*, 1> input_strides = {{iter.strides(NOUT).data()}};
+  OffsetCalculator<1> input_calc(num_reduce_dims, shape.data(), input_strides.data());
+  std::array<const int64_t*, NOUT + 1> output_strides;
+  for (int arg = 0; arg <= NOUT; arg++) {
+    output_strides[arg] = iter.strides(arg).data() + num_reduce_dims;
+  }
+  OffsetCalculator<NOUT + 1> output_calc(
+      iter.ndim() - num_reduce_dims, shape.data() + num_reduce_dims, output_strides.data());
+
+  reduce_op_t reduction{ops, acc_t(ident), config, input_calc, output_calc,
+                        (const char*)iter.data_ptr(NOUT), {}, nullptr, nullptr};
+  for (int arg = 0; arg < NOUT; arg++) {
+    reduction.dst[arg] = (char*)iter.data_ptr(arg);
+  }
+
+  Tensor staging, semaphores;
+  if (config.ctas_per_output > 1) {
+    auto options = iter.output(0).options();
+    staging = at::empty(
+        {(int64_t)config.num_outputs * config.ctas_per_output * (int64_t)sizeof(acc_t)},
+        options.dtype(kByte));
+    semaphores = at::zeros({(int64_t)config.grid.x}, options.dtype(kInt));
+    reduction.staging = reinterpret_cast<acc_t*>(staging.data_ptr());
+    reduction.semaphores = semaphores.data<int>();
+  }
+
+  const int shared_memory = config.block.x * config.block.y * sizeof(acc_t);
+  auto stream = at::cuda::getCurrentCUDAStream();
+  reduce_kernel<kMaxThreads, reduce_op_t><<<config.grid, config.block, shared_memory, stream>>>(reduction);
+  AT_CUDA_CHECK(cudaGetLastError());
+}
+
+}} // namespace at::native
@@ -0,0 +1,152 @@
+#include <ATen/AccumulateType.h>
+#include <ATen/Dispatch.h>
+#include <ATen/native/DispatchStub.h>
+#include <ATen/native/TensorIterator.h>
+#include <ATen/native/cpu/ReduceOpsKernel.h>
+#include <ATen/native/cuda/Reduce.cuh>
+
+// CUDA kernels for the TensorIterator reductions; see Reduce.cuh.
+
+namespace at { namespace native {
+
+template <typename scalar_t, typename acc_t>
+struct SumOps {
+  __device__ acc_t reduce(acc_t acc, scalar_t data, int64_t /*idx*/) const {
+    return acc + static_cast<acc_t>(data);
+  }
+  __device__ acc_t combine(acc_t a, acc_t b) const {
+    return a + b;
+  }
+  __device__ scalar_t project(acc_t acc) const {
+    return static_cast<scalar_t>(acc);
+  }
+  __device__ acc_t warp_shfl_down(acc_t acc, int offset) const {
+    return WARP_SHFL_DOWN(acc, offset);
+  }
+};
+
+template <typename scalar_t, typename acc_t>
+struct ProdOps {
+  __device__ acc_t reduce(acc_t acc, scalar_t data, int64_t /*idx*/) const {
+    return acc * static_cast<acc_t>(data);
+  }
+  __device__ acc_t combine(acc_t a, acc_t b) const {
+    return a * b;
+  }
+  __device__ scalar_t project(acc_t acc) const {
+    return static_cast<scalar_t>(acc);
+  }
+  __device__ acc_t warp_shfl_down(acc_t acc, int offset) const {
+    return WARP_SHFL_DOWN(acc, offset);
+  }
+};
+
+// The CUDA kernels index with 32 bits, so the count fits in an int.
+template <typename acc_scalar_t>
+struct WelfordData {
+  acc_scalar_t mean;
+  acc_scalar_t m2;
+  int n;
+};
+
+// Same as the CPU WelfordOps in cpu/ReduceOpsKernel.cpp.
+template <typename scalar_t, typename acc_scalar_t>
+struct WelfordOps {
+  using acc_t = WelfordData<acc_scalar_t>;
+  bool unbiased;
+  bool take_sqrt;
+
+  __device__ acc_t reduce(acc_t acc, scalar_t data, int64_t /*idx*/) const {
+    acc_scalar_t value = static_cast<acc_scalar_t>(data);
+    acc_scalar_t delta = value - acc.mean;
+    acc.n++;
+    acc.mean += delta / acc.n;
+    acc.m2 += delta * (value - acc.mean);
+    return acc;
+  }
+
+  __device__ acc_t combine(acc_t a, acc_t b) const {
+    if (a.n == 0) {
+      return b;
+    }
+    if (b.n == 0) {
+      return a;
+    }
+    acc_t result;
+    acc_scalar_t delta = b.mean - a.mean;
+    result.n = a.n + b.n;
+    acc_scalar_t nb_over_n = (acc_scalar_t)b.n / result.n;
+    result.mean = a.mean + delta * nb_over_n;
+    result.m2 = a.m2 + b.m2 + delta * delta * a.n * nb_over_n;
+    return result;
+  }
+
+  __device__ acc_scalar_t std_var(acc_t acc) const {
+    int divisor = unbiased ? acc.n - 1 : acc.n;
+    acc_scalar_t var = acc.m2 / divisor;
+    return take_sqrt ? ::sqrt(var) : var;
+  }
+
+  __device__ scalar_t project(acc_t acc) const {
+    return static_cast<scalar_t>(std_var(acc));
+  }
+
+  __device__ acc_t warp_shfl_down(acc_t acc, int offset) const {
+    return {
+      WARP_SHFL_DOWN(acc.mean, offset),
+      WARP_SHFL_DOWN(acc.m2, offset),
+      WARP_SHFL_DOWN(acc.n, offset)
+    };
+  }
+};
+
+// Like WelfordOps, with the mean as a second output (var_mean, std_mean).
+template <typename scalar_t, typename acc_scalar_t>
+struct WelfordMeanOps : public WelfordOps<scalar_t, acc_scalar_t> {
+  using acc_t = WelfordData<acc_scalar_t>;
+
+  WelfordMeanOps(bool unbiased, bool take_sqrt)
+    : WelfordOps<scalar_t, acc_scalar_t>{unbiased, take_sqrt} {}
+
+  __device__ thrust::pair<scalar_t, scalar_t> project(acc_t acc) const {
+    return thrust::pair<scalar_t, scalar_t>(
+        static_cast<scalar_t>(this->std_var(acc)), static_cast<scalar_t>(acc.mean));
+  }
+};
+
+static void sum_kernel_cuda(TensorIterator& iter) {
+  AT_DISPATCH_ALL_TYPES_AND_HALF(iter.type(), "sum", [&]() {
+    using accscalar_t = acc_type<scalar_t, true>;
+    gpu_reduce_kernel<scalar_t>(iter, SumOps<scalar_t, accscalar_t>(), accscalar_t(0));
+  });
+}
+
+static void prod_kernel_cuda(TensorIterator& iter) {
+  AT_DISPATCH_ALL_TYPES_AND_HALF(iter.type(), "prod", [&]() {
+    using accscalar_t = acc_type<scalar_t, true>;
+    gpu_reduce_kernel<scalar_t>(iter, ProdOps<scalar_t, accscalar_t>(), accscalar_t(1));
+  });
+}
+
+static void std_var_kernel_cuda(TensorIterator& iter, bool unbiased, bool take_sqrt) {
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(iter.type(), "std", [&]() {
+    using accscalar_t = acc_type<scalar_t, true>;
+    if (iter.noutputs() == 2) {
+      gpu_reduce_kernel<scalar_t>(
+          iter,
+          WelfordMeanOps<scalar_t, accscalar_t>(unbiased, take_sqrt),
+          WelfordData<accscalar_t> { 0, 0, 0 });
+    } else {
+      gpu_reduce_kernel<scalar_t>(
+          iter,
+          WelfordOps<scalar_t, accscalar_t> { unbiased, take_sqrt },
+          WelfordData<accscalar_t> { 0, 0, 0 });
+    }
+  });
+}
+
+REGISTER_DISPATCH(sum_iter_stub, &sum_kernel_cuda);
+REGISTER_DISPATCH(prod_iter_stub, &prod_kernel_cuda);
+REGISTER_DISPATCH(std_var_stub, &std_var_kernel_cuda);
+
+}} // namespace at::native
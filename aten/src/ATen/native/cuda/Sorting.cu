@@ -0,0 +1,402 @@
+// CUDA sort and topk along a dimension.
+//
+// Like the CPU versions, these move the dimension to the end and work on
+// contiguous rows, picking the algorithm by the row length and count:
+//
+// - sort: rows of up to 2048 elements use THC's in-place bitonic sort, which
+//   sorts every row in one launch. Longer rows are radix sorted by cub, as a
+//   single segmented sort over all rows (or a device-wide sort if there is
+//   only one), instead of THC's two full-tensor thrust sorts.
+// - topk: for k < 512, each row is scanned once by a block of warp-private
+//   heaps in shared memory, which are merged with a bitonic sort, so the
+//   result comes out sorted. Larger k use THC's radix selection, with the
+//   selected values sorted by the segmented sort above.
+
+#include "ATen/ATen.h"
+#include "ATen/Dispatch.h"
+#include "ATen/WrapDimUtils.h"
+#include "ATen/cuda/CUDAContext.h"
+
+#include <THC/THCAsmUtils.cuh>
+#include <THC/THCDeviceUtils.cuh>
+
+#ifndef __HIP_PLATFORM_HCC__
+#include <cub/device/device_radix_sort.cuh>
+#include <cub/device/device_segmented_radix_sort.cuh>
+#include <cub/iterator/counting_input_iterator.cuh>
+#include <cub/iterator/transform_input_iterator.cuh>
+#endif
+
+#include <limits>
+#include <tuple>
+
+namespace at { namespace native {
+
+#ifndef __HIP_PLATFORM_HCC__
+
+namespace {
+
+// Rows up to this long are sorted in place by THC's bitonic sort.
+constexpr int64_t kMaxBitonicSortSize = 2048;
+// topk with k below this uses heap selection.
+constexpr int64_t kMaxHeapSelectK = 512;
+constexpr int kHeapSelectThreads = 128;
+
+// Maps values to unsigned integers that compare the same way, with NaN the
+// largest, like RadixKey in SortingUtils.h.
+template <typename scalar_t>
+struct TopKKey {};
+
+template <>
+struct TopKKey<uint8_t> {
+  using type = uint32_t;
+  static __device__ __forceinline__ type encode(uint8_t v) {
+    return v;
+  }
+};
+
+template <typename signed_t>
+struct SignedTopKKey {
+  using type = uint32_t;
+  static __device__ __forceinline__ type encode(signed_t v) {
+    return static_cast<uint32_t>(static_cast<int32_t>(v)) ^ 0x80000000u;
+  }
+};
+
+template <> struct TopKKey<int8_t> : SignedTopKKey<int8_t> {};
+template <> struct TopKKey<int16_t> : SignedTopKKey<int16_t> {};
+template <> struct TopKKey<int32_t> : SignedTopKKey<int32_t> {};
+
+template <>
+struct TopKKey<int64_t> {
+  using type = uint64_t;
+  static __device__ __forceinline__ type encode(int64_t v) {
+    return static_cast<uint64_t>(v) ^ (1ull << 63);
+  }
+};
+
+template <>
+struct TopKKey<float> {
+  using type = uint32_t;
+  static __device__ __forceinline__ type encode(float v) {
+    if (v != v) {
+      return 0xffffffffu;
+    }
+    uint32_t x = __float_as_uint(v);
+    return (x & 0x80000000u) ? ~x : (x | 0x80000000u);
+  }
+};
+
+template <>
+struct TopKKey<double> {
+  using type = uint64_t;
+  static __device__ __forceinline__ type encode(double v) {
+    if (v != v) {
+      return ~0ull;
+    }
+    uint64_t x = static_cast<uint64_t>(__double_as_longlong(v));
+    return (x & (1ull << 63)) ? ~x : (x | (1ull << 63));
+  }
+};
+
+// Selection always keeps the smallest keys (largest values are selected by
+// flipping the keys), with ties going to the smaller index.
+template <typename key_t>
+__device__ __forceinline__ bool better(key_t ka, int64_t ia, key_t kb, int64_t ib) {
+  return ka < kb || (ka == kb && ia < ib);
+}
+
+// Offers (k, i) to a warp's heap of the HeapSize - 1 best entries seen so far,
+// whose root is the worst of them. The last slot is never used, so the heaps
+// can later be sorted together as a power of two.
+template <typename key_t, int HeapSize>
+__device__ __forceinline__ void heapInsert(key_t k, int64_t i, key_t* keys, int64_t* indices) {
+  // a lane that went before us may have made the root better than us
+  if (!better(k, i, keys[0], indices[0])) {
+    return;
+  }
+  int pos = 0;
+  while (true) {
+    int left = 2 * pos + 1;
+    int right = left + 1;
+    if (left >= HeapSize - 1) {
+      break;
+    }
+    // the worse child, if it is worse than us, moves up
+    int child = left;
+    if (right < HeapSize - 1 && better(keys[left], indices[left], keys[right], indices[right])) {
+      child = right;
+    }
+    if (!better(k, i, keys[child], indices[child])) {
+      break;
+    }
+    keys[pos] = keys[child];
+    indices[pos] = indices[child];
+    pos = child;
+  }
+  keys[pos] = k;
+  indices[pos] = i;
+}
+
+// One block per row. Each warp keeps a heap of the best entries of the
+// elements it reads; lanes that beat the root take turns inserting.
+template <typename scalar_t, int HeapSize>
+__global__ void heapSelectKernel(
+    const scalar_t* input, scalar_t* values, int64_t* indices,
+    int64_t n, int64_t k, bool largest) {
+  using key_t = typename TopKKey<scalar_t>::type;
+  constexpr int kWarps = kHeapSelectThreads / 32;
+  constexpr int kEntries = kWarps * HeapSize;
+  constexpr key_t kWorstKey = ~key_t(0);
+  constexpr int64_t kWorstIndex = INT64_MAX;
+
+  extern __shared__ char smem[];
+  int64_t* heap_indices = reinterpret_cast<int64_t*>(smem);
+  key_t* heap_keys = reinterpret_cast<key_t*>(heap_indices + kEntries);
+
+  const int warp = threadIdx.x / 32;
+  const int lane = getLaneId();
+  key_t* keys = heap_keys + warp * HeapSize;
+  int64_t* idx = heap_indices + warp * HeapSize;
+  for (int i = lane; i < HeapSize; i += 32) {
+    keys[i] = kWorstKey;
+    idx[i] = kWorstIndex;
+  }
+  __syncthreads();
+
+  const scalar_t* row = input + blockIdx.x * n;
+  key_t root_key = kWorstKey;
+  int64_t root_index = kWorstIndex;
+  // every lane runs the same number of iterations, so the ballots below see
+  // the whole warp
+  for (int64_t base = 0; base < n; base += blockDim.x) {
+    const int64_t i = base + threadIdx.x;
+    key_t key = kWorstKey;
+    if (i < n) {
+      key = TopKKey<scalar_t>::encode(row[i]);
+      key = largest ? static_cast<key_t>(~key) : key;
+    }
+    bool want = i < n && better(key, i, root_key, root_index);
+    unsigned vote = WARP_BALLOT(want);
+    if (!vote) {
+      continue;
+    }
+    const int rank = __popc(getLaneMaskLt() & vote);
+    const int total = __popc(vote);
+    for (int turn = 0; turn < total; turn++) {
+      if (want && rank == turn) {
+        heapInsert<key_t, HeapSize>(key, i, keys, idx);
+        __threadfence_block();
+      }
+#if CUDA_VERSION >= 9000
+      __syncwarp();
+#endif
+    }
+    root_key = keys[0];
+    root_index = idx[0];
+  }
+  __syncthreads();
+
+  // Bitonic sort of all the heaps, best first. Unused slots hold the worst
+  // entry, so they sort last.
+  for (int size = 2; size <= kEntries; size *= 2) {
+    for (int stride = size / 2; stride > 0; stride /= 2) {
+      for (int t = threadIdx.x; t < kEntries / 2; t += blockDim.x) {
+        const int a = 2 * t - (t & (stride - 1));
+        const int b = a + stride;
+        const bool ascending = (a & size) == 0;
+        if (better(heap_keys[b], heap_indices[b], heap_keys[a], heap_indices[a]) == ascending) {
+          key_t tk = heap_keys[a];
+          heap_keys[a] = heap_keys[b];
+          heap_keys[b] = tk;
+          int64_t ti = heap_indices[a];
+          heap_indices[a] = heap_indices[b];
+          heap_indices[b] = ti;
+        }
+      }
+      __syncthreads();
+    }
+  }
+
+  for (int64_t i = threadIdx.x; i < k; i += blockDim.x) {
+    const int64_t index = heap_indices[i];
+    indices[blockIdx.x * k + i] = index;
+    values[blockIdx.x * k + i] = row[index];
+  }
+}
+
+template <int HeapSize>
+void launchHeapSelect(const Tensor& input, Tensor& values, Tensor& indices, int64_t k, bool largest) {
+  const int64_t n = input.size(-1);
+  const int64_t rows = input.numel() / n;
+  auto stream = at::cuda::getCurrentCUDAStream();
+  AT_DISPATCH_ALL_TYPES(input.type(), "topk", [&] {
+    using key_t = typename TopKKey<scalar_t>::type;
+    const size_t smem = (kHeapSelectThreads / 32) * HeapSize * (sizeof(int64_t) + sizeof(key_t));
+    heapSelectKernel<scalar_t, HeapSize><<<rows, kHeapSelectThreads, smem, stream>>>(
+        input.data<scalar_t>(), values.data<scalar_t>(), indices.data<int64_t>(),
+        n, k, largest);
+  });
+  AT_CUDA_CHECK(cudaGetLastError());
+}
+
+__global__ void fillSegmentIndicesKernel(int64_t* indices, int64_t n, int64_t total) {
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < total; i += blockDim.x * gridDim.x) {
+    indices[i] = i % n;
+  }
+}
+
+struct SegmentOffset {
+  int n;
+  __host__ __device__ __forceinline__ int operator()(int segment) const {
+    return segment * n;
+  }
+};
+
+// Sorts the rows of the contiguous input with cub, writing into the
+// contiguous values and indices, which must not alias the input.
+void segmentedSort(const Tensor& input, Tensor& values, Tensor& indices, bool descending) {
+  const int n = static_cast<int>(input.size(-1));
+  const int total = static_cast<int>(input.numel());
+  const int rows = total / n;
+  auto stream = at::cuda::getCurrentCUDAStream();
+
+  Tensor index_keys = at::empty(input.sizes(), indices.options());
+  int64_t* index_keys_data = index_keys.data<int64_t>();
+  const int threads = 256;
+  const int blocks = std::min<int64_t>((total + threads - 1) / threads, 4096);
+  fillSegmentIndicesKernel<<<blocks, threads, 0, stream>>>(index_keys_data, n, total);
+  AT_CUDA_CHECK(cudaGetLastError());
+
+  cub::CountingInputIterator<int> counting(0);
+  cub::TransformInputIterator<int, SegmentOffset, cub::CountingInputIterator<int>>
+      offsets(counting, SegmentOffset{n});
+
+  AT_DISPATCH_ALL_TYPES(input.type(), "sort", [&] {
+    const scalar_t* keys_in = input.data<scalar_t>();
+    scalar_t* keys_out = values.data<scalar_t>();
+    int64_t* indices_out = indices.data<int64_t>();
+    // The first call only computes the scratch space needed.
+    auto run = [&](void* scratch, size_t& scratch_bytes) {
+      if (rows == 1) {
+        return descending
+            ? cub::DeviceRadixSort::SortPairsDescending(
+                  scratch, scratch_bytes, keys_in, keys_out, index_keys_data, indices_out,
+                  total, 0, sizeof(scalar_t) * 8, stream)
+            : cub::DeviceRadixSort::SortPairs(
+                  scratch, scratch_bytes, keys_in, keys_out, index_keys_data, indices_out,
+                  total, 0, sizeof(scalar_t) * 8, stream);
+      }
+      return descending
+          ? cub::DeviceSegmentedRadixSort::SortPairsDescending(
+                scratch, scratch_bytes, keys_in, keys_out, index_keys_data, indices_out,
+                total, rows, offsets, offsets + 1, 0, sizeof(scalar_t) * 8, stream)
+          : cub::DeviceSegmentedRadixSort::SortPairs(
+                scratch, scratch_bytes, keys_in, keys_out, index_keys_data, indices_out,
+                total, rows, offsets, offsets + 1, 0, sizeof(scalar_t) * 8, stream);
+    };
+    size_t scratch_bytes = 0;
+    AT_CUDA_CHECK(run(nullptr, scratch_bytes));
+    Tensor scratch = at::empty({static_cast<int64_t>(scratch_bytes)}, input.options().dtype(kByte));
+    AT_CUDA_CHECK(run(scratch.data_ptr(), scratch_bytes));
+  });
+}
+
+bool can_write_directly(const Tensor& self, int64_t dim, const Tensor& values, const Tensor& indices) {
+  return dim == self.dim() - 1 && values.is_contiguous() && indices.is_contiguous();
+}
+
+} // anonymous namespace
+
+#endif
+
+std::tuple<Tensor&, Tensor&> sort_out_cuda(Tensor& values, Tensor& indices,
+                                           const Tensor& self, int64_t dim, bool descending) {
+#ifndef __HIP_PLATFORM_HCC__
+  if (self.dim() > 0 && self.type().scalarType() != kHalf &&
+      self.size(maybe_wrap_dim(dim, self.dim())) > kMaxBitonicSortSize &&
+      self.numel() <= std::numeric_limits<int>::max()) {
+    dim = maybe_wrap_dim(dim, self.dim());
+    values.resize_(self.sizes());
+    indices.resize_(self.sizes());
+    Tensor input = self.transpose(dim, -1).contiguous();
+    const bool direct = can_write_directly(self, dim, values, indices);
+    if (direct && input.data_ptr() == values.data_ptr()) {
+      // cub can't sort in place
+      input = input.clone();
+    }
+    Tensor values_buf = direct ? values : at::empty(input.sizes(), values.options());
+    Tensor indices_buf = direct ? indices : at::empty(input.sizes(), indices.options());
+    segmentedSort(input, values_buf, indices_buf, descending);
+    if (!direct) {
+      values.transpose(dim, -1).copy_(values_buf);
+      indices.transpose(dim, -1).copy_(indices_buf);
+    }
+    return std::forward_as_tuple(values, indices);
+  }
+#endif
+  return at::_th_sort_out(values, indices, self, dim, descending);
+}
+
+std::tuple<Tensor, Tensor> sort_cuda(const Tensor& self, int64_t dim, bool descending) {
+  Tensor values = at::empty({0}, self.options());
+  Tensor indices = at::empty({0}, self.options().dtype(kLong));
+  return at::native::sort_out_cuda(values, indices, self, dim, descending);
+}
+
+std::tuple<Tensor&, Tensor&> topk_out_cuda(Tensor& values, Tensor& indices,
+                                           const Tensor& self, int64_t k, int64_t dim,
+                                           bool largest, bool sorted) {
+#ifndef __HIP_PLATFORM_HCC__
+  if (self.dim() > 0 && self.type().scalarType() != kHalf) {
+    dim = maybe_wrap_dim(dim, self.dim());
+    AT_CHECK(k >= 0 && k <= self.size(dim), "selected index k out of range");
+    auto result_sizes = self.sizes().vec();
+    result_sizes[dim] = k;
+    values.resize_(result_sizes);
+    indices.resize_(result_sizes);
+    if (values.numel() == 0) {
+      return std::forward_as_tuple(values, indices);
+    }
+    if (k < kMaxHeapSelectK) {
+      Tensor input = self.transpose(dim, -1).contiguous();
+      auto buf_sizes = input.sizes().vec();
+      buf_sizes.back() = k;
+      const bool direct = can_write_directly(self, dim, values, indices);
+      Tensor values_buf = direct ? values : at::empty(buf_sizes, values.options());
+      Tensor indices_buf = direct ? indices : at::empty(buf_sizes, indices.options());
+      if (k < 32) {
+        launchHeapSelect<32>(input, values_buf, indices_buf, k, largest);
+      } else if (k < 128) {
+        launchHeapSelect<128>(input, values_buf, indices_buf, k, largest);
+      } else {
+        launchHeapSelect<512>(input, values_buf, indices_buf, k, largest);
+      }
+      if (!direct) {
+        values.transpose(dim, -1).copy_(values_buf);
+        indices.transpose(dim, -1).copy_(indices_buf);
+      }
+      return std::forward_as_tuple(values, indices);
+    }
+    if (sorted && k > kMaxBitonicSortSize) {
+      // THC would sort the selection with two full thrust sorts
+      at::_th_topk_out(values, indices, self, k, dim, largest, false);
+      Tensor sorted_values, order;
+      std::tie(sorted_values, order) = at::native::sort_cuda(values, dim, largest);
+      values.copy_(sorted_values);
+      indices.copy_(indices.gather(dim, order));
+      return std::forward_as_tuple(values, indices);
+    }
+  }
+#endif
+  return at::_th_topk_out(values, indices, self, k, dim, largest, sorted);
+}
+
+std::tuple<Tensor, Tensor> topk_cuda(const Tensor& self, int64_t k, int64_t dim,
+                                     bool largest, bool sorted) {
+  Tensor values = at::empty({0}, self.options());
+  Tensor indices = at::empty({0}, self.options().dtype(kLong));
+  return at::native::topk_out_cuda(values, indices, self, k, dim, largest, sorted);
+}
+
+}} // namespace at::native
@@ -15,6 +15,9 @@
 #include <cufft.h>
 #include <cufftXt.h>
 #include <cmath>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace at { namespace native {
 
@@ -183,6 +186,9 @@ static inline Tensor _run_cufft(
   // set to current stream
   CUFFT_CHECK(cufftSetStream(plan, at::cuda::getCurrentCUDAStream()));
 
+  // The work area comes from the caching allocator instead of being owned by
+  // the plan, so cached plans don't hold on to device memory, and transforms
+  // on the same stream reuse the same block.
   auto ws = ctx.getType(at::Backend::CUDA, at::ScalarType::Byte).tensor({ config.workspace_size() });
   CUFFT_CHECK(cufftSetWorkArea(plan, ws.data_ptr()));
 
@@ -216,36 +222,67 @@ static inline Tensor _run_cufft(
   return output;
 }
 
-// The cuFFT plan cache, defined in CuFFTUtils.h
-struct CuFFTParamsLRUCache plan_cache;
-std::mutex plan_cache_mutex;
+// The cuFFT plan caches, one per device, defined in CuFFTPlanCache.h. Each
+// has its own mutex, so that transforms on different devices don't contend.
+struct DeviceCuFFTPlanCache {
+  CuFFTParamsLRUCache cache;
+  std::mutex mutex;
+};
+
+static DeviceCuFFTPlanCache& cufft_plan_cache(int64_t device_index) {
+  static std::vector<std::unique_ptr<DeviceCuFFTPlanCache>> caches = [] {
+    std::vector<std::unique_ptr<DeviceCuFFTPlanCache>> result(at::cuda::getNumGPUs());
+    for (auto& cache : result) {
+      cache.reset(new DeviceCuFFTPlanCache());
+    }
+    return result;
+  }();
+  AT_CHECK(device_index >= 0 && device_index < static_cast<int64_t>(caches.size()),
+           "cuFFT plan cache: invalid device index ", device_index);
+  return *caches[device_index];
+}
 
 namespace detail {
 
-int64_t cufft_get_plan_cache_max_size_impl() {
-  std::lock_guard<std::mutex> guard(plan_cache_mutex);
-  return plan_cache.max_size();
+int64_t cufft_get_plan_cache_max_size_impl(int64_t device_index) {
+  auto& plan_cache = cufft_plan_cache(device_index);
+  std::lock_guard<std::mutex> guard(plan_cache.mutex);
+  return plan_cache.cache.max_size();
+}
+
+void cufft_set_plan_cache_max_size_impl(int64_t device_index, int64_t max_size) {
+  auto& plan_cache = cufft_plan_cache(device_index);
+  std::lock_guard<std::mutex> guard(plan_cache.mutex);
+  plan_cache.cache.resize(max_size);
+}
+
+int64_t cufft_get_plan_cache_size_impl(int64_t device_index) {
+  auto& plan_cache = cufft_plan_cache(device_index);
+  std::lock_guard<std::mutex> guard(plan_cache.mutex);
+  return plan_cache.cache.size();
 }
 
-void cufft_set_plan_cache_max_size_impl(int64_t max_size) {
-  std::lock_guard<std::mutex> guard(plan_cache_mutex);
-  plan_cache.resize(max_size);
+void cufft_clear_plan_cache_impl(int64_t device_index) {
+  auto& plan_cache = cufft_plan_cache(device_index);
+  std::lock_guard<std::mutex> guard(plan_cache.mutex);
+  return plan_cache.cache.clear();
 }
 
-int64_t cufft_get_plan_cache_size_impl() {
-  std::lock_guard<std::mutex> guard(plan_cache_mutex);
-  return plan_cache.size();
+int64_t cufft_get_plan_cache_hits_impl(int64_t device_index) {
+  auto& plan_cache = cufft_plan_cache(device_index);
+  std::lock_guard<std::mutex> guard(plan_cache.mutex);
+  return plan_cache.cache.hits();
 }
 
-void cufft_clear_plan_cache_impl() {
-  std::lock_guard<std::mutex> guard(plan_cache_mutex);
-  return plan_cache.clear();
+int64_t cufft_get_plan_cache_misses_impl(int64_t device_index) {
+  auto& plan_cache = cufft_plan_cache(device_index);
+  std::lock_guard<std::mutex> guard(plan_cache.mutex);
+  return plan_cache.cache.misses();
 }
 
 } // namespace at::native::detail
 
 // cuFFT
-// Currently not utilizing multi GPUs so this can be potentially sped up.
 Tensor _fft_cufft(const Tensor& self, int64_t signal_ndim,
                   bool complex_input, bool complex_output, bool inverse,
                   IntList checked_signal_sizes, bool normalized, bool onesided,
@@ -278,21 +315,23 @@ Tensor _fft_cufft(const Tensor& self, int64_t signal_ndim,
   // futher cuFFT parameter computation and plan creation to the helper class
   // CuFFTConfig in CuFFTUtils.h.
 
-  // If plan caching is enabled, we check the cache. Note that this accesses
-  // plan_cache.max_size() and thus makes this function less functional.
+  // If plan caching is enabled, we check the cache of the input's device. Note
+  // that this accesses plan_cache.max_size() and thus makes this function less
+  // functional.
   // However, integrating additional arguments into the "public" level c++ APIs,
   // e.g., irfft, is difficult as we have a long call sequence looking like
   //   irfft --> _fft --> _fft_with_size --dispatching-to-> _fft_cufft
 
   // This read is not locked for perf reason. Shouldn't matter too much because
   // we check again after acquiring the lock.
-  if (plan_cache.max_size() > 0) {
+  auto& plan_cache = cufft_plan_cache(input.get_device());
+  if (plan_cache.cache.max_size() > 0) {
     CuFFTParams params;
     setCuFFTParams(&params, input, signal_ndim, complex_input,
       complex_output, checked_signal_sizes, onesided);
-    std::lock_guard<std::mutex> guard(plan_cache_mutex);
-    if (plan_cache.max_size() > 0) {  // check again after acquiring the lock
-      const CuFFTConfig &config = plan_cache.try_emplace_value(std::move(params),
+    std::lock_guard<std::mutex> guard(plan_cache.mutex);
+    if (plan_cache.cache.max_size() > 0) {  // check again after acquiring the lock
+      const CuFFTConfig &config = plan_cache.cache.try_emplace_value(std::move(params),
                                              input, signal_ndim, complex_input,
                                              complex_output, checked_signal_sizes,
                                              onesided, output_sizes);
@@ -2,6 +2,8 @@
 #include "ATen/cuda/CUDAContext.h"
 #include "ATen/cuda/CUDAApplyUtils.cuh"
 
+#include <algorithm>
+
 namespace at {
 namespace cuda {
 #define THRESH_NUMBER_BINS_FOR_MULTI_BLOCK_MEM 100
@@ -34,6 +36,7 @@ __global__ void kernelHistogram1D(
     detail::TensorInfo<input_t, IndexType> b, /* input */
     int binsize,
     IndexType totalElements,
+    IndexType sharedBins, /* bins counted in shared memory */
     Op getOp) {
   extern __shared__ unsigned char my_smem[];
   output_t* smem = nullptr;
@@ -42,8 +45,10 @@ __global__ void kernelHistogram1D(
     ////////////////////////// Shared memory //////////////////////////
     // atomically add to block specific shared memory
     // then atomically add to the global output tensor
+    // Only the first `sharedBins` bins fit in shared memory; the remaining
+    // ones are atomically added to the global output tensor directly.
     smem = reinterpret_cast<output_t*>(my_smem);
-    for (IndexType i = threadIdx.x; i < a.sizes[0]; i += blockDim.x) {
+    for (IndexType i = threadIdx.x; i < sharedBins; i += blockDim.x) {
       smem[i] = 0;
     }
     __syncthreads();
@@ -53,13 +58,19 @@ __global__ void kernelHistogram1D(
           detail::IndexToOffset<input_t, IndexType, BDims>::get(linearIndex, b);
       // Use value at `b` as an offset of `smem`
       const IndexType pOffset = b.data[bOffset] / binsize;
-      atomicAdd(&smem[pOffset], getOp(linearIndex));
+      if (pOffset < sharedBins) {
+        atomicAdd(&smem[pOffset], getOp(linearIndex));
+      } else {
+        const IndexType aOffset =
+            detail::IndexToOffset<output_t, IndexType, ADims>::get(pOffset, a);
+        atomicAdd(&a.data[aOffset], getOp(linearIndex));
+      }
     }
     __syncthreads();
     // NOTE: atomically update output bin count.
     //   Atomic update is imp since __syncthread() will only synchronize threads
     //   in a given block, not across blocks.
-    for (IndexType i = threadIdx.x; i < a.sizes[0]; i += blockDim.x) {
+    for (IndexType i = threadIdx.x; i < sharedBins; i += blockDim.x) {
       const IndexType aOffset =
           detail::IndexToOffset<output_t, IndexType, ADims>::get(i, a);
       atomicAdd(&a.data[aOffset], smem[i]);
@@ -118,7 +129,8 @@ __global__ void kernelHistogram1D(
          block,                                                            \
          (MEMORY_TYPE == CUDAHistogramMemoryType::SHARED) ? sharedMem : 0, \
          getCurrentCUDAStream()>>>(                    \
-          aInfo, pInfo, bInfo, binsize, totalElements, WEIGHTS_OP);        \
+          aInfo, pInfo, bInfo, binsize, totalElements, sharedBins,         \
+          WEIGHTS_OP);                                                     \
   AT_ASSERTM(cudaGetLastError() == cudaSuccess, "kernelHistogram1D failed");
 
 #define HANDLE_SWITCH_CASE(mType, getOp)                        \
@@ -152,13 +164,19 @@ inline int64_t getFreeGlobalMemory() {
   See `help torch.bincount` for details on the math.
 
   3 implementations based of input size and memory usage:
-    case: #bins < THRESH_NUMBER_BINS_FOR_MULTI_BLOCK_MEM and enough shared mem
+    case: enough shared mem, and #bins < THRESH_NUMBER_BINS_FOR_MULTI_BLOCK_MEM
+          or enough elements to amortize flushing every block's copy
         SHARED: Each block atomically adds to it's own **shared** hist copy,
         then atomically updates the global tensor.
     case: #bins < THRESH_NUMBER_BINS_FOR_GLOBAL_MEM and enough global mem
         MULTI_BLOCK: Each block atomically adds to it's own **global** hist
         copy, then atomically updates the global tensor.
-    case: THRESH_NUMBER_BINS_FOR_GLOBAL_MEM <= #bins
+    case: not enough shared mem for all bins, but enough elements to amortize
+          flushing every block's copy of the bins that fit
+        SHARED with spill-over: As SHARED for the bins that fit in shared
+        memory; values in the remaining bins atomically update the global
+        tensor directly.
+    otherwise
         GLOBAL: all threads atomically update to a single **global** hist copy.
  */
 template <typename output_t, typename input_t, bool HasWeights>
@@ -189,16 +207,26 @@ bool CUDA_tensor_histogram(
   auto sharedMem = nbins * sizeof(output_t) + 8; // 8 guard bytes
   auto maxGlobalMem = getFreeGlobalMemory();
   auto multiBlockMem = nbins * grid.x * sizeof(output_t) + 8; // 8 guard bytes
+  // every block flushes its shared copy with one global atomic per bin, which
+  // pays off as long as there are more elements than that
+  int64_t maxSharedBins = (maxSharedMem - 8) / sizeof(output_t);
+  int64_t sharedBins = 0;
   // determine memory type to use in the kernel
-  if (nbins < THRESH_NUMBER_BINS_FOR_MULTI_BLOCK_MEM &&
-      sharedMem < maxSharedMem) {
+  if (sharedMem < maxSharedMem &&
+      (nbins < THRESH_NUMBER_BINS_FOR_MULTI_BLOCK_MEM ||
+       nbins * grid.x <= totalElements)) {
     memType = CUDAHistogramMemoryType::SHARED;
+    sharedBins = nbins;
   } else if (
       nbins < THRESH_NUMBER_BINS_FOR_GLOBAL_MEM &&
       multiBlockMem < (maxGlobalMem / 2)) {
     // check against half of free mem to be extra safe
     // due to cached allocator, we may anyway have slightly more free mem
     memType = CUDAHistogramMemoryType::MULTI_BLOCK;
+  } else if (maxSharedBins * grid.x <= totalElements) {
+    memType = CUDAHistogramMemoryType::SHARED;
+    sharedBins = std::min(nbins, maxSharedBins);
+    sharedMem = sharedBins * sizeof(output_t) + 8;
   }
 
   // alloc memory for MULTI_BLOCK
@@ -86,5 +86,19 @@ _unique_cuda(const Tensor& self, const bool sorted, const bool return_inverse) {
 #endif
 }
 
+std::tuple<Tensor, Tensor, Tensor>
+_unique2_cuda(const Tensor& self, const bool sorted, const bool return_inverse, const bool return_counts) {
+  Tensor output, inverse_indices;
+  std::tie(output, inverse_indices) = _unique_cuda(self, sorted, return_inverse || return_counts);
+  Tensor counts = at::empty({0}, self.type().toScalarType(kLong));
+  if (return_counts) {
+    counts = inverse_indices.view(-1).bincount({}, output.numel());
+  }
+  if (!return_inverse) {
+    inverse_indices = at::empty({0}, self.type().toScalarType(kLong));
+  }
+  return std::make_tuple(output, inverse_indices, counts);
+}
+
 }  // namespace native
 }  // namespace at
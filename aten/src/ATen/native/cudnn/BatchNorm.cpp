@@ -47,6 +47,19 @@ Tensor expandScale(const Tensor& t, int64_t dim) {
   return t.view(size);
 }
 
+// Channels-last inputs are normalized in place of their layout: the output
+// and the gradients share the input's descriptor. See Note [Channels last].
+bool is_channels_last_input(const Tensor& t) {
+  return suggest_memory_format(t.sizes(), t.strides()) == MemoryFormat::ChannelsLast;
+}
+
+Tensor empty_like_input(const Tensor& t) {
+  if (is_channels_last_input(t)) {
+    return t.type().tensor(t.sizes(), t.strides());
+  }
+  return t.type().tensor(t.sizes());
+}
+
 }  // namespace
 
 std::tuple<Tensor, Tensor, Tensor> cudnn_batch_norm(
@@ -74,7 +87,10 @@ std::tuple<Tensor, Tensor, Tensor> cudnn_batch_norm(
   }
   checkAllSameType(c, {weight, bias, running_mean, running_var});
   // TODO: is weight required to be contiguous?
-  checkAllContiguous(c, {input, weight, bias, running_mean, running_var});
+  if (!is_channels_last_input(*input)) {
+    checkContiguous(c, input);
+  }
+  checkAllContiguous(c, {weight, bias, running_mean, running_var});
   checkDimRange(c, input, 2, 6 /* exclusive */);
   auto num_features = input->size(1);
   for (auto t : {weight, bias, running_mean, running_var}) {
@@ -94,7 +110,7 @@ std::tuple<Tensor, Tensor, Tensor> cudnn_batch_norm(
 #endif
   }
 
-  auto output_t = input->type().tensor(input->sizes());
+  auto output_t = empty_like_input(*input);
   TensorArg output{ output_t, "output", 0 };
 
   auto handle = getCudnnHandle();
@@ -146,13 +162,17 @@ std::tuple<Tensor, Tensor, Tensor> cudnn_batch_norm(
 // in training mode (evaluation mode batchnorm has a different algorithm),
 // which is why this doesn't accept a 'training' parameter.
 std::tuple<Tensor, Tensor, Tensor> cudnn_batch_norm_backward(
-    const Tensor& input_t, const Tensor& grad_output_t, const Tensor& weight_t,
+    const Tensor& input_t, const Tensor& grad_output_r, const Tensor& weight_t,
     // Unused: but we require them to be passed so that double backwards
     // has access
     const Tensor& running_mean, const Tensor& running_var,
     const Tensor& save_mean_t, const Tensor& save_var_t,
     double epsilon)
 {
+  // grad_output shares the input descriptor, so it must have the same layout
+  auto grad_output_t = is_channels_last_input(input_t)
+      ? grad_output_r.to_channels_last() : grad_output_r.contiguous();
+
   TensorArg input{ input_t, "input", 1 },
             grad_output{ grad_output_t, "grad_output", 2 },
             weight{ weight_t, "weight", 3 },
@@ -171,7 +191,10 @@ std::tuple<Tensor, Tensor, Tensor> cudnn_batch_norm_backward(
   checkAllSameType(c, {input, grad_output});
   checkAllSameType(c, {weight, save_mean, save_var});
   // TODO: is weight required to be contiguous?
-  checkAllContiguous(c, {input, grad_output, save_mean, save_var});
+  if (!is_channels_last_input(*input)) {
+    checkAllContiguous(c, {input, grad_output});
+  }
+  checkAllContiguous(c, {save_mean, save_var});
   checkDimRange(c, input, 2, 6 /* exclusive */);
   checkSameSize(c, input, grad_output);
   auto num_features = input->size(1);
@@ -190,7 +213,7 @@ std::tuple<Tensor, Tensor, Tensor> cudnn_batch_norm_backward(
 #endif
   }
 
-  auto grad_input_t  = input->type().tensor(input->sizes());
+  auto grad_input_t  = empty_like_input(*input);
   auto grad_weight_t = weight->type().tensor(weight->sizes());
   auto grad_bias_t   = weight->type().tensor(weight->sizes());
 
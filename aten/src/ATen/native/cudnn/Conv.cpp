@@ -81,10 +81,15 @@ std::tuple<at::Tensor,at::Tensor,at::Tensor> cudnn_convolution_transpose_backwar
 #include <ATen/cudnn/Descriptors.h>
 #include <ATen/cudnn/Types.h>
 #include <ATen/cudnn/Utils.h>
+#include <ATen/cuda/CUDAContext.h>
+#include "ATen/native/cudnn/ConvBenchmarkCache.h"
 #include "ATen/native/utils/ParamsHash.h"
 
 #include <ATen/TensorUtils.h>
 
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <functional>
 #include <iterator>
 #include <sstream>
@@ -177,6 +182,19 @@ Tensor narrowGroup(const Tensor& t, int dim, int group_idx, int64_t groups) {
   return t.narrow(dim, group_idx * group_size, group_size);
 }
 
+// Channels-last inputs give channels-last weights and outputs, see
+// Note [Channels last]
+static bool is_channels_last_input(const Tensor& t) {
+  return suggest_memory_format(t.sizes(), t.strides()) == MemoryFormat::ChannelsLast;
+}
+
+static Tensor empty_in_format(const Tensor& t, IntList sizes, bool channels_last) {
+  if (channels_last) {
+    return t.type().tensor(sizes, get_channels_last_strides(sizes));
+  }
+  return t.type().tensor(sizes);
+}
+
 // ---------------------------------------------------------------------
 //
 // Checking
@@ -340,12 +358,127 @@ struct BenchmarkCache {
     std::lock_guard<std::mutex> guard(mutex);
     map[params] = results;
   }
+
+  std::vector<std::pair<ConvolutionParams, T>> entries() {
+    std::lock_guard<std::mutex> guard(mutex);
+    return std::vector<std::pair<ConvolutionParams, T>>(map.begin(), map.end());
+  }
+
+  size_t size() {
+    std::lock_guard<std::mutex> guard(mutex);
+    return map.size();
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> guard(mutex);
+    map.clear();
+  }
 };
 
 BenchmarkCache<cudnnConvolutionFwdAlgo_t> fwd_algos;
 BenchmarkCache<cudnnConvolutionBwdDataAlgo_t> bwd_data_algos;
 BenchmarkCache<cudnnConvolutionBwdFilterAlgo_t> bwd_filter_algos;
 
+// Note [Persistent benchmark cache]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// The algorithms picked by benchmarking can be saved to a file and loaded
+// by other processes, so that they don't run cudnnFind* again for shapes
+// that have been seen before. The file is only valid for the cuDNN version
+// and GPU model it was written with, and it stores ConvolutionParams as raw
+// bytes, so it records all three and is ignored (with a warning) by a
+// process in which any of them differ.
+//
+// If the TORCH_CUDNN_BENCHMARK_CACHE environment variable is set, the file
+// it names is loaded the first time an algorithm is looked up; a missing
+// file is not an error, so the same setting can be used before the file
+// has been written.  Like the in-memory cache, the file isn't keyed by
+// device, so processes that use different GPU models need separate files.
+
+constexpr char benchmark_cache_magic[] = "ATEN_CUDNN_BENCHMARK_CACHE_V1";
+
+struct BenchmarkCacheHeader {
+  char magic[sizeof(benchmark_cache_magic)];
+  int64_t cudnn_version;
+  int64_t params_size;
+  char device_name[256];
+};
+
+static BenchmarkCacheHeader currentBenchmarkCacheHeader() {
+  BenchmarkCacheHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, benchmark_cache_magic, sizeof(benchmark_cache_magic));
+  header.cudnn_version = cudnnGetVersion();
+  header.params_size = sizeof(ConvolutionParams);
+  strncpy(header.device_name, at::cuda::getCurrentDeviceProperties()->name,
+          sizeof(header.device_name) - 1);
+  return header;
+}
+
+template <typename T>
+static void writeBenchmarkCache(std::ostream& out, BenchmarkCache<T>& cache) {
+  auto entries = cache.entries();
+  int64_t count = entries.size();
+  out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+  for (const auto& entry : entries) {
+    int32_t algo = entry.second;
+    out.write(reinterpret_cast<const char*>(&entry.first), sizeof(ConvolutionParams));
+    out.write(reinterpret_cast<const char*>(&algo), sizeof(algo));
+  }
+}
+
+template <typename T>
+static int64_t readBenchmarkCache(std::istream& in, BenchmarkCache<T>& cache, const std::string& path) {
+  int64_t count;
+  in.read(reinterpret_cast<char*>(&count), sizeof(count));
+  AT_CHECK(in && count >= 0, "cuDNN benchmark cache file ", path, " is corrupted");
+  for (int64_t i = 0; i < count; i++) {
+    ConvolutionParams params;
+    int32_t algo;
+    in.read(reinterpret_cast<char*>(&params), sizeof(params));
+    in.read(reinterpret_cast<char*>(&algo), sizeof(algo));
+    AT_CHECK(in, "cuDNN benchmark cache file ", path, " is corrupted");
+    cache.insert(params, static_cast<T>(algo));
+  }
+  return count;
+}
+
+static int64_t loadBenchmarkCache(const std::string& path, bool must_exist) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    AT_CHECK(!must_exist, "could not open cuDNN benchmark cache file ", path);
+    return 0;
+  }
+  auto expected = currentBenchmarkCacheHeader();
+  BenchmarkCacheHeader header;
+  in.read(reinterpret_cast<char*>(&header), sizeof(header));
+  AT_CHECK(in && memcmp(header.magic, expected.magic, sizeof(header.magic)) == 0,
+           path, " is not a cuDNN benchmark cache file");
+  header.device_name[sizeof(header.device_name) - 1] = '\0';
+  if (header.cudnn_version != expected.cudnn_version ||
+      header.params_size != expected.params_size ||
+      strcmp(header.device_name, expected.device_name) != 0) {
+    AT_WARN("ignoring cuDNN benchmark cache file ", path, ", which was written with cuDNN ",
+            header.cudnn_version, " on ", header.device_name, ", but this process uses cuDNN ",
+            expected.cudnn_version, " on ", expected.device_name);
+    return 0;
+  }
+  int64_t count = 0;
+  count += readBenchmarkCache(in, fwd_algos, path);
+  count += readBenchmarkCache(in, bwd_data_algos, path);
+  count += readBenchmarkCache(in, bwd_filter_algos, path);
+  return count;
+}
+
+static void maybeLoadBenchmarkCacheFromEnv() {
+  static std::once_flag once;
+  std::call_once(once, [] {
+    const char* path = std::getenv("TORCH_CUDNN_BENCHMARK_CACHE");
+    if (path && *path) {
+      loadBenchmarkCache(path, /*must_exist=*/false);
+    }
+  });
+}
+
 // TODO: Stop manually allocating CUDA memory; allocate an ATen byte
 // tensor instead.
 struct Workspace {
@@ -365,6 +498,74 @@ struct Workspace {
   void* data;
 };
 
+// Note [cuDNN workspace]
+// ~~~~~~~~~~~~~~~~~~~~~~
+// Convolutions share one workspace per stream instead of allocating their
+// own. It grows to the largest size any convolution on that stream has
+// needed, and is only freed when it has to grow. Kernels on a stream run in
+// order, so the convolutions can't overwrite each other's workspace; the lock
+// on it keeps other host threads from resizing it while a convolution that
+// uses it is being queued. (The temporary workspace used for benchmarking,
+// which can be several GBs, isn't shared.)
+//
+// Algorithms are chosen to fit the memory that is available without going
+// through an OOM: the workspace of the current stream, or the largest block
+// that the caching allocator (or failing it, the device) can hand out.
+
+struct StreamWorkspace {
+  std::mutex mutex;
+  void* data = nullptr;
+  size_t size = 0;
+};
+
+static StreamWorkspace& getStreamWorkspace(cudaStream_t stream) {
+  static std::mutex mutex;
+  // Never destroyed: freeing the workspaces can't happen during shutdown
+  static auto& workspaces = *new std::unordered_map<cudaStream_t, std::unique_ptr<StreamWorkspace>>();
+  std::lock_guard<std::mutex> guard(mutex);
+  auto& workspace = workspaces[stream];
+  if (!workspace) {
+    workspace.reset(new StreamWorkspace());
+  }
+  return *workspace;
+}
+
+// The workspace of the current stream, reserved for one convolution
+struct SharedWorkspace {
+  SharedWorkspace(size_t size) {
+    THCState *state = globalContext().lazyInitCUDA();
+    auto& workspace = getStreamWorkspace(THCState_getCurrentStream(state));
+    lock = std::unique_lock<std::mutex>(workspace.mutex);
+    if (workspace.size < size) {
+      if (workspace.data) {
+        THCudaFree(state, workspace.data);
+        workspace.data = nullptr;
+        workspace.size = 0;
+      }
+      workspace.data = THCudaMalloc(state, size);
+      workspace.size = size;
+    }
+    data = workspace.data;
+    this->size = workspace.size;
+  }
+
+  std::unique_lock<std::mutex> lock;
+  size_t size;
+  void* data;
+};
+
+static size_t getAvailableWorkspaceSize() {
+  THCState *state = globalContext().lazyInitCUDA();
+  size_t max_block_size = 0;
+  size_t total_gpu_mem = 0;
+  size_t free_gpu_mem = 0;
+  THCudaCheck(THCudaMemGetInfoCached(state, &free_gpu_mem, &total_gpu_mem, &max_block_size));
+
+  auto& workspace = getStreamWorkspace(THCState_getCurrentStream(state));
+  std::lock_guard<std::mutex> guard(workspace.mutex);
+  return std::max(workspace.size, max_block_size);
+}
+
 template<typename algo_t>
 struct algorithm_search {
 };
@@ -495,9 +696,10 @@ struct algorithm_search<cudnnConvolutionFwdAlgo_t> {
 
   static void getAlgorithm(
     const ConvolutionArgs& args,
+    size_t workspace_limit,
     algo_t* algo)
   {
-    cudnnConvolutionFwdPreference_t pref = CUDNN_CONVOLUTION_FWD_PREFER_FASTEST;
+    cudnnConvolutionFwdPreference_t pref = CUDNN_CONVOLUTION_FWD_SPECIFY_WORKSPACE_LIMIT;
     AT_CUDNN_CHECK(cudnnGetConvolutionForwardAlgorithm(
         args.handle,
         args.idesc.desc(),
@@ -505,7 +707,7 @@ struct algorithm_search<cudnnConvolutionFwdAlgo_t> {
         args.cdesc.desc(),
         args.odesc.desc(),
         pref,
-        0,
+        workspace_limit,
         algo));
   }
 
@@ -562,15 +764,15 @@ struct algorithm_search<cudnnConvolutionBwdDataAlgo_t> {
     return getBestAlgorithm(perf_results.get(), args.params.deterministic, perf_count);
   }
 
-  static void getAlgorithm(const ConvolutionArgs& args, algo_t* algo) {
+  static void getAlgorithm(const ConvolutionArgs& args, size_t workspace_limit, algo_t* algo) {
     AT_CUDNN_CHECK(cudnnGetConvolutionBackwardDataAlgorithm(
         args.handle,
         args.wdesc.desc(),
         args.odesc.desc(),
         args.cdesc.desc(),
         args.idesc.desc(),
-        CUDNN_CONVOLUTION_BWD_DATA_PREFER_FASTEST,
-        0,
+        CUDNN_CONVOLUTION_BWD_DATA_SPECIFY_WORKSPACE_LIMIT,
+        workspace_limit,
         algo));
   }
 
@@ -632,15 +834,15 @@ struct algorithm_search<cudnnConvolutionBwdFilterAlgo_t> {
     return getBestAlgorithm<perf_t>(perf_results.get(), args.params.deterministic, perf_count);
   }
 
-  static void getAlgorithm(const ConvolutionArgs& args, algo_t* algo) {
+  static void getAlgorithm(const ConvolutionArgs& args, size_t workspace_limit, algo_t* algo) {
     AT_CUDNN_CHECK(cudnnGetConvolutionBackwardFilterAlgorithm(
         args.handle,
         args.idesc.desc(),
         args.odesc.desc(),
         args.cdesc.desc(),
         args.wdesc.desc(),
-        CUDNN_CONVOLUTION_BWD_FILTER_PREFER_FASTEST,
-        0,
+        CUDNN_CONVOLUTION_BWD_FILTER_SPECIFY_WORKSPACE_LIMIT,
+        workspace_limit,
         algo)
     );
   }
@@ -663,6 +865,7 @@ void findAlgorithm(const ConvolutionArgs& args, bool benchmark, algo_t* algo) {
   using search = algorithm_search<algo_t>;
   auto& cache = search::cache();
 
+  maybeLoadBenchmarkCacheFromEnv();
   if (cache.find(args.params, algo)) {
     return;
   }
@@ -673,7 +876,8 @@ void findAlgorithm(const ConvolutionArgs& args, bool benchmark, algo_t* algo) {
   }
 
   if (!benchmark) {
-    search::getAlgorithm(args, algo);
+    // Not cached: the best algorithm depends on how much memory is free
+    search::getAlgorithm(args, getAvailableWorkspaceSize(), algo);
     return;
   }
 
@@ -699,8 +903,9 @@ void findAlgorithm(const ConvolutionArgs& args, bool benchmark, algo_t* algo) {
   THCCachingAllocator_emptyCache();
 }
 
+// See Note [cuDNN workspace]
 template<typename algo_t>
-Workspace chooseAlgorithm(
+SharedWorkspace chooseAlgorithm(
     const ConvolutionArgs& args,
     bool benchmark,
     algo_t* algo)
@@ -711,17 +916,22 @@ Workspace chooseAlgorithm(
   size_t workspace_size;
   search::getWorkspaceSize(args, *algo, &workspace_size);
   try {
-    return Workspace(workspace_size);
+    return SharedWorkspace(workspace_size);
   } catch (std::runtime_error& e) {
     cudaGetLastError(); // clear OOM error
 
-    // switch to default algorithm and record it in the cache to prevent
-    // further OOM errors
-    *algo = search::DEFAULT_ALGO;
+    // switch to the fastest algorithm that fits in the memory that is left
+    // (or to the default one, if we need determinism) and record it in the
+    // cache to prevent further OOM errors
+    if (args.params.deterministic) {
+      *algo = search::DEFAULT_ALGO;
+    } else {
+      search::getAlgorithm(args, getAvailableWorkspaceSize(), algo);
+    }
     search::cache().insert(args.params, *algo);
 
     search::getWorkspaceSize(args, *algo, &workspace_size);
-    return Workspace(workspace_size);
+    return SharedWorkspace(workspace_size);
   }
 }
 
@@ -815,7 +1025,7 @@ void raw_cudnn_convolution_forward_out(
   // convolution support is already pretty slow, so this might not
   // matter.  (This applies to raw_cudnn_convolution_backward_input as well.)
   cudnnConvolutionFwdAlgo_t fwdAlg;
-  Workspace workspace = chooseAlgorithm(args, benchmark, &fwdAlg);
+  SharedWorkspace workspace = chooseAlgorithm(args, benchmark, &fwdAlg);
 
   Constant one(dataType, 1);
   Constant zero(dataType, 0);
@@ -837,16 +1047,18 @@ Tensor cudnn_convolution_forward(
   checkAllSameType(c, {input, weight});
   checkAllSameGPU(c, {input, weight});
 
-  auto output_t = input->type().tensor(
+  bool channels_last = is_channels_last_input(*input);
+  auto output_t = empty_in_format(*input,
                     conv_output_size(input->sizes(), weight->sizes(),
-                                     padding, stride, dilation, groups));
+                                     padding, stride, dilation, groups),
+                    channels_last);
 
   // Avoid ambiguity of "output" when this is being used as backwards
   TensorArg output{ output_t, "result", 0 };
   convolution_shape_check(c, input, weight, output, padding, stride, dilation, groups);
 
   // See #4500
-  Tensor weight_contig = weight->contiguous();
+  Tensor weight_contig = channels_last ? weight->to_channels_last() : weight->contiguous();
 
 #if CUDNN_VERSION < 7000
   for (int i = 0; i < groups; i++) {
@@ -903,7 +1115,7 @@ std::tuple<at::Tensor,at::Tensor,at::Tensor> cudnn_convolution_transpose_backwar
     IntList padding, IntList output_padding, IntList stride, IntList dilation, int64_t groups,
     bool benchmark, bool deterministic, std::array<bool,3> output_mask) {
 
-  Tensor grad_output = grad_output_t.contiguous();
+  Tensor grad_output = is_channels_last_input(input) ? grad_output_t.to_channels_last() : grad_output_t.contiguous();
 
   Tensor grad_input, grad_weight, grad_bias;
   if (output_mask[0]) {
@@ -943,7 +1155,7 @@ void raw_cudnn_convolution_backward_input_out(
   args.cdesc.set(dataType, grad_output.dim() - 2, args.params.padding, args.params.stride, args.params.dilation, args.params.groups);
 
   cudnnConvolutionBwdDataAlgo_t bwdDataAlg;
-  Workspace workspace = chooseAlgorithm(args, benchmark, &bwdDataAlg);
+  SharedWorkspace workspace = chooseAlgorithm(args, benchmark, &bwdDataAlg);
 
   Constant one(dataType, 1);
   Constant zero(dataType, 0);
@@ -975,14 +1187,15 @@ Tensor cudnn_convolution_backward_input(
   checkAllSameType(c, {grad_output, weight});
   checkAllSameGPU(c, {grad_output, weight});
 
-  auto grad_input_t = grad_output->type().tensor(input_size);
+  bool channels_last = is_channels_last_input(*grad_output);
+  auto grad_input_t = empty_in_format(*grad_output, input_size, channels_last);
 
   // Avoid "grad_input" when this is being used as transposed convolution
   TensorArg grad_input{ grad_input_t, "result", 0 };
   convolution_shape_check(c, grad_input, weight, grad_output, padding, stride, dilation, groups);
 
   // See #4500
-  Tensor weight_contig = weight->contiguous();
+  Tensor weight_contig = channels_last ? weight->to_channels_last() : weight->contiguous();
 
 #if CUDNN_VERSION < 7000
   for (int i = 0; i < groups; i++) {
@@ -1032,7 +1245,7 @@ std::tuple<at::Tensor,at::Tensor,at::Tensor> cudnn_convolution_backward(
     IntList padding, IntList stride, IntList dilation, int64_t groups,
     bool benchmark, bool deterministic, std::array<bool,3> output_mask) {
 
-  Tensor grad_output = grad_output_t.contiguous();
+  Tensor grad_output = is_channels_last_input(input) ? grad_output_t.to_channels_last() : grad_output_t.contiguous();
 
   Tensor grad_input, grad_weight, grad_bias;
   if (output_mask[0]) {
@@ -1087,7 +1300,7 @@ void raw_cudnn_convolution_backward_weight_out(
   args.cdesc.set(dataType, input.dim() - 2, args.params.padding, args.params.stride, args.params.dilation, args.params.groups);
 
   cudnnConvolutionBwdFilterAlgo_t bwdFilterAlg;
-  Workspace workspace = chooseAlgorithm(args, benchmark, &bwdFilterAlg);
+  SharedWorkspace workspace = chooseAlgorithm(args, benchmark, &bwdFilterAlg);
 
   Constant one(dataType, 1);
   Constant zero(dataType, 0);
@@ -1110,7 +1323,7 @@ Tensor cudnn_convolution_backward_weight(
   checkAllSameType(c, {grad_output, input});
   checkAllSameGPU(c, {grad_output, input});
 
-  auto grad_weight_t = grad_output->type().tensor(weight_size);
+  auto grad_weight_t = empty_in_format(*grad_output, weight_size, is_channels_last_input(*input));
 
   // For uniformity with everything else, although it seems grad_weight
   // would be unambiguous too.
@@ -1200,6 +1413,36 @@ Tensor cudnn_convolution_backward_bias(
 }
 
 
+namespace detail {
+
+void cudnn_save_benchmark_cache_impl(const std::string& path) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  AT_CHECK(out, "could not open cuDNN benchmark cache file ", path, " for writing");
+  auto header = currentBenchmarkCacheHeader();
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  writeBenchmarkCache(out, fwd_algos);
+  writeBenchmarkCache(out, bwd_data_algos);
+  writeBenchmarkCache(out, bwd_filter_algos);
+  out.close();
+  AT_CHECK(out, "failed to write cuDNN benchmark cache file ", path);
+}
+
+int64_t cudnn_load_benchmark_cache_impl(const std::string& path) {
+  return loadBenchmarkCache(path, /*must_exist=*/true);
+}
+
+int64_t cudnn_get_benchmark_cache_size_impl() {
+  return fwd_algos.size() + bwd_data_algos.size() + bwd_filter_algos.size();
+}
+
+void cudnn_clear_benchmark_cache_impl() {
+  fwd_algos.clear();
+  bwd_data_algos.clear();
+  bwd_filter_algos.clear();
+}
+
+} // namespace detail
+
 }}  // namespace
 
 #endif
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace at { namespace native { namespace detail {
+
+// Since ATen is separated into CPU build and CUDA build, we need a way to call
+// these functions only when CUDA is loaded. We use CUDA hooks for this purpose
+// (at cuda/detail/CUDAHooks.cpp), and call the hooked functions from the actual
+// native function counterparts (at native/Convolution.cpp), i.e.,
+// _cudnn_save_benchmark_cache, _cudnn_load_benchmark_cache,
+// _cudnn_get_benchmark_cache_size and _cudnn_clear_benchmark_cache.
+//
+// See Note [Persistent benchmark cache] in native/cudnn/Conv.cpp.
+void cudnn_save_benchmark_cache_impl(const std::string& path);
+int64_t cudnn_load_benchmark_cache_impl(const std::string& path);
+int64_t cudnn_get_benchmark_cache_size_impl();
+void cudnn_clear_benchmark_cache_impl();
+
+}}} // namespace at::native::detail
@@ -62,6 +62,12 @@ Tensor _cudnn_init_dropout_state(const Type& ty, double dropout, bool train, int
 #include <ATen/cudnn/Descriptors.h>
 #include <ATen/cudnn/Types.h>
 #include <ATen/cudnn/Utils.h>
+#include <ATen/native/utils/ParamsHash.h>
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 namespace at { namespace native {
 
@@ -100,6 +106,8 @@ namespace {
     cudnnDataType_t datatype;
 
     cudnnRNNInputMode_t input_mode = CUDNN_LINEAR_INPUT;
+    // See Note [Persistent cuDNN RNN kernels]
+    cudnnRNNAlgo_t algo = CUDNN_RNN_ALGO_STANDARD;
 
     int64_t num_directions() const {
       return bidirectional ? 2 : 1;
@@ -143,7 +151,7 @@ namespace {
 
     RNNDescriptor descriptor(cudnnHandle_t handle, DropoutDescriptor&& dropout_desc) const {
       RNNDescriptor rnn_desc;
-      rnn_desc.set(handle, hidden_size, num_layers, std::move(dropout_desc), input_mode, bidirectional, mode, datatype);
+      rnn_desc.set(handle, hidden_size, num_layers, std::move(dropout_desc), input_mode, bidirectional, mode, algo, datatype);
       return rnn_desc;
     }
 
@@ -179,11 +187,11 @@ namespace {
     return descriptors;
   }
 
-  std::vector<TensorDescriptor> rnn_descriptor(const Tensor& tensor, int64_t N) {
-    std::vector<TensorDescriptor> descriptors(N);
-    for (int64_t i = 0; i < N; i++) {
-      descriptors[i].set(tensor, 5);
-    }
+  // All steps of an unpacked input have the same shape, so they share a single
+  // descriptor, which RNNDescriptors::get_descs repeats for every step.
+  std::vector<TensorDescriptor> rnn_descriptor(const Tensor& tensor) {
+    std::vector<TensorDescriptor> descriptors(1);
+    descriptors[0].set(tensor, 5);
     return descriptors;
   }
 
@@ -293,7 +301,7 @@ namespace {
       if (is_input_packed) {
         return rnn_descriptor_sequence(x, batch_sizes);
       } else {
-        return rnn_descriptor(x[0], seq_length);
+        return rnn_descriptor(x[0]);
       }
     }
   };
@@ -306,9 +314,119 @@ namespace {
     TensorDescriptorListParams tensors;
   };
 
+  // Note [Persistent cuDNN RNN kernels]
+  // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // With CUDNN_RNN_ALGO_PERSIST_STATIC, cuDNN runs a whole layer in one
+  // persistent kernel that keeps the recurrent weights on chip across steps.
+  // That avoids one GEMM launch per step and is much faster for small
+  // minibatches (e.g. streaming inference), but is slower or unsupported
+  // for large ones, needs a Pascal or newer GPU, and doesn't take packed
+  // input.  It is opt-in through torch.backends.cudnn.rnn_persistent, and
+  // even then only used where it is known to work well.  The weight layout
+  // doesn't depend on the algorithm, so flattened weights work with both.
+  cudnnRNNAlgo_t get_algo(const RNNDescriptorParams& rnn, const TensorDescriptorListParams& tensors) {
+#if CUDNN_VERSION >= 7000
+    if (!at::globalContext().persistentRNNCuDNN() || tensors.is_input_packed() ||
+        rnn.datatype == CUDNN_DATA_DOUBLE) {
+      return CUDNN_RNN_ALGO_STANDARD;
+    }
+    cudaDeviceProp* prop = at::cuda::getCurrentDeviceProperties();
+    if (prop->major >= 6 && tensors.mini_batch <= 64 && rnn.hidden_size <= 1024) {
+      return CUDNN_RNN_ALGO_PERSIST_STATIC;
+    }
+#endif
+    return CUDNN_RNN_ALGO_STANDARD;
+  }
+
+  // Note [cuDNN RNN descriptor cache]
+  // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // Every forward and backward call needs an RNN descriptor (and the dropout
+  // descriptor it owns), and setting one up takes several cuDNN calls.  For
+  // small inputs that setup is a large part of the call, so the descriptors
+  // are cached, keyed by everything that goes into them.  A dropout
+  // descriptor only points at its RNG state, which lives in the dropout
+  // state buffer (see get_dropout_state), so reusing one continues from the
+  // state the previous calls left behind, as a freshly restored one would.
+  // Cached descriptors hold a reference to their dropout state buffer.
+  //
+  // Descriptors are only read by cuDNN calls, so a cached descriptor can be
+  // used by several threads at once.
+
+  // Keys and values of the caches must not depend on padding bytes; see
+  // ParamsHash.
+  template <typename Key, typename Value>
+  struct RNNCache {
+    std::mutex mutex;
+    std::unordered_map<Key, Value, ParamsHash<Key>, ParamsEqual<Key>> map;
+
+    template <typename F>
+    Value get(const Key& key, F&& create) {
+      {
+        std::lock_guard<std::mutex> guard(mutex);
+        auto it = map.find(key);
+        if (it != map.end()) {
+          return it->second;
+        }
+      }
+      // Creating a value calls into cuDNN, so do it without the lock.  If
+      // two threads race, they create equal values and either one is kept.
+      Value value = create();
+      std::lock_guard<std::mutex> guard(mutex);
+      return map.emplace(key, std::move(value)).first->second;
+    }
+  };
+
+  struct RNNDescriptorKey {
+    int device;
+    int64_t hidden_size;
+    int64_t num_layers;
+    cudnnDirectionMode_t bidirectional;
+    cudnnRNNMode_t mode;
+    cudnnDataType_t datatype;
+    cudnnRNNInputMode_t input_mode;
+    cudnnRNNAlgo_t algo;
+    double dropout_p;
+    void* dropout_state;
+  };
+
+  std::shared_ptr<const RNNDescriptor> get_rnn_descriptor(
+      cudnnHandle_t handle, const RNNDescriptorParams& rnn, const DropoutDescriptorParams& dropout) {
+    static RNNCache<RNNDescriptorKey, std::shared_ptr<const RNNDescriptor>> cache;
+
+    auto dropout_p = dropout.train ? dropout.dropout : 0;
+    RNNDescriptorKey key;
+    // Zero the padding bytes, so they don't take part in hashing and comparisons
+    memset(&key, 0, sizeof(key));
+    key.device = cuda::current_device();
+    key.hidden_size = rnn.hidden_size;
+    key.num_layers = rnn.num_layers;
+    key.bidirectional = rnn.bidirectional;
+    key.mode = rnn.mode;
+    key.datatype = rnn.datatype;
+    key.input_mode = rnn.input_mode;
+    key.algo = rnn.algo;
+    key.dropout_p = dropout_p;
+    key.dropout_state = dropout_p != 0 ? dropout.dropout_state.data_ptr() : nullptr;
+    return cache.get(key, [&] {
+      return std::make_shared<const RNNDescriptor>(
+          dropout_p != 0 ? rnn.descriptor(handle, dropout.descriptor(handle)) : rnn.descriptor(handle));
+    });
+  }
+
+  // Same as above, for uses that don't need the dropout descriptor.  See
+  // RNNDescriptorParams::descriptor(cudnnHandle_t).
+  std::shared_ptr<const RNNDescriptor> get_rnn_descriptor(
+      cudnnHandle_t handle, const RNNDescriptorParams& rnn) {
+    DropoutDescriptorParams no_dropout;
+    no_dropout.set(/*train=*/false, /*dropout=*/0, /*dropout_state=*/Tensor());
+    return get_rnn_descriptor(handle, rnn, no_dropout);
+  }
+
   // NB: Doesn't include the weight descriptor
   struct RNNDescriptors {
-    RNNDescriptor rnn_desc;
+    std::shared_ptr<const RNNDescriptor> rnn_desc_ptr;
+    const RNNDescriptor& rnn_desc;
+    int64_t seq_length;
     // NB: this won't actually lay out the tensor descriptor pointers
     // in the right way, so you'll have to preprocess them
     std::vector<TensorDescriptor> x_descs;
@@ -318,8 +436,10 @@ namespace {
     TensorDescriptor cx_desc;
     TensorDescriptor cy_desc;
 
-    RNNDescriptors(const RNNParams& fn, cudnnHandle_t handle, Tensor x, Tensor y, Tensor hx, Tensor cx) {
-      rnn_desc = fn.rnn.descriptor(handle, fn.dropout.descriptor(handle));
+    RNNDescriptors(const RNNParams& fn, cudnnHandle_t handle, Tensor x, Tensor y, Tensor hx, Tensor cx)
+      : rnn_desc_ptr(get_rnn_descriptor(handle, fn.rnn, fn.dropout)),
+        rnn_desc(*rnn_desc_ptr),
+        seq_length(fn.tensors.seq_length) {
       x_descs = fn.tensors.descriptors(x);
       y_descs = fn.tensors.descriptors(y);
       hx_desc.set(hx, 5);
@@ -333,6 +453,10 @@ namespace {
     // TODO: This is annoying, having to put the cudnnTensorDescriptor_t
     // in a contiguous array...
     std::vector<cudnnTensorDescriptor_t> get_descs(const std::vector<TensorDescriptor>& descs) {
+      if (descs.size() == 1) {
+        // One descriptor shared by all steps, see rnn_descriptor
+        return std::vector<cudnnTensorDescriptor_t>(seq_length, descs[0].desc());
+      }
       std::vector<cudnnTensorDescriptor_t> r;
       r.reserve(descs.size());
       for (auto& desc : descs) {
@@ -581,7 +705,8 @@ Tensor _cudnn_rnn_flatten_weight(
   rnn.set(fn_mode, fn_hidden_size, fn_num_layers, fn_bidirectional, getCudnnDataType(any_param));
 
   auto handle = getCudnnHandle();
-  RNNDescriptor rnn_desc = rnn.descriptor(handle);
+  auto rnn_desc_ptr = get_rnn_descriptor(handle, rnn);
+  const RNNDescriptor& rnn_desc = *rnn_desc_ptr;
 
   TensorGeometry x_geom({1, input_size});
   TensorDescriptor x_desc;
@@ -639,6 +764,7 @@ std::tuple<Tensor, Tensor, Tensor, Tensor, Tensor> _cudnn_rnn(
   fn.rnn.set(fn_mode, fn_hidden_size, fn_num_layers, fn_bidirectional, getCudnnDataType(input));
   fn.dropout.set(fn_train, fn_dropout, fn_dropout_state);
   fn.tensors.set(input.sizes(), fn_batch_sizes, batch_first);
+  fn.rnn.algo = get_algo(fn.rnn, fn.tensors);
 
   // TODO: Set device to input
 
@@ -782,6 +908,7 @@ std::tuple<Tensor, Tensor, Tensor> _cudnn_rnn_backward_input(
   fn.rnn.set(fn_mode, fn_hidden_size, fn_num_layers, fn_bidirectional, getCudnnDataType(input));
   fn.dropout.set(fn_train, fn_dropout, fn_dropout_state);
   fn.tensors.set(input.sizes(), fn_batch_sizes, batch_first);
+  fn.rnn.algo = get_algo(fn.rnn, fn.tensors);
 
   // TODO: Set device to input
   auto handle = getCudnnHandle();
@@ -923,6 +1050,7 @@ std::vector<Tensor> _cudnn_rnn_backward_weight(
   fn.rnn.set(fn_mode, fn_hidden_size, fn_num_layers, fn_bidirectional, getCudnnDataType(input));
   fn.dropout.set(fn_train, fn_dropout, fn_dropout_state);
   fn.tensors.set(input.sizes(), fn_batch_sizes, batch_first);
+  fn.rnn.algo = get_algo(fn.rnn, fn.tensors);
 
   auto handle = getCudnnHandle();
 
@@ -1128,46 +1256,96 @@ DropoutState& get_dropout_state(const Type& tp, double dropout_p, bool train) {
   return state;
 }
 
+// Note [cuDNN RNN weight layout cache]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Before every call we check whether the parameters are views into a single
+// buffer, laid out the way cuDNN expects (as flatten_parameters() leaves
+// them), so they can be passed to cuDNN without a copy.  Where cuDNN expects
+// each parameter only depends on the RNN configuration, and not on the
+// buffer, so the offsets are computed once and cached; the check itself is
+// then a comparison of data pointers.  Nothing here depends on the values
+// of the weights, so in-place updates of them don't invalidate the cache.
+struct WeightLayoutKey {
+  int device;
+  int64_t input_size;
+  int64_t hidden_size;
+  int64_t num_layers;
+  cudnnDirectionMode_t bidirectional;
+  cudnnRNNMode_t mode;
+  cudnnDataType_t datatype;
+};
+
+struct WeightLayout {
+  int64_t num_weights;
+  // byte offsets of the expected parameter pointers from the start of the
+  // buffer, in the order of get_expected_data_ptrs
+  std::vector<ptrdiff_t> offsets;
+};
+
+std::shared_ptr<const WeightLayout> get_weight_layout(
+    cudnnHandle_t handle, const Tensor& any_param, const RNNDescriptorParams& rnn, int64_t input_size) {
+  static RNNCache<WeightLayoutKey, std::shared_ptr<const WeightLayout>> cache;
+
+  WeightLayoutKey key;
+  // Zero the padding bytes, so they don't take part in hashing and comparisons
+  memset(&key, 0, sizeof(key));
+  key.device = cuda::current_device();
+  key.input_size = input_size;
+  key.hidden_size = rnn.hidden_size;
+  key.num_layers = rnn.num_layers;
+  key.bidirectional = rnn.bidirectional;
+  key.mode = rnn.mode;
+  key.datatype = rnn.datatype;
+  return cache.get(key, [&] {
+    auto rnn_desc_ptr = get_rnn_descriptor(handle, rnn);
+
+    TensorGeometry x_geom ({1, input_size});
+    TensorDescriptor x_desc;
+    x_desc.set(rnn.datatype, x_geom.sizes(), x_geom.strides(), 5);
+
+    auto layout = std::make_shared<WeightLayout>();
+    layout->num_weights = get_num_weights(handle, *rnn_desc_ptr, x_desc, rnn.datatype);
+    // cuDNN only computes addresses in this buffer, it doesn't touch it
+    auto weight_buf = any_param.type().tensor({layout->num_weights});
+    auto base = static_cast<char*>(weight_buf.data_ptr());
+    for (void* ptr : get_expected_data_ptrs(weight_buf, handle, rnn, *rnn_desc_ptr, x_desc, rnn.datatype)) {
+      layout->offsets.push_back(static_cast<char*>(ptr) - base);
+    }
+    return std::shared_ptr<const WeightLayout>(std::move(layout));
+  });
+}
+
 Tensor try_get_weight_buf(
       const Tensor& input, TensorList parameters, bool has_biases,
       cudnnRNNMode_t mode, int64_t hidden_size, int64_t num_layers, bool bidirectional) {
-  // Prepare all relevant descriptors
   auto handle = getCudnnHandle();
-  auto datatype = getCudnnDataType(input);
 
   RNNDescriptorParams rnn;
-  rnn.set(mode, hidden_size, num_layers, bidirectional, datatype);
-  RNNDescriptor rnn_desc = rnn.descriptor(handle);
-
-  TensorGeometry x_geom ({1, input.size(-1)});
-  TensorDescriptor x_desc;
-  x_desc.set(datatype, x_geom.sizes(), x_geom.strides(), 5);
-
-  auto num_params = get_num_weights(handle, rnn_desc, x_desc, datatype);
+  rnn.set(mode, hidden_size, num_layers, bidirectional, getCudnnDataType(input));
+  auto & any_param = parameters.at(0);
+  auto layout = get_weight_layout(handle, any_param, rnn, input.size(-1));
 
   // Try to get parameter storage
-  auto & any_param = parameters.at(0);
   auto param_storage = any_param.storage();
   auto weight_buf = any_param.type().tensor().set_(*param_storage);
-  if (weight_buf.size(0) < num_params) {
+  if (weight_buf.size(0) < layout->num_weights) {
     return {};
-  } else if (weight_buf.size(0) > num_params) {
-    weight_buf = weight_buf.narrow(0, 0, num_params);
+  } else if (weight_buf.size(0) > layout->num_weights) {
+    weight_buf = weight_buf.narrow(0, 0, layout->num_weights);
   }
 
-  // Get and check data pointers
-  auto expected_data_ptrs = get_expected_data_ptrs(
-      weight_buf, handle, rnn, rnn_desc, x_desc, datatype);
-
+  // Check data pointers
+  auto base = static_cast<char*>(weight_buf.data_ptr());
+  const auto& offsets = layout->offsets;
   int64_t num_parameters = parameters.size();
-  int64_t num_ptrs = expected_data_ptrs.size();
+  int64_t num_ptrs = offsets.size();
   AT_ASSERT(num_ptrs == (num_parameters * (has_biases ? 1 : 2)));
   AT_ASSERT(num_ptrs % (has_biases ? 4 : 2) == 0);
   for (int64_t param_i = 0, ptr_i = 0;
        ptr_i < num_ptrs;
        ptr_i += (has_biases ? 2 : 4), param_i += 2) {
-    if (expected_data_ptrs[ptr_i] != parameters[param_i].data_ptr()) return {};
-    if (expected_data_ptrs[ptr_i + 1] != parameters[param_i + 1].data_ptr()) return {};
+    if (base + offsets[ptr_i] != parameters[param_i].data_ptr()) return {};
+    if (base + offsets[ptr_i + 1] != parameters[param_i + 1].data_ptr()) return {};
   }
   if (!parameters[num_parameters - 1].is_contiguous()) return {};
   return weight_buf;
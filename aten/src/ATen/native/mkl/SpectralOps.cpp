@@ -15,6 +15,28 @@ Tensor _fft_mkl(const Tensor& input, int64_t signal_ndim,
   throw std::runtime_error("fft: ATen not compiled with MKL support");
 }
 
+int64_t _mkl_fft_get_plan_cache_max_size() {
+  return 0;
+}
+
+void _mkl_fft_set_plan_cache_max_size(int64_t max_size) {
+  throw std::runtime_error("MKL FFT plan cache: ATen not compiled with MKL support");
+}
+
+int64_t _mkl_fft_get_plan_cache_size() {
+  return 0;
+}
+
+int64_t _mkl_fft_get_plan_cache_hits() {
+  return 0;
+}
+
+int64_t _mkl_fft_get_plan_cache_misses() {
+  return 0;
+}
+
+void _mkl_fft_clear_plan_cache() {}
+
 }}
 
 #else // AT_MKL_ENABLED
@@ -25,7 +47,13 @@ Tensor _fft_mkl(const Tensor& input, int64_t signal_ndim,
 #include "ATen/Utils.h"
 #include "ATen/NativeFunctions.h"
 
+#include "ATen/native/utils/ParamsLRUCache.h"
+
 #include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <numeric>
 #include <cmath>
@@ -159,13 +187,148 @@ static inline void _fft_fill_with_conjugate_symmetry_(Tensor& input,
   });
 }
 
+// MKL DFTI descriptors are expensive to create and commit compared to small
+// transforms, so committed descriptors are kept in an LRU cache keyed by
+// everything that went into their configuration.
+constexpr int mkl_fft_max_rank = 3;
+constexpr int64_t MKL_FFT_DEFAULT_PLAN_CACHE_SIZE = 64;
+
+struct MKLFFTParams {
+  ScalarType scalar_type;
+  DFTI_CONFIG_VALUE signal_type;
+  bool complex_input;
+  bool complex_output;
+  bool inverse;
+  bool normalized;
+  int64_t signal_ndim;
+  int64_t signal_sizes[mkl_fft_max_rank];
+  int64_t batch;
+  int64_t idist;
+  int64_t odist;
+  // first value is the offset, which is always zero
+  int64_t istrides[mkl_fft_max_rank + 1];
+  int64_t ostrides[mkl_fft_max_rank + 1];
+};
+
+static inline void setMKLFFTParams(MKLFFTParams* params,
+    const Tensor& input, const Tensor& output, int64_t signal_ndim,
+    bool complex_input, bool complex_output, bool inverse,
+    IntList checked_signal_sizes, bool normalized) {
+  memset(params, 0, sizeof(MKLFFTParams));
+  params->scalar_type = input.type().scalarType();
+  if (!inverse) {
+    params->signal_type = complex_input ? DFTI_COMPLEX : DFTI_REAL;
+  } else {
+    params->signal_type = complex_output ? DFTI_COMPLEX : DFTI_REAL;
+  }
+  params->complex_input = complex_input;
+  params->complex_output = complex_output;
+  params->inverse = inverse;
+  params->normalized = normalized;
+  params->signal_ndim = signal_ndim;
+  std::copy(checked_signal_sizes.begin(), checked_signal_sizes.end(), params->signal_sizes);
+  params->batch = input.size(0);
+  // batch dim stride, i.e., dist between each data
+  auto istrides = input.strides();
+  auto ostrides = output.strides();
+  params->idist = complex_input ? istrides[0] >> 1 : istrides[0];
+  params->odist = complex_output ? ostrides[0] >> 1 : ostrides[0];
+  for (int64_t i = 1; i <= signal_ndim; i++) {
+    params->istrides[i] = complex_input ? istrides[i] >> 1 : istrides[i];
+    params->ostrides[i] = complex_output ? ostrides[i] >> 1 : ostrides[i];
+  }
+}
+
+class MKLFFTConfig {
+public:
+  MKLFFTConfig(const MKLFFTParams& params) : descriptor_(std::make_shared<DftiDescriptor>()) {
+    DftiDescriptor& descriptor = *descriptor_;
+    auto signal_ndim = params.signal_ndim;
+    // precision
+    DFTI_CONFIG_VALUE prec = params.scalar_type == ScalarType::Double ? DFTI_DOUBLE : DFTI_SINGLE;
+    // create descriptor with signal size
+    std::vector<MKL_LONG> mkl_signal_sizes(params.signal_sizes, params.signal_sizes + signal_ndim);
+    descriptor.init(prec, params.signal_type, signal_ndim, mkl_signal_sizes.data());
+    // out of place FFT
+    MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_PLACEMENT, DFTI_NOT_INPLACE));
+    // batch mode
+    MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_NUMBER_OF_TRANSFORMS, (MKL_LONG)params.batch));
+    MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_INPUT_DISTANCE, (MKL_LONG)params.idist));
+    MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_OUTPUT_DISTANCE, (MKL_LONG)params.odist));
+    // signal strides
+    std::vector<MKL_LONG> mkl_istrides(params.istrides, params.istrides + 1 + signal_ndim);
+    std::vector<MKL_LONG> mkl_ostrides(params.ostrides, params.ostrides + 1 + signal_ndim);
+    MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_INPUT_STRIDES, mkl_istrides.data()));
+    MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_OUTPUT_STRIDES, mkl_ostrides.data()));
+    // if conjugate domain of real is involved, set standard CCE storage type
+    // this will become default in MKL in future
+    if (!params.complex_input || !params.complex_output) {
+      MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_CONJUGATE_EVEN_STORAGE, DFTI_COMPLEX_COMPLEX));
+    }
+    // rescale if needed by normalized flag or inverse transform
+    if (params.normalized || params.inverse) {
+      auto signal_numel = std::accumulate(params.signal_sizes, params.signal_sizes + signal_ndim,
+                                          int64_t(1), std::multiplies<int64_t>());
+      double double_scale;
+      if (params.normalized) {
+        double_scale = 1.0 / std::sqrt(static_cast<double>(signal_numel));
+      } else {
+        double_scale = 1.0 / static_cast<double>(signal_numel);
+      }
+      MKL_DFTI_CHECK(DftiSetValue(descriptor.get(),
+        params.inverse ? DFTI_BACKWARD_SCALE : DFTI_FORWARD_SCALE,
+        prec == DFTI_DOUBLE ? double_scale : static_cast<float>(double_scale)));
+    }
+    // finalize
+    MKL_DFTI_CHECK(DftiCommitDescriptor(descriptor.get()));
+  }
+
+  const std::shared_ptr<DftiDescriptor>& descriptor() const { return descriptor_; }
+
+private:
+  std::shared_ptr<DftiDescriptor> descriptor_;
+};
+
+static ParamsLRUCache<MKLFFTParams, MKLFFTConfig> mkl_fft_plan_cache(
+    "MKL FFT plan cache", MKL_FFT_DEFAULT_PLAN_CACHE_SIZE);
+static std::mutex mkl_fft_plan_cache_mutex;
+
+int64_t _mkl_fft_get_plan_cache_max_size() {
+  std::lock_guard<std::mutex> guard(mkl_fft_plan_cache_mutex);
+  return mkl_fft_plan_cache.max_size();
+}
+
+void _mkl_fft_set_plan_cache_max_size(int64_t max_size) {
+  std::lock_guard<std::mutex> guard(mkl_fft_plan_cache_mutex);
+  mkl_fft_plan_cache.resize(max_size);
+}
+
+int64_t _mkl_fft_get_plan_cache_size() {
+  std::lock_guard<std::mutex> guard(mkl_fft_plan_cache_mutex);
+  return mkl_fft_plan_cache.size();
+}
+
+int64_t _mkl_fft_get_plan_cache_hits() {
+  std::lock_guard<std::mutex> guard(mkl_fft_plan_cache_mutex);
+  return mkl_fft_plan_cache.hits();
+}
+
+int64_t _mkl_fft_get_plan_cache_misses() {
+  std::lock_guard<std::mutex> guard(mkl_fft_plan_cache_mutex);
+  return mkl_fft_plan_cache.misses();
+}
+
+void _mkl_fft_clear_plan_cache() {
+  std::lock_guard<std::mutex> guard(mkl_fft_plan_cache_mutex);
+  mkl_fft_plan_cache.clear();
+}
+
 // MKL DFTI
 Tensor _fft_mkl(const Tensor& self, int64_t signal_ndim,
                 bool complex_input, bool complex_output,
                 bool inverse, IntList checked_signal_sizes,
                 bool normalized, bool onesided,
                 IntList output_sizes) {
-  int64_t batch = self.size(0);
   Tensor input = self;
   // real/imag dimension must aligned when viewed as of complex type
   if (complex_input) {
@@ -217,75 +380,37 @@ Tensor _fft_mkl(const Tensor& self, int64_t signal_ndim,
   }
   Tensor output = input.type().tensor(output_sizes);
 
-  // precision
-  DFTI_CONFIG_VALUE prec;
-  if (input.type().scalarType() == ScalarType::Float) {
-    prec = DFTI_SINGLE;
-  } else if (input.type().scalarType() == ScalarType::Double) {
-    prec = DFTI_DOUBLE;
-  } else {
+  if (input.type().scalarType() != ScalarType::Float &&
+      input.type().scalarType() != ScalarType::Double) {
     std::ostringstream ss;
     ss << "MKL FFT doesn't support tensor of type: "
        << at::toString(input.type().scalarType());
     throw std::runtime_error(ss.str());
   }
-  // signal type
-  DFTI_CONFIG_VALUE signal_type;
-  if (!inverse) {
-    signal_type = complex_input ? DFTI_COMPLEX : DFTI_REAL;
-  } else {
-    signal_type = complex_output ? DFTI_COMPLEX : DFTI_REAL;
-  }
-  // create descriptor with signal size
-  std::vector<MKL_LONG> mkl_signal_sizes(checked_signal_sizes.begin(), checked_signal_sizes.end());
-  DftiDescriptor descriptor;
-  descriptor.init(prec, signal_type, signal_ndim, mkl_signal_sizes.data());
-  // out of place FFT
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_PLACEMENT, DFTI_NOT_INPLACE));
-  // batch mode
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_NUMBER_OF_TRANSFORMS, batch));
 
-  auto istrides = input.strides();
-  auto ostrides = output.strides();
-  // batch dim stride, i.e., dist between each data
-  MKL_LONG idist = complex_input ? istrides[0] >> 1 : istrides[0];
-  MKL_LONG odist = complex_output ? ostrides[0] >> 1 : ostrides[0];
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_INPUT_DISTANCE, idist));
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_OUTPUT_DISTANCE, odist));
-  // signal strides
-  // first val is offset, set to zero (ignored)
-  std::vector<MKL_LONG> mkl_istrides(1 + signal_ndim, 0), mkl_ostrides(1 + signal_ndim, 0);
-  for (int64_t i = 1; i <= signal_ndim; i++) {
-    mkl_istrides[i] = complex_input ? istrides[i] >> 1 : istrides[i];
-    mkl_ostrides[i] = complex_output ? ostrides[i] >> 1 : ostrides[i];
-  }
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_INPUT_STRIDES, mkl_istrides.data()));
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_OUTPUT_STRIDES, mkl_ostrides.data()));
-  // if conjugate domain of real is involved, set standard CCE storage type
-  // this will become default in MKL in future
-  if (!complex_input || !complex_output) {
-    MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_CONJUGATE_EVEN_STORAGE, DFTI_COMPLEX_COMPLEX));
-  }
-  // rescale if needed by normalized flag or inverse transform
-  if (normalized || inverse) {
-    auto signal_numel = at::prod_intlist(checked_signal_sizes);
-    double double_scale;
-    if (normalized) {
-      double_scale = 1.0 / std::sqrt(static_cast<double>(signal_numel));
-    } else {
-      double_scale = 1.0 / static_cast<double>(signal_numel);
+  MKLFFTParams params;
+  setMKLFFTParams(&params, input, output, signal_ndim, complex_input,
+                  complex_output, inverse, checked_signal_sizes, normalized);
+
+  // Committed descriptors are safe to compute with from several threads, so
+  // only the lookup holds the lock. The shared_ptr keeps the descriptor alive
+  // if another thread evicts it in the meantime.
+  std::shared_ptr<DftiDescriptor> descriptor;
+  {
+    std::lock_guard<std::mutex> guard(mkl_fft_plan_cache_mutex);
+    if (mkl_fft_plan_cache.max_size() > 0) {
+      descriptor = mkl_fft_plan_cache.try_emplace_value(params, params).descriptor();
     }
-    MKL_DFTI_CHECK(DftiSetValue(descriptor.get(),
-      inverse ? DFTI_BACKWARD_SCALE : DFTI_FORWARD_SCALE,
-      prec == DFTI_DOUBLE ? double_scale : static_cast<float>(double_scale)));
   }
-  // finalize
-  MKL_DFTI_CHECK(DftiCommitDescriptor(descriptor.get()));
+  if (!descriptor) {
+    descriptor = MKLFFTConfig(params).descriptor();
+  }
+
   // run
   if (!inverse) {
-    MKL_DFTI_CHECK(DftiComputeForward(descriptor.get(), input.data_ptr(), output.data_ptr()));
+    MKL_DFTI_CHECK(DftiComputeForward(descriptor->get(), input.data_ptr(), output.data_ptr()));
   } else {
-    MKL_DFTI_CHECK(DftiComputeBackward(descriptor.get(), input.data_ptr(), output.data_ptr()));
+    MKL_DFTI_CHECK(DftiComputeBackward(descriptor->get(), input.data_ptr(), output.data_ptr()));
   }
   // now if needed, fill out the other half using Hermitian symmetry dim
   if (!complex_input && complex_output && !onesided) {
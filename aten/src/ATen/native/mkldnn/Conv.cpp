@@ -30,11 +30,33 @@ std::tuple<at::Tensor,at::Tensor,at::Tensor> mkldnn_convolution_backward(
   throw std::runtime_error("mkldnn_convolution_backward: ATen not compiled with MKLDNN support");
 }
 
+int64_t _mkldnn_get_weight_cache_size() {
+  throw std::runtime_error("_mkldnn_get_weight_cache_size: ATen not compiled with MKLDNN support");
+}
+
+int64_t _mkldnn_get_weight_cache_max_size() {
+  throw std::runtime_error("_mkldnn_get_weight_cache_max_size: ATen not compiled with MKLDNN support");
+}
+
+void _mkldnn_set_weight_cache_max_size(int64_t max_size) {
+  throw std::runtime_error("_mkldnn_set_weight_cache_max_size: ATen not compiled with MKLDNN support");
+}
+
+void _mkldnn_clear_weight_cache() {
+  throw std::runtime_error("_mkldnn_clear_weight_cache: ATen not compiled with MKLDNN support");
+}
+
 }}
 
 #else // AT_MKLDNN_EBABLED
 
 #include <ATen/mkldnn/Runtime.h>
+#include <ATen/native/utils/ParamsHash.h>
+
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
 
 using namespace mkldnn;
 
@@ -66,12 +88,136 @@ std::vector<int64_t> conv_output_size(
   return output_size;
 }
 
+// The inputs are either contiguous or channels last, see Note [Channels last]
+static bool is_nhwc(const Tensor& tensor) {
+  return suggest_memory_format(tensor.sizes(), tensor.strides()) == MemoryFormat::ChannelsLast;
+}
+
+static memory::format data_format(const Tensor& tensor) {
+  return is_nhwc(tensor) ? memory::format::nhwc : memory::format::nchw;
+}
+
+static Tensor empty_like_format(const Tensor& self, IntList sizes, bool channels_last) {
+  if (channels_last) {
+    return self.type().tensor(sizes, get_channels_last_strides(sizes));
+  }
+  return self.type().tensor(sizes);
+}
+
+// Note [MKL-DNN weight cache]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// MKL-DNN convolutions want their weights in a blocked format, and
+// reordering the weights on every call dominates small-batch inference. The
+// weight cache keeps the reordered weights of the most recently used
+// convolutions, keyed by the weight's data pointer, sizes and the blocked
+// format. ATen doesn't see the version counter of a Variable, so the cache
+// can't notice a weight being modified in place. It is therefore disabled
+// (max_size is 0) unless it's turned on, which is only safe when the weights
+// aren't modified, e.g. for inference. Each entry holds a reference to its
+// weight, so the data pointer can't be reused by another tensor while the
+// entry exists.
+//
+// Only the forward convolution uses the cache; the backward functions are
+// for training, where the weights change.
+
+struct WeightCacheKey {
+  void* data;
+  memory::dims::value_type dims[2 + max_dim];
+  int32_t format;
+};
+
+class WeightCache {
+public:
+  // Returns true and sets `reordered` if there is an entry for `key`
+  bool find(const WeightCacheKey& key, memory* reordered) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = map_.find(key);
+    if (it == map_.end()) {
+      return false;
+    }
+    // move to the front of the usage list
+    list_.splice(list_.begin(), list_, it->second);
+    *reordered = it->second->reordered;
+    return true;
+  }
+
+  void insert(const WeightCacheKey& key, const Tensor& weight, const memory& reordered) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (max_size_ == 0 || map_.count(key)) {
+      return;
+    }
+    if (list_.size() >= max_size_) {
+      map_.erase(list_.back().key);
+      list_.pop_back();
+    }
+    list_.push_front(Entry{key, weight, reordered});
+    map_.emplace(key, list_.begin());
+  }
+
+  size_t size() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return list_.size();
+  }
+
+  size_t max_size() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return max_size_;
+  }
+
+  void set_max_size(int64_t max_size) {
+    AT_CHECK(max_size >= 0, "MKL-DNN weight cache size must be non-negative, but got ", max_size);
+    std::lock_guard<std::mutex> guard(mutex_);
+    max_size_ = max_size;
+    while (list_.size() > max_size_) {
+      map_.erase(list_.back().key);
+      list_.pop_back();
+    }
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    map_.clear();
+    list_.clear();
+  }
+
+private:
+  struct Entry {
+    WeightCacheKey key;
+    Tensor weight;
+    memory reordered;
+  };
+
+  std::mutex mutex_;
+  std::list<Entry> list_;
+  std::unordered_map<WeightCacheKey, std::list<Entry>::iterator,
+                     ParamsHash<WeightCacheKey>, ParamsEqual<WeightCacheKey>> map_;
+  size_t max_size_ = 0;
+};
+
+static WeightCache& weight_cache() {
+  static WeightCache cache;
+  return cache;
+}
+
+static WeightCacheKey weight_cache_key(
+    const Tensor& weight, const memory::dims& weight_tz, const memory::primitive_desc& weight_pd) {
+  WeightCacheKey key;
+  // the key is hashed and compared as raw bytes, so clear the padding
+  memset(&key, 0, sizeof(key));
+  key.data = weight.data_ptr();
+  for (size_t i = 0; i < weight_tz.size(); i++) {
+    key.dims[i] = weight_tz[i];
+  }
+  key.format = weight_pd.desc().data.format;
+  return key;
+}
+
 at::Tensor mkldnn_convolution(
     const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
     IntList padding, IntList stride, IntList dilation, int64_t groups)
 {
-  auto output = input.type().tensor(conv_output_size(
-    input.sizes(), weight.sizes(), padding, stride, dilation, groups));
+  auto output = empty_like_format(input, conv_output_size(
+    input.sizes(), weight.sizes(), padding, stride, dilation, groups), is_nhwc(input));
 
   auto cpu_engine = CpuEngine::Instance().get_engine();
 
@@ -96,7 +242,6 @@ at::Tensor mkldnn_convolution(
 
   auto data_t = memory::data_type::f32;
   auto format_any = memory::format::any;
-  auto format_nchw = memory::format::nchw;
   auto format_weight = (g!= 1) ? memory::format::goihw : memory::format::oihw;
   auto format_x = memory::format::x;
 
@@ -127,11 +272,11 @@ at::Tensor mkldnn_convolution(
   conv_forward_pd.reset(new convolution_forward::primitive_desc(
     *conv_forward_desc, cpu_engine));
 
-  auto input_usr_memory = memory({{{input_tz}, data_t, format_nchw}, cpu_engine},
+  auto input_usr_memory = memory({{{input_tz}, data_t, data_format(input)}, cpu_engine},
     input.data_ptr());
   auto weight_usr_memory = memory({{{weight_tz}, data_t,  format_weight}, cpu_engine},
     weight.data_ptr());
-  auto output_usr_memory = memory({{{output_tz}, data_t, format_nchw}, cpu_engine},
+  auto output_usr_memory = memory({{{output_tz}, data_t, data_format(output)}, cpu_engine},
     output.data_ptr());
 
   std::vector<primitive> net;
@@ -146,8 +291,22 @@ at::Tensor mkldnn_convolution(
   auto weight_pd = conv_forward_pd->weights_primitive_desc();
   auto weight_memory = weight_usr_memory;
   if (weight_usr_memory.get_primitive_desc() != memory::primitive_desc(weight_pd)) {
-    weight_memory = memory(weight_pd);
-    net.push_back(reorder(weight_usr_memory, weight_memory));
+    // See Note [MKL-DNN weight cache]
+    auto& cache = weight_cache();
+    if (cache.max_size() == 0) {
+      weight_memory = memory(weight_pd);
+      net.push_back(reorder(weight_usr_memory, weight_memory));
+    } else {
+      auto key = weight_cache_key(weight, weight_tz, weight_pd);
+      if (!cache.find(key, &weight_memory)) {
+        // reorder right away, so that other threads never see an entry
+        // whose reorder hasn't run yet
+        weight_memory = memory(weight_pd);
+        std::vector<primitive> reorder_net{reorder(weight_usr_memory, weight_memory)};
+        Stream::Instance().get_stream().submit(reorder_net);
+        cache.insert(key, weight, weight_memory);
+      }
+    }
   }
 
   auto output_pd = conv_forward_pd->dst_primitive_desc();
@@ -182,7 +341,7 @@ Tensor mkldnn_convolution_backward_input(
     IntList input_size, const at::Tensor& grad_output, const at::Tensor& weight,
     IntList padding, IntList stride, IntList dilation, int64_t groups, bool bias_defined)
 {
-  auto grad_input = grad_output.type().tensor(input_size);
+  auto grad_input = empty_like_format(grad_output, input_size, is_nhwc(grad_output));
 
   auto cpu_engine = CpuEngine::Instance().get_engine();
 
@@ -207,7 +366,6 @@ Tensor mkldnn_convolution_backward_input(
 
   auto data_t = memory::data_type::f32;
   auto format_any = memory::format::any;
-  auto format_nchw = memory::format::nchw;
   auto format_weight = (g!= 1) ? memory::format::goihw : memory::format::oihw;
 
   memory::dims input_tz = {n, ic, ih, iw};
@@ -247,11 +405,11 @@ Tensor mkldnn_convolution_backward_input(
   conv_backward_data_pd.reset(new convolution_backward_data::primitive_desc(
     *conv_backward_data_desc, cpu_engine, *conv_forward_pd));
 
-  auto grad_output_usr_memory = memory({{{output_tz}, data_t, format_nchw}, cpu_engine},
+  auto grad_output_usr_memory = memory({{{output_tz}, data_t, data_format(grad_output)}, cpu_engine},
     grad_output.data_ptr());
   auto weight_usr_memory = memory({{{weight_tz}, data_t, format_weight}, cpu_engine},
     weight.data_ptr());
-  auto grad_input_usr_memory = memory({{{input_tz}, data_t, format_nchw}, cpu_engine},
+  auto grad_input_usr_memory = memory({{{input_tz}, data_t, data_format(grad_input)}, cpu_engine},
     grad_input.data_ptr());
 
   std::vector<primitive> net;
@@ -324,7 +482,6 @@ std::tuple<at::Tensor, at::Tensor> mkldnn_convolution_backward_weights(
 
   auto data_t = memory::data_type::f32;
   auto format_any = memory::format::any;
-  auto format_nchw = memory::format::nchw;
   auto format_weight = (g!= 1) ? memory::format::goihw : memory::format::oihw;
   auto format_x = memory::format::x;
 
@@ -371,9 +528,9 @@ std::tuple<at::Tensor, at::Tensor> mkldnn_convolution_backward_weights(
   conv_backward_weight_pd.reset(new convolution_backward_weights::primitive_desc(
     *conv_backward_weight_desc, cpu_engine, *conv_forward_pd));
 
-  auto input_usr_memory = memory({{{input_tz}, data_t, format_nchw}, cpu_engine},
+  auto input_usr_memory = memory({{{input_tz}, data_t, data_format(input)}, cpu_engine},
     input.data_ptr());
-  auto grad_output_usr_memory = memory({{{output_tz}, data_t, format_nchw}, cpu_engine},
+  auto grad_output_usr_memory = memory({{{output_tz}, data_t, data_format(grad_output)}, cpu_engine},
     grad_output.data_ptr());
   auto grad_weight_usr_memory = memory({{{weight_tz}, data_t, format_weight}, cpu_engine},
     grad_weight.data_ptr());
@@ -427,7 +584,8 @@ std::tuple<at::Tensor,at::Tensor,at::Tensor> mkldnn_convolution_backward(
     const at::Tensor& input, const at::Tensor& grad_output_t, const at::Tensor& weight,
     IntList padding, IntList stride, IntList dilation, int64_t groups, std::array<bool,3> output_mask)
 {
-  Tensor grad_output = grad_output_t.contiguous();
+  // grad_output uses the memory format of the input, and so does grad_input
+  Tensor grad_output = is_nhwc(input) ? grad_output_t.to_channels_last() : grad_output_t.contiguous();
 
   Tensor grad_input, grad_weight, grad_bias;
   if (output_mask[0]) {
@@ -442,6 +600,22 @@ std::tuple<at::Tensor,at::Tensor,at::Tensor> mkldnn_convolution_backward(
   return std::tuple<Tensor, Tensor, Tensor>{grad_input, grad_weight, grad_bias};
 }
 
+int64_t _mkldnn_get_weight_cache_size() {
+  return weight_cache().size();
+}
+
+int64_t _mkldnn_get_weight_cache_max_size() {
+  return weight_cache().max_size();
+}
+
+void _mkldnn_set_weight_cache_max_size(int64_t max_size) {
+  weight_cache().set_max_size(max_size);
+}
+
+void _mkldnn_clear_weight_cache() {
+  weight_cache().clear();
+}
+
 }}  // namespace at::native
 
 #endif
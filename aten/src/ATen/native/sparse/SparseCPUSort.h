@@ -0,0 +1,137 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Parallel, stable sorting of int64 keys for the CPU sparse kernels.
+//
+// Stability is what keeps these kernels deterministic: entries with equal
+// keys keep their input order whatever the number of threads, so duplicate
+// entries are always summed in the same order.
+
+namespace at { namespace native { namespace sparse {
+
+constexpr int kRadixBits = 8;
+constexpr int64_t kRadixBuckets = int64_t(1) << kRadixBits;
+
+// The number of chunks the passes below split [0, n) into. Each chunk is
+// counted and scattered by one task, in chunk order.
+inline int64_t sort_num_chunks(int64_t n) {
+  return std::max<int64_t>(1, std::min<int64_t>(get_num_threads(), divup(n, internal::GRAIN_SIZE)));
+}
+
+// One stable counting sort pass: moves keys_in[i] and perm_in[i] (or i, if
+// perm_in is null) to keys_out and perm_out, ordered by bucket(keys_in[i]),
+// which must be in [0, num_buckets). Returns the start of every bucket in
+// the output, plus n at the end.
+template <typename BucketFn>
+std::vector<int64_t> counting_sort_pass(
+    int64_t n, int64_t num_buckets, const int64_t* keys_in, const int64_t* perm_in,
+    int64_t* keys_out, int64_t* perm_out, const BucketFn& bucket) {
+  const int64_t num_chunks = sort_num_chunks(n);
+  const int64_t chunk_size = divup(n, num_chunks);
+  // offsets[c * num_buckets + b] is where chunk c puts its next key of bucket b
+  std::vector<int64_t> offsets(num_chunks * num_buckets, 0);
+  parallel_for(0, num_chunks, 1, [&](int64_t c_begin, int64_t c_end) {
+    for (int64_t c = c_begin; c < c_end; c++) {
+      int64_t* count = offsets.data() + c * num_buckets;
+      const int64_t end = std::min(n, (c + 1) * chunk_size);
+      for (int64_t i = c * chunk_size; i < end; i++) {
+        count[bucket(keys_in[i])]++;
+      }
+    }
+  });
+
+  std::vector<int64_t> bucket_starts(num_buckets + 1);
+  int64_t total = 0;
+  for (int64_t b = 0; b < num_buckets; b++) {
+    bucket_starts[b] = total;
+    for (int64_t c = 0; c < num_chunks; c++) {
+      int64_t count = offsets[c * num_buckets + b];
+      offsets[c * num_buckets + b] = total;
+      total += count;
+    }
+  }
+  bucket_starts[num_buckets] = total;
+
+  parallel_for(0, num_chunks, 1, [&](int64_t c_begin, int64_t c_end) {
+    for (int64_t c = c_begin; c < c_end; c++) {
+      int64_t* offset = offsets.data() + c * num_buckets;
+      const int64_t end = std::min(n, (c + 1) * chunk_size);
+      for (int64_t i = c * chunk_size; i < end; i++) {
+        int64_t pos = offset[bucket(keys_in[i])]++;
+        keys_out[pos] = keys_in[i];
+        perm_out[pos] = perm_in ? perm_in[i] : i;
+      }
+    }
+  });
+  return bucket_starts;
+}
+
+// Sorts the n keys, all in [0, max_key], with a least significant digit
+// radix sort. sorted_keys gets the sorted keys and perm the input position
+// of each of them. Only the digits that max_key needs are sorted on.
+inline void radix_sort(int64_t n, int64_t max_key, const int64_t* keys,
+                       int64_t* sorted_keys, int64_t* perm) {
+  int passes = 0;
+  for (uint64_t m = static_cast<uint64_t>(max_key); m > 0; m >>= kRadixBits) {
+    passes++;
+  }
+  if (passes == 0) {
+    std::copy(keys, keys + n, sorted_keys);
+    for (int64_t i = 0; i < n; i++) {
+      perm[i] = i;
+    }
+    return;
+  }
+
+  std::vector<int64_t> keys_tmp(n);
+  std::vector<int64_t> perm_tmp(n);
+  const int64_t* keys_in = keys;
+  const int64_t* perm_in = nullptr;
+  for (int pass = 0; pass < passes; pass++) {
+    // alternate between the buffers so that the last pass ends up in the
+    // outputs
+    bool to_output = (passes - 1 - pass) % 2 == 0;
+    int64_t* keys_out = to_output ? sorted_keys : keys_tmp.data();
+    int64_t* perm_out = to_output ? perm : perm_tmp.data();
+    const int shift = pass * kRadixBits;
+    counting_sort_pass(n, kRadixBuckets, keys_in, perm_in, keys_out, perm_out,
+                       [shift](int64_t key) { return (key >> shift) & (kRadixBuckets - 1); });
+    keys_in = keys_out;
+    perm_in = perm_out;
+  }
+}
+
+// The row-major offset of every index of a sparse tensor of the given size
+// into its sparse dimensions, which orders like the indices themselves.
+// Returns the largest possible key in max_key.
+inline Tensor flatten_indices_cpu(const Tensor& indices, IntList sizes, int64_t& max_key) {
+  const int64_t sparseDims = indices.size(0);
+  const int64_t nnz = indices.size(1);
+  max_key = 1;
+  for (int64_t d = 0; d < sparseDims; d++) {
+    max_key *= sizes[d];
+  }
+  max_key -= 1;
+
+  Tensor keys = at::empty({nnz}, indices.options());
+  int64_t* keys_ptr = keys.data<int64_t>();
+  auto indices_accessor = indices.accessor<int64_t, 2>();
+  parallel_for(0, nnz, internal::GRAIN_SIZE / std::max<int64_t>(sparseDims, 1), [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      int64_t key = 0;
+      for (int64_t d = 0; d < sparseDims; d++) {
+        key = key * sizes[d] + indices_accessor[d][i];
+      }
+      keys_ptr[i] = key;
+    }
+  });
+  return keys;
+}
+
+}}} // namespace at::native::sparse
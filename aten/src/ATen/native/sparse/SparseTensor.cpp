@@ -3,10 +3,15 @@
 #include <ATen/ATen.h>
 #include <ATen/SparseTensorImpl.h>
 #include <ATen/NativeFunctions.h>
+#include <ATen/Parallel.h>
+#include <ATen/native/sparse/SparseCPUSort.h>
 #include <ATen/native/sparse/SparseUtils.h>
 
 #include <TH/THBlasUtils.h>
 
+#include <algorithm>
+#include <vector>
+
 namespace at { namespace native {
 
 /******************************************************************************
@@ -53,6 +58,28 @@ Tensor _values_sparse(const SparseTensor& self) {
   return _get_sparse_impl(self)->values().narrow(0, 0, nnz);
 }
 
+// The CSR row pointers of a coalesced sparse matrix: row r holds entries
+// crow_indices[r] up to crow_indices[r+1]. They are cached on the tensor
+// until its indices change, so that repeated sparse x dense products with the
+// same matrix do not rebuild them.
+Tensor _crow_indices_sparse(const SparseTensor& self) {
+  AT_CHECK(self._sparseDims() == 2 && self._denseDims() == 0,
+           "_crow_indices: expected a sparse matrix with scalar values, but got ",
+           self._sparseDims(), " sparse and ", self._denseDims(), " dense dimensions");
+  AT_CHECK(self.is_coalesced(), "_crow_indices: expected a coalesced tensor");
+  SparseTensorImpl* impl = _get_sparse_impl(self);
+  if (!impl->crow_indices().defined()) {
+    int64_t dim = self.size(0);
+    LongTensor crow_indices = at::zeros({dim + 1}, impl->indices().options());
+    if (self._nnz() > 0) {
+      LongTensor counts = at::bincount(self._indices().select(0, 0), {}, dim);
+      crow_indices.narrow(0, 1, dim).copy_(counts.cumsum(0));
+    }
+    impl->set_crow_indices(crow_indices);
+  }
+  return impl->crow_indices();
+}
+
 /******************************************************************************
  * creation methods
  ******************************************************************************/
@@ -189,6 +216,63 @@ SparseTensor new_with_tensor_and_size_sparse(const LongTensor& indices, const Te
   return _new_with_dims_and_tensor_sparse(dtype, sparseDims, denseDims, sizes, indices, values);
 }
 
+// A sparse matrix from its CSR form. When the columns of every row are
+// strictly increasing, which is the canonical form, the result is marked
+// coalesced and keeps crow_indices as its cached row pointers.
+SparseTensor new_with_csr_sparse(const LongTensor& crow_indices_, const LongTensor& col_indices, const Tensor& values, ArrayRef<int64_t> sizes) {
+  AT_CHECK(sizes.size() == 2, "from_csr: expected the size of a matrix, but got ", sizes);
+  AT_CHECK(values.dim() == 1, "from_csr: expected 1D values, but got ", values.dim(), "D values");
+  AT_CHECK(col_indices.dim() == 1 && col_indices.size(0) == values.size(0),
+           "from_csr: expected one column index per value, but got ", col_indices.sizes(),
+           " column indices and ", values.size(0), " values");
+  int64_t dim = sizes[0];
+  int64_t nnz = values.size(0);
+  AT_CHECK(crow_indices_.dim() == 1 && crow_indices_.size(0) == dim + 1,
+           "from_csr: expected ", dim + 1, " row pointers, but got ", crow_indices_.sizes());
+  LongTensor crow_indices = crow_indices_.contiguous();
+
+  // NB: the row pointers are checked on the CPU; there are only dim + 1 of them
+  LongTensor cpu_crow_indices;
+  if (crow_indices.is_cuda()) {
+    cpu_crow_indices = at::CPU(kLong).copy(crow_indices);
+  } else {
+    cpu_crow_indices = crow_indices;
+  }
+  auto cpu_crow_accessor = cpu_crow_indices.accessor<int64_t, 1>();
+  AT_CHECK(cpu_crow_accessor[0] == 0 && cpu_crow_accessor[dim] == nnz,
+           "from_csr: row pointers must start at 0 and end at nnz (", nnz, "), but got ",
+           cpu_crow_accessor[0], " and ", cpu_crow_accessor[dim]);
+  for (int64_t r = 0; r < dim; r++) {
+    AT_CHECK(cpu_crow_accessor[r] <= cpu_crow_accessor[r + 1],
+             "from_csr: row pointers must be non-decreasing, but row ", r, " starts at ",
+             cpu_crow_accessor[r], " and ends at ", cpu_crow_accessor[r + 1]);
+  }
+
+  // The row of entry i is the number of rows after the first that start at
+  // or before i: mark the start of every row and take the running sum.
+  LongTensor rows = at::zeros({nnz + 1}, crow_indices.options());
+  if (dim > 1) {
+    rows.index_add_(0, crow_indices.narrow(0, 1, dim - 1),
+                    at::ones({dim - 1}, crow_indices.options()));
+  }
+  rows = rows.narrow(0, 0, nnz).cumsum(0);
+
+  LongTensor indices = at::stack({rows, col_indices.toType(crow_indices.type())});
+  SparseTensor self = new_with_tensor_and_size_sparse(indices, values, sizes);
+
+  bool canonical = true;
+  if (nnz > 1) {
+    auto new_row = rows.narrow(0, 1, nnz - 1).ne(rows.narrow(0, 0, nnz - 1));
+    auto increasing = indices[1].narrow(0, 1, nnz - 1).gt(indices[1].narrow(0, 0, nnz - 1));
+    canonical = new_row.__or__(increasing).all().toCByte();
+  }
+  if (canonical) {
+    _get_sparse_impl(self)->set_coalesced(true);
+    _get_sparse_impl(self)->set_crow_indices(crow_indices);
+  }
+  return self;
+}
+
 // NB: Deleted newWithSizeNd variants
 
 SparseTensor clone_sparse(const SparseTensor& self) {
@@ -277,14 +361,25 @@ SparseTensor coalesce_sparse_cpu(const SparseTensor& self) {
   int64_t denseDims = self._denseDims();
   int64_t nnz = self._nnz();
 
-  LongTensor indices_scalar = at::zeros({nnz}, kLong);
-
-  int64_t factor = 1;
-  for (int64_t d = sparseDims - 1; d >= 0; d--) {
-    LongTensor indices_slice = indices.select(0, d);
-    indices_scalar.add_(indices_slice, factor); // cadd is swapped args
-    factor *= self.size(d);
+  // Sort the entries by their flattened index with a stable radix sort, so
+  // that duplicates are summed in their input order
+  int64_t max_key;
+  LongTensor keys = sparse::flatten_indices_cpu(indices, self.sizes(), max_key);
+  LongTensor indicesBuffer = at::empty({nnz}, kLong);
+  LongTensor indicesPermutation = at::empty({nnz}, kLong);
+  sparse::radix_sort(nnz, max_key, keys.data<int64_t>(),
+                     indicesBuffer.data<int64_t>(), indicesPermutation.data<int64_t>());
+
+  // The start of every run of equal keys in the sorted order
+  const int64_t* sorted_keys = indicesBuffer.data<int64_t>();
+  std::vector<int64_t> segments;
+  for (int64_t j = 0; j < nnz; j++) {
+    if (j == 0 || sorted_keys[j] != sorted_keys[j - 1]) {
+      segments.push_back(j);
+    }
   }
+  const int64_t newNnz = segments.size();
+  segments.push_back(nnz);
 
   SparseTensor dst = new_sparse(self.type());
   _raw_resize_sparse(dst, sparseDims, denseDims, self.sizes());
@@ -293,40 +388,34 @@ SparseTensor coalesce_sparse_cpu(const SparseTensor& self) {
   Tensor newValues = values.type().tensor(values.sizes());
   _alias_into_sparse(dst, newIndices, newValues);
 
-  LongTensor indicesBuffer;
-  LongTensor indicesPermutation;
-  std::tie(indicesBuffer, indicesPermutation) = indices_scalar.sort(0);
   // NB: The accessor accesses here rely on self._nnz() > 0 (tested earlier in this function)
   auto newIndicesAccessor = newIndices.accessor<int64_t, 2>();
   auto indicesAccessor = indices.accessor<int64_t, 2>();
-  auto indicesPermutationAccessor = indicesPermutation.accessor<int64_t, 1>();
-  auto indicesBufferAccessor = indicesBuffer.accessor<int64_t, 1>();
+  const int64_t* perm = indicesPermutation.data<int64_t>();
 
-  int64_t i = -1;
   AT_DISPATCH_ALL_TYPES(
       values.type(), "coalesce", [&] {
-        int64_t prev = -1;
         int64_t blockSize = values.stride(0);
         scalar_t* values_ptr = values.data<scalar_t>();
         scalar_t* newValues_ptr = newValues.data<scalar_t>();
-        for (int64_t j = 0; j < nnz; j++) {
-          int64_t pos = indicesPermutationAccessor[j];
-          int64_t curr = indicesBufferAccessor[j];
-          if (curr == prev) {
-            THBlas_axpy<scalar_t>(blockSize, 1, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
-          } else {
-            ++i;
+        // every output entry is written by one thread only
+        int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / (blockSize * std::max<int64_t>(1, nnz / newNnz)));
+        parallel_for(0, newNnz, grain_size, [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; i++) {
+            int64_t pos = perm[segments[i]];
             for (int64_t d = 0; d < sparseDims; d++) {
               newIndicesAccessor[d][i] = indicesAccessor[d][pos];
             }
             THBlas_copy<scalar_t>(blockSize, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
+            for (int64_t j = segments[i] + 1; j < segments[i + 1]; j++) {
+              THBlas_axpy<scalar_t>(blockSize, 1, values_ptr + perm[j] * blockSize, 1, newValues_ptr + i * blockSize, 1);
+            }
           }
-          prev = curr;
-        }
+        });
     });
 
   _get_sparse_impl(dst)->set_coalesced(true);
-  _get_sparse_impl(dst)->set_nnz(i + 1);
+  _get_sparse_impl(dst)->set_nnz(newNnz);
 
   return dst;
 }
@@ -2,38 +2,16 @@
 #include <ATen/SparseTensorImpl.h>
 #include <ATen/ExpandUtils.h>
 #include <ATen/NativeFunctions.h>
+#include <ATen/Parallel.h>
+#include <ATen/native/sparse/SparseCPUSort.h>
 #include <ATen/native/sparse/SparseUtils.h>
 
 #include <TH/THBlasUtils.h>
 
-namespace at { namespace native {
-
-// --------------------------------------------------------------------
-// Utility functions
-// --------------------------------------------------------------------
-
-namespace {
-  LongTensor _to_csr(const int64_t* indices, int64_t dim, int64_t nnz) {
-    int64_t h, i, hp0, hp1;
-    LongTensor csr = native::zeros({dim + 1}, kLong);
-
-    // TODO: eliminate this conditional when zero-size dims supported correctly
-    if (nnz > 0) {
-      auto csr_accessor = csr.accessor<int64_t, 1>();
-      // Convert the sparse matrix to CSR format
-#pragma omp parallel for private(i, h, hp0, hp1) schedule(static) if (nnz > 10000)
-      for (i=0; i<nnz; i++) {
-        hp0 = indices[i];
-        hp1 = (i+1 == nnz) ?  dim : indices[i+1];
-        if (hp0 != hp1) for (h = hp0; h < hp1; h++) {
-          csr_accessor[h+1] = i+1;
-        }
-      }
-    }
-    return csr;
-  }
+#include <algorithm>
+#include <vector>
 
-}
+namespace at { namespace native {
 
 // --------------------------------------------------------------------
 // zero_(SparseTensor)
@@ -307,6 +285,57 @@ void add_dense_sparse_worker_cpu(Tensor& r, Scalar value, const SparseTensor& sp
   }
 }
 
+// Adds the entries of an uncoalesced sparse tensor to a contiguous r without
+// coalescing it first. keys are the flattened sparse indices. The entries
+// are bucketed by which of the stripes of r they land in, with a stable
+// counting sort, and every thread then adds its stripes' entries in their
+// input order, so the result does not depend on the number of threads.
+template <typename scalar_t>
+void add_dense_sparse_fused_worker_cpu(Tensor& r, Scalar value, const Tensor& keys, int64_t max_key, const Tensor& values, bool coalesced) {
+  const int64_t nnz = keys.size(0);
+  const int64_t blockSize = values.numel() / nnz;
+  const int64_t* keys_ptr = keys.data<int64_t>();
+  const scalar_t* values_ptr = values.data<scalar_t>();
+  scalar_t* r_ptr = r.data<scalar_t>();
+  scalar_t cast_value = value.to<scalar_t>();
+
+  auto add_entry = [&](int64_t k) {
+    scalar_t* dst = r_ptr + keys_ptr[k] * blockSize;
+    const scalar_t* src = values_ptr + k * blockSize;
+    if (blockSize == 1) {
+      *dst += cast_value * *src;
+    } else {
+      THBlas_axpy<scalar_t>(blockSize, cast_value, const_cast<scalar_t*>(src), 1, dst, 1);
+    }
+  };
+
+  const int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(blockSize, 1));
+  if (coalesced) {
+    // the destinations are distinct
+    parallel_for(0, nnz, grain_size, [&](int64_t begin, int64_t end) {
+      for (int64_t k = begin; k < end; k++) {
+        add_entry(k);
+      }
+    });
+    return;
+  }
+
+  const int64_t num_stripes = sparse::sort_num_chunks(nnz);
+  const int64_t stripe_size = max_key / num_stripes + 1;
+  std::vector<int64_t> sorted_keys(nnz);
+  std::vector<int64_t> perm(nnz);
+  std::vector<int64_t> stripe_starts = sparse::counting_sort_pass(
+      nnz, num_stripes, keys_ptr, nullptr, sorted_keys.data(), perm.data(),
+      [stripe_size](int64_t key) { return key / stripe_size; });
+  parallel_for(0, num_stripes, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t stripe = begin; stripe < end; stripe++) {
+      for (int64_t j = stripe_starts[stripe]; j < stripe_starts[stripe + 1]; j++) {
+        add_entry(perm[j]);
+      }
+    }
+  });
+}
+
 Tensor& add_out_dense_sparse_cpu(Tensor& r, const Tensor& dense, SparseTensorRef sparse__, Scalar value) {
   const SparseTensor& sparse_ = sparse__.tref;
 
@@ -322,6 +351,25 @@ Tensor& add_out_dense_sparse_cpu(Tensor& r, const Tensor& dense, SparseTensorRef
     dense.sizes(), " while other has size ", sparse_.sizes(), " (FYI: dense-sparse addition does not currently support broadcasting)");
 
   r.resize_as_(dense);
+
+  // Contiguous outputs take the sparse entries as they are, without
+  // coalescing them first
+  int64_t sparseDims = sparse_._sparseDims();
+  if (r.is_contiguous() && sparse_._nnz() > 0 &&
+      sparse_._values().sizes().slice(1).equals(dense.sizes().slice(sparseDims))) {
+    if (!isSameTensor(r, dense)) r.copy_(dense);
+    int64_t max_key;
+    LongTensor keys = sparse::flatten_indices_cpu(sparse_._indices(), sparse_.sizes(), max_key);
+    AT_CHECK(keys.min().toCLong() >= 0 && keys.max().toCLong() <= max_key,
+             "add: sparse indices out of bounds for size ", sparse_.sizes());
+    Tensor values = sparse_._values().contiguous();
+    AT_DISPATCH_ALL_TYPES(
+        values.type(), "add_dense_sparse", [&] {
+          add_dense_sparse_fused_worker_cpu<scalar_t>(r, value, keys, max_key, values, sparse_.is_coalesced());
+        });
+    return r;
+  }
+
   SparseTensor sparse = sparse_.coalesce();
 
   LongTensor indices = sparse._indices();
@@ -458,11 +506,8 @@ SparseTensor& mul_out_sparse_cpu(SparseTensor& r, const Tensor& t_, const Tensor
 // addmm(Tensor, SparseTensorRef, Tensor, Scalar, Scalar)  [broadcasts]
 // --------------------------------------------------------------------
 
-// NB: OMP pragmas have to get their own functions; can't put them in lambdas
 template <typename scalar_t>
 void s_addmm_out_sparse_dense_worker(int64_t nnz, int64_t dim_i, int64_t dim_j, int64_t dim_k, Tensor& r, Scalar beta, const Tensor& t, Scalar alpha, const Tensor& csr, const Tensor& indices, const Tensor& values, const Tensor& dense) {
-  int64_t h, i;
-
   // r_ = alpha * sparse * dense
   scalar_t cast_alpha = alpha.to<scalar_t>();
   scalar_t cast_beta = beta.to<scalar_t>();
@@ -479,6 +524,13 @@ void s_addmm_out_sparse_dense_worker(int64_t nnz, int64_t dim_i, int64_t dim_j,
   auto csr_accessor = csr.accessor<int64_t, 1>();
   auto indices_accessor = indices.accessor<int64_t, 2>();
 
+  // Check the columns up front, since we can't throw from the parallel loop
+  for (int64_t i = 0; i < nnz; i++) {
+    int64_t col = indices_accessor[1][i];
+    AT_CHECK(col >= 0 && col < dim_j,
+             "addmm: index out of bound: ", col, " not between 1 and ", dim_j);
+  }
+
   auto values_accessor = values.accessor<scalar_t, 1>();
   scalar_t* dense_ptr = dense.data<scalar_t>();
   scalar_t* r_ptr = r.data<scalar_t>();
@@ -487,23 +539,24 @@ void s_addmm_out_sparse_dense_worker(int64_t nnz, int64_t dim_i, int64_t dim_j,
   int64_t dense_stride1 = dense.stride(1);
   int64_t r_stride0 = r.stride(0);
   int64_t r_stride1 = r.stride(1);
-#pragma omp parallel for private(h, i) schedule(static) if (nnz > 10000)
-  for (h = 0; h < dim_i; h++) {
-    int64_t i_start = csr_accessor[h];
-    int64_t i_end = csr_accessor[h+1];
-    for (i = i_start; i < i_end; i++) {
-      scalar_t val = values_accessor[i];
-      int64_t col = indices_accessor[1][i];
-      if (col >= 0 && col < dim_j) {
+  // Every row of r is written by one thread only. Rows are weighted by the
+  // average work per row, so that short products stay on one thread.
+  int64_t row_cost = std::max<int64_t>(1, nnz / dim_i) * dim_k;
+  int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / row_cost);
+  parallel_for(0, dim_i, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t h = begin; h < end; h++) {
+      int64_t i_start = csr_accessor[h];
+      int64_t i_end = csr_accessor[h+1];
+      for (int64_t i = i_start; i < i_end; i++) {
+        scalar_t val = values_accessor[i];
+        int64_t col = indices_accessor[1][i];
         THBlas_axpy<scalar_t>(dim_k,
             cast_alpha * val,
             dense_ptr + col * dense_stride0, dense_stride1,
             r_ptr + h * r_stride0, r_stride1);
-      } else {
-        AT_ERROR("addmm: index out of bound: ", col, " not between 1 and ", dim_j);
       }
     }
-  }
+  });
 };
 
 Tensor& s_addmm_out_sparse_dense_cpu(
@@ -550,7 +603,7 @@ Tensor& s_addmm_out_sparse_dense_cpu(
 
   LongTensor indices = sparse._indices();
   Tensor values      = sparse._values();
-  LongTensor csr = _to_csr(indices.data<int64_t>(), dim_i, nnz);
+  LongTensor csr = sparse._crow_indices();
 
   AT_DISPATCH_ALL_TYPES(
       values.type(), "addmm_sparse_dense", [&] {
@@ -707,7 +760,7 @@ SparseTensor& _sspaddmm_out_cpu(
   LongTensor indices = sparse._indices();
   Tensor values      = sparse._values();
 
-  LongTensor csr = _to_csr(indices.data<int64_t>(), dim_i, nnz);
+  LongTensor csr = sparse._crow_indices();
 
   int64_t t_nnz = t._nnz();
   int64_t r_nnz = nnz * dim_k + t_nnz;
@@ -75,11 +75,19 @@ Tensor& s_addmm_out_sparse_dense_cuda(Tensor& r_, const Tensor& t, const SparseT
   LongTensor indices = sparse._indices();
   Tensor values = sparse._values();
 
-  LongTensor rowIndices = indices.select(0, 0);
-  LongTensor colIndices = indices.select(0, 1);
-  IntTensor csr = _to_csr_int(rowIndices, m, nnz);
-  IntTensor colIndicesInt = at::empty({colIndices.size(0)}, indices.type().toScalarType(kInt));
-  colIndicesInt.copy_(colIndices);
+  // cuSPARSE takes int32 row pointers and column indices. Build them once per
+  // coalesced matrix and keep them on it (they are dropped when its indices
+  // change), so multiplying by the same matrix again skips the conversion.
+  SparseTensorImpl* sparse_impl = _get_sparse_impl(sparse);
+  if (!sparse_impl->crow_indices_int().defined()) {
+    LongTensor rowIndices = indices.select(0, 0);
+    LongTensor colIndices = indices.select(0, 1);
+    IntTensor colIndicesInt = at::empty({colIndices.size(0)}, indices.type().toScalarType(kInt));
+    colIndicesInt.copy_(colIndices);
+    sparse_impl->set_csr_int(_to_csr_int(rowIndices, m, nnz), colIndicesInt);
+  }
+  IntTensor csr = sparse_impl->crow_indices_int();
+  IntTensor colIndicesInt = sparse_impl->col_indices_int();
 
   // No half support, so we don't have to use CUDATypeConversion
   Tensor r__;
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "ATen/native/utils/ParamsHash.h"
+#include "ATen/core/Error.h"
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <list>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+namespace at { namespace native {
+
+// A least recently used cache from POD Params (see ParamsHash.h) to the
+// plans or descriptors built from them, e.g., cuFFT plans and MKL DFTI
+// descriptors. It counts its hits and misses, which are reset by clear().
+//
+// This cache assumes that the mapping from key to value never changes.
+// This is **NOT** thread-safe. Please use a mutex when using it **AND** the
+// value returned from try_emplace_value.
+// The contract of using this cache is that try_emplace_value should only be
+// used when the max_size is positive.
+template <typename Params, typename Value>
+class ParamsLRUCache {
+public:
+  using kv_t = typename std::pair<Params, Value>;
+  using map_t = typename std::unordered_map<std::reference_wrapper<Params>,
+                                            typename std::list<kv_t>::iterator,
+                                            ParamsHash<Params>,
+                                            ParamsEqual<Params>>;
+  using map_kkv_iter_t = typename map_t::iterator;
+
+  // name is used in error messages, and max_size may never exceed
+  // max_size_limit.
+  ParamsLRUCache(std::string name, int64_t max_size,
+                 int64_t max_size_limit = std::numeric_limits<int64_t>::max())
+    : _name(std::move(name)), _max_size_limit(max_size_limit) {
+    _set_max_size(max_size);
+  }
+
+  // If key is in this cache, return the cached value. Otherwise, emplace the
+  // value in this cache using value_args and return it.
+  // Return const reference because values shouldn't be tampered with once
+  // created.
+  // This is similar to c++ 17 try_emplace.
+  template<typename K, class ...VArgs>
+  const Value &try_emplace_value(K&& key, VArgs&&... value_args) {
+    AT_ASSERT(_max_size > 0);
+
+    map_kkv_iter_t map_it = _cache_map.find(key);
+    // Hit, put to list front
+    if (map_it != _cache_map.end()) {
+      _hits++;
+      _usage_list.splice(_usage_list.begin(), _usage_list, map_it->second);
+      return map_it->second->second;
+    }
+
+    // Miss
+    _misses++;
+    // remove if needed
+    if (_usage_list.size() >= _max_size) {
+      auto last = _usage_list.end();
+      last--;
+      _cache_map.erase(last->first);
+      _usage_list.pop_back();
+    }
+
+    // construct new value at list front, then insert into _cache_map
+    _usage_list.emplace_front(std::piecewise_construct,
+                       std::forward_as_tuple(key),
+                       std::forward_as_tuple(value_args...));
+    auto kv_it = _usage_list.begin();
+    _cache_map.emplace(std::piecewise_construct,
+                std::forward_as_tuple(kv_it->first),
+                std::forward_as_tuple(kv_it));
+    return kv_it->second;
+  }
+
+  void clear() {
+    _cache_map.clear();
+    _usage_list.clear();
+    _hits = 0;
+    _misses = 0;
+  }
+
+  void resize(int64_t new_size) {
+    _set_max_size(new_size);
+
+    auto cur_size = _usage_list.size();
+    if (cur_size > _max_size) {
+      auto delete_it = _usage_list.end();
+      for (size_t i = 0; i < cur_size - _max_size; i++) {
+        delete_it--;
+        _cache_map.erase(delete_it->first);
+      }
+      _usage_list.erase(delete_it, _usage_list.end());
+    }
+  }
+
+  size_t size() const { return _cache_map.size(); }
+
+  size_t max_size() const noexcept { return _max_size; }
+
+  int64_t hits() const { return _hits; }
+
+  int64_t misses() const { return _misses; }
+
+private:
+  // Only sets size and does value check. Does not resize the data structures.
+  void _set_max_size(int64_t new_size) {
+    AT_CHECK(new_size <= _max_size_limit,
+             _name, " size can not be larger than ", _max_size_limit, ", but got ", new_size);
+    AT_CHECK(new_size >= 0,
+             _name, " size must be non-negative, but got ", new_size);
+    _max_size = static_cast<size_t>(new_size);
+  }
+
+  std::string _name;
+  int64_t _max_size_limit;
+  std::list<kv_t> _usage_list;
+  map_t _cache_map;
+  size_t _max_size;
+  int64_t _hits = 0;
+  int64_t _misses = 0;
+};
+
+}}  // at::native
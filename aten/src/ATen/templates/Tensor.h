@@ -141,6 +141,18 @@ struct Tensor : public detail::TensorBase {
   template<typename T, size_t N>
   TensorAccessor<T,N> accessor() && = delete;
 
+  // Like accessor, but the result holds copies of the sizes and strides, so
+  // it can be passed to CUDA kernels. See PackedTensorAccessor in
+  // TensorAccessor.h for using index_t = int32_t.
+  template<typename T, size_t N, typename index_t = int64_t>
+  PackedTensorAccessor<T,N,index_t> packed_accessor() const& {
+    static_assert(N > 0, "accessor is used for indexing tensor, for scalars use *data<T>()");
+    AT_CHECK(dim() == N, "expected ", N, " dims but tensor has ", dim());
+    return PackedTensorAccessor<T,N,index_t>(data<T>(),sizes().data(),strides().data());
+  }
+  template<typename T, size_t N, typename index_t = int64_t>
+  PackedTensorAccessor<T,N,index_t> packed_accessor() && = delete;
+
   Tensor operator-() const;
   Tensor& operator+=(const Tensor & other);
   Tensor& operator+=(Scalar other);
@@ -64,6 +64,14 @@ TEST_CASE( "atest", "[]" ) {
   REQUIRE(f_a[0][0][0] == 1.0);
   REQUIRE(f_a[0][1][1] == 5.0);
 
+  auto f_t = f.transpose(1, 2);
+  auto f_p = f_t.packed_accessor<float,3,int32_t>();
+  REQUIRE(f_p.size(1) == 3);
+  REQUIRE(f_p.stride(1) == 1);
+  REQUIRE(f_p.stride(2) == 3);
+  REQUIRE(f_p[0][2][1] == 6.0);
+  REQUIRE(f_p[0][1][0] == 2.0);
+
   REQUIRE(f.strides()[0] == 6);
   REQUIRE(f.strides()[1] == 3);
   REQUIRE(f.strides()[2] == 1);
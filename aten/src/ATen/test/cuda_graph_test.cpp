@@ -0,0 +1,54 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include "ATen/ATen.h"
+#include "ATen/cuda/CUDAGraph.h"
+
+#include "cuda_runtime.h"
+
+using namespace at;
+
+static bool graphsSupported() {
+  int version = 0;
+  cudaRuntimeGetVersion(&version);
+  return version >= 10010;
+}
+
+TEST_CASE( "CUDA graph replays captured ops", "[cuda]" ) {
+  if (!graphsSupported()) return;
+
+  auto input = CUDA(kFloat).ones({1000});
+  // warm up so that nothing is lazily initialized while capturing
+  auto output = input * 2 + 1;
+
+  cuda::CUDAGraph graph;
+  graph.capture_begin();
+  output = input * 2 + 1;
+  graph.capture_end();
+  REQUIRE(graph.has_graph());
+
+  input.fill_(3);
+  graph.replay();
+  REQUIRE(output.equal(CUDA(kFloat).ones({1000}) * 7));
+
+  graph.reset();
+  REQUIRE(!graph.has_graph());
+}
+
+TEST_CASE( "CUDA graph draws new random numbers on every replay", "[cuda]" ) {
+  if (!graphsSupported()) return;
+
+  auto input = CUDA(kFloat).ones({1000});
+  auto result = at::_fused_dropout(input, 0.5);
+
+  cuda::CUDAGraph graph;
+  graph.capture_begin();
+  result = at::_fused_dropout(input, 0.5);
+  graph.capture_end();
+
+  graph.replay();
+  auto first = std::get<0>(result).clone();
+  graph.replay();
+  auto second = std::get<0>(result).clone();
+  REQUIRE(!first.equal(second));
+}
@@ -0,0 +1,56 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include "ATen/ATen.h"
+
+#include <string>
+
+static void check_positive(int64_t x) {
+  AT_CHECK(x > 0, "expected a positive number but got ", x);
+}
+
+TEST_CASE( "at::Error backtraces", "" ) {
+  SECTION("what() includes the location, what_without_backtrace() doesn't") {
+    try {
+      check_positive(-1);
+      FAIL("check_positive didn't throw");
+    } catch (const at::Error& e) {
+      REQUIRE(std::string(e.what_without_backtrace()) ==
+              "expected a positive number but got -1");
+      std::string what = e.what();
+      REQUIRE(what.find("expected a positive number but got -1 (") == 0);
+      REQUIRE(what.find("check_positive") != std::string::npos);
+      // the message is only computed once
+      REQUIRE(e.what() == e.what());
+    }
+  }
+
+  SECTION("copies and appended messages") {
+    try {
+      check_positive(0);
+      FAIL("check_positive didn't throw");
+    } catch (const at::Error& e) {
+      at::Error copy = e;
+      copy.AppendMessage(" while testing");
+      REQUIRE(std::string(copy.what_without_backtrace()) ==
+              "expected a positive number but got 0 while testing");
+      REQUIRE(std::string(copy.what()).find(" while testing (") != std::string::npos);
+      REQUIRE(std::string(e.what()).find(" while testing") == std::string::npos);
+    }
+  }
+
+  SECTION("expected errors have no backtrace") {
+    at::ExpectedErrorGuard guard;
+    REQUIRE(at::ExpectedErrorGuard::is_enabled());
+    try {
+      check_positive(-2);
+      FAIL("check_positive didn't throw");
+    } catch (const at::Error& e) {
+      std::string what = e.what();
+      REQUIRE(what.find("expected a positive number but got -2 (") == 0);
+      REQUIRE(what.find("frame #") == std::string::npos);
+    }
+  }
+
+  REQUIRE_FALSE(at::ExpectedErrorGuard::is_enabled());
+}
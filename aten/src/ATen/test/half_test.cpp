@@ -2,10 +2,13 @@
 #include "catch.hpp"
 
 #include <ATen/ATen.h>
+#include <ATen/core/BFloat16.h>
+#include <ATen/cpu/vec256/vec256.h>
 #include <iostream>
 #include <limits>
 #include <sstream>
 #include <type_traits>
+#include <vector>
 
 using namespace at;
 
@@ -64,6 +67,48 @@ static std::string to_string(const Half& h) {
   return ss.str();
 }
 
+TEST_CASE( "bfloat16 conversions", "[]" ) {
+  REQUIRE((float)BFloat16(1.5f) == 1.5f);
+  REQUIRE((float)BFloat16(-3.0f) == -3.0f);
+  // 1 + 2^-8 is halfway between 1 and 1 + 2^-7 and rounds to even
+  REQUIRE((float)BFloat16(1.00390625f) == 1.0f);
+  REQUIRE((float)BFloat16(1.01171875f) == 1.015625f);
+  REQUIRE(std::isinf((float)BFloat16(std::numeric_limits<float>::infinity())));
+  REQUIRE(std::isnan((float)BFloat16(std::numeric_limits<float>::quiet_NaN())));
+  BFloat16 one = 1.0f;
+  REQUIRE((float)(one + one) == 2.0f);
+  REQUIRE((float)(one / BFloat16(4.0f)) == 0.25f);
+}
+
+TEST_CASE( "vectorized half and bfloat16 conversions", "[]" ) {
+  // more than one vector plus a tail, including rounding cases and NaN
+  const int64_t n = 37;
+  std::vector<float> src(n);
+  for (int64_t i = 0; i < n; i++) {
+    src[i] = (i - 18) * 1.00390625f + i * 1e-4f;
+  }
+  src[5] = std::numeric_limits<float>::infinity();
+  src[11] = std::numeric_limits<float>::quiet_NaN();
+
+  std::vector<Half> h(n);
+  std::vector<BFloat16> b(n);
+  std::vector<float> back(n);
+  vec256::convert(src.data(), h.data(), n);
+  vec256::convert(src.data(), b.data(), n);
+  for (int64_t i = 0; i < n; i++) {
+    REQUIRE(h[i].x == Half(src[i]).x);
+    REQUIRE(b[i].x == BFloat16(src[i]).x);
+  }
+  vec256::convert(h.data(), back.data(), n);
+  for (int64_t i = 0; i < n; i++) {
+    REQUIRE((std::isnan(back[i]) ? i == 11 : back[i] == (float)h[i]));
+  }
+  vec256::convert(b.data(), back.data(), n);
+  for (int64_t i = 0; i < n; i++) {
+    REQUIRE((std::isnan(back[i]) ? i == 11 : back[i] == (float)b[i]));
+  }
+}
+
 TEST_CASE( "half to string", "[]" ) {
   REQUIRE(to_string(Half(3.5f)) == "3.5");
   REQUIRE(to_string(Half(-100.0f)) == "-100");
@@ -0,0 +1,65 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include "ATen/ATen.h"
+#include "ATen/HugePageAllocator.h"
+
+#include <cstdint>
+#include <cstring>
+
+using namespace at;
+
+TEST_CASE( "huge page allocator", "[cpu]" ) {
+  setHugePageMode(HugePageMode::Transparent);
+  if (hugePageMode() == HugePageMode::Disabled) {
+    // not supported on this platform
+    return;
+  }
+  hugePageEmptyCache();
+
+  SECTION( "blocks are aligned, cached and reused" ) {
+    auto before = hugePageStats();
+    void* ptr;
+    {
+      auto data = getHugePageAllocator()->allocate(3 * 1024 * 1024);
+      ptr = data.get();
+      REQUIRE(reinterpret_cast<uintptr_t>(ptr) % kHugePageSize == 0);
+      std::memset(ptr, 1, 3 * 1024 * 1024);
+      REQUIRE(hugePageStats().allocated_bytes == before.allocated_bytes + 2 * kHugePageSize);
+    }
+    REQUIRE(hugePageStats().cached_bytes == 2 * kHugePageSize);
+    {
+      // rounded up to the same size
+      auto data = getHugePageAllocator()->allocate(4 * 1024 * 1024);
+      REQUIRE(data.get() == ptr);
+    }
+    auto after = hugePageStats();
+    REQUIRE(after.allocations == before.allocations + 2);
+    REQUIRE(after.cache_hits == before.cache_hits + 1);
+    REQUIRE(after.mapped_blocks == before.mapped_blocks + 1);
+    hugePageEmptyCache();
+    REQUIRE(hugePageStats().cached_bytes == 0);
+  }
+
+  SECTION( "default allocator uses huge pages above the threshold" ) {
+    auto old_threshold = hugePageThreshold();
+    setHugePageThreshold(1024 * 1024);
+    auto before = hugePageStats();
+    Tensor small = ones({1000}, CPU(kFloat));
+    REQUIRE(hugePageStats().allocations == before.allocations);
+    Tensor large = ones({1024 * 1024}, CPU(kFloat));
+    REQUIRE(hugePageStats().allocations == before.allocations + 1);
+    REQUIRE(large.sum().toCFloat() == 1024 * 1024);
+    setHugePageThreshold(old_threshold);
+  }
+
+  SECTION( "explicit huge pages fall back to transparent ones" ) {
+    // most test machines don't reserve any huge pages
+    setHugePageMode(HugePageMode::Explicit);
+    auto data = getHugePageAllocator()->allocate(kHugePageSize);
+    REQUIRE(data.get() != nullptr);
+    std::memset(data.get(), 1, kHugePageSize);
+  }
+
+  setHugePageMode(HugePageMode::Disabled);
+}
@@ -0,0 +1,70 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include "ATen/ATen.h"
+#include "ATen/NUMA.h"
+
+#include <cstring>
+
+using namespace at;
+
+// These run whether or not the host has NUMA; without it there is a single
+// node and nothing is bound.
+TEST_CASE( "numa allocator", "[cpu]" ) {
+  REQUIRE(numaNodeCount() >= 1);
+
+  SECTION( "blocks are usable on every node" ) {
+    for (int node = kFirstTouchNUMANode; node < numaNodeCount(); node++) {
+      for (size_t size : {1, 100, 4096, 100000}) {
+        auto data = getNUMAAllocator(node)->allocate(size);
+        REQUIRE(data.get() != nullptr);
+        std::memset(data.get(), 1, size);
+      }
+    }
+  }
+
+  SECTION( "freed blocks are cached per node and reused" ) {
+    numaEmptyCache(0);
+    void* ptr;
+    {
+      auto data = getNUMAAllocator(0)->allocate(10000);
+      ptr = data.get();
+    }
+    REQUIRE(numaCachedBytes(0) >= 10000);
+    {
+      // rounded up to the same size
+      auto data = getNUMAAllocator(0)->allocate(10001);
+      REQUIRE(data.get() == ptr);
+      REQUIRE(numaCachedBytes(0) == 0);
+    }
+    numaEmptyCache(0);
+    REQUIRE(numaCachedBytes(0) == 0);
+  }
+
+  SECTION( "node guard" ) {
+    REQUIRE(currentNUMANode() == kFirstTouchNUMANode);
+    {
+      NUMANodeGuard guard(0);
+      REQUIRE(currentNUMANode() == 0);
+      numaEmptyCache(0);
+      Tensor t = ones({1000}, CPU(kFloat));
+      REQUIRE(t.sum().toCFloat() == 1000);
+      t.reset();
+      // the buffer went back to the node's pool
+      REQUIRE(numaCachedBytes(0) >= 4000);
+    }
+    REQUIRE(currentNUMANode() == kFirstTouchNUMANode);
+  }
+
+  SECTION( "binding threads" ) {
+    numaBindIntraOpThreads(0);
+    Tensor t = ones({100000}, CPU(kFloat));
+    REQUIRE(t.sum().toCFloat() == 100000);
+    numaBindIntraOpThreads(kFirstTouchNUMANode);
+  }
+
+  SECTION( "invalid nodes" ) {
+    REQUIRE_THROWS(getNUMAAllocator(numaNodeCount()));
+    REQUIRE_THROWS(NUMANodeGuard(-2));
+  }
+}
@@ -0,0 +1,68 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include "ATen/ATen.h"
+#include "ATen/cuda/CUDAContext.h"
+#include "ATen/cuda/detail/IndexUtils.cuh"
+
+#include <limits>
+
+using namespace at;
+
+// out[i] = sum_j a[i][j] * b[j][i]
+template <typename index_t>
+__global__ void diag_of_product_kernel(
+    PackedTensorAccessor<float, 2, index_t> a,
+    PackedTensorAccessor<float, 2, index_t> b,
+    PackedTensorAccessor<float, 1, index_t> out) {
+  const index_t i = blockIdx.x * blockDim.x + threadIdx.x;
+  if (i < out.size(0)) {
+    const auto a_i = a[i];
+    float sum = 0;
+    for (index_t j = 0; j < a.size(1); j++) {
+      sum += a_i[j] * b[j][i];
+    }
+    out[i] = sum;
+  }
+}
+
+void diag_of_product(const Tensor& a, const Tensor& b, Tensor& out, bool use_32bit) {
+  AT_DISPATCH_INDEX_TYPES(use_32bit, [&] {
+    diag_of_product_kernel<index_t><<<1, 128, 0, at::cuda::getCurrentCUDAStream()>>>(
+        a.packed_accessor<float, 2, index_t>(),
+        b.packed_accessor<float, 2, index_t>(),
+        out.packed_accessor<float, 1, index_t>());
+  });
+  REQUIRE(cudaGetLastError() == cudaSuccess);
+}
+
+TEST_CASE("packed accessors in CUDA kernels", "[cuda]") {
+  if (!at::hasCUDA()) return;
+  manual_seed(123, at::kCUDA);
+
+  auto a = CUDA(kFloat).randn({100, 30});
+  // non-contiguous, so that the strides get exercised
+  auto b = CUDA(kFloat).randn({100, 30}).t();
+  auto expected = (a * b.t()).sum(1);
+
+  for (bool use_32bit : {true, false}) {
+    auto out = CUDA(kFloat).zeros({100});
+    diag_of_product(a, b, out, use_32bit);
+    REQUIRE(out.allclose(expected, 1e-4, 1e-5));
+  }
+}
+
+TEST_CASE("canUse32BitIndexMath", "[cuda]") {
+  if (!at::hasCUDA()) return;
+  using at::cuda::detail::canUse32BitIndexMath;
+
+  auto small = CUDA(kFloat).zeros({1000, 1000});
+  REQUIRE(canUse32BitIndexMath(small));
+
+  // 2^32 elements without the memory for them
+  const int64_t big = int64_t(1) << 16;
+  auto one = CUDA(kFloat).zeros({1, 1});
+  auto expanded = one.expand({big, big});
+  REQUIRE_FALSE(canUse32BitIndexMath(expanded));
+  REQUIRE(canUse32BitIndexMath(expanded, std::numeric_limits<int64_t>::max()));
+}
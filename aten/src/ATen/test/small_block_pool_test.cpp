@@ -0,0 +1,86 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include "ATen/ATen.h"
+#include "ATen/SmallBlockPool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace at;
+
+TEST_CASE( "small block pool", "[cpu]" ) {
+  SECTION( "blocks are aligned and don't overlap" ) {
+    std::vector<void*> blocks;
+    for (size_t size : {1, 8, 16, 17, 100, 512, 513, 4096}) {
+      for (int i = 0; i < 100; i++) {
+        void* ptr = smallBlockAlloc(size);
+        REQUIRE(reinterpret_cast<uintptr_t>(ptr) % 16 == 0);
+        std::memset(ptr, static_cast<int>(blocks.size() % 256), size);
+        blocks.push_back(ptr);
+      }
+    }
+    size_t i = 0;
+    for (size_t size : {1, 8, 16, 17, 100, 512, 513, 4096}) {
+      for (int j = 0; j < 100; j++, i++) {
+        auto* bytes = static_cast<unsigned char*>(blocks[i]);
+        REQUIRE(bytes[0] == i % 256);
+        REQUIRE(bytes[size - 1] == i % 256);
+      }
+    }
+    for (auto ptr : blocks) {
+      smallBlockFree(ptr);
+    }
+  }
+
+  SECTION( "freed blocks are reused" ) {
+    void* a = smallBlockAlloc(24);
+    smallBlockFree(a);
+    void* b = smallBlockAlloc(32);
+    REQUIRE(a == b);
+    smallBlockFree(b);
+  }
+
+  SECTION( "blocks can be freed by other threads" ) {
+    std::vector<void*> blocks(10000);
+    std::thread producer([&] {
+      for (auto& ptr : blocks) {
+        ptr = smallBlockAlloc(64);
+      }
+    });
+    producer.join();
+    std::thread consumer([&] {
+      for (auto ptr : blocks) {
+        smallBlockFree(ptr);
+      }
+    });
+    consumer.join();
+    // the consumer gave its blocks to the shared pool when it exited
+    void* ptr = smallBlockAlloc(64);
+    smallBlockFree(ptr);
+  }
+
+  SECTION( "scalar tensors" ) {
+    // catch assertions aren't thread safe
+    std::atomic<int> failures(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+      threads.emplace_back([&] {
+        for (int i = 0; i < 1000; i++) {
+          Tensor a = CPU(kFloat).scalarTensor(i);
+          Tensor b = a + 1;
+          if (b.toCFloat() != i + 1) {
+            failures++;
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    REQUIRE(failures == 0);
+  }
+}
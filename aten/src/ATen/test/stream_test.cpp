@@ -8,6 +8,7 @@
 
 #include <functional>
 #include <thread>
+#include <vector>
 
 /*
 Tests related to ATen streams.
@@ -200,3 +201,51 @@ TEST_CASE("CUDAGuardIsMovable") {
   REQUIRE(third.original_device() == 0);
   REQUIRE(third.last_device() == 1);
 }
+
+TEST_CASE("Stream pool", "Pool streams are handed out round-robin") {
+  auto first = at::cuda::getStreamFromPool();
+  REQUIRE(first.device() == at::cuda::current_device());
+  REQUIRE(first != at::cuda::getDefaultCUDAStream());
+
+  // one full round of the pool ends up on the same stream
+  std::vector<at::cuda::CUDAStream> streams = {first};
+  for (auto i = 0; i < 32; ++i) {
+    streams.push_back(at::cuda::getStreamFromPool());
+  }
+  for (auto i = 1; i < 32; ++i) {
+    REQUIRE(streams[i] != streams[i - 1]);
+  }
+  REQUIRE(streams[32] == first);
+
+  auto high = at::cuda::getStreamFromPool(/*isHighPriority=*/true);
+  for (const auto& s : streams) {
+    REQUIRE(s != high);
+  }
+}
+
+TEST_CASE(
+    "Per-thread streams",
+    "Threads start on different pool streams when enabled") {
+  at::cuda::setPerThreadCUDAStreams(true);
+  at::cuda::CUDAStream s0, s1;
+  auto get_current = [](at::cuda::CUDAStream& s) {
+    s = at::cuda::getCurrentCUDAStream();
+    // the stream stays the current one of the thread
+    REQUIRE(at::cuda::getCurrentCUDAStream() == s);
+  };
+  std::thread t0{get_current, std::ref(s0)};
+  t0.join();
+  std::thread t1{get_current, std::ref(s1)};
+  t1.join();
+  at::cuda::setPerThreadCUDAStreams(false);
+
+  REQUIRE(s0 != at::cuda::getDefaultCUDAStream());
+  REQUIRE(s1 != at::cuda::getDefaultCUDAStream());
+  REQUIRE(s0 != s1);
+
+  // threads started afterwards are back on the default stream
+  at::cuda::CUDAStream s2;
+  std::thread t2{get_current, std::ref(s2)};
+  t2.join();
+  REQUIRE(s2 == at::cuda::getDefaultCUDAStream());
+}
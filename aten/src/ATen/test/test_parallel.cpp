@@ -3,10 +3,16 @@
 
 #include "ATen/ATen.h"
 #include "ATen/DLConvertor.h"
+#include "ATen/Parallel.h"
 
 #include <iostream>
 #include <string.h>
 #include <sstream>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
 #include "test_seed.h"
 
 using namespace at;
@@ -26,3 +32,103 @@ TEST_CASE( "parallel", "[cpu]" ) {
   as[2] = 0;
   REQUIRE(a.sum(0).equal(as));
 }
+
+TEST_CASE( "parallel native backend", "[cpu]" ) {
+  auto prev = get_parallel_backend();
+  set_num_threads(4);
+  set_parallel_backend(ParallelBackend::Native);
+
+  Tensor a = rand({1 << 20});
+  double expected = 0;
+  auto a_data = a.data<float>();
+  for (int64_t i = 0; i < a.numel(); i++) {
+    expected += a_data[i];
+  }
+  // Catch assertions are not thread-safe, so worker-side checks are recorded
+  // in atomics and asserted on the main thread.
+  std::atomic<bool> all_in_region(true);
+  double actual = parallel_reduce(
+      0, a.numel(), internal::GRAIN_SIZE, 0.0,
+      [&](int64_t begin, int64_t end, double ident) {
+        if (!in_parallel_region()) {
+          all_in_region = false;
+        }
+        for (int64_t i = begin; i < end; i++) {
+          ident += a_data[i];
+        }
+        return ident;
+      },
+      std::plus<double>());
+  REQUIRE(all_in_region.load());
+  REQUIRE(std::abs(actual - expected) < 1e-6 * a.numel());
+
+  // Nested regions run serially on the calling thread.
+  std::atomic<int64_t> visited(0);
+  std::atomic<bool> nested_serial(true);
+  parallel_for(0, 64, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      parallel_for(0, 1000, 1, [&](int64_t b, int64_t e) {
+        if (b != 0 || e != 1000) {
+          nested_serial = false;
+        }
+        visited += e - b;
+      });
+    }
+  });
+  REQUIRE(nested_serial.load());
+  REQUIRE(visited.load() == 64 * 1000);
+  REQUIRE(!in_parallel_region());
+
+  REQUIRE(a.sum(0).toCDouble() == Approx(expected).epsilon(1e-4));
+  set_parallel_backend(prev);
+  set_num_threads(1);
+}
+
+TEST_CASE( "parallel cost hints and autotuning", "[cpu]" ) {
+  REQUIRE(internal::grain_size_for_cost(1) == internal::GRAIN_SIZE);
+  REQUIRE(internal::grain_size_for_cost(16) == internal::GRAIN_SIZE / 16);
+
+  auto prev = get_parallel_backend();
+  set_num_threads(4);
+  set_parallel_backend(ParallelBackend::Native);
+  set_parallel_autotune(true);
+  reset_parallel_tuning();
+
+  // The first runs try different chunkings before one is chosen, the result
+  // must not depend on it.
+  constexpr ParallelCostHint hint{"test_parallel_autotune", 4};
+  const int64_t numel = 1 << 16;
+  for (int run = 0; run < 64; run++) {
+    std::atomic<int64_t> visited(0);
+    parallel_for(0, numel, hint, [&](int64_t begin, int64_t end) {
+      visited += end - begin;
+    });
+    REQUIRE(visited.load() == numel);
+  }
+
+  auto path = std::string(std::tmpnam(nullptr));
+  save_parallel_tuning(path);
+  std::ifstream in(path);
+  std::string name;
+  int size_class;
+  int64_t num_chunks;
+  REQUIRE(in >> name >> size_class >> num_chunks);
+  REQUIRE(name == hint.name);
+  REQUIRE(size_class == 16);
+  REQUIRE(num_chunks >= 1);
+  in.close();
+
+  reset_parallel_tuning();
+  load_parallel_tuning(path);
+  std::atomic<int64_t> chunks(0);
+  parallel_for(0, numel, hint, [&](int64_t begin, int64_t end) {
+    chunks++;
+  });
+  REQUIRE(chunks.load() <= num_chunks);
+  std::remove(path.c_str());
+
+  set_parallel_autotune(false);
+  reset_parallel_tuning();
+  set_parallel_backend(prev);
+  set_num_threads(1);
+}
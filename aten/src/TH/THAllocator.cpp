@@ -1,5 +1,9 @@
 #include "THAllocator.h"
 
+#include "ATen/HugePageAllocator.h"
+#include "ATen/NUMA.h"
+#include "ATen/SmallBlockPool.h"
+
 /* stuff for mapped files */
 #ifdef _WIN32
 #include <windows.h>
@@ -19,14 +23,27 @@
 #endif
 /* end of stuff for mapped files */
 
+// Small buffers, like those of scalar-sized tensors, come from the per-thread
+// free lists of the small block pool. Larger ones come from the pool of the
+// NUMA node set with an at::NUMANodeGuard, if there is one, and very large
+// ones from the huge page allocator, if it is enabled. As those take
+// different deleters, raw_allocate/raw_deallocate aren't supported.
 struct THDefaultAllocator final : public at::Allocator {
   at::DataPtr allocate(size_t size) const override {
+    if (size > 0 && size <= at::kSmallBlockMaxSize) {
+      auto* ptr = at::smallBlockAlloc(size);
+      return {ptr, ptr, &at::smallBlockFree, at::DeviceType::CPU};
+    }
+    const int numa_node = at::currentNUMANode();
+    if (numa_node != at::kFirstTouchNUMANode) {
+      return at::getNUMAAllocator(numa_node)->allocate(size);
+    }
+    if (at::useHugePages(size)) {
+      return at::getHugePageAllocator()->allocate(size);
+    }
     auto* ptr = THAlloc(size);
     return {ptr, ptr, &THFree, at::DeviceType::CPU};
   }
-  at::DeleterFnPtr raw_deleter() const override {
-    return &THFree;
-  }
 };
 
 static THDefaultAllocator th_default_allocator;
@@ -81,6 +98,9 @@ THMapAllocator::THMapAllocator(WithFd, const char *filename, int fd, int flags,
   }
 
 #ifdef _WIN32
+  if (flags_ & TH_ALLOCATOR_MAPPED_READONLY) {
+    AT_ERROR("TH_ALLOCATOR_MAPPED_READONLY is unsupported on Windows");
+  }
   if (flags_ & TH_ALLOCATOR_MAPPED_SHAREDMEM) {
     // Shadowing
     const char *filename;
@@ -210,7 +230,9 @@ THMapAllocator::THMapAllocator(WithFd, const char *filename, int fd, int flags,
     int flags; // shadow
     struct stat file_stat;
 
-    if (flags_ & (TH_ALLOCATOR_MAPPED_SHARED | TH_ALLOCATOR_MAPPED_SHAREDMEM)) {
+    if (flags_ & TH_ALLOCATOR_MAPPED_READONLY) {
+      flags = O_RDONLY;
+    } else if (flags_ & (TH_ALLOCATOR_MAPPED_SHARED | TH_ALLOCATOR_MAPPED_SHAREDMEM)) {
       flags = O_RDWR | O_CREAT;
     } else {
       flags = O_RDONLY;
@@ -254,7 +276,7 @@ THMapAllocator::THMapAllocator(WithFd, const char *filename, int fd, int flags,
 
     if (size > 0) {
       if (size > file_stat.st_size) {
-        if (flags_) {
+        if (flags_ && !(flags_ & TH_ALLOCATOR_MAPPED_READONLY)) {
           if (ftruncate(fd, size) == -1) {
             AT_ERROR("unable to resize file <", filename_, "> to the right size");
           }
@@ -283,12 +305,23 @@ THMapAllocator::THMapAllocator(WithFd, const char *filename, int fd, int flags,
     size_ = size; /* if we are here, it must be the right size */
 
     /* map it */
-    if (flags_ & (TH_ALLOCATOR_MAPPED_SHARED | TH_ALLOCATOR_MAPPED_SHAREDMEM)) {
+    if (flags_ & TH_ALLOCATOR_MAPPED_READONLY) {
+      /* pages are shared with every other mapping of the file, writes fault */
+      base_ptr_ = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    } else if (flags_ & (TH_ALLOCATOR_MAPPED_SHARED | TH_ALLOCATOR_MAPPED_SHAREDMEM)) {
       base_ptr_ = mmap(nullptr, size_, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
     } else {
       base_ptr_ = mmap(nullptr, size_, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
     }
 
+#ifdef MADV_HUGEPAGE
+    /* only takes effect for shared memory, but saves TLB misses when loading
+       large checkpoints from it */
+    if (base_ptr_ != MAP_FAILED && at::useHugePages(size_)) {
+      madvise(base_ptr_, size_, MADV_HUGEPAGE);
+    }
+#endif
+
     if (base_ptr_ == MAP_FAILED) {
       base_ptr_ = nullptr; /* let's be sure it is NULL */
     }
@@ -13,6 +13,7 @@
 #define TH_ALLOCATOR_MAPPED_KEEPFD 16
 #define TH_ALLOCATOR_MAPPED_FROMFD 32
 #define TH_ALLOCATOR_MAPPED_UNLINK 64
+#define TH_ALLOCATOR_MAPPED_READONLY 128
 
 #ifdef __cplusplus
 using THAllocator = at::Allocator;
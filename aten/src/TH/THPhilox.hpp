@@ -0,0 +1,69 @@
+#pragma once
+
+// Philox4x32-10, the counter-based generator of Salmon et al., "Parallel
+// Random Numbers: As Easy as 1, 2, 3" (SC'11), which cuRAND also uses.
+//
+// A counter-based generator maps (key, counter) to random bits without any
+// state, so a tensor can be filled by any number of threads in any order:
+// element i always gets the bits of counter i / (elements per call). The
+// CPU random fills draw one key from the THGenerator per call, which keeps
+// them reproducible for a given seed whatever the number of threads.
+
+#include <cstdint>
+
+// Tensors with at least this many elements are filled from Philox; smaller
+// ones keep drawing from the Mersenne Twister one element at a time.
+#define TH_PHILOX_MIN_SIZE 16384
+
+struct THPhilox4x32 {
+  uint32_t x[4];
+};
+
+static inline uint32_t THPhilox_mulhilo(uint32_t a, uint32_t b, uint32_t *hi)
+{
+  uint64_t product = (uint64_t)a * b;
+  *hi = (uint32_t)(product >> 32);
+  return (uint32_t)product;
+}
+
+// The four 32-bit outputs for the given 64-bit key and counter.
+static inline THPhilox4x32 THPhilox_generate(uint64_t key, uint64_t counter)
+{
+  const uint32_t kPhiloxM0 = 0xD2511F53;
+  const uint32_t kPhiloxM1 = 0xCD9E8D57;
+  const uint32_t kPhiloxW0 = 0x9E3779B9;
+  const uint32_t kPhiloxW1 = 0xBB67AE85;
+
+  uint32_t c0 = (uint32_t)counter;
+  uint32_t c1 = (uint32_t)(counter >> 32);
+  uint32_t c2 = 0;
+  uint32_t c3 = 0;
+  uint32_t k0 = (uint32_t)key;
+  uint32_t k1 = (uint32_t)(key >> 32);
+  for (int round = 0; round < 10; round++) {
+    uint32_t hi0, hi1;
+    uint32_t lo0 = THPhilox_mulhilo(kPhiloxM0, c0, &hi0);
+    uint32_t lo1 = THPhilox_mulhilo(kPhiloxM1, c2, &hi1);
+    c0 = hi1 ^ c1 ^ k0;
+    c1 = lo1;
+    c2 = hi0 ^ c3 ^ k1;
+    c3 = lo0;
+    k0 += kPhiloxW0;
+    k1 += kPhiloxW1;
+  }
+  THPhilox4x32 result = {{c0, c1, c2, c3}};
+  return result;
+}
+
+// A uniform float on [0, 1) from 24 of the given bits.
+static inline float THPhilox_uniformFloat(uint32_t x)
+{
+  return (x >> 8) * (1.0f / (1u << 24));
+}
+
+// A uniform double on [0, 1) from 53 of the given bits.
+static inline double THPhilox_uniformDouble(uint32_t hi, uint32_t lo)
+{
+  uint64_t bits = ((uint64_t)hi << 32) | lo;
+  return (bits >> 11) * (1.0 / (UINT64_C(1) << 53));
+}
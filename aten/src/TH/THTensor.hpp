@@ -107,7 +107,7 @@ inline std::vector<int64_t> THTensor_stridesLegacyNoScalars(const THTensor *self
     return self->strides().vec();
   }
 }
-inline void THTensor_setSizesAndStrides(THTensor* tensor, std::vector<int64_t>&& new_size, std::vector<int64_t>&& new_stride) {
+inline void THTensor_setSizesAndStrides(THTensor* tensor, at::DimVector&& new_size, at::DimVector&& new_stride) {
   AT_CHECK(new_size.size() == new_stride.size(), "dimensionality of sizes (",
            new_size.size(), ") must match dimensionality of strides (", new_stride.size(), ")");
   tensor->sizes_ = std::move(new_size);
@@ -140,8 +140,8 @@ TH_API void THTensor_resizeNd(THTensor *self, int nDimension, const int64_t *siz
 
 TH_CPP_API void THTensor_resize(THTensor *self, at::IntList size, at::IntList stride);
 TH_CPP_API void THTensor_setStorage(THTensor *self, THStorage *storage_, ptrdiff_t storageOffset_, at::IntList size_, at::IntList stride_);
-TH_CPP_API at::optional<std::vector<int64_t>> THTensor_compute_stride(at::IntList oldshape, at::IntList oldstride,
-                                                                      at::IntList newshape);
+TH_CPP_API at::optional<at::DimVector> THTensor_compute_stride(at::IntList oldshape, at::IntList oldstride,
+                                                               at::IntList newshape);
 
 #include "generic/THTensor.hpp"
 #include "THGenerateAllTypes.h"
@@ -376,8 +376,8 @@ void THTensor_(unfold)(THTensor *self, THTensor *src, int dimension, int64_t siz
 
   THTensor_(set)(self, src);
 
-  std::vector<int64_t> newSize(/* size */ self->dim()+1);
-  std::vector<int64_t> newStride(/* size */ self->dim()+1);
+  at::DimVector newSize(/* size */ self->dim()+1);
+  at::DimVector newStride(/* size */ self->dim()+1);
 
   newSize[self->dim()] = size;
   newStride[self->dim()] = THTensor_strideLegacyNoScalars(self, dimension);
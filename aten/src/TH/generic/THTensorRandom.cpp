@@ -11,6 +11,81 @@
 #include <cpuinfo.h>
 
 #include "THGenerator.hpp"
+#include "THPhilox.hpp"
+
+#ifndef TH_PHILOX_FILL
+#define TH_PHILOX_FILL
+// The Philox fills below hand every element i of [0, size) its random
+// numbers through op(i, ...). Element i only depends on key and i, so the
+// elements are filled in parallel.
+
+// op(i, u) with a uniform double u on [0, 1); two per Philox call.
+template <typename Op>
+static void THPhilox_uniformDoubleFill(int64_t size, uint64_t key, const Op& op)
+{
+  int64_t blocks = (size + 1) / 2;
+  int64_t b;
+#pragma omp parallel for private(b)
+  for (b = 0; b < blocks; b++) {
+    THPhilox4x32 r = THPhilox_generate(key, b);
+    op(2 * b, THPhilox_uniformDouble(r.x[0], r.x[1]));
+    if (2 * b + 1 < size) {
+      op(2 * b + 1, THPhilox_uniformDouble(r.x[2], r.x[3]));
+    }
+  }
+}
+
+// op(i, u) with a uniform float u on [0, 1); four per Philox call.
+template <typename Op>
+static void THPhilox_uniformFloatFill(int64_t size, uint64_t key, const Op& op)
+{
+  int64_t blocks = (size + 3) / 4;
+  int64_t b;
+#pragma omp parallel for private(b)
+  for (b = 0; b < blocks; b++) {
+    THPhilox4x32 r = THPhilox_generate(key, b);
+    int64_t count = size - 4 * b < 4 ? size - 4 * b : 4;
+    for (int64_t j = 0; j < count; j++) {
+      op(4 * b + j, THPhilox_uniformFloat(r.x[j]));
+    }
+  }
+}
+
+// op(i, z) with a standard normal z, from Box-Muller on the two uniform
+// doubles of one Philox call, which give the normals of elements 2b and
+// 2b + 1.
+template <typename Op>
+static void THPhilox_normalFill(int64_t size, uint64_t key, const Op& op)
+{
+  int64_t blocks = (size + 1) / 2;
+  int64_t b;
+#pragma omp parallel for private(b)
+  for (b = 0; b < blocks; b++) {
+    THPhilox4x32 r = THPhilox_generate(key, b);
+    const double u1 = 1 - THPhilox_uniformDouble(r.x[0], r.x[1]); // [0, 1) -> (0, 1] for log.
+    const double u2 = THPhilox_uniformDouble(r.x[2], r.x[3]);
+    const double radius = sqrt(-2 * log(u1));
+    const double theta = 2.0 * M_PI * u2;
+    op(2 * b, radius * cos(theta));
+    if (2 * b + 1 < size) {
+      op(2 * b + 1, radius * sin(theta));
+    }
+  }
+}
+#endif
+
+// Large contiguous tensors are filled from Philox with a key drawn from the
+// generator; see THPhilox.hpp.
+static inline bool THTensor_(usePhilox)(THTensor *self)
+{
+  return THTensor_(numel)(self) >= TH_PHILOX_MIN_SIZE && THTensor_(isContiguous)(self);
+}
+
+static inline uint64_t THTensor_(philoxKey)(THGenerator *_generator)
+{
+  std::lock_guard<std::mutex> lock(_generator->mutex);
+  return THRandom_random64(_generator);
+}
 
 void THTensor_(random)(THTensor *self, THGenerator *_generator)
 {
@@ -138,14 +213,18 @@ void THTensor_(bernoulli)(THTensor *self, THGenerator *_generator, double p)
   if(cpuinfo_initialize() && cpuinfo_vendor_intel == cpuinfo_get_processor(0)->core->vendor) {
     std::lock_guard<std::mutex> lock(_generator->mutex);
     THTensor_(iBernoulli_generate_copy)(self, _generator, p);
-  } else {
-    std::lock_guard<std::mutex> lock(_generator->mutex);
-    TH_TENSOR_APPLY(real, self, *self_data = (real)THRandom_bernoulli(_generator, p););
+    return;
+  }
+#endif
+  if (THTensor_(usePhilox)(self)) {
+    THArgCheck(p >= 0 && p <= 1, 1, "must be >= 0 and <= 1");
+    real *data = THTensor_(data)(self);
+    THPhilox_uniformDoubleFill(THTensor_(numel)(self), THTensor_(philoxKey)(_generator),
+      [data, p](int64_t i, double u) { data[i] = (real)(u <= p); });
+    return;
   }
-#else
   std::lock_guard<std::mutex> lock(_generator->mutex);
   TH_TENSOR_APPLY(real, self, *self_data = (real)THRandom_bernoulli(_generator, p););
-#endif
 }
 
 void THTensor_(bernoulli_FloatTensor)(THTensor *self, THGenerator *_generator, THFloatTensor *p)
@@ -179,6 +258,18 @@ void THTensor_(bernoulli_Tensor)(THTensor *self, THGenerator *_generator, THTens
 
 void THTensor_(uniform)(THTensor *self, THGenerator *_generator, double a, double b)
 {
+  if (THTensor_(usePhilox)(self)) {
+    real *data = THTensor_(data)(self);
+    #if defined(TH_REAL_IS_FLOAT)
+    const float fa = (float)a, fb = (float)b;
+    THPhilox_uniformFloatFill(THTensor_(numel)(self), THTensor_(philoxKey)(_generator),
+      [data, fa, fb](int64_t i, float u) { data[i] = u * (fb - fa) + fa; });
+    #else
+    THPhilox_uniformDoubleFill(THTensor_(numel)(self), THTensor_(philoxKey)(_generator),
+      [data, a, b](int64_t i, double u) { data[i] = (real)(u * (b - a) + a); });
+    #endif
+    return;
+  }
   std::lock_guard<std::mutex> lock(_generator->mutex);
   #if defined(TH_REAL_IS_FLOAT)
   TH_TENSOR_APPLY(real, self, *self_data =
@@ -191,6 +282,12 @@ void THTensor_(uniform)(THTensor *self, THGenerator *_generator, double a, doubl
 
 void THTensor_(normal)(THTensor *self, THGenerator *_generator, double mean, double stddev)
 {
+  if (THTensor_(usePhilox)(self)) {
+    real *data = THTensor_(data)(self);
+    THPhilox_normalFill(THTensor_(numel)(self), THTensor_(philoxKey)(_generator),
+      [data, mean, stddev](int64_t i, double z) { data[i] = (real)(z * stddev + mean); });
+    return;
+  }
   std::lock_guard<std::mutex> lock(_generator->mutex);
   const int64_t size = THTensor_(numel)(self);
   if (size >= 16 && THTensor_(isContiguous)(self)) {
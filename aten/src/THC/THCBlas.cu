@@ -2,6 +2,9 @@
 #include "THCGeneral.h"
 #include "THCHalf.h"
 
+#include "ATen/Context.h"
+#include "ATen/cuda/CUDAContext.h"
+
 #include <algorithm>
 
 float THCudaBlas_Sdot(THCState *state, int64_t n, float *x, int64_t incx, float *y, int64_t incy)
@@ -16,8 +19,7 @@ float THCudaBlas_Sdot(THCState *state, int64_t n, float *x, int64_t incx, float
     int i_incx = (int)incx;
     int i_incy = (int)incy;
     float result;
-    cublasHandle_t handle = THCState_getCurrentBlasHandle(state);
-    cublasSetStream(handle, THCState_getCurrentStream(state));
+    cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
     THCublasCheck(cublasSdot(handle, i_n, x, i_incx, y, i_incy, &result));
     return result;
   }
@@ -39,8 +41,7 @@ double THCudaBlas_Ddot(THCState *state, int64_t n, double *x, int64_t incx, doub
     int i_incx = (int)incx;
     int i_incy = (int)incy;
     double result;
-    cublasHandle_t handle = THCState_getCurrentBlasHandle(state);
-    cublasSetStream(handle, THCState_getCurrentStream(state));
+    cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
     THCublasCheck(cublasDdot(handle, i_n, x, i_incx, y, i_incy, &result));
     return result;
   }
@@ -60,8 +61,7 @@ half THCudaBlas_Hdot(THCState *state, int64_t n, half *x, int64_t incx, half *y,
 
   if ((n <= INT_MAX) && (incx <= INT_MAX) && (incy <= INT_MAX)) {
     half result;
-    cublasHandle_t handle = THCState_getCurrentBlasHandle(state);
-    cublasSetStream(handle, THCState_getCurrentStream(state));
+    cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
     THCublasCheck(cublasDotEx(handle, n,
                               x, CUDA_R_16F, incx,
                               y, CUDA_R_16F, incy,
@@ -111,8 +111,7 @@ void THCudaBlas_Sgemv(THCState *state, char trans, int64_t m, int64_t n, float a
     int i_incx = (int)incx;
     int i_incy = (int)incy;
 
-    cublasHandle_t handle = THCState_getCurrentBlasHandle(state);
-    cublasSetStream(handle, THCState_getCurrentStream(state));
+    cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
     THCublasCheck(cublasSgemv(handle, op, i_m, i_n, &alpha, a, i_lda, x, i_incx, &beta, y, i_incy));
     return;
   }
@@ -141,8 +140,7 @@ void THCudaBlas_Dgemv(THCState *state, char trans, int64_t m, int64_t n, double
     int i_incx = (int)incx;
     int i_incy = (int)incy;
 
-    cublasHandle_t handle = THCState_getCurrentBlasHandle(state);
-    cublasSetStream(handle, THCState_getCurrentStream(state));
+    cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
     THCublasCheck(cublasDgemv(handle, op, i_m, i_n, &alpha, a, i_lda, x, i_incx, &beta, y, i_incy));
     return;
   }
@@ -162,8 +160,7 @@ void THCudaBlas_Sger(THCState *state, int64_t m, int64_t n, float alpha, float *
       int i_incx = (int)incx;
       int i_incy = (int)incy;
 
-      cublasHandle_t handle = THCState_getCurrentBlasHandle(state);
-      cublasSetStream(handle, THCState_getCurrentStream(state));
+      cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
       THCublasCheck(cublasSger(handle, i_m, i_n, &alpha, x, i_incx, y, i_incy, a, i_lda));
       return;
     }
@@ -183,8 +180,7 @@ void THCudaBlas_Dger(THCState *state, int64_t m, int64_t n, double alpha, double
       int i_incx = (int)incx;
       int i_incy = (int)incy;
 
-      cublasHandle_t handle = THCState_getCurrentBlasHandle(state);
-      cublasSetStream(handle, THCState_getCurrentStream(state));
+      cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
       THCublasCheck(cublasDger(handle, i_m, i_n, &alpha, x, i_incx, y, i_incy, a, i_lda));
       return;
     }
@@ -237,6 +233,19 @@ void adjustLdLevel3(char transa, char transb, int64_t m, int64_t n, int64_t k, i
 
 }
 
+// Whether float GEMMs run on a tensor op math handle, which lets them use
+// tensor cores at reduced precision (TF32 from CUDA 11, fp16 inputs before).
+// It's opt-in, see Context::allowReducedPrecisionCuBLAS.
+static bool useTensorOpMathForFloat(THCState *state)
+{
+#if CUDA_VERSION >= 9000 && !defined __HIP_PLATFORM_HCC__
+  return at::globalContext().allowReducedPrecisionCuBLAS() &&
+         THCState_getCurrentDeviceProperties(state)->major >= 7;
+#else
+  return false;
+#endif
+}
+
 /* Level 3 */
 void THCudaBlas_Sgemm(THCState *state, char transa, char transb, int64_t m, int64_t n, int64_t k, float alpha, float *a, int64_t lda, float *b, int64_t ldb, float beta, float *c, int64_t ldc)
 {
@@ -253,8 +262,7 @@ void THCudaBlas_Sgemm(THCState *state, char transa, char transb, int64_t m, int6
     int i_ldb = (int)ldb;
     int i_ldc = (int)ldc;
 
-    cublasHandle_t handle = THCState_getCurrentBlasHandle(state);
-    cublasSetStream(handle, THCState_getCurrentStream(state));
+    cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle(useTensorOpMathForFloat(state));
     THCublasCheck(cublasSgemm(handle, opa, opb, i_m, i_n, i_k, &alpha, a, i_lda, b, i_ldb, &beta, c, i_ldc));
     return;
   }
@@ -282,14 +290,12 @@ void THCudaBlas_Hgemm(THCState *state, char transa, char transb, int64_t m, int6
       int i_ldb = (int)ldb;
       int i_ldc = (int)ldc;
 
-      cublasHandle_t handle = THCState_getCurrentBlasHandle(state);
-      cublasSetStream(handle, THCState_getCurrentStream(state));
-
       // Simulated Hgemm
       float fAlpha = THC_half2float(alpha);
       float fBeta = THC_half2float(beta);
 
 #if CUDA_VERSION < 9000
+      cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
       THCublasCheck(cublasSgemmEx(handle, opa, opb,
                                   i_m, i_n, i_k, &fAlpha,
                                   a, CUDA_R_16F, i_lda, b, CUDA_R_16F,
@@ -297,18 +303,23 @@ void THCudaBlas_Hgemm(THCState *state, char transa, char transb, int64_t m, int6
 #else
       cudaDeviceProp* prop = THCState_getCurrentDeviceProperties(state);
       if (prop->major >= 5){
-#ifndef __HIP_PLATFORM_HCC__
-        THCublasCheck(cublasSetMathMode(handle, CUBLAS_TENSOR_OP_MATH));
-#endif
-	THCublasCheck(cublasGemmEx(handle, opa, opb,
-                                   i_m, i_n, i_k, &fAlpha,
-                                   a, CUDA_R_16F, i_lda, b, CUDA_R_16F,
-                                   i_ldb, &fBeta, c, CUDA_R_16F, i_ldc,
-                                   CUDA_R_32F, CUBLAS_GEMM_DFALT_TENSOR_OP));
-#ifndef __HIP_PLATFORM_HCC__
-	THCublasCheck(cublasSetMathMode(handle, CUBLAS_DEFAULT_MATH));
-#endif
+        cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle(/*tensor_op_math=*/true);
+        if (at::globalContext().allowReducedPrecisionCuBLAS()) {
+          // accumulate in half as well
+          THCublasCheck(cublasGemmEx(handle, opa, opb,
+                                     i_m, i_n, i_k, &alpha,
+                                     a, CUDA_R_16F, i_lda, b, CUDA_R_16F,
+                                     i_ldb, &beta, c, CUDA_R_16F, i_ldc,
+                                     CUDA_R_16F, CUBLAS_GEMM_DFALT_TENSOR_OP));
+        } else {
+          THCublasCheck(cublasGemmEx(handle, opa, opb,
+                                     i_m, i_n, i_k, &fAlpha,
+                                     a, CUDA_R_16F, i_lda, b, CUDA_R_16F,
+                                     i_ldb, &fBeta, c, CUDA_R_16F, i_ldc,
+                                     CUDA_R_32F, CUBLAS_GEMM_DFALT_TENSOR_OP));
+        }
       }else{
+        cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
         THCublasCheck(cublasSgemmEx(handle, opa, opb,
                                     i_m, i_n, i_k, &fAlpha,
                                     a, CUDA_R_16F, i_lda, b, CUDA_R_16F,
@@ -336,8 +347,7 @@ void THCudaBlas_Dgemm(THCState *state, char transa, char transb, int64_t m, int6
     int i_ldb = (int)ldb;
     int i_ldc = (int)ldc;
 
-    cublasHandle_t handle = THCState_getCurrentBlasHandle(state);
-    cublasSetStream(handle, THCState_getCurrentStream(state));
+    cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
     THCublasCheck(cublasDgemm(handle, opa, opb, i_m, i_n, i_k, &alpha, a, i_lda, b, i_ldb, &beta, c, i_ldc));
     return;
   }
@@ -361,18 +371,25 @@ void THCudaBlas_HgemmStridedBatched(THCState *state, char transa, char transb, i
   cublasOperation_t opa = convertTransToCublasOperation(transa);
   cublasOperation_t opb = convertTransToCublasOperation(transb);
 
-  cublasHandle_t handle = THCState_getCurrentBlasHandle(state);
-  cublasSetStream(handle, THCState_getCurrentStream(state));
+  cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle(/*tensor_op_math=*/true);
+  if (at::globalContext().allowReducedPrecisionCuBLAS()) {
+    // accumulate in half as well
+    THCublasCheck(cublasGemmStridedBatchedEx(handle,
+                                     opa, opb, (int)m, (int)n, (int)k,
+                                     (void*)&alpha, a, CUDA_R_16F, (int)lda, strideA,
+                                     b, CUDA_R_16F, (int)ldb, strideB,
+                                     (void*)&beta, c, CUDA_R_16F, (int)ldc, strideC,
+                                     (int)batchCount, CUDA_R_16F, CUBLAS_GEMM_DEFAULT_TENSOR_OP));
+    return;
+  }
   float fAlpha = THC_half2float(alpha);
   float fBeta = THC_half2float(beta);
-  THCublasCheck(cublasSetMathMode(handle, CUBLAS_TENSOR_OP_MATH));
   THCublasCheck(cublasGemmStridedBatchedEx(handle,
                                    opa, opb, (int)m, (int)n, (int)k,
                                    (void*)&fAlpha, a, CUDA_R_16F, (int)lda, strideA,
                                    b, CUDA_R_16F, (int)ldb, strideB,
                                    (void*)&fBeta, c, CUDA_R_16F, (int)ldc, strideC,
                                    (int)batchCount, CUDA_R_32F, CUBLAS_GEMM_DEFAULT_TENSOR_OP));
-  THCublasCheck(cublasSetMathMode(handle, CUBLAS_DEFAULT_MATH));
 }
 #endif
 
@@ -400,8 +417,7 @@ void THCudaBlas_SgemmBatched(THCState *state, char transa, char transb, int64_t
   cublasOperation_t opa = convertTransToCublasOperation(transa);
   cublasOperation_t opb = convertTransToCublasOperation(transb);
 
-  cublasHandle_t handle = THCState_getCurrentBlasHandle(state);
-  cublasSetStream(handle, THCState_getCurrentStream(state));
+  cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle(useTensorOpMathForFloat(state));
   THCublasCheck(cublasSgemmBatched(handle,
                                    opa, opb, (int)m, (int)n, (int)k,
                                    &alpha, a, (int)lda, b, (int)ldb, &beta, c, (int)ldc,
@@ -425,8 +441,7 @@ void THCudaBlas_SgemmStridedBatched(THCState *state, char transa, char transb, i
   cublasOperation_t opa = convertTransToCublasOperation(transa);
   cublasOperation_t opb = convertTransToCublasOperation(transb);
 
-  cublasHandle_t handle = THCState_getCurrentBlasHandle(state);
-  cublasSetStream(handle, THCState_getCurrentStream(state));
+  cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle(useTensorOpMathForFloat(state));
   THCublasCheck(cublasSgemmStridedBatched(handle,
                                    opa, opb, (int)m, (int)n, (int)k,
                                    &alpha, a, (int)lda, strideA, b, (int)ldb, strideB, &beta, c, (int)ldc, strideC,
@@ -458,8 +473,7 @@ void THCudaBlas_DgemmBatched(THCState *state, char transa, char transb, int64_t
   cublasOperation_t opa = convertTransToCublasOperation(transa);
   cublasOperation_t opb = convertTransToCublasOperation(transb);
 
-  cublasHandle_t handle = THCState_getCurrentBlasHandle(state);
-  cublasSetStream(handle, THCState_getCurrentStream(state));
+  cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
   THCublasCheck(cublasDgemmBatched(handle,
                                    opa, opb, (int)m, (int)n, (int)k,
                                    &alpha, a, (int)lda, b, (int)ldb, &beta, c, (int)ldc,
@@ -482,8 +496,7 @@ void THCudaBlas_DgemmStridedBatched(THCState *state, char transa, char transb, i
   cublasOperation_t opa = convertTransToCublasOperation(transa);
   cublasOperation_t opb = convertTransToCublasOperation(transb);
 
-  cublasHandle_t handle = THCState_getCurrentBlasHandle(state);
-  cublasSetStream(handle, THCState_getCurrentStream(state));
+  cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
   THCublasCheck(cublasDgemmStridedBatched(handle,
                                    opa, opb, (int)m, (int)n, (int)k,
                                    &alpha, a, (int)lda, strideA, b, (int)ldb, strideB, &beta, c, (int)ldc, strideC,
@@ -498,8 +511,7 @@ void THCudaBlas_Sgetrf(THCState *state, int n, float **a, int lda, int *pivot, i
     THError("Cublas_Sgetrf only supports n, lda, batchSize"
             "with the bound [val] <= %d", INT_MAX);
   }
-  cublasHandle_t handle = THCState_getCurrentBlasHandle(state);
-  cublasSetStream(handle, THCState_getCurrentStream(state));
+  cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
   THCublasCheck(cublasSgetrfBatched(handle, n, a, lda, pivot, info, batchSize));
 }
 
@@ -509,8 +521,7 @@ void THCudaBlas_Dgetrf(THCState *state, int n, double **a, int lda, int *pivot,
     THError("Cublas_Dgetrf only supports n, lda, batchSize"
             "with the bound [val] <= %d", INT_MAX);
   }
-  cublasHandle_t handle = THCState_getCurrentBlasHandle(state);
-  cublasSetStream(handle, THCState_getCurrentStream(state));
+  cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
   THCublasCheck(cublasDgetrfBatched(handle, n, a, lda, pivot, info, batchSize));
 }
 
@@ -525,8 +536,7 @@ THC_API void THCudaBlas_Sgetrs(THCState *state, char transa, int n, int nrhs, co
   // no need to adjust leading dimensions, since matrices are square
   cublasOperation_t opa = convertTransToCublasOperation(transa);
 
-  cublasHandle_t handle = THCState_getCurrentBlasHandle(state);
-  cublasSetStream(handle, THCState_getCurrentStream(state));
+  cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
   THCublasCheck(cublasSgetrsBatched(handle, opa, n, nrhs, a, lda, pivot, b, ldb, info, batchSize));
 }
 
@@ -542,8 +552,7 @@ THC_API void THCudaBlas_Dgetrs(THCState *state, char transa, int n, int nrhs, co
   // no need to adjust leading dimensions, since matrices are square
   cublasOperation_t opa = convertTransToCublasOperation(transa);
 
-  cublasHandle_t handle = THCState_getCurrentBlasHandle(state);
-  cublasSetStream(handle, THCState_getCurrentStream(state));
+  cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
   THCublasCheck(cublasDgetrsBatched(handle, opa, n, nrhs, a, lda, pivot, b, ldb, info, batchSize));
 }
 
@@ -554,8 +563,7 @@ void THCudaBlas_Sgetri(THCState *state, int n, const float **a, int lda, int *pi
     THError("Cublas_Sgetri only supports n, lda, ldc, batchSize"
             "with the bound [val] <= %d", INT_MAX);
   }
-  cublasHandle_t handle = THCState_getCurrentBlasHandle(state);
-  cublasSetStream(handle, THCState_getCurrentStream(state));
+  cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
   THCublasCheck(cublasSgetriBatched(handle, n, a, lda, pivot, c, ldc, info, batchSize));
 }
 
@@ -566,7 +574,6 @@ void THCudaBlas_Dgetri(THCState *state, int n, const double **a, int lda, int *p
     THError("Cublas_Dgetri only supports n, lda, ldc, batchSize"
             "with the bound [val] <= %d", INT_MAX);
   }
-  cublasHandle_t handle = THCState_getCurrentBlasHandle(state);
-  cublasSetStream(handle, THCState_getCurrentStream(state));
+  cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
   THCublasCheck(cublasDgetriBatched(handle, n, a, lda, pivot, c, ldc, info, batchSize));
 }
@@ -3,10 +3,12 @@
 #include <ATen/Context.h>
 #include <ATen/cuda/CUDAContext.h>
 #include <ATen/cuda/Exceptions.h>
+#include <ATen/core/StaticTracepoint.h>
 
 #include <cuda_runtime_api.h>
 #include <algorithm>
 #include <deque>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -25,8 +27,14 @@
 // - If the cudaMalloc fails, the allocator will free all cached blocks that
 //   are not split and retry the allocation.
 // - Large (>1MB) and small allocation requests are handled separately. Large
-//   allocation requests can be filled by a cudaMalloc call of the exact size.
-//   Small requests will allocate and split a 1MB buffer, if necessary.
+//   allocation requests are rounded up to a size class, four of which lie
+//   between consecutive powers of two, and can be filled by a cudaMalloc call
+//   of that size. Small requests will allocate and split a 1MB buffer, if
+//   necessary.
+// - A cached large block is only split if the request takes at least half of
+//   it, so that small requests are not carved out of big segments, which could
+//   then never be released. If cudaMalloc fails, any cached block that fits is
+//   used before the cache is freed.
 //
 // With this allocator, allocations and frees should logically be considered
 // "usages" of the memory segment associated with streams, just like kernel
@@ -36,7 +44,21 @@
 // The library provides a recordStream() function to help insert the correct
 // synchronization when allocations are used on multiple streams. This will
 // ensure that the block is not reused before each recorded stream completes
-// work.
+// work. Freeing such a block records an event on each of its streams; within a
+// stream use batch (see beginStreamUseBatch()) the frees only queue the block,
+// and ending the batch records a single event per stream for all of them.
+// Completed events are kept for reuse rather than destroyed.
+//
+// A CUDA graph (see ATen/cuda/CUDAGraph.h) allocates everything it captures
+// on a stream of its own. Since blocks are only reused on their allocation
+// stream, the blocks of that stream form a private pool that no other work
+// draws from; while the graph is alive the pool is also retained (see
+// retainPrivatePool()) so that its free blocks, which replays of the graph
+// still use, are never returned to cudaFree.
+//
+// Allocations and frees fire the caching_malloc and caching_free static
+// tracepoints (see ATen/core/StaticTracepoint.h), and segments obtained from
+// and returned to CUDA fire cuda_malloc and cuda_free.
 //
 
 namespace {
@@ -47,33 +69,48 @@ typedef std::set<THCStreamPtr> stream_set;
 const size_t kRoundSmall = 512;     // round up small allocs to 512 bytes
 const size_t kRoundLarge = 131072;  // round up large allocs to 128 KiB
 const size_t kSmallAlloc = 1048576; // largest "small" allocation is 1 MiB
+const size_t kSizeClassesPerPowerOfTwo = 4; // size classes of large allocs
 
 struct DeviceStats {
   uint64_t   amount_allocated;      // total amount allocated in bytes
   uint64_t   max_amount_allocated;  // max total amount allocated in bytes
   uint64_t   amount_cached;         // total amount in cache in bytes
   uint64_t   max_amount_cached;     // max total amount in cache in bytes
+  uint64_t   total_allocated;       // sum of all allocations in bytes
+  uint64_t   total_freed;           // sum of all frees in bytes
+  uint64_t   amount_active;         // allocated, or freed but awaiting stream uses
+  uint64_t   num_segments;          // number of cudaMalloc'd segments
+  uint64_t   num_alloc_retries;     // cudaMalloc retries after freeing the cache
+  uint64_t   num_stream_events;     // events recorded to guard stream uses
+  uint64_t   amount_external;       // registered memory allocated elsewhere
 
   DeviceStats() :
       amount_allocated(0), max_amount_allocated(0),
-      amount_cached(0), max_amount_cached(0) { }
+      amount_cached(0), max_amount_cached(0),
+      total_allocated(0), total_freed(0),
+      amount_active(0), num_segments(0), num_alloc_retries(0),
+      num_stream_events(0), amount_external(0) { }
 
   void increaseAllocated(size_t delta) {
     amount_allocated += delta;
     max_amount_allocated = std::max(max_amount_allocated, amount_allocated);
+    total_allocated += delta;
   }
 
   void decreaseAllocated(size_t delta) {
     amount_allocated -= delta;
+    total_freed += delta;
   }
 
   void increaseCached(size_t delta) {
     amount_cached += delta;
     max_amount_cached = std::max(max_amount_cached, amount_cached);
+    num_segments++;
   }
 
   void decreaseCached(size_t delta) {
     amount_cached -= delta;
+    num_segments--;
   }
 };
 
@@ -93,6 +130,13 @@ struct Block {
       allocated(0), prev(NULL), next(NULL), event_count(0) { }
 };
 
+// an event recorded on a stream after all blocks in the list were freed
+struct StreamUseEvent {
+  int                 device; // device of the event's stream
+  cudaEvent_t         event;
+  std::vector<Block*> blocks; // blocks waiting on the event
+};
+
 static bool BlockComparator(const Block* a, const Block* b)
 {
   if (a->device != b->device) {
@@ -133,7 +177,29 @@ struct THCCachingAllocator
   std::unordered_map<void*, Block*> allocated_blocks;
 
   // outstanding cuda events
-  std::deque<std::pair<cudaEvent_t, Block*>> cuda_events;
+  std::deque<StreamUseEvent> cuda_events;
+
+  // freed blocks still in use by a stream, waiting for an event to be recorded
+  std::map<THCStreamPtr, std::vector<Block*>> pending_stream_uses;
+
+  // completed events available for reuse, by device
+  std::vector<std::vector<cudaEvent_t>> free_events;
+
+  // nesting depth of stream use batches
+  int stream_use_batch_depth = 0;
+
+  // allocation streams of the private pools of live CUDA graphs, with the
+  // number of times each was retained
+  std::map<cudaStream_t, int> private_pools;
+
+  // memory allocated outside of the allocator and wrapped in tensors, by
+  // device pointer: its size and device, and the number of registrations
+  struct ExternalAllocation {
+    size_t size;
+    int device;
+    int count;
+  };
+  std::unordered_map<void*, ExternalAllocation> external_allocations;
 
   THCCachingAllocator() :
       large_blocks(BlockComparator),
@@ -168,25 +234,36 @@ struct THCCachingAllocator
 
     DeviceStats &stats = get_stats_for_device(device);
 
-    Block search_key(device, stream, size);
-    auto& free_blocks = small ? large_blocks : small_blocks;
+    auto& free_blocks = small ? small_blocks : large_blocks;
 
-    Block* block = NULL;
+    Block* block = find_free_block(free_blocks, device, stream, size, !small);
     Block* remaining = NULL;
 
-    auto it = free_blocks.lower_bound(&search_key);
-    if (it != free_blocks.end() && (*it)->device == device && (*it)->stream == stream) {
-      block = *it;
-      free_blocks.erase(it);
-    } else {
+    if (!block) {
       void* ptr;
       size_t alloc_size = small ? kSmallAlloc : size;
-      err = cuda_malloc_retry(device, &ptr, alloc_size);
+      err = cudaMalloc(&ptr, alloc_size);
       if (err != cudaSuccess) {
-        return err;
+        cudaGetLastError();
+        // before giving memory back to the driver, split whatever fits
+        block = find_free_block(free_blocks, device, stream, size, false);
+        if (!block) {
+          stats.num_alloc_retries++;
+          err = free_cached_blocks(device);
+          if (err != cudaSuccess) {
+            return err;
+          }
+          err = cudaMalloc(&ptr, alloc_size);
+          if (err != cudaSuccess) {
+            return err;
+          }
+        }
+      }
+      if (!block) {
+        AT_SDT(cuda_malloc, device, alloc_size, ptr);
+        stats.increaseCached(alloc_size);
+        block = new Block(device, stream, alloc_size, (char*)ptr);
       }
-      stats.increaseCached(alloc_size);
-      block = new Block(device, stream, alloc_size, (char*)ptr);
     }
 
     if (block->size - size >= (small ? kRoundSmall : kSmallAlloc + 1)) {
@@ -211,9 +288,28 @@ struct THCCachingAllocator
     *devPtr = (void*)block->ptr;
 
     stats.increaseAllocated(block->size);
+    stats.amount_active += block->size;
+    AT_SDT(caching_malloc, device, block->size, block->ptr, stream);
     return cudaSuccess;
   }
 
+  /** removes and returns the smallest free block on the stream that fits size,
+      or NULL; with limit_split, large blocks more than twice size are skipped */
+  Block* find_free_block(FreeBlocks& free_blocks, int device, cudaStream_t stream, size_t size, bool limit_split)
+  {
+    Block search_key(device, stream, size);
+    auto it = free_blocks.lower_bound(&search_key);
+    if (it == free_blocks.end() || (*it)->device != device || (*it)->stream != stream) {
+      return NULL;
+    }
+    if (limit_split && (*it)->size - size > size) {
+      return NULL;
+    }
+    Block* block = *it;
+    free_blocks.erase(it);
+    return block;
+  }
+
   cudaError_t free(void* ptr)
   {
     std::lock_guard<std::mutex> lock(mutex);
@@ -229,6 +325,7 @@ struct THCCachingAllocator
     Block* block = it->second;
     allocated_blocks.erase(it);
     block->allocated = false;
+    AT_SDT(caching_free, block->device, block->size, block->ptr, block->stream);
 
     get_stats_for_device(block->device).decreaseAllocated(block->size);
     if (!block->stream_uses.empty()) {
@@ -239,6 +336,14 @@ struct THCCachingAllocator
     return cudaSuccess;
   }
 
+  /** returns cached segments of a device that are entirely free to the system
+      allocator; split segments stay cached */
+  cudaError_t emptyCache(int device)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return free_cached_blocks(device);
+  }
+
   /** returns cached blocks to the system allocator */
   cudaError_t emptyCache()
   {
@@ -251,7 +356,51 @@ struct THCCachingAllocator
     if (err != cudaSuccess) {
       return err;
     }
-    return cudaSuccess;
+    return free_cached_events();
+  }
+
+  /** keeps the cached blocks of stream's pool from being freed until the
+      matching releasePrivatePool() */
+  void retainPrivatePool(cudaStream_t stream)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    private_pools[stream]++;
+  }
+
+  /** frees the segments of stream's pool that are entirely free and lets
+      the remaining blocks be freed as usual */
+  cudaError_t releasePrivatePool(cudaStream_t stream)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = private_pools.find(stream);
+    THAssert(it != private_pools.end());
+    if (--it->second > 0) {
+      return cudaSuccess;
+    }
+    private_pools.erase(it);
+    cudaError_t err = free_stream_blocks(large_blocks, stream);
+    if (err != cudaSuccess) {
+      return err;
+    }
+    return free_stream_blocks(small_blocks, stream);
+  }
+
+  /** defers the events guarding stream uses of freed blocks until the
+      outermost batch ends */
+  void beginStreamUseBatch()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stream_use_batch_depth++;
+  }
+
+  cudaError_t endStreamUseBatch()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    THAssert(stream_use_batch_depth > 0);
+    if (--stream_use_batch_depth > 0) {
+      return cudaSuccess;
+    }
+    return record_stream_use_events();
   }
 
   void* getBaseAllocation(void* ptr, size_t* outSize)
@@ -297,11 +446,76 @@ struct THCCachingAllocator
     cacheInfoAux(small_blocks, dev_id, total, largest);
   }
 
+  // Accumulates sizes of the free blocks of a device that are part of a
+  // segment which is also partly allocated, and so can't be released
+  size_t inactiveSplitSize(FreeBlocks& blocks, int dev_id)
+  {
+    size_t total = 0;
+    Block search_key(dev_id, 0, 0);
+    auto it = blocks.lower_bound(&search_key);
+    for (;it != blocks.end() && *it && (*it)->device == dev_id; ++it) {
+      if ((*it)->prev || (*it)->next) {
+        total += (*it)->size;
+      }
+    }
+    return total;
+  }
+
+  void registerExternalAllocation(void* ptr, size_t size, int device)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = external_allocations.find(ptr);
+    if (it != external_allocations.end()) {
+      it->second.count++;
+      return;
+    }
+    // memory of the allocator coming back (e.g. through DLPack) is already
+    // counted as allocated
+    if (allocated_blocks.count(ptr)) {
+      size = 0;
+    }
+    external_allocations[ptr] = {size, device, 1};
+    get_stats_for_device(device).amount_external += size;
+  }
+
+  void unregisterExternalAllocation(void* ptr)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = external_allocations.find(ptr);
+    if (it == external_allocations.end()) {
+      THError("invalid external device pointer: %p", ptr);
+    }
+    if (--it->second.count == 0) {
+      get_stats_for_device(it->second.device).amount_external -= it->second.size;
+      external_allocations.erase(it);
+    }
+  }
+
+  void getStats(int dev_id, THCCachingAllocatorStats* out)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    DeviceStats& stats = get_stats_for_device(dev_id);
+    out->allocated = stats.amount_allocated;
+    out->max_allocated = stats.max_amount_allocated;
+    out->active = stats.amount_active;
+    out->reserved = stats.amount_cached;
+    out->max_reserved = stats.max_amount_cached;
+    out->inactive_split = inactiveSplitSize(large_blocks, dev_id) + inactiveSplitSize(small_blocks, dev_id);
+    out->num_segments = stats.num_segments;
+    out->num_alloc_retries = stats.num_alloc_retries;
+    out->num_stream_events = stats.num_stream_events;
+    out->external = stats.amount_external;
+  }
+
   void recordStream(void* ptr, THCStream* stream)
   {
     std::lock_guard<std::mutex> lock(mutex);
     Block* block = find_allocated_block(ptr);
     if (!block) {
+      if (external_allocations.count(ptr)) {
+        // the owner of external memory frees it; there is nothing to delay
+        return;
+      }
       THError("invalid device pointer: %p", ptr);
     }
     if (THCStream_stream(stream) == block->stream) {
@@ -317,8 +531,9 @@ struct THCCachingAllocator
   void free_block(Block* block)
   {
     THAssert(!block->allocated && block->event_count == 0);
+    get_stats_for_device(block->device).amount_active -= block->size;
     bool small = block->size <= kSmallAlloc;
-    auto& free_blocks = small ? large_blocks : small_blocks;
+    auto& free_blocks = small ? small_blocks : large_blocks;
     try_merge_blocks(block, block->prev, free_blocks);
     try_merge_blocks(block, block->next, free_blocks);
     free_blocks.insert(block);
@@ -354,28 +569,18 @@ struct THCCachingAllocator
     } else if (size < kSmallAlloc) {
       size += kRoundSmall - 1 - (size - 1) % kRoundSmall;
     } else {
-      size += kRoundLarge - 1 - (size - 1) % kRoundLarge;
-    }
-    return size;
-  }
-
-  cudaError_t cuda_malloc_retry(int device, void** devPtr, size_t size)
-  {
-    // Try cudaMalloc. If cudaMalloc fails, frees all non-split cached blocks
-    // and retries.
-    cudaError_t err = cudaMalloc(devPtr, size);
-    if (err != cudaSuccess) {
-      cudaGetLastError();
-      err = free_cached_blocks(device);
-      if (err != cudaSuccess) {
-        return err;
-      }
-      err = cudaMalloc(devPtr, size);
-      if (err != cudaSuccess) {
-        return err;
+      // the size class is a multiple of a quarter of the largest power of two
+      // below size, so at most a fifth of a block is wasted, and blocks freed by
+      // requests of similar sizes (e.g. varying sequence lengths) can be reused
+      // without splitting
+      size_t pow2 = kSmallAlloc;
+      while (pow2 * 2 < size) {
+        pow2 *= 2;
       }
+      size_t step = std::max(kRoundLarge, pow2 / kSizeClassesPerPowerOfTwo);
+      size += step - 1 - (size - 1) % step;
     }
-    return cudaSuccess;
+    return size;
   }
 
   cudaError_t free_cached_blocks(int device)
@@ -400,15 +605,17 @@ struct THCCachingAllocator
 
   cudaError_t free_blocks(FreeBlocks& blocks, FreeBlocks::iterator it, FreeBlocks::iterator end)
   {
-    // Frees all non-split blocks between `it` and `end`
+    // Frees all non-split blocks between `it` and `end`, except for those of
+    // private pools
     std::lock_guard<std::mutex> lock(cuda_free_mutex);
     while (it != end) {
       Block* block = *it;
-      if (!block->prev && !block->next) {
+      if (!block->prev && !block->next && !private_pools.count(block->stream)) {
         cudaError_t err = cudaFree((void*)block->ptr);
         if (err != cudaSuccess) {
           return err;
         }
+        AT_SDT(cuda_free, block->device, block->size, block->ptr);
         get_stats_for_device(block->device).decreaseCached(block->size);
         auto cur = it;
         ++it;
@@ -421,6 +628,24 @@ struct THCCachingAllocator
     return cudaSuccess;
   }
 
+  cudaError_t free_stream_blocks(FreeBlocks& blocks, cudaStream_t stream)
+  {
+    // Frees all non-split blocks of stream, on any device
+    for (auto it = blocks.begin(); it != blocks.end();) {
+      if ((*it)->stream != stream) {
+        ++it;
+        continue;
+      }
+      auto next = std::next(it);
+      cudaError_t err = free_blocks(blocks, it, next);
+      if (err != cudaSuccess) {
+        return err;
+      }
+      it = next;
+    }
+    return cudaSuccess;
+  }
+
   Block* find_allocated_block(void *ptr) {
     auto it = allocated_blocks.find(ptr);
     if (it == allocated_blocks.end()) {
@@ -431,61 +656,111 @@ struct THCCachingAllocator
 
   cudaError_t insert_events(Block* block)
   {
+    stream_set streams(std::move(block->stream_uses));
+    THAssert(block->stream_uses.empty());
+    for (auto& stream : streams) {
+      block->event_count++;
+      pending_stream_uses[stream].push_back(block);
+    }
+    if (stream_use_batch_depth > 0) {
+      return cudaSuccess;
+    }
+    return record_stream_use_events();
+  }
+
+  /** records one event on every stream with pending uses, which guards all
+      blocks freed while in use by that stream */
+  cudaError_t record_stream_use_events()
+  {
+    if (pending_stream_uses.empty()) {
+      return cudaSuccess;
+    }
+
     cudaError_t err;
 
     int prev_device;
     err = cudaGetDevice(&prev_device);
     if (err != cudaSuccess) return err;
 
-    std::set<THCStreamPtr> streams(std::move(block->stream_uses));
-    THAssert(block->stream_uses.empty());
-    for (auto it = streams.begin(); it != streams.end(); ++it) {
-      auto& stream = *it;
+    while (!pending_stream_uses.empty()) {
+      auto it = pending_stream_uses.begin();
+      THCStream* stream = it->first.get();
+      int device = THCStream_device(stream);
 
-      err = cudaSetDevice(THCStream_device(stream.get()));
+      err = cudaSetDevice(device);
       if (err != cudaSuccess) break;
 
       cudaEvent_t event;
-      err = cudaEventCreateWithFlags(&event, cudaEventDisableTiming);
+      err = get_event(device, &event);
       if (err != cudaSuccess) break;
 
-      err = cudaEventRecord(event, THCStream_stream(stream.get()));
-      if (err != cudaSuccess) break;
+      err = cudaEventRecord(event, THCStream_stream(stream));
+      if (err != cudaSuccess) {
+        free_events[device].push_back(event);
+        break;
+      }
 
-      block->event_count++;
-      cuda_events.emplace_back(event, block);
+      get_stats_for_device(device).num_stream_events++;
+      cuda_events.push_back(StreamUseEvent{device, event, std::move(it->second)});
+      pending_stream_uses.erase(it);
     }
 
     cudaSetDevice(prev_device);
     return err;
   }
 
+  /** takes a completed event of device for reuse, or creates one */
+  cudaError_t get_event(int device, cudaEvent_t* event)
+  {
+    if ((size_t) device >= free_events.size()) {
+      free_events.resize(device + 1);
+    }
+    auto& events = free_events[device];
+    if (!events.empty()) {
+      *event = events.back();
+      events.pop_back();
+      return cudaSuccess;
+    }
+    return cudaEventCreateWithFlags(event, cudaEventDisableTiming);
+  }
+
+  cudaError_t free_cached_events()
+  {
+    for (auto& events : free_events) {
+      while (!events.empty()) {
+        cudaError_t err = cudaEventDestroy(events.back());
+        if (err != cudaSuccess) {
+          return err;
+        }
+        events.pop_back();
+      }
+    }
+    return cudaSuccess;
+  }
+
   cudaError_t process_events()
   {
     // Process outstanding cudaEvents. Events that are completed are removed
-    // from the queue, and the 'event_count' for the corresponding allocation
-    // is decremented. Stops at the first event which has not been completed.
+    // from the queue, and the 'event_count' for each of their blocks is
+    // decremented. Stops at the first event which has not been completed.
     // Since events on different devices or streams may occur out of order,
     // the processing of some events may be delayed.
     while (!cuda_events.empty()) {
       auto& e = cuda_events.front();
-      cudaEvent_t event = e.first;
-      Block* block = e.second;
 
-      cudaError_t err = cudaEventQuery(event);
+      cudaError_t err = cudaEventQuery(e.event);
       if (err == cudaErrorNotReady) {
         break;
       } else if (err != cudaSuccess) {
         return err;
       }
-      err = cudaEventDestroy(event);
-      if (err != cudaSuccess) {
-        return err;
-      }
+      free_events[e.device].push_back(e.event);
 
-      block->event_count--;
-      if (block->event_count == 0) {
-        free_block(block);
+      for (Block* block : e.blocks) {
+        block->event_count--;
+        if (block->event_count == 0) {
+          free_block(block);
+        }
       }
       cuda_events.pop_front();
     }
@@ -528,6 +803,10 @@ THC_API void THCCachingAllocator_emptyCache(void) {
   AT_CUDA_CHECK(caching_allocator.emptyCache());
 }
 
+THC_API void THCCachingAllocator_emptyDeviceCache(int device) {
+  AT_CUDA_CHECK(caching_allocator.emptyCache(device));
+}
+
 THC_API void THCCachingAllocator_cacheInfo(int dev_id, size_t* cachedAndFree, size_t* largestBlock) {
   caching_allocator.cacheInfo(dev_id, cachedAndFree, largestBlock);
 }
@@ -542,6 +821,36 @@ THC_API void THCCachingAllocator_recordStream(void *ptr, THCStream* stream)
   caching_allocator.recordStream(ptr, stream);
 }
 
+THC_API void THCCachingAllocator_registerExternalAllocation(void *ptr, size_t size, int device)
+{
+  caching_allocator.registerExternalAllocation(ptr, size, device);
+}
+
+THC_API void THCCachingAllocator_unregisterExternalAllocation(void *ptr)
+{
+  caching_allocator.unregisterExternalAllocation(ptr);
+}
+
+THC_API void THCCachingAllocator_retainPrivatePool(cudaStream_t stream)
+{
+  caching_allocator.retainPrivatePool(stream);
+}
+
+THC_API void THCCachingAllocator_releasePrivatePool(cudaStream_t stream)
+{
+  AT_CUDA_CHECK(caching_allocator.releasePrivatePool(stream));
+}
+
+THC_API void THCCachingAllocator_beginStreamUseBatch(void)
+{
+  caching_allocator.beginStreamUseBatch();
+}
+
+THC_API void THCCachingAllocator_endStreamUseBatch(void)
+{
+  AT_CUDA_CHECK(caching_allocator.endStreamUseBatch());
+}
+
 THC_API std::mutex* THCCachingAllocator_getCudaFreeMutex()
 {
   return &caching_allocator.cuda_free_mutex;
@@ -574,3 +883,18 @@ THC_API uint64_t THCCachingAllocator_maxMemoryCached(int device) {
   assertValidDevice(device);
   return caching_allocator.get_stats_for_device(device).max_amount_cached;
 }
+
+THC_API void THCCachingAllocator_getStats(int device, THCCachingAllocatorStats* stats) {
+  assertValidDevice(device);
+  caching_allocator.getStats(device, stats);
+}
+
+THC_API uint64_t THCCachingAllocator_totalMemoryAllocated(int device) {
+  assertValidDevice(device);
+  return caching_allocator.get_stats_for_device(device).total_allocated;
+}
+
+THC_API uint64_t THCCachingAllocator_totalMemoryFreed(int device) {
+  assertValidDevice(device);
+  return caching_allocator.get_stats_for_device(device).total_freed;
+}
@@ -8,15 +8,53 @@
 #include "THCGeneral.h"
 #include "THCStream.h"
 
+// statistics of the caching allocator for one device, in bytes unless noted
+typedef struct THCCachingAllocatorStats {
+  uint64_t allocated;         // occupied by tensors
+  uint64_t max_allocated;
+  uint64_t active;            // allocated, or freed but still used by a stream
+  uint64_t reserved;          // obtained from cudaMalloc, i.e. memory cached
+  uint64_t max_reserved;
+  uint64_t inactive_split;    // free but in segments that are partly allocated,
+                              // so it can't be released; a measure of fragmentation
+  uint64_t num_segments;      // number of cudaMalloc'd segments
+  uint64_t num_alloc_retries; // failed cudaMalloc calls retried after freeing the cache
+  uint64_t num_stream_events; // events recorded to guard blocks freed while used by other streams
+  uint64_t external;          // memory allocated elsewhere but registered, e.g. by DLPack imports
+} THCCachingAllocatorStats;
+
 THC_API THCDeviceAllocator* THCCachingAllocator_get(void);
 THC_API void THCCachingAllocator_emptyCache(void);
+// releases the cached segments of device that are entirely free
+THC_API void THCCachingAllocator_emptyDeviceCache(int device);
+THC_API void THCCachingAllocator_getStats(int device, THCCachingAllocatorStats* stats);
 THC_API void THCCachingAllocator_cacheInfo(int dev_id, size_t* cachedAndFree, size_t* largestBlock);
 THC_API void* THCCachingAllocator_getBaseAllocation(void *ptr, size_t *size);
 THC_API void THCCachingAllocator_recordStream(void *ptr, THCStream* stream);
+// registers device memory that was allocated outside of the allocator but is
+// used by tensors (see at::fromExternalMemory), so that it is counted in the
+// `external` statistic and recordStream() accepts it; a pointer may be
+// registered several times, and is forgotten once unregistered as many
+THC_API void THCCachingAllocator_registerExternalAllocation(void *ptr, size_t size, int device);
+THC_API void THCCachingAllocator_unregisterExternalAllocation(void *ptr);
+// the cached blocks allocated on stream, the private pool of a CUDA graph,
+// aren't freed (e.g. by emptyCache) while the pool is retained; releasing
+// it frees its segments that are entirely free
+THC_API void THCCachingAllocator_retainPrivatePool(cudaStream_t stream);
+THC_API void THCCachingAllocator_releasePrivatePool(cudaStream_t stream);
+// between begin and end, blocks freed while used by other streams (see
+// recordStream) are guarded by one event per stream, recorded when the
+// outermost batch ends, instead of one event per block and stream; they can't
+// be reused before that
+THC_API void THCCachingAllocator_beginStreamUseBatch(void);
+THC_API void THCCachingAllocator_endStreamUseBatch(void);
 THC_API uint64_t THCCachingAllocator_currentMemoryAllocated(int device);
 THC_API uint64_t THCCachingAllocator_maxMemoryAllocated(int device);
 THC_API uint64_t THCCachingAllocator_currentMemoryCached(int device);
 THC_API uint64_t THCCachingAllocator_maxMemoryCached(int device);
+// bytes allocated and freed since the start of the process
+THC_API uint64_t THCCachingAllocator_totalMemoryAllocated(int device);
+THC_API uint64_t THCCachingAllocator_totalMemoryFreed(int device);
 
 #if (__cplusplus >= 201103L) || (defined(_MSC_VER) && defined(__cplusplus))
 THC_API std::mutex* THCCachingAllocator_getCudaFreeMutex();
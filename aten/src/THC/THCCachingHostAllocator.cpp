@@ -2,6 +2,7 @@
 #include "THCStream.h"
 
 #include <cuda_runtime_api.h>
+#include <algorithm>
 #include <deque>
 #include <memory>
 #include <mutex>
@@ -14,6 +15,27 @@ namespace {
 
 typedef std::shared_ptr<THCStream> THCStreamPtr;
 
+const size_t kMinBlockSize = 512;  // smallest size class in bytes
+const size_t kSizeClassesPerPowerOfTwo = 4;
+
+// rounds size up to a size class, so that blocks cached for one request can
+// be reused for requests of similar size
+static size_t roundSize(size_t size)
+{
+  if (size == 0) {
+    return 0;
+  }
+  if (size <= kMinBlockSize) {
+    return kMinBlockSize;
+  }
+  size_t pow2 = kMinBlockSize;
+  while (pow2 < size) {
+    pow2 <<= 1;
+  }
+  size_t step = pow2 / 2 / kSizeClassesPerPowerOfTwo;
+  return (size + step - 1) / step * step;
+}
+
 struct BlockSize
 {
   size_t  size; // allocation size
@@ -69,10 +91,13 @@ struct HostAllocator
       return err;
     }
 
-    // search for the smallest block which can hold this allocation
+    size = roundSize(size);
+
+    // search for the smallest block which can hold this allocation; blocks
+    // more than twice as large are left for bigger requests
     BlockSize search_key(size);
     auto it = available.lower_bound(search_key);
-    if (it != available.end()) {
+    if (it != available.end() && it->size <= 2 * size) {
       Block& block = blocks.at(it->ptr);
       THAssert(!block.allocated && block.event_count == 0);
       block.allocated = true;
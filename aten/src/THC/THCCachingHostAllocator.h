@@ -17,7 +17,9 @@
 // and tensors in THCTensor_(copyAsyncCPU) and THCTensor_(copyAsyncCuda).
 //
 // Note that this allocator does not split larger allocations into smaller
-// blocks, unlike the caching device allocator.
+// blocks, unlike the caching device allocator. Requests are rounded up to one
+// of four size classes per power of two, and only served from cached blocks
+// at most twice their size.
 //
 THC_API THAllocator* getTHCCachingHostAllocator(void);
 
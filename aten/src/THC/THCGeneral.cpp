@@ -11,6 +11,7 @@
 #include "THCCachingAllocator.h"
 #include <stdlib.h>
 #include <stdint.h>
+#include <mutex>
 
 /* Size of scratch space available in global memory per each SM + stream */
 #define MIN_GLOBAL_SCRATCH_SPACE_PER_SM_STREAM 4 * sizeof(float)
@@ -113,26 +114,13 @@ void THCudaInit(THCState* state)
         state->p2pAccessEnabled[i][j] = -1;
   }
 
+  // The properties of each device are queried on first use: making every
+  // device current here would create a context, with its memory and startup
+  // cost, on devices the process may never use.
+  state->deviceInitialized = new std::atomic<bool>[numDevices];
   for (int i = 0; i < numDevices; ++i) {
-    THCCudaResourcesPerDevice* res = THCState_getDeviceResourcePtr(state, i);
-    THCudaCheck(cudaSetDevice(i));
-    THCudaCheck(cudaGetDeviceProperties(&state->deviceProperties[i], i));
-
-    /* The scratch space that we want to have available per each device is
-       based on the number of SMs available per device. We guarantee a
-       minimum of 128kb of space per device, but to future-proof against
-       future architectures that may have huge #s of SMs, we guarantee that
-       we have at least 16 bytes for each SM. */
-    int numSM = state->deviceProperties[i].multiProcessorCount;
-    size_t sizePerStream =
-      MIN_GLOBAL_SCRATCH_SPACE_PER_DEVICE >= numSM * MIN_GLOBAL_SCRATCH_SPACE_PER_SM_STREAM ?
-      MIN_GLOBAL_SCRATCH_SPACE_PER_DEVICE :
-      numSM * MIN_GLOBAL_SCRATCH_SPACE_PER_SM_STREAM;
-    res->scratchSpacePerStream = sizePerStream;
-  }
-
-  /* Restore to previous device */
-  THCudaCheck(cudaSetDevice(device));
+    state->deviceInitialized[i] = false;
+  }
 
   // Unlike CUDA streams, there is no NULL cuBLAS handle. The default THC
   // cuBLAS handle is the first user BLAS handle. Note that the actual BLAS
@@ -144,12 +132,43 @@ void THCudaInit(THCState* state)
   state->heapDelta = 0;
 }
 
+static std::mutex lazyInitDeviceMutex;
+
+/* Fills in the properties and scratch space size of device the first time
+   they are needed. cudaGetDeviceProperties doesn't need a context. */
+static void THCState_lazyInitDevice(THCState* state, int device)
+{
+  if (state->deviceInitialized[device].load(std::memory_order_acquire)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(lazyInitDeviceMutex);
+  if (state->deviceInitialized[device].load(std::memory_order_relaxed)) {
+    return;
+  }
+  THCudaCheck(cudaGetDeviceProperties(&state->deviceProperties[device], device));
+
+  /* The scratch space that we want to have available per each device is
+     based on the number of SMs available per device. We guarantee a
+     minimum of 128kb of space per device, but to future-proof against
+     future architectures that may have huge #s of SMs, we guarantee that
+     we have at least 16 bytes for each SM. */
+  int numSM = state->deviceProperties[device].multiProcessorCount;
+  size_t sizePerStream =
+    MIN_GLOBAL_SCRATCH_SPACE_PER_DEVICE >= numSM * MIN_GLOBAL_SCRATCH_SPACE_PER_SM_STREAM ?
+    MIN_GLOBAL_SCRATCH_SPACE_PER_DEVICE :
+    numSM * MIN_GLOBAL_SCRATCH_SPACE_PER_SM_STREAM;
+  state->resourcesPerDevice[device].scratchSpacePerStream = sizePerStream;
+
+  state->deviceInitialized[device].store(true, std::memory_order_release);
+}
+
 void THCudaShutdown(THCState* state)
 {
   THCRandom_shutdown(state);
 
   free(state->rngState);
   free(state->deviceProperties);
+  delete[] state->deviceInitialized;
 
   int deviceCount = 0;
   int prevDev = -1;
@@ -164,8 +183,11 @@ void THCudaShutdown(THCState* state)
 
   /* cleanup per-device state */
   for (int dev = 0; dev < deviceCount; ++dev) {
-    THCudaCheck(cudaSetDevice(dev));
     THCCudaResourcesPerDevice* res = &(state->resourcesPerDevice[dev]);
+    /* don't create a context on a device that was never used */
+    if (res->numBlasHandles > 0 || res->numSparseHandles > 0) {
+      THCudaCheck(cudaSetDevice(dev));
+    }
     /* Free user defined BLAS handles */
     for (int i = 0; i < res->numBlasHandles; ++i) {
       THCublasCheck(cublasDestroy(res->blasHandles[i]));
@@ -272,12 +294,13 @@ struct cudaDeviceProp* THCState_getCurrentDeviceProperties(THCState* state)
   int curDev = -1;
   THCudaCheck(cudaGetDevice(&curDev));
 
-  return &(state->deviceProperties[curDev]);
+  return THCState_getDeviceProperties(state, curDev);
 }
 
 struct cudaDeviceProp* THCState_getDeviceProperties(THCState* state, int device)
 {
   THAssert(device >= 0 && device < state->numDevices);
+  THCState_lazyInitDevice(state, device);
   return &(state->deviceProperties[device]);
 }
 
@@ -532,6 +555,7 @@ size_t THCState_getDeviceScratchSpaceSize(THCState* state, int device)
 {
   THCCudaResourcesPerDevice* res =
     THCState_getDeviceResourcePtr(state, device);
+  THCState_lazyInitDevice(state, device);
 
   return res->scratchSpacePerStream;
 }
@@ -2,10 +2,16 @@
 
 #include "THCGeneral.h"
 
+#include <atomic>
+
 /* Global state of THC. */
 struct THCState {
   struct THCRNGState* rngState;
   struct cudaDeviceProp* deviceProperties;
+  /* Whether deviceProperties and the scratch space size of each device have
+     been filled in. They are filled in on first use, so that a process never
+     touches devices it doesn't use (see THCState_lazyInitDevice). */
+  std::atomic<bool>* deviceInitialized;
   /* Set of all allocated resources. blasHandles and sparseHandles do not have
      a default and must be explicitly initialized. We always initialize 1
      blasHandle and 1 sparseHandle but we can use more.
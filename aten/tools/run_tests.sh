@@ -13,8 +13,11 @@ VALGRIND=${VALGRIND:=ON}
 ./wrapdim_test
 ./apply_utils_test
 ./dlconvertor_test
+./huge_page_test
 ./native_test
+./numa_test
 ./scalar_tensor_test
+./small_block_pool_test
 ./undefined_tensor_test
 if [[ -x ./cudnn_test ]]; then
   ./cudnn_test
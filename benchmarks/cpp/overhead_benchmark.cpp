@@ -0,0 +1,420 @@
+// Measures the overhead of the autograd engine and of the GraphExecutor on
+// graphs of operators so small that the time goes to the framework rather
+// than to the kernels:
+//
+//  - engine/...: backward over `width` independent chains of `depth`
+//    multiplications of 1-element tensors, on the CPU or switching between
+//    the CPU and the GPU every few operators. Reported per node of the
+//    backward graph, with the heap allocations (operator new) per node.
+//  - ready_queue/...: the time from the end of a function to the start of
+//    the next one in a chain, i.e. how long handing a task over through the
+//    ReadyQueues takes, within a device and across devices.
+//  - executor/...: GraphExecutor runs of an LSTM cell-like elementwise graph,
+//    with the fusion compiler on and off, without and with a backward pass.
+//
+// Results can be saved with --output and compared against a run of another
+// build with --compare, like benchmarks/dispatch_overhead.py:
+//
+//   overhead_benchmark --output before.json
+//   # rebuild
+//   overhead_benchmark --compare before.json
+
+#include "torch/csrc/autograd/engine.h"
+#include "torch/csrc/autograd/function.h"
+#include "torch/csrc/autograd/function_hook.h"
+#include "torch/csrc/autograd/variable.h"
+#include "torch/csrc/jit/graph_executor.h"
+#include "torch/csrc/jit/ir.h"
+#include "torch/csrc/jit/symbolic_variable.h"
+
+#include <ATen/ATen.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <new>
+#include <regex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using torch::autograd::Function;
+using torch::autograd::FunctionPostHook;
+using torch::autograd::FunctionPreHook;
+using torch::autograd::Variable;
+using torch::autograd::make_variable;
+using torch::autograd::variable_list;
+
+namespace {
+
+std::atomic<uint64_t> allocations(0);
+
+} // namespace
+
+// Counts the heap allocations of the whole process, including the engine
+// threads and libtorch
+void* operator new(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size ? size : 1)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+  int iters = 100;
+  int repeat = 5;
+  std::string filter;
+  std::string output;
+  std::string compare;
+};
+
+double seconds_since(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// The fastest of `repeat` measurements of `iters` calls, in seconds per call
+double best_time(const Options& options, const std::function<void()>& fn) {
+  double best = std::numeric_limits<double>::infinity();
+  for (int r = 0; r < options.repeat; ++r) {
+    auto start = Clock::now();
+    for (int i = 0; i < options.iters; ++i) {
+      fn();
+    }
+    best = std::min(best, seconds_since(start) / options.iters);
+  }
+  return best;
+}
+
+uint64_t count_allocations(const std::function<void()>& fn) {
+  auto before = allocations.load();
+  fn();
+  return allocations.load() - before;
+}
+
+bool has_cuda() {
+  return at::globalContext().hasCUDA() && at::globalContext().getNumGPUs() > 0;
+}
+
+// Number of distinct functions reachable from `fn`
+size_t count_functions(const std::shared_ptr<Function>& root) {
+  std::unordered_set<Function*> seen;
+  std::vector<Function*> stack{root.get()};
+  while (!stack.empty()) {
+    auto fn = stack.back();
+    stack.pop_back();
+    if (!fn || !seen.insert(fn).second) continue;
+    for (const auto& edge : fn->next_edges()) {
+      stack.push_back(edge.function.get());
+    }
+  }
+  return seen.size();
+}
+
+// The operators of a chain switch devices this often when mixing devices
+constexpr int kDeviceSwitchEvery = 4;
+
+Variable multiply(const Variable& x) {
+  return Variable(x * 1.0001);
+}
+
+Variable other_device(const Variable& x) {
+  return Variable(x.is_cuda() ? x.cpu() : x.cuda());
+}
+
+// Sum of `width` chains of `depth` multiplications
+Variable build_chains(int width, int depth, bool mixed, std::vector<Variable>& leaves) {
+  std::vector<at::Tensor> outputs;
+  for (int w = 0; w < width; ++w) {
+    auto leaf = make_variable(at::ones({1}), /*requires_grad=*/true);
+    leaves.push_back(leaf);
+    Variable y = leaf;
+    for (int d = 0; d < depth; ++d) {
+      if (mixed && d > 0 && d % kDeviceSwitchEvery == 0) {
+        y = other_device(y);
+      }
+      y = multiply(y);
+    }
+    outputs.push_back(y.is_cuda() ? y.cpu() : y);
+  }
+  return Variable(at::stack(outputs).sum());
+}
+
+struct Results {
+  std::map<std::string, double> values;
+  std::map<std::string, double> baseline;
+
+  void add(const std::string& name, double value) {
+    values[name] = value;
+    auto it = baseline.find(name);
+    std::printf("%-48s\t%12.4f", name.c_str(), value);
+    if (it != baseline.end()) {
+      std::printf("\t%12.4f\t%+7.1f%%", it->second, 100 * (value / it->second - 1));
+    }
+    std::printf("\n");
+  }
+};
+
+void bench_engine(const Options& options, Results& results, bool mixed) {
+  const std::string devices = mixed ? "cpu_cuda" : "cpu";
+  for (int width : {1, 8, 64}) {
+    for (int depth : {8, 64}) {
+      std::ostringstream name;
+      name << "engine/" << devices << "/w" << width << "_d" << depth;
+      if (name.str().find(options.filter) == std::string::npos) continue;
+
+      std::vector<Variable> leaves;
+      auto loss = build_chains(width, depth, mixed, leaves);
+      const size_t nodes = count_functions(loss.grad_fn());
+      auto backward = [&] {
+        loss.backward(at::nullopt, /*keep_graph=*/true);
+      };
+      backward();  // warm up, and start the engine threads
+      const double time = best_time(options, backward);
+      const auto allocs = count_allocations(backward);
+      results.add(name.str() + "/us_per_node", time / nodes * 1e6);
+      results.add(name.str() + "/allocs_per_node", static_cast<double>(allocs) / nodes);
+    }
+  }
+}
+
+// Records when each function of a chain starts and ends
+struct ChainTimestamps {
+  explicit ChainTimestamps(size_t size) : start(size), end(size) {}
+  std::vector<Clock::time_point> start;
+  std::vector<Clock::time_point> end;
+};
+
+struct RecordStart : public FunctionPreHook {
+  RecordStart(ChainTimestamps* timestamps, size_t index)
+    : timestamps(timestamps), index(index) {}
+  variable_list operator()(const variable_list& grads) override {
+    timestamps->start[index] = Clock::now();
+    return grads;
+  }
+  ChainTimestamps* timestamps;
+  size_t index;
+};
+
+struct RecordEnd : public FunctionPostHook {
+  RecordEnd(ChainTimestamps* timestamps, size_t index)
+    : timestamps(timestamps), index(index) {}
+  variable_list operator()(const variable_list& grad_input, const variable_list& grad_output) override {
+    timestamps->end[index] = Clock::now();
+    return grad_input;
+  }
+  ChainTimestamps* timestamps;
+  size_t index;
+};
+
+void bench_ready_queue(const Options& options, Results& results, bool mixed) {
+  const std::string name = std::string("ready_queue/") + (mixed ? "cpu_cuda" : "cpu") + "/us";
+  if (name.find(options.filter) == std::string::npos) return;
+
+  constexpr int kDepth = 64;
+  auto y = make_variable(at::ones({1}), /*requires_grad=*/true);
+  Variable leaf = y;
+  for (int d = 0; d < kDepth; ++d) {
+    if (mixed) {
+      y = other_device(y);
+    }
+    y = multiply(y);
+  }
+  auto loss = Variable((y.is_cuda() ? y.cpu() : y).sum());
+
+  std::vector<std::shared_ptr<Function>> chain;
+  for (auto fn = loss.grad_fn(); fn; ) {
+    chain.push_back(fn);
+    fn = fn->num_outputs() > 0 ? fn->next_edge(0).function : nullptr;
+  }
+  ChainTimestamps timestamps(chain.size());
+  for (size_t i = 0; i < chain.size(); ++i) {
+    chain[i]->add_pre_hook(std::unique_ptr<FunctionPreHook>(new RecordStart(&timestamps, i)));
+    chain[i]->add_post_hook(std::unique_ptr<FunctionPostHook>(new RecordEnd(&timestamps, i)));
+  }
+
+  loss.backward(at::nullopt, /*keep_graph=*/true);  // warm up
+  double best = std::numeric_limits<double>::infinity();
+  for (int r = 0; r < options.repeat; ++r) {
+    double total = 0;
+    for (int i = 0; i < options.iters; ++i) {
+      loss.backward(at::nullopt, /*keep_graph=*/true);
+      for (size_t j = 0; j + 1 < chain.size(); ++j) {
+        total += std::chrono::duration<double>(timestamps.start[j + 1] - timestamps.end[j]).count();
+      }
+    }
+    best = std::min(best, total / (options.iters * (chain.size() - 1)));
+  }
+  results.add(name, best * 1e6);
+}
+
+// An LSTM cell-like graph of elementwise operators
+std::shared_ptr<torch::jit::Graph> build_cell() {
+  using Var = torch::jit::SymbolicVariable;
+  auto g = std::make_shared<torch::jit::Graph>();
+  auto x = Var::asNewInput(*g);
+  auto hx = Var::asNewInput(*g);
+  auto cx = Var::asNewInput(*g);
+  auto ingate = (x * hx).sigmoid();
+  auto forgetgate = (x + hx).sigmoid();
+  auto cellgate = (hx * cx).tanh();
+  auto outgate = (x - hx).sigmoid();
+  auto cy = forgetgate * cx + ingate * cellgate;
+  auto hy = outgate * cy.tanh();
+  hy.addAsOutput();
+  cy.addAsOutput();
+  return g;
+}
+
+void bench_executor(const Options& options, Results& results, bool cuda, bool fusion, bool backward) {
+  std::ostringstream name;
+  name << "executor/" << (cuda ? "cuda" : "cpu") << "/" << (fusion ? "fused" : "unfused")
+       << "/" << (backward ? "forward_backward" : "forward");
+  if (name.str().find(options.filter) == std::string::npos) return;
+
+  torch::jit::setFusionEnabled(fusion);
+  torch::jit::GraphExecutor executor(build_cell());
+  std::vector<Variable> inputs;
+  for (int i = 0; i < 3; ++i) {
+    auto tensor = at::randn({8, 32});
+    inputs.push_back(make_variable(cuda ? tensor.cuda() : tensor, /*requires_grad=*/backward));
+  }
+  auto run = [&] {
+    torch::jit::Stack stack(inputs.begin(), inputs.end());
+    executor.run(stack);
+    if (backward) {
+      auto hy = Variable(stack[0].toTensor());
+      auto cy = Variable(stack[1].toTensor());
+      Variable(hy.sum() + cy.sum()).backward();
+    } else if (cuda) {
+      // wait for the kernels, so that the time isn't only their launches
+      stack[0].toTensor().cpu();
+    }
+  };
+  run();  // warm up, and compile the plan
+  const double time = best_time(options, run);
+  const auto allocs = count_allocations(run);
+  torch::jit::setFusionEnabled(true);
+  results.add(name.str() + "/us", time * 1e6);
+  results.add(name.str() + "/allocs", static_cast<double>(allocs));
+}
+
+// Runs a group of cases, reporting rather than propagating their errors, e.g.
+// if the fusion compiler isn't supported on this machine
+void run_cases(const std::string& group, const std::function<void()>& fn) {
+  try {
+    fn();
+  } catch (const std::exception& e) {
+    std::printf("%-48s\tskipped: %s\n", group.c_str(), e.what());
+  }
+}
+
+std::map<std::string, double> load_results(const std::string& path) {
+  std::ifstream file(path);
+  if (!file) {
+    throw std::runtime_error("can't open " + path);
+  }
+  std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  std::map<std::string, double> values;
+  std::regex entry("\"([^\"]+)\"\\s*:\\s*([-+0-9.eE]+)");
+  for (std::sregex_iterator it(contents.begin(), contents.end(), entry), end; it != end; ++it) {
+    values[(*it)[1]] = std::stod((*it)[2]);
+  }
+  return values;
+}
+
+void save_results(const std::string& path, const std::map<std::string, double>& values) {
+  std::ofstream file(path);
+  file << "{\n  \"results\": {\n";
+  for (auto it = values.begin(); it != values.end(); ++it) {
+    file << "    \"" << it->first << "\": " << it->second
+         << (std::next(it) == values.end() ? "\n" : ",\n");
+  }
+  file << "  }\n}\n";
+}
+
+Options parse_options(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (i + 1 >= argc) {
+      throw std::runtime_error("missing value of " + arg);
+    }
+    std::string value = argv[++i];
+    if (arg == "--iters") {
+      options.iters = std::max(1, std::atoi(value.c_str()));
+    } else if (arg == "--repeat") {
+      options.repeat = std::max(1, std::atoi(value.c_str()));
+    } else if (arg == "--filter") {
+      options.filter = value;
+    } else if (arg == "--output") {
+      options.output = value;
+    } else if (arg == "--compare") {
+      options.compare = value;
+    } else {
+      throw std::runtime_error("unknown option " + arg + "; expected --iters, "
+                               "--repeat, --filter, --output or --compare");
+    }
+  }
+  return options;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  Results results;
+  try {
+    options = parse_options(argc, argv);
+    if (!options.compare.empty()) {
+      results.baseline = load_results(options.compare);
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "overhead_benchmark: " << e.what() << "\n";
+    return 1;
+  }
+
+  at::set_num_threads(1);
+  std::printf("%-48s\t%12s\t%12s\t%8s\n", "case", "value", "baseline", "change");
+  run_cases("engine/cpu", [&] { bench_engine(options, results, /*mixed=*/false); });
+  run_cases("ready_queue/cpu", [&] { bench_ready_queue(options, results, /*mixed=*/false); });
+  if (has_cuda()) {
+    run_cases("engine/cpu_cuda", [&] { bench_engine(options, results, /*mixed=*/true); });
+    run_cases("ready_queue/cpu_cuda", [&] { bench_ready_queue(options, results, /*mixed=*/true); });
+  }
+  for (bool cuda : {false, true}) {
+    if (cuda && !has_cuda()) continue;
+    for (bool fusion : {false, true}) {
+      for (bool backward : {false, true}) {
+        run_cases(cuda ? "executor/cuda" : "executor/cpu", [&] {
+          bench_executor(options, results, cuda, fusion, backward);
+        });
+      }
+    }
+  }
+
+  if (!options.output.empty()) {
+    save_results(options.output, results.values);
+  }
+  return 0;
+}
@@ -0,0 +1,96 @@
+"""Measures the per-call overhead of dispatching ops from Python.
+
+The ops run on tiny CPU tensors, so the time per call is dominated by
+argument parsing, overload resolution and dispatch rather than by the
+kernels. Results can be saved with --output and compared against a run of
+another build or release with --compare:
+
+    python benchmarks/dispatch_overhead.py --output before.json
+    # rebuild or switch releases
+    python benchmarks/dispatch_overhead.py --compare before.json
+"""
+import argparse
+import json
+import sys
+from timeit import default_timer as timer
+
+import torch
+
+
+def make_cases():
+    x = torch.ones(1)
+    y = torch.ones(1)
+    i = torch.ones(1, dtype=torch.long)
+    z = torch.tensor(2.)
+    w = torch.ones(2, 2, requires_grad=True)
+    return [
+        ('x.add(y)', lambda: x.add(y)),
+        ('x.add(2)', lambda: x.add(2)),
+        ('x.add(z)', lambda: x.add(z)),
+        ('x + y', lambda: x + y),
+        ('x.mul(2.5)', lambda: x.mul(2.5)),
+        ('torch.add(x, y, out=y)', lambda: torch.add(x, y, out=y)),
+        ('x.sum()', lambda: x.sum()),
+        ('x.sum(0)', lambda: x.sum(0)),
+        ('x.view(1, 1)', lambda: x.view(1, 1)),
+        ('x.view(-1)', lambda: x.view(-1)),
+        ('x.size(0)', lambda: x.size(0)),
+        ('x[0]', lambda: x[0]),
+        ('i.add(1)', lambda: i.add(1)),
+        ('torch.cat([x, y])', lambda: torch.cat([x, y])),
+        ('torch.empty(1)', lambda: torch.empty(1)),
+        ('x.relu()', lambda: x.relu()),
+        ('w.mul(2) (requires_grad)', lambda: w.mul(2)),
+    ]
+
+
+def time_case(fn, iters, repeat):
+    best = float('inf')
+    for _ in range(repeat):
+        start = timer()
+        for _ in range(iters):
+            fn()
+        best = min(best, timer() - start)
+    return best / iters * 1e6
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Benchmark the overhead of calling ops from Python.')
+    parser.add_argument('--iters', type=int, default=100000,
+                        help='calls per measurement; default: 100000')
+    parser.add_argument('--repeat', type=int, default=5,
+                        help='measurements per op, the fastest is reported; default: 5')
+    parser.add_argument('--filter', default='',
+                        help='only run the ops whose name contains this string')
+    parser.add_argument('--output', help='save the results as JSON to this file')
+    parser.add_argument('--compare', help='compare against results saved with --output')
+    args = parser.parse_args()
+
+    torch.set_num_threads(1)
+    baseline = {}
+    if args.compare:
+        with open(args.compare) as f:
+            baseline = json.load(f)['results']
+
+    results = {}
+    print('torch {}'.format(torch.__version__))
+    print('{:<28}\t{:>9}\t{:>9}\t{:>7}'.format('op', 'us/call', 'baseline', 'change'))
+    for name, fn in make_cases():
+        if args.filter not in name:
+            continue
+        fn()  # warm up
+        us = time_case(fn, args.iters, args.repeat)
+        results[name] = us
+        if name in baseline:
+            change = '{:+.1f}%'.format(100 * (us / baseline[name] - 1))
+            print('{:<28}\t{:>9.3f}\t{:>9.3f}\t{:>7}'.format(name, us, baseline[name], change))
+        else:
+            print('{:<28}\t{:>9.3f}'.format(name, us))
+
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump({'version': torch.__version__, 'results': results}, f, indent=2)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
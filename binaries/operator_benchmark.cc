@@ -0,0 +1,432 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmarks single operators over sweeps of input shapes, data types and
+// devices, and writes the results as JSON, one object per operator run:
+//
+//   operator_benchmark --operators=Relu,Add,ATen:relu \
+//     --shapes="1024;1024,1024;256x256,256x256" --dtypes=float \
+//     --peak_gflops=1000 --peak_gbps=100 --json=relu.json
+//
+// Each point of --shapes lists the shapes of the inputs of the operator; an
+// operator is run at the points whose number of inputs its schema accepts.
+// --operators=all runs every operator registered for the device. ATen
+// functions are run through the ATen operator, when it is built in.
+//
+// The FLOPs and bytes of a run come from the cost inference function of the
+// schema of the operator, and otherwise the bytes are the sizes of the inputs
+// and outputs. They give the achieved GFLOP/s and GB/s, also reported as
+// fractions of --peak_gflops and --peak_gbps when those are given. The CPU
+// allocations made by the timed iterations are counted as well.
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "caffe2/core/allocator.h"
+#include "caffe2/core/init.h"
+#include "caffe2/core/logging.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/operator_schema.h"
+#include "caffe2/core/timer.h"
+#include "caffe2/core/workspace.h"
+#include "caffe2/utils/proto_utils.h"
+#include "caffe2/utils/string_utils.h"
+
+CAFFE2_DEFINE_string(
+    operators,
+    "",
+    "Comma separated operators to benchmark, or 'all' for all the operators "
+    "registered for the device. ATen functions are given as ATen:<name>.");
+CAFFE2_DEFINE_string(
+    engine,
+    "",
+    "The engine of the operators to benchmark.");
+CAFFE2_DEFINE_string(
+    shapes,
+    "1048576",
+    "Semicolon separated points of the shape sweep. Each point is a comma "
+    "separated list of the shapes of the inputs, with dims separated by 'x'.");
+CAFFE2_DEFINE_string(
+    dtypes,
+    "float",
+    "Comma separated data types of the inputs. The supported types are "
+    "float, double, int, int64 and uint8.");
+CAFFE2_DEFINE_string(
+    devices,
+    "cpu",
+    "Comma separated devices to run on. The supported devices are cpu and "
+    "cuda.");
+CAFFE2_DEFINE_int(warmup, 2, "The number of iterations to warm up.");
+CAFFE2_DEFINE_int(iter, 10, "The number of timed iterations.");
+CAFFE2_DEFINE_double(
+    peak_gflops,
+    0,
+    "The peak GFLOP/s of the machine, to report the fraction achieved.");
+CAFFE2_DEFINE_double(
+    peak_gbps,
+    0,
+    "The peak memory bandwidth of the machine in GB/s, to report the "
+    "fraction achieved.");
+CAFFE2_DEFINE_string(
+    json,
+    "",
+    "The file to write the JSON results to. Defaults to stdout.");
+
+namespace caffe2 {
+namespace {
+
+// Counts the allocations made through the CPU allocator.
+class CountingCPUAllocator final : public CPUAllocator {
+ public:
+  std::pair<void*, MemoryDeleter> New(size_t nbytes) override {
+    allocations_++;
+    bytes_ += nbytes;
+    return base_.New(nbytes);
+  }
+
+  MemoryDeleter GetDeleter() override {
+    return base_.GetDeleter();
+  }
+
+  void Reset() {
+    allocations_ = 0;
+    bytes_ = 0;
+  }
+
+  uint64_t allocations() const {
+    return allocations_;
+  }
+
+  uint64_t bytes() const {
+    return bytes_;
+  }
+
+ private:
+  DefaultCPUAllocator base_;
+  std::atomic<uint64_t> allocations_{0};
+  std::atomic<uint64_t> bytes_{0};
+};
+
+const std::string kATenPrefix = "ATen:";
+
+struct Result {
+  std::string op;
+  std::string device;
+  std::string dtype;
+  std::vector<std::vector<TIndex>> shapes;
+  float mean_ms;
+  float min_ms;
+  float max_ms;
+  uint64_t flops;
+  uint64_t bytes;
+  double allocations;
+  double allocated_bytes;
+};
+
+std::vector<TIndex> ParseShape(const std::string& str) {
+  std::vector<TIndex> dims;
+  for (const auto& dim : split('x', str)) {
+    dims.push_back(std::stoll(dim));
+  }
+  return dims;
+}
+
+TensorProto::DataType ParseDataType(const std::string& str) {
+  if (str == "float") {
+    return TensorProto_DataType_FLOAT;
+  } else if (str == "double") {
+    return TensorProto_DataType_DOUBLE;
+  } else if (str == "int") {
+    return TensorProto_DataType_INT32;
+  } else if (str == "int64") {
+    return TensorProto_DataType_INT64;
+  } else if (str == "uint8") {
+    return TensorProto_DataType_UINT8;
+  }
+  CAFFE_THROW("Unsupported data type ", str);
+}
+
+DeviceType ParseDevice(const std::string& str) {
+  if (str == "cpu") {
+    return CPU;
+  } else if (str == "cuda") {
+    return CUDA;
+  }
+  CAFFE_THROW("Unsupported device ", str);
+}
+
+template <typename T, typename Distribution>
+void Fill(Tensor* tensor, Distribution distribution, std::mt19937* gen) {
+  auto* data = tensor->mutable_data<T>();
+  for (TIndex i = 0; i < tensor->size(); ++i) {
+    data[i] = static_cast<T>(distribution(*gen));
+  }
+}
+
+// Fills the tensor with random values, which are small non-negative
+// integers for the integer types so that they are valid indices of the
+// other inputs as well.
+void FillRandom(
+    TensorProto::DataType dtype,
+    const std::vector<TIndex>& dims,
+    Tensor* tensor,
+    std::mt19937* gen) {
+  tensor->Resize(dims);
+  std::uniform_real_distribution<double> real(-1, 1);
+  std::uniform_int_distribution<int> integer(0, 9);
+  switch (dtype) {
+    case TensorProto_DataType_FLOAT:
+      Fill<float>(tensor, real, gen);
+      break;
+    case TensorProto_DataType_DOUBLE:
+      Fill<double>(tensor, real, gen);
+      break;
+    case TensorProto_DataType_INT32:
+      Fill<int>(tensor, integer, gen);
+      break;
+    case TensorProto_DataType_INT64:
+      Fill<int64_t>(tensor, integer, gen);
+      break;
+    case TensorProto_DataType_UINT8:
+      Fill<uint8_t>(tensor, integer, gen);
+      break;
+    default:
+      CAFFE_THROW("Unsupported data type ", dtype);
+  }
+}
+
+OperatorDef MakeOperatorDef(
+    const std::string& name,
+    DeviceType device,
+    int num_inputs) {
+  OperatorDef def;
+  if (name.compare(0, kATenPrefix.size(), kATenPrefix) == 0) {
+    def.set_type("ATen");
+    AddArgument<std::string>("operator", name.substr(kATenPrefix.size()), &def);
+  } else {
+    def.set_type(name);
+  }
+  def.set_engine(FLAGS_engine);
+  def.mutable_device_option()->set_device_type(device);
+  for (int i = 0; i < num_inputs; ++i) {
+    def.add_input(MakeString("X", i));
+  }
+  int num_outputs = 1;
+  const auto* schema = OpSchemaRegistry::Schema(def.type());
+  if (schema) {
+    num_outputs = schema->CalculateOutput(num_inputs);
+    if (num_outputs == kCannotComputeNumOutputs) {
+      num_outputs = std::max(schema->min_output(), 1);
+    }
+  }
+  for (int i = 0; i < num_outputs; ++i) {
+    def.add_output(MakeString("Y", i));
+  }
+  return def;
+}
+
+bool AcceptsInputs(const std::string& name, int num_inputs) {
+  const auto* schema = OpSchemaRegistry::Schema(name);
+  return !schema ||
+      (schema->min_input() <= num_inputs && num_inputs <= schema->max_input());
+}
+
+// Runs the operator on random inputs, and returns false when it cannot run
+// them.
+bool Benchmark(
+    const std::string& name,
+    DeviceType device,
+    TensorProto::DataType dtype,
+    const std::vector<std::vector<TIndex>>& shapes,
+    CountingCPUAllocator* allocator,
+    Result* result) {
+  if (name.compare(0, kATenPrefix.size(), kATenPrefix) != 0 &&
+      !AcceptsInputs(name, shapes.size())) {
+    return false;
+  }
+  const auto def = MakeOperatorDef(name, device, shapes.size());
+  Workspace ws;
+  std::mt19937 gen(0);
+  Tensor cpu(CPU);
+  for (size_t i = 0; i < shapes.size(); ++i) {
+    FillRandom(dtype, shapes[i], &cpu, &gen);
+    ws.CreateBlob(def.input(i))->GetMutableTensor(device)->CopyFrom(cpu);
+  }
+
+  std::unique_ptr<OperatorBase> op;
+  try {
+    op = CreateOperator(def, &ws);
+    for (int i = 0; i < std::max(FLAGS_warmup, 1); ++i) {
+      if (!op->Run()) {
+        return false;
+      }
+    }
+  } catch (const std::exception& e) {
+    VLOG(1) << "Skipping " << name << ": " << e.what();
+    return false;
+  }
+
+  std::vector<TensorShape> input_shapes;
+  uint64_t bytes = 0;
+  for (const auto& input : def.input()) {
+    input_shapes.push_back(GetTensorShapeOfBlob(ws.GetBlob(input)));
+    bytes += ws.GetBlob(input)->Get<Tensor>().nbytes();
+  }
+  for (const auto& output : def.output()) {
+    const auto* blob = ws.GetBlob(output);
+    if (blob->IsType<Tensor>()) {
+      bytes += blob->Get<Tensor>().nbytes();
+    }
+  }
+  result->flops = 0;
+  result->bytes = bytes;
+  const auto* schema = OpSchemaRegistry::Schema(def.type());
+  if (schema && schema->HasCostInferenceFunction()) {
+    try {
+      const auto cost = schema->InferCost(def, input_shapes);
+      result->flops = cost.flops;
+      result->bytes = cost.bytes_read + cost.bytes_written;
+    } catch (const std::exception& e) {
+      VLOG(1) << "No cost for " << name << ": " << e.what();
+    }
+  }
+
+  std::vector<float> times;
+  allocator->Reset();
+  for (int i = 0; i < FLAGS_iter; ++i) {
+    Timer timer;
+    CAFFE_ENFORCE(op->Run(), "Failed to run ", name);
+    times.push_back(timer.MilliSeconds());
+  }
+  result->allocations = static_cast<double>(allocator->allocations()) /
+      std::max(FLAGS_iter, 1);
+  result->allocated_bytes =
+      static_cast<double>(allocator->bytes()) / std::max(FLAGS_iter, 1);
+  result->mean_ms = 0;
+  for (auto t : times) {
+    result->mean_ms += t / times.size();
+  }
+  result->min_ms =
+      times.empty() ? 0 : *std::min_element(times.begin(), times.end());
+  result->max_ms =
+      times.empty() ? 0 : *std::max_element(times.begin(), times.end());
+  return true;
+}
+
+void WriteJson(const std::vector<Result>& results, std::ostream& out) {
+  out << "[\n";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const auto& r = results[i];
+    const double gflops = r.mean_ms > 0 ? r.flops / (r.mean_ms * 1e6) : 0;
+    const double gbps = r.mean_ms > 0 ? r.bytes / (r.mean_ms * 1e6) : 0;
+    out << "  {\"operator\": \"" << r.op << "\", \"device\": \"" << r.device
+        << "\", \"dtype\": \"" << r.dtype << "\", \"shapes\": [";
+    for (size_t j = 0; j < r.shapes.size(); ++j) {
+      out << (j ? ", [" : "[");
+      for (size_t k = 0; k < r.shapes[j].size(); ++k) {
+        out << (k ? ", " : "") << r.shapes[j][k];
+      }
+      out << "]";
+    }
+    out << "], \"mean_ms\": " << r.mean_ms << ", \"min_ms\": " << r.min_ms
+        << ", \"max_ms\": " << r.max_ms << ", \"flops\": " << r.flops
+        << ", \"bytes\": " << r.bytes << ", \"gflops\": " << gflops
+        << ", \"gbps\": " << gbps;
+    if (FLAGS_peak_gflops > 0) {
+      out << ", \"gflops_fraction_of_peak\": " << gflops / FLAGS_peak_gflops;
+    }
+    if (FLAGS_peak_gbps > 0) {
+      out << ", \"gbps_fraction_of_peak\": " << gbps / FLAGS_peak_gbps;
+    }
+    out << ", \"allocations_per_iter\": " << r.allocations
+        << ", \"allocated_bytes_per_iter\": " << r.allocated_bytes << "}"
+        << (i + 1 < results.size() ? ",\n" : "\n");
+  }
+  out << "]\n";
+}
+
+} // namespace
+} // namespace caffe2
+
+int main(int argc, char** argv) {
+  caffe2::GlobalInit(&argc, &argv);
+  using namespace caffe2;
+
+  // The allocator is owned by the CPU allocator registry from here on.
+  auto* allocator = new CountingCPUAllocator();
+  SetCPUAllocator(allocator);
+
+  std::vector<std::vector<std::vector<TIndex>>> points;
+  for (const auto& point : split(';', FLAGS_shapes)) {
+    std::vector<std::vector<TIndex>> shapes;
+    for (const auto& shape : split(',', point)) {
+      shapes.push_back(ParseShape(shape));
+    }
+    points.push_back(shapes);
+  }
+
+  std::vector<Result> results;
+  for (const auto& device_name : split(',', FLAGS_devices)) {
+    const auto device = ParseDevice(device_name);
+    if (!gDeviceTypeRegistry()->count(device)) {
+      LOG(ERROR) << "No operators registered for device " << device_name;
+      continue;
+    }
+    std::vector<std::string> operators = split(',', FLAGS_operators);
+    if (FLAGS_operators == "all") {
+      operators.clear();
+      for (const auto& key : gDeviceTypeRegistry()->at(device)->Keys()) {
+        // Keys of engines are <operator>_ENGINE_<engine>.
+        if (key.find("_ENGINE_") == std::string::npos) {
+          operators.push_back(key);
+        }
+      }
+    }
+    for (const auto& name : operators) {
+      for (const auto& dtype_name : split(',', FLAGS_dtypes)) {
+        const auto dtype = ParseDataType(dtype_name);
+        for (const auto& shapes : points) {
+          Result result;
+          if (!Benchmark(name, device, dtype, shapes, allocator, &result)) {
+            continue;
+          }
+          result.op = name;
+          result.device = device_name;
+          result.dtype = dtype_name;
+          result.shapes = shapes;
+          LOG(INFO) << name << " on " << device_name << " " << dtype_name
+                    << ": " << result.mean_ms << " ms";
+          results.push_back(result);
+        }
+      }
+    }
+  }
+
+  if (FLAGS_json.empty()) {
+    WriteJson(results, std::cout);
+  } else {
+    std::ofstream out(FLAGS_json);
+    CAFFE_ENFORCE(out, "Cannot open ", FLAGS_json);
+    WriteJson(results, out);
+  }
+  return 0;
+}
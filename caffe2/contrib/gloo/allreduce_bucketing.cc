@@ -0,0 +1,212 @@
+#include "caffe2/contrib/gloo/allreduce_bucketing.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "caffe2/core/operator.h"
+#include "caffe2/core/types.h"
+#include "caffe2/opt/converter.h"
+#include "caffe2/opt/passes.h"
+#include "caffe2/utils/proto_utils.h"
+
+namespace caffe2 {
+namespace gloo {
+
+using namespace nom;
+
+namespace {
+
+using NodeRef = repr::NNGraph::NodeRef;
+
+const OperatorDef* getOpDef(NodeRef node) {
+  if (!repr::nn::is<repr::NeuralNetOperator>(node)) {
+    return nullptr;
+  }
+  auto* annotation =
+      repr::nn::get<repr::NeuralNetOperator>(node)->getAnnotation();
+  if (!annotation || !isa<Caffe2Annotation>(annotation)) {
+    return nullptr;
+  }
+  return &dyn_cast<Caffe2Annotation>(annotation)->getOperatorDef();
+}
+
+const std::string& getName(NodeRef tensor) {
+  return repr::nn::get<repr::NeuralNetData>(tensor)->getName();
+}
+
+bool isBucketable(const OperatorDef& op) {
+  return op.type() == "Allreduce" && op.engine() == "GLOO" &&
+      op.input_size() == 2 && op.output_size() == 1 &&
+      op.device_option().device_type() == CPU &&
+      op.control_input_size() == 0;
+}
+
+struct Bucket {
+  // Identifies the operators that can share a bucket: they only differ in
+  // their tensor.
+  std::string key;
+  std::vector<NodeRef> ops;
+  std::unordered_set<std::string> tensors;
+  size_t bytes = 0;
+};
+
+bool touches(NodeRef node, const Bucket& bucket) {
+  for (auto tensor : repr::nn::getInputs(node)) {
+    if (bucket.tensors.count(getName(tensor))) {
+      return true;
+    }
+  }
+  for (auto tensor : repr::nn::getOutputs(node)) {
+    if (bucket.tensors.count(getName(tensor))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Replaces the Allreduce operators of the bucket with a BucketedAllreduce at
+// the position of the last one.
+void fuseBucket(repr::NNModule* nn, const Bucket& bucket, bool sharded) {
+  if (bucket.ops.size() < 2) {
+    return;
+  }
+  const auto last = bucket.ops.back();
+  const auto commonWorld = repr::nn::getInputs(last).front();
+  std::vector<NodeRef> inputs;
+  std::vector<NodeRef> outputs;
+  for (auto op : bucket.ops) {
+    inputs.push_back(repr::nn::getInputs(op).back());
+    outputs.push_back(repr::nn::getOutputs(op).front());
+  }
+
+  OperatorDef fused = *getOpDef(last);
+  fused.set_type("BucketedAllreduce");
+  fused.clear_input();
+  fused.clear_output();
+  if (sharded) {
+    AddArgument<bool>("sharded", true, &fused);
+  }
+
+  for (auto op : bucket.ops) {
+    const auto inEdges = op->getInEdges();
+    for (auto edge : inEdges) {
+      nn->dataFlow.deleteEdge(edge);
+    }
+    const auto outEdges = op->getOutEdges();
+    for (auto edge : outEdges) {
+      nn->dataFlow.deleteEdge(edge);
+    }
+    if (op != last) {
+      nn->dataFlow.deleteNode(op);
+    }
+  }
+  last->resetData(convertToNeuralNetOperator(fused));
+  nn->dataFlow.createEdge(commonWorld, last);
+  for (auto input : inputs) {
+    nn->dataFlow.createEdge(input, last);
+  }
+  for (auto output : outputs) {
+    nn->dataFlow.createEdge(last, output);
+  }
+}
+
+} // namespace
+
+void bucketAllreduce(
+    repr::NNModule* nn,
+    Workspace* ws,
+    const AllreduceBucketingOptions& options) {
+  CAFFE_ENFORCE(ws, "Allreduce bucketing needs the workspace of the net");
+  auto net = convertToCaffe2Proto(*nn);
+  const auto shapes = InferBlobShapesAndTypesFromWorkspace(ws, {&net});
+  std::unordered_map<std::string, const TensorShape*> shapeOf;
+  for (const auto& shape : shapes.shapes()) {
+    if (!shape.unknown_shape()) {
+      shapeOf[shape.name()] = &shape;
+    }
+  }
+
+  std::vector<NodeRef> instrs;
+  for (auto bbNode : nn->controlFlow.getMutableNodes()) {
+    auto bb = bbNode->mutableData()->get();
+    const auto& bbInstrs = bb->getInstructions();
+    instrs.insert(instrs.end(), bbInstrs.begin(), bbInstrs.end());
+  }
+
+  // The open buckets, in the order they were started, which is the same on
+  // every node.
+  std::vector<Bucket> buckets;
+  for (auto instr : instrs) {
+    // An operator using a tensor of a bucket must see it allreduced.
+    for (auto it = buckets.begin(); it != buckets.end();) {
+      if (touches(instr, *it)) {
+        fuseBucket(nn, *it, options.sharded);
+        it = buckets.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    const auto* def = getOpDef(instr);
+    if (!def || !isBucketable(*def)) {
+      continue;
+    }
+    const auto& name = getName(repr::nn::getInputs(instr).back());
+    const auto shape = shapeOf.find(name);
+    if (shape == shapeOf.end() ||
+        (shape->second->data_type() != TensorProto_DataType_FLOAT &&
+         shape->second->data_type() != TensorProto_DataType_FLOAT16)) {
+      continue;
+    }
+    size_t bytes = DataTypeToTypeMeta(shape->second->data_type()).itemsize();
+    for (auto dim : shape->second->dims()) {
+      bytes *= dim;
+    }
+
+    OperatorDef keyDef = *def;
+    keyDef.clear_input();
+    keyDef.clear_output();
+    keyDef.clear_name();
+    keyDef.add_input(def->input(0));
+    const auto key = keyDef.SerializeAsString() + "/" +
+        caffe2::to_string(shape->second->data_type());
+    auto bucket = std::find_if(
+        buckets.begin(), buckets.end(), [&](const Bucket& b) {
+          return b.key == key;
+        });
+    if (bucket != buckets.end() &&
+        bucket->bytes + bytes > options.max_bucket_bytes) {
+      fuseBucket(nn, *bucket, options.sharded);
+      buckets.erase(bucket);
+      bucket = buckets.end();
+    }
+    if (bucket == buckets.end()) {
+      buckets.emplace_back();
+      bucket = buckets.end() - 1;
+      bucket->key = key;
+    }
+    bucket->ops.push_back(instr);
+    bucket->tensors.insert(name);
+    bucket->bytes += bytes;
+  }
+  for (const auto& bucket : buckets) {
+    fuseBucket(nn, bucket, options.sharded);
+  }
+}
+
+namespace {
+
+void bucketAllreduceSharded(repr::NNModule* nn, Workspace* ws) {
+  AllreduceBucketingOptions options;
+  options.sharded = true;
+  bucketAllreduce(nn, ws, options);
+}
+
+} // namespace
+
+REGISTER_WS_OPT_PASS_FROM_FUNC(BucketAllreduce, bucketAllreduce);
+REGISTER_WS_OPT_PASS_FROM_FUNC(BucketAllreduceSharded, bucketAllreduceSharded);
+
+} // namespace gloo
+} // namespace caffe2
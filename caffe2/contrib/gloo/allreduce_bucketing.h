@@ -0,0 +1,31 @@
+#pragma once
+
+#include "caffe2/core/workspace.h"
+#include "nomnigraph/Representations/NeuralNet.h"
+
+namespace caffe2 {
+namespace gloo {
+
+struct CAFFE2_API AllreduceBucketingOptions {
+  // Upper bound on the size of the tensors allreduced by one operator. A
+  // larger tensor is allreduced alone.
+  size_t max_bucket_bytes = 25 << 20;
+  // Whether the buckets are reduce-scattered and then allgathered.
+  bool sharded = false;
+};
+
+// Replaces the CPU Allreduce operators of the Gloo engine that allreduce a
+// single tensor with BucketedAllreduce operators, each over consecutive
+// tensors of the same common world and data type, up to the bucket size.
+// A bucket runs at the position of its last Allreduce, so in an async net
+// it starts as soon as the producers of its tensors finish, and is closed
+// before any operator that reads or writes one of its tensors. The sizes
+// of the tensors are inferred from the shapes of the blobs in `ws`; an
+// Allreduce of unknown size is left alone.
+CAFFE2_API void bucketAllreduce(
+    nom::repr::NNModule* nn,
+    Workspace* ws,
+    const AllreduceBucketingOptions& options = AllreduceBucketingOptions());
+
+} // namespace gloo
+} // namespace caffe2
@@ -0,0 +1,41 @@
+#include "bucketed_allreduce_ops.h"
+
+#include <gloo/allgather_ring.h>
+#include <gloo/allreduce_halving_doubling.h>
+#include <gloo/reduce_scatter.h>
+#include <gloo/types.h>
+
+namespace caffe2 {
+namespace gloo {
+
+// The sharded variant runs the algorithms of ReduceScatterOp and AllgatherOp
+// on the buffer.
+template <class Context>
+template <typename T>
+void BucketedAllreduceOp<Context>::initializeAlgorithms() {
+  auto* buffer = static_cast<T*>(buffer_.raw_mutable_data());
+  if (!sharded_) {
+    algorithms_.emplace_back(new ::gloo::AllreduceHalvingDoubling<T>(
+        init_.context, std::vector<T*>{buffer}, buffer_.size()));
+    return;
+  }
+  std::vector<int> recvCounts(init_.context->size, shard_.size());
+  algorithms_.emplace_back(new ::gloo::ReduceScatterHalvingDoubling<T>(
+      init_.context, std::vector<T*>{buffer}, buffer_.size(), recvCounts));
+  algorithms_.emplace_back(new ::gloo::AllgatherRing<T>(
+      init_.context,
+      std::vector<const T*>{static_cast<const T*>(shard_.raw_data())},
+      buffer,
+      shard_.size()));
+}
+
+namespace {
+
+REGISTER_CPU_OPERATOR_WITH_ENGINE(
+    BucketedAllreduce,
+    GLOO,
+    BucketedAllreduceOp<CPUContext>);
+
+} // namespace
+} // namespace gloo
+} // namespace caffe2
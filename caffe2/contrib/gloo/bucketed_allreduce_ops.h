@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+
+#include "caffe2/contrib/gloo/common.h"
+#include "caffe2/core/operator.h"
+
+#include <gloo/algorithm.h>
+#include <gloo/common/error.h>
+#include <gloo/context.h>
+
+namespace caffe2 {
+namespace gloo {
+
+// Allreduces tensors of any size with a single Gloo algorithm, by packing
+// them into one buffer. Unlike AllreduceOp, whose inputs are copies of the
+// same tensor, the inputs are different tensors of the same type.
+template <class Context>
+class BucketedAllreduceOp final : public Operator<Context> {
+ public:
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+
+  BucketedAllreduceOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<Context>(operator_def, ws),
+        ws_(ws),
+        status_blob_(
+            OperatorBase::GetSingleArgument<std::string>("status_blob", "")),
+        sharded_(OperatorBase::GetSingleArgument<bool>("sharded", false)) {
+    if (status_blob_ != "") {
+      ws_->CreateBlob(status_blob_);
+    }
+  }
+
+  virtual ~BucketedAllreduceOp() {}
+
+  bool RunOnDevice() override {
+    std::call_once(once_, [&] { initialize(); });
+
+    // If any parameter has changed in between runs, the initialized
+    // algorithm is invalid and cannot be used.
+    update(current_);
+    CAFFE_ENFORCE(current_ == init_, "Inputs/outputs have changed");
+
+    auto* buffer = static_cast<char*>(buffer_.raw_mutable_data());
+    for (auto i = 1; i < InputSize(); i++) {
+      context_.CopyBytesSameDevice(
+          Input(i).nbytes(), Input(i).raw_data(), buffer);
+      buffer += Input(i).nbytes();
+    }
+
+    try {
+      if (sharded_) {
+        // Each node gets the sum of its part of the buffer at the start of
+        // the buffer, and then sends it to all the others.
+        algorithms_[0]->run();
+        context_.CopyBytesSameDevice(
+            shard_.nbytes(), buffer_.raw_data(), shard_.raw_mutable_data());
+        algorithms_[1]->run();
+      } else {
+        algorithms_[0]->run();
+      }
+    } catch (::gloo::IoException& ioe) {
+      LOG(ERROR) << "Caught gloo IO exception: " << ioe.what();
+      if (status_blob_ != "") {
+        signalFailure(ws_->GetBlob(status_blob_), ioe);
+        return false;
+      } else {
+        throw;
+      }
+    }
+
+    buffer = static_cast<char*>(buffer_.raw_mutable_data());
+    for (auto i = 0; i < OutputSize(); i++) {
+      context_.CopyBytesSameDevice(
+          Output(i)->nbytes(), buffer, Output(i)->raw_mutable_data());
+      buffer += Output(i)->nbytes();
+    }
+    return true;
+  }
+
+ protected:
+  void initialize() {
+    // Store which inputs/outputs this instance initialized with
+    update(init_);
+
+    // Verify inputs == ouputs
+    CAFFE_ENFORCE_EQ(init_.inputs.size(), init_.outputs.size());
+    for (auto i = 0; i < init_.inputs.size(); i++) {
+      CAFFE_ENFORCE_EQ(init_.inputs[i], init_.outputs[i]);
+    }
+
+    // Verify tensors all have same type
+    for (auto i = 2; i < InputSize(); i++) {
+      CAFFE_ENFORCE(Input(i).meta() == init_.meta);
+    }
+
+    // When sharded, the buffer is padded to split evenly between the nodes.
+    // The padding is reduced along, and never read.
+    size_t size = init_.size;
+    if (sharded_) {
+      const size_t nodes = init_.context->size;
+      const size_t chunk = (size + nodes - 1) / nodes;
+      size = chunk * nodes;
+      shard_.Resize(chunk);
+      shard_.raw_mutable_data(init_.meta);
+    }
+    buffer_.Resize(size);
+    buffer_.raw_mutable_data(init_.meta);
+
+    if (init_.template IsType<float>()) {
+      initializeAlgorithms<float>();
+    } else if (init_.template IsType<::caffe2::float16>()) {
+      initializeAlgorithms<::gloo::float16>();
+    } else {
+      CAFFE_ENFORCE(false, "Unhandled type: ", init_.meta.name());
+    }
+  }
+
+  template <typename T>
+  void initializeAlgorithms();
+
+  std::once_flag once_;
+  std::vector<std::unique_ptr<::gloo::Algorithm>> algorithms_;
+
+  // Captures the parameters passed to Gloo when first initialized.
+  // An instance is updated every time this op runs and is compared
+  // to the reference instance for equality. If any parameter has
+  // changed from run to run, the initialized algorithm is invalid.
+  // The size is the total number of elements of the tensors.
+  void update(GlooParameters& params) {
+    params.context = OperatorBase::Input<std::shared_ptr<::gloo::Context>>(0);
+    params.inputs.resize(InputSize() - 1);
+    params.outputs.resize(OutputSize());
+    params.size = 0;
+    for (auto i = 0; i < params.inputs.size(); i++) {
+      params.inputs[i] = Input(i + 1).template raw_data();
+      params.outputs[i] = Output(i)->template raw_mutable_data();
+      params.size += Output(i)->size();
+    }
+    params.meta = Output(0)->meta();
+  }
+
+  GlooParameters init_;
+  GlooParameters current_;
+  Workspace* ws_;
+  std::string status_blob_;
+  const bool sharded_;
+  Tensor buffer_{Context::GetDeviceType()};
+  Tensor shard_{Context::GetDeviceType()};
+};
+
+} // namespace gloo
+} // namespace caffe2
@@ -16,6 +16,7 @@ import tempfile
 import shutil
 
 from caffe2.python import core, workspace, dyndep
+from caffe2.python.transformations import Transformer
 import caffe2.python.hypothesis_test_util as hu
 from gloo.python import IoError
 
@@ -347,6 +348,85 @@ class TestCase(hu.HypothesisTestCase):
                     tmpdir=tmpdir,
                     use_float16=use_float16)
 
+    def _test_bucket_allreduce(self,
+                               comm_rank=None,
+                               comm_size=None,
+                               blob_size=None,
+                               sharded=False,
+                               tmpdir=None
+                               ):
+        store_handler, common_world = self.create_common_world(
+            comm_rank=comm_rank,
+            comm_size=comm_size,
+            tmpdir=tmpdir)
+
+        blob_size = self.synchronize(
+            store_handler,
+            blob_size,
+            comm_rank=comm_rank)
+
+        # Tensors of different sizes, so that the buckets are padded when
+        # sharded.
+        num_blobs = 4
+        blobs = []
+        for i in range(num_blobs):
+            blob = "blob_{}".format(i)
+            value = np.full(blob_size + i, (comm_rank * num_blobs) + i,
+                            np.float32)
+            workspace.FeedBlob(blob, value)
+            blobs.append(blob)
+
+        # The Scale reads blob_0, which closes the first bucket.
+        net = core.Net("bucket_allreduce")
+        net.Allreduce([common_world, blobs[0]], [blobs[0]], engine=op_engine)
+        net.Allreduce([common_world, blobs[1]], [blobs[1]], engine=op_engine)
+        net.Scale([blobs[0]], ["scaled"], scale=2.0)
+        net.Allreduce([common_world, blobs[2]], [blobs[2]], engine=op_engine)
+        net.Allreduce([common_world, blobs[3]], [blobs[3]], engine=op_engine)
+        if sharded:
+            Transformer().BucketAllreduceSharded(net)
+        else:
+            Transformer().BucketAllreduce(net)
+        self.assertEqual(
+            [op.type for op in net.Proto().op],
+            ["BucketedAllreduce", "Scale", "BucketedAllreduce"])
+
+        workspace.CreateNet(net)
+        workspace.RunNet(net.Name())
+
+        for i in range(num_blobs):
+            np.testing.assert_array_equal(
+                workspace.FetchBlob(blobs[i]),
+                np.full(blob_size + i,
+                        num_blobs * comm_size * (comm_size - 1) / 2 +
+                        comm_size * i,
+                        np.float32))
+        np.testing.assert_array_equal(
+            workspace.FetchBlob("scaled"), 2 * workspace.FetchBlob(blobs[0]))
+
+    @given(comm_size=st.integers(min_value=2, max_value=8),
+           blob_size=st.integers(min_value=1e3, max_value=1e5),
+           sharded=st.booleans(),
+           device_option=st.sampled_from([hu.cpu_do]))
+    def test_bucket_allreduce(self, comm_size, blob_size, sharded,
+                              device_option):
+        TestCase.test_counter += 1
+        if os.getenv('COMM_RANK') is not None:
+            self.run_test_distributed(
+                self._test_bucket_allreduce,
+                blob_size=blob_size,
+                sharded=sharded,
+                device_option=device_option)
+        else:
+            with TemporaryDirectory() as tmpdir:
+                self.run_test_locally(
+                    self._test_bucket_allreduce,
+                    comm_size=comm_size,
+                    blob_size=blob_size,
+                    sharded=sharded,
+                    device_option=device_option,
+                    tmpdir=tmpdir)
+
     def _test_reduce_scatter(self,
                              comm_rank=None,
                              comm_size=None,
@@ -11,6 +11,15 @@ void StoreHandlerWrapper::set(
 }
 
 std::vector<char> StoreHandlerWrapper::get(const std::string& key) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = prefetched_.find(key);
+    if (it != prefetched_.end()) {
+      std::vector<char> data(it->second.begin(), it->second.end());
+      prefetched_.erase(it);
+      return data;
+    }
+  }
   std::string str = handler_.get(key);
   return std::vector<char>(str.begin(), str.end());
 }
@@ -19,6 +28,11 @@ void StoreHandlerWrapper::wait(
     const std::vector<std::string>& keys,
     const std::chrono::milliseconds& timeout) {
   handler_.wait(keys, timeout);
+  auto values = handler_.multiGet(keys);
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t i = 0; i < keys.size(); i++) {
+    prefetched_[keys[i]] = std::move(values[i]);
+  }
 }
 
 } // namespace gloo
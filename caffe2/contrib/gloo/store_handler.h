@@ -5,6 +5,9 @@
 
 #include <gloo/rendezvous/store.h>
 
+#include <mutex>
+#include <unordered_map>
+
 namespace caffe2 {
 namespace gloo {
 
@@ -29,6 +32,12 @@ class CAFFE2_API StoreHandlerWrapper : public ::gloo::rendezvous::Store {
 
  protected:
   StoreHandler& handler_;
+
+  // Gloo waits for the keys of its peers and then gets them one at a time.
+  // The values are read in one batch when waiting, and kept here until the
+  // matching get.
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::string> prefetched_;
 };
 
 } // namespace gloo
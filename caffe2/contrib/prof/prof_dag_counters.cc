@@ -0,0 +1,126 @@
+#include "prof_dag_counters.h"
+
+#include <cmath>
+#include <iomanip>
+
+namespace caffe2 {
+
+ProfDAGCounters::ProfDAGCounters(
+    const std::string& net_name,
+    const std::vector<OperatorBase*>& operators)
+    : net_name_(net_name),
+      time_per_op_run_(operators.size()),
+      time_per_op_total_(operators.size(), Stats{0, 0, 0}) {
+  for (const auto* op : operators) {
+    op_types_.push_back(op->type());
+    if (op->has_debug_def() && op->debug_def().name().size()) {
+      op_print_names_.push_back(op->debug_def().name());
+    } else if (op->has_debug_def() && op->OutputSize()) {
+      op_print_names_.push_back(op->debug_def().output(0));
+    } else {
+      op_print_names_.push_back("NO_OUTPUT");
+    }
+  }
+}
+
+void ProfDAGCounters::ReportRunStart() {
+  runs_++;
+  std::fill(time_per_op_run_.begin(), time_per_op_run_.end(), 0.0f);
+}
+
+void ProfDAGCounters::AddPerOpTime(size_t op_id, float time_ms) {
+  // don't collect metrics from first run
+  if (runs_ <= 1) {
+    return;
+  }
+  CAFFE_ENFORCE(
+      time_per_op_run_.size() > op_id,
+      "Expecting ",
+      time_per_op_run_.size(),
+      " ops, but op #",
+      op_id,
+      " was given.");
+  time_per_op_run_[op_id] += time_ms;
+}
+
+void ProfDAGCounters::ReportRunEnd() {
+  if (runs_ <= 1) {
+    return;
+  }
+
+  // Aggregate this run's stats per operator type
+  CaffeMap<string, float> time_per_op_type_run;
+  for (size_t idx = 0; idx < time_per_op_run_.size(); idx++) {
+    const float spent = time_per_op_run_[idx];
+    time_per_op_total_[idx].sum += spent;
+    time_per_op_total_[idx].sqrsum += spent * spent;
+    time_per_op_type_run[op_types_[idx]] += spent;
+    time_per_op_type_total_[op_types_[idx]].cnt += 1;
+  }
+
+  for (const auto& item : time_per_op_type_run) {
+    time_per_op_type_total_[item.first].sum += item.second;
+    time_per_op_type_total_[item.first].sqrsum += item.second * item.second;
+  }
+}
+
+ProfDAGProto ProfDAGCounters::ProtoMsg(
+    std::pair<std::string, Stats> op_stat) const {
+  ProfDAGProto message;
+  float mean = op_stat.second.sum / (runs_ - 1);
+  float stddev = std::sqrt(op_stat.second.sqrsum / (runs_ - 1) - mean * mean);
+  message.set_mean(mean);
+  message.set_stddev(stddev);
+  message.set_name(op_stat.first);
+  return message;
+}
+
+ProfDAGProtos ProfDAGCounters::GetOperatorStats() const {
+  ProfDAGProtos prof_dag_protos;
+  for (auto& item : time_per_op_type_total_) {
+    auto buf = prof_dag_protos.add_stats();
+    buf->CopyFrom(ProtoMsg(item));
+  }
+  return prof_dag_protos;
+}
+
+ProfDAGProtos ProfDAGCounters::GetPerOperatorCost() const {
+  ProfDAGProtos prof_dag_protos;
+  for (size_t idx = 0; idx < time_per_op_total_.size(); idx++) {
+    auto buf = prof_dag_protos.add_stats();
+    std::string op_output_name =
+        net_name_ + "___" + to_string(idx) + "___" + op_types_[idx];
+    std::pair<std::string, Stats> op_stat =
+        std::pair<std::string, Stats>(op_output_name, time_per_op_total_[idx]);
+    buf->CopyFrom(ProtoMsg(op_stat));
+  }
+  return prof_dag_protos;
+}
+
+void ProfDAGCounters::PrintStats() const {
+  CAFFE_ENFORCE(runs_ > 1, "# of runs: ", runs_, ", expected > 1.");
+  int measured_runs = runs_ - 1;
+
+  LOG(INFO) << "Measured operators over " << measured_runs << " net runs.";
+
+  for (size_t idx = 0; idx < time_per_op_total_.size(); idx++) {
+    float mean = time_per_op_total_[idx].sum / measured_runs;
+    float stddev =
+        std::sqrt(time_per_op_total_[idx].sqrsum / measured_runs - mean * mean);
+    VLOG(1) << "Op #" << idx << " (" << op_print_names_[idx] << ", "
+            << op_types_[idx] << ") " << mean << " ms/run (" << stddev
+            << " ms/run)";
+  }
+
+  LOG(INFO) << "Mean time in operator per run (stddev):";
+  for (const auto& item : time_per_op_type_total_) {
+    float mean = item.second.sum / measured_runs;
+    float stddev = std::sqrt(item.second.sqrsum / measured_runs - mean * mean);
+    LOG(INFO) << std::setw(10) << std::setfill(' ') << mean << " ms/run ("
+              << std::setw(10) << std::setfill(' ') << stddev << " ms/run) "
+              << " Op count per run: " << (item.second.cnt / measured_runs)
+              << "  " << item.first;
+  }
+}
+
+} // namespace caffe2
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "caffe2/core/common.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/proto/prof_dag.pb.h"
+
+namespace caffe2 {
+
+struct Stats {
+  float sum;
+  float sqrsum;
+  size_t cnt;
+};
+
+/**
+ * Per operator and per operator type time statistics of the runs of a net,
+ * shared by ProfDAGNet and ProfDAGObserver.
+ *
+ * To collect statistics from stable runs, the first run is ignored.
+ */
+class ProfDAGCounters {
+ public:
+  ProfDAGCounters(
+      const std::string& net_name,
+      const std::vector<OperatorBase*>& operators);
+
+  void ReportRunStart();
+  // Adds to the time of operator `op_id` in the current run
+  void AddPerOpTime(size_t op_id, float time_ms);
+  void ReportRunEnd();
+
+  int runs() const {
+    return runs_;
+  }
+
+  ProfDAGProtos GetOperatorStats() const;
+
+  // GetPerOperatorCost collects the execution time of each operator, the
+  // output is formatted as a map: (netName__opIndex__opType, cost)
+  ProfDAGProtos GetPerOperatorCost() const;
+
+  void PrintStats() const;
+
+ private:
+  ProfDAGProto ProtoMsg(std::pair<std::string, Stats> op_stat) const;
+
+  std::string net_name_;
+  std::vector<std::string> op_types_;
+  std::vector<std::string> op_print_names_;
+  // Time spent per operator instance in the current run.
+  std::vector<float> time_per_op_run_;
+  // Cumulative sum and sum squared time spent per operator instance in net.
+  std::vector<Stats> time_per_op_total_;
+  // Cumulative sum and sum squared time spent per unique operator type.
+  CaffeMap<std::string, Stats> time_per_op_type_total_;
+  int runs_ = 0;
+};
+
+} // namespace caffe2
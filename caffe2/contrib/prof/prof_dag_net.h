@@ -1,22 +1,20 @@
 #pragma once
 
+#include "caffe2/contrib/prof/prof_dag_counters.h"
 #include "caffe2/core/net_dag.h"
 #include "caffe2/proto/prof_dag.pb.h"
 
 namespace caffe2 {
 
-struct Stats {
-  float sum;
-  float sqrsum;
-  size_t cnt;
-};
-
 /**
  * This net type is identical to DAGNet, except that it
  * measures the time taken for each and every operator.
  *
  * To collect statistics from stable runs, this net ignores the first run.
  * Thus, at least two runs are required for this net to print operator metrics.
+ *
+ * The timing is synchronous and the net has its own scheduling, prefer
+ * attaching a ProfDAGObserver (prof_dag_observer.h) to async_scheduling nets.
  */
 class ProfDAGNet : public DAGNetBase {
  public:
@@ -34,14 +32,8 @@ class ProfDAGNet : public DAGNetBase {
  protected:
   bool DoRunAsync() override;
   bool RunAt(int chain_id, const std::vector<int>& chain) override;
-  void PrintStats();
   void ValidateOpTensorDevices();
-  ProfDAGProto ProtoMsg(std::pair<std::string, Stats> op_stat) const;
-  // Cumulative sum and sum squared time spent per operator instance in net.
-  std::vector<Stats> time_per_op_total_;
-  // Cumulative sum and sum squared time spent per unique operator type.
-  CaffeMap<std::string, Stats> time_per_op_type_total_;
-  int runs_ = 0;
+  ProfDAGCounters counters_;
 };
 
 } // namespace caffe2
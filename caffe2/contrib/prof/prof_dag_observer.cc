@@ -0,0 +1,217 @@
+#include "prof_dag_observer.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace caffe2 {
+
+CAFFE_DEFINE_TYPED_REGISTRY(
+    ProfDAGOpTimerRegistry,
+    int,
+    ProfDAGOpTimer,
+    std::unique_ptr,
+    OperatorBase*);
+
+namespace {
+
+class HostProfDAGOpTimer final : public ProfDAGOpTimer {
+ public:
+  explicit HostProfDAGOpTimer(OperatorBase* /* unused */) {}
+
+  void Start() override {
+    timer_.Start();
+  }
+
+  void Stop() override {
+    elapsed_ = timer_.MilliSeconds();
+  }
+
+  float ElapsedMs() override {
+    return elapsed_;
+  }
+
+ private:
+  Timer timer_;
+  float elapsed_ = 0;
+};
+
+std::mutex& observersMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::unordered_map<const NetBase*, ProfDAGObserver*>& observersByNet() {
+  static std::unordered_map<const NetBase*, ProfDAGObserver*> observers;
+  return observers;
+}
+
+} // namespace
+
+ProfDAGOperatorObserver::ProfDAGOperatorObserver(
+    OperatorBase* subject,
+    ProfDAGObserver* netObserver)
+    : ObserverBase<OperatorBase>(subject), netObserver_(netObserver) {
+  const int device_type = subject->device_option().device_type();
+  if (ProfDAGOpTimerRegistry()->Has(device_type)) {
+    timer_ = ProfDAGOpTimerRegistry()->Create(device_type, subject);
+  } else {
+    timer_ = caffe2::make_unique<HostProfDAGOpTimer>(subject);
+  }
+}
+
+void ProfDAGOperatorObserver::Start() {
+  launch_us_ = netObserver_->CurrentTimestamp();
+  tid_ = std::this_thread::get_id();
+  timer_->Start();
+}
+
+void ProfDAGOperatorObserver::Stop() {
+  timer_->Stop();
+  recorded_run_ = netObserver_->run_id_;
+}
+
+ProfDAGObserver::ProfDAGObserver(NetBase* subject)
+    : OperatorAttachingNetObserver<ProfDAGOperatorObserver, ProfDAGObserver>(
+          subject,
+          this),
+      counters_(subject->Name(), subject->GetOperators()),
+      tracer_(tracing::create(subject, subject->Name())) {
+  for (const auto* op : subject->GetOperators()) {
+    op_trace_names_.push_back(op->type());
+  }
+  std::lock_guard<std::mutex> lock(observersMutex());
+  observersByNet()[subject] = this;
+}
+
+ProfDAGObserver::~ProfDAGObserver() {
+  {
+    std::lock_guard<std::mutex> lock(observersMutex());
+    observersByNet().erase(subject_);
+  }
+  // the operators, and their observers, are destroyed by now
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (counters_.runs() <= 1) {
+    LOG(INFO) << "Insufficient runs to produce meaningful data.";
+    return;
+  }
+  counters_.PrintStats();
+}
+
+ProfDAGObserver* ProfDAGObserver::Find(const NetBase* net) {
+  std::lock_guard<std::mutex> lock(observersMutex());
+  auto it = observersByNet().find(net);
+  return it != observersByNet().end() ? it->second : nullptr;
+}
+
+void ProfDAGObserver::Start() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // the previous run is finished on the host, by now its device work is
+  // usually done as well
+  ResolveRun();
+  ++run_id_;
+  tracing::startIter(tracer_);
+}
+
+void ProfDAGObserver::Stop() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  run_pending_ = true;
+}
+
+ProfDAGProtos ProfDAGObserver::GetOperatorStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ResolveRun();
+  return counters_.GetOperatorStats();
+}
+
+ProfDAGProtos ProfDAGObserver::GetPerOperatorCost() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ResolveRun();
+  return counters_.GetPerOperatorCost();
+}
+
+void ProfDAGObserver::ResolveRun() {
+  if (!run_pending_) {
+    return;
+  }
+  run_pending_ = false;
+
+  // ops that did not run (e.g. in a failed run) are reported with time -1
+  std::vector<float> times(operator_observers_.size(), -1.0f);
+  counters_.ReportRunStart();
+  for (size_t idx = 0; idx < operator_observers_.size(); ++idx) {
+    const auto* observer = operator_observers_[idx];
+    if (observer->recorded_run_ != run_id_) {
+      continue;
+    }
+    times[idx] = observer->timer_->ElapsedMs();
+    counters_.AddPerOpTime(idx, times[idx]);
+  }
+  counters_.ReportRunEnd();
+
+  if (tracer_ && tracer_->isEnabled()) {
+    TraceRun(times);
+  }
+}
+
+void ProfDAGObserver::TraceRun(const std::vector<float>& times) {
+  std::vector<tracing::TracerEvent> events;
+  // Device operators are only timed relative to their own start, they are
+  // placed at their launch time or after the previous operator on the same
+  // stream finishes, whichever is later
+  std::vector<size_t> op_ids;
+  for (size_t idx = 0; idx < times.size(); ++idx) {
+    if (times[idx] >= 0) {
+      op_ids.push_back(idx);
+    }
+  }
+  std::sort(op_ids.begin(), op_ids.end(), [this](size_t a, size_t b) {
+    return operator_observers_[a]->launch_us_ <
+        operator_observers_[b]->launch_us_;
+  });
+
+  std::unordered_map<int, long> stream_end_us;
+  for (auto idx : op_ids) {
+    const auto* observer = operator_observers_[idx];
+    const int stream_label = observer->timer_->StreamLabel();
+
+    tracing::TracerEvent event;
+    event.name_ = op_trace_names_[idx].c_str();
+    event.category_ = "op";
+    long start_us = observer->launch_us_;
+    if (stream_label >= 0) {
+      event.stream_id_ = stream_label;
+      event.thread_label_ = stream_label;
+      start_us = std::max(start_us, stream_end_us[stream_label]);
+    } else {
+      event.tid_ = observer->tid_;
+    }
+    long end_us = start_us +
+        std::max(1L, (long)caffe2::round(times[idx] * 1000.0f));
+    if (stream_label >= 0) {
+      stream_end_us[stream_label] = end_us;
+    }
+
+    event.is_beginning_ = true;
+    event.timestamp_ = start_us;
+    events.push_back(event);
+    event.is_beginning_ = false;
+    event.timestamp_ = end_us;
+    events.push_back(event);
+  }
+
+  // the tracer expects the events of every thread in time order
+  std::stable_sort(
+      events.begin(),
+      events.end(),
+      [](const tracing::TracerEvent& a, const tracing::TracerEvent& b) {
+        if (a.timestamp_ != b.timestamp_) {
+          return a.timestamp_ < b.timestamp_;
+        }
+        return !a.is_beginning_ && b.is_beginning_;
+      });
+  for (const auto& event : events) {
+    tracer_->recordEvent(event);
+  }
+}
+
+} // namespace caffe2
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <memory>
+#include <thread>
+
+#include "caffe2/contrib/prof/prof_dag_counters.h"
+#include "caffe2/core/net.h"
+#include "caffe2/core/net_async_tracing.h"
+#include "caffe2/core/observer.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/registry.h"
+#include "caffe2/core/timer.h"
+#include "caffe2/observers/operator_attaching_net_observer.h"
+#include "caffe2/proto/prof_dag.pb.h"
+
+namespace caffe2 {
+
+/**
+ * Measures the run time of a single operator on the operator's device.
+ * Start() and Stop() are called on the thread running the operator, right
+ * before and after it runs, and must not block; ElapsedMs() returns the time
+ * of the last recorded run and may wait for the device to finish it.
+ */
+class ProfDAGOpTimer {
+ public:
+  virtual ~ProfDAGOpTimer() {}
+
+  virtual void Start() = 0;
+  virtual void Stop() = 0;
+  virtual float ElapsedMs() = 0;
+
+  // Label of the stream the last run was recorded on, -1 for host timers
+  virtual int StreamLabel() const {
+    return -1;
+  }
+};
+
+// Device specific timers, keyed by the operator's device type; operators on
+// devices without a registered timer are timed on the host
+CAFFE_DECLARE_TYPED_REGISTRY(
+    ProfDAGOpTimerRegistry,
+    int,
+    ProfDAGOpTimer,
+    std::unique_ptr,
+    OperatorBase*);
+
+class ProfDAGObserver;
+
+class ProfDAGOperatorObserver final : public ObserverBase<OperatorBase> {
+ public:
+  explicit ProfDAGOperatorObserver(OperatorBase* subject) = delete;
+  ProfDAGOperatorObserver(OperatorBase* subject, ProfDAGObserver* netObserver);
+
+ private:
+  void Start() override;
+  void Stop() override;
+
+  ProfDAGObserver* netObserver_;
+  std::unique_ptr<ProfDAGOpTimer> timer_;
+  // Host time at which the last run was launched, on the net observer's clock
+  long launch_us_ = -1;
+  std::thread::id tid_;
+  // Net run during which the operator last finished
+  int recorded_run_ = -1;
+
+  friend class ProfDAGObserver;
+};
+
+/**
+ * Profiles the operators of a net without changing how the net schedules
+ * them, in particular it is meant to be attached to async_scheduling nets
+ * instead of running them as prof_dag nets.
+ *
+ * Operators record their start and end on their own device (CUDA events on
+ * the operator's stream for CUDA operators) and the recorded times are
+ * resolved lazily, at the start of the next run or when the statistics are
+ * requested, so that the runs are not synchronized with the devices. The
+ * statistics printed on destruction thus do not include the last run.
+ *
+ * The statistics are the ones of ProfDAGNet and are exposed to the
+ * GetProfDagStats operator. If tracing is enabled for the net (see
+ * net_async_tracing.h) the operator times are also dumped as a Chrome trace,
+ * with CUDA operators laid out per stream.
+ */
+class ProfDAGObserver final : public OperatorAttachingNetObserver<
+                                  ProfDAGOperatorObserver,
+                                  ProfDAGObserver> {
+ public:
+  explicit ProfDAGObserver(NetBase* subject);
+  ~ProfDAGObserver();
+
+  ProfDAGProtos GetOperatorStats();
+  ProfDAGProtos GetPerOperatorCost();
+
+  // Returns the observer attached to the given net, nullptr if there is none
+  static ProfDAGObserver* Find(const NetBase* net);
+
+  long CurrentTimestamp() {
+    return (long)caffe2::round(timer_.MicroSeconds());
+  }
+
+ private:
+  void Start() override;
+  void Stop() override;
+
+  // Collects the times of the last run into counters_ and the tracer
+  void ResolveRun();
+  void TraceRun(const std::vector<float>& times);
+
+  std::mutex mutex_;
+  ProfDAGCounters counters_;
+  // Trace events are named directly so that the tracer, which dumps the
+  // events on destruction, does not access the (already destroyed) operators
+  std::vector<std::string> op_trace_names_;
+  std::shared_ptr<tracing::Tracer> tracer_;
+  Timer timer_;
+  int run_id_ = 0;
+  bool run_pending_ = false;
+
+  friend class ProfDAGOperatorObserver;
+};
+
+} // namespace caffe2
@@ -0,0 +1,66 @@
+#include "prof_dag_observer.h"
+
+#include "caffe2/core/context_gpu.h"
+
+namespace caffe2 {
+
+namespace {
+
+// Records CUDA events around the operator on the operator's stream; the
+// events are created once and reused across runs.
+class CUDAProfDAGOpTimer final : public ProfDAGOpTimer {
+ public:
+  explicit CUDAProfDAGOpTimer(OperatorBase* op)
+      : context_(
+            dynamic_cast_if_rtti<const Operator<CUDAContext>*>(op)
+                ->getContext()) {
+    CAFFE_ENFORCE(context_, "Expected a CUDA operator: ", op->type());
+    DeviceGuard g(context_->cuda_gpu_id());
+    CUDA_ENFORCE(cudaEventCreate(&start_));
+    CUDA_ENFORCE(cudaEventCreate(&stop_));
+  }
+
+  ~CUDAProfDAGOpTimer() override {
+    DeviceGuard g(context_->cuda_gpu_id());
+    CUDA_CHECK(cudaEventDestroy(start_));
+    CUDA_CHECK(cudaEventDestroy(stop_));
+  }
+
+  void Start() override {
+    // the operator has already switched to its stream
+    gpu_id_ = context_->cuda_gpu_id();
+    stream_id_ = context_->stream_id();
+    CUDA_ENFORCE(cudaEventRecord(
+        start_, CUDAContext::cuda_stream(gpu_id_, stream_id_)));
+  }
+
+  void Stop() override {
+    CUDA_ENFORCE(cudaEventRecord(
+        stop_, CUDAContext::cuda_stream(gpu_id_, stream_id_)));
+  }
+
+  float ElapsedMs() override {
+    DeviceGuard g(gpu_id_);
+    CUDA_ENFORCE(cudaEventSynchronize(stop_));
+    float elapsed = 0;
+    CUDA_ENFORCE(cudaEventElapsedTime(&elapsed, start_, stop_));
+    return elapsed;
+  }
+
+  int StreamLabel() const override {
+    return gpu_id_ * 1000 + stream_id_;
+  }
+
+ private:
+  const CUDAContext* context_;
+  cudaEvent_t start_;
+  cudaEvent_t stop_;
+  int gpu_id_ = 0;
+  int stream_id_ = 0;
+};
+
+} // namespace
+
+CAFFE_REGISTER_TYPED_CLASS(ProfDAGOpTimerRegistry, CUDA, CUDAProfDAGOpTimer);
+
+} // namespace caffe2
@@ -0,0 +1,77 @@
+#include "caffe2/contrib/prof/prof_dag_observer.h"
+#include "caffe2/core/common.h"
+#include "caffe2/core/net.h"
+#include "caffe2/core/operator.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+namespace caffe2 {
+
+namespace {
+
+class ProfDAGTestSleepOp final : public Operator<CPUContext> {
+ public:
+  using Operator<CPUContext>::Operator;
+  bool RunOnDevice() override {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    return true;
+  }
+};
+
+REGISTER_CPU_OPERATOR(ProfDAGTestSleep, ProfDAGTestSleepOp);
+
+OPERATOR_SCHEMA(ProfDAGTestSleep).NumInputs(0, INT_MAX).NumOutputs(0, INT_MAX);
+
+unique_ptr<NetBase> CreateNetTestHelper(Workspace* ws) {
+  NetDef net_def;
+  net_def.set_name("prof_dag_observer_test");
+  net_def.set_type("async_scheduling");
+  {
+    auto& op = *(net_def.add_op());
+    op.set_type("ProfDAGTestSleep");
+    op.add_input("in");
+    op.add_output("hidden");
+  }
+  {
+    auto& op = *(net_def.add_op());
+    op.set_type("ProfDAGTestSleep");
+    op.add_input("hidden");
+    op.add_output("out");
+  }
+  net_def.add_external_input("in");
+  net_def.add_external_output("out");
+
+  return CreateNet(net_def, ws);
+}
+} // namespace
+
+TEST(ProfDAGObserverTest, AsyncSchedulingNet) {
+  Workspace ws;
+  ws.CreateBlob("in");
+  unique_ptr<NetBase> net(CreateNetTestHelper(&ws));
+  auto net_ob = caffe2::make_unique<ProfDAGObserver>(net.get());
+  auto* ob = net_ob.get();
+  net->AttachObserver(std::move(net_ob));
+  EXPECT_EQ(ob, ProfDAGObserver::Find(net.get()));
+
+  // the first run is not measured
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(net->Run());
+  }
+
+  auto stats = ob->GetOperatorStats();
+  ASSERT_EQ(stats.stats_size(), 1);
+  EXPECT_EQ(stats.stats(0).name(), "ProfDAGTestSleep");
+  EXPECT_GE(stats.stats(0).mean(), 40);
+  EXPECT_LT(stats.stats(0).mean(), 400);
+
+  auto per_op = ob->GetPerOperatorCost();
+  ASSERT_EQ(per_op.stats_size(), 2);
+  for (const auto& stat : per_op.stats()) {
+    EXPECT_GE(stat.mean(), 20);
+  }
+}
+
+} // namespace caffe2
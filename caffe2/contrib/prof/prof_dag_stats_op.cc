@@ -18,9 +18,11 @@ Gets the profiling statistics.
         "op will be calculated separately")
     .Arg(
         "partial_net_name",
-        "(string) default to empty; describes the partial name of the ProfDAGNet")
+        "(string) default to empty; describes the partial name of the "
+        "ProfDAGNet, or of the net observed by a ProfDAGObserver")
     .Arg(
         "net_name",
-        "(string) default to empty; describes the name of the ProfDAGNet");
+        "(string) default to empty; describes the name of the ProfDAGNet, or of "
+        "the net observed by a ProfDAGObserver");
 } // namespace
 } // namespace caffe2
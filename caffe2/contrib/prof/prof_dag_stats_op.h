@@ -2,13 +2,15 @@
 #define CAFFE2_OPERATORS_FULLY_CONNECTED_OP_H_
 
 #include "caffe2/contrib/prof/prof_dag_net.h"
+#include "caffe2/contrib/prof/prof_dag_observer.h"
 #include "caffe2/core/context.h"
 #include "caffe2/core/operator.h"
 #include "caffe2/utils/math.h"
 
 namespace caffe2 {
 
-// This operator outputs the ProfDAGNet stats
+// This operator outputs the stats of a ProfDAGNet, or of a net with an
+// attached ProfDAGObserver
 template <typename T, class Context, class Engine = DefaultEngine>
 class GetProfDagStatsOp final : public Operator<Context> {
  public:
@@ -53,14 +55,17 @@ class GetProfDagStatsOp final : public Operator<Context> {
           " as part of its name");
     }
 
-    auto prof_dag_net = dynamic_cast_if_rtti<ProfDAGNet*>(net);
-    CAFFE_ENFORCE(prof_dag_net);
-
     ProfDAGProtos stats;
-    if (per_op_) {
-      stats = prof_dag_net->GetPerOperatorCost();
+    auto prof_dag_net = dynamic_cast_if_rtti<ProfDAGNet*>(net);
+    if (prof_dag_net) {
+      stats = per_op_ ? prof_dag_net->GetPerOperatorCost()
+                      : prof_dag_net->GetOperatorStats();
     } else {
-      stats = prof_dag_net->GetOperatorStats();
+      auto* observer = ProfDAGObserver::Find(net);
+      CAFFE_ENFORCE(
+          observer, "Net is neither a ProfDAGNet nor has a ProfDAGObserver");
+      stats = per_op_ ? observer->GetPerOperatorCost()
+                      : observer->GetOperatorStats();
     }
 
     // Write protobuf message to the output blob
@@ -1,5 +1,6 @@
 #include "caffe2/contrib/tensorrt/tensorrt_op_trt.h"
 
+#include <algorithm>
 #include <numeric>
 #include <unordered_map>
 
@@ -54,61 +55,84 @@ TensorRTOp::TensorRTOp(const OperatorDef& operator_def, Workspace* ws)
               FLAGS_minloglevel))),
       max_batch_size_(
           OperatorBase::GetSingleArgument<int>("max_batch_size", 1)) {
-  {
-    auto engine_string =
-        OperatorBase::GetSingleArgument<std::string>("backend_buffer", "");
-    if (!engine_string.empty()) {
-      auto trt_runtime =
-          tensorrt::TrtObject(nvinfer1::createInferRuntime(logger_));
-      // TODO(support trt plugin factory)
-      trt_engine_ = tensorrt::TrtObject(trt_runtime->deserializeCudaEngine(
-          engine_string.data(), engine_string.size(), nullptr));
-    } else {
-      auto onnx_model_str =
-          OperatorBase::GetSingleArgument<std::string>("onnx_model", "");
-      CAFFE_ENFORCE(!onnx_model_str.empty(), "onnx_model cannot be empty");
-      auto debug_builder = OperatorBase::GetSingleArgument<int>("debug_builder", 0);
-      auto max_workspace_size = OperatorBase::GetSingleArgument<int>(
-          "max_workspace_size", 1024 * 1024 * 2);
+  auto engine_string =
+      OperatorBase::GetSingleArgument<std::string>("backend_buffer", "");
+  if (!engine_string.empty()) {
+    auto trt_runtime =
+        tensorrt::TrtObject(nvinfer1::createInferRuntime(logger_));
+    // TODO(support trt plugin factory)
+    auto trt_engine = tensorrt::TrtObject(trt_runtime->deserializeCudaEngine(
+        engine_string.data(), engine_string.size(), nullptr));
+    engines_.push_back({max_batch_size_, trt_engine, nullptr});
+  } else {
+    auto onnx_model_str =
+        OperatorBase::GetSingleArgument<std::string>("onnx_model", "");
+    CAFFE_ENFORCE(!onnx_model_str.empty(), "onnx_model cannot be empty");
+    auto debug_builder = OperatorBase::GetSingleArgument<int>("debug_builder", 0);
+    auto max_workspace_size = OperatorBase::GetSingleArgument<int>(
+        "max_workspace_size", 1024 * 1024 * 2);
 
-      // Pull the weights from workspace and assembly it back to the onnx model,
-      // notice that since we may have rewritten the net, we need to map the
-      // weight names
-      auto initializers = OperatorBase::GetRepeatedArgument<std::string>("initializers");
-      CAFFE_ENFORCE_EQ(
-          initializers.size() % 2, 0, "initializers should come in pairs");
-      std::unordered_set<std::string> initializer_set;
-      std::unordered_map<std::string, std::string> input_mapping;
-      for (auto it = initializers.begin(); it != initializers.end(); ++it)  {
-        auto key = *it++;
-        input_mapping.emplace(key, *it);
-        initializer_set.emplace(key);
-      }
-      Workspace mapped_ws(ws, input_mapping);
-      ::ONNX_NAMESPACE::ModelProto onnx_model;
-      ParseProtoFromLargeString(onnx_model_str, &onnx_model);
-      BuildInitializationList(&mapped_ws, onnx_model.mutable_graph(), &initializer_set);
-      onnx_model_str.clear();
-      onnx_model.SerializeToString(&onnx_model_str);
+    // Pull the weights from workspace and assembly it back to the onnx model,
+    // notice that since we may have rewritten the net, we need to map the
+    // weight names
+    auto initializers = OperatorBase::GetRepeatedArgument<std::string>("initializers");
+    CAFFE_ENFORCE_EQ(
+        initializers.size() % 2, 0, "initializers should come in pairs");
+    std::unordered_set<std::string> initializer_set;
+    std::unordered_map<std::string, std::string> input_mapping;
+    for (auto it = initializers.begin(); it != initializers.end(); ++it)  {
+      auto key = *it++;
+      input_mapping.emplace(key, *it);
+      initializer_set.emplace(key);
+    }
+    Workspace mapped_ws(ws, input_mapping);
+    ::ONNX_NAMESPACE::ModelProto onnx_model;
+    ParseProtoFromLargeString(onnx_model_str, &onnx_model);
+    BuildInitializationList(&mapped_ws, onnx_model.mutable_graph(), &initializer_set);
+    onnx_model_str.clear();
+    onnx_model.SerializeToString(&onnx_model_str);
 
-      // Build the trt engine
-      trt_engine_ = tensorrt::BuildTrtEngine(
+    // Build (or load from the engine cache) the trt engines, one per batch
+    // size profile below max_batch_size and one for max_batch_size
+    auto profiles =
+        OperatorBase::GetRepeatedArgument<int>("batch_size_profiles");
+    profiles.push_back(max_batch_size_);
+    std::sort(profiles.begin(), profiles.end());
+    for (auto profile : profiles) {
+      CAFFE_ENFORCE_GT(profile, 0, "Batch size profiles must be positive");
+      if (profile > max_batch_size_) {
+        LOG(WARNING) << "Ignoring batch size profile " << profile
+                     << " larger than max_batch_size " << max_batch_size_;
+        continue;
+      }
+      if (!engines_.empty() && engines_.back().max_batch_size == profile) {
+        continue;
+      }
+      auto trt_engine = tensorrt::BuildOrLoadTrtEngine(
           onnx_model_str,
           &logger_,
-          max_batch_size_,
+          profile,
           max_workspace_size,
           debug_builder);
+      engines_.push_back({profile, trt_engine, nullptr});
     }
   }
 
-  CAFFE_ENFORCE(trt_engine_, "Cannot build TensorRT engine!");
+  for (auto& engine : engines_) {
+    CAFFE_ENFORCE(engine.engine, "Cannot build TensorRT engine!");
+    engine.executor =
+        tensorrt::TrtObject(engine.engine->createExecutionContext());
+  }
+  // the engines only differ in their max batch size, so they have the same
+  // bindings
+  const auto& trt_engine = engines_.back().engine;
 
   // match and bind the input/output
-  const int num_bindings = trt_engine_->getNbBindings();
+  const int num_bindings = trt_engine->getNbBindings();
   int output_idx = 0;
   for (int b = 0; b < num_bindings; ++b) {
-    nv_dims_.push_back(trt_engine_->getBindingDimensions(b));
-    bool is_input = trt_engine_->bindingIsInput(b);
+    nv_dims_.push_back(trt_engine->getBindingDimensions(b));
+    bool is_input = trt_engine->bindingIsInput(b);
     is_input_.push_back(is_input);
     if (!is_input) {
       // For output, we try to get its output size hint
@@ -124,8 +148,6 @@ TensorRTOp::TensorRTOp(const OperatorDef& operator_def, Workspace* ws)
       ++output_idx;
     }
   }
-
-  trt_executor_ = tensorrt::TrtObject(trt_engine_->createExecutionContext());
 }
 
 void TensorRTOp::MaybeAdjustOutputShape(
@@ -156,7 +178,7 @@ void TensorRTOp::MaybeAdjustOutputShape(
 }
 
 bool TensorRTOp::RunOnDevice() {
-  CAFFE_ENFORCE(trt_executor_);
+  CAFFE_ENFORCE(!engines_.empty());
   // Decide input batch size
   size_t N = 0;
   for (int i = 0; i < InputSize(); ++i) {
@@ -223,7 +245,12 @@ bool TensorRTOp::RunOnDevice() {
     }
 
     CAFFE_ENFORCE_EQ(bindings.size(), InputSize() + OutputSize());
-    if (!trt_executor_->execute(batch_size, bindings.data())) {
+    // the engine of the smallest profile that fits the batch
+    auto engine = engines_.begin();
+    while (engine->max_batch_size < batch_size) {
+      ++engine;
+    }
+    if (!engine->executor->execute(batch_size, bindings.data())) {
       CAFFE_THROW("Error running the TensorRT executor");
     }
   }
@@ -252,7 +279,13 @@ This is a GPU only operator.
         "max_batch_size",
         "(int default 0) Batch size set by the TensorRT engine builder."
         "It must be no larger than the max_batch_size of the engine builder so "
-        "it is better not to edit this manually.");
+        "it is better not to edit this manually.")
+    .Arg(
+        "batch_size_profiles",
+        "(list of ints default=[]) When the engine is built from onnx_model, "
+        "additional engines are built for these max batch sizes, and each "
+        "batch runs on the engine of the smallest one that fits it. Engines "
+        "built for smaller batches can pick faster kernels for them.");
 
 REGISTER_CUDA_OPERATOR(TensorRT, TensorRTOp);
 } // namespace caffe2
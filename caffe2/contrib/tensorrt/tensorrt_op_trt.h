@@ -24,8 +24,14 @@ class TensorRTOp final : public Operator<CUDAContext> {
   std::vector<nvinfer1::Dims> nv_dims_;
   std::vector<bool> is_input_;
   std::unordered_map<int, std::vector<TIndex>> output_size_hints_;
-  std::shared_ptr<nvinfer1::ICudaEngine> trt_engine_{nullptr};
-  std::shared_ptr<nvinfer1::IExecutionContext> trt_executor_{nullptr};
+  // One engine per batch size profile, by increasing max batch size. The
+  // last one is built for max_batch_size_.
+  struct Engine {
+    int max_batch_size;
+    std::shared_ptr<nvinfer1::ICudaEngine> engine;
+    std::shared_ptr<nvinfer1::IExecutionContext> executor;
+  };
+  std::vector<Engine> engines_;
   bool batch_warning_issued_{false};
 };
 
@@ -246,7 +246,7 @@ OperatorDef TensorRTTransformer::BuildTrtOp(
   op.set_type("TensorRT");
 
   tensorrt::TrtLogger logger;
-  auto trt_engine = tensorrt::BuildTrtEngine(
+  auto trt_engine = tensorrt::BuildOrLoadTrtEngine(
       onnx_model_str,
       &logger,
       max_batch_size_,
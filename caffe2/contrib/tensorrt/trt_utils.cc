@@ -1,9 +1,58 @@
 #include "caffe2/contrib/tensorrt/trt_utils.h"
 
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
 #include <NvOnnxParser.h>
+#include <unistd.h>
+
+#include "caffe2/core/common_gpu.h"
+
+CAFFE2_DEFINE_string(
+    caffe2_tensorrt_engine_cache_dir,
+    "",
+    "If set, directory in which built TensorRT engines are cached, so that "
+    "loading the same model on the same GPU model again doesn't rebuild them.");
 
 namespace caffe2 {
 namespace tensorrt {
+
+namespace {
+
+// FNV-1a, which unlike std::hash is the same in every build.
+uint64_t Fnv1a(const void* data, size_t size, uint64_t hash) {
+  const auto* bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+std::string EngineCachePath(
+    const std::string& onnx_model_str,
+    size_t max_batch_size,
+    size_t max_workspace_size) {
+  int device = 0;
+  CUDA_ENFORCE(cudaGetDevice(&device));
+  cudaDeviceProp prop;
+  CUDA_ENFORCE(cudaGetDeviceProperties(&prop, device));
+  std::stringstream options;
+  options << prop.name << ";" << prop.major << "." << prop.minor << ";"
+          << NV_TENSORRT_MAJOR << "." << NV_TENSORRT_MINOR << "."
+          << NV_TENSORRT_PATCH << ";" << max_batch_size << ";"
+          << max_workspace_size;
+  const auto options_str = options.str();
+  uint64_t hash = 14695981039346656037ULL;
+  hash = Fnv1a(onnx_model_str.data(), onnx_model_str.size(), hash);
+  hash = Fnv1a(options_str.data(), options_str.size(), hash);
+  char name[32];
+  snprintf(name, sizeof(name), "%016llx.trt", (unsigned long long)hash);
+  return FLAGS_caffe2_tensorrt_engine_cache_dir + "/" + name;
+}
+
+} // namespace
 std::shared_ptr<nvinfer1::ICudaEngine> BuildTrtEngine(
     const std::string& onnx_model_str,
     TrtLogger* logger,
@@ -40,5 +89,60 @@ std::shared_ptr<nvinfer1::ICudaEngine> BuildTrtEngine(
   trt_builder->setDebugSync(debug_builder);
   return TrtObject(trt_builder->buildCudaEngine(*trt_network.get()));
 }
+
+std::shared_ptr<nvinfer1::ICudaEngine> BuildOrLoadTrtEngine(
+    const std::string& onnx_model_str,
+    TrtLogger* logger,
+    size_t max_batch_size,
+    size_t max_workspace_size,
+    bool debug_builder) {
+  if (FLAGS_caffe2_tensorrt_engine_cache_dir.empty()) {
+    return BuildTrtEngine(
+        onnx_model_str,
+        logger,
+        max_batch_size,
+        max_workspace_size,
+        debug_builder);
+  }
+
+  const auto path =
+      EngineCachePath(onnx_model_str, max_batch_size, max_workspace_size);
+  std::ifstream in(path, std::ios::binary);
+  if (in) {
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    const auto plan = buffer.str();
+    auto trt_runtime = TrtObject(nvinfer1::createInferRuntime(*logger));
+    auto* engine =
+        trt_runtime->deserializeCudaEngine(plan.data(), plan.size(), nullptr);
+    if (engine) {
+      VLOG(1) << "Loaded TensorRT engine from " << path;
+      return TrtObject(engine);
+    }
+    LOG(WARNING) << "Cannot deserialize the cached TensorRT engine " << path
+                 << ", rebuilding it";
+  }
+
+  auto trt_engine = BuildTrtEngine(
+      onnx_model_str, logger, max_batch_size, max_workspace_size, debug_builder);
+  auto plan = TrtObject(trt_engine->serialize());
+  // Written to a temporary file first, so that concurrent loaders never see
+  // a partial engine.
+  const auto tmp_path = MakeString(path, ".", getpid(), ".tmp");
+  {
+    std::ofstream out(tmp_path, std::ios::binary);
+    out.write(static_cast<const char*>(plan->data()), plan->size());
+    if (!out) {
+      LOG(WARNING) << "Cannot write the TensorRT engine cache " << tmp_path;
+      std::remove(tmp_path.c_str());
+      return trt_engine;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    LOG(WARNING) << "Cannot write the TensorRT engine cache " << path;
+    std::remove(tmp_path.c_str());
+  }
+  return trt_engine;
+}
 } // namespace tensorrt
 } // namespace caffe2
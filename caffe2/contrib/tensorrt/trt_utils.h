@@ -3,8 +3,11 @@
 #include <iostream>
 #include <NvInfer.h>
 
+#include "caffe2/core/flags.h"
 #include "caffe2/core/logging.h"
 
+CAFFE2_DECLARE_string(caffe2_tensorrt_engine_cache_dir);
+
 namespace caffe2 { namespace tensorrt {
 
   // Logger for GIE info/warning/errors
@@ -50,6 +53,18 @@ std::shared_ptr<nvinfer1::ICudaEngine> BuildTrtEngine(
     size_t max_batch_size,
     size_t max_workspace_size,
     bool debug_builder);
+
+// Same as BuildTrtEngine, but if --caffe2_tensorrt_engine_cache_dir is set,
+// the serialized engine is kept in that directory, keyed by a hash of the
+// model (including its input shapes and weights), of the builder options,
+// of the GPU model and of the TensorRT version, and later calls with the
+// same key deserialize it instead of building it again.
+std::shared_ptr<nvinfer1::ICudaEngine> BuildOrLoadTrtEngine(
+    const std::string& onnx_model_str,
+    TrtLogger* logger,
+    size_t max_batch_size,
+    size_t max_workspace_size,
+    bool debug_builder);
 }
 }
 
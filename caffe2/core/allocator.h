@@ -1,8 +1,13 @@
 #ifndef CAFFE2_CORE_ALLOCATOR_H_
 #define CAFFE2_CORE_ALLOCATOR_H_
 
+#include <algorithm>
 #include <unordered_map>
 
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
 #include "caffe2/core/logging.h"
 #include "caffe2/core/numa.h"
 
@@ -25,6 +30,10 @@ struct CAFFE2_API CPUAllocator {
   virtual ~CPUAllocator() noexcept {}
   virtual std::pair<void*, MemoryDeleter> New(size_t nbytes) = 0;
   virtual MemoryDeleter GetDeleter() = 0;
+  // The number of bytes usable at data, returned by New(nbytes)
+  virtual size_t Capacity(const void* /*data*/, size_t nbytes) {
+    return nbytes;
+  }
 };
 
 // A virtual struct that is used to report Caffe2's memory allocation and
@@ -57,11 +66,18 @@ struct CAFFE2_API DefaultCPUAllocator final : CPUAllocator {
     // move data to a thread's NUMA node
     NUMAMove(data, nbytes, GetCurrentNUMANode());
     if (FLAGS_caffe2_cpu_allocator_do_zero_fill) {
-      memset(data, 0, nbytes);
+      memset(data, 0, Capacity(data, nbytes));
     }
     return {data, Delete};
   }
 
+#ifdef __GLIBC__
+  // malloc rounds sizes up to its chunk sizes
+  size_t Capacity(const void* data, size_t nbytes) override {
+    return std::max(nbytes, malloc_usable_size(const_cast<void*>(data)));
+  }
+#endif
+
 #ifdef _MSC_VER
   static void Delete(void* data) {
     _aligned_free(data);
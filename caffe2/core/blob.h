@@ -36,7 +36,8 @@ class CAFFE2_API Blob {
   Blob(Blob&& other) noexcept
       : meta_(std::move(other.meta_)),
         pointer_(std::move(other.pointer_)),
-        destroy_(std::move(other.destroy_)) {
+        destroy_(std::move(other.destroy_)),
+        version_(other.version_) {
     other.meta_ = {};
     other.pointer_ = nullptr;
     other.destroy_ = nullptr;
@@ -49,6 +50,7 @@ class CAFFE2_API Blob {
     meta_ = std::move(other.meta_);
     pointer_ = std::move(other.pointer_);
     destroy_ = std::move(other.destroy_);
+    ++version_;
     other.meta_ = {};
     other.pointer_ = nullptr;
     other.destroy_ = nullptr;
@@ -88,6 +90,13 @@ class CAFFE2_API Blob {
    */
   inline const char* TypeName() const { return meta_.name(); }
 
+  /**
+   * Returns a counter of the mutable accesses to the blob, which changes
+   * whenever the blob is written through its interface. Writes through a
+   * pointer obtained earlier are not counted.
+   */
+  inline uint64_t version() const { return version_; }
+
   /**
    * @brief Gets the const reference of the stored object. The code checks if
    * the stored object is of the desired type.
@@ -129,6 +138,7 @@ class CAFFE2_API Blob {
         "GetMutable can't be called with non-default-constructible types. "
         "Try using specialized methods");
     if (IsType<T>()) {
+      ++version_;
       return static_cast<T*>(pointer_);
     } else {
       VLOG(1) << "Create new mutable object " << TypeMeta::TypeName<T>();
@@ -139,6 +149,7 @@ class CAFFE2_API Blob {
   template <class T>
   T* GetMutableOrNull() {
     if (IsType<T>()) {
+      ++version_;
       return static_cast<T*>(pointer_);
     } else {
       return nullptr;
@@ -147,6 +158,7 @@ class CAFFE2_API Blob {
 
   inline Tensor* GetMutableTensor(DeviceType device_type) {
     if (IsType<Tensor>(device_type)) {
+      ++version_;
       return static_cast<Tensor*>(pointer_);
     } else {
       VLOG(1) << "Create new mutable object " << TypeMeta::TypeName<Tensor>()
@@ -171,6 +183,7 @@ class CAFFE2_API Blob {
     meta_ = TypeMeta::Make<T>();
     pointer_ = static_cast<void*>(allocated);
     destroy_ = &Destroy<T>;
+    ++version_;
     return allocated;
   }
 
@@ -182,6 +195,7 @@ class CAFFE2_API Blob {
     meta_ = meta;
     pointer_ = static_cast<void*>(allocated);
     destroy_ = destroy;
+    ++version_;
     return allocated;
   }
 
@@ -220,6 +234,7 @@ class CAFFE2_API Blob {
     meta_ = meta;
     pointer_ = static_cast<void*>(allocated);
     destroy_ = nullptr;
+    ++version_;
     return allocated;
   }
 
@@ -233,6 +248,7 @@ class CAFFE2_API Blob {
     pointer_ = nullptr;
     meta_ = TypeMeta();
     destroy_ = nullptr;
+    ++version_;
   }
 
   /**
@@ -266,6 +282,8 @@ class CAFFE2_API Blob {
     swap(meta_, rhs.meta_);
     swap(pointer_, rhs.pointer_);
     swap(destroy_, rhs.destroy_);
+    ++version_;
+    ++rhs.version_;
   }
 
   /**
@@ -275,6 +293,15 @@ class CAFFE2_API Blob {
    */
   void Deserialize(const string& content);
   void Deserialize(const BlobProto& proto);
+  /**
+   * Deserializes from a BlobProto whose data is given separately, as parsed
+   * by ParseBlobProto() from the raw encoding of tensors. With a null
+   * `raw_data`, the same as Deserialize(proto).
+   */
+  void Deserialize(
+      const BlobProto& proto,
+      const char* raw_data,
+      size_t raw_size);
 
  private:
   /**
@@ -287,6 +314,7 @@ class CAFFE2_API Blob {
   TypeMeta meta_;
   void* pointer_ = nullptr;
   DestroyCall destroy_ = nullptr;
+  uint64_t version_ = 0;
 
   AT_DISABLE_COPY_AND_ASSIGN(Blob);
 };
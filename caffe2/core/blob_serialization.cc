@@ -1,5 +1,6 @@
 #include "caffe2/core/blob_serialization.h"
 
+#include <cstring>
 #include <sstream>
 #include <mutex>
 
@@ -21,7 +22,92 @@ CAFFE2_DEFINE_bool(
     false,
     "Serialize FLOAT16 tensors using byte_data field");
 
+CAFFE2_DEFINE_bool(
+    caffe2_serialize_tensors_raw,
+    false,
+    "Serialize tensors of fixed size types in the raw encoding, which is "
+    "faster to deserialize but cannot be read by older versions");
+
 namespace caffe2 {
+
+namespace {
+
+bool IsLittleEndian() {
+  const int kValue = 1;
+  return reinterpret_cast<const char*>(&kValue)[0] == 1;
+}
+
+bool HasRawEncoding(TensorProto::DataType data_type) {
+  return data_type != TensorProto_DataType_UNDEFINED &&
+      data_type != TensorProto_DataType_STRING &&
+      data_type != TensorProto_DataType_BYTE;
+}
+
+// The offset of the data in the raw encoding.
+size_t RawDataBegin(uint32_t headerSize) {
+  const size_t headerEnd = kRawTensorMagicSize + sizeof(headerSize) + headerSize;
+  return (headerEnd + kRawTensorAlignment - 1) / kRawTensorAlignment *
+      kRawTensorAlignment;
+}
+
+// Resizes the tensor to the dims of the proto and returns the range of the
+// chunk of the proto.
+std::pair<int64_t, int64_t> PrepareTensorChunk(
+    const TensorProto& proto,
+    Tensor* tensor) {
+  vector<TIndex> dims;
+  for (const TIndex d : proto.dims()) {
+    dims.push_back(d);
+  }
+  tensor->Resize(dims);
+
+  int64_t chunkBegin = 0;
+  auto chunkEnd = tensor->size();
+  if (proto.has_segment()) {
+    chunkBegin = proto.segment().begin();
+    chunkEnd = proto.segment().end();
+  }
+  CAFFE_ENFORCE(
+      0 <= chunkBegin && chunkBegin <= chunkEnd && chunkEnd <= tensor->size(),
+      "Invalid chunk ",
+      chunkBegin,
+      ' ',
+      chunkEnd,
+      " with total tensor size ",
+      tensor->size());
+  return {chunkBegin, chunkEnd};
+}
+
+} // namespace
+
+bool ParseBlobProto(
+    const std::string& serialized,
+    BlobProto* proto,
+    const char** raw_data,
+    size_t* raw_size) {
+  *raw_data = nullptr;
+  *raw_size = 0;
+  // The magic cannot start a BlobProto, whose first byte would be the tag of
+  // a group with field number 8.
+  if (serialized.compare(0, kRawTensorMagicSize, kRawTensorMagic) != 0) {
+    return proto->ParseFromString(serialized);
+  }
+  uint32_t headerSize;
+  const size_t headerBegin = kRawTensorMagicSize + sizeof(headerSize);
+  if (serialized.size() < headerBegin) {
+    return false;
+  }
+  std::memcpy(
+      &headerSize, serialized.data() + kRawTensorMagicSize, sizeof(headerSize));
+  const size_t dataBegin = RawDataBegin(headerSize);
+  if (serialized.size() < dataBegin ||
+      !proto->ParseFromArray(serialized.data() + headerBegin, headerSize)) {
+    return false;
+  }
+  *raw_data = serialized.data() + dataBegin;
+  *raw_size = serialized.size() - dataBegin;
+  return true;
+}
 /**
  * @brief StringSerializer is the serializer for String.
  *
@@ -103,7 +189,20 @@ void TensorSerializer::SerializeWithChunkSize(
     chunk_size = FLAGS_caffe2_tensor_chunk_size;
   }
 
+  const bool raw = FLAGS_caffe2_serialize_tensors_raw && IsLittleEndian() &&
+      HasRawEncoding(TypeMetaToDataType(tensor.meta()));
   auto processChunk = [&](int64_t chunkStart) {
+    // Small chunks keep the proto encoding, as the padding of the raw
+    // encoding would outweigh them.
+    if (raw &&
+        std::min<int64_t>(chunk_size, tensor.size() - chunkStart) *
+                tensor.itemsize() >=
+            kRawTensorAlignment) {
+      acceptor(
+          MakeString(name, kChunkIdSeparator, chunkStart / chunk_size),
+          SerializeRaw(tensor, name, chunkStart, chunk_size));
+      return;
+    }
     BlobProto blob_proto;
     blob_proto.set_name(name);
     blob_proto.set_type(kTensorBlobType);
@@ -312,6 +411,47 @@ void TensorSerializer::Serialize(
   }
 }
 
+string TensorSerializer::SerializeRaw(
+    const Tensor& input,
+    const string& name,
+    size_t chunkBegin,
+    int32_t chunkSize) {
+  if (chunkBegin + chunkSize > input.size()) {
+    chunkSize = input.size() - chunkBegin;
+  }
+  BlobProto blob_proto;
+  blob_proto.set_name(name);
+  blob_proto.set_type(kTensorBlobType);
+  TensorProto& proto = *blob_proto.mutable_tensor();
+  proto.set_name(name);
+  proto.mutable_segment()->set_begin(chunkBegin);
+  proto.mutable_segment()->set_end(chunkBegin + chunkSize);
+  for (int i = 0; i < input.ndim(); ++i) {
+    proto.add_dims(input.dim(i));
+  }
+  proto.set_data_type(TypeMetaToDataType(input.meta()));
+  StoreDeviceDetail(input, &proto);
+  const string header = blob_proto.SerializeAsString();
+
+  const uint32_t headerSize = header.size();
+  const size_t dataBegin = RawDataBegin(headerSize);
+  const size_t nbytes = chunkSize * input.itemsize();
+  string serialized(dataBegin + nbytes, '\0');
+  char* out = &serialized[0];
+  std::memcpy(out, kRawTensorMagic, kRawTensorMagicSize);
+  std::memcpy(out + kRawTensorMagicSize, &headerSize, sizeof(headerSize));
+  std::memcpy(
+      out + kRawTensorMagicSize + sizeof(headerSize), header.data(), headerSize);
+  auto uniq_ptr = input.GetStaticContext()->CreateContext();
+  uniq_ptr->CopyBytesToCPU(
+      nbytes,
+      static_cast<const char*>(input.raw_data()) +
+          chunkBegin * input.itemsize(),
+      out + dataBegin);
+  uniq_ptr->FinishDeviceComputation();
+  return serialized;
+}
+
 int GetGPUIDForPointer(const void* ptr);
 
 void TensorSerializer::StoreDeviceDetail(
@@ -330,10 +470,12 @@ CAFFE_DEFINE_REGISTRY(BlobDeserializerRegistry, BlobDeserializerBase);
 
 void Blob::Deserialize(const string& content) {
   BlobProto blob_proto;
+  const char* raw_data;
+  size_t raw_size;
   CAFFE_ENFORCE(
-      blob_proto.ParseFromString(content),
+      ParseBlobProto(content, &blob_proto, &raw_data, &raw_size),
       "Cannot parse content into a BlobProto.");
-  Deserialize(blob_proto);
+  Deserialize(blob_proto, raw_data, raw_size);
 }
 
 void Blob::Deserialize(const BlobProto& blob_proto) {
@@ -357,6 +499,26 @@ void Blob::Deserialize(const BlobProto& blob_proto) {
   }
 }
 
+void Blob::Deserialize(
+    const BlobProto& blob_proto,
+    const char* raw_data,
+    size_t raw_size) {
+  if (!raw_data) {
+    Deserialize(blob_proto);
+    return;
+  }
+  auto deserializer = CreateDeserializer(
+      blob_proto.type() == kTensorBlobType
+          ? "Tensor" +
+              DeviceTypeName(blob_proto.tensor().device_detail().device_type())
+          : blob_proto.type());
+  CAFFE_ENFORCE(
+      deserializer.get(),
+      "No registered deserializer for type ",
+      blob_proto.type());
+  deserializer->Deserialize(blob_proto, raw_data, raw_size, this);
+}
+
 void TensorDeserializer::Deserialize(const BlobProto& blob_proto, Blob* blob) {
   auto tensor_proto = blob_proto.tensor();
   Deserialize(
@@ -365,6 +527,45 @@ void TensorDeserializer::Deserialize(const BlobProto& blob_proto, Blob* blob) {
           static_cast<DeviceType>(tensor_proto.device_detail().device_type())));
 }
 
+void TensorDeserializer::Deserialize(
+    const BlobProto& blob_proto,
+    const char* raw_data,
+    size_t raw_size,
+    Blob* blob) {
+  const auto& tensor_proto = blob_proto.tensor();
+  Deserialize(
+      tensor_proto,
+      raw_data,
+      raw_size,
+      blob->GetMutableTensor(
+          static_cast<DeviceType>(tensor_proto.device_detail().device_type())));
+}
+
+void TensorDeserializer::Deserialize(
+    const TensorProto& proto,
+    const char* raw_data,
+    size_t raw_size,
+    Tensor* tensor) {
+  CAFFE_ENFORCE(
+      HasRawEncoding(proto.data_type()),
+      "No raw encoding for tensors of type ",
+      proto.data_type());
+  auto uniq_ptr =
+      tensor->GetStaticContext()->CreateContext(proto.device_detail());
+  auto context = uniq_ptr.get();
+  context->SwitchToDevice(0);
+  const auto chunk = PrepareTensorChunk(proto, tensor);
+  const TypeMeta meta = DataTypeToTypeMeta(proto.data_type());
+  const size_t nbytes = (chunk.second - chunk.first) * meta.itemsize();
+  CAFFE_ENFORCE_EQ(nbytes, raw_size, "Incorrect raw data size.");
+  context->CopyBytesFromCPU(
+      nbytes,
+      raw_data,
+      static_cast<char*>(tensor->raw_mutable_data(meta)) +
+          chunk.first * meta.itemsize());
+  context->FinishDeviceComputation();
+}
+
 void TensorDeserializer::Deserialize(const TensorProto& proto, Tensor* tensor) {
   // We create a local context for deserializing. Since Caffe2 contexts are
   // usually lightweight, this should not involve too much overhead.
@@ -372,27 +573,9 @@ void TensorDeserializer::Deserialize(const TensorProto& proto, Tensor* tensor) {
       tensor->GetStaticContext()->CreateContext(proto.device_detail());
   auto context = uniq_ptr.get();
   context->SwitchToDevice(0);
-  vector<TIndex> dims;
-  for (const TIndex d : proto.dims()) {
-    dims.push_back(d);
-  }
-  tensor->Resize(dims);
-
-  int64_t chunkBegin = 0;
-  auto chunkEnd = tensor->size();
-  if (proto.has_segment()) {
-    chunkBegin = proto.segment().begin();
-    chunkEnd = proto.segment().end();
-  }
-  CAFFE_ENFORCE(
-      0 <= chunkBegin && chunkBegin <= chunkEnd && chunkEnd <= tensor->size(),
-      "Invalid chunk ",
-      chunkBegin,
-      ' ',
-      chunkEnd,
-      " with total tensor size ",
-      tensor->size());
-  auto chunkSize = chunkEnd - chunkBegin;
+  const auto chunk = PrepareTensorChunk(proto, tensor);
+  const int64_t chunkBegin = chunk.first;
+  auto chunkSize = chunk.second - chunk.first;
 
   switch (proto.data_type()) {
     case TensorProto_DataType_FLOAT:
@@ -16,6 +16,7 @@
 CAFFE2_DECLARE_int(caffe2_tensor_chunk_size);
 CAFFE2_DECLARE_int(caffe2_max_tensor_serializer_threads);
 CAFFE2_DECLARE_bool(caffe2_serialize_fp16_as_bytes);
+CAFFE2_DECLARE_bool(caffe2_serialize_tensors_raw);
 
 namespace caffe2 {
 
@@ -23,6 +24,33 @@ constexpr auto kTensorBlobType = "Tensor";
 // String used to separate chunk id from the blob name when storing in DB
 constexpr auto kChunkIdSeparator = "#%";
 
+/**
+ * The raw encoding of tensors, which skips the protobuf encoding of the data.
+ * A serialized blob in this encoding starts with kRawTensorMagic, followed by
+ * the size of a BlobProto as a little endian uint32 and the BlobProto, whose
+ * tensor has no data. After padding to a multiple of kRawTensorAlignment from
+ * the start, the data of the tensor (chunk) follows as it is in memory, so
+ * that it is deserialized with a single copy.
+ *
+ * Tensors of fixed size types are serialized in the raw encoding with
+ * --caffe2_serialize_tensors_raw, when their chunk is at least
+ * kRawTensorAlignment bytes. Deserialization takes both encodings.
+ */
+constexpr char kRawTensorMagic[] = "C2RAWTNS";
+constexpr size_t kRawTensorMagicSize = sizeof(kRawTensorMagic) - 1;
+constexpr size_t kRawTensorAlignment = 4096;
+
+/**
+ * Parses a serialized blob in either encoding into `proto`. In the raw
+ * encoding, `*raw_data` and `*raw_size` are set to the data of the tensor
+ * within `serialized`, otherwise `*raw_data` is set to nullptr.
+ */
+CAFFE2_API bool ParseBlobProto(
+    const std::string& serialized,
+    BlobProto* proto,
+    const char** raw_data,
+    size_t* raw_size);
+
 /**
  * @brief TensorSerializer is the serializer for Tensors.
  *
@@ -55,6 +83,12 @@ class CAFFE2_API TensorSerializer : public BlobSerializerBase {
       int32_t chunkSize);
 
  private:
+  // Serializes a chunk of the tensor in the raw encoding.
+  string SerializeRaw(
+      const Tensor& input,
+      const string& name,
+      size_t chunkBegin,
+      int32_t chunkSize);
   // A utility function to store the device context detauls.
   void StoreDeviceDetail(const Tensor& input, TensorProto* proto);
   unique_ptr<BaseContext> context_;
@@ -72,7 +106,17 @@ class CAFFE2_API TensorSerializer : public BlobSerializerBase {
 class CAFFE2_API TensorDeserializer : public BlobDeserializerBase {
  public:
   void Deserialize(const BlobProto& proto, Blob* blob) override;
+  void Deserialize(
+      const BlobProto& proto,
+      const char* raw_data,
+      size_t raw_size,
+      Blob* blob) override;
   void Deserialize(const TensorProto& proto, Tensor* tensor);
+  void Deserialize(
+      const TensorProto& proto,
+      const char* raw_data,
+      size_t raw_size,
+      Tensor* tensor);
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -4,6 +4,7 @@
 #include <functional>
 
 #include "caffe2/core/common.h"
+#include "caffe2/core/logging.h"
 #include "caffe2/core/registry.h"
 #include "caffe2/proto/caffe2.pb.h"
 
@@ -80,6 +81,17 @@ class CAFFE2_API BlobDeserializerBase {
 
   // Deserializes from a BlobProto object.
   virtual void Deserialize(const BlobProto& proto, Blob* blob) = 0;
+
+  // Deserializes from a BlobProto object whose data is given separately, as
+  // in the raw encoding of tensors (see blob_serialization.h). Only types
+  // with a raw encoding support it.
+  virtual void Deserialize(
+      const BlobProto& proto,
+      const char* /*raw_data*/,
+      size_t /*raw_size*/,
+      Blob* /*blob*/) {
+    CAFFE_THROW("No raw encoding for blobs of type ", proto.type());
+  }
 };
 
 CAFFE_DECLARE_REGISTRY(BlobDeserializerRegistry, BlobDeserializerBase);
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <map>
 #include <memory>
 #include <mutex>
 
@@ -21,6 +22,7 @@
 CAFFE2_DEFINE_int64(caffe2_test_big_tensor_size, 100000000, "");
 CAFFE2_DECLARE_int(caffe2_tensor_chunk_size);
 CAFFE2_DECLARE_bool(caffe2_serialize_fp16_as_bytes);
+CAFFE2_DECLARE_bool(caffe2_serialize_tensors_raw);
 
 namespace caffe2 {
 using namespace ::caffe2::db;
@@ -169,6 +171,24 @@ TEST(BlobTest, BlobShareExternalObject) {
   blob.Reset();
 }
 
+TEST(BlobTest, BlobVersion) {
+  Blob blob;
+  auto version = blob.version();
+  blob.GetMutable<BlobTestFoo>();
+  EXPECT_GT(blob.version(), version);
+  version = blob.version();
+  blob.Get<BlobTestFoo>();
+  EXPECT_EQ(blob.version(), version);
+  blob.GetMutable<BlobTestFoo>();
+  EXPECT_GT(blob.version(), version);
+  version = blob.version();
+  blob.GetMutableTensor(CPU);
+  EXPECT_GT(blob.version(), version);
+  version = blob.version();
+  blob.Reset();
+  EXPECT_GT(blob.version(), version);
+}
+
 TEST(BlobTest, StringSerialization) {
   const std::string kTestString = "Hello world?";
   Blob blob;
@@ -507,6 +527,46 @@ TYPED_TEST(TensorCPUTest, MaxKeepOnShrink) {
   FLAGS_caffe2_max_keep_on_shrink_memory = LLONG_MAX;
 }
 
+TYPED_TEST(TensorCPUTest, ReserveKeepsData) {
+  CPUContext context;
+  Tensor tensor(vector<int>{2, 3}, CPU);
+  TypeParam* ptr = tensor.mutable_data<TypeParam>();
+  for (int i = 0; i < tensor.size(); ++i) {
+    ptr[i] = static_cast<TypeParam>(i);
+  }
+  tensor.Reserve(10, &context);
+  EXPECT_EQ(tensor.dims(), (vector<TIndex>{2, 3}));
+  TypeParam* reserved_ptr = tensor.mutable_data<TypeParam>();
+  for (int i = 0; i < tensor.size(); ++i) {
+    EXPECT_EQ(reserved_ptr[i], static_cast<TypeParam>(i));
+  }
+  // Growing within the reserved capacity doesn't reallocate
+  tensor.Extend(8, 50, &context);
+  EXPECT_EQ(tensor.dims(), (vector<TIndex>{10, 3}));
+  EXPECT_EQ(tensor.mutable_data<TypeParam>(), reserved_ptr);
+  tensor.Resize(7, 3);
+  EXPECT_EQ(tensor.mutable_data<TypeParam>(), reserved_ptr);
+}
+
+TYPED_TEST(TensorCPUTest, ResizeWithGrowth) {
+  FLAGS_caffe2_keep_on_shrink = true;
+  Tensor tensor(CPU);
+  const auto meta = TypeMeta::Make<TypeParam>();
+  tensor.ResizeWithGrowth(vector<TIndex>{10, 2}, 50, meta);
+  EXPECT_EQ(tensor.dims(), (vector<TIndex>{10, 2}));
+  EXPECT_GE(tensor.capacity_nbytes(), 15 * 2 * sizeof(TypeParam));
+  TypeParam* ptr = static_cast<TypeParam*>(tensor.raw_mutable_data(meta));
+  // Up to the extra capacity, growing doesn't reallocate
+  tensor.ResizeWithGrowth(vector<TIndex>{15, 2}, 50, meta);
+  EXPECT_EQ(tensor.dims(), (vector<TIndex>{15, 2}));
+  EXPECT_EQ(tensor.raw_mutable_data(meta), ptr);
+  tensor.ResizeWithGrowth(vector<TIndex>{4, 2}, 50, meta);
+  EXPECT_EQ(tensor.raw_mutable_data(meta), ptr);
+  tensor.ResizeWithGrowth(vector<TIndex>{20, 2}, 50, meta);
+  EXPECT_EQ(tensor.dims(), (vector<TIndex>{20, 2}));
+  EXPECT_GE(tensor.capacity_nbytes(), 30 * 2 * sizeof(TypeParam));
+}
+
 TYPED_TEST(TensorCPUDeathTest, CannotAccessRawDataWhenEmpty) {
   Tensor tensor(CPU);
   EXPECT_EQ(tensor.ndim(), 0);
@@ -1049,6 +1109,52 @@ TEST(CustomChunkSize, BigTensorSerialization) {
   EXPECT_EQ(counter, 1);
 }
 
+TEST(RawEncoding, TensorSerialization) {
+  FLAGS_caffe2_serialize_tensors_raw = true;
+  Blob blob;
+  TensorCPU* tensor = blob.GetMutableTensor(CPU);
+  tensor->Resize(3, 1000);
+  for (int i = 0; i < tensor->size(); ++i) {
+    tensor->mutable_data<float>()[i] = i;
+  }
+  std::mutex mutex;
+  std::map<std::string, std::string> chunks;
+  blob.Serialize(
+      "test",
+      [&](const std::string& key, const std::string& value) {
+        std::lock_guard<std::mutex> guard(mutex);
+        chunks[key] = value;
+      },
+      2000);
+  FLAGS_caffe2_serialize_tensors_raw = false;
+  // The second chunk is too small for the raw encoding.
+  EXPECT_EQ(chunks.size(), 2);
+  const auto& first = chunks.begin()->second;
+  EXPECT_EQ(first.compare(0, kRawTensorMagicSize, kRawTensorMagic), 0);
+  EXPECT_NE(chunks.rbegin()->second.compare(
+                0, kRawTensorMagicSize, kRawTensorMagic),
+            0);
+
+  BlobProto proto;
+  const char* raw_data;
+  size_t raw_size;
+  EXPECT_TRUE(ParseBlobProto(first, &proto, &raw_data, &raw_size));
+  EXPECT_EQ((raw_data - first.data()) % kRawTensorAlignment, 0);
+  EXPECT_EQ(raw_size, 2000 * sizeof(float));
+  EXPECT_EQ(proto.tensor().segment().begin(), 0);
+  EXPECT_EQ(proto.tensor().segment().end(), 2000);
+
+  Blob new_blob;
+  for (const auto& chunk : chunks) {
+    new_blob.Deserialize(chunk.second);
+  }
+  const auto& new_tensor = new_blob.Get<TensorCPU>();
+  EXPECT_EQ(new_tensor.dims(), tensor->dims());
+  for (int i = 0; i < tensor->size(); ++i) {
+    EXPECT_EQ(new_tensor.data<float>()[i], tensor->data<float>()[i]);
+  }
+}
+
 TEST(QTensor, QTensorSizingTest) {
   vector<int> dims(3);
   dims[0] = 2;
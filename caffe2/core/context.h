@@ -192,6 +192,10 @@ class CAFFE2_API CPUStaticContext : public BaseStaticContext {
     return data_and_deleter;
   }
 
+  size_t Capacity(const void* data, size_t nbytes) const override {
+    return GetCPUAllocator()->Capacity(data, nbytes);
+  }
+
   std::unique_ptr<BaseContext> CreateContext() override {
     return caffe2::make_unique<CPUContext>();
   }
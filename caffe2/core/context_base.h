@@ -25,6 +25,15 @@ class CAFFE2_API BaseStaticContext {
 
   virtual std::pair<void*, MemoryDeleter> New(size_t nbytes) const = 0;
 
+  /*
+   * @brief: Returns the number of bytes usable at `data`, allocated by
+   * New(nbytes). Allocators that round sizes up can report the room after
+   * nbytes, so that tensors grow into it instead of reallocating.
+   */
+  virtual size_t Capacity(const void* /*data*/, size_t nbytes) const {
+    return nbytes;
+  }
+
   virtual std::unique_ptr<BaseContext> CreateContext() = 0;
 
   virtual std::unique_ptr<BaseContext> CreateContext(const DeviceOption&) = 0;
@@ -4,12 +4,17 @@
 #include <string>
 #include <unordered_map>
 
-#include "caffe2/core/THCCachingAllocator_gpu.h"
 #include "cub/util_allocator.cuh"
 
 // Needed to be included first to check the CAFFE2_USE_CUDNN macros.
 #include "caffe2/core/macros.h"
 
+#ifdef CAFFE2_BUILD_ATEN
+#include "THC/THCCachingAllocator.h"
+#else
+#include "caffe2/core/THCCachingAllocator_gpu.h"
+#endif
+
 #include "caffe2/core/asan.h"
 #include "caffe2/core/blob_stats.h"
 #ifdef CAFFE2_USE_CUDNN
@@ -25,7 +30,8 @@ CAFFE2_DEFINE_string(
     caffe2_cuda_memory_pool,
     "",
     "Sets the memory pool used by caffe2. Possible values are "
-    "none, cnmem, thc and cub.");
+    "none, cnmem, thc and cub. When built with ATen, thc is ATen's caching "
+    "allocator, shared with ATen tensors, and is the default.");
 
 // For description of CUB caching allocator configuration, see
 // https://nvlabs.github.io/cub/structcub_1_1_caching_device_allocator.html
@@ -70,7 +76,9 @@ CudaMemoryPoolType g_cuda_memory_pool_type;
 
 std::unique_ptr<cub::CachingDeviceAllocator> g_cub_allocator;
 
+#ifndef CAFFE2_BUILD_ATEN
 std::unique_ptr<THCCachingAllocator> g_thc_allocator;
+#endif
 
 // an unordered map that holds the map from the cuda memory pointer to the
 // device id that it is allocated from. This is used in the cuda memory pool
@@ -173,6 +181,14 @@ static void SetUpCub() {
 }
 
 static void Caffe2SetCUDAMemoryPool() {
+#ifdef CAFFE2_BUILD_ATEN
+  // ATen caches the memory of its tensors anyway. Using its allocator means
+  // one cache per process, so that memory freed by either side can be reused
+  // by the other instead of running out with half of it cached.
+  if (FLAGS_caffe2_cuda_memory_pool == "") {
+    FLAGS_caffe2_cuda_memory_pool = "thc";
+  }
+#endif
   if (FLAGS_caffe2_cuda_memory_pool == "" ||
       FLAGS_caffe2_cuda_memory_pool == "none") {
     g_cuda_memory_pool_type = CudaMemoryPoolType::NONE;
@@ -185,7 +201,9 @@ static void Caffe2SetCUDAMemoryPool() {
     SetUpCub();
   } else if (FLAGS_caffe2_cuda_memory_pool == "thc") {
     g_cuda_memory_pool_type = CudaMemoryPoolType::THC;
+#ifndef CAFFE2_BUILD_ATEN
     g_thc_allocator.reset(new THCCachingAllocator());
+#endif
   } else {
     CAFFE_THROW("Unrecognized cuda memory pool type: ",
                 FLAGS_caffe2_cuda_memory_pool);
@@ -334,7 +352,11 @@ std::pair<void*, MemoryDeleter> CUDAStaticContext::New(size_t nbytes) const {
     }
     return {ptr, Delete};
   case CudaMemoryPoolType::THC:
+#ifdef CAFFE2_BUILD_ATEN
+    ptr = THCCachingAllocator_get()->raw_allocate(nbytes);
+#else
     CUDA_ENFORCE(g_thc_allocator->Alloc(&ptr, nbytes, 0 /* stream */));
+#endif
     if (FLAGS_caffe2_gpu_memory_tracking) {
       g_size_map[ptr] = nbytes;
       g_cuda_device_affiliation[ptr] = CaffeCudaGetDevice();
@@ -387,7 +409,11 @@ void CUDAStaticContext::Delete(void* ptr) {
     break;
   }
   case CudaMemoryPoolType::THC: {
+#ifdef CAFFE2_BUILD_ATEN
+    THCCachingAllocator_get()->raw_deallocate(ptr);
+#else
     CUDA_ENFORCE(g_thc_allocator->Free(ptr));
+#endif
     if (FLAGS_caffe2_gpu_memory_tracking) {
       g_cuda_device_affiliation.erase(g_cuda_device_affiliation.find(ptr));
     }
@@ -186,6 +186,10 @@ class CAFFE2_API CUDAContext final : public BaseContext {
     return gpu_id_;
   }
 
+  inline int stream_id() const {
+    return stream_id_;
+  }
+
   inline cudaStream_t cuda_stream() {
     return cuda_stream(gpu_id_, stream_id_);
   }
@@ -7,6 +7,11 @@
 #include "caffe2/core/context_gpu.h"
 #include <gtest/gtest.h>
 
+#ifdef CAFFE2_BUILD_ATEN
+#include "ATen/ATen.h"
+#include "THC/THCCachingAllocator.h"
+#endif
+
 CAFFE2_DECLARE_bool(caffe2_cuda_full_device_control);
 
 namespace caffe2 {
@@ -84,6 +89,28 @@ TEST(CUDAContextTest, MemoryPoolAllocateDealloc) {
   }
 }
 
+#ifdef CAFFE2_BUILD_ATEN
+TEST(CUDAContextTest, MemoryPoolSharedWithATen) {
+  if (!HasCudaGPU())
+    return;
+  if (GetCudaMemoryPoolType() != CudaMemoryPoolType::THC) {
+    LOG(ERROR) << "Use the thc memory pool to test sharing it with ATen.";
+    return;
+  }
+  const int nbytes = 1048576;
+  DeviceGuard guard(0);
+  const auto before = THCCachingAllocator_currentMemoryAllocated(0);
+  auto allocated = shared_from_new(CUDAContext::New(nbytes));
+  EXPECT_EQ(THCCachingAllocator_currentMemoryAllocated(0), before + nbytes);
+  void* prev_allocated = allocated.get();
+  allocated.reset();
+  EXPECT_EQ(THCCachingAllocator_currentMemoryAllocated(0), before);
+  // The block freed by Caffe2 is reused for an ATen tensor
+  auto tensor = at::empty({nbytes}, at::TensorOptions(at::kCUDA).dtype(at::kByte));
+  EXPECT_EQ(tensor.data_ptr(), prev_allocated);
+}
+#endif
+
 cudaStream_t getStreamForHandle(cublasHandle_t handle) {
   cudaStream_t stream = nullptr;
   CUBLAS_ENFORCE(cublasGetStream(handle, &stream));
@@ -46,6 +46,15 @@ class Cursor {
    * Returns the current value.
    */
   virtual string value() = 0;
+  /**
+   * Points data and size at the current value without copying it, if the db
+   * can do that, and returns whether it did. The memory stays valid for as
+   * long as the cursor exists, not only until it moves. By default this
+   * returns false and callers should fall back to value().
+   */
+  virtual bool ValueView(const char** /*data*/, size_t* /*size*/) {
+    return false;
+  }
   /**
    * Returns whether the current location is valid - for example, if we have
    * reached the end of the database, return false.
@@ -2,6 +2,8 @@
 #include "caffe2/core/event_cpu.h"
 #include "caffe2/core/operator.h"
 
+#include <ATen/core/EventPool.h>
+
 #include <atomic>
 
 namespace caffe2 {
@@ -12,13 +14,19 @@ struct CudaEventWrapper {
         cuda_gpu_id_(option.cuda_gpu_id()),
         status_(EventStatus::EVENT_INITIALIZED) {
     CAFFE_ENFORCE(option.device_type(), CUDA);
-    DeviceGuard g(cuda_gpu_id_);
-    CUDA_ENFORCE(cudaEventCreate(
-        &cuda_event_, cudaEventDefault | cudaEventDisableTiming));
+    // The events are reused through the pool shared with ATen, since nets
+    // with many small operators create a lot of them
+    auto* pooled = at::cuda_event_pool().acquire(cuda_gpu_id_);
+    if (pooled) {
+      cuda_event_ = static_cast<cudaEvent_t>(pooled);
+    } else {
+      DeviceGuard g(cuda_gpu_id_);
+      CUDA_ENFORCE(cudaEventCreate(
+          &cuda_event_, cudaEventDefault | cudaEventDisableTiming));
+    }
   }
   ~CudaEventWrapper() {
-    DeviceGuard g(cuda_gpu_id_);
-    CUDA_CHECK(cudaEventDestroy(cuda_event_));
+    at::cuda_event_pool().release(cuda_gpu_id_, cuda_event_);
   }
 
   cudaEvent_t cuda_event_;
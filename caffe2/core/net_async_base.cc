@@ -53,6 +53,12 @@ CAFFE2_DEFINE_bool(
     false,
     "Use per net thread pools");
 
+CAFFE2_DEFINE_int(
+    caffe2_net_async_cost_based_chains,
+    0,
+    "If positive, merge chains based on estimated operator costs, aiming at"
+    " this many tasks per net, and schedule the critical path first");
+
 namespace caffe2 {
 
 thread_local std::vector<int> AsyncNetBase::stream_counters_;
@@ -70,10 +76,18 @@ AsyncNetBase::AsyncNetBase(
     operators_.push_back(op_ptr);
   }
 
-  execution_chains_ = dag_utils::computeChains(operator_nodes_);
-  chains_.reserve(execution_chains_.size());
-  for (const auto& kv : execution_chains_) {
-    chains_.push_back(kv.second);
+  if (FLAGS_caffe2_net_async_cost_based_chains > 0) {
+    auto op_costs = dag_utils::estimateOperatorCosts(*net_def, ws);
+    execution_chains_ = dag_utils::computeCostBasedChains(
+        operator_nodes_, op_costs, FLAGS_caffe2_net_async_cost_based_chains);
+    chains_ = dag_utils::orderChainsByCriticalPath(
+        execution_chains_, operator_nodes_, op_costs);
+  } else {
+    execution_chains_ = dag_utils::computeChains(operator_nodes_);
+    chains_.reserve(execution_chains_.size());
+    for (const auto& kv : execution_chains_) {
+      chains_.push_back(kv.second);
+    }
   }
   chain_nodes_ = dag_utils::prepareChainGraphNodes(operator_nodes_, chains_);
 
@@ -22,6 +22,7 @@ CAFFE2_DECLARE_int(caffe2_net_async_cpu_pool_size);
 CAFFE2_DECLARE_bool(caffe2_net_async_check_stream_status);
 CAFFE2_DECLARE_bool(caffe2_net_async_use_single_pool);
 CAFFE2_DECLARE_bool(caffe2_net_async_use_per_net_pools);
+CAFFE2_DECLARE_int(caffe2_net_async_cost_based_chains);
 
 namespace caffe2 {
 
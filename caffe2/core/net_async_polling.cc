@@ -5,12 +5,18 @@
 
 CAFFE2_DECLARE_bool(caffe2_dag_net_collect_stats);
 
+CAFFE2_DEFINE_int(
+    caffe2_net_async_polling_wait_us,
+    50,
+    "Longest time the polling net sleeps when no task made progress, before"
+    " querying the device events again; 0 polls without sleeping");
+
 namespace caffe2 {
 
 AsyncPollingNet::AsyncPollingNet(
     const std::shared_ptr<const NetDef>& net_def,
     Workspace* ws)
-    : AsyncNetBase(net_def, ws), running_(false) {
+    : AsyncNetBase(net_def, ws), running_(false), finished_runs_(0) {
   task_timers_.resize(tasksNum());
   for (auto task_id = 0; task_id < tasksNum(); ++task_id) {
     task_timers_[task_id] = caffe2::make_unique<Timer>();
@@ -78,9 +84,30 @@ void AsyncPollingNet::schedule(int task_id) {
     } catch (const std::exception&) {
       has_chain_failed_ = true;
     }
+
+    {
+      std::unique_lock<std::mutex> lock(poll_mutex_);
+      ++finished_runs_;
+    }
+    poll_cv_.notify_one();
   });
 }
 
+void AsyncPollingNet::waitForProgress(uint64_t finished_runs) {
+  // Tasks notify when they have finished running, which is when CPU events
+  // complete and GPU events are recorded. GPU events completing on the device
+  // don't notify, so they are picked up by querying them again after at most
+  // caffe2_net_async_polling_wait_us.
+  if (FLAGS_caffe2_net_async_polling_wait_us <= 0) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(poll_mutex_);
+  poll_cv_.wait_for(
+      lock,
+      std::chrono::microseconds(FLAGS_caffe2_net_async_polling_wait_us),
+      [this, finished_runs]() { return finished_runs_ != finished_runs; });
+}
+
 void AsyncPollingNet::reset() {
   status_.clear();
   status_.resize(tasksNum(), EventStatus::EVENT_INITIALIZED);
@@ -108,6 +135,11 @@ bool AsyncPollingNet::pollAndSchedule() {
     if (FLAGS_caffe2_dag_net_collect_stats) {
       timer.Start();
     }
+    uint64_t finished_runs;
+    {
+      std::unique_lock<std::mutex> lock(poll_mutex_);
+      finished_runs = finished_runs_;
+    }
     if (has_chain_failed_) {
       finishTasks(current_tasks);
       return false;
@@ -159,6 +191,11 @@ bool AsyncPollingNet::pollAndSchedule() {
       }
     }
 
+    // Sleep instead of spinning until something changes
+    if (updated_tasks.empty() && !next_tasks.empty()) {
+      waitForProgress(finished_runs);
+    }
+
     current_tasks.swap(next_tasks);
   }
   return true;
@@ -40,6 +40,14 @@ class AsyncPollingNet : public AsyncNetBase {
   void reset() override;
   std::atomic<bool> has_chain_failed_;
 
+  // Number of tasks that have finished running, to wake up the polling loop
+  std::mutex poll_mutex_;
+  std::condition_variable poll_cv_;
+  uint64_t finished_runs_;
+  // Blocks until a task finishes running after finished_runs_ was
+  // `finished_runs`, or for at most caffe2_net_async_polling_wait_us
+  void waitForProgress(uint64_t finished_runs);
+
   AT_DISABLE_COPY_AND_ASSIGN(AsyncPollingNet);
 };
 
@@ -9,10 +9,19 @@ CAFFE2_DEFINE_bool(
 
 namespace caffe2 {
 
+namespace {
+// Bounds the recursion of inline continuations, deeper ones are enqueued
+constexpr int kMaxInlineContinuationDepth = 64;
+thread_local int inline_continuation_depth = 0;
+} // namespace
+
 AsyncSchedulingNet::AsyncSchedulingNet(
     const std::shared_ptr<const NetDef>& net_def,
     Workspace* ws)
-    : AsyncNetBase(net_def, ws), running_(false), use_dfs_scheduling_(false) {
+    : AsyncNetBase(net_def, ws),
+      running_(false),
+      use_dfs_scheduling_(false),
+      inline_continuations_(false) {
   for (int arg_idx = 0; arg_idx < net_def->arg_size(); ++arg_idx) {
     auto& arg = net_def->arg(arg_idx);
     if (arg.has_name() && arg.name() == "deferrable_mode") {
@@ -35,6 +44,13 @@ void AsyncSchedulingNet::Wait() {
   }
 }
 
+void AsyncSchedulingNet::enqueue(
+    int task_id,
+    const std::function<void()>& func) {
+  const auto& device_option = event(task_id).GetDeviceOption();
+  pool(device_option)->run(func);
+}
+
 void AsyncSchedulingNet::schedule(int task_id, bool run_inline) {
   if (!testAndSetScheduled(task_id)) {
     return;
@@ -50,6 +66,20 @@ void AsyncSchedulingNet::schedule(int task_id, bool run_inline) {
       }
     }
 
+    // with inline continuations the first ready child is kept back and run
+    // on this thread once the task is done, the others are enqueued
+    int continuation_id = -1;
+    auto schedule_child = [this, &continuation_id](int child_id) {
+      if (inline_continuations_ && !use_dfs_scheduling_ &&
+          continuation_id < 0) {
+        continuation_id = child_id;
+      } else {
+        // if DFS scheduling is enabled, run children inline,
+        // ignore DFS scheduling in callbacks
+        schedule(child_id, use_dfs_scheduling_);
+      }
+    };
+
     for (auto child_id : children(task_id)) {
       int parent_count = updateParentCount(child_id);
       if (parent_count == 0) {
@@ -61,9 +91,7 @@ void AsyncSchedulingNet::schedule(int task_id, bool run_inline) {
         // - in all other cases, check parents with canSchedule
         if (!success_ || always_schedule_child_ || finish_chain_ ||
             canSchedule(child_id)) {
-          // if DFS scheduling is enabled, run children inline,
-          // ignore DFS scheduling in callbacks
-          schedule(child_id, use_dfs_scheduling_);
+          schedule_child(child_id);
         } else {
           bool parent_failed = false;
           bool parent_needs_polling = false;
@@ -102,13 +130,13 @@ void AsyncSchedulingNet::schedule(int task_id, bool run_inline) {
           if (parent_failed) {
             // one of parents failed, set failure flag and wrap up execution
             success_ = false;
-            schedule(child_id, use_dfs_scheduling_);
+            schedule_child(child_id);
           } else if (parent_needs_polling) {
             // some parents are blocking us from scheduling a child and don't
             // support callbacks, using polling
-            const auto& child_device_option = event(child_id).GetDeviceOption();
-            pool(child_device_option)
-                ->run(std::bind(
+            enqueue(
+                child_id,
+                std::bind(
                     &AsyncSchedulingNet::pollAndSchedule, this, child_id));
           } else if (!parents_with_callback.empty()) {
             // some parents are blocking us from scheduling a child and they
@@ -119,7 +147,7 @@ void AsyncSchedulingNet::schedule(int task_id, bool run_inline) {
             }
           } else {
             // we're ready to schedule a child
-            schedule(child_id, use_dfs_scheduling_);
+            schedule_child(child_id);
           }
         }
       }
@@ -151,13 +179,23 @@ void AsyncSchedulingNet::schedule(int task_id, bool run_inline) {
     if (cur_processed_tasks == tasks_num) {
       finishRun();
     }
+
+    // the continuation is not processed yet, so the net can't have finished
+    if (continuation_id >= 0) {
+      if (inline_continuation_depth < kMaxInlineContinuationDepth) {
+        ++inline_continuation_depth;
+        schedule(continuation_id, /* run_inline */ true);
+        --inline_continuation_depth;
+      } else {
+        schedule(continuation_id);
+      }
+    }
   };
 
   if (run_inline) {
     schedule_func();
   } else {
-    const auto& device_option = event(task_id).GetDeviceOption();
-    pool(device_option)->run(schedule_func);
+    enqueue(task_id, schedule_func);
   }
 }
 
@@ -188,9 +226,9 @@ void AsyncSchedulingNet::pollAndSchedule(int task_id) {
   if (can_schedule || !success_ || parent_failed) {
     schedule(task_id);
   } else {
-    const auto& device_option = event(task_id).GetDeviceOption();
-    pool(device_option)
-        ->run(std::bind(&AsyncSchedulingNet::pollAndSchedule, this, task_id));
+    enqueue(
+        task_id,
+        std::bind(&AsyncSchedulingNet::pollAndSchedule, this, task_id));
   }
 }
 
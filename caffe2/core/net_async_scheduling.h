@@ -22,11 +22,16 @@ class AsyncSchedulingNet : public AsyncNetBase {
   void reset() override;
   virtual void finishRun();
   void parentCallback(int parent_id);
+  // Hands a task's scheduling function over to a thread pool
+  virtual void enqueue(int task_id, const std::function<void()>& func);
 
   std::mutex running_mutex_;
   std::condition_variable running_cv_;
   std::atomic<bool> running_;
   bool use_dfs_scheduling_;
+  // Run one ready child inline once its parent is done, instead of going
+  // through the pool
+  bool inline_continuations_;
 
   std::atomic<int> processed_tasks_num_;
 
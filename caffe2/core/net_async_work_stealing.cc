@@ -0,0 +1,43 @@
+#include "caffe2/core/net_async_work_stealing.h"
+
+namespace caffe2 {
+
+AsyncWorkStealingNet::AsyncWorkStealingNet(
+    const std::shared_ptr<const NetDef>& net_def,
+    Workspace* ws)
+    : AsyncSchedulingNet(net_def, ws) {
+  inline_continuations_ = true;
+
+  // the pool is shared, so only the first net of the workspace decides its
+  // size
+  int pool_size = num_workers_;
+  if (pool_size <= 0) {
+    pool_size = FLAGS_caffe2_net_async_cpu_pool_size;
+  }
+  if (pool_size <= 0) {
+    pool_size = std::thread::hardware_concurrency();
+    CAFFE_ENFORCE(pool_size > 0, "Failed to get number of CPU cores");
+  }
+  ws_pool_ = ws->GetWorkStealingThreadPool(pool_size);
+}
+
+void AsyncWorkStealingNet::enqueue(
+    int task_id,
+    const std::function<void()>& func) {
+  const auto& device_option = event(task_id).GetDeviceOption();
+  int numa_node_id = -1;
+  if (device_option.device_type() == CPU) {
+    numa_node_id = device_option.numa_node_id();
+  }
+  ws_pool_->run(func, numa_node_id);
+}
+
+AsyncWorkStealingNet::~AsyncWorkStealingNet() {
+  // wait while the pool is still referenced, the base class waits again
+  // after ws_pool_ is gone
+  Wait();
+}
+
+REGISTER_NET(async_work_stealing, AsyncWorkStealingNet);
+
+} // namespace caffe2
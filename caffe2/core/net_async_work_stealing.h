@@ -0,0 +1,30 @@
+#ifndef CAFFE2_CORE_NET_ASYNC_WORK_STEALING_H_
+#define CAFFE2_CORE_NET_ASYNC_WORK_STEALING_H_
+
+#include "caffe2/core/net_async_scheduling.h"
+#include "caffe2/utils/work_stealing_thread_pool.h"
+
+namespace caffe2 {
+
+// async_scheduling on a WorkStealingThreadPool shared by all nets of the
+// workspace: tasks scheduled from a worker stay on that worker's deque, the
+// first ready child of a finished chain runs inline on the same thread, and
+// CPU chains are submitted to workers on their NUMA node.
+class AsyncWorkStealingNet : public AsyncSchedulingNet {
+ public:
+  AsyncWorkStealingNet(
+      const std::shared_ptr<const NetDef>& net_def,
+      Workspace* ws);
+  ~AsyncWorkStealingNet() override;
+
+ protected:
+  void enqueue(int task_id, const std::function<void()>& func) override;
+
+  std::shared_ptr<WorkStealingThreadPool> ws_pool_;
+
+  AT_DISABLE_COPY_AND_ASSIGN(AsyncWorkStealingNet);
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_CORE_NET_ASYNC_WORK_STEALING_H_
@@ -1,5 +1,6 @@
 #include "caffe2/core/net_dag_utils.h"
 
+#include <algorithm>
 #include <set>
 #include <stack>
 #include <unordered_map>
@@ -118,6 +119,24 @@ void updateOperatorNodes(
     node.scheduled_.clear();
   }
 }
+
+// The cost of the most expensive path from every operator to the end of the
+// net, including the operator itself. Operators only depend on operators
+// that come before them in the net, so one backwards pass is enough.
+std::vector<float> bottomLevels(
+    const std::vector<OperatorNode>& nodes,
+    const std::vector<float>& op_costs) {
+  std::vector<float> levels(nodes.size(), 0);
+  for (int idx = (int)nodes.size() - 1; idx >= 0; --idx) {
+    float max_child_level = 0;
+    for (auto child : nodes[idx].children_) {
+      CAFFE_ENFORCE_GT(child, idx, "Operators are not in topological order");
+      max_child_level = std::max(max_child_level, levels[child]);
+    }
+    levels[idx] = op_costs[idx] + max_child_level;
+  }
+  return levels;
+}
 } // namespace
 
 ExecutionChains computeChains(std::vector<OperatorNode>& orig_nodes) {
@@ -287,6 +306,173 @@ ExecutionChains singleChains(std::vector<OperatorNode>& nodes) {
   return chains;
 }
 
+std::vector<float> estimateOperatorCosts(const NetDef& net_def, Workspace* ws) {
+  for (const auto& arg : net_def.arg()) {
+    if (arg.has_name() && arg.name() == "op_costs") {
+      CAFFE_ENFORCE_EQ(
+          arg.floats_size(),
+          net_def.op_size(),
+          "op_costs should have one float per operator");
+      return std::vector<float>(arg.floats().begin(), arg.floats().end());
+    }
+  }
+
+  std::unordered_map<std::string, TensorShape> blob_shapes;
+  try {
+    NetDef net_def_copy(net_def);
+    auto shapes = InferBlobShapesAndTypesFromWorkspace(ws, {&net_def_copy});
+    for (const auto& shape : shapes.shapes()) {
+      if (!shape.unknown_shape()) {
+        blob_shapes[shape.name()] = shape;
+      }
+    }
+  } catch (const std::exception& e) {
+    VLOG(1) << "Shape inference failed, estimating op costs without shapes: "
+            << e.what();
+  }
+
+  std::vector<float> op_costs(net_def.op_size(), -1);
+  float known_costs_sum = 0;
+  int known_costs_num = 0;
+  for (int idx = 0; idx < net_def.op_size(); ++idx) {
+    const auto& op_def = net_def.op(idx);
+    const auto* schema = OpSchemaRegistry::Schema(op_def.type());
+    if (!schema || !schema->HasCostInferenceFunction()) {
+      continue;
+    }
+    std::vector<TensorShape> input_shapes;
+    for (const auto& input : op_def.input()) {
+      auto it = blob_shapes.find(input);
+      if (it == blob_shapes.end()) {
+        break;
+      }
+      input_shapes.push_back(it->second);
+    }
+    if ((int)input_shapes.size() != op_def.input_size()) {
+      continue;
+    }
+    try {
+      auto cost = schema->InferCost(op_def, input_shapes);
+      // memory bound operators do few flops, so count the bytes too
+      op_costs[idx] =
+          float(cost.flops) + float(cost.bytes_read + cost.bytes_written);
+      known_costs_sum += op_costs[idx];
+      ++known_costs_num;
+    } catch (const std::exception& e) {
+      VLOG(1) << "Cost inference failed for " << op_def.type() << ": "
+              << e.what();
+    }
+  }
+
+  float default_cost =
+      known_costs_num > 0 ? known_costs_sum / known_costs_num : 1;
+  for (auto& cost : op_costs) {
+    if (cost < 0) {
+      cost = default_cost;
+    }
+  }
+  return op_costs;
+}
+
+ExecutionChains computeCostBasedChains(
+    std::vector<OperatorNode>& nodes,
+    const std::vector<float>& op_costs,
+    int num_tasks) {
+  CAFFE_ENFORCE_EQ(op_costs.size(), nodes.size());
+  CAFFE_ENFORCE_GT(num_tasks, 0);
+  ExecutionChains chains = computeChains(nodes);
+
+  float total_cost = 0;
+  for (auto cost : op_costs) {
+    total_cost += cost;
+  }
+  const float target_cost = total_cost / num_tasks;
+  const auto levels = bottomLevels(nodes, op_costs);
+
+  std::vector<int> heads;
+  for (const auto& kv : chains) {
+    heads.push_back(kv.first);
+  }
+  std::sort(heads.begin(), heads.end());
+
+  for (auto head : heads) {
+    auto chain_it = chains.find(head);
+    if (chain_it == chains.end()) {
+      // already appended to another chain
+      continue;
+    }
+    auto& chain = chain_it->second;
+    float chain_cost = 0;
+    for (auto op_idx : chain) {
+      chain_cost += op_costs[op_idx];
+    }
+
+    while (true) {
+      const int tail = chain.back();
+      const auto& tail_op = nodes[tail].operator_;
+      int best_head = -1;
+      float best_cost = 0;
+      for (auto child : nodes[tail].children_) {
+        auto child_it = chains.find(child);
+        // Only chains that depend on nothing but the tail can be appended
+        // without delaying the chain on other dependencies (or creating
+        // cycles); the same device rules as in computeChains apply.
+        if (child_it == chains.end() || nodes[child].parents_.size() != 1 ||
+            !IsSameDevice(
+                tail_op->device_option(),
+                nodes[child].operator_->device_option()) ||
+            (tail_op->HasAsyncPart() &&
+             !nodes[child].operator_->SupportsAsyncScheduling())) {
+          continue;
+        }
+        float child_cost = 0;
+        for (auto op_idx : child_it->second) {
+          child_cost += op_costs[op_idx];
+        }
+        if (chain_cost + child_cost > target_cost) {
+          continue;
+        }
+        if (best_head < 0 || levels[child] > levels[best_head]) {
+          best_head = child;
+          best_cost = child_cost;
+        }
+      }
+      if (best_head < 0) {
+        break;
+      }
+      auto& appended = chains[best_head];
+      chain.insert(chain.end(), appended.begin(), appended.end());
+      chain_cost += best_cost;
+      chains.erase(best_head);
+    }
+  }
+
+  updateOperatorNodes(nodes, chains);
+  return chains;
+}
+
+std::vector<std::vector<int>> orderChainsByCriticalPath(
+    const ExecutionChains& chains,
+    const std::vector<OperatorNode>& nodes,
+    const std::vector<float>& op_costs) {
+  const auto levels = bottomLevels(nodes, op_costs);
+  std::vector<std::vector<int>> ordered;
+  ordered.reserve(chains.size());
+  for (const auto& kv : chains) {
+    ordered.push_back(kv.second);
+  }
+  std::sort(
+      ordered.begin(),
+      ordered.end(),
+      [&levels](const std::vector<int>& a, const std::vector<int>& b) {
+        if (levels[a.front()] != levels[b.front()]) {
+          return levels[a.front()] > levels[b.front()];
+        }
+        return a.front() < b.front();
+      });
+  return ordered;
+}
+
 std::vector<OperatorNode> prepareOperatorNodes(
     const std::shared_ptr<const NetDef>& net_def,
     Workspace* ws) {
@@ -423,6 +609,12 @@ std::vector<OpGraphNode> prepareChainGraphNodes(
     }
   }
 
+  // Children in task order, so that when tasks are ordered by priority
+  // (see orderChainsByCriticalPath) they are scheduled by priority too
+  for (auto& chain : chain_nodes) {
+    std::sort(chain.children_.begin(), chain.children_.end());
+  }
+
   return chain_nodes;
 }
 
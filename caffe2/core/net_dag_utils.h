@@ -47,6 +47,37 @@ ExecutionChains computeChains(std::vector<OperatorNode>& orig_nodes);
 
 ExecutionChains singleChains(std::vector<OperatorNode>& nodes);
 
+/**
+ * Estimated cost of every operator of the net, in arbitrary but consistent
+ * units. Observed run times (e.g. TimeObserver averages) can be passed in
+ * the "op_costs" net argument, one float per operator; otherwise the costs
+ * come from OpSchema cost inference on the blob shapes inferred from the
+ * workspace, and operators without a cost function get the average cost.
+ */
+std::vector<float> estimateOperatorCosts(const NetDef& net_def, Workspace* ws);
+
+/**
+ * Like computeChains, but then appends the chains hanging off a chain's last
+ * operator to that chain while the total stays under the target cost of
+ * total_cost / num_tasks, so that cheap operators don't end up as separate
+ * tasks. Of the candidates, the one on the most expensive path to the end
+ * of the net goes first.
+ */
+ExecutionChains computeCostBasedChains(
+    std::vector<OperatorNode>& nodes,
+    const std::vector<float>& op_costs,
+    int num_tasks);
+
+/**
+ * The chains ordered by the cost of the most expensive path from their first
+ * operator to the end of the net, so that when tasks are numbered in this
+ * order the critical path is scheduled first.
+ */
+std::vector<std::vector<int>> orderChainsByCriticalPath(
+    const ExecutionChains& chains,
+    const std::vector<OperatorNode>& nodes,
+    const std::vector<float>& op_costs);
+
 std::vector<OperatorNode> prepareOperatorNodes(
     const std::shared_ptr<const NetDef>& net_def,
     Workspace* ws);
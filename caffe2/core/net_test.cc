@@ -1,7 +1,9 @@
 #include <gtest/gtest.h>
 #include "caffe2/core/net.h"
 #include "caffe2/core/net_async_scheduling.h"
+#include "caffe2/core/net_async_work_stealing.h"
 #include "caffe2/core/net_dag.h"
+#include "caffe2/core/net_dag_utils.h"
 #include "caffe2/core/operator.h"
 #include "caffe2/core/scope_guard.h"
 
@@ -718,6 +720,120 @@ TEST(NetTest, AsyncEmptyNet) {
   }
 }
 
+TEST(NetTest, AsyncWorkStealingSharedPool) {
+  const auto spec = R"DOC(
+        name: "example"
+        type: "async_work_stealing"
+        num_workers: 4
+        external_input: "in"
+        op {
+          input: "in"
+          output: "hidden_1"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "in"
+          output: "hidden_2"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "in"
+          output: "hidden_3"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "hidden_1"
+          input: "hidden_2"
+          input: "hidden_3"
+          output: "out"
+          type: "NetTestDummy"
+        }
+  )DOC";
+
+  Workspace ws;
+  ws.CreateBlob("in");
+  NetDef net_def;
+  CAFFE_ENFORCE(
+      ::google::protobuf::TextFormat::ParseFromString(spec, &net_def));
+
+  std::unique_ptr<NetBase> net1(CreateNet(net_def, &ws));
+  std::unique_ptr<NetBase> net2(CreateNet(net_def, &ws));
+  ASSERT_TRUE(
+      caffe2::dynamic_cast_if_rtti<AsyncWorkStealingNet*>(net1.get()) !=
+      nullptr);
+  // both nets run on the same pool
+  ASSERT_EQ(ws.GetWorkStealingThreadPool(1)->size(), 4U);
+
+  counter.exchange(0);
+  const int kIters = 100;
+  for (int i = 0; i < kIters; ++i) {
+    ASSERT_TRUE(net1->RunAsync());
+    ASSERT_TRUE(net2->RunAsync());
+    net1->Wait();
+    net2->Wait();
+  }
+  ASSERT_EQ(counter.load(), 2 * 4 * kIters);
+}
+
+TEST(NetTest, CostBasedChains) {
+  // a fork of a cheap, an expensive and another cheap operator
+  const auto spec = R"DOC(
+        name: "example"
+        type: "async_scheduling"
+        external_input: "in"
+        op {
+          input: "in"
+          output: "hidden"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "hidden"
+          output: "out1"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "hidden"
+          output: "out2"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "hidden"
+          output: "out3"
+          type: "NetTestDummy"
+        }
+        arg {
+          name: "op_costs"
+          floats: 1
+          floats: 1
+          floats: 10
+          floats: 1
+        }
+  )DOC";
+
+  Workspace ws;
+  ws.CreateBlob("in");
+  auto net_def = std::make_shared<NetDef>();
+  CAFFE_ENFORCE(
+      ::google::protobuf::TextFormat::ParseFromString(spec, net_def.get()));
+
+  auto nodes = dag_utils::prepareOperatorNodes(net_def, &ws);
+  auto op_costs = dag_utils::estimateOperatorCosts(*net_def, &ws);
+  ASSERT_EQ(op_costs, std::vector<float>({1, 1, 10, 1}));
+
+  // structurally every operator is its own chain
+  ASSERT_EQ(dag_utils::computeChains(nodes).size(), 4U);
+
+  // with a target cost of 13 / 2, only one of the cheap operators can be
+  // appended to the first chain, the expensive one is left alone
+  auto chains = dag_utils::computeCostBasedChains(nodes, op_costs, 2);
+  dag_utils::ExecutionChains expected{{0, {0, 1}}, {2, {2}}, {3, {3}}};
+  ASSERT_EQ(chains, expected);
+
+  // the chain leading to the expensive operator comes first
+  auto ordered = dag_utils::orderChainsByCriticalPath(chains, nodes, op_costs);
+  ASSERT_EQ(ordered, std::vector<std::vector<int>>({{0, 1}, {2}, {3}}));
+}
+
 TEST(NetTest, DISABLED_RunAsyncFailure) {
   const auto spec = R"DOC(
         name: "example"
@@ -491,9 +491,10 @@ class CAFFE2_API Operator : public OperatorBase {
   // non-async executors that do not rely on events
   bool Run(int stream_id = 0) final {
     try {
+      // switch first, so that observers can record events on the stream
+      context_.SwitchToDevice(stream_id);
       StartAllObservers();
 
-      context_.SwitchToDevice(stream_id);
       bool result = RunOnDevice();
       if (!result) {
         this->RecordLastFailedOpNetPosition();
@@ -521,9 +522,9 @@ class CAFFE2_API Operator : public OperatorBase {
 
   bool RunAsync(int stream_id = 0) final {
     try {
+      context_.SwitchToDevice(stream_id);
       StartAllObservers();
 
-      context_.SwitchToDevice(stream_id);
       auto result = RunOnDevice();
       if (result) {
         if (HasAsyncPart()) {
@@ -1,6 +1,8 @@
 #include "caffe2/core/plan_executor.h"
 
 #include <condition_variable>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -145,6 +147,70 @@ struct WorkspaceIdInjector {
 const string WorkspaceIdInjector::NODE_ID = "NODE_ID";
 const string WorkspaceIdInjector::GLOBAL_WORKSPACE_ID = "GLOBAL_WORKSPACE_ID";
 
+/**
+ * Threads running the concurrent substeps of a plan, kept for the whole plan
+ * so that plans with many short concurrent steps don't create and join
+ * threads on every iteration.
+ *
+ * Concurrent substeps may block on each other (e.g. a reader and a trainer
+ * sharing a queue), so every task gets a thread of its own: idle threads are
+ * reused, and a new thread is started when all of them are busy.
+ */
+class StepThreadPool {
+ public:
+  StepThreadPool() {}
+
+  ~StepThreadPool() {
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  void run(std::function<void()> task) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    tasks_.push_back(std::move(task));
+    if (idle_ > 0) {
+      --idle_;
+      cv_.notify_one();
+    } else {
+      threads_.emplace_back([this]() { workerLoop(); });
+    }
+  }
+
+ private:
+  void workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      cv_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+      if (tasks_.empty()) {
+        return;
+      }
+      auto task = std::move(tasks_.front());
+      tasks_.pop_front();
+      lock.unlock();
+      // Exceptions escaping the task abort the process, like they did when
+      // the substeps had threads of their own
+      task();
+      lock.lock();
+      ++idle_;
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> tasks_;
+  std::vector<std::thread> threads_;
+  size_t idle_{0};
+  bool stop_{false};
+
+  AT_DISABLE_COPY_AND_ASSIGN(StepThreadPool);
+};
+
 struct CompiledExecutionStep;
 
 /**
@@ -172,12 +238,14 @@ struct ExecutionStepWrapper {
       Workspace* externalWorkspace,
       ShouldContinue externalShouldContinue,
       NetDefMap* netDefs,
-      WorkspaceIdInjector* ws_id_injector)
+      WorkspaceIdInjector* ws_id_injector,
+      StepThreadPool* threadPool)
       : step_(step),
         externalWorkspace_(externalWorkspace),
         externalShouldContinue_(externalShouldContinue),
         netDefs_(netDefs),
-        ws_id_injector_(ws_id_injector) {
+        ws_id_injector_(ws_id_injector),
+        threadPool_(threadPool) {
     // If this execution step does not create a child workspace,
     // then just eagerly-compile it. This will trigger CreateNet on the
     // nets used by this execution step.
@@ -212,6 +280,10 @@ struct ExecutionStepWrapper {
     return *step_;
   }
 
+  StepThreadPool* threadPool() {
+    return threadPool_;
+  }
+
   CompiledGuard compiled() {
     CompiledGuard guard;
     if (compiledStep_) {
@@ -231,6 +303,7 @@ struct ExecutionStepWrapper {
   NetDefMap* netDefs_;
   std::unique_ptr<CompiledExecutionStep> compiledStep_;
   WorkspaceIdInjector* ws_id_injector_;
+  StepThreadPool* threadPool_;
 };
 
 struct CompiledExecutionStep {
@@ -241,7 +314,8 @@ struct CompiledExecutionStep {
       Workspace* externalWorkspace,
       ShouldContinue externalShouldContinue,
       NetDefMap* netDefs,
-      WorkspaceIdInjector* ws_id_injector)
+      WorkspaceIdInjector* ws_id_injector,
+      StepThreadPool* threadPool)
       : step(mainStep) {
     if (mainStep->create_workspace()) {
       localWorkspace_.reset(new Workspace(externalWorkspace));
@@ -286,7 +360,12 @@ struct CompiledExecutionStep {
 
       for (const auto& ss : step->substep()) {
         auto compiledSubstep = std::make_shared<ExecutionStepWrapper>(
-            &ss, workspace, substepShouldContinue, netDefs, ws_id_injector);
+            &ss,
+            workspace,
+            substepShouldContinue,
+            netDefs,
+            ws_id_injector,
+            threadPool);
         if (ss.has_run_every_ms()) {
           reportSubsteps.push_back(compiledSubstep);
         } else {
@@ -342,7 +421,8 @@ std::unique_ptr<CompiledExecutionStep> ExecutionStepWrapper::doCompile() {
       externalWorkspace_,
       externalShouldContinue_,
       netDefs_,
-      ws_id_injector_));
+      ws_id_injector_,
+      threadPool_));
 }
 
 #define CHECK_SHOULD_STOP(step, shouldStop)                       \
@@ -431,16 +511,28 @@ bool ExecuteStepRecursive(ExecutionStepWrapper& stepWrapper) {
           }
         };
 
-        std::vector<std::thread> threads;
         auto numThreads = compiledStep->recurringSubsteps.size();
         if (step.has_num_concurrent_instances()) {
           numThreads *= step.num_concurrent_instances();
         }
+        // Wait for the workers with a counter rather than by joining threads,
+        // the threads are kept by the plan for the next iterations
+        std::mutex done_mutex;
+        std::condition_variable done_cv;
+        size_t running = numThreads;
         for (size_t i = 0; i < numThreads; ++i) {
-          threads.emplace_back(worker);
+          stepWrapper.threadPool()->run([&]() {
+            worker();
+            // Notify under the lock, the waiter destroys done_cv as soon as
+            // it sees running == 0
+            std::lock_guard<std::mutex> guard(done_mutex);
+            --running;
+            done_cv.notify_all();
+          });
         }
-        for (auto& thread : threads) {
-          thread.join();
+        {
+          std::unique_lock<std::mutex> lock(done_mutex);
+          done_cv.wait(lock, [&]() { return running == 0; });
         }
         if (compiledStep->gotFailure) {
           LOG(ERROR) << "One of the workers failed.";
@@ -499,11 +591,12 @@ bool RunPlanOnWorkspace(
     net_defs[net_def.name()] = NetDefInfo{&net_def, netAlreadyExists};
   }
   WorkspaceIdInjector ws_id_injector;
+  StepThreadPool threadPool;
   Timer plan_timer;
   for (const ExecutionStep& step : plan.execution_step()) {
     Timer step_timer;
     ExecutionStepWrapper stepWrapper(
-        &step, ws, shouldContinue, &net_defs, &ws_id_injector);
+        &step, ws, shouldContinue, &net_defs, &ws_id_injector, &threadPool);
     if (!ExecuteStepRecursive(stepWrapper)) {
       LOG(ERROR) << "Failed initializing step " << step.name();
       return false;
@@ -0,0 +1,240 @@
+#include "caffe2/core/prefetching_cursor.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <random>
+
+#include "caffe2/core/logging.h"
+
+namespace caffe2 {
+namespace db {
+
+PrefetchingCursor::PrefetchingCursor(DB* db, const Options& options)
+    : options_(options), indexed_(false), epoch_(0), stopping_(false) {
+  CAFFE_ENFORCE(db, "Passed null db");
+  CAFFE_ENFORCE_GT(options_.num_threads, 0);
+  CAFFE_ENFORCE_GT(options_.buffer_size, 0);
+  CAFFE_ENFORCE_GE(options_.num_shards, 1);
+  CAFFE_ENFORCE_GE(options_.shard_id, 0);
+  CAFFE_ENFORCE_LT(options_.shard_id, options_.num_shards);
+
+  cursors_.push_back(db->NewCursor());
+  indexed_ = cursors_[0]->SupportsSeek();
+  if (indexed_) {
+    BuildIndex();
+    for (int i = 1; i < options_.num_threads; ++i) {
+      cursors_.push_back(db->NewCursor());
+    }
+  } else {
+    CAFFE_ENFORCE(
+        !options_.shuffle,
+        "Shuffling needs a db that supports seeking to a key.");
+    // Some dbs, e.g. minidb, only allow a single cursor at a time, and
+    // without seeking a single thread has to read the records in order
+    // anyway.
+    VLOG(1) << "The db does not support seeking, prefetching on one thread.";
+  }
+  Start();
+}
+
+PrefetchingCursor::~PrefetchingCursor() {
+  Stop();
+}
+
+void PrefetchingCursor::Seek(const string& /*key*/) {
+  CAFFE_THROW("PrefetchingCursor does not support seeking to a key.");
+}
+
+void PrefetchingCursor::SeekToFirst() {
+  Stop();
+  ++epoch_;
+  Start();
+}
+
+void PrefetchingCursor::Next() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    WaitForCurrent(lock);
+    if (position_ >= end_) {
+      return;
+    }
+    buffer_[position_ % buffer_.size()] = Record();
+    ++position_;
+  }
+  consumed_.notify_all();
+}
+
+string PrefetchingCursor::key() {
+  return Current().key;
+}
+
+string PrefetchingCursor::value() {
+  const auto& record = Current();
+  if (record.data) {
+    return string(record.data, record.size);
+  }
+  return record.value;
+}
+
+bool PrefetchingCursor::ValueView(const char** data, size_t* size) {
+  const auto& record = Current();
+  if (!record.data) {
+    return false;
+  }
+  *data = record.data;
+  *size = record.size;
+  return true;
+}
+
+bool PrefetchingCursor::Valid() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  WaitForCurrent(lock);
+  return position_ < end_;
+}
+
+void PrefetchingCursor::BuildIndex() {
+  // Only the keys are read here, for LMDB the values are not even touched.
+  auto* cursor = cursors_[0].get();
+  cursor->SeekToFirst();
+  Skip(cursor, options_.shard_id);
+  while (cursor->Valid()) {
+    keys_.push_back(cursor->key());
+    Skip(cursor, options_.num_shards);
+  }
+  order_.resize(keys_.size());
+  VLOG(1) << "Indexed " << keys_.size() << " records of shard "
+          << options_.shard_id << " of " << options_.num_shards;
+}
+
+void PrefetchingCursor::Start() {
+  position_ = 0;
+  next_ = 0;
+  end_ = indexed_ ? order_.size() : std::numeric_limits<size_t>::max();
+  stopping_ = false;
+  error_ = nullptr;
+  buffer_.assign(options_.buffer_size, Record());
+  if (indexed_) {
+    std::iota(order_.begin(), order_.end(), 0);
+    if (options_.shuffle) {
+      std::mt19937 gen(options_.seed + epoch_);
+      std::shuffle(order_.begin(), order_.end(), gen);
+    }
+  }
+  for (int i = 0; i < cursors_.size(); ++i) {
+    threads_.emplace_back(&PrefetchingCursor::ReadLoop, this, i);
+  }
+}
+
+void PrefetchingCursor::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  consumed_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+  threads_.clear();
+}
+
+void PrefetchingCursor::WaitForCurrent(std::unique_lock<std::mutex>& lock) {
+  produced_.wait(lock, [this] {
+    return error_ || position_ >= end_ ||
+        buffer_[position_ % buffer_.size()].ready;
+  });
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+}
+
+const PrefetchingCursor::Record& PrefetchingCursor::Current() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  WaitForCurrent(lock);
+  CAFFE_ENFORCE_LT(position_, end_, "Cursor is at invalid location!");
+  // The slot is only reused after the consumer moves past it.
+  return buffer_[position_ % buffer_.size()];
+}
+
+void PrefetchingCursor::ReadLoop(int thread_id) {
+  auto* cursor = cursors_[thread_id].get();
+  try {
+    if (!indexed_) {
+      cursor->SeekToFirst();
+      Skip(cursor, options_.shard_id);
+    }
+    for (;;) {
+      size_t position;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        consumed_.wait(lock, [this] {
+          return stopping_ || next_ >= end_ ||
+              next_ < position_ + buffer_.size();
+        });
+        if (stopping_ || next_ >= end_) {
+          return;
+        }
+        position = next_++;
+      }
+
+      Record record;
+      bool found = ReadRecord(cursor, position, &record);
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (found) {
+          record.ready = true;
+          buffer_[position % buffer_.size()] = std::move(record);
+        } else {
+          end_ = position;
+        }
+      }
+      produced_.notify_all();
+      if (!found) {
+        return;
+      }
+    }
+  } catch (...) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      error_ = std::current_exception();
+    }
+    produced_.notify_all();
+  }
+}
+
+bool PrefetchingCursor::ReadRecord(
+    Cursor* cursor,
+    size_t position,
+    Record* record) {
+  if (indexed_) {
+    const auto& key = keys_[order_[position]];
+    cursor->Seek(key);
+    CAFFE_ENFORCE(
+        cursor->Valid() && cursor->key() == key,
+        "Key ",
+        key,
+        " is no longer in the db");
+    record->key = key;
+  } else {
+    if (!cursor->Valid()) {
+      return false;
+    }
+    record->key = cursor->key();
+  }
+  if (!cursor->ValueView(&record->data, &record->size)) {
+    record->value = cursor->value();
+  }
+  if (!indexed_) {
+    Skip(cursor, options_.num_shards);
+  }
+  return true;
+}
+
+void PrefetchingCursor::Skip(Cursor* cursor, int count) {
+  for (int i = 0; i < count && cursor->Valid(); ++i) {
+    cursor->Next();
+  }
+}
+
+}  // namespace db
+}  // namespace caffe2
@@ -0,0 +1,111 @@
+#ifndef CAFFE2_CORE_PREFETCHING_CURSOR_H_
+#define CAFFE2_CORE_PREFETCHING_CURSOR_H_
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "caffe2/core/db.h"
+
+namespace caffe2 {
+namespace db {
+
+/**
+ * A cursor that reads ahead of its consumer on a set of I/O threads, each
+ * with its own cursor of the db, keeping up to buffer_size records in
+ * flight. This hides the read latency of dbs on network storage.
+ *
+ * If the db supports seeking, the keys of the shard are indexed once when
+ * the cursor is created, and the threads seek to them in parallel, either in
+ * key order or, with shuffle, in a random order that changes every epoch
+ * (every SeekToFirst()). Otherwise a single thread reads the shard
+ * sequentially and shuffling is not supported.
+ *
+ * Records are returned in the same order whatever the number of threads.
+ * For dbs that support Cursor::ValueView (LMDB), ValueView() returns the
+ * value in place instead of a copy; the memory stays valid for as long as
+ * the PrefetchingCursor exists.
+ *
+ * Seek() is not supported. The db has to outlive the cursor.
+ */
+class CAFFE2_API PrefetchingCursor : public Cursor {
+ public:
+  struct Options {
+    int num_threads = 4;
+    int buffer_size = 256;
+    int num_shards = 1;
+    int shard_id = 0;
+    bool shuffle = false;
+    unsigned seed = 0;
+  };
+
+  PrefetchingCursor(DB* db, const Options& options);
+  ~PrefetchingCursor();
+
+  void Seek(const string& key) override;
+  bool SupportsSeek() override {
+    return false;
+  }
+  void SeekToFirst() override;
+  void Next() override;
+  string key() override;
+  string value() override;
+  bool ValueView(const char** data, size_t* size) override;
+  bool Valid() override;
+
+  /**
+   * The number of records in the shard, or -1 if the db does not support
+   * seeking and the shard was not indexed.
+   */
+  int64_t NumRecords() const {
+    return indexed_ ? static_cast<int64_t>(keys_.size()) : -1;
+  }
+
+ private:
+  struct Record {
+    string key;
+    string value;
+    // set instead of value if the db returns values in place
+    const char* data = nullptr;
+    size_t size = 0;
+    bool ready = false;
+  };
+
+  void BuildIndex();
+  void Start();
+  void Stop();
+  void WaitForCurrent(std::unique_lock<std::mutex>& lock);
+  const Record& Current();
+  void ReadLoop(int thread_id);
+  bool ReadRecord(Cursor* cursor, size_t position, Record* record);
+  void Skip(Cursor* cursor, int count);
+
+  Options options_;
+  std::vector<std::unique_ptr<Cursor>> cursors_;
+  bool indexed_;
+  std::vector<string> keys_;
+  std::vector<size_t> order_;
+  unsigned epoch_;
+
+  // Ring buffer of the records from position_ to position_ + buffer_size;
+  // the I/O threads claim the positions in order through next_.
+  std::vector<Record> buffer_;
+  size_t position_;
+  size_t next_;
+  size_t end_;
+  bool stopping_;
+  std::exception_ptr error_;
+  std::mutex mutex_;
+  std::condition_variable produced_;
+  std::condition_variable consumed_;
+  std::vector<std::thread> threads_;
+
+  AT_DISABLE_COPY_AND_ASSIGN(PrefetchingCursor);
+};
+
+}  // namespace db
+}  // namespace caffe2
+
+#endif  // CAFFE2_CORE_PREFETCHING_CURSOR_H_
@@ -11,6 +11,7 @@
 #define CAFFE2_CORE_REGISTRY_H_
 
 #include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <cstdlib>
 #include <functional>
@@ -41,72 +42,132 @@ inline void PrintOffendingKey(const string& key) {
  * You should most likely not use the Registry class explicitly, but use the
  * helper macros below to declare specific registries as well as registering
  * objects.
+ *
+ * Registration, which happens during static initialization, only appends to
+ * a vector. The vector is sorted, and checked for keys registered twice, by
+ * the first lookup after a registration, and lookups are binary searches.
+ * Help messages can be given as a function, which is only called if the help
+ * message is asked for.
  */
 template <class SrcType, class ObjectPtrType, class... Args>
 class CAFFE2_API Registry {
  public:
   typedef std::function<ObjectPtrType(Args...)> Creator;
+  typedef const char* (*HelpMessageFn)();
 
-  Registry() : registry_() {}
+  Registry() : entries_(), sorted_(true) {}
 
   void Register(const SrcType& key, Creator creator) {
-    // The if statement below is essentially the same as the following line:
-    // CHECK_EQ(registry_.count(key), 0) << "Key " << key
-    //                                   << " registered twice.";
-    // However, CHECK_EQ depends on google logging, and since registration is
-    // carried out at static initialization time, we do not want to have an
-    // explicit dependency on glog's initialization function.
-    std::lock_guard<std::mutex> lock(register_mutex_);
-    if (registry_.count(key) != 0) {
-      printf("Key already registered.\n");
-      PrintOffendingKey(key);
-      std::exit(1);
-    }
-    registry_[key] = creator;
+    Register(key, creator, string());
   }
 
   void Register(const SrcType& key, Creator creator, const string& help_msg) {
-    Register(key, creator);
-    help_message_[key] = help_msg;
+    std::lock_guard<std::mutex> lock(register_mutex_);
+    entries_.push_back(Entry{key, std::move(creator), help_msg, nullptr});
+    sorted_ = false;
+  }
+
+  void Register(const SrcType& key, Creator creator, HelpMessageFn help_fn) {
+    std::lock_guard<std::mutex> lock(register_mutex_);
+    entries_.push_back(Entry{key, std::move(creator), string(), help_fn});
+    sorted_ = false;
   }
 
-  inline bool Has(const SrcType& key) { return (registry_.count(key) != 0); }
+  inline bool Has(const SrcType& key) { return Find(key) != nullptr; }
 
   ObjectPtrType Create(const SrcType& key, Args... args) {
-    if (registry_.count(key) == 0) {
+    const Entry* entry = Find(key);
+    if (entry == nullptr) {
       // Returns nullptr if the key is not registered.
       return nullptr;
     }
-    return registry_[key](args...);
+    return entry->creator(args...);
   }
 
   /**
    * Returns the keys currently registered as a vector.
    */
   vector<SrcType> Keys() {
+    Sort();
     vector<SrcType> keys;
-    for (const auto& it : registry_) {
-      keys.push_back(it.first);
+    keys.reserve(entries_.size());
+    for (const auto& entry : entries_) {
+      keys.push_back(entry.key);
     }
     return keys;
   }
 
   const CaffeMap<SrcType, string>& HelpMessage() const {
+    std::lock_guard<std::mutex> lock(register_mutex_);
+    if (help_message_.size() != entries_.size()) {
+      for (const auto& entry : entries_) {
+        if (help_message_.count(entry.key) == 0) {
+          help_message_[entry.key] =
+              entry.help_fn ? entry.help_fn() : entry.help_msg;
+        }
+      }
+    }
     return help_message_;
   }
 
   const char* HelpMessage(const SrcType& key) const {
-    auto it = help_message_.find(key);
-    if (it == help_message_.end()) {
+    const auto& help_message = HelpMessage();
+    auto it = help_message.find(key);
+    if (it == help_message.end()) {
       return nullptr;
     }
     return it->second.c_str();
   }
 
  private:
-  CaffeMap<SrcType, Creator> registry_;
-  CaffeMap<SrcType, string> help_message_;
-  std::mutex register_mutex_;
+  struct Entry {
+    SrcType key;
+    Creator creator;
+    string help_msg;
+    HelpMessageFn help_fn;
+  };
+
+  void Sort() {
+    if (sorted_.load(std::memory_order_acquire)) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(register_mutex_);
+    if (sorted_.load(std::memory_order_relaxed)) {
+      return;
+    }
+    std::stable_sort(
+        entries_.begin(), entries_.end(), [](const Entry& a, const Entry& b) {
+          return a.key < b.key;
+        });
+    for (size_t i = 1; i < entries_.size(); ++i) {
+      if (!(entries_[i - 1].key < entries_[i].key)) {
+        // Same as when this was checked in Register: no glog, since this
+        // may still run during static initialization.
+        printf("Key already registered.\n");
+        PrintOffendingKey(entries_[i].key);
+        std::exit(1);
+      }
+    }
+    sorted_.store(true, std::memory_order_release);
+  }
+
+  const Entry* Find(const SrcType& key) {
+    Sort();
+    auto it = std::lower_bound(
+        entries_.begin(),
+        entries_.end(),
+        key,
+        [](const Entry& entry, const SrcType& k) { return entry.key < k; });
+    if (it == entries_.end() || key < it->key) {
+      return nullptr;
+    }
+    return &*it;
+  }
+
+  vector<Entry> entries_;
+  std::atomic<bool> sorted_;
+  mutable CaffeMap<SrcType, string> help_message_;
+  mutable std::mutex register_mutex_;
 
   AT_DISABLE_COPY_AND_ASSIGN(Registry);
 };
@@ -122,6 +183,15 @@ class CAFFE2_API Registerer {
     registry->Register(key, creator, help_msg);
   }
 
+  Registerer(
+      const SrcType& key,
+      Registry<SrcType, ObjectPtrType, Args...>* registry,
+      typename Registry<SrcType, ObjectPtrType, Args...>::Creator creator,
+      typename Registry<SrcType, ObjectPtrType, Args...>::HelpMessageFn
+          help_fn) {
+    registry->Register(key, creator, help_fn);
+  }
+
   template <class DerivedType>
   static ObjectPtrType DefaultCreator(Args... args) {
     // TODO(jiayq): old versions of NVCC does not handle make_unique well
@@ -179,7 +249,7 @@ class CAFFE2_API Registerer {
       key,                                                                    \
       RegistryName(),                                                         \
       Registerer##RegistryName::DefaultCreator<__VA_ARGS__>,                  \
-      at::demangle_type<__VA_ARGS__>());                                           \
+      &at::demangle_type<__VA_ARGS__>);                                       \
   }
 
 // CAFFE_DECLARE_REGISTRY and CAFFE_DEFINE_REGISTRY are hard-wired to use string
@@ -42,5 +42,19 @@ TEST(RegistryTest, CanRunCreator) {
 TEST(RegistryTest, ReturnNullOnNonExistingCreator) {
   EXPECT_EQ(FooRegistry()->Create("Non-existing bar", 1), nullptr);
 }
+
+TEST(RegistryTest, KeysAreSorted) {
+  EXPECT_EQ(
+      FooRegistry()->Keys(), (vector<string>{"AnotherBar", "Bar"}));
+  EXPECT_TRUE(FooRegistry()->Has("Bar"));
+  EXPECT_FALSE(FooRegistry()->Has("Baz"));
+}
+
+TEST(RegistryTest, HelpMessageIsClassName) {
+  const char* help = FooRegistry()->HelpMessage("Bar");
+  ASSERT_TRUE(help != nullptr);
+  EXPECT_NE(string(help).find("Bar"), string::npos);
+  EXPECT_EQ(FooRegistry()->HelpMessage("Baz"), nullptr);
+}
 }
 }  // namespace caffe2
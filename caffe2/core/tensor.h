@@ -274,19 +274,77 @@ class CAFFE2_API Tensor {
     auto newCapacity = dims_;
     newCapacity[0] = std::max<size_t>(
         newDims[0], std::ceil(dims_[0] * (growthPct + 100) / 100));
-    auto oldData = std::move(data_);
-    auto oldSize = size_;
-    auto oldDims = dims_;
-    Resize(newCapacity);
-    auto* newData = raw_mutable_data(meta_);
     CAFFE_ENFORCE(
         context != nullptr, "Context must be provided to Extend the tensor");
-    context->CopyItemsSameDevice(meta_, oldSize, oldData.get(), newData);
-    reserved_ = true;
+    Reallocate(newCapacity, context);
     dims_ = newDims;
     size_ = newSize;
   }
 
+  /**
+   * @brief Makes room for `outer_dim` elements in the outer-most dimension,
+   * preserving the existing data.
+   *
+   * Later calls to Extend(), ExtendTo() and Resize() that fit in the reserved
+   * capacity don't reallocate. Unlike ReserveSpace(), this keeps the data, and
+   * can be called before any data is allocated as long as the type is known.
+   */
+  void Reserve(TIndex outer_dim, BaseContext* context) {
+    CAFFE_ENFORCE_GE_WITH_CALLER(dims_.size(), 1);
+    CAFFE_ENFORCE_WITH_CALLER(
+        meta_.id() != TypeIdentifier::uninitialized(),
+        "The type must be known to Reserve space in a tensor");
+    CAFFE_ENFORCE(context != nullptr, "Context must be provided.");
+    auto newCapacity = dims_;
+    newCapacity[0] = outer_dim;
+    auto newSize = std::accumulate(
+        newCapacity.begin(),
+        newCapacity.end(),
+        static_cast<TIndex>(1),
+        std::multiplies<TIndex>());
+    if (data_ && newSize * meta_.itemsize() <= capacity_) {
+      return;
+    }
+    auto oldDims = dims_;
+    auto oldSize = size_;
+    Reallocate(newCapacity, context);
+    dims_ = oldDims;
+    size_ = oldSize;
+  }
+
+  /**
+   * @brief Resizes the tensor for data of type `meta`, not keeping the data.
+   *
+   * When the memory has to be reallocated, the capacity of the outer-most
+   * dimension is grown by growthPct percent more than needed. Outputs whose
+   * outer dimension varies from run to run, e.g. concatenations of a varying
+   * number of rows, then stop reallocating once they reach the largest size,
+   * like Extend() does for appends.
+   */
+  void ResizeWithGrowth(
+      const vector<TIndex>& dims,
+      float growthPct,
+      const TypeMeta& meta) {
+    CAFFE_ENFORCE_GE_WITH_CALLER(dims.size(), 1);
+    CAFFE_ENFORCE_GE_WITH_CALLER(growthPct, 0);
+    auto newSize = std::accumulate(
+        dims.begin(), dims.end(), static_cast<TIndex>(1),
+        std::multiplies<TIndex>());
+    if (meta_ == meta && data_ && newSize * meta.itemsize() <= capacity_) {
+      dims_ = dims;
+      size_ = newSize;
+      return;
+    }
+    auto newCapacity = dims;
+    newCapacity[0] = std::ceil(dims[0] * (growthPct + 100) / 100);
+    FreeMemory();
+    Resize(newCapacity);
+    raw_mutable_data(meta);
+    reserved_ = true;
+    dims_ = dims;
+    size_ = newSize;
+  }
+
   /**
    * @brief Shrinks the outer-most dimension to given size, keeping the data.
    *
@@ -602,13 +660,17 @@ class CAFFE2_API Tensor {
               deleter(ptr);
             });
         meta_.ctor()(data_.get(), size_);
+        capacity_ = size_ * meta_.itemsize();
       } else {
         // For fundamental type, new and delete is easier.
-        auto ptr_and_deleter =
-            GetStaticContext()->New(size_ * meta_.itemsize());
+        auto nbytes = size_ * meta_.itemsize();
+        auto* context = GetStaticContext();
+        auto ptr_and_deleter = context->New(nbytes);
         data_.reset(ptr_and_deleter.first, ptr_and_deleter.second);
+        // The allocation may have room after nbytes, which later Resize()
+        // and Extend() calls can grow into without reallocating.
+        capacity_ = context->Capacity(data_.get(), nbytes);
       }
-      capacity_ = size_ * meta_.itemsize();
       return data_.get();
     }
   }
@@ -781,6 +843,23 @@ class CAFFE2_API Tensor {
   // In case of chunk load we store how much data was already loaded
 
  private:
+  /**
+   * Moves the data to a new allocation with the shape `capacity`, which must
+   * hold at least as many items. The tensor is left with that shape and marked
+   * as reserved, so that shrinking back doesn't release the memory.
+   */
+  void Reallocate(const vector<TIndex>& capacity, BaseContext* context) {
+    auto oldData = std::move(data_);
+    auto oldSize = size_;
+    capacity_ = 0;
+    Resize(capacity);
+    auto* newData = raw_mutable_data(meta_);
+    if (oldData) {
+      context->CopyItemsSameDevice(meta_, oldSize, oldData.get(), newData);
+    }
+    reserved_ = true;
+  }
+
   template <
       typename T,
       typename = typename std::enable_if<std::is_integral<T>::value>::type>
@@ -2,6 +2,8 @@
 
 #include <algorithm>
 #include <ctime>
+#include <deque>
+#include <limits>
 #include <mutex>
 
 #include "caffe2/core/logging.h"
@@ -18,6 +20,56 @@ CAFFE2_DEFINE_bool(
 
 namespace caffe2 {
 
+namespace {
+
+struct BlobNameTable {
+  std::mutex mutex;
+  std::unordered_map<string, BlobId> ids;
+  // a deque, so that BlobName can hand out references
+  std::deque<string> names;
+};
+
+BlobNameTable& blobNameTable() {
+  static auto* table = new BlobNameTable();
+  return *table;
+}
+
+} // namespace
+
+BlobId InternBlobName(const string& name) {
+  auto& table = blobNameTable();
+  std::lock_guard<std::mutex> guard(table.mutex);
+  auto it = table.ids.find(name);
+  if (it != table.ids.end()) {
+    return it->second;
+  }
+  CAFFE_ENFORCE_LT(
+      table.names.size(),
+      std::numeric_limits<BlobId>::max(),
+      "Too many distinct blob names");
+  BlobId id = table.names.size();
+  table.names.push_back(name);
+  table.ids.emplace(name, id);
+  return id;
+}
+
+BlobId FindBlobName(const string& name) {
+  auto& table = blobNameTable();
+  std::lock_guard<std::mutex> guard(table.mutex);
+  auto it = table.ids.find(name);
+  return it == table.ids.end() ? kInvalidBlobId : it->second;
+}
+
+const string& BlobName(BlobId id) {
+  auto& table = blobNameTable();
+  std::lock_guard<std::mutex> guard(table.mutex);
+  CAFFE_ENFORCE(
+      id >= 0 && static_cast<size_t>(id) < table.names.size(),
+      "Invalid blob id ",
+      id);
+  return table.names[id];
+}
+
 void Workspace::PrintBlobSizes() {
   vector<string> blobs = LocalBlobs();
   size_t cumtotal = 0;
@@ -72,24 +124,23 @@ vector<string> Workspace::LocalBlobs() const {
   vector<string> names;
   names.reserve(blob_map_.size());
   for (auto& entry : blob_map_) {
-    names.push_back(entry.first);
+    names.push_back(BlobName(entry.first));
   }
+  std::sort(names.begin(), names.end());
   return names;
 }
 
 vector<string> Workspace::Blobs() const {
-  vector<string> names;
-  names.reserve(blob_map_.size());
-  for (auto& entry : blob_map_) {
-    names.push_back(entry.first);
-  }
+  vector<string> names = LocalBlobs();
+  vector<string> forwarded_names;
   for (const auto& forwarded : forwarded_blobs_) {
     const auto parent_ws = forwarded.second.first;
-    const auto& parent_name = forwarded.second.second;
-    if (parent_ws->HasBlob(parent_name)) {
-      names.push_back(forwarded.first);
+    if (parent_ws->HasBlob(forwarded.second.second)) {
+      forwarded_names.push_back(BlobName(forwarded.first));
     }
   }
+  std::sort(forwarded_names.begin(), forwarded_names.end());
+  names.insert(names.end(), forwarded_names.begin(), forwarded_names.end());
   if (shared_) {
     const auto& shared_blobs = shared_->Blobs();
     names.insert(names.end(), shared_blobs.begin(), shared_blobs.end());
@@ -98,32 +149,44 @@ vector<string> Workspace::Blobs() const {
 }
 
 Blob* Workspace::CreateBlob(const string& name) {
-  if (HasBlob(name)) {
-    VLOG(1) << "Blob " << name << " already exists. Skipping.";
-  } else if (forwarded_blobs_.count(name)) {
+  return CreateBlob(InternBlobName(name));
+}
+
+Blob* Workspace::CreateBlob(BlobId id) {
+  if (auto* blob = GetBlob(id)) {
+    VLOG(1) << "Blob " << BlobName(id) << " already exists. Skipping.";
+    return blob;
+  }
+  auto forwarded = forwarded_blobs_.find(id);
+  if (forwarded != forwarded_blobs_.end()) {
     // possible if parent workspace deletes forwarded blob
-    VLOG(1) << "Blob " << name << " is already forwarded from parent workspace "
-            << "(blob " << forwarded_blobs_[name].second << "). Skipping.";
-  } else {
-    VLOG(1) << "Creating blob " << name;
-    blob_map_[name] = unique_ptr<Blob>(new Blob());
+    VLOG(1) << "Blob " << BlobName(id)
+            << " is already forwarded from parent workspace "
+            << "(blob " << BlobName(forwarded->second.second)
+            << "). Skipping.";
+    return nullptr;
   }
-  return GetBlob(name);
+  VLOG(1) << "Creating blob " << BlobName(id);
+  auto* blob = new Blob();
+  blob_map_[id] = unique_ptr<Blob>(blob);
+  return blob;
 }
 
 Blob* Workspace::CreateLocalBlob(const string& name) {
-  if (blob_map_.count(name)) {
+  auto id = InternBlobName(name);
+  auto& blob = blob_map_[id];
+  if (blob) {
     VLOG(1) << "Blob " << name << " already exists. Skipping.";
   } else {
     VLOG(1) << "Creating blob " << name;
-    blob_map_[name] = unique_ptr<Blob>(new Blob());
+    blob.reset(new Blob());
   }
-  return GetBlob(name);
+  return blob.get();
 }
 
 Blob* Workspace::RenameBlob(const string& old_name, const string& new_name) {
   // We allow renaming only local blobs for API clarity purpose
-  auto it = blob_map_.find(old_name);
+  auto it = blob_map_.find(FindBlobName(old_name));
   CAFFE_ENFORCE(
       it != blob_map_.end(),
       "Blob ",
@@ -140,12 +203,12 @@ Blob* Workspace::RenameBlob(const string& old_name, const string& new_name) {
   blob_map_.erase(it);
 
   auto* raw_ptr = value.get();
-  blob_map_[new_name] = std::move(value);
+  blob_map_[InternBlobName(new_name)] = std::move(value);
   return raw_ptr;
 }
 
 bool Workspace::RemoveBlob(const string& name) {
-  auto it = blob_map_.find(name);
+  auto it = blob_map_.find(FindBlobName(name));
   if (it != blob_map_.end()) {
     VLOG(1) << "Removing blob " << name << " from this workspace.";
     blob_map_.erase(it);
@@ -158,14 +221,11 @@ bool Workspace::RemoveBlob(const string& name) {
 }
 
 const Blob* Workspace::GetBlob(const string& name) const {
-  if (blob_map_.count(name)) {
-    return blob_map_.at(name).get();
-  } else if (forwarded_blobs_.count(name)) {
-    const auto parent_ws = forwarded_blobs_.at(name).first;
-    const auto& parent_name = forwarded_blobs_.at(name).second;
-    return parent_ws->GetBlob(parent_name);
-  } else if (shared_ && shared_->HasBlob(name)) {
-    return shared_->GetBlob(name);
+  auto id = FindBlobName(name);
+  if (id != kInvalidBlobId) {
+    if (auto* blob = GetBlob(id)) {
+      return blob;
+    }
   }
   LOG(WARNING) << "Blob " << name << " not in the workspace.";
   // TODO(Yangqing): do we want to always print out the list of blobs here?
@@ -185,13 +245,16 @@ void Workspace::AddBlobMapping(
     CAFFE_ENFORCE(
         parent->HasBlob(forwarded.second),
         "Invalid parent workspace blob " + forwarded.second);
-    if (forwarded_blobs_.count(forwarded.first)) {
-      const auto& ws_blob = forwarded_blobs_[forwarded.first];
+    auto id = InternBlobName(forwarded.first);
+    auto parent_id = InternBlobName(forwarded.second);
+    auto it = forwarded_blobs_.find(id);
+    if (it != forwarded_blobs_.end()) {
+      const auto& ws_blob = it->second;
       CAFFE_ENFORCE_EQ(
           ws_blob.first, parent, "Redefinition of blob " + forwarded.first);
       CAFFE_ENFORCE_EQ(
           ws_blob.second,
-          forwarded.second,
+          parent_id,
           "Redefinition of blob " + forwarded.first);
     } else {
       if (skip_defined_blobs && HasBlob(forwarded.first)) {
@@ -201,8 +264,7 @@ void Workspace::AddBlobMapping(
           !HasBlob(forwarded.first), "Redefinition of blob " + forwarded.first);
       // Lazy blob resolution - store the parent workspace and
       // blob name, blob value might change in the parent workspace
-      forwarded_blobs_[forwarded.first] =
-          std::make_pair(parent, forwarded.second);
+      forwarded_blobs_[id] = std::make_pair(parent, parent_id);
     }
   }
 }
@@ -308,4 +370,13 @@ ThreadPool* Workspace::GetThreadPool() {
   return thread_pool_.get();
 }
 
+std::shared_ptr<WorkStealingThreadPool> Workspace::GetWorkStealingThreadPool(
+    std::size_t pool_size) {
+  std::lock_guard<std::mutex> guard(thread_pool_creation_mutex_);
+  if (!work_stealing_pool_) {
+    work_stealing_pool_ = std::make_shared<WorkStealingThreadPool>(pool_size);
+  }
+  return work_stealing_pool_;
+}
+
 } // namespace caffe2
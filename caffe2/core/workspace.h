@@ -8,6 +8,7 @@
 #include <cstddef>
 #include <mutex>
 #include <typeinfo>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -17,6 +18,7 @@
 #include "caffe2/proto/caffe2.pb.h"
 #include "caffe2/utils/signal_handler.h"
 #include "caffe2/utils/threadpool/ThreadPool.h"
+#include "caffe2/utils/work_stealing_thread_pool.h"
 
 CAFFE2_DECLARE_bool(caffe2_print_blob_sizes_at_exit);
 
@@ -24,6 +26,30 @@ namespace caffe2 {
 
 class NetBase;
 
+/**
+ * Blob names are interned process-wide into BlobIds, by which workspaces key
+ * their blobs: a lookup hashes the name once, however many parent
+ * workspaces it goes through, and code that resolves the same names in many
+ * workspaces, like the step nets of recurrent networks, can intern them
+ * once and skip hashing altogether. Ids are never released.
+ */
+typedef int32_t BlobId;
+constexpr BlobId kInvalidBlobId = -1;
+
+/**
+ * Returns the id of the given blob name, interning it if it's new.
+ */
+CAFFE2_API BlobId InternBlobName(const string& name);
+/**
+ * Returns the id of the given blob name, or kInvalidBlobId if it has never
+ * been interned, in which case no workspace has a blob of that name.
+ */
+CAFFE2_API BlobId FindBlobName(const string& name);
+/**
+ * Returns the name of an interned blob id.
+ */
+CAFFE2_API const string& BlobName(BlobId id);
+
 struct CAFFE2_API StopOnSignal {
   StopOnSignal()
       : handler_(std::make_shared<SignalHandler>(
@@ -47,7 +73,7 @@ struct CAFFE2_API StopOnSignal {
 class CAFFE2_API Workspace {
  public:
   typedef std::function<bool(int)> ShouldContinue;
-  typedef CaffeMap<string, unique_ptr<Blob> > BlobMap;
+  typedef std::unordered_map<BlobId, unique_ptr<Blob>> BlobMap;
   typedef CaffeMap<string, unique_ptr<NetBase> > NetMap;
   /**
    * Initializes an empty workspace.
@@ -89,8 +115,8 @@ class CAFFE2_API Workspace {
     for (const auto& forwarded : forwarded_blobs) {
       CAFFE_ENFORCE(
           shared->HasBlob(forwarded.second), "Invalid parent workspace blob");
-      forwarded_blobs_[forwarded.first] =
-          std::make_pair(shared, forwarded.second);
+      forwarded_blobs_[InternBlobName(forwarded.first)] =
+          std::make_pair(shared, InternBlobName(forwarded.second));
     }
   }
 
@@ -128,18 +154,19 @@ class CAFFE2_API Workspace {
   template <class Context>
   void CopyForwardedTensors(const std::unordered_set<std::string>& blobs) {
     for (const auto& blob : blobs) {
-      if (!forwarded_blobs_.count(blob)) {
+      auto it = forwarded_blobs_.find(FindBlobName(blob));
+      if (it == forwarded_blobs_.end()) {
         continue;
       }
-      const auto& ws_blob = forwarded_blobs_[blob];
-      const auto* parent_ws = ws_blob.first;
-      auto* from_blob = parent_ws->GetBlob(ws_blob.second);
+      const auto* parent_ws = it->second.first;
+      auto parent_id = it->second.second;
+      auto* from_blob = parent_ws->GetBlob(parent_id);
       CAFFE_ENFORCE(from_blob);
       CAFFE_ENFORCE(
           from_blob->template IsType<Tensor>(),
           "Expected blob with tensor value",
-          ws_blob.second);
-      forwarded_blobs_.erase(blob);
+          BlobName(parent_id));
+      forwarded_blobs_.erase(it);
       auto* to_blob = CreateBlob(blob);
       CAFFE_ENFORCE(to_blob);
       const auto& from_tensor = from_blob->template Get<Tensor>();
@@ -150,7 +177,7 @@ class CAFFE2_API Workspace {
 
   /**
    * Return list of blobs owned by this Workspace, not including blobs
-   * shared from parent workspace.
+   * shared from parent workspace, in sorted order.
    */
   vector<string> LocalBlobs() const;
 
@@ -169,18 +196,10 @@ class CAFFE2_API Workspace {
    * Checks if a blob with the given name is present in the current workspace.
    */
   inline bool HasBlob(const string& name) const {
-    // First, check the local workspace,
-    // Then, check the forwarding map, then the parent workspace
-    if (blob_map_.count(name)) {
-      return true;
-    } else if (forwarded_blobs_.count(name)) {
-      const auto parent_ws = forwarded_blobs_.at(name).first;
-      const auto& parent_name = forwarded_blobs_.at(name).second;
-      return parent_ws->HasBlob(parent_name);
-    } else if (shared_) {
-      return shared_->HasBlob(name);
-    }
-    return false;
+    return HasBlob(FindBlobName(name));
+  }
+  inline bool HasBlob(BlobId id) const {
+    return GetBlob(id) != nullptr;
   }
 
   void PrintBlobSizes();
@@ -191,6 +210,7 @@ class CAFFE2_API Workspace {
    * already exists, the creation is skipped and the existing blob is returned.
    */
   Blob* CreateBlob(const string& name);
+  Blob* CreateBlob(BlobId id);
   /**
    * Similar to CreateBlob(), but it creates a blob in the local workspace even
    * if another blob with the same name already exists in the parent workspace
@@ -215,6 +235,29 @@ class CAFFE2_API Workspace {
    * not exist, a nullptr is returned.
    */
   Blob* GetBlob(const string& name);
+  /**
+   * Same as GetBlob(name) with the interned name, except that a missing blob
+   * isn't logged.
+   */
+  const Blob* GetBlob(BlobId id) const {
+    // First, check the local workspace,
+    // Then, check the forwarding map, then the parent workspace
+    auto it = blob_map_.find(id);
+    if (it != blob_map_.end()) {
+      return it->second.get();
+    }
+    auto forwarded = forwarded_blobs_.find(id);
+    if (forwarded != forwarded_blobs_.end()) {
+      return forwarded->second.first->GetBlob(forwarded->second.second);
+    }
+    if (shared_) {
+      return shared_->GetBlob(id);
+    }
+    return nullptr;
+  }
+  Blob* GetBlob(BlobId id) {
+    return const_cast<Blob*>(static_cast<const Workspace*>(this)->GetBlob(id));
+  }
 
   /**
    * Renames a local workspace blob. If blob is not found in the local blob list
@@ -276,6 +319,14 @@ class CAFFE2_API Workspace {
    */
   ThreadPool* GetThreadPool();
 
+  /*
+   * Returns the work stealing pool shared by all async_work_stealing nets of
+   * this workspace, creating it with pool_size threads on first use. Nets
+   * keep a reference so the pool outlives any run still in flight.
+   */
+  std::shared_ptr<WorkStealingThreadPool> GetWorkStealingThreadPool(
+      std::size_t pool_size);
+
   // RunOperatorOnce and RunNetOnce runs an operator or net once. The difference
   // between RunNet and RunNetOnce lies in the fact that RunNet allows you to
   // have a persistent net object, while RunNetOnce creates a net and discards
@@ -292,10 +343,12 @@ class CAFFE2_API Workspace {
   NetMap net_map_;
   const string root_folder_;
   const Workspace* shared_;
-  std::unordered_map<string, std::pair<const Workspace*, string>>
+  // blob -> (parent workspace, parent blob)
+  std::unordered_map<BlobId, std::pair<const Workspace*, BlobId>>
       forwarded_blobs_;
   std::unique_ptr<ThreadPool> thread_pool_;
   std::mutex thread_pool_creation_mutex_;
+  std::shared_ptr<WorkStealingThreadPool> work_stealing_pool_;
 
   AT_DISABLE_COPY_AND_ASSIGN(Workspace);
 };
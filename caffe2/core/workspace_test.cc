@@ -115,4 +115,35 @@ TEST(WorkspaceTest, BlobMapping) {
   }
 }
 
+TEST(WorkspaceTest, BlobIds) {
+  BlobId id = InternBlobName("workspace_test_blob_id");
+  EXPECT_NE(id, kInvalidBlobId);
+  EXPECT_EQ(InternBlobName("workspace_test_blob_id"), id);
+  EXPECT_EQ(FindBlobName("workspace_test_blob_id"), id);
+  EXPECT_EQ(BlobName(id), "workspace_test_blob_id");
+  EXPECT_EQ(FindBlobName("workspace_test_never_interned"), kInvalidBlobId);
+
+  Workspace parent;
+  EXPECT_FALSE(parent.HasBlob(id));
+  EXPECT_EQ(parent.GetBlob(id), nullptr);
+  Blob* blob = parent.CreateBlob(id);
+  EXPECT_TRUE(blob);
+  EXPECT_EQ(parent.GetBlob("workspace_test_blob_id"), blob);
+  EXPECT_EQ(parent.CreateBlob("workspace_test_blob_id"), blob);
+
+  std::unordered_map<string, string> forwarded_blobs;
+  forwarded_blobs["workspace_test_inner"] = "workspace_test_blob_id";
+  Workspace child(&parent, forwarded_blobs);
+  EXPECT_EQ(child.GetBlob(InternBlobName("workspace_test_inner")), blob);
+  Workspace grandchild(&child);
+  EXPECT_EQ(grandchild.GetBlob(id), blob);
+
+  parent.CreateBlob("c");
+  parent.CreateBlob("b");
+  parent.CreateBlob("a");
+  EXPECT_EQ(
+      parent.LocalBlobs(),
+      (vector<string>{"a", "b", "c", "workspace_test_blob_id"}));
+}
+
 }  // namespace caffe2
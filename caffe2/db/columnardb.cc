@@ -0,0 +1,558 @@
+#include "caffe2/db/columnardb.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef CAFFE2_USE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "caffe2/core/blob_serialization.h"
+#include "caffe2/core/flags.h"
+#include "caffe2/core/logging.h"
+
+CAFFE2_DEFINE_int(
+    caffe2_columnardb_chunk_size,
+    4096,
+    "The number of records in a chunk when writing a columnardb.");
+CAFFE2_DEFINE_string(
+    caffe2_columnardb_compression,
+    "none",
+    "The compression of the columns when writing a columnardb: none or zstd.");
+CAFFE2_DEFINE_int(
+    caffe2_columnardb_zstd_level,
+    3,
+    "The ZSTD compression level when writing a columnardb.");
+
+namespace caffe2 {
+namespace db {
+
+namespace {
+
+// "C2COLDB1"
+constexpr uint64_t kMagic = 0x3142444c4f433243ULL;
+constexpr uint32_t kVersion = 1;
+// Columns are aligned so batches can be used in place by vectorized code.
+constexpr size_t kAlignment = 64;
+
+template <typename T>
+void Append(string* index, T value) {
+  index->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+class IndexReader {
+ public:
+  IndexReader(const char* begin, const char* end) : pos_(begin), end_(end) {}
+
+  template <typename T>
+  T Read() {
+    CAFFE_ENFORCE_LE(
+        sizeof(T),
+        static_cast<size_t>(end_ - pos_),
+        "Truncated columnardb index");
+    T value;
+    std::memcpy(&value, pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return value;
+  }
+
+ private:
+  const char* pos_;
+  const char* end_;
+};
+
+}  // namespace
+
+class ColumnarDBCursor : public Cursor {
+ public:
+  explicit ColumnarDBCursor(const ColumnarDB* db)
+      : db_(db),
+        chunk_(0),
+        row_(0),
+        loaded_chunk_(-1),
+        scratch_(db->columns_.size()),
+        columns_(db->columns_.size()) {}
+
+  void Seek(const string& /*key*/) override {
+    LOG(FATAL) << "ColumnarDB does not support seeking to a specific key.";
+  }
+
+  void SeekToFirst() override {
+    chunk_ = 0;
+    row_ = 0;
+  }
+
+  void Next() override {
+    if (!Valid()) {
+      return;
+    }
+    if (++row_ == db_->chunks_[chunk_].num_records) {
+      ++chunk_;
+      row_ = 0;
+    }
+  }
+
+  string key() override {
+    CAFFE_ENFORCE(Valid(), "Cursor is at invalid location!");
+    return db_->Key(chunk_, row_);
+  }
+
+  string value() override {
+    CAFFE_ENFORCE(Valid(), "Cursor is at invalid location!");
+    Load();
+    TensorProtos protos;
+    TensorSerializer serializer;
+    for (int i = 0; i < db_->columns_.size(); ++i) {
+      const auto& column = db_->columns_[i];
+      TensorCPU tensor(column.dims, CPU);
+      tensor.ShareExternalPointer(
+          const_cast<char*>(columns_[i] + row_ * column.record_bytes),
+          DataTypeToTypeMeta(column.data_type));
+      auto* proto = protos.add_protos();
+      serializer.Serialize(tensor, "", proto, 0, tensor.size());
+      // the way the record was written
+      proto->clear_segment();
+      proto->clear_device_detail();
+    }
+    return protos.SerializeAsString();
+  }
+
+  bool Valid() override {
+    return chunk_ < db_->chunks_.size();
+  }
+
+ private:
+  // Decompresses the columns of the current chunk once.
+  void Load() {
+    if (loaded_chunk_ == chunk_) {
+      return;
+    }
+    for (int i = 0; i < columns_.size(); ++i) {
+      columns_[i] = db_->ColumnData(chunk_, i, &scratch_[i]);
+    }
+    loaded_chunk_ = chunk_;
+  }
+
+  const ColumnarDB* db_;
+  size_t chunk_;
+  int64_t row_;
+  size_t loaded_chunk_;
+  std::vector<std::vector<char>> scratch_;
+  std::vector<const char*> columns_;
+};
+
+class ColumnarDBTransaction : public Transaction {
+ public:
+  explicit ColumnarDBTransaction(ColumnarDB* db) : db_(db) {}
+  ~ColumnarDBTransaction() {
+    Commit();
+  }
+
+  void Put(const string& key, const string& value) override {
+    db_->Put(key, value);
+  }
+
+  // Full chunks are already written; the last one is written on Close().
+  void Commit() override {
+    db_->Flush();
+  }
+
+ private:
+  ColumnarDB* db_;
+
+  AT_DISABLE_COPY_AND_ASSIGN(ColumnarDBTransaction);
+};
+
+ColumnarDB::ColumnarDB(const string& source, Mode mode)
+    : DB(source, mode),
+      source_(source),
+      file_(nullptr),
+      file_offset_(0),
+      chunk_size_(FLAGS_caffe2_columnardb_chunk_size),
+      compression_(NONE),
+      compression_level_(FLAGS_caffe2_columnardb_zstd_level),
+      data_(nullptr),
+      size_(0) {
+  CAFFE_ENFORCE(
+      mode != WRITE, "ColumnarDB can't be appended to, create a new one.");
+  if (mode == NEW) {
+    CAFFE_ENFORCE_GT(FLAGS_caffe2_columnardb_chunk_size, 0);
+    const auto& compression = FLAGS_caffe2_columnardb_compression;
+    if (compression == "zstd") {
+#ifdef CAFFE2_USE_ZSTD
+      compression_ = ZSTD;
+#else
+      CAFFE_THROW("ColumnarDB zstd compression needs a build with USE_ZSTD.");
+#endif
+    } else {
+      CAFFE_ENFORCE_EQ(
+          compression, "none", "Unknown columnardb compression ", compression);
+    }
+    file_ = fopen(source.c_str(), "wb");
+    CAFFE_ENFORCE(file_, "Cannot open file: ", source);
+    VLOG(1) << "Created columnardb " << source;
+    return;
+  }
+
+  int fd = open(source.c_str(), O_RDONLY);
+  CAFFE_ENFORCE_GE(fd, 0, "Cannot open file: ", source);
+  struct stat st;
+  bool stat_ok = fstat(fd, &st) == 0;
+  size_ = stat_ok ? st.st_size : 0;
+  void* addr = MAP_FAILED;
+  if (size_ >= 2 * sizeof(uint64_t)) {
+    addr = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  CAFFE_ENFORCE(stat_ok, "Cannot stat file: ", source);
+  CAFFE_ENFORCE(addr != MAP_FAILED, "Cannot map columnardb ", source);
+  data_ = static_cast<const char*>(addr);
+  try {
+    ReadIndex();
+  } catch (...) {
+    Close();
+    throw;
+  }
+  VLOG(1) << "Opened columnardb " << source << " with " << NumRecords()
+          << " records in " << chunks_.size() << " chunks";
+}
+
+ColumnarDB::~ColumnarDB() {
+  Close();
+}
+
+void ColumnarDB::Close() {
+  if (file_) {
+    if (!pending_keys_.empty()) {
+      WriteChunk();
+    }
+    WriteIndex();
+    fclose(file_);
+    file_ = nullptr;
+  }
+  if (data_) {
+    munmap(const_cast<char*>(data_), size_);
+    data_ = nullptr;
+  }
+}
+
+unique_ptr<Cursor> ColumnarDB::NewCursor() {
+  CAFFE_ENFORCE_EQ(this->mode_, READ);
+  return make_unique<ColumnarDBCursor>(this);
+}
+
+unique_ptr<Transaction> ColumnarDB::NewTransaction() {
+  CAFFE_ENFORCE_EQ(this->mode_, NEW);
+  return make_unique<ColumnarDBTransaction>(this);
+}
+
+int64_t ColumnarDB::NumRecords() const {
+  int64_t num_records = pending_keys_.size();
+  if (!chunks_.empty()) {
+    num_records += chunks_.back().first_record + chunks_.back().num_records;
+  }
+  return num_records;
+}
+
+bool ColumnarDB::ReadBatch(
+    int64_t first,
+    int64_t count,
+    int column,
+    TensorCPU* output) {
+  CAFFE_ENFORCE(data_, "ColumnarDB ", source_, " is not open for reading.");
+  CAFFE_ENFORCE(column >= 0 && column < columns_.size(), "Bad column ", column);
+  CAFFE_ENFORCE(
+      first >= 0 && count >= 0 && first + count <= NumRecords(),
+      "Records [",
+      first,
+      ", ",
+      first + count,
+      ") are out of the db");
+  const auto& schema = columns_[column];
+  const auto& meta = DataTypeToTypeMeta(schema.data_type);
+  auto dims = schema.dims;
+  dims.insert(dims.begin(), count);
+  output->Resize(dims);
+  if (count == 0) {
+    output->raw_mutable_data(meta);
+    return false;
+  }
+
+  auto chunk = FindChunk(first);
+  const auto& first_chunk = chunks_[chunk];
+  const auto& data = first_chunk.columns[column];
+  if (first + count <= first_chunk.first_record + first_chunk.num_records &&
+      data.compression == NONE) {
+    auto offset = (first - first_chunk.first_record) * schema.record_bytes;
+    output->ShareExternalPointer(
+        const_cast<char*>(data_ + data.offset + offset), meta);
+    return true;
+  }
+
+  auto* destination = static_cast<char*>(output->raw_mutable_data(meta));
+  std::vector<char> scratch;
+  for (auto record = first; record < first + count; ++chunk) {
+    const auto& current = chunks_[chunk];
+    auto row = record - current.first_record;
+    auto rows = std::min(current.num_records - row, first + count - record);
+    const char* source = ColumnData(chunk, column, &scratch);
+    std::memcpy(
+        destination,
+        source + row * schema.record_bytes,
+        rows * schema.record_bytes);
+    destination += rows * schema.record_bytes;
+    record += rows;
+  }
+  return false;
+}
+
+void ColumnarDB::Put(const string& key, const string& value) {
+  CAFFE_ENFORCE(file_, "ColumnarDB ", source_, " is not open for writing.");
+  TensorProtos protos;
+  CAFFE_ENFORCE(
+      protos.ParseFromString(value),
+      "ColumnarDB records have to be serialized TensorProtos.");
+  std::vector<TensorCPU> tensors;
+  TensorDeserializer deserializer;
+  for (const auto& proto : protos.protos()) {
+    tensors.emplace_back(CPU);
+    deserializer.Deserialize(proto, &tensors.back());
+  }
+
+  if (columns_.empty()) {
+    for (const auto& tensor : tensors) {
+      CAFFE_ENFORCE(
+          tensor.meta().copy() == nullptr,
+          "ColumnarDB only stores fixed size types, not ",
+          tensor.meta().name());
+      columns_.push_back(Column{TypeMetaToDataType(tensor.meta()),
+                                tensor.dims(),
+                                tensor.nbytes()});
+    }
+    pending_columns_.resize(columns_.size());
+  }
+  CAFFE_ENFORCE_EQ(
+      tensors.size(),
+      columns_.size(),
+      "All the records of a columnardb need the same number of tensors");
+  for (int i = 0; i < tensors.size(); ++i) {
+    const auto& tensor = tensors[i];
+    CAFFE_ENFORCE(
+        TypeMetaToDataType(tensor.meta()) == columns_[i].data_type &&
+            tensor.dims() == columns_[i].dims,
+        "Tensor ",
+        i,
+        " of record ",
+        key,
+        " does not match the columnardb schema");
+    const auto* data = static_cast<const char*>(tensor.raw_data());
+    pending_columns_[i].insert(
+        pending_columns_[i].end(), data, data + tensor.nbytes());
+  }
+  pending_keys_.push_back(key);
+  if (pending_keys_.size() >= chunk_size_) {
+    WriteChunk();
+  }
+}
+
+void ColumnarDB::Flush() {
+  if (file_) {
+    CAFFE_ENFORCE_EQ(fflush(file_), 0);
+  }
+}
+
+void ColumnarDB::Write(const void* data, size_t size) {
+  if (size > 0) {
+    CAFFE_ENFORCE_EQ(fwrite(data, 1, size, file_), size);
+    file_offset_ += size;
+  }
+}
+
+uint64_t ColumnarDB::WriteBlob(const void* data, size_t size) {
+  static const char kZeros[kAlignment] = {};
+  Write(kZeros, (kAlignment - file_offset_ % kAlignment) % kAlignment);
+  auto offset = file_offset_;
+  Write(data, size);
+  return offset;
+}
+
+void ColumnarDB::WriteChunk() {
+  Chunk chunk;
+  chunk.first_record = NumRecords() - pending_keys_.size();
+  chunk.num_records = pending_keys_.size();
+
+  // The end offset of every key, followed by the keys.
+  std::vector<uint64_t> ends;
+  string keys;
+  for (const auto& key : pending_keys_) {
+    keys += key;
+    ends.push_back(keys.size());
+  }
+  keys.insert(
+      0, reinterpret_cast<const char*>(ends.data()), ends.size() * 8);
+  chunk.keys_offset = WriteBlob(keys.data(), keys.size());
+  chunk.keys_bytes = keys.size();
+  pending_keys_.clear();
+
+  for (auto& column : pending_columns_) {
+    Chunk::ColumnData data{0, column.size(), NONE};
+    const char* stored = column.data();
+#ifdef CAFFE2_USE_ZSTD
+    std::vector<char> compressed;
+    if (compression_ == ZSTD) {
+      compressed.resize(ZSTD_compressBound(column.size()));
+      auto size = ZSTD_compress(
+          compressed.data(),
+          compressed.size(),
+          column.data(),
+          column.size(),
+          compression_level_);
+      CAFFE_ENFORCE(!ZSTD_isError(size), ZSTD_getErrorName(size));
+      // Incompressible columns are kept as they are, so they can be read
+      // in place.
+      if (size < column.size()) {
+        data.stored_bytes = size;
+        data.compression = ZSTD;
+        stored = compressed.data();
+      }
+    }
+#endif
+    data.offset = WriteBlob(stored, data.stored_bytes);
+    chunk.columns.push_back(data);
+    column.clear();
+  }
+  chunks_.push_back(std::move(chunk));
+}
+
+void ColumnarDB::WriteIndex() {
+  string index;
+  Append<uint32_t>(&index, kVersion);
+  Append<uint32_t>(&index, columns_.size());
+  for (const auto& column : columns_) {
+    Append<int32_t>(&index, column.data_type);
+    Append<uint32_t>(&index, column.dims.size());
+    for (auto dim : column.dims) {
+      Append<int64_t>(&index, dim);
+    }
+  }
+  Append<uint64_t>(&index, chunks_.size());
+  for (const auto& chunk : chunks_) {
+    Append<int64_t>(&index, chunk.first_record);
+    Append<int64_t>(&index, chunk.num_records);
+    Append<uint64_t>(&index, chunk.keys_offset);
+    Append<uint64_t>(&index, chunk.keys_bytes);
+    for (const auto& data : chunk.columns) {
+      Append<uint64_t>(&index, data.offset);
+      Append<uint64_t>(&index, data.stored_bytes);
+      Append<uint8_t>(&index, data.compression);
+    }
+  }
+  uint64_t footer[2] = {WriteBlob(index.data(), index.size()), kMagic};
+  Write(footer, sizeof(footer));
+}
+
+void ColumnarDB::ReadIndex() {
+  uint64_t footer[2];
+  std::memcpy(footer, data_ + size_ - sizeof(footer), sizeof(footer));
+  CAFFE_ENFORCE_EQ(footer[1], kMagic, source_, " is not a columnardb");
+  CAFFE_ENFORCE_LE(footer[0], size_ - sizeof(footer));
+  IndexReader reader(data_ + footer[0], data_ + size_ - sizeof(footer));
+  auto version = reader.Read<uint32_t>();
+  CAFFE_ENFORCE_EQ(version, kVersion, "Unknown columnardb version");
+
+  columns_.resize(reader.Read<uint32_t>());
+  for (auto& column : columns_) {
+    column.data_type =
+        static_cast<TensorProto::DataType>(reader.Read<int32_t>());
+    column.dims.resize(reader.Read<uint32_t>());
+    for (auto& dim : column.dims) {
+      dim = reader.Read<int64_t>();
+    }
+    column.record_bytes = DataTypeToTypeMeta(column.data_type).itemsize() *
+        size_from_dim_(0, column.dims);
+  }
+
+  chunks_.resize(reader.Read<uint64_t>());
+  for (auto& chunk : chunks_) {
+    chunk.first_record = reader.Read<int64_t>();
+    chunk.num_records = reader.Read<int64_t>();
+    chunk.keys_offset = reader.Read<uint64_t>();
+    chunk.keys_bytes = reader.Read<uint64_t>();
+    CAFFE_ENFORCE_GT(chunk.num_records, 0);
+    CAFFE_ENFORCE_LE(chunk.keys_offset + chunk.keys_bytes, size_);
+    CAFFE_ENFORCE_GE(chunk.keys_bytes, chunk.num_records * 8);
+    chunk.columns.resize(columns_.size());
+    for (int i = 0; i < columns_.size(); ++i) {
+      auto& data = chunk.columns[i];
+      data.offset = reader.Read<uint64_t>();
+      data.stored_bytes = reader.Read<uint64_t>();
+      data.compression = static_cast<Compression>(reader.Read<uint8_t>());
+      CAFFE_ENFORCE_LE(data.offset + data.stored_bytes, size_);
+      CAFFE_ENFORCE_LE(data.compression, ZSTD, "Unknown compression");
+      if (data.compression == NONE) {
+        CAFFE_ENFORCE_EQ(
+            data.stored_bytes, chunk.num_records * columns_[i].record_bytes);
+      }
+    }
+  }
+}
+
+size_t ColumnarDB::FindChunk(int64_t record) const {
+  auto it = std::upper_bound(
+      chunks_.begin(),
+      chunks_.end(),
+      record,
+      [](int64_t record, const Chunk& chunk) {
+        return record < chunk.first_record;
+      });
+  return it - chunks_.begin() - 1;
+}
+
+string ColumnarDB::Key(size_t chunk, int64_t row) const {
+  const auto& current = chunks_[chunk];
+  const char* ends = data_ + current.keys_offset;
+  const char* keys = ends + current.num_records * 8;
+  uint64_t begin = 0;
+  uint64_t end;
+  if (row > 0) {
+    std::memcpy(&begin, ends + (row - 1) * 8, 8);
+  }
+  std::memcpy(&end, ends + row * 8, 8);
+  return string(keys + begin, end - begin);
+}
+
+const char* ColumnarDB::ColumnData(
+    size_t chunk,
+    int column,
+    std::vector<char>* scratch) const {
+  const auto& current = chunks_[chunk];
+  const auto& data = current.columns[column];
+  if (data.compression == NONE) {
+    return data_ + data.offset;
+  }
+#ifdef CAFFE2_USE_ZSTD
+  const size_t bytes = current.num_records * columns_[column].record_bytes;
+  scratch->resize(bytes);
+  auto size = ZSTD_decompress(
+      scratch->data(), bytes, data_ + data.offset, data.stored_bytes);
+  CAFFE_ENFORCE(!ZSTD_isError(size), ZSTD_getErrorName(size));
+  CAFFE_ENFORCE_EQ(size, bytes, "Corrupted columnardb chunk");
+  return scratch->data();
+#else
+  CAFFE_THROW(
+      "ColumnarDB ",
+      source_,
+      " is compressed with zstd, which needs a build with USE_ZSTD.");
+#endif
+}
+
+REGISTER_CAFFE2_DB(ColumnarDB, ColumnarDB);
+REGISTER_CAFFE2_DB(columnardb, ColumnarDB);
+
+}  // namespace db
+}  // namespace caffe2
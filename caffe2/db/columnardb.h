@@ -0,0 +1,127 @@
+#ifndef CAFFE2_DB_COLUMNARDB_H_
+#define CAFFE2_DB_COLUMNARDB_H_
+
+#include <cstdio>
+#include <vector>
+
+#include "caffe2/core/db.h"
+#include "caffe2/core/flags.h"
+#include "caffe2/core/tensor.h"
+
+CAFFE2_DECLARE_int(caffe2_columnardb_chunk_size);
+CAFFE2_DECLARE_string(caffe2_columnardb_compression);
+
+namespace caffe2 {
+namespace db {
+
+/**
+ * A db of records that are serialized TensorProtos with a fixed schema:
+ * the same number of tensors in every record, and the same data type and
+ * shape for the i-th tensor of every record. Instead of storing each record
+ * as a protobuf, it stores every tensor (column) of a chunk of records
+ * contiguously, so a batch of records is read without parsing protobufs.
+ *
+ * The file consists of the chunks, each with its keys and one blob per
+ * column, followed by an index of the schema and the chunks. The file is
+ * memory mapped for reading. Every column of a chunk can optionally be
+ * compressed with ZSTD (see --caffe2_columnardb_compression).
+ *
+ * Records are kept in insertion order, and only NEW and READ modes are
+ * supported. Records written with a Transaction are only guaranteed to be in
+ * the file after the db is closed, since partial chunks are written then.
+ *
+ * The cursor still returns serialized TensorProtos, so the db works with
+ * the existing readers; ReadBatch() is the fast path.
+ */
+class CAFFE2_API ColumnarDB : public DB {
+ public:
+  enum Compression : uint8_t {
+    NONE = 0,
+    ZSTD = 1,
+  };
+
+  struct Column {
+    TensorProto::DataType data_type;
+    // the shape of the column in a single record
+    std::vector<TIndex> dims;
+    size_t record_bytes;
+  };
+
+  struct Chunk {
+    struct ColumnData {
+      uint64_t offset;
+      uint64_t stored_bytes;
+      Compression compression;
+    };
+    int64_t first_record;
+    int64_t num_records;
+    uint64_t keys_offset;
+    uint64_t keys_bytes;
+    std::vector<ColumnData> columns;
+  };
+
+  ColumnarDB(const string& source, Mode mode);
+  ~ColumnarDB() override;
+
+  void Close() override;
+  unique_ptr<Cursor> NewCursor() override;
+  unique_ptr<Transaction> NewTransaction() override;
+
+  int64_t NumRecords() const;
+  const std::vector<Column>& columns() const {
+    return columns_;
+  }
+
+  /**
+   * Reads column `column` of the records [first, first + count) into output,
+   * which gets shape {count, dims of the column...}. If the records are all
+   * in one uncompressed chunk, output shares the memory mapped file and true
+   * is returned; output must then not be written to, and must not outlive
+   * the db. Otherwise the data is copied (and decompressed) and false is
+   * returned.
+   */
+  bool ReadBatch(int64_t first, int64_t count, int column, TensorCPU* output);
+
+ private:
+  friend class ColumnarDBCursor;
+  friend class ColumnarDBTransaction;
+
+  // Writing
+  void Put(const string& key, const string& value);
+  void Flush();
+  void WriteChunk();
+  void Write(const void* data, size_t size);
+  // Writes data at the next aligned offset of the file and returns it.
+  uint64_t WriteBlob(const void* data, size_t size);
+  void WriteIndex();
+
+  // Reading
+  void ReadIndex();
+  size_t FindChunk(int64_t record) const;
+  string Key(size_t chunk, int64_t row) const;
+  // Returns the column of a chunk, decompressing it into scratch if needed.
+  const char* ColumnData(size_t chunk, int column, std::vector<char>* scratch)
+      const;
+
+  string source_;
+  std::vector<Column> columns_;
+  std::vector<Chunk> chunks_;
+
+  FILE* file_;
+  uint64_t file_offset_;
+  size_t chunk_size_;
+  Compression compression_;
+  int compression_level_;
+  std::vector<string> pending_keys_;
+  std::vector<std::vector<char>> pending_columns_;
+
+  const char* data_;
+  size_t size_;
+
+  AT_DISABLE_COPY_AND_ASSIGN(ColumnarDB);
+};
+
+}  // namespace db
+}  // namespace caffe2
+
+#endif  // CAFFE2_DB_COLUMNARDB_H_
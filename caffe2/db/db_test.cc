@@ -6,6 +6,10 @@
 #include "caffe2/core/blob_serialization.h"
 #include "caffe2/core/db.h"
 #include "caffe2/core/logging.h"
+#include "caffe2/core/prefetching_cursor.h"
+#ifndef _MSC_VER
+#include "caffe2/db/columnardb.h"
+#endif
 #include "caffe2/proto/caffe2.pb.h"
 #include <gtest/gtest.h>
 
@@ -196,5 +200,127 @@ TEST(DBReaderShardedTest, Reader) {
   EXPECT_EQ(value, "05");
 }
 
+static void PrefetchingCursorTestWrapper(const string& db_type) {
+  std::string name = std::tmpnam(nullptr);
+  if (!CreateAndFill(db_type, name)) {
+    EXPECT_TRUE(0);
+    return;
+  }
+  std::unique_ptr<DB> db(CreateDB(db_type, name, READ));
+  PrefetchingCursor::Options options;
+  options.num_threads = 3;
+  options.buffer_size = 4;
+
+  // In order, the same as the plain cursor.
+  {
+    PrefetchingCursor cursor(db.get(), options);
+    for (int epoch = 0; epoch < 2; ++epoch) {
+      for (int i = 0; i < kMaxItems; ++i) {
+        std::stringstream ss;
+        ss << std::setw(2) << std::setfill('0') << i;
+        EXPECT_TRUE(cursor.Valid());
+        EXPECT_EQ(cursor.key(), ss.str());
+        EXPECT_EQ(cursor.value(), ss.str());
+        cursor.Next();
+      }
+      EXPECT_FALSE(cursor.Valid());
+      cursor.SeekToFirst();
+    }
+  }
+
+  // Shuffled and sharded, every record of the shard exactly once per epoch.
+  if (db_type != "minidb") {
+    options.num_shards = 3;
+    options.shard_id = 1;
+    options.shuffle = true;
+    PrefetchingCursor cursor(db.get(), options);
+    EXPECT_EQ(cursor.NumRecords(), 3);
+    for (int epoch = 0; epoch < 2; ++epoch) {
+      std::set<string> keys;
+      while (cursor.Valid()) {
+        EXPECT_EQ(cursor.key(), cursor.value());
+        keys.insert(cursor.key());
+        cursor.Next();
+      }
+      EXPECT_EQ(keys, (std::set<string>{"01", "04", "07"}));
+      cursor.SeekToFirst();
+    }
+  }
+}
+
+TEST(PrefetchingCursorTest, MiniDB) {
+  PrefetchingCursorTestWrapper("minidb");
+}
+
+TEST(PrefetchingCursorTest, LevelDB) {
+  PrefetchingCursorTestWrapper("leveldb");
+}
+
+TEST(PrefetchingCursorTest, LMDB) {
+  PrefetchingCursorTestWrapper("lmdb");
+}
+
+#ifndef _MSC_VER
+TEST(ColumnarDBTest, ReadWrite) {
+  std::string name = std::tmpnam(nullptr);
+  auto chunk_size = FLAGS_caffe2_columnardb_chunk_size;
+  FLAGS_caffe2_columnardb_chunk_size = 4;
+  {
+    std::unique_ptr<DB> db(CreateDB("columnardb", name, NEW));
+    std::unique_ptr<Transaction> trans(db->NewTransaction());
+    for (int i = 0; i < kMaxItems; ++i) {
+      TensorProtos protos;
+      auto* features = protos.add_protos();
+      features->set_data_type(TensorProto::FLOAT);
+      features->add_dims(2);
+      features->add_float_data(i);
+      features->add_float_data(-i);
+      auto* label = protos.add_protos();
+      label->set_data_type(TensorProto::INT32);
+      label->add_int32_data(i);
+      std::stringstream ss;
+      ss << std::setw(2) << std::setfill('0') << i;
+      trans->Put(ss.str(), protos.SerializeAsString());
+    }
+    trans->Commit();
+  }
+  FLAGS_caffe2_columnardb_chunk_size = chunk_size;
+
+  std::unique_ptr<DB> db(CreateDB("columnardb", name, READ));
+  auto* columnar = dynamic_cast<ColumnarDB*>(db.get());
+  ASSERT_TRUE(columnar != nullptr);
+  EXPECT_EQ(columnar->NumRecords(), kMaxItems);
+  ASSERT_EQ(columnar->columns().size(), 2);
+
+  // The cursor returns the records the way they were written.
+  std::unique_ptr<Cursor> cursor(db->NewCursor());
+  for (int i = 0; i < kMaxItems; ++i) {
+    ASSERT_TRUE(cursor->Valid());
+    std::stringstream ss;
+    ss << std::setw(2) << std::setfill('0') << i;
+    EXPECT_EQ(cursor->key(), ss.str());
+    TensorProtos protos;
+    ASSERT_TRUE(protos.ParseFromString(cursor->value()));
+    ASSERT_EQ(protos.protos_size(), 2);
+    EXPECT_EQ(protos.protos(0).float_data(1), -i);
+    EXPECT_EQ(protos.protos(1).int32_data(0), i);
+    cursor->Next();
+  }
+  EXPECT_FALSE(cursor->Valid());
+
+  // Records 4 to 7 are one chunk and read in place, 2 to 5 span two.
+  TensorCPU batch(CPU);
+  EXPECT_TRUE(columnar->ReadBatch(4, 4, 0, &batch));
+  EXPECT_EQ(batch.dims(), (vector<TIndex>{4, 2}));
+  EXPECT_EQ(batch.data<float>()[2], 5);
+  EXPECT_EQ(batch.data<float>()[3], -5);
+  EXPECT_FALSE(columnar->ReadBatch(2, 4, 1, &batch));
+  EXPECT_EQ(batch.dims(), (vector<TIndex>{4}));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(batch.data<int>()[i], i + 2);
+  }
+}
+#endif
+
 }  // namespace db
 }  // namespace caffe2
@@ -68,6 +68,14 @@ class LMDBCursor : public Cursor {
         mdb_value_.mv_size);
   }
 
+  // The value lives in the memory mapped db and stays there until the read
+  // transaction, which the cursor owns, ends.
+  bool ValueView(const char** data, size_t* size) override {
+    *data = static_cast<const char*>(mdb_value_.mv_data);
+    *size = mdb_value_.mv_size;
+    return true;
+  }
+
   bool Valid() override { return valid_; }
 
  private:
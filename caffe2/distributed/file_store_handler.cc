@@ -16,6 +16,12 @@
 #include <direct.h> // for _mkdir
 #endif
 
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
 #include "caffe2/utils/murmur_hash3.h"
 
 namespace caffe2 {
@@ -144,17 +150,52 @@ bool FileStoreHandler::check(const std::vector<std::string>& names) {
 void FileStoreHandler::wait(
     const std::vector<std::string>& names,
     const std::chrono::milliseconds& timeout) {
-  // Not using inotify because it doesn't work on many
-  // shared filesystems (such as NFS).
+#if defined(__linux__)
+  // Files are created by renaming them into the base directory, so inotify
+  // wakes us up as soon as a key is set, instead of after a sleep. inotify
+  // doesn't see changes made by other hosts on many shared filesystems (such
+  // as NFS), so the keys are still checked periodically.
+  int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd != -1 &&
+      inotify_add_watch(fd, basePath_.c_str(), IN_MOVED_TO | IN_CREATE) ==
+          -1) {
+    close(fd);
+    fd = -1;
+  }
+#endif
+
   const auto start = std::chrono::steady_clock::now();
+  bool timedOut = false;
   while (!check(names)) {
     const auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
         std::chrono::steady_clock::now() - start);
     if (timeout != kNoTimeout && elapsed > timeout) {
-      STORE_HANDLER_TIMEOUT("Wait timeout for name(s): ", Join(" ", names));
+      timedOut = true;
+      break;
+    }
+#if defined(__linux__)
+    if (fd != -1) {
+      struct pollfd pfd = {fd, POLLIN, 0};
+      if (poll(&pfd, 1, 100) > 0) {
+        // Drain the events, we only need to know that there were some
+        std::array<char, 4096> buf;
+        while (read(fd, buf.data(), buf.size()) > 0) {
+        }
+      }
+      continue;
     }
+#endif
     /* sleep override */
     std::this_thread::sleep_for(std::chrono::milliseconds(10));
   }
+
+#if defined(__linux__)
+  if (fd != -1) {
+    close(fd);
+  }
+#endif
+  if (timedOut) {
+    STORE_HANDLER_TIMEOUT("Wait timeout for name(s): ", Join(" ", names));
+  }
 }
 }
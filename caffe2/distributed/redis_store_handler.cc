@@ -30,37 +30,109 @@ std::string RedisStoreHandler::compoundKey(const std::string& name) {
   return prefix_ + name;
 }
 
-void RedisStoreHandler::set(const std::string& name, const std::string& data) {
-  auto key = compoundKey(name);
-  void* ptr = redisCommand(
-      redis_,
-      "SETNX %b %b",
-      key.c_str(),
-      (size_t)key.size(),
-      data.c_str(),
-      (size_t)data.size());
+RedisStoreHandler::Reply RedisStoreHandler::command(
+    const std::vector<std::string>& args) {
+  std::vector<const char*> argv;
+  std::vector<size_t> argvlen;
+  for (const auto& arg : args) {
+    argv.push_back(arg.c_str());
+    argvlen.push_back(arg.length());
+  }
+
+  auto argc = argv.size();
+  void* ptr = redisCommandArgv(redis_, argc, argv.data(), argvlen.data());
   CAFFE_ENFORCE_NE(ptr, (void*)nullptr, redis_->errstr);
-  redisReply* reply = static_cast<redisReply*>(ptr);
-  CAFFE_ENFORCE_EQ(reply->type, REDIS_REPLY_INTEGER);
-  CAFFE_ENFORCE_EQ(
-      reply->integer,
-      1,
+  return Reply(static_cast<redisReply*>(ptr));
+}
+
+RedisStoreHandler::Reply RedisStoreHandler::nextReply() {
+  void* ptr = nullptr;
+  auto rv = redisGetReply(redis_, &ptr);
+  CAFFE_ENFORCE_EQ(rv, REDIS_OK, redis_->errstr);
+  CAFFE_ENFORCE_NE(ptr, (void*)nullptr, redis_->errstr);
+  return Reply(static_cast<redisReply*>(ptr));
+}
+
+void RedisStoreHandler::set(const std::string& name, const std::string& data) {
+  multiSet({name}, {data});
+}
+
+void RedisStoreHandler::multiSet(
+    const std::vector<std::string>& names,
+    const std::vector<std::string>& data) {
+  CAFFE_ENFORCE_EQ(names.size(), data.size());
+
+  // Pipeline the commands, so that setting many keys takes a single
+  // round trip rather than one per key
+  for (size_t i = 0; i < names.size(); i++) {
+    auto key = compoundKey(names[i]);
+    auto rv = redisAppendCommand(
+        redis_,
+        "SETNX %b %b",
+        key.c_str(),
+        (size_t)key.size(),
+        data[i].c_str(),
+        (size_t)data[i].size());
+    CAFFE_ENFORCE_EQ(rv, REDIS_OK, redis_->errstr);
+  }
+
+  // Read all replies before failing, to keep the connection usable
+  std::vector<std::string> alreadySet;
+  for (const auto& name : names) {
+    auto reply = nextReply();
+    CAFFE_ENFORCE_EQ(reply->type, REDIS_REPLY_INTEGER);
+    if (reply->integer != 1) {
+      alreadySet.push_back(name);
+    }
+  }
+  CAFFE_ENFORCE(
+      alreadySet.empty(),
       "Value at ",
-      name,
+      Join(" ", alreadySet),
       " was already set",
       " (perhaps you reused a run ID you have used before?)");
 }
 
 std::string RedisStoreHandler::get(const std::string& name) {
-  // Block until key is set
-  wait({name});
+  return multiGet({name})[0];
+}
 
-  auto key = compoundKey(name);
-  void* ptr = redisCommand(redis_, "GET %b", key.c_str(), (size_t)key.size());
-  CAFFE_ENFORCE_NE(ptr, (void*)nullptr, redis_->errstr);
-  redisReply* reply = static_cast<redisReply*>(ptr);
-  CAFFE_ENFORCE_EQ(reply->type, REDIS_REPLY_STRING);
-  return std::string(reply->str, reply->len);
+std::vector<std::string> RedisStoreHandler::multiGet(
+    const std::vector<std::string>& names) {
+  std::vector<std::string> args;
+  args.push_back("MGET");
+  for (const auto& name : names) {
+    args.push_back(compoundKey(name));
+  }
+
+  // Block until all keys are set. MGET returns nil for the missing keys, so
+  // polling it both waits for the keys and reads them, in a single command.
+  const auto start = std::chrono::steady_clock::now();
+  while (true) {
+    auto reply = command(args);
+    CAFFE_ENFORCE_EQ(reply->type, REDIS_REPLY_ARRAY);
+    CAFFE_ENFORCE_EQ(reply->elements, names.size());
+    std::vector<std::string> data;
+    for (size_t i = 0; i < reply->elements; i++) {
+      const auto* element = reply->element[i];
+      if (element->type == REDIS_REPLY_NIL) {
+        break;
+      }
+      CAFFE_ENFORCE_EQ(element->type, REDIS_REPLY_STRING);
+      data.emplace_back(element->str, element->len);
+    }
+    if (data.size() == names.size()) {
+      return data;
+    }
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now() - start);
+    if (elapsed > kDefaultTimeout) {
+      STORE_HANDLER_TIMEOUT("Wait timeout for name(s): ", Join(" ", names));
+    }
+    /* sleep override */
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
 }
 
 int64_t RedisStoreHandler::add(const std::string& name, int64_t value) {
@@ -68,29 +140,20 @@ int64_t RedisStoreHandler::add(const std::string& name, int64_t value) {
   void* ptr = redisCommand(
       redis_, "INCRBY %b %ld", key.c_str(), (size_t)key.size(), value);
   CAFFE_ENFORCE_NE(ptr, (void*)nullptr, redis_->errstr);
-  redisReply* reply = static_cast<redisReply*>(ptr);
+  Reply reply(static_cast<redisReply*>(ptr));
   CAFFE_ENFORCE_EQ(reply->type, REDIS_REPLY_INTEGER);
   return reply->integer;
 }
 
 bool RedisStoreHandler::check(const std::vector<std::string>& names) {
+  // A single EXISTS for all keys. Unlike MGET it doesn't send the values.
   std::vector<std::string> args;
   args.push_back("EXISTS");
   for (const auto& name : names) {
     args.push_back(compoundKey(name));
   }
 
-  std::vector<const char*> argv;
-  std::vector<size_t> argvlen;
-  for (const auto& arg : args) {
-    argv.push_back(arg.c_str());
-    argvlen.push_back(arg.length());
-  }
-
-  auto argc = argv.size();
-  void* ptr = redisCommandArgv(redis_, argc, argv.data(), argvlen.data());
-  CAFFE_ENFORCE_NE(ptr, (void*)nullptr, redis_->errstr);
-  redisReply* reply = static_cast<redisReply*>(ptr);
+  auto reply = command(args);
   CAFFE_ENFORCE_EQ(reply->type, REDIS_REPLY_INTEGER);
   return reply->integer == names.size();
 }
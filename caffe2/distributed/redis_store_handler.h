@@ -6,7 +6,9 @@ extern "C" {
 #include <hiredis/hiredis.h>
 }
 
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace caffe2 {
 
@@ -19,6 +21,13 @@ class CAFFE2_API RedisStoreHandler : public StoreHandler {
 
   virtual std::string get(const std::string& name) override;
 
+  virtual void multiSet(
+      const std::vector<std::string>& names,
+      const std::vector<std::string>& data) override;
+
+  virtual std::vector<std::string> multiGet(
+      const std::vector<std::string>& names) override;
+
   virtual int64_t add(const std::string& name, int64_t value) override;
 
   virtual bool check(const std::vector<std::string>& names) override;
@@ -34,7 +43,20 @@ class CAFFE2_API RedisStoreHandler : public StoreHandler {
 
   redisContext* redis_;
 
+  struct ReplyDeleter {
+    void operator()(redisReply* reply) const {
+      freeReplyObject(reply);
+    }
+  };
+  using Reply = std::unique_ptr<redisReply, ReplyDeleter>;
+
   std::string compoundKey(const std::string& name);
+
+  // Runs a command given as a list of arguments
+  Reply command(const std::vector<std::string>& args);
+
+  // Reads the reply of the next pipelined command
+  Reply nextReply();
 };
 
 } // namespace caffe2
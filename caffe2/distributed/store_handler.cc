@@ -2,6 +2,7 @@
 
 #include <memory>
 
+#include "caffe2/core/logging.h"
 #include "caffe2/core/typeid.h"
 
 namespace caffe2 {
@@ -14,6 +15,27 @@ StoreHandler::~StoreHandler() {
   // symbols for this abstract class.
 }
 
+void StoreHandler::multiSet(
+    const std::vector<std::string>& names,
+    const std::vector<std::string>& data) {
+  CAFFE_ENFORCE_EQ(names.size(), data.size());
+  for (size_t i = 0; i < names.size(); i++) {
+    set(names[i], data[i]);
+  }
+}
+
+std::vector<std::string> StoreHandler::multiGet(
+    const std::vector<std::string>& names) {
+  // Wait for all keys at once rather than one after the other
+  wait(names);
+  std::vector<std::string> data;
+  data.reserve(names.size());
+  for (const auto& name : names) {
+    data.push_back(get(name));
+  }
+  return data;
+}
+
 CAFFE_KNOWN_TYPE(std::unique_ptr<StoreHandler>);
 
 } // namespace caffe2
@@ -32,6 +32,21 @@ class CAFFE2_API StoreHandler {
    */
   virtual std::string get(const std::string& name) = 0;
 
+  /*
+   * Set data for several keys, like calling set for each of them.
+   * Handlers that can batch the writes override this.
+   */
+  virtual void multiSet(
+      const std::vector<std::string>& names,
+      const std::vector<std::string>& data);
+
+  /*
+   * Get the data for several keys, like calling get for each of them.
+   * Handlers that can batch the reads override this.
+   */
+  virtual std::vector<std::string> multiGet(
+      const std::vector<std::string>& names);
+
   /*
    * Does an atomic add operation on the key and returns the latest updated
    * value.
@@ -19,6 +19,13 @@ namespace caffe2 {
  * purpose.
  *
  * All the input and output of the original operator should be TensorCPU.
+ * Inputs in the plain (public) format are shared with the CPU operator as
+ * they are, only inputs in a blocked MKL-DNN format are reordered, into a
+ * buffer that is kept across runs. Float outputs are returned as plain
+ * ideep tensors sharing the memory of the CPU outputs, so a chain of
+ * fallback operators only converts at its ends. To have a blocked tensor
+ * read by several fallback operators reordered once, see
+ * groupFallbackReordersForIdeep in caffe2/opt/optimize_ideep.cc.
  *
  * Example usage: if you have a class MyMagicOp that is CPU based, and you use
  * the registration code
@@ -66,6 +73,7 @@ class IDEEPFallbackOp final : public IDEEPOperator {
     for (const string& name : base_def_.input()) {
       local_input_blobs_.push_back(local_ws_->CreateBlob(name));
       CHECK_NOTNULL(local_input_blobs_.back());
+      reorder_buffers_.emplace_back(CPU);
     }
     base_op_.reset(new CPUOp(base_def_, local_ws_.get()));
   }
@@ -79,7 +87,12 @@ class IDEEPFallbackOp final : public IDEEPOperator {
         if (input.is_public_format()) {
           dtensor->ShareExternalPointer(static_cast<float*>(input.get_data_handle()));
         } else {
-          input.reorder_to(dtensor->template mutable_data<float>());
+          // Not into dtensor, which may still share the memory of the
+          // input of a previous run.
+          auto& buffer = reorder_buffers_[i];
+          buffer.Resize(input.get_dims());
+          input.reorder_to(buffer.template mutable_data<float>());
+          dtensor->ShareData(buffer);
         }
       } else if (
           InputIsType<itensor>(i) &&
@@ -91,7 +104,10 @@ class IDEEPFallbackOp final : public IDEEPOperator {
           dtensor->ShareExternalPointer(
               static_cast<long*>(input.get_data_handle()));
         } else {
-          input.reorder_to(dtensor->template mutable_data<long>());
+          auto& buffer = reorder_buffers_[i];
+          buffer.Resize(input.get_dims());
+          input.reorder_to(buffer.template mutable_data<long>());
+          dtensor->ShareData(buffer);
         }
       } else {
         VLOG(1) << "Input " << i << " is not ideep::tensor. Skipping copy.";
@@ -159,6 +175,8 @@ class IDEEPFallbackOp final : public IDEEPOperator {
  protected:
   vector<Blob*> local_input_blobs_;
   vector<Blob*> local_output_blobs_;
+  // Where the inputs in a blocked format are reordered to.
+  vector<Tensor> reorder_buffers_;
   std::unique_ptr<CPUOp> base_op_;
   std::unique_ptr<Workspace> local_ws_;
   OperatorDef base_def_;
@@ -86,6 +86,10 @@ The dimension of the output image will always be cropxcrop
     .Arg("use_caffe_datum", "1 if the input is in Caffe format. Defaults to 0")
     .Arg("use_gpu_transform", "1 if GPU acceleration should be used."
          " Defaults to 0. Can only be 1 in a CUDAContext")
+    .Arg("use_gpu_decode", "1 to decode the JPEG images with nvJPEG and crop"
+         " and resize them on the GPU, while the next batch is read from the"
+         " db. Needs use_gpu_transform and a build with nvJPEG; color jitter"
+         " and lighting are not applied. Defaults to 0")
     .Arg("decode_threads", "Number of CPU decode/transform threads."
          " Defaults to 4")
     .Arg("output_type", "If gpu_transform, can set to FLOAT or FLOAT16.")
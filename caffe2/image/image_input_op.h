@@ -6,6 +6,7 @@
 
 #include <iostream>
 #include <algorithm>
+#include <future>
 
 #include "caffe2/core/common.h"
 #include "caffe2/core/db.h"
@@ -19,6 +20,7 @@
 namespace caffe2 {
 
 class CUDAContext;
+class NvJpegDecoder;
 
 template <class Context>
 class ImageInputOp final
@@ -76,13 +78,24 @@ class ImageInputOp final
 
   bool GetImageAndLabelAndInfoFromDBValue(
       const string& value, cv::Mat* img, PerImageArg& info, int item_id,
-      std::mt19937* randgen);
+      std::mt19937* randgen, string* encoded_image = nullptr);
   void DecodeAndTransform(
       const std::string& value, float *image_data, int item_id,
       const int channels, std::size_t thread_index);
   void DecodeAndTransposeOnly(
       const std::string& value, uint8_t *image_data, int item_id,
       const int channels, std::size_t thread_index);
+  // For use_gpu_decode: parses the labels and keeps the encoded image
+  void ParseOnly(const std::string& value, int item_id,
+                 std::size_t thread_index);
+  std::vector<std::string> ReadBatch();
+  // Computes where to crop a decoded image, the same way the CPU path
+  // scales and crops it
+  GPUImageCrop ComputeCrop(int height, int width, const PerImageArg& info,
+                           std::mt19937* randgen);
+  // Decodes the parsed images on the GPU, and crops and resizes them into
+  // prefetched_image_on_device_. Only the CUDA op implements it.
+  void DecodeOnGPU();
 
   unique_ptr<db::DBReader> owned_reader_;
   const db::DBReader* reader_;
@@ -124,8 +137,18 @@ class ImageInputOp final
   bool is_test_;
   bool use_caffe_datum_;
   bool gpu_transform_;
+  bool gpu_decode_;
   bool mean_std_copied_ = false;
 
+  // use_gpu_decode state: the next batch is read from the db while the
+  // current one is decoded
+  std::future<std::vector<std::string>> next_batch_;
+  std::vector<std::string> encoded_images_;
+  std::vector<PerImageArg> image_args_;
+  std::shared_ptr<NvJpegDecoder> gpu_decoder_;
+  Tensor crops_{CPU};
+  Tensor crops_on_device_{Context::GetDeviceType()};
+
   // thread pool for parse + decode
   int num_decode_threads_;
   int additional_inputs_offset_;
@@ -193,6 +216,9 @@ ImageInputOp<Context>::ImageInputOp(
       gpu_transform_(OperatorBase::template GetSingleArgument<int>(
           "use_gpu_transform",
           0)),
+      gpu_decode_(OperatorBase::template GetSingleArgument<int>(
+          "use_gpu_decode",
+          0)),
       num_decode_threads_(
           OperatorBase::template GetSingleArgument<int>("decode_threads", 4)),
       thread_pool_(std::make_shared<TaskThreadPool>(num_decode_threads_)),
@@ -293,6 +319,19 @@ ImageInputOp<Context>::ImageInputOp(
       "If the output sizes are specified, they must be specified for all "
       "additional outputs");
 
+  if (gpu_decode_) {
+#ifndef CAFFE2_USE_NVJPEG
+    CAFFE_THROW("use_gpu_decode needs Caffe2 to be built with nvJPEG.");
+#endif
+    CAFFE_ENFORCE(
+        Context::GetDeviceType() == CUDA,
+        "use_gpu_decode is only supported by the CUDA op");
+    CAFFE_ENFORCE(gpu_transform_, "use_gpu_decode needs use_gpu_transform");
+    CAFFE_ENFORCE(
+        !use_caffe_datum_ && color_,
+        "use_gpu_decode only supports color images in TensorProtos");
+  }
+
   CAFFE_ENFORCE(random_scale_.size() == 2,
       "Must provide [scale_min, scale_max]");
   CAFFE_ENFORCE_GE(random_scale_[1], random_scale_[0],
@@ -318,6 +357,9 @@ ImageInputOp<Context>::ImageInputOp(
   if (gpu_transform_) {
     LOG(INFO) << "    Performing transformation on GPU";
   }
+  if (gpu_decode_) {
+    LOG(INFO) << "    Decoding, cropping and resizing on GPU";
+  }
   LOG(INFO) << "    Outputting in batches of " << batch_size_ << " images;";
   LOG(INFO) << "    Treating input image as "
             << (color_ ? "color " : "grayscale ") << "image;";
@@ -439,7 +481,8 @@ bool ImageInputOp<Context>::GetImageAndLabelAndInfoFromDBValue(
     cv::Mat* img,
     PerImageArg& info,
     int item_id,
-    std::mt19937* randgen) {
+    std::mt19937* randgen,
+    string* encoded_image) {
   //
   // recommend using --caffe2_use_fatal_for_enforce=1 when using ImageInputOp
   // as this function runs on a worker thread and the exceptions from
@@ -526,7 +569,14 @@ bool ImageInputOp<Context>::GetImageAndLabelAndInfoFromDBValue(
       info.bounding_params.width = bounding_proto.int32_data(3);
     }
 
-    if (image_proto.data_type() == TensorProto::STRING) {
+    CAFFE_ENFORCE(
+        !encoded_image || image_proto.data_type() == TensorProto::STRING,
+        "GPU decoding needs encoded images");
+    if (encoded_image) {
+      DCHECK_EQ(image_proto.string_data_size(), 1);
+      // decoded later, with the rest of the batch
+      *encoded_image = image_proto.string_data(0);
+    } else if (image_proto.data_type() == TensorProto::STRING) {
       // encoded image string.
       DCHECK_EQ(image_proto.string_data_size(), 1);
       const string& encoded_image_str = image_proto.string_data(0);
@@ -672,6 +722,10 @@ bool ImageInputOp<Context>::GetImageAndLabelAndInfoFromDBValue(
         LOG(FATAL) << "Unsupported output type.";
       }
     }
+
+    if (encoded_image) {
+      return true;
+    }
   }
 
   //
@@ -1101,6 +1155,119 @@ void ImageInputOp<Context>::DecodeAndTransposeOnly(
                               randgen, &mirror_this_image, is_test_);
 }
 
+template <class Context>
+void ImageInputOp<Context>::ParseOnly(
+    const std::string& value, int item_id, std::size_t thread_index) {
+  CAFFE_ENFORCE((int)thread_index < num_decode_threads_);
+
+  std::mt19937* randgen = &(randgen_per_thread_[thread_index]);
+  cv::Mat img;
+  CHECK(GetImageAndLabelAndInfoFromDBValue(
+      value, &img, image_args_[item_id], item_id, randgen,
+      &encoded_images_[item_id]));
+}
+
+template <class Context>
+std::vector<std::string> ImageInputOp<Context>::ReadBatch() {
+  std::vector<std::string> values(batch_size_);
+  std::string key;
+  for (auto& value : values) {
+    reader_->Read(&key, &value);
+  }
+  return values;
+}
+
+template <class Context>
+GPUImageCrop ImageInputOp<Context>::ComputeCrop(
+    int height, int width, const PerImageArg& info, std::mt19937* randgen) {
+  GPUImageCrop crop;
+  crop.image = nullptr;
+  crop.image_height = height;
+  crop.image_width = width;
+
+  // the region of the image to use, see GetImageAndLabelAndInfoFromDBValue
+  float x = 0, y = 0;
+  if (info.bounding_params.valid &&
+      height >= info.bounding_params.ymin + info.bounding_params.height &&
+      width >= info.bounding_params.xmin + info.bounding_params.width) {
+    x = info.bounding_params.xmin;
+    y = info.bounding_params.ymin;
+    height = info.bounding_params.height;
+    width = info.bounding_params.width;
+  }
+
+  std::bernoulli_distribution mirror_this_image(0.5f);
+  crop.mirror = !is_test_ && mirror_ && mirror_this_image(*randgen);
+
+  if (scale_jitter_type_ == INCEPTION_STYLE && !is_test_) {
+    // as RandomSizedCropping, which resizes the region straight to the crop
+    int area = height * width;
+    std::uniform_real_distribution<> area_dis(0.08, 1.0);
+    std::uniform_real_distribution<> aspect_ratio_dis(3.0 / 4.0, 4.0 / 3.0);
+    for (int i = 0; i < 10; ++i) {
+      int target_area = int(ceil(area_dis(*randgen) * area));
+      float aspect_ratio = aspect_ratio_dis(*randgen);
+      int nh = floor(std::sqrt(((float)target_area / aspect_ratio)));
+      int nw = floor(std::sqrt(((float)target_area * aspect_ratio)));
+      if (nh >= 1 && nh <= height && nw >= 1 && nw <= width) {
+        crop.y = y + std::uniform_int_distribution<>(0, height - nh)(*randgen);
+        crop.x = x + std::uniform_int_distribution<>(0, width - nw)(*randgen);
+        crop.height = nh;
+        crop.width = nw;
+        return crop;
+      }
+    }
+  }
+
+  int scale_to_use = scale_ > 0 ? scale_ : minsize_;
+  if (random_scaling_) {
+    scale_to_use = std::uniform_int_distribution<>(
+        random_scale_[0], random_scale_[1])(*randgen);
+  }
+  int scaled_width, scaled_height;
+  if (warp_) {
+    scaled_width = scale_to_use;
+    scaled_height = scale_to_use;
+  } else if (height > width) {
+    scaled_width = scale_to_use;
+    scaled_height = static_cast<float>(height) * scale_to_use / width;
+  } else {
+    scaled_height = scale_to_use;
+    scaled_width = static_cast<float>(width) * scale_to_use / height;
+  }
+  if (!(scale_ > 0 || scaled_height > height || scaled_width > width)) {
+    // minsize only scales images up
+    scaled_height = height;
+    scaled_width = width;
+  }
+  CAFFE_ENFORCE_GE(scaled_height, crop_, "Image height must be bigger than crop.");
+  CAFFE_ENFORCE_GE(scaled_width, crop_, "Image width must be bigger than crop.");
+
+  int height_offset, width_offset;
+  if (is_test_) {
+    height_offset = (scaled_height - crop_) / 2;
+    width_offset = (scaled_width - crop_) / 2;
+  } else {
+    height_offset =
+        std::uniform_int_distribution<>(0, scaled_height - crop_)(*randgen);
+    width_offset =
+        std::uniform_int_distribution<>(0, scaled_width - crop_)(*randgen);
+  }
+  // map the crop of the scaled image back to the image
+  const float ratio_y = static_cast<float>(height) / scaled_height;
+  const float ratio_x = static_cast<float>(width) / scaled_width;
+  crop.y = y + height_offset * ratio_y;
+  crop.x = x + width_offset * ratio_x;
+  crop.height = crop_ * ratio_y;
+  crop.width = crop_ * ratio_x;
+  return crop;
+}
+
+template <class Context>
+void ImageInputOp<Context>::DecodeOnGPU() {
+  CAFFE_THROW("use_gpu_decode is only supported by the CUDA op");
+}
+
 
 template <class Context>
 bool ImageInputOp<Context>::Prefetch() {
@@ -1122,12 +1289,26 @@ bool ImageInputOp<Context>::Prefetch() {
   prefetched_label_.mutable_data<int>();
   // Prefetching handled with a thread pool of "decode_threads" threads.
 
+  std::vector<std::string> values;
+  if (gpu_decode_) {
+    // Read the next batch while this one is parsed and decoded.
+    values = next_batch_.valid() ? next_batch_.get() : ReadBatch();
+    next_batch_ = std::async(
+        std::launch::async, &ImageInputOp<Context>::ReadBatch, this);
+    encoded_images_.resize(batch_size_);
+    image_args_.resize(batch_size_);
+  }
+
   for (int item_id = 0; item_id < batch_size_; ++item_id) {
     std::string key, value;
     cv::Mat img;
 
     // read data
-    reader_->Read(&key, &value);
+    if (gpu_decode_) {
+      value = std::move(values[item_id]);
+    } else {
+      reader_->Read(&key, &value);
+    }
 
     // determine label type based on first item
     if( item_id == 0 ) {
@@ -1169,7 +1350,14 @@ bool ImageInputOp<Context>::Prefetch() {
 
     // launch into thread pool for processing
     // TODO: support color jitter and color lighting in gpu_transform
-    if (gpu_transform_) {
+    if (gpu_decode_) {
+      thread_pool_->runTaskWithID(std::bind(
+          &ImageInputOp<Context>::ParseOnly,
+          this,
+          std::string(value),
+          item_id,
+          std::placeholders::_1));
+    } else if (gpu_transform_) {
       // output of decode will still be int8
       uint8_t* image_data = prefetched_image_.mutable_data<uint8_t>() +
           crop_ * crop_ * channels * item_id;
@@ -1196,6 +1384,10 @@ bool ImageInputOp<Context>::Prefetch() {
   }
   thread_pool_->waitWorkComplete();
 
+  if (gpu_decode_) {
+    DecodeOnGPU();
+  }
+
   // we allow to get at most max_decode_error_ratio from
   // opencv imdecode until raising a runtime exception
   if ((float)num_decode_errors_in_batch_ / batch_size_ >
@@ -1208,7 +1400,9 @@ bool ImageInputOp<Context>::Prefetch() {
   // If the context is not CPUContext, we will need to do a copy in the
   // prefetch function as well.
   if (!std::is_same<Context, CPUContext>::value) {
-    prefetched_image_on_device_.CopyFrom(prefetched_image_, &cpu_context_);
+    if (!gpu_decode_) {
+      prefetched_image_on_device_.CopyFrom(prefetched_image_, &cpu_context_);
+    }
     prefetched_label_on_device_.CopyFrom(prefetched_label_, &cpu_context_);
 
     for (int i = 0; i < prefetched_additional_outputs_on_device_.size(); ++i) {
@@ -1,9 +1,55 @@
 #include "caffe2/core/common_gpu.h"
 #include "caffe2/core/context_gpu.h"
 #include "caffe2/image/image_input_op.h"
+#include "caffe2/image/nvjpeg_decoder.h"
 
 namespace caffe2 {
 
+template <>
+void ImageInputOp<CUDAContext>::DecodeOnGPU() {
+#ifdef CAFFE2_USE_NVJPEG
+  if (!gpu_decoder_) {
+    gpu_decoder_ = std::make_shared<NvJpegDecoder>();
+  }
+  const int channels = 3;
+  crops_.Resize(batch_size_ * sizeof(GPUImageCrop));
+  auto* crops = reinterpret_cast<GPUImageCrop*>(crops_.mutable_data<uint8_t>());
+  // the decode threads are done, so their generator is free
+  std::mt19937* randgen = &randgen_per_thread_[0];
+  for (int item_id = 0; item_id < batch_size_; ++item_id) {
+    const uint8_t* image;
+    int height, width;
+    if (!gpu_decoder_->Decode(
+            encoded_images_[item_id],
+            item_id,
+            context_.cuda_stream(),
+            &image,
+            &height,
+            &width)) {
+      num_decode_errors_in_batch_++;
+    }
+    crops[item_id] = ComputeCrop(height, width, image_args_[item_id], randgen);
+    crops[item_id].image = image;
+  }
+
+  crops_on_device_.CopyFrom(crops_, &context_);
+  prefetched_image_on_device_.Resize(
+      TIndex(batch_size_), TIndex(crop_), TIndex(crop_), TIndex(channels));
+  // PrefetchWorker waits for the stream before the batch is used
+  CropResizeOnGPU(
+      reinterpret_cast<const GPUImageCrop*>(
+          crops_on_device_.data<uint8_t>()),
+      batch_size_,
+      channels,
+      crop_,
+      crop_,
+      prefetched_image_on_device_.mutable_data<uint8_t>(),
+      &context_);
+#else
+  CAFFE_THROW("use_gpu_decode needs Caffe2 to be built with nvJPEG.");
+#endif
+}
+
 REGISTER_CUDA_OPERATOR(ImageInput, ImageInputOp<CUDAContext>);
 
 }  // namespace caffe2
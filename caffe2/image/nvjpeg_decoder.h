@@ -0,0 +1,56 @@
+#ifndef CAFFE2_IMAGE_NVJPEG_DECODER_H_
+#define CAFFE2_IMAGE_NVJPEG_DECODER_H_
+
+#include "caffe2/core/common.h"
+
+#ifdef CAFFE2_USE_NVJPEG
+
+#include <nvjpeg.h>
+
+#include "caffe2/core/context_gpu.h"
+
+namespace caffe2 {
+
+/**
+ * Decodes JPEG images on the GPU with nvJPEG, into interleaved BGR images
+ * (the layout cv::imdecode produces) in device memory that the decoder
+ * keeps, one buffer per index so the images of a batch can all be used
+ * together. nvJPEG does the Huffman decoding on the calling thread and
+ * the rest of the decoding on the given stream, so a decoded image is only
+ * ready once the stream gets there.
+ *
+ * A decoder is not thread safe.
+ */
+class NvJpegDecoder {
+ public:
+  NvJpegDecoder();
+  ~NvJpegDecoder();
+
+  /**
+   * Decodes encoded into the buffer of index. If it can't be decoded, the
+   * image is a black 224x224 one instead, like on the OpenCV path, and
+   * false is returned.
+   */
+  bool Decode(
+      const std::string& encoded,
+      int index,
+      cudaStream_t stream,
+      const uint8_t** image,
+      int* height,
+      int* width);
+
+ private:
+  uint8_t* Buffer(int index, size_t size);
+
+  nvjpegHandle_t handle_;
+  nvjpegJpegState_t state_;
+  std::vector<Tensor> buffers_;
+
+  AT_DISABLE_COPY_AND_ASSIGN(NvJpegDecoder);
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_USE_NVJPEG
+
+#endif // CAFFE2_IMAGE_NVJPEG_DECODER_H_
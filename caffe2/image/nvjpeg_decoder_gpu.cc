@@ -0,0 +1,93 @@
+#include "caffe2/image/nvjpeg_decoder.h"
+
+#ifdef CAFFE2_USE_NVJPEG
+
+namespace caffe2 {
+
+namespace {
+
+#define NVJPEG_ENFORCE(condition)            \
+  do {                                       \
+    nvjpegStatus_t status = condition;       \
+    CAFFE_ENFORCE_EQ(                        \
+        status,                              \
+        NVJPEG_STATUS_SUCCESS,               \
+        "nvJPEG error ",                     \
+        static_cast<int>(status));           \
+  } while (0)
+
+// the size of the replacement for images that fail to decode
+constexpr int kBlankImageSize = 224;
+
+} // namespace
+
+NvJpegDecoder::NvJpegDecoder() {
+  NVJPEG_ENFORCE(nvjpegCreate(NVJPEG_BACKEND_DEFAULT, nullptr, &handle_));
+  NVJPEG_ENFORCE(nvjpegJpegStateCreate(handle_, &state_));
+}
+
+NvJpegDecoder::~NvJpegDecoder() {
+  nvjpegJpegStateDestroy(state_);
+  nvjpegDestroy(handle_);
+}
+
+uint8_t* NvJpegDecoder::Buffer(int index, size_t size) {
+  while (buffers_.size() <= index) {
+    buffers_.emplace_back(CUDA);
+  }
+  // shrinking keeps the memory, so buffers settle at the largest image
+  buffers_[index].Resize(size);
+  return buffers_[index].mutable_data<uint8_t>();
+}
+
+bool NvJpegDecoder::Decode(
+    const std::string& encoded,
+    int index,
+    cudaStream_t stream,
+    const uint8_t** image,
+    int* height,
+    int* width) {
+  const auto* data = reinterpret_cast<const unsigned char*>(encoded.data());
+  int num_components;
+  nvjpegChromaSubsampling_t subsampling;
+  int widths[NVJPEG_MAX_COMPONENT];
+  int heights[NVJPEG_MAX_COMPONENT];
+  bool decoded = nvjpegGetImageInfo(
+                     handle_,
+                     data,
+                     encoded.size(),
+                     &num_components,
+                     &subsampling,
+                     widths,
+                     heights) == NVJPEG_STATUS_SUCCESS;
+  if (decoded) {
+    *height = heights[0];
+    *width = widths[0];
+    nvjpegImage_t output;
+    memset(&output, 0, sizeof(output));
+    output.channel[0] = Buffer(index, *height * *width * 3);
+    output.pitch[0] = *width * 3;
+    decoded = nvjpegDecode(
+                  handle_,
+                  state_,
+                  data,
+                  encoded.size(),
+                  NVJPEG_OUTPUT_BGRI,
+                  &output,
+                  stream) == NVJPEG_STATUS_SUCCESS;
+    *image = output.channel[0];
+  }
+  if (!decoded) {
+    *height = kBlankImageSize;
+    *width = kBlankImageSize;
+    const size_t size = kBlankImageSize * kBlankImageSize * 3;
+    auto* blank = Buffer(index, size);
+    CUDA_ENFORCE(cudaMemsetAsync(blank, 0, size, stream));
+    *image = blank;
+  }
+  return decoded;
+}
+
+} // namespace caffe2
+
+#endif // CAFFE2_USE_NVJPEG
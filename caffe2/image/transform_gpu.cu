@@ -46,6 +46,47 @@ __global__ void transform_kernel(
   }
 }
 
+// one block per image, output in (uint8, NHWC)
+__global__ void crop_resize_kernel(
+    const GPUImageCrop* crops,
+    const int C,
+    const int H,
+    const int W,
+    uint8_t* out) {
+  const int n = blockIdx.x;
+  const GPUImageCrop crop = crops[n];
+  uint8_t* output_ptr = &out[n * H * W * C];
+
+  const float scale_y = crop.height / H;
+  const float scale_x = crop.width / W;
+  for (int h = threadIdx.y; h < H; h += blockDim.y) {
+    // sample at the pixel centers, as cv::resize does
+    float y = crop.y + (h + 0.5f) * scale_y - 0.5f;
+    y = fminf(fmaxf(y, 0.f), crop.image_height - 1.f);
+    const int y0 = static_cast<int>(y);
+    const int y1 = min(y0 + 1, crop.image_height - 1);
+    const float dy = y - y0;
+    for (int w = threadIdx.x; w < W; w += blockDim.x) {
+      float x = crop.x + (w + 0.5f) * scale_x - 0.5f;
+      x = fminf(fmaxf(x, 0.f), crop.image_width - 1.f);
+      const int x0 = static_cast<int>(x);
+      const int x1 = min(x0 + 1, crop.image_width - 1);
+      const float dx = x - x0;
+      const int out_w = crop.mirror ? W - 1 - w : w;
+      for (int c = 0; c < C; ++c) {
+        const uint8_t* image = crop.image + c;
+        const int stride = crop.image_width * C;
+        const float top = image[y0 * stride + x0 * C] * (1.f - dx) +
+            image[y0 * stride + x1 * C] * dx;
+        const float bottom = image[y1 * stride + x0 * C] * (1.f - dx) +
+            image[y1 * stride + x1 * C] * dx;
+        output_ptr[(h * W + out_w) * C + c] =
+            static_cast<uint8_t>(top * (1.f - dy) + bottom * dy + 0.5f);
+      }
+    }
+  }
+}
+
 }
 
 template <typename T_IN, typename T_OUT, class Context>
@@ -85,4 +126,29 @@ template bool TransformOnGPU<uint8_t, float16, CUDAContext>(
     Tensor& std,
     CUDAContext* context);
 
+template <class Context>
+bool CropResizeOnGPU(
+    const GPUImageCrop* crops,
+    const int N,
+    const int C,
+    const int H,
+    const int W,
+    uint8_t* out,
+    Context* context) {
+  if (N > 0) {
+    crop_resize_kernel<<<N, dim3(16, 16), 0, context->cuda_stream()>>>(
+        crops, C, H, W, out);
+  }
+  return true;
+}
+
+template bool CropResizeOnGPU<CUDAContext>(
+    const GPUImageCrop* crops,
+    const int N,
+    const int C,
+    const int H,
+    const int W,
+    uint8_t* out,
+    CUDAContext* context);
+
 }  // namespace caffe2
@@ -38,6 +38,32 @@ bool TransformOnGPU(
     Tensor& std,
     Context* context);
 
+// A crop of one decoded image for CropResizeOnGPU: the rectangle at (x, y)
+// of size width x height in the HWC uint8 image, which may be fractional.
+struct GPUImageCrop {
+  const uint8_t* image;
+  int image_height;
+  int image_width;
+  float x;
+  float y;
+  float height;
+  float width;
+  bool mirror;
+};
+
+// Crops every image of the batch and resizes the crop bilinearly to H x W,
+// mirroring it horizontally if requested. crops is an array of N crops in
+// device memory and the output is NHWC uint8.
+template <class Context>
+bool CropResizeOnGPU(
+    const GPUImageCrop* crops,
+    const int N,
+    const int C,
+    const int H,
+    const int W,
+    uint8_t* out,
+    Context* context);
+
 }  // namespace caffe2
 
 #endif
@@ -15,6 +15,17 @@ std::mutex& MPIMutex() {
   return gCaffe2MPIMutex;
 }
 
+void MPIWait(MPI_Request* request) {
+  int done = 0;
+  while (true) {
+    MPI_CHECK(MPI_Test(request, &done, MPI_STATUS_IGNORE));
+    if (done) {
+      return;
+    }
+    std::this_thread::yield();
+  }
+}
+
 static MPI_Comm gCaffe2MPIComm = MPI_COMM_WORLD;
 
 MPI_Comm GlobalMPIComm() {
@@ -45,6 +45,17 @@ std::mutex& MPIMutex();
         error);                                              \
   } while (0)
 
+/**
+ * @brief Waits for a non-blocking MPI call to complete.
+ *
+ * MPIMutex() is only held while testing the request, so that operators
+ * running on other threads, e.g. collectives on other common worlds, can make
+ * MPI calls while this one is in flight. Waiting in a blocking MPI call with
+ * the mutex held would serialize them, and deadlock if two processes run them
+ * in a different order.
+ */
+void MPIWait(MPI_Request* request);
+
 /**
  * @brief Gets the global MPI communicator used by Caffe2. In default, this
  * is MPI_COMM_WORLD unless you call SetGlobalMPIComm().
@@ -44,12 +44,17 @@ class MPIBroadcastOp final : public Operator<Context> {
         output->size() > 0,
         "Broadcast op uses in-place operation so the output "
         "should be already allocated.");
-    MPI_CHECK(MPI_Bcast(
+    // CUDA-aware MPI reads device memory outside of our stream
+    context_.FinishDeviceComputation();
+    MPI_Request request;
+    MPI_CHECK(MPI_Ibcast(
         output->raw_mutable_data(),
         output->nbytes(),
         MPIDataTypeWrapper<char>::type(),
         root_,
-        comm));
+        comm,
+        &request));
+    MPIWait(&request);
     return true;
   }
 
@@ -72,14 +77,18 @@ class MPIReduceOp final : public Operator<Context> {
     auto& input = Input(1);
     auto* output = Output(0);
     output->ResizeLike(input);
-    MPI_CHECK(MPI_Reduce(
+    context_.FinishDeviceComputation();
+    MPI_Request request;
+    MPI_CHECK(MPI_Ireduce(
         const_cast<T*>(input.template data<T>()),
         output->template mutable_data<T>(),
         input.size(),
         MPIDataTypeWrapper<T>::type(),
         MPI_SUM,
         root_,
-        comm));
+        comm,
+        &request));
+    MPIWait(&request);
     return true;
   }
 
@@ -101,14 +110,18 @@ class MPIAllgatherOp final : public Operator<Context> {
     vector<TIndex> output_dims = input.dims();
     output_dims[0] *= OperatorBase::Input<MPICommonWorldWrapper>(0).size();
     output->Resize(output_dims);
-    MPI_CHECK(MPI_Allgather(
+    context_.FinishDeviceComputation();
+    MPI_Request request;
+    MPI_CHECK(MPI_Iallgather(
         const_cast<T*>(input.template data<T>()),
         input.size(),
         MPIDataTypeWrapper<T>::type(),
         output->template mutable_data<T>(),
         input.size(),
         MPIDataTypeWrapper<T>::type(),
-        comm));
+        comm,
+        &request));
+    MPIWait(&request);
     return true;
   }
 };
@@ -133,13 +146,17 @@ class MPIAllreduceOp final : public Operator<Context> {
       // Normal allreduce takes the source from the input.
       source = const_cast<T*>(input.template data<T>());
     }
-    MPI_CHECK(MPI_Allreduce(
+    context_.FinishDeviceComputation();
+    MPI_Request request;
+    MPI_CHECK(MPI_Iallreduce(
         source,
         output->template mutable_data<T>(),
         input.size(),
         MPIDataTypeWrapper<T>::type(),
         MPI_SUM,
-        comm));
+        comm,
+        &request));
+    MPIWait(&request);
     return true;
   }
 };
@@ -175,6 +192,7 @@ class MPISendTensorOp final : public Operator<Context> {
       // We need to do a const cast to cope with the fact that, before OpenMPI
       // 1.7, MPI_Send expects a non-const pointer although it uses it in a
       // const way.
+      context_.FinishDeviceComputation();
       MPI_CHECK(MPI_Send(
           const_cast<void*>(input.raw_data()),
           input.nbytes(),
@@ -50,15 +50,75 @@ namespace caffe2 {
 #define CAFFE2_HAS_CUDA_MPI_ALLREDUCE 0
 #endif // CAFFE2_FORCE_FALLBACK_CUDA_MPI
 
+namespace {
+
+// The macros above only say whether the MPI library was built with CUDA
+// support. OpenMPI can also report whether it is actually available at run
+// time, e.g. it isn't if the CUDA libraries couldn't be loaded.
+bool MPIHasCUDASupportAtRuntime() {
+#if defined(MPIX_CUDA_AWARE_SUPPORT) && MPIX_CUDA_AWARE_SUPPORT
+  static const bool has_support = MPIX_Query_cuda_support() == 1;
+  return has_support;
+#else
+  return true;
+#endif
+}
+
+// Runs CUDAOp, which passes device pointers to MPI, if the MPI library reports
+// CUDA support when the operator is created, and FallbackOp, which copies
+// through host memory, otherwise.
+template <class CUDAOp, class FallbackOp>
+class CUDAAwareMPIOp final : public Operator<CUDAContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CUDAContext);
+  CUDAAwareMPIOp(const OperatorDef& def, Workspace* ws)
+      : Operator<CUDAContext>(def, ws) {
+    if (MPIHasCUDASupportAtRuntime()) {
+      op_.reset(new CUDAOp(def, ws));
+    } else {
+      op_.reset(new FallbackOp(def, ws));
+    }
+  }
+
+  bool RunOnDevice() override {
+    return op_->Run();
+  }
+
+ private:
+  std::unique_ptr<OperatorBase> op_;
+};
+
+} // namespace
+
 REGISTER_CUDA_OPERATOR(
     MPICreateCommonWorld,
     MPICreateCommonWorldOp<CUDAContext>);
 #if CAFFE2_HAS_CUDA_MPI_BASICS
-REGISTER_CUDA_OPERATOR(MPIBroadcast, MPIBroadcastOp<CUDAContext>);
-REGISTER_CUDA_OPERATOR(MPIReduce, MPIReduceOp<float, CUDAContext>);
-REGISTER_CUDA_OPERATOR(MPIAllgather, MPIAllgatherOp<float, CUDAContext>);
-REGISTER_CUDA_OPERATOR(MPISendTensor, MPISendTensorOp<CUDAContext>);
-REGISTER_CUDA_OPERATOR(MPIReceiveTensor, MPIReceiveTensorOp<CUDAContext>);
+REGISTER_CUDA_OPERATOR(
+    MPIBroadcast,
+    CUDAAwareMPIOp<
+        MPIBroadcastOp<CUDAContext>,
+        GPUFallbackOp<MPIBroadcastOp<CPUContext>>>);
+REGISTER_CUDA_OPERATOR(
+    MPIReduce,
+    CUDAAwareMPIOp<
+        MPIReduceOp<float, CUDAContext>,
+        GPUFallbackOp<MPIReduceOp<float, CPUContext>>>);
+REGISTER_CUDA_OPERATOR(
+    MPIAllgather,
+    CUDAAwareMPIOp<
+        MPIAllgatherOp<float, CUDAContext>,
+        GPUFallbackOp<MPIAllgatherOp<float, CPUContext>>>);
+REGISTER_CUDA_OPERATOR(
+    MPISendTensor,
+    CUDAAwareMPIOp<
+        MPISendTensorOp<CUDAContext>,
+        GPUFallbackOp<MPISendTensorOp<CPUContext>>>);
+REGISTER_CUDA_OPERATOR(
+    MPIReceiveTensor,
+    CUDAAwareMPIOp<
+        MPIReceiveTensorOp<CUDAContext>,
+        GPUFallbackOp<MPIReceiveTensorOp<CPUContext>, SkipIndices<1, 2>>>);
 #else
 REGISTER_CUDA_OPERATOR(MPIBroadcast, GPUFallbackOp<MPIBroadcastOp<CPUContext>>);
 REGISTER_CUDA_OPERATOR(
@@ -76,7 +136,11 @@ REGISTER_CUDA_OPERATOR(
 #endif
 
 #if CAFFE2_HAS_CUDA_MPI_ALLREDUCE
-REGISTER_CUDA_OPERATOR(MPIAllreduce, MPIAllreduceOp<float, CUDAContext>);
+REGISTER_CUDA_OPERATOR(
+    MPIAllreduce,
+    CUDAAwareMPIOp<
+        MPIAllreduceOp<float, CUDAContext>,
+        GPUFallbackOp<MPIAllreduceOp<float, CPUContext>>>);
 #else
 REGISTER_CUDA_OPERATOR(
     MPIAllreduce,
@@ -0,0 +1,200 @@
+#include "caffe2/observers/histogram_observer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace caffe2 {
+
+namespace {
+
+int shardIndex() {
+  static std::atomic<int> next{0};
+  thread_local int shard = next++ % LatencyHistogram::kNumShards;
+  return shard;
+}
+
+int64_t elapsedNanoSeconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+} // namespace
+
+constexpr int LatencyHistogram::kSubBucketBits;
+constexpr int LatencyHistogram::kSubBuckets;
+constexpr int LatencyHistogram::kMaxBits;
+constexpr int LatencyHistogram::kNumBuckets;
+constexpr int LatencyHistogram::kNumShards;
+
+LatencyHistogram::LatencyHistogram() : shards_(new Shard[kNumShards]) {
+  for (int i = 0; i < kNumShards; ++i) {
+    for (auto& count : shards_[i].counts) {
+      count.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+int LatencyHistogram::bucket(int64_t nanoseconds) {
+  if (nanoseconds < kSubBuckets) {
+    return std::max<int64_t>(nanoseconds, 0);
+  }
+  if (nanoseconds >= (int64_t(1) << kMaxBits)) {
+    return kNumBuckets - 1;
+  }
+#if defined(__GNUC__) || defined(__clang__)
+  const int msb = 63 - __builtin_clzll(nanoseconds);
+#else
+  int msb = kSubBucketBits;
+  while (nanoseconds >> (msb + 1)) {
+    ++msb;
+  }
+#endif
+  const int shift = msb - kSubBucketBits;
+  const int sub = (nanoseconds >> shift) & (kSubBuckets - 1);
+  return (shift + 1) * kSubBuckets + sub;
+}
+
+int64_t LatencyHistogram::bucketUpperBound(int bucket) {
+  if (bucket < kSubBuckets) {
+    return bucket;
+  }
+  const int shift = bucket / kSubBuckets - 1;
+  const int64_t lower = int64_t(kSubBuckets + bucket % kSubBuckets) << shift;
+  return lower + (int64_t(1) << shift) - 1;
+}
+
+void LatencyHistogram::record(int64_t nanoseconds) {
+  shards_[shardIndex()].counts[bucket(nanoseconds)].fetch_add(
+      1, std::memory_order_relaxed);
+}
+
+std::vector<uint64_t> LatencyHistogram::snapshot(bool reset) {
+  std::vector<uint64_t> counts(kNumBuckets, 0);
+  for (int i = 0; i < kNumShards; ++i) {
+    for (int b = 0; b < kNumBuckets; ++b) {
+      auto& count = shards_[i].counts[b];
+      counts[b] += reset ? count.exchange(0, std::memory_order_relaxed)
+                         : count.load(std::memory_order_relaxed);
+    }
+  }
+  return counts;
+}
+
+int64_t LatencyHistogram::count(const std::vector<uint64_t>& counts) {
+  int64_t total = 0;
+  for (auto c : counts) {
+    total += c;
+  }
+  return total;
+}
+
+int64_t LatencyHistogram::quantile(
+    const std::vector<uint64_t>& counts,
+    double q) {
+  const int64_t total = count(counts);
+  if (total == 0) {
+    return 0;
+  }
+  const int64_t rank = std::max<int64_t>(1, std::ceil(q * total));
+  int64_t seen = 0;
+  for (size_t b = 0; b < counts.size(); ++b) {
+    seen += counts[b];
+    if (seen >= rank) {
+      return bucketUpperBound(b);
+    }
+  }
+  return bucketUpperBound(counts.size() - 1);
+}
+
+LatencyHistogramRegistry& LatencyHistogramRegistry::get() {
+  static LatencyHistogramRegistry registry;
+  return registry;
+}
+
+LatencyHistogram* LatencyHistogramRegistry::add(const std::string& name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& histogram = histograms_[name];
+  if (!histogram) {
+    histogram = caffe2::make_unique<LatencyHistogram>();
+  }
+  return histogram.get();
+}
+
+void LatencyHistogramRegistry::publish(
+    ExportedStatList& exported,
+    bool reset) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto now = std::chrono::high_resolution_clock::now();
+  for (const auto& kv : histograms_) {
+    const auto counts = kv.second->snapshot(reset);
+    const auto& name = kv.first;
+    exported.push_back(
+        {name + "/latency_count", LatencyHistogram::count(counts), now});
+    exported.push_back({name + "/latency_p50_ns",
+                        LatencyHistogram::quantile(counts, 0.5),
+                        now});
+    exported.push_back({name + "/latency_p99_ns",
+                        LatencyHistogram::quantile(counts, 0.99),
+                        now});
+    exported.push_back({name + "/latency_p999_ns",
+                        LatencyHistogram::quantile(counts, 0.999),
+                        now});
+  }
+}
+
+HistogramOperatorObserver::HistogramOperatorObserver(
+    OperatorBase* op,
+    HistogramNetObserver* netObserver)
+    : ObserverBase<OperatorBase>(op), netObserver_(netObserver) {
+  const auto& type =
+      op->has_debug_def() ? op->debug_def().type() : std::string("unknown");
+  histogram_ = LatencyHistogramRegistry::get().add(
+      netObserver_->subject()->Name() + "/" + type);
+}
+
+std::unique_ptr<ObserverBase<OperatorBase>> HistogramOperatorObserver::rnnCopy(
+    OperatorBase* subject,
+    int /* rnn_order */) const {
+  return std::unique_ptr<ObserverBase<OperatorBase>>(
+      new HistogramOperatorObserver(subject, netObserver_));
+}
+
+void HistogramOperatorObserver::Start() {
+  sampled_ = netObserver_->sampled();
+  if (sampled_) {
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+void HistogramOperatorObserver::Stop() {
+  if (sampled_) {
+    histogram_->record(elapsedNanoSeconds(start_));
+  }
+}
+
+HistogramNetObserver::HistogramNetObserver(NetBase* subject, int sample_rate)
+    : OperatorAttachingNetObserver<
+          HistogramOperatorObserver,
+          HistogramNetObserver>(subject, this),
+      sample_rate_(sample_rate),
+      histogram_(LatencyHistogramRegistry::get().add(subject->Name())) {
+  CAFFE_ENFORCE_GT(sample_rate_, 0);
+}
+
+void HistogramNetObserver::Start() {
+  const bool sampled =
+      runs_.fetch_add(1, std::memory_order_relaxed) % sample_rate_ == 0;
+  sampled_.store(sampled, std::memory_order_relaxed);
+  if (sampled) {
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+void HistogramNetObserver::Stop() {
+  if (sampled()) {
+    histogram_->record(elapsedNanoSeconds(start_));
+  }
+}
+
+} // namespace caffe2
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "caffe2/core/net.h"
+#include "caffe2/core/observer.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/stats.h"
+#include "caffe2/observers/operator_attaching_net_observer.h"
+
+namespace caffe2 {
+
+/**
+ * A histogram of latencies in nanoseconds with log-linear (HDR-style)
+ * buckets: every power of two is split into kSubBuckets buckets, so the
+ * quantiles are within 1/kSubBuckets of the recorded values. The counts are
+ * sharded by thread and updated with relaxed atomics, so recording from many
+ * threads takes no lock and does not contend on a cache line.
+ */
+class CAFFE2_API LatencyHistogram {
+ public:
+  static constexpr int kSubBucketBits = 3;
+  static constexpr int kSubBuckets = 1 << kSubBucketBits;
+  // covers up to 2^40 ns, i.e. about 18 minutes
+  static constexpr int kMaxBits = 40;
+  static constexpr int kNumBuckets =
+      (kMaxBits - kSubBucketBits + 1) * kSubBuckets;
+  static constexpr int kNumShards = 8;
+
+  LatencyHistogram();
+
+  void record(int64_t nanoseconds);
+
+  // The counts of the buckets. With reset, the counts are cleared without
+  // losing records made at the same time.
+  std::vector<uint64_t> snapshot(bool reset = false);
+
+  static int64_t count(const std::vector<uint64_t>& counts);
+  // The latency that a fraction q of the counted latencies are at most
+  // (up to the bucket width).
+  static int64_t quantile(const std::vector<uint64_t>& counts, double q);
+
+ private:
+  static int bucket(int64_t nanoseconds);
+  static int64_t bucketUpperBound(int bucket);
+
+  struct alignas(64) Shard {
+    std::atomic<uint64_t> counts[kNumBuckets];
+  };
+  std::unique_ptr<Shard[]> shards_;
+};
+
+/**
+ * Holds the latency histograms of the nets and of their operator types by
+ * name, "<net>" and "<net>/<operator type>". The histograms are looked up
+ * when observers are attached, never while recording.
+ */
+class CAFFE2_API LatencyHistogramRegistry {
+ public:
+  static LatencyHistogramRegistry& get();
+
+  LatencyHistogram* add(const std::string& name);
+
+  /**
+   * Appends "<name>/latency_{p50,p99,p999}_ns" and "<name>/latency_count"
+   * for every histogram to `exported`, e.g. next to the counters of
+   * StatRegistry::publish. If `reset` is true, the histograms are cleared.
+   */
+  void publish(ExportedStatList& exported, bool reset = false);
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::unique_ptr<LatencyHistogram>>
+      histograms_;
+};
+
+class HistogramNetObserver;
+class HistogramOperatorObserver final : public ObserverBase<OperatorBase> {
+ public:
+  explicit HistogramOperatorObserver(OperatorBase* op) = delete;
+  HistogramOperatorObserver(
+      OperatorBase* op,
+      HistogramNetObserver* netObserver);
+  std::unique_ptr<ObserverBase<OperatorBase>> rnnCopy(
+      OperatorBase* subject,
+      int rnn_order) const override;
+
+ private:
+  void Start() override;
+  void Stop() override;
+
+  HistogramNetObserver* netObserver_;
+  LatencyHistogram* histogram_;
+  bool sampled_{false};
+  std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * Records the latency of every run of the net, and of each of its
+ * operators by operator type, into LatencyHistogramRegistry. With
+ * sample_rate N > 1 only one in N runs is timed; the operators of the other
+ * runs only check a flag.
+ */
+class CAFFE2_API HistogramNetObserver final
+    : public OperatorAttachingNetObserver<
+          HistogramOperatorObserver,
+          HistogramNetObserver> {
+ public:
+  explicit HistogramNetObserver(NetBase* subject, int sample_rate = 1);
+
+  bool sampled() const {
+    return sampled_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  void Start() override;
+  void Stop() override;
+
+  const int sample_rate_;
+  LatencyHistogram* histogram_;
+  std::atomic<int64_t> runs_{0};
+  std::atomic<bool> sampled_{false};
+  std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace caffe2
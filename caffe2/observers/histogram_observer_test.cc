@@ -0,0 +1,52 @@
+#include "caffe2/core/common.h"
+#include "caffe2/core/net.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/observers/histogram_observer.h"
+
+#include <gtest/gtest.h>
+
+namespace caffe2 {
+
+TEST(LatencyHistogramTest, Quantiles) {
+  LatencyHistogram histogram;
+  for (int64_t i = 1; i <= 1000; ++i) {
+    histogram.record(i * 1000);
+  }
+  auto counts = histogram.snapshot();
+  EXPECT_EQ(LatencyHistogram::count(counts), 1000);
+  const auto p50 = LatencyHistogram::quantile(counts, 0.5);
+  const auto p99 = LatencyHistogram::quantile(counts, 0.99);
+  EXPECT_GE(p50, 500000);
+  EXPECT_LE(p50, 500000 * 9 / 8);
+  EXPECT_GE(p99, 990000);
+  EXPECT_LE(p99, 990000 * 9 / 8);
+
+  histogram.snapshot(true);
+  EXPECT_EQ(LatencyHistogram::count(histogram.snapshot()), 0);
+}
+
+TEST(HistogramObserverTest, SampledRuns) {
+  Workspace ws;
+  NetDef net_def;
+  net_def.set_name("histogram_observer_test");
+  auto* op = net_def.add_op();
+  op->set_type("ConstantFill");
+  op->add_output("out");
+  auto* arg = op->add_arg();
+  arg->set_name("shape");
+  arg->add_ints(10);
+  unique_ptr<NetBase> net(CreateNet(net_def, &ws));
+  net->AttachObserver(caffe2::make_unique<HistogramNetObserver>(net.get(), 2));
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(net->Run());
+  }
+
+  ExportedStatList stats;
+  LatencyHistogramRegistry::get().publish(stats, true);
+  auto map = toMap(stats);
+  EXPECT_EQ(map["histogram_observer_test/latency_count"], 5);
+  EXPECT_EQ(map["histogram_observer_test/ConstantFill/latency_count"], 5);
+  EXPECT_GT(map["histogram_observer_test/latency_p50_ns"], 0);
+}
+
+} // namespace caffe2
@@ -61,6 +61,17 @@ class TimeObserver final
     return sum / subject_->GetOperators().size();
   }
 
+  // Average time of every operator, in net order; can be passed to the
+  // async executors as the "op_costs" net argument
+  std::vector<float> average_operator_times() const {
+    std::vector<float> times;
+    times.reserve(operator_observers_.size());
+    for (const auto* observer : operator_observers_) {
+      times.push_back(observer->average_time());
+    }
+    return times;
+  }
+
  private:
   void Start() override;
   void Stop() override;
@@ -65,7 +65,7 @@ OPERATOR_SCHEMA(Allreduce)
       return in >= 2 && out == (in - 1);
     })
     .EnforceInplace([](int in, int out) { return (in - 1) == out; })
-    .IdenticalTypeAndShapeOfInput(0)
+    .IdenticalTypeAndShapeOfInput(1)
     .InputsCanCrossDevices()
     .SetDoc(R"DOC(
 Does an allreduce operation among the nodes. Currently only Sum is supported.
@@ -74,6 +74,29 @@ Does an allreduce operation among the nodes. Currently only Sum is supported.
     .Input(1, "X", "A tensor to be allreduced.")
     .Output(0, "Y", "The allreduced tensor, same on all nodes.");
 
+OPERATOR_SCHEMA(BucketedAllreduce)
+    .NumInputsOutputs([](int in, int out) {
+      return in >= 2 && out == (in - 1);
+    })
+    .EnforceInplace([](int in, int out) { return (in - 1) == out; })
+    .TensorInferenceFunction([](const OperatorDef& /* unused */,
+                                const vector<TensorShape>& in) {
+      return vector<TensorShape>(in.begin() + 1, in.end());
+    })
+    .InputsCanCrossDevices()
+    .SetDoc(R"DOC(
+Does an allreduce operation among the nodes on each of its tensors, with a
+single collective over a buffer holding all of them. The tensors may differ
+in size, but have the same data type. Currently only Sum is supported.
+)DOC")
+    .Input(0, "comm_world", "The common world.")
+    .Input(1, "X", "The tensors to be allreduced.")
+    .Output(0, "X", "In-place as the inputs after the common world.")
+    .Arg(
+        "sharded",
+        "(bool, default false) whether to reduce-scatter the buffer and then "
+        "allgather it, instead of running an allreduce.");
+
 OPERATOR_SCHEMA(ReduceScatter)
     .NumInputsOutputs([](int in, int out) {
       return in >= 2 && out == (in - 1);
@@ -182,6 +205,7 @@ SHOULD_NOT_DO_GRADIENT(Broadcast);
 SHOULD_NOT_DO_GRADIENT(Reduce);
 SHOULD_NOT_DO_GRADIENT(Allgather);
 SHOULD_NOT_DO_GRADIENT(Allreduce);
+SHOULD_NOT_DO_GRADIENT(BucketedAllreduce);
 SHOULD_NOT_DO_GRADIENT(ReduceScatter);
 SHOULD_NOT_DO_GRADIENT(Barrier);
 SHOULD_NOT_DO_GRADIENT(SendTensor);
@@ -195,6 +219,7 @@ REGISTER_CPU_OPERATOR(Broadcast, NoDefaultEngineOp<CPUContext>);
 REGISTER_CPU_OPERATOR(Reduce, NoDefaultEngineOp<CPUContext>);
 REGISTER_CPU_OPERATOR(Allgather, NoDefaultEngineOp<CPUContext>);
 REGISTER_CPU_OPERATOR(Allreduce, NoDefaultEngineOp<CPUContext>);
+REGISTER_CPU_OPERATOR(BucketedAllreduce, NoDefaultEngineOp<CPUContext>);
 REGISTER_CPU_OPERATOR(ReduceScatter, NoDefaultEngineOp<CPUContext>);
 REGISTER_CPU_OPERATOR(Barrier, NoDefaultEngineOp<CPUContext>);
 REGISTER_CPU_OPERATOR(SendTensor, NoDefaultEngineOp<CPUContext>);
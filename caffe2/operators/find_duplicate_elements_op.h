@@ -1,12 +1,12 @@
 #ifndef CAFFE2_OPERATORS_FIND_DUPLICATE_ELEMENTS_OP_H
 #define CAFFE2_OPERATORS_FIND_DUPLICATE_ELEMENTS_OP_H
 
-#include <unordered_map>
 #include <vector>
 
 #include "caffe2/core/context.h"
 #include "caffe2/core/operator.h"
 #include "caffe2/core/tensor.h"
+#include "caffe2/utils/flat_hash_map/flat_hash_map.h"
 
 namespace caffe2 {
 
@@ -28,7 +28,8 @@ class FindDuplicateElementsOp final : public Operator<Context> {
     CAFFE_ENFORCE(data.ndim() == 1, "data should be 1-D.");
 
     const auto* data_ptr = data.template data<T>();
-    std::unordered_map<T, int64_t> dict;
+    ska::flat_hash_map<T, int64_t> dict;
+    dict.reserve(data.dims()[0]);
     std::vector<int64_t> dupIndices;
     // i is the index of unique elements, j is the index of all elements
     for (int64_t i = 0, j = 0; j < data.dims()[0]; ++i, ++j) {
@@ -4,8 +4,7 @@
 #include "caffe2/core/context.h"
 #include "caffe2/core/logging.h"
 #include "caffe2/core/operator.h"
-
-#include <unordered_map>
+#include "caffe2/utils/flat_hash_map/flat_hash_map.h"
 
 namespace caffe2 {
 
@@ -54,7 +53,8 @@ class FindOp final : public Operator<Context> {
       }
     } else {
       // O(n + m)
-      std::unordered_map<T, int> idx_map;
+      ska::flat_hash_map<T, int> idx_map;
+      idx_map.reserve(idx_size);
       for (int j = 0; j < idx_size; j++) {
         idx_map[idx_data[j]] = j;
       }
@@ -1,9 +1,45 @@
 #include <functional>
 
 #include "caffe2/operators/fully_connected_op.h"
+#include "caffe2/utils/eigen_utils.h"
 
 namespace caffe2 {
 
+FCActivation GetFCActivation(const std::string& name) {
+  if (name.empty()) {
+    return FCActivation::NONE;
+  } else if (name == "Relu") {
+    return FCActivation::RELU;
+  } else if (name == "Sigmoid") {
+    return FCActivation::SIGMOID;
+  } else if (name == "Tanh") {
+    return FCActivation::TANH;
+  }
+  CAFFE_THROW("Unsupported FC activation: ", name);
+}
+
+template <>
+void ApplyFCActivation<CPUContext>(
+    FCActivation activation,
+    const int N,
+    float* Y,
+    CPUContext* /* context */) {
+  EigenVectorArrayMap<float> y(Y, N);
+  switch (activation) {
+    case FCActivation::NONE:
+      break;
+    case FCActivation::RELU:
+      y = y.cwiseMax(0.f);
+      break;
+    case FCActivation::SIGMOID:
+      y = 1.f / (1.f + (-y).exp());
+      break;
+    case FCActivation::TANH:
+      y = y.tanh();
+      break;
+  }
+}
+
 REGISTER_CPU_OPERATOR(FC, FullyConnectedOp<CPUContext>);
 REGISTER_CPU_OPERATOR(FCGradient, FullyConnectedGradientOp<CPUContext>);
 
@@ -236,6 +272,9 @@ Y:
     .Arg(
         "float16_compute",
         "*(type: bool; default: False)* Whether to use float-16 compute kernel.")
+    .Arg(
+        "activation",
+        "*(type: string; default: \"\")* One of \"Relu\", \"Sigmoid\" or \"Tanh\" to apply to the output. Only supported on CPU and for inference; set by the FuseFCActivation optimization pass.")
     .Input(
         0,
         "X",
@@ -275,6 +314,9 @@ class GetFCGradient : public GradientMakerBase {
   std::vector<OperatorDef> GetGradientDefs() override {
     CAFFE_ENFORCE_EQ(def_.input_size(), 3);
     CAFFE_ENFORCE(def_.type() == "FC" || def_.type() == "FCTransposed");
+    CAFFE_ENFORCE(
+        !ArgumentHelper::HasArgument(def_, "activation"),
+        "FC with a fused activation has no gradient");
     return SingleGradientDef(
         def_.type() + "Gradient",
         "",
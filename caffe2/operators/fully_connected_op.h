@@ -8,6 +8,29 @@
 
 namespace caffe2 {
 
+// An activation that FC applies to its output, so that a following Relu,
+// Sigmoid or Tanh does not need another pass over the output. It is set by
+// the FuseFCActivation optimization pass and only supported on CPU.
+enum class FCActivation { NONE, RELU, SIGMOID, TANH };
+
+CAFFE2_API FCActivation GetFCActivation(const std::string& name);
+
+template <class Context>
+void ApplyFCActivation(
+    FCActivation /* activation */,
+    const int /* N */,
+    float* /* Y */,
+    Context* /* context */) {
+  CAFFE_THROW("FC only supports the activation argument on CPU");
+}
+
+template <>
+CAFFE2_API void ApplyFCActivation<CPUContext>(
+    FCActivation activation,
+    const int N,
+    float* Y,
+    CPUContext* context);
+
 // This is Caffe's InnerProductOp, with a name that fits its purpose better.
 template <
     class Context,
@@ -21,7 +44,9 @@ class FullyConnectedOp final : public Operator<Context> {
         axis_(this->template GetSingleArgument<int32_t>("axis", 1)),
         axis_w_(this->template GetSingleArgument<int32_t>("axis_w", 1)),
         float16_compute_(
-            this->template GetSingleArgument<bool>("float16_compute", false)) {}
+            this->template GetSingleArgument<bool>("float16_compute", false)),
+        activation_(GetFCActivation(
+            this->template GetSingleArgument<string>("activation", ""))) {}
   ~FullyConnectedOp() {}
 
   template <
@@ -126,6 +151,7 @@ class FullyConnectedOp final : public Operator<Context> {
         Y->template mutable_data<T_Y>(),
         &context_,
         math_type);
+    MaybeApplyActivation(Y->size(), Y->template mutable_data<T_Y>());
     return true;
   }
 
@@ -148,6 +174,21 @@ class FullyConnectedOp final : public Operator<Context> {
   ;
 
   bool float16_compute_;
+  FCActivation activation_;
+
+ private:
+  template <typename T_Y>
+  void MaybeApplyActivation(const int /* N */, T_Y* /* Y */) {
+    CAFFE_ENFORCE(
+        activation_ == FCActivation::NONE,
+        "FC only supports the activation argument for float outputs");
+  }
+
+  void MaybeApplyActivation(const int N, float* Y) {
+    if (activation_ != FCActivation::NONE) {
+      ApplyFCActivation<Context>(activation_, N, Y, &context_);
+    }
+  }
 };
 
 template <
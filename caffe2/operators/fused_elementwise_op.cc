@@ -0,0 +1,200 @@
+#include "caffe2/operators/fused_elementwise_op.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <string>
+#include <type_traits>
+
+#include "caffe2/operators/elementwise_ops_utils.h"
+#include "caffe2/utils/eigen_utils.h"
+
+namespace caffe2 {
+
+namespace {
+
+constexpr int kBlockSize = 1024;
+
+// Reads the block [start, start + n) of the output from an input that is
+// broadcast to the output dims Y_dims, converting it to float.
+template <typename T>
+const float* LoadBlock(
+    const Tensor& input,
+    const std::vector<int>& Y_dims,
+    const TIndex start,
+    const int n,
+    float* scratch) {
+  const T* data = input.template data<T>();
+  const TIndex size = std::accumulate(
+      Y_dims.cbegin(), Y_dims.cend(), TIndex(1), std::multiplies<TIndex>());
+  if (input.size() == size) {
+    if (std::is_same<T, float>::value) {
+      return reinterpret_cast<const float*>(data) + start;
+    }
+    std::transform(data + start, data + start + n, scratch, [](T x) {
+      return static_cast<float>(x);
+    });
+    return scratch;
+  }
+  if (input.size() == 1) {
+    std::fill(scratch, scratch + n, static_cast<float>(data[0]));
+    return scratch;
+  }
+  // The dims of the input are aligned to the trailing output dims, and
+  // broadcast dims have a stride of 0.
+  const int ndim = Y_dims.size();
+  const int offset = ndim - input.ndim();
+  std::vector<TIndex> strides(ndim, 0);
+  TIndex stride = 1;
+  for (int i = input.ndim() - 1; i >= 0; --i) {
+    if (input.dim(i) != 1) {
+      strides[i + offset] = stride;
+    }
+    stride *= input.dim(i);
+  }
+  for (int k = 0; k < n; ++k) {
+    TIndex index = start + k;
+    TIndex pos = 0;
+    for (int i = ndim - 1; i >= 0; --i) {
+      pos += (index % Y_dims[i]) * strides[i];
+      index /= Y_dims[i];
+    }
+    scratch[k] = static_cast<float>(data[pos]);
+  }
+  return scratch;
+}
+
+} // namespace
+
+FusedElementwiseOp::FusedElementwiseOp(
+    const OperatorDef& operator_def,
+    Workspace* ws)
+    : Operator<CPUContext>(operator_def, ws),
+      cast_(GetSingleArgument<bool>("cast", false)) {
+  int num_operands = 0;
+  for (const auto& op : GetRepeatedArgument<std::string>("ops")) {
+    if (op == "Add") {
+      steps_.push_back(Step::ADD);
+      ++num_operands;
+    } else if (op == "Mul") {
+      steps_.push_back(Step::MUL);
+      ++num_operands;
+    } else if (op == "Relu") {
+      steps_.push_back(Step::RELU);
+    } else if (op == "Sigmoid") {
+      steps_.push_back(Step::SIGMOID);
+    } else if (op == "Tanh") {
+      steps_.push_back(Step::TANH);
+    } else {
+      CAFFE_THROW("FusedElementwise does not support ", op);
+    }
+  }
+  CAFFE_ENFORCE_EQ(
+      InputSize(),
+      num_operands + 1,
+      "FusedElementwise needs one input per Add and Mul besides X");
+}
+
+bool FusedElementwiseOp::RunOnDevice() {
+  if (cast_) {
+    return DispatchHelper<TensorTypes<float, double, int, int64_t, bool>>::
+        call(this, Input(0));
+  }
+  return DoRunWithType<float>();
+}
+
+template <typename T>
+bool FusedElementwiseOp::DoRunWithType() {
+  const auto& X = Input(0);
+  std::vector<int> Y_dims(X.dims().cbegin(), X.dims().cend());
+  for (int i = 1; i < InputSize(); ++i) {
+    const auto& B = Input(i);
+    Y_dims = elementwise_ops_utils::ComputeBinaryBroadcastForwardDims(
+        Y_dims, std::vector<int>(B.dims().cbegin(), B.dims().cend()));
+  }
+  const std::vector<TIndex> dims(Y_dims.cbegin(), Y_dims.cend());
+
+  // The fused op may write to a blob that one of the fused ops read, e.g.
+  // for X -> Relu -> Add(B) -> X, which is only safe when the input is read
+  // at the position it is written to.
+  auto* Y = Output(0);
+  Tensor* out = Y;
+  for (int i = 0; i < InputSize(); ++i) {
+    if (&Input(i) == Y &&
+        (Input(i).dims() != dims || (i == 0 && !std::is_same<T, float>()))) {
+      out = &buffer_;
+    }
+  }
+  out->Resize(dims);
+  float* y = out->mutable_data<float>();
+
+  float acc[kBlockSize];
+  float scratch[kBlockSize];
+  for (TIndex start = 0; start < out->size(); start += kBlockSize) {
+    const int n = std::min<TIndex>(kBlockSize, out->size() - start);
+    const float* x = LoadBlock<T>(X, Y_dims, start, n, acc);
+    EigenVectorArrayMap<float> a(acc, n);
+    if (x != acc) {
+      a = ConstEigenVectorArrayMap<float>(x, n);
+    }
+    int operand = 1;
+    for (const auto step : steps_) {
+      switch (step) {
+        case Step::ADD:
+          a += ConstEigenVectorArrayMap<float>(
+              LoadBlock<float>(Input(operand++), Y_dims, start, n, scratch),
+              n);
+          break;
+        case Step::MUL:
+          a *= ConstEigenVectorArrayMap<float>(
+              LoadBlock<float>(Input(operand++), Y_dims, start, n, scratch),
+              n);
+          break;
+        case Step::RELU:
+          a = a.cwiseMax(0.f);
+          break;
+        case Step::SIGMOID:
+          a = 1.f / (1.f + (-a).exp());
+          break;
+        case Step::TANH:
+          a = a.tanh();
+          break;
+      }
+    }
+    std::copy(acc, acc + n, y + start);
+  }
+
+  if (out != Y) {
+    Y->CopyFrom(*out);
+  }
+  return true;
+}
+
+REGISTER_CPU_OPERATOR(FusedElementwise, FusedElementwiseOp);
+
+OPERATOR_SCHEMA(FusedElementwise)
+    .NumInputs(1, INT_MAX)
+    .NumOutputs(1)
+    .AllowInplace([](int /* in */, int /* out */) { return true; })
+    .SetDoc(R"DOC(
+Applies a chain of elementwise operators to X in a single pass, so that no
+intermediate result is written to memory. It is created by the
+FuseElementwise optimization pass and is meant for inference.
+
+The chain is given by the `ops` argument and is evaluated in float. Each Add
+and Mul in the chain takes the next input as its other operand, with the
+same numpy-style broadcasting as the standalone operators. With `cast`, X is
+first converted to float, as by a Cast to FLOAT.
+)DOC")
+    .Arg(
+        "ops",
+        "The operators of the chain, in order. Add, Mul, Relu, Sigmoid and "
+        "Tanh are supported.")
+    .Arg("cast", "Converts X to float first (default false)")
+    .Input(0, "X", "The input of the chain; float unless `cast` is set")
+    .Input(1, "operands", "One float tensor per Add and Mul, in order")
+    .Output(0, "Y", "The float output of the chain");
+
+NO_GRADIENT(FusedElementwise);
+
+} // namespace caffe2
@@ -0,0 +1,35 @@
+#ifndef CAFFE2_OPERATORS_FUSED_ELEMENTWISE_OP_H_
+#define CAFFE2_OPERATORS_FUSED_ELEMENTWISE_OP_H_
+
+#include <vector>
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+
+namespace caffe2 {
+
+// Runs a chain of elementwise operators, as built by the FuseElementwise
+// optimization pass, in a single pass over the data. The chain is evaluated
+// on blocks that fit in the L1 cache, so the intermediate results are never
+// written to memory.
+class FusedElementwiseOp final : public Operator<CPUContext> {
+ public:
+  enum class Step { ADD, MUL, RELU, SIGMOID, TANH };
+
+  FusedElementwiseOp(const OperatorDef& operator_def, Workspace* ws);
+
+  bool RunOnDevice() override;
+
+  template <typename T>
+  bool DoRunWithType();
+
+ private:
+  const bool cast_;
+  std::vector<Step> steps_;
+  // Holds the output when it would overwrite an input that is still needed.
+  Tensor buffer_{CPU};
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_FUSED_ELEMENTWISE_OP_H_
@@ -1,12 +1,13 @@
+#include <array>
 #include <atomic>
 #include <limits>
 #include <mutex>
 #include <sstream>
-#include <unordered_map>
 #include <vector>
 #include "caffe2/core/blob_serialization.h"
 #include "caffe2/core/operator.h"
 #include "caffe2/core/tensor.h"
+#include "caffe2/utils/flat_hash_map/flat_hash_map.h"
 
 namespace caffe2 {
 namespace {
@@ -36,18 +37,21 @@ struct IndexBase {
   const TypeMeta& Type() const { return meta_; }
 
   TIndexValue Size() {
-    std::lock_guard<std::mutex> guard(dictMutex_);
     return nextId_;
   }
 
  protected:
   int64_t maxElements_;
   TypeMeta meta_;
-  TIndexValue nextId_{1}; // guarded by dictMutex_
+  std::atomic<TIndexValue> nextId_{1};
   std::atomic<bool> frozen_{false};
-  std::mutex dictMutex_;
 };
 
+// The keys are split into shards by hash, each an open addressing hash map
+// with its own mutex, so that concurrent IndexGet calls on the same index
+// only contend when they look up keys of the same shard. The ids stay
+// consecutive: they come from a shared atomic counter, which is only advanced
+// by an insert under the lock of its shard.
 template<typename T>
 struct Index: IndexBase {
   explicit Index(TIndexValue maxElements)
@@ -58,17 +62,41 @@ struct Index: IndexBase {
       FrozenGet(keys, values, numKeys);
       return;
     }
-    std::lock_guard<std::mutex> lock(dictMutex_);
-    for (int i = 0; i < numKeys; ++i) {
-      auto it = dict_.find(keys[i]);
-      if (it != dict_.end()) {
-        values[i] = it->second;
-      } else if (nextId_ < maxElements_) {
-        auto newValue = nextId_++;
-        dict_.insert({keys[i], newValue});
-        values[i] = newValue;
-      } else {
-        CAFFE_THROW("Dict max size reached");
+    // The keys are grouped by shard first, so that every shard is locked
+    // once per call rather than once per key.
+    std::vector<uint8_t> shardOf(numKeys);
+    std::array<size_t, kNumShards + 1> offsets{};
+    for (size_t i = 0; i < numKeys; ++i) {
+      shardOf[i] = shard(keys[i]);
+      ++offsets[shardOf[i] + 1];
+    }
+    for (size_t s = 0; s < kNumShards; ++s) {
+      offsets[s + 1] += offsets[s];
+    }
+    std::vector<size_t> order(numKeys);
+    {
+      auto next = offsets;
+      for (size_t i = 0; i < numKeys; ++i) {
+        order[next[shardOf[i]]++] = i;
+      }
+    }
+    for (size_t s = 0; s < kNumShards; ++s) {
+      if (offsets[s] == offsets[s + 1]) {
+        continue;
+      }
+      const auto& dict = shards_[s].dict;
+      std::lock_guard<std::mutex> lock(shards_[s].mutex);
+      for (size_t j = offsets[s]; j < offsets[s + 1]; ++j) {
+        const auto i = order[j];
+        auto it = dict.find(keys[i]);
+        values[i] = it != dict.end() ? it->second : 0;
+      }
+    }
+    // The keys that were missing are inserted in the order of the input, so
+    // that a single caller gets the same ids as with an unsharded map.
+    for (size_t i = 0; i < numKeys; ++i) {
+      if (values[i] == 0) {
+        values[i] = Insert(shards_[shardOf[i]], keys[i]);
       }
     }
   }
@@ -77,41 +105,89 @@ struct Index: IndexBase {
     CAFFE_ENFORCE(
         numKeys <= maxElements_,
         "Cannot load index: Tensor is larger than max_elements.");
-    decltype(dict_) dict;
+    std::array<Dict, kNumShards> dicts;
+    for (auto& dict : dicts) {
+      dict.reserve(numKeys / kNumShards + 1);
+    }
     for (int i = 0; i < numKeys; ++i) {
       CAFFE_ENFORCE(
-          dict.insert({keys[i], i + 1}).second,
+          dicts[shard(keys[i])].emplace(keys[i], i + 1).second,
           "Repeated elements found: cannot load into dictionary.");
     }
     // assume no `get` is inflight while this happens
     {
-      std::lock_guard<std::mutex> lock(dictMutex_);
-      // let the old dict get destructed outside of the lock
-      dict_.swap(dict);
+      auto locks = LockAll();
+      // let the old dicts get destructed outside of the locks
+      for (size_t s = 0; s < kNumShards; ++s) {
+        shards_[s].dict.swap(dicts[s]);
+      }
       nextId_ = numKeys + 1;
     }
     return true;
   }
 
   bool Store(Tensor* out) {
-    std::lock_guard<std::mutex> lock(dictMutex_);
+    auto locks = LockAll();
     out->Resize(nextId_ - 1);
     auto outData = out->template mutable_data<T>();
-    for (const auto& entry : dict_) {
-      outData[entry.second - 1] = entry.first;
+    for (const auto& shard : shards_) {
+      for (const auto& entry : shard.dict) {
+        outData[entry.second - 1] = entry.first;
+      }
     }
     return true;
   }
 
  private:
+  static constexpr size_t kNumShards = 16;
+  using Dict = ska::flat_hash_map<T, TIndexValue>;
+
+  struct Shard {
+    std::mutex mutex;
+    Dict dict;
+  };
+
+  static size_t shard(const T& key) {
+    // The maps index by hash modulo a prime, so taking the low bits for the
+    // shard doesn't cluster the keys within it.
+    return std::hash<T>()(key) % kNumShards;
+  }
+
+  TIndexValue Insert(Shard& shard, const T& key) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    // Another call, or an earlier occurrence of the key, may have inserted
+    // it since it was looked up.
+    auto it = shard.dict.find(key);
+    if (it != shard.dict.end()) {
+      return it->second;
+    }
+    auto newValue = nextId_.load();
+    do {
+      if (newValue >= maxElements_) {
+        CAFFE_THROW("Dict max size reached");
+      }
+    } while (!nextId_.compare_exchange_weak(newValue, newValue + 1));
+    shard.dict.emplace(key, newValue);
+    return newValue;
+  }
+
+  std::vector<std::unique_lock<std::mutex>> LockAll() {
+    std::vector<std::unique_lock<std::mutex>> locks;
+    for (auto& shard : shards_) {
+      locks.emplace_back(shard.mutex);
+    }
+    return locks;
+  }
+
   void FrozenGet(const T* keys, TIndexValue* values, size_t numKeys) {
     for (int i = 0; i < numKeys; ++i) {
-      auto it = dict_.find(keys[i]);
-      values[i] = it != dict_.end() ? it->second : 0;
+      const auto& dict = shards_[shard(keys[i])].dict;
+      auto it = dict.find(keys[i]);
+      values[i] = it != dict.end() ? it->second : 0;
     }
   }
 
-  std::unordered_map<T, TIndexValue> dict_;
+  std::array<Shard, kNumShards> shards_;
 };
 
 // TODO(azzolini): support sizes larger than int32
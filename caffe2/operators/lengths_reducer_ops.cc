@@ -48,7 +48,12 @@ SparseWeightedSum
         3,
         "LENGTHS",
         "Vector with the same sum of elements as the first dimension of DATA")
-    .Output(0, "output", "output");
+    .Output(0, "output", "output")
+    .Arg(
+        "parallel",
+        "*(type: bool; default: False)* Reduce the segments on the thread "
+        "pool of the workspace. Worth it for large batches, when the op does "
+        "not already run in parallel with others");
 
 REGISTER_CPU_OPERATOR_STR(
     "SparseLengthsPositionalWeightedSum",
@@ -79,6 +84,11 @@ OPERATOR_SCHEMA(SparseLengthsSum)
         SparseLengthsSumOp::LENGTHS)
     .SetDoc(FormatDoc<SparseLengthsSumDef>())
     .Output(0, "OUTPUT", "Aggregated tensor")
+    .Arg(
+        "parallel",
+        "*(type: bool; default: False)* Reduce the segments on the thread "
+        "pool of the workspace. Worth it for large batches, when the op does "
+        "not already run in parallel with others")
     .FillUsing(SparseLengthsSumDef::PopulateSchema);
 REGISTER_CPU_OPERATOR(
     SparseLengthsSumGradient,
@@ -101,6 +111,11 @@ OPERATOR_SCHEMA(SparseLengthsWeightedSum)
     .DisallowInputFillers() // TODO: enable input fillers
     .SetDoc(FormatDoc<SparseLengthsWeightedSumDef>())
     .Output(0, "OUTPUT", "Aggregated tensor")
+    .Arg(
+        "parallel",
+        "*(type: bool; default: False)* Reduce the segments on the thread "
+        "pool of the workspace. Worth it for large batches, when the op does "
+        "not already run in parallel with others")
     .FillUsing(SparseLengthsWeightedSumDef::PopulateSchema);
 REGISTER_CPU_OPERATOR(
     SparseLengthsWeightedSumGradient,
@@ -128,6 +143,11 @@ OPERATOR_SCHEMA(SparseLengthsMean)
         SparseLengthsMeanOp::LENGTHS)
     .SetDoc(FormatDoc<SparseLengthsMeanDef>())
     .Output(0, "OUTPUT", "Aggregated tensor")
+    .Arg(
+        "parallel",
+        "*(type: bool; default: False)* Reduce the segments on the thread "
+        "pool of the workspace. Worth it for large batches, when the op does "
+        "not already run in parallel with others")
     .FillUsing(SparseLengthsMeanDef::PopulateSchema);
 REGISTER_CPU_OPERATOR(
     SparseLengthsMeanGradient,
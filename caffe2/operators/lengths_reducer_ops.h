@@ -1,7 +1,12 @@
 #pragma once
+#include <exception>
+#include <mutex>
+#include <vector>
+
 #include "caffe2/core/context.h"
 #include "caffe2/core/operator.h"
 #include "caffe2/perfkernels/embedding_lookup.h"
+#include "caffe2/utils/threadpool/ThreadPool.h"
 
 namespace caffe2 {
 
@@ -19,7 +24,9 @@ class CPUSparseLengthsReductionOp : public Operator<CPUContext> {
  public:
   USE_OPERATOR_FUNCTIONS(CPUContext);
   CPUSparseLengthsReductionOp(const OperatorDef& operator_def, Workspace* ws)
-      : Operator<CPUContext>(operator_def, ws) {
+      : Operator<CPUContext>(operator_def, ws),
+        ws_(ws),
+        parallel_(OperatorBase::GetSingleArgument<bool>("parallel", false)) {
     static_assert(
         !(USE_WEIGHT & USE_MEAN), "Cannot both specify weight and mean.");
   }
@@ -77,18 +84,81 @@ class CPUSparseLengthsReductionOp : public Operator<CPUContext> {
     }
 
     // delegate work to perfkernel that branches based on architecture
-    EmbeddingLookup<IndexType, InputType, T, USE_POSITIONAL_WEIGHT>(
-        D,
-        M,
+    auto lookup = [&](TIndex begin, TIndex end, TIndex indexBegin,
+                      TIndex indexEnd) {
+      EmbeddingLookup<IndexType, InputType, T, USE_POSITIONAL_WEIGHT>(
+          D,
+          end - begin,
+          indexEnd - indexBegin,
+          N,
+          in_data,
+          indices + indexBegin,
+          lengths + begin,
+          in_weight && !USE_POSITIONAL_WEIGHT ? in_weight + indexBegin
+                                              : in_weight,
+          nullptr, // scale_bias field is only used in
+                   // SparseLengths8BitsRowwiseOp
+          USE_MEAN,
+          out_data + begin * D);
+    };
+
+    // Below this many gathered values, waking up the pool costs more than it
+    // saves.
+    const TIndex kMinParallelWork = 1 << 16;
+    ThreadPool* pool = parallel_ && ws_ ? ws_->GetThreadPool() : nullptr;
+    const int numTasks = pool ? std::min<TIndex>(pool->getNumThreads(), M) : 1;
+    if (numTasks <= 1 || indices_size * D < kMinParallelWork) {
+      lookup(0, M, 0, indices_size);
+      return true;
+    }
+
+    // Splits the segments into ranges that gather about the same number of
+    // rows, one per task.
+    std::vector<TIndex> begins(numTasks + 1);
+    std::vector<TIndex> indexBegins(numTasks + 1);
+    TIndex m = 0;
+    TIndex pos = 0;
+    for (int task = 0; task < numTasks; ++task) {
+      begins[task] = m;
+      indexBegins[task] = pos;
+      const TIndex target = indices_size * (task + 1) / numTasks;
+      for (; m < M && pos < target; ++m) {
+        CAFFE_ENFORCE_GE(lengths[m], 0, "LENGTHS must be non-negative");
+        pos += lengths[m];
+      }
+    }
+    for (; m < M; ++m) {
+      pos += lengths[m];
+    }
+    begins[numTasks] = M;
+    indexBegins[numTasks] = pos;
+    CAFFE_ENFORCE_EQ(
+        pos,
         indices_size,
-        N,
-        in_data,
-        indices,
-        lengths,
-        in_weight,
-        nullptr, // scale_bias field is only used in SparseLengths8BitsRowwiseOp
-        USE_MEAN,
-        out_data);
+        "Your input seems to be incorrect: the sum of lengths values should be "
+        "the size of the indices tensor, but it appears not.");
+
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    pool->run(
+        [&](int, size_t task) {
+          try {
+            lookup(
+                begins[task],
+                begins[task + 1],
+                indexBegins[task],
+                indexBegins[task + 1]);
+          } catch (...) {
+            std::lock_guard<std::mutex> guard(errorMutex);
+            if (!error) {
+              error = std::current_exception();
+            }
+          }
+        },
+        numTasks);
+    if (error) {
+      std::rethrow_exception(error);
+    }
     return true;
   }
 
@@ -100,6 +170,11 @@ class CPUSparseLengthsReductionOp : public Operator<CPUContext> {
     LENGTHS = 2 + USE_WEIGHT, // 2 in SparseLengths[Sum, Mean],
                               // 3 in SparseLengthsWeightedSum
   };
+
+ private:
+  Workspace* ws_;
+  // Whether to reduce the segments on the thread pool of the workspace.
+  bool parallel_;
 };
 
 } // namespace caffe2
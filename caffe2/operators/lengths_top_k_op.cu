@@ -0,0 +1,357 @@
+#include "caffe2/operators/lengths_top_k_op.h"
+
+#include <cub/device/device_scan.cuh>
+#include <cub/device/device_segmented_radix_sort.cuh>
+
+#include "caffe2/core/context_gpu.h"
+#include "caffe2/operators/top_k_radix_selection.cuh"
+#include "caffe2/utils/GpuDefs.cuh"
+#include "caffe2/utils/math.h"
+
+namespace caffe2 {
+
+namespace {
+
+// Segments of up to kWarpSize * kItemsPerLane values are handled by a single
+// warp, longer ones by a block.
+constexpr int kItemsPerLane = 4;
+constexpr int kMaxWarpSegmentSize = kWarpSize * kItemsPerLane;
+
+// The values of a segment are spread over the lanes of a warp, and every
+// lane ranks its values against all the others by shuffling them around the
+// warp, which leaves the top k sorted by value and then by index without
+// shared memory or synchronization. Rows of segments shorter than k are
+// padded with 0 and -1.
+template <typename T>
+__global__ void LengthsTopKWarpKernel(
+    const T* X,
+    const int* lengths,
+    const int* offsets,
+    const int N,
+    const int k,
+    T* values,
+    int* indices) {
+  const int segment = (blockIdx.x * blockDim.x + threadIdx.x) / kWarpSize;
+  const int lane = threadIdx.x % kWarpSize;
+  if (segment >= N) {
+    return;
+  }
+  const int len = lengths[segment];
+  if (len > kMaxWarpSegmentSize) {
+    return;
+  }
+  const T* x = X + offsets[segment];
+  T* segment_values = values + segment * k;
+  int* segment_indices = indices + segment * k;
+
+  T v[kItemsPerLane];
+  int rank[kItemsPerLane];
+#pragma unroll
+  for (int j = 0; j < kItemsPerLane; ++j) {
+    const int i = lane + j * kWarpSize;
+    v[j] = i < len ? x[i] : T(0);
+    rank[j] = 0;
+  }
+  for (int src = 0; src < kWarpSize; ++src) {
+#pragma unroll
+    for (int jj = 0; jj < kItemsPerLane; ++jj) {
+#if CUDA_VERSION >= 9000
+      const T other = __shfl_sync(0xffffffff, v[jj], src);
+#else
+      const T other = __shfl(v[jj], src);
+#endif
+      const int other_index = src + jj * kWarpSize;
+#pragma unroll
+      for (int j = 0; j < kItemsPerLane; ++j) {
+        const int i = lane + j * kWarpSize;
+        rank[j] += other_index < len &&
+            (other > v[j] || (other == v[j] && other_index < i));
+      }
+    }
+  }
+#pragma unroll
+  for (int j = 0; j < kItemsPerLane; ++j) {
+    const int i = lane + j * kWarpSize;
+    if (i < len && rank[j] < k) {
+      segment_values[rank[j]] = v[j];
+      segment_indices[rank[j]] = i;
+    }
+  }
+  for (int i = len + lane; i < k; i += kWarpSize) {
+    segment_values[i] = T(0);
+    segment_indices[i] = -1;
+  }
+}
+
+// One block per long segment, which selects its top k with the radix
+// selection of TopK into `unsorted_values` and `unsorted_indices`. The
+// padding of segments shorter than k goes to `values` and `indices` directly.
+template <typename T>
+__global__ void LengthsTopKBlockKernel(
+    const T* X,
+    const int* lengths,
+    const int* offsets,
+    const int k,
+    T* unsorted_values,
+    int* unsorted_indices,
+    T* values,
+    int* indices) {
+  __shared__ int smem[32]; // one per each warp, up to warp limit
+
+  const int segment = blockIdx.x;
+  const int len = lengths[segment];
+  if (len <= kMaxWarpSegmentSize) {
+    return;
+  }
+  const T* x = X + offsets[segment];
+  const int offset = segment * k;
+  if (len > k) {
+    gatherTopKSlice<T, true, int>(
+        x, len, k, unsorted_values + offset, unsorted_indices + offset, smem);
+    return;
+  }
+  for (int i = threadIdx.x; i < k; i += blockDim.x) {
+    if (i < len) {
+      unsorted_values[offset + i] = x[i];
+      unsorted_indices[offset + i] = i;
+    } else {
+      values[offset + i] = T(0);
+      indices[offset + i] = -1;
+    }
+  }
+}
+
+// The ranges of the rows to sort: the selected values of the long segments.
+// The rows of the short segments are sorted already, so their ranges are
+// empty.
+__global__ void LengthsTopKSortRangesKernel(
+    const int* lengths,
+    const int N,
+    const int k,
+    int* begin_offsets,
+    int* end_offsets) {
+  CUDA_1D_KERNEL_LOOP(i, N) {
+    const int len = lengths[i];
+    begin_offsets[i] = i * k;
+    end_offsets[i] = i * k + (len > kMaxWarpSegmentSize ? min(len, k) : 0);
+  }
+}
+
+template <typename T>
+__global__ void LengthsTopKGradientKernel(
+    const int* lengths,
+    const int* offsets,
+    const int* indices,
+    const T* dY,
+    const int N,
+    const int k,
+    T* dX) {
+  CUDA_1D_KERNEL_LOOP(i, N * k) {
+    const int segment = i / k;
+    if (i % k < lengths[segment]) {
+      dX[offsets[segment] + indices[i]] = dY[i];
+    }
+  }
+}
+
+void LengthsOffsets(
+    const int* lengths,
+    const int N,
+    Tensor* scan_buffer,
+    Tensor* offsets,
+    CUDAContext* context) {
+  offsets->Resize(N);
+  size_t temp_storage_bytes = 0;
+  cub::DeviceScan::ExclusiveSum(
+      nullptr,
+      temp_storage_bytes,
+      lengths,
+      offsets->template mutable_data<int>(),
+      N,
+      context->cuda_stream());
+  scan_buffer->Resize(temp_storage_bytes / sizeof(int) + 1);
+  cub::DeviceScan::ExclusiveSum(
+      static_cast<void*>(scan_buffer->template mutable_data<int>()),
+      temp_storage_bytes,
+      lengths,
+      offsets->template mutable_data<int>(),
+      N,
+      context->cuda_stream());
+}
+
+} // namespace
+
+template <typename T, class Context>
+class LengthsTopKCUDAOp : public Operator<Context> {
+ public:
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+
+  LengthsTopKCUDAOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<Context>(operator_def, ws), OP_SINGLE_ARG(int, "k", k_, -1) {
+    CAFFE_ENFORCE_GE(k_, 1, "k argument must be >= 1");
+  }
+
+  bool RunOnDevice() override {
+    auto& X = Input(X_IN);
+    auto& Y = Input(Y_IN);
+    const int N = Y.dim32(0);
+    auto* output_topk_values = Output(TOPK_VALUES_OUT);
+    auto* output_topk_indices = Output(TOPK_INDICES_OUT);
+    output_topk_values->Resize(N, k_);
+    output_topk_indices->Resize(N, k_);
+    T* values = output_topk_values->template mutable_data<T>();
+    int* indices = output_topk_indices->template mutable_data<int>();
+    if (N == 0) {
+      return true;
+    }
+    const T* X_data = X.template data<T>();
+    const int* lengths = Y.template data<int>();
+    LengthsOffsets(lengths, N, &scan_buffer_, &offsets_, &context_);
+    const int* offsets = offsets_.template data<int>();
+
+    // Both kernels run over all the segments and skip those of the other
+    // one, so that the lengths never have to be copied to the host.
+    LengthsTopKWarpKernel<T>
+        <<<math::divUp(N * kWarpSize, CAFFE_CUDA_NUM_THREADS),
+           CAFFE_CUDA_NUM_THREADS,
+           0,
+           context_.cuda_stream()>>>(
+            X_data, lengths, offsets, N, k_, values, indices);
+    unsorted_values_.Resize(N, k_);
+    unsorted_indices_.Resize(N, k_);
+    LengthsTopKBlockKernel<T>
+        <<<N, CAFFE_CUDA_NUM_THREADS, 0, context_.cuda_stream()>>>(
+            X_data,
+            lengths,
+            offsets,
+            k_,
+            unsorted_values_.template mutable_data<T>(),
+            unsorted_indices_.template mutable_data<int>(),
+            values,
+            indices);
+
+    // The radix selection doesn't sort the values it selects, so the rows of
+    // the long segments are sorted by a segmented sort, which is stable and
+    // thus keeps ties ordered by index like the CPU version.
+    sort_ranges_.Resize(2, N);
+    int* begin_offsets = sort_ranges_.template mutable_data<int>();
+    int* end_offsets = begin_offsets + N;
+    LengthsTopKSortRangesKernel<<<
+        CAFFE_GET_BLOCKS(N),
+        CAFFE_CUDA_NUM_THREADS,
+        0,
+        context_.cuda_stream()>>>(lengths, N, k_, begin_offsets, end_offsets);
+    size_t temp_storage_bytes = 0;
+    cub::DeviceSegmentedRadixSort::SortPairsDescending(
+        nullptr,
+        temp_storage_bytes,
+        unsorted_values_.template data<T>(),
+        values,
+        unsorted_indices_.template data<int>(),
+        indices,
+        N * k_,
+        N,
+        begin_offsets,
+        end_offsets,
+        0,
+        sizeof(T) * 8,
+        context_.cuda_stream());
+    sort_buffer_.Resize(temp_storage_bytes / sizeof(int) + 1);
+    cub::DeviceSegmentedRadixSort::SortPairsDescending(
+        static_cast<void*>(sort_buffer_.template mutable_data<int>()),
+        temp_storage_bytes,
+        unsorted_values_.template data<T>(),
+        values,
+        unsorted_indices_.template data<int>(),
+        indices,
+        N * k_,
+        N,
+        begin_offsets,
+        end_offsets,
+        0,
+        sizeof(T) * 8,
+        context_.cuda_stream());
+    return true;
+  }
+
+ protected:
+  int k_;
+  Tensor scan_buffer_{CUDA};
+  Tensor offsets_{CUDA};
+  Tensor unsorted_values_{CUDA};
+  Tensor unsorted_indices_{CUDA};
+  Tensor sort_ranges_{CUDA};
+  Tensor sort_buffer_{CUDA};
+  INPUT_TAGS(X_IN, Y_IN);
+  OUTPUT_TAGS(TOPK_VALUES_OUT, TOPK_INDICES_OUT);
+};
+
+template <typename T, class Context>
+class LengthsTopKGradientCUDAOp : public Operator<Context> {
+ public:
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+
+  LengthsTopKGradientCUDAOp(const OperatorDef& def, Workspace* ws)
+      : Operator<Context>(def, ws), OP_SINGLE_ARG(int, "k", k_, -1) {
+    CAFFE_ENFORCE_GE(k_, 1, "k argument must be >= 1");
+  }
+
+  bool RunOnDevice() override {
+    auto& input_len = Input(LENGTH_IN);
+    const int N = input_len.size();
+    auto& input_indices = Input(INDICES_IN);
+    CAFFE_ENFORCE_GE(input_indices.ndim(), 2, "input dim must be >= 2");
+    CAFFE_ENFORCE_EQ(
+        input_indices.size(), N * k_, "input_indices shape is not correct");
+    auto& input_topk = Input(DER_TOPK_IN);
+    CAFFE_ENFORCE_EQ(
+        input_topk.size(), N * k_, "input_topk shape is not correct");
+    auto* X_out = Output(DER_X_OUT);
+
+    // The size of the gradient is the sum of the lengths, which has to be
+    // known on the host.
+    int num_indices = 0;
+    const int* lengths = input_len.template data<int>();
+    if (N > 0) {
+      LengthsOffsets(lengths, N, &scan_buffer_, &offsets_, &context_);
+      int last[2];
+      context_.CopyToCPU(1, offsets_.template data<int>() + N - 1, &last[0]);
+      context_.CopyToCPU(1, lengths + N - 1, &last[1]);
+      context_.FinishDeviceComputation();
+      num_indices = last[0] + last[1];
+    }
+    X_out->Resize(num_indices);
+    T* X_out_data = X_out->template mutable_data<T>();
+    math::Set<T, Context>(num_indices, 0.0, X_out_data, &context_);
+    if (N == 0) {
+      return true;
+    }
+    LengthsTopKGradientKernel<T>
+        <<<CAFFE_GET_BLOCKS(N * k_),
+           CAFFE_CUDA_NUM_THREADS,
+           0,
+           context_.cuda_stream()>>>(
+            lengths,
+            offsets_.template data<int>(),
+            input_indices.template data<int>(),
+            input_topk.template data<T>(),
+            N,
+            k_,
+            X_out_data);
+    return true;
+  }
+
+ protected:
+  int k_;
+  Tensor scan_buffer_{CUDA};
+  Tensor offsets_{CUDA};
+  INPUT_TAGS(LENGTH_IN, INDICES_IN, DER_TOPK_IN);
+  OUTPUT_TAGS(DER_X_OUT);
+};
+
+REGISTER_CUDA_OPERATOR(LengthsTopK, LengthsTopKCUDAOp<float, CUDAContext>);
+REGISTER_CUDA_OPERATOR(
+    LengthsTopKGradient,
+    LengthsTopKGradientCUDAOp<float, CUDAContext>);
+
+} // namespace caffe2
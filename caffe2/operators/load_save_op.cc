@@ -13,6 +13,7 @@ REGISTER_CPU_OPERATOR(DBExists, DBExistsOp<CPUContext>);
 REGISTER_CPU_OPERATOR(Load, LoadOp<CPUContext>);
 REGISTER_CPU_OPERATOR(Save, SaveOp<CPUContext>);
 REGISTER_CPU_OPERATOR(Checkpoint, CheckpointOp<CPUContext>);
+REGISTER_CPU_OPERATOR(AsyncCheckpoint, AsyncCheckpointOp<CPUContext>);
 // CPU Operator old name: do NOT use, we may deprecate this later.
 REGISTER_CPU_OPERATOR(Snapshot, CheckpointOp<CPUContext>);
 
@@ -249,11 +250,45 @@ counter). This is determined whether we need to do checkpointing.
         "(int, default 1) the checkpointing is carried out when "
         "(iter mod every) is zero.");
 
+OPERATOR_SCHEMA(AsyncCheckpoint)
+    .NumInputs(1, INT_MAX)
+    .NumOutputs(0)
+    .SetDoc(R"DOC(
+The AsyncCheckpoint operator is similar to the Checkpoint operator, but only
+copies its inputs to CPU memory before returning. They are serialized and
+written to the db in the background, with large tensors split into chunks
+serialized in parallel. The next checkpoint waits for the previous one to be
+written, and fails if it could not be.
+
+With `incremental` set, a checkpoint only holds the inputs written since the
+previous checkpoint of the operator, through their blob, and the first one
+holds all of them. Loading the checkpoints in order restores the latest one.
+)DOC")
+    .Arg(
+        "absolute_path",
+        "(int, default 0) if set, use the db path directly and do not prepend "
+        "the current root folder of the workspace.")
+    .Arg(
+        "db",
+        "(string) a template string that one can combine with the "
+        "iteration to create the final db name. For example, "
+        "\"/home/lonestarr/checkpoint_%08d.db\"")
+    .Arg("db_type", "(string) the type of the db.")
+    .Arg(
+        "every",
+        "(int, default 1) the checkpointing is carried out when "
+        "(iter mod every) is zero.")
+    .Arg(
+        "incremental",
+        "(bool, default true) whether to only save the inputs written since "
+        "the previous checkpoint.");
+
 OPERATOR_SCHEMA(Snapshot);
 
 NO_GRADIENT(Load);
 SHOULD_NOT_DO_GRADIENT(DBExists);
 SHOULD_NOT_DO_GRADIENT(Save);
 SHOULD_NOT_DO_GRADIENT(Checkpoint);
+SHOULD_NOT_DO_GRADIENT(AsyncCheckpoint);
 SHOULD_NOT_DO_GRADIENT(Snapshot);
 }  // namespace caffe2
@@ -2,6 +2,7 @@
 #define CAFFE2_OPERATORS_LOAD_SAVE_OP_H_
 
 #include <cstdio>
+#include <future>
 #include <map>
 #include <unordered_set>
 
@@ -215,15 +216,19 @@ class LoadOp final : public Operator<Context> {
       }
 
       BlobProto proto;
+      const char* raw_data;
+      size_t raw_size;
       CAFFE_ENFORCE(
-          proto.ParseFromString(cursor->value()), "Couldn't parse Proto");
+          ParseBlobProto(cursor->value(), &proto, &raw_data, &raw_size),
+          "Couldn't parse Proto");
       if (!keep_device_) {
         // If we are not keeping the device as the one specified in the
         // proto, we will set the current device.
         SetCurrentDevice(&proto);
       }
       Blob* blob = ws_->CreateBlob(key);
-      ProcessBlob(blob, proto, blob_states, key, &loaded_blobs);
+      ProcessBlob(
+          blob, proto, raw_data, raw_size, blob_states, key, &loaded_blobs);
     }
     *total_loaded_blobs += loaded_blobs;
   }
@@ -249,7 +254,10 @@ class LoadOp final : public Operator<Context> {
 
         VLOG(2) << "Deserializing blob " << key;
         BlobProto proto;
-        CAFFE_ENFORCE(proto.ParseFromString(cursor->value()));
+        const char* raw_data;
+        size_t raw_size;
+        CAFFE_ENFORCE(
+            ParseBlobProto(cursor->value(), &proto, &raw_data, &raw_size));
         if (!keep_device_) {
           // If we are not keeping the device as the one specified in the
           // proto, we will set the current device.
@@ -257,7 +265,8 @@ class LoadOp final : public Operator<Context> {
         }
         auto blobIndex = output_indices_[key];
         Blob* blob = outputs.at(blobIndex);
-        ProcessBlob(blob, proto, blob_states, key, &loaded_blobs);
+        ProcessBlob(
+            blob, proto, raw_data, raw_size, blob_states, key, &loaded_blobs);
 
         if (*total_loaded_blobs + loaded_blobs == OutputSize()) {
           break;
@@ -283,9 +292,13 @@ class LoadOp final : public Operator<Context> {
  private:
   // We are tracking sizes of already read tensor parts while reading data
   // chunks. This way we can make sure that all chunks were loaded in the end.
+  // The data of a tensor in the raw encoding is in raw_data, which is null
+  // otherwise.
   void ProcessBlob(
       Blob* blob,
       const BlobProto& proto,
+      const char* raw_data,
+      size_t raw_size,
       std::unordered_map<string, BlobState>* blob_states_ptr,
       const string& key,
       int* loaded_blobs) {
@@ -298,7 +311,7 @@ class LoadOp final : public Operator<Context> {
       // different GPU.
       blob->Reset();
     }
-    blob->Deserialize(proto);
+    blob->Deserialize(proto, raw_data, raw_size);
     if (proto.has_content_num_chunks()) {
       if (!blob_states.count(key)) {
         blob_states[key] = BlobState(proto.content_num_chunks());
@@ -556,6 +569,150 @@ class CheckpointOp final : public Operator<Context> {
   OperatorDef save_op_def_;
 };
 
+// AsyncCheckpointOp checkpoints like CheckpointOp, without holding up the
+// net until the db is written: the inputs are copied to CPU tensors, which
+// are then serialized and written in the background. Only one checkpoint is
+// written at a time, and an error writing it is raised by the next one. With
+// incremental set, a checkpoint only holds the blobs that were written since
+// the previous one, as counted by Blob::version(), and restoring takes
+// loading all the checkpoints in order.
+template <class Context>
+class AsyncCheckpointOp final : public Operator<Context> {
+ public:
+  AsyncCheckpointOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<Context>(operator_def, ws),
+        db_pattern_(this->template GetSingleArgument<string>("db", "")),
+        db_type_(this->template GetSingleArgument<string>("db_type", "")),
+        every_(this->template GetSingleArgument<int>("every", 1)),
+        absolute_path_(
+            this->template GetSingleArgument<int>("absolute_path", false)),
+        incremental_(
+            this->template GetSingleArgument<bool>("incremental", true)),
+        ws_(ws),
+        names_(operator_def.input().begin(), operator_def.input().end()),
+        versions_(names_.size()),
+        saved_(names_.size(), false),
+        copies_(names_.size()) {
+    CAFFE_ENFORCE_GT(
+        db_pattern_.size(), 0, "Must specify a checkpoint file pattern.");
+    CAFFE_ENFORCE_GT(db_type_.size(), 0, "Must specify a db type.");
+    CAFFE_ENFORCE_GT(every_, 0, "Checkpoint interval should be positive.");
+    std::set<std::string> input_names;
+    for (const auto& name : names_) {
+      CAFFE_ENFORCE(
+          input_names.insert(name).second, "Duplicated input: ", name);
+    }
+  }
+
+  ~AsyncCheckpointOp() {
+    if (pending_.valid()) {
+      try {
+        pending_.get();
+      } catch (const std::exception& e) {
+        LOG(ERROR) << "Writing the last checkpoint failed: " << e.what();
+      }
+    }
+  }
+
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+
+  bool RunOnDevice() override {
+    int64_t iter =
+        this->template Input<Tensor>(0, CPU).template data<int64_t>()[0];
+    if (iter % every_ != 0) {
+      return true;
+    }
+    if (pending_.valid()) {
+      pending_.get();
+    }
+
+    // The copies are reused from checkpoint to checkpoint. Blobs other than
+    // tensors are serialized right away.
+    std::vector<int> copied;
+    std::vector<std::pair<std::string, std::string>> serialized;
+    const vector<const Blob*>& inputs = OperatorBase::Inputs();
+    for (int i = 0; i < inputs.size(); ++i) {
+      if (incremental_ && saved_[i] && versions_[i] == inputs[i]->version()) {
+        continue;
+      }
+      if (inputs[i]->template IsType<Tensor>()) {
+        const auto& tensor = inputs[i]->template Get<Tensor>();
+        if (!copies_[i]) {
+          copies_[i].reset(new Blob());
+        }
+        auto* copy = copies_[i]->GetMutableTensor(CPU);
+        if (tensor.GetDeviceType() == CPU) {
+          copy->CopyFrom(tensor);
+        } else {
+          auto context = tensor.CreateContext();
+          copy->CopyFrom(tensor, context.get());
+          context->FinishDeviceComputation();
+        }
+        copied.push_back(i);
+      } else {
+        inputs[i]->Serialize(
+            names_[i],
+            [&](const std::string& blobName, const std::string& data) {
+              serialized.emplace_back(blobName, data);
+            });
+      }
+      versions_[i] = inputs[i]->version();
+      saved_[i] = true;
+    }
+
+    const string db_name = FormatString(db_pattern_, iter);
+    const string full_db_name =
+        absolute_path_ ? db_name : (ws_->RootFolder() + "/" + db_name);
+    auto blobs = std::make_shared<
+        std::vector<std::pair<std::string, std::string>>>(
+        std::move(serialized));
+    pending_ = std::async(
+        std::launch::async, [this, full_db_name, copied, blobs]() {
+          Write(full_db_name, copied, *blobs);
+        });
+    return true;
+  }
+
+ private:
+  void Write(
+      const string& full_db_name,
+      const std::vector<int>& copied,
+      const std::vector<std::pair<std::string, std::string>>& serialized) {
+    std::unique_ptr<DB> out_db(
+        caffe2::db::CreateDB(db_type_, full_db_name, caffe2::db::NEW));
+    CAFFE_ENFORCE(out_db.get(), "Cannot open db for writing: ", full_db_name);
+
+    BlobSerializerBase::SerializationAcceptor acceptor = [&](
+        const std::string& blobName, const std::string& data) {
+      // transaction should take care of locking
+      auto transaction = out_db->NewTransaction();
+      transaction->Put(blobName, data);
+      transaction->Commit();
+    };
+    // Large tensors are serialized in chunks on several threads.
+    for (int i : copied) {
+      copies_[i]->Serialize(names_[i], acceptor);
+    }
+    for (const auto& blob : serialized) {
+      acceptor(blob.first, blob.second);
+    }
+    out_db->Close();
+  }
+
+  string db_pattern_;
+  string db_type_;
+  int every_;
+  bool absolute_path_;
+  bool incremental_;
+  Workspace* ws_;
+  std::vector<std::string> names_;
+  // The versions of the inputs at their last checkpoint.
+  std::vector<uint64_t> versions_;
+  std::vector<bool> saved_;
+  std::vector<std::unique_ptr<Blob>> copies_;
+  std::future<void> pending_;
+};
+
 } // namespace caffe2
 
 #endif // CAFFE2_OPERATORS_LOAD_SAVE_OP_H_
@@ -0,0 +1,48 @@
+#include "caffe2/operators/murmur_hash_op.h"
+
+namespace caffe2 {
+
+template <class Context>
+constexpr int MurmurHashOp<Context>::kChunkSize;
+
+namespace {
+
+REGISTER_CPU_OPERATOR(MurmurHash, MurmurHashOp<CPUContext>);
+
+OPERATOR_SCHEMA(MurmurHash)
+    .NumInputs(1)
+    .NumOutputs(1)
+    .SetDoc(R"DOC(
+Hashes a tensor of int32 or int64 feature ids with MurmurHash3 into int64 ids,
+in batches with SIMD where the CPU supports it. Every id is sign extended to
+64 bits and hashed as 8 bytes with MurmurHash3_x64_128, of which the low 64
+bits are kept, so int32 and int64 ids of the same value hash the same.
+
+Every seed in `seeds` gives an independent hash. With a single seed, the output
+has the shape of the input; with K > 1 seeds it has an extra last dimension of
+size K, holding the hashes of an id with every seed. If `modulo` is positive,
+the hashes are taken as unsigned and bucketed into [0, modulo); otherwise the
+output holds their 64 bits as is.
+)DOC")
+    .Input(0, "Indices", "Input feature indices, int32 or int64.")
+    .Output(0, "HashedIndices", "Hashed feature indices, int64.")
+    .Arg("seeds", "list of seeds for the hash function, truncated to 32 bits "
+         "(default [0])")
+    .Arg("modulo", "if > 0, hashed ids will be modulo this number (default 0)")
+    .TensorInferenceFunction([](const OperatorDef& def,
+                                const vector<TensorShape>& in) {
+      ArgumentHelper helper(def);
+      auto seeds = helper.GetRepeatedArgument<int64_t>("seeds", {0});
+      std::vector<TIndex> output_dims = GetDimsVector(in[0]);
+      if (seeds.size() > 1) {
+        output_dims.push_back(seeds.size());
+      }
+      std::vector<TensorShape> out(1);
+      out[0] = CreateTensorShape(output_dims, TensorProto::INT64);
+      return out;
+    });
+
+SHOULD_NOT_DO_GRADIENT(MurmurHash);
+
+} // namespace
+} // namespace caffe2
@@ -0,0 +1,84 @@
+#ifndef CAFFE2_OPERATORS_MURMUR_HASH_OP_H_
+#define CAFFE2_OPERATORS_MURMUR_HASH_OP_H_
+
+#include <algorithm>
+
+#include "caffe2/core/logging.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/perfkernels/murmur_hash.h"
+
+namespace caffe2 {
+
+template <class Context>
+class MurmurHashOp final : public Operator<Context> {
+ public:
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+  MurmurHashOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<Context>(operator_def, ws),
+        seeds_(this->template GetRepeatedArgument<int64_t>("seeds", {0})),
+        modulo_(this->template GetSingleArgument<int64_t>("modulo", 0)) {
+    CAFFE_ENFORCE(!seeds_.empty(), "SEEDS shouldn't be empty");
+    CAFFE_ENFORCE_GE(modulo_, 0, "MODULO should be >= 0");
+  }
+
+  bool RunOnDevice() override {
+    return DispatchHelper<TensorTypes<int32_t, int64_t>>::call(
+        this, Input(INDICES));
+  }
+
+  template <typename T>
+  bool DoRunWithType() {
+    auto& indices = Input(INDICES);
+    auto* hashed_indices = Output(HASHED_INDICES);
+    const int K = seeds_.size();
+    auto dims = indices.dims();
+    if (K > 1) {
+      dims.push_back(K);
+    }
+    hashed_indices->Resize(dims);
+
+    const int N = indices.size();
+    const T* indices_data = indices.template data<T>();
+    uint64_t* hashed_data = reinterpret_cast<uint64_t*>(
+        hashed_indices->template mutable_data<int64_t>());
+    const uint64_t modulo = modulo_;
+
+    // Hash in chunks small enough for the keys and the hashes to stay in the
+    // L1 cache while they are hashed with every seed and bucketed.
+    uint64_t keys[kChunkSize];
+    uint64_t hashes[kChunkSize];
+    for (int start = 0; start < N; start += kChunkSize) {
+      const int n = std::min(kChunkSize, N - start);
+      for (int i = 0; i < n; ++i) {
+        keys[i] = static_cast<int64_t>(indices_data[start + i]);
+      }
+      for (int s = 0; s < K; ++s) {
+        MurmurHash3Keys64(n, keys, static_cast<uint32_t>(seeds_[s]), hashes);
+        uint64_t* out = hashed_data + static_cast<size_t>(start) * K + s;
+        if (modulo > 0) {
+          for (int i = 0; i < n; ++i) {
+            out[i * K] = hashes[i] % modulo;
+          }
+        } else {
+          for (int i = 0; i < n; ++i) {
+            out[i * K] = hashes[i];
+          }
+        }
+      }
+    }
+    return true;
+  }
+
+ private:
+  static constexpr int kChunkSize = 1024;
+
+  INPUT_TAGS(INDICES);
+  OUTPUT_TAGS(HASHED_INDICES);
+
+  std::vector<int64_t> seeds_;
+  int64_t modulo_;
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_MURMUR_HASH_OP_H_
@@ -0,0 +1,86 @@
+#include "caffe2/operators/quantized/int8_calibration.h"
+
+#include <algorithm>
+
+namespace caffe2 {
+
+CAFFE_KNOWN_TYPE(int8::CalibrationStats);
+
+namespace int8 {
+
+namespace {
+
+void recordBlob(
+    CalibrationStats* stats,
+    const std::string& name,
+    const Blob& blob) {
+  if (blob.IsType<Tensor>(CPU)) {
+    const auto& tensor = blob.Get<TensorCPU>();
+    if (tensor.IsType<float>() && tensor.size() > 0) {
+      stats->update(name, tensor);
+    }
+  }
+}
+
+} // namespace
+
+void CalibrationStats::update(
+    const std::string& name,
+    const TensorCPU& tensor) {
+  const float* data = tensor.data<float>();
+  const auto minmax = std::minmax_element(data, data + tensor.size());
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = ranges_.find(name);
+  if (it == ranges_.end()) {
+    ranges_[name] = {*minmax.first, *minmax.second};
+  } else {
+    it->second.first = std::min(it->second.first, *minmax.first);
+    it->second.second = std::max(it->second.second, *minmax.second);
+  }
+}
+
+bool CalibrationStats::params(
+    const std::string& name,
+    QuantizationParams* params) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = ranges_.find(name);
+  if (it == ranges_.end()) {
+    return false;
+  }
+  *params = ChooseQuantizationParams(it->second.first, it->second.second);
+  return true;
+}
+
+CalibrationStats* GetCalibrationStats(Workspace* ws) {
+  return ws->CreateBlob(kCalibrationStatsBlob)->GetMutable<CalibrationStats>();
+}
+
+CalibrationOperatorObserver::CalibrationOperatorObserver(
+    OperatorBase* op,
+    CalibrationNetObserver* netObserver)
+    : ObserverBase<OperatorBase>(op), netObserver_(netObserver) {}
+
+void CalibrationOperatorObserver::Start() {
+  if (!subject()->has_debug_def()) {
+    return;
+  }
+  const auto& def = subject()->debug_def();
+  auto* stats = netObserver_->stats();
+  for (int i = 0; i < subject()->InputSize(); ++i) {
+    recordBlob(stats, def.input(i), subject()->InputBlob(i));
+  }
+}
+
+void CalibrationOperatorObserver::Stop() {
+  if (!subject()->has_debug_def()) {
+    return;
+  }
+  const auto& def = subject()->debug_def();
+  auto* stats = netObserver_->stats();
+  for (int i = 0; i < subject()->OutputSize(); ++i) {
+    recordBlob(stats, def.output(i), *subject()->OutputBlob(i));
+  }
+}
+
+} // namespace int8
+} // namespace caffe2
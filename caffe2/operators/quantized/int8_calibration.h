@@ -0,0 +1,81 @@
+#ifndef CAFFE2_OPERATORS_QUANTIZED_INT8_CALIBRATION_H_
+#define CAFFE2_OPERATORS_QUANTIZED_INT8_CALIBRATION_H_
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "caffe2/core/workspace.h"
+#include "caffe2/observers/operator_attaching_net_observer.h"
+#include "caffe2/operators/quantized/int8_utils.h"
+
+namespace caffe2 {
+namespace int8 {
+
+// The workspace blob that holds the CalibrationStats used by the
+// Int8Quantization pass.
+constexpr const char* kCalibrationStatsBlob = "__int8_calibration_stats__";
+
+/**
+ * The range of the values of every float blob seen while running a net on
+ * calibration data, from which the quantization parameters of the blobs are
+ * chosen.
+ */
+class CAFFE2_API CalibrationStats {
+ public:
+  void update(const std::string& name, const TensorCPU& tensor);
+
+  // False if the blob has not been seen.
+  bool params(const std::string& name, QuantizationParams* params) const;
+
+ private:
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, std::pair<float, float>> ranges_;
+};
+
+// Creates the stats in `ws` if they are not there yet.
+CAFFE2_API CalibrationStats* GetCalibrationStats(Workspace* ws);
+
+class CalibrationNetObserver;
+class CalibrationOperatorObserver final : public ObserverBase<OperatorBase> {
+ public:
+  CalibrationOperatorObserver(
+      OperatorBase* op,
+      CalibrationNetObserver* netObserver);
+
+ private:
+  void Start() override;
+  void Stop() override;
+
+  CalibrationNetObserver* netObserver_;
+};
+
+/**
+ * Records the ranges of the float CPU inputs and outputs of all operators of
+ * the net into the CalibrationStats of `ws`. The inputs are recorded before
+ * the operators run, so in-place operators are seen with both ranges.
+ */
+class CAFFE2_API CalibrationNetObserver final
+    : public OperatorAttachingNetObserver<
+          CalibrationOperatorObserver,
+          CalibrationNetObserver> {
+ public:
+  CalibrationNetObserver(NetBase* subject, Workspace* ws)
+      : OperatorAttachingNetObserver<
+            CalibrationOperatorObserver,
+            CalibrationNetObserver>(subject, this),
+        stats_(GetCalibrationStats(ws)) {}
+
+  CalibrationStats* stats() const {
+    return stats_;
+  }
+
+ private:
+  CalibrationStats* stats_;
+};
+
+} // namespace int8
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_QUANTIZED_INT8_CALIBRATION_H_
@@ -0,0 +1,163 @@
+#include <cstring>
+
+#include "caffe2/operators/conv_pool_op_base.h"
+#include "caffe2/operators/quantized/int8_utils.h"
+#include "caffe2/perfkernels/int8_gemm.h"
+
+namespace caffe2 {
+
+namespace {
+
+class Int8ConvOp final : public ConvPoolOpBase<CPUContext> {
+ public:
+  USE_CONV_POOL_BASE_FUNCTIONS(CPUContext);
+
+  Int8ConvOp(const OperatorDef& operator_def, Workspace* ws)
+      : ConvPoolOpBase<CPUContext>(operator_def, ws),
+        scale_(GetSingleArgument<float>("Y_scale", 1.f)),
+        zero_point_(GetSingleArgument<int>("Y_zero_point", 0)),
+        relu_(GetSingleArgument<bool>("relu", false)) {
+    CAFFE_ENFORCE_GT(scale_, 0);
+    CAFFE_ENFORCE_EQ(kernel_.size(), 2, "Int8Conv only supports 2D");
+    CAFFE_ENFORCE_EQ(group_, 1, "Int8Conv does not support groups");
+  }
+
+  bool RunOnDeviceWithOrderNHWC() override {
+    return RunWithOrder(true);
+  }
+
+  bool RunOnDeviceWithOrderNCHW() override {
+    return RunWithOrder(false);
+  }
+
+ private:
+  bool RunWithOrder(bool nhwc) {
+    const auto& X = OperatorBase::Input<int8::Int8TensorCPU>(0);
+    const auto& W = OperatorBase::Input<int8::Int8PackedWeights>(1);
+    auto* Y = Outputs()[0]->GetMutable<int8::Int8TensorCPU>();
+    CAFFE_ENFORCE_EQ(X.t.ndim(), 4);
+
+    const int N = X.t.dim32(0);
+    const int C = nhwc ? X.t.dim32(3) : X.t.dim32(1);
+    const int H = nhwc ? X.t.dim32(1) : X.t.dim32(2);
+    const int Wd = nhwc ? X.t.dim32(2) : X.t.dim32(3);
+    const int K = C * kernel_h() * kernel_w();
+    CAFFE_ENFORCE_EQ(K, W.K, "The input does not match the weights");
+    ConvPoolOpBase<CPUContext>::SetOutputSize(X.t, &Y->t, W.N);
+    Y->scale = scale_;
+    Y->zero_point = zero_point_;
+    const int outH = nhwc ? Y->t.dim32(1) : Y->t.dim32(2);
+    const int outW = nhwc ? Y->t.dim32(2) : Y->t.dim32(3);
+    const int P = outH * outW;
+
+    // A 1x1 NHWC convolution without stride and padding is an FC on the
+    // pixels, otherwise the patches are gathered into rows first.
+    const bool pointwise = nhwc && kernel_h() == 1 && kernel_w() == 1 &&
+        stride_h() == 1 && stride_w() == 1 && !HasPad();
+    const uint8_t* x = X.t.data<uint8_t>();
+    uint8_t* y = Y->t.mutable_data<uint8_t>();
+    acc_.resize(P * W.N);
+    if (!pointwise) {
+      rows_.resize(P * K);
+    }
+    for (int n = 0; n < N; ++n) {
+      const uint8_t* image = x + n * H * Wd * C;
+      if (!pointwise) {
+        Im2Row(nhwc, image, C, H, Wd, outH, outW, X.zero_point);
+      }
+      Int8GemmPackedB(
+          P,
+          W.N,
+          K,
+          pointwise ? image : rows_.data(),
+          K,
+          W.packed.data(),
+          acc_.data(),
+          W.N);
+      int8::Requantize(
+          P,
+          acc_.data(),
+          X.scale,
+          X.zero_point,
+          W,
+          scale_,
+          zero_point_,
+          relu_,
+          y + n * P * W.N,
+          nhwc ? W.N : 1,
+          nhwc ? 1 : P);
+    }
+    return true;
+  }
+
+  // Gathers the patch of every output pixel into a row of rows_, in the
+  // order of the weights: (kh, kw, c) for NHWC and (c, kh, kw) for NCHW.
+  // Padding is filled with the zero point, which represents 0.
+  void Im2Row(
+      bool nhwc,
+      const uint8_t* image,
+      int C,
+      int H,
+      int W,
+      int outH,
+      int outW,
+      uint8_t zero_point) {
+    const int K = C * kernel_h() * kernel_w();
+    for (int oh = 0; oh < outH; ++oh) {
+      for (int ow = 0; ow < outW; ++ow) {
+        uint8_t* row = rows_.data() + (oh * outW + ow) * K;
+        for (int kh = 0; kh < kernel_h(); ++kh) {
+          const int ih = oh * stride_h() - pad_t() + kh * dilation_h();
+          for (int kw = 0; kw < kernel_w(); ++kw) {
+            const int iw = ow * stride_w() - pad_l() + kw * dilation_w();
+            const bool inside = ih >= 0 && ih < H && iw >= 0 && iw < W;
+            if (nhwc) {
+              uint8_t* dst = row + (kh * kernel_w() + kw) * C;
+              if (inside) {
+                std::memcpy(dst, image + (ih * W + iw) * C, C);
+              } else {
+                std::memset(dst, zero_point, C);
+              }
+            } else {
+              for (int c = 0; c < C; ++c) {
+                row[(c * kernel_h() + kh) * kernel_w() + kw] = inside
+                    ? image[(c * H + ih) * W + iw]
+                    : zero_point;
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  const float scale_;
+  const int32_t zero_point_;
+  const bool relu_;
+  std::vector<uint8_t> rows_;
+  std::vector<int32_t> acc_;
+};
+
+} // namespace
+
+REGISTER_CPU_OPERATOR(Int8Conv, Int8ConvOp);
+
+OPERATOR_SCHEMA(Int8Conv)
+    .NumInputs(2)
+    .NumOutputs(1)
+    .SetDoc(R"DOC(
+The int8 version of a 2D Conv without groups, for a uint8 input in NCHW or
+NHWC order and weights packed by Int8PackWeight from the float weights of
+the same order. The patches are gathered into rows and multiplied with the
+int8 GEMM; the accumulators are requantized with per-channel scales.
+)DOC")
+    .Arg("Y_scale", "Scale of the output")
+    .Arg("Y_zero_point", "Zero point of the output")
+    .Arg("relu", "Clamps the output at zero (default false)")
+    .Input(0, "X", "Int8TensorCPU input")
+    .Input(1, "W_packed", "Weights and bias packed by Int8PackWeight")
+    .Output(0, "Y", "Int8TensorCPU output");
+
+NO_GRADIENT(Int8Conv);
+
+} // namespace caffe2
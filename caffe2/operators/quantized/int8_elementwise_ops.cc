@@ -0,0 +1,112 @@
+#include "caffe2/core/operator.h"
+#include "caffe2/operators/quantized/int8_utils.h"
+
+namespace caffe2 {
+
+namespace {
+
+class Int8AddOp final : public Operator<CPUContext> {
+ public:
+  Int8AddOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws),
+        scale_(GetSingleArgument<float>("Y_scale", 1.f)),
+        zero_point_(GetSingleArgument<int>("Y_zero_point", 0)),
+        relu_(GetSingleArgument<bool>("relu", false)) {
+    CAFFE_ENFORCE_GT(scale_, 0);
+  }
+
+  bool RunOnDevice() override {
+    const auto& A = OperatorBase::Input<int8::Int8TensorCPU>(0);
+    const auto& B = OperatorBase::Input<int8::Int8TensorCPU>(1);
+    CAFFE_ENFORCE_EQ(
+        A.t.dims(), B.t.dims(), "Int8Add does not support broadcasting");
+    auto* Y = Outputs()[0]->GetMutable<int8::Int8TensorCPU>();
+    // Y may be A or B.
+    const float a_scale = A.scale;
+    const float b_scale = B.scale;
+    const int32_t a_zero_point = A.zero_point;
+    const int32_t b_zero_point = B.zero_point;
+    Y->t.ResizeLike(A.t);
+    Y->scale = scale_;
+    Y->zero_point = zero_point_;
+
+    // y = (a_scale * (a - a_zp) + b_scale * (b - b_zp)) / y_scale + y_zp
+    const float inv_scale = 1.f / scale_;
+    const float a_multiplier = a_scale * inv_scale;
+    const float b_multiplier = b_scale * inv_scale;
+    const float offset = zero_point_ - a_multiplier * a_zero_point -
+        b_multiplier * b_zero_point;
+    const int32_t lower = relu_ ? zero_point_ : 0;
+    const uint8_t* a = A.t.data<uint8_t>();
+    const uint8_t* b = B.t.data<uint8_t>();
+    uint8_t* y = Y->t.mutable_data<uint8_t>();
+    for (TIndex i = 0; i < Y->t.size(); ++i) {
+      const int32_t q =
+          std::nearbyint(a_multiplier * a[i] + b_multiplier * b[i] + offset);
+      y[i] = std::min<int32_t>(255, std::max<int32_t>(lower, q));
+    }
+    return true;
+  }
+
+ private:
+  const float scale_;
+  const int32_t zero_point_;
+  const bool relu_;
+};
+
+class Int8ReluOp final : public Operator<CPUContext> {
+ public:
+  USE_SIMPLE_CTOR_DTOR(Int8ReluOp);
+
+  bool RunOnDevice() override {
+    const auto& X = OperatorBase::Input<int8::Int8TensorCPU>(0);
+    auto* Y = Outputs()[0]->GetMutable<int8::Int8TensorCPU>();
+    // The zero point represents 0, and keeping the quantization of the
+    // input makes relu a clamp.
+    const int32_t zero_point = X.zero_point;
+    Y->scale = X.scale;
+    Y->zero_point = zero_point;
+    Y->t.ResizeLike(X.t);
+    const uint8_t* x = X.t.data<uint8_t>();
+    uint8_t* y = Y->t.mutable_data<uint8_t>();
+    for (TIndex i = 0; i < X.t.size(); ++i) {
+      y[i] = std::max<int32_t>(x[i], zero_point);
+    }
+    return true;
+  }
+};
+
+} // namespace
+
+REGISTER_CPU_OPERATOR(Int8Add, Int8AddOp);
+REGISTER_CPU_OPERATOR(Int8Relu, Int8ReluOp);
+
+OPERATOR_SCHEMA(Int8Add)
+    .NumInputs(2)
+    .NumOutputs(1)
+    .AllowInplace({{0, 0}, {1, 0}})
+    .SetDoc(R"DOC(
+Adds two Int8TensorCPU of the same shape, each with its own quantization,
+and requantizes the sum to Y_scale and Y_zero_point.
+)DOC")
+    .Arg("Y_scale", "Scale of the output")
+    .Arg("Y_zero_point", "Zero point of the output")
+    .Arg("relu", "Clamps the output at zero (default false)")
+    .Input(0, "A", "Int8TensorCPU input")
+    .Input(1, "B", "Int8TensorCPU input of the same shape as A")
+    .Output(0, "Y", "Int8TensorCPU output");
+
+OPERATOR_SCHEMA(Int8Relu)
+    .NumInputs(1)
+    .NumOutputs(1)
+    .AllowInplace({{0, 0}})
+    .SetDoc(R"DOC(
+Relu on an Int8TensorCPU. The output keeps the quantization of the input.
+)DOC")
+    .Input(0, "X", "Int8TensorCPU input")
+    .Output(0, "Y", "Int8TensorCPU output");
+
+NO_GRADIENT(Int8Add);
+NO_GRADIENT(Int8Relu);
+
+} // namespace caffe2
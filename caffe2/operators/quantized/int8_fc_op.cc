@@ -0,0 +1,91 @@
+#include "caffe2/core/operator.h"
+#include "caffe2/operators/quantized/int8_utils.h"
+#include "caffe2/perfkernels/int8_gemm.h"
+
+namespace caffe2 {
+
+namespace {
+
+class Int8FCOp final : public Operator<CPUContext> {
+ public:
+  Int8FCOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws),
+        axis_(GetSingleArgument<int>("axis", 1)),
+        scale_(GetSingleArgument<float>("Y_scale", 1.f)),
+        zero_point_(GetSingleArgument<int>("Y_zero_point", 0)),
+        relu_(GetSingleArgument<bool>("relu", false)) {
+    CAFFE_ENFORCE_GT(scale_, 0);
+  }
+
+  bool RunOnDevice() override {
+    const auto& X = OperatorBase::Input<int8::Int8TensorCPU>(0);
+    const auto& W = OperatorBase::Input<int8::Int8PackedWeights>(1);
+    auto* Y = Outputs()[0]->GetMutable<int8::Int8TensorCPU>();
+
+    const int axis = X.t.canonical_axis_index(axis_);
+    const int M = X.t.size_to_dim(axis);
+    const int K = X.t.size_from_dim(axis);
+    CAFFE_ENFORCE_EQ(K, W.K, "The input does not match the weights");
+    auto dims = X.t.dims();
+    dims.resize(axis + 1);
+    dims[axis] = W.N;
+    Y->t.Resize(dims);
+    Y->scale = scale_;
+    Y->zero_point = zero_point_;
+
+    acc_.resize(M * W.N);
+    Int8GemmPackedB(
+        M,
+        W.N,
+        K,
+        X.t.data<uint8_t>(),
+        K,
+        W.packed.data(),
+        acc_.data(),
+        W.N);
+    int8::Requantize(
+        M,
+        acc_.data(),
+        X.scale,
+        X.zero_point,
+        W,
+        scale_,
+        zero_point_,
+        relu_,
+        Y->t.mutable_data<uint8_t>(),
+        W.N,
+        1);
+    return true;
+  }
+
+ private:
+  const int axis_;
+  const float scale_;
+  const int32_t zero_point_;
+  const bool relu_;
+  std::vector<int32_t> acc_;
+};
+
+} // namespace
+
+REGISTER_CPU_OPERATOR(Int8FC, Int8FCOp);
+
+OPERATOR_SCHEMA(Int8FC)
+    .NumInputs(2)
+    .NumOutputs(1)
+    .SetDoc(R"DOC(
+The int8 version of FC, Y = X * W^T + b, for a uint8 input and weights
+packed by Int8PackWeight. The products are accumulated in int32 and
+requantized to the uint8 output with per-channel scales.
+)DOC")
+    .Arg("axis", "As in FC (default 1)")
+    .Arg("Y_scale", "Scale of the output")
+    .Arg("Y_zero_point", "Zero point of the output")
+    .Arg("relu", "Clamps the output at zero (default false)")
+    .Input(0, "X", "Int8TensorCPU input")
+    .Input(1, "W_packed", "Weights and bias packed by Int8PackWeight")
+    .Output(0, "Y", "Int8TensorCPU output");
+
+NO_GRADIENT(Int8FC);
+
+} // namespace caffe2
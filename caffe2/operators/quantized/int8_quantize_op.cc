@@ -0,0 +1,109 @@
+#include "caffe2/core/operator.h"
+#include "caffe2/operators/quantized/int8_utils.h"
+
+namespace caffe2 {
+
+namespace {
+
+class Int8QuantizeOp final : public Operator<CPUContext> {
+ public:
+  Int8QuantizeOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws),
+        scale_(GetSingleArgument<float>("Y_scale", 1.f)),
+        zero_point_(GetSingleArgument<int>("Y_zero_point", 0)) {
+    CAFFE_ENFORCE_GT(scale_, 0);
+  }
+
+  bool RunOnDevice() override {
+    const auto& X = Input(0);
+    auto* Y = Outputs()[0]->GetMutable<int8::Int8TensorCPU>();
+    Y->scale = scale_;
+    Y->zero_point = zero_point_;
+    Y->t.ResizeLike(X);
+    const float* x = X.data<float>();
+    uint8_t* y = Y->t.mutable_data<uint8_t>();
+    const float inv_scale = 1.f / scale_;
+    for (TIndex i = 0; i < X.size(); ++i) {
+      y[i] = int8::Quantize(x[i], inv_scale, zero_point_);
+    }
+    return true;
+  }
+
+ private:
+  const float scale_;
+  const int32_t zero_point_;
+};
+
+class Int8DequantizeOp final : public Operator<CPUContext> {
+ public:
+  USE_SIMPLE_CTOR_DTOR(Int8DequantizeOp);
+
+  bool RunOnDevice() override {
+    const auto& X = OperatorBase::Input<int8::Int8TensorCPU>(0);
+    auto* Y = Output(0);
+    Y->ResizeLike(X.t);
+    const uint8_t* x = X.t.data<uint8_t>();
+    float* y = Y->mutable_data<float>();
+    for (TIndex i = 0; i < X.t.size(); ++i) {
+      y[i] = X.scale * (int32_t(x[i]) - X.zero_point);
+    }
+    return true;
+  }
+};
+
+class Int8PackWeightOp final : public Operator<CPUContext> {
+ public:
+  USE_SIMPLE_CTOR_DTOR(Int8PackWeightOp);
+
+  bool RunOnDevice() override {
+    int8::PackInt8Weights(
+        Input(0),
+        InputSize() > 1 ? &Input(1) : nullptr,
+        Outputs()[0]->GetMutable<int8::Int8PackedWeights>());
+    return true;
+  }
+};
+
+} // namespace
+
+REGISTER_CPU_OPERATOR(Int8Quantize, Int8QuantizeOp);
+REGISTER_CPU_OPERATOR(Int8Dequantize, Int8DequantizeOp);
+REGISTER_CPU_OPERATOR(Int8PackWeight, Int8PackWeightOp);
+
+OPERATOR_SCHEMA(Int8Quantize)
+    .NumInputs(1)
+    .NumOutputs(1)
+    .SetDoc(R"DOC(
+Quantizes a float tensor to uint8, q = clamp(round(x / Y_scale) +
+Y_zero_point, 0, 255). The output is an Int8TensorCPU that carries the scale
+and zero point.
+)DOC")
+    .Arg("Y_scale", "Scale of the output")
+    .Arg("Y_zero_point", "Zero point of the output, in [0, 255]")
+    .Input(0, "X", "Float tensor")
+    .Output(0, "Y", "Int8TensorCPU");
+
+OPERATOR_SCHEMA(Int8Dequantize)
+    .NumInputs(1)
+    .NumOutputs(1)
+    .SetDoc("Converts an Int8TensorCPU back to a float tensor.")
+    .Input(0, "X", "Int8TensorCPU")
+    .Output(0, "Y", "Float tensor");
+
+OPERATOR_SCHEMA(Int8PackWeight)
+    .NumInputs(1, 2)
+    .NumOutputs(1)
+    .SetDoc(R"DOC(
+Quantizes the float weights of an FC or convolution, of shape
+{output channels, ...}, to int8 with one scale per output channel and packs
+them for Int8FC and Int8Conv. Run it once, e.g. in the init net.
+)DOC")
+    .Input(0, "W", "Float weights")
+    .Input(1, "b", "Optional float bias, one per output channel")
+    .Output(0, "W_packed", "Packed weights");
+
+NO_GRADIENT(Int8Quantize);
+NO_GRADIENT(Int8Dequantize);
+NO_GRADIENT(Int8PackWeight);
+
+} // namespace caffe2
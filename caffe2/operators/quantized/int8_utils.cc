@@ -0,0 +1,83 @@
+#include "caffe2/operators/quantized/int8_utils.h"
+
+#include "caffe2/perfkernels/int8_gemm.h"
+
+namespace caffe2 {
+
+CAFFE_KNOWN_TYPE(int8::Int8PackedWeights);
+
+namespace int8 {
+
+void PackInt8Weights(
+    const TensorCPU& W,
+    const TensorCPU* b,
+    Int8PackedWeights* packed) {
+  CAFFE_ENFORCE_GE(W.ndim(), 2);
+  const int N = W.dim32(0);
+  const int K = W.size_from_dim(1);
+  packed->N = N;
+  packed->K = K;
+  packed->scales.resize(N);
+  packed->row_sums.resize(N);
+
+  const float* w = W.data<float>();
+  std::vector<int8_t> quantized(N * K);
+  for (int n = 0; n < N; ++n) {
+    float max = 0;
+    for (int k = 0; k < K; ++k) {
+      max = std::max(max, std::abs(w[n * K + k]));
+    }
+    const float scale = max > 0 ? max / 127.f : 1.f;
+    int32_t sum = 0;
+    for (int k = 0; k < K; ++k) {
+      const int32_t q = std::nearbyint(w[n * K + k] / scale);
+      quantized[n * K + k] = std::min(127, std::max(-127, q));
+      sum += quantized[n * K + k];
+    }
+    packed->scales[n] = scale;
+    packed->row_sums[n] = sum;
+  }
+  packed->packed.resize(Int8GemmPackedBSize(N, K));
+  Int8GemmPackB(N, K, quantized.data(), packed->packed.data());
+
+  packed->bias.clear();
+  if (b) {
+    CAFFE_ENFORCE_EQ(b->size(), N);
+    packed->bias.assign(b->data<float>(), b->data<float>() + N);
+  }
+}
+
+void Requantize(
+    int M,
+    const int32_t* acc,
+    float input_scale,
+    int32_t input_zero_point,
+    const Int8PackedWeights& weights,
+    float output_scale,
+    int32_t output_zero_point,
+    bool relu,
+    uint8_t* Y,
+    int y_stride_m,
+    int y_stride_n) {
+  const int N = weights.N;
+  std::vector<float> multipliers(N);
+  std::vector<float> offsets(N);
+  for (int n = 0; n < N; ++n) {
+    multipliers[n] = input_scale * weights.scales[n] / output_scale;
+    offsets[n] = (weights.bias.empty() ? 0.f : weights.bias[n]) / output_scale -
+        multipliers[n] * input_zero_point * weights.row_sums[n];
+  }
+  const float low = relu ? output_zero_point : 0;
+  const float high = 255;
+  for (int m = 0; m < M; ++m) {
+    for (int n = 0; n < N; ++n) {
+      const float v = acc[m * N + n] * multipliers[n] + offsets[n] +
+          output_zero_point;
+      Y[m * y_stride_m + n * y_stride_n] =
+          std::nearbyint(std::min(high, std::max(low, v)));
+    }
+  }
+}
+
+} // namespace int8
+} // namespace caffe2
@@ -0,0 +1,88 @@
+#ifndef CAFFE2_OPERATORS_QUANTIZED_INT8_UTILS_H_
+#define CAFFE2_OPERATORS_QUANTIZED_INT8_UTILS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "caffe2/core/tensor.h"
+#include "caffe2/core/tensor_int8.h"
+
+namespace caffe2 {
+namespace int8 {
+
+/**
+ * Activations are quantized asymmetrically to uint8,
+ * x = scale * (q - zero_point), so that the range of the values maps to
+ * [0, 255] with 0 exactly representable.
+ */
+struct QuantizationParams {
+  float scale;
+  int32_t zero_point;
+};
+
+inline QuantizationParams ChooseQuantizationParams(float min, float max) {
+  min = std::min(min, 0.f);
+  max = std::max(max, 0.f);
+  QuantizationParams params;
+  params.scale = max > min ? (max - min) / 255.f : 1.f;
+  params.zero_point = std::min<int32_t>(
+      255, std::max<int32_t>(0, std::nearbyint(-min / params.scale)));
+  return params;
+}
+
+inline uint8_t Quantize(float x, float inv_scale, int32_t zero_point) {
+  const int32_t q = std::nearbyint(x * inv_scale) + zero_point;
+  return std::min<int32_t>(255, std::max<int32_t>(0, q));
+}
+
+/**
+ * Weights prepacked for Int8GemmPackedB. The weights are quantized
+ * symmetrically to int8 with one scale per output channel,
+ * w[n][k] = scales[n] * q[n][k], which keeps the error of channels with
+ * small weights low. The bias stays in float and is added in the
+ * requantization epilogue.
+ */
+struct Int8PackedWeights {
+  // output channels and the size of the reduction
+  int N = 0;
+  int K = 0;
+  std::vector<int8_t> packed;
+  std::vector<float> scales;
+  // sum_k q[n][k], which corrects the accumulators for the input zero point
+  std::vector<int32_t> row_sums;
+  std::vector<float> bias;
+};
+
+// Quantizes and packs the float weights W, of shape {N, ...}, and the
+// optional bias b of shape {N}.
+CAFFE2_API void PackInt8Weights(
+    const TensorCPU& W,
+    const TensorCPU* b,
+    Int8PackedWeights* packed);
+
+/**
+ * Converts the int32 accumulators of an M x N GEMM of the input, quantized
+ * with input_scale and input_zero_point, with `weights` to uint8 outputs
+ * quantized with output_scale and output_zero_point. With relu the outputs
+ * are clamped at zero. Output (m, n) is written to
+ * Y[m * y_stride_m + n * y_stride_n], so NCHW outputs can be written
+ * transposed.
+ */
+CAFFE2_API void Requantize(
+    int M,
+    const int32_t* acc,
+    float input_scale,
+    int32_t input_zero_point,
+    const Int8PackedWeights& weights,
+    float output_scale,
+    int32_t output_zero_point,
+    bool relu,
+    uint8_t* Y,
+    int y_stride_m,
+    int y_stride_n);
+
+} // namespace int8
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_QUANTIZED_INT8_UTILS_H_
@@ -33,7 +33,7 @@ std::unique_ptr<RecurrentNetworkExecutorBase> createRNNExecutor<CPUContext>(
 bool ThreadedRecurrentNetworkExecutor::Run(int T) {
   CAFFE_ENFORCE(timestep_ops_.size() >= T);
   countdown_ = T * timestep_ops_[0].size();
-  finished_timesteps_ = 0;
+  StartTimesteps(T);
 
   CHECK(task_queue_.size() == 0);
 
@@ -54,7 +54,7 @@ bool ThreadedRecurrentNetworkExecutor::Run(int T) {
 bool ThreadedRecurrentNetworkExecutor::RunBackwards(int T) {
   CAFFE_ENFORCE(timestep_ops_.size() >= T);
   countdown_ = T * timestep_ops_[0].size();
-  finished_timesteps_ = 0;
+  StartTimesteps(T);
 
   // Frontier
   CHECK(task_queue_.size() == 0);
@@ -69,11 +69,88 @@ bool ThreadedRecurrentNetworkExecutor::RunBackwards(int T) {
   return true;
 }
 
+/**
+ * Resets the per-timestep bookkeeping for a run over T timesteps.
+ */
+void ThreadedRecurrentNetworkExecutor::StartTimesteps(int T) {
+  timestep_countdown_.reset(new std::atomic<int>[T]);
+  for (int t = 0; t < T; t++) {
+    timestep_countdown_[t] = timestep_ops_[0].size();
+  }
+  timestep_done_.assign(T, false);
+  finished_timesteps_ = 0;
+  CHECK(parked_tasks_.empty());
+}
+
+/**
+ * Returns whether the task's timestep is within max_parallel_timesteps_ of
+ * the completed ones. Otherwise parks the task, for FinishTask() to schedule
+ * it once the timesteps before it complete.
+ */
+bool ThreadedRecurrentNetworkExecutor::AdmitTask(OpTask job) {
+  if (max_parallel_timesteps_ <= 0) {
+    return true;
+  }
+  int t = job.forward() ? job.timestep : job.T - 1 - job.timestep;
+  if (t - finished_timesteps_ < max_parallel_timesteps_) {
+    return true;
+  }
+  std::lock_guard<std::mutex> lk(window_mtx_);
+  // Checked again, so that a timestep completing concurrently does not miss
+  // this task.
+  if (t - finished_timesteps_ < max_parallel_timesteps_) {
+    return true;
+  }
+  parked_tasks_.push_back(job);
+  return false;
+}
+
+/**
+ * Counts a task as done, and when it was the last one of its timestep,
+ * advances the completed timesteps and schedules the parked tasks that
+ * fit in the window now.
+ */
+void ThreadedRecurrentNetworkExecutor::FinishTask(OpTask job) {
+  int t = job.forward() ? job.timestep : job.T - 1 - job.timestep;
+  if (timestep_countdown_[t].fetch_sub(1) != 1) {
+    return;
+  }
+  std::vector<OpTask> ready;
+  {
+    std::lock_guard<std::mutex> lk(window_mtx_);
+    timestep_done_[t] = true;
+    int finished = finished_timesteps_;
+    while (finished < job.T && timestep_done_[finished]) {
+      finished++;
+    }
+    finished_timesteps_ = finished;
+
+    auto it = parked_tasks_.begin();
+    while (it != parked_tasks_.end()) {
+      int parked_t = it->forward() ? it->timestep : it->T - 1 - it->timestep;
+      if (parked_t - finished < max_parallel_timesteps_) {
+        ready.push_back(*it);
+        it = parked_tasks_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  for (auto& task : ready) {
+    task_queue_.Push(task);
+  }
+}
+
 /**
  * Runs a single op and updates its dependencies when finished. If
- * dependent ops are ready to run, adds them to the task_queue.
+ * dependent ops are ready to run, returns the first one in `next`, for the
+ * calling worker to run while the op's outputs are still in its cache,
+ * and adds the others to the task_queue.
  */
-void ThreadedRecurrentNetworkExecutor::RunOp(OpTask job, int /*thread_id*/) {
+bool ThreadedRecurrentNetworkExecutor::RunOp(
+    OpTask job,
+    int /*thread_id*/,
+    OpTask* next) {
   bool first_timestep =
       ((job.forward() && job.timestep == 0) ||
        (job.backward() && job.timestep == job.T - 1));
@@ -104,6 +181,7 @@ void ThreadedRecurrentNetworkExecutor::RunOp(OpTask job, int /*thread_id*/) {
 
   // Knock down dependencies and start next ops, if this
   // was last dependency fulfilled.
+  bool has_next = false;
   for (int depidx : rnn_op.dependencies) {
     int t = job.timestep;
     bool for_next_timestep = depidx <= rnn_op.order;
@@ -124,10 +202,17 @@ void ThreadedRecurrentNetworkExecutor::RunOp(OpTask job, int /*thread_id*/) {
     }
 
     if (proc_inputs == num_req_inputs || num_req_inputs == 0) {
-      task_queue_.Push(OpTask(t, depidx, job.T, job.direction));
+      if (has_next) {
+        task_queue_.Push(OpTask(t, depidx, job.T, job.direction));
+      } else {
+        *next = OpTask(t, depidx, job.T, job.direction);
+        has_next = true;
+      }
     }
   }
 
+  FinishTask(job);
+
   // Decrement countdown: when at zero, we have run all ops and can
   // notify the caller thread.
   if (countdown_.fetch_sub(1) == 1) {
@@ -135,6 +220,7 @@ void ThreadedRecurrentNetworkExecutor::RunOp(OpTask job, int /*thread_id*/) {
     std::unique_lock<std::mutex> lk(countdown_mtx_);
     cv_.notify_one();
   }
+  return has_next;
 }
 
 /**
@@ -152,32 +238,26 @@ void ThreadedRecurrentNetworkExecutor::WorkerFunction() {
       break;
     }
 
-    // Check for limited timestep parallelism, and if too many timesteps would
-    // be started concurrently, return the task to task queue.
-    if (max_parallel_timesteps_ > 0) {
-      int t = (job.direction == 1 ? job.timestep : job.T - job.timestep + 1);
-      if (t - finished_timesteps_ >= max_parallel_timesteps_) {
-        // Return to queue
-        task_queue_.Push(job);
-        continue;
-      }
-    }
-
-    try {
-      RunOp(job, id);
-      if (job.op_idx == timestep_ops_template_.size() - 1) {
-        finished_timesteps_.fetch_add(1);
+    // Run the task, then the ops it made ready, as long as there are some.
+    // With limited timestep parallelism, a task too far ahead is parked
+    // until the timesteps before it complete.
+    bool has_job = true;
+    while (has_job && !failed_ && AdmitTask(job)) {
+      try {
+        OpTask next;
+        has_job = RunOp(job, id, &next);
+        job = next;
+        num_jobs++;
+      } catch (::caffe2::EnforceNotMet& enf) {
+        std::unique_lock<std::mutex> lk(countdown_mtx_);
+        LOG(ERROR) << "Crash at thread " << id << " timestep " << job.timestep
+                   << " op:" << ProtoDebugString(step_net_def_.op(job.op_idx))
+                   << enf.what();
+        task_queue_.NoMoreJobs();
+        failed_ = true;
+        cv_.notify_one();
+        return;
       }
-      num_jobs++;
-    } catch (::caffe2::EnforceNotMet& enf) {
-      std::unique_lock<std::mutex> lk(countdown_mtx_);
-      LOG(ERROR) << "Crash at thread " << id << " timestep " << job.timestep
-                 << " op:" << ProtoDebugString(step_net_def_.op(job.op_idx))
-                 << enf.what();
-      task_queue_.NoMoreJobs();
-      failed_ = true;
-      cv_.notify_one();
-      return;
     }
   }
   VLOG(1) << "Worker exiting, did run: " << num_jobs << " jobs";
@@ -1,7 +1,10 @@
 #ifndef CAFFE2_OPERATORS_RECURRENT_NETWORK_EXECUTOR_H_
 #define CAFFE2_OPERATORS_RECURRENT_NETWORK_EXECUTOR_H_
 
+#include <atomic>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <unordered_set>
 #include <vector>
 
@@ -502,13 +505,30 @@ class ThreadedRecurrentNetworkExecutor : public RecurrentNetworkExecutorBase {
 
   void WorkerFunction();
 
-  void RunOp(OpTask job, int thread_id);
+  bool RunOp(OpTask job, int thread_id, OpTask* next);
+
+  void StartTimesteps(int T);
+
+  bool AdmitTask(OpTask job);
+
+  void FinishTask(OpTask job);
 
   SimpleQueue<OpTask> task_queue_;
   std::atomic<int> countdown_;
   std::atomic<bool> failed_;
-  std::atomic<int> finished_timesteps_;
   int num_ops_;
+
+  // Ops left to run in each timestep, indexed in execution order, and the
+  // number of timesteps from the start that have completed. With
+  // max_parallel_timesteps_ set, tasks of timesteps that far past the
+  // completed ones would share workspaces and ops with a running timestep,
+  // so they wait in parked_tasks_ until the window moves.
+  std::unique_ptr<std::atomic<int>[]> timestep_countdown_;
+  std::vector<bool> timestep_done_;
+  std::atomic<int> finished_timesteps_;
+  std::vector<OpTask> parked_tasks_;
+  std::mutex window_mtx_;
+
   std::mutex countdown_mtx_;
   std::condition_variable cv_;
   std::vector<std::thread> workers_;
@@ -51,11 +51,16 @@ struct ScratchWorkspaces {
   std::shared_ptr<Workspace> sharedBlobsWs = nullptr;
 };
 
-inline void UpdateTimestepBlob(Workspace* ws, std::string blob_name, int t) {
-  ws->CreateBlob(blob_name)->GetMutableTensor(CPU)->Resize(1);
-  auto timestepBlob = ws->GetBlob(blob_name);
+inline void UpdateTimestepBlob(Workspace* ws, BlobId blob_id, int t) {
+  auto timestepBlob = ws->CreateBlob(blob_id);
   CAFFE_ENFORCE(timestepBlob);
-  timestepBlob->GetMutableTensor(CPU)->template mutable_data<int32_t>()[0] = t;
+  auto* timestepTensor = timestepBlob->GetMutableTensor(CPU);
+  timestepTensor->Resize(1);
+  timestepTensor->template mutable_data<int32_t>()[0] = t;
+}
+
+inline void UpdateTimestepBlob(Workspace* ws, std::string blob_name, int t) {
+  UpdateTimestepBlob(ws, InternBlobName(blob_name), t);
 }
 
 CAFFE2_API std::map<string, string> GetRecurrentMapping(
@@ -183,7 +188,8 @@ class RecurrentNetworkOp final : public Operator<Context> {
             false)),
         timestep_(this->template GetSingleArgument<std::string>(
             "timestep",
-            "timestep")) {
+            "timestep")),
+        timestepBlobId_(InternBlobName(timestep_)) {
     CAFFE_ENFORCE(ws);
 
     stepNetDef_ = detail::extractNetDef(operator_def, "step_net");
@@ -342,6 +348,12 @@ class RecurrentNetworkOp final : public Operator<Context> {
       stepWorkspaces.resize(num_workspaces_on_fwd_only);
     }
 
+    if (!rnnExecutor_ && !sharedStepNetDef_) {
+      // every step workspace instantiates the same step net, so share one
+      // copy of its definition between them
+      sharedStepNetDef_ = std::make_shared<const NetDef>(stepNetDef_);
+    }
+
     for (auto t = 0; t < seqLen; ++t) {
       auto& currentStepWorkspace =
           (has_backward_pass ? stepWorkspaces[t] :
@@ -359,10 +371,11 @@ class RecurrentNetworkOp final : public Operator<Context> {
             t, currentStepWorkspace.get(), this->observers_list_);
       } else {
         // Use plain Caffe2 nets
-        detail::UpdateTimestepBlob(currentStepWorkspace.get(), timestep_, t);
+        detail::UpdateTimestepBlob(
+            currentStepWorkspace.get(), timestepBlobId_, t);
         auto* stepNet = currentStepWorkspace->GetNet(stepNetDef_.name());
         if (stepNet == nullptr) {
-          stepNet = currentStepWorkspace->CreateNet(stepNetDef_);
+          stepNet = currentStepWorkspace->CreateNet(sharedStepNetDef_);
         }
         CAFFE_ENFORCE(stepNet, "Step Net construction failure");
         // Since we have a SimpleNet, there are no races here.
@@ -395,6 +408,8 @@ class RecurrentNetworkOp final : public Operator<Context> {
   std::vector<detail::OffsetAlias> aliases_;
   std::vector<detail::RecurrentInput> recurrentInputs_;
   std::string timestep_;
+  BlobId timestepBlobId_;
+  std::shared_ptr<const NetDef> sharedStepNetDef_;
 };
 
 template <class Context>
@@ -746,6 +761,9 @@ class RecurrentNetworkGradientOp final : public Operator<Context> {
     if (stepWorkspaces.size() > 0) {
       CreateSharedBlobs(stepWorkspaces[0], &sharedBlobsWs);
     }
+    if (!rnnExecutor_ && !sharedStepNetDef_) {
+      sharedStepNetDef_ = std::make_shared<const NetDef>(stepNetDef_);
+    }
     for (int32_t t = seqLen - 1; t >= 0; --t) {
       if (rnnExecutor_) {
         rnnExecutor_->EnsureTimestepInitialized(
@@ -753,7 +771,7 @@ class RecurrentNetworkGradientOp final : public Operator<Context> {
       } else {
         auto* stepNet = stepWorkspaces[t].get()->GetNet(stepNetDef_.name());
         if (stepNet == nullptr) {
-          stepNet = stepWorkspaces[t].get()->CreateNet(stepNetDef_);
+          stepNet = stepWorkspaces[t].get()->CreateNet(sharedStepNetDef_);
         }
         CAFFE_ENFORCE(stepNet);
         stepNet->RunAsync();
@@ -825,6 +843,7 @@ class RecurrentNetworkGradientOp final : public Operator<Context> {
   std::vector<detail::Param> params_;
   std::vector<detail::RecurrentGradient> recurrentGradients_;
   std::string timestep_;
+  std::shared_ptr<const NetDef> sharedStepNetDef_;
   // For now we support only one input sequence
   const int numSequences_{1};
   std::vector<int32_t> recurrentInputIds_;
@@ -40,44 +40,178 @@ void inclusive_scan_wrapper(
       context_->cuda_stream());
 }
 
-template <typename T, bool ExactBlock = false, bool Average = false>
-__global__ void length_sum_kernel(
+// The sum (or mean) reductions over segments are load balanced over rows
+// rather than launched with one block per segment: block b reduces the rows
+// [b * rows_per_block, (b + 1) * rows_per_block) of the input, whichever
+// segments they belong to. With skewed lengths one block per segment leaves
+// most of the GPU idle while a few blocks walk through the longest segments,
+// and wastes a whole block on each of the many tiny ones.
+//
+// A block writes the segments that lie within its rows straight to the
+// output. A segment that crosses the boundary of a block leaves a partial
+// sum in one of the two carry slots of the block: the head slot if the
+// segment started in an earlier block, the tail slot if it starts in this
+// one and ends in a later one. length_sum_carry_kernel then adds the partial
+// sums of those segments, in block order so that the result doesn't depend
+// on scheduling, and fills in the empty segments.
+template <typename T, typename IndexType, bool Sparse, bool Average>
+__global__ void length_sum_balanced_kernel(
     const T* __restrict__ in,
     T* __restrict__ out,
+    T* __restrict__ carry,
     const int* __restrict__ prefix_sum_length_data,
-    int N,
+    const IndexType* __restrict__ indices,
     int post,
-    int len_length) {
-  // len_length blocks
-  int group = blockIdx.x;
+    int len_length,
+    int num_rows,
+    int rows_per_block) {
+  const int lo = blockIdx.x * rows_per_block;
+  const int hi = min(lo + rows_per_block, num_rows);
+
+  // The first segment that ends after lo.
+  int first = 0;
+  int last = len_length;
+  while (first < last) {
+    const int mid = (first + last) / 2;
+    if (prefix_sum_length_data[mid] <= lo) {
+      first = mid + 1;
+    } else {
+      last = mid;
+    }
+  }
 
-  int start = group == 0 ? 0 : prefix_sum_length_data[group - 1];
-  int end = prefix_sum_length_data[group];
-  CUDA_KERNEL_ASSERT(start <= N);
-  CUDA_KERNEL_ASSERT(end <= N);
+  extern __shared__ T reduceVals[];
 
-  if (ExactBlock) {
-    in += threadIdx.x;
+  for (int col = 0; col < post; col += blockDim.x) {
+    const int i = col + threadIdx.x;
+    for (int group = first; group < len_length; ++group) {
+      const int start = group == 0 ? 0 : prefix_sum_length_data[group - 1];
+      if (start >= hi) {
+        break;
+      }
+      const int end = prefix_sum_length_data[group];
+      if (start == end) {
+        continue;
+      }
 
-    T sum = (T)0;
-    for (int line = start; line < end; ++line) {
-      sum += in[line * post];
-    }
-    if (Average && (end - start) > 1) {
-      sum /= (end - start);
-    }
-    out[group * post + threadIdx.x] = sum;
-  } else {
-    for (int i = threadIdx.x; i < post; i += blockDim.x) {
       T sum = (T)0;
-      for (int line = start; line < end; ++line) {
-        sum += in[line * post + i];
+      if (i < post) {
+        const int row_end = min(end, hi);
+        for (int line = max(start, lo) + threadIdx.y; line < row_end;
+             line += blockDim.y) {
+          sum += in[(Sparse ? indices[line] : line) * post + i];
+        }
       }
-      if (Average && (end - start) > 1) {
-        sum /= (end - start);
+      reduceVals[threadIdx.y * blockDim.x + threadIdx.x] = sum;
+      __syncthreads();
+
+      if (threadIdx.y == 0 && i < post) {
+        for (int y = 1; y < blockDim.y; ++y) {
+          sum += reduceVals[y * blockDim.x + threadIdx.x];
+        }
+        if (start >= lo && end <= hi) {
+          if (Average && (end - start) > 1) {
+            sum /= (end - start);
+          }
+          out[group * post + i] = sum;
+        } else {
+          carry[(2 * blockIdx.x + (start < lo ? 0 : 1)) * post + i] = sum;
+        }
       }
-      out[group * post + i] = sum;
+      __syncthreads();
+    }
+  }
+}
+
+template <typename T, bool Average>
+__global__ void length_sum_carry_kernel(
+    const T* __restrict__ carry,
+    T* __restrict__ out,
+    const int* __restrict__ prefix_sum_length_data,
+    int post,
+    int len_length,
+    int num_rows,
+    int rows_per_block) {
+  CUDA_1D_KERNEL_LOOP(j, len_length * post) {
+    const int group = j / post;
+    const int i = j % post;
+    const int start = group == 0 ? 0 : prefix_sum_length_data[group - 1];
+    const int end = prefix_sum_length_data[group];
+    CUDA_KERNEL_ASSERT(end <= num_rows);
+    if (start == end) {
+      out[j] = (T)0;
+      continue;
+    }
+    const int first_block = start / rows_per_block;
+    const int last_block = (end - 1) / rows_per_block;
+    if (first_block == last_block) {
+      // Written by length_sum_balanced_kernel.
+      continue;
+    }
+    T sum = carry[(2 * first_block + 1) * post + i];
+    for (int b = first_block + 1; b <= last_block; ++b) {
+      sum += carry[2 * b * post + i];
     }
+    if (Average && (end - start) > 1) {
+      sum /= (end - start);
+    }
+    out[j] = sum;
+  }
+}
+
+// Sums (Average = false) or averages the rows of `in` over the segments whose
+// inclusive prefix sum of lengths is `prefix_sum_length_data`. The rows are
+// those of `in` or, if Sparse, those picked by `indices`.
+template <typename T, typename IndexType, bool Sparse, bool Average>
+void length_sum_balanced(
+    const T* in,
+    T* out,
+    const int* prefix_sum_length_data,
+    const IndexType* indices,
+    int post,
+    int len_length,
+    int num_rows,
+    Tensor* carry_buffer,
+    CUDAContext* context) {
+  // Threads are laid out over the columns, then over the rows of a block, and
+  // a block takes enough rows for a few thousand additions.
+  const int block_x = std::min(post, CAFFE_CUDA_NUM_THREADS * 2);
+  const int block_y = std::max(1, CAFFE_CUDA_NUM_THREADS * 2 / block_x);
+  const int rows_per_block = std::max(block_y, 4096 / std::max(post, 1));
+
+  T* carry = nullptr;
+  if (num_rows > 0 && post > 0) {
+    const int num_blocks = math::divUp(num_rows, rows_per_block);
+    carry_buffer->Resize(2 * num_blocks * post);
+    carry = carry_buffer->template mutable_data<T>();
+    length_sum_balanced_kernel<T, IndexType, Sparse, Average>
+        <<<num_blocks,
+           dim3(block_x, block_y),
+           sizeof(T) * block_x * block_y,
+           context->cuda_stream()>>>(
+            in,
+            out,
+            carry,
+            prefix_sum_length_data,
+            indices,
+            post,
+            len_length,
+            num_rows,
+            rows_per_block);
+  }
+  if (len_length * post > 0) {
+    length_sum_carry_kernel<T, Average>
+        <<<CAFFE_GET_BLOCKS(len_length * post),
+           CAFFE_CUDA_NUM_THREADS,
+           0,
+           context->cuda_stream()>>>(
+            carry,
+            out,
+            prefix_sum_length_data,
+            post,
+            len_length,
+            num_rows,
+            rows_per_block);
   }
 }
 
@@ -236,66 +370,6 @@ __global__ void length_weighted_sum_with_main_input_gradient_kernel(
   }
 }
 
-template <
-    typename T,
-    typename IndexType,
-    bool ExactBlock = false,
-    bool Average = false>
-__global__ void sparse_length_sum_kernel(
-    const T* __restrict__ in,
-    T* __restrict__ out,
-    const int* __restrict__ prefix_sum_length_data,
-    const IndexType* __restrict__ indices,
-    int N,
-    int post,
-    int len_length,
-    int len_indices) {
-  // len_length blocks
-  int group = blockIdx.x;
-
-  int start = group == 0 ? 0 : prefix_sum_length_data[group - 1];
-  int end = prefix_sum_length_data[group];
-  CUDA_KERNEL_ASSERT(start <= len_indices);
-  CUDA_KERNEL_ASSERT(end <= len_indices);
-
-  extern __shared__ T reduceVals[];
-
-  if (ExactBlock) {
-    T sum = (T)0;
-
-    in += threadIdx.x;
-    for (int line = start + threadIdx.y; line < end; line += blockDim.y) {
-      sum += in[indices[line] * post];
-    }
-
-    reduceVals[threadIdx.y * blockDim.x + threadIdx.x] = sum;
-    __syncthreads();
-
-    if (threadIdx.y == 0) {
-      sum = (T)0;
-      for (int i = 0; i < blockDim.y; ++i) {
-        sum += reduceVals[i * blockDim.x + threadIdx.x];
-      }
-      if (Average && (end - start) > 1) {
-        sum /= (end - start);
-      }
-
-      out[group * post + threadIdx.x] = sum;
-    }
-  } else {
-    for (int i = threadIdx.x; i < post; i += blockDim.x) {
-      T sum = (T)0;
-      for (int line = start; line < end; ++line) {
-        sum += in[indices[line] * post + i];
-      }
-      if (Average && (end - start) > 1) {
-        sum /= (end - start);
-      }
-      out[group * post + i] = sum;
-    }
-  }
-}
-
 template <typename T, typename IndexType, bool ExactBlock = false>
 __global__ void sparse_length_max_kernel(
     const T* __restrict__ in,
@@ -449,7 +523,7 @@ class CUDASparseLengthsSumOp : public Operator<CUDAContext> {
       return true;
     }
 
-    const IndexType* indices;
+    const IndexType* indices = nullptr;
     if (SparseFused) { // static if
       auto& indicesInput = Input(INDICES);
       CAFFE_ENFORCE_EQ(1, indicesInput.ndim(), "INDICES must be a vector");
@@ -471,52 +545,18 @@ class CUDASparseLengthsSumOp : public Operator<CUDAContext> {
     const T* in_data = dataInput.template data<T>();
     auto* prefix_sum_length_data =
         inclusive_scan_length_buffer_.template data<int>();
-    int N = dataSize;
     int post = dataInput.size_from_dim(1);
 
-    auto maxThreads =
-        GetDeviceProperty(CaffeCudaGetDevice()).maxThreadsPerBlock;
-    if (SparseFused) {
-      if (post <= maxThreads) {
-        int multiple = std::min(maxThreads / post, 16);
-        dim3 block(post, multiple);
-        size_t smem = sizeof(T) * post * multiple;
-
-        // calling cuda kernel with ExactBlock = true, Average = false
-        sparse_length_sum_kernel<T, IndexType, true, false>
-            <<<len_length, block, smem, context_.cuda_stream()>>>(
-                in_data,
-                out_data,
-                prefix_sum_length_data,
-                indices,
-                N,
-                post,
-                len_length,
-                dataToReduceSize);
-      } else {
-        // calling cuda kernel with ExactBlock = false, Average = false
-        sparse_length_sum_kernel<T, IndexType, false, false>
-            <<<len_length, maxThreads, 0, context_.cuda_stream()>>>(
-                in_data,
-                out_data,
-                prefix_sum_length_data,
-                indices,
-                N,
-                post,
-                len_length,
-                dataToReduceSize);
-      }
-    } else {
-      if (post <= maxThreads) {
-        length_sum_kernel<T, true, false>
-            <<<len_length, post, 0, context_.cuda_stream()>>>(
-                in_data, out_data, prefix_sum_length_data, N, post, len_length);
-      } else {
-        length_sum_kernel<T, true, false>
-            <<<len_length, maxThreads, 0, context_.cuda_stream()>>>(
-                in_data, out_data, prefix_sum_length_data, N, post, len_length);
-      }
-    }
+    length_sum_balanced<T, IndexType, SparseFused, false>(
+        in_data,
+        out_data,
+        prefix_sum_length_data,
+        indices,
+        post,
+        len_length,
+        dataToReduceSize,
+        &carry_buffer_,
+        &context_);
     return true;
   }
 
@@ -526,6 +566,7 @@ class CUDASparseLengthsSumOp : public Operator<CUDAContext> {
   // menber field to manage memory
   Tensor inclusive_scan_buffer_{CUDA};
   Tensor inclusive_scan_length_buffer_{CUDA};
+  Tensor carry_buffer_{CUDA};
 };
 
 template <typename T, class Context = CUDAContext, bool SparseFused = true>
@@ -570,7 +611,7 @@ class CUDASparseLengthsMeanOp : public Operator<CUDAContext> {
       return true;
     }
 
-    const IndexType* indices;
+    const IndexType* indices = nullptr;
     if (SparseFused) { // static if
       auto& indicesInput = Input(INDICES);
       CAFFE_ENFORCE_EQ(1, indicesInput.ndim(), "INDICES must be a vector");
@@ -592,53 +633,18 @@ class CUDASparseLengthsMeanOp : public Operator<CUDAContext> {
     const T* in_data = dataInput.template data<T>();
     auto* prefix_sum_length_data =
         inclusive_scan_length_buffer_.template data<int>();
-    int N = dataSize;
     int post = dataInput.size_from_dim(1);
 
-    auto maxThreads =
-        GetDeviceProperty(CaffeCudaGetDevice()).maxThreadsPerBlock;
-    if (SparseFused) {
-      if (post <= maxThreads) {
-        int multiple = std::min(maxThreads / post, 16);
-        dim3 block(post, multiple);
-        size_t smem = sizeof(T) * post * multiple;
-        // calling cuda kernel with ExactBlock = true, Average = true
-        sparse_length_sum_kernel<T, IndexType, true, true>
-            <<<len_length, block, smem, context_.cuda_stream()>>>(
-                in_data,
-                out_data,
-                prefix_sum_length_data,
-                indices,
-                N,
-                post,
-                len_length,
-                dataToReduceSize);
-      } else {
-        // calling cuda kernel with ExactBlock = false, Average = true
-        sparse_length_sum_kernel<T, IndexType, false, true>
-            <<<len_length, maxThreads, 0, context_.cuda_stream()>>>(
-                in_data,
-                out_data,
-                prefix_sum_length_data,
-                indices,
-                N,
-                post,
-                len_length,
-                dataToReduceSize);
-      }
-    } else {
-      if (post <= maxThreads) {
-        // calling cuda kernel with ExactBlock = true, Average = true
-        length_sum_kernel<T, true, true>
-            <<<len_length, post, 0, context_.cuda_stream()>>>(
-                in_data, out_data, prefix_sum_length_data, N, post, len_length);
-      } else {
-        // calling cuda kernel with ExactBlock = true, Average = true
-        length_sum_kernel<T, true, true>
-            <<<len_length, maxThreads, 0, context_.cuda_stream()>>>(
-                in_data, out_data, prefix_sum_length_data, N, post, len_length);
-      }
-    }
+    length_sum_balanced<T, IndexType, SparseFused, true>(
+        in_data,
+        out_data,
+        prefix_sum_length_data,
+        indices,
+        post,
+        len_length,
+        dataToReduceSize,
+        &carry_buffer_,
+        &context_);
     return true;
   }
 
@@ -648,6 +654,7 @@ class CUDASparseLengthsMeanOp : public Operator<CUDAContext> {
   // menber field to manage memory
   Tensor inclusive_scan_buffer_{CUDA};
   Tensor inclusive_scan_length_buffer_{CUDA};
+  Tensor carry_buffer_{CUDA};
 };
 
 template <typename T, class Context = CUDAContext, bool SparseFused = true>
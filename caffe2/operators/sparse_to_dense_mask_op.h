@@ -2,11 +2,11 @@
 #define CAFFE2_OPERATORS_SPARSE_TO_DENSE_MASK_OP_H_
 
 #include <algorithm>
-#include <unordered_map>
 #include <vector>
 #include "caffe2/core/context.h"
 #include "caffe2/core/operator.h"
 #include "caffe2/core/tensor.h"
+#include "caffe2/utils/flat_hash_map/flat_hash_map.h"
 #include "caffe2/utils/math.h"
 
 namespace caffe2 {
@@ -24,6 +24,9 @@ class SparseToDenseMaskBase : public Operator<Context> {
     CAFFE_ENFORCE(!mask.empty(), "mask can't be empty");
     auto biggest = *std::max_element(mask.begin(), mask.end());
     dense_.assign(std::min(kMaxDenseSize, biggest + 1), -1);
+    sparse_.reserve(std::count_if(mask.begin(), mask.end(), [this](int64_t id) {
+      return id >= kMaxDenseSize;
+    }));
     for (int i = 0; i < mask.size(); i++) {
       int64_t id = mask[i];
       CAFFE_ENFORCE_GE(id, 0, "Only positive IDs are allowed.");
@@ -40,7 +43,7 @@ class SparseToDenseMaskBase : public Operator<Context> {
  protected:
   const int64_t kMaxDenseSize = 1024 * 128;
 
-  std::unordered_map<int64_t, int> sparse_;
+  ska::flat_hash_map<int64_t, int> sparse_;
   std::vector<int> dense_;
   int featuresCount_;
 
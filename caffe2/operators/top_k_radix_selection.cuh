@@ -343,25 +343,16 @@ __device__ void radixSelect(const DataType* data,
   *topK = TopKTypeConfig<DataType>::deconvert(desired);
 }
 
+// Writes the top `outputSliceSize` values of one slice and their indices in
+// the slice, unsorted, with the whole block. `smem` must hold one int per
+// warp.
 template <typename T, bool Order, typename IndicesType>
-__global__ void gatherTopK(const T* inputPtr,
-                           int inputSliceSize,
-                           int outputSliceSize, // aka `k`
-                           int numInputSlices,
-                           T* topKPtr,
-                           IndicesType* indicesPtr) {
-  __shared__ int smem[32]; // one per each warp, up to warp limit
-
-  int slice = blockIdx.x;
-  if (slice >= numInputSlices) {
-    return;
-  }
-
-  // Find the start offset for our slice
-  const T* inputSliceStart = &inputPtr[slice * inputSliceSize];
-  T* topKSliceStart = &topKPtr[slice * outputSliceSize];
-  IndicesType* indicesSliceStart = &indicesPtr[slice * outputSliceSize];
-
+__device__ void gatherTopKSlice(const T* inputSliceStart,
+                                int inputSliceSize,
+                                int outputSliceSize, // aka `k`
+                                T* topKSliceStart,
+                                IndicesType* indicesSliceStart,
+                                int* smem) {
   // Find the k-th highest element in our input
   T topKValue = (T)0;
   radixSelect<T, typename TopKTypeConfig<T>::RadixType, Order>(
@@ -451,6 +442,29 @@ __global__ void gatherTopK(const T* inputPtr,
   }
 }
 
+template <typename T, bool Order, typename IndicesType>
+__global__ void gatherTopK(const T* inputPtr,
+                           int inputSliceSize,
+                           int outputSliceSize, // aka `k`
+                           int numInputSlices,
+                           T* topKPtr,
+                           IndicesType* indicesPtr) {
+  __shared__ int smem[32]; // one per each warp, up to warp limit
+
+  int slice = blockIdx.x;
+  if (slice >= numInputSlices) {
+    return;
+  }
+
+  gatherTopKSlice<T, Order, IndicesType>(
+      &inputPtr[slice * inputSliceSize],
+      inputSliceSize,
+      outputSliceSize,
+      &topKPtr[slice * outputSliceSize],
+      &indicesPtr[slice * outputSliceSize],
+      smem);
+}
+
 #undef RADIX_BITS
 #undef RADIX_SIZE
 #undef RADIX_MASK
@@ -18,6 +18,8 @@
 
 #include <cmath>
 
+#include "caffe2/utils/flat_hash_map/flat_hash_map.h"
+
 namespace caffe2 {
 
 template <>
@@ -37,27 +39,38 @@ bool UniqueOp<CPUContext>::DoRunWithType() {
   }
 
   const T* input = inputTensor.template data<T>();
-  // TODO(dzhulgakov): if perf becomes an issue consider doing hash table
-  // instead of sorting
-  order_.resize(N);
+  // Deduplicates with an open addressing hash map, sized for N distinct ids
+  // so that it never rehashes, and then sorts only the K distinct ids.
+  ska::flat_hash_map<T, int> ids;
+  ids.reserve(N);
+  std::vector<T> values;
+  for (int i = 0; i < N; ++i) {
+    auto it = ids.emplace(input[i], values.size());
+    if (it.second) {
+      values.push_back(input[i]);
+    }
+    if (remapping) {
+      remapping[i] = it.first->second;
+    }
+  }
+  const int K = values.size();
+  order_.resize(K);
   std::iota(order_.begin(), order_.end(), 0);
-  std::sort(order_.begin(), order_.end(), [input](const int x, const int y) {
-    return input[x] < input[y];
+  std::sort(order_.begin(), order_.end(), [&values](const int x, const int y) {
+    return values[x] < values[y];
   });
-  int K = N;
-  for (int i = 1; i < N; ++i) {
-    K -= input[order_[i]] == input[order_[i - 1]];
-  }
   uniqueTensor->Resize(K);
   T* unique = uniqueTensor->template mutable_data<T>();
-  K = 0;
-  T prev = -1;
-  for (int i = 0; i < N; ++i) {
-    if (i == 0 || prev != input[order_[i]]) {
-      prev = unique[K++] = input[order_[i]];
+  for (int i = 0; i < K; ++i) {
+    unique[i] = values[order_[i]];
+  }
+  if (remapping) {
+    std::vector<int> rank(K);
+    for (int i = 0; i < K; ++i) {
+      rank[order_[i]] = i;
     }
-    if (remapping) {
-      remapping[order_[i]] = K - 1;
+    for (int i = 0; i < N; ++i) {
+      remapping[i] = rank[remapping[i]];
     }
   }
   return true;
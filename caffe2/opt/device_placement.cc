@@ -0,0 +1,401 @@
+#include "caffe2/opt/device_placement.h"
+
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "caffe2/core/operator.h"
+#include "caffe2/core/types.h"
+#include "caffe2/opt/converter.h"
+#include "caffe2/opt/passes.h"
+#include "caffe2/opt/shape_inference.h"
+
+namespace caffe2 {
+namespace opt {
+
+using namespace nom;
+
+namespace {
+
+using NodeRef = repr::NNGraph::NodeRef;
+
+constexpr double kInfinity = 1e30;
+constexpr double kEpsilon = 1e-9;
+
+// Dinic's maximum flow, from which a minimum s-t cut is read.
+class MinCut {
+ public:
+  int addNode() {
+    graph_.emplace_back();
+    return graph_.size() - 1;
+  }
+
+  void addEdge(int from, int to, double capacity) {
+    if (capacity <= 0) {
+      return;
+    }
+    graph_[from].push_back(edges_.size());
+    edges_.push_back({to, capacity});
+    graph_[to].push_back(edges_.size());
+    edges_.push_back({from, 0});
+  }
+
+  // Whether each node is on the side of s of a minimum cut.
+  std::vector<bool> solve(int s, int t) {
+    level_.resize(graph_.size());
+    next_.resize(graph_.size());
+    while (bfs(s, t)) {
+      std::fill(next_.begin(), next_.end(), 0);
+      while (dfs(s, t, kInfinity) > 0) {
+      }
+    }
+    // The last search reached exactly the nodes on the side of s.
+    std::vector<bool> sourceSide(graph_.size());
+    for (size_t i = 0; i < graph_.size(); ++i) {
+      sourceSide[i] = level_[i] >= 0;
+    }
+    return sourceSide;
+  }
+
+ private:
+  struct Edge {
+    int to;
+    double capacity;
+  };
+
+  bool bfs(int s, int t) {
+    std::fill(level_.begin(), level_.end(), -1);
+    level_[s] = 0;
+    std::queue<int> queue;
+    queue.push(s);
+    while (!queue.empty()) {
+      const int u = queue.front();
+      queue.pop();
+      for (int e : graph_[u]) {
+        const auto& edge = edges_[e];
+        if (edge.capacity > kEpsilon && level_[edge.to] < 0) {
+          level_[edge.to] = level_[u] + 1;
+          queue.push(edge.to);
+        }
+      }
+    }
+    return level_[t] >= 0;
+  }
+
+  double dfs(int u, int t, double flow) {
+    if (u == t) {
+      return flow;
+    }
+    for (size_t& i = next_[u]; i < graph_[u].size(); ++i) {
+      auto& edge = edges_[graph_[u][i]];
+      if (edge.capacity > kEpsilon && level_[edge.to] == level_[u] + 1) {
+        const double pushed = dfs(edge.to, t, std::min(flow, edge.capacity));
+        if (pushed > 0) {
+          edge.capacity -= pushed;
+          edges_[graph_[u][i] ^ 1].capacity += pushed;
+          return pushed;
+        }
+      }
+    }
+    return 0;
+  }
+
+  std::vector<std::vector<int>> graph_;
+  std::vector<Edge> edges_;
+  std::vector<int> level_;
+  std::vector<size_t> next_;
+};
+
+OperatorDef* getMutableOpDef(NodeRef node) {
+  if (!repr::nn::is<repr::NeuralNetOperator>(node)) {
+    return nullptr;
+  }
+  auto* annotation =
+      repr::nn::get<repr::NeuralNetOperator>(node)->getMutableAnnotation();
+  if (!annotation || !isa<Caffe2Annotation>(annotation)) {
+    return nullptr;
+  }
+  return dyn_cast<Caffe2Annotation>(annotation)->getMutableOperatorDef();
+}
+
+int getDeviceType(NodeRef op) {
+  auto* annotation =
+      repr::nn::get<repr::NeuralNetOperator>(op)->getMutableAnnotation();
+  return annotation && isa<Caffe2Annotation>(annotation)
+      ? dyn_cast<Caffe2Annotation>(annotation)->getDeviceType()
+      : CPU;
+}
+
+void setDevice(NodeRef op, int deviceType, int gpuId) {
+  auto* annotation = dyn_cast<Caffe2Annotation>(
+      repr::nn::get<repr::NeuralNetOperator>(op)->getMutableAnnotation());
+  annotation->setDeviceType(deviceType);
+  auto* deviceOption = annotation->getMutableOperatorDef()
+                           ->mutable_device_option();
+  deviceOption->set_device_type(deviceType);
+  if (deviceType == CUDA) {
+    deviceOption->set_cuda_gpu_id(gpuId);
+  } else {
+    deviceOption->clear_cuda_gpu_id();
+  }
+}
+
+const std::string& getName(NodeRef tensor) {
+  return repr::nn::get<repr::NeuralNetData>(tensor)->getName();
+}
+
+bool isCopy(const std::string& type) {
+  return type == "CopyCPUToGPU" || type == "CopyGPUToCPU" ||
+      type == "CopyFromCPUInput" || type == "EnsureCPUOutput";
+}
+
+uint64_t getBytes(const TensorShape& shape) {
+  if (shape.unknown_shape()) {
+    return 0;
+  }
+  uint64_t size = DataTypeToTypeMeta(shape.data_type()).itemsize();
+  for (auto d : shape.dims()) {
+    size *= d;
+  }
+  return size;
+}
+
+// The device of the value of `tensor` before the pass inserts copies: that
+// of its producer, or of its blob in `ws` for an external input.
+int getProducerDevice(NodeRef tensor, Workspace* ws) {
+  if (repr::nn::hasProducer(tensor)) {
+    const int deviceType = getDeviceType(repr::nn::getProducer(tensor));
+    return deviceType == CUDA ? CUDA : CPU;
+  }
+  const auto* blob = ws->GetBlob(getName(tensor));
+  return blob && blob->IsType<Tensor>(CUDA) ? CUDA : CPU;
+}
+
+NodeRef createCopy(repr::NNModule* nn, int from, int gpuId) {
+  OperatorDef def;
+  def.set_type(from == CPU ? "CopyCPUToGPU" : "CopyGPUToCPU");
+  def.mutable_device_option()->set_device_type(CUDA);
+  def.mutable_device_option()->set_cuda_gpu_id(gpuId);
+  auto node = nn->dataFlow.createNode();
+  node->resetData(convertToNeuralNetOperator(def));
+  return node;
+}
+
+NodeRef createTensor(repr::NNModule* nn, const std::string& name) {
+  return nn->dataFlow.createNode(util::make_unique<repr::Tensor>(name));
+}
+
+std::string deviceSuffix(int deviceType) {
+  return deviceType == CUDA ? "_gpu" : "_cpu";
+}
+
+// Makes the readers of `tensor` on the other device than its producer read
+// a copy, and moves an external output to the device it is expected on.
+void insertCopies(
+    repr::NNModule* nn,
+    Workspace* ws,
+    NodeRef tensor,
+    const DevicePlacementOptions& options) {
+  const int producerDevice = getProducerDevice(tensor, ws);
+  const int home = nn->outputs.count(tensor) && repr::nn::hasProducer(tensor)
+      ? options.external_output_device
+      : producerDevice;
+  const auto outEdges = tensor->getOutEdges();
+
+  // The value of the tensor on the device of its producer.
+  NodeRef local = tensor;
+  if (home != producerDevice) {
+    local = createTensor(nn, getName(tensor) + deviceSuffix(producerDevice));
+    auto edge = tensor->getInEdges().front();
+    tensor->removeInEdge(edge);
+    edge->setHead(local);
+    local->addInEdge(edge);
+    auto copy = createCopy(nn, producerDevice, options.gpu_id);
+    nn->dataFlow.createEdge(local, copy);
+    nn->dataFlow.createEdge(copy, tensor);
+  }
+
+  // The value of the tensor on the other device.
+  NodeRef remote = home != producerDevice ? tensor : nullptr;
+  for (auto edge : outEdges) {
+    const int deviceType =
+        getDeviceType(edge->head()) == CUDA ? CUDA : CPU;
+    NodeRef input = local;
+    if (deviceType != producerDevice) {
+      if (!remote) {
+        remote = createTensor(nn, getName(tensor) + deviceSuffix(deviceType));
+        auto copy = createCopy(nn, producerDevice, options.gpu_id);
+        nn->dataFlow.createEdge(local, copy);
+        nn->dataFlow.createEdge(copy, remote);
+      }
+      input = remote;
+    }
+    if (input != tensor) {
+      // The reader keeps the position of the input among its inputs.
+      tensor->removeOutEdge(edge);
+      edge->setTail(input);
+      input->addOutEdge(edge);
+    }
+  }
+}
+
+} // namespace
+
+void placeDevices(
+    repr::NNModule* nn,
+    Workspace* ws,
+    const DevicePlacementOptions& options) {
+  CAFFE_ENFORCE(ws, "Device placement needs the workspace of the net");
+  auto isSupported = options.is_supported;
+  if (!isSupported) {
+    isSupported = [](const OperatorDef& op, int deviceType) {
+      auto* registries = gDeviceTypeRegistry();
+      return registries->count(deviceType) &&
+          registries->at(deviceType)->Has(op.type());
+    };
+  }
+
+  std::vector<NodeRef> ops;
+  std::vector<NodeRef> tensors;
+  std::unordered_set<NodeRef> seen;
+  for (auto bbNode : nn->controlFlow.getMutableNodes()) {
+    auto bb = bbNode->mutableData()->get();
+    for (auto instr : bb->getInstructions()) {
+      NOM_REQUIRE_OR_CONT(getMutableOpDef(instr));
+      ops.push_back(instr);
+      for (auto tensor : repr::nn::getInputs(instr)) {
+        if (seen.insert(tensor).second) {
+          tensors.push_back(tensor);
+        }
+      }
+      for (auto tensor : repr::nn::getOutputs(instr)) {
+        if (seen.insert(tensor).second) {
+          tensors.push_back(tensor);
+        }
+      }
+    }
+  }
+
+  ShapeInference shapes(ws);
+
+  MinCut cut;
+  const int s = cut.addNode(); // CPU
+  const int t = cut.addNode(); // GPU
+  std::unordered_map<NodeRef, int> index;
+  for (auto op : ops) {
+    const auto& def = *getMutableOpDef(op);
+    const auto inputs = repr::nn::getInputs(op);
+    const auto outputs = repr::nn::getOutputs(op);
+    std::vector<TensorShape> inputShapes;
+    bool known = true;
+    for (auto input : inputs) {
+      inputShapes.push_back(shapes.getShape(input));
+      known = known && !inputShapes.back().unknown_shape();
+    }
+
+    const auto* schema = OpSchemaRegistry::Schema(def.type());
+    OpSchema::Cost cost;
+    bool costKnown = false;
+    if (schema && known && schema->HasCostInferenceFunction()) {
+      try {
+        cost = schema->InferCost(def, inputShapes);
+        costKnown = true;
+      } catch (const ::caffe2::EnforceNotMet&) {
+      }
+    }
+    if (!costKnown) {
+      for (auto input : inputs) {
+        cost.bytes_read += getBytes(shapes.getShape(input));
+      }
+      for (auto output : outputs) {
+        cost.bytes_written += getBytes(shapes.getShape(output));
+      }
+    }
+    const double bytes = cost.bytes_read + cost.bytes_written;
+    const double cpuTime = options.cpu_op_overhead_us +
+        cost.flops / options.cpu_flops_per_us +
+        bytes / options.cpu_bytes_per_us;
+    const double gpuTime = options.gpu_op_overhead_us +
+        cost.flops / options.gpu_flops_per_us +
+        bytes / options.gpu_bytes_per_us;
+
+    // Copies and ops on other devices stay where they are, and the latter
+    // are treated as CPU ops.
+    const int deviceType = getDeviceType(op);
+    bool onCPU = isSupported(def, CPU);
+    bool onGPU = isSupported(def, CUDA);
+    if (isCopy(def.type()) || (deviceType != CPU && deviceType != CUDA) ||
+        (!onCPU && !onGPU)) {
+      onCPU = deviceType != CUDA;
+      onGPU = deviceType == CUDA;
+    }
+
+    // Ops on the side of s run on the CPU, the cut edge gives the cost.
+    const int node = cut.addNode();
+    index[op] = node;
+    cut.addEdge(s, node, onGPU ? gpuTime : kInfinity);
+    cut.addEdge(node, t, onCPU ? cpuTime : kInfinity);
+  }
+
+  // A blob is copied once to each device it is read on other than the one
+  // it is produced on. An auxiliary node per direction makes the transfer
+  // cost paid once, however many readers there are.
+  for (auto tensor : tensors) {
+    int producer = getProducerDevice(tensor, ws) == CUDA ? t : s;
+    if (repr::nn::hasProducer(tensor)) {
+      auto it = index.find(repr::nn::getProducer(tensor));
+      if (it != index.end()) {
+        producer = it->second;
+      }
+    }
+    std::vector<int> readers;
+    for (auto consumer : repr::nn::getConsumers(tensor)) {
+      auto it = index.find(consumer);
+      if (it != index.end()) {
+        readers.push_back(it->second);
+      }
+    }
+    if (nn->outputs.count(tensor)) {
+      readers.push_back(options.external_output_device == CUDA ? t : s);
+    }
+    const double transfer = options.transfer_latency_us +
+        getBytes(shapes.getShape(tensor)) / options.transfer_bytes_per_us;
+    if (producer != t) {
+      // Paid if the producer runs on the CPU and a reader on the GPU.
+      const int toGPU = cut.addNode();
+      cut.addEdge(producer, toGPU, transfer);
+      for (int reader : readers) {
+        if (reader != s) {
+          cut.addEdge(toGPU, reader, kInfinity);
+        }
+      }
+    }
+    if (producer != s) {
+      // Paid if the producer runs on the GPU and a reader on the CPU.
+      const int toCPU = cut.addNode();
+      cut.addEdge(toCPU, producer, transfer);
+      for (int reader : readers) {
+        if (reader != t) {
+          cut.addEdge(reader, toCPU, kInfinity);
+        }
+      }
+    }
+  }
+
+  const auto onCPU = cut.solve(s, t);
+  for (auto op : ops) {
+    const int deviceType = getDeviceType(op);
+    if (deviceType == CPU || deviceType == CUDA) {
+      setDevice(op, onCPU[index[op]] ? CPU : CUDA, options.gpu_id);
+    }
+  }
+  for (auto tensor : tensors) {
+    insertCopies(nn, ws, tensor, options);
+  }
+}
+
+REGISTER_WS_OPT_PASS_FROM_FUNC(DevicePlacement, placeDevices);
+
+} // namespace opt
+} // namespace caffe2
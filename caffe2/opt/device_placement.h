@@ -0,0 +1,50 @@
+#ifndef CAFFE2_OPT_DEVICE_PLACEMENT_H_
+#define CAFFE2_OPT_DEVICE_PLACEMENT_H_
+
+#include <functional>
+
+#include "caffe2/core/workspace.h"
+#include "nomnigraph/Representations/NeuralNet.h"
+
+namespace caffe2 {
+namespace opt {
+
+// The cost model of the placement pass. The time of an operator on a device
+// is its overhead plus its flops and bytes, as given by the cost inference
+// function of its schema, at the throughput of the device. Copying a blob
+// between the devices takes the transfer latency plus its size at the
+// transfer bandwidth. Throughputs are per microsecond.
+struct CAFFE2_API DevicePlacementOptions {
+  double cpu_flops_per_us = 5e4;
+  double cpu_bytes_per_us = 2e4;
+  double cpu_op_overhead_us = 1;
+  double gpu_flops_per_us = 5e6;
+  double gpu_bytes_per_us = 3e5;
+  // Kernel launch and synchronization, which keeps small ops on the CPU.
+  double gpu_op_overhead_us = 10;
+  double transfer_bytes_per_us = 1e4;
+  double transfer_latency_us = 10;
+
+  int gpu_id = 0;
+  // Where the external outputs of the net are expected.
+  int external_output_device = CPU;
+  // Whether an operator can run on a device type. Defaults to checking the
+  // operator registry of the device.
+  std::function<bool(const OperatorDef&, int)> is_supported;
+};
+
+// Places each operator of `nn` on the CPU or the GPU so that the estimated
+// time of the net, including the copies between the devices, is minimal,
+// and inserts CopyCPUToGPU and CopyGPUToCPU operators where blobs cross
+// devices. The shapes of the external inputs are taken from `ws`, and so
+// is their device. The assignment is a minimum s-t cut, which is exact for
+// this cost model.
+CAFFE2_API void placeDevices(
+    nom::repr::NNModule* nn,
+    Workspace* ws,
+    const DevicePlacementOptions& options = DevicePlacementOptions());
+
+} // namespace opt
+} // namespace caffe2
+
+#endif // CAFFE2_OPT_DEVICE_PLACEMENT_H_
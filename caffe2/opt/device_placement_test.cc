@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include "caffe2/core/workspace.h"
+#include "caffe2/opt/converter.h"
+#include "caffe2/opt/device_placement.h"
+
+namespace caffe2 {
+namespace {
+
+void addInput(
+    Workspace* ws,
+    const std::string& name,
+    const std::vector<TIndex>& dims) {
+  auto* tensor = ws->CreateBlob(name)->GetMutableTensor(CPU);
+  tensor->Resize(dims);
+  tensor->mutable_data<float>();
+}
+
+void addOp(
+    NetDef* net,
+    const std::string& type,
+    const std::vector<std::string>& inputs,
+    const std::vector<std::string>& outputs) {
+  auto* op = net->add_op();
+  op->set_type(type);
+  for (const auto& input : inputs) {
+    op->add_input(input);
+  }
+  for (const auto& output : outputs) {
+    op->add_output(output);
+  }
+}
+
+int count(const NetDef& net, const std::string& type) {
+  int n = 0;
+  for (const auto& op : net.op()) {
+    n += op.type() == type;
+  }
+  return n;
+}
+
+} // namespace
+
+// The FCs are much cheaper on the GPU, even with the copies, and share the
+// copies of their inputs. The tiny Relu is not worth the transfers.
+TEST(DevicePlacementTest, PlacesByCost) {
+  Workspace ws;
+  addInput(&ws, "X", {512, 1024});
+  addInput(&ws, "W", {1024, 1024});
+  addInput(&ws, "b", {1024});
+  addInput(&ws, "S", {4});
+  NetDef net;
+  addOp(&net, "FC", {"X", "W", "b"}, {"Y"});
+  addOp(&net, "FC", {"X", "W", "b"}, {"Z"});
+  addOp(&net, "Relu", {"S"}, {"T"});
+  for (const auto& name : {"X", "W", "b", "S"}) {
+    net.add_external_input(name);
+  }
+  for (const auto& name : {"Y", "Z", "T"}) {
+    net.add_external_output(name);
+  }
+
+  auto nn = convertToNNModule(net);
+  opt::DevicePlacementOptions options;
+  // Pretend every operator has a CUDA implementation.
+  options.is_supported = [](const OperatorDef&, int) { return true; };
+  opt::placeDevices(&nn, &ws, options);
+  const auto placed = convertToCaffe2Proto(nn, net);
+
+  EXPECT_EQ(count(placed, "CopyCPUToGPU"), 3);
+  EXPECT_EQ(count(placed, "CopyGPUToCPU"), 2);
+  for (const auto& op : placed.op()) {
+    if (op.type() == "FC") {
+      EXPECT_EQ(op.device_option().device_type(), CUDA);
+      EXPECT_EQ(op.input(0), "X_gpu");
+      EXPECT_EQ(op.output(0).substr(1), "_gpu");
+    } else if (op.type() == "Relu") {
+      EXPECT_EQ(op.device_option().device_type(), CPU);
+      EXPECT_EQ(op.input(0), "S");
+      EXPECT_EQ(op.output(0), "T");
+    }
+  }
+}
+
+// Without a GPU implementation, the FC stays on the CPU and nothing is
+// copied.
+TEST(DevicePlacementTest, RespectsSupport) {
+  Workspace ws;
+  addInput(&ws, "X", {512, 1024});
+  addInput(&ws, "W", {1024, 1024});
+  addInput(&ws, "b", {1024});
+  NetDef net;
+  addOp(&net, "FC", {"X", "W", "b"}, {"Y"});
+  net.add_external_output("Y");
+
+  auto nn = convertToNNModule(net);
+  opt::DevicePlacementOptions options;
+  options.is_supported = [](const OperatorDef&, int deviceType) {
+    return deviceType == CPU;
+  };
+  opt::placeDevices(&nn, &ws, options);
+  const auto placed = convertToCaffe2Proto(nn, net);
+
+  ASSERT_EQ(placed.op_size(), 1);
+  EXPECT_EQ(placed.op(0).device_option().device_type(), CPU);
+  EXPECT_EQ(placed.op(0).input(0), "X");
+}
+
+} // namespace caffe2
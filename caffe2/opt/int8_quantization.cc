@@ -0,0 +1,195 @@
+#include "caffe2/opt/int8_quantization.h"
+
+#include "caffe2/operators/quantized/int8_calibration.h"
+#include "caffe2/opt/converter.h"
+#include "caffe2/opt/passes.h"
+#include "caffe2/utils/proto_utils.h"
+
+namespace caffe2 {
+namespace opt {
+
+using namespace nom;
+
+namespace {
+
+const OperatorDef* getOpDef(repr::NNGraph::NodeRef node) {
+  if (!repr::nn::is<repr::NeuralNetOperator>(node)) {
+    return nullptr;
+  }
+  auto* annotation =
+      repr::nn::get<repr::NeuralNetOperator>(node)->getAnnotation();
+  if (!annotation || !isa<Caffe2Annotation>(annotation)) {
+    return nullptr;
+  }
+  return &dyn_cast<Caffe2Annotation>(annotation)->getOperatorDef();
+}
+
+const std::string& getName(repr::NNGraph::NodeRef node) {
+  return repr::nn::get<repr::NeuralNetData>(node)->getName();
+}
+
+const TensorCPU* getFloatTensor(Workspace* ws, const std::string& name) {
+  auto* blob = ws->GetBlob(name);
+  if (!blob || !blob->IsType<Tensor>(CPU)) {
+    return nullptr;
+  }
+  const auto& tensor = blob->Get<TensorCPU>();
+  return tensor.IsType<float>() ? &tensor : nullptr;
+}
+
+bool isQuantizable(const OperatorDef& op) {
+  if (op.device_option().device_type() != DeviceType::CPU) {
+    return false;
+  }
+  ArgumentHelper args(op);
+  if (op.type() == "FC") {
+    return args.GetSingleArgument<int>("axis_w", 1) == 1;
+  }
+  if (op.type() == "Conv") {
+    return args.GetSingleArgument<int>("group", 1) == 1 &&
+        (!args.HasArgument("kernels") ||
+         args.GetRepeatedArgument<int>("kernels").size() == 2);
+  }
+  return false;
+}
+
+repr::NNGraph::NodeRef createOp(repr::NNModule* nn, const OperatorDef& op) {
+  auto node = nn->dataFlow.createNode();
+  node->resetData(convertToNeuralNetOperator(op));
+  return node;
+}
+
+repr::NNGraph::NodeRef createTensor(
+    repr::NNModule* nn,
+    const std::string& name) {
+  return nn->dataFlow.createNode(util::make_unique<repr::Tensor>(name));
+}
+
+OperatorDef makeQuantizationOp(
+    const std::string& type,
+    const OperatorDef& like,
+    const int8::QuantizationParams& params) {
+  OperatorDef op;
+  op.set_type(type);
+  *op.mutable_device_option() = like.device_option();
+  if (type == "Int8Quantize") {
+    AddArgument<float>("Y_scale", params.scale, &op);
+    AddArgument<int>("Y_zero_point", params.zero_point, &op);
+  }
+  return op;
+}
+
+} // namespace
+
+void quantizeInt8(repr::NNModule* nn, caffe2::Workspace* ws) {
+  auto* statsBlob = ws->GetBlob(int8::kCalibrationStatsBlob);
+  if (!statsBlob || !statsBlob->IsType<int8::CalibrationStats>()) {
+    LOG(WARNING) << "No calibration stats, the net is not quantized";
+    return;
+  }
+  const auto& stats = statsBlob->Get<int8::CalibrationStats>();
+
+  // The inserted Int8Dequantize ops and the int8 tensors they read.
+  std::unordered_map<repr::NNGraph::NodeRef, repr::NNGraph::NodeRef>
+      dequantized;
+  for (auto bbNode : nn->controlFlow.getMutableNodes()) {
+    auto bb = bbNode->mutableData()->get();
+    // We insert instructions into the bb, so we copy here.
+    const auto instrs = bb->getInstructions();
+    for (size_t i = 0; i < instrs.size(); ++i) {
+      auto node = instrs[i];
+      const auto* def = getOpDef(node);
+      NOM_REQUIRE_OR_CONT(def && isQuantizable(*def));
+      const auto inputs = repr::nn::getInputs(node);
+      const auto outputs = repr::nn::getOutputs(node);
+      NOM_REQUIRE_OR_CONT(inputs.size() >= 2 && inputs.size() <= 3);
+      NOM_REQUIRE_OR_CONT(outputs.size() == 1);
+
+      int8::QuantizationParams inputParams;
+      int8::QuantizationParams outputParams;
+      NOM_REQUIRE_OR_CONT(stats.params(getName(inputs[0]), &inputParams));
+      NOM_REQUIRE_OR_CONT(stats.params(getName(outputs[0]), &outputParams));
+      const auto* W = getFloatTensor(ws, getName(inputs[1]));
+      const auto* b =
+          inputs.size() > 2 ? getFloatTensor(ws, getName(inputs[2])) : nullptr;
+      NOM_REQUIRE_OR_CONT(W && (inputs.size() == 2 || b));
+      NOM_REQUIRE_OR_CONT(def->type() == "FC" || W->ndim() == 4);
+
+      // The weights are packed once, here, rather than by the net.
+      auto packedName = getName(inputs[1]) + "_int8_packed";
+      if (b) {
+        packedName = getName(inputs[1]) + "_" + getName(inputs[2]) +
+            "_int8_packed";
+      }
+      int8::PackInt8Weights(
+          *W,
+          b,
+          ws->CreateBlob(packedName)->GetMutable<int8::Int8PackedWeights>());
+      auto packedNode = createTensor(nn, packedName);
+      nn->inputs.insert(packedNode);
+
+      // The input is already quantized with the same parameters if it comes
+      // from a converted op.
+      repr::NNGraph::NodeRef inputInt8 = nullptr;
+      if (repr::nn::hasProducer(inputs[0])) {
+        auto it = dequantized.find(repr::nn::getProducer(inputs[0]));
+        if (it != dequantized.end()) {
+          inputInt8 = it->second;
+        }
+      }
+      if (!inputInt8) {
+        inputInt8 = createTensor(nn, getName(inputs[0]) + "_int8");
+        auto quantize = createOp(
+            nn, makeQuantizationOp("Int8Quantize", *def, inputParams));
+        nn->dataFlow.createEdge(inputs[0], quantize);
+        nn->dataFlow.createEdge(quantize, inputInt8);
+        bb->insertInstructionBefore(quantize, node);
+      }
+
+      OperatorDef int8Op = *def;
+      int8Op.set_type(def->type() == "FC" ? "Int8FC" : "Int8Conv");
+      int8Op.clear_engine();
+      AddArgument<float>("Y_scale", outputParams.scale, &int8Op);
+      AddArgument<int>("Y_zero_point", outputParams.zero_point, &int8Op);
+      // The order of the edges is the order of the inputs.
+      const auto inEdges = node->getInEdges();
+      for (auto edge : inEdges) {
+        nn->dataFlow.deleteEdge(edge);
+      }
+      const auto outEdges = node->getOutEdges();
+      for (auto edge : outEdges) {
+        nn->dataFlow.deleteEdge(edge);
+      }
+      node->resetData(convertToNeuralNetOperator(int8Op));
+      nn->dataFlow.createEdge(inputInt8, node);
+      nn->dataFlow.createEdge(packedNode, node);
+
+      auto outputInt8 = createTensor(nn, getName(outputs[0]) + "_int8");
+      nn->dataFlow.createEdge(node, outputInt8);
+      auto dequantize = createOp(
+          nn, makeQuantizationOp("Int8Dequantize", int8Op, outputParams));
+      nn->dataFlow.createEdge(outputInt8, dequantize);
+      nn->dataFlow.createEdge(dequantize, outputs[0]);
+      if (i + 1 < instrs.size()) {
+        bb->insertInstructionBefore(dequantize, instrs[i + 1]);
+      } else {
+        bb->pushInstructionNode(dequantize);
+      }
+      dequantized[dequantize] = outputInt8;
+    }
+  }
+
+  // Drop the dequantized outputs that are only read by converted ops.
+  for (const auto& pair : dequantized) {
+    auto output = repr::nn::getOutputs(pair.first).front();
+    if (!repr::nn::hasConsumer(output) && !nn->outputs.count(output)) {
+      nn->dataFlow.deleteNode(pair.first);
+      nn->dataFlow.deleteNode(output);
+    }
+  }
+}
+
+REGISTER_WS_OPT_PASS_FROM_FUNC(Int8Quantization, quantizeInt8);
+
+} // namespace opt
+} // namespace caffe2
@@ -0,0 +1,26 @@
+#ifndef CAFFE2_OPT_INT8_QUANTIZATION_H_
+#define CAFFE2_OPT_INT8_QUANTIZATION_H_
+
+#include "caffe2/core/workspace.h"
+#include "nomnigraph/Representations/NeuralNet.h"
+
+namespace caffe2 {
+namespace opt {
+
+/**
+ * Converts the CPU FC and Conv ops of a float net to Int8FC and Int8Conv,
+ * using the calibration stats that a CalibrationNetObserver recorded into
+ * `ws`. Only ops whose input and output have been calibrated and whose
+ * weights are float tensors in `ws` are converted; their weights are packed
+ * into new blobs of `ws` that become external inputs of the net.
+ *
+ * Every converted op quantizes its input and dequantizes its output, so the
+ * rest of the net is unchanged. Between two converted ops the pair is
+ * elided and the int8 tensor is passed on directly.
+ */
+CAFFE2_API void quantizeInt8(nom::repr::NNModule* nn, caffe2::Workspace* ws);
+
+} // namespace opt
+} // namespace caffe2
+
+#endif // CAFFE2_OPT_INT8_QUANTIZATION_H_
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "caffe2/core/net.h"
+#include "caffe2/operators/quantized/int8_calibration.h"
+#include "caffe2/opt/converter.h"
+#include "caffe2/opt/int8_quantization.h"
+#include "caffe2/utils/proto_utils.h"
+
+namespace caffe2 {
+namespace {
+
+void fillRandom(
+    Workspace* ws,
+    const std::string& name,
+    const std::vector<TIndex>& dims,
+    std::mt19937* gen) {
+  auto* tensor = ws->CreateBlob(name)->GetMutableTensor(CPU);
+  tensor->Resize(dims);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  float* data = tensor->mutable_data<float>();
+  for (TIndex i = 0; i < tensor->size(); ++i) {
+    data[i] = dist(*gen);
+  }
+}
+
+OperatorDef* addOp(
+    NetDef* net,
+    const std::string& type,
+    const std::vector<std::string>& inputs,
+    const std::string& output) {
+  auto* op = net->add_op();
+  op->set_type(type);
+  for (const auto& input : inputs) {
+    op->add_input(input);
+  }
+  op->add_output(output);
+  return op;
+}
+
+// Calibrates `net` on the inputs in `ws`, quantizes it and checks that the
+// int8 net gives the float output "Y" within a few percent of its range.
+NetDef quantizeAndCompare(NetDef net, Workspace* ws) {
+  auto* floatNet = ws->CreateNet(net);
+  floatNet->AttachObserver(
+      make_unique<int8::CalibrationNetObserver>(floatNet, ws));
+  EXPECT_TRUE(floatNet->Run());
+  const auto& Y = ws->GetBlob("Y")->Get<TensorCPU>();
+  const std::vector<float> expected(Y.data<float>(), Y.data<float>() + Y.size());
+
+  auto nn = convertToNNModule(net);
+  opt::quantizeInt8(&nn, ws);
+  auto int8Net = convertToCaffe2Proto(nn, net);
+  int8Net.set_name("int8_net");
+  EXPECT_TRUE(ws->RunNetOnce(int8Net));
+
+  const auto& Yq = ws->GetBlob("Y")->Get<TensorCPU>();
+  EXPECT_EQ(Yq.size(), expected.size());
+  const auto minmax = std::minmax_element(expected.begin(), expected.end());
+  const float tolerance = 0.05f * (*minmax.second - *minmax.first);
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_NEAR(Yq.data<float>()[i], expected[i], tolerance);
+  }
+  return int8Net;
+}
+
+} // namespace
+
+TEST(Int8QuantizationTest, FCChain) {
+  Workspace ws;
+  std::mt19937 gen(0);
+  fillRandom(&ws, "X", {8, 37}, &gen);
+  fillRandom(&ws, "W1", {19, 37}, &gen);
+  fillRandom(&ws, "b1", {19}, &gen);
+  fillRandom(&ws, "W2", {6, 19}, &gen);
+  fillRandom(&ws, "b2", {6}, &gen);
+
+  NetDef net;
+  net.set_name("fc_chain");
+  addOp(&net, "FC", {"X", "W1", "b1"}, "H");
+  addOp(&net, "FC", {"H", "W2", "b2"}, "Y");
+  for (const auto& input : {"X", "W1", "b1", "W2", "b2"}) {
+    net.add_external_input(input);
+  }
+  net.add_external_output("Y");
+
+  const auto int8Net = quantizeAndCompare(net, &ws);
+  // H stays int8 between the two FCs.
+  std::vector<std::string> types;
+  for (const auto& op : int8Net.op()) {
+    types.push_back(op.type());
+  }
+  EXPECT_EQ(
+      types,
+      std::vector<std::string>(
+          {"Int8Quantize", "Int8FC", "Int8FC", "Int8Dequantize"}));
+}
+
+TEST(Int8QuantizationTest, ConvNHWC) {
+  Workspace ws;
+  std::mt19937 gen(0);
+  fillRandom(&ws, "X", {2, 7, 9, 5}, &gen);
+  fillRandom(&ws, "W", {8, 3, 3, 5}, &gen);
+  fillRandom(&ws, "b", {8}, &gen);
+
+  NetDef net;
+  net.set_name("conv");
+  auto* conv = addOp(&net, "Conv", {"X", "W", "b"}, "Y");
+  AddArgument<int>("kernel", 3, conv);
+  AddArgument<int>("pad", 1, conv);
+  AddArgument<int>("stride", 2, conv);
+  AddArgument<std::string>("order", "NHWC", conv);
+  for (const auto& input : {"X", "W", "b"}) {
+    net.add_external_input(input);
+  }
+  net.add_external_output("Y");
+
+  const auto int8Net = quantizeAndCompare(net, &ws);
+  EXPECT_EQ(int8Net.op_size(), 3);
+  EXPECT_EQ(int8Net.op(1).type(), "Int8Conv");
+}
+
+} // namespace caffe2
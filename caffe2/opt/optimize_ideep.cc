@@ -2,6 +2,8 @@
 #include "caffe2/opt/converter.h"
 #include "caffe2/opt/fusion.h"
 
+#include <cstring>
+
 #ifdef CAFFE2_USE_IDEEP
 #include "caffe2/ideep/ideep_utils.h"
 #endif
@@ -420,6 +422,93 @@ void setPoolingInferenceMode(repr::NNModule *nn) {
   }
 }
 
+// Fallback operators are registered as IDEEPFallbackOp<CPUOp>, whose
+// demangled type the registry keeps as the help message of the entry.
+bool isIdeepFallbackOp(repr::NNGraph::NodeRef node) {
+  if (!repr::nn::is<repr::NeuralNetOperator>(node)) {
+    return false;
+  }
+  const auto* annotation =
+      repr::nn::get<repr::NeuralNetOperator>(node)->getAnnotation();
+  if (!annotation || !isa<Caffe2Annotation>(annotation)) {
+    return false;
+  }
+  const auto& op = dyn_cast<Caffe2Annotation>(annotation)->getOperatorDef();
+  if (op.device_option().device_type() != DeviceType::IDEEP) {
+    return false;
+  }
+  const char* type = IDEEPOperatorRegistry()->HelpMessage(op.type());
+  return type && strstr(type, "IDEEPFallbackOp<") != nullptr;
+}
+
+// Whether the outputs of `node` can be in a blocked MKL-DNN layout.
+bool isNativeIdeepOp(repr::NNGraph::NodeRef node) {
+  if (!repr::nn::is<repr::NeuralNetOperator>(node)) {
+    return false;
+  }
+  const auto* annotation =
+      repr::nn::get<repr::NeuralNetOperator>(node)->getAnnotation();
+  if (!annotation || !isa<Caffe2Annotation>(annotation)) {
+    return false;
+  }
+  const auto& op = dyn_cast<Caffe2Annotation>(annotation)->getOperatorDef();
+  return op.device_option().device_type() == DeviceType::IDEEP &&
+      op.type() != "CopyIDEEPToCPU" && !isIdeepFallbackOp(node);
+}
+
+// Every fallback operator reading an output of a native IDEEP operator
+// reorders it into the plain layout on each run. When several of them read
+// the same tensor, it is reordered once by a CopyIDEEPToCPU, whose plain
+// output they all share without conversion. Reports the number of layout
+// transitions into fallback operators, and how many were removed.
+void groupFallbackReordersForIdeep(repr::NNModule* nn) {
+  size_t transitions = 0;
+  size_t removed = 0;
+  for (auto tensor : nn->dataFlow.getMutableNodes()) {
+    if (!repr::nn::is<repr::NeuralNetData>(tensor) ||
+        !repr::nn::hasProducer(tensor)) {
+      continue;
+    }
+    auto producer = repr::nn::getProducer(tensor);
+    if (!isNativeIdeepOp(producer)) {
+      continue;
+    }
+    std::vector<repr::NNGraph::EdgeRef> fallbackEdges;
+    for (auto edge : tensor->getOutEdges()) {
+      if (isIdeepFallbackOp(edge->head())) {
+        fallbackEdges.push_back(edge);
+      }
+    }
+    transitions += fallbackEdges.size();
+    if (fallbackEdges.size() < 2) {
+      continue;
+    }
+
+    caffe2::OperatorDef def;
+    def.set_type("CopyIDEEPToCPU");
+    def.mutable_device_option()->CopyFrom(
+        getOpDef(*repr::nn::get<repr::NeuralNetOperator>(producer))
+            .device_option());
+    auto copy = nn->dataFlow.createNode(convertToNeuralNetOperator(def));
+    auto plain = nn->dataFlow.createNode(util::make_unique<repr::Tensor>(
+        repr::nn::get<repr::Tensor>(tensor)->getName() + "_plain"));
+    nn->dataFlow.createEdge(tensor, copy);
+    nn->dataFlow.createEdge(copy, plain);
+    for (auto edge : fallbackEdges) {
+      // The reader keeps the position of the input among its inputs.
+      tensor->removeOutEdge(edge);
+      edge->setTail(plain);
+      plain->addOutEdge(edge);
+    }
+    removed += fallbackEdges.size() - 1;
+  }
+  if (transitions > 0) {
+    LOG(INFO) << "IDEEP net has " << transitions
+              << " layout transitions into fallback operators, " << removed
+              << " of them removed by sharing reorders";
+  }
+}
+
 void OptimizeForIdeep(
     repr::NNModule* nn,
     caffe2::Workspace* ws,
@@ -438,6 +527,8 @@ void OptimizeForIdeep(
   enforceFusionInplaceForIdeep(nn);
 
   setPoolingInferenceMode(nn);
+
+  groupFallbackReordersForIdeep(nn);
 }
 
 #endif // CAFFE2_USE_IDEEP
@@ -0,0 +1,474 @@
+#include "caffe2/opt/pattern_fusion.h"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_set>
+
+#include "caffe2/opt/converter.h"
+#include "caffe2/opt/passes.h"
+#include "caffe2/utils/cast.h"
+#include "caffe2/utils/proto_utils.h"
+
+namespace caffe2 {
+namespace opt {
+
+using namespace nom;
+
+namespace {
+
+using NodeRef = repr::NNGraph::NodeRef;
+
+const OperatorDef* getOpDef(NodeRef node) {
+  if (!repr::nn::is<repr::NeuralNetOperator>(node)) {
+    return nullptr;
+  }
+  auto* annotation =
+      repr::nn::get<repr::NeuralNetOperator>(node)->getAnnotation();
+  if (!annotation || !isa<Caffe2Annotation>(annotation)) {
+    return nullptr;
+  }
+  return &dyn_cast<Caffe2Annotation>(annotation)->getOperatorDef();
+}
+
+const std::string& getName(NodeRef tensor) {
+  return repr::nn::get<repr::NeuralNetData>(tensor)->getName();
+}
+
+bool isOnCPU(const OperatorDef& op) {
+  return op.device_option().device_type() == DeviceType::CPU;
+}
+
+// The operator reading the only output of `node`, if the output is read once
+// and is not an output of the net, so that it can be removed.
+NodeRef getOnlyConsumer(repr::NNModule* nn, NodeRef node) {
+  const auto outputs = repr::nn::getOutputs(node);
+  if (outputs.size() != 1 || nn->outputs.count(outputs.front())) {
+    return nullptr;
+  }
+  const auto consumers = repr::nn::getConsumers(outputs.front());
+  return consumers.size() == 1 ? consumers.front() : nullptr;
+}
+
+bool isUnused(repr::NNModule* nn, NodeRef tensor) {
+  return !repr::nn::hasConsumer(tensor) && !nn->outputs.count(tensor);
+}
+
+// Whether an operator after `from` and before `to` (or the end of the basic
+// block if `to` is null), other than those in `skip`, writes the blob `name`,
+// or with `reads` also reads it. Moving a read or write of `name` between
+// `from` and `to` is only safe if not.
+bool isUsedBetween(
+    repr::NNModule* nn,
+    NodeRef from,
+    NodeRef to,
+    const std::string& name,
+    bool reads,
+    const std::unordered_set<NodeRef>& skip = {}) {
+  for (auto bbNode : nn->controlFlow.getMutableNodes()) {
+    auto bb = bbNode->mutableData()->get();
+    if (!bb->hasInstruction(from)) {
+      continue;
+    }
+    const auto& instrs = bb->getInstructions();
+    auto it = std::find(instrs.begin(), instrs.end(), from);
+    for (++it; it != instrs.end() && *it != to; ++it) {
+      if (skip.count(*it)) {
+        continue;
+      }
+      for (auto output : repr::nn::getOutputs(*it)) {
+        if (getName(output) == name) {
+          return true;
+        }
+      }
+      if (!reads) {
+        continue;
+      }
+      for (auto input : repr::nn::getInputs(*it)) {
+        if (getName(input) == name) {
+          return true;
+        }
+      }
+    }
+    return to && it == instrs.end();
+  }
+  return true;
+}
+
+// Removes `first` through `last`, a sequence of operators that leaves its
+// input unchanged, and makes the readers of the output of `last` read the
+// input of `first` instead.
+bool bypass(repr::NNModule* nn, NodeRef first, NodeRef last) {
+  const auto input = repr::nn::getInputs(first).front();
+  const auto output = repr::nn::getOutputs(last).front();
+  if (nn->outputs.count(output) ||
+      isUsedBetween(
+          nn, first, nullptr, getName(input), false, {first, last})) {
+    return false;
+  }
+  // The readers keep the position of the output among their inputs.
+  nn->dataFlow.replaceNode(output, input);
+  nn->dataFlow.deleteNode(output);
+  return true;
+}
+
+// Makes `node` read the input of its producer `producer` in place of its
+// output, and removes `producer`.
+bool bypassProducer(repr::NNModule* nn, NodeRef producer, NodeRef node) {
+  const auto input = repr::nn::getInputs(producer).front();
+  const auto output = repr::nn::getOutputs(producer).front();
+  if (isUsedBetween(nn, producer, node, getName(input), false)) {
+    return false;
+  }
+  nn->dataFlow.replaceNode(output, input);
+  nn->dataFlow.deleteNode(producer);
+  nn->dataFlow.deleteNode(output);
+  return true;
+}
+
+void deleteNodes(repr::NNModule* nn, const std::vector<NodeRef>& nodes) {
+  for (auto node : nodes) {
+    nn->dataFlow.deleteNode(node);
+  }
+}
+
+bool isUnaryActivation(const std::string& type) {
+  return type == "Relu" || type == "Sigmoid" || type == "Tanh";
+}
+
+bool isFusibleElementwise(const OperatorDef& op) {
+  if (!isOnCPU(op) || op.output_size() != 1) {
+    return false;
+  }
+  ArgumentHelper args(op);
+  if (isUnaryActivation(op.type())) {
+    return op.input_size() == 1;
+  }
+  if (op.type() == "Add" || op.type() == "Mul") {
+    // Legacy broadcasting is not supported.
+    return op.input_size() == 2 &&
+        !args.GetSingleArgument<bool>("broadcast", false);
+  }
+  if (op.type() == "Cast") {
+    return op.input_size() == 1 &&
+        cast::GetCastDataType(args, "to") == TensorProto_DataType_FLOAT;
+  }
+  return false;
+}
+
+// Fuses the longest chain starting at `head` that can be fused, if it has
+// at least two operators.
+bool fuseElementwiseChain(repr::NNModule* nn, NodeRef head) {
+  const auto* headDef = getOpDef(head);
+  if (!headDef || !isFusibleElementwise(*headDef)) {
+    return false;
+  }
+  // The chain input, then the other operand of each Add and Mul.
+  const auto headInputs = repr::nn::getInputs(head);
+  std::vector<NodeRef> inputs(headInputs.begin(), headInputs.end());
+  std::vector<NodeRef> readers(inputs.size(), head);
+  std::vector<NodeRef> ops = {head};
+  std::vector<std::string> steps;
+  const bool cast = headDef->type() == "Cast";
+  if (!cast) {
+    steps.push_back(headDef->type());
+  }
+  for (auto node = getOnlyConsumer(nn, head); node;
+       node = getOnlyConsumer(nn, node)) {
+    const auto* def = getOpDef(node);
+    if (!def || !isFusibleElementwise(*def) || def->type() == "Cast") {
+      break;
+    }
+    const auto previous = repr::nn::getOutputs(ops.back()).front();
+    for (auto input : repr::nn::getInputs(node)) {
+      if (input != previous) {
+        inputs.push_back(input);
+        readers.push_back(node);
+      }
+    }
+    ops.push_back(node);
+    steps.push_back(def->type());
+  }
+
+  // The fused op runs at the position of the last op of the chain, so none
+  // of its inputs may be overwritten before. The chain is evaluated in float,
+  // which only the Cast or an activation guarantees for the standalone ops.
+  size_t length = ops.size();
+  size_t numInputs = inputs.size();
+  for (; length >= 2; --length) {
+    const std::unordered_set<NodeRef> chain(
+        ops.begin(), ops.begin() + length);
+    numInputs = 0;
+    while (numInputs < readers.size() && chain.count(readers[numInputs])) {
+      ++numInputs;
+    }
+    bool safe = true;
+    for (size_t i = 0; i < numInputs && safe; ++i) {
+      safe = !isUsedBetween(
+          nn, readers[i], ops[length - 1], getName(inputs[i]), false, chain);
+    }
+    const bool floatChain = cast ||
+        std::any_of(steps.begin(),
+                    steps.begin() + length - (cast ? 1 : 0),
+                    isUnaryActivation);
+    if (safe && floatChain) {
+      break;
+    }
+  }
+  if (length < 2) {
+    return false;
+  }
+  ops.resize(length);
+  steps.resize(length - (cast ? 1 : 0));
+  inputs.resize(numInputs);
+
+  const auto last = ops.back();
+  OperatorDef fused;
+  fused.set_type("FusedElementwise");
+  fused.set_name(getOpDef(last)->name());
+  *fused.mutable_device_option() = headDef->device_option();
+  AddArgument<std::vector<std::string>>("ops", steps, &fused);
+  if (cast) {
+    AddArgument<bool>("cast", true, &fused);
+  }
+
+  std::vector<NodeRef> removed;
+  for (size_t i = 0; i + 1 < ops.size(); ++i) {
+    removed.push_back(ops[i]);
+    removed.push_back(repr::nn::getOutputs(ops[i]).front());
+  }
+  const auto inEdges = last->getInEdges();
+  for (auto edge : inEdges) {
+    nn->dataFlow.deleteEdge(edge);
+  }
+  last->resetData(convertToNeuralNetOperator(fused));
+  for (auto input : inputs) {
+    nn->dataFlow.createEdge(input, last);
+  }
+  deleteNodes(nn, removed);
+  return true;
+}
+
+bool fuseFCActivationOnce(repr::NNModule* nn, NodeRef fc) {
+  const auto* def = getOpDef(fc);
+  if (!def || (def->type() != "FC" && def->type() != "FCTransposed") ||
+      !isOnCPU(*def) || !def->engine().empty() ||
+      ArgumentHelper::HasArgument(*def, "activation")) {
+    return false;
+  }
+  const auto activation = getOnlyConsumer(nn, fc);
+  const auto* activationDef = activation ? getOpDef(activation) : nullptr;
+  if (!activationDef || !isUnaryActivation(activationDef->type()) ||
+      !IsSameDevice(def->device_option(), activationDef->device_option()) ||
+      repr::nn::getOutputs(activation).size() != 1) {
+    return false;
+  }
+
+  // The FC writes the output of the activation earlier than the activation
+  // did, and cannot write to its own input.
+  const auto output = repr::nn::getOutputs(activation).front();
+  const auto& name = getName(output);
+  if (isUsedBetween(nn, fc, activation, name, true)) {
+    return false;
+  }
+  for (auto input : repr::nn::getInputs(fc)) {
+    if (getName(input) == name) {
+      return false;
+    }
+  }
+
+  OperatorDef fused = *def;
+  AddArgument<std::string>("activation", activationDef->type(), &fused);
+  const auto intermediate = repr::nn::getOutputs(fc).front();
+  fc->resetData(convertToNeuralNetOperator(fused));
+  nn->dataFlow.deleteNode(activation);
+  nn->dataFlow.replaceNode(intermediate, output);
+  nn->dataFlow.deleteNode(intermediate);
+  return true;
+}
+
+// Whether transposing with axes `first` and then with axes `second` gives
+// the input back. Empty axes reverse the dims.
+bool isIdentityTranspose(std::vector<int> first, std::vector<int> second) {
+  if (first.empty() && second.empty()) {
+    return true;
+  }
+  const size_t ndim = std::max(first.size(), second.size());
+  for (auto* axes : {&first, &second}) {
+    if (axes->empty()) {
+      for (int i = ndim - 1; i >= 0; --i) {
+        axes->push_back(i);
+      }
+    }
+  }
+  if (first.size() != second.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < ndim; ++i) {
+    if (second[i] < 0 || second[i] >= static_cast<int>(ndim) ||
+        first[second[i]] != static_cast<int>(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool removeRedundantTranspose(repr::NNModule* nn, NodeRef node) {
+  const auto* def = getOpDef(node);
+  const auto axes = ArgumentHelper(*def).GetRepeatedArgument<int>("axes");
+  std::vector<int> identity(axes.size());
+  std::iota(identity.begin(), identity.end(), 0);
+  if (!axes.empty() && axes == identity) {
+    if (bypass(nn, node, node)) {
+      nn->dataFlow.deleteNode(node);
+      return true;
+    }
+    return false;
+  }
+
+  const auto next = getOnlyConsumer(nn, node);
+  const auto* nextDef = next ? getOpDef(next) : nullptr;
+  if (!nextDef || nextDef->type() != "Transpose" ||
+      !isIdentityTranspose(
+          axes, ArgumentHelper(*nextDef).GetRepeatedArgument<int>("axes"))) {
+    return false;
+  }
+  const auto intermediate = repr::nn::getOutputs(node).front();
+  if (!bypass(nn, node, next)) {
+    return false;
+  }
+  deleteNodes(nn, {node, next, intermediate});
+  return true;
+}
+
+bool removeRedundantReshape(repr::NNModule* nn, NodeRef node) {
+  // Reshape outputs the reshaped tensor and the old shape.
+  const auto outputs = repr::nn::getOutputs(node);
+  if (outputs.size() != 2 || nn->outputs.count(outputs[0])) {
+    return false;
+  }
+  const auto consumers = repr::nn::getConsumers(outputs[0]);
+  if (consumers.size() != 1) {
+    return false;
+  }
+  const auto next = consumers.front();
+  const auto* nextDef = getOpDef(next);
+  if (!nextDef || nextDef->type() != "Reshape") {
+    return false;
+  }
+  const auto nextInputs = repr::nn::getInputs(next);
+  const auto nextOutputs = repr::nn::getOutputs(next);
+  // The old shape of the second Reshape changes either way.
+  if (nextOutputs.size() != 2 || !isUnused(nn, nextOutputs[1])) {
+    return false;
+  }
+
+  // Reshaping to the old shape of the first Reshape undoes it.
+  if (nextInputs.size() == 2 && nextInputs[1] == outputs[1]) {
+    if (nn->outputs.count(outputs[1]) ||
+        repr::nn::getConsumers(outputs[1]).size() != 1 ||
+        !bypass(nn, node, next)) {
+      return false;
+    }
+    deleteNodes(nn, {node, next, outputs[0], outputs[1], nextOutputs[1]});
+    return true;
+  }
+
+  // Otherwise the second Reshape can reshape the input of the first one, if
+  // its shape does not refer to the dims of its input.
+  const auto shape = ArgumentHelper(*nextDef).GetRepeatedArgument<int64_t>(
+      "shape");
+  if (nextInputs.size() != 1 || !isUnused(nn, outputs[1]) ||
+      std::count(shape.begin(), shape.end(), 0) > 0) {
+    return false;
+  }
+  const auto oldShape = outputs[1];
+  if (!bypassProducer(nn, node, next)) {
+    return false;
+  }
+  nn->dataFlow.deleteNode(oldShape);
+  return true;
+}
+
+bool removeRedundantCopy(repr::NNModule* nn, NodeRef node) {
+  const auto* def = getOpDef(node);
+  const auto next = getOnlyConsumer(nn, node);
+  const auto* nextDef = next ? getOpDef(next) : nullptr;
+  if (!nextDef ||
+      !IsSameDevice(def->device_option(), nextDef->device_option())) {
+    return false;
+  }
+  const auto& type = def->type();
+  const auto& nextType = nextDef->type();
+  // A copy to the GPU and back, or the other way around, gives the input.
+  if ((type == "CopyCPUToGPU" && nextType == "CopyGPUToCPU") ||
+      (type == "CopyGPUToCPU" && nextType == "CopyCPUToGPU")) {
+    const auto intermediate = repr::nn::getOutputs(node).front();
+    if (!bypass(nn, node, next)) {
+      return false;
+    }
+    deleteNodes(nn, {node, next, intermediate});
+    return true;
+  }
+  // A copy of a copy only needs one copy.
+  if (type == "Copy" && nextType == "Copy") {
+    return bypassProducer(nn, node, next);
+  }
+  return false;
+}
+
+bool removeRedundantOp(repr::NNModule* nn, NodeRef node) {
+  const auto* def = getOpDef(node);
+  if (!def || repr::nn::getInputs(node).empty()) {
+    return false;
+  }
+  const auto& type = def->type();
+  if (type == "Transpose") {
+    return removeRedundantTranspose(nn, node);
+  }
+  if (type == "Reshape") {
+    return removeRedundantReshape(nn, node);
+  }
+  if (type == "Copy" || type == "CopyCPUToGPU" || type == "CopyGPUToCPU") {
+    return removeRedundantCopy(nn, node);
+  }
+  return false;
+}
+
+// Applies `rewrite` to the operators in order until it changes the graph,
+// which invalidates the iteration, and returns whether it did.
+template <typename F>
+bool rewriteOnce(repr::NNModule* nn, F rewrite) {
+  for (auto bbNode : nn->controlFlow.getMutableNodes()) {
+    auto bb = bbNode->mutableData()->get();
+    for (auto node : bb->getInstructions()) {
+      if (rewrite(nn, node)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+void fuseElementwise(repr::NNModule* nn) {
+  while (rewriteOnce(nn, fuseElementwiseChain)) {
+  }
+}
+
+void fuseFCActivation(repr::NNModule* nn) {
+  while (rewriteOnce(nn, fuseFCActivationOnce)) {
+  }
+}
+
+void removeRedundantOps(repr::NNModule* nn) {
+  while (rewriteOnce(nn, removeRedundantOp)) {
+  }
+}
+
+REGISTER_OPT_PASS_FROM_FUNC(FuseElementwise, fuseElementwise);
+REGISTER_OPT_PASS_FROM_FUNC(FuseFCActivation, fuseFCActivation);
+REGISTER_OPT_PASS_FROM_FUNC(RemoveRedundantOps, removeRedundantOps);
+
+} // namespace opt
+} // namespace caffe2
@@ -0,0 +1,26 @@
+#ifndef CAFFE2_OPT_PATTERN_FUSION_H_
+#define CAFFE2_OPT_PATTERN_FUSION_H_
+
+#include "nomnigraph/Representations/NeuralNet.h"
+
+namespace caffe2 {
+namespace opt {
+
+// Replaces chains of CPU Add, Mul, Relu, Sigmoid, Tanh and Cast operators,
+// where each operator reads the output of the previous one and nothing else
+// does, with a single FusedElementwise operator. A Cast must convert to
+// float and is only fused at the start of a chain.
+CAFFE2_API void fuseElementwise(nom::repr::NNModule* nn);
+
+// Folds a Relu, Sigmoid or Tanh that reads the output of a CPU FC into the
+// FC, through its activation argument.
+CAFFE2_API void fuseFCActivation(nom::repr::NNModule* nn);
+
+// Removes pairs of Transpose, Reshape and Copy operators that undo each
+// other, and merges two consecutive Reshapes or Copies into one.
+CAFFE2_API void removeRedundantOps(nom::repr::NNModule* nn);
+
+} // namespace opt
+} // namespace caffe2
+
+#endif // CAFFE2_OPT_PATTERN_FUSION_H_
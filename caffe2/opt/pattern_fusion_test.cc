@@ -0,0 +1,160 @@
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "caffe2/core/workspace.h"
+#include "caffe2/opt/converter.h"
+#include "caffe2/opt/pattern_fusion.h"
+#include "caffe2/utils/proto_utils.h"
+
+namespace caffe2 {
+namespace {
+
+void fillRandom(
+    Workspace* ws,
+    const std::string& name,
+    const std::vector<TIndex>& dims) {
+  static std::mt19937 gen(0);
+  auto* tensor = ws->CreateBlob(name)->GetMutableTensor(CPU);
+  tensor->Resize(dims);
+  std::uniform_real_distribution<float> dist(-2.f, 2.f);
+  float* data = tensor->mutable_data<float>();
+  for (TIndex i = 0; i < tensor->size(); ++i) {
+    data[i] = dist(gen);
+  }
+}
+
+OperatorDef* addOp(
+    NetDef* net,
+    const std::string& type,
+    const std::vector<std::string>& inputs,
+    const std::vector<std::string>& outputs) {
+  auto* op = net->add_op();
+  op->set_type(type);
+  for (const auto& input : inputs) {
+    op->add_input(input);
+  }
+  for (const auto& output : outputs) {
+    op->add_output(output);
+  }
+  return op;
+}
+
+std::vector<float> runAndFetch(Workspace* ws, const NetDef& net) {
+  EXPECT_TRUE(ws->RunNetOnce(net));
+  const auto& Y = ws->GetBlob("Y")->Get<TensorCPU>();
+  return std::vector<float>(Y.data<float>(), Y.data<float>() + Y.size());
+}
+
+// Runs `net` before and after `pass` and checks that the output "Y" is the
+// same. Returns the optimized net.
+NetDef optimizeAndCompare(
+    Workspace* ws,
+    NetDef net,
+    void (*pass)(nom::repr::NNModule*)) {
+  net.add_external_output("Y");
+  const auto expected = runAndFetch(ws, net);
+  auto nn = convertToNNModule(net);
+  pass(&nn);
+  const auto optimized = convertToCaffe2Proto(nn, net);
+  const auto actual = runAndFetch(ws, optimized);
+  EXPECT_EQ(actual.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_NEAR(actual[i], expected[i], 1e-5);
+  }
+  return optimized;
+}
+
+} // namespace
+
+TEST(PatternFusionTest, ElementwiseChain) {
+  Workspace ws;
+  fillRandom(&ws, "X", {4, 5, 300});
+  fillRandom(&ws, "B", {5, 300});
+  fillRandom(&ws, "C", {4, 1, 1});
+  NetDef net;
+  addOp(&net, "Add", {"X", "B"}, {"T1"});
+  addOp(&net, "Relu", {"T1"}, {"T1"});
+  addOp(&net, "Mul", {"C", "T1"}, {"T2"});
+  addOp(&net, "Sigmoid", {"T2"}, {"Y"});
+
+  const auto optimized =
+      optimizeAndCompare(&ws, net, opt::fuseElementwise);
+  ASSERT_EQ(optimized.op_size(), 1);
+  const auto& op = optimized.op(0);
+  EXPECT_EQ(op.type(), "FusedElementwise");
+  EXPECT_EQ(
+      std::vector<std::string>(op.input().begin(), op.input().end()),
+      std::vector<std::string>({"X", "B", "C"}));
+  EXPECT_EQ(
+      ArgumentHelper(op).GetRepeatedArgument<std::string>("ops"),
+      std::vector<std::string>({"Add", "Relu", "Mul", "Sigmoid"}));
+}
+
+TEST(PatternFusionTest, ElementwiseChainStopsBeforeOverwrite) {
+  Workspace ws;
+  fillRandom(&ws, "X", {16});
+  fillRandom(&ws, "B", {16});
+  NetDef net;
+  addOp(&net, "Relu", {"B"}, {"D"});
+  addOp(&net, "Tanh", {"X"}, {"T"});
+  addOp(&net, "Add", {"T", "D"}, {"U"});
+  // D is overwritten after the Add reads it, so the chain cannot run at the
+  // position of the last Relu.
+  addOp(&net, "Sigmoid", {"D"}, {"D"});
+  addOp(&net, "Relu", {"U"}, {"Y"});
+
+  const auto optimized =
+      optimizeAndCompare(&ws, net, opt::fuseElementwise);
+  ASSERT_EQ(optimized.op_size(), 4);
+  EXPECT_EQ(optimized.op(1).type(), "FusedElementwise");
+  EXPECT_EQ(
+      ArgumentHelper(optimized.op(1)).GetRepeatedArgument<std::string>("ops"),
+      std::vector<std::string>({"Tanh", "Add"}));
+  EXPECT_EQ(optimized.op(3).type(), "Relu");
+}
+
+TEST(PatternFusionTest, FCActivation) {
+  Workspace ws;
+  fillRandom(&ws, "X", {8, 32});
+  fillRandom(&ws, "W", {16, 32});
+  fillRandom(&ws, "b", {16});
+  NetDef net;
+  addOp(&net, "FC", {"X", "W", "b"}, {"H"});
+  addOp(&net, "Relu", {"H"}, {"Y"});
+
+  const auto optimized =
+      optimizeAndCompare(&ws, net, opt::fuseFCActivation);
+  ASSERT_EQ(optimized.op_size(), 1);
+  EXPECT_EQ(optimized.op(0).type(), "FC");
+  EXPECT_EQ(optimized.op(0).output(0), "Y");
+  EXPECT_EQ(
+      ArgumentHelper(optimized.op(0)).GetSingleArgument<std::string>(
+          "activation", ""),
+      "Relu");
+}
+
+TEST(PatternFusionTest, RedundantOps) {
+  Workspace ws;
+  fillRandom(&ws, "X", {2, 3, 4});
+  NetDef net;
+  auto* transpose = addOp(&net, "Transpose", {"X"}, {"T1"});
+  AddArgument<std::vector<int>>("axes", {2, 0, 1}, transpose);
+  transpose = addOp(&net, "Transpose", {"T1"}, {"T2"});
+  AddArgument<std::vector<int>>("axes", {1, 2, 0}, transpose);
+  auto* reshape = addOp(&net, "Reshape", {"T2"}, {"R1", "S1"});
+  AddArgument<std::vector<int64_t>>("shape", {6, 4}, reshape);
+  addOp(&net, "Reshape", {"R1", "S1"}, {"R2", "S2"});
+  addOp(&net, "Copy", {"R2"}, {"C1"});
+  addOp(&net, "Copy", {"C1"}, {"C2"});
+  addOp(&net, "Relu", {"C2"}, {"Y"});
+
+  const auto optimized =
+      optimizeAndCompare(&ws, net, opt::removeRedundantOps);
+  ASSERT_EQ(optimized.op_size(), 2);
+  EXPECT_EQ(optimized.op(0).type(), "Copy");
+  EXPECT_EQ(optimized.op(0).input(0), "X");
+  EXPECT_EQ(optimized.op(1).type(), "Relu");
+}
+
+} // namespace caffe2
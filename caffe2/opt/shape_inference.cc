@@ -0,0 +1,143 @@
+#include "caffe2/opt/shape_inference.h"
+
+#include <unordered_set>
+
+#include "caffe2/core/operator.h"
+#include "caffe2/opt/converter.h"
+
+namespace caffe2 {
+namespace opt {
+
+using namespace nom;
+
+namespace {
+
+const OperatorDef* getOpDef(ShapeInference::NodeRef op) {
+  const auto* annotation =
+      repr::nn::get<repr::NeuralNetOperator>(op)->getAnnotation();
+  if (!annotation || !isa<Caffe2Annotation>(annotation)) {
+    return nullptr;
+  }
+  return &dyn_cast<Caffe2Annotation>(annotation)->getOperatorDef();
+}
+
+TensorShape unknownShape() {
+  TensorShape shape;
+  shape.set_unknown_shape(true);
+  return shape;
+}
+
+} // namespace
+
+ShapeInference::ShapeInference(Workspace* ws) : ws_(ws) {
+  CAFFE_ENFORCE(ws);
+}
+
+ShapeInference::ShapeInference(
+    std::unordered_map<std::string, TensorShape> hints)
+    : hints_(std::move(hints)) {}
+
+const TensorShape& ShapeInference::getShape(NodeRef tensor) {
+  auto it = shapes_.find(tensor);
+  if (it != shapes_.end()) {
+    return it->second;
+  }
+  // Depth first through the producers, without recursion since the nets
+  // can be very deep. The data flow graph is in SSA form, hence acyclic.
+  std::vector<NodeRef> stack{tensor};
+  while (!stack.empty()) {
+    auto current = stack.back();
+    if (shapes_.count(current)) {
+      stack.pop_back();
+      continue;
+    }
+    if (!repr::nn::hasProducer(current)) {
+      shapes_[current] = externalShape(current);
+      stack.pop_back();
+      continue;
+    }
+    auto op = repr::nn::getProducer(current);
+    bool ready = true;
+    for (auto input : repr::nn::getInputs(op)) {
+      if (!shapes_.count(input)) {
+        stack.push_back(input);
+        ready = false;
+      }
+    }
+    if (ready) {
+      inferOp(op);
+      stack.pop_back();
+    }
+  }
+  return shapes_.at(tensor);
+}
+
+void ShapeInference::setShape(NodeRef tensor, const TensorShape& shape) {
+  invalidate(tensor);
+  shapes_[tensor] = shape;
+}
+
+void ShapeInference::invalidate(NodeRef node) {
+  // Downstream tensors are usually cached, but not necessarily: the pass may
+  // have rewired them to new nodes, so the traversal doesn't stop at the
+  // tensors without a shape.
+  std::unordered_set<NodeRef> seen{node};
+  std::vector<NodeRef> stack{node};
+  while (!stack.empty()) {
+    auto current = stack.back();
+    stack.pop_back();
+    std::vector<NodeRef> next;
+    if (repr::nn::is<repr::NeuralNetData>(current)) {
+      shapes_.erase(current);
+      next = repr::nn::getConsumers(current);
+    } else if (repr::nn::is<repr::NeuralNetOperator>(current)) {
+      next = repr::nn::getOutputs(current);
+    }
+    for (auto n : next) {
+      if (seen.insert(n).second) {
+        stack.push_back(n);
+      }
+    }
+  }
+}
+
+TensorShape ShapeInference::externalShape(NodeRef tensor) {
+  const auto& name = repr::nn::get<repr::NeuralNetData>(tensor)->getName();
+  if (ws_) {
+    const auto* blob = ws_->GetBlob(name);
+    return blob ? GetTensorShapeOfBlob(blob) : unknownShape();
+  }
+  auto it = hints_.find(name);
+  return it != hints_.end() ? it->second : unknownShape();
+}
+
+void ShapeInference::inferOp(NodeRef op) {
+  const auto outputs = repr::nn::getOutputs(op);
+  std::vector<TensorShape> inputShapes;
+  bool known = true;
+  for (auto input : repr::nn::getInputs(op)) {
+    inputShapes.push_back(shapes_.at(input));
+    known = known && !inputShapes.back().unknown_shape();
+  }
+
+  std::vector<TensorShape> outputShapes;
+  const auto* def = getOpDef(op);
+  const auto* schema = def ? OpSchemaRegistry::Schema(def->type()) : nullptr;
+  if (schema && known) {
+    ++numInferredOps_;
+    try {
+      outputShapes = schema->InferTensor(*def, inputShapes);
+    } catch (const ::caffe2::EnforceNotMet& enf) {
+      VLOG(1) << "Shape inference failed for " << def->type() << ": "
+              << enf.msg();
+      outputShapes.clear();
+    }
+  }
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    shapes_[outputs[i]] =
+        i < outputShapes.size() ? outputShapes[i] : unknownShape();
+  }
+}
+
+} // namespace opt
+} // namespace caffe2
@@ -0,0 +1,65 @@
+#ifndef CAFFE2_OPT_SHAPE_INFERENCE_H_
+#define CAFFE2_OPT_SHAPE_INFERENCE_H_
+
+#include <unordered_map>
+
+#include "caffe2/core/workspace.h"
+#include "caffe2/proto/caffe2.pb.h"
+#include "nomnigraph/Representations/NeuralNet.h"
+
+namespace caffe2 {
+namespace opt {
+
+// The shapes and types of the tensors of an NNModule graph, inferred with the
+// shape inference functions of the operator schemas and cached per tensor
+// node, so that passes can share one map instead of running
+// InferBlobShapesAndTypes over the whole net each.
+//
+// Shapes are inferred lazily, from the producer of a tensor back to the
+// external inputs, whose shapes come from a workspace or from hints. After a
+// pass rewrites the graph, invalidate() forgets the shapes downstream of the
+// changed nodes only, and the next getShape() re-infers just those.
+//
+// A tensor gets an unknown shape when its producer has no schema or shape
+// inference function, when inference fails, or when the shape of one of the
+// inputs of its producer is unknown.
+class CAFFE2_API ShapeInference {
+ public:
+  using NodeRef = nom::repr::NNGraph::NodeRef;
+
+  // The shapes of the external inputs are those of their blobs in `ws`.
+  explicit ShapeInference(Workspace* ws);
+  // The shapes of the external inputs are looked up by name in `hints`.
+  explicit ShapeInference(std::unordered_map<std::string, TensorShape> hints);
+
+  const TensorShape& getShape(NodeRef tensor);
+
+  // Overrides the shape of `tensor`, e.g. of an external input whose shape
+  // changed, and invalidates the shapes downstream of it.
+  void setShape(NodeRef tensor, const TensorShape& shape);
+
+  // Forgets the shapes of `node` (an operator or a tensor) and of all the
+  // tensors that depend on it. Must be called for the nodes a pass created,
+  // changed or rewired, and before deleting a node.
+  void invalidate(NodeRef node);
+
+  // How many times an operator's shape inference function ran, to check
+  // that re-inference is incremental.
+  size_t numInferredOps() const {
+    return numInferredOps_;
+  }
+
+ private:
+  TensorShape externalShape(NodeRef tensor);
+  void inferOp(NodeRef op);
+
+  Workspace* ws_ = nullptr;
+  std::unordered_map<std::string, TensorShape> hints_;
+  std::unordered_map<NodeRef, TensorShape> shapes_;
+  size_t numInferredOps_ = 0;
+};
+
+} // namespace opt
+} // namespace caffe2
+
+#endif // CAFFE2_OPT_SHAPE_INFERENCE_H_
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include "caffe2/core/workspace.h"
+#include "caffe2/opt/converter.h"
+#include "caffe2/opt/shape_inference.h"
+
+namespace caffe2 {
+namespace {
+
+TensorShape makeShape(const std::vector<TIndex>& dims) {
+  TensorShape shape;
+  shape.set_data_type(TensorProto_DataType_FLOAT);
+  for (auto d : dims) {
+    shape.add_dims(d);
+  }
+  return shape;
+}
+
+std::vector<TIndex> dimsOf(const TensorShape& shape) {
+  return std::vector<TIndex>(shape.dims().begin(), shape.dims().end());
+}
+
+void addOp(
+    NetDef* net,
+    const std::string& type,
+    const std::vector<std::string>& inputs,
+    const std::vector<std::string>& outputs) {
+  auto* op = net->add_op();
+  op->set_type(type);
+  for (const auto& input : inputs) {
+    op->add_input(input);
+  }
+  for (const auto& output : outputs) {
+    op->add_output(output);
+  }
+}
+
+} // namespace
+
+TEST(ShapeInferenceTest, Incremental) {
+  NetDef net;
+  addOp(&net, "FC", {"X", "W", "b"}, {"Y"});
+  addOp(&net, "Relu", {"Y"}, {"Z"});
+  addOp(&net, "Relu", {"S"}, {"T"});
+  for (const auto& name : {"X", "W", "b", "S"}) {
+    net.add_external_input(name);
+  }
+  std::unordered_map<std::string, nom::repr::NNGraph::NodeRef> blobs;
+  auto nn = convertToNNModule(net, &blobs);
+
+  opt::ShapeInference shapes(std::unordered_map<std::string, TensorShape>{
+      {"X", makeShape({4, 8})},
+      {"W", makeShape({16, 8})},
+      {"b", makeShape({16})},
+      {"S", makeShape({3})}});
+  EXPECT_EQ(dimsOf(shapes.getShape(blobs["Z"])), std::vector<TIndex>({4, 16}));
+  EXPECT_EQ(dimsOf(shapes.getShape(blobs["T"])), std::vector<TIndex>({3}));
+  EXPECT_EQ(shapes.numInferredOps(), 3u);
+
+  // Cached.
+  shapes.getShape(blobs["Z"]);
+  shapes.getShape(blobs["Y"]);
+  EXPECT_EQ(shapes.numInferredOps(), 3u);
+
+  // Only the FC and the Relu reading its output are inferred again.
+  shapes.setShape(blobs["X"], makeShape({2, 8}));
+  EXPECT_EQ(dimsOf(shapes.getShape(blobs["Z"])), std::vector<TIndex>({2, 16}));
+  EXPECT_EQ(dimsOf(shapes.getShape(blobs["T"])), std::vector<TIndex>({3}));
+  EXPECT_EQ(shapes.numInferredOps(), 5u);
+
+  shapes.invalidate(nom::repr::nn::getProducer(blobs["Z"]));
+  EXPECT_EQ(dimsOf(shapes.getShape(blobs["Z"])), std::vector<TIndex>({2, 16}));
+  EXPECT_EQ(shapes.numInferredOps(), 6u);
+}
+
+} // namespace caffe2
@@ -0,0 +1,41 @@
+#include "caffe2/perfkernels/adagrad.h"
+
+#include <cmath>
+
+#include "caffe2/perfkernels/common.h"
+#include "caffe2/utils/cpuid.h"
+
+namespace caffe2 {
+
+void AdagradUpdate__base(
+    int N,
+    const float* w,
+    const float* g,
+    const float* h,
+    float* nw,
+    float* nh,
+    float epsilon,
+    float decay,
+    float lr) {
+  for (int i = 0; i < N; ++i) {
+    float gi = g[i];
+    float hi = nh[i] = decay * h[i] + gi * gi;
+    nw[i] = w[i] + lr * gi / (std::sqrt(hi) + epsilon);
+  }
+}
+
+void AdagradUpdate(
+    int N,
+    const float* w,
+    const float* g,
+    const float* h,
+    float* nw,
+    float* nh,
+    float epsilon,
+    float decay,
+    float lr) {
+  AVX2_FMA_DO(AdagradUpdate, N, w, g, h, nw, nh, epsilon, decay, lr);
+  BASE_DO(AdagradUpdate, N, w, g, h, nw, nh, epsilon, decay, lr);
+}
+
+} // namespace caffe2
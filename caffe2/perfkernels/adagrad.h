@@ -0,0 +1,20 @@
+#pragma once
+
+namespace caffe2 {
+
+// The Adagrad update of N values:
+//   nh = decay * h + g^2
+//   nw = w + lr * g / (sqrt(nh) + epsilon)
+// nw and nh may alias w and h.
+void AdagradUpdate(
+    int N,
+    const float* w,
+    const float* g,
+    const float* h,
+    float* nw,
+    float* nh,
+    float epsilon,
+    float decay,
+    float lr);
+
+} // namespace caffe2
@@ -0,0 +1,39 @@
+#include "caffe2/perfkernels/adagrad.h"
+
+#include <cmath>
+
+#include <immintrin.h>
+
+namespace caffe2 {
+
+void AdagradUpdate__avx2_fma(
+    int N,
+    const float* w,
+    const float* g,
+    const float* h,
+    float* nw,
+    float* nh,
+    float epsilon,
+    float decay,
+    float lr) {
+  const __m256 vepsilon = _mm256_set1_ps(epsilon);
+  const __m256 vdecay = _mm256_set1_ps(decay);
+  const __m256 vlr = _mm256_set1_ps(lr);
+  int i = 0;
+  for (; i + 8 <= N; i += 8) {
+    const __m256 gi = _mm256_loadu_ps(g + i);
+    const __m256 hi =
+        _mm256_fmadd_ps(gi, gi, _mm256_mul_ps(vdecay, _mm256_loadu_ps(h + i)));
+    _mm256_storeu_ps(nh + i, hi);
+    const __m256 step = _mm256_div_ps(
+        _mm256_mul_ps(vlr, gi), _mm256_add_ps(_mm256_sqrt_ps(hi), vepsilon));
+    _mm256_storeu_ps(nw + i, _mm256_add_ps(_mm256_loadu_ps(w + i), step));
+  }
+  for (; i < N; ++i) {
+    float gi = g[i];
+    float hi = nh[i] = decay * h[i] + gi * gi;
+    nw[i] = w[i] + lr * gi / (std::sqrt(hi) + epsilon);
+  }
+}
+
+} // namespace caffe2
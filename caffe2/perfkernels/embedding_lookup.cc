@@ -127,6 +127,19 @@ static void EmbeddingLookupGenericSlow(
       const float* scale_bias,                                                             \
       bool normalize_by_lengths,                                                           \
       OutType* out) {                                                                      \
+    AVX512_DO(                                                                             \
+        EmbeddingLookup_##IndexType##_##InType##_##OutType##_##IS_WEIGHT_POSITIONAL,       \
+        block_size,                                                                        \
+        output_size,                                                                       \
+        index_size,                                                                        \
+        data_size,                                                                         \
+        input,                                                                             \
+        indices,                                                                           \
+        lengths,                                                                           \
+        weights,                                                                           \
+        scale_bias,                                                                        \
+        normalize_by_lengths,                                                              \
+        out);                                                                              \
     AVX2_FMA_DO(                                                                           \
         EmbeddingLookup_##IndexType##_##InType##_##OutType##_##IS_WEIGHT_POSITIONAL,       \
         block_size,                                                                        \
@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <type_traits>
+
+#include <immintrin.h>
+
+#include "caffe2/core/common.h"
+#include "caffe2/core/types.h"
+
+namespace caffe2 {
+
+namespace {
+
+// Unlike the generated AVX2 kernels, which are unrolled for a few block
+// sizes, these handle any block size: the columns are reduced in strips of
+// up to kMaxVectors vectors, kept in registers, and the last vector of a
+// strip is masked.
+constexpr int kVectorSize = 16;
+constexpr int kMaxVectors = 8;
+// In rows. Far enough ahead for the loads to arrive in time, close enough
+// for the rows to still be in L1.
+constexpr int kPrefetchDistance = 16;
+
+inline __m512 load(const float* p, __mmask16 mask) {
+  return _mm512_maskz_loadu_ps(mask, p);
+}
+
+inline __m512 load(const float16* p, __mmask16 mask) {
+  return _mm512_cvtph_ps(_mm256_maskz_loadu_epi16(mask, p));
+}
+
+inline __m512 load(const uint8_t* p, __mmask16 mask) {
+  return _mm512_cvtepi32_ps(
+      _mm512_cvtepu8_epi32(_mm_maskz_loadu_epi8(mask, p)));
+}
+
+// Reduces the columns [col, col + min(block_size - col, NUM_VECTORS * 16))
+// of every output segment.
+template <
+    int NUM_VECTORS,
+    typename IndexType,
+    typename InType,
+    bool IS_WEIGHT_POSITIONAL>
+void EmbeddingLookupStrip(
+    const TIndex block_size,
+    const TIndex col,
+    const TIndex output_size,
+    const TIndex index_size,
+    const TIndex data_size,
+    const InType* input,
+    const IndexType* indices,
+    const int* lengths,
+    const float* weights,
+    const float* scale_bias,
+    bool normalize_by_lengths,
+    float* out) {
+  constexpr bool kHasBias = std::is_same<InType, uint8_t>::value;
+  const TIndex width =
+      std::min<TIndex>(block_size - col, NUM_VECTORS * kVectorSize);
+  const int tail = width - (NUM_VECTORS - 1) * kVectorSize;
+  const __mmask16 lastMask = (1u << tail) - 1;
+  const TIndex stripBytes = width * sizeof(InType);
+
+  TIndex dataInd = 0;
+  for (TIndex rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+    __m512 vop[NUM_VECTORS];
+    for (int v = 0; v < NUM_VECTORS; ++v) {
+      vop[v] = _mm512_setzero_ps();
+    }
+    const TIndex start = dataInd;
+    const TIndex end = start + lengths[rangeIndex];
+    CAFFE_ENFORCE_LE(
+        end,
+        index_size,
+        "Your input seems to be incorrect: the sum of lengths values should "
+        "be the size of the indices tensor, but it appears not.");
+    for (; dataInd < end; ++dataInd) {
+      const TIndex idx = indices[dataInd];
+      CAFFE_ENFORCE(
+          idx >= 0 && idx < data_size,
+          "Index ",
+          dataInd,
+          " is out of bounds: ",
+          idx,
+          ", range 0 to ",
+          data_size);
+      float wgt = 1.f;
+      if (weights) {
+        wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+      }
+      float bio = 0.f;
+      if (kHasBias) {
+        bio = wgt * scale_bias[2 * idx + 1];
+        wgt = wgt * scale_bias[2 * idx];
+      }
+      const __m512 vwgt = _mm512_set1_ps(wgt);
+      const __m512 vbio = _mm512_set1_ps(bio);
+
+      // Prefetching never faults, so the index is checked when it is used.
+      if (dataInd + kPrefetchDistance < index_size) {
+        const char* next = reinterpret_cast<const char*>(
+            &input[indices[dataInd + kPrefetchDistance] * block_size + col]);
+        for (TIndex offset = 0; offset < stripBytes; offset += 64) {
+          _mm_prefetch(next + offset, _MM_HINT_T0);
+        }
+      }
+
+      const InType* ip = &input[idx * block_size + col];
+      for (int v = 0; v < NUM_VECTORS; ++v) {
+        const __mmask16 mask = v == NUM_VECTORS - 1 ? lastMask : 0xFFFF;
+        const __m512 acc = kHasBias ? _mm512_add_ps(vop[v], vbio) : vop[v];
+        vop[v] = _mm512_fmadd_ps(vwgt, load(ip + v * kVectorSize, mask), acc);
+      }
+    }
+
+    if (normalize_by_lengths && lengths[rangeIndex]) {
+      const __m512 vlen_inv = _mm512_set1_ps(1.0f / lengths[rangeIndex]);
+      for (int v = 0; v < NUM_VECTORS; ++v) {
+        vop[v] = _mm512_mul_ps(vop[v], vlen_inv);
+      }
+    }
+    float* op = &out[rangeIndex * block_size + col];
+    for (int v = 0; v < NUM_VECTORS; ++v) {
+      const __mmask16 mask = v == NUM_VECTORS - 1 ? lastMask : 0xFFFF;
+      _mm512_mask_storeu_ps(op + v * kVectorSize, mask, vop[v]);
+    }
+  }
+  CAFFE_ENFORCE_EQ(
+      dataInd,
+      index_size,
+      "Your input seems to be incorrect: the sum of lengths values should be "
+      "the size of the indices tensor, but it appears not.");
+}
+
+template <typename IndexType, typename InType, bool IS_WEIGHT_POSITIONAL>
+void EmbeddingLookupAVX512(
+    const TIndex block_size,
+    const TIndex output_size,
+    const TIndex index_size,
+    const TIndex data_size,
+    const InType* input,
+    const IndexType* indices,
+    const int* lengths,
+    const float* weights,
+    const float* scale_bias,
+    bool normalize_by_lengths,
+    float* out) {
+  if (std::is_same<InType, uint8_t>::value) {
+    CAFFE_ENFORCE(scale_bias != nullptr, "scale_bias must not be nullptr");
+  } else {
+    CAFFE_ENFORCE(scale_bias == nullptr, "scale_bias must be nullptr");
+  }
+  for (TIndex col = 0; col < block_size;
+       col += kMaxVectors * kVectorSize) {
+    const TIndex width =
+        std::min<TIndex>(block_size - col, kMaxVectors * kVectorSize);
+#define CAFFE2_EMBEDDING_LOOKUP_STRIP(n)                                       \
+  case n:                                                                      \
+    EmbeddingLookupStrip<n, IndexType, InType, IS_WEIGHT_POSITIONAL>(          \
+        block_size,                                                            \
+        col,                                                                   \
+        output_size,                                                           \
+        index_size,                                                            \
+        data_size,                                                             \
+        input,                                                                 \
+        indices,                                                               \
+        lengths,                                                               \
+        weights,                                                               \
+        scale_bias,                                                            \
+        normalize_by_lengths,                                                  \
+        out);                                                                  \
+    break;
+    switch ((width + kVectorSize - 1) / kVectorSize) {
+      CAFFE2_EMBEDDING_LOOKUP_STRIP(1)
+      CAFFE2_EMBEDDING_LOOKUP_STRIP(2)
+      CAFFE2_EMBEDDING_LOOKUP_STRIP(3)
+      CAFFE2_EMBEDDING_LOOKUP_STRIP(4)
+      CAFFE2_EMBEDDING_LOOKUP_STRIP(5)
+      CAFFE2_EMBEDDING_LOOKUP_STRIP(6)
+      CAFFE2_EMBEDDING_LOOKUP_STRIP(7)
+      CAFFE2_EMBEDDING_LOOKUP_STRIP(8)
+    }
+#undef CAFFE2_EMBEDDING_LOOKUP_STRIP
+  }
+}
+
+} // namespace
+
+#define EMBEDDING_SPECIALIZATION(                                              \
+    IndexType, InType, OutType, IS_WEIGHT_POSITIONAL)                          \
+  void                                                                         \
+      EmbeddingLookup_##IndexType##_##InType##_##OutType##_##IS_WEIGHT_POSITIONAL##__avx512( \
+          const TIndex block_size,                                             \
+          const TIndex output_size,                                            \
+          const TIndex index_size,                                             \
+          const TIndex data_size,                                              \
+          const InType* input,                                                 \
+          const IndexType* indices,                                            \
+          const int* lengths,                                                  \
+          const float* weights,                                                \
+          const float* scale_bias,                                             \
+          bool normalize_by_lengths,                                           \
+          OutType* out) {                                                      \
+    EmbeddingLookupAVX512<IndexType, InType, IS_WEIGHT_POSITIONAL>(            \
+        block_size,                                                            \
+        output_size,                                                           \
+        index_size,                                                            \
+        data_size,                                                             \
+        input,                                                                 \
+        indices,                                                               \
+        lengths,                                                               \
+        weights,                                                               \
+        scale_bias,                                                            \
+        normalize_by_lengths,                                                  \
+        out);                                                                  \
+  }
+
+EMBEDDING_SPECIALIZATION(int32_t, float, float, false);
+EMBEDDING_SPECIALIZATION(int64_t, float, float, false);
+EMBEDDING_SPECIALIZATION(int32_t, float16, float, false);
+EMBEDDING_SPECIALIZATION(int64_t, float16, float, false);
+EMBEDDING_SPECIALIZATION(int32_t, uint8_t, float, false);
+EMBEDDING_SPECIALIZATION(int64_t, uint8_t, float, false);
+
+EMBEDDING_SPECIALIZATION(int32_t, float, float, true);
+EMBEDDING_SPECIALIZATION(int64_t, float, float, true);
+EMBEDDING_SPECIALIZATION(int32_t, float16, float, true);
+EMBEDDING_SPECIALIZATION(int64_t, float16, float, true);
+EMBEDDING_SPECIALIZATION(int32_t, uint8_t, float, true);
+EMBEDDING_SPECIALIZATION(int64_t, uint8_t, float, true);
+
+#undef EMBEDDING_SPECIALIZATION
+
+} // namespace caffe2
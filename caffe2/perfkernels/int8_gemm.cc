@@ -0,0 +1,67 @@
+#include "caffe2/perfkernels/int8_gemm.h"
+
+#include <cstring>
+
+#include "caffe2/perfkernels/common.h"
+#include "caffe2/utils/cpuid.h"
+
+namespace caffe2 {
+
+void Int8GemmPackB(int N, int K, const int8_t* B, int8_t* packed) {
+  const int blocksK = (K + kInt8GemmBlockK - 1) / kInt8GemmBlockK;
+  std::memset(packed, 0, Int8GemmPackedBSize(N, K));
+  for (int n = 0; n < N; ++n) {
+    const int blockN = n / kInt8GemmBlockN;
+    const int row = n % kInt8GemmBlockN;
+    for (int k = 0; k < K; ++k) {
+      const int blockK = k / kInt8GemmBlockK;
+      packed
+          [((blockN * blocksK + blockK) * kInt8GemmBlockN + row) *
+               kInt8GemmBlockK +
+           k % kInt8GemmBlockK] = B[n * K + k];
+    }
+  }
+}
+
+void Int8GemmPackedB__base(
+    int M,
+    int N,
+    int K,
+    const uint8_t* A,
+    int lda,
+    const int8_t* packedB,
+    int32_t* C,
+    int ldc) {
+  const int blocksK = (K + kInt8GemmBlockK - 1) / kInt8GemmBlockK;
+  for (int m = 0; m < M; ++m) {
+    const uint8_t* a = A + m * lda;
+    for (int n = 0; n < N; ++n) {
+      const int8_t* b = packedB +
+          ((n / kInt8GemmBlockN) * blocksK * kInt8GemmBlockN +
+           n % kInt8GemmBlockN) *
+              kInt8GemmBlockK;
+      int32_t sum = 0;
+      for (int k = 0; k < K; ++k) {
+        sum += int32_t(a[k]) *
+            b[(k / kInt8GemmBlockK) * kInt8GemmBlockN * kInt8GemmBlockK +
+              k % kInt8GemmBlockK];
+      }
+      C[m * ldc + n] = sum;
+    }
+  }
+}
+
+void Int8GemmPackedB(
+    int M,
+    int N,
+    int K,
+    const uint8_t* A,
+    int lda,
+    const int8_t* packedB,
+    int32_t* C,
+    int ldc) {
+  AVX2_DO(Int8GemmPackedB, M, N, K, A, lda, packedB, C, ldc);
+  BASE_DO(Int8GemmPackedB, M, N, K, A, lda, packedB, C, ldc);
+}
+
+} // namespace caffe2
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace caffe2 {
+
+// The int8 GEMM works on a packed copy of B, so that the rows of B a block
+// of outputs needs are read sequentially: B is split into blocks of
+// kInt8GemmBlockN rows, and within a block the rows are interleaved every
+// kInt8GemmBlockK columns. Rows and columns are zero padded to full blocks.
+constexpr int kInt8GemmBlockN = 4;
+constexpr int kInt8GemmBlockK = 16;
+
+inline size_t Int8GemmPackedBSize(int N, int K) {
+  return static_cast<size_t>(
+             (N + kInt8GemmBlockN - 1) / kInt8GemmBlockN * kInt8GemmBlockN) *
+      ((K + kInt8GemmBlockK - 1) / kInt8GemmBlockK * kInt8GemmBlockK);
+}
+
+// Packs the row-major N x K matrix B (e.g. the weights of an FC) into
+// `packed`, which has to hold Int8GemmPackedBSize(N, K) values.
+void Int8GemmPackB(int N, int K, const int8_t* B, int8_t* packed);
+
+// C = A * B^T, i.e. C[m][n] = sum_k A[m][k] * B[n][k], for the row-major
+// M x K uint8 matrix A with leading dimension lda and B packed with
+// Int8GemmPackB. The products are accumulated exactly in int32.
+void Int8GemmPackedB(
+    int M,
+    int N,
+    int K,
+    const uint8_t* A,
+    int lda,
+    const int8_t* packedB,
+    int32_t* C,
+    int ldc);
+
+} // namespace caffe2
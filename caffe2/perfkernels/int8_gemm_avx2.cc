@@ -0,0 +1,84 @@
+#include "caffe2/perfkernels/int8_gemm.h"
+
+#include <cstring>
+
+#include <immintrin.h>
+
+namespace caffe2 {
+
+static_assert(
+    kInt8GemmBlockN == 4 && kInt8GemmBlockK == 16,
+    "The AVX2 kernel is written for blocks of 4 rows and 16 columns");
+
+void Int8GemmPackedB__avx2(
+    int M,
+    int N,
+    int K,
+    const uint8_t* A,
+    int lda,
+    const int8_t* packedB,
+    int32_t* C,
+    int ldc) {
+  const int blocksK = (K + kInt8GemmBlockK - 1) / kInt8GemmBlockK;
+  const int fullBlocksK = K / kInt8GemmBlockK;
+  alignas(16) uint8_t tail[kInt8GemmBlockK];
+  for (int m = 0; m < M; ++m) {
+    const uint8_t* a = A + m * lda;
+    // The last, partial block of the row is read from a zero padded copy,
+    // since A itself is not padded.
+    if (fullBlocksK < blocksK) {
+      std::memset(tail, 0, sizeof(tail));
+      std::memcpy(
+          tail,
+          a + fullBlocksK * kInt8GemmBlockK,
+          K - fullBlocksK * kInt8GemmBlockK);
+    }
+    for (int n = 0; n < N; n += kInt8GemmBlockN) {
+      const int8_t* b = packedB + n * blocksK * kInt8GemmBlockK;
+      __m256i acc0 = _mm256_setzero_si256();
+      __m256i acc1 = _mm256_setzero_si256();
+      __m256i acc2 = _mm256_setzero_si256();
+      __m256i acc3 = _mm256_setzero_si256();
+      for (int kb = 0; kb < blocksK; ++kb) {
+        const uint8_t* ak = kb < fullBlocksK ? a + kb * kInt8GemmBlockK : tail;
+        // Widening to 16 bits before the multiply-add keeps the sums exact,
+        // unlike _mm256_maddubs_epi16, which saturates.
+        const __m256i a16 = _mm256_cvtepu8_epi16(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(ak)));
+        const __m128i* bk = reinterpret_cast<const __m128i*>(
+            b + kb * kInt8GemmBlockN * kInt8GemmBlockK);
+        acc0 = _mm256_add_epi32(
+            acc0,
+            _mm256_madd_epi16(
+                a16, _mm256_cvtepi8_epi16(_mm_loadu_si128(bk + 0))));
+        acc1 = _mm256_add_epi32(
+            acc1,
+            _mm256_madd_epi16(
+                a16, _mm256_cvtepi8_epi16(_mm_loadu_si128(bk + 1))));
+        acc2 = _mm256_add_epi32(
+            acc2,
+            _mm256_madd_epi16(
+                a16, _mm256_cvtepi8_epi16(_mm_loadu_si128(bk + 2))));
+        acc3 = _mm256_add_epi32(
+            acc3,
+            _mm256_madd_epi16(
+                a16, _mm256_cvtepi8_epi16(_mm_loadu_si128(bk + 3))));
+      }
+      // Reduces the four accumulators to the four sums at once.
+      const __m256i sums = _mm256_hadd_epi32(
+          _mm256_hadd_epi32(acc0, acc1), _mm256_hadd_epi32(acc2, acc3));
+      const __m128i result = _mm_add_epi32(
+          _mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+      int32_t* c = C + m * ldc + n;
+      if (n + kInt8GemmBlockN <= N) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(c), result);
+      } else {
+        alignas(16) int32_t out[kInt8GemmBlockN];
+        _mm_store_si128(reinterpret_cast<__m128i*>(out), result);
+        std::memcpy(c, out, (N - n) * sizeof(int32_t));
+      }
+    }
+  }
+}
+
+} // namespace caffe2
@@ -0,0 +1,48 @@
+#include "caffe2/perfkernels/murmur_hash.h"
+
+#include "caffe2/perfkernels/common.h"
+#include "caffe2/utils/cpuid.h"
+
+namespace caffe2 {
+
+// MurmurHash3_x64_128 of an 8 byte key has no body block, only a tail of a
+// single 64 bit word, which leaves this straight line code per key. There is
+// no AVX2 version: without a 64 bit vector multiply, emulating the six
+// multiplies per key with 32 bit ones is no faster than this loop.
+void MurmurHash3Keys64__base(
+    int N,
+    const uint64_t* keys,
+    uint32_t seed,
+    uint64_t* hashes) {
+  const uint64_t c1 = 0x87c37b91114253d5ULL;
+  const uint64_t c2 = 0x4cf5ad432745937fULL;
+  auto fmix64 = [](uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+  };
+  for (int i = 0; i < N; ++i) {
+    uint64_t k1 = keys[i] * c1;
+    k1 = (k1 << 31) | (k1 >> 33);
+    k1 *= c2;
+    uint64_t h1 = (seed ^ k1) ^ 8;
+    uint64_t h2 = uint64_t(seed) ^ 8;
+    h1 += h2;
+    h2 += h1;
+    hashes[i] = fmix64(h1) + fmix64(h2);
+  }
+}
+
+void MurmurHash3Keys64(
+    int N,
+    const uint64_t* keys,
+    uint32_t seed,
+    uint64_t* hashes) {
+  AVX512_DO(MurmurHash3Keys64, N, keys, seed, hashes);
+  BASE_DO(MurmurHash3Keys64, N, keys, seed, hashes);
+}
+
+} // namespace caffe2
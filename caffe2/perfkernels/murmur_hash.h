@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+namespace caffe2 {
+
+// Hashes N 64 bit keys: hashes[i] is the low 64 bits of MurmurHash3_x64_128
+// of the 8 bytes of keys[i] (see caffe2/utils/murmur_hash3.h), so the result
+// is the same as that of the scalar version on little endian platforms.
+// hashes may alias keys.
+void MurmurHash3Keys64(
+    int N,
+    const uint64_t* keys,
+    uint32_t seed,
+    uint64_t* hashes);
+
+} // namespace caffe2
@@ -0,0 +1,47 @@
+#include "caffe2/perfkernels/murmur_hash.h"
+
+#include <immintrin.h>
+
+namespace caffe2 {
+
+void MurmurHash3Keys64__base(
+    int N,
+    const uint64_t* keys,
+    uint32_t seed,
+    uint64_t* hashes);
+
+namespace {
+
+inline __m512i fmix64(__m512i k) {
+  const __m512i m1 = _mm512_set1_epi64(0xff51afd7ed558ccdULL);
+  const __m512i m2 = _mm512_set1_epi64(0xc4ceb9fe1a85ec53ULL);
+  k = _mm512_xor_si512(k, _mm512_srli_epi64(k, 33));
+  k = _mm512_mullo_epi64(k, m1);
+  k = _mm512_xor_si512(k, _mm512_srli_epi64(k, 33));
+  k = _mm512_mullo_epi64(k, m2);
+  return _mm512_xor_si512(k, _mm512_srli_epi64(k, 33));
+}
+
+} // namespace
+
+void MurmurHash3Keys64__avx512(
+    int N,
+    const uint64_t* keys,
+    uint32_t seed,
+    uint64_t* hashes) {
+  const __m512i c1 = _mm512_set1_epi64(0x87c37b91114253d5ULL);
+  const __m512i c2 = _mm512_set1_epi64(0x4cf5ad432745937fULL);
+  const __m512i h0 = _mm512_set1_epi64(uint64_t(seed) ^ 8);
+  int i = 0;
+  for (; i + 8 <= N; i += 8) {
+    __m512i k1 = _mm512_mullo_epi64(_mm512_loadu_si512(keys + i), c1);
+    k1 = _mm512_mullo_epi64(_mm512_rol_epi64(k1, 31), c2);
+    __m512i h1 = _mm512_add_epi64(_mm512_xor_si512(h0, k1), h0);
+    __m512i h2 = _mm512_add_epi64(h0, h1);
+    _mm512_storeu_si512(
+        hashes + i, _mm512_add_epi64(fmix64(h1), fmix64(h2)));
+  }
+  MurmurHash3Keys64__base(N - i, keys + i, seed, hashes + i);
+}
+
+} // namespace caffe2
@@ -0,0 +1,240 @@
+#include "caffe2/predictor/memory_plan.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+#include "caffe2/core/allocator.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/types.h"
+
+namespace caffe2 {
+
+namespace {
+
+// Ops whose outputs share the memory of another blob instead of owning it.
+const std::unordered_set<std::string>& aliasingOps() {
+  static const std::unordered_set<std::string> ops{"Alias", "UnsafeCoalesce"};
+  return ops;
+}
+
+bool hasSubnets(const NetDef& net) {
+  for (const auto& op : net.op()) {
+    for (const auto& arg : op.arg()) {
+      if (arg.has_n() || arg.nets_size() > 0) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// The size of a shape in bytes, or -1 if it is not known.
+int64_t shapeBytes(const TensorShape& shape) {
+  if (shape.unknown_shape() ||
+      shape.data_type() == TensorProto::UNDEFINED ||
+      shape.data_type() == TensorProto::STRING) {
+    return -1;
+  }
+  int64_t nbytes = DataTypeToTypeMeta(shape.data_type()).itemsize();
+  for (auto d : shape.dims()) {
+    if (d < 0) {
+      return -1;
+    }
+    nbytes *= d;
+  }
+  return nbytes;
+}
+
+size_t alignUp(size_t nbytes) {
+  return (nbytes + gCaffe2Alignment - 1) / gCaffe2Alignment * gCaffe2Alignment;
+}
+
+bool overlap(const MemoryPlan::Allocation& a, const MemoryPlan::Allocation& b) {
+  return a.first_op <= b.last_op && b.first_op <= a.last_op;
+}
+
+} // namespace
+
+MemoryPlan planMemory(
+    const NetDef& net,
+    Workspace* ws,
+    const CaffeMap<std::string, std::vector<TIndex>>& max_input_shapes,
+    const CaffeMap<std::string, TensorProto::DataType>& input_types) {
+  CaffeMap<std::string, TensorShape> blob_desc;
+  std::unordered_set<std::string> external_inputs;
+  for (const auto& name : net.external_input()) {
+    external_inputs.insert(name);
+    TensorShape shape;
+    auto it = max_input_shapes.find(name);
+    if (it != max_input_shapes.end()) {
+      for (auto d : it->second) {
+        shape.add_dims(d);
+      }
+      auto type = input_types.find(name);
+      if (type != input_types.end()) {
+        shape.set_data_type(type->second);
+      }
+    } else {
+      auto* blob = ws->GetBlob(name);
+      CAFFE_ENFORCE(blob, "No shape given for input ", name);
+      shape = GetTensorShapeOfBlob(blob);
+    }
+    blob_desc[name] = shape;
+  }
+  // Shape inference op by op, since a blob that is written more than once
+  // needs the largest of its shapes.
+  CaffeMap<std::string, TensorShape> largest;
+  for (const auto& op : net.op()) {
+    NetDef single;
+    *single.add_op() = op;
+    InferBlobShapesAndTypes(blob_desc, {&single});
+    for (const auto& output : op.output()) {
+      auto desc = blob_desc.find(output);
+      if (desc == blob_desc.end()) {
+        continue;
+      }
+      // a blob with any unknown shape stays unknown
+      auto it = largest.find(output);
+      if (it == largest.end()) {
+        largest[output] = desc->second;
+      } else if (shapeBytes(it->second) >= 0) {
+        const auto nbytes = shapeBytes(desc->second);
+        if (nbytes < 0 || nbytes > shapeBytes(it->second)) {
+          it->second = desc->second;
+        }
+      }
+    }
+  }
+
+  // The lifetime of every blob the ops write, in op indices.
+  const bool sequential = (!net.has_type() || net.type() == "simple") &&
+      !hasSubnets(net);
+  const int num_ops = net.op_size();
+  CaffeMap<std::string, std::pair<int, int>> lifetimes;
+  std::unordered_set<std::string> aliased;
+  for (int i = 0; i < num_ops; ++i) {
+    const auto& op = net.op(i);
+    for (const auto& output : op.output()) {
+      auto it = lifetimes.find(output);
+      if (it == lifetimes.end()) {
+        lifetimes[output] = {sequential ? i : 0, sequential ? i : num_ops};
+      } else {
+        it->second.second = std::max(it->second.second, i);
+      }
+    }
+    for (const auto& input : op.input()) {
+      auto it = lifetimes.find(input);
+      if (it != lifetimes.end()) {
+        it->second.second = std::max(it->second.second, i);
+      }
+    }
+    if (aliasingOps().count(op.type())) {
+      aliased.insert(op.input().begin(), op.input().end());
+      aliased.insert(op.output().begin(), op.output().end());
+    }
+  }
+  for (const auto& name : net.external_output()) {
+    auto it = lifetimes.find(name);
+    if (it != lifetimes.end()) {
+      it->second.second = num_ops;
+    }
+  }
+
+  MemoryPlan plan;
+  for (const auto& lifetime : lifetimes) {
+    const auto& name = lifetime.first;
+    if (external_inputs.count(name)) {
+      // inputs are fed by the caller and parameters are written in place
+      continue;
+    }
+    auto desc = largest.find(name);
+    const int64_t nbytes =
+        desc == largest.end() ? -1 : shapeBytes(desc->second);
+    if (aliased.count(name) || nbytes < 0) {
+      plan.unplanned.push_back(name);
+      continue;
+    }
+    MemoryPlan::Allocation allocation;
+    allocation.meta = DataTypeToTypeMeta(desc->second.data_type());
+    allocation.dims.assign(
+        desc->second.dims().begin(), desc->second.dims().end());
+    allocation.nbytes = nbytes;
+    allocation.blob = name;
+    allocation.first_op = lifetime.second.first;
+    allocation.last_op = lifetime.second.second;
+    plan.total_nbytes += allocation.nbytes;
+    plan.allocations.push_back(std::move(allocation));
+  }
+
+  // Greedy by size: every blob goes into the lowest gap that is not used by
+  // a larger blob alive at the same time.
+  std::sort(
+      plan.allocations.begin(),
+      plan.allocations.end(),
+      [](const MemoryPlan::Allocation& a, const MemoryPlan::Allocation& b) {
+        return a.nbytes > b.nbytes;
+      });
+  for (size_t i = 0; i < plan.allocations.size(); ++i) {
+    auto& allocation = plan.allocations[i];
+    std::vector<const MemoryPlan::Allocation*> alive;
+    for (size_t j = 0; j < i; ++j) {
+      if (overlap(allocation, plan.allocations[j])) {
+        alive.push_back(&plan.allocations[j]);
+      }
+    }
+    std::sort(
+        alive.begin(),
+        alive.end(),
+        [](const MemoryPlan::Allocation* a, const MemoryPlan::Allocation* b) {
+          return a->offset < b->offset;
+        });
+    size_t offset = 0;
+    for (const auto* other : alive) {
+      if (offset + allocation.nbytes <= other->offset) {
+        break;
+      }
+      offset = std::max(offset, alignUp(other->offset + other->nbytes));
+    }
+    allocation.offset = offset;
+    plan.arena_nbytes =
+        std::max(plan.arena_nbytes, alignUp(offset + allocation.nbytes));
+  }
+  return plan;
+}
+
+MemoryArena::MemoryArena(MemoryPlan plan, Workspace* ws)
+    : plan_(std::move(plan)) {
+  if (plan_.arena_nbytes > 0) {
+    auto data_and_deleter = CPUContext::New(plan_.arena_nbytes);
+    data_.reset(data_and_deleter.first, data_and_deleter.second);
+  }
+  for (const auto& allocation : plan_.allocations) {
+    auto* blob = ws->GetBlob(allocation.blob);
+    CAFFE_ENFORCE(blob, "Planned blob ", allocation.blob, " does not exist");
+    tensors_.push_back(blob->GetMutableTensor(CPU));
+  }
+  bind();
+}
+
+MemoryArena::~MemoryArena() {
+  for (auto* tensor : tensors_) {
+    tensor->FreeMemory();
+  }
+}
+
+void MemoryArena::bind() {
+  for (size_t i = 0; i < tensors_.size(); ++i) {
+    const auto& allocation = plan_.allocations[i];
+    auto* data = static_cast<char*>(data_.get()) + allocation.offset;
+    auto* tensor = tensors_[i];
+    if (tensor->capacity_nbytes() == allocation.nbytes &&
+        tensor->meta() == allocation.meta && tensor->size() > 0 &&
+        tensor->raw_data() == data) {
+      continue;
+    }
+    tensor->Resize(allocation.dims);
+    tensor->ShareExternalPointer(data, allocation.meta, allocation.nbytes);
+  }
+}
+
+} // namespace caffe2
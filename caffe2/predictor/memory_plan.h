@@ -0,0 +1,81 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "caffe2/core/workspace.h"
+#include "caffe2/proto/caffe2.pb.h"
+
+namespace caffe2 {
+
+/**
+ * A static layout of the activations of a net in a single arena, computed
+ * ahead of time from the shapes that shape inference gives for the largest
+ * inputs. Activations that are never alive at the same time share memory,
+ * so arena_nbytes is the peak memory of the planned activations.
+ *
+ * Only the blobs written by the top-level ops of the net are planned, and
+ * only those whose shape and type (a fundamental type) can be inferred;
+ * the others are listed in `unplanned` and allocated by their ops as usual.
+ * The ops of nets other than "simple" nets may run concurrently, and those of
+ * subnets are not visited, so such nets are planned without any sharing.
+ */
+struct CAFFE2_API MemoryPlan {
+  struct Allocation {
+    std::string blob;
+    TypeMeta meta;
+    std::vector<TIndex> dims;
+    size_t offset;
+    size_t nbytes;
+    // the ops that first write and last read the blob
+    int first_op;
+    int last_op;
+  };
+
+  std::vector<Allocation> allocations;
+  std::vector<std::string> unplanned;
+  size_t arena_nbytes = 0;
+  // what the planned activations take without sharing
+  size_t total_nbytes = 0;
+};
+
+// The parameters, i.e. the external inputs of `net` that are not in
+// `max_input_shapes`, are read from `ws`. Inputs are float unless their type
+// is given in `input_types`.
+CAFFE2_API MemoryPlan planMemory(
+    const NetDef& net,
+    Workspace* ws,
+    const CaffeMap<std::string, std::vector<TIndex>>& max_input_shapes,
+    const CaffeMap<std::string, TensorProto::DataType>& input_types = {});
+
+/**
+ * Owns the arena of a MemoryPlan and points the planned tensors of a
+ * workspace at their slices of it. Ops keep writing into the slices as long
+ * as their outputs fit, so once bound a run does not allocate. An output
+ * that is larger than planned is reallocated by its op as before, and gets
+ * its slice back on the next bind().
+ */
+class CAFFE2_API MemoryArena {
+ public:
+  MemoryArena(MemoryPlan plan, Workspace* ws);
+  // Frees the memory of the planned tensors, so the workspace has to
+  // outlive the arena.
+  ~MemoryArena();
+
+  // Cheap; call it before every run.
+  void bind();
+
+  const MemoryPlan& plan() const {
+    return plan_;
+  }
+
+ private:
+  MemoryPlan plan_;
+  std::vector<TensorCPU*> tensors_;
+  std::shared_ptr<void> data_;
+
+  AT_DISABLE_COPY_AND_ASSIGN(MemoryArena);
+};
+
+} // namespace caffe2
@@ -125,6 +125,43 @@ Predictor::Predictor(
   CAFFE_ENFORCE(ws_.CreateNet(predict_net));
 }
 
+Predictor::Predictor(const PredictorConfig& config, Workspace* parent)
+    : config_(config), ws_(parent) {
+  CAFFE_ENFORCE(config_.predict_net, "The config has no predict_net");
+  // CreateBlob would return the parent's blob of the same name
+  for (const auto& name : config_.input_names) {
+    ws_.CreateLocalBlob(name)->GetMutableTensor(CPU);
+  }
+  for (const auto& op : config_.predict_net->op()) {
+    for (const auto& output : op.output()) {
+      ws_.CreateLocalBlob(output);
+    }
+  }
+  for (const auto& name : config_.predict_net->external_input()) {
+    if (!ws_.HasBlob(name)) {
+      ws_.CreateBlob(name)->GetMutableTensor(CPU);
+    }
+  }
+
+  CAFFE_ENFORCE(ws_.CreateNet(config_.predict_net));
+}
+
+const MemoryPlan& Predictor::planMemory(
+    const CaffeMap<std::string, std::vector<TIndex>>& max_input_shapes,
+    const CaffeMap<std::string, TensorProto::DataType>& input_types) {
+  arena_.reset();
+  arena_ = caffe2::make_unique<MemoryArena>(
+      caffe2::planMemory(
+          *config_.predict_net, &ws_, max_input_shapes, input_types),
+      &ws_);
+  const auto& plan = arena_->plan();
+  LOG(INFO) << "Planned " << plan.allocations.size() << " activations of "
+            << config_.predict_net->name() << " into " << plan.arena_nbytes
+            << " bytes (" << plan.total_nbytes << " without sharing), "
+            << plan.unplanned.size() << " left to their ops";
+  return plan;
+}
+
 bool Predictor::run(const TensorVector& inputs, TensorVector* outputs) {
   CAFFE_ENFORCE(
       inputs.size() <=
@@ -133,6 +170,9 @@ bool Predictor::run(const TensorVector& inputs, TensorVector* outputs) {
     shareInputTensor(&ws_, config_.predict_net->external_input(i), inputs[i]);
   }
 
+  if (arena_) {
+    arena_->bind();
+  }
   if (!ws_.RunNet(config_.predict_net->name())) {
     return false;
   }
@@ -160,6 +200,9 @@ bool Predictor::run_map_workspace(const TensorMap& inputs) {
     shareInputTensor(&ws_, input.first, input.second);
   }
 
+  if (arena_) {
+    arena_->bind();
+  }
   return ws_.RunNet(config_.predict_net->name());
 }
 
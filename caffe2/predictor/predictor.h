@@ -3,6 +3,7 @@
 #include <unordered_set>
 #include "caffe2/core/net.h"
 #include "caffe2/core/tensor.h"
+#include "caffe2/predictor/memory_plan.h"
 #include "caffe2/predictor/predictor_config.h"
 #include "caffe2/proto/metanet.pb.h"
 #include "caffe2/proto/predictor_consts.pb.h"
@@ -30,6 +31,12 @@ class CAFFE2_API Predictor {
       bool run_init = true,
       int optimization = 1);
 
+  // Runs `config.predict_net` in a child workspace of `parent`, which has to
+  // hold the parameters already. The inputs and every blob the net writes
+  // are created in the child workspace, so several predictors can run
+  // concurrently on one parent without copying the parameters.
+  Predictor(const PredictorConfig& config, Workspace* parent);
+
   ~Predictor() {}
 
   // Executes `run_net` on the inputs.
@@ -52,6 +59,13 @@ class CAFFE2_API Predictor {
   // string name to tensor.
   bool run_map_outputs(const TensorMap& inputs, TensorMap* outputs);
 
+  // Lays out the activations of run_net in a single arena for inputs up to
+  // `max_input_shapes` (see MemoryPlan), so that later runs with inputs no
+  // larger than these don't allocate. The plan reports the peak memory.
+  const MemoryPlan& planMemory(
+      const CaffeMap<std::string, std::vector<TIndex>>& max_input_shapes,
+      const CaffeMap<std::string, TensorProto::DataType>& input_types = {});
+
   const NetDef& def() const {
     return *config_.predict_net;
   };
@@ -72,5 +86,6 @@ class CAFFE2_API Predictor {
   bool run_map_workspace(const TensorMap& inputs);
   PredictorConfig config_;
   Workspace ws_;
+  std::unique_ptr<MemoryArena> arena_;
 };
 }
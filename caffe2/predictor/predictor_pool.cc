@@ -0,0 +1,270 @@
+#include "caffe2/predictor/predictor_pool.h"
+
+#include <algorithm>
+
+namespace caffe2 {
+
+namespace {
+
+bool canMerge(
+    const Predictor::TensorVector& a,
+    const Predictor::TensorVector& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a[i]->meta() != b[i]->meta() || a[i]->ndim() != b[i]->ndim() ||
+        !std::equal(
+            a[i]->dims().begin() + 1,
+            a[i]->dims().end(),
+            b[i]->dims().begin() + 1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void copyRows(
+    const TensorCPU& src,
+    TIndex first,
+    TIndex count,
+    TensorCPU* dst,
+    TIndex dst_first) {
+  CPUContext context;
+  const auto row_items = src.size_from_dim(1);
+  context.CopyItems<CPUContext, CPUContext>(
+      src.meta(),
+      count * row_items,
+      static_cast<const char*>(src.raw_data()) +
+          first * row_items * src.itemsize(),
+      static_cast<char*>(dst->raw_mutable_data(src.meta())) +
+          dst_first * row_items * src.itemsize());
+}
+
+} // namespace
+
+PredictorPool::PredictorPool(
+    const NetDef& init_net,
+    const NetDef& run_net,
+    const std::vector<std::string>& input_names,
+    const Options& options)
+    : options_(options) {
+  CAFFE_ENFORCE_GE(options_.max_batch_size, 0);
+  CAFFE_ENFORCE(ws_.RunNetOnce(init_net));
+
+  config_.predict_net = std::make_shared<NetDef>(run_net);
+  config_.input_names = input_names;
+  if (config_.input_names.empty()) {
+    for (const auto& name : run_net.external_input()) {
+      if (!ws_.HasBlob(name)) {
+        config_.input_names.push_back(name);
+      }
+    }
+  }
+  for (const auto& name : run_net.external_input()) {
+    if (std::find(
+            config_.input_names.begin(), config_.input_names.end(), name) ==
+        config_.input_names.end()) {
+      CAFFE_ENFORCE(
+          ws_.HasBlob(name), "Parameter ", name, " is not set by init_net");
+      config_.parameter_names.push_back(name);
+    }
+  }
+  for (const auto& name : run_net.external_output()) {
+    config_.output_names.push_back(name);
+  }
+
+  if (options_.max_batch_size > 0) {
+    CAFFE_ENFORCE_GT(options_.num_batch_threads, 0);
+    for (int i = 0; i < options_.num_batch_threads; ++i) {
+      batch_threads_.emplace_back(&PredictorPool::batchLoop, this);
+    }
+  }
+}
+
+PredictorPool::~PredictorPool() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    stopping_ = true;
+  }
+  queue_cv_.notify_all();
+  for (auto& thread : batch_threads_) {
+    thread.join();
+  }
+}
+
+bool PredictorPool::run(const TensorVector& inputs, OutputVector* outputs) {
+  CAFFE_ENFORCE(outputs);
+  if (options_.max_batch_size == 0) {
+    return runDirect(inputs, outputs);
+  }
+
+  CAFFE_ENFORCE(!inputs.empty(), "Batching needs at least one input");
+  Request request;
+  request.inputs = &inputs;
+  request.outputs = outputs;
+  for (const auto* input : inputs) {
+    CAFFE_ENFORCE_GE(input->ndim(), 1, "Batched inputs need a batch dim");
+  }
+  request.rows = inputs[0]->dim(0);
+  for (const auto* input : inputs) {
+    CAFFE_ENFORCE_EQ(
+        input->dim(0),
+        request.rows,
+        "All inputs of a request need the same batch size");
+  }
+  request.arrival = std::chrono::steady_clock::now();
+  auto done = request.done.get_future();
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    queue_.push_back(&request);
+    queued_rows_ += request.rows;
+  }
+  queue_cv_.notify_all();
+  return done.get();
+}
+
+std::unique_ptr<Predictor> PredictorPool::acquire() {
+  {
+    std::lock_guard<std::mutex> lock(predictors_mutex_);
+    if (!idle_predictors_.empty()) {
+      auto predictor = std::move(idle_predictors_.back());
+      idle_predictors_.pop_back();
+      return predictor;
+    }
+  }
+  return caffe2::make_unique<Predictor>(config_, &ws_);
+}
+
+void PredictorPool::release(std::unique_ptr<Predictor> predictor) {
+  std::lock_guard<std::mutex> lock(predictors_mutex_);
+  idle_predictors_.push_back(std::move(predictor));
+}
+
+bool PredictorPool::runDirect(
+    const TensorVector& inputs,
+    OutputVector* outputs) {
+  CAFFE_ENFORCE_EQ(inputs.size(), config_.input_names.size());
+  Predictor::TensorMap input_map;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    input_map[config_.input_names[i]] = inputs[i];
+  }
+
+  // If the run throws the predictor is dropped rather than reused.
+  auto predictor = acquire();
+  TensorVector results;
+  if (!predictor->run_map(input_map, &results)) {
+    release(std::move(predictor));
+    return false;
+  }
+  outputs->clear();
+  outputs->reserve(results.size());
+  for (const auto* result : results) {
+    outputs->push_back(result->Clone());
+  }
+  release(std::move(predictor));
+  return true;
+}
+
+void PredictorPool::batchLoop() {
+  for (;;) {
+    std::vector<Request*> batch;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      queue_cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      const auto deadline = queue_.front()->arrival + options_.max_latency;
+      queue_cv_.wait_until(lock, deadline, [this] {
+        return stopping_ || queue_.empty() ||
+            queued_rows_ >= options_.max_batch_size;
+      });
+      if (queue_.empty()) {
+        // another batching thread took the requests
+        continue;
+      }
+      batch = takeBatch();
+    }
+    runBatch(batch);
+  }
+}
+
+std::vector<PredictorPool::Request*> PredictorPool::takeBatch() {
+  std::vector<Request*> batch{queue_.front()};
+  queue_.pop_front();
+  TIndex rows = batch[0]->rows;
+  while (!queue_.empty() &&
+         rows + queue_.front()->rows <= options_.max_batch_size &&
+         canMerge(*batch[0]->inputs, *queue_.front()->inputs)) {
+    rows += queue_.front()->rows;
+    batch.push_back(queue_.front());
+    queue_.pop_front();
+  }
+  queued_rows_ -= rows;
+  return batch;
+}
+
+void PredictorPool::runBatch(const std::vector<Request*>& batch) {
+  std::vector<OutputVector> split(batch.size());
+  bool success = false;
+  try {
+    if (batch.size() == 1) {
+      success = runDirect(*batch[0]->inputs, &split[0]);
+    } else {
+      TIndex rows = 0;
+      for (const auto* request : batch) {
+        rows += request->rows;
+      }
+
+      const auto& first = *batch[0]->inputs;
+      std::vector<TensorCPU> merged;
+      merged.reserve(first.size());
+      TensorVector merged_ptrs;
+      for (size_t i = 0; i < first.size(); ++i) {
+        auto dims = first[i]->dims();
+        dims[0] = rows;
+        merged.emplace_back(dims, CPU);
+        TIndex offset = 0;
+        for (const auto* request : batch) {
+          copyRows(
+              *(*request->inputs)[i], 0, request->rows, &merged[i], offset);
+          offset += request->rows;
+        }
+        merged_ptrs.push_back(&merged[i]);
+      }
+
+      OutputVector outputs;
+      success = runDirect(merged_ptrs, &outputs);
+      for (size_t i = 0; success && i < outputs.size(); ++i) {
+        CAFFE_ENFORCE(
+            outputs[i].ndim() > 0 && outputs[i].dim(0) == rows,
+            "Output ",
+            config_.output_names[i],
+            " does not have one row per input row and can't be batched");
+        TIndex offset = 0;
+        for (size_t r = 0; r < batch.size(); ++r) {
+          auto dims = outputs[i].dims();
+          dims[0] = batch[r]->rows;
+          split[r].emplace_back(dims, CPU);
+          copyRows(outputs[i], offset, batch[r]->rows, &split[r].back(), 0);
+          offset += batch[r]->rows;
+        }
+      }
+    }
+  } catch (...) {
+    for (auto* request : batch) {
+      request->done.set_exception(std::current_exception());
+    }
+    return;
+  }
+
+  for (size_t r = 0; r < batch.size(); ++r) {
+    if (success) {
+      *batch[r]->outputs = std::move(split[r]);
+    }
+    batch[r]->done.set_value(success);
+  }
+}
+
+} // namespace caffe2
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "caffe2/predictor/predictor.h"
+
+namespace caffe2 {
+
+/**
+ * Runs a model from many threads at once. The `init_net` is run once into a
+ * parent workspace that holds the parameters, and every concurrent request
+ * gets a Predictor with its own child workspace for the inputs and
+ * activations, so the parameters are shared read-only instead of being
+ * copied per thread. The predictors are reused across requests; the pool
+ * grows to the largest number of requests that ran at the same time.
+ *
+ * With max_batch_size > 0, requests are not run on the calling thread but
+ * merged by num_batch_threads batching threads: a batch is closed when it
+ * has max_batch_size rows, or max_latency after its first request arrived,
+ * whichever comes first. The inputs of the merged requests are concatenated
+ * along the first dimension, and every output of the net has to have one
+ * row per input row so it can be split back. Requests whose inputs differ
+ * in type or in the shape of a row go into different batches.
+ */
+class CAFFE2_API PredictorPool {
+ public:
+  using TensorVector = Predictor::TensorVector;
+  using OutputVector = std::vector<TensorCPU>;
+
+  struct Options {
+    // 0 runs every request on its own, on the calling thread
+    int max_batch_size = 0;
+    std::chrono::microseconds max_latency{1000};
+    int num_batch_threads = 1;
+  };
+
+  // `input_names` are the external inputs of `run_net` fed by `run`, in
+  // order; by default all of those that `init_net` does not produce.
+  PredictorPool(
+      const NetDef& init_net,
+      const NetDef& run_net,
+      const std::vector<std::string>& input_names = {},
+      const Options& options = Options());
+  ~PredictorPool();
+
+  // Thread safe. Like Predictor::run, but `outputs` receives copies of the
+  // output tensors, since the predictor is reused by other requests.
+  bool run(const TensorVector& inputs, OutputVector* outputs);
+
+  Workspace* ws() {
+    return &ws_;
+  }
+
+  const std::vector<std::string>& input_names() const {
+    return config_.input_names;
+  }
+
+ private:
+  struct Request {
+    const TensorVector* inputs;
+    OutputVector* outputs;
+    TIndex rows;
+    std::chrono::steady_clock::time_point arrival;
+    std::promise<bool> done;
+  };
+
+  std::unique_ptr<Predictor> acquire();
+  void release(std::unique_ptr<Predictor> predictor);
+  bool runDirect(const TensorVector& inputs, OutputVector* outputs);
+
+  void batchLoop();
+  // Pops the longest prefix of the queue that can be merged with its head.
+  std::vector<Request*> takeBatch();
+  void runBatch(const std::vector<Request*>& batch);
+
+  Options options_;
+  Workspace ws_;
+  PredictorConfig config_;
+
+  std::mutex predictors_mutex_;
+  std::vector<std::unique_ptr<Predictor>> idle_predictors_;
+
+  std::mutex queue_mutex_;
+  std::condition_variable queue_cv_;
+  std::deque<Request*> queue_;
+  TIndex queued_rows_{0};
+  bool stopping_{false};
+  std::vector<std::thread> batch_threads_;
+
+  AT_DISABLE_COPY_AND_ASSIGN(PredictorPool);
+};
+
+} // namespace caffe2
@@ -2,10 +2,13 @@
 #include "caffe2/core/operator.h"
 #include "caffe2/core/tensor.h"
 #include "caffe2/predictor/predictor.h"
+#include "caffe2/predictor/predictor_pool.h"
 #include "caffe2/utils/math.h"
 
 #include <gtest/gtest.h>
 
+#include <thread>
+
 namespace caffe2 {
 
 namespace {
@@ -224,4 +227,71 @@ TEST_F(PredictorMetaNetDefTest, SimpleMetaNetDefInitializer) {
   EXPECT_TRUE(output.front()->dim(1) == 10);
   EXPECT_NEAR(output.front()->data<float>()[4], 0.1209, 1E-4);
 }
+TEST_F(PredictorTest, PlannedMemory) {
+  const auto& plan = p_->planMemory({{"data", {4, 4}}});
+  ASSERT_EQ(plan.allocations.size(), 1);
+  EXPECT_EQ(plan.allocations[0].blob, "y");
+  EXPECT_EQ(plan.arena_nbytes, 4 * 10 * sizeof(float));
+  EXPECT_TRUE(plan.unplanned.empty());
+
+  const void* arena = nullptr;
+  for (int batch : {1, 4, 2}) {
+    auto inputData = randomTensor({batch, 4}, ctx_.get());
+    Predictor::TensorVector input{inputData->GetMutableTensor(CPU)};
+    Predictor::TensorVector output;
+    p_->run(input, &output);
+    EXPECT_EQ(output.front()->dim(0), batch);
+    if (!arena) {
+      arena = output.front()->raw_data();
+    }
+    EXPECT_EQ(output.front()->raw_data(), arena);
+  }
+}
+
+TEST(PredictorPoolTest, ConcurrentRunsMatchPredictor) {
+  DeviceOption op;
+  op.set_random_seed(1701);
+  CPUContext ctx(op);
+  Predictor reference(parseNetDef(initSpec), parseNetDef(predictSpec));
+  std::vector<std::unique_ptr<Blob>> inputs;
+  for (int i = 0; i < 8; ++i) {
+    inputs.push_back(randomTensor({i % 3 + 1, 4}, &ctx));
+  }
+
+  for (int max_batch_size : {0, 4}) {
+    PredictorPool::Options options;
+    options.max_batch_size = max_batch_size;
+    options.max_latency = std::chrono::milliseconds(10);
+    PredictorPool pool(
+        parseNetDef(initSpec), parseNetDef(predictSpec), {}, options);
+    EXPECT_EQ(pool.input_names(), std::vector<std::string>{"data"});
+
+    std::vector<PredictorPool::OutputVector> outputs(inputs.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      threads.emplace_back([&, i]() {
+        PredictorPool::TensorVector input{inputs[i]->GetMutableTensor(CPU)};
+        EXPECT_TRUE(pool.run(input, &outputs[i]));
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      Predictor::TensorVector input{inputs[i]->GetMutableTensor(CPU)};
+      Predictor::TensorVector expected;
+      reference.run(input, &expected);
+      ASSERT_EQ(outputs[i].size(), 1);
+      ASSERT_EQ(outputs[i][0].dims(), expected[0]->dims());
+      for (int j = 0; j < expected[0]->size(); ++j) {
+        EXPECT_NEAR(
+            outputs[i][0].data<float>()[j],
+            expected[0]->data<float>()[j],
+            1E-5);
+      }
+    }
+  }
+}
+
 } // namespace caffe2
@@ -1189,6 +1189,27 @@ class TestOperators(hu.HypothesisTestCase):
         t = time.time() - t
         self.assertGreater(t, 0.19)
 
+    def test_safe_dequeue_blobs_many(self):
+        self.ws.run(core.CreateOperator(
+            "CreateBlobsQueue", [], ["queue"], capacity=5, num_blobs=1))
+        xs = [np.random.rand(i + 1, 3).astype(np.float32) for i in range(3)]
+        for x in xs:
+            self.ws.create_blob("x").feed(x)
+            self.ws.run(core.CreateOperator(
+                "EnqueueBlobs", ["queue", "x"], ["x"]))
+        self.ws.run(core.CreateOperator("CloseBlobsQueue", ["queue"], []))
+
+        # asks for more records than there are, gets all that are left
+        op = core.CreateOperator(
+            "SafeDequeueBlobs", ["queue"], ["y", "status"], num_records=4)
+        self.ws.run(op)
+        np.testing.assert_array_equal(
+            self.ws.blobs["y"].fetch(), np.vstack(xs))
+        self.assertFalse(self.ws.blobs["status"].fetch())
+
+        self.ws.run(op)
+        self.assertTrue(self.ws.blobs["status"].fetch())
+
     @given(num_threads=st.integers(1, 10),  # noqa
            num_elements=st.integers(1, 100),
            capacity=st.integers(1, 5),
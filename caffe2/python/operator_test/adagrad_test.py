@@ -259,3 +259,54 @@ class TestAdagrad(hu.HypothesisTestCase):
             gc, op,
             [param, momentum, indices, grad, lr],
             ref_row_wise_sparse)
+
+    @given(num_rows=st.integers(1, 20),
+           block_size=st.sampled_from([1, 5, 8, 37]),
+           num_segments=st.integers(0, 10),
+           row_wise=st.booleans(),
+           lr=st.floats(min_value=0.01, max_value=0.99,
+                        allow_nan=False, allow_infinity=False),
+           epsilon=st.floats(min_value=0.01, max_value=0.99,
+                             allow_nan=False, allow_infinity=False),
+           **hu.gcs_cpu_only)
+    def test_sparse_adagrad_fused_with_sparse_lengths_sum_gradient(
+            self, num_rows, block_size, num_segments, row_wise, lr, epsilon,
+            gc, dc):
+        param = np.random.rand(num_rows, block_size).astype(np.float32)
+        if row_wise:
+            momentum = np.random.rand(num_rows).astype(np.float32)
+        else:
+            momentum = np.random.rand(num_rows, block_size).astype(np.float32)
+        lengths = np.random.randint(0, 5, size=num_segments).astype(np.int32)
+        # Indices may repeat, within a segment and across segments.
+        indices = np.random.randint(
+            0, num_rows, size=lengths.sum()).astype(np.int64)
+        grad = (np.random.rand(num_segments, block_size).astype(np.float32) -
+                0.5)
+        lr = np.array([lr], dtype=np.float32)
+
+        op = core.CreateOperator(
+            "RowWiseSparseAdagradFusedWithSparseLengthsSumGradient"
+            if row_wise else "SparseAdagradFusedWithSparseLengthsSumGradient",
+            ["param", "momentum", "indices", "grad", "lr", "lengths"],
+            ["param", "momentum"],
+            epsilon=epsilon,
+            device_option=gc)
+
+        # SparseLengthsSumGradient followed by (RowWise)SparseAdagrad, which
+        # update repeated rows once per occurrence.
+        def ref_fused(param, momentum, indices, grad, lr, lengths):
+            param_out = np.copy(param)
+            momentum_out = np.copy(momentum)
+            segments = np.repeat(np.arange(len(lengths)), lengths)
+            for index, segment in zip(indices, segments):
+                update = self.ref_row_wise_adagrad if row_wise else ref_adagrad
+                param_out[index], momentum_out[index] = update(
+                    param_out[index], momentum_out[index], grad[segment],
+                    lr, epsilon)
+            return (param_out, momentum_out)
+
+        self.assertReferenceChecks(
+            gc, op,
+            [param, momentum, indices, grad, lr, lengths],
+            ref_fused)
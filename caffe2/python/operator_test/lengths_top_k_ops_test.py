@@ -12,7 +12,7 @@ import numpy as np
 class TestLengthsTopKOps(hu.HypothesisTestCase):
     @given(N=st.integers(min_value=0, max_value=10),
            K=st.integers(min_value=1, max_value=10),
-           **hu.gcs_cpu_only)
+           **hu.gcs)
     def test_lengths_top_k_op(self, N, K, gc, dc):
         lens = np.random.randint(low=1, high=2 * K + 1, size=N).astype(np.int32)
         X = []
@@ -43,7 +43,7 @@ class TestLengthsTopKOps(hu.HypothesisTestCase):
 
     @given(N=st.integers(min_value=0, max_value=10),
            K=st.integers(min_value=1, max_value=10),
-           **hu.gcs_cpu_only)
+           **hu.gcs)
     def test_lengths_top_k_empty_op(self, N, K, gc, dc):
         lens = np.zeros((N, ), dtype=np.int32)
         X = np.array([], dtype=np.float32)
@@ -56,3 +56,26 @@ class TestLengthsTopKOps(hu.HypothesisTestCase):
         self.assertDeviceChecks(dc, op, [X, lens], [0, 1])
         self.assertReferenceChecks(gc, op, [X, lens], lengths_top_k)
         self.assertGradientChecks(gc, op, [X, lens], 0, [0])
+
+    @given(N=st.integers(min_value=1, max_value=4),
+           K=st.integers(min_value=1, max_value=300),
+           **hu.gcs)
+    def test_lengths_top_k_long_segments_op(self, N, K, gc, dc):
+        # Segments longer than a warp can handle take a different path on GPU
+        lens = np.random.randint(low=100, high=600, size=N).astype(np.int32)
+        X = np.random.permutation(lens.sum()).astype(np.float32)
+        op = core.CreateOperator("LengthsTopK", ["X", "Y"], ["values", "indices"], k=K)
+
+        def lengths_top_k(X, lens):
+            values = np.zeros((N, K), dtype=np.float32)
+            indices = -1 * np.ones((N, K), dtype=np.int32)
+            si = 0
+            for i in range(N):
+                cur_indices = X[si:si + lens[i]].argsort()[::-1][:K]
+                values[i, :len(cur_indices)] = X[si:si + lens[i]][cur_indices]
+                indices[i, :len(cur_indices)] = cur_indices
+                si += lens[i]
+            return (values, indices)
+
+        self.assertDeviceChecks(dc, op, [X, lens], [0, 1])
+        self.assertReferenceChecks(gc, op, [X, lens], lengths_top_k)
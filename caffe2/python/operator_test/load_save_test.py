@@ -455,6 +455,57 @@ class TestLoadSave(TestLoadSaveBase):
             if e.errno != errno.ENOENT:
                 raise
 
+    def testAsyncCheckpoint(self):
+        tmp_folder = tempfile.mkdtemp()
+        workspace.ResetWorkspace()
+        # Large enough to be serialized in several chunks.
+        x = np.random.rand(2500000).astype(np.float32)
+        y = np.random.rand(2, 3).astype(np.float32)
+        workspace.FeedBlob("x", x)
+        workspace.FeedBlob("y", y)
+        workspace.FeedBlob("iter", np.array([1], dtype=np.int64))
+
+        net = core.Net("async_checkpoint")
+        net.AsyncCheckpoint(
+            ["iter", "x", "y"], [],
+            absolute_path=1,
+            db=os.path.join(tmp_folder, "checkpoint_%d"),
+            db_type=self._db_type)
+        workspace.CreateNet(net)
+        workspace.RunNet(net.Name())
+
+        # Only y and the iteration are written after the first checkpoint.
+        y_new = y + 1
+        workspace.FeedBlob("y", y_new)
+        workspace.FeedBlob("iter", np.array([2], dtype=np.int64))
+        workspace.RunNet(net.Name())
+        # Waits for the last checkpoint to be written.
+        workspace.ResetWorkspace()
+
+        workspace.RunOperatorOnce(core.CreateOperator(
+            "Load", [], [],
+            absolute_path=1,
+            db=os.path.join(tmp_folder, "checkpoint_2"),
+            db_type=self._db_type,
+            load_all=True))
+        self.assertEqual(sorted(workspace.Blobs()), ["iter", "y"])
+
+        for i in [1, 2]:
+            workspace.RunOperatorOnce(core.CreateOperator(
+                "Load", [], [],
+                absolute_path=1,
+                db=os.path.join(tmp_folder, "checkpoint_{}".format(i)),
+                db_type=self._db_type,
+                load_all=True))
+        np.testing.assert_array_equal(workspace.FetchBlob("x"), x)
+        np.testing.assert_array_equal(workspace.FetchBlob("y"), y_new)
+        np.testing.assert_array_equal(workspace.FetchBlob("iter"), [2])
+        try:
+            shutil.rmtree(tmp_folder)
+        except OSError as e:
+            if e.errno != errno.ENOENT:
+                raise
+
 
 if __name__ == '__main__':
     unittest.main()
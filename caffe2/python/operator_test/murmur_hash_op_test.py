@@ -0,0 +1,91 @@
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+from caffe2.python import core, workspace
+from hypothesis import given
+import caffe2.python.hypothesis_test_util as hu
+import hypothesis.strategies as st
+import numpy as np
+
+MASK = (1 << 64) - 1
+
+
+def fmix64(k):
+    k ^= k >> 33
+    k = (k * 0xff51afd7ed558ccd) & MASK
+    k ^= k >> 33
+    k = (k * 0xc4ceb9fe1a85ec53) & MASK
+    k ^= k >> 33
+    return k
+
+
+def murmur_hash(key, seed):
+    # The low 64 bits of MurmurHash3_x64_128 of the 8 bytes of key
+    k1 = (int(key) & MASK) * 0x87c37b91114253d5 & MASK
+    k1 = ((k1 << 31) | (k1 >> 33)) & MASK
+    k1 = k1 * 0x4cf5ad432745937f & MASK
+    h1 = seed ^ k1 ^ 8
+    h2 = seed ^ 8
+    h1 = (h1 + h2) & MASK
+    h2 = (h2 + h1) & MASK
+    return (fmix64(h1) + fmix64(h2)) & MASK
+
+
+class TestMurmurHashOp(hu.HypothesisTestCase):
+    @given(
+        indices=st.sampled_from([
+            np.int32, np.int64
+        ]).flatmap(lambda dtype: hu.tensor(min_dim=1, max_dim=2, dtype=dtype)),
+        seeds=st.lists(st.integers(min_value=0, max_value=2**32 - 1),
+                       min_size=1, max_size=3),
+        modulo=st.sampled_from([0, 1, 1000, 2**62 + 1]),
+        **hu.gcs_cpu_only
+    )
+    def test_murmur_hash(self, indices, seeds, modulo, gc, dc):
+        op = core.CreateOperator("MurmurHash",
+                                 ["indices"], ["hashed_indices"],
+                                 seeds=seeds, modulo=modulo)
+
+        def ref(indices):
+            hashed = np.zeros(indices.shape + (len(seeds),), dtype=np.uint64)
+            for idx in np.ndindex(indices.shape):
+                for s, seed in enumerate(seeds):
+                    h = murmur_hash(indices[idx], seed)
+                    hashed[idx + (s,)] = h % modulo if modulo > 0 else h
+            if len(seeds) == 1:
+                hashed = hashed.reshape(indices.shape)
+            return [hashed.view(np.int64)]
+
+        self.assertDeviceChecks(dc, op, [indices], [0])
+        self.assertReferenceChecks(gc, op, [indices], ref)
+
+    def test_int32_and_int64_hash_the_same(self):
+        ids = np.array([-3, 0, 7, 2**31 - 1], dtype=np.int64)
+        outputs = []
+        for dtype in [np.int32, np.int64]:
+            workspace.FeedBlob("ids", ids.astype(dtype))
+            workspace.RunOperatorOnce(core.CreateOperator(
+                "MurmurHash", ["ids"], ["hashed"], seeds=[1, 2]))
+            outputs.append(workspace.FetchBlob("hashed"))
+        np.testing.assert_array_equal(outputs[0], outputs[1])
+        self.assertEqual(outputs[0].shape, (4, 2))
+
+    def test_shape_and_type_inference(self):
+        with hu.temp_workspace("shape_type_inf_murmur_hash"):
+            net = core.Net('test_net')
+            net.ConstantFill(
+                [], "values", shape=[2, 32], dtype=core.DataType.INT32,
+            )
+            net.MurmurHash(['values'], ['one_seed'])
+            net.MurmurHash(['values'], ['three_seeds'], seeds=[1, 2, 3])
+            (shapes, types) = workspace.InferShapesAndTypes([net], {})
+
+            self.assertEqual(shapes["one_seed"], [2, 32])
+            self.assertEqual(shapes["three_seeds"], [2, 32, 3])
+            self.assertEqual(types["three_seeds"], core.DataType.INT64)
+
+
+if __name__ == "__main__":
+    import unittest
+    unittest.main()
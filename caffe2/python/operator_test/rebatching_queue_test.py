@@ -77,6 +77,39 @@ class TestReBatchingQueue(TestCase):
             workspace.FetchBlob(results[1]), workspace.FetchBlob("tensors")[5:]
         )
 
+    def test_rebatching_queue_bucketed(self):
+        net = core.Net('net')
+        # sequences of length 1, 4, 2, 5 and 3; buckets [0, 3) and [3, inf)
+        sequences = [
+            np.arange(length * 2, dtype=np.float32).reshape(length, 2) + 1
+            for length in [1, 4, 2, 5, 3]
+        ]
+        queue = net.CreateRebatchingQueue(
+            [], 1, capacity=10, num_blobs=1, bucket_boundaries=[3])
+        for idx, sequence in enumerate(sequences):
+            workspace.FeedBlob("sequence_{}".format(idx), sequence)
+            net.EnqueueRebatchingQueue([queue, "sequence_{}".format(idx)], [])
+        net.CloseRebatchingQueue([queue], 0)
+
+        # the long bucket fills up first, then the rest of the short one
+        results = [
+            net.DequeueRebatchingQueue([queue], 2, num_elements=3),
+            net.DequeueRebatchingQueue([queue], 2, num_elements=3),
+        ]
+
+        workspace.RunNetOnce(net)
+
+        for result, indices in zip(results, [[1, 3, 4], [0, 2]]):
+            data = workspace.FetchBlob(result[0])
+            lengths = workspace.FetchBlob(result[1])
+            npt.assert_array_equal(
+                lengths, [sequences[i].shape[0] for i in indices])
+            self.assertEqual(data.shape, (len(indices), max(lengths), 2))
+            for row, i in enumerate(indices):
+                npt.assert_array_equal(
+                    data[row, :lengths[row]], sequences[i])
+                self.assertTrue((data[row, lengths[row]:] == 0).all())
+
     def test_rebatching_queue_closes_properly(self):
         net = core.Net('net')
         workspace.FeedBlob(
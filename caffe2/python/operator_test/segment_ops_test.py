@@ -384,6 +384,25 @@ class TestSegmentOps(hu.HypothesisTestCase):
         op = core.CreateOperator("UnsortedSegmentSum", ["X", "segments"], "out")
         self.assertDeviceChecks(dc, op, [X, segments], [0])
 
+    @unittest.skipIf(not workspace.has_gpu_support, "No gpu support")
+    @given(op_name=st.sampled_from(["LengthsSum", "LengthsMean"]),
+           post=st.sampled_from([1, 16, 300]),
+           **hu.gcs)
+    def test_lengths_reductions_skewed(self, op_name, post, gc, dc):
+        # A few segments spanning many blocks among lots of tiny and empty
+        # ones.
+        lengths = np.random.choice(
+            [0, 1, 2, 3], size=2000, p=[0.2, 0.4, 0.2, 0.2]).astype(np.int32)
+        lengths[np.random.choice(2000, size=3, replace=False)] = 5000
+        X = np.random.rand(lengths.sum(), post).astype(np.float32)
+        indices = np.random.randint(
+            0, X.shape[0], size=lengths.sum()).astype(np.int32)
+        op = core.CreateOperator(op_name, ["X", "lengths"], "out")
+        self.assertDeviceChecks(dc, op, [X, lengths], [0])
+        op = core.CreateOperator(
+            "Sparse" + op_name, ["X", "indices", "lengths"], "out")
+        self.assertDeviceChecks(dc, op, [X, indices, lengths], [0])
+
     @unittest.skipIf(not workspace.has_gpu_support, "No gpu support")
     @given(**hu.gcs)
     def test_sorted_segment_range_mean(self, gc, dc):
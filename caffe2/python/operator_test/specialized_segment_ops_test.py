@@ -266,5 +266,36 @@ class TestSpecializedSegmentOps(hu.HypothesisTestCase):
             self.ws.run(op)
 
 
+    @given(batchsize=st.integers(100, 300),
+           blocksize=st.sampled_from([17, 64, 300]),
+           op_type=st.sampled_from(
+               ["SparseLengthsSum", "SparseLengthsWeightedSum",
+                "SparseLengthsMean"]),
+           **hu.gcs_cpu_only)
+    def test_sparse_lengths_parallel(
+            self, batchsize, blocksize, op_type, gc, dc):
+        tblsize = 300
+        Tbl = np.random.rand(tblsize, blocksize).astype(np.float32)
+        # Empty segments included, they must not shift the split.
+        Lengths = np.random.randint(0, 30, size=batchsize).astype(np.int32)
+        Indices = np.random.randint(
+            0, tblsize, size=sum(Lengths)).astype(np.int64)
+        Weights = np.random.rand(sum(Lengths)).astype(np.float32)
+        inputs = ["Tbl", "Indices", "Lengths"]
+        if op_type == "SparseLengthsWeightedSum":
+            inputs.insert(1, "Weights")
+
+        self.ws.create_blob("Tbl").feed(Tbl)
+        self.ws.create_blob("Indices").feed(Indices)
+        self.ws.create_blob("Lengths").feed(Lengths)
+        self.ws.create_blob("Weights").feed(Weights)
+        self.ws.run(core.CreateOperator(op_type, inputs, "serial"))
+        self.ws.run(core.CreateOperator(
+            op_type, inputs, "parallel", parallel=True))
+        np.testing.assert_allclose(self.ws.blobs["parallel"].fetch(),
+                                   self.ws.blobs["serial"].fetch(),
+                                   rtol=1e-5, atol=1e-5)
+
+
 if __name__ == "__main__":
     unittest.main()
@@ -62,19 +62,21 @@ bool BlobsQueue::blockingRead(
   const auto& name = name_.c_str();
   CAFFE_SDT(queue_read_start, name, (void*)this, SDT_BLOCKING_OP);
   std::unique_lock<std::mutex> g(mutex_);
-  auto canRead = [this]() {
-    CAFFE_ENFORCE_LE(reader_, writer_);
-    return reader_ != writer_;
-  };
   // Decrease queue balance before reading to indicate queue read pressure
   // is being increased (-ve queue balance indicates more reads than writes)
   CAFFE_EVENT(stats_, queue_balance, -1);
-  if (timeout_secs > 0) {
-    std::chrono::milliseconds timeout_ms(int(timeout_secs * 1000));
-    cv_.wait_for(
-        g, timeout_ms, [this, canRead]() { return closing_ || canRead(); });
-  } else {
-    cv_.wait(g, [this, canRead]() { return closing_ || canRead(); });
+  if (!closing_ && !canRead()) {
+    Timer waitTimer;
+    ++waitingReaders_;
+    if (timeout_secs > 0) {
+      std::chrono::milliseconds timeout_ms(int(timeout_secs * 1000));
+      readCv_.wait_for(
+          g, timeout_ms, [this]() { return closing_ || canRead(); });
+    } else {
+      readCv_.wait(g, [this]() { return closing_ || canRead(); });
+    }
+    --waitingReaders_;
+    CAFFE_EVENT(stats_, read_wait_time_ns, waitTimer.NanoSeconds());
   }
   if (!canRead()) {
     if (timeout_secs > 0 && !closing_) {
@@ -86,22 +88,63 @@ bool BlobsQueue::blockingRead(
     return false;
   }
   DCHECK(canRead());
-  auto& result = queue_[reader_ % queue_.size()];
-  CAFFE_ENFORCE(inputs.size() >= result.size());
-  for (auto i = 0; i < result.size(); ++i) {
-    auto bytes = BlobStat::sizeBytes(*result[i]);
-    CAFFE_EVENT(stats_, queue_dequeued_bytes, bytes, i);
-    using std::swap;
-    swap(*(inputs[i]), *(result[i]));
-  }
   CAFFE_SDT(queue_read_end, name, (void*)this, writer_ - reader_);
-  CAFFE_EVENT(stats_, queue_dequeued_records);
-  ++reader_;
-  cv_.notify_all();
+  doRead(inputs);
+  notifyWriters(1);
   CAFFE_EVENT(stats_, read_time_ns, readTimer.NanoSeconds());
   return true;
 }
 
+size_t BlobsQueue::blockingReadMany(
+    const std::vector<std::vector<Blob*>>& outputs,
+    float timeout_secs) {
+  Timer readTimer;
+  auto keeper = this->shared_from_this();
+  const auto& name = name_.c_str();
+  CAFFE_SDT(queue_read_start, name, (void*)this, SDT_BLOCKING_OP);
+  std::unique_lock<std::mutex> g(mutex_);
+  CAFFE_EVENT(stats_, queue_balance, -(int64_t)outputs.size());
+  const auto deadline = std::chrono::steady_clock::now() +
+      std::chrono::milliseconds(int(timeout_secs * 1000));
+  size_t numRead = 0;
+  while (numRead < outputs.size()) {
+    if (!closing_ && !canRead()) {
+      Timer waitTimer;
+      ++waitingReaders_;
+      if (timeout_secs > 0) {
+        readCv_.wait_until(
+            g, deadline, [this]() { return closing_ || canRead(); });
+      } else {
+        readCv_.wait(g, [this]() { return closing_ || canRead(); });
+      }
+      --waitingReaders_;
+      CAFFE_EVENT(stats_, read_wait_time_ns, waitTimer.NanoSeconds());
+    }
+    if (!canRead()) {
+      break;
+    }
+    // take everything that is there, with a single wake up for the writers
+    size_t batch = 0;
+    while (numRead < outputs.size() && canRead()) {
+      doRead(outputs[numRead++]);
+      ++batch;
+    }
+    notifyWriters(batch);
+  }
+  if (numRead < outputs.size()) {
+    if (timeout_secs > 0 && !closing_) {
+      LOG(ERROR) << "DequeueBlobs timed out in " << timeout_secs << " secs";
+      CAFFE_SDT(queue_read_end, name, (void*)this, SDT_TIMEOUT);
+    } else {
+      CAFFE_SDT(queue_read_end, name, (void*)this, SDT_CANCEL);
+    }
+  } else {
+    CAFFE_SDT(queue_read_end, name, (void*)this, writer_ - reader_);
+  }
+  CAFFE_EVENT(stats_, read_time_ns, readTimer.NanoSeconds());
+  return numRead;
+}
+
 bool BlobsQueue::tryWrite(const std::vector<Blob*>& inputs) {
   Timer writeTimer;
   auto keeper = this->shared_from_this();
@@ -116,7 +159,10 @@ bool BlobsQueue::tryWrite(const std::vector<Blob*>& inputs) {
   // being increased (+ve queue balance indicates more writes than reads)
   CAFFE_EVENT(stats_, queue_balance, 1);
   DCHECK(canWrite());
+  CAFFE_SDT(
+      queue_write_end, name, (void*)this, reader_ + queue_.size() - writer_);
   doWrite(inputs);
+  notifyReaders(1);
   CAFFE_EVENT(stats_, write_time_ns, writeTimer.NanoSeconds());
   return true;
 }
@@ -130,13 +176,57 @@ bool BlobsQueue::blockingWrite(const std::vector<Blob*>& inputs) {
   // Increase queue balance before writing to indicate queue write pressure is
   // being increased (+ve queue balance indicates more writes than reads)
   CAFFE_EVENT(stats_, queue_balance, 1);
-  cv_.wait(g, [this]() { return closing_ || canWrite(); });
+  if (!closing_ && !canWrite()) {
+    Timer waitTimer;
+    ++waitingWriters_;
+    writeCv_.wait(g, [this]() { return closing_ || canWrite(); });
+    --waitingWriters_;
+    CAFFE_EVENT(stats_, write_wait_time_ns, waitTimer.NanoSeconds());
+  }
   if (!canWrite()) {
     CAFFE_SDT(queue_write_end, name, (void*)this, SDT_ABORT);
     return false;
   }
   DCHECK(canWrite());
+  CAFFE_SDT(
+      queue_write_end, name, (void*)this, reader_ + queue_.size() - writer_);
   doWrite(inputs);
+  notifyReaders(1);
+  CAFFE_EVENT(stats_, write_time_ns, writeTimer.NanoSeconds());
+  return true;
+}
+
+bool BlobsQueue::blockingWriteMany(
+    const std::vector<std::vector<Blob*>>& inputs) {
+  Timer writeTimer;
+  auto keeper = this->shared_from_this();
+  const auto& name = name_.c_str();
+  CAFFE_SDT(queue_write_start, name, (void*)this, SDT_BLOCKING_OP);
+  std::unique_lock<std::mutex> g(mutex_);
+  CAFFE_EVENT(stats_, queue_balance, (int64_t)inputs.size());
+  size_t numWritten = 0;
+  while (numWritten < inputs.size()) {
+    if (!closing_ && !canWrite()) {
+      Timer waitTimer;
+      ++waitingWriters_;
+      writeCv_.wait(g, [this]() { return closing_ || canWrite(); });
+      --waitingWriters_;
+      CAFFE_EVENT(stats_, write_wait_time_ns, waitTimer.NanoSeconds());
+    }
+    if (!canWrite()) {
+      CAFFE_SDT(queue_write_end, name, (void*)this, SDT_ABORT);
+      return false;
+    }
+    // fill all the free slots, with a single wake up for the readers
+    size_t batch = 0;
+    while (numWritten < inputs.size() && canWrite()) {
+      doWrite(inputs[numWritten++]);
+      ++batch;
+    }
+    notifyReaders(batch);
+  }
+  CAFFE_SDT(
+      queue_write_end, name, (void*)this, reader_ + queue_.size() - writer_);
   CAFFE_EVENT(stats_, write_time_ns, writeTimer.NanoSeconds());
   return true;
 }
@@ -145,7 +235,13 @@ void BlobsQueue::close() {
   closing_ = true;
 
   std::lock_guard<std::mutex> g(mutex_);
-  cv_.notify_all();
+  readCv_.notify_all();
+  writeCv_.notify_all();
+}
+
+bool BlobsQueue::canRead() {
+  CAFFE_ENFORCE_LE(reader_, writer_);
+  return reader_ != writer_;
 }
 
 bool BlobsQueue::canWrite() {
@@ -156,18 +252,51 @@ bool BlobsQueue::canWrite() {
   return writer_ != reader_ + queue_.size();
 }
 
+void BlobsQueue::doRead(const std::vector<Blob*>& outputs) {
+  auto& result = queue_[reader_ % queue_.size()];
+  CAFFE_ENFORCE(outputs.size() >= result.size());
+  for (auto i = 0; i < result.size(); ++i) {
+    auto bytes = BlobStat::sizeBytes(*result[i]);
+    CAFFE_EVENT(stats_, queue_dequeued_bytes, bytes, i);
+    using std::swap;
+    swap(*(outputs[i]), *(result[i]));
+  }
+  CAFFE_EVENT(stats_, queue_dequeued_records);
+  ++reader_;
+  CAFFE_EVENT(stats_, queue_depth, writer_ - reader_);
+}
+
 void BlobsQueue::doWrite(const std::vector<Blob*>& inputs) {
   auto& result = queue_[writer_ % queue_.size()];
   CAFFE_ENFORCE(inputs.size() >= result.size());
-  const auto& name = name_.c_str();
   for (auto i = 0; i < result.size(); ++i) {
     using std::swap;
     swap(*(inputs[i]), *(result[i]));
   }
-  CAFFE_SDT(
-      queue_write_end, name, (void*)this, reader_ + queue_.size() - writer_);
   ++writer_;
-  cv_.notify_all();
+  CAFFE_EVENT(stats_, queue_depth, writer_ - reader_);
+}
+
+void BlobsQueue::notifyReaders(size_t numRecords) {
+  if (waitingReaders_ == 0 || numRecords == 0) {
+    return;
+  }
+  if (numRecords > 1) {
+    readCv_.notify_all();
+  } else {
+    readCv_.notify_one();
+  }
+}
+
+void BlobsQueue::notifyWriters(size_t numRecords) {
+  if (waitingWriters_ == 0 || numRecords == 0) {
+    return;
+  }
+  if (numRecords > 1) {
+    writeCv_.notify_all();
+  } else {
+    writeCv_.notify_one();
+  }
 }
 
 } // namespace caffe2
@@ -19,6 +19,9 @@ namespace caffe2 {
 
 // Containing blobs are owned by the workspace.
 // On read, we swap out the underlying data for the blob passed in for blobs
+// (and the same on write), so records are handed off without copying or
+// reallocating tensors. The *Many variants move several records per lock
+// acquisition and wake up a waiting reader or writer only once per batch.
 
 class CAFFE2_API BlobsQueue : public std::enable_shared_from_this<BlobsQueue> {
  public:
@@ -39,22 +42,39 @@ class CAFFE2_API BlobsQueue : public std::enable_shared_from_this<BlobsQueue> {
       float timeout_secs = 0.0f);
   bool tryWrite(const std::vector<Blob*>& inputs);
   bool blockingWrite(const std::vector<Blob*>& inputs);
+  // Reads outputs.size() records, fewer if the queue is closed or the
+  // timeout expires first. Returns the number of records read.
+  size_t blockingReadMany(
+      const std::vector<std::vector<Blob*>>& outputs,
+      float timeout_secs = 0.0f);
+  // Writes all the records, as space frees up. Returns false if the queue
+  // was closed before all of them were written.
+  bool blockingWriteMany(const std::vector<std::vector<Blob*>>& inputs);
   void close();
   size_t getNumBlobs() const {
     return numBlobs_;
   }
 
  private:
+  bool canRead();
   bool canWrite();
+  void doRead(const std::vector<Blob*>& outputs);
   void doWrite(const std::vector<Blob*>& inputs);
+  // Wakes up one waiting reader (writer), or all of them when more than one
+  // record (slot) became available. Called with mutex_ held.
+  void notifyReaders(size_t numRecords);
+  void notifyWriters(size_t numRecords);
 
   std::atomic<bool> closing_{false};
 
   size_t numBlobs_;
   std::mutex mutex_; // protects all variables in the class.
-  std::condition_variable cv_;
+  std::condition_variable readCv_;
+  std::condition_variable writeCv_;
   int64_t reader_{0};
   int64_t writer_{0};
+  int waitingReaders_{0};
+  int waitingWriters_{0};
   std::vector<std::vector<Blob*>> queue_;
   const std::string name_;
 
@@ -65,6 +85,9 @@ class CAFFE2_API BlobsQueue : public std::enable_shared_from_this<BlobsQueue> {
     CAFFE_DETAILED_EXPORTED_STAT(queue_dequeued_bytes);
     CAFFE_AVG_EXPORTED_STAT(read_time_ns);
     CAFFE_AVG_EXPORTED_STAT(write_time_ns);
+    CAFFE_STATIC_STAT(queue_depth);
+    CAFFE_AVG_EXPORTED_STAT(read_wait_time_ns);
+    CAFFE_AVG_EXPORTED_STAT(write_wait_time_ns);
   } stats_;
 };
 } // namespace caffe2
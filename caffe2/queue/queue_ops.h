@@ -7,6 +7,10 @@
 
 namespace caffe2 {
 
+// Extra capacity given to the outputs of dequeues that concatenate several
+// records when they are reallocated, in percent of their outer dimension
+constexpr float kDequeueGrowthPct = 40;
+
 template <typename Context>
 class CreateBlobsQueueOp final : public Operator<Context> {
  public:
@@ -130,42 +134,59 @@ class SafeDequeueBlobsOp final : public Operator<Context> {
   bool dequeueMany(std::shared_ptr<BlobsQueue>& queue) {
     auto size = queue->getNumBlobs();
 
-    if (blobs_.size() != size) {
-      blobs_.resize(size);
-      blobPtrs_.resize(size);
-      for (int col = 0; col < size; ++col) {
-        blobPtrs_.at(col) = &blobs_.at(col);
+    if (blobs_.size() != numRecords_ * size) {
+      blobs_.resize(numRecords_ * size);
+      blobPtrs_.resize(numRecords_);
+      for (int i = 0; i < numRecords_; ++i) {
+        blobPtrs_.at(i).resize(size);
+        for (int col = 0; col < size; ++col) {
+          blobPtrs_.at(i).at(col) = &blobs_.at(i * size + col);
+        }
       }
     }
 
-    const int kTensorGrowthPct = 40;
-    for (int i = 0; i < numRecords_; ++i) {
-      if (!queue->blockingRead(blobPtrs_)) {
-        // if we read at least one record, status is still true
-        return i > 0;
+    // all the records in one go; if we read at least one record, status is
+    // still true
+    const int numRead = queue->blockingReadMany(blobPtrs_);
+    if (numRead == 0) {
+      return false;
+    }
+    for (int col = 0; col < size; ++col) {
+      auto* out = this->Output(col);
+      const auto& first = blobPtrs_.at(0).at(col)->template Get<Tensor>();
+      if (numRead == 1) {
+        out->CopyFrom(first);
+        continue;
+      }
+
+      // concatenate along the first dimension, sizing the output once
+      auto dims = first.dims();
+      CAFFE_ENFORCE(
+          dims.size() > 0,
+          "Empty tensor to dequeue at column ",
+          col,
+          " within ",
+          size,
+          " total columns");
+      for (int i = 1; i < numRead; ++i) {
+        const auto& in = blobPtrs_.at(i).at(col)->template Get<Tensor>();
+        CAFFE_ENFORCE(
+            in.ndim() > 0,
+            "Empty tensor to dequeue at column ",
+            col,
+            " within ",
+            size,
+            " total columns");
+        dims[0] += in.dims()[0];
       }
-      for (int col = 0; col < size; ++col) {
-        auto* out = this->Output(col);
-        const auto& in = blobPtrs_.at(col)->template Get<Tensor>();
-        if (i == 0) {
-          out->CopyFrom(in);
-        } else {
-          auto oldSize = out->size();
-
-          CAFFE_ENFORCE(
-              in.ndim() > 0,
-              "Empty tensor to dequeue at column ",
-              col,
-              " within ",
-              size,
-              " total columns");
-
-          out->Extend(in.dims()[0], kTensorGrowthPct, &context_);
-          auto* dst =
-              (char*)out->raw_mutable_data() + oldSize * in.meta().itemsize();
-          context_.template CopyItems<Context, Context>(
-              in.meta(), in.size(), in.raw_data(), dst);
-        }
+      // the number of rows varies, so leave room to not reallocate every run
+      out->ResizeWithGrowth(dims, kDequeueGrowthPct, first.meta());
+      auto* dst = (char*)out->raw_mutable_data(first.meta());
+      for (int i = 0; i < numRead; ++i) {
+        const auto& in = blobPtrs_.at(i).at(col)->template Get<Tensor>();
+        context_.template CopyItems<Context, Context>(
+            in.meta(), in.size(), in.raw_data(), dst);
+        dst += in.nbytes();
       }
     }
     return true;
@@ -195,7 +216,7 @@ class SafeDequeueBlobsOp final : public Operator<Context> {
  private:
   int numRecords_;
   std::vector<Blob> blobs_;
-  std::vector<Blob*> blobPtrs_;
+  std::vector<std::vector<Blob*>> blobPtrs_;
 };
 
 template <typename Context>
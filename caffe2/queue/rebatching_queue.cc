@@ -1,14 +1,41 @@
 #include "rebatching_queue.h"
-#include "caffe2/utils/smart_tensor_printer.h"
+
+#include <algorithm>
+#include <cstring>
 
 namespace caffe2 {
 
+std::vector<TIndex> RebatchingQueue::Row::dims() const {
+  auto dims = tensor->dims();
+  if (index >= 0) {
+    dims.erase(dims.begin());
+  }
+  return dims;
+}
+
+const void* RebatchingQueue::Row::data() const {
+  if (index < 0) {
+    return tensor->raw_data();
+  }
+  return (const char*)tensor->raw_data() +
+      index * tensor->size_from_dim(1) * tensor->itemsize();
+}
+
+TIndex RebatchingQueue::Row::size() const {
+  return index < 0 ? tensor->size() : tensor->size_from_dim(1);
+}
+
 namespace {
 
+// Extra capacity given to the outputs when they are reallocated, in percent
+// of their outer dimension, as their sizes vary from one dequeue to the next
+const float kOutputGrowthPct = 40;
+
 // This concat function will always create a new first dimension to concat
+template <typename Element>
 void concat(
     CPUContext& context,
-    const std::vector<std::vector<TensorCPU>>& inputs,
+    const std::vector<Element>& inputs,
     const std::vector<TensorCPU*>& outputs) {
   CAFFE_ENFORCE(!inputs.empty());
 
@@ -17,19 +44,21 @@ void concat(
   const auto numRows = inputs.size();
 
   // Precompute the output sizes to avoid resizing
+  std::vector<std::vector<TIndex>> inputDims(numTensors);
   std::vector<std::vector<TIndex>> outputDims(numTensors);
 
   for (int i = 0; i < numTensors; ++i) {
-    SmartTensorPrinter::PrintTensor(inputZero.at(i));
-    outputDims[i] = inputZero.at(i).dims();
+    inputDims[i] = inputZero.at(i).dims();
+    outputDims[i] = inputDims[i];
     outputDims[i].insert(outputDims[i].begin(), numRows);
   }
 
   // Resize to the final output size
   std::vector<void*> destinations(numTensors);
   for (int i = 0; i < numTensors; ++i) {
-    outputs[i]->Resize(outputDims[i]);
-    destinations[i] = outputs[i]->raw_mutable_data(inputZero[i].meta());
+    const auto& meta = inputZero[i].tensor->meta();
+    outputs[i]->ResizeWithGrowth(outputDims[i], kOutputGrowthPct, meta);
+    destinations[i] = outputs[i]->raw_mutable_data(meta);
   }
 
   for (int i = 0; i < numRows; ++i) {
@@ -37,13 +66,10 @@ void concat(
 
     for (int j = 0; j < numTensors; ++j) {
       const auto& input = inputs[i][j];
+      const auto& meta = input.tensor->meta();
 
-      CAFFE_ENFORCE(inputZero[j].meta() == input.meta());
-      CAFFE_ENFORCE_EQ(inputZero[j].itemsize(), input.itemsize());
-      CAFFE_ENFORCE_EQ(inputZero[j].ndim(), input.ndim());
-      for (int k = 0; k < input.ndim(); ++k) {
-        CAFFE_ENFORCE_EQ(input.dims()[k], inputZero[j].dims()[k]);
-      }
+      CAFFE_ENFORCE(inputZero[j].tensor->meta() == meta);
+      CAFFE_ENFORCE(input.dims() == inputDims[j]);
 
       // Skip empty tensors
       if (input.size() == 0) {
@@ -51,70 +77,172 @@ void concat(
       }
 
       context.CopyItemsToCPU(
-          input.meta(),
+          meta,
           input.size(),
-          input.raw_data() /* src */,
+          input.data() /* src */,
           destinations[j] /* dst */
       );
 
-      destinations[j] =
-          (char*)destinations[j] + input.size() * input.itemsize();
+      destinations[j] = (char*)destinations[j] + input.size() * meta.itemsize();
     }
   }
 }
 
-std::vector<std::vector<TensorCPU>> split(
+// Like concat, but pads the first dimension of every input to the longest
+// one and writes the lengths to the extra last output
+template <typename Element>
+void concatPadded(
     CPUContext& context,
-    const std::vector<const TensorCPU*>& inputs) {
+    const std::vector<Element>& inputs,
+    const std::vector<TensorCPU*>& outputs) {
   CAFFE_ENFORCE(!inputs.empty());
 
-  const auto outputSize = inputs[0]->dims().at(0);
-  std::vector<std::vector<TensorCPU>> outputs(outputSize);
-
-  for (const auto* inputPtr : inputs) {
-    CAFFE_ENFORCE(inputPtr);
-
-    const auto& input = *inputPtr;
-    const auto innerSize = input.size_from_dim(1);
-    const auto itemSize = input.meta().itemsize();
-
-    auto outputDims = input.dims();
-    CAFFE_ENFORCE(!outputDims.empty());
-    outputDims.erase(outputDims.begin());
-    CAFFE_ENFORCE_EQ(input.dims().at(0), outputSize);
+  const auto& inputZero = inputs[0];
+  const auto numTensors = inputZero.size();
+  const auto numRows = inputs.size();
+  CAFFE_ENFORCE_EQ(
+      outputs.size(),
+      numTensors + 1,
+      "A bucketed queue also outputs the lengths");
+
+  auto* lengths = outputs[numTensors];
+  lengths->Resize(numRows);
+  auto* lengthsData = lengths->template mutable_data<int32_t>();
+  TIndex maxLength = 0;
+  for (int i = 0; i < numRows; ++i) {
+    lengthsData[i] = inputs[i][0].dims().at(0);
+    maxLength = std::max<TIndex>(maxLength, lengthsData[i]);
+  }
 
-    for (int i = 0; i < outputSize; ++i) {
-      outputs[i].push_back(Tensor(outputDims, CPU));
-      context.CopyItemsToCPU(
-          input.meta(),
-          innerSize,
-          (char*)input.raw_data() + i * innerSize * itemSize /* src */,
-          outputs[i].back().raw_mutable_data(input.meta()) /* dst */);
+  for (int j = 0; j < numTensors; ++j) {
+    const auto& meta = inputZero[j].tensor->meta();
+    CAFFE_ENFORCE(
+        meta.copy() == nullptr, "Only sequences of POD types can be padded");
+    auto innerDims = inputZero[j].dims();
+    innerDims.erase(innerDims.begin());
+    const auto innerSize = size_from_dim_(0, innerDims);
+    const auto stride = maxLength * innerSize * meta.itemsize();
+
+    auto outputDims = innerDims;
+    outputDims.insert(outputDims.begin(), {(TIndex)numRows, maxLength});
+    outputs[j]->ResizeWithGrowth(outputDims, kOutputGrowthPct, meta);
+    auto* destination = (char*)outputs[j]->raw_mutable_data(meta);
+
+    for (int i = 0; i < numRows; ++i) {
+      const auto& input = inputs[i][j];
+      CAFFE_ENFORCE(input.tensor->meta() == meta);
+      auto dims = input.dims();
+      CAFFE_ENFORCE_EQ(dims.at(0), lengthsData[i]);
+      dims.erase(dims.begin());
+      CAFFE_ENFORCE(dims == innerDims);
+
+      const auto bytes = input.size() * meta.itemsize();
+      if (bytes > 0) {
+        context.CopyItemsToCPU(meta, input.size(), input.data(), destination);
+      }
+      // the padding, memset is fine for POD types
+      std::memset(destination + bytes, 0, stride - bytes);
+      destination += stride;
     }
   }
-
-  return outputs;
 }
+
 } // anonymous namespace
 
-RebatchingQueue::RebatchingQueue(size_t capacity, size_t numBlobs)
-    : capacity_(capacity), numBlobs_(numBlobs), queue_(capacity) {}
+RebatchingQueue::RebatchingQueue(
+    size_t capacity,
+    size_t numBlobs,
+    std::vector<TIndex> bucketBoundaries)
+    : capacity_(capacity),
+      numBlobs_(numBlobs),
+      bucketBoundaries_(std::move(bucketBoundaries)),
+      buckets_(bucketBoundaries_.size() + 1) {
+  CAFFE_ENFORCE(
+      std::is_sorted(bucketBoundaries_.begin(), bucketBoundaries_.end()),
+      "Bucket boundaries should be sorted");
+}
 
 RebatchingQueue::~RebatchingQueue() {
   close();
 }
 
+bool RebatchingQueue::isBucketed() const {
+  return !bucketBoundaries_.empty();
+}
+
+size_t RebatchingQueue::bucket(const Element& element) const {
+  if (!isBucketed()) {
+    return 0;
+  }
+  CAFFE_ENFORCE(!element.empty());
+  auto dims = element[0].dims();
+  CAFFE_ENFORCE(!dims.empty(), "Bucketed queue elements should be sequences");
+  for (const auto& row : element) {
+    auto rowDims = row.dims();
+    CAFFE_ENFORCE(
+        !rowDims.empty() && rowDims[0] == dims[0],
+        "All the components of an element should have the same length");
+  }
+  return std::upper_bound(
+             bucketBoundaries_.begin(), bucketBoundaries_.end(), dims[0]) -
+      bucketBoundaries_.begin();
+}
+
+int RebatchingQueue::readyBucket(size_t numElements) const {
+  if (!canRead()) {
+    return -1;
+  }
+  int fullest = 0;
+  for (int i = 1; i < buckets_.size(); ++i) {
+    if (buckets_[i].size() > buckets_[fullest].size()) {
+      fullest = i;
+    }
+  }
+  // Wait for a full batch of one length unless no more elements can come in
+  if (buckets_[fullest].size() >= numElements || size_ == capacity() ||
+      isClosed_) {
+    return fullest;
+  }
+  return -1;
+}
+
 bool RebatchingQueue::canRead() const {
-  return tail_ < head_;
+  return size_ > 0;
 }
 
 bool RebatchingQueue::dequeue(
     CPUContext& context,
     size_t numElements,
     const std::vector<TensorCPU*>& outputs) {
-  std::vector<std::vector<TensorCPU>> results;
+  std::vector<Element> results;
   results.reserve(numElements);
 
+  if (isBucketed()) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      cvEmpty_.wait(lock, [this, numElements] {
+        return readyBucket(numElements) >= 0 || isClosed_;
+      });
+
+      auto idx = readyBucket(numElements);
+      if (idx < 0) {
+        // empty and closed
+        return false;
+      }
+      auto& elements = buckets_[idx];
+      while (!elements.empty() && results.size() < numElements) {
+        results.push_back(std::move(elements.front()));
+        elements.pop_front();
+        --size_;
+      }
+    }
+    cvOverflow_.notify_all();
+
+    concatPadded(context, results, outputs);
+    return true;
+  }
+
   for (;;) {
     if (results.size() == numElements) {
       break;
@@ -130,8 +258,11 @@ bool RebatchingQueue::dequeue(
         break;
       }
 
+      auto& queue = buckets_[0];
       do {
-        results.push_back(std::move(queue_[tail_++ % capacity()]));
+        results.push_back(std::move(queue.front()));
+        queue.pop_front();
+        --size_;
       } while (canRead() && results.size() < numElements);
     }
 
@@ -152,38 +283,55 @@ bool RebatchingQueue::dequeue(
 }
 
 bool RebatchingQueue::canWrite() const {
-  return tail_ + capacity() > head_;
+  return size_ < capacity();
 }
 
 bool RebatchingQueue::enqueueOne(
     CPUContext& /*context*/,
     const std::vector<const TensorCPU*>& inputs) {
-  std::vector<std::vector<TensorCPU>> splittedInputs;
-  splittedInputs.emplace_back();
-  auto& tensorVector = splittedInputs.back();
-  tensorVector.reserve(inputs.size());
+  std::vector<Element> elements;
+  elements.emplace_back();
+  auto& element = elements.back();
+  element.reserve(inputs.size());
   for (const auto* tensorPtr : inputs) {
-    tensorVector.push_back(tensorPtr->Clone());
+    element.push_back(
+        Row{std::make_shared<const TensorCPU>(tensorPtr->Clone()), -1});
   }
 
-  return enqueue(std::move(splittedInputs));
+  return enqueue(std::move(elements));
 }
 
 bool RebatchingQueue::enqueueMany(
-    CPUContext& context,
+    CPUContext& /*context*/,
     const std::vector<const TensorCPU*>& inputs) {
   CAFFE_ENFORCE_EQ(numBlobs_, inputs.size());
+  CAFFE_ENFORCE(!inputs.empty());
 
-  std::vector<std::vector<TensorCPU>> splittedInputs;
-  splittedInputs = split(context, inputs);
-  return enqueue(std::move(splittedInputs));
+  // copy every input once, the elements are its rows
+  const auto numRows = inputs[0]->dims().at(0);
+  std::vector<Element> elements(numRows);
+  for (const auto* inputPtr : inputs) {
+    CAFFE_ENFORCE(inputPtr);
+    CAFFE_ENFORCE(!inputPtr->dims().empty());
+    CAFFE_ENFORCE_EQ(inputPtr->dims().at(0), numRows);
+    auto batch = std::make_shared<const TensorCPU>(inputPtr->Clone());
+    for (TIndex i = 0; i < numRows; ++i) {
+      elements[i].push_back(Row{batch, i});
+    }
+  }
+  return enqueue(std::move(elements));
 }
 
-bool RebatchingQueue::enqueue(
-    std::vector<std::vector<TensorCPU>> splittedInputs) {
+bool RebatchingQueue::enqueue(std::vector<Element> elements) {
+  std::vector<size_t> elementBuckets;
+  elementBuckets.reserve(elements.size());
+  for (const auto& element : elements) {
+    elementBuckets.push_back(bucket(element));
+  }
+
   int idx = 0;
   for (;;) {
-    if (idx >= splittedInputs.size()) {
+    if (idx >= elements.size()) {
       break;
     }
 
@@ -199,8 +347,10 @@ bool RebatchingQueue::enqueue(
       }
 
       do {
-        queue_[head_++ % capacity()] = std::move(splittedInputs[idx++]);
-      } while (canWrite() && idx < splittedInputs.size());
+        buckets_[elementBuckets[idx]].push_back(std::move(elements[idx]));
+        ++size_;
+        ++idx;
+      } while (canWrite() && idx < elements.size());
     }
 
     cvEmpty_.notify_all();
@@ -2,6 +2,7 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <queue>
@@ -17,9 +18,17 @@ namespace caffe2 {
 // atomic index + circular queue optimizations or pull something more
 // heavy-weight later
 
+// With bucket boundaries every component of an element is a sequence whose
+// first dimension is the element's length (the same for all components).
+// Elements are kept in buckets by length, upper_bound(boundaries, length),
+// and a dequeued batch comes from a single bucket: its sequences are padded
+// with zeros to the longest one, and the lengths go to an extra output.
 class RebatchingQueue {
  public:
-  RebatchingQueue(size_t capacity, size_t numBlobs);
+  RebatchingQueue(
+      size_t capacity,
+      size_t numBlobs,
+      std::vector<TIndex> bucketBoundaries = {});
 
   ~RebatchingQueue();
 
@@ -40,29 +49,48 @@ class RebatchingQueue {
 
   size_t numBlobs() const;
 
+  bool isBucketed() const;
+
   bool isClosed() const;
 
   void close();
 
  private:
-  bool enqueue(std::vector<std::vector<TensorCPU>> splittedInputs);
+  // One component of a queue element: either a whole tensor, or a row of
+  // an enqueued batch. Rows share the batch, which is copied once on enqueue
+  // instead of row by row, and are copied straight into the dequeue outputs.
+  struct Row {
+    std::shared_ptr<const TensorCPU> tensor;
+    TIndex index; // -1 for the whole tensor
+
+    std::vector<TIndex> dims() const;
+    const void* data() const;
+    TIndex size() const;
+  };
+  using Element = std::vector<Row>;
+
+  bool enqueue(std::vector<Element> elements);
+  size_t bucket(const Element& element) const;
+  // The bucket to dequeue from, or -1 if we should wait for more elements
+  int readyBucket(size_t numElements) const;
 
   bool canWrite() const;
   bool canRead() const;
 
   const size_t capacity_;
   const size_t numBlobs_;
+  const std::vector<TIndex> bucketBoundaries_;
 
   mutable std::mutex mutex_;
 
   bool isClosed_{false};
 
-  uint64_t head_{0};
-  uint64_t tail_{0};
+  size_t size_{0};
 
   std::condition_variable cvEmpty_;
   std::condition_variable cvOverflow_;
 
-  std::vector<std::vector<TensorCPU>> queue_;
+  // A single FIFO without bucketing
+  std::vector<std::deque<Element>> buckets_;
 };
 } // caffe2
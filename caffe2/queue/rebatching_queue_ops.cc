@@ -26,7 +26,13 @@ Creates the Queue.
     .Arg("num_blobs", "Number of input tensors the queue will support")
     .Arg(
         "capacity",
-        "Maximal number of elements the queue can hold at any given point");
+        "Maximal number of elements the queue can hold at any given point")
+    .Arg(
+        "bucket_boundaries",
+        "(optional) Sorted sequence lengths. If set, every component of an "
+        "element is a sequence of the same length along the first dimension, "
+        "elements are bucketed by that length and a dequeued batch only "
+        "holds elements of one bucket, padded with zeros to the longest one.");
 
 OPERATOR_SCHEMA(CloseRebatchingQueue)
     .NumInputs(1)
@@ -62,11 +68,19 @@ Dequeue Tensors from the Queue.
 If the Queue is closed this might return less elements than asked.
 If num_elements > 1 the returned elements will be concatenated into one
 tensor per component.
+If the queue has bucket boundaries, the batch comes from a single bucket, as
+soon as it has num_elements elements (or the queue is full or closed), and
+there is an extra last output with the int32 length of every sequence.
+On GPU the batch is assembled on the CPU in pinned memory and copied
+asynchronously; with prefetch the next batch is assembled in the background.
 )DOC")
     .Input(0, "rebatching_queue", "object representing the queue")
     .Input(1, "tensor", "First tensor to enqueue")
     .Arg(
         "num_elements",
-        "Number of elements to dequeue. By default we dequeue one element.");
+        "Number of elements to dequeue. By default we dequeue one element.")
+    .Arg(
+        "prefetch",
+        "(GPU only, default true) Assemble the next batch in the background");
 }
 }
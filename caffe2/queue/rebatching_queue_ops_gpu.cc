@@ -0,0 +1,118 @@
+#include "rebatching_queue_ops.h"
+
+#include <future>
+
+#include "caffe2/core/context_gpu.h"
+
+namespace caffe2 {
+
+namespace {
+
+// Dequeues into CPU staging tensors and copies them to the GPU outputs
+// asynchronously on the operator's stream. Once a CUDAContext exists the CPU
+// allocator hands out pinned memory, so the copies don't block the host.
+// With prefetch (the default) the next batch is assembled on a background
+// thread, into the other of two staging buffers, while the current one is
+// being copied and consumed.
+//
+// NB: the destructor waits for a pending prefetch, so close the queue
+// before destroying the net.
+class DequeueRebatchingQueueCUDAOp final : public Operator<CUDAContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CUDAContext);
+
+  DequeueRebatchingQueueCUDAOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CUDAContext>(operator_def, ws),
+        numElements_(OperatorBase::GetSingleArgument<int>("num_elements", 1)),
+        prefetch_(OperatorBase::GetSingleArgument<bool>("prefetch", true)) {
+    for (int buffer = 0; buffer < 2; ++buffer) {
+      for (int i = 0; i < OutputSize(); ++i) {
+        staging_[buffer].emplace_back(new TensorCPU(CPU));
+        stagingPtrs_[buffer].push_back(staging_[buffer].back().get());
+      }
+    }
+  }
+
+  ~DequeueRebatchingQueueCUDAOp() {
+    if (pending_.valid()) {
+      try {
+        pending_.get();
+      } catch (const std::exception&) {
+      }
+    }
+    for (int buffer = 0; buffer < 2; ++buffer) {
+      if (copied_[buffer]) {
+        DeviceGuard guard(context_.cuda_gpu_id());
+        cudaEventDestroy(copied_[buffer]);
+      }
+    }
+  }
+
+  bool RunOnDevice() override {
+    auto& queue = Inputs()[0]->template Get<RebatchingQueuePtr>();
+    CHECK(queue);
+
+    if (!copied_[0]) {
+      for (int buffer = 0; buffer < 2; ++buffer) {
+        CUDA_ENFORCE(cudaEventCreateWithFlags(
+            &copied_[buffer], cudaEventDisableTiming));
+      }
+    }
+
+    if (!pending_.valid()) {
+      pending_ = fetch(queue.get(), current_);
+    }
+    if (!pending_.get()) {
+      return false;
+    }
+
+    for (int i = 0; i < OutputSize(); ++i) {
+      const auto& staged = *staging_[current_][i];
+      auto* output = Output(i);
+      output->Resize(staged.dims());
+      context_.CopyItems<CPUContext, CUDAContext>(
+          staged.meta(),
+          staged.size(),
+          staged.raw_data(),
+          output->raw_mutable_data(staged.meta()));
+    }
+    CUDA_ENFORCE(cudaEventRecord(copied_[current_], context_.cuda_stream()));
+    recorded_[current_] = true;
+
+    current_ ^= 1;
+    if (prefetch_) {
+      pending_ = fetch(queue.get(), current_);
+    }
+    return true;
+  }
+
+ private:
+  std::future<bool> fetch(RebatchingQueue* queue, int buffer) {
+    // the buffer's last copy to the GPU was two runs ago
+    cudaEvent_t copied = recorded_[buffer] ? copied_[buffer] : nullptr;
+    auto* outputs = &stagingPtrs_[buffer];
+    size_t numElements = numElements_;
+    return std::async(std::launch::async, [=]() {
+      if (copied) {
+        CUDA_ENFORCE(cudaEventSynchronize(copied));
+      }
+      CPUContext context;
+      return queue->dequeue(context, numElements, *outputs);
+    });
+  }
+
+  const int numElements_;
+  const bool prefetch_;
+
+  std::vector<std::unique_ptr<TensorCPU>> staging_[2];
+  std::vector<TensorCPU*> stagingPtrs_[2];
+  cudaEvent_t copied_[2] = {nullptr, nullptr};
+  bool recorded_[2] = {false, false};
+  int current_{0};
+  std::future<bool> pending_;
+};
+
+REGISTER_CUDA_OPERATOR(DequeueRebatchingQueue, DequeueRebatchingQueueCUDAOp);
+
+} // namespace
+} // namespace caffe2
@@ -0,0 +1,59 @@
+#include "caffe2/sgd/adagrad_fused_op.h"
+
+namespace caffe2 {
+
+REGISTER_CPU_OPERATOR(
+    SparseAdagradFusedWithSparseLengthsSumGradient,
+    SparseAdagradFusedWithSparseLengthsSumGradientOp<false>);
+OPERATOR_SCHEMA(SparseAdagradFusedWithSparseLengthsSumGradient)
+    .NumInputs(6)
+    .NumOutputs(2)
+    .EnforceOneToOneInplace()
+    .SetDoc(R"DOC(
+
+Fused SparseLengthsSumGradient and SparseAdagrad: given inputs (param,
+moment, indices, grad, lr, lengths), where grad is the gradient of the output
+of SparseLengthsSum(param, indices, lengths), runs the SparseAdagrad update of
+each row of param looked up by indices with the gradient of its segment, and
+returns (new_param, new_moment). The rows are updated in the order of
+indices, so repeated indices give the same result as the unfused ops.
+
+)DOC")
+    .Input(0, "param", "Parameters to be updated")
+    .Input(1, "moment", "Moment history")
+    .Input(2, "indices", "Sparse indices, as in SparseLengthsSum")
+    .Input(3, "grad", "Gradient of the output of SparseLengthsSum")
+    .Input(4, "lr", "learning rate")
+    .Input(5, "lengths", "Segment lengths, as in SparseLengthsSum")
+    .Output(0, "output_param", "Updated parameters")
+    .Output(1, "output_moment_1", "Updated moment")
+    .Arg("epsilon", "Default 1e-5");
+
+REGISTER_CPU_OPERATOR(
+    RowWiseSparseAdagradFusedWithSparseLengthsSumGradient,
+    SparseAdagradFusedWithSparseLengthsSumGradientOp<true>);
+OPERATOR_SCHEMA(RowWiseSparseAdagradFusedWithSparseLengthsSumGradient)
+    .NumInputs(6)
+    .NumOutputs(2)
+    .EnforceOneToOneInplace()
+    .SetDoc(R"DOC(
+
+Fused SparseLengthsSumGradient and RowWiseSparseAdagrad: as
+SparseAdagradFusedWithSparseLengthsSumGradient, with the row-wise moment of
+RowWiseSparseAdagrad, a 1D tensor with one value per row of param.
+
+)DOC")
+    .Input(0, "param", "Parameters to be updated")
+    .Input(1, "moment", "Moment history, one value per row of param")
+    .Input(2, "indices", "Sparse indices, as in SparseLengthsSum")
+    .Input(3, "grad", "Gradient of the output of SparseLengthsSum")
+    .Input(4, "lr", "learning rate")
+    .Input(5, "lengths", "Segment lengths, as in SparseLengthsSum")
+    .Output(0, "output_param", "Updated parameters")
+    .Output(1, "output_moment_1", "Updated moment")
+    .Arg("epsilon", "Default 1e-5");
+
+SHOULD_NOT_DO_GRADIENT(SparseAdagradFusedWithSparseLengthsSumGradient);
+SHOULD_NOT_DO_GRADIENT(RowWiseSparseAdagradFusedWithSparseLengthsSumGradient);
+
+} // namespace caffe2
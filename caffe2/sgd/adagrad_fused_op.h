@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cmath>
+
+#include "caffe2/core/operator.h"
+#include "caffe2/perfkernels/adagrad.h"
+#include "caffe2/utils/math.h"
+
+namespace caffe2 {
+
+// Applies the sparse Adagrad update for the gradient of a SparseLengthsSum
+// directly from the gradient of its output: every row looked up for segment
+// i is updated with row i of the output gradient. This saves materializing
+// one gradient row per index, as SparseLengthsSumGradient does for
+// SparseAdagrad. The rows are updated in the order of the indices, so a
+// duplicate index is updated once per occurrence, as with the unfused ops.
+template <bool ROWWISE>
+class SparseAdagradFusedWithSparseLengthsSumGradientOp final
+    : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+  SparseAdagradFusedWithSparseLengthsSumGradientOp(
+      const OperatorDef& operator_def,
+      Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws),
+        epsilon_(this->template GetSingleArgument<float>("epsilon", 1e-5f)) {}
+
+  bool RunOnDevice() override {
+    const auto& param = Input(PARAM);
+    const auto& grad = Input(GRAD);
+    CAFFE_ENFORCE_EQ(Input(LR).size(), 1);
+    CAFFE_ENFORCE_EQ(1, Input(INDICES).ndim(), "INDICES must be a vector");
+    CAFFE_ENFORCE_EQ(1, Input(LENGTHS).ndim(), "LENGTHS must be a vector");
+    CAFFE_ENFORCE_GE(param.ndim(), 1);
+    CAFFE_ENFORCE_EQ(param.ndim(), grad.ndim());
+    CAFFE_ENFORCE_EQ(grad.dim(0), Input(LENGTHS).size());
+    CAFFE_ENFORCE_EQ(param.size_from_dim(1), grad.size_from_dim(1));
+    if (ROWWISE) {
+      CAFFE_ENFORCE_EQ(param.dim(0), Input(MOMENT_1).size());
+    } else {
+      CAFFE_ENFORCE_EQ(param.size(), Input(MOMENT_1).size());
+    }
+
+    return DispatchHelper<TensorTypes<int32_t, int64_t>>::call(
+        this, Input(INDICES));
+  }
+
+  template <typename SIndex>
+  bool DoRunWithType() {
+    const auto* indices = Input(INDICES).template data<SIndex>();
+    const auto* lengths = Input(LENGTHS).template data<int>();
+    const auto* gradIn = Input(GRAD).template data<float>();
+    const float lr = Input(LR).template data<float>()[0];
+    // Updated in place, see the schema.
+    auto* param = Output(OUTPUT_PARAM)->template mutable_data<float>();
+    auto* moment = Output(OUTPUT_MOMENT_1)->template mutable_data<float>();
+
+    const TIndex numRows = Input(PARAM).dim(0);
+    const TIndex blockSize = Input(PARAM).size_from_dim(1);
+    const TIndex numIndices = Input(INDICES).size();
+    const TIndex numSegments = Input(LENGTHS).size();
+
+    TIndex pos = 0;
+    for (TIndex segment = 0; segment < numSegments; ++segment) {
+      const float* g = gradIn + segment * blockSize;
+      CAFFE_ENFORCE_LE(
+          pos + lengths[segment],
+          numIndices,
+          "The sum of LENGTHS must be the size of INDICES");
+      // The row-wise moment only depends on the gradient, which is the same
+      // for the whole segment.
+      float gradSquaredAvg = 0;
+      if (ROWWISE && blockSize > 0) {
+        for (TIndex j = 0; j < blockSize; ++j) {
+          gradSquaredAvg += g[j] * g[j];
+        }
+        gradSquaredAvg /= blockSize;
+      }
+      for (int i = 0; i < lengths[segment]; ++i, ++pos) {
+        const SIndex idx = indices[pos];
+        CAFFE_ENFORCE(
+            0 <= idx && idx < numRows,
+            "Index ",
+            pos,
+            " is out of bounds: ",
+            idx,
+            ", range 0 to ",
+            numRows);
+        float* w = param + idx * blockSize;
+        if (ROWWISE) {
+          const float hi = moment[idx] += gradSquaredAvg;
+          math::Axpy<float, CPUContext>(
+              blockSize, lr / (std::sqrt(hi) + epsilon_), g, w, &context_);
+        } else {
+          float* h = moment + idx * blockSize;
+          AdagradUpdate(blockSize, w, g, h, w, h, epsilon_, 1.0f, lr);
+        }
+      }
+    }
+    CAFFE_ENFORCE_EQ(
+        pos, numIndices, "The sum of LENGTHS must be the size of INDICES");
+    return true;
+  }
+
+ protected:
+  float epsilon_;
+  INPUT_TAGS(PARAM, MOMENT_1, INDICES, GRAD, LR, LENGTHS);
+  OUTPUT_TAGS(OUTPUT_PARAM, OUTPUT_MOMENT_1);
+};
+
+} // namespace caffe2
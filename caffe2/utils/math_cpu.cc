@@ -1138,11 +1138,32 @@ void ReduceTensor(
   const int Y_size =
       std::accumulate(Y_dims, Y_dims + ndim, 1, std::multiplies<int>());
   Set<T, CPUContext>(Y_size, init, Y, context);
-  std::vector<int> index(ndim, 0);
-  for (int X_index = 0; X_index < X_size; ++X_index) {
-    const int Y_index = utils::GetIndexFromDims(ndim, Y_dims, index.data());
-    Y[Y_index] = reducer(Y[Y_index], X[X_index]);
-    utils::IncreaseIndexInDims(ndim, X_dims, index.data());
+  if (X_size == 0) {
+    return;
+  }
+  // The index into Y is only computed once per row of the last dimension,
+  // which is either reduced or kept as a whole.
+  const int inner = ndim > 0 ? X_dims[ndim - 1] : 1;
+  const int Y_inner = ndim > 0 ? Y_dims[ndim - 1] : 1;
+  const int outer = X_size / inner;
+  std::vector<int> index(std::max(ndim - 1, 0), 0);
+  const T* X_ptr = X;
+  for (int i = 0; i < outer; ++i) {
+    T* Y_ptr =
+        Y + utils::GetIndexFromDims(ndim - 1, Y_dims, index.data()) * Y_inner;
+    if (Y_inner == 1) {
+      T acc = *Y_ptr;
+      for (int j = 0; j < inner; ++j) {
+        acc = reducer(acc, X_ptr[j]);
+      }
+      *Y_ptr = acc;
+    } else {
+      for (int j = 0; j < inner; ++j) {
+        Y_ptr[j] = reducer(Y_ptr[j], X_ptr[j]);
+      }
+    }
+    X_ptr += inner;
+    utils::IncreaseIndexInDims(ndim - 1, X_dims, index.data());
   }
   Scale<T, T, CPUContext>(Y_size, alpha, Y, Y, context);
 }
@@ -1907,14 +1928,31 @@ void BroadcastBinaryOpImpl(
     const TIn* A,
     const TIn* B,
     TOut* C) {
-  std::vector<int> index(ndim, 0);
   const int C_size =
       std::accumulate(C_dims, C_dims + ndim, 1, std::multiplies<int>());
-  for (int C_index = 0; C_index < C_size; ++C_index) {
-    const int A_index = utils::GetIndexFromDims(ndim, A_dims, index.data());
-    const int B_index = utils::GetIndexFromDims(ndim, B_dims, index.data());
-    C[C_index] = op(A[A_index], B[B_index]);
-    utils::IncreaseIndexInDims(ndim, C_dims, index.data());
+  if (C_size == 0) {
+    return;
+  }
+  // The indices into A and B are only computed once per row of the last
+  // dimension, along which each of them is either contiguous or broadcast.
+  const int inner = ndim > 0 ? C_dims[ndim - 1] : 1;
+  const int A_inner = ndim > 0 ? A_dims[ndim - 1] : 1;
+  const int B_inner = ndim > 0 ? B_dims[ndim - 1] : 1;
+  const int A_stride = A_inner == 1 ? 0 : 1;
+  const int B_stride = B_inner == 1 ? 0 : 1;
+  const int outer = C_size / inner;
+  std::vector<int> index(std::max(ndim - 1, 0), 0);
+  TOut* C_ptr = C;
+  for (int i = 0; i < outer; ++i) {
+    const TIn* A_ptr =
+        A + utils::GetIndexFromDims(ndim - 1, A_dims, index.data()) * A_inner;
+    const TIn* B_ptr =
+        B + utils::GetIndexFromDims(ndim - 1, B_dims, index.data()) * B_inner;
+    for (int j = 0; j < inner; ++j) {
+      C_ptr[j] = op(A_ptr[j * A_stride], B_ptr[j * B_stride]);
+    }
+    C_ptr += inner;
+    utils::IncreaseIndexInDims(ndim - 1, C_dims, index.data());
   }
 }
 
@@ -3276,11 +3314,28 @@ DELEGATE_TRANSPOSE_2D_FUNCTION(double, mkl_domatcopy);
 
 #endif // CAFFE2_USE_MKL
 
+// Transposes tile by tile, so that both the rows read from X and the rows
+// written to Y of a tile stay in cache.
+template <typename T>
+void Tranpose2DBlocked(const int rows, const int cols, const T* X, T* Y) {
+  constexpr int kTileSize = 32;
+  for (int i0 = 0; i0 < rows; i0 += kTileSize) {
+    const int i1 = std::min(i0 + kTileSize, rows);
+    for (int j0 = 0; j0 < cols; j0 += kTileSize) {
+      const int j1 = std::min(j0 + kTileSize, cols);
+      for (int i = i0; i < i1; ++i) {
+        for (int j = j0; j < j1; ++j) {
+          Y[j * rows + i] = X[i * cols + j];
+        }
+      }
+    }
+  }
+}
+
 #define CAFFE2_SPECIALIZED_TRANSPOSE_2D(T)                               \
   template <>                                                            \
   void Tranpose2D<T>(const int rows, const int cols, const T* X, T* Y) { \
-    EigenMatrixMap<T>(Y, rows, cols) =                                   \
-        ConstEigenMatrixMap<T>(X, cols, rows).transpose();               \
+    Tranpose2DBlocked<T>(rows, cols, X, Y);                              \
   }
 
 #ifndef CAFFE2_USE_MKL
@@ -3298,8 +3353,7 @@ void Tranpose2D<float>(
     return;
   }
 #endif // CAFFE2_USE_HPTT
-  EigenMatrixMap<float>(Y, rows, cols) =
-      ConstEigenMatrixMap<float>(X, cols, rows).transpose();
+  Tranpose2DBlocked<float>(rows, cols, X, Y);
 }
 
 CAFFE2_SPECIALIZED_TRANSPOSE_2D(double)
@@ -3353,18 +3407,34 @@ void TransposeND(
   const int num_blocks = std::accumulate(
       Y_dims.cbegin(), Y_dims.cbegin() + itr_axes, 1, std::multiplies<int>());
   const std::vector<int> X_strides = ComputeXStrides(itr_axes, dims, axes);
+  if (block_size == 1) {
+    // Single elements: gather each row of Y with the stride of its axis in
+    // X, computing the offset of the row only once.
+    const int inner = Y_dims[itr_axes - 1];
+    const int inner_stride = X_strides[itr_axes - 1];
+    const int outer = inner > 0 ? num_blocks / inner : 0;
+    std::vector<int> index(itr_axes - 1, 0);
+    T* Y_ptr = Y;
+    for (int i = 0; i < outer; ++i) {
+      const T* X_ptr = X +
+          std::inner_product(
+              X_strides.cbegin(), X_strides.cend() - 1, index.cbegin(), 0);
+      for (int j = 0; j < inner; ++j) {
+        Y_ptr[j] = X_ptr[j * inner_stride];
+      }
+      Y_ptr += inner;
+      utils::IncreaseIndexInDims(itr_axes - 1, Y_dims.data(), index.data());
+    }
+    return;
+  }
   std::vector<int> index(itr_axes, 0);
   for (int Y_index = 0; Y_index < num_blocks; ++Y_index) {
     const int X_index = std::inner_product(
         X_strides.cbegin(), X_strides.cend(), index.cbegin(), 0);
-    if (block_size == 1) {
-      Y[Y_index] = X[X_index];
-    } else {
-      std::memcpy(
-          Y + block_size * Y_index,
-          X + block_size * X_index,
-          block_size * sizeof(T));
-    }
+    std::memcpy(
+        Y + block_size * Y_index,
+        X + block_size * X_index,
+        block_size * sizeof(T));
     utils::IncreaseIndexInDims(itr_axes, Y_dims.data(), index.data());
   }
 }
@@ -2,11 +2,16 @@
 #include "WorkersPool.h"
 #include "caffe2/core/logging.h"
 
+#include <ATen/core/ThreadPool.h>
 #include <cpuinfo.h>
 
 CAFFE2_DEFINE_bool(caffe2_threadpool_force_inline, false,
                    "Force to always run jobs on the calling thread");
 
+CAFFE2_DEFINE_bool(caffe2_threadpool_use_intra_op_pool, false,
+                   "Run jobs on the work-stealing intra-op pool shared with "
+                   "ATen instead of a private WorkersPool");
+
 // Whether or not threadpool caps apply to Android
 CAFFE2_DEFINE_int(caffe2_threadpool_android_cap, true, "");
 
@@ -127,6 +132,22 @@ void ThreadPool::run(const std::function<void(int, size_t)>& fn, size_t range) {
 
   CAFFE_ENFORCE_GE(numThreads_, 1);
   const size_t unitsPerTask = (range + numThreads_ - 1) / numThreads_;
+
+  if (FLAGS_caffe2_threadpool_use_intra_op_pool) {
+    // Share threads with ATen's parallel_for so a process mixing both does
+    // not run two competing pools. Work is still split into numThreads_
+    // contiguous pieces so that the thread index passed to fn stays within
+    // [0, numThreads_) for callers that keep per-thread scratch space.
+    const size_t numTasks = (range + unitsPerTask - 1) / unitsPerTask;
+    at::intra_op_thread_pool()->run(numTasks, [&](size_t idx) {
+      const size_t start = idx * unitsPerTask;
+      const size_t end = std::min<size_t>(range, start + unitsPerTask);
+      for (size_t i = start; i < end; ++i) {
+        fn(idx, i);
+      }
+    });
+    return;
+  }
   tasks_.resize(numThreads_);
   for (size_t i = 0; i < numThreads_; ++i) {
     if (!tasks_[i]) {
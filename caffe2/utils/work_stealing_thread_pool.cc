@@ -0,0 +1,176 @@
+#include "caffe2/utils/work_stealing_thread_pool.h"
+
+#include "caffe2/core/numa.h"
+#include "caffe2/utils/thread_name.h"
+
+namespace caffe2 {
+
+namespace {
+
+// The pool and worker index of the calling thread, if it is a worker
+thread_local const WorkStealingThreadPool* current_pool = nullptr;
+thread_local std::size_t current_index = 0;
+
+} // namespace
+
+WorkStealingThreadPool::WorkStealingThreadPool(std::size_t pool_size)
+    : pending_(0), sleeping_(0), next_worker_(0), running_(true) {
+  CAFFE_ENFORCE_GT(pool_size, 0, "Empty work stealing thread pool");
+  int num_numa_nodes = IsNUMAEnabled() ? GetNumNUMANodes() : -1;
+  workers_.reserve(pool_size);
+  for (std::size_t i = 0; i < pool_size; ++i) {
+    workers_.emplace_back(new Worker());
+    if (num_numa_nodes > 0) {
+      workers_[i]->numa_node_id = i % num_numa_nodes;
+    }
+  }
+  threads_.reserve(pool_size);
+  for (std::size_t i = 0; i < pool_size; ++i) {
+    threads_.emplace_back(&WorkStealingThreadPool::main_loop, this, i);
+  }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  {
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    running_ = false;
+    condition_.notify_all();
+  }
+
+  try {
+    for (auto& t : threads_) {
+      t.join();
+    }
+  } catch (const std::exception&) {
+  }
+}
+
+bool WorkStealingThreadPool::inWorkerThread() const {
+  return current_pool == this;
+}
+
+void WorkStealingThreadPool::run(
+    std::function<void()> func,
+    int numa_node_id) {
+  if (inWorkerThread()) {
+    push(current_index, std::move(func), /* front */ true);
+  } else {
+    push(pickWorker(numa_node_id), std::move(func), /* front */ false);
+  }
+}
+
+std::size_t WorkStealingThreadPool::pickWorker(int numa_node_id) {
+  auto num_workers = workers_.size();
+  auto start = next_worker_++ % num_workers;
+  if (numa_node_id >= 0) {
+    for (std::size_t i = 0; i < num_workers; ++i) {
+      auto index = (start + i) % num_workers;
+      if (workers_[index]->numa_node_id == numa_node_id) {
+        return index;
+      }
+    }
+  }
+  return start;
+}
+
+void WorkStealingThreadPool::push(
+    std::size_t index,
+    std::function<void()> func,
+    bool front) {
+  auto& worker = *workers_[index];
+  {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    // counted before it can be popped, so pending_ never goes below zero
+    ++pending_;
+    if (front) {
+      worker.tasks.push_front(std::move(func));
+    } else {
+      worker.tasks.push_back(std::move(func));
+    }
+  }
+  // A worker bumps sleeping_ before it checks pending_, so either it sees
+  // the new task or we see it sleeping; taking the lock makes sure it is
+  // already waiting when we notify.
+  if (sleeping_ > 0) {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    condition_.notify_one();
+  }
+}
+
+bool WorkStealingThreadPool::pop(
+    std::size_t index,
+    std::function<void()>& func) {
+  auto& worker = *workers_[index];
+  std::lock_guard<std::mutex> lock(worker.mutex);
+  if (worker.tasks.empty()) {
+    return false;
+  }
+  func = std::move(worker.tasks.front());
+  worker.tasks.pop_front();
+  --pending_;
+  return true;
+}
+
+bool WorkStealingThreadPool::stealFrom(
+    std::size_t victim,
+    std::function<void()>& func) {
+  auto& worker = *workers_[victim];
+  std::unique_lock<std::mutex> lock(worker.mutex, std::try_to_lock);
+  if (!lock.owns_lock() || worker.tasks.empty()) {
+    return false;
+  }
+  func = std::move(worker.tasks.back());
+  worker.tasks.pop_back();
+  --pending_;
+  return true;
+}
+
+bool WorkStealingThreadPool::steal(
+    std::size_t index,
+    std::function<void()>& func) {
+  auto num_workers = workers_.size();
+  auto numa_node_id = workers_[index]->numa_node_id;
+  // workers on the same NUMA node first, then everybody else
+  for (int same_node = 1; same_node >= 0; --same_node) {
+    for (std::size_t i = 1; i < num_workers; ++i) {
+      auto victim = (index + i) % num_workers;
+      if ((workers_[victim]->numa_node_id == numa_node_id) !=
+          (same_node == 1)) {
+        continue;
+      }
+      if (stealFrom(victim, func)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void WorkStealingThreadPool::main_loop(std::size_t index) {
+  setThreadName("CaffeWSTaskThread");
+  NUMABind(workers_[index]->numa_node_id);
+  current_pool = this;
+  current_index = index;
+
+  while (running_) {
+    std::function<void()> func;
+    if (pop(index, func) || steal(index, func)) {
+      try {
+        func();
+      } catch (const std::exception&) {
+      }
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    ++sleeping_;
+    // a victim may have been busy (try_lock failed) while we tried to
+    // steal, so recheck the pending count rather than the deques
+    while (pending_ == 0 && running_) {
+      condition_.wait(lock);
+    }
+    --sleeping_;
+  }
+}
+
+} // namespace caffe2
@@ -0,0 +1,77 @@
+#ifndef CAFFE2_UTILS_WORK_STEALING_THREAD_POOL_H_
+#define CAFFE2_UTILS_WORK_STEALING_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "caffe2/core/common.h"
+
+namespace caffe2 {
+
+/**
+ * A thread pool where every worker owns a deque of tasks. A task submitted
+ * from one of the pool's workers goes to the front of that worker's deque
+ * and is the next one the worker runs; idle workers steal the oldest tasks
+ * from the back of the other deques, trying workers on their own NUMA node
+ * first. Unlike TaskThreadPool there is no single queue lock that every
+ * submission and every worker contend on.
+ *
+ * When NUMA is enabled, workers are bound to the NUMA nodes round-robin,
+ * and tasks submitted from outside the pool can ask for a node.
+ */
+class CAFFE2_API WorkStealingThreadPool {
+ public:
+  explicit WorkStealingThreadPool(std::size_t pool_size);
+
+  // Stops the workers; tasks that have not started yet are dropped.
+  ~WorkStealingThreadPool();
+
+  std::size_t size() const {
+    return threads_.size();
+  }
+
+  /// @brief Runs func on the pool. numa_node_id is only a hint for tasks
+  /// submitted from outside the pool, -1 means any node.
+  void run(std::function<void()> func, int numa_node_id = -1);
+
+  /// @brief Whether the calling thread is one of this pool's workers.
+  bool inWorkerThread() const;
+
+ private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+    int numa_node_id = -1;
+  };
+
+  void push(std::size_t index, std::function<void()> func, bool front);
+  bool pop(std::size_t index, std::function<void()>& func);
+  bool steal(std::size_t index, std::function<void()>& func);
+  bool stealFrom(std::size_t victim, std::function<void()>& func);
+  std::size_t pickWorker(int numa_node_id);
+  void main_loop(std::size_t index);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+
+  // Idle workers sleep on condition_ while there are no pending tasks;
+  // submitters only take sleep_mutex_ when somebody is sleeping.
+  std::mutex sleep_mutex_;
+  std::condition_variable condition_;
+  std::atomic<std::size_t> pending_;
+  std::atomic<std::size_t> sleeping_;
+  std::atomic<std::size_t> next_worker_;
+  std::atomic<bool> running_;
+
+  AT_DISABLE_COPY_AND_ASSIGN(WorkStealingThreadPool);
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_UTILS_WORK_STEALING_THREAD_POOL_H_
@@ -2,6 +2,7 @@
 #include <caffe2/core/logging.h>
 
 #include <stdio.h>
+#include <algorithm>
 #include <mutex>
 #include <random>
 
@@ -25,6 +26,12 @@ VideoDecoder::VideoDecoder() {
     avformat_network_init();
     gInitialized = true;
   }
+  videoStreamFrame_ = av_frame_alloc();
+}
+
+VideoDecoder::~VideoDecoder() {
+  sws_freeContext(scaleContext_);
+  av_frame_free(&videoStreamFrame_);
 }
 
 void VideoDecoder::ResizeAndKeepAspectRatio(
@@ -45,6 +52,167 @@ void VideoDecoder::ResizeAndKeepAspectRatio(
   }
 }
 
+AVCodec* VideoDecoder::findHardwareDecoder(
+    const AVCodecContext* codecContext) {
+  // FFmpeg names its NVDEC decoders after the codec, e.g. h264_cuvid
+  const std::string name =
+      std::string(avcodec_get_name(codecContext->codec_id)) + "_cuvid";
+  return avcodec_find_decoder_by_name(name.c_str());
+}
+
+// Scales and converts videoStreamFrame_ to the output size and pixel format.
+// The scaling context is created from the decoded frame rather than from the
+// codec, since hardware decoders only settle on their output format once they
+// return a frame, and is reused as long as the sizes and formats don't change.
+std::unique_ptr<DecodedFrame> VideoDecoder::convertFrame(
+    const AVPixelFormat pixFormat,
+    const int outWidth,
+    const int outHeight) {
+  scaleContext_ = sws_getCachedContext(
+      scaleContext_,
+      videoStreamFrame_->width,
+      videoStreamFrame_->height,
+      static_cast<AVPixelFormat>(videoStreamFrame_->format),
+      outWidth,
+      outHeight,
+      pixFormat,
+      SWS_FAST_BILINEAR,
+      nullptr,
+      nullptr,
+      nullptr);
+  if (scaleContext_ == nullptr) {
+    LOG(ERROR) << "Unable to create a scaling context";
+    return nullptr;
+  }
+
+  // Determine required buffer size and allocate buffer
+  int numBytes = avpicture_get_size(pixFormat, outWidth, outHeight);
+  DecodedFrame::AvDataPtr buffer(
+      (uint8_t*)av_malloc(numBytes * sizeof(uint8_t)));
+  AVPicture picture;
+  int size =
+      avpicture_fill(&picture, buffer.get(), pixFormat, outWidth, outHeight);
+
+  sws_scale(
+      scaleContext_,
+      videoStreamFrame_->data,
+      videoStreamFrame_->linesize,
+      0,
+      videoStreamFrame_->height,
+      picture.data,
+      picture.linesize);
+
+  unique_ptr<DecodedFrame> frame = make_unique<DecodedFrame>();
+  frame->width_ = outWidth;
+  frame->height_ = outHeight;
+  frame->data_ = move(buffer);
+  frame->size_ = size;
+  frame->keyFrame_ = videoStreamFrame_->key_frame;
+  return frame;
+}
+
+// Decodes the clip_per_video_ clips of num_of_required_frame_ frames that
+// DecodeMultipleClipsFromVideo samples uniformly from the video, seeking to the
+// key frame before each clip instead of decoding the whole video. The frame
+// positions come from the stream's duration and frame count, and the clips
+// are returned back to back. Returns false if a clip can't be decoded, e.g.
+// because the metadata is wrong, in which case the caller decodes all frames.
+bool VideoDecoder::decodeUniformClips(
+    AVFormatContext* inputContext,
+    AVStream* videoStream,
+    const int videoStreamIndex,
+    AVCodecContext* videoCodecContext,
+    const Params& params,
+    const int outWidth,
+    const int outHeight,
+    std::vector<std::unique_ptr<DecodedFrame>>& sampledFrames) {
+  const int numRequired = params.num_of_required_frame_;
+  const int numClips = params.clip_per_video_;
+  // the whole-video path samples from the first MAX_DECODING_FRAMES frames
+  const int64_t numFrames = std::min<int64_t>(
+      videoStream->nb_frames, MAX_DECODING_FRAMES);
+  if (numRequired <= 0 || numClips <= 0 || numFrames < numRequired) {
+    return false;
+  }
+  const float sampleStep =
+      numClips <= 1 ? 0 : float(numFrames - numRequired) / (numClips - 1);
+  // leave a margin of 10 frames to take in to account the error
+  // from av_seek_frame
+  const int64_t margin =
+      int64_t(ceil((10 * videoStream->duration) / (videoStream->nb_frames)));
+
+  AVPacket packet;
+  av_init_packet(&packet);
+  packet.data = nullptr;
+  packet.size = 0;
+
+  for (int i = 0; i < numClips; i++) {
+    const int startFrame = floor(i * sampleStep);
+    const int64_t startTs = int64_t(floor(
+        (videoStream->duration * startFrame) / (videoStream->nb_frames)));
+    if (av_seek_frame(
+            inputContext,
+            videoStreamIndex,
+            std::max<int64_t>(0, startTs - margin),
+            AVSEEK_FLAG_BACKWARD) < 0) {
+      return false;
+    }
+    avcodec_flush_buffers(videoCodecContext);
+
+    int numDecoded = 0;
+    int gotPicture = 0;
+    bool eof = false;
+    while (numDecoded < numRequired && (!eof || gotPicture)) {
+      if (!eof) {
+        if (av_read_frame(inputContext, &packet) < 0) {
+          // stay in the loop to flush the frames buffered by the decoder
+          eof = true;
+          packet.data = nullptr;
+          packet.size = 0;
+        } else if (packet.stream_index != videoStreamIndex) {
+          av_packet_unref(&packet);
+          continue;
+        }
+      }
+
+      int ret = avcodec_decode_video2(
+          videoCodecContext, videoStreamFrame_, &gotPicture, &packet);
+      av_packet_unref(&packet);
+      if (ret < 0) {
+        LOG(ERROR) << "Error decoding video frame : " << ffmpegErrorStr(ret);
+        if (eof) {
+          break;
+        }
+        continue;
+      }
+      if (!gotPicture) {
+        continue;
+      }
+
+      long int frame_ts = av_frame_get_best_effort_timestamp(videoStreamFrame_);
+      // frames before the clip are only decoded as references
+      if (frame_ts >= startTs) {
+        auto frame = convertFrame(params.pixelFormat_, outWidth, outHeight);
+        if (!frame) {
+          av_frame_unref(videoStreamFrame_);
+          return false;
+        }
+        frame->index_ = startFrame + numDecoded;
+        frame->outputFrameIndex_ = sampledFrames.size();
+        frame->timestamp_ = frame_ts * av_q2d(videoStream->time_base);
+        sampledFrames.push_back(move(frame));
+        numDecoded++;
+      }
+      av_frame_unref(videoStreamFrame_);
+    }
+
+    if (numDecoded < numRequired) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void VideoDecoder::decodeLoop(
     const string& videoName,
     VideoIOContext& ioctx,
@@ -55,10 +223,8 @@ void VideoDecoder::decodeLoop(
   AVFormatContext* inputContext = avformat_alloc_context();
   AVStream* videoStream_ = nullptr;
   AVCodecContext* videoCodecContext_ = nullptr;
-  AVFrame* videoStreamFrame_ = nullptr;
   AVPacket packet;
   av_init_packet(&packet); // init packet
-  SwsContext* scaleContext_ = nullptr;
 
   try {
     inputContext->pb = ioctx.get_avio();
@@ -121,11 +287,25 @@ void VideoDecoder::decodeLoop(
     // Initialize codec
     AVDictionary* opts = nullptr;
     videoCodecContext_ = videoStream_->codec;
+    AVCodec* hardwareDecoder = params.useHardwareDecoder_
+        ? findHardwareDecoder(videoCodecContext_)
+        : nullptr;
     try {
-      ret = avcodec_open2(
-          videoCodecContext_,
-          avcodec_find_decoder(videoCodecContext_->codec_id),
-          &opts);
+      ret = -1;
+      if (hardwareDecoder != nullptr) {
+        ret = avcodec_open2(videoCodecContext_, hardwareDecoder, &opts);
+        if (ret < 0) {
+          LOG(WARNING) << "Cannot open hardware decoder "
+                       << hardwareDecoder->name << " : " << ffmpegErrorStr(ret)
+                       << ", decoding on CPU";
+        }
+      }
+      if (ret < 0) {
+        ret = avcodec_open2(
+            videoCodecContext_,
+            avcodec_find_decoder(videoCodecContext_->codec_id),
+            &opts);
+      }
     } catch (const std::exception&) {
       LOG(ERROR) << "Exception during open video codec";
       return;
@@ -175,22 +355,6 @@ void VideoDecoder::decodeLoop(
       LOG(ERROR) << "Unknown video_res_type: " << params.video_res_type_;
     }
 
-    // Make sure that we have a valid format
-    CAFFE_ENFORCE_NE(videoCodecContext_->pix_fmt, AV_PIX_FMT_NONE);
-
-    // Create a scale context
-    scaleContext_ = sws_getContext(
-        videoCodecContext_->width,
-        videoCodecContext_->height,
-        videoCodecContext_->pix_fmt,
-        outWidth,
-        outHeight,
-        pixFormat,
-        SWS_FAST_BILINEAR,
-        nullptr,
-        nullptr,
-        nullptr);
-
     // Getting video meta data
     VideoMeta videoMeta;
     videoMeta.codec_type = videoCodecContext_->codec_type;
@@ -230,9 +394,6 @@ void VideoDecoder::decodeLoop(
     }
 
     double lastFrameTimestamp = -1.0;
-    // Initialize frame and packet.
-    // These will be reused across calls.
-    videoStreamFrame_ = av_frame_alloc();
 
     // frame index in video stream
     int frameIndex = -1;
@@ -243,6 +404,8 @@ void VideoDecoder::decodeLoop(
     std::mt19937 meta_randgen(time(nullptr));
     long int start_ts = -1;
     bool mustDecodeAll = false;
+    // set when the clips of DO_UNIFORM_SMP were decoded by seeking to them
+    bool clipsDecoded = false;
     if (videoStream_->duration > 0 && videoStream_->nb_frames > 0) {
       /* we have a valid duration and nb_frames. We can safely
        * detect an intermediate timestamp to start decoding from. */
@@ -280,6 +443,28 @@ void VideoDecoder::decodeLoop(
             videoStreamIndex_,
             0 > (start_ts - margin) ? 0 : (start_ts - margin),
             AVSEEK_FLAG_BACKWARD);
+      } else if (
+          params.decode_type_ == DecodeType::DO_UNIFORM_SMP &&
+          params.intervals_.size() == 1 &&
+          params.intervals_[0].fps == SpecialFps::SAMPLE_ALL_FRAMES &&
+          !params.keyFrames_) {
+        // only decode the GOPs containing the sampled clips
+        clipsDecoded = decodeUniformClips(
+            inputContext,
+            videoStream_,
+            videoStreamIndex_,
+            videoCodecContext_,
+            params,
+            outWidth,
+            outHeight,
+            sampledFrames);
+        if (!clipsDecoded) {
+          sampledFrames.clear();
+          ret = av_seek_frame(
+              inputContext, videoStreamIndex_, 0, AVSEEK_FLAG_BACKWARD);
+          avcodec_flush_buffers(videoCodecContext_);
+          mustDecodeAll = true;
+        }
       } else {
         mustDecodeAll = true;
       }
@@ -310,7 +495,7 @@ void VideoDecoder::decodeLoop(
     // Therefore, after EOF, continue going while
     // the decoder is still giving us frames.
     int ipacket = 0;
-    while ((!eof || gotPicture) &&
+    while (!clipsDecoded && (!eof || gotPicture) &&
            /* either you must decode all frames or decode upto maxFrames
             * based on status of the mustDecodeAll flag */
            (mustDecodeAll ||
@@ -432,48 +617,14 @@ void VideoDecoder::decodeLoop(
               break;
             }
 
-            AVFrame* rgbFrame = av_frame_alloc();
-            if (!rgbFrame) {
-              LOG(ERROR) << "Error allocating AVframe";
-            }
-
-            try {
-              // Determine required buffer size and allocate buffer
-              int numBytes = avpicture_get_size(pixFormat, outWidth, outHeight);
-              DecodedFrame::AvDataPtr buffer(
-                  (uint8_t*)av_malloc(numBytes * sizeof(uint8_t)));
-
-              int size = avpicture_fill(
-                  (AVPicture*)rgbFrame,
-                  buffer.get(),
-                  pixFormat,
-                  outWidth,
-                  outHeight);
-
-              sws_scale(
-                  scaleContext_,
-                  videoStreamFrame_->data,
-                  videoStreamFrame_->linesize,
-                  0,
-                  videoCodecContext_->height,
-                  rgbFrame->data,
-                  rgbFrame->linesize);
-
-              unique_ptr<DecodedFrame> frame = make_unique<DecodedFrame>();
-              frame->width_ = outWidth;
-              frame->height_ = outHeight;
-              frame->data_ = move(buffer);
-              frame->size_ = size;
+            unique_ptr<DecodedFrame> frame =
+                convertFrame(pixFormat, outWidth, outHeight);
+            if (frame) {
               frame->index_ = frameIndex;
               frame->outputFrameIndex_ = outputFrameIndex;
               frame->timestamp_ = timestamp;
-              frame->keyFrame_ = videoStreamFrame_->key_frame;
-
               sampledFrames.push_back(move(frame));
               selectiveDecodedFrames++;
-              av_frame_free(&rgbFrame);
-            } catch (const std::exception&) {
-              av_frame_free(&rgbFrame);
             }
           }
           av_frame_unref(videoStreamFrame_);
@@ -488,18 +639,16 @@ void VideoDecoder::decodeLoop(
     } // of while loop
 
     // free all stuffs
-    sws_freeContext(scaleContext_);
     av_packet_unref(&packet);
-    av_frame_free(&videoStreamFrame_);
+    av_frame_unref(videoStreamFrame_);
     avcodec_close(videoCodecContext_);
     avformat_close_input(&inputContext);
     avformat_free_context(inputContext);
   } catch (const std::exception&) {
     // In case of decoding error
     // free all stuffs
-    sws_freeContext(scaleContext_);
     av_packet_unref(&packet);
-    av_frame_free(&videoStreamFrame_);
+    av_frame_unref(videoStreamFrame_);
     avcodec_close(videoCodecContext_);
     avformat_close_input(&inputContext);
     avformat_free_context(inputContext);
@@ -12,6 +12,8 @@ extern "C" {
 #include <libavformat/avio.h>
 }
 
+struct SwsContext;
+
 namespace caffe2 {
 
 #define VIO_BUFFER_SZ 32768
@@ -101,6 +103,12 @@ class Params {
   // params for decoding behavior
   int decode_type_ = DecodeType::DO_TMP_JITTER;
   int num_of_required_frame_ = -1;
+  // number of clips sampled with DecodeType::DO_UNIFORM_SMP
+  int clip_per_video_ = 1;
+
+  // decode with the NVDEC (CUVID) decoder of the codec when FFmpeg has one,
+  // falling back to the software decoder otherwise
+  bool useHardwareDecoder_ = false;
 
   // intervals_ control variable sampling fps between different timestamps
   // intervals_ must be ordered strictly ascending by timestamps
@@ -183,6 +191,14 @@ class Params {
     scale_h_ = height;
     return *this;
   }
+
+  /**
+   * Decode with the NVDEC (CUVID) hardware decoder when available
+   */
+  Params& hardwareDecoder(bool useHardwareDecoder) {
+    useHardwareDecoder_ = useHardwareDecoder;
+    return *this;
+  }
 };
 
 // data structure for storing decoded video frames
@@ -383,9 +399,16 @@ struct VideoMeta {
         pixFormat(AVPixelFormat::AV_PIX_FMT_RGB24) {}
 };
 
+// A decoder keeps the decoded frame and the scaling context between videos,
+// so a thread decoding many videos of the same size and pixel format only
+// sets them up once. It isn't thread safe; use one decoder per thread.
 class VideoDecoder {
  public:
   VideoDecoder();
+  ~VideoDecoder();
+
+  VideoDecoder(const VideoDecoder&) = delete;
+  VideoDecoder& operator=(const VideoDecoder&) = delete;
 
   void decodeFile(
       const std::string& filename,
@@ -411,12 +434,32 @@ class VideoDecoder {
       int& outHeight,
       int& outWidth);
 
+  AVCodec* findHardwareDecoder(const AVCodecContext* codecContext);
+
+  std::unique_ptr<DecodedFrame> convertFrame(
+      const AVPixelFormat pixFormat,
+      const int outWidth,
+      const int outHeight);
+
+  bool decodeUniformClips(
+      AVFormatContext* inputContext,
+      AVStream* videoStream,
+      const int videoStreamIndex,
+      AVCodecContext* videoCodecContext,
+      const Params& params,
+      const int outWidth,
+      const int outHeight,
+      std::vector<std::unique_ptr<DecodedFrame>>& sampledFrames);
+
   void decodeLoop(
       const std::string& videoName,
       VideoIOContext& ioctx,
       const Params& params,
       const int start_frm,
       std::vector<std::unique_ptr<DecodedFrame>>& sampledFrames);
+
+  AVFrame* videoStreamFrame_ = nullptr;
+  SwsContext* scaleContext_ = nullptr;
 };
 } // namespace caffe2
 
@@ -103,6 +103,7 @@ class VideoInputOp final : public PrefetchOperator<Context> {
   bool get_optical_flow_;
   bool get_video_id_;
   bool do_multi_label_;
+  bool use_hw_decoder_;
 
   // thread pool for parse + decode
   int num_decode_threads_;
@@ -241,6 +242,10 @@ void VideoInputOp<Context>::CheckParamsAndPrint() {
   } else {
     LOG(ERROR) << "    Unknown video decoding type";
   }
+
+  if (use_hw_decoder_) {
+    LOG(INFO) << "    Decode with NVDEC when available";
+  }
 }
 
 template <class Context>
@@ -343,6 +348,9 @@ VideoInputOp<Context>::VideoInputOp(
       do_multi_label_(OperatorBase::template GetSingleArgument<bool>(
           "do_multi_label",
           false)),
+      use_hw_decoder_(OperatorBase::template GetSingleArgument<bool>(
+          "use_hw_decoder",
+          false)),
       num_decode_threads_(OperatorBase::template GetSingleArgument<int>(
           "num_decode_threads",
           4)),
@@ -573,6 +581,8 @@ bool VideoInputOp<Context>::GetClipsAndLabelsFromDBValue(
   params.scale_h_ = scale_h_;
   params.decode_type_ = decode_type_;
   params.num_of_required_frame_ = num_of_required_frame_;
+  params.clip_per_video_ = clip_per_video_;
+  params.useHardwareDecoder_ = use_hw_decoder_;
 
   char* video_buffer = nullptr; // for decoding from buffer
   std::string video_filename; // for decoding from file
@@ -508,7 +508,9 @@ bool DecodeMultipleClipsFromVideo(
     int& width,
     std::vector<unsigned char*>& buffer_rgb) {
   std::vector<std::unique_ptr<DecodedFrame>> sampledFrames;
-  VideoDecoder decoder;
+  // one decoder per decoding thread, so its frame and scaling context are
+  // reused across videos
+  static thread_local VideoDecoder decoder;
 
   // decoding from buffer or file
   if (!use_local_file) {
@@ -535,6 +537,9 @@ bool DecodeMultipleClipsFromVideo(
 
   height = sampledFrames[0]->height_;
   width = sampledFrames[0]->width_;
+  // When the decoder only decoded the sampled clips, sampledFrames holds
+  // exactly clip_per_video clips back to back and the step below is
+  // num_of_required_frame_.
   float sample_stepsz = (clip_per_video <= 1)
       ? 0
       : (float(sampledFrames.size() - params.num_of_required_frame_) /
@@ -94,10 +94,18 @@ if (BUILD_ATEN)
     IF(MSVC)
       LIST(APPEND CPU_CAPABILITY_FLAGS "${MSVC_OPT_FLAG}/arch:AVX2")
     ELSE(MSVC)
-      LIST(APPEND CPU_CAPABILITY_FLAGS "-O3 -mavx2 -mfma")
+      LIST(APPEND CPU_CAPABILITY_FLAGS "-O3 -mavx2 -mfma -mf16c")
     ENDIF(MSVC)
   ENDIF(CXX_AVX2_FOUND)
 
+  # The Vec512 specializations are not built with MSVC, which would leave the
+  # AVX512 kernels with the generic scalar fallback.
+  IF(CXX_AVX512_FOUND AND NOT MSVC)
+    SET(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DHAVE_AVX512_CPU_DEFINITION")
+    LIST(APPEND CPU_CAPABILITY_NAMES "AVX512")
+    LIST(APPEND CPU_CAPABILITY_FLAGS "-O3 -mavx512f -mavx512dq -mavx512vl -mavx512bw -mfma -mf16c")
+  ENDIF(CXX_AVX512_FOUND AND NOT MSVC)
+
   list(LENGTH CPU_CAPABILITY_NAMES NUM_CPU_CAPABILITY_NAMES)
   math(EXPR NUM_CPU_CAPABILITY_NAMES "${NUM_CPU_CAPABILITY_NAMES}-1")
 
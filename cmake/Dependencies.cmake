@@ -587,6 +587,26 @@ if(USE_NCCL)
   endif()
 endif()
 
+# ---[ nvJPEG
+if(USE_NVJPEG)
+  find_path(NVJPEG_INCLUDE_DIR nvjpeg.h
+      HINTS ${CUDA_TOOLKIT_ROOT_DIR}
+      PATH_SUFFIXES include)
+  find_library(NVJPEG_LIBRARY nvjpeg
+      HINTS ${CUDA_TOOLKIT_ROOT_DIR}
+      PATH_SUFFIXES lib64 lib)
+  if(NOT USE_CUDA OR NOT NVJPEG_INCLUDE_DIR OR NOT NVJPEG_LIBRARY)
+    message(WARNING
+        "Not compiling with nvJPEG. Suppress this warning with "
+        "-DUSE_NVJPEG=OFF.")
+    caffe2_update_option(USE_NVJPEG OFF)
+  else()
+    include_directories(SYSTEM ${NVJPEG_INCLUDE_DIR})
+    list(APPEND Caffe2_CUDA_DEPENDENCY_LIBS ${NVJPEG_LIBRARY})
+    set(CAFFE2_USE_NVJPEG 1)
+  endif()
+endif()
+
 # ---[ CUB
 if(USE_CUDA)
   find_package(CUB)
@@ -760,6 +780,7 @@ if (USE_ZSTD)
   include_directories(SYSTEM ${CMAKE_CURRENT_LIST_DIR}/../third_party/zstd/lib)
   add_subdirectory(${CMAKE_CURRENT_LIST_DIR}/../third_party/zstd/build/cmake)
   set_property(TARGET libzstd_static PROPERTY POSITION_INDEPENDENT_CODE ON)
+  set(CAFFE2_USE_ZSTD 1)
 endif()
 
 # ---[ Onnx
@@ -1231,6 +1252,22 @@ if (BUILD_ATEN)
     endif()
   endif()
 
+  # ATen's NNPACK convolution runs on the pthreadpool implementation in
+  # caffe2/utils/threadpool, which is only built with the rest of Caffe2.
+  if (USE_NNPACK AND BUILD_CAFFE2 AND NOT MSVC)
+    set(AT_NNPACK_ENABLED 1)
+  else()
+    set(AT_NNPACK_ENABLED 0)
+  endif()
+
+  # USE_NUMA is turned off above if libnuma wasn't found, and
+  # CAFFE2_DISABLE_NUMA is set by MiscCheck.cmake if its headers don't work.
+  if (USE_NUMA AND NOT CAFFE2_DISABLE_NUMA)
+    set(AT_NUMA_ENABLED 1)
+  else()
+    set(AT_NUMA_ENABLED 0)
+  endif()
+
   IF(UNIX AND NOT APPLE)
      INCLUDE(CheckLibraryExists)
      # https://github.com/libgit2/libgit2/issues/2128#issuecomment-35649830
@@ -153,6 +153,31 @@ if (CAFFE2_COMPILER_SUPPORTS_AVX2_EXTENSIONS)
 endif()
 cmake_pop_check_state()
 
+# ---[ Check if the compiler has AVX512 support, for the perfkernels that
+# use the AVX512F, AVX512DQ, AVX512VL and AVX512BW extensions.
+cmake_push_check_state(RESET)
+if (MSVC)
+  set(CMAKE_REQUIRED_FLAGS "/arch:AVX512")
+else()
+  set(CMAKE_REQUIRED_FLAGS "-mavx512f -mavx512dq -mavx512vl -mavx512bw")
+endif()
+CHECK_CXX_SOURCE_COMPILES(
+    "#include <immintrin.h>
+     int main() {
+       __m512 a = _mm512_setzero_ps();
+       __m128i b = _mm_maskz_loadu_epi8((__mmask16)1, &a);
+       a = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(b));
+       return 0;
+     }" CAFFE2_COMPILER_SUPPORTS_AVX512_EXTENSIONS)
+if (CAFFE2_COMPILER_SUPPORTS_AVX512_EXTENSIONS)
+  message(STATUS "Current compiler supports avx512 extention. Will build avx512 perfkernels.")
+  # See the note on MSVC for avx2 above.
+  if (NOT MSVC)
+    set(CAFFE2_PERF_WITH_AVX512 1)
+  endif()
+endif()
+cmake_pop_check_state()
+
 # ---[ Checks if compiler supports -fvisibility=hidden
 check_cxx_compiler_flag("-fvisibility=hidden" COMPILER_SUPPORTS_HIDDEN_VISIBILITY)
 check_cxx_compiler_flag("-fvisibility-inlines-hidden" COMPILER_SUPPORTS_HIDDEN_INLINE_VISIBILITY)
@@ -274,6 +299,9 @@ endif()
 # ---[ Create CAFFE2_BUILD_SHARED_LIBS for macros.h.in usage.
 set(CAFFE2_BUILD_SHARED_LIBS ${BUILD_SHARED_LIBS})
 
+# ---[ Create CAFFE2_BUILD_ATEN for macros.h.in usage.
+set(CAFFE2_BUILD_ATEN ${BUILD_ATEN})
+
 if (USE_NATIVE_ARCH)
   check_cxx_compiler_flag("-march=native" COMPILER_SUPPORTS_MARCH_NATIVE)
   if (COMPILER_SUPPORTS_MARCH_NATIVE)
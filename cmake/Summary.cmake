@@ -116,6 +116,7 @@ function (caffe2_print_configuration_summary)
     message(STATUS "    NERVANA_GPU version : ${NERVANA_GPU_VERSION}")
   endif()
   message(STATUS "  USE_NNPACK            : ${USE_NNPACK}")
+  message(STATUS "  USE_NVJPEG            : ${USE_NVJPEG}")
   message(STATUS "  USE_OBSERVERS         : ${USE_OBSERVERS}")
   message(STATUS "  USE_OPENCL            : ${USE_OPENCL}")
   message(STATUS "  USE_OPENCV            : ${USE_OPENCV}")
@@ -793,9 +793,11 @@ main_sources = [
     "torch/csrc/autograd/python_variable_indexing.cpp",
     "torch/csrc/byte_order.cpp",
     "torch/csrc/jit/batched/BatchTensor.cpp",
+    "torch/csrc/jit/batched/BatchingExecutor.cpp",
     "torch/csrc/jit/init.cpp",
     "torch/csrc/jit/ivalue.cpp",
     "torch/csrc/jit/passes/onnx.cpp",
+    "torch/csrc/jit/passes/onnx/constant_fold.cpp",
     "torch/csrc/jit/passes/onnx/fixup_onnx_loop.cpp",
     "torch/csrc/jit/passes/onnx/peephole.cpp",
     "torch/csrc/jit/passes/to_batch.cpp",
@@ -852,7 +854,10 @@ if USE_DISTRIBUTED:
 
 if USE_C10D:
     extra_compile_args += ['-DUSE_C10D']
-    main_sources += ['torch/csrc/distributed/c10d/init.cpp']
+    main_sources += [
+        'torch/csrc/distributed/c10d/init.cpp',
+        'torch/csrc/distributed/c10d/reducer.cpp',
+    ]
     main_link_args += [C10D_LIB]
 
 if USE_CUDA:
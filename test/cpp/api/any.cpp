@@ -100,6 +100,34 @@ TEST_CASE("any-module") {
         any.forward(1, 2, 3),
         Contains("M's forward() method expects 2 arguments, but received 3"));
   }
+  SECTION("forward_unboxed()") {
+    struct M : torch::nn::Module {
+      torch::Tensor forward(torch::Tensor x) {
+        return x * 2;
+      }
+    };
+    AnyModule any(M{});
+    auto variable = torch::ones(3);
+    REQUIRE(any.is_callable_unboxed<torch::Tensor, torch::Tensor>());
+    REQUIRE(any.is_callable_unboxed<torch::Tensor, decltype(variable)>());
+    REQUIRE(!any.is_callable_unboxed<int, torch::Tensor>());
+    REQUIRE(!any.is_callable_unboxed<torch::Tensor, int>());
+    REQUIRE(any.forward_unboxed<torch::Tensor>(variable).sum().toCInt() == 6);
+
+    SECTION("falls back to boxing if the signature does not match") {
+      struct N : torch::nn::Module {
+        int forward(int a, int b) {
+          return a + b;
+        }
+      };
+      AnyModule any(N{});
+      REQUIRE(!any.is_callable_unboxed<int, int, int64_t>());
+      REQUIRE(any.forward_unboxed<int>(1, 2) == 3);
+      REQUIRE_THROWS_WITH(
+          any.forward_unboxed<int>(1, int64_t(2)),
+          StartsWith("Expected argument #1 to be of type int"));
+    }
+  }
   SECTION("get()") {
     struct M : torch::nn::Module {
       explicit M(int value_) : torch::nn::Module("M"), value(value_) {}
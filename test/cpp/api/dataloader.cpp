@@ -0,0 +1,126 @@
+#include <catch.hpp>
+
+#include <torch/data.h>
+#include <torch/tensor.h>
+#include <torch/utils.h>
+
+#include <torch/csrc/utils/memory.h>
+
+#include <ATen/core/Error.h>
+#include <ATen/detail/CUDAHooksInterface.h>
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using namespace torch::data;
+
+namespace {
+std::shared_ptr<TensorDataset> make_dataset(int64_t size) {
+  auto data = torch::arange(size, torch::kFloat32).view({size, 1});
+  auto target = torch::arange(size, torch::kInt64);
+  return std::make_shared<TensorDataset>(data, target);
+}
+
+std::vector<int64_t> targets_of(DataLoader& loader) {
+  std::vector<int64_t> targets;
+  for (auto& batch : loader) {
+    for (int64_t i = 0; i < batch.target.size(0); ++i) {
+      targets.push_back(batch.target[i].toCLong());
+    }
+  }
+  return targets;
+}
+
+bool is_pinned(const torch::Tensor& tensor) {
+  auto* allocator = at::detail::getCUDAHooks().getPinnedMemoryAllocator();
+  return tensor.unsafeGetTensorImpl()->storage()->pImpl()->allocator() ==
+      allocator;
+}
+
+struct ThrowingDataset : public Dataset {
+  Example get(size_t index) override {
+    if (index == 5) {
+      throw std::runtime_error("bad example");
+    }
+    return Example(torch::ones({2}), torch::Tensor());
+  }
+  size_t size() const override {
+    return 8;
+  }
+};
+} // namespace
+
+TEST_CASE("DataLoader/StacksExamplesIntoBatches") {
+  DataLoader loader(make_dataset(10), DataLoaderOptions(4));
+  std::vector<int64_t> batch_sizes;
+  int64_t expected = 0;
+  for (auto& batch : loader) {
+    REQUIRE(batch.data.size(0) == batch.target.size(0));
+    REQUIRE(batch.data.size(1) == 1);
+    for (int64_t i = 0; i < batch.target.size(0); ++i, ++expected) {
+      REQUIRE(batch.target[i].toCLong() == expected);
+      REQUIRE(batch.data[i][0].toCFloat() == expected);
+    }
+    batch_sizes.push_back(batch.data.size(0));
+  }
+  REQUIRE(batch_sizes == std::vector<int64_t>({4, 4, 2}));
+}
+
+TEST_CASE("DataLoader/DropsLastIncompleteBatch") {
+  DataLoader loader(
+      make_dataset(10), DataLoaderOptions(4).drop_last(true).workers(2));
+  REQUIRE(targets_of(loader).size() == 8);
+}
+
+TEST_CASE("DataLoader/WorkersPreserveSamplerOrder") {
+  torch::manual_seed(0);
+  DataLoader serial(
+      make_dataset(100),
+      DataLoaderOptions(3),
+      torch::make_unique<RandomSampler>(100));
+  const auto expected = targets_of(serial);
+
+  torch::manual_seed(0);
+  DataLoader parallel(
+      make_dataset(100),
+      DataLoaderOptions(3).workers(4).prefetch(6),
+      torch::make_unique<RandomSampler>(100));
+  REQUIRE(targets_of(parallel) == expected);
+  // every epoch is a new permutation
+  REQUIRE(targets_of(parallel) != expected);
+}
+
+TEST_CASE("DataLoader/ResetStartsNewEpoch") {
+  DataLoader loader(make_dataset(10), DataLoaderOptions(2).workers(3));
+  loader.reset();
+  REQUIRE(loader.next()->target[0].toCLong() == 0);
+  REQUIRE(loader.next()->target[0].toCLong() == 2);
+  loader.reset();
+  REQUIRE(targets_of(loader).size() == 10);
+  REQUIRE(!loader.next().has_value());
+}
+
+TEST_CASE("DataLoader/RethrowsExceptionsOfWorkers") {
+  DataLoader loader(
+      std::make_shared<ThrowingDataset>(), DataLoaderOptions(2).workers(2));
+  loader.reset();
+  auto batch = loader.next();
+  REQUIRE(batch.has_value());
+  REQUIRE(batch->data.sizes().vec() == std::vector<int64_t>({2, 2}));
+  REQUIRE(!batch->target.defined());
+  loader.next();
+  REQUIRE_THROWS_WITH(loader.next(), "bad example");
+  REQUIRE(loader.next().has_value());
+  REQUIRE(!loader.next().has_value());
+}
+
+TEST_CASE("DataLoader/PinsBatches", "[cuda]") {
+  DataLoader loader(
+      make_dataset(10), DataLoaderOptions(4).pin_memory(true).workers(2));
+  for (auto& batch : loader) {
+    REQUIRE(is_pinned(batch.data));
+    REQUIRE(is_pinned(batch.target));
+  }
+}
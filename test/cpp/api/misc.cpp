@@ -30,6 +30,25 @@ TEST_CASE("NoGrad") {
   REQUIRE(!model->parameters()["weight"].grad().defined());
 }
 
+TEST_CASE("InferenceGuard") {
+  torch::manual_seed(0);
+  auto x = torch::randn({3, 3}, torch::requires_grad());
+  auto y = torch::zeros({3, 3});
+  const auto version = torch::autograd::Variable(y).current_version();
+  {
+    torch::InferenceGuard guard;
+    REQUIRE(!torch::autograd::GradMode::is_enabled());
+    REQUIRE(torch::autograd::InferenceMode::is_enabled());
+    y.add_(x);
+    REQUIRE(!y.requires_grad());
+    REQUIRE(torch::autograd::Variable(y).current_version() == version);
+  }
+  REQUIRE(torch::autograd::GradMode::is_enabled());
+  REQUIRE(!torch::autograd::InferenceMode::is_enabled());
+  y.add_(x);
+  REQUIRE(torch::autograd::Variable(y).current_version() == version + 1);
+}
+
 TEST_CASE("autograd") {
   torch::manual_seed(0);
   auto x = torch::randn({3, 3}, torch::requires_grad());
@@ -47,6 +66,21 @@ TEST_CASE("autograd") {
     z.sum().backward(torch::ones({}) * 2);
     REQUIRE(x.grad().allclose(y * 2));
   }
+  SECTION("hooks") {
+    torch::autograd::Variable leaf(x);
+    torch::autograd::Variable interior(z);
+    leaf.register_hook([](const torch::autograd::Variable& grad) {
+      return torch::autograd::Variable(grad * 3);
+    });
+    int calls = 0;
+    interior.register_hook([&](const torch::autograd::Variable& grad) {
+      ++calls;
+      return torch::autograd::Variable();
+    });
+    z.sum().backward();
+    REQUIRE(calls == 1);
+    REQUIRE(x.grad().allclose(y * 3));
+  }
   // Assume everything else is safe from PyTorch tests.
 }
 
@@ -410,6 +410,149 @@ TEST_CASE("module/buffers") {
   }
 }
 
+TEST_CASE("module/cached-cursors") {
+  struct Child : Module {
+    Child() {
+      a = register_parameter("a", torch::zeros({2}));
+    }
+    void add_b() {
+      b = register_parameter("b", torch::ones({2}));
+    }
+    torch::Tensor a, b;
+  };
+  struct Parent : Module {
+    Parent() {
+      child = register_module("child", std::make_shared<Child>());
+      register_buffer("c", torch::zeros({2}));
+    }
+    std::shared_ptr<Child> child;
+  };
+
+  Parent parent;
+
+  SECTION("cursors share their items") {
+    auto first = parent.parameters();
+    auto second = parent.parameters();
+    REQUIRE(&first[0] == &second[0]);
+    auto first_buffers = parent.buffers();
+    auto second_buffers = parent.buffers();
+    REQUIRE(&first_buffers[0] == &second_buffers[0]);
+  }
+
+  SECTION("registering a parameter in a child updates the parent's cursor") {
+    REQUIRE(parent.parameters().size() == 1);
+    parent.child->add_b();
+    auto parameters = parent.parameters();
+    REQUIRE(parameters.size() == 2);
+    REQUIRE(parameters.contains("child.a"));
+    REQUIRE(parameters.contains("child.b"));
+    // The earlier cursor keeps its items.
+    REQUIRE(parent.parameters().size() == 2);
+  }
+
+  SECTION("const cursors are cached separately") {
+    const Parent& const_parent = parent;
+    REQUIRE(const_parent.parameters().size() == 1);
+    parent.child->add_b();
+    REQUIRE(const_parent.parameters().size() == 2);
+  }
+
+  SECTION("copies of a module have their own items") {
+    Parent copy = parent;
+    REQUIRE(&*copy.buffers()[0] != &*parent.buffers()[0]);
+  }
+}
+
+TEST_CASE("module/flatten_parameters") {
+  torch::manual_seed(0);
+  Linear module(3, 4);
+  auto weight = module->weight.clone();
+  auto bias = module->bias.clone();
+  auto flat = module->flatten_parameters();
+
+  SECTION("preserves the values of the parameters") {
+    REQUIRE(flat.numel() == 16);
+    REQUIRE(flat.is_contiguous());
+    REQUIRE(module->weight.allclose(weight));
+    REQUIRE(module->bias.allclose(bias));
+    REQUIRE(flat.slice(0, 12).allclose(bias));
+  }
+
+  SECTION("parameters are views into the flat tensor") {
+    {
+      torch::NoGradGuard guard;
+      flat.fill_(3);
+    }
+    REQUIRE(module->weight.sum().toCFloat() == 36);
+    REQUIRE(module->bias.sum().toCFloat() == 12);
+  }
+
+  SECTION("gradients are accumulated into the flat gradient") {
+    REQUIRE(flat.grad().defined());
+    REQUIRE(flat.grad().sum().toCFloat() == 0);
+    auto input = torch::ones({8, 3});
+    module->forward(input).sum().backward();
+    REQUIRE(flat.grad().slice(0, 12).sum().toCFloat() == 32);
+    REQUIRE(flat.grad().slice(0, 0, 12).sum().toCFloat() == 96);
+    module->zero_grad();
+    REQUIRE(flat.grad().sum().toCFloat() == 0);
+  }
+
+  SECTION("requires all parameters to have the same dtype") {
+    at::detail::set_data(
+        module->bias,
+        torch::autograd::Variable(module->bias).data().to(torch::kFloat64));
+    REQUIRE_THROWS_WITH(
+        module->flatten_parameters(),
+        StartsWith("flatten_parameters() requires all parameters to have "
+                   "the same dtype and device"));
+  }
+}
+
+TEST_CASE("module/shallow_replica") {
+  torch::manual_seed(0);
+  struct TestModule : public Cloneable<TestModule> {
+    TestModule() {
+      reset();
+    }
+    void reset() override {
+      linear = register_module("linear", Linear(2, 2));
+      running = register_buffer("running", torch::zeros({2}));
+    }
+    Linear linear{nullptr};
+    torch::Tensor running;
+  };
+
+  auto module = std::make_shared<TestModule>();
+  auto replica =
+      std::dynamic_pointer_cast<TestModule>(module->shallow_replica());
+  REQUIRE(replica != nullptr);
+
+  SECTION("shares the data of the parameters") {
+    REQUIRE(
+        replica->linear->weight.data_ptr() == module->linear->weight.data_ptr());
+    REQUIRE(
+        replica->linear->bias.data_ptr() == module->linear->bias.data_ptr());
+    auto x = torch::randn({4, 2});
+    REQUIRE(replica->linear->forward(x).equal(module->linear->forward(x)));
+  }
+
+  SECTION("copies the buffers") {
+    REQUIRE(replica->running.data_ptr() != module->running.data_ptr());
+    {
+      torch::NoGradGuard no_grad;
+      replica->running.fill_(1);
+    }
+    REQUIRE(module->running.sum().toCFloat() == 0);
+  }
+
+  SECTION("clone() still copies the parameters afterwards") {
+    auto clone = std::dynamic_pointer_cast<TestModule>(module->clone());
+    REQUIRE(
+        clone->linear->weight.data_ptr() != module->linear->weight.data_ptr());
+  }
+}
+
 TEST_CASE("module/default-constructor") {
   struct AImpl : torch::nn::Module {
     AImpl() : x_(123) {}
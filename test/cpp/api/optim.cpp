@@ -316,6 +316,146 @@ TEST_CASE("Optim/ExternalVectorOfParameters") {
   REQUIRE(parameters[2].allclose(original_parameters[2] - 1.0));
 }
 
+template <typename OptimizerClass, typename Options>
+void check_sparse_gradient_matches_dense(Options options) {
+  torch::manual_seed(0);
+
+  auto sparse_parameter = torch::randn({10, 3});
+  auto dense_parameter = sparse_parameter.clone();
+  OptimizerClass sparse_optimizer(
+      std::vector<torch::Tensor>{sparse_parameter}, options);
+  OptimizerClass dense_optimizer(
+      std::vector<torch::Tensor>{dense_parameter}, options);
+
+  // Rows 1, 4 and 7, with row 4 given twice so it has to be coalesced. Always
+  // touching the same rows makes lazy updates agree with dense ones.
+  auto indices = torch::tensor({1, 4, 7, 4}, torch::kInt64).view({1, 4});
+  for (size_t step = 0; step < 3; ++step) {
+    auto values = torch::randn({4, 3});
+    auto gradient = torch::sparse_coo_tensor(indices, values, {10, 3});
+    sparse_parameter.grad() = gradient;
+    dense_parameter.grad() = gradient.to_dense();
+    sparse_optimizer.step();
+    dense_optimizer.step();
+    REQUIRE(sparse_parameter.allclose(dense_parameter));
+  }
+}
+
+TEST_CASE("Optim/SparseGradient") {
+  SECTION("SGD") {
+    check_sparse_gradient_matches_dense<SGD>(SGDOptions(0.1));
+  }
+  SECTION("Adagrad") {
+    check_sparse_gradient_matches_dense<Adagrad>(AdagradOptions(0.1).lr_decay(1e-3));
+  }
+  SECTION("Adam") {
+    check_sparse_gradient_matches_dense<Adam>(AdamOptions(0.1));
+  }
+  SECTION("AdamWithAmsgrad") {
+    check_sparse_gradient_matches_dense<Adam>(AdamOptions(0.1).amsgrad(true));
+  }
+  SECTION("LazyAdam") {
+    // Rows without a gradient keep their moments instead of decaying them.
+    torch::manual_seed(0);
+    auto parameter = torch::randn({4, 2});
+    Adam optimizer(std::vector<torch::Tensor>{parameter}, AdamOptions(0.1));
+    auto first = torch::tensor({0}, torch::kInt64).view({1, 1});
+    parameter.grad() = torch::sparse_coo_tensor(first, torch::ones({1, 2}), {4, 2});
+    optimizer.step();
+    auto after_first = parameter.clone();
+    auto second = torch::tensor({2}, torch::kInt64).view({1, 1});
+    parameter.grad() = torch::sparse_coo_tensor(second, torch::ones({1, 2}), {4, 2});
+    optimizer.step();
+    REQUIRE(parameter[0].allclose(after_first[0]));
+    REQUIRE(!parameter[2].allclose(after_first[2]));
+  }
+}
+
+TEST_CASE("Optim/Fused/ProducesPyTorchValues") {
+  SECTION("SGD") {
+    check_exact_values<SGD>(
+        SGDOptions(0.1).fused(true), expected_parameters::SGD);
+  }
+  SECTION("Adam") {
+    check_exact_values<Adam>(
+        AdamOptions(1.0).fused(true), expected_parameters::Adam);
+  }
+  SECTION("AdamWithWeightDecayAndAMSGrad") {
+    check_exact_values<Adam>(
+        AdamOptions(1.0).weight_decay(1e-6).amsgrad(true).fused(true),
+        expected_parameters::Adam_with_weight_decay_and_amsgrad);
+  }
+  SECTION("RMSpropWithWeightDecayAndCenteredAndMomentum") {
+    check_exact_values<RMSprop>(
+        RMSpropOptions(0.1)
+            .weight_decay(1e-6)
+            .centered(true)
+            .momentum(0.9)
+            .fused(true),
+        expected_parameters::
+            RMSprop_with_weight_decay_and_centered_and_momentum);
+  }
+}
+
+template <typename OptimizerClass, typename Options>
+void check_fused_matches_unfused(Options options, torch::Device device) {
+  torch::manual_seed(0);
+
+  // More parameters than fit in one launch, and one that spans many chunks.
+  std::vector<torch::Tensor> parameters;
+  for (int64_t i = 0; i < 150; ++i) {
+    parameters.push_back(torch::randn({i % 7, 3}, device));
+  }
+  parameters.push_back(torch::randn({300000}, device));
+  std::vector<torch::Tensor> fused_parameters;
+  for (const auto& parameter : parameters) {
+    fused_parameters.push_back(parameter.clone());
+  }
+
+  OptimizerClass optimizer(parameters, options);
+  OptimizerClass fused_optimizer(fused_parameters, options.fused(true));
+  for (size_t step = 0; step < 3; ++step) {
+    for (size_t i = 0; i < parameters.size(); ++i) {
+      auto gradient = torch::randn_like(parameters[i]);
+      parameters[i].grad() = gradient;
+      fused_parameters[i].grad() = gradient.clone();
+    }
+    optimizer.step();
+    fused_optimizer.step();
+    for (size_t i = 0; i < parameters.size(); ++i) {
+      REQUIRE(fused_parameters[i].allclose(parameters[i], 1e-4, 1e-5));
+    }
+  }
+}
+
+TEST_CASE("Optim/Fused/MatchesUnfused") {
+  SECTION("SGDWithNesterovMomentum") {
+    check_fused_matches_unfused<SGD>(
+        SGDOptions(0.1).momentum(0.9).nesterov(true), torch::kCPU);
+  }
+  SECTION("Adam") {
+    check_fused_matches_unfused<Adam>(AdamOptions(0.1), torch::kCPU);
+  }
+  SECTION("RMSprop") {
+    check_fused_matches_unfused<RMSprop>(RMSpropOptions(0.1), torch::kCPU);
+  }
+}
+
+TEST_CASE("Optim/Fused/MatchesUnfused/CUDA", "[cuda]") {
+  SECTION("SGDWithNesterovMomentum") {
+    check_fused_matches_unfused<SGD>(
+        SGDOptions(0.1).momentum(0.9).nesterov(true), torch::kCUDA);
+  }
+  SECTION("AdamWithAmsgrad") {
+    check_fused_matches_unfused<Adam>(
+        AdamOptions(0.1).amsgrad(true), torch::kCUDA);
+  }
+  SECTION("RMSpropWithCenteredAndMomentum") {
+    check_fused_matches_unfused<RMSprop>(
+        RMSpropOptions(0.1).centered(true).momentum(0.9), torch::kCUDA);
+  }
+}
+
 TEST_CASE("Optim/AddParameter/LBFGS") {
   torch::manual_seed(0);
 
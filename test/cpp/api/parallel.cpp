@@ -104,6 +104,43 @@ TEST_CASE("Parallel/Replicate", "[multi-cuda]") {
   }
 }
 
+TEST_CASE("Parallel/ReplicateBroadcastsAndReducesGradients", "[multi-cuda]") {
+  Linear linear(3, 4);
+  linear->to({torch::kCUDA, 0});
+  auto replicas = parallel::replicate(
+      linear, {torch::Device(torch::kCUDA, 0), torch::Device(torch::kCUDA, 1)});
+  REQUIRE(replicas.size() == 2);
+
+  auto original_parameters = linear->parameters();
+  auto replica1_parameters = replicas[0]->parameters();
+  auto replica2_parameters = replicas[1]->parameters();
+  for (size_t i = 0; i < original_parameters.size(); ++i) {
+    // the replica on the module's device shares its parameters
+    REQUIRE(
+        replica1_parameters[i].data<float>() ==
+        original_parameters[i].data<float>());
+    REQUIRE(replica2_parameters[i]->device() == torch::Device(torch::kCUDA, 1));
+    REQUIRE(replica2_parameters[i]->to(torch::Device(torch::kCUDA, 0))
+                .allclose(*original_parameters[i]));
+  }
+
+  auto input = torch::ones({2, 3}, torch::device({torch::kCUDA, 0}));
+  auto output = replicas[0]->forward(input).sum() +
+      replicas[1]->forward(input.to({torch::kCUDA, 1})).sum().to(
+          {torch::kCUDA, 0});
+  output.backward();
+
+  // the gradients of both replicas are summed into the module's parameters:
+  // each one contributes the sum over the batch of two rows of ones
+  auto weight_grad = linear->parameters()["weight"].grad();
+  REQUIRE(weight_grad.device() == torch::Device(torch::kCUDA, 0));
+  REQUIRE(weight_grad.allclose(
+      torch::full({4, 3}, 4, torch::device({torch::kCUDA, 0}))));
+  auto bias_grad = linear->parameters()["bias"].grad();
+  REQUIRE(bias_grad.allclose(
+      torch::full({4}, 4, torch::device({torch::kCUDA, 0}))));
+}
+
 TEST_CASE("Parallel/ParallelApply", "[multi-cuda]") {
   Linear a(3, 4);
 
@@ -178,6 +178,31 @@ TEST_CASE("sequential") {
     }
   }
 
+  SECTION("forward() mixes unboxed and boxed modules") {
+    struct Double : torch::nn::Module {
+      torch::Tensor forward(torch::Tensor x) {
+        return x * 2;
+      }
+    };
+    struct Sum : torch::nn::Module {
+      float forward(torch::Tensor x) {
+        return x.sum().toCFloat();
+      }
+    };
+    struct Increment : torch::nn::Module {
+      torch::Tensor forward(float x) {
+        return torch::ones(1) * (x + 1);
+      }
+    };
+
+    Sequential sequential(Double{}, Double{}, Sum{}, Increment{}, Double{});
+    REQUIRE(sequential->forward(torch::ones(3)).toCFloat() == 26);
+    REQUIRE(sequential->forward(torch::ones(3)).toCFloat() == 26);
+    REQUIRE_THROWS_WITH(
+        sequential->forward<int>(torch::ones(3)),
+        StartsWith("The type of the return value is at::Tensor"));
+  }
+
   SECTION("returns the last value") {
     torch::manual_seed(0);
     Sequential sequential(Linear(10, 3), Linear(3, 5), Linear(5, 100));
@@ -307,6 +332,66 @@ TEST_CASE("sequential") {
   }
 }
 
+TEST_CASE("sequential/forward_checkpointed") {
+  torch::manual_seed(0);
+  Sequential sequential(
+      Linear(4, 8),
+      Functional(torch::relu),
+      Dropout(0.5),
+      Linear(8, 8),
+      Functional(torch::tanh),
+      Linear(8, 2));
+  Sequential checkpointed =
+      std::dynamic_pointer_cast<SequentialImpl>(sequential->clone());
+
+  SECTION("matches forward(), including the dropout mask") {
+    for (size_t segments : {0, 1, 2, 3, 6, 10}) {
+      for (bool input_requires_grad : {false, true}) {
+        sequential->zero_grad();
+        checkpointed->zero_grad();
+        auto input = torch::randn({5, 4}).set_requires_grad(input_requires_grad);
+        auto checkpointed_input = input.detach().set_requires_grad(input_requires_grad);
+
+        torch::manual_seed(1);
+        auto output = sequential->forward(input);
+        output.sum().backward();
+        torch::manual_seed(1);
+        auto checkpointed_output =
+            checkpointed->forward_checkpointed(checkpointed_input, segments);
+        checkpointed_output.sum().backward();
+
+        REQUIRE(checkpointed_output.allclose(output));
+        if (input_requires_grad) {
+          REQUIRE(checkpointed_input.grad().allclose(input.grad()));
+        }
+        auto parameters = sequential->parameters();
+        auto checkpointed_parameters = checkpointed->parameters();
+        for (auto& parameter : parameters) {
+          REQUIRE(checkpointed_parameters[parameter.key].grad().allclose(
+              parameter->grad()));
+        }
+      }
+    }
+  }
+
+  SECTION("does not disturb the random numbers drawn after it") {
+    torch::manual_seed(2);
+    checkpointed->forward_checkpointed(torch::randn({5, 4}), 2).sum().backward();
+    auto after_checkpointed = torch::rand({3});
+    torch::manual_seed(2);
+    checkpointed->forward(torch::randn({5, 4}));
+    REQUIRE(torch::rand({3}).allclose(after_checkpointed));
+  }
+
+  SECTION("calling forward_checkpointed() on an empty sequential is disallowed") {
+    Sequential empty;
+    REQUIRE_THROWS_WITH(
+        empty->forward_checkpointed(torch::ones({1})),
+        StartsWith(
+            "Cannot call forward_checkpointed() on an empty Sequential"));
+  }
+}
+
 TEST_CASE("sequential/clone-to-device", "[cuda]") {
   Sequential sequential(Linear(3, 4), Functional(torch::relu), BatchNorm(3));
   torch::Device device(torch::kCUDA, 0);
@@ -319,3 +404,50 @@ TEST_CASE("sequential/clone-to-device", "[cuda]") {
     REQUIRE(b->device() == device);
   }
 }
+
+TEST_CASE("static-sequential") {
+  torch::manual_seed(0);
+  SECTION("chains the modules statically") {
+    struct M : torch::nn::Module {
+      explicit M(int value_) : value(value_) {}
+      int forward(int x) {
+        REQUIRE(x == value);
+        return x + 1;
+      }
+      int value;
+    };
+    struct N : torch::nn::Module {
+      std::string forward(int x) {
+        return std::to_string(x);
+      }
+    };
+    StaticSequential<M, M, N> sequential(M(1), std::make_shared<M>(2), N{});
+    REQUIRE(sequential->size() == 3);
+    REQUIRE(sequential->get<1>()->value == 2);
+    std::string output = sequential->forward(1);
+    REQUIRE(output == "3");
+  }
+
+  SECTION("matches Sequential") {
+    Linear first(10, 3), second(3, 5);
+    Sequential sequential(first, Functional(torch::relu), second);
+    StaticSequential<Linear, Functional, Linear> static_sequential(
+        first, Functional(torch::relu), second);
+
+    auto x = torch::randn({8, 10});
+    REQUIRE(static_sequential->forward(x).equal(sequential->forward(x)));
+    REQUIRE(static_sequential->parameters().size() == 4);
+    REQUIRE(static_sequential->parameters().contains("0.weight"));
+    REQUIRE(static_sequential->parameters().contains("2.bias"));
+  }
+
+  SECTION("clone() deep copies the modules") {
+    StaticSequential<Linear, Linear> sequential(Linear(2, 3), Linear(3, 4));
+    auto clone = std::dynamic_pointer_cast<decltype(sequential)::ContainedType>(
+        sequential->clone());
+    REQUIRE(clone != nullptr);
+    REQUIRE(clone->get<0>() != sequential->get<0>());
+    auto x = torch::randn({5, 2});
+    REQUIRE(clone->forward(x).equal(sequential->forward(x)));
+  }
+}
@@ -5,6 +5,7 @@
 #include <torch/nn/modules/sequential.h>
 #include <torch/optim/optimizer.h>
 #include <torch/optim/sgd.h>
+#include <torch/checkpoint.h>
 #include <torch/serialization.h>
 #include <torch/tensor.h>
 #include <torch/utils.h>
@@ -13,6 +14,8 @@
 
 #include <cereal/archives/portable_binary.hpp>
 
+#include <cstdio>
+#include <fstream>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -28,6 +31,15 @@ Sequential xor_model() {
       Linear(8, 1),
       Functional(at::sigmoid));
 }
+
+/// A temporary file that is removed when it goes out of scope.
+struct TemporaryFile {
+  TemporaryFile() : name(std::tmpnam(nullptr)) {}
+  ~TemporaryFile() {
+    std::remove(name.c_str());
+  }
+  std::string name;
+};
 } // namespace
 
 TEST_CASE("serialization") {
@@ -284,6 +296,89 @@ TEST_CASE("serialization") {
   }
 }
 
+TEST_CASE("checkpoint") {
+  torch::manual_seed(0);
+  TemporaryFile file;
+
+  SECTION("tensors") {
+    torch::NamedTensors tensors = {
+        {"float", torch::randn({3, 4})},
+        {"long", torch::arange(10, torch::kInt64)},
+        {"scalar", torch::randn({})},
+        {"empty", torch::randn({0, 5})},
+        {"non-contiguous", torch::randn({4, 3}).t()}};
+    torch::save_checkpoint(file.name, tensors);
+
+    for (bool populate : {false, true}) {
+      auto loaded = torch::load_checkpoint(
+          file.name, torch::CheckpointLoadOptions().populate(populate));
+      REQUIRE(loaded.size() == tensors.size());
+      for (size_t i = 0; i < tensors.size(); ++i) {
+        REQUIRE(loaded[i].first == tensors[i].first);
+        REQUIRE(loaded[i].second.dtype() == tensors[i].second.dtype());
+        REQUIRE(loaded[i].second.sizes().equals(tensors[i].second.sizes()));
+        REQUIRE(loaded[i].second.equal(tensors[i].second));
+        // the storage of every tensor starts at a page boundary of the file
+        REQUIRE(reinterpret_cast<uintptr_t>(loaded[i].second.data_ptr()) % 4096 == 0);
+      }
+    }
+  }
+
+  SECTION("chunked") {
+    torch::NamedTensors tensors = {
+        {"a", torch::randn({1000})},
+        {"b", torch::arange(3, torch::kInt64)},
+        {"c", torch::randn({0})}};
+    // not a multiple of the element size, so chunks split elements
+    torch::save_checkpoint(
+        file.name,
+        tensors,
+        torch::CheckpointSaveOptions().threads(3).chunk_size(1001));
+    auto loaded = torch::load_checkpoint(
+        file.name, torch::CheckpointLoadOptions().populate(true).threads(2));
+    REQUIRE(loaded.size() == tensors.size());
+    for (size_t i = 0; i < tensors.size(); ++i) {
+      REQUIRE(loaded[i].second.equal(tensors[i].second));
+    }
+  }
+
+  SECTION("writes do not change the file") {
+    torch::save_checkpoint(file.name, {{"x", torch::zeros({8})}});
+    auto x = torch::load_checkpoint(file.name)[0].second;
+    x.fill_(1);
+    REQUIRE(torch::load_checkpoint(file.name)[0].second.sum().toCFloat() == 0);
+  }
+
+  SECTION("modules") {
+    auto model = xor_model();
+    auto model2 = xor_model();
+    torch::save_checkpoint(file.name, *model);
+    torch::load_checkpoint(file.name, *model2);
+    auto params = model->parameters();
+    auto params2 = model2->parameters();
+    for (const auto& p : params) {
+      REQUIRE(params2[p.key].equal(p.value));
+      REQUIRE(params2[p.key].requires_grad());
+    }
+    // the parameters can be trained
+    model2->forward<torch::Tensor>(torch::ones({1, 2})).sum().backward();
+    REQUIRE(params2["0.weight"].grad().defined());
+
+    REQUIRE_THROWS_WITH(
+        torch::load_checkpoint(file.name, *Sequential(Linear(2, 8))),
+        Catch::StartsWith("Expected 2 parameters"));
+  }
+
+  SECTION("invalid files") {
+    {
+      std::ofstream stream(file.name, std::ios::binary);
+      stream << "not a checkpoint";
+    }
+    REQUIRE_THROWS_WITH(
+        torch::load_checkpoint(file.name), Catch::Contains("is not a checkpoint file"));
+  }
+}
+
 TEST_CASE("serialization_cuda", "[cuda]") {
   torch::manual_seed(0);
   // We better be able to save and load a XOR model!
@@ -504,6 +504,38 @@ class TestCaffe2Backend(unittest.TestCase):
         underlying = nn.BatchNorm2d(3)
         self.run_model_test(underlying, train=True, batch_size=BATCH_SIZE)
 
+    def test_constant_folding(self):
+        model = nn.Sequential(nn.Conv2d(3, 4, 3, bias=False), nn.BatchNorm2d(4),
+                              nn.Conv2d(4, 5, 3), nn.BatchNorm2d(5))
+        for bn in (model[1], model[3]):
+            bn.running_mean.uniform_()
+            bn.running_var.uniform_(0.5, 1.5)
+        model.train(False)
+        input = torch.randn(BATCH_SIZE, 3, 16, 16)
+
+        f = io.BytesIO()
+        torch_out = torch.onnx._export(model, input, f, do_constant_folding=True)
+        mp = onnx.ModelProto.FromString(f.getvalue())
+        self.assertEqual([node.op_type for node in mp.graph.node], ['Conv', 'Conv'])
+        # only the folded weights and biases are left
+        self.assertEqual(len(mp.graph.initializer), 4)
+
+        caffe2_out = c2.prepare(mp, device='CPU').run(input.numpy())[0]
+        np.testing.assert_allclose(torch_out.detach().numpy(), caffe2_out, rtol=1e-3, atol=1e-5)
+
+    def test_constant_folding_linear(self):
+        model = nn.Linear(5, 3)
+        input = torch.randn(BATCH_SIZE, 5)
+
+        f = io.BytesIO()
+        torch_out = torch.onnx._export(model, input, f, do_constant_folding=True)
+        mp = onnx.ModelProto.FromString(f.getvalue())
+        # the weight is transposed at export time
+        self.assertNotIn('Transpose', [node.op_type for node in mp.graph.node])
+
+        caffe2_out = c2.prepare(mp, device='CPU').run(input.numpy())[0]
+        np.testing.assert_allclose(torch_out.detach().numpy(), caffe2_out, rtol=1e-3, atol=1e-5)
+
     def _test_index_generic(self, fn):
         class MyModel(torch.nn.Module):
             def __init__(self):
@@ -1,5 +1,10 @@
 import contextlib
 import gc
+import json
+import os
+import shutil
+import tempfile
+import threading
 import sys
 import math
 import torch
@@ -205,6 +210,25 @@ class TestAutograd(TestCase):
         x_grad, x_grad_clone = compute_grad(create_graph=True)
         self.assertEqual(x_grad, x_grad_clone)
 
+    def test_accumulate_grad_steals_buffers(self):
+        grad_output = torch.randn(5, 5)
+        grad_output_clone = grad_output.clone()
+        x = torch.randn(5, 5, requires_grad=True)
+        # the gradients of y are summed in the InputBuffer of y's grad_fn
+        y = x * 2
+        z = y * 3 + y * 4 + y.exp()
+        z.backward(grad_output)
+        expected = grad_output * (7 + y.detach().exp()) * 2
+        self.assertEqual(x.grad, expected)
+        # gradients referenced from outside of the engine are never modified
+        self.assertEqual(grad_output, grad_output_clone)
+
+        # a stolen .grad keeps accumulating correctly
+        x_grad = x.grad
+        (x * 2).sum().backward()
+        self.assertEqual(x.grad, expected + 2)
+        self.assertIs(x.grad, x_grad)
+
     def test_hessian_vector(self):
         x = torch.randn(2, 2, requires_grad=True)
         y = torch.randn(2, 2, requires_grad=True)
@@ -448,6 +472,33 @@ class TestAutograd(TestCase):
         sum(fn(x, y)).sum().backward()
         self.assertTrue(was_called[0])
 
+    def test_backward_order_longest_path_first(self):
+        # WARNING: this is a test for autograd internals.
+        # The branch with the longest path left is run first, even though
+        # the other branch was recorded last.
+        order = []
+        a = torch.randn(5, requires_grad=True)
+        b = torch.randn(5, requires_grad=True)
+        long_branch = a.exp().exp().exp()
+        short_branch = b * 3
+        long_branch.register_hook(lambda grad: order.append('long'))
+        short_branch.register_hook(lambda grad: order.append('short'))
+        (long_branch.sum() + short_branch.sum()).backward()
+        self.assertEqual(order, ['long', 'short'])
+
+    def test_backward_order_post_hooks_first(self):
+        # WARNING: this is a test for autograd internals.
+        # Functions leading to a function with post hooks (e.g. the gradient
+        # accumulators hooked by DistributedDataParallel) are run first.
+        order = []
+        a = torch.randn(5, requires_grad=True)
+        b = torch.randn(5, requires_grad=True)
+        grad_accumulator = a.expand_as(a).grad_fn.next_functions[0][0]
+        grad_accumulator.register_hook(lambda grad_input, grad_output: order.append('a'))
+        b.register_hook(lambda grad: order.append('b'))
+        ((a * 2).sum() + b.exp().exp().exp().sum()).backward()
+        self.assertEqual(order, ['a', 'b'])
+
     def test_retain_grad(self):
         input = torch.rand(1, 3, requires_grad=True)
         h1 = input * 3
@@ -1287,6 +1338,16 @@ class TestAutograd(TestCase):
         gradcheck(func, [x])
         gradgradcheck(func, [x])
 
+    def test_var_mean_std_mean(self):
+        x = torch.randn(4, 5, dtype=torch.double, requires_grad=True)
+        for fn in [torch.var_mean, torch.std_mean]:
+            gradcheck(lambda x: fn(x), [x])
+            gradcheck(lambda x: fn(x, 1, keepdim=True), [x])
+            gradgradcheck(lambda x: fn(x, 0, unbiased=False), [x])
+            # only one of the outputs used
+            gradcheck(lambda x: fn(x, 1)[0], [x])
+            gradcheck(lambda x: fn(x, 1)[1], [x])
+
     def test_stack(self):
         x = torch.randn(10, 10, requires_grad=True)
         y = torch.randn(10, 10, requires_grad=True)
@@ -1938,6 +1999,28 @@ class TestAutograd(TestCase):
         run_test(upper=True)
         run_test(upper=False)
 
+    def test_cdist(self):
+        for D in [3, 20]:
+            x = torch.randn(4, D, dtype=torch.double, requires_grad=True)
+            y = torch.randn(5, D, dtype=torch.double, requires_grad=True)
+            for p in [1, 2, 3.5, float('inf')]:
+                gradcheck(lambda x, y: torch.cdist(x, y, p), [x, y])
+
+    @skipIfNoLapack
+    def test_cholesky_batched(self):
+        root = torch.tril(torch.rand(3, S, S)) + torch.eye(S)
+        root.requires_grad_()
+
+        def run_test(upper):
+            def func(root):
+                x = torch.matmul(root, root.transpose(-2, -1))
+                return torch.cholesky(x, upper)
+
+            gradcheck(func, [root])
+
+        run_test(upper=True)
+        run_test(upper=False)
+
     @skipIfNoLapack
     def test_trtrs(self):
         def _test_with_size(N, C):
@@ -2121,6 +2204,54 @@ class TestAutograd(TestCase):
             self.assertEqual(info.name, expected_name)
             last_end = info.cpu_interval.end
 
+    def test_profiler_shapes(self):
+        x = torch.randn(3, 4)
+        y = torch.randn(4, 5)
+
+        with profile(record_shapes=True) as p:
+            torch.mm(x, y)
+            torch.mm(y.t(), x.t())
+
+        mm = [evt for evt in p.function_events if evt.name == 'mm']
+        self.assertEqual(len(mm), 2)
+        self.assertEqual(mm[0].input_shapes, [[3, 4], [4, 5]])
+        self.assertEqual(mm[0].input_dtypes, ['Float', 'Float'])
+        self.assertEqual(mm[1].input_shapes, [[5, 4], [4, 3]])
+        by_shape = [evt for evt in p.key_averages(group_by_input_shape=True) if evt.key == 'mm']
+        self.assertEqual(len(by_shape), 2)
+
+        with profile() as p:
+            torch.mm(x, y)
+        self.assertEqual(p.function_events[0].input_shapes, [])
+
+    def test_profiler_chrome_trace(self):
+        x = torch.randn(10, 10, requires_grad=True)
+
+        torch.autograd._enable_profiler(torch.autograd.ProfilerState.CPU)
+        (x * 2).sum().backward()
+        records = torch.autograd._disable_profiler()
+
+        tmpdir = tempfile.mkdtemp()
+        try:
+            path = os.path.join(tmpdir, 'trace.json')
+            torch.autograd._export_chrome_trace(records, path)
+            with open(path) as f:
+                trace = json.load(f)
+        finally:
+            shutil.rmtree(tmpdir)
+
+        def first_range(name):
+            ranges = [evt for evt in trace if evt['ph'] == 'X' and evt['name'] == name]
+            self.assertTrue(ranges)
+            return min(ranges, key=lambda evt: evt['ts'])
+
+        mul = first_range('mul')
+        mul_backward = first_range('MulBackward0')
+        self.assertGreaterEqual(mul['ts'], 0)
+        self.assertGreater(mul_backward['ts'], mul['ts'])
+        # the backward Function has the sequence number of the op that made it
+        self.assertEqual(mul['args']['sequence_nr'], mul_backward['args']['sequence_nr'])
+
     def test_dir(self):
         x = torch.randn(10, 10)
         keys = dir(x)
@@ -2427,6 +2558,28 @@ class TestAutograd(TestCase):
         out.sum().backward()
         self.assertFalse(s.grad is None or s.grad.abs().sum().item() == 0)
 
+    @unittest.skipIf(not torch.cuda.is_available(), "CUDA unavailable")
+    @skipIfRocm
+    def test_saved_variable_offload_cuda(self):
+        def run():
+            torch.manual_seed(0)
+            x = torch.randn(64, 64, device='cuda', requires_grad=True)
+            w = torch.randn(64, 64, device='cuda', requires_grad=True)
+            y = x
+            for _ in range(6):
+                y = torch.tanh(y.mm(w)).t()
+            y.sum().backward()
+            return x.grad, w.grad
+
+        expected = run()
+        torch.autograd._enable_saved_variable_offload(1024, prefetch_distance=2)
+        try:
+            actual = run()
+        finally:
+            torch.autograd._disable_saved_variable_offload()
+        self.assertEqual(expected[0], actual[0])
+        self.assertEqual(expected[1], actual[1])
+
     def test_anomaly_detect_nan(self):
         size = 10
 
@@ -2466,6 +2619,76 @@ class TestAutograd(TestCase):
                     out.backward()
             self.assertIn('MyFunc.apply', str(w[0].message))
 
+    def test_anomaly_detect_nonfinite_lightweight(self):
+        size = 10
+
+        class MyFunc(Function):
+            @staticmethod
+            def forward(ctx, inp, fill):
+                ctx.fill = fill
+                return inp.sum(0, keepdim=True)
+
+            @staticmethod
+            def backward(ctx, gO):
+                gI = gO.clone().expand(size)
+                gI[0] = ctx.fill
+                return gI, None
+
+        def run(fill):
+            inp = torch.rand(size, requires_grad=True)
+            out = MyFunc.apply(inp, fill).exp()
+            out.backward()
+
+        for fill in (float('nan'), float('inf')):
+            with self.assertRaisesRegex(RuntimeError, "Function 'MyFuncBackward' returned non-finite values in its 0th output."):
+                with warnings.catch_warnings(record=True) as w:
+                    with detect_anomaly(lightweight=True):
+                        run(fill)
+                self.assertIn('test_anomaly_detect_nonfinite_lightweight', str(w[0].message))
+
+        with detect_anomaly(lightweight=True):
+            run(0)  # Should not fail
+
+        # Sampling the tracebacks doesn't affect the check
+        with self.assertRaisesRegex(RuntimeError, "returned non-finite values"):
+            with warnings.catch_warnings(record=True):
+                with detect_anomaly(lightweight=True, stack_every=1000):
+                    run(float('nan'))
+
+        self.assertFalse(torch.is_anomaly_enabled())
+        self.assertFalse(torch._C._is_anomaly_lightweight())
+        self.assertEqual(torch._C._get_anomaly_stack_every(), 1)
+
+    def test_python_functions_multithreaded(self):
+        class Double(Function):
+            @staticmethod
+            def forward(ctx, x):
+                return x * 2
+
+            @staticmethod
+            def backward(ctx, grad):
+                return grad * 2
+
+        def run(results, i):
+            x = torch.randn(5, 5, requires_grad=True)
+            x.register_hook(lambda grad: grad + 1)
+            y = x
+            for _ in range(10):
+                y = Double.apply(y)
+            y.sum().backward()
+            results[i] = (x.grad, torch.autograd._last_gil_wait_time())
+
+        results = [None] * 4
+        threads = [threading.Thread(target=run, args=(results, i)) for i in range(len(results))]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        for grad, gil_wait_time in results:
+            self.assertEqual(grad, torch.full((5, 5), 2 ** 10 + 1))
+            self.assertIsInstance(gil_wait_time, float)
+            self.assertGreaterEqual(gil_wait_time, 0)
+
     @skipIfRocm
     def test_symeig_no_eigenvectors(self):
         A = torch.tensor([[1., 2.], [2., 4.]], dtype=torch.float32, requires_grad=True)
@@ -3045,6 +3268,7 @@ method_tests = [
     ('index_fill', (), (0, torch.tensor([0], dtype=torch.int64), 2), 'scalar_input_dim', [0]),
     ('index_fill', (), (0, torch.tensor(0, dtype=torch.int64), 2), 'scalar_both_dim', [0]),
     ('inverse', (S, S), NO_ARGS, '', NO_ARGS, [skipIfNoLapack]),
+    ('inverse', (3, S, S), NO_ARGS, 'batched', NO_ARGS, [skipIfNoLapack]),
     ('det', (S, S), NO_ARGS, '', NO_ARGS, [skipIfNoLapack]),
     ('det', (1, 1), NO_ARGS, '1x1', NO_ARGS, [skipIfNoLapack]),
     ('det', lambda: random_symmetric_matrix(S), NO_ARGS, 'symmetric', NO_ARGS, [skipIfNoLapack]),
@@ -98,6 +98,19 @@ class StoreTestBase(object):
     def test_set_get(self):
         self._test_set_get(self._create_store())
 
+    def _test_multi_set_get(self, fs):
+        fs.multi_set(["key0", "key1", "key2"], ["value0", "value1", "value2"])
+        self.assertEqual(b"value1", fs.get("key1"))
+        self.assertEqual(
+            [b"value2", b"value0", b"value1"],
+            fs.multi_get(["key2", "key0", "key1"]))
+        self.assertEqual([], fs.multi_get([]))
+        with self.assertRaisesRegex(ValueError, "as many values as keys"):
+            fs.multi_set(["key3"], [])
+
+    def test_multi_set_get(self):
+        self._test_multi_set_get(self._create_store())
+
 
 class FileStoreTest(TestCase, StoreTestBase):
     def setUp(self):
@@ -335,6 +348,111 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
         work.wait()
         self.assertEqual(torch.Tensor([float(self.world_size * (self.world_size + 1) / 2)]), x)
 
+    def test_allreduce_compression(self):
+        store = c10d.FileStore(self.file.name)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        opts = c10d.AllreduceOptions()
+        opts.compression = c10d.AllreduceCompression.FP16
+
+        # 1/3 is not exactly representable in half precision
+        third = torch.Tensor([1.0 / 3])
+        x = third.clone()
+        work = pg.allreduce([x], opts)
+        work.wait()
+        self.assertEqual(third * self.world_size, x, prec=1e-2)
+
+        # With error feedback the compression error is kept in the residual
+        residual = torch.zeros(1)
+        opts.residuals = [residual]
+        x = third.clone()
+        work = pg.allreduce([x], opts)
+        work.wait()
+        self.assertEqual(third * self.world_size, x, prec=1e-2)
+        self.assertEqual(third - third.half().float(), residual)
+        self.assertNotEqual(0, residual.item())
+
+        # Only float tensors can be compressed
+        opts.residuals = []
+        with self.assertRaisesRegex(ValueError, 'float tensors'):
+            pg.allreduce([torch.DoubleTensor([1.0])], opts)
+
+    def test_allreduce_sparse(self):
+        store = c10d.FileStore(self.file.name)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        def sparse(rows):
+            # One row per rank, and one row shared by all ranks
+            indices = torch.LongTensor([[self.rank, rows - 1]])
+            values = torch.ones(2, 2) * (self.rank + 1)
+            return torch.sparse_coo_tensor(indices, values, (rows, 2))
+
+        # Few nonzero rows are gathered, many are reduced densely
+        for rows in [100, self.world_size + 1]:
+            x = sparse(rows)
+            expected = torch.zeros(rows, 2)
+            for rank in range(self.world_size):
+                expected[rank] = rank + 1
+            expected[rows - 1] = self.world_size * (self.world_size + 1) / 2
+            work = pg.allreduce([x])
+            work.wait()
+            self.assertTrue(x.is_sparse)
+            self.assertEqual(self.world_size + 1, x._nnz())
+            self.assertEqual(expected, x.to_dense())
+
+        opts = c10d.AllreduceOptions()
+        opts.reduceOp = c10d.ReduceOp.MAX
+        with self.assertRaisesRegex(ValueError, 'ReduceOp::SUM'):
+            pg.allreduce([sparse(100)], opts)
+
+    def test_allreduce_gpu_direct_cpu(self):
+        store = c10d.FileStore(self.file.name)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        # GPUDirect only applies to CUDA tensors, CPU tensors are reduced
+        # as usual (the TCP transport can't send device memory)
+        opts = c10d.AllreduceOptions()
+        opts.gpuDirect = True
+        x = torch.Tensor([self.rank + 1.0])
+        work = pg.allreduce([x], opts)
+        work.wait()
+        self.assertEqual(torch.Tensor([float(self.world_size * (self.world_size + 1) / 2)]), x)
+
+    def test_reduce_scatter_ops(self):
+        store = c10d.FileStore(self.file.name)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        def reduce_scatter(output, inputs, op):
+            opts = c10d.ReduceScatterOptions()
+            opts.reduceOp = op
+            work = pg.reduce_scatter([output], [inputs], opts)
+            work.wait()
+
+        # Rank i contributes i + j + 1 to the slice of rank j
+        def inputs():
+            return [torch.Tensor([self.rank + j + 1.0]) for j in range(self.world_size)]
+
+        # Sum
+        x = torch.Tensor([0.0])
+        reduce_scatter(x, inputs(), c10d.ReduceOp.SUM)
+        expected = self.world_size * (self.rank + 1) + self.world_size * (self.world_size - 1) / 2
+        self.assertEqual(torch.Tensor([float(expected)]), x)
+
+        # Max
+        x = torch.Tensor([0.0])
+        reduce_scatter(x, inputs(), c10d.ReduceOp.MAX)
+        self.assertEqual(torch.Tensor([float(self.world_size + self.rank)]), x)
+
+        # Test overloaded convenience function (defaults to using sum)
+        x = torch.Tensor([0.0])
+        work = pg.reduce_scatter(x, inputs())
+        work.wait()
+        self.assertEqual(torch.Tensor([float(expected)]), x)
+
+        # Every rank needs an input tensor for every rank
+        with self.assertRaisesRegex(ValueError, 'world size'):
+            pg.reduce_scatter(x, inputs()[:-1])
+
 
 class ProcessGroupNCCLTest(TestCase):
     MAIN_PROCESS_RANK = 0
@@ -430,6 +548,50 @@ class ProcessGroupNCCLTest(TestCase):
         for i in range(self.num_gpus):
             self.assertEqual(torch.Tensor([self.num_gpus]), tensors[i])
 
+    @skip_if_not_nccl
+    def test_hierarchical_allreduce_fallback(self):
+        store = c10d.FileStore(self.file.name)
+        opts = c10d.ProcessGroupNCCL.Options()
+        opts.hierarchicalAllreduce = True
+        pg = c10d.ProcessGroupNCCL(store, self.rank, self.world_size, opts)
+
+        # A single host has nothing to gain from the hierarchical allreduce,
+        # so the flat allreduce is used, and repeatedly so
+        for _ in range(2):
+            x = torch.Tensor([self.rank + 1.0, 2.0, 3.0]).cuda(0)
+            work = pg.allreduce(x)
+            work.wait()
+            self.assertEqual(torch.Tensor([self.world_size, 2.0 * self.world_size,
+                                           3.0 * self.world_size]), x)
+
+    @skip_if_not_nccl
+    def test_init_nccl_comms(self):
+        store = c10d.FileStore(self.file.name)
+        pg = c10d.ProcessGroupNCCL(store, self.rank, self.world_size)
+        device_lists = [[i] for i in range(self.num_gpus)]
+        device_lists.append(list(range(self.num_gpus)))
+        pg.init_nccl_comms(device_lists)
+        # Device lists that already have communicators are skipped
+        pg.init_nccl_comms(device_lists)
+
+        for i in range(self.num_gpus):
+            x = torch.Tensor([i + 1.0]).cuda(i)
+            pg.allreduce(x).wait()
+            self.assertEqual(torch.Tensor([i + 1.0]), x)
+
+    @skip_if_not_nccl
+    def test_share_communicators(self):
+        store = c10d.FileStore(self.file.name)
+        opts = c10d.ProcessGroupNCCL.Options()
+        opts.shareCommunicators = True
+        pg0 = c10d.ProcessGroupNCCL(store, self.rank, self.world_size, opts)
+        pg1 = c10d.ProcessGroupNCCL(store, self.rank, self.world_size, opts)
+
+        for pg in [pg0, pg1, pg0]:
+            x = torch.Tensor([self.rank + 1.0]).cuda(0)
+            pg.allreduce(x).wait()
+            self.assertEqual(torch.Tensor([self.world_size]), x)
+
     def test_reduce_ops(self):
         store = c10d.FileStore(self.file.name)
         pg = c10d.ProcessGroupNCCL(store, self.rank, self.world_size)
@@ -478,6 +640,31 @@ class ProcessGroupNCCLTest(TestCase):
             for t in device_ts:
                 self.assertEqual(torch.Tensor([idx]), t)
 
+    @skip_if_not_nccl
+    def test_reduce_scatter_ops(self):
+        store = c10d.FileStore(self.file.name)
+        pg = c10d.ProcessGroupNCCL(store, self.rank, self.world_size)
+
+        def reduce_scatter(output_ts, input_ts):
+            work = pg.reduce_scatter(output_ts, input_ts, c10d.ReduceScatterOptions())
+            work.wait()
+
+        # Every GPU is a participant and gets one slice of the reduced inputs
+        num_ranks = self.world_size * self.num_gpus
+        output_ts = []
+        input_ts = []
+        for i in range(self.num_gpus):
+            output_ts.append(torch.Tensor([0]).cuda(i))
+            input_ts.append([torch.Tensor([i * num_ranks + j]).cuda(i)
+                             for j in range(num_ranks)])
+
+        reduce_scatter(output_ts, input_ts)
+
+        # Verification
+        base = num_ranks * self.num_gpus * (self.num_gpus - 1) / 2
+        for idx, t in enumerate(output_ts):
+            self.assertEqual(torch.Tensor([float(base + self.num_gpus * idx)]), t)
+
 
 class Net(nn.Module):
     def __init__(self):
@@ -546,6 +733,37 @@ class DistributedDataParallelTest(MultiProcessTestCase):
             torch.manual_seed(1337 + iteration)
             input = input[torch.randperm(global_batch_size)]
 
+    def test_reducer_gloo_cpu(self):
+        store = c10d.TCPStore('localhost', self.port, self.rank == 0)
+        options = c10d.ProcessGroupGloo.Options()
+        options.devices = [c10d.ProcessGroupGloo.create_tcp_device(interface="lo")]
+        process_group = c10d.ProcessGroupGloo(store, self.rank, self.world_size, options)
+
+        torch.manual_seed(1337)
+        model = Net()
+        ref_model = copy.deepcopy(model)
+
+        # A small cap puts the parameters into more than one bucket
+        reducer = c10d.Reducer([list(model.parameters())], process_group, 1024)
+        self.assertEqual(2, reducer.num_buckets())
+
+        local_batch_size = 2
+        global_batch_size = self.world_size * local_batch_size
+        for iteration in range(2):
+            input = torch.randn(global_batch_size, 2)
+            target = torch.randn(global_batch_size, 4)
+            local = slice(self.rank * local_batch_size, (self.rank + 1) * local_batch_size)
+
+            F.mse_loss(ref_model(input), target).backward()
+            F.mse_loss(model(input[local]), target[local]).backward()
+
+            # The averaged gradients of the local batches match the
+            # gradients of the global batch
+            for p, ref_p in zip(model.parameters(), ref_model.parameters()):
+                self.assertEqual(ref_p.grad, p.grad)
+                p.grad = None
+                ref_p.grad = None
+
     @skip_if_not_multigpu
     def test_gloo_backend(self):
         store = c10d.TCPStore('localhost', self.port, self.rank == 0)
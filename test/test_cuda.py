@@ -4,7 +4,7 @@ import tempfile
 import re
 import unittest
 import sys
-from itertools import repeat
+from itertools import repeat, product
 import os
 from contextlib import contextmanager
 
@@ -759,6 +759,37 @@ class TestCuda(TestCase):
         for _ in self._test_memory_stats_generator(self):
             pass
 
+    def test_memory_stats_dict(self):
+        stats = torch.cuda.memory_stats()
+        self.assertEqual(stats['allocated'], torch.cuda.memory_allocated())
+        self.assertEqual(stats['max_allocated'], torch.cuda.max_memory_allocated())
+        self.assertEqual(stats['reserved'], torch.cuda.memory_cached())
+        self.assertEqual(stats['max_reserved'], torch.cuda.max_memory_cached())
+        self.assertGreaterEqual(stats['active'], stats['allocated'])
+
+        # blocks are cached per stream, so a new stream starts with a fresh segment
+        stream = torch.cuda.Stream()
+        with torch.cuda.stream(stream):
+            a = torch.cuda.FloatTensor(1024)
+            b = torch.cuda.FloatTensor(1024)
+        before = torch.cuda.memory_stats()
+        del a
+        # a is free, but can't be released while b occupies the same segment
+        after = torch.cuda.memory_stats()
+        self.assertEqual(after['inactive_split'], before['inactive_split'] + 4096)
+        self.assertEqual(after['active'], before['active'] - 4096)
+        del b
+        reserved = torch.cuda.memory_stats()['reserved']
+        torch.cuda.empty_cache(torch.cuda.current_device())
+        self.assertLessEqual(torch.cuda.memory_stats()['reserved'], reserved - 1024 * 1024)
+
+    def test_caching_allocator_size_classes(self):
+        m0 = torch.cuda.memory_allocated()
+        # just over 1MB is rounded up to the next size class, 1.25MB
+        x = torch.cuda.FloatTensor(1024 * 1024 // 4 + 1)
+        self.assertEqual(torch.cuda.memory_allocated() - m0, 1024 * 1024 * 5 // 4)
+        del x
+
     @unittest.skipIf(not TEST_MULTIGPU, "only one GPU detected")
     def test_memory_stats_multigpu(self):
         # advance a generator with a end flag
@@ -886,6 +917,25 @@ class TestCuda(TestCase):
     def test_neg(self):
         TestTorch._test_neg(self, lambda t: t.cuda())
 
+    def test_binary_ops_alignment(self):
+        # contiguous operands that start at any offset, with lengths that leave
+        # a partial vector, and strided and broadcast ones
+        for dtype in [torch.float, torch.double, torch.half, torch.uint8]:
+            a = torch.randint(1, 10, (80,), dtype=torch.float).to(dtype)
+            b = torch.randint(1, 10, (80,), dtype=torch.float).to(dtype)
+            a_cuda, b_cuda = a.cuda(), b.cuda()
+            for offset_a, offset_b, n in product(range(3), range(3), [1, 7, 33, 64]):
+                x, y = a[offset_a:offset_a + n], b[offset_b:offset_b + n]
+                x_cuda, y_cuda = a_cuda[offset_a:offset_a + n], b_cuda[offset_b:offset_b + n]
+                self.assertEqual((x_cuda + y_cuda).cpu(), x + y)
+                self.assertEqual((x_cuda * 2).cpu(), x * 2)
+                out = torch.zeros(n + 1, dtype=dtype).cuda()[1:]
+                torch.add(x_cuda, y_cuda, out=out)
+                self.assertEqual(out.cpu(), x + y)
+            self.assertEqual((a_cuda[::2] + b_cuda[:40]).cpu(), a[::2] + b[:40])
+            self.assertEqual((a_cuda.view(8, 10) + b_cuda[:10]).cpu(), a.view(8, 10) + b[:10])
+            self.assertEqual((a_cuda.view(8, 10).t() - b_cuda[:8]).cpu(), a.view(8, 10).t() - b[:8])
+
     def _test_broadcast(self, input):
         if not TEST_MULTIGPU:
             raise unittest.SkipTest("only one GPU detected")
@@ -965,6 +1015,20 @@ class TestCuda(TestCase):
         ]
         self._test_broadcast_coalesced(self, tensors, num_bytes * 5 // 2)
 
+    @unittest.skipIf(not TEST_MULTIGPU, "only one GPU detected")
+    def test_broadcast_coalesced_adjacent_and_repeated(self):
+        numel = 5
+        num_bytes = numel * 8
+        # views of a single storage are broadcast without being flattened
+        flat = torch.randn(numel * 4).cuda()
+        tensors = list(flat.split(numel)) + [
+            torch.randn(numel).long().cuda(),
+            torch.randn(numel, 2).cuda().t(),
+        ]
+        # the flat buffers are reused between calls
+        for _ in range(3):
+            self._test_broadcast_coalesced(self, tensors, num_bytes * 5 // 2)
+
     @unittest.skipIf(not TEST_MULTIGPU, "only one GPU detected")
     def test_reduce_add(self):
         x = torch.randn(5, 5)
@@ -1293,6 +1357,41 @@ class TestCuda(TestCase):
             self.assertEqual(torch.cuda.current_stream().device, 1)
             self.assertNotEqual(torch.cuda.current_stream(), default_stream)
 
+    def test_matmul_streams(self):
+        # each stream gets its own cuBLAS handle
+        a = torch.randn(4, 30, 40, device='cuda')
+        b = torch.randn(4, 40, 50, device='cuda')
+        expected = torch.bmm(a.double(), b.double()).float()
+        streams = [torch.cuda.Stream() for _ in range(2)]
+        results = []
+        for stream in streams:
+            with torch.cuda.stream(stream):
+                results.append((torch.bmm(a, b), a[0].mm(b[0])))
+        torch.cuda.synchronize()
+        for batched, single in results:
+            self.assertEqual(batched, expected, prec=1e-3)
+            self.assertEqual(single, expected[0], prec=1e-3)
+
+        # expanded and transposed batches go through the strided batched GEMM
+        self.assertEqual(torch.bmm(a[:1].expand(4, 30, 40), b), torch.bmm(a[:1].repeat(4, 1, 1), b), prec=1e-3)
+        self.assertEqual(torch.bmm(a.transpose(1, 2).contiguous().transpose(1, 2), b), expected, prec=1e-3)
+
+    def test_matmul_reduced_precision(self):
+        self.assertFalse(torch.backends.cuda.allow_reduced_precision_matmul)
+        a = torch.randn(3, 64, 64, device='cuda')
+        b = torch.randn(3, 64, 64, device='cuda')
+        expected = torch.bmm(a.double(), b.double())
+        try:
+            torch.backends.cuda.allow_reduced_precision_matmul = True
+            self.assertTrue(torch.backends.cuda.allow_reduced_precision_matmul)
+            # rounded inputs: around 1e-3 relative error for fp32 inputs
+            self.assertEqual(torch.bmm(a, b).double(), expected, prec=0.5)
+            self.assertEqual(a[0].mm(b[0]).double(), expected[0], prec=0.5)
+            self.assertEqual(torch.bmm(a.half(), b.half()).double(), expected, prec=1)
+        finally:
+            torch.backends.cuda.allow_reduced_precision_matmul = False
+        self.assertEqual(torch.bmm(a, b).double(), expected, prec=1e-3)
+
     @unittest.skipIf(not TEST_MULTIGPU, "multi-GPU not supported")
     def test_tensor_device(self):
         self.assertEqual(torch.cuda.FloatTensor(1).get_device(), 0)
@@ -1347,6 +1446,38 @@ class TestCuda(TestCase):
             tmp3 = torch.cuda.FloatTensor(t.size())
             self.assertEqual(tmp3.data_ptr(), ptr[0], 'allocation not re-used')
 
+    def test_stream_use_batch(self):
+        stream = torch.cuda.Stream()
+
+        def free_used_tensors(n):
+            tensors = [torch.cuda.FloatTensor(1024) for _ in range(n)]
+            ptrs = {t.data_ptr() for t in tensors}
+            for t in tensors:
+                t.record_stream(stream)
+            del tensors[:]
+            return ptrs
+
+        before = torch.cuda.memory_stats()['num_stream_events']
+        free_used_tensors(4)
+        self.assertEqual(torch.cuda.memory_stats()['num_stream_events'], before + 4)
+        stream.synchronize()
+
+        with torch.cuda.stream_use_batch():
+            with torch.cuda.stream_use_batch():
+                ptrs = free_used_tensors(4)
+            # the inner batch doesn't record any events
+            self.assertEqual(torch.cuda.memory_stats()['num_stream_events'], before + 4)
+            t = torch.cuda.FloatTensor(1024)
+            self.assertNotIn(t.data_ptr(), ptrs, 'allocation re-used too soon')
+            del t
+        self.assertEqual(torch.cuda.memory_stats()['num_stream_events'], before + 5)
+
+        # the memory is released once the event completed, on the next allocation
+        active = torch.cuda.memory_stats()['active']
+        stream.synchronize()
+        t = torch.cuda.FloatTensor(1024)
+        self.assertEqual(torch.cuda.memory_stats()['active'], active - 4 * 4096 + 4096)
+
     def test_noncontiguous_pinned_memory(self):
         # See issue #3266
         x = torch.arange(0, 10).view((2, 5))
@@ -1416,9 +1547,46 @@ class TestCuda(TestCase):
     def test_gesv_batched_dims(self):
         TestTorch._test_gesv_batched_dims(self, lambda t: t.cuda())
 
+    @unittest.skipIf(not TEST_MAGMA, "no MAGMA library detected")
+    def test_inverse_batched(self):
+        TestTorch._test_inverse_batched(self, lambda t: t.cuda())
+
+    @unittest.skipIf(not TEST_MAGMA, "no MAGMA library detected")
+    def test_cholesky_batched(self):
+        TestTorch._test_cholesky_batched(self, lambda t: t.cuda())
+
     def test_view(self):
         TestTorch._test_view(self, lambda t: t.cuda())
 
+    def test_sort_large_slices(self):
+        # rows longer than the bitonic sort limit go through the segmented
+        # radix sort, and a single row through the device-wide one
+        for shape in [(5000,), (7, 3000), (3000, 3)]:
+            for dtype in [torch.float, torch.double, torch.int, torch.long]:
+                x = torch.randint(-1000, 1000, shape).to(dtype)
+                dim = 0 if shape[-1] == 3 else -1
+                for descending in [False, True]:
+                    values, indices = x.cuda().sort(dim, descending)
+                    expected, _ = x.sort(dim, descending)
+                    self.assertEqual(values.cpu(), expected, 0)
+                    self.assertEqual(x.gather(dim, indices.cpu()), expected, 0)
+
+    def test_topk_selection(self):
+        # small k uses heap selection, large k radix selection
+        x = torch.randn(64, 10000)
+        for k in [1, 5, 31, 32, 200, 511, 1000, 3000]:
+            for largest in [True, False]:
+                values, indices = x.cuda().topk(k, largest=largest)
+                self.assertEqual(x.gather(1, indices.cpu()), values.cpu(), 0)
+                expected, _ = x.topk(k, largest=largest)
+                self.assertEqual(values.cpu(), expected, 0)
+
+        x = torch.randint(0, 3, (16, 4000)).long()
+        values, indices = x.cuda().topk(10, dim=1)
+        self.assertEqual(values.cpu(), x.topk(10, dim=1)[0], 0)
+        values, indices = x.cuda().t().topk(10, dim=0)
+        self.assertEqual(values.cpu(), x.t().topk(10, dim=0)[0], 0)
+
     def test_flip(self):
         TestTorch._test_flip(self, use_cuda=True)
 
@@ -1456,6 +1624,50 @@ class TestCuda(TestCase):
         with self.assertRaisesRegex(RuntimeError, r"read-only property"):
             torch.backends.cuda.cufft_plan_cache.size = -1
 
+        with self.assertRaisesRegex(RuntimeError, r"read-only property"):
+            torch.backends.cuda.cufft_plan_cache.hits = -1
+
+        # the plan cache counts its hits and misses until it is cleared
+        with plan_cache_max_size(10):
+            cache = torch.backends.cuda.cufft_plan_cache
+            cache.clear()
+            self.assertEqual((cache.hits, cache.misses), (0, 0))
+            x = torch.randn(4, 8, 2, device='cuda')
+            x.fft(1)
+            x.fft(1)
+            self.assertEqual((cache.size, cache.hits, cache.misses), (1, 1, 1))
+            cache.clear()
+            self.assertEqual((cache.size, cache.hits, cache.misses), (0, 0, 0))
+
+        # indexing by device gives the same cache as the current device's
+        self.assertIs(torch.backends.cuda.cufft_plan_cache[0],
+                      torch.backends.cuda.cufft_plan_cache[torch.device('cuda:0')])
+        with self.assertRaisesRegex(RuntimeError, r"device index"):
+            torch.backends.cuda.cufft_plan_cache[torch.cuda.device_count()]
+
+    @unittest.skipIf(not TEST_MULTIGPU, "only one GPU detected")
+    def test_cufft_plan_cache_per_device(self):
+        cache0 = torch.backends.cuda.cufft_plan_cache[0]
+        cache1 = torch.backends.cuda.cufft_plan_cache[1]
+        original = (cache0.max_size, cache1.max_size)
+        try:
+            cache0.clear()
+            cache1.clear()
+            cache0.max_size = 10
+            cache1.max_size = 11
+            self.assertEqual(cache0.max_size, 10)
+            self.assertEqual(cache1.max_size, 11)
+            torch.randn(4, 8, 2, device='cuda:1').fft(1)
+            self.assertEqual((cache0.size, cache0.misses), (0, 0))
+            self.assertEqual((cache1.size, cache1.misses), (1, 1))
+            with torch.cuda.device(1):
+                self.assertEqual(torch.backends.cuda.cufft_plan_cache.max_size, 11)
+                torch.backends.cuda.cufft_plan_cache.max_size = 12
+            self.assertEqual(cache1.max_size, 12)
+            self.assertEqual(torch.backends.cuda.cufft_plan_cache.max_size, 10)
+        finally:
+            cache0.max_size, cache1.max_size = original
+
     def test_stft(self):
         TestTorch._test_stft(self, device=torch.device('cuda'))
 
@@ -1682,6 +1894,41 @@ class TestCuda(TestCase):
         tensor = tensor.unsqueeze(1)
         self.assertEqual(tensor.var(0), 0.03125)
 
+    def test_var_mean(self):
+        TestTorch._test_var_mean(self, 'cuda')
+
+    def test_reduction_kernels(self):
+        # covers the inner (vectorized) and outer layouts, and the split of
+        # long reductions across blocks
+        shapes = [(1000003,), (3, 70000), (70000, 3), (65, 129, 33), (2, 1)]
+        for shape in shapes:
+            cpu_tensor = torch.randn(*shape, dtype=torch.double)
+            gpu_tensor = cpu_tensor.cuda()
+            self.assertEqual(gpu_tensor.sum(), cpu_tensor.sum())
+            self.assertEqual(gpu_tensor.var(), cpu_tensor.var())
+            self.assertEqual(gpu_tensor.std(unbiased=False), cpu_tensor.std(unbiased=False))
+            for dim in range(len(shape)):
+                self.assertEqual(gpu_tensor.sum(dim), cpu_tensor.sum(dim))
+                self.assertEqual(gpu_tensor.var(dim), cpu_tensor.var(dim))
+                self.assertEqual(gpu_tensor.std(dim, keepdim=True), cpu_tensor.std(dim, keepdim=True))
+
+        # non-contiguous and misaligned inputs
+        cpu_tensor = torch.randn(300, 500, dtype=torch.double)
+        gpu_tensor = cpu_tensor.cuda()
+        self.assertEqual(gpu_tensor.t().sum(1), cpu_tensor.t().sum(1))
+        self.assertEqual(gpu_tensor[:, 1:].sum(1), cpu_tensor[:, 1:].sum(1))
+        self.assertEqual(gpu_tensor[:, 3:].var(1), cpu_tensor[:, 3:].var(1))
+
+        cpu_tensor = torch.rand(40, 30, dtype=torch.double) + 0.5
+        gpu_tensor = cpu_tensor.cuda()
+        self.assertEqual(gpu_tensor.prod(1), cpu_tensor.prod(1))
+        self.assertEqual(gpu_tensor[:4].prod(), cpu_tensor[:4].prod())
+
+        cpu_tensor = torch.randint(-100, 100, (1000, 300), dtype=torch.int32)
+        gpu_tensor = cpu_tensor.cuda()
+        self.assertEqual(gpu_tensor.sum(), cpu_tensor.sum())
+        self.assertEqual(gpu_tensor.sum(0), cpu_tensor.sum(0))
+
     def test_digamma(self):
         def test(use_double=False):
             cpu_tensor = torch.randn(10, 10, 10)
@@ -1845,6 +2092,15 @@ class TestCuda(TestCase):
         t = torch.randint(2000, input_size, dtype=torch.int64, device='cuda')
         self.assertEqual(t.cpu().bincount(), t.bincount())
         self.assertEqual(t.cpu().bincount(w_cpu), t.bincount(w))
+        # test shared memory impl with many bins, and with spill-over of the
+        # bins that don't fit in shared memory into global memory
+        input_size = (1000000,)
+        w = torch.randn(input_size, device='cuda')
+        w_cpu = w.cpu()
+        for nbins in (2000, 100000):
+            t = torch.randint(nbins, input_size, dtype=torch.int64, device='cuda')
+            self.assertEqual(t.cpu().bincount(), t.bincount())
+            self.assertEqual(t.cpu().bincount(w_cpu), t.bincount(w))
 
     def test_tiny_half_norm_(self):
         a = torch.arange(25).cuda().float()
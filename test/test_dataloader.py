@@ -12,7 +12,8 @@ import subprocess
 from torch import multiprocessing as mp
 from torch.utils.data import Dataset, TensorDataset, DataLoader, ConcatDataset
 from torch.utils.data.dataset import random_split
-from torch.utils.data.dataloader import default_collate, ExceptionWrapper, MANAGER_STATUS_CHECK_INTERVAL
+from torch.utils.data.dataloader import default_collate, ExceptionWrapper, MANAGER_STATUS_CHECK_INTERVAL, \
+    pin_memory_batch
 from common import TestCase, run_tests, TEST_NUMPY, IS_WINDOWS, NO_MULTIPROCESSING_SPAWN, skipIfRocm
 
 # We cannot import TEST_CUDA from common_nn here, because if we do that,
@@ -345,6 +346,20 @@ class TestDataLoader(TestCase):
             self.assertTrue(input.is_pinned())
             self.assertTrue(target.is_pinned())
 
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    @skipIfRocm
+    def test_pin_memory_batch_coalesced(self):
+        x, y, z = torch.randn(3), torch.randn(2, 2), torch.arange(4)
+        batch = pin_memory_batch([x, {'y': y, 'z': z}, 'name'])
+        px, py, pz = batch[0], batch[1]['y'], batch[1]['z']
+        for t, pinned in [(x, px), (y, py), (z, pz)]:
+            self.assertTrue(pinned.is_pinned())
+            self.assertEqual(t, pinned)
+        self.assertEqual(batch[2], 'name')
+        # tensors of the same type share one pinned buffer
+        self.assertEqual(px.storage().data_ptr(), py.storage().data_ptr())
+        self.assertNotEqual(px.storage().data_ptr(), pz.storage().data_ptr())
+
     @skipIfRocm
     def test_multiple_dataloaders(self):
         loader1_it = iter(DataLoader(self.dataset, num_workers=1))
@@ -414,6 +429,22 @@ class TestDataLoader(TestCase):
     def test_seqential_batch_workers(self):
         self._test_sequential(DataLoader(self.dataset, batch_size=2, num_workers=4))
 
+    def test_sequential_batch_workers_reuse_shared_memory(self):
+        # the last batch is smaller and fits into the buffers of its slot
+        self._test_sequential(DataLoader(self.dataset, batch_size=3, num_workers=2,
+                                         reuse_shared_memory=True))
+
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    @skipIfRocm
+    def test_sequential_pin_memory_reuse_shared_memory(self):
+        loader = DataLoader(self.dataset, batch_size=2, num_workers=2, pin_memory=True,
+                            reuse_shared_memory=True)
+        for i, (input, target) in enumerate(loader):
+            self.assertTrue(input.is_pinned())
+            self.assertTrue(target.is_pinned())
+            self.assertEqual(input, self.data[2 * i:2 * i + 2])
+            self.assertEqual(target, self.labels[2 * i:2 * i + 2])
+
     def test_shuffle_workers(self):
         self._test_shuffle(DataLoader(self.dataset, shuffle=True, num_workers=4))
 
@@ -703,6 +734,14 @@ class TestDictDataLoader(TestCase):
             self.assertTrue(sample['a_tensor'].is_pinned())
             self.assertTrue(sample['another_dict']['a_number'].is_pinned())
 
+    def test_reuse_shared_memory(self):
+        loader = DataLoader(self.dataset, batch_size=2, num_workers=2, reuse_shared_memory=True)
+        for i, sample in enumerate(loader):
+            idx = i * 2
+            self.assertTrue((sample['a_tensor'][0] == idx).all())
+            self.assertTrue((sample['a_tensor'][1] == idx + 1).all())
+            self.assertEqual(sample['another_dict']['a_number'].tolist(), [idx, idx + 1])
+
 
 class TestWorkerQueueDataset(Dataset):
     def __init__(self, data):
@@ -539,6 +539,26 @@ class _DistTestBase(object):
             2 + (10 * (len(group) - 1)),
         )
 
+    @unittest.skipIf(BACKEND == "nccl", "Nccl does not support CPU tensors")
+    def test_all_reduce_async(self):
+        group, group_id, rank = self._init_global_test()
+        expected = sum(range(1, len(group) + 1))
+        # The large tensor is reduced with the chunked ring algorithm
+        large = _build_tensor(64, rank + 1)
+        small = _build_tensor(2, rank + 1)
+        large_request = dist.all_reduce(large, group=group_id, async_op=True)
+        small_request = dist.all_reduce(small, group=group_id, async_op=True)
+        # Synchronous collectives run after the pending asynchronous ones
+        tensor = _build_tensor(3, rank + 1)
+        dist.all_reduce(tensor, group=group_id)
+        self.assertEqual(tensor, _build_tensor(3, expected))
+        large_request.wait()
+        small_request.wait()
+        self.assertTrue(large_request.is_completed())
+        self.assertEqual(large, _build_tensor(64, expected))
+        self.assertEqual(small, _build_tensor(2, expected))
+        self._barrier()
+
     @unittest.skipIf(
         BACKEND != "gloo" and BACKEND != "nccl",
         "Only Gloo & Nccl backend support CUDA allReduce",
@@ -254,6 +254,50 @@ class TestIndexing(TestCase):
         self.assertEqual(x[2], value)
         self.assertEqual(x[3], torch.arange(12, 16))
 
+    def test_byte_mask_fill(self):
+        devices = ['cpu'] if not torch.cuda.is_available() else ['cpu', 'cuda']
+        for device in devices:
+            x = torch.arange(0., 12, device=device).view(3, 4)
+            mask = torch.ByteTensor([[1, 0, 1, 0], [0, 0, 0, 0], [1, 1, 1, 1]]).to(device)
+            expected = x.masked_fill(mask, 5)
+            y = x.clone()
+            y[mask] = 5
+            self.assertEqual(y, expected)
+            y = x.clone()
+            y[mask] = torch.tensor(5., device=device)
+            self.assertEqual(y, expected)
+            # a mask of some of the dimensions
+            y = x.clone()
+            y[:, mask[0]] = torch.tensor([-1.], device=device)
+            self.assertEqual(y[:, 0], [-1, -1, -1])
+            self.assertEqual(y[:, 1], x[:, 1])
+            self.assertEqual(y[:, 2], [-1, -1, -1])
+            self.assertEqual(y[:, 3], x[:, 3])
+
+    def test_index_put_accumulate(self):
+        devices = ['cpu'] if not torch.cuda.is_available() else ['cpu', 'cuda']
+        for device in devices:
+            x = torch.zeros(5, 3, device=device)
+            index = torch.tensor([0, 2, 0, -1], device=device)
+            x.index_put_((index,), torch.ones(4, 3, device=device), accumulate=True)
+            self.assertEqual(x[:, 0].tolist(), [2, 0, 1, 0, 1])
+            self.assertEqual(x[:, 1], x[:, 0])
+
+            x = torch.zeros(4, 4, device=device)
+            rows = torch.tensor([0, 0, 3], device=device)
+            columns = torch.tensor([1, 1, 2], device=device)
+            y = x.index_put((rows, columns), torch.tensor([1., 2., 3.], device=device), accumulate=True)
+            self.assertEqual(x.sum(), 0)
+            self.assertEqual(y[0, 1], 3)
+            self.assertEqual(y[3, 2], 3)
+            self.assertEqual(y.sum(), 6)
+
+            # the gradient of indexing with duplicate indices accumulates
+            x = torch.randn(5, 3, device=device, requires_grad=True)
+            x[[0, 0, 2], 1:].sum().backward()
+            self.assertEqual(x.grad[:, 1].tolist(), [2, 0, 1, 0, 0])
+            self.assertEqual(x.grad[:, 0].sum(), 0)
+
     def test_variable_slicing(self):
         x = torch.arange(0, 16).view(4, 4)
         indices = torch.IntTensor([0, 1])
@@ -19,6 +19,7 @@ import inspect
 import textwrap
 import numpy as np
 import tempfile
+import threading
 import shutil
 import warnings
 from test_autograd import method_tests, create_input, unpack_variables, \
@@ -197,7 +198,7 @@ def _construct_empty_tensor_list():
 class JitTestCase(TestCase):
     _do_cuda_memory_leak_check = True
 
-    def getExportImportCopy(self, m):
+    def getExportImportCopy(self, m, mmap=False):
         # Ideally we would like to not have to manually delete the file, but NamedTemporaryFile
         # opens the file, and it cannot be opened multiple times in Windows. To support Windows,
         # close the file after creation and try to remove it manually
@@ -205,9 +206,11 @@ class JitTestCase(TestCase):
         try:
             f.close()
             m.save(f.name)
-            imported = torch.jit.load(f.name)
+            imported = torch.jit.load(f.name, mmap=mmap)
         finally:
-            os.unlink(f.name)
+            # a mapped file can't be removed while it is in use on Windows
+            if not (mmap and IS_WINDOWS):
+                os.unlink(f.name)
         return imported
 
     def assertExpectedONNXGraph(self, trace, *args, **kwargs):
@@ -364,6 +367,28 @@ class TestJit(JitTestCase):
         self.run_pass('peephole', trace)
         self.assertEqual(s, str(trace))
 
+    def test_peephole_specialized_shapes(self):
+        x = torch.randn(2, 3)
+        y = torch.randn(3, 2)
+
+        def f(x, y):
+            a = x.view(2, 3).contiguous()
+            b = y.t().contiguous()
+            return a * b.view(6).view(2, 3)
+
+        trace, z = torch.jit.get_trace_graph(f, (x, y))
+        s = str(trace)
+        self.run_pass('peephole', trace)
+        # without specialized shapes, the sizes of a trace are not trusted
+        self.assertEqual(s, str(trace))
+        torch._C._jit_pass_peephole(trace.graph(), specialized_shapes=True)
+        torch._C._jit_pass_lint(trace.graph())
+        s = str(trace)
+        # only the view that changes the shape and the contiguous of the
+        # transposed tensor are left
+        self.assertEqual(s.count('aten::view'), 2)
+        self.assertEqual(s.count('aten::contiguous'), 1)
+
     def test_peephole_dynamic(self):
         def f(x, y):
             return x.type_as(y)
@@ -568,6 +593,59 @@ class TestJit(JitTestCase):
         ge = self.checkTrace(f, (x, y))
         self.assertExpectedGraph(ge.graph_for(x, y))
 
+    @unittest.skipIf(IS_WINDOWS, "NYI: fuser support for Windows")
+    @unittest.skipIf(not RUN_CUDA, "fuser requires CUDA")
+    @skipIfRocm
+    def test_reduction_fusion_cuda(self):
+        def f(x, y):
+            return (x * y + x).sum(1), torch.sigmoid(x - y).mean(0, keepdim=True)
+
+        x = torch.randn(4, 8, dtype=torch.float, device='cuda')
+        y = torch.randn(4, 8, dtype=torch.float, device='cuda')
+
+        ge = self.checkTrace(f, (x, y))
+        graph = ge.graph_for(x, y)
+        kinds = [n.kind() for n in graph.nodes()]
+        self.assertEqual(kinds.count('prim::FusionGroup'), 2)
+        self.assertNotIn('aten::sum', kinds)
+        self.assertNotIn('aten::mean', kinds)
+
+    @unittest.skipIf(IS_WINDOWS, "NYI: fuser support for Windows")
+    @unittest.skipIf(not RUN_CUDA, "fuser requires CUDA")
+    @skipIfRocm
+    def test_linear_relu_fusion_cuda(self):
+        def f(x, w, b):
+            return F.relu(F.linear(x, w, b)) * 2
+
+        x = torch.randn(4, 8, dtype=torch.float, device='cuda')
+        w = torch.randn(5, 8, dtype=torch.float, device='cuda')
+        b = torch.randn(5, dtype=torch.float, device='cuda')
+
+        ge = self.checkTrace(f, (x, w, b), inputs_require_grads=False)
+        kinds = [n.kind() for n in ge.graph_for(x, w, b).nodes()]
+        self.assertIn('aten::linear_relu', kinds)
+        self.assertNotIn('aten::addmm', kinds)
+
+    @unittest.skipIf(IS_WINDOWS, "NYI: fuser support for Windows")
+    @unittest.skipIf(not RUN_CUDA, "fuser requires CUDA")
+    @skipIfRocm
+    def test_memory_planning_cuda(self):
+        def f(x, y):
+            s = (x * y).sum(1)
+            return torch.sigmoid(s) * s
+
+        x = torch.randn(4, 8, dtype=torch.float, device='cuda')
+        y = torch.randn(4, 8, dtype=torch.float, device='cuda')
+
+        enabled = torch._C._jit_get_memory_planning_enabled()
+        torch._C._jit_set_memory_planning_enabled(True)
+        try:
+            ge = self.checkTrace(f, (x, y), inputs_require_grads=False)
+            kinds = [n.kind() for n in ge.graph_for(x, y).nodes()]
+            self.assertIn('prim::AllocateArena', kinds)
+        finally:
+            torch._C._jit_set_memory_planning_enabled(enabled)
+
     @unittest.skipIf(IS_WINDOWS, "NYI: fuser support for Windows")
     @unittest.skipIf(not RUN_CUDA, "fuser requires CUDA")
     def test_fusion_rand(self):
@@ -908,6 +986,27 @@ class TestJit(JitTestCase):
         with self.assertRaisesRegex(RuntimeError, 'inplace MyInplaceFn'):
             ge(x)
 
+    def test_plan_cache_limit(self):
+        def fn(x):
+            return x * 2 + 1
+
+        ge = torch._C.GraphExecutor(fn, (torch.randn(1),))
+        limit = torch._C._jit_get_plan_cache_limit()
+        torch._C._jit_set_plan_cache_limit(2)
+        try:
+            # every size is a different specialization
+            for size in [1, 2, 1, 3, 1, 2]:
+                x = torch.randn(size)
+                self.assertEqual(ge(x), fn(x))
+        finally:
+            torch._C._jit_set_plan_cache_limit(limit)
+
+        state = ge.get_debug_state()
+        self.assertEqual(len(state.execution_plans), 2)
+        self.assertEqual(state.plan_cache_hits, 2)
+        self.assertEqual(state.plan_cache_misses, 4)
+        self.assertEqual(state.plan_cache_evictions, 2)
+
     def do_trace_size(self, requires_grad):
         def fn(x):
             return x.view(x.shape[1] * 2, x.size(0), 2)
@@ -1608,6 +1707,54 @@ class TestBatched(TestCase):
         res = [xs[j].sum().unsqueeze(0) for j in range(4)]
         self.assertEqual(res, res_batch.examples())
 
+    def test_batch_gradient(self):
+        @torch.jit.batch_gradient(batch_size=4)
+        def layer(x, w):
+            return torch.tanh(torch.mm(x, w)).exp()
+
+        xs, batch = self.rand_batch(4, (False, 2), (False, 3))
+        w = torch.rand(3, 5, requires_grad=True)
+        grad_output = torch.rand(2, 5)
+        out_batch, grad_x_batch, grad_w_batch = layer(batch, w, grad_output)
+        outs, grad_xs, grad_ws = [], [], []
+        for x in xs:
+            out = torch.tanh(torch.mm(x.squeeze(0), w)).exp()
+            grad_x, grad_w = torch.autograd.grad(out, (x, w), grad_output)
+            outs.append(out.unsqueeze(0))
+            grad_xs.append(grad_x)
+            grad_ws.append(grad_w.unsqueeze(0))
+        self.assertEqual(outs, out_batch.examples())
+        self.assertEqual(grad_xs, grad_x_batch.examples())
+        # per-example gradients of the shared weight
+        self.assertEqual(grad_ws, grad_w_batch.examples())
+
+    def test_batching_executor(self):
+        def layer(x, y):
+            return torch.tanh(x + y), x * y
+
+        executor = torch.jit.batching_executor(layer, dims=[[True, False], [True, False]],
+                                               max_batch_size=4, max_delay=0.05)
+        inputs = []
+        for _ in range(10):
+            n = random.randint(1, 5)
+            inputs.append((torch.rand(n, 3), torch.rand(n, 3)))
+        results = [None] * len(inputs)
+
+        def client(i):
+            results[i] = executor(*inputs[i])
+
+        threads = [threading.Thread(target=client, args=(i,)) for i in range(len(inputs))]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        for (x, y), result in zip(inputs, results):
+            self.assertEqual(layer(x, y), result)
+
+        # the static dimension doesn't match the dims given to the executor
+        with self.assertRaisesRegex(RuntimeError, "dimensions"):
+            executor(torch.rand(2, 3, 1), torch.rand(2, 3, 1))
+
     def test_if_else(self):
         def single_if(a, b):
             if a > b:
@@ -4187,6 +4334,26 @@ def func(t):
             self.assertEqual(m_orig.foo(), m_import.foo())
             self.assertTrue(m_orig.foo().dtype == m_import.foo().dtype)
 
+    def test_script_module_export_mmap(self):
+        class M(torch.jit.ScriptModule):
+
+            def __init__(self):
+                super(M, self).__init__(False)
+                self.param = torch.nn.Parameter(torch.randn(4, 6))
+                self.view = torch.nn.Parameter(self.param[1:3, 2:])
+
+            @torch.jit.script_method
+            def forward(self, input):
+                return torch.mm(input, self.param) + self.view.sum()
+
+        m_orig = M()
+        m_import = self.getExportImportCopy(m_orig, mmap=True)
+        input = torch.randn(3, 4)
+        self.assertEqual(m_orig(input), m_import(input))
+        # parameters are copy-on-write mappings
+        m_import.param.data.add_(1)
+        self.assertEqual(m_orig.param + 1, m_import.param)
+
     @unittest.skipIf(not RUN_CUDA, "testing cuda tensors require CUDA")
     def test_script_module_export_tensor_cuda(self):
         class M(torch.jit.ScriptModule):
@@ -4225,6 +4392,29 @@ def func(t):
         self.assertTrue(m_import.param1.storage().data_ptr() == m_import.param2.storage().data_ptr())
         self.assertTrue(m_import.param1.storage().data_ptr() != m_import.param3.storage().data_ptr())
 
+    def test_script_module_export_precompiled(self):
+        class M(torch.jit.ScriptModule):
+
+            def __init__(self):
+                super(M, self).__init__()
+                self.weight = torch.nn.Parameter(torch.rand(3, 3))
+
+            @torch.jit.script_method
+            def forward(self, x):
+                return torch.mm(x, self.weight).tanh() + 1
+
+        m_orig = M()
+        x = torch.randn(4, 3)
+        with torch.no_grad():
+            m_orig._get_method('forward').precompile([x])
+            m_import = self.getExportImportCopy(m_orig)
+            self.assertEqual(m_orig(x), m_import(x))
+
+        # the saved plan was used instead of optimizing the method again
+        state = m_import.get_debug_state()
+        self.assertEqual(len(state.execution_plans), 1)
+        self.assertEqual(state.plan_cache_misses, 0)
+
     def test_onnx_export_script_module(self):
         class ModuleToExport(torch.jit.ScriptModule):
             def __init__(self):
@@ -4788,6 +4978,43 @@ def func(t):
         self.checkScript(fn, (torch.tensor(1),))
         self.checkScript(fn, (torch.tensor(2),))
 
+    def test_loop_invariant_code_motion(self):
+        def fn(n, x, w):
+            y = x
+            for _ in range(int(n)):
+                y = y.mm(w.t())
+            return y
+
+        graph = torch.jit.script(fn).graph
+        self.run_pass('loop_invariant_code_motion', graph)
+        loop = [node for node in graph.nodes() if node.kind() == 'prim::Loop'][0]
+        body = next(loop.blocks())
+        self.assertNotIn('aten::t', [node.kind() for node in body.nodes()])
+        self.assertIn('aten::t', [node.kind() for node in graph.nodes()])
+        self.checkScript(fn, (torch.tensor(3), torch.randn(4, 4), torch.randn(4, 4)))
+        self.checkScript(fn, (torch.tensor(0), torch.randn(4, 4), torch.randn(4, 4)))
+
+    def test_loop_fusion(self):
+        def fn(n, x, y):
+            a = x
+            for _ in range(int(n)):
+                a = a * 2
+            b = y
+            for _ in range(int(n)):
+                b = b + a
+            c = y
+            for _ in range(int(n)):
+                c = c - 1
+            return a + b + c
+
+        graph = torch.jit.script(fn).graph
+        self.run_pass('cse', graph)
+        self.run_pass('loop_fusion', graph)
+        # the second loop depends on the first one, the third one doesn't
+        loops = [node for node in graph.nodes() if node.kind() == 'prim::Loop']
+        self.assertEqual(len(loops), 2)
+        self.checkScript(fn, (torch.tensor(3), torch.randn(4), torch.randn(4)))
+
     def test_where(self):
         def fn(x, y):
             return torch.where(x > 0.0, x, y)
@@ -6189,11 +6416,15 @@ class TestPytorchExportModes(JitTestCase):
                            export_type=torch.onnx.ExportTypes.COMPRESSED_ZIP_ARCHIVE)
 
     def test_directory(self):
-        torch_model = TestPytorchExportModes.MyModel()
+        torch_model = nn.Sequential(TestPytorchExportModes.MyModel(), nn.Linear(224, 3))
         fake_input = Variable(torch.randn(1, 1, 224, 224), requires_grad=True)
         d = tempfile.mkdtemp()
         torch.onnx._export(torch_model, (fake_input), d, verbose=False,
                            export_type=torch.onnx.ExportTypes.DIRECTORY)
+        # the model proto and one file per parameter
+        files = os.listdir(d)
+        self.assertIn(torch.onnx.ONNX_ARCHIVE_MODEL_PROTO_NAME, files)
+        self.assertEqual(len(files), 1 + len(list(torch_model.parameters())))
         shutil.rmtree(d)
 
     def test_aten_fallback(self):
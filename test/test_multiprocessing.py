@@ -2,6 +2,7 @@ import contextlib
 import gc
 import os
 import sys
+import tempfile
 import time
 import unittest
 from sys import platform
@@ -113,6 +114,12 @@ def autograd_sharing(queue, ready, master_modified, device, is_parameter):
     queue.put(is_ok)
 
 
+def sum_shared_weights(name, queue):
+    from torch.multiprocessing.shared_weights import attach_state_dict
+    state_dict = attach_state_dict(name)
+    queue.put(sum(t.sum().item() for t in state_dict.values()))
+
+
 @contextlib.contextmanager
 def fs_sharing():
     prev_strategy = mp.get_sharing_strategy()
@@ -296,6 +303,44 @@ class TestMultiprocessing(TestCase):
             for _ in range(TEST_REPEATS):
                 queue_put()
 
+    @unittest.skipIf(IS_WINDOWS, "read-only mappings are not supported on Windows")
+    def test_shared_weights_file(self):
+        from torch.multiprocessing.shared_weights import save_shared, load_shared, bind_state_dict
+        model = torch.nn.Sequential(torch.nn.Linear(3, 4), torch.nn.BatchNorm1d(4))
+        model[1].running_mean.uniform_()
+        with tempfile.NamedTemporaryFile() as f:
+            save_shared(model.state_dict(), f.name)
+            state_dict = load_shared(f.name)
+        self.assertEqual(list(state_dict.keys()), list(model.state_dict().keys()))
+        for key, value in model.state_dict().items():
+            self.assertEqual(state_dict[key].dtype, value.dtype)
+            self.assertEqual(state_dict[key], value)
+
+        other = torch.nn.Sequential(torch.nn.Linear(3, 4), torch.nn.BatchNorm1d(4))
+        bind_state_dict(other, state_dict)
+        self.assertEqual(other[0].weight.data_ptr(), state_dict['0.weight'].data_ptr())
+        other.eval()
+        model.eval()
+        x = torch.randn(2, 3)
+        with torch.no_grad():
+            self.assertEqual(other(x), model(x))
+
+    @unittest.skipIf(not HAS_SHM_FILES, "named shared weights require /dev/shm")
+    def test_shared_weights_named(self):
+        from torch.multiprocessing.shared_weights import share_state_dict, unlink_state_dict
+        name = 'test_{}'.format(os.getpid())
+        state_dict = {'a': torch.arange(10, dtype=torch.float64), 'b': torch.ones(3, 3, dtype=torch.int32)}
+        shared = share_state_dict(state_dict, name)
+        try:
+            self.assertEqual(shared['a'], state_dict['a'])
+            q = mp.Queue()
+            p = mp.Process(target=sum_shared_weights, args=(name, q))
+            p.start()
+            self.assertEqual(q.get(timeout=10), 45 + 9)
+            p.join()
+        finally:
+            unlink_state_dict(name)
+
     def test_inherit_tensor(self):
         t = torch.zeros(5, 5)
         p = SubProcess(t.share_memory_())
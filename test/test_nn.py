@@ -13,6 +13,7 @@ from operator import mul
 from collections import OrderedDict
 import hashlib
 import os
+import tempfile
 
 import torch
 from torch._six import inf, nan
@@ -1836,6 +1837,33 @@ class TestNN(NNTestCase):
         self.assertEqual(output[1], output[2])
         self.assertTrue(output.data.norm(p=2, dim=1).le(1).all())
 
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    def test_embedding_backward_repeated_indices_cuda(self):
+        # A hot index is reduced in many segments; the result has to match the
+        # CPU and be the same from run to run.
+        input = torch.cat([torch.full((5000,), 3, dtype=torch.long),
+                           torch.randint(0, 50, (2000,), dtype=torch.long)])
+        input = input[torch.randperm(input.numel())]
+        grad = torch.randn(input.numel(), 37, dtype=torch.double)
+        for scale_grad_by_freq in (False, True):
+            expected = torch.embedding_backward(grad, input, 50, 7, scale_grad_by_freq, False)
+            results = [torch.embedding_backward(grad.cuda(), input.cuda(), 50, 7, scale_grad_by_freq, False)
+                       for _ in range(2)]
+            self.assertEqual(results[0].cpu(), expected)
+            self.assertTrue(torch.equal(results[0], results[1]))
+            self.assertEqual(results[0][7].abs().sum().item(), 0)
+
+        offsets = torch.arange(0, input.numel(), 7, dtype=torch.long)
+        weight = torch.randn(50, 37, dtype=torch.double)
+        for mode in ('sum', 'mean'):
+            grads = []
+            for device in ('cpu', 'cuda', 'cuda'):
+                w = weight.to(device).requires_grad_()
+                F.embedding_bag(input.to(device), w, offsets.to(device), mode=mode).sum().backward()
+                grads.append(w.grad)
+            self.assertEqual(grads[1].cpu(), grads[0])
+            self.assertTrue(torch.equal(grads[1], grads[2]))
+
     def test_embedding_from_pretrained(self):
         a = torch.Tensor([[1, 2, 3], [4, 5, 6]])
         embedding = nn.Embedding.from_pretrained(a)
@@ -2101,6 +2129,84 @@ class TestNN(NNTestCase):
         self._test_EmbeddingBag(False, 'sum', True)
         self._test_EmbeddingBag(False, 'mean', True)
 
+    def test_embedding_bag_per_sample_weights(self):
+        for sparse in (False, True):
+            es = nn.EmbeddingBag(10, 5, mode='sum', sparse=sparse).double()
+            input = torch.tensor([3, 1, 1, 9, 4, 3, 0], dtype=torch.long)
+            offsets = torch.tensor([0, 3, 3, 7], dtype=torch.long)
+            per_sample_weights = torch.randn(7, dtype=torch.double, requires_grad=True)
+
+            expected = []
+            for begin, end in [(0, 3), (3, 3), (3, 7), (7, 7)]:
+                rows = es.weight.index_select(0, input[begin:end])
+                expected.append((rows * per_sample_weights[begin:end].unsqueeze(1)).sum(0))
+            expected = torch.stack(expected)
+            output = es(input, offsets, per_sample_weights)
+            self.assertEqual(output, expected)
+
+            grad = torch.randn_like(output)
+            output.backward(grad)
+            weight_grad = es.weight.grad.to_dense() if sparse else es.weight.grad
+            psw_grad = per_sample_weights.grad.clone()
+            es.weight.grad = None
+            per_sample_weights.grad = None
+            expected.backward(grad)
+            self.assertEqual(weight_grad, es.weight.grad)
+            self.assertEqual(psw_grad, per_sample_weights.grad)
+
+        weight = torch.randn(10, 5, dtype=torch.double, requires_grad=True)
+        per_sample_weights = torch.randn(2, 3, dtype=torch.double, requires_grad=True)
+        input = torch.tensor([[3, 1, 1], [9, 4, 3]], dtype=torch.long)
+        gradcheck(lambda w, psw: F.embedding_bag(input, w, mode='sum', per_sample_weights=psw),
+                  (weight, per_sample_weights))
+
+        with self.assertRaises(ValueError):
+            F.embedding_bag(input, weight, mode='mean', per_sample_weights=per_sample_weights)
+
+    def _test_embedding_bag_rowwise(self, device):
+        weight = torch.randn(20, 6)
+        input = torch.tensor([3, 1, 1, 19, 4, 3, 0, 7], dtype=torch.long)
+        offsets = torch.tensor([0, 3, 3, 6], dtype=torch.long)
+        per_sample_weights = torch.randn(8)
+        for bit_rate in (8, 4):
+            packed = torch._embedding_bag_pack_rowwise(weight, bit_rate)
+            self.assertEqual(packed.dtype, torch.uint8)
+            self.assertEqual(packed.shape, (20, 6 * bit_rate // 8 + 8))
+            dequantized = torch._embedding_bag_unpack_rowwise(packed, bit_rate)
+            # Every value is within half a quantization step of the original
+            step = (weight.max(1)[0] - weight.min(1)[0]) / (2 ** bit_rate - 1)
+            self.assertTrue(((dequantized - weight).abs() <= step.unsqueeze(1) / 2 + 1e-6).all())
+
+            packed = packed.to(device)
+            for mode, mode_id in (('sum', 0), ('mean', 1)):
+                expected = F.embedding_bag(input, dequantized, offsets, mode=mode)
+                output = torch._embedding_bag_rowwise(packed, input.to(device), offsets.to(device),
+                                                      bit_rate, mode_id)
+                self.assertEqual(output.cpu(), expected, prec=1e-4)
+            expected = F.embedding_bag(input, dequantized, offsets, mode='sum',
+                                       per_sample_weights=per_sample_weights)
+            output = torch._embedding_bag_rowwise(packed, input.to(device), offsets.to(device),
+                                                  bit_rate, 0, per_sample_weights.to(device))
+            self.assertEqual(output.cpu(), expected, prec=1e-4)
+
+        with self.assertRaises(RuntimeError):
+            torch._embedding_bag_pack_rowwise(torch.randn(4, 3), 4)
+
+    def test_embedding_bag_rowwise(self):
+        self._test_embedding_bag_rowwise('cpu')
+
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    def test_embedding_bag_rowwise_cuda(self):
+        self._test_embedding_bag_rowwise('cuda')
+
+    def test_embedding_bag_index_out_of_range(self):
+        weight = torch.randn(10, 5)
+        offsets = torch.tensor([0, 2], dtype=torch.long)
+        for mode in ('sum', 'mean'):
+            for bad in (10, -1):
+                input = torch.tensor([1, 2, bad, 3], dtype=torch.long)
+                self.assertRaises(RuntimeError, lambda: F.embedding_bag(input, weight, offsets, mode=mode))
+
     @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
     @repeat_test_for_types(ALL_TENSORTYPES)
     def test_embedding_bag_cuda(self, dtype=torch.float):
@@ -2156,6 +2262,29 @@ class TestNN(NNTestCase):
         input = torch.Tensor(1000)
         self._test_dropout(nn.Dropout, True, input)
 
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    def test_Dropout_cuda_regenerates_mask(self):
+        # the backward recomputes the forward's mask from the saved RNG state
+        p = 0.3
+        for size in [(7,), (1000, 37), (3, 0)]:
+            x = torch.randn(*size, device='cuda').abs_().add_(1).requires_grad_()
+            out = F.dropout(x.t() if x.dim() == 2 else x, p, training=True)
+            out.backward(torch.ones_like(out))
+            kept = (out != 0).float()
+            if x.dim() == 2:
+                kept = kept.t()
+            self.assertEqual(x.grad, kept / (1 - p))
+
+        x = torch.randn(100, device='cuda', dtype=torch.double, requires_grad=True)
+        torch.cuda.manual_seed(0)
+        out, state = torch._fused_dropout_philox(x, 0.5)
+        torch.cuda.manual_seed(0)
+        out2, state2 = torch._fused_dropout_philox(x, 0.5)
+        self.assertEqual(out, out2)
+        self.assertEqual(state, state2)
+        grad, = torch.autograd.grad(out, x, torch.ones_like(out), create_graph=True)
+        self.assertEqual(grad, (out != 0).double() * 2)
+
     @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
     def test_Dropout2d_cuda(self):
         b = random.randint(1, 5)
@@ -2443,6 +2572,92 @@ class TestNN(NNTestCase):
         self._test_GroupNorm_general("cuda", torch.float)
         self._test_GroupNorm_cuda_half()
 
+    def test_LayerNorm_GroupNorm_grad(self):
+        for elementwise_affine in [True, False]:
+            ln = nn.LayerNorm([3, 4], elementwise_affine=elementwise_affine).double()
+            x = torch.randn(2, 5, 3, 4, dtype=torch.double, requires_grad=True)
+            _assertGradAndGradgradChecks(self, lambda x, *params: ln(x), (x,) + tuple(ln.parameters()))
+
+            gn = nn.GroupNorm(2, 6, affine=elementwise_affine).double()
+            x = torch.randn(3, 6, 2, 3, dtype=torch.double, requires_grad=True)
+            _assertGradAndGradgradChecks(self, lambda x, *params: gn(x), (x,) + tuple(gn.parameters()))
+
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    def test_LayerNorm_GroupNorm_cuda_matches_cpu(self):
+        # rows of up to 1024 elements take the warp per row kernels
+        for normalized_size in [7, 1024, 3000]:
+            x = torch.randn(37, normalized_size, requires_grad=True)
+            ln = nn.LayerNorm(normalized_size)
+            ln.weight.data.uniform_(0.5, 2)
+            ln.bias.data.uniform_(-1, 1)
+            ln_cuda = deepcopy(ln).cuda()
+            x_cuda = x.detach().cuda().requires_grad_()
+            grad = torch.randn(37, normalized_size)
+            ln(x).backward(grad)
+            ln_cuda(x_cuda).backward(grad.cuda())
+            self.assertEqual(x.grad, x_cuda.grad, prec=1e-4)
+            self.assertEqual(ln.weight.grad, ln_cuda.weight.grad, prec=1e-3)
+            self.assertEqual(ln.bias.grad, ln_cuda.bias.grad, prec=1e-3)
+
+        x = torch.randn(5, 12, 9, 7, requires_grad=True)
+        gn = nn.GroupNorm(4, 12)
+        gn.weight.data.uniform_(0.5, 2)
+        gn.bias.data.uniform_(-1, 1)
+        gn_cuda = deepcopy(gn).cuda()
+        x_cuda = x.detach().cuda().requires_grad_()
+        grad = torch.randn(5, 12, 9, 7)
+        self.assertEqual(gn(x), gn_cuda(x_cuda), prec=1e-4)
+        gn(x).backward(grad)
+        gn_cuda(x_cuda).backward(grad.cuda())
+        self.assertEqual(x.grad, x_cuda.grad, prec=1e-4)
+        self.assertEqual(gn.weight.grad, gn_cuda.weight.grad, prec=1e-3)
+        self.assertEqual(gn.bias.grad, gn_cuda.bias.grad, prec=1e-3)
+
+    def _test_linear_relu(self, device):
+        for input_size in [(6, 5), (2, 3, 5), (5,), (0, 5)]:
+            x = torch.randn(*input_size, dtype=torch.double, device=device, requires_grad=True)
+            w = torch.randn(4, 5, dtype=torch.double, device=device, requires_grad=True)
+            b = torch.randn(4, dtype=torch.double, device=device, requires_grad=True)
+            self.assertEqual(torch.linear_relu(x, w, b), F.relu(F.linear(x, w, b)))
+            self.assertEqual(torch.linear_relu(x, w), F.relu(F.linear(x, w)))
+            if x.numel() > 0:
+                _assertGradAndGradgradChecks(self, torch.linear_relu, (x, w, b))
+
+    def test_linear_relu(self):
+        self._test_linear_relu('cpu')
+
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    def test_linear_relu_cuda(self):
+        self._test_linear_relu('cuda')
+
+    def test_cpu_convolution(self):
+        def reference(x, w, b, padding, stride, dilation, groups):
+            n, _, h, w_ = x.shape
+            kh, kw = w.shape[2:]
+            oh = (h + 2 * padding[0] - dilation[0] * (kh - 1) - 1) // stride[0] + 1
+            ow = (w_ + 2 * padding[1] - dilation[1] * (kw - 1) - 1) // stride[1] + 1
+            cols = F.unfold(x, (kh, kw), dilation, padding, stride).view(n, groups, -1, oh * ow)
+            out = torch.matmul(w.view(groups, w.size(0) // groups, -1), cols).view(n, -1, oh, ow)
+            return out if b is None else out + b.view(1, -1, 1, 1)
+
+        # (in_channels, out_channels, kernel, padding, stride, dilation, groups)
+        configs = [
+            (4, 6, (3, 3), (1, 1), (1, 1), (1, 1), 1),
+            (4, 6, (3, 2), (2, 0), (2, 1), (1, 2), 2),
+            (4, 4, (1, 1), (0, 0), (1, 1), (1, 1), 1),
+            (4, 6, (1, 1), (1, 0), (2, 2), (1, 1), 2),
+            (4, 4, (3, 3), (1, 1), (1, 1), (1, 1), 4),
+            (4, 4, (3, 3), (0, 2), (2, 2), (1, 1), 4),
+        ]
+        for cin, cout, kernel, padding, stride, dilation, groups in configs:
+            x = torch.randn(3, cin, 7, 9, dtype=torch.double, requires_grad=True)
+            w = torch.randn(cout, cin // groups, *kernel, dtype=torch.double, requires_grad=True)
+            b = torch.randn(cout, dtype=torch.double, requires_grad=True)
+            args = (padding, stride, dilation, groups)
+            self.assertEqual(torch.cpu_convolution(x, w, b, *args), reference(x, w, b, *args))
+            self.assertEqual(torch.cpu_convolution(x, w, None, *args), reference(x, w, None, *args))
+            _assertGradAndGradgradChecks(self, lambda x, w, b: torch.cpu_convolution(x, w, b, *args), (x, w, b))
+
     def test_pad(self):
         inputs = torch.randn(1, 3, 4, 4, requires_grad=True)
         _assertGradAndGradgradChecks(self, lambda x: F.pad(x, (1, 1, 1, 1)), (inputs,))
@@ -2587,6 +2802,32 @@ class TestNN(NNTestCase):
     def test_MaxPool2d_indices_cuda(self, dtype=torch.float):
         self._test_maxpool_indices(2, device="cuda", dtype=dtype)
 
+    def test_pool2d_native_cpu(self):
+        # the native CPU kernels against the THNN ones they replace
+        nn_ = torch._C._nn
+        for ceil_mode, padding, stride in product([False, True], [0, 1], [1, 2]):
+            x = torch.randn(2, 5, 9, 11, dtype=torch.double)
+            x[0, 1, 2, 3] = float('nan')
+            for input in [x, x.to_channels_last(), x[0]]:
+                expected, expected_indices = nn_.thnn_max_pool2d_with_indices(
+                    input, (3, 2), (stride, stride), (padding, 1), (2, 1), ceil_mode)
+                result, indices = nn_.max_pool2d_with_indices(
+                    input, (3, 2), (stride, stride), (padding, 1), (2, 1), ceil_mode)
+                self.assertEqual(result, expected, allow_inf=True)
+                self.assertEqual(indices, expected_indices)
+                for count_include_pad in [False, True]:
+                    self.assertEqual(
+                        nn_.avg_pool2d(input, (3, 2), (stride, stride), (padding, 1), ceil_mode, count_include_pad),
+                        nn_.thnn_avg_pool2d(input, (3, 2), (stride, stride), (padding, 1), ceil_mode, count_include_pad))
+            self.assertTrue(nn_.avg_pool2d(x.to_channels_last(), 2).is_channels_last())
+
+        input = torch.randn(1, 3, 6, 7, dtype=torch.double, requires_grad=True)
+        for x in [input, input.to_channels_last()]:
+            gradcheck(lambda x: F.max_pool2d(x, 3, 2, 1, ceil_mode=True), [x])
+            gradgradcheck(lambda x: F.max_pool2d(x, 3, 2, 1, ceil_mode=True), [x])
+            gradcheck(lambda x: F.avg_pool2d(x, 3, 2, 1, ceil_mode=True), [x])
+            gradgradcheck(lambda x: F.avg_pool2d(x, 3, 2, 1, ceil_mode=True), [x])
+
     def test_MaxPool3d_indices(self):
         self._test_maxpool_indices(3)
 
@@ -3373,6 +3614,87 @@ class TestNN(NNTestCase):
             self.assertEqual(conv1.bias.grad.data, conv2.bias.grad.data, prec=0.0)
             self.assertEqual(conv1.weight.grad.data, conv2.weight.grad.data, prec=0.0)
 
+    @unittest.skipIf(not TEST_CUDA, 'CUDA not available')
+    @unittest.skipIf(not TEST_CUDNN, 'CUDNN not available')
+    def test_Conv2d_cudnn_benchmark_cache(self):
+        cache = cudnn.benchmark_cache
+        shapes = [{'input_size': (2, 3, 7, 7), 'weight_size': (4, 3, 3, 3)},
+                  {'input_size': (2, 4, 9, 9), 'weight_size': (4, 2, 3, 3), 'padding': 1, 'groups': 2}]
+        cache.clear()
+        cache.warmup(shapes)
+        size = cache.size
+        self.assertGreater(size, 0)
+        with tempfile.NamedTemporaryFile() as f:
+            cache.save(f.name)
+            cache.clear()
+            self.assertEqual(cache.size, 0)
+            self.assertEqual(cache.load(f.name), size)
+            self.assertEqual(cache.size, size)
+            # the cached algorithms are found without benchmarking again
+            cache.warmup(shapes)
+            self.assertEqual(cache.size, size)
+        self.assertRaises(RuntimeError, lambda: cache.load(f.name))
+
+    @unittest.skipIf(not torch.backends.mkldnn.is_available(), 'MKL-DNN not available')
+    def test_Conv2d_mkldnn_weight_cache(self):
+        cache = torch.backends.mkldnn.weight_cache
+        self.assertEqual(cache.max_size, 0)
+        conv = nn.Conv2d(3, 16, 3, groups=1)
+        x = torch.randn(2, 3, 8, 8)
+        with torch.no_grad():
+            expected = conv(x)
+            try:
+                cache.max_size = 2
+                self.assertEqual(conv(x), expected)
+                self.assertLessEqual(cache.size, 1)
+                self.assertEqual(conv(x), expected)
+                self.assertEqual(conv(torch.randn(3, 3, 8, 8)).size(), (3, 16, 6, 6))
+                cache.clear()
+                self.assertEqual(cache.size, 0)
+                self.assertRaises(RuntimeError, lambda: setattr(cache, 'size', 1))
+            finally:
+                cache.max_size = 0
+        self.assertEqual(cache.size, 0)
+
+    @unittest.skipIf(not torch.backends.nnpack.is_available(), 'NNPACK not available')
+    def test_Conv2d_nnpack(self):
+        conv = nn.Conv2d(3, 16, 3, padding=1)
+        # double convolutions don't use NNPACK
+        conv_ref = deepcopy(conv).double()
+        for batch_size in [1, 4]:
+            x = torch.randn(batch_size, 3, 9, 7, requires_grad=True)
+            x_ref = x.detach().double().requires_grad_()
+            out = conv(x)
+            out_ref = conv_ref(x_ref)
+            self.assertEqual(out, out_ref.float(), prec=1e-3)
+            grad = torch.randn(out.size())
+            out.backward(grad)
+            out_ref.backward(grad.double())
+            self.assertEqual(x.grad, x_ref.grad.float(), prec=1e-4)
+            self.assertEqual(conv.weight.grad, conv_ref.weight.grad.float(), prec=1e-3)
+            conv.zero_grad()
+            conv_ref.zero_grad()
+
+        cache = torch.backends.nnpack.weight_cache
+        self.assertEqual(cache.max_size, 0)
+        x = torch.randn(2, 3, 8, 8)
+        with torch.no_grad():
+            expected = conv(x)
+            try:
+                cache.max_size = 2
+                self.assertEqual(conv(x), expected)
+                self.assertEqual(cache.size, 1)
+                self.assertEqual(conv(x), expected)
+                self.assertEqual(cache.size, 1)
+                self.assertEqual(conv(torch.randn(3, 3, 6, 6)).size(), (3, 16, 6, 6))
+                self.assertEqual(cache.size, 2)
+                cache.clear()
+                self.assertEqual(cache.size, 0)
+                self.assertRaises(RuntimeError, lambda: setattr(cache, 'size', 1))
+            finally:
+                cache.max_size = 0
+        self.assertEqual(cache.size, 0)
+
     def test_Conv2d_missing_argument(self):
         c = nn.Conv2d(3, 3, 3)
         self.assertRaises(TypeError, lambda: c(None))
@@ -3660,6 +3982,25 @@ class TestNN(NNTestCase):
         self.assertEqual(res, expected)
         self.assertEqual(res2, res)
 
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    def test_CTCLoss_checkpointed(self):
+        target_lengths = [30, 25, 20, 0]
+        input_lengths = [50, 41, 50, 7]
+        for targets in [torch.randint(1, 15, (sum(target_lengths),), dtype=torch.long, device='cuda'),
+                        torch.randint(1, 15, (len(target_lengths), 30), dtype=torch.int, device='cuda')]:
+            for interval in [1, 7, 50, 64]:
+                log_probs = torch.randn(50, 4, 15, dtype=torch.double, device='cuda').log_softmax(2).requires_grad_()
+                res, _ = torch._ctc_loss(log_probs, targets, input_lengths, target_lengths, 0)
+                res_ckpt, _ = torch._ctc_loss_checkpointed(log_probs, targets, input_lengths, target_lengths, 0, interval)
+                self.assertEqual(res[:3], res_ckpt[:3])
+                grad_out = torch.randn_like(res)
+                grad, = torch.autograd.grad(res[:3], log_probs, grad_out[:3])
+                grad_ckpt, = torch.autograd.grad(res_ckpt[:3], log_probs, grad_out[:3])
+                self.assertEqual(grad[:, :3], grad_ckpt[:, :3])
+                # the direct implementation doesn't handle empty targets, so compare
+                # with the likelihood of blanks only
+                self.assertEqual(res_ckpt[3], -log_probs[:7, 3, 0].sum())
+
     def test_RNN_cell_no_broadcasting(self):
         def test(cell_module, input, hx, input_size, hidden_size):
             cell = cell_module(input_size, hidden_size)
@@ -3890,6 +4231,64 @@ class TestNN(NNTestCase):
 
             (hx + cx).sum().backward()
 
+    def test_fused_RNN_cells_cpu(self):
+        # the CPU cells use the fused kernels for float and double; compare
+        # them against the cell equations written out with autograd ops
+        def lstm_ref(input, hx, cx, w_ih, w_hh, b_ih, b_hh):
+            gates = F.linear(input, w_ih, b_ih) + F.linear(hx, w_hh, b_hh)
+            i, f, c, o = gates.chunk(4, 1)
+            cy = f.sigmoid() * cx + i.sigmoid() * c.tanh()
+            return o.sigmoid() * cy.tanh(), cy
+
+        def gru_ref(input, hx, w_ih, w_hh, b_ih, b_hh):
+            ir, ii, in_ = F.linear(input, w_ih, b_ih).chunk(3, 1)
+            hr, hi, hn = F.linear(hx, w_hh, b_hh).chunk(3, 1)
+            r = (ir + hr).sigmoid()
+            i = (ii + hi).sigmoid()
+            n = (in_ + r * hn).tanh()
+            return n + i * (hx - n)
+
+        # an odd hidden size exercises the vectorized kernels' tails
+        input_size, hidden_size, batch = 5, 37, 3
+        for bias in (True, False):
+            input = torch.randn(batch, input_size, dtype=torch.double, requires_grad=True)
+            hx = torch.randn(batch, hidden_size, dtype=torch.double, requires_grad=True)
+            cx = torch.randn(batch, hidden_size, dtype=torch.double, requires_grad=True)
+
+            lstm = nn.LSTMCell(input_size, hidden_size, bias=bias).double()
+            params = list(lstm.parameters()) + ([None, None] if not bias else [])
+            out = lstm(input, (hx, cx))
+            ref = lstm_ref(input, hx, cx, *params)
+            self.assertEqual(out[0], ref[0])
+            self.assertEqual(out[1], ref[1])
+            gradcheck(lambda *args: lstm(args[0], args[1:]), (input, hx, cx))
+            # only one of the outputs contributes to the loss
+            torch.autograd.grad(lstm(input, (hx, cx))[1].sum(), (input, hx, cx))
+
+            gru = nn.GRUCell(input_size, hidden_size, bias=bias).double()
+            params = list(gru.parameters()) + ([None, None] if not bias else [])
+            self.assertEqual(gru(input, hx), gru_ref(input, hx, *params))
+            gradcheck(gru, (input, hx))
+
+        # the layers feed the cells input-to-hidden GEMMs precomputed for the
+        # whole sequence; unroll the cells by hand to check them
+        for module, cell in ((nn.LSTM, nn.LSTMCell), (nn.GRU, nn.GRUCell)):
+            rnn = module(input_size, hidden_size)
+            rnn_cell = cell(input_size, hidden_size)
+            for p, q in zip(rnn_cell.parameters(), rnn.parameters()):
+                p.data.copy_(q.data)
+            input = torch.randn(4, batch, input_size)
+            hx = torch.randn(1, batch, hidden_size)
+            if module is nn.LSTM:
+                output, (hy, cy) = rnn(input, (hx, torch.zeros_like(hx)))
+                hidden = (hx[0], torch.zeros_like(hx[0]))
+            else:
+                output, hy = rnn(input, hx)
+                hidden = hx[0]
+            for t in range(input.size(0)):
+                hidden = rnn_cell(input[t], hidden)
+                self.assertEqual(output[t], hidden[0] if module is nn.LSTM else hidden)
+
     @unittest.skipIf(not (TEST_CUDNN and TEST_MULTIGPU), 'CUDNN or multi-gpu not available')
     def test_cudnn_rnn_dropout_states_device(self):
         rnn = nn.RNN(10, 20, num_layers=2, dropout=.5)
@@ -3946,6 +4345,35 @@ class TestNN(NNTestCase):
             weight_data[:] = 4
             self.assertEqual(weight_data, all_vars[4].data)
 
+    @unittest.skipIf(not TEST_CUDNN, 'CUDNN not available')
+    def test_cudnn_rnn_persistent(self):
+        # persistent kernels are only picked for small minibatches, and must
+        # agree with the standard algorithm
+        for module in (nn.LSTM, nn.GRU, nn.RNN):
+            rnn = module(64, 128).cuda()
+            input = torch.randn(10, 8, 64, device='cuda', requires_grad=True)
+            results = []
+            for persistent in (False, True):
+                torch.backends.cudnn.rnn_persistent = persistent
+                try:
+                    output = rnn(input)[0]
+                    output.sum().backward()
+                finally:
+                    torch.backends.cudnn.rnn_persistent = False
+                results.append([output, input.grad.clone()] + [p.grad.clone() for p in rnn.parameters()])
+                input.grad.zero_()
+                rnn.zero_grad()
+            self.assertEqual(results[0], results[1], prec=1e-4)
+
+            # cached descriptors and weight layouts must not hide in-place
+            # updates of the weights
+            with torch.no_grad():
+                for p in rnn.parameters():
+                    p.mul_(0.5)
+            rnn_copy = deepcopy(rnn)
+            rnn_copy.flatten_parameters()
+            self.assertEqual(rnn(input)[0], rnn_copy(input)[0])
+
     @unittest.skipIf(not TEST_CUDNN, 'CUDNN not available')
     def test_cudnn_weight_tying(self):
         rnns = [
@@ -4543,6 +4971,28 @@ class TestNN(NNTestCase):
         weight = torch.rand(1, dtype=torch.float)
         self.assertEqual(nn.BCEWithLogitsLoss(weight)(output, target), nn.BCELoss(weight)(sigmoid(output), target))
 
+    def _test_cross_entropy_fused(self, device):
+        target = torch.randint(20, (16,), dtype=torch.long, device=device)
+        target[3] = -100
+        weight = torch.rand(20, device=device)
+        for reduction, w, chunk_size in product(['none', 'elementwise_mean', 'sum'], [None, weight], [0, 7]):
+            input = torch.randn(16, 20, device=device, requires_grad=True)
+            expected = F.nll_loss(F.log_softmax(input, 1), target, w, reduction=reduction)
+            output = torch.cross_entropy(input, target, w, F._Reduction.get_enum(reduction), -100, chunk_size)
+            self.assertEqual(expected, output)
+            grad = torch.rand_like(output)
+            expected_grad, = torch.autograd.grad(expected, input, grad)
+            output_grad, = torch.autograd.grad(output, input, grad)
+            self.assertEqual(expected_grad, output_grad)
+            self.assertEqual(0, output_grad[3].abs().sum())
+
+    def test_cross_entropy_fused(self):
+        self._test_cross_entropy_fused('cpu')
+
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    def test_cross_entropy_fused_cuda(self):
+        self._test_cross_entropy_fused('cuda')
+
     def test_bce_with_logits_has_correct_grad_at_zero(self):
         output = torch.zeros(3, 1, requires_grad=True)
         target = torch.zeros(3, 1)
@@ -5104,6 +5554,30 @@ class TestNN(NNTestCase):
                     with cudnn.flags(enabled=False):
                         test(N, C, H, W, mode, padding_mode)
 
+    def test_grid_sample_channels_last(self):
+        # channels-last inputs are sampled without a copy, and must give the
+        # results and gradients of contiguous ones
+        for mode, padding_mode in product(['bilinear', 'nearest'], ['zeros', 'border', 'reflection']):
+            input = torch.randn(3, 11, 5, 7, dtype=torch.double)
+            grid = torch.randn(3, 4, 6, 2, dtype=torch.double) * 1.2
+            grad = torch.randn(3, 11, 4, 6, dtype=torch.double)
+            results = []
+            for inp in [input, input.to_channels_last()]:
+                inp = inp.detach().requires_grad_()
+                g = grid.clone().requires_grad_()
+                out = F.grid_sample(inp, g, mode=mode, padding_mode=padding_mode)
+                out.backward(grad)
+                results.append((out, inp.grad, g.grad))
+            self.assertTrue(results[1][0].is_channels_last())
+            for contiguous, channels_last in zip(*results):
+                self.assertEqual(contiguous, channels_last)
+
+            input = torch.randn(2, 3, 4, 5, dtype=torch.double).to_channels_last().requires_grad_()
+            grid = torch.randn(2, 3, 4, 2, dtype=torch.double, requires_grad=True)
+            self.assertTrue(gradcheck(
+                lambda inp, grid: F.grid_sample(inp, grid, mode=mode, padding_mode=padding_mode),
+                (input, grid)))
+
     def test_grid_sample_3d(self):
         def test(N, C, D, H, W, mode, padding_mode):
             def test_shape(N, C, ID, IH, IW, D, H, W, mode, padding_mode):
@@ -5350,6 +5824,25 @@ class TestNN(NNTestCase):
         out_t_5 = m(in_t_9[:, :, :5, :5, :5])
         self.assertEqual(out_t_9[:, :, :15, :15, :15], out_t_5)
 
+    def test_upsampling_linear_native_cpu(self):
+        # the native CPU kernels against the THNN ones they replace
+        nn_ = torch._C._nn
+        for align_corners in [True, False]:
+            for size in [(3, 4), (5, 17), (12, 9)]:
+                x = torch.randn(2, 3, 5, 8, dtype=torch.double)
+                for input in [x, x.to_channels_last()]:
+                    self.assertEqual(nn_.upsample_bilinear2d(input, size, align_corners),
+                                     nn_.thnn_upsample_bilinear2d(input, size, align_corners))
+                x = torch.randn(1, 2, 3, 5, 4, dtype=torch.double)
+                self.assertEqual(nn_.upsample_trilinear3d(x, (4,) + size, align_corners),
+                                 nn_.thnn_upsample_trilinear3d(x, (4,) + size, align_corners))
+            self.assertTrue(nn_.upsample_bilinear2d(x[0].to_channels_last(), (7, 7), align_corners).is_channels_last())
+
+            input = torch.randn(1, 2, 3, 4, dtype=torch.double, requires_grad=True)
+            for x in [input, input.to_channels_last()]:
+                gradcheck(lambda x: F.interpolate(x, (5, 3), mode='bilinear', align_corners=align_corners), [x])
+                gradgradcheck(lambda x: F.interpolate(x, (5, 3), mode='bilinear', align_corners=align_corners), [x])
+
     def test_interpolate(self):
         def _test_interpolate_helper(in_t, scale_factor, layer):
                 out_size = int(math.floor(in_t.shape[-1] * scale_factor))
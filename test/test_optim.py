@@ -419,6 +419,51 @@ class TestOptim(TestCase):
         with self.assertRaisesRegex(ValueError, "Invalid momentum value: -1.0"):
             optim.RMSprop(None, lr=1e-2, momentum=-1.0)
 
+    def _test_fused_matches_unfused(self, constructor, device):
+        torch.manual_seed(0)
+        # More parameters than fit in one launch, and one spanning many chunks
+        params = [torch.randn(i % 7, 3, device=device) for i in range(150)]
+        params.append(torch.randn(300000, device=device))
+        fused_params = [p.clone() for p in params]
+        for p in params + fused_params:
+            p.requires_grad_()
+        optimizer = constructor(params, fused=False)
+        fused_optimizer = constructor(fused_params, fused=True)
+        for _ in range(3):
+            for p, fused_p in zip(params, fused_params):
+                p.grad = torch.randn_like(p)
+                fused_p.grad = p.grad.clone()
+            optimizer.step()
+            fused_optimizer.step()
+            for p, fused_p in zip(params, fused_params):
+                self.assertEqual(p, fused_p, prec=1e-4)
+                self.assertEqual(p.grad, fused_p.grad)
+
+    def _test_fused(self, device):
+        constructors = [
+            lambda params, fused: optim.SGD(params, lr=1e-2, fused=fused),
+            lambda params, fused: optim.SGD(params, lr=1e-2, momentum=0.9,
+                                            dampening=0.1, fused=fused),
+            lambda params, fused: optim.SGD(params, lr=1e-2, momentum=0.9,
+                                            nesterov=True, fused=fused),
+            lambda params, fused: optim.Adam(params, lr=1e-2, fused=fused),
+            lambda params, fused: optim.Adam(params, lr=1e-2, weight_decay=1e-2,
+                                             amsgrad=True, fused=fused),
+            lambda params, fused: optim.RMSprop(params, lr=1e-2, fused=fused),
+            lambda params, fused: optim.RMSprop(params, lr=1e-2, momentum=0.9,
+                                                centered=True, weight_decay=1e-2,
+                                                fused=fused),
+        ]
+        for constructor in constructors:
+            self._test_fused_matches_unfused(constructor, device)
+
+    def test_fused(self):
+        self._test_fused('cpu')
+
+    @unittest.skipIf(not torch.cuda.is_available(), "no CUDA")
+    def test_fused_cuda(self):
+        self._test_fused('cuda')
+
     @skipIfRocm
     def test_asgd(self):
         self._test_rosenbrock(
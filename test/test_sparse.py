@@ -440,6 +440,47 @@ class TestSparse(TestCase):
         test_shape(100, 1000, 200)
         test_shape(64, 10000, 300)
 
+    def test_csr(self):
+        def test_shape(di, dj, nnz):
+            x, _, _ = self._gen_sparse(2, nnz, [di, dj])
+            crow, col, values = torch.sparse.to_csr(x)
+            dense = self.safeToDense(x)
+            self.assertEqual(crow.size(), torch.Size([di + 1]))
+            for r in range(di):
+                row = torch.zeros(dj, dtype=self.value_dtype, device=self.device)
+                row[col[crow[r]:crow[r + 1]]] = values[crow[r]:crow[r + 1]]
+                self.assertEqual(row, dense[r])
+
+            y = torch.sparse.from_csr(crow, col, values, (di, dj))
+            self.assertTrue(y.is_coalesced())
+            self.assertEqual(self.safeToDense(y), dense)
+            self.assertEqual(y._crow_indices(), crow)
+
+            # reusing y reuses its cached CSR form
+            m = self.randn(dj, 7)
+            expected = torch.mm(dense, m)
+            self.assertEqual(torch.mm(y, m), expected)
+            self.assertEqual(torch.mm(y, m), expected)
+
+            # changing the indices drops the cached form
+            y.transpose_(0, 1)
+            self.assertEqual(torch.mm(y, self.randn(di, 7).fill_(1)),
+                             torch.mm(dense.t(), self.randn(di, 7).fill_(1)))
+
+        test_shape(5, 7, 10)
+        test_shape(1, 7, 3)
+        test_shape(100, 50, 300)
+
+    def test_from_csr_uncanonical(self):
+        crow = self.IndexTensor([0, 2, 2, 3])
+        col = self.IndexTensor([1, 1, 0])
+        values = self.ValueTensor([1, 2, 3])
+        x = torch.sparse.from_csr(crow, col, values, (3, 2))
+        self.assertFalse(x.is_coalesced())
+        self.assertEqual(self.safeToDense(x), self.ValueTensor([[0, 3], [0, 0], [3, 0]]))
+        self.assertRaises(RuntimeError,
+                          lambda: torch.sparse.from_csr(self.IndexTensor([0, 2, 1, 3]), col, values, (3, 2)))
+
     @cpu_only
     def test_saddmm(self):
         def test_shape(di, dj, dk):
@@ -882,6 +923,33 @@ class TestSparse(TestCase):
 
         self.assertFalse(z._indices().numel() != 2 and z.is_coalesced())
 
+    def test_coalesce_many_duplicates(self):
+        # enough entries for the CPU sort and add to split the work
+        def test_shape(sizes, sparse_dims, nnz):
+            i = torch.stack([torch.randint(0, n, (nnz,), dtype=torch.int64)
+                             for n in sizes[:sparse_dims]]).to(self.device)
+            v = self.randn(nnz, *sizes[sparse_dims:])
+            x = self.SparseTensor(i, v, torch.Size(sizes))
+
+            flat = torch.zeros(sizes[:sparse_dims], dtype=torch.int64, device=self.device)
+            flat = torch.arange(flat.numel(), device=self.device).view_as(flat)[tuple(i)]
+            expected = self.randn(*sizes).zero_()
+            expected.view(-1, *sizes[sparse_dims:]).index_add_(0, flat, v)
+
+            y = x.coalesce()
+            self.assertTrue(y.is_coalesced())
+            self.assertEqual(y._nnz(), flat.unique().numel())
+            self.assertEqual(y.to_dense(), expected)
+            self.assertEqual(x.coalesce()._values(), y._values())
+
+            dense = self.randn(*sizes)
+            self.assertEqual(dense + x, dense + expected)
+            self.assertEqual(dense.clone().add_(x, alpha=2), dense + 2 * expected)
+
+        test_shape([100], 1, 100000)
+        test_shape([30, 40], 2, 100000)
+        test_shape([20, 30, 4], 2, 50000)
+
     @cuda_only
     def test_storage_not_null(self):
         x = torch.cuda.sparse.FloatTensor(2)
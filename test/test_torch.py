@@ -796,6 +796,33 @@ class TestTorch(TestCase):
     def test_min(self):
         self._testSelection(torch.min, min)
 
+    def test_max_min_dim_kernels(self):
+        # reductions over inner and outer dimensions, with long rows that are
+        # split up between threads
+        for size, dim in [((4, 1000), 1), ((1000, 37), 0), ((2, 300, 70), 1), ((100003,), 0)]:
+            x = torch.randn(*size)
+            for fn, sort_index in [(torch.max, -1), (torch.min, 0)]:
+                values, indices = fn(x, dim)
+                expected = x.sort(dim)[0].select(dim, sort_index)
+                self.assertEqual(values, expected, 0)
+                self.assertEqual(x.gather(dim, indices.unsqueeze(dim)).squeeze(dim), expected, 0)
+
+            # the first NaN wins
+            x[(slice(None),) * dim + (7,)] = nan
+            x[(slice(None),) * dim + (9,)] = nan
+            for fn in [torch.max, torch.min]:
+                values, indices = fn(x, dim)
+                self.assertTrue(torch.isnan(values).all())
+                self.assertTrue((indices == 7).all())
+
+    def test_norm_dim_kernels(self):
+        for size, dim in [((4, 1000), 1), ((1000, 37), 0), ((2, 300, 70), 1)]:
+            for dtype in [torch.float, torch.double]:
+                x = torch.randn(*size, dtype=dtype)
+                self.assertEqual(x.norm(1, dim), x.abs().sum(dim))
+                self.assertEqual(x.norm(2, dim), x.pow(2).sum(dim).sqrt())
+                self.assertEqual(x.norm(2, dim, keepdim=True), x.pow(2).sum(dim, keepdim=True).sqrt())
+
     @staticmethod
     def _test_norm(self, device):
         # full reduction
@@ -1043,6 +1070,54 @@ class TestTorch(TestCase):
             self.assertEqual(torch.zeros(0, device=device), torch.pairwise_distance(x, y))
             self.assertEqual(torch.zeros((0, 1), device=device), torch.pairwise_distance(x, y, keepdim=True))
 
+    def test_cdist(self):
+        def brute_cdist(x, y, p):
+            diff = (x.unsqueeze(1) - y.unsqueeze(0)).abs()
+            if p == 0:
+                return (diff != 0).sum(-1).to(x.dtype)
+            if p == float('inf'):
+                return diff.max(-1)[0]
+            return diff.pow(p).sum(-1).pow(1. / p)
+
+        devices = ['cpu'] if not torch.cuda.is_available() else ['cpu', 'cuda']
+        for device in devices:
+            # D = 3 runs the direct kernels for every p, D = 40 the GEMM for p = 2
+            for D in [3, 40]:
+                x = torch.randn(7, D, device=device, dtype=torch.double)
+                y = torch.randn(5, D, device=device, dtype=torch.double)
+                y[0] = x[0]
+                for p in [0, 1, 2, 3.5, float('inf')]:
+                    self.assertEqual(torch.cdist(x, y, p), brute_cdist(x, y, p))
+
+            x = torch.randn(4, 0, device=device)
+            y = torch.randn(3, 0, device=device)
+            self.assertEqual(torch.cdist(x, y), torch.zeros(4, 3, device=device))
+            self.assertEqual(torch.cdist(x[:0], y).shape, (0, 3))
+            self.assertRaises(RuntimeError, lambda: torch.cdist(torch.randn(4, 3), torch.randn(4, 2)))
+
+    def test_cdist_topk(self):
+        devices = ['cpu'] if not torch.cuda.is_available() else ['cpu', 'cuda']
+        for device in devices:
+            x = torch.randn(6, 4, device=device, dtype=torch.double)
+            y = torch.randn(50, 4, device=device, dtype=torch.double)
+            for largest in [False, True]:
+                for p in [1, 2]:
+                    values, indices = torch.cdist_topk(x, y, 5, p, largest)
+                    expected_values, expected_indices = torch.cdist(x, y, p).topk(5, 1, largest)
+                    self.assertEqual(values, expected_values)
+                    self.assertEqual(indices, expected_indices)
+            values, indices = torch.cdist_topk(x, y, 0)
+            self.assertEqual(values.shape, (6, 0))
+
+            # enough rows of x that y is split into several blocks
+            x = torch.randn(4096, 4, device=device)
+            y = torch.randn(2500, 4, device=device)
+            values, indices = torch.cdist_topk(x, y, 3)
+            expected_values, expected_indices = torch.cdist(x[:10], y).topk(3, 1, largest=False)
+            self.assertEqual(values[:10], expected_values)
+            self.assertEqual(indices[:10], expected_indices)
+            self.assertRaises(RuntimeError, lambda: torch.cdist_topk(x, y, 51))
+
     @unittest.skipIf(not TEST_SCIPY, "Scipy not found")
     def test_logsumexp(self):
         from scipy.special import logsumexp
@@ -1613,6 +1688,23 @@ class TestTorch(TestCase):
         torch.clamp(m1, max=max_val, out=out)
         self.assertEqual(out, res1)
 
+    def test_clamp_nan_noncontiguous(self):
+        for dtype in [torch.float, torch.double]:
+            m1 = torch.randn(40, 40, dtype=dtype).t()
+            m1[0, 0] = float('nan')
+            res = m1.clamp(-0.5, 0.5)
+            self.assertTrue(math.isnan(res[0, 0]))
+            self.assertEqual(res[1:], m1[1:].contiguous().clamp(-0.5, 0.5))
+            self.assertTrue(math.isnan(m1.clamp(min=-0.5)[0, 0]))
+            self.assertTrue(math.isnan(m1.clamp(max=0.5)[0, 0]))
+            self.assertEqual(m1.clamp(min=-0.5)[1:], torch.max(m1[1:], torch.tensor(-0.5, dtype=dtype)))
+            self.assertEqual(m1.clamp(max=0.5)[1:], torch.min(m1[1:], torch.tensor(0.5, dtype=dtype)))
+
+        m1 = torch.arange(-10, 10, dtype=torch.int).view(4, 5).t()
+        self.assertEqual(m1.clamp(-3, 3), m1.contiguous().clamp(-3, 3))
+        self.assertEqual(m1.clamp(-3, 3).max(), 3)
+        self.assertEqual(m1.clamp(-3, 3).min(), -3)
+
     def test_pow(self):
         # [res] torch.pow([res,] x)
 
@@ -2317,6 +2409,62 @@ class TestTorch(TestCase):
         test_inference(torch.float64)
         test_inference(torch.float32)
 
+    def test_tensor_factory_number_lists(self):
+        # lists of Python floats and ints take a fast path, anything else the
+        # generic one
+        data = [[float(i * 4 + j) for j in range(4)] for i in range(3)]
+        self.assertEqual(torch.arange(12).view(3, 4).float(), torch.tensor(data))
+        self.assertEqual(torch.arange(12).view(3, 4).double(), torch.tensor(data, dtype=torch.float64))
+        self.assertEqual(torch.arange(12).view(3, 4), torch.tensor(data, dtype=torch.int64))
+        self.assertIs(torch.int64, torch.tensor([[1, 2], [3, 4]]).dtype)
+        self.assertEqual(torch.tensor([[1., 2.5], [3., 4.]]), torch.tensor([[1, 2.5], (3, 4)]))
+        self.assertEqual(torch.tensor([1, 0, 1], dtype=torch.uint8), torch.tensor([True, False, True]))
+        self.assertEqual(torch.tensor([2 ** 40]), torch.tensor([2 ** 40], dtype=torch.float64).long())
+        self.assertRaises(ValueError, lambda: torch.tensor([[1., 2.], [3.]]))
+        self.assertRaises(TypeError, lambda: torch.tensor([[1., 2.], [3., 'a']]))
+
+    @unittest.skipIf(not PY3, "array.array only supports the new buffer protocol in Python 3")
+    def test_tensor_factory_buffer(self):
+        import array
+        a = array.array('f', [1., 2., 3.])
+        self.assertIs(torch.float32, torch.tensor(a).dtype)
+        self.assertIs(torch.float64, torch.tensor(array.array('d', [1.])).dtype)
+        self.assertIs(torch.int32, torch.tensor(array.array('i', [1])).dtype)
+        self.assertEqual(torch.tensor([1., 2., 3.]), torch.tensor(a))
+        self.assertEqual(torch.tensor([1., 2., 3.], dtype=torch.float64), torch.tensor(a, dtype=torch.float64))
+
+        # as_tensor shares the memory, tensor copies it
+        shared = torch.as_tensor(a)
+        copied = torch.tensor(a)
+        a[0] = 7.
+        self.assertEqual(7., shared[0].item())
+        self.assertEqual(1., copied[0].item())
+
+        view = memoryview(array.array('h', range(6))).cast('B').cast('h', (2, 3))
+        self.assertEqual(torch.arange(6, dtype=torch.int16).view(2, 3), torch.tensor(view))
+        self.assertEqual(torch.tensor([0, 2, 4], dtype=torch.int16), torch.tensor(memoryview(array.array('h', range(6)))[::2]))
+
+        # bytes are still sequences of ints
+        self.assertEqual(torch.tensor([1, 2]), torch.tensor(b'\x01\x02'))
+
+        class ArrayInterface(object):
+            def __init__(self, tensor):
+                self.tensor = tensor
+                self.__array_interface__ = {
+                    'shape': tuple(tensor.shape),
+                    'typestr': '<f8' if sys.byteorder == 'little' else '>f8',
+                    'data': (tensor.data_ptr(), False),
+                    'strides': tuple(s * tensor.element_size() for s in tensor.stride()),
+                    'version': 3,
+                }
+
+        x = torch.randn(4, 5, dtype=torch.float64).t()
+        y = torch.as_tensor(ArrayInterface(x))
+        self.assertEqual(x, y)
+        self.assertEqual(x.stride(), y.stride())
+        x[0, 0] = 3.
+        self.assertEqual(3., y[0, 0].item())
+
     @unittest.skipIf(not torch.cuda.is_available(), 'no CUDA')
     def test_tensor_factory_cuda_type_inference(self):
         saved_type = torch.Tensor().type()
@@ -3068,6 +3216,30 @@ class TestTorch(TestCase):
     def test_contiguous(self):
         return self._test_contiguous(self, lambda t: t)
 
+    def test_channels_last(self):
+        x = torch.randn(2, 3, 4, 5)
+        self.assertFalse(x.is_channels_last())
+        y = x.to_channels_last()
+        self.assertTrue(y.is_channels_last())
+        self.assertEqual(y.stride(), (60, 1, 15, 3))
+        self.assertEqual(x, y)
+        self.assertIs(y.to_channels_last(), y)
+        self.assertTrue(y.contiguous().is_contiguous())
+        self.assertRaises(RuntimeError, lambda: torch.randn(2, 3, 4).to_channels_last())
+
+        # point-wise ops preserve the layout of their inputs
+        self.assertTrue((y + y).is_channels_last())
+        self.assertTrue((y * 2).is_channels_last())
+        self.assertEqual(y + 1, x + 1)
+
+    def test_conv_channels_last(self):
+        x = torch.randn(2, 3, 8, 8)
+        weight = torch.randn(4, 3, 3, 3)
+        bias = torch.randn(4)
+        expected = torch.nn.functional.conv2d(x, weight, bias, padding=1)
+        result = torch.nn.functional.conv2d(x.to_channels_last(), weight, bias, padding=1)
+        self.assertEqual(result, expected)
+
     def test_empty_tensor_props(self):
         sizes = [(0,), (0, 3), (5, 0), (5, 0, 3, 0, 2), (0, 3, 0, 2), (0, 5, 0, 2, 0)]
         devices = ['cpu'] if not torch.cuda.is_available() else ['cpu', 'cuda']
@@ -3206,6 +3378,28 @@ class TestTorch(TestCase):
         torch.zeros(5, 6).copy_(torch.zeros(6))
         self.assertRaises(RuntimeError, lambda: torch.zeros(5, 6).copy_(torch.zeros(30)))
 
+    def test_copy_transpose_convert(self):
+        # large enough for the native CPU copy kernel; the odd sizes leave
+        # partial transpose tiles
+        x = torch.rand(100, 67) * 100
+        for src_dtype in [torch.float, torch.double, torch.half, torch.int, torch.uint8]:
+            src = x.to(src_dtype)
+            for dst_dtype in [torch.float, torch.double, torch.half, torch.long, torch.int16]:
+                expected = src.double().to(dst_dtype)
+                self.assertEqual(src.to(dst_dtype), expected, 0)
+                # transposed source
+                self.assertEqual(src.t().to(dst_dtype), expected.t(), 0)
+                self.assertEqual(src.t().contiguous().t().to(dst_dtype), expected, 0)
+                dst = torch.empty(67, 100, dtype=dst_dtype)
+                self.assertEqual(dst.copy_(src.t()), expected.t(), 0)
+                # transposed destination
+                dst = torch.empty(67, 100, dtype=dst_dtype).t()
+                self.assertEqual(dst.copy_(src), expected, 0)
+                # strided and broadcast sources
+                self.assertEqual(src[:, ::2].to(dst_dtype), expected[:, ::2], 0)
+                dst = torch.empty(100, 67, dtype=dst_dtype)
+                self.assertEqual(dst.copy_(src[0]), expected[0].expand(100, 67), 0)
+
     def test_randperm(self):
         _RNGState = torch.get_rng_state()
         res1 = torch.randperm(100)
@@ -3335,6 +3529,39 @@ class TestTorch(TestCase):
         # Test that we still have proper sorting with duplicate keys
         self.assertIsOrdered('descending', x, res2val, res2ind, 'random with duplicate keys')
 
+    def test_sort_large(self):
+        # long rows take the radix sort path, and are split across threads
+        for dtype in [torch.float, torch.double, torch.int, torch.long, torch.uint8]:
+            x = torch.randint(-100 if dtype != torch.uint8 else 0, 100, (100000,)).to(dtype)
+            values, indices = x.sort()
+            self.assertIsOrdered('ascending', x, values, indices, 'large {}'.format(dtype))
+            values, indices = x.sort(descending=True)
+            self.assertIsOrdered('descending', x, values, indices, 'large {}'.format(dtype))
+
+        # many short rows along a non-last dimension
+        x = torch.randn(20, 300, 7)
+        values, indices = x.sort(1)
+        self.assertEqual(values, x.gather(1, indices), 0)
+        self.assertTrue((values[:, 1:] >= values[:, :-1]).all())
+
+    def test_sort_stable_and_nan(self):
+        # equal keys keep their order
+        x = torch.tensor([3., 1., 2., 1., 3., 1.] * 20)
+        _, indices = x.sort()
+        for value in [1., 2., 3.]:
+            positions = indices[x[indices] == value]
+            self.assertEqual(positions, positions.sort()[0])
+
+        # NaNs go last, and -0. sorts with 0.
+        x = torch.tensor([2., float('nan'), -1., 0., -0., float('-inf'), float('inf')])
+        values, indices = x.sort()
+        self.assertEqual(values[:6], torch.tensor([float('-inf'), -1., 0., 0., 2., float('inf')]))
+        self.assertTrue(torch.isnan(values[6]))
+        self.assertEqual(indices[6], 1)
+        values, _ = x.sort(descending=True)
+        self.assertTrue(torch.isnan(values[0]))
+        self.assertEqual(values[1:], torch.tensor([float('inf'), 2., 0., 0., -1., float('-inf')]))
+
     def test_topk(self):
         def topKViaSort(t, k, dim, dir):
             sorted, indices = t.sort(dim, dir)
@@ -3379,6 +3606,19 @@ class TestTorch(TestCase):
                         k = random.randint(1, testTensor.size(dim))
                         compare(testTensor, k, dim, dir)
 
+    def test_topk_large(self):
+        x = torch.randn(8, 5000)
+        for k in [1, 10, 3000, 5000]:
+            for largest in [True, False]:
+                values, indices = x.topk(k, largest=largest)
+                expected, _ = x.sort(descending=largest)
+                self.assertEqual(values, expected[:, :k], 0)
+                self.assertEqual(values, x.gather(1, indices), 0)
+
+        values, indices = x.topk(100, sorted=False)
+        self.assertEqual(values.sort(descending=True)[0], x.sort(descending=True)[0][:, :100], 0)
+        self.assertRaises(RuntimeError, lambda: x.topk(5001))
+
     def test_topk_arguments(self):
         q = torch.randn(10, 2, 10)
         # Make sure True isn't mistakenly taken as the 2nd dimension (interpreted as 1)
@@ -3544,6 +3784,20 @@ class TestTorch(TestCase):
 
         self.assertRaises(RuntimeError, lambda: torch.cat([]))
 
+    def test_cat_many_inputs(self):
+        for dtype in [torch.float, torch.double, torch.uint8, torch.int64]:
+            for dim in range(3):
+                inputs = [torch.randn(4, 5, 6).narrow(dim, 0, i % 3 + 1).contiguous().to(dtype)
+                          for i in range(100)]
+                res = torch.cat(inputs, dim)
+                offset = 0
+                for x in inputs:
+                    self.assertEqual(res.narrow(dim, offset, x.size(dim)), x, 0)
+                    offset += x.size(dim)
+                out = torch.empty(0, dtype=dtype)
+                torch.cat(inputs, dim, out=out)
+                self.assertEqual(out, res, 0)
+
     def test_cat_bad_input_sizes(self):
         x = torch.randn(2, 1)
         y = torch.randn(2, 1, 1)
@@ -3933,6 +4187,67 @@ class TestTorch(TestCase):
     def test_gesv_batched_dims(self):
         self._test_gesv_batched_dims(self, lambda t: t)
 
+    @staticmethod
+    def _test_inverse_batched(self, cast):
+        # sizes up to 8 use the register-blocked kernels, larger ones LAPACK/MAGMA
+        for n in [1, 3, 8, 16]:
+            A = cast(torch.randn(2, 3, n, n)) + cast(torch.eye(n)) * n
+            A_inv = torch.inverse(A)
+            self.assertEqual(A_inv.size(), A.size())
+            for i in range(2):
+                for j in range(3):
+                    self.assertEqual(A_inv[i, j], torch.inverse(A[i, j]))
+            self.assertEqual(torch.matmul(A, A_inv), cast(torch.eye(n)).expand_as(A))
+
+        # non-contiguous input
+        A = cast(torch.randn(4, 4, 3)).permute(2, 0, 1)
+        A_inv = torch.inverse(A)
+        for i in range(3):
+            self.assertEqual(A_inv[i], torch.inverse(A[i]))
+
+        # empty batch
+        self.assertEqual(torch.inverse(cast(torch.randn(0, 4, 4))).size(), (0, 4, 4))
+
+        # singular matrix
+        for n in [4, 16]:
+            A = cast(torch.randn(3, n, n))
+            A[1].zero_()
+            self.assertRaises(RuntimeError, lambda: torch.inverse(A))
+
+    @skipIfNoLapack
+    def test_inverse_batched(self):
+        self._test_inverse_batched(self, lambda t: t)
+
+    @staticmethod
+    def _test_cholesky_batched(self, cast):
+        for n in [1, 4, 8, 16]:
+            A = cast(torch.randn(2, 3, n, n))
+            A = torch.matmul(A, A.transpose(-2, -1)) + cast(torch.eye(n)) * 1e-1
+            for upper in [True, False]:
+                factor = torch.cholesky(A, upper)
+                for i in range(2):
+                    for j in range(3):
+                        self.assertEqual(factor[i, j], torch.potrf(A[i, j], upper))
+                if upper:
+                    self.assertEqual(torch.matmul(factor.transpose(-2, -1), factor), A)
+                else:
+                    self.assertEqual(torch.matmul(factor, factor.transpose(-2, -1)), A)
+
+        # upper defaults to False, unlike potrf
+        A = cast(torch.randn(4, 4))
+        A = torch.mm(A, A.t()) + cast(torch.eye(4)) * 1e-1
+        self.assertEqual(torch.cholesky(A), torch.potrf(A, False))
+
+        # not positive definite
+        for n in [4, 16]:
+            A = cast(torch.eye(n)).expand(3, n, n).clone()
+            A[2, 0, 0] = -1
+            self.assertRaises(RuntimeError, lambda: torch.cholesky(A))
+
+    @skipIfNoLapack
+    def test_cholesky_batched(self):
+        self._test_cholesky_batched(self, lambda t: t)
+
     @skipIfNoLapack
     def test_qr(self):
 
@@ -4655,6 +4970,33 @@ class TestTorch(TestCase):
     def test_fft_ifft_rfft_irfft(self):
         self._test_fft_ifft_rfft_irfft(self)
 
+    @unittest.skipIf(not TEST_MKL, "PyTorch is built without MKL support")
+    def test_mkl_fft_plan_cache(self):
+        cache = torch.backends.mkl.mkl_fft_plan_cache
+        original = cache.max_size
+        try:
+            cache.clear()
+            cache.max_size = 2
+            x = torch.randn(4, 8, 2)
+            y = x.fft(1)
+            self.assertEqual((cache.size, cache.hits, cache.misses), (1, 0, 1))
+            self.assertEqual(x.fft(1), y, 0)
+            self.assertEqual((cache.size, cache.hits, cache.misses), (1, 1, 1))
+            # different strides need another descriptor
+            x.transpose(0, 1).fft(1)
+            x.ifft(1)
+            x.fft(1)
+            self.assertEqual((cache.size, cache.hits, cache.misses), (2, 1, 4))
+            cache.max_size = 0
+            self.assertEqual(x.fft(1), y, 0)
+            self.assertEqual(cache.size, 0)
+            with self.assertRaisesRegex(RuntimeError, r"must be non-negative"):
+                cache.max_size = -1
+            with self.assertRaisesRegex(RuntimeError, r"read-only property"):
+                cache.size = -1
+        finally:
+            cache.max_size = original
+
     @staticmethod
     def _test_stft(self, device='cpu'):
         if not TEST_LIBROSA:
@@ -4926,6 +5268,36 @@ class TestTorch(TestCase):
         self.assertEqual(seeded, reseeded, 0,
                          'repeated calls to manual_seed not generating same sequence of normally distributed numbers')
 
+    def test_random_large_reproducible(self):
+        # large contiguous fills are generated in parallel from a counter-based
+        # stream, which must not depend on the number of threads
+        def sample(seed):
+            torch.manual_seed(seed)
+            return [torch.rand(100003), torch.randn(100003, dtype=torch.double),
+                    torch.empty(100003).bernoulli_(0.3), torch.empty(50001).uniform_(-2, 5)]
+
+        num_threads = torch.get_num_threads()
+        try:
+            torch.set_num_threads(1)
+            expected = sample(7)
+            torch.set_num_threads(max(num_threads, 4))
+            actual = sample(7)
+        finally:
+            torch.set_num_threads(num_threads)
+        for e, a in zip(expected, actual):
+            self.assertEqual(e, a, 0)
+        self.assertNotEqual(sample(8)[0], expected[0])
+
+        u, n, b, w = expected
+        self.assertTrue(u.min() >= 0 and u.max() < 1)
+        self.assertEqual(u.mean(), 0.5, 0.01)
+        self.assertEqual(n.mean(), 0, 0.02)
+        self.assertEqual(n.std(), 1, 0.02)
+        self.assertEqual(b.mean(), 0.3, 0.01)
+        self.assertTrue(w.min() >= -2 and w.max() < 5)
+        # consecutive draws differ
+        self.assertNotEqual(torch.rand(100003), torch.rand(100003))
+
     def test_manual_seed(self):
         rng_state = torch.get_rng_state()
         torch.manual_seed(2)
@@ -5812,6 +6184,24 @@ class TestTorch(TestCase):
         out.fill_(0.123)
         self.assertEqual(out, dest.view(-1))  # Must point to the same storage.
 
+    def test_index_select_dims(self):
+        for dtype in [torch.float, torch.double, torch.uint8, torch.int64]:
+            src = torch.randn(3, 4, 5).mul(10).to(dtype)
+            idx = torch.LongTensor([3, 0, 0, 2])
+            for dim in range(3):
+                idx_dim = idx.clamp(max=src.size(dim) - 1)
+                dest = src.index_select(dim, idx_dim)
+                for i in range(idx_dim.size(0)):
+                    self.assertEqual(dest.select(dim, i), src.select(dim, idx_dim[i]), 0)
+                # non-contiguous source
+                self.assertEqual(src.transpose(0, 2).index_select(2 - dim, idx_dim),
+                                 dest.transpose(0, 2), 0)
+            self.assertEqual(src.index_select(1, torch.LongTensor([])).shape, (3, 0, 5))
+        with self.assertRaisesRegex(RuntimeError, 'out of'):
+            torch.randn(3, 4).index_select(1, torch.LongTensor([4]))
+        with self.assertRaisesRegex(RuntimeError, 'out of'):
+            torch.randn(3, 4).index_select(0, torch.LongTensor([-1]))
+
     def test_take(self):
         def check(src, idx):
             expected = src.contiguous().view(-1).index_select(
@@ -6111,6 +6501,66 @@ class TestTorch(TestCase):
         self.assertEqual(tensor.var(dim=0), 0.03125)
         self.assertEqual(tensor.var(), 0.03125)
 
+    def test_std_var_noncontiguous(self):
+        # large enough for the reductions to be split across threads
+        for size in [(7, 9, 11), (3, 50000)]:
+            x = torch.randn(*size, dtype=torch.double).transpose(0, -1)
+            for dim in range(x.dim()):
+                for unbiased in [True, False]:
+                    mean = x.mean(dim, keepdim=True)
+                    n = x.size(dim) - (1 if unbiased else 0)
+                    expected = (x - mean).pow(2).sum(dim) / n
+                    self.assertEqual(x.var(dim, unbiased=unbiased), expected)
+                    self.assertEqual(x.std(dim, unbiased=unbiased), expected.sqrt())
+                    self.assertEqual(x.var(dim, unbiased=unbiased, keepdim=True),
+                                     expected.unsqueeze(dim))
+            n = x.numel() - 1
+            self.assertEqual(x.var(), (x - x.mean()).pow(2).sum() / n)
+            self.assertEqual(x.std(), ((x - x.mean()).pow(2).sum() / n).sqrt())
+
+    @staticmethod
+    def _test_var_mean(self, device):
+        for size in [(7, 9, 11), (3, 50000)]:
+            x = torch.randn(*size, dtype=torch.double, device=device).transpose(0, -1)
+            for dim in range(x.dim()):
+                for unbiased in [True, False]:
+                    for keepdim in [True, False]:
+                        var, mean = torch.var_mean(x, dim, unbiased=unbiased, keepdim=keepdim)
+                        self.assertEqual(var, x.var(dim, unbiased=unbiased, keepdim=keepdim))
+                        self.assertEqual(mean, x.mean(dim, keepdim=keepdim))
+                        std, mean = torch.std_mean(x, dim, unbiased=unbiased, keepdim=keepdim)
+                        self.assertEqual(std, x.std(dim, unbiased=unbiased, keepdim=keepdim))
+                        self.assertEqual(mean, x.mean(dim, keepdim=keepdim))
+            var, mean = torch.var_mean(x)
+            self.assertEqual(var, x.var())
+            self.assertEqual(mean, x.mean())
+            std, mean = torch.std_mean(x, unbiased=False)
+            self.assertEqual(std, x.std(unbiased=False))
+            self.assertEqual(mean, x.mean())
+
+        # stable for values with a large mean
+        x = torch.tensor([2281.5, 2281.25], device=device)
+        var, mean = torch.var_mean(x)
+        self.assertEqual(var, 0.03125)
+        self.assertEqual(mean, 2281.375)
+
+    def test_var_mean(self):
+        self._test_var_mean(self, 'cpu')
+
+        x = torch.randn(5, 1)
+        self.assertEqual(x.var(1, unbiased=False), torch.zeros(5))
+        self.assertTrue(math.isnan(x.var(1)[0]))
+
+    def test_max_min_noncontiguous(self):
+        x = torch.randn(20, 30, 40).transpose(0, 2)[:, ::2]
+        x[3, 4, 5] = nan
+        for dim in range(x.dim()):
+            for fn in [torch.max, torch.min]:
+                values, indices = fn(x, dim)
+                expected_values, expected_indices = fn(x.contiguous(), dim)
+                self.assertEqual(values, expected_values)
+                self.assertEqual(indices, expected_indices)
+
     @staticmethod
     def _test_view(self, cast):
         tensor = cast(torch.rand(15))
@@ -7176,6 +7626,20 @@ class TestTorch(TestCase):
         self.assertRaises(TypeError,
                           lambda: torch.isclose(x, x, torch.tensor(1.5), torch.tensor(1., requires_grad=True)).all())
 
+    def test_parsing_repeated_calls(self):
+        # overload resolution is cached per function, so the same call with
+        # arguments that bind differently must still pick the right overload
+        x = torch.ones(3)
+        for _ in range(3):
+            self.assertEqual(x.add(2), torch.full((3,), 3))
+            self.assertEqual(x.add(torch.tensor(2.)), torch.full((3,), 3))
+            self.assertEqual(x.add(torch.ones(3)), torch.full((3,), 2))
+            z = torch.tensor(2., requires_grad=True)
+            x.add(z).sum().backward()
+            self.assertEqual(z.grad, torch.tensor(3.))
+            self.assertRaises(TypeError, lambda: torch.cumsum(x, torch.tensor(0.)))
+            self.assertEqual(torch.cumsum(x, torch.tensor(0)), torch.tensor([1., 2., 3.]))
+
     def test_parsing_intlist(self):
         #  parse with integer variables
         self.assertEqual(torch.Size([3, 4]), torch.ones((torch.tensor(3), torch.tensor(4))).shape)
@@ -7340,6 +7804,23 @@ class TestTorch(TestCase):
             xh2 = torch.load(f)
             self.assertEqual(xh.float(), xh2.float())
 
+    def test_half_tensor_binary_ops(self):
+        # computed in float and rounded once to half; the sizes cover the
+        # vectorized blocks and their tails
+        for size in [(5, 5), (3, 700)]:
+            x = torch.randn(*size)
+            y = torch.rand(*size) + 0.5
+            xh, yh = x.half(), y.half()
+            xf, yf = xh.float(), yh.float()
+            self.assertEqual((xh + yh).float(), (xf + yf).half().float(), 0)
+            self.assertEqual(torch.add(xh, 2, yh).float(), (xf + 2 * yf).half().float(), 0)
+            self.assertEqual((xh - yh).float(), (xf - yf).half().float(), 0)
+            self.assertEqual((xh * yh).float(), (xf * yf).half().float(), 0)
+            self.assertEqual((xh / yh).float(), (xf / yf).half().float(), 0)
+            # broadcast scalar operand and a transposed, non-contiguous one
+            self.assertEqual((xh * yh[:1, :1]).float(), (xf * yf[:1, :1]).half().float(), 0)
+            self.assertEqual((xh.t() + yh.t()).float(), (xf.t() + yf.t()).half().float(), 0)
+
     def test_serialize_device(self):
         device_str = ['cpu', 'cpu:0', 'cuda', 'cuda:0']
         device_obj = [torch.device(d) for d in device_str]
@@ -7949,6 +8430,26 @@ class TestTorch(TestCase):
         z = from_dlpack(to_dlpack(x))
         self.assertEqual(z, x)
 
+    @unittest.skipIf(not torch.cuda.is_available(), "No CUDA")
+    def test_dlpack_cuda_streams(self):
+        stream = torch.cuda.Stream()
+        with torch.cuda.stream(stream):
+            x = torch.randn(1000, 1000, device='cuda')
+            y = x * 2
+        # the consumer's stream waits for the producer's
+        capsule = to_dlpack(y, stream=torch.cuda.current_stream())
+        z = from_dlpack(capsule, stream=stream)
+        self.assertEqual(z, x * 2)
+
+        # imported memory is registered with the caching allocator, but
+        # memory that came from it isn't counted twice
+        external = torch.cuda.memory_stats()['external']
+        w = from_dlpack(to_dlpack(x))
+        self.assertEqual(torch.cuda.memory_stats()['external'], external)
+        w[1:].record_stream(stream)
+        del w
+        self.assertEqual(torch.cuda.memory_stats()['external'], external)
+
     @unittest.skipIf(not TEST_NUMPY, "Numpy not found")
     def test_from_numpy(self):
         dtypes = [
@@ -8218,6 +8719,41 @@ class TestTorch(TestCase):
         for idx in iter_indices(x):
             self.assertEqual(x[idx] >= y[idx], ge[idx] == 1)
 
+    def test_comparison_ops_broadcast_out(self):
+        x = torch.randn(5, 6).t()
+        y = torch.randn(5, 1)
+        for op in ['eq', 'ne', 'lt', 'le', 'gt', 'ge']:
+            res = getattr(x, op)(y)
+            self.assertEqual(res.dtype, torch.uint8)
+            expected = getattr(x.contiguous(), op)(y.expand(6, 5).contiguous())
+            self.assertEqual(res, expected)
+
+            out = torch.ByteTensor()
+            getattr(torch, op)(x, y, out=out)
+            self.assertEqual(out, expected)
+
+            res = getattr(x, op)(0.5)
+            self.assertEqual(res, getattr(x, op)(torch.full_like(x, 0.5)))
+
+            # the in-place variants keep the type of self
+            z = x.clone()
+            getattr(z, op + '_')(y)
+            self.assertEqual(z.dtype, x.dtype)
+            self.assertEqual(z, expected.to(x.dtype))
+
+    def test_where(self):
+        for dtype in [torch.float, torch.double, torch.long, torch.uint8]:
+            x = torch.randn(6, 5).t().to(dtype)
+            y = torch.randn(5, 1).to(dtype)
+            cond = torch.randn(1, 6) > 0
+            res = torch.where(cond, x, y)
+            expected = x.clone()
+            y_expanded = y.expand(5, 6)
+            for idx in iter_indices(x):
+                if cond[0, idx[1]] == 0:
+                    expected[idx] = y_expanded[idx]
+            self.assertEqual(res, expected)
+
     def test_bitwise_ops(self):
         x = torch.randn(5, 5).gt(0)
         y = torch.randn(5, 5).gt(0)
@@ -8430,6 +8966,30 @@ class TestTorch(TestCase):
         self.assertEqual(torch.ByteTensor([7, 42, 128, 133]), byte_unique)
         self.assertEqual(torch.LongTensor([3, 0, 0, 0, 1, 2]), byte_inverse)
 
+        x_unique, x_counts = x.unique(sorted=True, return_counts=True)
+        self.assertEqual(expected_unique, x_unique)
+        self.assertEqual(torch.LongTensor([1, 3, 2, 1, 1]), x_counts)
+
+        x_unique, x_inverse, x_counts = torch.unique(
+            x, sorted=True, return_inverse=True, return_counts=True)
+        self.assertEqual(expected_unique, x_unique)
+        self.assertEqual(expected_inverse, x_inverse)
+        self.assertEqual(torch.LongTensor([1, 3, 2, 1, 1]), x_counts)
+
+    def test_unique_large(self):
+        # large inputs are deduplicated in parallel partitions
+        x = torch.randint(-500, 500, (200000,)).long()
+        x_unique, x_inverse, x_counts = x.unique(
+            sorted=True, return_inverse=True, return_counts=True)
+        expected = sorted(set(x.tolist()))
+        self.assertEqual(torch.LongTensor(expected), x_unique)
+        self.assertEqual(x, x_unique[x_inverse])
+        self.assertEqual(torch.bincount(x_inverse), x_counts)
+
+        x_unique, x_inverse = x.float().unique(return_inverse=True)
+        self.assertEqual(expected, sorted(x_unique.long().tolist()))
+        self.assertEqual(x.float(), x_unique[x_inverse])
+
     @staticmethod
     def _test_bincount(self, device):
         # negative input throws
@@ -8491,6 +9051,15 @@ class TestTorch(TestCase):
         big_exp[1] = 1000000
         big_out = torch.ones(1000000, dtype=torch.int8, device=device).bincount()
         self.assertEqual(big_exp, big_out)
+        # test large input size with weights and many bins, which are counted
+        # in per-thread histograms on CPU
+        for nbins in (10, 1000):
+            t = torch.randint(nbins, (1000000,), dtype=torch.int64, device=device)
+            w = torch.rand(1000000, dtype=torch.double, device=device)
+            expected = torch.zeros(nbins, dtype=torch.double, device=device).index_add_(0, t, w)
+            self.assertEqual(expected, t.bincount(w))
+            counts = torch.zeros(nbins, dtype=torch.long, device=device).index_add_(0, t, torch.ones_like(t))
+            self.assertEqual(counts, t.bincount())
 
     def test_bincount_cpu(self):
         self._test_bincount(self, device='cpu')
@@ -8524,6 +9093,24 @@ class TestTorch(TestCase):
         self.assertTrue(grid_b.equal(expected_grid_b))
         self.assertTrue(grid_c.equal(expected_grid_c))
 
+    def test_murmur3_hash(self):
+        # The low 64 bits of MurmurHash3_x64_128 of the 8 byte ids
+        ids = torch.tensor([-3, 0, 7, 123456789012345])
+        expected = torch.tensor([2010103946454652540, 4548340543905915070,
+                                 -212406819515953212, 6466774078116880712])
+        self.assertEqual(torch.murmur3_hash(ids, seeds=[4000000000]), expected)
+        self.assertEqual(torch.murmur3_hash(ids.int()[:3], seeds=[4000000000]), expected[:3])
+        self.assertEqual(torch.murmur3_hash(ids, seeds=[4000000000], modulo=1000),
+                         torch.tensor([540, 70, 404, 712]))
+
+        ids = torch.randint(-2**40, 2**40, (5, 3000), dtype=torch.long).t()
+        hashed = torch.murmur3_hash(ids, seeds=[1, 2, 3], modulo=100)
+        self.assertEqual(hashed.shape, torch.Size([3000, 5, 3]))
+        for i, seed in enumerate([1, 2, 3]):
+            self.assertEqual(hashed[..., i], torch.murmur3_hash(ids, seeds=[seed], modulo=100))
+        self.assertTrue((hashed >= 0).all() and (hashed < 100).all())
+        self.assertRaises(RuntimeError, lambda: torch.murmur3_hash(torch.randn(3)))
+
 
 # Functions to test negative dimension wrapping
 METHOD = 1
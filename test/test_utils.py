@@ -631,6 +631,50 @@ class TestBottleneck(TestCase):
 from torch.utils.collect_env import get_pretty_env_info
 
 
+class TestFlatten(TestCase):
+    def test_flatten_adjacent_dense_tensors(self):
+        from torch._utils import _flatten_dense_tensors, _flatten_adjacent_dense_tensors, \
+            _unflatten_dense_tensors_
+        params = [torch.randn(2, 3), torch.randn(4), torch.randn(1, 5)]
+        self.assertIsNone(_flatten_adjacent_dense_tensors(params))
+        grads = [torch.randn(2, 3), torch.randn(4), torch.randn(1, 5)]
+        flat = _flatten_dense_tensors(grads)
+        expected = [g.clone() for g in grads]
+        _unflatten_dense_tensors_(flat, grads)
+        for grad, value in zip(grads, expected):
+            self.assertEqual(grad, value)
+        adjacent = _flatten_adjacent_dense_tensors(grads)
+        self.assertEqual(adjacent.data_ptr(), flat.data_ptr())
+        self.assertEqual(adjacent.size(), torch.Size([15]))
+        # the buffer and the tensors share memory both ways
+        adjacent.mul_(2)
+        self.assertEqual(grads[1], expected[1] * 2)
+        grads[2].zero_()
+        self.assertEqual(flat[-5:], torch.zeros(5))
+        self.assertIsNone(_flatten_adjacent_dense_tensors(grads[::-1]))
+
+    def test_unflatten_dense_tensors_grad_accumulation(self):
+        from torch._utils import _flatten_dense_tensors, _flatten_adjacent_dense_tensors, \
+            _unflatten_dense_tensors_
+        model = nn.Sequential(nn.Linear(3, 4), nn.Linear(4, 2))
+        model(torch.randn(5, 3)).sum().backward()
+        grads = [p.grad.data for p in model.parameters()]
+        flat = _flatten_dense_tensors(grads)
+        _unflatten_dense_tensors_(flat, grads)
+        model.zero_grad()
+        input = torch.randn(5, 3)
+        model(input).sum().backward()
+        model(input).sum().backward()
+        # AccumulateGrad wrote into the buffer
+        adjacent = _flatten_adjacent_dense_tensors([p.grad for p in model.parameters()])
+        self.assertIsNotNone(adjacent)
+        self.assertEqual(adjacent.data_ptr(), flat.data_ptr())
+        accumulated = flat.clone()
+        model.zero_grad()
+        model(input).sum().backward()
+        self.assertEqual(flat * 2, accumulated)
+
+
 class TestCollectEnv(TestCase):
     def test_smoke(self):
         info_output = get_pretty_env_info()
@@ -160,13 +160,20 @@ def should_generate_python_binding(declaration):
     return True
 
 
+def is_nn_module_function(declaration):
+    # THNN functions and native functions marked with `python_module: nn`
+    # are bound in torch._C._nn rather than in the torch namespace.
+    return (declaration['mode'] == 'NN' or
+            declaration.get('python_module') == 'nn')
+
+
 def gen_py_variable_methods(out, declarations, template_path):
     PY_VARIABLE_METHODS_CPP = CodeTemplate.from_file(template_path + '/python_variable_methods.cpp')
     PY_VARIABLE_DISPATCH_H = CodeTemplate.from_file(template_path + '/python_variable_methods_dispatch.h')
 
     def should_bind(declaration):
         return (should_generate_python_binding(declaration) and
-                declaration['mode'] != 'NN' and
+                not is_nn_module_function(declaration) and
                 'Tensor' in declaration['method_of'])
 
     py_variable_methods = group_declarations_by_name(declarations, should_bind)
@@ -183,7 +190,7 @@ def gen_py_nn_functions(out, declarations, template_path):
 
     def should_bind(declaration):
         return (should_generate_python_binding(declaration) and
-                declaration['mode'] == 'NN')
+                is_nn_module_function(declaration))
 
     py_nn_functions = group_declarations_by_name(declarations, should_bind)
 
@@ -199,7 +206,7 @@ def gen_py_torch_functions(out, declarations, template_path):
 
     def should_bind(declaration):
         return (should_generate_python_binding(declaration) and
-                declaration['mode'] != 'NN' and
+                not is_nn_module_function(declaration) and
                 'namespace' in declaration['method_of'])
 
     py_torch_functions = group_declarations_by_name(declarations, should_bind)
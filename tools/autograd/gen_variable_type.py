@@ -126,6 +126,9 @@ if (${cond}) {
 RECORD_FUNCTION = CodeTemplate("""\
 profiler::RecordFunction profiler("${name}", Function::get_next_sequence_nr());""")
 
+# arguments whose shapes and types the profiler records, see emit_record_function
+PROFILED_INPUT_TYPES = {'Tensor', 'IndexTensor', 'BoolTensor', 'TensorList'}
+
 PRE_RECORD_TRACE = CodeTemplate("""\
 torch::jit::Node* node = nullptr;
 if (jit::tracer::isTracing()) {
@@ -473,6 +476,16 @@ def emit_body(declaration):
             return []
         return ['check_inplace({});'.format(arg['name']) for arg in differentiable_outputs]
 
+    def emit_record_function():
+        body = [RECORD_FUNCTION.substitute(combined)]
+        record_inputs = ['profiler.addInput({});'.format(arg['name'])
+                         for arg in declaration['arguments']
+                         if arg['dynamic_type'] in PROFILED_INPUT_TYPES]
+        if record_inputs:
+            body.append(CONDITIONAL.substitute(cond='profiler.recordsInputs()',
+                                               statements=record_inputs))
+        return body
+
     def emit_increment_version():
         if not modifies_arguments:
             return []
@@ -483,7 +496,7 @@ def emit_body(declaration):
 
     body = []
     if base_name not in DONT_PROFILE:
-        body.append(RECORD_FUNCTION.substitute(combined))
+        body.extend(emit_record_function())
     if strategy != 'use_type':
         body.extend(unpack_args(env, declaration))
     if requires_derivative:
@@ -528,6 +541,9 @@ def unpack_args(env, declaration):
         is_nullable = arg.get('is_nullable', False)
         ref = (not is_nullable) and dynamic_type not in ['TensorList', 'SparseTensorRef']
         suffix = '_opt' if is_nullable else ''
+        if dynamic_type == 'TensorList' and arg['name'] == 'indices':
+            # the indices of advanced indexing may have null entries
+            suffix = '_idxs'
 
         body.append(UNPACK_TENSOR.substitute(
             arg_name=arg['name'],
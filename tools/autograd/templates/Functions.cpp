@@ -389,6 +389,26 @@ Tensor logsumexp_backward(Tensor grad, const Tensor & self, Tensor result, int64
   return grad * (self - result).exp();
 }
 
+Tensor cross_entropy_backward(const Tensor & grad, const Tensor & self, const Tensor & target, const Tensor & weight,
+                              int64_t reduction, int64_t ignore_index, int64_t chunk_size, const Tensor & logsumexp) {
+  if (!GradMode::is_enabled()) {
+    return at::_cross_entropy_backward(grad, self, target, weight, reduction, ignore_index, chunk_size, logsumexp);
+  }
+  // _cross_entropy_backward isn't differentiable, so double backward goes
+  // through softmax, which materializes the probabilities:
+  // grad_input = scale * (softmax(self) - onehot(target))
+  auto ignored = target.eq(ignore_index);
+  auto safe_target = target.clone().masked_fill_(ignored, 0);
+  auto row_weight = weight.defined() ? weight.index_select(0, safe_target) : at::ones({self.size(0)}, self.options());
+  row_weight = row_weight * target.ne(ignore_index).type_as(row_weight);
+  auto scale = row_weight * grad;
+  if (reduction == Reduction::ElementwiseMean) {
+    scale = scale / row_weight.sum();
+  }
+  auto onehot = at::zeros_like(self).scatter_(1, safe_target.unsqueeze(1), 1);
+  return (at::softmax(self, 1) - onehot) * scale.unsqueeze(1);
+}
+
 Tensor unbind_backward(const variable_list& grads, int64_t dim) {
   IntList sizes;
   at::TensorOptions o;
@@ -525,6 +545,24 @@ Tensor repeat_backward(Tensor grad, int64_t input_dims, IntList repeats) {
   return grad;
 }
 
+std::tuple<Tensor, Tensor, Tensor> linear_relu_backward(
+    const Tensor & grad, const Tensor & input, const Tensor & weight,
+    const Tensor & result, std::array<bool, 3> output_mask) {
+  // gradient of the pre-activation output, flattened to (batch, out_features)
+  auto grad_pre = threshold_backward(grad, result, 0, 0).reshape({-1, weight.size(0)});
+  Tensor grad_input, grad_weight, grad_bias;
+  if (output_mask[0]) {
+    grad_input = grad_pre.mm(weight).reshape(input.sizes());
+  }
+  if (output_mask[1]) {
+    grad_weight = grad_pre.t().mm(input.reshape({-1, input.size(-1)}));
+  }
+  if (output_mask[2]) {
+    grad_bias = grad_pre.sum(0);
+  }
+  return std::tuple<Tensor, Tensor, Tensor>{grad_input, grad_weight, grad_bias};
+}
+
 // p1m == 1 - p
 Tensor _fused_dropout_backward(Tensor grad, Tensor mask, double p1m) {
   if (grad.requires_grad()) {
@@ -603,6 +641,36 @@ Tensor var_backward(Tensor grad, const Tensor & self, int64_t dim, bool unbiased
   return (2.0 / (self.size(dim) - unbiased)) * grad * (self - self.mean(dim, true));
 }
 
+Tensor std_to_var_grad(const Tensor & grad, const Tensor & std) {
+  return grad.defined() ? grad / (std * 2) : grad;
+}
+
+// Either output of var_mean may not have a gradient.
+Tensor var_mean_backward(const Tensor & grad_var, const Tensor & grad_mean, const Tensor & self, bool unbiased) {
+  Tensor grad;
+  if (grad_var.defined()) {
+    grad = var_backward(grad_var, self, unbiased);
+  }
+  if (grad_mean.defined()) {
+    auto mean_grad = grad_mean.expand(self.sizes()) / self.numel();
+    grad = grad.defined() ? grad + mean_grad : mean_grad;
+  }
+  return grad;
+}
+
+Tensor var_mean_backward(const Tensor & grad_var, const Tensor & grad_mean, const Tensor & self,
+                         int64_t dim, bool unbiased, bool keepdim) {
+  Tensor grad;
+  if (grad_var.defined()) {
+    grad = var_backward(grad_var, self, dim, unbiased, keepdim);
+  }
+  if (grad_mean.defined()) {
+    auto mean_grad = sum_backward(grad_mean, self.sizes(), dim, keepdim) / _safe_size(self.sizes(), dim);
+    grad = grad.defined() ? grad + mean_grad : mean_grad;
+  }
+  return grad;
+}
+
 Tensor masked_scatter_backward(const Tensor & grad, const Tensor & mask, IntList sizes) {
   int64_t numel = 1;
   for (auto size : sizes) {
@@ -647,6 +715,34 @@ Tensor potrf_backward(Tensor grad, bool upper, Tensor L) {
   return S;
 }
 
+// potrf_backward for batches of matrices
+Tensor cholesky_backward(Tensor grad, bool upper, Tensor L) {
+  if (L.dim() == 2) {
+    return potrf_backward(grad, upper, L);
+  }
+  if (upper) {
+    L = L.transpose(-2, -1);
+    grad = grad.transpose(-2, -1);
+  }
+
+  // tril() and diag() only take matrices, so phi masks the batch instead
+  auto n = L.size(-1);
+  auto lower = at::ones({n, n}, L.type()).tril();
+  auto phi_mask = lower - 0.5 * at::eye(n, L.type());
+
+  auto Lbar = grad * lower;
+  auto Lt = L.transpose(-2, -1);
+  auto P = at::matmul(Lt, Lbar) * phi_mask;
+  Tensor S;
+  std::tie(S, std::ignore) = at::gesv(P + P.transpose(-2, -1), Lt);
+  std::tie(S, std::ignore) = at::gesv(S.transpose(-2, -1), Lt);
+  S = S * phi_mask;
+  if (upper) {
+    S = S.transpose(-2, -1);
+  }
+  return S;
+}
+
 Tensor split_with_sizes_backward(const std::vector<torch::autograd::Variable> &grads,
                                  IntList split_sizes, int64_t dim, IntList sizes, const Type &type) {
   dim = at::maybe_wrap_dim(dim, sizes.size());
@@ -1937,6 +2033,128 @@ std::tuple<Tensor, Tensor, Tensor> batchnorm_double_backward(
 
 }
 
+// Helper for layer_norm_double_backward and group_norm_double_backward.
+// input, ggI and gO are (1, rows, cols) views normalized over dim 2 with the
+// row statistics mean and rstd; gamma, ggG and ggB are undefined or expanded
+// to the same shape. Returns {gI, gG, ggO} with gG still expanded.
+static std::tuple<Tensor, Tensor, Tensor> normalization_double_backward(
+    const Tensor & input,
+    const Tensor & gamma,
+    const Tensor & ggI,
+    const Tensor & ggG,
+    const Tensor & ggB,
+    const Tensor & gO,
+    const Tensor & mean,
+    const Tensor & rstd) {
+  // The first backward's grad_input is the batch norm (training, no affine)
+  // grad_input of gO * gamma, normalizing each row of dim 1.
+  auto gxhat = gamma.defined() ? gO * gamma : gO;
+  Tensor gI, ggxhat;
+  std::tie(gI, std::ignore, ggxhat) = batchnorm_double_backward(
+      input, Tensor(), ggI, Tensor(), Tensor(), gxhat, Tensor(), Tensor(),
+      true, 0, mean.reshape({-1}), rstd.reshape({-1}), {{false, false, false}});
+
+  auto cols = input.size(2);
+  auto rstd3 = rstd.reshape({1, -1, 1});
+  auto xhat = (input - mean.reshape({1, -1, 1})) * rstd3;
+
+  Tensor gG;
+  if (gamma.defined() && ggxhat.defined()) {
+    gG = ggxhat * gO;
+  }
+  Tensor ggO;
+  if (ggxhat.defined()) {
+    ggO = gamma.defined() ? ggxhat * gamma : ggxhat;
+  }
+  if (ggG.defined()) {
+    auto ggO_G_term = ggG * xhat;
+    ggO = ggO.defined() ? ggO + ggO_G_term : ggO_G_term;
+    // grad_weight = sum(gO * xhat) depends on input through xhat
+    auto c = gO * ggG;
+    auto gI_G_term = (rstd3 / cols) * (cols * c).sub_(c.sum(2, true)).sub_(xhat * (c * xhat).sum(2, true));
+    gI = gI.defined() ? gI + gI_G_term : gI_G_term;
+  }
+  if (ggB.defined()) {
+    ggO = ggO.defined() ? ggO + ggB : ggB;
+  }
+  return std::tuple<Tensor, Tensor, Tensor>{gI, gG, ggO};
+}
+
+std::tuple<Tensor, Tensor, Tensor> layer_norm_double_backward(
+    const Tensor & input,
+    const Tensor & gamma,
+    const Tensor & ggI,
+    const Tensor & ggG,
+    const Tensor & ggB,
+    const Tensor & gO,
+    const Tensor & mean,
+    const Tensor & rstd,
+    int64_t M,
+    int64_t N,
+    std::array<bool,3> output_mask) {
+  auto rows = [&](const Tensor& t) {
+    return t.defined() ? t.reshape({1, M, N}) : t;
+  };
+  auto expand_param = [&](const Tensor& t) {
+    return t.defined() ? t.reshape({1, 1, N}).expand({1, M, N}) : t;
+  };
+  Tensor gI, gG, ggO;
+  std::tie(gI, gG, ggO) = normalization_double_backward(
+      rows(input), expand_param(gamma), rows(ggI), expand_param(ggG),
+      expand_param(ggB), rows(gO), mean, rstd);
+
+  if (gI.defined()) gI = gI.reshape(input.sizes());
+  if (gG.defined()) gG = gG.sum({0, 1}).reshape(gamma.sizes());
+  if (ggO.defined()) ggO = ggO.reshape(gO.sizes());
+  if (output_mask[0] && !gI.defined()) gI = at::zeros_like(input);
+  if (output_mask[1] && !gG.defined()) {
+    AT_ASSERTM(gamma.defined(), "gamma should always be defined when it requires grad");
+    gG = at::zeros_like(gamma);
+  }
+  if (output_mask[2] && !ggO.defined()) ggO = at::zeros_like(gO);
+  return std::tuple<Tensor, Tensor, Tensor>{gI, gG, ggO};
+}
+
+std::tuple<Tensor, Tensor, Tensor> group_norm_double_backward(
+    const Tensor & input,
+    const Tensor & gamma,
+    const Tensor & ggI,
+    const Tensor & ggG,
+    const Tensor & ggB,
+    const Tensor & gO,
+    const Tensor & mean,
+    const Tensor & rstd,
+    int64_t N,
+    int64_t C,
+    int64_t HxW,
+    int64_t group,
+    std::array<bool,3> output_mask) {
+  const int64_t row_size = C / group * HxW;
+  auto rows = [&](const Tensor& t) {
+    return t.defined() ? t.reshape({1, N * group, row_size}) : t;
+  };
+  auto expand_param = [&](const Tensor& t) {
+    return t.defined()
+        ? t.reshape({1, C, 1}).expand({N, C, HxW}).reshape({1, N * group, row_size})
+        : t;
+  };
+  Tensor gI, gG, ggO;
+  std::tie(gI, gG, ggO) = normalization_double_backward(
+      rows(input), expand_param(gamma), rows(ggI), expand_param(ggG),
+      expand_param(ggB), rows(gO), mean, rstd);
+
+  if (gI.defined()) gI = gI.reshape(input.sizes());
+  if (gG.defined()) gG = gG.reshape({N, C, HxW}).sum({0, 2}).reshape(gamma.sizes());
+  if (ggO.defined()) ggO = ggO.reshape(gO.sizes());
+  if (output_mask[0] && !gI.defined()) gI = at::zeros_like(input);
+  if (output_mask[1] && !gG.defined()) {
+    AT_ASSERTM(gamma.defined(), "gamma should always be defined when it requires grad");
+    gG = at::zeros_like(gamma);
+  }
+  if (output_mask[2] && !ggO.defined()) ggO = at::zeros_like(gO);
+  return std::tuple<Tensor, Tensor, Tensor>{gI, gG, ggO};
+}
+
 std::tuple<Tensor, Tensor, Tensor> _trilinear_backward(const Tensor& grad_out, const Tensor& i1, const Tensor& i2, const Tensor& i3,
 						       IntList expand1, IntList expand2, IntList expand3,
 						       IntList sumdim, int64_t unroll_dim, std::array<bool, 3> grad_mask) {
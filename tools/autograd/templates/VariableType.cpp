@@ -258,6 +258,24 @@ std::vector<at::Tensor> VariableType::unpack(at::TensorList tl, const char *name
   return ret;
 }
 
+// Like unpack, but for the indices of advanced indexing, which are undefined
+// for the dimensions that aren't indexed
+std::vector<at::Tensor> VariableType::unpack_idxs(at::TensorList tl, const char *name, int pos) {
+  std::vector<at::Tensor> ret(tl.size());
+  for (size_t i = 0; i < tl.size(); ++i) {
+    const auto &t = tl[i];
+    if (!t.defined()) {
+      continue;
+    }
+    if (!isVariableType(t.type())) {
+      AT_ERROR("Expected object of type Variable but found type ", t.type().toString(), " at position #", i, " "
+                    "for iterable argument #", pos, " '", name, "'");
+    }
+    ret[i] = static_cast<const Variable&>(t).data();
+  }
+  return ret;
+}
+
 // Assumed that saved tensor lists are never inplace outputs
 static std::vector<SavedVariable> make_saved_variable_list(TensorList tensors) {
   return fmap(tensors, [](const Tensor& tensor) -> SavedVariable {
@@ -326,6 +344,12 @@ static void check_no_requires_grad(const Tensor& tensor, const char* name) {
   }
 }
 
+static void check_no_requires_grad(TensorList tensors, const char* name) {
+  for (auto& tensor : tensors) {
+    check_no_requires_grad(tensor, name);
+  }
+}
+
 static void check_inplace(const Tensor& tensor) {
   auto& var = static_cast<const Variable&>(tensor);
   if (var.requires_grad() && var.is_leaf() && GradMode::is_enabled()) {
@@ -380,7 +404,11 @@ template<typename... Args> inline variable_list flatten_tensor_args(Args&&... ar
 }
 
 static void increment_version(Tensor & t) {
-  as_variable_ref(t).bump_version();
+  // Nothing is saved for backward in inference mode, so there is nothing for
+  // the version counter to protect (see grad_mode.h).
+  if (!InferenceMode::is_enabled()) {
+    as_variable_ref(t).bump_version();
+  }
 }
 
 static bool isFloatingPoint(ScalarType s) {
@@ -68,6 +68,7 @@ private:
   static at::SparseTensorRef unpack(SparseTensorRef t, const char * name, int pos);
   static at::Tensor unpack_opt(const Tensor & t, const char * name, int pos);
   static std::vector<at::Tensor> unpack(at::TensorList tl, const char *name, int pos);
+  static std::vector<at::Tensor> unpack_idxs(at::TensorList tl, const char *name, int pos);
 
   at::Type* baseType;
   std::string str;
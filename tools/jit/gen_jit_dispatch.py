@@ -136,6 +136,12 @@ def is_jit_arg(i, arg):
     return True
 
 
+# In-place variants that the JIT's RewriteInplaceOps pass may emit.
+# The script compiler still rejects calls to in-place ops.
+# Keep in sync with rewritable_ops in torch/csrc/jit/passes/inplace_rewrite.cpp
+jit_inplace_ops = {'relu_', 'sigmoid_', 'tanh_', 'neg_', 'exp_', 'add_', 'sub_', 'mul_', 'div_'}
+
+
 def is_jit_op(decl):
     # We currently don't support functions that return nothing
     if all(r['type'] == 'void' for r in decl['returns']):
@@ -145,7 +151,8 @@ def is_jit_op(decl):
     # and the only tensor argument
     arguments = decl['arguments']
 
-    return ((not decl['api_name'].endswith('_') or is_magic_method(decl['api_name'])) and
+    is_inplace = decl['api_name'].endswith('_') and not is_magic_method(decl['api_name'])
+    return ((not is_inplace or decl['api_name'] in jit_inplace_ops) and
             not decl['name'].endswith('_out') and
             ('namespace' in decl['method_of'] or 'Tensor' in decl['method_of']) and
             all(is_jit_arg(i, arg) for i, arg in enumerate(decl['arguments'])) and
@@ -688,6 +688,125 @@ Arguments:
     out (Tensor, optional): the output tensor
 """)
 
+add_docstr(torch.cholesky, r"""
+cholesky(a, upper=False) -> Tensor
+
+Computes the Cholesky decomposition of a symmetric positive-definite
+matrix :math:`A` or of batches of symmetric positive-definite matrices.
+
+If :attr:`upper` is ``True``, the returned matrix `U` is upper-triangular, and
+the decomposition has the form:
+
+.. math::
+
+  A = U^TU
+
+If :attr:`upper` is ``False``, the returned matrix `L` is lower-triangular, and
+the decomposition has the form:
+
+.. math::
+
+    A = LL^T
+
+If :attr:`a` is a batch of matrices, the returned tensor holds the
+Cholesky factors of the individual matrices.
+
+.. note::
+
+    Unlike :func:`torch.potrf`, :attr:`upper` defaults to ``False``.
+
+Args:
+    a (Tensor): the input tensor of size `(*, n, n)` where `*` is zero or more
+                batch dimensions of symmetric positive-definite matrices
+    upper (bool, optional): flag that indicates whether to return
+                            upper or lower triangular matrices
+
+Example::
+
+    >>> a = torch.randn(3, 3)
+    >>> a = torch.mm(a, a.t()) # make symmetric positive definite
+    >>> l = torch.cholesky(a)
+    >>> a
+    tensor([[ 2.4112, -0.7486,  1.4551],
+            [-0.7486,  1.3544,  0.1294],
+            [ 1.4551,  0.1294,  1.6724]])
+    >>> l
+    tensor([[ 1.5528,  0.0000,  0.0000],
+            [-0.4821,  1.0592,  0.0000],
+            [ 0.9371,  0.5486,  0.7023]])
+    >>> torch.mm(l, l.t())
+    tensor([[ 2.4112, -0.7486,  1.4551],
+            [-0.7486,  1.3544,  0.1294],
+            [ 1.4551,  0.1294,  1.6724]])
+    >>> a = torch.randn(3, 2, 2)
+    >>> a = torch.matmul(a, a.transpose(-1, -2)) + 1e-03 # make symmetric positive-definite
+    >>> l = torch.cholesky(a)
+    >>> z = torch.matmul(l, l.transpose(-1, -2))
+    >>> torch.max(torch.abs(z - a)) # Max non-zero
+    tensor(2.3842e-07)
+""")
+
+add_docstr(torch.cdist,
+           r"""
+cdist(x1, x2, p=2) -> Tensor
+
+Computes the p-norm distance between every pair of rows of :attr:`x1` and
+:attr:`x2`.
+
+For ``p=2`` and rows of more than a few features, the distances are computed
+with a matrix multiply as :math:`\sqrt{\|x\|^2 + \|y\|^2 - 2 x^T y}`, which is
+much faster than comparing the rows one by one, but less precise for rows
+that are close relative to their norms.
+
+Args:
+    x1 (Tensor): input tensor of shape :math:`(N, D)`
+    x2 (Tensor): input tensor of shape :math:`(M, D)`
+    p (float, optional): the norm; 0 counts the differing features and
+                         ``inf`` takes the largest difference. Default: 2
+
+Returns:
+    Tensor: the distances, of shape :math:`(N, M)`
+
+Example::
+
+    >>> a = torch.tensor([[0.9041,  0.0196], [-0.3108, -2.4423], [-0.4821,  1.059]])
+    >>> b = torch.tensor([[-2.1763, -0.4713], [-0.6986,  1.3702]])
+    >>> torch.cdist(a, b, p=2)
+    tensor([[3.1193, 2.0959],
+            [2.7138, 3.8322],
+            [2.2830, 0.3791]])
+""")
+
+add_docstr(torch.cdist_topk,
+           r"""
+cdist_topk(x1, x2, k, p=2, largest=False) -> (Tensor, LongTensor)
+
+Returns the distances to the :attr:`k` nearest rows of :attr:`x2` for every
+row of :attr:`x1`, and their indices, like
+``torch.cdist(x1, x2, p).topk(k, 1, largest)``, but without materializing
+the full :math:`(N, M)` distance matrix: the distances are computed for
+blocks of rows of :attr:`x2` and merged into the running top :attr:`k`.
+
+Args:
+    x1 (Tensor): input tensor of shape :math:`(N, D)`
+    x2 (Tensor): input tensor of shape :math:`(M, D)`
+    k (int): the number of neighbors, at most :math:`M`
+    p (float, optional): the norm, as for :func:`torch.cdist`. Default: 2
+    largest (bool, optional): return the farthest rows instead. Default: ``False``
+
+Returns:
+    A tuple of the sorted distances and the indices into :attr:`x2`, both of
+    shape :math:`(N, k)`
+
+Example::
+
+    >>> queries = torch.randn(1000, 64)
+    >>> database = torch.randn(100000, 64)
+    >>> distances, indices = torch.cdist_topk(queries, database, 10)
+    >>> indices.shape
+    torch.Size([1000, 10])
+""")
+
 add_docstr(torch.chunk,
            r"""
 chunk(tensor, chunks, dim=0) -> List of Tensors
@@ -905,6 +1024,37 @@ Example::
     tensor([ 1.0133,  1.7860,  1.2536,  1.2805])
 """)
 
+add_docstr(torch.cross_entropy,
+           r"""
+cross_entropy(input, target, weight=None, reduction=1, ignore_index=-100, chunk_size=0) -> Tensor
+
+Computes ``nll_loss(log_softmax(input, 1), target, weight)`` for a 2D
+:attr:`input` without materializing the :math:`(N, C)` log-probabilities:
+only the logsumexp of each row is kept for the backward, which writes the
+gradient directly. This is what :func:`torch.nn.functional.cross_entropy`
+uses for 2D inputs.
+
+Args:
+    input (Tensor): the scores, of shape :math:`(N, C)`
+    target (LongTensor): the classes, of shape :math:`(N)`
+    weight (Tensor, optional): the weight of each class, of shape :math:`(C)`
+    reduction (int, optional): 0 for none, 1 for the (weighted) mean and 2
+        for the sum. Default: 1
+    ignore_index (int, optional): target value that doesn't contribute to
+        the loss. Default: -100
+    chunk_size (int, optional): on CUDA, process the classes in chunks of
+        this many, so that the temporaries are :math:`(N, chunk\_size)`;
+        0 processes all of them at once. The CPU implementation keeps no
+        temporaries and ignores it. Default: 0
+
+Example::
+
+    >>> input = torch.randn(32, 250000, requires_grad=True)
+    >>> target = torch.randint(250000, (32,), dtype=torch.long)
+    >>> loss = torch.cross_entropy(input, target, chunk_size=16384)
+    >>> loss.backward()
+""")
+
 add_docstr(torch.cross,
            r"""
 cross(input, other, dim=-1, out=None) -> Tensor
@@ -1931,16 +2081,20 @@ add_docstr(torch.inverse,
            r"""
 inverse(input, out=None) -> Tensor
 
-Takes the inverse of the square matrix :attr:`input`.
+Takes the inverse of the square matrix :attr:`input`. :attr:`input` can be
+batches of 2-D square tensors, in which case this function returns a tensor
+of the inverses of the individual matrices.
 
 .. note::
 
-    Irrespective of the original strides, the returned matrix will be
-    transposed, i.e. with strides `(1, m)` instead of `(m, 1)`
+    Irrespective of the original strides, the returned matrices will be
+    transposed, i.e. with strides like `input.contiguous().transpose(-2, -1).strides()`
 
 Args:
-    input (Tensor): the input 2-D square tensor
-    out (Tensor, optional): the optional output tensor
+    input (Tensor): the input tensor of size `(*, n, n)` where `*` is zero or
+                    more batch dimensions
+    out (Tensor, optional): the optional output tensor. Batched inputs do not
+                            support :attr:`out`
 
 Example::
 
@@ -1955,6 +2109,12 @@ Example::
     >>> torch.max(torch.abs(z - torch.eye(4))) # Max nonzero
     tensor(1.00000e-07 *
            1.1921)
+    >>> # Batched inverse example
+    >>> x = torch.randn(2, 3, 4, 4)
+    >>> y = torch.inverse(x)
+    >>> z = torch.matmul(x, y)
+    >>> torch.max(torch.abs(z - torch.eye(4).expand_as(x))) # Max nonzero
+    tensor(1.9073e-06)
 """)
 
 add_docstr(torch.kthvalue,
@@ -2784,6 +2944,37 @@ Example::
     tensor([ 2,  1,  1,  1])
 """)
 
+add_docstr(torch.murmur3_hash,
+           r"""
+murmur3_hash(input, seeds=[0], modulo=0) -> LongTensor
+
+Hashes the integer ids in :attr:`input` with MurmurHash3, e.g. to map sparse
+features to a fixed number of buckets with the hashing trick.
+
+Every id is taken as 64 bits and hashed as 8 bytes with MurmurHash3_x64_128,
+of which the low 64 bits are kept. These are the same hashes as those of the
+Caffe2 ``MurmurHash`` operator.
+
+Every seed gives an independent hash. With a single seed, the result has the
+shape of :attr:`input`; with :math:`k > 1` seeds it has an extra last
+dimension of size :math:`k`. If :attr:`modulo` is positive, the hashes are
+taken as unsigned and bucketed into :math:`[0, modulo)`; otherwise the result
+holds their 64 bits as is.
+
+Args:
+    input (Tensor): the integer ids
+    seeds (list of int, optional): the seeds of the hashes, truncated to 32 bits
+    modulo (int, optional): the number of buckets, or 0 for none
+
+Example::
+
+    >>> ids = torch.tensor([-3, 0, 7])
+    >>> torch.murmur3_hash(ids, modulo=1000)
+    tensor([ 223,  539,  706])
+    >>> torch.murmur3_hash(ids, seeds=[1, 2], modulo=1000).shape
+    torch.Size([3, 2])
+""")
+
 add_docstr(torch.mv,
            r"""
 mv(mat, vec, out=None) -> Tensor
@@ -4259,6 +4450,49 @@ Example::
     tensor([ 1.0311,  0.7477,  1.2204,  0.9087])
 """)
 
+add_docstr(torch.std_mean,
+           r"""
+.. function:: std_mean(input, unbiased=True) -> (Tensor, Tensor)
+
+Returns the standard deviation and the mean of all elements in the
+:attr:`input` tensor, computed together in a single pass.
+
+If :attr:`unbiased` is ``False``, then the standard deviation will be calculated
+via the biased estimator. Otherwise, Bessel's correction will be used.
+
+Args:
+    input (Tensor): the input tensor
+    unbiased (bool): whether to use the unbiased estimation or not
+
+Example::
+
+    >>> a = torch.tensor([[1., 2., 3.], [4., 5., 6.]])
+    >>> torch.std_mean(a)
+    (tensor(1.8708), tensor(3.5000))
+
+.. function:: std_mean(input, dim, unbiased=True, keepdim=False) -> (Tensor, Tensor)
+
+Returns the standard deviation and the mean of each row of the :attr:`input`
+tensor in the given dimension :attr:`dim`, computed together in a single pass.
+
+If :attr:`keepdim` is ``True``, the output tensors are of the same size
+as :attr:`input` except in the dimension :attr:`dim` where they are of size 1.
+Otherwise, :attr:`dim` is squeezed (see :func:`torch.squeeze`), resulting in
+the output tensors having 1 fewer dimension than :attr:`input`.
+
+Args:
+    input (Tensor): the input tensor
+    dim (int): the dimension to reduce
+    unbiased (bool): whether to use the unbiased estimation or not
+    keepdim (bool): whether the output tensors have :attr:`dim` retained or not
+
+Example::
+
+    >>> a = torch.tensor([[1., 2., 3.], [4., 5., 6.]])
+    >>> torch.std_mean(a, 1)
+    (tensor([1., 1.]), tensor([2., 5.]))
+""")
+
 add_docstr(torch.sum,
            r"""
 .. function:: sum(input, dtype=None) -> Tensor
@@ -4928,6 +5162,49 @@ Example::
     tensor([ 1.7444,  1.1363,  0.7356,  0.5112])
 """)
 
+add_docstr(torch.var_mean,
+           r"""
+.. function:: var_mean(input, unbiased=True) -> (Tensor, Tensor)
+
+Returns the variance and the mean of all elements in the :attr:`input` tensor,
+computed together in a single pass.
+
+If :attr:`unbiased` is ``False``, then the variance will be calculated via the
+biased estimator. Otherwise, Bessel's correction will be used.
+
+Args:
+    input (Tensor): the input tensor
+    unbiased (bool): whether to use the unbiased estimation or not
+
+Example::
+
+    >>> a = torch.tensor([[1., 2., 3.], [4., 5., 6.]])
+    >>> torch.var_mean(a)
+    (tensor(3.5000), tensor(3.5000))
+
+.. function:: var_mean(input, dim, unbiased=True, keepdim=False) -> (Tensor, Tensor)
+
+Returns the variance and the mean of each row of the :attr:`input` tensor in
+the given dimension :attr:`dim`, computed together in a single pass.
+
+If :attr:`keepdim` is ``True``, the output tensors are of the same size
+as :attr:`input` except in the dimension :attr:`dim` where they are of size 1.
+Otherwise, :attr:`dim` is squeezed (see :func:`torch.squeeze`), resulting in
+the output tensors having 1 fewer dimension than :attr:`input`.
+
+Args:
+    input (Tensor): the input tensor
+    dim (int): the dimension to reduce
+    unbiased (bool): whether to use the unbiased estimation or not
+    keepdim (bool): whether the output tensors have :attr:`dim` retained or not
+
+Example::
+
+    >>> a = torch.tensor([[1., 2., 3.], [4., 5., 6.]])
+    >>> torch.var_mean(a, 1)
+    (tensor([1., 1.]), tensor([2., 5.]))
+""")
+
 add_docstr(torch.zeros,
            r"""
 zeros(*sizes, out=None, dtype=None, layout=torch.strided, device=None, requires_grad=False) -> Tensor
@@ -5327,8 +5604,11 @@ The inverse of this function is :func:`~torch.ifft`.
     Changing ``torch.backends.cuda.cufft_plan_cache.max_size`` (default 1023)
     controls the capacity of this cache. Some cuFFT plans may allocate GPU
     memory. You may use ``torch.backends.cuda.cufft_plan_cache.size`` to query
-    the number of plans currently in cache, and
+    the number of plans currently in cache, ``.hits`` and ``.misses`` to see
+    how often plans were reused, and
     ``torch.backends.cuda.cufft_plan_cache.clear()`` to clear the cache.
+    Every device has its own cache, which ``cufft_plan_cache[i]`` selects;
+    otherwise the cache of the current device is used.
 
 .. warning::
     For CPU tensors, this method is currently only available with MKL. Use
@@ -5427,8 +5707,11 @@ The inverse of this function is :func:`~torch.fft`.
     Changing ``torch.backends.cuda.cufft_plan_cache.max_size`` (default 1023)
     controls the capacity of this cache. Some cuFFT plans may allocate GPU
     memory. You may use ``torch.backends.cuda.cufft_plan_cache.size`` to query
-    the number of plans currently in cache, and
+    the number of plans currently in cache, ``.hits`` and ``.misses`` to see
+    how often plans were reused, and
     ``torch.backends.cuda.cufft_plan_cache.clear()`` to clear the cache.
+    Every device has its own cache, which ``cufft_plan_cache[i]`` selects;
+    otherwise the cache of the current device is used.
 
 .. warning::
     For CPU tensors, this method is currently only available with MKL. Use
@@ -5516,8 +5799,11 @@ The inverse of this function is :func:`~torch.irfft`.
     Changing ``torch.backends.cuda.cufft_plan_cache.max_size`` (default 1023)
     controls the capacity of this cache. Some cuFFT plans may allocate GPU
     memory. You may use ``torch.backends.cuda.cufft_plan_cache.size`` to query
-    the number of plans currently in cache, and
+    the number of plans currently in cache, ``.hits`` and ``.misses`` to see
+    how often plans were reused, and
     ``torch.backends.cuda.cufft_plan_cache.clear()`` to clear the cache.
+    Every device has its own cache, which ``cufft_plan_cache[i]`` selects;
+    otherwise the cache of the current device is used.
 
 .. warning::
     For CPU tensors, this method is currently only available with MKL. Use
@@ -5597,8 +5883,11 @@ The inverse of this function is :func:`~torch.rfft`.
     Changing ``torch.backends.cuda.cufft_plan_cache.max_size`` (default 1023)
     controls the capacity of this cache. Some cuFFT plans may allocate GPU
     memory. You may use ``torch.backends.cuda.cufft_plan_cache.size`` to query
-    the number of plans currently in cache, and
+    the number of plans currently in cache, ``.hits`` and ``.misses`` to see
+    how often plans were reused, and
     ``torch.backends.cuda.cufft_plan_cache.clear()`` to clear the cache.
+    Every device has its own cache, which ``cufft_plan_cache[i]`` selects;
+    otherwise the cache of the current device is used.
 
 .. warning::
     For CPU tensors, this method is currently only available with MKL. Use
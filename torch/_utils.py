@@ -145,6 +145,36 @@ def _flatten_dense_tensors(tensors):
     return flat
 
 
+def _flatten_adjacent_dense_tensors(tensors):
+    """Return the 1D buffer spanning dense tensors that are contiguous, of the
+    same type and lie back to back in one storage, like the views made by
+    :func:`_unflatten_dense_tensors_`.
+
+    Unlike :func:`_flatten_dense_tensors` this doesn't copy, so the result
+    aliases the tensors.
+
+    Arguments:
+        tensors (Iterable[Tensor]): dense tensors to flatten.
+
+    Returns:
+        A contiguous 1D buffer sharing memory with the tensors, or None if they
+        aren't adjacent.
+    """
+    if len(tensors) == 0 or tensors[0].is_sparse:
+        return None
+    first = tensors[0]
+    storage = first.storage()
+    offset = first.storage_offset()
+    for tensor in tensors:
+        if (tensor.type() != first.type() or not tensor.is_contiguous() or
+                tensor.storage().data_ptr() != storage.data_ptr() or
+                tensor.storage_offset() != offset):
+            return None
+        offset += tensor.numel()
+    numel = offset - first.storage_offset()
+    return first.new().set_(storage, first.storage_offset(), torch.Size([numel]))
+
+
 def _flatten_sparse_tensors(tensors):
     """Flatten sparse tensors into two contiguous 1D buffers, one of indices and
     one of values. Assume tensors are of same sparse type.
@@ -183,6 +213,28 @@ def _unflatten_dense_tensors(flat, tensors):
     return tuple(outputs)
 
 
+def _unflatten_dense_tensors_(flat, tensors):
+    """Make each of tensors, in place, a view of a flat buffer with its own
+    size, so that they keep sharing the buffer's memory. Assume that tensors
+    are of same dense type, and that flat is given by
+    :func:`_flatten_dense_tensors`.
+
+    Gradients unflattened this way are accumulated directly into the buffer
+    by later backward passes, and :func:`_flatten_adjacent_dense_tensors`
+    returns it without copying, so coalesced collectives on them skip both the
+    flatten and the unflatten copy.
+
+    Arguments:
+        flat (Tensor): flattened dense tensors to unflatten.
+        tensors (Iterable[Tensor]): dense tensors to turn into views of flat.
+    """
+    storage = flat.storage()
+    offset = flat.storage_offset()
+    for tensor in tensors:
+        tensor.set_(storage, offset, tensor.size())
+        offset += tensor.numel()
+
+
 def _unflatten_sparse_tensors(flat, tensors):
     """View flat buffer (containing indices and values) using the sizes of
     tensors. Assume that tensors are of same sparse type, and that flat is given
@@ -163,6 +163,18 @@ def _is_checkpoint_valid():
     return Variable._execution_engine.is_checkpoint_valid()
 
 
+def _last_gil_wait_time():
+    r"""Returns the time in seconds that the threads of the autograd engine
+    spent waiting for the GIL during the last backward pass run by the calling
+    thread.
+
+    The engine holds the GIL across consecutive functions implemented in
+    Python or with Python hooks, so this is the cost of these functions
+    contending with the other Python threads.
+    """
+    return Variable._execution_engine.last_gil_wait_time()
+
+
 def variable(*args, **kwargs):
     warnings.warn("torch.autograd.variable(...) is deprecated, use torch.tensor(...) instead")
     return torch.tensor(*args, **kwargs)
@@ -1,6 +1,17 @@
 import torch
 
 
+def _get_anomaly_state():
+    return (torch.is_anomaly_enabled(), torch._C._is_anomaly_lightweight(),
+            torch._C._get_anomaly_stack_every())
+
+
+def _set_anomaly_state(enabled, lightweight, stack_every):
+    torch._C._set_anomaly_stack_every(stack_every)
+    torch._C._set_anomaly_lightweight(lightweight)
+    torch.set_anomaly_enabled(enabled)
+
+
 class detect_anomaly(object):
     r"""Context-manager that enable anomaly detection for the autograd engine.
 
@@ -10,6 +21,25 @@ class detect_anomaly(object):
     backward function.
     - Any backward computation that generate "nan" value will raise an error.
 
+    Both are expensive: every forward operation formats its traceback, and
+    every backward computation waits for its outputs to be checked. With
+    ``lightweight=True``:
+
+    - The forward operations only record which frames they were called from,
+      and only one in every :attr:`stack_every` of them does.
+    - The outputs of the backward computations are checked for "nan" and
+      "inf" values on their device, and the results are read once the
+      backward pass is done. The error then names the first backward
+      computation that returned a non-finite value.
+
+    This is cheap enough to be left enabled during training.
+
+    Arguments:
+        lightweight (bool): Flag whether to use the cheaper detection
+                            described above (default: ``False``).
+        stack_every (int): Only record the traceback of one in every
+                           ``stack_every`` forward operations (default: 1).
+
     Example:
 
         >>> import torch
@@ -61,14 +91,16 @@ class detect_anomaly(object):
 
     """
 
-    def __init__(self):
-        self.prev = torch.is_anomaly_enabled()
+    def __init__(self, lightweight=False, stack_every=1):
+        self.prev = _get_anomaly_state()
+        self.lightweight = lightweight
+        self.stack_every = stack_every
 
     def __enter__(self):
-        torch.set_anomaly_enabled(True)
+        _set_anomaly_state(True, self.lightweight, self.stack_every)
 
     def __exit__(self, *args):
-        torch.set_anomaly_enabled(self.prev)
+        _set_anomaly_state(*self.prev)
         return False
 
 
@@ -84,16 +116,20 @@ class set_detect_anomaly(object):
     Arguments:
         mode (bool): Flag whether to enable anomaly detection (``True``),
                      or disable (``False``).
+        lightweight (bool): Flag whether to use the cheaper detection
+                            (default: ``False``).
+        stack_every (int): Only record the traceback of one in every
+                           ``stack_every`` forward operations (default: 1).
 
     """
 
-    def __init__(self, mode):
-        self.prev = torch.is_anomaly_enabled()
-        torch.set_anomaly_enabled(mode)
+    def __init__(self, mode, lightweight=False, stack_every=1):
+        self.prev = _get_anomaly_state()
+        _set_anomaly_state(mode, lightweight, stack_every)
 
     def __enter__(self):
         pass
 
     def __exit__(self, *args):
-        torch.set_anomaly_enabled(self.prev)
+        _set_anomaly_state(*self.prev)
         return False
@@ -101,15 +101,23 @@ class EventList(list):
 
             json.dump(chrome_events, f)
 
-    def key_averages(self):
+    def key_averages(self, group_by_input_shape=False):
         """Averages all function events over their keys.
 
+        Arguments:
+            group_by_input_shape (bool, optional): Average events with the same
+                key but different input shapes separately. Requires the events to
+                be recorded with ``record_shapes=True``. Default: ``False``.
+
         Returns:
             An EventList containing FunctionEventAvg objects.
         """
         stats = defaultdict(FunctionEventAvg)
         for evt in self:
-            stats[evt.key] += evt
+            if group_by_input_shape:
+                stats[(evt.key, str(evt.input_shapes))] += evt
+            else:
+                stats[evt.key] += evt
         return EventList(stats.values())
 
     def total_average(self):
@@ -137,6 +145,12 @@ class profile(object):
             Adds approximately 4us of overhead to each tensor operation.
             Default: ``False``
 
+        record_shapes (bool, optional): Records the shapes and types of the inputs of
+            every operation, and with ``use_cuda`` the bytes of CUDA memory each one
+            allocates and frees. Memory is attributed by device, so it includes the
+            allocations of any other thread running at the same time.
+            Default: ``False``
+
     .. warning:
         This context managers should not be called recursively, i.e. at most one
         instance should be enabled at any given time.
@@ -161,9 +175,10 @@ class profile(object):
         N5torch8autograd5CloneE                        4.088us          0.000us
     """
 
-    def __init__(self, enabled=True, use_cuda=False):
+    def __init__(self, enabled=True, use_cuda=False, record_shapes=False):
         self.enabled = enabled
         self.use_cuda = use_cuda
+        self.record_shapes = record_shapes
         self.function_events = None
         if not self.enabled:
             return
@@ -177,7 +192,7 @@ class profile(object):
         self.entered = True
         profiler_kind = torch.autograd.ProfilerState.CUDA if self.use_cuda \
             else torch.autograd.ProfilerState.CPU
-        torch.autograd._enable_profiler(profiler_kind)
+        torch.autograd._enable_profiler(profiler_kind, self.record_shapes)
         return self
 
     def __exit__(self, exc_type, exc_val, exc_tb):
@@ -211,9 +226,9 @@ class profile(object):
         return self.function_events.export_chrome_trace(path)
     export_chrome_trace.__doc__ = EventList.export_chrome_trace.__doc__
 
-    def key_averages(self):
+    def key_averages(self, group_by_input_shape=False):
         self._check_finish()
-        return self.function_events.key_averages()
+        return self.function_events.key_averages(group_by_input_shape)
     key_averages.__doc__ = EventList.key_averages.__doc__
 
     def total_average(self):
@@ -331,13 +346,18 @@ class Kernel(object):
 # TODO: record TID too
 class FunctionEvent(FormattedTimesMixin):
     """Profiling information about a single function."""
-    def __init__(self, id, name, thread, cpu_start, cpu_end):
+    def __init__(self, id, name, thread, cpu_start, cpu_end, input_shapes=None,
+                 input_dtypes=None, cuda_memory_allocated=0, cuda_memory_freed=0):
         self.id = id
         self.name = name
         self.cpu_interval = Interval(cpu_start, cpu_end)
         self.thread = thread
         self.kernels = []
         self.count = 1
+        self.input_shapes = input_shapes if input_shapes is not None else []
+        self.input_dtypes = input_dtypes if input_dtypes is not None else []
+        self.cuda_memory_allocated = cuda_memory_allocated
+        self.cuda_memory_freed = cuda_memory_freed
 
     def append_kernel(self, name, device, start, end):
         self.kernels.append(Kernel(name, device, Interval(start, end)))
@@ -363,15 +383,20 @@ class FunctionEventAvg(FormattedTimesMixin):
     """Used to average stats over multiple FunctionEvent objects."""
     def __init__(self):
         self.key = None
+        self.input_shapes = None
         self.count = self.cpu_time_total = self.cuda_time_total = 0
+        self.cuda_memory_allocated = self.cuda_memory_freed = 0
 
     def __iadd__(self, other):
         if self.key is None:
             self.key = other.key
+            self.input_shapes = other.input_shapes
         assert isinstance(other, FunctionEvent)
         assert other.key == self.key
         self.cpu_time_total += other.cpu_time
         self.cuda_time_total += other.cuda_time
+        self.cuda_memory_allocated += other.cuda_memory_allocated
+        self.cuda_memory_freed += other.cuda_memory_freed
         self.count += 1
         return self
 
@@ -445,7 +470,11 @@ def parse_cpu_trace(thread_records):
                 name=string_table[start.name()],
                 thread=start.thread_id(),
                 cpu_start=start_record.cpu_elapsed_us(start),
-                cpu_end=start_record.cpu_elapsed_us(record))
+                cpu_end=start_record.cpu_elapsed_us(record),
+                input_shapes=start.shapes(),
+                input_dtypes=start.dtypes(),
+                cuda_memory_allocated=record.cuda_memory_allocated() - start.cuda_memory_allocated(),
+                cuda_memory_freed=record.cuda_memory_freed() - start.cuda_memory_freed())
             if start.has_cuda():
                 cuda_start = adjusted_time(start)
                 cuda_end = adjusted_time(record)
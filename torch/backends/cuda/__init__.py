@@ -16,12 +16,84 @@ class ContextProp(object):
         self.setter(val)
 
 
+class cuFFTPlanCacheAttrContextProp(ContextProp):
+    # Like regular ContextProp, but uses the `.device_index` attribute from the
+    # calling object as the first argument to the getter and setter.
+    def __get__(self, obj, objtype):
+        return self.getter(obj.device_index)
+
+    def __set__(self, obj, val):
+        if isinstance(self.setter, str):
+            raise RuntimeError(self.setter)
+        self.setter(obj.device_index, val)
+
+
 class cuFFTPlanCache(object):
-    size = ContextProp(torch._cufft_get_plan_cache_size,
-                       'cufft_plan_cache.size is a read-only property showing the current cache. '
-                       'To set the cache capacity, use cufft_plan_cache.max_size.')
-    max_size = ContextProp(torch._cufft_get_plan_cache_max_size, torch._cufft_set_plan_cache_max_size)
-    clear = torch._cufft_clear_plan_cache
+    r"""
+    Represents a specific plan cache for a specific `device_index`. The
+    attributes `size`, `hits` and `misses` are read-only, and `max_size` is
+    settable. `hits` and `misses` count the lookups since the last `clear()`.
+    """
+    def __init__(self, device_index):
+        self.device_index = device_index
+
+    size = cuFFTPlanCacheAttrContextProp(
+        torch._cufft_get_plan_cache_size,
+        '.size is a read-only property showing the number of plans currently in the '
+        'cache. To change the cache capacity, set cufft_plan_cache.max_size.')
+
+    max_size = cuFFTPlanCacheAttrContextProp(torch._cufft_get_plan_cache_max_size,
+                                             torch._cufft_set_plan_cache_max_size)
+
+    hits = cuFFTPlanCacheAttrContextProp(
+        torch._cufft_get_plan_cache_hits,
+        '.hits is a read-only property counting the plans reused from the cache.')
+
+    misses = cuFFTPlanCacheAttrContextProp(
+        torch._cufft_get_plan_cache_misses,
+        '.misses is a read-only property counting the plans created for the cache.')
+
+    def clear(self):
+        return torch._cufft_clear_plan_cache(self.device_index)
+
+
+class cuFFTPlanCacheManager(object):
+    r"""
+    Represents all cuFFT plan caches. When indexed, it returns a
+    :class:`~torch.backends.cuda.cuFFTPlanCache` object for the given device.
+    When accessed directly, it forwards to the cache of the current device.
+    """
+    __initialized = False
+
+    def __init__(self):
+        self.caches = []
+        self.__initialized = True
+
+    def __getitem__(self, device):
+        if isinstance(device, torch.device):
+            if device.type != 'cuda':
+                raise RuntimeError("cufft_plan_cache expects a CUDA device, but got {}".format(device))
+            index = device.index
+        else:
+            index = device
+        if index is None:
+            index = torch.cuda.current_device()
+        if index < 0 or index >= torch.cuda.device_count():
+            raise RuntimeError(
+                ("cufft_plan_cache: expected 0 <= device index < {}, but got "
+                 "device with index {}").format(torch.cuda.device_count(), index))
+        if len(self.caches) == 0:
+            self.caches.extend(cuFFTPlanCache(index) for index in range(torch.cuda.device_count()))
+        return self.caches[index]
+
+    def __getattr__(self, name):
+        return getattr(self[torch.cuda.current_device()], name)
+
+    def __setattr__(self, name, value):
+        if self.__initialized:
+            return setattr(self[torch.cuda.current_device()], name, value)
+        else:
+            return super(cuFFTPlanCacheManager, self).__setattr__(name, value)
 
 
 class CUDAModule(object):
@@ -32,7 +104,13 @@ class CUDAModule(object):
         # https://stackoverflow.com/questions/47540722/how-do-i-use-the-sys-modules-replacement-trick-in-init-py-on-python-2
         self.__old_mod = m
 
-    cufft_plan_cache = cuFFTPlanCache()
+    cufft_plan_cache = cuFFTPlanCacheManager()
+
+    # Whether cuBLAS may use tensor cores at reduced precision: float matrix
+    # products may round their inputs (to TF32 on CUDA 11, to half before) and
+    # half ones may accumulate in half. Off by default.
+    allow_reduced_precision_matmul = ContextProp(torch._C._get_cublas_allow_reduced_precision,
+                                                 torch._C._set_cublas_allow_reduced_precision)
 
 # This is the sys.modules replacement trick, see
 # https://stackoverflow.com/questions/2447353/getattr-on-a-module/7668273#7668273
@@ -443,6 +443,66 @@ class ContextProp(object):
                                "after disable_global_flags; please use flags() context manager instead")
 
 
+class BenchmarkCache(object):
+    r"""The convolution algorithms picked when ``torch.backends.cudnn.benchmark``
+    is set, keyed by the convolution's sizes, strides and settings.
+
+    The cache can be saved to a file and loaded by other processes running
+    on the same GPU model with the same cuDNN version, so that they don't
+    benchmark the same shapes again. If the ``TORCH_CUDNN_BENCHMARK_CACHE``
+    environment variable is set, the file it names is loaded automatically
+    before the first convolution.
+    """
+
+    @property
+    def size(self):
+        r"""The number of cached algorithms."""
+        return torch._cudnn_get_benchmark_cache_size()
+
+    def clear(self):
+        r"""Removes all cached algorithms."""
+        torch._cudnn_clear_benchmark_cache()
+
+    def save(self, path):
+        r"""Writes the cached algorithms to the file ``path``."""
+        torch._cudnn_save_benchmark_cache(path)
+
+    def load(self, path):
+        r"""Adds the algorithms saved in the file ``path`` to the cache, and
+        returns the number of algorithms loaded. Files written on a different
+        GPU model or with a different cuDNN version are ignored with a warning.
+        """
+        return torch._cudnn_load_benchmark_cache(path)
+
+    def warmup(self, shapes, dtype=torch.float, device='cuda', backward=True):
+        r"""Benchmarks the convolutions with the given shapes, so that the
+        algorithms are cached before they are needed.
+
+        Arguments:
+            shapes (iterable of dict): each dict has the entries ``input_size``
+                and ``weight_size``, and optionally ``stride``, ``padding``,
+                ``dilation`` and ``groups``, as taken by
+                :func:`torch.nn.functional.conv2d` (or ``conv1d`` and ``conv3d``,
+                depending on the number of dimensions)
+            dtype (:class:`torch.dtype`): the type of the convolutions
+            device (:class:`torch.device`): the device of the convolutions
+            backward (bool): whether to benchmark the backward convolutions too
+        """
+        import torch.nn.functional as F
+        convolutions = {3: F.conv1d, 4: F.conv2d, 5: F.conv3d}
+        with flags(enabled=True, benchmark=True,
+                   deterministic=torch._C._get_cudnn_deterministic(), verbose=verbose):
+            for shape in shapes:
+                kwargs = dict(shape)
+                input = torch.randn(kwargs.pop('input_size'), dtype=dtype, device=device,
+                                    requires_grad=backward)
+                weight = torch.randn(kwargs.pop('weight_size'), dtype=dtype, device=device,
+                                     requires_grad=backward)
+                output = convolutions[input.dim()](input, weight, **kwargs)
+                if backward:
+                    output.backward(torch.ones_like(output))
+
+
 class CudnnModule(object):
     def __init__(self, m):
         self.__dict__ = m.__dict__
@@ -453,6 +513,8 @@ class CudnnModule(object):
     enabled = ContextProp(torch._C._get_cudnn_enabled, torch._C._set_cudnn_enabled)
     deterministic = ContextProp(torch._C._get_cudnn_deterministic, torch._C._set_cudnn_deterministic)
     benchmark = ContextProp(torch._C._get_cudnn_benchmark, torch._C._set_cudnn_benchmark)
+    rnn_persistent = ContextProp(torch._C._get_cudnn_rnn_persistent, torch._C._set_cudnn_rnn_persistent)
+    benchmark_cache = BenchmarkCache()
 
 # This is the sys.modules replacement trick, see
 # https://stackoverflow.com/questions/2447353/getattr-on-a-module/7668273#7668273
@@ -1,6 +1,37 @@
+import sys
 import torch
+from torch.backends.cuda import ContextProp
 
 
 def is_available():
     r"""Returns whether PyTorch is built with MKL support."""
     return torch._C.has_mkl
+
+
+class MKLFFTPlanCache(object):
+    r"""
+    The cache of committed MKL FFT descriptors used by CPU FFTs. The attributes
+    `size`, `hits` and `misses` are read-only, and `max_size` is settable.
+    """
+    size = ContextProp(torch._mkl_fft_get_plan_cache_size,
+                       'mkl_fft_plan_cache.size is a read-only property showing the current cache. '
+                       'To set the cache capacity, use mkl_fft_plan_cache.max_size.')
+    max_size = ContextProp(torch._mkl_fft_get_plan_cache_max_size, torch._mkl_fft_set_plan_cache_max_size)
+    hits = ContextProp(torch._mkl_fft_get_plan_cache_hits,
+                       'mkl_fft_plan_cache.hits is a read-only property.')
+    misses = ContextProp(torch._mkl_fft_get_plan_cache_misses,
+                         'mkl_fft_plan_cache.misses is a read-only property.')
+    clear = torch._mkl_fft_clear_plan_cache
+
+
+class MKLModule(object):
+    def __init__(self, m):
+        self.__dict__ = m.__dict__
+        # Retain the old module so it doesn't get GC'ed, see torch/backends/cuda
+        self.__old_mod = m
+
+    mkl_fft_plan_cache = MKLFFTPlanCache()
+
+# This is the sys.modules replacement trick, see
+# https://stackoverflow.com/questions/2447353/getattr-on-a-module/7668273#7668273
+sys.modules[__name__] = MKLModule(sys.modules[__name__])
@@ -0,0 +1,52 @@
+import sys
+import torch
+
+
+def is_available():
+    r"""Returns whether PyTorch is built with MKL-DNN support."""
+    return torch._C.has_mkldnn
+
+
+class ContextProp(object):
+    def __init__(self, getter, setter):
+        self.getter = getter
+        self.setter = setter
+
+    def __get__(self, obj, objtype):
+        return self.getter()
+
+    def __set__(self, obj, val):
+        if isinstance(self.setter, str):
+            raise RuntimeError(self.setter)
+        self.setter(val)
+
+
+class WeightCache(object):
+    r"""Caches the MKL-DNN convolution weights reordered into MKL-DNN's blocked
+    format, so that inference doesn't reorder them on every call.
+
+    The cache can't detect weights being modified in place, so it is disabled
+    (``max_size`` is 0) by default. Only enable it when the weights of the
+    cached convolutions don't change, e.g. for inference, or call ``clear()``
+    after changing them.
+    """
+    size = ContextProp(torch._mkldnn_get_weight_cache_size,
+                       'weight_cache.size is a read-only property showing the number of cached weights. '
+                       'To set the cache capacity, use weight_cache.max_size.')
+    max_size = ContextProp(torch._mkldnn_get_weight_cache_max_size, torch._mkldnn_set_weight_cache_max_size)
+    clear = torch._mkldnn_clear_weight_cache
+
+
+class MKLDNNModule(object):
+    def __init__(self, m):
+        self.__dict__ = m.__dict__
+        # You have to retain the old module, otherwise it will
+        # get GC'ed and a lot of things will break.  See:
+        # https://stackoverflow.com/questions/47540722/how-do-i-use-the-sys-modules-replacement-trick-in-init-py-on-python-2
+        self.__old_mod = m
+
+    weight_cache = WeightCache()
+
+# This is the sys.modules replacement trick, see
+# https://stackoverflow.com/questions/2447353/getattr-on-a-module/7668273#7668273
+sys.modules[__name__] = MKLDNNModule(sys.modules[__name__])
@@ -296,19 +296,43 @@ void DLPack_Capsule_Destructor(PyObject* data) {
   END_HANDLE_TH_ERRORS_RET()
 }
 
-PyObject *THPModule_toDLPack(PyObject *_unused, PyObject *data)
+// The stream of a DLPack exchange: None, or the address of a cudaStream_t
+static void* THPModule_unpackDLPackStream(PyObject *stream)
+{
+  if (stream == Py_None) {
+    return nullptr;
+  }
+  if (!THPUtils_checkLong(stream)) {
+    throw torch::TypeError("stream must be None or an int, but got %s",
+                           THPUtils_typename(stream));
+  }
+  return reinterpret_cast<void*>(static_cast<intptr_t>(THPUtils_unpackLong(stream)));
+}
+
+PyObject *THPModule_toDLPack(PyObject *_unused, PyObject *args)
 {
   HANDLE_TH_ERRORS
+  PyObject *data = nullptr;
+  PyObject *stream = Py_None;
+  if (!PyArg_ParseTuple(args, "O|O", &data, &stream)) {
+    return NULL;
+  }
   THPUtils_assert(THPVariable_Check(data), "data must be a Tensor");
-  DLManagedTensor* dlMTensor = at::toDLPack(THPVariable_UnpackData(data));
+  DLManagedTensor* dlMTensor = at::toDLPack(
+      THPVariable_UnpackData(data), THPModule_unpackDLPackStream(stream));
   return PyCapsule_New(dlMTensor, "dltensor", DLPack_Capsule_Destructor);
   END_HANDLE_TH_ERRORS
 }
 
-PyObject *THPModule_fromDLPack(PyObject *_unused, PyObject *data)
+PyObject *THPModule_fromDLPack(PyObject *_unused, PyObject *args)
 {
   using namespace torch::autograd;
   HANDLE_TH_ERRORS
+  PyObject *data = nullptr;
+  PyObject *stream = Py_None;
+  if (!PyArg_ParseTuple(args, "O|O", &data, &stream)) {
+    return NULL;
+  }
   DLManagedTensor * dlMTensor = (DLManagedTensor *)PyCapsule_GetPointer(data, "dltensor");
   THPUtils_assert(dlMTensor, "from_dlpack received an invalid capsule. "
     "Note that DLTensor capsules can be consumed only once, "
@@ -316,7 +340,8 @@ PyObject *THPModule_fromDLPack(PyObject *_unused, PyObject *data)
   // atensor steals the ownership of the underlying storage. It also passes a
   // destructor function that will be called when the underlying storage goes
   // out of scope. When the destructor is called, the dlMTensor is destructed too.
-  auto atensor = make_variable(at::fromDLPack(dlMTensor), false);
+  auto atensor = make_variable(
+      at::fromDLPack(dlMTensor, THPModule_unpackDLPackStream(stream)), false);
 
   // It is possible that the call to at::fromDLPack is the very first
   // call to create a Tensor in PyTorch. If so, then _lazy_init has
@@ -375,6 +400,34 @@ PyObject *THPModule_benchmarkCuDNN(PyObject *_unused)
   else Py_RETURN_FALSE;
 }
 
+PyObject *THPModule_setPersistentRNNCuDNN(PyObject *_unused, PyObject *arg)
+{
+  THPUtils_assert(PyBool_Check(arg), "set_cudnn_rnn_persistent expects a bool, "
+          "but got %s", THPUtils_typename(arg));
+  at::globalContext().setPersistentRNNCuDNN(arg == Py_True);
+  Py_RETURN_NONE;
+}
+
+PyObject *THPModule_persistentRNNCuDNN(PyObject *_unused)
+{
+  if (at::globalContext().persistentRNNCuDNN()) Py_RETURN_TRUE;
+  else Py_RETURN_FALSE;
+}
+
+PyObject *THPModule_setAllowReducedPrecisionCuBLAS(PyObject *_unused, PyObject *arg)
+{
+  THPUtils_assert(PyBool_Check(arg), "set_cublas_allow_reduced_precision expects a bool, "
+          "but got %s", THPUtils_typename(arg));
+  at::globalContext().setAllowReducedPrecisionCuBLAS(arg == Py_True);
+  Py_RETURN_NONE;
+}
+
+PyObject *THPModule_allowReducedPrecisionCuBLAS(PyObject *_unused)
+{
+  if (at::globalContext().allowReducedPrecisionCuBLAS()) Py_RETURN_TRUE;
+  else Py_RETURN_FALSE;
+}
+
 PyObject *THPModule_setFlushDenormal(PyObject *_unused, PyObject *arg) {
   THPUtils_assert(PyBool_Check(arg), "flush_denormal expects a bool, "
           "but got %s", THPUtils_typename(arg));
@@ -427,8 +480,12 @@ static PyMethodDef TorchMethods[] = {
   {"_set_cudnn_benchmark", (PyCFunction)THPModule_setBenchmarkCuDNN, METH_O,  NULL},
   {"_get_cudnn_deterministic", (PyCFunction)THPModule_deterministicCuDNN, METH_NOARGS,     NULL},
   {"_set_cudnn_deterministic", (PyCFunction)THPModule_setDeterministicCuDNN, METH_O,  NULL},
-  {"_to_dlpack",      (PyCFunction)THPModule_toDLPack,          METH_O,       NULL},
-  {"_from_dlpack",    (PyCFunction)THPModule_fromDLPack,        METH_O,       NULL},
+  {"_get_cudnn_rnn_persistent", (PyCFunction)THPModule_persistentRNNCuDNN, METH_NOARGS,     NULL},
+  {"_set_cudnn_rnn_persistent", (PyCFunction)THPModule_setPersistentRNNCuDNN, METH_O,  NULL},
+  {"_get_cublas_allow_reduced_precision", (PyCFunction)THPModule_allowReducedPrecisionCuBLAS, METH_NOARGS,     NULL},
+  {"_set_cublas_allow_reduced_precision", (PyCFunction)THPModule_setAllowReducedPrecisionCuBLAS, METH_O,  NULL},
+  {"_to_dlpack",      (PyCFunction)THPModule_toDLPack,          METH_VARARGS, NULL},
+  {"_from_dlpack",    (PyCFunction)THPModule_fromDLPack,        METH_VARARGS, NULL},
   {"set_flush_denormal", (PyCFunction)THPModule_setFlushDenormal, METH_O,     NULL},
   {"get_default_dtype", (PyCFunction)THPModule_getDefaultDtype, METH_NOARGS,  NULL},
   {"_is_default_type_cuda", (PyCFunction)THPModule_isDefaultTypeCuda, METH_NOARGS,  NULL},
@@ -612,6 +669,7 @@ static PyObject* initModule() {
   at::Warning::set_warning_handler(&warning_handler);
 
   ASSERT_TRUE(PyModule_AddObject(module, "has_mkl", at::hasMKL() ? Py_True : Py_False) == 0);
+  ASSERT_TRUE(PyModule_AddObject(module, "has_mkldnn", at::hasMKLDNN() ? Py_True : Py_False) == 0);
 
 #ifdef _GLIBCXX_USE_CXX11_ABI
   ASSERT_TRUE(PyModule_AddObject(module, "_GLIBCXX_USE_CXX11_ABI",
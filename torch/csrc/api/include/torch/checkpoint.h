@@ -0,0 +1,66 @@
+#pragma once
+
+#include <torch/nn/module.h>
+#include <torch/nn/pimpl.h>
+#include <torch/tensor.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace torch {
+
+/// A checkpoint file starts with a header that lists the name, dtype, sizes
+/// and file offset of every tensor, followed by the raw data of the tensors,
+/// each starting at a page boundary. This lets `load_checkpoint()` map the
+/// file into memory and use it as the storage of the loaded tensors, instead
+/// of reading and copying every tensor.
+using NamedTensors = std::vector<std::pair<std::string, Tensor>>;
+
+struct CheckpointSaveOptions {
+  /// The number of threads writing the tensor data.
+  TORCH_ARG(size_t, threads) = 4;
+  /// The data of large tensors is split into chunks of this many bytes, which
+  /// are written by different threads.
+  TORCH_ARG(size_t, chunk_size) = 64 << 20;
+};
+
+struct CheckpointLoadOptions {
+  /// Reads all pages of the file into memory when it is mapped, instead of on
+  /// first access. Useful for warm starts.
+  TORCH_ARG(bool, populate) = false;
+  /// The number of threads reading the pages of the file if `populate` is set.
+  /// With a single thread, the pages are read by the kernel (`MAP_POPULATE`).
+  TORCH_ARG(size_t, threads) = 1;
+};
+
+/// Writes the tensors to a checkpoint file. CUDA tensors are saved from their
+/// CPU copies.
+void save_checkpoint(
+    const std::string& path,
+    const NamedTensors& tensors,
+    CheckpointSaveOptions options = CheckpointSaveOptions());
+
+/// Writes the parameters of the module to a checkpoint file.
+void save_checkpoint(
+    const std::string& path,
+    const nn::Module& module,
+    CheckpointSaveOptions options = CheckpointSaveOptions());
+
+/// Maps a checkpoint file into memory and returns its tensors, which are CPU
+/// tensors whose storage is the mapped file. The mapping is private: writing
+/// to the tensors does not change the file. The file stays mapped until all
+/// tensors and their storages are destroyed.
+NamedTensors load_checkpoint(
+    const std::string& path,
+    CheckpointLoadOptions options = CheckpointLoadOptions());
+
+/// Loads the parameters of the module from a checkpoint file. CPU parameters
+/// of the saved dtype share the mapped memory of the file, other parameters
+/// are copied into. Throws if the parameters of the module and the
+/// checkpoint don't have the same names and sizes.
+void load_checkpoint(
+    const std::string& path,
+    nn::Module& module,
+    CheckpointLoadOptions options = CheckpointLoadOptions());
+} // namespace torch
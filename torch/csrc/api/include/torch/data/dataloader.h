@@ -0,0 +1,148 @@
+#pragma once
+
+#include <torch/data/datasets.h>
+#include <torch/data/example.h>
+#include <torch/data/samplers.h>
+#include <torch/nn/pimpl.h>
+#include <torch/tensor.h>
+
+#include <ATen/core/optional.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace torch {
+namespace data {
+
+struct DataLoaderOptions {
+  /* implicit */ DataLoaderOptions(size_t batch_size);
+
+  TORCH_ARG(size_t, batch_size);
+  /// The number of threads that fetch and collate batches. With zero workers,
+  /// batches are loaded on the thread calling `next()`.
+  TORCH_ARG(size_t, workers) = 0;
+  /// The maximum number of batches loaded ahead of the consumer. Defaults to
+  /// twice the number of workers.
+  TORCH_ARG(at::optional<size_t>, prefetch) = at::nullopt;
+  /// Whether to drop the last batch of an epoch if it is incomplete.
+  TORCH_ARG(bool, drop_last) = false;
+  /// Whether to collate batches into pinned (page-locked) memory, to speed up
+  /// copies to CUDA devices.
+  TORCH_ARG(bool, pin_memory) = false;
+};
+
+/// Loads batches of a `Dataset` in the order given by a `Sampler`, collating
+/// the examples of a batch by stacking them into new tensors. With workers,
+/// batches are loaded in parallel and ahead of time, but still returned in
+/// sampler order; an exception thrown while loading a batch is rethrown by the
+/// `next()` call that would have returned it.
+///
+/// \rst
+/// .. code-block:: cpp
+///
+///   auto dataset = std::make_shared<torch::data::TensorDataset>(inputs, labels);
+///   torch::data::DataLoader loader(
+///       dataset, torch::data::DataLoaderOptions(64).workers(4));
+///   for (auto& batch : loader) {
+///     auto output = model->forward(batch.data);
+///   }
+/// \endrst
+class DataLoader {
+ public:
+  class Iterator;
+
+  /// Samples the dataset with a `SequentialSampler` if no `sampler` is given.
+  DataLoader(
+      std::shared_ptr<Dataset> dataset,
+      DataLoaderOptions options,
+      std::unique_ptr<Sampler> sampler = nullptr);
+
+  DataLoader(const DataLoader&) = delete;
+  DataLoader& operator=(const DataLoader&) = delete;
+
+  /// Stops and joins the worker threads.
+  ~DataLoader();
+
+  /// Starts a new epoch, discarding batches of the current one that were
+  /// loaded ahead.
+  void reset();
+
+  /// Returns the next batch of the epoch, or `nullopt` once it is exhausted.
+  at::optional<Example> next();
+
+  /// Starts a new epoch and returns an iterator over its batches.
+  Iterator begin();
+
+  Iterator end();
+
+  const DataLoaderOptions& options() const noexcept;
+
+ private:
+  struct Job {
+    size_t sequence_number;
+    std::vector<size_t> indices;
+  };
+
+  struct Result {
+    Example batch;
+    std::exception_ptr exception;
+  };
+
+  /// Returns the next indices of the sampler, or `nullopt` at the end of the
+  /// epoch.
+  at::optional<std::vector<size_t>> next_indices();
+
+  /// Issues jobs until `prefetch` batches are in flight.
+  void issue_jobs();
+
+  /// Fetches the examples of a batch and stacks them.
+  Example load_batch(const std::vector<size_t>& indices);
+
+  void worker_loop();
+
+  std::shared_ptr<Dataset> dataset_;
+  DataLoaderOptions options_;
+  std::unique_ptr<Sampler> sampler_;
+  size_t prefetch_;
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable jobs_available_;
+  std::condition_variable result_available_;
+  std::deque<Job> jobs_;
+  std::map<size_t, Result> results_;
+  /// Sequence numbers keep increasing across epochs, so that results of jobs
+  /// of a previous epoch are recognized and dropped.
+  size_t next_sequence_number_{0};
+  size_t next_result_{0};
+  bool sampler_exhausted_{false};
+  bool shutdown_{false};
+};
+
+/// Iterates over the batches of one epoch of a `DataLoader`.
+class DataLoader::Iterator
+    : public std::iterator<std::input_iterator_tag, Example> {
+ public:
+  Example& operator*();
+  Example* operator->();
+  Iterator& operator++();
+  bool operator==(const Iterator& other) const;
+  bool operator!=(const Iterator& other) const;
+
+ private:
+  friend class DataLoader;
+  explicit Iterator(DataLoader* loader);
+
+  DataLoader* loader_;
+  at::optional<Example> batch_;
+};
+} // namespace data
+} // namespace torch
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <torch/data/example.h>
+#include <torch/tensor.h>
+
+#include <cstddef>
+
+namespace torch {
+namespace data {
+
+/// A dataset of examples that can be accessed by index. `get()` is called from
+/// the worker threads of a `DataLoader`, so it must be safe to call
+/// concurrently.
+class Dataset {
+ public:
+  virtual ~Dataset() = default;
+
+  /// Returns the example at the given index, which is less than `size()`.
+  virtual Example get(size_t index) = 0;
+
+  /// Returns the number of examples in the dataset.
+  virtual size_t size() const = 0;
+};
+
+/// A dataset whose examples are the slices of a data tensor and a target
+/// tensor along their first dimension.
+class TensorDataset : public Dataset {
+ public:
+  /// The `target` may be undefined, in which case examples have no target.
+  explicit TensorDataset(Tensor data, Tensor target = Tensor());
+
+  Example get(size_t index) override;
+
+  size_t size() const override;
+
+ private:
+  Tensor data_;
+  Tensor target_;
+};
+} // namespace data
+} // namespace torch
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <torch/tensor.h>
+
+#include <utility>
+
+namespace torch {
+namespace data {
+
+/// A single example of a dataset, or a batch of examples stacked along the
+/// first dimension. The `target` may be undefined for unlabeled data.
+struct Example {
+  Example() = default;
+  Example(Tensor data, Tensor target)
+      : data(std::move(data)), target(std::move(target)) {}
+
+  Tensor data;
+  Tensor target;
+};
+} // namespace data
+} // namespace torch
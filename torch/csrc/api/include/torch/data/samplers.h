@@ -0,0 +1,57 @@
+#pragma once
+
+#include <torch/tensor.h>
+
+#include <ATen/core/optional.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace torch {
+namespace data {
+
+/// Produces the indices of the examples of each batch, one epoch at a time.
+class Sampler {
+ public:
+  virtual ~Sampler() = default;
+
+  /// Starts a new epoch.
+  virtual void reset() = 0;
+
+  /// Returns the indices of the next batch of at most `batch_size` examples,
+  /// or `nullopt` once the epoch is exhausted.
+  virtual at::optional<std::vector<size_t>> next(size_t batch_size) = 0;
+};
+
+/// Returns the indices `0, 1, ..., size - 1` in order.
+class SequentialSampler : public Sampler {
+ public:
+  explicit SequentialSampler(size_t size);
+
+  void reset() override;
+
+  at::optional<std::vector<size_t>> next(size_t batch_size) override;
+
+ private:
+  size_t size_;
+  size_t index_{0};
+};
+
+/// Returns the indices `0, 1, ..., size - 1` in a new random order every
+/// epoch. The permutation is drawn from the default CPU generator, so it is
+/// reproducible with `torch::manual_seed()`.
+class RandomSampler : public Sampler {
+ public:
+  explicit RandomSampler(size_t size);
+
+  void reset() override;
+
+  at::optional<std::vector<size_t>> next(size_t batch_size) override;
+
+ private:
+  size_t size_;
+  std::vector<size_t> indices_;
+  size_t index_{0};
+};
+} // namespace data
+} // namespace torch
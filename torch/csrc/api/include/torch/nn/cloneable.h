@@ -9,11 +9,52 @@
 #include <ATen/core/Error.h>
 #include <ATen/core/optional.h>
 
+#include <map>
 #include <memory>
 #include <utility>
 
 namespace torch {
 namespace nn {
+namespace detail {
+/// Copies of parameters and buffers on other devices, keyed by the tensor
+/// they were copied from and the index of their device.
+using ReplicatedTensors =
+    std::map<std::pair<const at::TensorImpl*, int32_t>, Tensor>;
+
+/// While a `ReplicationGuard` is alive, `Cloneable::clone(device)` gives the
+/// clone the copies of the parameters and buffers in the given map instead
+/// of copying them one at a time. This is how `parallel::replicate()` copies
+/// all of them to every device with a single coalesced broadcast.
+class ReplicationGuard {
+ public:
+  explicit ReplicationGuard(const ReplicatedTensors& tensors);
+  ~ReplicationGuard();
+
+  /// The copy of `tensor` on the given device that the current guard holds,
+  /// or null.
+  static const Tensor* replicated(const Tensor& tensor, const Device& device);
+
+ private:
+  const ReplicatedTensors* previous_;
+};
+
+/// While a `SharedParametersGuard` is alive, `Cloneable::clone()` gives the
+/// clone the data of the parameters of the module it clones instead of copies
+/// of them. This is how `Module::shallow_replica()` shares parameters between
+/// whole module trees.
+class SharedParametersGuard {
+ public:
+  SharedParametersGuard();
+  ~SharedParametersGuard();
+
+  /// True if a guard is alive in this thread.
+  static bool is_enabled() noexcept;
+
+ private:
+  bool previous_;
+};
+} // namespace detail
+
 /// The `clone()` method in the base `Module` class does not have knowledge of
 /// the concrete runtime type of its subclasses. Therefore, `clone()` must
 /// either be called from within the subclass, or from a base class that has
@@ -53,8 +94,20 @@ class Cloneable : public virtual Module {
         "parameters as the original module after calling reset(). "
         "Are you sure you called register_parameter() inside reset() "
         "and not the constructor?");
+    const bool share_parameters = detail::SharedParametersGuard::is_enabled();
     for (const auto& parameter : parameters_) {
-      if (device) {
+      const Tensor* replica =
+          device ? detail::ReplicationGuard::replicated(*parameter, *device)
+                 : nullptr;
+      if (share_parameters) {
+        at::detail::set_data(
+            copy->parameters_[parameter.key],
+            autograd::Variable(*parameter).data());
+      } else if (replica) {
+        at::detail::set_data(
+            copy->parameters_[parameter.key],
+            autograd::Variable(*replica).data());
+      } else if (device) {
         copy->parameters_[parameter.key].copy_(
             *parameter, /*non_blocking=*/true);
       } else {
@@ -70,7 +123,13 @@ class Cloneable : public virtual Module {
         "Are you sure you called register_buffer() inside reset() "
         "and not the constructor?");
     for (const auto& buffer : buffers_) {
-      if (device) {
+      const Tensor* replica =
+          device ? detail::ReplicationGuard::replicated(*buffer, *device)
+                 : nullptr;
+      if (replica) {
+        at::detail::set_data(
+            copy->buffers_[buffer.key], autograd::Variable(*replica).data());
+      } else if (device) {
         copy->buffers_[buffer.key].copy_(*buffer, /*non_blocking=*/true);
       } else {
         at::detail::set_data(
@@ -101,6 +160,9 @@ class Cloneable : public virtual Module {
         "Attempted to clone submodule, but it is of a "
         "different type than the submodule it was to be cloned into");
     static_cast<Derived&>(*this) = std::move(*clone);
+    // The parameters, buffers and submodules of `this` were replaced, so the
+    // cursors cached by its ancestors point to the old ones.
+    torch::detail::invalidate_cursor_caches();
   }
 };
 
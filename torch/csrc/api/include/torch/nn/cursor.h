@@ -3,10 +3,14 @@
 #include <torch/tensor.h>
 
 #include <cstddef>
+#include <cstdint>
 #include <iterator>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 // Forward declarations.
 namespace torch {
@@ -35,6 +39,10 @@ namespace detail {
 /// cursor, e.g. do not write `auto iterator = module.parameters().begin()`, as
 /// the parameter cursor will die at the end of the expression.
 ///
+/// The items of parameter and buffer cursors are cached by the module they
+/// were created from and shared between cursors (see `CursorCache`), so
+/// creating and iterating over them does not allocate.
+///
 /// A cursor's lifetime is bound to the lifetime of the module hierarchy into
 /// which it points.
 template <typename T>
@@ -66,18 +74,22 @@ class CursorBase {
   using Iterator = typename std::vector<Item>::iterator;
   using ConstIterator = typename std::vector<Item>::const_iterator;
 
-  CursorBase() = default;
+  CursorBase();
 
   /// Constructs the `CursorBase` from a vector of items.
   explicit CursorBase(std::vector<Item>&& items);
 
+  /// Constructs the `CursorBase` from a vector of items shared with other
+  /// cursors, which must not be modified anymore.
+  explicit CursorBase(std::shared_ptr<std::vector<Item>> items);
+
   // No need for a virtual destructor, as cursors are not intended to be used
   // polymorhpically (i.e. we are relying on non-virtual inheritance).
 
   // Note that these functions may only be called on lvalues (that's the
   // ampersand next to the function)! This prevents code like `auto iterator =
   // module.modules().begin()`, since `iterator` would be pointing to a `vector`
-  // that gets destructed at the end of the expression. This is not a problem
+  // that may get destructed at the end of the expression. This is not a problem
   // for range loops, as they capture the range expression (the thing to the
   // right of the colon in `for (auto x : ...)`) before iteration. This is
   // smart.
@@ -91,13 +103,13 @@ class CursorBase {
   /// a single argument, that is a reference to the value type (e.g. `Module&`).
   template <typename Function>
   void apply(const Function& function) {
-    for (auto& item : items_) {
+    for (auto& item : *items_) {
       function(*item);
     }
   }
   template <typename Function>
   void apply(const Function& function) const {
-    for (auto& item : items_) {
+    for (auto& item : *items_) {
       function(*item);
     }
   }
@@ -108,13 +120,13 @@ class CursorBase {
   /// `Module&`).
   template <typename Function>
   void apply_items(const Function& function) {
-    for (auto& item : items_) {
+    for (auto& item : *items_) {
       function(item.key, item.value);
     }
   }
   template <typename Function>
   void apply_items(const Function& function) const {
-    for (auto& item : items_) {
+    for (auto& item : *items_) {
       function(item.key, item.value);
     }
   }
@@ -124,13 +136,13 @@ class CursorBase {
   /// a single argument, that is a reference to the value type (e.g. `Module&`).
   template <typename Iterator, typename Function>
   void map(Iterator output_iterator, Function function) {
-    for (auto& item : items_) {
+    for (auto& item : *items_) {
       *output_iterator++ = function(*item);
     }
   }
   template <typename Iterator, typename Function>
   void map(Iterator output_iterator, Function function) const {
-    for (auto& item : items_) {
+    for (auto& item : *items_) {
       *output_iterator++ = function(*item);
     }
   }
@@ -141,13 +153,13 @@ class CursorBase {
   /// std::string&`) and the other taking a referen
   template <typename Iterator, typename Function>
   void map_items(Iterator output_iterator, Function function) {
-    for (auto& item : items_) {
+    for (auto& item : *items_) {
       *output_iterator++ = function(item.key, item.value);
     }
   }
   template <typename Iterator, typename Function>
   void map_items(Iterator output_iterator, Function function) const {
-    for (auto& item : items_) {
+    for (auto& item : *items_) {
       *output_iterator++ = function(item.key, item.value);
     }
   }
@@ -183,8 +195,43 @@ class CursorBase {
   /// Helper struct to collect items.
   struct Collector;
 
-  /// The (eagerly) collected vector of items.
-  std::vector<Item> items_;
+  /// The (eagerly) collected vector of items. Never null.
+  std::shared_ptr<std::vector<Item>> items_;
+};
+
+/// Invalidates the items cached by every `CursorCache`. Called whenever a
+/// parameter, buffer or submodule is registered with (or replaced in) any
+/// module, since the items of all its ancestors change with it.
+void invalidate_cursor_caches() noexcept;
+
+/// Holds the items a module collected for its `parameters()` or `buffers()`
+/// cursor, so that later cursors can share them instead of walking the module
+/// tree again. The items stay valid until the next call to
+/// `invalidate_cursor_caches()`, which only happens when modules are built or
+/// cloned, not while training.
+///
+/// A copy of a module refers to different tensors, so copying a cache gives an
+/// empty one.
+template <typename T>
+class CursorCache {
+ public:
+  using Items = std::vector<typename CursorBase<T>::Item>;
+
+  CursorCache() = default;
+  CursorCache(const CursorCache&) {}
+  CursorCache& operator=(const CursorCache&);
+
+  /// Returns the cached items, calling `collect()` to collect them again if the
+  /// cache was invalidated since they were collected.
+  template <typename Function>
+  std::shared_ptr<Items> get(const Function& collect);
+
+ private:
+  std::mutex mutex_;
+  std::shared_ptr<Items> items_;
+  /// The value of the global counter `invalidate_cursor_caches()` increments,
+  /// when `items_` were collected.
+  uint64_t version_{0};
 };
 } // namespace detail
 
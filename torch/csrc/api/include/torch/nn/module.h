@@ -46,6 +46,15 @@ class Module {
   virtual std::shared_ptr<Module> clone(
       at::optional<Device> device = at::nullopt) const;
 
+  /// Creates a copy of the module tree that shares the data of all parameters
+  /// with this module, but has its own copies of all buffers, like a `clone()`
+  /// that does not copy parameters. This is meant for serving one model from
+  /// many threads, each running (e.g. under a `torch::InferenceGuard`) its own
+  /// replica: the parameters are only read, while buffers such as running
+  /// statistics may be written. Modifying the parameters of either module in
+  /// place (e.g. with an optimizer) changes the parameters of both.
+  std::shared_ptr<Module> shallow_replica() const;
+
   /// Provides a means to traverse the `Module` tree.
   ModuleCursor modules();
   ConstModuleCursor modules() const;
@@ -55,7 +64,9 @@ class Module {
   ConstModuleCursor children() const;
 
   /// Provides a means to recursively access the parameters of the `Module`
-  /// tree.
+  /// tree. The parameters are only collected again after a parameter, buffer
+  /// or submodule was registered somewhere, so calling this every iteration of
+  /// a training loop is cheap.
   ParameterCursor parameters();
   ConstParameterCursor parameters() const;
 
@@ -99,6 +110,15 @@ class Module {
   /// Recursively zeros out the `grad` values of all parameters.
   virtual void zero_grad();
 
+  /// Moves the data of all parameters of the `Module` tree into one contiguous
+  /// tensor, and makes every parameter a view into it. The same is done for
+  /// the gradients, which are zero for parameters that had none. Returns the
+  /// flat tensor, whose `grad()` is the flat gradient, so that an optimizer
+  /// can update all parameters with a single kernel, e.g. by optimizing just
+  /// `{module->flatten_parameters()}`. All parameters must have the same dtype
+  /// and device. Moving the module with `to()` unflattens the parameters.
+  Tensor flatten_parameters();
+
   /// Serializes the `Module`.
   template <class Archive>
   void save(Archive& ar) const;
@@ -157,6 +177,12 @@ class Module {
   OrderedDict<Tensor> buffers_;
   OrderedDict<std::shared_ptr<Module>> children_;
 
+  /// The items of the `parameters()` and `buffers()` cursors of this module.
+  mutable torch::detail::CursorCache<Tensor> parameters_cache_;
+  mutable torch::detail::CursorCache<const Tensor> const_parameters_cache_;
+  mutable torch::detail::CursorCache<Tensor> buffers_cache_;
+  mutable torch::detail::CursorCache<const Tensor> const_buffers_cache_;
+
   /// The module's name (e.g. "LSTM").
   mutable at::optional<std::string> name_;
 
@@ -205,6 +231,7 @@ std::shared_ptr<ModuleType> Module::register_module(
     std::string name,
     std::shared_ptr<ModuleType> module) {
   auto& base_module = children_.insert(std::move(name), std::move(module));
+  torch::detail::invalidate_cursor_caches();
   return std::dynamic_pointer_cast<ModuleType>(base_module);
 }
 
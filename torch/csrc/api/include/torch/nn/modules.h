@@ -9,3 +9,4 @@
 #include <torch/nn/modules/linear.h>
 #include <torch/nn/modules/rnn.h>
 #include <torch/nn/modules/sequential.h>
+#include <torch/nn/modules/static_sequential.h>
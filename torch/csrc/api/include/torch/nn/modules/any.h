@@ -71,6 +71,22 @@ class AnyModule {
   template <typename... ArgumentTypes>
   Value forward(ArgumentTypes&&... arguments);
 
+  /// Returns true if the contained module's `forward()` method takes arguments
+  /// of the decayed `ArgumentTypes` (`Variable`s count as `Tensor`s) and
+  /// returns a `ReturnType`, in which case `forward_unboxed()` calls it without
+  /// boxing any values.
+  template <typename ReturnType, typename... ArgumentTypes>
+  bool is_callable_unboxed() const noexcept;
+
+  /// Invokes `forward()` on the contained module with the given arguments, and
+  /// returns the return value as a `ReturnType`. If the module's `forward()`
+  /// has exactly this signature (see `is_callable_unboxed()`), neither the
+  /// arguments nor the return value are boxed into `Value`s, which saves their
+  /// allocations and the type checks. Otherwise this is equivalent to
+  /// `forward(arguments...).get<ReturnType>()`.
+  template <typename ReturnType, typename... ArgumentTypes>
+  ReturnType forward_unboxed(ArgumentTypes&&... arguments);
+
   /// Attempts to cast the underlying module to the given module type. Throws an
   /// exception if the types do not match.
   template <typename T, typename = torch::detail::enable_if_module_t<T>>
@@ -129,6 +145,14 @@ class AnyModule {
   template <typename T>
   T& get_() const;
 
+  /// The type an argument of type `T` is passed to `forward_unboxed()` as.
+  /// Like `Value`, this converts `autograd::Variable`s to `Tensor`s.
+  template <typename T>
+  using Unboxed = typename std::conditional<
+      std::is_same<decay_t<T>, autograd::Variable>::value,
+      Tensor,
+      decay_t<T>>::type;
+
   /// The type erased module.
   std::unique_ptr<Placeholder> content_;
 };
@@ -236,6 +260,15 @@ class AnyModule::Value {
 struct AnyModule::Placeholder : public AnyModule::Value::Placeholder {
   using AnyModule::Value::Placeholder::Placeholder;
 
+  /// The signature of the module's `forward()` method, as the type
+  /// `ReturnType(ArgumentTypes...)`.
+  const std::type_info* signature{nullptr};
+
+  /// Calls the module's `forward()` method without boxing. Its actual type is
+  /// `ReturnType (*)(Placeholder&, ArgumentTypes&&...)`, where the types are
+  /// those of `signature`.
+  void (*unboxed_forward)(){nullptr};
+
   /// The "erased" `forward()` method.
   virtual Value forward(std::vector<Value>&& arguments) = 0;
 
@@ -283,7 +316,23 @@ struct AnyModule::Holder : public AnyModule::Placeholder {
 
   /// Constructs the `Holder` from a concrete module.
   explicit Holder(std::shared_ptr<ModuleType>&& module_)
-      : Placeholder(typeid(ModuleType)), module(std::move(module_)) {}
+      : Placeholder(typeid(ModuleType)), module(std::move(module_)) {
+    using ReturnType = decltype(
+        std::declval<ModuleType&>().forward(std::declval<ArgumentTypes>()...));
+    signature = &typeid(ReturnType(ArgumentTypes...));
+    unboxed_forward =
+        reinterpret_cast<void (*)()>(&Holder::forward_unboxed<ReturnType>);
+  }
+
+  /// Calls `forward()` on the underlying module of `self`, which must be a
+  /// `Holder` of this type. See `AnyModule::forward_unboxed()`.
+  template <typename ReturnType>
+  static ReturnType forward_unboxed(
+      Placeholder& self,
+      ArgumentTypes&&... arguments) {
+    return static_cast<Holder&>(self).module->forward(
+        std::forward<ArgumentTypes>(arguments)...);
+  }
 
   /// Calls `forward()` on the underlying module, casting each `Value` in the
   /// argument vector to a concrete value.
@@ -368,6 +417,28 @@ AnyModule::Value AnyModule::forward(ArgumentTypes&&... arguments) {
   return content_->forward(std::move(values));
 }
 
+template <typename ReturnType, typename... ArgumentTypes>
+bool AnyModule::is_callable_unboxed() const noexcept {
+  return content_ != nullptr &&
+      content_->signature->hash_code() ==
+      typeid(ReturnType(Unboxed<ArgumentTypes>...)).hash_code();
+}
+
+template <typename ReturnType, typename... ArgumentTypes>
+ReturnType AnyModule::forward_unboxed(ArgumentTypes&&... arguments) {
+  if (is_callable_unboxed<ReturnType, ArgumentTypes...>()) {
+    using Function =
+        ReturnType (*)(Placeholder&, Unboxed<ArgumentTypes>&&...);
+    // Arguments the caller passes as lvalues are copied, just like the module's
+    // `forward()` (taking them by value) would copy them.
+    return reinterpret_cast<Function>(content_->unboxed_forward)(
+        *content_,
+        Unboxed<ArgumentTypes>(std::forward<ArgumentTypes>(arguments))...);
+  }
+  return forward(std::forward<ArgumentTypes>(arguments)...)
+      .template get<ReturnType>();
+}
+
 template <typename T, typename>
 T& AnyModule::get() {
   AT_CHECK(!is_empty(), "Cannot call get() on an empty AnyModule");
@@ -6,8 +6,12 @@
 #include <torch/nn/pimpl.h>
 #include <torch/tensor.h>
 
+#include <torch/csrc/autograd/functions/checkpoint.h>
+
 #include <ATen/core/Error.h>
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -52,27 +56,74 @@ class SequentialImpl : public Cloneable<SequentialImpl> {
 
   /// Feeds the `inputs` to the first module, then chains the output of each
   /// module with the input of the next, in order of construction.
+  ///
+  /// As long as the modules return a `Tensor` that the next module takes as
+  /// its only argument, the output is passed on without boxing it into an
+  /// `AnyModule::Value` (see `AnyModule::forward_unboxed()`). For modules of
+  /// statically known types, `StaticSequential` avoids type erasure entirely.
   template <typename ReturnType = Tensor, typename... ArgumentTypes>
   ReturnType forward(ArgumentTypes&&... arguments) {
     AT_CHECK(!is_empty(), "Cannot call forward() on an empty Sequential");
 
     auto iterator = modules_.begin();
-    auto input = iterator->forward(std::forward<ArgumentTypes>(arguments)...);
+    if (!iterator->is_callable_unboxed<Tensor, ArgumentTypes...>()) {
+      auto input =
+          iterator->forward(std::forward<ArgumentTypes>(arguments)...);
+      return forward_boxed<ReturnType>(++iterator, std::move(input));
+    }
 
-    for (++iterator; iterator != modules_.end(); ++iterator) {
-      input = iterator->forward(std::move(input));
+    Tensor output = iterator->forward_unboxed<Tensor>(
+        std::forward<ArgumentTypes>(arguments)...);
+    for (++iterator; iterator != modules_.end() &&
+         iterator->is_callable_unboxed<Tensor, Tensor>();
+         ++iterator) {
+      output = iterator->forward_unboxed<Tensor>(std::move(output));
     }
+    if (iterator == modules_.end()) {
+      return return_value<ReturnType>(std::move(output));
+    }
+    auto input = iterator->forward(std::move(output));
+    return forward_boxed<ReturnType>(++iterator, std::move(input));
+  }
 
-    // Check the return value and give a nice error message if the requsted
-    // return type was incorrect.
-    if (auto* return_value = input.template try_get<ReturnType>()) {
-      return std::move(*return_value);
+  /// Like `forward()` for modules that take and return a single `Tensor`, but
+  /// divides the modules into `segments` consecutive segments and checkpoints
+  /// all of them except the last: their activations are recomputed during
+  /// backward instead of being kept, which trades compute for memory (see
+  /// Note [Checkpointing] in torch/csrc/autograd/functions/checkpoint.h). If
+  /// `segments` is 0, about the square root of the number of modules is used,
+  /// which minimizes the memory of the activations when the modules are alike.
+  Tensor forward_checkpointed(Tensor input, size_t segments = 0) {
+    AT_CHECK(
+        !is_empty(),
+        "Cannot call forward_checkpointed() on an empty Sequential");
+    if (segments == 0) {
+      segments = std::max<size_t>(
+          1, std::lround(std::sqrt(static_cast<double>(size()))));
     }
-    AT_ERROR(
-        "The type of the return value is ",
-        at::demangle(input.type_info().name()),
-        ", but you asked for type ",
-        at::demangle(typeid(ReturnType).name()));
+    segments = std::min(segments, size());
+    const size_t segment_size = (size() + segments - 1) / segments;
+
+    size_t begin = 0;
+    for (; begin + segment_size < size(); begin += segment_size) {
+      // The segment keeps (shallow copies of) its modules alive until the
+      // backward pass is done with them.
+      std::vector<AnyModule> segment(
+          modules_.begin() + begin, modules_.begin() + begin + segment_size);
+      auto run_segment =
+          [segment](const autograd::variable_list& inputs) mutable {
+        Tensor output = inputs.at(0);
+        for (auto& module : segment) {
+          output = module.forward(output).get<Tensor>();
+        }
+        return autograd::variable_list{output};
+      };
+      input = autograd::checkpoint(run_segment, {input}).at(0);
+    }
+    for (; begin < size(); ++begin) {
+      input = modules_[begin].forward(std::move(input)).get<Tensor>();
+    }
+    return input;
   }
 
   /// Adds a new (boxed) `Module` to the `Sequential` container.
@@ -219,6 +270,43 @@ class SequentialImpl : public Cloneable<SequentialImpl> {
   /// The base case, when the list of modules is empty.
   void push_back() {}
 
+  /// Chains `input` through the modules from `iterator` to the end.
+  template <typename ReturnType>
+  ReturnType forward_boxed(Iterator iterator, AnyModule::Value input) {
+    for (; iterator != modules_.end(); ++iterator) {
+      input = iterator->forward(std::move(input));
+    }
+
+    // Check the return value and give a nice error message if the requsted
+    // return type was incorrect.
+    if (auto* return_value = input.template try_get<ReturnType>()) {
+      return std::move(*return_value);
+    }
+    AT_ERROR(
+        "The type of the return value is ",
+        at::demangle(input.type_info().name()),
+        ", but you asked for type ",
+        at::demangle(typeid(ReturnType).name()));
+  }
+
+  /// Returns the unboxed output of the last module, if a `Tensor` was asked
+  /// for.
+  template <typename ReturnType>
+  torch::enable_if_t<std::is_same<ReturnType, Tensor>::value, ReturnType>
+  return_value(Tensor output) {
+    return output;
+  }
+
+  template <typename ReturnType>
+  torch::disable_if_t<std::is_same<ReturnType, Tensor>::value, ReturnType>
+  return_value(Tensor output) {
+    AT_ERROR(
+        "The type of the return value is ",
+        at::demangle(typeid(Tensor).name()),
+        ", but you asked for type ",
+        at::demangle(typeid(ReturnType).name()));
+  }
+
   // Box the AnyModules to give Sequential reference semantics, like the rest of
   // the API. Note that this is not required otherwise, this could just be a
   // `vector<AnyModule>`.
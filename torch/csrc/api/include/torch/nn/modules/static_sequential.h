@@ -0,0 +1,206 @@
+#pragma once
+
+#include <torch/csrc/utils/variadic.h>
+#include <torch/nn/cloneable.h>
+#include <torch/nn/module.h>
+#include <torch/nn/pimpl.h>
+
+#include <ATen/Device.h>
+#include <ATen/core/Error.h>
+#include <ATen/core/optional.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace torch {
+namespace nn {
+namespace detail {
+/// The module type stored for a `StaticSequential` module type `M`: the
+/// contained type for `ModuleHolder`s, else `M` itself.
+template <typename M, bool = torch::detail::is_module_holder<M>::value>
+struct StaticSequentialModule {
+  using type = M;
+};
+
+template <typename M>
+struct StaticSequentialModule<M, true> {
+  using type = typename M::ContainedType;
+};
+
+/// Chains `Input` through the modules from `Index` to the end of the tuple
+/// `Modules` of `shared_ptr`s, computing the type of the final output.
+template <
+    size_t Index,
+    typename Modules,
+    typename Input,
+    bool = (Index == std::tuple_size<Modules>::value)>
+struct StaticForward {
+  using Module = typename std::tuple_element<Index, Modules>::type::element_type;
+  using Output =
+      decay_t<decltype(std::declval<Module&>().forward(std::declval<Input>()))>;
+  using Next = StaticForward<Index + 1, Modules, Output>;
+  using ReturnType = typename Next::ReturnType;
+
+  static ReturnType run(Modules& modules, Input input) {
+    return Next::run(modules, std::get<Index>(modules)->forward(std::move(input)));
+  }
+};
+
+template <size_t Index, typename Modules, typename Input>
+struct StaticForward<Index, Modules, Input, true> {
+  using ReturnType = Input;
+
+  static ReturnType run(Modules& /*modules*/, Input input) {
+    return input;
+  }
+};
+
+/// The chain of a `StaticSequential` with the given tuple of modules, whose
+/// first module is called with arguments of the given types.
+template <typename Modules, typename... ArgumentTypes>
+struct StaticSequentialForward {
+  using Input = decay_t<decltype(std::get<0>(std::declval<Modules&>())
+                                     ->forward(std::declval<ArgumentTypes>()...))>;
+  using Chain = StaticForward<1, Modules, Input>;
+  using ReturnType = typename Chain::ReturnType;
+};
+} // namespace detail
+
+/// A `Sequential` whose modules have types known at compile time, given as
+/// template arguments (either module holders like `Linear` or module classes).
+/// Its `forward()` calls the `forward()` method of each module directly, with
+/// the output of the previous one, so there is no type erasure and no boxing of
+/// the values passed between the modules, and the return type is deduced.
+/// Prefer it over `Sequential` for deep stacks of small layers.
+///
+/// \rst
+/// .. code-block:: cpp
+///
+///   StaticSequential<Linear, Functional, Linear> net(
+///       Linear(3, 4), Functional(torch::relu), Linear(4, 5));
+///   torch::Tensor output = net->forward(torch::ones({2, 3}));
+/// \endrst
+template <typename... Modules>
+class StaticSequentialImpl
+    : public Cloneable<StaticSequentialImpl<Modules...>> {
+ public:
+  static_assert(
+      sizeof...(Modules) > 0,
+      "StaticSequential requires at least one module");
+
+  /// The tuple of the contained modules.
+  using ModuleTuple = std::tuple<
+      std::shared_ptr<typename detail::StaticSequentialModule<Modules>::type>...>;
+
+  /// Constructs the `StaticSequential` from one module per template argument,
+  /// each of which can be a module holder, a `shared_ptr` to a module or a
+  /// module value (which is moved into a `shared_ptr`).
+  template <
+      typename... Ts,
+      typename = enable_if_t<sizeof...(Ts) == sizeof...(Modules)>>
+  explicit StaticSequentialImpl(Ts&&... modules)
+      : modules_(boxed(std::forward<Ts>(modules))...) {
+    register_modules();
+  }
+
+  StaticSequentialImpl(const StaticSequentialImpl&) = default;
+  StaticSequentialImpl(StaticSequentialImpl& other)
+      : StaticSequentialImpl(static_cast<const StaticSequentialImpl&>(other)) {}
+  StaticSequentialImpl& operator=(const StaticSequentialImpl&) = default;
+
+  /// Special cloning function for `StaticSequential` because it does not use
+  /// `reset()`.
+  std::shared_ptr<Module> clone(
+      at::optional<Device> device = at::nullopt) const override {
+    return clone_modules(
+        device, typename MakeIndices<sizeof...(Modules)>::indices{});
+  }
+
+  /// `reset()` is empty for `StaticSequential`, since it does not have
+  /// parameters of its own.
+  void reset() override {}
+
+  /// Feeds the `arguments` to the first module, then chains the output of each
+  /// module with the input of the next, in order of construction.
+  template <typename... ArgumentTypes>
+  auto forward(ArgumentTypes&&... arguments) -> typename detail::
+      StaticSequentialForward<ModuleTuple, ArgumentTypes&&...>::ReturnType {
+    using Chain = typename detail::
+        StaticSequentialForward<ModuleTuple, ArgumentTypes&&...>::Chain;
+    return Chain::run(
+        modules_,
+        std::get<0>(modules_)->forward(
+            std::forward<ArgumentTypes>(arguments)...));
+  }
+
+  /// Returns the module at the given index.
+  template <size_t Index>
+  const typename std::tuple_element<Index, ModuleTuple>::type& get() const {
+    return std::get<Index>(modules_);
+  }
+
+  /// The number of modules in the `StaticSequential`.
+  constexpr size_t size() const noexcept {
+    return sizeof...(Modules);
+  }
+
+ private:
+  template <typename M>
+  static std::shared_ptr<M> boxed(std::shared_ptr<M> module) {
+    return module;
+  }
+
+  template <typename M>
+  static std::shared_ptr<M> boxed(const ModuleHolder<M>& module_holder) {
+    return module_holder.ptr();
+  }
+
+  template <typename M, typename = torch::detail::enable_if_module_t<M>>
+  static std::shared_ptr<decay_t<M>> boxed(M&& module) {
+    return std::make_shared<decay_t<M>>(std::forward<M>(module));
+  }
+
+  template <size_t Index = 0>
+  enable_if_t<(Index < sizeof...(Modules))> register_modules() {
+    this->register_module(std::to_string(Index), std::get<Index>(modules_));
+    register_modules<Index + 1>();
+  }
+
+  template <size_t Index>
+  enable_if_t<Index == sizeof...(Modules)> register_modules() {}
+
+  template <size_t... Is>
+  std::shared_ptr<Module> clone_modules(
+      at::optional<Device> device,
+      Indices<Is...>) const {
+    return std::make_shared<StaticSequentialImpl>(
+        std::dynamic_pointer_cast<
+            typename std::tuple_element<Is, ModuleTuple>::type::element_type>(
+            std::get<Is>(modules_)->clone(device))...);
+  }
+
+  ModuleTuple modules_;
+};
+
+/// A `ModuleHolder` subclass for `StaticSequentialImpl`.
+/// See the documentation for `StaticSequentialImpl` class to learn what
+/// methods it provides, or the documentation for `ModuleHolder` to learn about
+/// PyTorch's module storage semantics.
+template <typename... Modules>
+class StaticSequential
+    : public ModuleHolder<StaticSequentialImpl<Modules...>> {
+ public:
+  using ModuleHolder<StaticSequentialImpl<Modules...>>::ModuleHolder;
+  StaticSequential(const StaticSequential&) = default;
+  StaticSequential(StaticSequential&&) = default;
+  StaticSequential(StaticSequential& other)
+      : StaticSequential(static_cast<const StaticSequential&>(other)) {}
+  StaticSequential& operator=(const StaticSequential&) = default;
+  StaticSequential& operator=(StaticSequential&&) = default;
+};
+} // namespace nn
+} // namespace torch
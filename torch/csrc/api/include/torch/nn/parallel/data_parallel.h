@@ -1,16 +1,19 @@
 #pragma once
 
 #include <torch/cuda.h>
+#include <torch/nn/cloneable.h>
 #include <torch/nn/module.h>
 #include <torch/nn/pimpl.h>
 #include <torch/tensor.h>
+#include <torch/utils.h>
 
 #include <torch/csrc/autograd/functions/comm.h>
+#include <torch/csrc/autograd/functions/utils.h>
+#include <torch/csrc/autograd/grad_mode.h>
 #include <torch/csrc/cuda/comm.h>
 
 #include <ATen/Device.h>
 #include <ATen/OptionsGuard.h>
-#include <ATen/Parallel.h>
 #include <ATen/TensorOptions.h>
 #include <ATen/core/Error.h>
 #include <ATen/core/optional.h>
@@ -19,22 +22,121 @@
 #include <exception>
 #include <memory>
 #include <mutex>
+#include <thread>
 #include <vector>
 
 namespace torch {
 namespace nn {
 namespace parallel {
+namespace detail {
+/// The size of the buckets that `replicate()` broadcasts parameters and
+/// buffers in, and that their gradients are reduced in.
+constexpr size_t kReplicateBufferSize = 10485760;
+
+/// Whether `replicate()` can broadcast the tensors from the first device to
+/// the others: all of them must be on the first device, which, like the
+/// others, must be a distinct CUDA device.
+inline bool can_broadcast(
+    const std::vector<Tensor>& tensors,
+    const std::vector<Device>& devices) {
+  for (size_t i = 0; i < devices.size(); ++i) {
+    if (!devices[i].is_cuda() || devices[i].index() < 0) {
+      return false;
+    }
+    for (size_t j = 0; j < i; ++j) {
+      if (devices[j] == devices[i]) {
+        return false;
+      }
+    }
+  }
+  for (const auto& tensor : tensors) {
+    if (!tensor.defined() || tensor.device() != devices.front()) {
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace detail
 
 /// Replicates a module on the given list of devices.
 /// A replica is created by calling `clone()` on the module. For this, the
 /// module must inherit from `nn::Cloneable`, or define its own `clone()`
 /// method, which is expected to perform a deep copy of the module.
+///
+/// If all parameters and buffers of the module are on the first device, and
+/// the devices are distinct CUDA devices, they are copied to the other
+/// devices with a single coalesced broadcast (see
+/// `torch::cuda::broadcast_coalesced()`), the replica on the first device
+/// shares them with the module, and gradients flowing into the parameters of
+/// the replicas are summed into the module's parameters with a coalesced
+/// (NCCL) reduction. Otherwise, every replica is an independent copy.
 template <typename ModuleType>
 std::vector<std::shared_ptr<ModuleType>> replicate(
     const std::shared_ptr<ModuleType>& module,
     const std::vector<Device>& devices) {
   std::vector<std::shared_ptr<ModuleType>> replicas;
   replicas.reserve(devices.size());
+#ifdef USE_CUDA
+  std::vector<Tensor> tensors;
+  std::vector<autograd::Variable> grad_parameters;
+  for (auto& parameter : module->parameters()) {
+    tensors.push_back(*parameter);
+    if (parameter->requires_grad()) {
+      grad_parameters.emplace_back(*parameter);
+    }
+  }
+  for (auto& buffer : module->buffers()) {
+    tensors.push_back(*buffer);
+  }
+
+  if (!devices.empty() && detail::can_broadcast(tensors, devices)) {
+    std::vector<int64_t> device_indices;
+    for (const auto& device : devices) {
+      device_indices.push_back(device.index());
+    }
+    torch::cuda::tensor_list2d copies;
+    {
+      NoGradGuard no_grad;
+      copies = torch::cuda::broadcast_coalesced(
+          tensors, device_indices, detail::kReplicateBufferSize);
+    }
+    nn::detail::ReplicatedTensors replicated;
+    for (size_t i = 0; i < devices.size(); ++i) {
+      for (size_t j = 0; j < tensors.size(); ++j) {
+        replicated.emplace(
+            std::make_pair(
+                tensors[j].unsafeGetTensorImpl(),
+                static_cast<int32_t>(device_indices[i])),
+            copies[i][j]);
+      }
+    }
+    {
+      nn::detail::ReplicationGuard guard(replicated);
+      for (const auto& device : devices) {
+        replicas.push_back(
+            std::static_pointer_cast<ModuleType>(module->clone(device)));
+      }
+    }
+
+    if (autograd::GradMode::is_enabled() && !grad_parameters.empty()) {
+      auto grad_fn = std::make_shared<autograd::ReduceAddCoalesced>(
+          devices.front(),
+          grad_parameters.size(),
+          detail::kReplicateBufferSize);
+      grad_fn->set_next_edges(autograd::collect_next_edges(grad_parameters));
+      // the inputs of grad_fn are the parameters of the replicas, replica
+      // by replica, in the order of grad_parameters
+      for (auto& replica : replicas) {
+        for (auto& parameter : replica->parameters()) {
+          if (parameter->requires_grad()) {
+            autograd::set_history(*parameter, grad_fn);
+          }
+        }
+      }
+    }
+    return replicas;
+  }
+#endif
   for (const auto& device : devices) {
     replicas.push_back(
         std::static_pointer_cast<ModuleType>(module->clone(device)));
@@ -54,9 +156,10 @@ std::vector<ModuleHolder<ModuleType>> replicate(
 }
 
 /// Applies the given inputs to the given modules in a parallel fashion.
-/// Conceptually, a thread is spawned for each `(module, input)` pair, in which
-/// `forward()` is called on the module with its corresponding input. The
-/// outputs of the individual calls are stored in a vector and returned.
+/// A thread is spawned for each `(module, input)` pair, in which `forward()`
+/// is called on the module with its corresponding input, with gradient
+/// recording enabled or disabled as in the calling thread. The outputs of the
+/// individual calls are stored in a vector and returned.
 ///
 /// The first exception caught by any thread is stashed and rethrown after all
 /// threads have completed their operation.
@@ -89,27 +192,37 @@ std::vector<Tensor> parallel_apply(
   // https://en.cppreference.com/w/cpp/error/exception_ptr
   std::exception_ptr exception;
 
-  at::parallel_for(
-      /*begin=*/0,
-      /*end=*/modules.size(),
-      /*grain_size=*/1,
-      [&modules, &inputs, &devices, &outputs, &mutex, &exception](
-          int64_t index, int64_t stop) {
-        for (; index < stop; ++index) {
-          try {
-            torch::OptionsGuard options_guard(
-                devices ? (*devices)[index] : inputs[index].device());
-            auto output = modules[index]->forward(inputs[index]);
-            std::lock_guard<std::mutex> lock(mutex);
-            outputs[index] = output;
-          } catch (...) {
-            std::lock_guard<std::mutex> lock(mutex);
-            if (!exception) {
-              exception = std::current_exception();
-            }
-          }
-        }
-      });
+  const bool grad_enabled = autograd::GradMode::is_enabled();
+  auto apply = [&modules, &inputs, &devices, &outputs, &mutex, &exception,
+                grad_enabled](size_t index) {
+    try {
+      // grad mode is thread local
+      autograd::GradMode::set_enabled(grad_enabled);
+      torch::OptionsGuard options_guard(
+          devices ? (*devices)[index] : inputs[index].device());
+      auto output = modules[index]->forward(inputs[index]);
+      std::lock_guard<std::mutex> lock(mutex);
+      outputs[index] = output;
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!exception) {
+        exception = std::current_exception();
+      }
+    }
+  };
+
+  if (modules.size() == 1) {
+    apply(0);
+  } else {
+    std::vector<std::thread> threads;
+    threads.reserve(modules.size());
+    for (size_t index = 0; index < modules.size(); ++index) {
+      threads.emplace_back(apply, index);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
 
   if (exception) {
     std::rethrow_exception(exception);
@@ -126,7 +239,8 @@ std::vector<Tensor> parallel_apply(
 ///
 /// In detail, this method performs the following four distinct steps:
 /// 1. *Scatter* the input to the given devices,
-/// 2. *Replicate* (deep clone) the model on each device,
+/// 2. *Replicate* the model on each device (see `replicate()`; gradients of
+/// the replicas flow back into the model's parameters),
 /// 3. *Evaluate* each module with its input on its device,
 /// 4. *Gather* the outputs of each replica into a single output tensor, located
 /// on the `output_device`.
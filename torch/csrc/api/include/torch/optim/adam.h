@@ -23,6 +23,10 @@ struct AdamOptions {
   TORCH_ARG(double, weight_decay) = 0;
   TORCH_ARG(double, eps) = 1e-8;
   TORCH_ARG(bool, amsgrad) = false;
+  /// Updates all parameters with dense gradients at once with
+  /// `at::_fused_adam_step`, one call per step count. Unlike the unfused
+  /// step, the gradients aren't modified by the weight decay.
+  TORCH_ARG(bool, fused) = false;
 };
 
 class Adam : public Optimizer {
@@ -48,6 +52,9 @@ class Adam : public Optimizer {
   friend class cereal::access;
   Adam() : options(0) {}
 
+  void sparse_step(Tensor& p, size_t i);
+  void fused_step(const std::vector<size_t>& indices);
+
   std::vector<int64_t> step_buffers_;
   std::vector<Tensor> exp_average_buffers_;
   std::vector<Tensor> exp_average_sq_buffers_;
@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <functional>
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace torch {
@@ -84,6 +85,12 @@ class OptimizerBase {
     return buffers[index];
   }
 
+  /// Coalesces a sparse gradient, such as the gradient of an embedding with
+  /// `sparse=true`, and returns the indices of the rows it touches (which are
+  /// unique) and the values of these rows. Optimizers use this to update only
+  /// those rows of a parameter and its buffers.
+  static std::pair<Tensor, Tensor> sparse_gradient_rows(const Tensor& gradient);
+
   /// The parameters this optimizer optimizes.
   std::vector<Tensor> parameters_;
 };
@@ -24,6 +24,10 @@ struct RMSpropOptions {
   TORCH_ARG(double, weight_decay) = 0;
   TORCH_ARG(double, momentum) = 0;
   TORCH_ARG(bool, centered) = false;
+  /// Updates all parameters with dense gradients at once with
+  /// `at::_fused_rmsprop_step`. Unlike the unfused step, the gradients aren't
+  /// modified by the weight decay.
+  TORCH_ARG(bool, fused) = false;
 };
 
 class RMSprop : public Optimizer {
@@ -50,6 +54,8 @@ class RMSprop : public Optimizer {
   friend class cereal::access;
   RMSprop() : options(0) {}
 
+  void fused_step(const std::vector<size_t>& indices);
+
   std::vector<Tensor> square_average_buffers_;
   std::vector<Tensor> momentum_buffers_;
   std::vector<Tensor> grad_average_buffers_;
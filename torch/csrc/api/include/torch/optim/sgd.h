@@ -24,6 +24,12 @@ struct SGDOptions {
   TORCH_ARG(double, dampening) = 0;
   TORCH_ARG(double, weight_decay) = 0;
   TORCH_ARG(bool, nesterov) = false;
+  /// Updates all parameters with dense gradients at once with
+  /// `at::_fused_sgd_step`. This is the update of `torch.optim.SGD`: weight
+  /// decay is added to the gradient before the momentum, and the momentum
+  /// buffers aren't scaled by the learning rate. It matches the unfused step
+  /// if there is no weight decay and the learning rate doesn't change.
+  TORCH_ARG(bool, fused) = false;
 };
 
 class SGD : public Optimizer {
@@ -46,6 +52,8 @@ class SGD : public Optimizer {
   friend class cereal::access;
   SGD() : options(0) {}
 
+  void fused_step(const std::vector<size_t>& indices);
+
   std::vector<Tensor> momentum_buffers_;
   /// Counts how often `step()` is called, for dampening.
   size_t iteration_{0};
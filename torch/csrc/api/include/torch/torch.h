@@ -1,6 +1,8 @@
 #pragma once
 
+#include <torch/checkpoint.h>
 #include <torch/cuda.h>
+#include <torch/data.h>
 #include <torch/nn.h>
 #include <torch/optim.h>
 #include <torch/serialization.h>
@@ -13,6 +13,17 @@ struct NoGradGuard : public AutoGradMode {
   NoGradGuard() : AutoGradMode(/*enabled=*/false) {}
 };
 
+// A RAII, thread local (!) guard for running models without ever calling
+// backward: like `NoGradGuard`, and additionally enables inference mode, in
+// which in-place operations skip the version counter bumps that only matter
+// for backward (see torch/csrc/autograd/grad_mode.h).
+struct InferenceGuard : public NoGradGuard {
+  InferenceGuard() : inference_mode_(/*enabled=*/true) {}
+
+ private:
+  autograd::AutoInferenceMode inference_mode_;
+};
+
 /// Sets the global random seed for all newly created CPU and CUDA tensors.
 void manual_seed(uint64_t seed);
 } // namespace torch
@@ -0,0 +1,415 @@
+#include <torch/checkpoint.h>
+
+#include <torch/nn/module.h>
+#include <torch/serialization.h>
+#include <torch/tensor.h>
+#include <torch/utils.h>
+
+#include <torch/csrc/autograd/variable.h>
+
+#include <ATen/ATen.h>
+#include <ATen/core/Error.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace torch {
+namespace {
+// The file format is:
+//   magic, uint64_t number of tensors,
+//   for each tensor: uint64_t name length, name, int32_t dtype id,
+//     uint64_t number of dimensions, int64_t sizes, uint64_t data offset,
+//   padding up to the data of the first tensor.
+// All integers are in the byte order of the machine that wrote the file.
+const char kMagic[8] = {'P', 'T', 'C', 'K', 'P', 'T', '0', '1'};
+const uint64_t kAlignment = 4096;
+
+uint64_t align(uint64_t offset) {
+  return (offset + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+template <typename T>
+void write_value(std::string& header, T value) {
+  header.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/// Calls `function(i)` for all `i` in `[0, count)` on up to `threads` threads,
+/// and rethrows the first exception thrown by any call.
+void parallel_apply(
+    size_t count,
+    size_t threads,
+    const std::function<void(size_t)>& function) {
+  std::atomic<size_t> next{0};
+  std::exception_ptr exception;
+  std::mutex mutex;
+  auto work = [&] {
+    for (size_t i = next++; i < count; i = next++) {
+      try {
+        function(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!exception) {
+          exception = std::current_exception();
+        }
+      }
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_t t = 1; t < std::min(threads, count); ++t) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
+#ifndef _WIN32
+void write_at(
+    int fd,
+    const char* data,
+    uint64_t size,
+    uint64_t offset,
+    const std::string& path) {
+  while (size > 0) {
+    const auto written = pwrite(fd, data, size, offset);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    AT_CHECK(
+        written > 0,
+        "Could not write checkpoint file '",
+        path,
+        "': ",
+        std::strerror(errno));
+    data += written;
+    size -= written;
+    offset += written;
+  }
+}
+#endif
+
+/// The file contents, mapped into memory where possible.
+class FileContents {
+ public:
+  FileContents(const std::string& path, bool populate, size_t threads) {
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    AT_CHECK(fd >= 0, "Could not open checkpoint file '", path, "'");
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      close(fd);
+      AT_ERROR("Could not stat checkpoint file '", path, "'");
+    }
+    size_ = st.st_size;
+    int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+    if (populate && threads <= 1) {
+      flags |= MAP_POPULATE;
+    }
+#endif
+    if (size_ > 0) {
+      data_ = mmap(
+          nullptr, size_, PROT_READ | PROT_WRITE, flags, fd, /*offset=*/0);
+    }
+    close(fd);
+    AT_CHECK(
+        data_ != MAP_FAILED, "Could not map checkpoint file '", path, "'");
+    if (populate && threads > 1) {
+      // Fault in the pages from several threads, to keep more reads in flight.
+      const uint64_t pages = (size_ + kAlignment - 1) / kAlignment;
+      parallel_apply(threads, threads, [&](size_t t) {
+        volatile char sink = 0;
+        for (uint64_t page = pages * t / threads;
+             page < pages * (t + 1) / threads;
+             ++page) {
+          sink += data()[page * kAlignment];
+        }
+      });
+    }
+#else
+    std::ifstream stream(path, std::ios::binary | std::ios::ate);
+    AT_CHECK(stream, "Could not open checkpoint file '", path, "'");
+    size_ = stream.tellg();
+    buffer_.reset(new char[size_]);
+    stream.seekg(0);
+    stream.read(buffer_.get(), size_);
+    AT_CHECK(stream, "Could not read checkpoint file '", path, "'");
+    data_ = buffer_.get();
+#endif
+  }
+
+  ~FileContents() {
+#ifndef _WIN32
+    if (data_ != nullptr && data_ != MAP_FAILED) {
+      munmap(data_, size_);
+    }
+#endif
+  }
+
+  char* data() const {
+    return static_cast<char*>(data_);
+  }
+
+  uint64_t size() const {
+    return size_;
+  }
+
+ private:
+  void* data_ = nullptr;
+  uint64_t size_ = 0;
+#ifdef _WIN32
+  std::unique_ptr<char[]> buffer_;
+#endif
+};
+
+/// Reads the header of a checkpoint, checking that it does not run past the end
+/// of the file.
+class HeaderReader {
+ public:
+  HeaderReader(const FileContents& contents, const std::string& path)
+      : contents_(contents), path_(path) {}
+
+  template <typename T>
+  T read() {
+    T value;
+    std::memcpy(&value, advance(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  std::string read_string(uint64_t length) {
+    return std::string(advance(length), length);
+  }
+
+  const char* advance(uint64_t size) {
+    AT_CHECK(
+        size <= contents_.size() && offset_ <= contents_.size() - size,
+        "Checkpoint file '",
+        path_,
+        "' is truncated");
+    const char* data = contents_.data() + offset_;
+    offset_ += size;
+    return data;
+  }
+
+ private:
+  const FileContents& contents_;
+  const std::string& path_;
+  uint64_t offset_ = 0;
+};
+} // namespace
+
+void save_checkpoint(
+    const std::string& path,
+    const NamedTensors& tensors,
+    CheckpointSaveOptions options) {
+  AT_CHECK(options.chunk_size() > 0, "chunk_size must be positive");
+  std::vector<Tensor> contiguous;
+  contiguous.reserve(tensors.size());
+  std::string header(kMagic, sizeof(kMagic));
+  write_value<uint64_t>(header, tensors.size());
+  for (const auto& item : tensors) {
+    AT_CHECK(
+        item.second.defined(),
+        "Cannot save undefined tensor '",
+        item.first,
+        "' to a checkpoint");
+    contiguous.push_back(item.second.cpu().contiguous());
+    write_value<uint64_t>(header, item.first.size());
+    header += item.first;
+    write_value<int32_t>(header, detail::scalarTypeId(item.second.dtype()));
+    write_value<uint64_t>(header, item.second.dim());
+    for (auto size : item.second.sizes()) {
+      write_value<int64_t>(header, size);
+    }
+    // The offset is filled in below, once the size of the header is known.
+    write_value<uint64_t>(header, 0);
+  }
+
+  // Patch the offsets of the tensor data into the header, and split the data
+  // into chunks.
+  struct Chunk {
+    const char* data;
+    uint64_t size;
+    uint64_t offset;
+  };
+  std::vector<Chunk> chunks;
+  uint64_t offset = align(header.size());
+  uint64_t file_size = header.size();
+  size_t position = sizeof(kMagic) + sizeof(uint64_t);
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    position += sizeof(uint64_t) + tensors[i].first.size() + sizeof(int32_t) +
+        sizeof(uint64_t) + sizeof(int64_t) * tensors[i].second.dim();
+    std::memcpy(&header[position], &offset, sizeof(uint64_t));
+    position += sizeof(uint64_t);
+
+    const auto* data = static_cast<const char*>(contiguous[i].data_ptr());
+    const uint64_t nbytes =
+        contiguous[i].numel() * contiguous[i].type().elementSizeInBytes();
+    for (uint64_t begin = 0; begin < nbytes; begin += options.chunk_size()) {
+      chunks.push_back(Chunk{data + begin,
+                             std::min<uint64_t>(options.chunk_size(), nbytes - begin),
+                             offset + begin});
+    }
+    file_size = offset + nbytes;
+    offset = align(offset + nbytes);
+  }
+
+#ifndef _WIN32
+  int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  AT_CHECK(fd >= 0, "Could not open checkpoint file '", path, "' for writing");
+  try {
+    // The padding between tensors is left as holes, which read as zeros.
+    AT_CHECK(
+        ftruncate(fd, file_size) == 0,
+        "Could not resize checkpoint file '",
+        path,
+        "'");
+    write_at(fd, header.data(), header.size(), 0, path);
+    parallel_apply(chunks.size(), options.threads(), [&](size_t i) {
+      write_at(fd, chunks[i].data, chunks[i].size, chunks[i].offset, path);
+    });
+  } catch (...) {
+    close(fd);
+    throw;
+  }
+  AT_CHECK(close(fd) == 0, "Could not write checkpoint file '", path, "'");
+#else
+  std::ofstream stream(path, std::ios::binary);
+  AT_CHECK(stream, "Could not open checkpoint file '", path, "' for writing");
+  stream.write(header.data(), header.size());
+  uint64_t written = header.size();
+  const std::string padding(kAlignment, '\0');
+  for (const auto& chunk : chunks) {
+    stream.write(padding.data(), chunk.offset - written);
+    stream.write(chunk.data, chunk.size);
+    written = chunk.offset + chunk.size;
+  }
+  stream.write(padding.data(), file_size - written);
+  AT_CHECK(stream, "Could not write checkpoint file '", path, "'");
+#endif
+}
+
+void save_checkpoint(
+    const std::string& path,
+    const nn::Module& module,
+    CheckpointSaveOptions options) {
+  NamedTensors tensors;
+  for (const auto& parameter : module.parameters()) {
+    tensors.emplace_back(parameter.key, parameter.value);
+  }
+  save_checkpoint(path, tensors, options);
+}
+
+NamedTensors load_checkpoint(
+    const std::string& path,
+    CheckpointLoadOptions options) {
+  auto contents = std::make_shared<FileContents>(
+      path, options.populate(), options.threads());
+  HeaderReader reader(*contents, path);
+  AT_CHECK(
+      std::memcmp(reader.advance(sizeof(kMagic)), kMagic, sizeof(kMagic)) == 0,
+      "'",
+      path,
+      "' is not a checkpoint file");
+
+  NamedTensors tensors;
+  const auto count = reader.read<uint64_t>();
+  for (uint64_t i = 0; i < count; ++i) {
+    auto name = reader.read_string(reader.read<uint64_t>());
+    const auto dtype = detail::scalarTypeFromId(reader.read<int32_t>());
+    std::vector<int64_t> sizes(reader.read<uint64_t>());
+    for (auto& size : sizes) {
+      size = reader.read<int64_t>();
+    }
+    const auto offset = reader.read<uint64_t>();
+
+    const auto tensor_options = at::TensorOptions().dtype(dtype);
+    int64_t numel = 1;
+    for (auto size : sizes) {
+      numel *= size;
+    }
+    const uint64_t nbytes = numel * tensor_options.type().elementSizeInBytes();
+    AT_CHECK(
+        offset <= contents->size() && nbytes <= contents->size() - offset,
+        "Checkpoint file '",
+        path,
+        "' is truncated");
+    // Every tensor keeps the file contents alive until its storage is freed.
+    auto data = at::from_blob(
+        contents->data() + offset,
+        sizes,
+        [contents](void*) {},
+        tensor_options);
+    tensors.emplace_back(
+        std::move(name), autograd::make_variable(std::move(data)));
+  }
+  return tensors;
+}
+
+void load_checkpoint(
+    const std::string& path,
+    nn::Module& module,
+    CheckpointLoadOptions options) {
+  auto tensors = load_checkpoint(path, options);
+  auto parameters = module.parameters();
+  AT_CHECK(
+      tensors.size() == parameters.size(),
+      "Expected ",
+      parameters.size(),
+      " parameters in checkpoint file '",
+      path,
+      "', but found ",
+      tensors.size());
+  NoGradGuard guard;
+  for (auto& item : tensors) {
+    auto* parameter = parameters.find(item.first);
+    AT_CHECK(
+        parameter != nullptr,
+        "Checkpoint file '",
+        path,
+        "' contains unexpected parameter '",
+        item.first,
+        "'");
+    AT_CHECK(
+        parameter->sizes().equals(item.second.sizes()),
+        "Expected parameter '",
+        item.first,
+        "' of size ",
+        parameter->sizes(),
+        " but checkpoint file '",
+        path,
+        "' has size ",
+        item.second.sizes());
+    auto& variable = autograd::as_variable_ref(*parameter);
+    if (!parameter->is_cuda() && parameter->dtype() == item.second.dtype()) {
+      variable.set_data(autograd::as_variable_ref(item.second).data());
+    } else {
+      variable.data().copy_(autograd::as_variable_ref(item.second).data());
+    }
+  }
+}
+} // namespace torch
@@ -0,0 +1,271 @@
+#include <torch/data/dataloader.h>
+
+#include <torch/data/datasets.h>
+#include <torch/data/example.h>
+#include <torch/data/samplers.h>
+#include <torch/tensor.h>
+#include <torch/utils.h>
+
+#include <torch/csrc/autograd/variable.h>
+#include <torch/csrc/utils/memory.h>
+
+#include <ATen/ATen.h>
+#include <ATen/core/Error.h>
+#include <ATen/core/optional.h>
+#include <ATen/detail/CUDAHooksInterface.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace {
+/// Stacks the tensors of the examples of a batch into a new tensor, which is
+/// allocated in pinned memory if `pin_memory` is true. The tensors must either
+/// all be undefined, or all have the same size.
+Tensor stack_into_batch(const std::vector<Tensor>& tensors, bool pin_memory) {
+  const auto& first = tensors.front();
+  if (!first.defined()) {
+    for (const auto& tensor : tensors) {
+      AT_CHECK(
+          !tensor.defined(),
+          "Expected either all or no examples of a batch to have a target");
+    }
+    return Tensor();
+  }
+
+  auto sizes = first.sizes().vec();
+  sizes.insert(sizes.begin(), tensors.size());
+  Tensor batch;
+  if (pin_memory) {
+    AT_CHECK(
+        first.device().is_cpu(),
+        "Only batches of CPU tensors can be pinned, but got a tensor on ",
+        first.device());
+    auto* allocator = at::detail::getCUDAHooks().getPinnedMemoryAllocator();
+    auto& type = at::getType(at::Backend::CPU, first.type().scalarType());
+    batch = autograd::make_variable(type.tensorWithAllocator(sizes, allocator));
+  } else {
+    batch = torch::empty(sizes, first.options());
+  }
+
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    const auto& tensor = tensors[i];
+    AT_CHECK(
+        tensor.defined() && tensor.sizes().equals(first.sizes()),
+        "Expected all examples of a batch to have size ",
+        first.sizes(),
+        ", but example ",
+        i,
+        tensor.defined() ? " has size " : " is undefined",
+        tensor.defined() ? tensor.sizes() : at::IntList());
+    batch[i].copy_(tensor);
+  }
+  return batch;
+}
+} // namespace
+
+DataLoaderOptions::DataLoaderOptions(size_t batch_size)
+    : batch_size_(batch_size) {}
+
+DataLoader::DataLoader(
+    std::shared_ptr<Dataset> dataset,
+    DataLoaderOptions options,
+    std::unique_ptr<Sampler> sampler)
+    : dataset_(std::move(dataset)),
+      options_(std::move(options)),
+      sampler_(std::move(sampler)) {
+  AT_CHECK(dataset_ != nullptr, "DataLoader requires a dataset");
+  AT_CHECK(options_.batch_size() > 0, "batch_size must be positive");
+  if (!sampler_) {
+    sampler_ = torch::make_unique<SequentialSampler>(dataset_->size());
+  }
+  prefetch_ = std::max<size_t>(
+      options_.prefetch().value_or(2 * options_.workers()), 1);
+  for (size_t i = 0; i < options_.workers(); ++i) {
+    workers_.emplace_back([this] { worker_loop(); });
+  }
+}
+
+DataLoader::~DataLoader() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  jobs_available_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void DataLoader::reset() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobs_.clear();
+    results_.clear();
+    // Jobs that are being loaded right now get dropped once they finish.
+    next_result_ = next_sequence_number_;
+  }
+  sampler_->reset();
+  sampler_exhausted_ = false;
+  if (!workers_.empty()) {
+    issue_jobs();
+  }
+}
+
+at::optional<Example> DataLoader::next() {
+  if (workers_.empty()) {
+    auto indices = next_indices();
+    if (!indices) {
+      return at::nullopt;
+    }
+    return load_batch(*indices);
+  }
+
+  issue_jobs();
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (next_result_ == next_sequence_number_) {
+    return at::nullopt;
+  }
+  result_available_.wait(lock, [this] { return results_.count(next_result_); });
+  auto it = results_.find(next_result_);
+  Result result = std::move(it->second);
+  results_.erase(it);
+  ++next_result_;
+  lock.unlock();
+
+  // Keep the workers busy while the batch is consumed.
+  issue_jobs();
+  if (result.exception) {
+    std::rethrow_exception(result.exception);
+  }
+  return std::move(result.batch);
+}
+
+DataLoader::Iterator DataLoader::begin() {
+  reset();
+  return Iterator(this);
+}
+
+DataLoader::Iterator DataLoader::end() {
+  return Iterator(nullptr);
+}
+
+const DataLoaderOptions& DataLoader::options() const noexcept {
+  return options_;
+}
+
+at::optional<std::vector<size_t>> DataLoader::next_indices() {
+  if (sampler_exhausted_) {
+    return at::nullopt;
+  }
+  auto indices = sampler_->next(options_.batch_size());
+  if (!indices || indices->empty() ||
+      (options_.drop_last() && indices->size() < options_.batch_size())) {
+    sampler_exhausted_ = true;
+    return at::nullopt;
+  }
+  return indices;
+}
+
+void DataLoader::issue_jobs() {
+  // Only the thread calling `next()` issues jobs and advances the sequence
+  // numbers, so they can be read here without holding the lock.
+  while (next_sequence_number_ - next_result_ < prefetch_) {
+    auto indices = next_indices();
+    if (!indices) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      jobs_.push_back(Job{next_sequence_number_++, std::move(*indices)});
+    }
+    jobs_available_.notify_one();
+  }
+}
+
+Example DataLoader::load_batch(const std::vector<size_t>& indices) {
+  NoGradGuard guard;
+  std::vector<Tensor> data, targets;
+  data.reserve(indices.size());
+  targets.reserve(indices.size());
+  for (auto index : indices) {
+    auto example = dataset_->get(index);
+    data.push_back(std::move(example.data));
+    targets.push_back(std::move(example.target));
+  }
+  return Example(
+      stack_into_batch(data, options_.pin_memory()),
+      stack_into_batch(targets, options_.pin_memory()));
+}
+
+void DataLoader::worker_loop() {
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      jobs_available_.wait(lock, [this] { return shutdown_ || !jobs_.empty(); });
+      if (shutdown_) {
+        return;
+      }
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+
+    Result result;
+    try {
+      result.batch = load_batch(job.indices);
+    } catch (...) {
+      result.exception = std::current_exception();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (job.sequence_number < next_result_) {
+        // The loader was reset while the batch was loaded.
+        continue;
+      }
+      results_.emplace(job.sequence_number, std::move(result));
+    }
+    result_available_.notify_all();
+  }
+}
+
+DataLoader::Iterator::Iterator(DataLoader* loader) : loader_(loader) {
+  if (loader_) {
+    batch_ = loader_->next();
+  }
+}
+
+Example& DataLoader::Iterator::operator*() {
+  AT_CHECK(batch_.has_value(), "Dereferencing the end of a DataLoader");
+  return *batch_;
+}
+
+Example* DataLoader::Iterator::operator->() {
+  return &**this;
+}
+
+DataLoader::Iterator& DataLoader::Iterator::operator++() {
+  AT_CHECK(batch_.has_value(), "Incrementing the end of a DataLoader");
+  batch_ = loader_->next();
+  return *this;
+}
+
+bool DataLoader::Iterator::operator==(const Iterator& other) const {
+  if (!batch_.has_value() || !other.batch_.has_value()) {
+    return batch_.has_value() == other.batch_.has_value();
+  }
+  return this == &other;
+}
+
+bool DataLoader::Iterator::operator!=(const Iterator& other) const {
+  return !(*this == other);
+}
+} // namespace data
+} // namespace torch
@@ -0,0 +1,38 @@
+#include <torch/data/datasets.h>
+
+#include <torch/data/example.h>
+#include <torch/tensor.h>
+
+#include <ATen/core/Error.h>
+
+#include <cstddef>
+#include <utility>
+
+namespace torch {
+namespace data {
+
+TensorDataset::TensorDataset(Tensor data, Tensor target)
+    : data_(std::move(data)), target_(std::move(target)) {
+  AT_CHECK(
+      data_.defined() && data_.dim() > 0,
+      "TensorDataset requires a data tensor with at least one dimension");
+  if (target_.defined()) {
+    AT_CHECK(
+        target_.dim() > 0 && target_.size(0) == data_.size(0),
+        "Expected the target tensor to have ",
+        data_.size(0),
+        " examples like the data tensor, but it has size ",
+        target_.sizes());
+  }
+}
+
+Example TensorDataset::get(size_t index) {
+  const auto i = static_cast<int64_t>(index);
+  return Example(data_[i], target_.defined() ? target_[i] : Tensor());
+}
+
+size_t TensorDataset::size() const {
+  return data_.size(0);
+}
+} // namespace data
+} // namespace torch
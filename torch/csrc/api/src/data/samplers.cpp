@@ -0,0 +1,53 @@
+#include <torch/data/samplers.h>
+
+#include <torch/tensor.h>
+
+#include <ATen/core/optional.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+namespace torch {
+namespace data {
+
+SequentialSampler::SequentialSampler(size_t size) : size_(size) {}
+
+void SequentialSampler::reset() {
+  index_ = 0;
+}
+
+at::optional<std::vector<size_t>> SequentialSampler::next(size_t batch_size) {
+  if (index_ >= size_) {
+    return at::nullopt;
+  }
+  std::vector<size_t> indices(std::min(batch_size, size_ - index_));
+  std::iota(indices.begin(), indices.end(), index_);
+  index_ += indices.size();
+  return indices;
+}
+
+RandomSampler::RandomSampler(size_t size) : size_(size) {
+  reset();
+}
+
+void RandomSampler::reset() {
+  const auto permutation = torch::randperm(size_, at::kLong);
+  const auto* data = permutation.data<int64_t>();
+  indices_.assign(data, data + size_);
+  index_ = 0;
+}
+
+at::optional<std::vector<size_t>> RandomSampler::next(size_t batch_size) {
+  if (index_ >= size_) {
+    return at::nullopt;
+  }
+  const auto count = std::min(batch_size, size_ - index_);
+  std::vector<size_t> indices(
+      indices_.begin() + index_, indices_.begin() + index_ + count);
+  index_ += count;
+  return indices;
+}
+} // namespace data
+} // namespace torch
@@ -4,7 +4,9 @@
 #include <torch/tensor.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <mutex>
 #include <queue>
 #include <string>
 #include <vector>
@@ -40,33 +42,41 @@ const T* CursorBase<T>::Item::operator->() const {
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ CursorBase ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+template <typename T>
+CursorBase<T>::CursorBase()
+    : items_(std::make_shared<std::vector<Item>>()) {}
+
 template <typename T>
 CursorBase<T>::CursorBase(std::vector<Item>&& items)
+    : items_(std::make_shared<std::vector<Item>>(std::move(items))) {}
+
+template <typename T>
+CursorBase<T>::CursorBase(std::shared_ptr<std::vector<Item>> items)
     : items_(std::move(items)) {}
 
 template <typename T>
     typename CursorBase<T>::Iterator CursorBase<T>::begin() & noexcept {
-  return items_.begin();
+  return items_->begin();
 }
 
 template <typename T>
 typename CursorBase<T>::ConstIterator CursorBase<T>::begin() const& noexcept {
-  return items_.begin();
+  return items_->begin();
 }
 
 template <typename T>
     typename CursorBase<T>::Iterator CursorBase<T>::end() & noexcept {
-  return items_.end();
+  return items_->end();
 }
 
 template <typename T>
 typename CursorBase<T>::ConstIterator CursorBase<T>::end() const& noexcept {
-  return items_.end();
+  return items_->end();
 }
 
 template <typename T>
 T* CursorBase<T>::find(const std::string& key) noexcept {
-  for (auto& item : items_) {
+  for (auto& item : *items_) {
     if (item.key == key) {
       return &item.value;
     }
@@ -76,7 +86,7 @@ T* CursorBase<T>::find(const std::string& key) noexcept {
 
 template <typename T>
 const T* CursorBase<T>::find(const std::string& key) const noexcept {
-  for (auto& item : items_) {
+  for (auto& item : *items_) {
     if (item.key == key) {
       return &item.value;
     }
@@ -108,7 +118,7 @@ typename CursorBase<T>::Item& CursorBase<T>::at(size_t index) {
       index,
       " is out of range for cursor of size ",
       size());
-  return items_[index];
+  return (*items_)[index];
 }
 
 template <typename T>
@@ -133,7 +143,42 @@ bool CursorBase<T>::contains(const std::string& key) const noexcept {
 
 template <typename T>
 size_t CursorBase<T>::size() const noexcept {
-  return items_.size();
+  return items_->size();
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ CursorCache ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+namespace {
+// Starts at one so that a `CursorCache` that never collected its items (with
+// version zero) is always out of date.
+std::atomic<uint64_t> cursor_cache_version{1};
+} // namespace
+
+void invalidate_cursor_caches() noexcept {
+  ++cursor_cache_version;
+}
+
+template <typename T>
+CursorCache<T>& CursorCache<T>::operator=(const CursorCache&) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  items_.reset();
+  version_ = 0;
+  return *this;
+}
+
+template <typename T>
+template <typename Function>
+std::shared_ptr<typename CursorCache<T>::Items> CursorCache<T>::get(
+    const Function& collect) {
+  // Read the version before collecting, so that a registration that races
+  // with the collection leaves the cache out of date rather than stale.
+  const uint64_t version = cursor_cache_version.load();
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (version_ != version || !items_) {
+    items_ = std::make_shared<Items>(collect());
+    version_ = version;
+  }
+  return items_;
 }
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ CursorCollector ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -204,6 +249,38 @@ struct CursorBase<T>::Collector {
     return std::move(items);
   }
 
+  static CursorCache<Tensor>& parameters_cache(nn::Module& module) {
+    return module.parameters_cache_;
+  }
+  static CursorCache<const Tensor>& parameters_cache(
+      const nn::Module& module) {
+    return module.const_parameters_cache_;
+  }
+  static CursorCache<Tensor>& buffers_cache(nn::Module& module) {
+    return module.buffers_cache_;
+  }
+  static CursorCache<const Tensor>& buffers_cache(
+      const nn::Module& module) {
+    return module.const_buffers_cache_;
+  }
+
+  /// Returns the parameters of the module tree, collecting them only if the
+  /// module's cache is out of date.
+  template <typename ModuleType>
+  static std::shared_ptr<std::vector<Item>> cached_parameters(
+      ModuleType& module) {
+    return parameters_cache(module).get(
+        [&module] { return Collector().collect_parameters(module); });
+  }
+
+  /// Returns the buffers of the module tree, collecting them only if the
+  /// module's cache is out of date.
+  template <typename ModuleType>
+  static std::shared_ptr<std::vector<Item>> cached_buffers(ModuleType& module) {
+    return buffers_cache(module).get(
+        [&module] { return Collector().collect_buffers(module); });
+  }
+
   std::vector<Item> items;
 };
 
@@ -212,6 +289,8 @@ template class CursorBase<nn::Module>;
 template class CursorBase<const nn::Module>;
 template class CursorBase<Tensor>;
 template class CursorBase<const Tensor>;
+template class CursorCache<Tensor>;
+template class CursorCache<const Tensor>;
 } // namespace detail
 
 namespace nn {
@@ -245,11 +324,10 @@ ConstModuleCursor::ConstModuleCursor(const ModuleCursor& cursor)
 // Parameter cursors
 
 ParameterCursor::ParameterCursor(Module& module)
-    : detail::CursorBase<Tensor>(Collector().collect_parameters(module)) {}
+    : detail::CursorBase<Tensor>(Collector::cached_parameters(module)) {}
 
 ConstParameterCursor::ConstParameterCursor(const Module& module)
-    : detail::CursorBase<const Tensor>(Collector().collect_parameters(module)) {
-}
+    : detail::CursorBase<const Tensor>(Collector::cached_parameters(module)) {}
 
 ConstParameterCursor::ConstParameterCursor(const ParameterCursor& cursor)
     : detail::CursorBase<const Tensor>(copy_cursor_items<Item>(cursor)) {}
@@ -257,10 +335,10 @@ ConstParameterCursor::ConstParameterCursor(const ParameterCursor& cursor)
 // Buffer cursors
 
 BufferCursor::BufferCursor(Module& module)
-    : detail::CursorBase<Tensor>(Collector().collect_buffers(module)) {}
+    : detail::CursorBase<Tensor>(Collector::cached_buffers(module)) {}
 
 ConstBufferCursor::ConstBufferCursor(const Module& module)
-    : detail::CursorBase<const Tensor>(Collector().collect_buffers(module)) {}
+    : detail::CursorBase<const Tensor>(Collector::cached_buffers(module)) {}
 
 ConstBufferCursor::ConstBufferCursor(const BufferCursor& cursor)
     : detail::CursorBase<const Tensor>(copy_cursor_items<Item>(cursor)) {}
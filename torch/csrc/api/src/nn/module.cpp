@@ -1,5 +1,6 @@
 #include <torch/nn/module.h>
 
+#include <torch/nn/cloneable.h>
 #include <torch/nn/cursor.h>
 
 #include <torch/csrc/autograd/generated/VariableType.h>
@@ -44,6 +45,11 @@ std::shared_ptr<Module> Module::clone(at::optional<Device> device) const {
       "> instead of torch::nn::Module to inherit the ability to clone.");
 }
 
+std::shared_ptr<Module> Module::shallow_replica() const {
+  detail::SharedParametersGuard guard;
+  return clone();
+}
+
 ModuleCursor Module::modules() {
   return ModuleCursor(*this);
 }
@@ -124,13 +130,109 @@ Tensor& Module::register_parameter(
     Tensor tensor,
     bool requires_grad) {
   tensor.set_requires_grad(requires_grad);
-  return parameters_.insert(std::move(name), std::move(tensor));
+  auto& parameter = parameters_.insert(std::move(name), std::move(tensor));
+  torch::detail::invalidate_cursor_caches();
+  return parameter;
 }
 
 Tensor& Module::register_buffer(std::string name, Tensor tensor) {
-  return buffers_.insert(std::move(name), std::move(tensor));
+  auto& buffer = buffers_.insert(std::move(name), std::move(tensor));
+  torch::detail::invalidate_cursor_caches();
+  return buffer;
+}
+
+Tensor Module::flatten_parameters() {
+  auto params = parameters();
+  AT_CHECK(params.size() > 0, "flatten_parameters() requires parameters");
+  const auto options = params[0]->options();
+  int64_t numel = 0;
+  for (auto& parameter : params) {
+    AT_CHECK(
+        parameter->dtype() == options.dtype() &&
+            parameter->device() == options.device(),
+        "flatten_parameters() requires all parameters to have the same dtype "
+        "and device, but parameter '",
+        parameter.key,
+        "' is ",
+        parameter->type().toString(),
+        " on ",
+        parameter->device(),
+        " while parameter '",
+        params[0].key,
+        "' is ",
+        params[0]->type().toString(),
+        " on ",
+        params[0]->device());
+    numel += parameter->numel();
+  }
+
+  NoGradGuard no_grad;
+  auto flat_data = autograd::Variable(torch::empty({numel}, options)).data();
+  auto flat_grad = autograd::Variable(torch::zeros({numel}, options)).data();
+  int64_t offset = 0;
+  for (auto& parameter : params) {
+    const auto size = parameter->numel();
+    auto data = flat_data.narrow(0, offset, size).view(parameter->sizes());
+    data.copy_(autograd::Variable(*parameter).data());
+    at::detail::set_data(*parameter, data);
+    // The gradients are new variables rather than views of the flat gradient
+    // variable, so that they can still be detached in place by `zero_grad()`.
+    auto grad = flat_grad.narrow(0, offset, size).view(parameter->sizes());
+    if (parameter->grad().defined()) {
+      grad.copy_(autograd::Variable(parameter->grad()).data());
+    }
+    parameter->grad() = autograd::make_variable(grad);
+    offset += size;
+  }
+
+  auto flat = autograd::make_variable(flat_data, /*requires_grad=*/true);
+  flat.grad() = autograd::make_variable(flat_grad);
+  return flat;
 }
 
 void Module::clone_(Module& other, at::optional<Device> device) {}
+
+namespace detail {
+namespace {
+thread_local const ReplicatedTensors* replicated_tensors = nullptr;
+} // namespace
+
+ReplicationGuard::ReplicationGuard(const ReplicatedTensors& tensors)
+    : previous_(replicated_tensors) {
+  replicated_tensors = &tensors;
+}
+
+ReplicationGuard::~ReplicationGuard() {
+  replicated_tensors = previous_;
+}
+
+const Tensor* ReplicationGuard::replicated(
+    const Tensor& tensor,
+    const Device& device) {
+  if (!replicated_tensors || !tensor.defined()) {
+    return nullptr;
+  }
+  auto it = replicated_tensors->find(
+      {tensor.unsafeGetTensorImpl(), device.index()});
+  return it == replicated_tensors->end() ? nullptr : &it->second;
+}
+
+namespace {
+thread_local bool share_parameters = false;
+} // namespace
+
+SharedParametersGuard::SharedParametersGuard()
+    : previous_(share_parameters) {
+  share_parameters = true;
+}
+
+SharedParametersGuard::~SharedParametersGuard() {
+  share_parameters = previous_;
+}
+
+bool SharedParametersGuard::is_enabled() noexcept {
+  return share_parameters;
+}
+} // namespace detail
 } // namespace nn
 } // namespace torch
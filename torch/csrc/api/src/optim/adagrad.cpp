@@ -6,6 +6,7 @@
 #include <ATen/ATen.h>
 
 #include <functional>
+#include <tuple>
 
 namespace torch {
 namespace optim {
@@ -31,6 +32,18 @@ void Adagrad::step() {
         (1.0 + (buffer_at(step_, i) - 1.0) * options.lr_decay_);
 
     auto& sum = buffer_at(sum_, i);
+    if (p.grad().is_sparse() && options.weight_decay_ == 0) {
+      // Only the rows of the parameter and the sum that the gradient touches
+      // change.
+      Tensor rows, values;
+      std::tie(rows, values) = sparse_gradient_rows(p.grad());
+      auto sum_rows = sum.index_select(0, rows).addcmul_(values, values, 1.0);
+      sum.index_copy_(0, rows, sum_rows);
+      NoGradGuard guard;
+      p.index_add_(0, rows, values / sum_rows.sqrt().add_(1e-10) * -clr);
+      continue;
+    }
+
     sum.addcmul_(p.grad(), p.grad(), 1.0);
     const auto std = buffer_at(sum_, i).sqrt().add_(1e-10);
 
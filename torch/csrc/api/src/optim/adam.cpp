@@ -8,6 +8,9 @@
 
 #include <cmath>
 #include <functional>
+#include <map>
+#include <tuple>
+#include <vector>
 
 namespace torch {
 namespace optim {
@@ -16,12 +19,23 @@ AdamOptions::AdamOptions(double learning_rate)
     : learning_rate_(learning_rate) {}
 
 void Adam::step() {
+  std::vector<size_t> fused_indices;
   for (size_t i = 0; i < parameters_.size(); ++i) {
     Tensor p = parameters_.at(i);
     if (!p.grad().defined()) {
       continue;
     }
 
+    if (options.fused_ && !p.grad().is_sparse()) {
+      fused_indices.push_back(i);
+      continue;
+    }
+
+    if (p.grad().is_sparse() && options.weight_decay_ == 0) {
+      sparse_step(p, i);
+      continue;
+    }
+
     if (options.weight_decay_ > 0) {
       p.grad() = p.grad() + options.weight_decay_ * p;
     }
@@ -52,6 +66,93 @@ void Adam::step() {
     NoGradGuard guard;
     p.addcdiv_(exp_average, denom.sqrt() + options.eps_, -step_size);
   }
+  if (!fused_indices.empty()) {
+    fused_step(fused_indices);
+  }
+}
+
+void Adam::fused_step(const std::vector<size_t>& indices) {
+  // The step size depends on the step count, so parameters at different
+  // steps (e.g. ones that went without gradients) are updated separately.
+  std::map<int64_t, std::vector<size_t>> indices_by_step;
+  for (auto i : indices) {
+    indices_by_step[++buffer_at(step_buffers_, i)].push_back(i);
+  }
+
+  NoGradGuard guard;
+  for (const auto& group : indices_by_step) {
+    std::vector<Tensor> params, grads, exp_averages, exp_average_sqs,
+        max_exp_average_sqs;
+    for (auto i : group.second) {
+      params.push_back(parameters_.at(i));
+      grads.push_back(parameters_.at(i).grad());
+      exp_averages.push_back(buffer_at(exp_average_buffers_, i));
+      exp_average_sqs.push_back(buffer_at(exp_average_sq_buffers_, i));
+      if (options.amsgrad_) {
+        max_exp_average_sqs.push_back(
+            buffer_at(max_exp_average_sq_buffers_, i));
+      }
+    }
+
+    const auto bias_correction1 = 1 - std::pow(options.beta1_, group.first);
+    const auto bias_correction2 = 1 - std::pow(options.beta2_, group.first);
+    const auto step_size =
+        options.learning_rate_ * std::sqrt(bias_correction2) / bias_correction1;
+
+    at::_fused_adam_step(
+        params,
+        grads,
+        exp_averages,
+        exp_average_sqs,
+        max_exp_average_sqs,
+        step_size,
+        options.beta1_,
+        options.beta2_,
+        options.eps_,
+        options.weight_decay_,
+        options.amsgrad_);
+  }
+}
+
+/// Lazy Adam, like torch.optim.SparseAdam: the moments of rows that don't
+/// appear in the gradient are left alone rather than decayed, so only the
+/// touched rows of the parameter and its buffers are read and written.
+void Adam::sparse_step(Tensor& p, size_t i) {
+  Tensor rows, values;
+  std::tie(rows, values) = sparse_gradient_rows(p.grad());
+
+  auto& exp_average = buffer_at(exp_average_buffers_, i);
+  auto& exp_average_sq = buffer_at(exp_average_sq_buffers_, i);
+
+  buffer_at(step_buffers_, i) += 1;
+
+  auto exp_average_rows = exp_average.index_select(0, rows)
+                              .mul_(options.beta1_)
+                              .add_(values, 1 - options.beta1_);
+  auto exp_average_sq_rows = exp_average_sq.index_select(0, rows)
+                                 .mul_(options.beta2_)
+                                 .addcmul_(values, values, 1 - options.beta2_);
+  exp_average.index_copy_(0, rows, exp_average_rows);
+  exp_average_sq.index_copy_(0, rows, exp_average_sq_rows);
+
+  Tensor denom_rows = exp_average_sq_rows;
+  if (options.amsgrad_) {
+    auto& max_exp_average_sq = buffer_at(max_exp_average_sq_buffers_, i);
+    denom_rows =
+        torch::max(max_exp_average_sq.index_select(0, rows), exp_average_sq_rows);
+    max_exp_average_sq.index_copy_(0, rows, denom_rows);
+  }
+
+  const auto bias_correction1 =
+      1 - std::pow(options.beta1_, buffer_at(step_buffers_, i));
+  const auto bias_correction2 =
+      1 - std::pow(options.beta2_, buffer_at(step_buffers_, i));
+  const auto step_size =
+      options.learning_rate_ * std::sqrt(bias_correction2) / bias_correction1;
+
+  NoGradGuard guard;
+  p.index_add_(
+      0, rows, exp_average_rows / (denom_rows.sqrt() + options.eps_) * -step_size);
 }
 
 } // namespace optim
@@ -39,6 +39,17 @@ void OptimizerBase::zero_grad() {
 size_t OptimizerBase::size() const noexcept {
   return parameters_.size();
 }
+
+std::pair<Tensor, Tensor> OptimizerBase::sparse_gradient_rows(
+    const Tensor& gradient) {
+  AT_CHECK(
+      gradient._sparseDims() == 1,
+      "Optimizers only support sparse gradients with one sparse dimension, "
+      "but got ",
+      gradient._sparseDims());
+  const auto coalesced = gradient.coalesce();
+  return {coalesced._indices()[0], coalesced._values()};
+}
 } // namespace detail
 } // namespace optim
 } // namespace torch
@@ -6,6 +6,7 @@
 #include <ATen/ATen.h>
 
 #include <functional>
+#include <vector>
 
 namespace torch {
 namespace optim {
@@ -16,12 +17,18 @@ RMSpropOptions::RMSpropOptions(double learning_rate)
 /// Adapted from
 /// https://github.com/pytorch/pytorch/blob/master/torch/optim/rmsprop.py
 void RMSprop::step() {
+  std::vector<size_t> fused_indices;
   for (size_t i = 0; i < parameters_.size(); ++i) {
     Tensor p = parameters_.at(i);
     if (!p.grad().defined()) {
       continue;
     }
 
+    if (options.fused_ && !p.grad().is_sparse()) {
+      fused_indices.push_back(i);
+      continue;
+    }
+
     if (options.weight_decay_ > 0) {
       p.grad() = p.grad() + options.weight_decay_ * p;
     }
@@ -50,6 +57,38 @@ void RMSprop::step() {
       p.addcdiv_(p.grad(), average, -options.learning_rate_);
     }
   }
+  if (!fused_indices.empty()) {
+    fused_step(fused_indices);
+  }
+}
+
+void RMSprop::fused_step(const std::vector<size_t>& indices) {
+  std::vector<Tensor> params, grads, square_averages, momentum_buffers,
+      grad_averages;
+  for (auto i : indices) {
+    params.push_back(parameters_.at(i));
+    grads.push_back(parameters_.at(i).grad());
+    square_averages.push_back(buffer_at(square_average_buffers_, i));
+    if (options.momentum_ > 0) {
+      momentum_buffers.push_back(buffer_at(momentum_buffers_, i));
+    }
+    if (options.centered_) {
+      grad_averages.push_back(buffer_at(grad_average_buffers_, i));
+    }
+  }
+  NoGradGuard guard;
+  at::_fused_rmsprop_step(
+      params,
+      grads,
+      square_averages,
+      momentum_buffers,
+      grad_averages,
+      options.learning_rate_,
+      options.alpha_,
+      options.eps_,
+      options.weight_decay_,
+      options.momentum_,
+      options.centered_);
 }
 } // namespace optim
 } // namespace torch
@@ -6,12 +6,15 @@
 #include <ATen/ATen.h>
 
 #include <functional>
+#include <tuple>
+#include <vector>
 
 namespace torch {
 namespace optim {
 SGDOptions::SGDOptions(double learning_rate) : learning_rate_(learning_rate) {}
 
 void SGD::step() {
+  std::vector<size_t> fused_indices;
   for (size_t i = 0; i < parameters_.size(); ++i) {
     Tensor p = parameters_.at(i);
 
@@ -19,6 +22,21 @@ void SGD::step() {
       continue;
     }
 
+    if (options.fused_ && !p.grad().is_sparse()) {
+      fused_indices.push_back(i);
+      continue;
+    }
+
+    if (p.grad().is_sparse() && options.momentum_ == 0 &&
+        options.weight_decay_ == 0) {
+      // Only the rows touched by the gradient change.
+      Tensor rows, values;
+      std::tie(rows, values) = sparse_gradient_rows(p.grad());
+      NoGradGuard guard;
+      p.index_add_(0, rows, values * -options.learning_rate_);
+      continue;
+    }
+
     auto update = options.learning_rate_ * p.grad();
     if (options.momentum_ != 0) {
       const auto dampening = iteration_ == 0 ? 1 : 1 - options.dampening_;
@@ -40,7 +58,34 @@ void SGD::step() {
     NoGradGuard guard;
     p.add_(-update);
   }
+  if (!fused_indices.empty()) {
+    fused_step(fused_indices);
+  }
   iteration_ += 1;
 }
+
+void SGD::fused_step(const std::vector<size_t>& indices) {
+  std::vector<Tensor> params, grads, momentum_buffers;
+  for (auto i : indices) {
+    params.push_back(parameters_.at(i));
+    grads.push_back(parameters_.at(i).grad());
+    if (options.momentum_ != 0) {
+      momentum_buffers.push_back(buffer_at(momentum_buffers_, i));
+    }
+  }
+  // The buffers start at zero, so the first step without dampening sets
+  // them to the gradients.
+  const auto dampening = iteration_ == 0 ? 0 : options.dampening_;
+  NoGradGuard guard;
+  at::_fused_sgd_step(
+      params,
+      grads,
+      momentum_buffers,
+      options.learning_rate_,
+      options.momentum_,
+      dampening,
+      options.weight_decay_,
+      options.nesterov_);
+}
 } // namespace optim
 } // namespace torch
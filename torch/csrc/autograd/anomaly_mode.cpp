@@ -1,7 +1,26 @@
 #include "torch/csrc/autograd/anomaly_mode.h"
 
+#include <ATen/core/Error.h>
+
 namespace torch { namespace autograd {
 
 bool AnomalyMode::_enabled = 0;
+bool AnomalyMode::_lightweight = 0;
+int64_t AnomalyMode::_stack_every = 1;
+
+void AnomalyMode::set_stack_every(int64_t stack_every) {
+  AT_CHECK(stack_every > 0, "stack_every must be positive, but got ", stack_every);
+  _stack_every = stack_every;
+}
+
+bool AnomalyMode::should_store_stack() {
+  if (_stack_every == 1) {
+    return true;
+  }
+  // Functions are sampled per thread, as they're created by the forward
+  // passes of all threads
+  static thread_local int64_t count = 0;
+  return count++ % _stack_every == 0;
+}
 
 }}
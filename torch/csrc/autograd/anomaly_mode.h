@@ -2,8 +2,25 @@
 
 #include "torch/csrc/WindowsTorchApiMacro.h"
 
+#include <cstdint>
+
 namespace torch { namespace autograd {
 
+// Note [Lightweight anomaly mode]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// The default anomaly mode formats the Python traceback of every forward
+// Function and syncs on a NaN check of every gradient, which is too slow to
+// leave on. In the lightweight mode:
+//
+//  - Functions store their forward stack as ids of interned (file, line,
+//    function) frames, which are only formatted if the stack is printed.
+//  - Every gradient is reduced on its device to a scalar that is 0 if it's
+//    finite, and NaN otherwise. The scalars are checked together once the
+//    backward pass is done, with a single sync per device, and only if one
+//    of them is NaN is the first Function that returned a non-finite gradient
+//    looked up and reported.
+//
+// In both modes, only one in every `stack_every` Functions stores its stack.
 struct AnomalyMode {
   static bool is_enabled() {
     return _enabled;
@@ -12,8 +29,26 @@ struct AnomalyMode {
     _enabled = enabled;
   }
 
+  // See Note [Lightweight anomaly mode]
+  static bool is_lightweight() {
+    return _lightweight;
+  }
+  static void set_lightweight(bool lightweight) {
+    _lightweight = lightweight;
+  }
+
+  static int64_t stack_every() {
+    return _stack_every;
+  }
+  TORCH_API static void set_stack_every(int64_t stack_every);
+
+  // Whether the Function being created should store its forward stack
+  TORCH_API static bool should_store_stack();
+
 private:
  TORCH_API static bool _enabled;
+ TORCH_API static bool _lightweight;
+ TORCH_API static int64_t _stack_every;
 };
 
 
@@ -0,0 +1,21 @@
+#include "torch/csrc/autograd/cpp_hook.h"
+
+#include <utility>
+
+namespace torch { namespace autograd {
+
+CppFunctionPreHook::CppFunctionPreHook(hook_type hook, int value_idx)
+  : hook(std::move(hook))
+  , value_idx(value_idx) {}
+
+auto CppFunctionPreHook::operator()(const variable_list& values) -> variable_list {
+  auto value = hook(values.at(value_idx));
+  if (!value.defined()) {
+    return values;
+  }
+  variable_list results(values);
+  results[value_idx] = std::move(value);
+  return results;
+}
+
+}} // namespace torch::autograd
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "torch/csrc/autograd/function_hook.h"
+#include "torch/csrc/autograd/variable.h"
+
+#include <functional>
+
+namespace torch { namespace autograd {
+
+// Calls a C++ function on the gradient of one of the inputs of a Function,
+// like PyFunctionPreHook does for Python hooks. If the hook returns an
+// undefined Variable, the gradient is left unchanged. Unlike Python hooks,
+// these run without the GIL. See Note [GIL in backward]
+struct CppFunctionPreHook : public FunctionPreHook {
+  using hook_type = std::function<Variable(const Variable&)>;
+
+  CppFunctionPreHook(hook_type hook, int value_idx);
+  variable_list operator()(const variable_list& values) override;
+
+  hook_type hook;
+  int value_idx;
+};
+
+}} // namespace torch::autograd
@@ -4,16 +4,22 @@
 #include "torch/csrc/autograd/functions/basic_ops.h"
 #include "torch/csrc/autograd/grad_mode.h"
 #include "torch/csrc/autograd/anomaly_mode.h"
+#include "torch/csrc/autograd/saved_variable.h"
 #include "torch/csrc/autograd/variable.h"
 
 #include <ATen/DeviceGuard.h>
 #include <ATen/ExpandUtils.h>
+#include <ATen/core/StaticTracepoint.h>
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
 #include <functional>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <set>
@@ -46,6 +52,10 @@ static thread_local int worker_device = NO_DEVICE;
 // gradient checkpointing feature only.
 static thread_local bool checkpoint_valid = true;
 
+// The GIL wait time of the last GraphTask executed by this thread.
+// See Note [GIL in backward]
+static thread_local uint64_t last_gil_wait = 0;
+
 // XXX: Changes to the way multithreading works in execute should be done with
 // great care. Right now the implementation guarantees that a single function's
 // apply will never be entered concurrently (even if multiple graphs are
@@ -53,6 +63,27 @@ static thread_local bool checkpoint_valid = true;
 // engine thread affinity to the device can break this invariant, and we depend
 // on it in a few places (e.g. AccumulateGrad function).
 
+// Note [Ready queue order]
+// ~~~~~~~~~~~~~~~~~~~~~~~~
+// Every device has one worker thread, so the order in which it picks the
+// ready functions of its queue decides how well the devices, and any
+// communication started by hooks, overlap. Ready functions are run:
+//
+//  1. Dummy tasks first, so that the owner of a finished GraphTask wakes up
+//     promptly (see Note [Reentrant backwards]).
+//  2. Then the functions that lead to a function with post hooks. Gradient
+//     accumulators of parameters carry the hooks of e.g.
+//     DistributedDataParallel, which start the reduction of a bucket as soon
+//     as all of its gradients are in.
+//  3. Then the functions with the longest path left below them in the
+//     graph (critical path first), so that a long chain on one device isn't
+//     started after all the short work on another.
+//  4. Ties are broken by the most recently created function first, which
+//     was the only criterion before and keeps the working set small.
+//
+// The priorities of 2. and 3. are computed once per GraphTask by
+// compute_dependencies(), which already visits the whole graph.
+
 struct FunctionTask {
   GraphTask* base;
   std::shared_ptr<Function> fn;
@@ -60,29 +91,97 @@ struct FunctionTask {
   // gradients flowing here.  Once all the dependencies are finished, we
   // use the contents of this buffer to run the function.
   InputBuffer inputs;
+  // See Note [Ready queue order]
+  uint64_t priority;
 
-  FunctionTask(GraphTask* base, std::shared_ptr<Function> fn, InputBuffer inputs)
+  FunctionTask(GraphTask* base, std::shared_ptr<Function> fn, InputBuffer inputs,
+               uint64_t priority = 0)
     : base(base)
     , fn(fn)
-    , inputs(std::move(inputs)) {}
+    , inputs(std::move(inputs))
+    , priority(fn ? priority : std::numeric_limits<uint64_t>::max()) {}
 };
 
 // Returns true when t2 should be (weakly) BEFORE t1 in the queue.
-struct CompareFunctionTaskTime {
+// See Note [Ready queue order]
+struct CompareFunctionTask {
   bool operator()(FunctionTask const & t1, FunctionTask const & t2) {
+    if (t1.priority != t2.priority) {
+      return t1.priority < t2.priority;
+    }
+    if (!t1.fn || !t2.fn) {
+      return false;
+    }
     return t1.fn->sequence_nr() < t2.fn->sequence_nr();
   }
 };
 
+// Note [Ready queue]
+// ~~~~~~~~~~~~~~~~~~
+// A ReadyQueue has many producers (any thread finishing a function whose
+// next function runs on this queue's device) but a single consumer, its
+// worker thread. Producers never take a lock on the fast path: they link
+// their tasks into `inbox`, a lock-free stack, with one compare-and-swap.
+// The worker takes the whole inbox at once, moves it into `heap`, which
+// only it touches, and runs the top of the heap (see Note [Ready queue
+// order]).
+//
+// An idle worker first spins for a short while, since a backward pass that
+// alternates between CPU and CUDA functions hands tasks back and forth
+// every few microseconds, and waking up a sleeping thread costs much more
+// than that. Then it parks on `not_empty`. Producers only take `mutex` to
+// notify the worker if it is parked: `parked` is set before the inbox is
+// checked for the last time, and read after the tasks are linked, so
+// either the worker sees the tasks or the producer sees the worker parked.
 struct ReadyQueue {
-  std::priority_queue<FunctionTask, std::vector<FunctionTask>, CompareFunctionTaskTime> heap;
-  std::condition_variable not_empty;
-  std::mutex mutex;
+  struct Node {
+    FunctionTask task;
+    Node* next;
+  };
+
+  ReadyQueue() : inbox(nullptr), parked(false) {}
+  ~ReadyQueue();
 
   void push(FunctionTask item);
+  // Pushes several tasks with a single compare-and-swap.
+  void push_all(std::vector<FunctionTask>& items);
+  // Must only be called by the worker thread of the queue.
   FunctionTask pop();
+  // Whether pop() would have to wait. Must only be called by the worker
+  // thread of the queue.
+  bool empty();
+
+ private:
+  void link(Node* first, Node* last);
+  bool drain_inbox();
+
+  std::atomic<Node*> inbox;
+  std::atomic<bool> parked;
+  std::condition_variable not_empty;
+  std::mutex mutex;
+  // Owned by the worker thread
+  std::priority_queue<FunctionTask, std::vector<FunctionTask>, CompareFunctionTask> heap;
 };
 
+// Note [GIL in backward]
+// ~~~~~~~~~~~~~~~~~~~~~~
+// Functions implemented in Python, and functions with Python hooks, need the
+// GIL to run (Function::needs_gil()). Acquiring it for every such function
+// makes a backward pass with many of them contend with all the Python threads
+// of the process for every function. Instead, the PythonEngine keeps the GIL
+// across a run of functions that need it, and only releases it before a
+// worker runs a function that doesn't, or would wait for work
+// (thread_before_function()).
+//
+// A worker holding the GIL must not block on anything another thread might
+// hold while waiting for the GIL. The only such thing in the engine is the
+// mutex of a GraphTask, which lock_graph_task() takes after releasing the
+// GIL if it's contended. Hooks registered from C++ (CppFunctionPreHook) don't
+// need the GIL at all.
+//
+// The time the workers spent waiting for the GIL is summed up for each
+// GraphTask, see Engine::last_gil_wait_ns().
+
 // Note [Reentrant backwards]
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~
 // To understand the reentrant backwards problem, we have to notice two
@@ -136,6 +235,20 @@ struct GraphTask {
   std::condition_variable not_done;
   std::unordered_map<Function*, InputBuffer> not_ready;
   std::unordered_map<Function*, int> dependencies;
+  // See Note [Ready queue order]
+  std::unordered_map<Function*, uint64_t> priorities;
+
+  // A scalar per gradient returned by a Function, which is NaN if the
+  // gradient isn't finite. See Note [Lightweight anomaly mode]
+  struct NonfiniteFlag {
+    std::shared_ptr<Function> fn;
+    int output_nr;
+    Variable flag;
+  };
+  std::vector<NonfiniteFlag> nonfinite_flags;
+
+  // See Note [GIL in backward]
+  std::atomic<uint64_t> gil_wait_ns;
 
   struct ExecInfo {
     struct Capture {
@@ -179,25 +292,86 @@ struct GraphTask {
     , not_done()
     , not_ready()
     , dependencies()
+    , priorities()
+    , gil_wait_ns(0)
     , owner(NO_DEVICE) {}
 };
 
-auto ReadyQueue::push(FunctionTask item) -> void {
-  {
+// Number of times an idle worker checks its inbox before parking.
+static constexpr int kReadyQueueSpins = 2000;
+
+ReadyQueue::~ReadyQueue() {
+  Node* node = inbox.exchange(nullptr);
+  while (node) {
+    Node* next = node->next;
+    delete node;
+    node = next;
+  }
+}
+
+auto ReadyQueue::link(Node* first, Node* last) -> void {
+  last->next = inbox.load(std::memory_order_relaxed);
+  while (!inbox.compare_exchange_weak(last->next, first)) {}
+  if (parked.load()) {
     std::lock_guard<std::mutex> lock(mutex);
+    not_empty.notify_one();
+  }
+}
+
+auto ReadyQueue::push(FunctionTask item) -> void {
+  ++item.base->outstanding_tasks;
+  Node* node = new Node{std::move(item), nullptr};
+  link(node, node);
+}
+
+auto ReadyQueue::push_all(std::vector<FunctionTask>& items) -> void {
+  if (items.empty()) return;
+  Node* first = nullptr;
+  Node* last = nullptr;
+  for (auto& item : items) {
     ++item.base->outstanding_tasks;
-    heap.push(std::move(item));
+    first = new Node{std::move(item), first};
+    if (!last) last = first;
   }
-  not_empty.notify_one();
+  link(first, last);
+}
+
+// Moves the tasks of the inbox to the heap. Returns false if it was empty.
+auto ReadyQueue::drain_inbox() -> bool {
+  if (!inbox.load(std::memory_order_relaxed)) return false;
+  Node* node = inbox.exchange(nullptr);
+  while (node) {
+    Node* next = node->next;
+    heap.push(std::move(node->task));
+    delete node;
+    node = next;
+  }
+  return true;
 }
 
 auto ReadyQueue::pop() -> FunctionTask {
-  std::unique_lock<std::mutex> lock(mutex);
-  not_empty.wait(lock, [this]{ return !heap.empty(); });
+  drain_inbox();
+  for (int spin = 0; heap.empty() && spin < kReadyQueueSpins; ++spin) {
+    std::this_thread::yield();
+    drain_inbox();
+  }
+  if (heap.empty()) {
+    std::unique_lock<std::mutex> lock(mutex);
+    parked.store(true);
+    not_empty.wait(lock, [this]{ return inbox.load() != nullptr; });
+    parked.store(false);
+    lock.unlock();
+    drain_inbox();
+  }
   auto task = std::move(const_cast<FunctionTask&>(heap.top())); heap.pop();
   return task;
 }
 
+auto ReadyQueue::empty() -> bool {
+  drain_inbox();
+  return heap.empty();
+}
+
 Engine::Engine() : ready_queues() {
 }
 
@@ -230,8 +404,13 @@ auto Engine::thread_main(GraphTask *graph_task) -> void {
   // Why the test on graph_task->outstanding_tasks?  See
   // Note [Reentrant backwards]
   while (!graph_task || graph_task->outstanding_tasks > 0) {
+    // See Note [GIL in backward]
+    if (queue->empty()) {
+      thread_before_function(nullptr);
+    }
     FunctionTask task = queue->pop();
     if (task.fn && !task.base->has_error.load()) {
+      task.base->gil_wait_ns += thread_before_function(task.fn.get());
       GradMode::set_enabled(task.base->grad_mode);
       try {
         evaluate_function(task);
@@ -246,7 +425,7 @@ auto Engine::thread_main(GraphTask *graph_task) -> void {
     // Task from a non-worker thread. Easy case.
     if (base_owner == NO_DEVICE) {
       if (--task.base->outstanding_tasks == 0) {
-        std::lock_guard<std::mutex> lock(task.base->mutex);
+        auto lock = lock_graph_task(*task.base);
         task.base->not_done.notify_all();
       }
     } else {
@@ -269,8 +448,18 @@ auto Engine::thread_main(GraphTask *graph_task) -> void {
   }
 }
 
+// See Note [GIL in backward]
+auto Engine::lock_graph_task(GraphTask& task) -> std::unique_lock<std::mutex> {
+  std::unique_lock<std::mutex> lock(task.mutex, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    thread_before_function(nullptr);
+    lock.lock();
+  }
+  return lock;
+}
+
 auto Engine::thread_on_exception(FunctionTask& task, std::exception& e) -> void {
-  std::lock_guard<std::mutex> lock(task.base->mutex);
+  auto lock = lock_graph_task(*task.base);
   if (!task.base->has_error.load()) {
     if (AnomalyMode::is_enabled()) {
       task.fn->metadata()->print_stack();
@@ -387,7 +576,7 @@ auto Engine::evaluate_function(FunctionTask& task) -> void {
   if (!exec_info.empty()) {
     auto & fn_info = exec_info.at(task.fn.get());
     if (auto *capture_vec = fn_info.captures.get()) {
-      std::lock_guard<std::mutex> lock(task.base->mutex);
+      auto lock = lock_graph_task(*task.base);
       for (auto capture : *capture_vec) {
         task.base->captured_vars[capture.output_idx] = task.inputs[capture.input_idx];
       }
@@ -395,7 +584,18 @@ auto Engine::evaluate_function(FunctionTask& task) -> void {
     if (!fn_info.needed) return;
   }
 
+  // See Note [Offloading saved variables]
+  if (SavedVariableOffload::is_enabled()) {
+    SavedVariableOffload::prefetch(task.fn->sequence_nr());
+  }
+
+  // The sequence number is the one the op_start probe of the forward op
+  // reported, which lets tracers match backward tasks to forward ops
+  auto* fn_ptr = task.fn.get();
+  auto sequence_nr = fn_ptr->sequence_nr();
+  AT_SDT(autograd_task_start, fn_ptr, sequence_nr);
   auto outputs = call_function(task);
+  AT_SDT(autograd_task_end, fn_ptr, sequence_nr);
 
   auto& fn = *task.fn;
   if (!task.base->keep_graph) {
@@ -405,7 +605,22 @@ auto Engine::evaluate_function(FunctionTask& task) -> void {
   int num_outputs = outputs.size();
   if (num_outputs == 0) return; // Don't even acquire the mutex
 
-  if (AnomalyMode::is_enabled()) {
+  if (AnomalyMode::is_enabled() && AnomalyMode::is_lightweight()) {
+    // x * 0 is 0 for finite x and NaN otherwise. The sums are only read once
+    // the backward pass is done, see Note [Lightweight anomaly mode]
+    AutoGradMode grad_mode(false);
+    std::vector<GraphTask::NonfiniteFlag> flags;
+    for (int i = 0; i < num_outputs; ++i) {
+      auto& output = outputs[i];
+      if (output.defined() && at::isFloatingType(output.type().scalarType())) {
+        at::DeviceGuard guard(output);
+        flags.push_back({task.fn, i, output.mul(0).sum()});
+      }
+    }
+    auto lock = lock_graph_task(*task.base);
+    auto& nonfinite_flags = task.base->nonfinite_flags;
+    std::move(flags.begin(), flags.end(), std::back_inserter(nonfinite_flags));
+  } else if (AnomalyMode::is_enabled()) {
     AutoGradMode grad_mode(false);
     for (int i = 0; i < num_outputs; ++i) {
       auto& output = outputs[i];
@@ -418,7 +633,12 @@ auto Engine::evaluate_function(FunctionTask& task) -> void {
     }
   }
 
-  std::lock_guard<std::mutex> lock(task.base->mutex);
+  // Functions that become ready are queued after the GraphTask lock is
+  // released, with one push per device rather than one per function. That
+  // matters for graphs of many tiny functions, whose cost is dominated by
+  // the synchronization on the queues (see Note [Ready queue]).
+  std::vector<std::pair<int, FunctionTask>> ready;
+  auto lock = lock_graph_task(*task.base);
   for (int i = 0; i < num_outputs; ++i) {
     auto& output = outputs[i];
     const auto& next = fn.next_edge(i);
@@ -451,8 +671,10 @@ auto Engine::evaluate_function(FunctionTask& task) -> void {
       InputBuffer input_buffer(next.function->num_inputs());
       input_buffer.add(next.input_nr, std::move(output));
       if (is_ready) {
-        auto& queue = ready_queue(input_buffer.device());
-        queue.push(FunctionTask(task.base, next.function, std::move(input_buffer)));
+        const auto device = input_buffer.device();
+        ready.emplace_back(device, FunctionTask(
+            task.base, next.function, std::move(input_buffer),
+            task.base->priorities[next.function.get()]));
       } else {
         not_ready.emplace(next.function.get(), std::move(input_buffer));
       }
@@ -461,32 +683,82 @@ auto Engine::evaluate_function(FunctionTask& task) -> void {
       auto &input_buffer = not_ready_it->second;
       input_buffer.add(next.input_nr, std::move(output));
       if (is_ready) {
-        auto& queue = ready_queue(input_buffer.device());
-        queue.push(FunctionTask(task.base, next.function, std::move(input_buffer)));
+        const auto device = input_buffer.device();
+        ready.emplace_back(device, FunctionTask(
+            task.base, next.function, std::move(input_buffer),
+            task.base->priorities[next.function.get()]));
         not_ready.erase(not_ready_it);
       }
     }
   }
+  lock.unlock();
+
+  // The current task is still outstanding, so the GraphTask can't be seen as
+  // finished before these are queued.
+  if (ready.size() == 1) {
+    ready_queue(ready[0].first).push(std::move(ready[0].second));
+    return;
+  }
+  std::vector<FunctionTask> batch;
+  while (!ready.empty()) {
+    const int device = ready.front().first;
+    auto it = std::stable_partition(
+        ready.begin(), ready.end(),
+        [device](const std::pair<int, FunctionTask>& r) { return r.first != device; });
+    batch.clear();
+    for (auto batch_it = it; batch_it != ready.end(); ++batch_it) {
+      batch.push_back(std::move(batch_it->second));
+    }
+    ready.erase(it, ready.end());
+    ready_queue(device).push_all(batch);
+  }
 }
 
-/* Computes the number of dependencies for each function which requires grad */
+// The priority of a function (see Note [Ready queue order]) has the bit
+// kFeedsHookPriority set if a function with post hooks can be reached from
+// it, and the length of the longest path below it in the low bits.
+static constexpr uint64_t kFeedsHookPriority = uint64_t(1) << 62;
+
+/* Computes the number of dependencies and the priority of each function
+ * which requires grad */
 auto Engine::compute_dependencies(Function* root, GraphTask& task) -> void {
-  // Just to make sure that they will never be added to the queue again
-  std::unordered_set<Function*> seen;
-  std::vector<Function*> queue { root };
+  // NB: this is a depth-first traversal with an explicit stack, so that the
+  // priority of a function is computed after those of all its next functions
+  // (the graph is acyclic). `priorities` also records the functions that have
+  // been seen, so they will never be added to the stack again.
+  struct Frame {
+    Frame(Function* fn) : fn(fn), next_edge(0) {}
+    Function* fn;
+    size_t next_edge;
+  };
+  auto& dependencies = task.dependencies;
+  auto& priorities = task.priorities;
+  std::vector<Frame> stack { Frame(root) };
+  priorities.emplace(root, 0);
 
-  // Queue contains all nodes that will start propagating gradients.
   // We no longer have to expand functions that don't require grad.
-  auto& dependencies = task.dependencies;
-  while (queue.size() > 0) {
-    auto fn = queue.back(); queue.pop_back();
-    for (const auto& edge : fn->next_edges()) {
-      if (auto next_ptr = edge.function.get()) {
+  while (!stack.empty()) {
+    auto& frame = stack.back();
+    const auto& next_edges = frame.fn->next_edges();
+    if (frame.next_edge < next_edges.size()) {
+      if (auto next_ptr = next_edges[frame.next_edge++].function.get()) {
         dependencies[next_ptr] += 1;
-        const bool was_inserted = seen.insert(next_ptr).second;
-        if (was_inserted) queue.push_back(next_ptr);
+        const bool was_inserted = priorities.emplace(next_ptr, 0).second;
+        if (was_inserted) stack.emplace_back(next_ptr);
+      }
+      continue;
+    }
+    uint64_t height = 0;
+    bool feeds_hook = !frame.fn->post_hooks().empty();
+    for (const auto& edge : next_edges) {
+      if (auto next_ptr = edge.function.get()) {
+        const auto next_priority = priorities[next_ptr];
+        height = std::max(height, (next_priority & (kFeedsHookPriority - 1)) + 1);
+        feeds_hook = feeds_hook || (next_priority & kFeedsHookPriority);
       }
     }
+    priorities[frame.fn] = height | (feeds_hook ? kFeedsHookPriority : 0);
+    stack.pop_back();
   }
 }
 
@@ -506,6 +778,44 @@ struct ClearCallbacks {
   std::mutex& callbacks_lock;
 };
 
+// Reads the flags of each device in a single sync, and reports the first
+// Function that returned a non-finite gradient.
+// See Note [Lightweight anomaly mode]
+static void check_nonfinite_flags(GraphTask& graph_task) {
+  AutoGradMode grad_mode(false);
+  const auto& flags = graph_task.nonfinite_flags;
+  std::map<std::pair<const at::Type*, int64_t>, std::vector<size_t>> by_device;
+  for (size_t i = 0; i < flags.size(); ++i) {
+    const auto& flag = flags[i].flag;
+    by_device[{&flag.type(), flag.is_cuda() ? flag.get_device() : -1}].push_back(i);
+  }
+  size_t first = flags.size();
+  for (const auto& device : by_device) {
+    const auto& indices = device.second;
+    std::vector<at::Tensor> device_flags;
+    device_flags.reserve(indices.size());
+    for (auto i : indices) {
+      device_flags.push_back(flags[i].flag);
+    }
+    at::DeviceGuard guard(device_flags[0]);
+    auto stacked = at::stack(device_flags);
+    auto nonfinite = stacked.ne(stacked);
+    if (nonfinite.any().toCByte()) {
+      auto position = nonfinite.nonzero()[0][0].toCLong();
+      first = std::min(first, indices[position]);
+    }
+  }
+  if (first == flags.size()) {
+    return;
+  }
+  auto& fn = *flags[first].fn;
+  fn.metadata()->print_stack();
+  std::stringstream ss;
+  ss << "Function '" << fn.name() << "' returned non-finite values in its "
+     << flags[first].output_nr << "th output.";
+  throw std::runtime_error(ss.str());
+}
+
 auto Engine::execute(const edge_list& roots,
                      const variable_list& inputs,
                      bool keep_graph,
@@ -546,6 +856,8 @@ auto Engine::execute(const edge_list& roots,
     thread_main(&graph_task);
   }
 
+  last_gil_wait = graph_task.gil_wait_ns.load();
+
   // Check for an exception while running backwards
   if (graph_task.has_error.load()) {
     std::rethrow_exception(graph_task.exception);
@@ -555,6 +867,10 @@ auto Engine::execute(const edge_list& roots,
     throw std::runtime_error("could not compute gradients for some functions");
   }
 
+  if (!graph_task.nonfinite_flags.empty()) {
+    check_nonfinite_flags(graph_task);
+  }
+
   // Unlocking is necessary, because the callback can register
   // more callbacks (or they can be registered from other threads
   // while it's waiting.
@@ -596,6 +912,10 @@ bool Engine::is_checkpoint_valid() {
   return checkpoint_valid;
 }
 
+uint64_t Engine::last_gil_wait_ns() {
+  return last_gil_wait;
+}
+
 auto Engine::ready_queue(int device) -> ReadyQueue& {
   return *ready_queues.at(device + 1);
 }
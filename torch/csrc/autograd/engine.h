@@ -8,10 +8,12 @@
 #include "torch/csrc/autograd/input_buffer.h"
 #include "torch/csrc/autograd/anomaly_mode.h"
 
+#include <cstdint>
 #include <deque>
 #include <exception>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -51,6 +53,11 @@ struct TORCH_API Engine {
 
   bool is_checkpoint_valid();
 
+  /// Returns the nanoseconds the worker threads spent waiting for the GIL
+  /// during the last call to `execute()` made by the calling thread.
+  /// See Note [GIL in backward]
+  static uint64_t last_gil_wait_ns();
+
 protected:
   void compute_dependencies(Function* root, GraphTask& task);
   void evaluate_function(FunctionTask& task);
@@ -59,6 +66,13 @@ protected:
   virtual void thread_init(int device);
   virtual void thread_main(GraphTask *graph_task);
   virtual void thread_on_exception(FunctionTask& task, std::exception& e);
+  // Called by a worker thread before it runs `fn`, and with nullptr before it
+  // waits. Returns the nanoseconds spent waiting for the GIL.
+  // See Note [GIL in backward]
+  virtual uint64_t thread_before_function(Function* fn) {
+    return 0;
+  }
+  std::unique_lock<std::mutex> lock_graph_task(GraphTask& task);
 
   std::once_flag start_threads_flag;
   std::vector<std::shared_ptr<ReadyQueue>> ready_queues;
@@ -29,6 +29,16 @@ auto Function::name() const -> std::string {
   return at::demangle(typeid(*this).name());
 }
 
+bool Function::needs_gil() const {
+  for (const auto& hook : pre_hooks_) {
+    if (hook->needs_gil()) return true;
+  }
+  for (const auto& hook : post_hooks_) {
+    if (hook->needs_gil()) return true;
+  }
+  return false;
+}
+
 AnomalyMetadata* Function::metadata() noexcept {
   if (!anomaly_metadata_) {
     anomaly_metadata_ = Engine::get_default_engine().make_anomaly_metadata();
@@ -95,7 +95,7 @@ struct TORCH_API Function : std::enable_shared_from_this<Function> {
       edge_list&& next_edges = edge_list())
       : sequence_nr_(sequence_nr),
       next_edges_(std::move(next_edges)) {
-    if (AnomalyMode::is_enabled()) {
+    if (AnomalyMode::is_enabled() && AnomalyMode::should_store_stack()) {
       metadata()->store_stack();
     }
   }
@@ -114,6 +114,11 @@ struct TORCH_API Function : std::enable_shared_from_this<Function> {
   /// function call.
   variable_list operator()(variable_list&& inputs) {
     profiler::RecordFunction rec(this);
+    if (rec.recordsInputs()) {
+      for (auto& input : inputs) {
+        rec.addInput(input);
+      }
+    }
     return apply(std::move(inputs));
   }
 
@@ -290,6 +295,11 @@ struct TORCH_API Function : std::enable_shared_from_this<Function> {
     return false;
   }
 
+  /// Returns true if `apply()` or any hook of this function calls into
+  /// Python, i.e. if the engine has to hold the GIL to run it.
+  /// See Note [GIL in backward]
+  virtual bool needs_gil() const;
+
   /// A `Function` is said to pass state transparently to backward, if the
   /// state consists only of (Saved)Variables and only non-variable objects
   /// that parameterize the operation in some way that defines the graph
@@ -12,11 +12,15 @@ using variable_list = std::vector<Variable>;
 struct FunctionPreHook {
   virtual ~FunctionPreHook() = default;
   virtual variable_list operator()(const variable_list& grads) = 0;
+  // Whether the hook calls into Python. See Note [GIL in backward]
+  virtual bool needs_gil() const { return false; }
 };
 
 struct FunctionPostHook {
   virtual ~FunctionPostHook() = default;
   virtual variable_list operator()(const variable_list& grad_input, const variable_list& grad_output) = 0;
+  // Whether the hook calls into Python. See Note [GIL in backward]
+  virtual bool needs_gil() const { return false; }
 };
 
 }} // namespace torch::autograd
@@ -1,6 +1,7 @@
 #include "torch/csrc/autograd/functions/accumulate_grad.h"
 
 #include "torch/csrc/autograd/grad_mode.h"
+#include "torch/csrc/autograd/input_buffer.h"
 #include "torch/csrc/autograd/variable.h"
 #include "torch/csrc/autograd/functions/basic_ops.h"
 #include "torch/csrc/autograd/functions/tensor.h"
@@ -22,6 +23,13 @@ AccumulateGrad::AccumulateGrad(Variable variable_)
   add_input_metadata(variable);
 }
 
+bool AccumulateGrad::needs_gil() const {
+  for (const auto& hook : variable.hooks()) {
+    if (hook->needs_gil()) return true;
+  }
+  return Function::needs_gil();
+}
+
 auto AccumulateGrad::apply(variable_list&& grads) -> variable_list {
   // XXX: this method is not thread-safe!
   check_input_variables("AccumulateGrad", grads, 1, 0);
@@ -33,14 +41,19 @@ auto AccumulateGrad::apply(variable_list&& grads) -> variable_list {
   if (!variable.requires_grad())
     return {};
 
-  auto new_grad = grads[0];
+  auto new_grad = std::move(grads[0]);
   for (auto& hook : variable.hooks()) {
     new_grad = (*hook)({new_grad})[0];
   }
 
   at::Tensor& grad = variable.grad();
   if (!grad.defined()) {
-    variable.grad() = new_grad.clone();
+    // A gradient that nothing else refers to can be kept without a copy
+    if (is_stealable_gradient(new_grad)) {
+      variable.grad() = std::move(new_grad);
+    } else {
+      variable.grad() = new_grad.clone();
+    }
   } else if (!GradMode::is_enabled()) {
     Variable& grad_variable = as_variable_ref(grad);
     // This case is not strictly necessary, but it makes the first-order only case
@@ -49,7 +62,12 @@ auto AccumulateGrad::apply(variable_list&& grads) -> variable_list {
     // a thing never promised and documented, but used in some hacks seen
     // on the internet.
     if (grad_variable.type().is_sparse() && !new_grad.type().is_sparse()) {
-      grad_variable.data() = new_grad.data() + grad_variable.data();
+      if (is_stealable_gradient(new_grad)) {
+        new_grad.data() += grad_variable.data();
+        grad_variable.data() = new_grad.data();
+      } else {
+        grad_variable.data() = new_grad.data() + grad_variable.data();
+      }
     } else {
       grad_variable.data() += new_grad.data();
     }
@@ -9,6 +9,7 @@ struct AccumulateGrad : public Function {
   explicit AccumulateGrad(Variable variable_);
 
   variable_list apply(variable_list&& grads) override;
+  bool needs_gil() const override;
 
   Variable variable;
 };
@@ -0,0 +1,168 @@
+#include "torch/csrc/autograd/functions/checkpoint.h"
+
+#include "torch/csrc/autograd/engine.h"
+#include "torch/csrc/autograd/functions/utils.h"
+#include "torch/csrc/autograd/grad_mode.h"
+
+#include <ATen/ATen.h>
+#include <ATen/DeviceGuard.h>
+#include <TH/TH.h>
+
+#ifdef USE_CUDA
+#include <THC/THC.h>
+#endif
+
+#include <utility>
+
+namespace torch { namespace autograd {
+
+namespace {
+
+at::Tensor get_cpu_rng_state() {
+  auto state = at::CPU(at::kByte).tensor();
+  auto generator = static_cast<THGenerator*>(
+      at::globalContext().defaultGenerator(at::kCPU).unsafeGetTH());
+  THByteTensor_getRNGState(generator, (THByteTensor*)state.unsafeGetTensorImpl());
+  return state;
+}
+
+void set_cpu_rng_state(const at::Tensor& state) {
+  auto generator = static_cast<THGenerator*>(
+      at::globalContext().defaultGenerator(at::kCPU).unsafeGetTH());
+  THByteTensor_setRNGState(generator, (THByteTensor*)state.unsafeGetTensorImpl());
+}
+
+at::Tensor get_cuda_rng_state(int device) {
+  auto state = at::CPU(at::kByte).tensor();
+#ifdef USE_CUDA
+  at::DeviceGuard guard(device);
+  THCRandom_getRNGState(
+      at::globalContext().lazyInitCUDA(), (THByteTensor*)state.unsafeGetTensorImpl());
+#endif
+  return state;
+}
+
+void set_cuda_rng_state(int device, const at::Tensor& state) {
+#ifdef USE_CUDA
+  at::DeviceGuard guard(device);
+  THCRandom_setRNGState(
+      at::globalContext().lazyInitCUDA(), (THByteTensor*)state.unsafeGetTensorImpl());
+#endif
+}
+
+} // anonymous namespace
+
+CheckpointBackward::CheckpointBackward(
+    CheckpointedFunction fn_,
+    const variable_list& inputs_)
+    : fn(std::move(fn_)) {
+  for (const auto& input : inputs_) {
+    inputs.emplace_back(input, /*is_output=*/false);
+    inputs_require_grad.push_back(input.requires_grad());
+    if (cuda_device == -1 && input.is_cuda()) {
+      cuda_device = input.get_device();
+    }
+  }
+  cpu_rng_state = get_cpu_rng_state();
+  if (cuda_device != -1) {
+    cuda_rng_state = get_cuda_rng_state(cuda_device);
+  }
+}
+
+variable_list CheckpointBackward::apply(variable_list&& grads) {
+  AT_CHECK(
+      Engine::get_default_engine().is_checkpoint_valid(),
+      "Checkpointing is not compatible with .grad(), please use .backward() if possible");
+
+  variable_list detached_inputs;
+  detached_inputs.reserve(inputs.size());
+  for (size_t i = 0; i < inputs.size(); i++) {
+    at::Tensor input = inputs[i].unpack().detach();
+    input.set_requires_grad(inputs_require_grad[i]);
+    detached_inputs.push_back(as_variable_ref(input));
+  }
+
+  // Replay the random numbers of the forward, without disturbing the ones
+  // drawn after it.
+  auto current_cpu_rng_state = get_cpu_rng_state();
+  at::Tensor current_cuda_rng_state;
+  if (cuda_device != -1) {
+    current_cuda_rng_state = get_cuda_rng_state(cuda_device);
+  }
+  set_cpu_rng_state(cpu_rng_state);
+  if (cuda_device != -1) {
+    set_cuda_rng_state(cuda_device, cuda_rng_state);
+  }
+  variable_list outputs;
+  {
+    AutoGradMode enable_grad(true);
+    outputs = fn(detached_inputs);
+  }
+  set_cpu_rng_state(current_cpu_rng_state);
+  if (cuda_device != -1) {
+    set_cuda_rng_state(cuda_device, current_cuda_rng_state);
+  }
+
+  AT_CHECK(
+      outputs.size() == grads.size(),
+      "checkpointed function returned ", outputs.size(), " outputs in "
+      "backward, but ", grads.size(), " in forward");
+  edge_list roots;
+  variable_list root_grads;
+  for (size_t i = 0; i < outputs.size(); i++) {
+    if (outputs[i].defined() && outputs[i].requires_grad() && grads[i].defined()) {
+      roots.push_back(outputs[i].gradient_edge());
+      root_grads.push_back(std::move(grads[i]));
+    }
+  }
+  if (!roots.empty()) {
+    Engine::get_default_engine().execute(
+        roots, root_grads, /*keep_graph=*/false, /*create_graph=*/false);
+  }
+
+  variable_list grad_inputs;
+  grad_inputs.reserve(detached_inputs.size());
+  for (auto& input : detached_inputs) {
+    grad_inputs.push_back(input.grad());
+  }
+  return grad_inputs;
+}
+
+void CheckpointBackward::release_variables() {
+  for (auto& input : inputs) {
+    input.reset_data();
+  }
+}
+
+variable_list checkpoint(
+    const CheckpointedFunction& fn,
+    const variable_list& inputs) {
+  for (size_t i = 0; i < inputs.size(); i++) {
+    AT_CHECK(inputs[i].defined(), "checkpoint: input ", i, " is undefined");
+  }
+  // Without grad mode there is nothing to save. Otherwise the outputs get a
+  // grad_fn even if no input requires grad, since the parameters used by
+  // `fn` may.
+  if (!GradMode::is_enabled()) {
+    return fn(inputs);
+  }
+  // The state of the random number generators is saved before `fn` runs.
+  auto grad_fn = std::make_shared<CheckpointBackward>(fn, inputs);
+  variable_list outputs;
+  {
+    AutoGradMode no_grad(false);
+    outputs = fn(inputs);
+  }
+  grad_fn->set_next_edges(collect_next_edges(inputs));
+  for (auto& output : outputs) {
+    // Outputs may alias inputs, whose history must not be overwritten.
+    if (output.defined()) {
+      at::Tensor detached = output.detach();
+      output = as_variable_ref(detached);
+    }
+    set_history(output, grad_fn);
+  }
+  return outputs;
+}
+
+}} // namespace torch::autograd
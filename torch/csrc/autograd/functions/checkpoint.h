@@ -0,0 +1,55 @@
+#pragma once
+
+#include "torch/csrc/WindowsTorchApiMacro.h"
+#include "torch/csrc/autograd/function.h"
+#include "torch/csrc/autograd/saved_variable.h"
+#include "torch/csrc/autograd/variable.h"
+
+#include <ATen/ATen.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace torch { namespace autograd {
+
+// Note [Checkpointing]
+// ~~~~~~~~~~~~~~~~~~~~
+// checkpoint(fn, inputs) runs `fn` on `inputs` without recording a graph, so
+// none of the activations `fn` computes internally are saved for backward.
+// Only the inputs are saved, together with the state of the random number
+// generators. The outputs get a single CheckpointBackward as their grad_fn,
+// which restores the random number generators, runs `fn` again with grad
+// mode enabled and backpropagates through the new graph with a reentrant
+// call to the engine (see Note [Reentrant backwards]). Parameters used by
+// `fn` get their gradients accumulated by that call.
+//
+// This is the same as torch.utils.checkpoint.checkpoint, and works with
+// backward() but not with grad(). `fn` must compute the same thing both
+// times it is called, except for the random numbers it draws.
+
+using CheckpointedFunction = std::function<variable_list(const variable_list&)>;
+
+struct TORCH_API CheckpointBackward : public Function {
+  CheckpointBackward(CheckpointedFunction fn_, const variable_list& inputs_);
+
+  variable_list apply(variable_list&& grads) override;
+  void release_variables() override;
+
+  CheckpointedFunction fn;
+  std::vector<SavedVariable> inputs;
+  std::vector<bool> inputs_require_grad;
+  // State of the CPU generator, and of the CUDA generator of `cuda_device`
+  // if some of the inputs are on CUDA.
+  at::Tensor cpu_rng_state;
+  at::Tensor cuda_rng_state;
+  int cuda_device = -1;
+};
+
+/// Runs `fn` on `inputs`, recomputing its activations during backward
+/// instead of storing them. See Note [Checkpointing].
+TORCH_API variable_list checkpoint(
+    const CheckpointedFunction& fn,
+    const variable_list& inputs);
+
+}} // namespace torch::autograd
@@ -130,6 +130,41 @@ variable_list Gather::apply(variable_list&& inputs) {
 #endif
 }
 
+ReduceAddCoalesced::ReduceAddCoalesced(
+    const at::Device& destination_device,
+    size_t num_tensors,
+    size_t buffer_size)
+    : destination_device_(destination_device),
+      num_tensors_(num_tensors),
+      buffer_size_(buffer_size) {}
+
+variable_list ReduceAddCoalesced::apply(variable_list&& inputs) {
+  AT_ASSERT(num_tensors_ > 0 && inputs.size() % num_tensors_ == 0);
+  const size_t num_devices = inputs.size() / num_tensors_;
+
+  torch::cuda::tensor_list2d grads(num_devices);
+  for (size_t device = 0; device < num_devices; ++device) {
+    auto& device_grads = grads[device];
+    device_grads.reserve(num_tensors_);
+    for (size_t i = 0; i < num_tensors_; ++i) {
+      const size_t input_nr = device * num_tensors_ + i;
+      auto& grad = inputs[input_nr];
+      if (grad.defined()) {
+        device_grads.push_back(std::move(grad));
+      } else {
+        const auto& metadata = input_metadata(input_nr);
+        device_grads.push_back(at::zeros(
+            metadata.shape(),
+            at::TensorOptions(metadata.type(), metadata.device())));
+      }
+    }
+  }
+
+  auto tensors = torch::cuda::reduce_add_coalesced(
+      grads, destination_device_.index(), buffer_size_);
+  return variable_list(tensors.begin(), tensors.end());
+}
+
 } // namespace autograd
 } // namespace torch
 
@@ -40,6 +40,24 @@ struct Gather : public Function {
   int64_t dim_;
 };
 
+// Sums the gradients of the copies of tensors that were broadcast to several
+// devices (see torch::nn::parallel::replicate()). The inputs are the
+// gradients of num_tensors tensors for each device, device by device, and
+// the outputs are the num_tensors sums on the destination device. Missing
+// gradients count as zeros.
+struct ReduceAddCoalesced : public Function {
+  ReduceAddCoalesced(
+      const at::Device& destination_device,
+      size_t num_tensors,
+      size_t buffer_size = 10485760);
+
+  variable_list apply(variable_list&& inputs) override;
+
+  at::Device destination_device_;
+  size_t num_tensors_;
+  size_t buffer_size_;
+};
+
 } // namespace autograd
 } // namespace torch
 
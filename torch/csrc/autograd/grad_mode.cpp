@@ -11,4 +11,14 @@ bool GradMode::is_enabled() {
 void GradMode::set_enabled(bool enabled) {
   GradMode_enabled = enabled;
 }
+
+thread_local bool InferenceMode_enabled = 0;
+
+bool InferenceMode::is_enabled() {
+  return InferenceMode_enabled;
+}
+
+void InferenceMode::set_enabled(bool enabled) {
+  InferenceMode_enabled = enabled;
+}
 }}
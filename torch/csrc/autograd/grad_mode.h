@@ -21,4 +21,30 @@ struct TORCH_API AutoGradMode {
   bool prev_mode;
 };
 
+// Inference mode is meant for code that runs models without ever calling
+// backward on the results, e.g. serving a model from many threads. On top of
+// what disabling grad mode does, in-place operations do not bump the version
+// counters of the Variables they modify: the counters only exist to detect
+// that a Variable saved for backward was modified, and nothing is saved for
+// backward in inference mode. Consequently, Variables saved by a graph that
+// was built outside of inference mode must not be modified in it.
+// Inference mode does not disable grad mode by itself, use
+// torch::InferenceGuard (torch/csrc/api/include/torch/utils.h) for both.
+struct TORCH_API InferenceMode {
+  static bool is_enabled();
+  static void set_enabled(bool enabled);
+};
+
+// A RAII, thread local (!) guard that enables or disables inference mode upon
+// construction, and sets it back to the original value upon destruction.
+struct TORCH_API AutoInferenceMode {
+  AutoInferenceMode(bool enabled) : prev_mode(InferenceMode::is_enabled()) {
+    InferenceMode::set_enabled(enabled);
+  }
+  ~AutoInferenceMode() {
+    InferenceMode::set_enabled(prev_mode);
+  }
+  bool prev_mode;
+};
+
 }}
@@ -5,6 +5,10 @@
 #include "torch/csrc/autograd/grad_mode.h"
 #include "torch/csrc/autograd/profiler.h"
 #include "torch/csrc/autograd/python_function.h"
+#include "torch/csrc/autograd/saved_variable.h"
+#include "torch/csrc/utils/python_numbers.h"
+
+#include <fstream>
 
 PyObject * THPAutograd_initExtension(PyObject *_unused)
 {
@@ -30,25 +34,69 @@ PyObject * THPAutograd_initExtension(PyObject *_unused)
           "name",
           [](const torch::autograd::profiler::Event& e) { return e.name(); })
       .def("thread_id", &torch::autograd::profiler::Event::thread_id)
+      .def("sequence_nr", &torch::autograd::profiler::Event::sequence_nr)
+      .def(
+          "backward_apply_sequence_nr",
+          &torch::autograd::profiler::Event::backward_apply_sequence_nr)
       .def("device", &torch::autograd::profiler::Event::device)
       .def("cpu_elapsed_us", &torch::autograd::profiler::Event::cpu_elapsed_us)
       .def(
           "cuda_elapsed_us", &torch::autograd::profiler::Event::cuda_elapsed_us)
-      .def("has_cuda", &torch::autograd::profiler::Event::has_cuda);
+      .def("has_cuda", &torch::autograd::profiler::Event::has_cuda)
+      .def("shapes", &torch::autograd::profiler::Event::shapes)
+      .def(
+          "dtypes",
+          [](const torch::autograd::profiler::Event& e) {
+            std::vector<std::string> dtypes;
+            for (auto dtype : e.dtypes()) {
+              dtypes.emplace_back(
+                  dtype == at::ScalarType::Undefined ? "Undefined"
+                                                     : at::toString(dtype));
+            }
+            return dtypes;
+          })
+      .def(
+          "cuda_memory_allocated",
+          &torch::autograd::profiler::Event::cuda_memory_allocated)
+      .def(
+          "cuda_memory_freed", &torch::autograd::profiler::Event::cuda_memory_freed);
   py::enum_<torch::autograd::profiler::ProfilerState>(m,"ProfilerState")
   .value("Disabled", torch::autograd::profiler::ProfilerState::Disabled)
   .value("CPU", torch::autograd::profiler::ProfilerState::CPU)
   .value("CUDA", torch::autograd::profiler::ProfilerState::CUDA)
   .value("NVTX", torch::autograd::profiler::ProfilerState::NVTX);
 
-  m.def("_enable_profiler", torch::autograd::profiler::enableProfiler);
+  m.def(
+      "_enable_profiler",
+      torch::autograd::profiler::enableProfiler,
+      py::arg("state"),
+      py::arg("record_shapes") = false);
   m.def("_disable_profiler", torch::autograd::profiler::disableProfiler);
+  m.def(
+      "_export_chrome_trace",
+      [](const torch::autograd::profiler::thread_event_lists& events,
+         const std::string& path) {
+        std::ofstream out(path);
+        torch::autograd::profiler::exportChromeTrace(events, out);
+        if (!out) {
+          throw std::runtime_error("could not write Chrome trace to " + path);
+        }
+      });
 
   m.def("_push_range", [](const char* name) {
     torch::autograd::profiler::pushRange(name);
   });
   m.def("_pop_range", []() { torch::autograd::profiler::popRange(); });
 
+  m.def(
+      "_enable_saved_variable_offload",
+      torch::autograd::SavedVariableOffload::enable,
+      py::arg("threshold_bytes"),
+      py::arg("prefetch_distance") = 4);
+  m.def(
+      "_disable_saved_variable_offload",
+      torch::autograd::SavedVariableOffload::disable);
+
   Py_RETURN_TRUE;
 }
 
@@ -94,12 +142,52 @@ static PyObject * is_anomaly_mode_enabled(PyObject* _unused, PyObject *arg) {
   END_HANDLE_TH_ERRORS
 }
 
+static PyObject * set_anomaly_lightweight(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (!PyBool_Check(arg)) {
+    throw TypeError("lightweight must be a bool (got %s)", Py_TYPE(arg)->tp_name);
+  }
+  AnomalyMode::set_lightweight(arg == Py_True);
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * is_anomaly_lightweight(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (AnomalyMode::is_lightweight()) {
+    Py_RETURN_TRUE;
+  } else {
+    Py_RETURN_FALSE;
+  }
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * set_anomaly_stack_every(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (!THPUtils_checkLong(arg)) {
+    throw TypeError("stack_every must be an int (got %s)", Py_TYPE(arg)->tp_name);
+  }
+  AnomalyMode::set_stack_every(THPUtils_unpackLong(arg));
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * get_anomaly_stack_every(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  return PyLong_FromLongLong(AnomalyMode::stack_every());
+  END_HANDLE_TH_ERRORS
+}
+
 // autograd methods on torch._C
 static PyMethodDef methods[] = {
   {"set_grad_enabled", (PyCFunction)set_grad_enabled, METH_O, nullptr},
   {"is_grad_enabled", (PyCFunction)is_grad_enabled, METH_NOARGS, nullptr},
   {"set_anomaly_enabled", (PyCFunction)set_anomaly_mode_enabled, METH_O, nullptr},
   {"is_anomaly_enabled", (PyCFunction)is_anomaly_mode_enabled, METH_NOARGS, nullptr},
+  {"_set_anomaly_lightweight", (PyCFunction)set_anomaly_lightweight, METH_O, nullptr},
+  {"_is_anomaly_lightweight", (PyCFunction)is_anomaly_lightweight, METH_NOARGS, nullptr},
+  {"_set_anomaly_stack_every", (PyCFunction)set_anomaly_stack_every, METH_O, nullptr},
+  {"_get_anomaly_stack_every", (PyCFunction)get_anomaly_stack_every, METH_NOARGS, nullptr},
   {nullptr, nullptr, 0, nullptr}
 };
 
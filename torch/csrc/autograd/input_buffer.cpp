@@ -1,6 +1,7 @@
 #include "torch/csrc/autograd/input_buffer.h"
 
 #include "torch/csrc/autograd/functions/basic_ops.h"
+#include "torch/csrc/autograd/grad_mode.h"
 
 #include <ATen/DeviceGuard.h>
 
@@ -10,6 +11,19 @@
 
 namespace torch { namespace autograd {
 
+bool is_stealable_gradient(const Variable& var) {
+  if (GradMode::is_enabled() || var.requires_grad() || var.is_view()) {
+    return false;
+  }
+  const auto& data = var.data();
+  if (data.type().is_sparse() || !data.is_contiguous()) {
+    return false;
+  }
+  // Neither the Variable, its data, nor the storage may be shared
+  return var.unsafeGetTensorImpl()->use_count() == 1 &&
+      data.unsafeGetTensorImpl()->use_count() == 1 &&
+      data.unsafeGetTensorImpl()->storageImpl()->use_count() == 1;
+}
 
 void InputBuffer::add(size_t pos, Variable var) {
   AT_ASSERT(pos < buffer.size());
@@ -21,8 +35,13 @@ void InputBuffer::add(size_t pos, Variable var) {
     buffer[pos] = std::move(var);
   } else {
     at::DeviceGuard device_guard(var);
+    if (is_stealable_gradient(old_var)) {
+      old_var.data() += var.data();
+    } else if (is_stealable_gradient(var)) {
+      var.data() += old_var.data();
+      buffer[pos] = std::move(var);
     // ATen doesn't route sparse additions correctly...
-    if (old_var.type().is_sparse()) {
+    } else if (old_var.type().is_sparse()) {
       buffer[pos] = var + old_var;
     } else {
       buffer[pos] = old_var + var;
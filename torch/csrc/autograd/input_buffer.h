@@ -3,7 +3,9 @@
 // The InputBuffer class accumulates a list of Variables for use by a
 // function. It implements logic to avoid modifying the passed
 // values in-place (adding an input twice will accumulate the result).
-// This behaviour is needed and used only in backward graphs.
+// This behaviour is needed and used only in backward graphs. Buffers that
+// nothing else refers to are reused for the sum (see
+// is_stealable_gradient).
 
 #include <vector>
 #include <utility>
@@ -35,4 +37,10 @@ private:
   std::vector<Variable> buffer;
 };
 
+// Returns true if `var` holds the only reference to its data, so that other
+// gradients can be added to it in-place instead of allocating the sum. Never
+// true while the backward pass is being recorded (create_graph=True), or for
+// sparse and non-contiguous (e.g. expanded) gradients.
+bool is_stealable_gradient(const Variable& var);
+
 }}  // namespace torch::autograd
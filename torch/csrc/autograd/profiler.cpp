@@ -1,16 +1,28 @@
 #include "torch/csrc/autograd/profiler.h"
 #include "torch/csrc/autograd/function.h"
+#ifdef USE_CUDA
+#include "THC/THCCachingAllocator.h"
+#endif
+#include <ATen/core/StaticTracepoint.h>
+#include <iomanip>
 #include <sstream>
+#include <unordered_map>
 
 namespace torch { namespace autograd { namespace profiler {
 
 ProfilerState state = ProfilerState::Disabled;
+bool record_shapes = false;
 uint32_t next_thread_id = 0;
 std::mutex all_event_lists_mutex;
 std::list<std::shared_ptr<RangeEventList>> all_event_lists;
 thread_local std::shared_ptr<RangeEventList> event_list;
 thread_local int32_t thread_id;
 
+// op_input(name, index, dim, sizes) fires for every input of an op that
+// RecordFunction traces; only while a tracer is attached, because the
+// generated code has to pass the inputs for it
+AT_SDT_DEFINE_SEMAPHORE(op_input);
+
 RangeEventList& getEventList() {
   if (!event_list) {
     std::lock_guard<std::mutex> guard(all_event_lists_mutex);
@@ -38,9 +50,24 @@ void mark(std::string name, bool include_cuda /* = true */) {
   }
 }
 
-void pushRange(std::string name) {
+namespace {
+
+void recordCUDAMemory(Event& e) {
+#ifdef USE_CUDA
+  if (record_shapes && state == ProfilerState::CUDA) {
+    int device;
+    TORCH_CUDA_CHECK(cudaGetDevice(&device));
+    e.setCUDAMemory(
+        THCCachingAllocator_totalMemoryAllocated(device),
+        THCCachingAllocator_totalMemoryFreed(device));
+  }
+#endif
+}
+
+// returns the recorded event if the inputs of the range should be added to it
+Event* pushRangeImpl(std::string name, int64_t sequence_nr) {
   if (state == ProfilerState::Disabled) {
-    return;
+    return nullptr;
   }
   if (state == ProfilerState::NVTX) {
 #ifdef USE_CUDA
@@ -49,15 +76,28 @@ void pushRange(std::string name) {
     throw std::logic_error(
         "pushRange called with NVTX tracing, but compiled without CUDA");
 #endif
+    return nullptr;
   } else {
-    getEventList().record(
+    auto& e = getEventList().record(
         EventKind::PushRange,
         std::move(name),
         thread_id,
-        state == ProfilerState::CUDA);
+        state == ProfilerState::CUDA,
+        sequence_nr,
+        RecordFunction::backward_apply_state
+          ? RecordFunction::backward_apply_sequence_nr
+          : -1);
+    recordCUDAMemory(e);
+    return record_shapes ? &e : nullptr;
   }
 }
 
+} // anonymous namespace
+
+void pushRange(std::string name) {
+  pushRangeImpl(std::move(name), -1);
+}
+
 void popRange() {
   if (state == ProfilerState::Disabled) {
     return;
@@ -70,11 +110,12 @@ void popRange() {
         "popRange called with NVTX tracing, but compiled without CUDA");
 #endif
   } else {
-    getEventList().record(
+    auto& e = getEventList().record(
         EventKind::PopRange,
         std::string(),
         thread_id,
         state == ProfilerState::CUDA);
+    recordCUDAMemory(e);
   }
 }
 
@@ -98,16 +139,30 @@ RecordFunction::RecordFunction(const char* name) {
 
 RecordFunction::RecordFunction(const char* name, int64_t current_sequence_nr) 
 {
+  // ops dispatched through VariableType come here, so these probes trace
+  // every op without enabling the profiler
+  op_name_ = name;
+  AT_SDT(op_start, name, current_sequence_nr);
+  probe_inputs_ = AT_SDT_IS_ENABLED(op_input);
   if (state == ProfilerState::Disabled)
     return;
-  std::stringstream s;
-  s << name << ", current seq nr " << current_sequence_nr;
-  if(backward_apply_state)
-    s << ", backward apply seq nr " << backward_apply_sequence_nr;
-  pushRange(std::move(s.str()));
+  // NVTX markers only carry a name, so the sequence numbers go there; the
+  // other modes record them in the Event
+  if (state == ProfilerState::NVTX) {
+    std::stringstream s;
+    s << name << ", current seq nr " << current_sequence_nr;
+    if(backward_apply_state)
+      s << ", backward apply seq nr " << backward_apply_sequence_nr;
+    pushRange(std::move(s.str()));
+    return;
+  }
+  event_ = pushRangeImpl(name, current_sequence_nr);
 }
 
 RecordFunction::~RecordFunction() {
+  if (op_name_) {
+    AT_SDT(op_end, op_name_);
+  }
   if (state == ProfilerState::Disabled)
     return;
   popRange();
@@ -123,7 +178,26 @@ void RecordFunction::set_backward_apply_state(bool state, int64_t backward_apply
 }
 
 void RecordFunction::pushFunctionRange(Function* fn) {
-  pushRange(fn->name());
+  event_ = pushRangeImpl(fn->name(), fn->sequence_nr());
+}
+
+void RecordFunction::addInput(const at::Tensor& input) {
+  if (probe_inputs_) {
+    // an undefined input has dim -1
+    int64_t dim = input.defined() ? input.dim() : -1;
+    const int64_t* sizes = input.defined() ? input.sizes().data() : nullptr;
+    AT_SDT_WITH_SEMAPHORE(op_input, op_name_, num_inputs_, dim, sizes);
+  }
+  num_inputs_++;
+  if (event_) {
+    event_->addInput(input);
+  }
+}
+
+void RecordFunction::addInput(at::TensorList inputs) {
+  for (auto& input : inputs) {
+    addInput(input);
+  }
 }
 
 #ifdef USE_CUDA
@@ -138,7 +212,7 @@ static void onEachDevice(std::function<void(int)> op) {
 }
 #endif
 
-void enableProfiler(ProfilerState new_state) {
+void enableProfiler(ProfilerState new_state, bool new_record_shapes) {
   AT_ASSERT(new_state != ProfilerState::Disabled);
 #ifndef USE_CUDA
   if (new_state == ProfilerState::NVTX)
@@ -148,6 +222,7 @@ void enableProfiler(ProfilerState new_state) {
       throw std::runtime_error("can't change kind of profiling (e.g. NVTX to CPU) while profiler is running");
   }
   state = new_state;
+  record_shapes = new_record_shapes && new_state != ProfilerState::NVTX;
 
 #ifdef USE_CUDA
   if(state == ProfilerState::CUDA) {
@@ -178,6 +253,7 @@ thread_event_lists disableProfiler() {
   ProfilerState old_state = state;
   mark("__stop_profile");
   state = ProfilerState::Disabled;
+  record_shapes = false;
   if (old_state == ProfilerState::NVTX) {
     return thread_event_lists();
   } else {
@@ -199,4 +275,148 @@ thread_event_lists disableProfiler() {
   }
 }
 
+namespace {
+
+void writeJSONString(std::ostream& out, const std::string& str) {
+  out << '"';
+  for (char c : str) {
+    switch (c) {
+      case '"': out << "\\\""; break;
+      case '\\': out << "\\\\"; break;
+      case '\n': out << "\\n"; break;
+      case '\t': out << "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+              << static_cast<int>(c) << std::dec << std::setfill(' ');
+        } else {
+          out << c;
+        }
+    }
+  }
+  out << '"';
+}
+
+struct ChromeTraceWriter {
+  explicit ChromeTraceWriter(std::ostream& out)
+  : out(out) {
+    // timestamps are in us, so keep ns resolution
+    out << std::fixed << std::setprecision(3) << "[";
+  }
+  ~ChromeTraceWriter() {
+    out << "\n]\n";
+  }
+
+  // starts an event and writes the fields every phase has, the caller
+  // writes the rest and calls end()
+  void begin(const std::string& name, const char* phase, double ts, const char* pid, int64_t tid) {
+    out << (first ? "\n" : ",\n") << "{\"name\": ";
+    first = false;
+    writeJSONString(out, name);
+    out << ", \"ph\": \"" << phase << "\", \"ts\": " << ts
+        << ", \"pid\": \"" << pid << "\", \"tid\": " << tid;
+  }
+  void end() {
+    out << "}";
+  }
+
+  std::ostream& out;
+  bool first = true;
+};
+
+} // anonymous namespace
+
+void exportChromeTrace(const thread_event_lists& events, std::ostream& stream) {
+  // '__start_profile' is not guaranteed to be first, so we must find it here
+  const Event* start = nullptr;
+  std::unordered_map<int, const Event*> cuda_starts;
+  for (auto& list : events) {
+    for (auto& e : list) {
+      if (e.name() == "__start_profile") {
+        start = &e;
+      } else if (e.name() == "__cuda_start_event") {
+        cuda_starts[e.device()] = &e;
+      }
+    }
+  }
+  if (!start) {
+    throw std::runtime_error("exportChromeTrace: events do not contain the start of a profile");
+  }
+  // the start events of each device are recorded slightly after the
+  // profiler's own start event, so GPU times are offset by the CPU time
+  // between the two
+  auto cuda_time = [&](const Event& e) {
+    const Event* cuda_start = cuda_starts.at(e.device());
+    return cuda_start->cuda_elapsed_us(e) + start->cpu_elapsed_us(*cuda_start);
+  };
+
+  // write to a buffer, so that the formatting flags of stream are untouched
+  std::stringstream out;
+  {
+    ChromeTraceWriter writer(out);
+    size_t next_flow_id = 0;
+    for (auto& list : events) {
+      std::vector<const Event*> stack;
+      for (auto& e : list) {
+        if (e.kind() == "push") {
+          stack.push_back(&e);
+          continue;
+        } else if (e.kind() != "pop" || stack.empty()) {
+          continue;
+        }
+        const Event& push = *stack.back();
+        stack.pop_back();
+        double ts = start->cpu_elapsed_us(push);
+        writer.begin(push.name(), "X", ts, "CPU functions", push.thread_id());
+        out << ", \"dur\": " << push.cpu_elapsed_us(e) << ", \"args\": {";
+        const char* sep = "";
+        if (push.sequence_nr() >= 0) {
+          out << "\"sequence_nr\": " << push.sequence_nr();
+          sep = ", ";
+        }
+        if (push.backward_apply_sequence_nr() >= 0) {
+          out << sep << "\"backward_apply_sequence_nr\": " << push.backward_apply_sequence_nr();
+          sep = ", ";
+        }
+        if (!push.shapes().empty()) {
+          out << sep << "\"input_shapes\": [";
+          for (size_t i = 0; i < push.shapes().size(); ++i) {
+            out << (i > 0 ? ", [" : "[");
+            for (size_t j = 0; j < push.shapes()[i].size(); ++j) {
+              out << (j > 0 ? ", " : "") << push.shapes()[i][j];
+            }
+            out << "]";
+          }
+          out << "]";
+          sep = ", ";
+        }
+        if (push.cuda_memory_allocated() != e.cuda_memory_allocated() ||
+            push.cuda_memory_freed() != e.cuda_memory_freed()) {
+          out << sep << "\"cuda_memory_allocated\": "
+              << (e.cuda_memory_allocated() - push.cuda_memory_allocated())
+              << ", \"cuda_memory_freed\": "
+              << (e.cuda_memory_freed() - push.cuda_memory_freed());
+        }
+        out << "}";
+        writer.end();
+        if (push.has_cuda()) {
+          double cuda_ts = cuda_time(push);
+          // 's' and 'f' draw a flow arrow from the CPU range to the GPU one
+          writer.begin(push.name(), "s", ts, "CPU functions", push.thread_id());
+          out << ", \"id\": " << next_flow_id << ", \"cat\": \"cpu_to_cuda\"";
+          writer.end();
+          writer.begin(push.name(), "f", cuda_ts, "CUDA functions", push.device());
+          out << ", \"id\": " << next_flow_id << ", \"cat\": \"cpu_to_cuda\"";
+          writer.end();
+          writer.begin(push.name(), "X", cuda_ts, "CUDA functions", push.device());
+          out << ", \"dur\": " << (cuda_time(e) - cuda_ts);
+          writer.end();
+          next_flow_id++;
+        }
+      }
+    }
+  }
+  stream << out.rdbuf();
+}
+
 }}}
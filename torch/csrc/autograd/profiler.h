@@ -45,10 +45,13 @@ enum class EventKind {
 };
 
 struct Event {
-  Event(EventKind kind, std::string name, uint32_t thread_id, bool record_cuda)
+  Event(EventKind kind, std::string name, uint32_t thread_id, bool record_cuda,
+        int64_t sequence_nr = -1, int64_t backward_apply_sequence_nr = -1)
   : kind_(kind)
   , name_(std::move(name))
-  , thread_id_(thread_id) {
+  , thread_id_(thread_id)
+  , sequence_nr_(sequence_nr)
+  , backward_apply_sequence_nr_(backward_apply_sequence_nr) {
 #ifdef USE_CUDA
     if(record_cuda) {
       TORCH_CUDA_CHECK(cudaGetDevice(&device_));
@@ -77,10 +80,20 @@ struct Event {
   uint32_t thread_id() const {
     return thread_id_;
   }
-  double cpu_elapsed_us(const Event & e) {
+  // sequence number of the autograd Function (or of the op that creates
+  // one) this range was recorded for, -1 if there is none
+  int64_t sequence_nr() const {
+    return sequence_nr_;
+  }
+  // sequence number of the Function whose apply() was running in the
+  // backward pass when the event was recorded, -1 outside of the backward
+  int64_t backward_apply_sequence_nr() const {
+    return backward_apply_sequence_nr_;
+  }
+  double cpu_elapsed_us(const Event & e) const {
     return (e.cpu_ns_ - cpu_ns_)/(1000.0);
   }
-  double cuda_elapsed_us(const Event & e) {
+  double cuda_elapsed_us(const Event & e) const {
 #ifdef USE_CUDA
     if(!e.has_cuda() || !has_cuda()) {
       throw std::logic_error("Events were not recorded for CUDA");
@@ -107,15 +120,54 @@ struct Event {
   int device() const {
     return device_;
   }
+  // shapes and scalar types of the inputs of a range, only recorded by
+  // RecordFunction when the profiler is enabled with record_shapes; an
+  // undefined input has an empty shape and an Undefined type
+  void addInput(const at::Tensor& input) {
+    if (input.defined()) {
+      shapes_.push_back(input.sizes().vec());
+      dtypes_.push_back(input.type().scalarType());
+    } else {
+      shapes_.emplace_back();
+      dtypes_.push_back(at::ScalarType::Undefined);
+    }
+  }
+  const std::vector<std::vector<int64_t>>& shapes() const {
+    return shapes_;
+  }
+  const std::vector<at::ScalarType>& dtypes() const {
+    return dtypes_;
+  }
+  // running totals of the bytes the CUDA caching allocator allocated and
+  // freed on the current device, recorded when CUDA profiling with
+  // record_shapes; the difference between a push and its pop is what the
+  // range allocated and freed, including any other thread using the device
+  // at the same time
+  void setCUDAMemory(uint64_t allocated, uint64_t freed) {
+    cuda_memory_allocated_ = allocated;
+    cuda_memory_freed_ = freed;
+  }
+  uint64_t cuda_memory_allocated() const {
+    return cuda_memory_allocated_;
+  }
+  uint64_t cuda_memory_freed() const {
+    return cuda_memory_freed_;
+  }
 private:
   EventKind kind_;
   std::string name_;
   uint32_t thread_id_;
+  int64_t sequence_nr_;
+  int64_t backward_apply_sequence_nr_;
   int64_t cpu_ns_; // signed to allow for negative intervals
 #ifdef USE_CUDA
   cudaEvent_t event = nullptr;
 #endif
   int device_ = -1;
+  std::vector<std::vector<int64_t>> shapes_;
+  std::vector<at::ScalarType> dtypes_;
+  uint64_t cuda_memory_allocated_ = 0;
+  uint64_t cuda_memory_freed_ = 0;
 };
 
 // a linked-list of fixed sized vectors, to avoid
@@ -135,12 +187,15 @@ struct RangeEventList {
     blocks.front().reserve(num_block_elements);
   }
 
+  // the returned Event stays valid until consolidate() is called, since
+  // blocks are never reallocated
   template<typename... Args>
-  void record(Args&&... args) {
+  Event& record(Args&&... args) {
     if (blocks.empty() || blocks.front().size() == num_block_elements) {
       allocBlock();
     }
     blocks.front().emplace_back(std::forward<Args>(args)...);
+    return blocks.front().back();
   }
 
   std::vector<Event> consolidate() {
@@ -180,19 +235,46 @@ struct TORCH_API RecordFunction {
 
   ~RecordFunction();
 
+  // Whether the profiler or a tracer attached to the op_input probe records
+  // the inputs of this range, in which case they should be passed to
+  // addInput() right after construction.
+  bool recordsInputs() const {
+    return event_ != nullptr || probe_inputs_;
+  }
+  void addInput(const at::Tensor& input);
+  void addInput(at::TensorList inputs);
+
   // Needed only because we don't have Function defined yet.
   void pushFunctionRange(Function *fn);
 
   static thread_local bool backward_apply_state;
   static thread_local int64_t backward_apply_sequence_nr;
   static void set_backward_apply_state(bool state, int64_t backward_apply_nr = -1);
+
+private:
+  // the PushRange event of this range, if its inputs are recorded
+  Event* event_ = nullptr;
+  // name of the op this range dispatches, for the op_end probe
+  const char* op_name_ = nullptr;
+  bool probe_inputs_ = false;
+  int64_t num_inputs_ = 0;
 };
 
 using thread_event_lists = std::vector<std::vector<Event>>;
 // NOTE: changing profiler modes is **NOT THREAD SAFE**. You should ensure that
 // there no autograd functions are being executed when these function are used.
-TORCH_API void enableProfiler(ProfilerState new_state);
+// With record_shapes, ops also record the shapes and types of their inputs
+// and, when profiling CUDA, the bytes the caching allocator allocates and
+// frees while they run. This adds overhead to every op, so it is off by default.
+TORCH_API void enableProfiler(ProfilerState new_state, bool record_shapes = false);
 TORCH_API thread_event_lists disableProfiler();
 
+// Writes the ranges in events, as returned by disableProfiler(), in the
+// Chrome trace event format, which chrome://tracing and Perfetto can load.
+// Times are in microseconds since the profiler was enabled. CUDA events
+// are recorded without synchronizing and are only waited on here, so
+// exporting a CUDA profile synchronizes with all work it recorded.
+TORCH_API void exportChromeTrace(const thread_event_lists& events, std::ostream& out);
+
 } // namespace profiler
 }} // namespace torch::autograd
@@ -5,12 +5,65 @@
 #include "torch/csrc/utils/object_ptr.h"
 #include "torch/csrc/Exceptions.h"
 
+#include <frameobject.h>
+
 #include <iostream>
+#include <sstream>
+#include <unordered_map>
+#include <utility>
 
 namespace torch { namespace autograd {
 
+namespace {
+
+// The (code object, line) of every frame seen by the lightweight mode, which
+// Functions refer to by index. The table holds a reference to the code
+// objects so that their addresses aren't reused. Only accessed with the GIL.
+struct FrameTable {
+  struct Hash {
+    size_t operator()(const std::pair<PyObject*, int>& key) const {
+      return std::hash<PyObject*>()(key.first) ^ (static_cast<size_t>(key.second) << 1);
+    }
+  };
+
+  uint32_t intern(PyObject* code, int line) {
+    auto key = std::make_pair(code, line);
+    auto it = ids.find(key);
+    if (it != ids.end()) {
+      return it->second;
+    }
+    Py_INCREF(code);
+    uint32_t id = frames.size();
+    frames.push_back(key);
+    ids.emplace(key, id);
+    return id;
+  }
+
+  std::vector<std::pair<PyObject*, int>> frames;
+  std::unordered_map<std::pair<PyObject*, int>, uint32_t, Hash> ids;
+};
+
+FrameTable& frame_table() {
+  // leaked, as the code objects can't be released after the interpreter
+  // shut down
+  static FrameTable* table = new FrameTable();
+  return *table;
+}
+
+} // namespace
+
 void PyAnomalyMetadata::store_stack() {
   AutoGIL gil;
+  if (AnomalyMode::is_lightweight()) {
+    auto& table = frame_table();
+    frames_.clear();
+    for (PyFrameObject* frame = PyEval_GetFrame(); frame; frame = frame->f_back) {
+      frames_.push_back(table.intern(
+          reinterpret_cast<PyObject*>(frame->f_code), PyFrame_GetLineNumber(frame)));
+    }
+    return;
+  }
+
   THPObjectPtr mod(PyImport_ImportModule("traceback"));
   if (!mod) {
     throw python_error();
@@ -28,6 +81,20 @@ void PyAnomalyMetadata::store_stack() {
 
 void PyAnomalyMetadata::print_stack() {
   AutoGIL gil;
+  if (!frames_.empty()) {
+    // Formatted like traceback.format_stack(), without the source lines
+    const auto& table = frame_table();
+    std::ostringstream ss;
+    for (auto it = frames_.rbegin(); it != frames_.rend(); ++it) {
+      const auto& frame = table.frames[*it];
+      auto code = reinterpret_cast<PyCodeObject*>(frame.first);
+      ss << "  File \"" << THPUtils_unpackString(code->co_filename) << "\", line "
+         << frame.second << ", in " << THPUtils_unpackString(code->co_name) << "\n";
+    }
+    AT_WARN("Traceback of forward call that caused the error:\n", ss.str());
+    return;
+  }
+
   if (!PyDict_Check(dict())) {
     throw std::runtime_error("Anomaly metadata is not a python dictionary.");
   }
@@ -35,7 +102,8 @@ void PyAnomalyMetadata::print_stack() {
   THPObjectPtr stack(PyDict_GetItemString(dict(), ANOMALY_TRACE_KEY));
   if (!stack) {
     AT_WARN("No forward pass information available. Enable detect anomaly "
-            "during forward pass for more information.");
+            "during forward pass for more information, and set stack_every to 1 "
+            "to store the stack of every forward call.");
     return;
   }
 
@@ -4,6 +4,9 @@
 #include "torch/csrc/python_headers.h"
 #include "torch/csrc/utils/auto_gil.h"
 
+#include <cstdint>
+#include <vector>
+
 namespace torch { namespace autograd {
 
 struct PyAnomalyMetadata : public AnomalyMetadata {
@@ -26,6 +29,9 @@ struct PyAnomalyMetadata : public AnomalyMetadata {
 
 private:
   PyObject* dict_;
+  // Interned frames, innermost first, in the lightweight mode.
+  // See Note [Lightweight anomaly mode]
+  std::vector<uint32_t> frames_;
 };
 
 }}
@@ -13,6 +13,7 @@
 #include <pthread.h>
 #endif
 
+#include <chrono>
 #include <unordered_set>
 #include <memory> // for unique_ptr
 
@@ -39,6 +40,48 @@ void PythonEngine::thread_init(int device) {
   Engine::thread_init(device);
 }
 
+namespace {
+
+// The GIL held by a worker thread across functions.
+// See Note [GIL in backward]
+struct HeldGIL {
+  bool held = false;
+  PyGILState_STATE state;
+};
+
+thread_local HeldGIL held_gil;
+
+} // namespace
+
+void PythonEngine::thread_main(GraphTask *graph_task) {
+  // A reentrant backward (see Note [Reentrant backwards]) is started by a
+  // function that needs the GIL, but THPEngine_run_backward released it
+  // before getting here
+  auto outer = held_gil;
+  held_gil = HeldGIL();
+  Engine::thread_main(graph_task);
+  thread_before_function(nullptr);
+  held_gil = outer;
+}
+
+uint64_t PythonEngine::thread_before_function(Function* fn) {
+  if (fn && fn->needs_gil()) {
+    if (held_gil.held) {
+      return 0;
+    }
+    auto start = std::chrono::steady_clock::now();
+    held_gil.state = PyGILState_Ensure();
+    held_gil.held = true;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+  }
+  if (held_gil.held) {
+    held_gil.held = false;
+    PyGILState_Release(held_gil.state);
+  }
+  return 0;
+}
+
 void PythonEngine::thread_on_exception(FunctionTask& task, std::exception& e) {
   auto python_err = dynamic_cast<python_error*>(&e);
   if (python_err) {
@@ -211,6 +254,12 @@ PyObject* THPEngine_is_checkpoint_valid(PyObject *self) {
   END_HANDLE_TH_ERRORS
 }
 
+PyObject* THPEngine_last_gil_wait_time(PyObject *self) {
+  HANDLE_TH_ERRORS
+  return PyFloat_FromDouble(Engine::last_gil_wait_ns() * 1e-9);
+  END_HANDLE_TH_ERRORS
+}
+
 PyObject *THPEngine_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
 {
   return type->tp_alloc(type, 0);
@@ -220,6 +269,7 @@ static struct PyMethodDef THPEngine_methods[] = {
   {(char*)"run_backward", (PyCFunction)THPEngine_run_backward, METH_VARARGS | METH_KEYWORDS, nullptr},
   {(char*)"queue_callback", (PyCFunction)THPEngine_queue_callback, METH_O, nullptr},
   {(char*)"is_checkpoint_valid", (PyCFunction)THPEngine_is_checkpoint_valid, METH_NOARGS, nullptr},
+  {(char*)"last_gil_wait_time", (PyCFunction)THPEngine_last_gil_wait_time, METH_NOARGS, nullptr},
   {nullptr}
 };
 
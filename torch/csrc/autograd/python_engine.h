@@ -12,6 +12,7 @@ namespace torch { namespace autograd { namespace python {
 
 struct PythonEngine : public Engine {
   virtual void thread_init(int device) override;
+  virtual void thread_main(GraphTask *graph_task) override;
   virtual void thread_on_exception(FunctionTask& task, std::exception& e) override;
   virtual variable_list execute(
       const edge_list& roots,
@@ -20,6 +21,9 @@ struct PythonEngine : public Engine {
       bool create_graph,
       const edge_list& outputs = {}) override;
   virtual std::unique_ptr<AnomalyMetadata> make_anomaly_metadata() override;
+
+protected:
+  virtual uint64_t thread_before_function(Function* fn) override;
 };
 
 }}} // namespace torch::autograd::python
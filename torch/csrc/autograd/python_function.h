@@ -44,6 +44,9 @@ struct PyFunction : public Function {
   virtual std::string name() const override;
   virtual std::shared_ptr<Function> get_shared_ptr() override;
   virtual bool is_traceable() override;
+  virtual bool needs_gil() const override {
+    return true;
+  }
 
   // THPFunction this Function is wrapping.
   PyObject* obj;
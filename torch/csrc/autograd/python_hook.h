@@ -10,6 +10,7 @@ struct PyFunctionPreHook : public FunctionPreHook {
   PyFunctionPreHook(PyObject* dict, int value_idx);
   ~PyFunctionPreHook();
   variable_list operator()(const variable_list& values) override;
+  bool needs_gil() const override { return true; }
   PyObject* dict;
   int value_idx;
 };
@@ -18,6 +19,7 @@ struct PyFunctionPostHook : public FunctionPostHook {
   PyFunctionPostHook(PyObject* dict);
   ~PyFunctionPostHook();
   variable_list operator()(const variable_list& outputs, const variable_list& inputs) override;
+  bool needs_gil() const override { return true; }
   PyObject* dict;
 };
 
@@ -362,6 +362,13 @@ int THPVariable_setitem(PyObject* self, PyObject* index, PyObject* py_value) {
     return 0;
   }
 
+  // Keep Python numbers on the CPU: index_put_ fills boolean masks with them
+  // without reading the value back from the device (see Note [Masked fill
+  // fast path] in ATen/native/Indexing.cpp).
+  if (!THPVariable_Check(py_value) && self_.type().is_cuda()) {
+    value = valueToTensor(self_.type().toBackend(Backend::CPU), py_value);
+  }
+
   IntList slicedValueSizes = slicePrefix1sSize(value.sizes());
   torch::autograd::Variable valuesSliced;
   if (!value.sizes().equals(slicedValueSizes)) {
@@ -5,13 +5,209 @@
 #include "torch/csrc/autograd/variable.h"
 
 #include <ATen/Tensor.h>
+#include <ATen/DeviceGuard.h>
 
+#ifdef USE_CUDA
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/CUDAEvent.h>
+#include <ATen/cuda/CUDAGuard.h>
+#include <ATen/detail/CUDAHooksInterface.h>
+#include <THC/THCCachingAllocator.h>
+#include <THC/THCCachingHostAllocator.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <list>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace torch { namespace autograd {
 
+// Note [Offloading saved variables]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// With SavedVariableOffload enabled, a SavedVariable whose data is a dense
+// CUDA tensor of at least the threshold size is copied to pinned CPU memory
+// on a side stream of its device as soon as it is saved, and only keeps
+// the CPU copy. Leaves are never offloaded, since parameters and inputs are
+// kept alive by their owners anyway.
+//
+// The position of the tensor in the backward pass is recorded as the
+// sequence number of the function that saves it, which is the most recently
+// created function of the thread. Before the engine runs a function, it
+// calls SavedVariableOffload::prefetch(), which starts the copy back to the
+// GPU, on the same side stream, for every tensor saved at most
+// `prefetch_distance` sequence numbers before it. Backward runs in roughly
+// decreasing sequence number order, so the copies overlap with the
+// functions in between. unpack() makes the current stream wait for the
+// copy, and starts it itself if the tensor wasn't prefetched (e.g. because
+// the ready queue order deviated from the sequence numbers).
+//
+// The CPU copy is contiguous, so strides of saved views aren't preserved.
+// That is fine since unpacked variables are never modified in-place.
+struct OffloadedData {
+#ifdef USE_CUDA
+  explicit OffloadedData(int64_t device) : device(device) {}
+
+  std::mutex mutex;
+  int64_t device;
+  // Pinned CPU copy of the data
+  at::Tensor cpu;
+  // Set once the copy back to the GPU has been started
+  at::Tensor cuda;
+  // Recorded on the side stream after the latest copy
+  at::cuda::CUDAEvent copied;
+#endif
+};
+
+namespace {
+
+std::atomic<int64_t> offload_threshold {0};
+std::atomic<int64_t> offload_prefetch_distance {0};
+
+#ifdef USE_CUDA
+struct OffloadRegistry {
+  std::mutex mutex;
+  // Offloaded tensors that haven't been prefetched, by position
+  std::multimap<uint64_t, std::weak_ptr<OffloadedData>> pending;
+  size_t sweep_size = 1024;
+};
+
+OffloadRegistry& offload_registry() {
+  static OffloadRegistry registry;
+  return registry;
+}
+
+at::cuda::CUDAStream offload_stream(int64_t device) {
+  static std::once_flag init_flag;
+  static std::vector<at::cuda::CUDAStream> streams;
+  std::call_once(init_flag, [] {
+    const auto num_gpus = at::cuda::getNumGPUs();
+    for (int64_t i = 0; i < num_gpus; ++i) {
+      at::DeviceGuard guard(i);
+      streams.push_back(at::cuda::createCUDAStream());
+    }
+  });
+  return streams.at(device);
+}
+
+// The caller must hold data.mutex
+void start_prefetch(OffloadedData& data) {
+  if (data.cuda.defined()) return;
+  at::DeviceGuard device_guard(data.device);
+  auto stream = offload_stream(data.device);
+  at::cuda::CUDAGuard stream_guard(stream);
+  data.cuda = data.cpu.type().toBackend(at::Backend::CUDA).tensor(data.cpu.sizes());
+  data.cuda.copy_(data.cpu, /*non_blocking=*/true);
+  data.copied.record(stream);
+  THCCachingHostAllocator_recordEvent(data.cpu.data_ptr(), stream.internals());
+}
+
+std::shared_ptr<OffloadedData> offload(const at::Tensor& tensor) {
+  const auto device = tensor.get_device();
+  at::DeviceGuard device_guard(device);
+  auto stream = offload_stream(device);
+  auto data = std::make_shared<OffloadedData>(device);
+
+  // The copy must not start before the tensor has been computed
+  at::cuda::CUDAEvent computed;
+  computed.record();
+  stream.synchronize_with(computed);
+
+  at::cuda::CUDAGuard stream_guard(stream);
+  auto* allocator = at::detail::getCUDAHooks().getPinnedMemoryAllocator();
+  data->cpu = tensor.type().toBackend(at::Backend::CPU)
+                  .tensorWithAllocator(tensor.sizes(), allocator);
+  data->cpu.copy_(tensor, /*non_blocking=*/true);
+  data->copied.record(stream);
+  // Keeps the memory of the tensor from being reused before the copy is done
+  THCCachingAllocator_recordStream(
+      tensor.storage()->pImpl()->data(), stream.internals());
+  return data;
+}
+
+at::Tensor fetch(OffloadedData& data) {
+  std::lock_guard<std::mutex> lock(data.mutex);
+  start_prefetch(data);
+  auto current = at::cuda::getCurrentCUDAStreamOnDevice(data.device);
+  current.synchronize_with(data.copied);
+  // data.cuda was allocated on the side stream
+  THCCachingAllocator_recordStream(data.cuda.data_ptr(), current.internals());
+  return data.cuda;
+}
+
+bool should_offload(const Variable& variable, const at::Tensor& data) {
+  const auto threshold = offload_threshold.load(std::memory_order_relaxed);
+  if (threshold <= 0 || variable.is_leaf()) return false;
+  if (!data.is_cuda() || data.is_sparse()) return false;
+  return static_cast<int64_t>(data.numel() * data.type().elementSizeInBytes()) >= threshold;
+}
+
+void register_offloaded(const std::shared_ptr<OffloadedData>& data) {
+  auto position = Function::get_next_sequence_nr() - 1;
+  auto& registry = offload_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.pending.emplace(position, data);
+  // Graphs that are never differentiated leave expired entries behind
+  if (registry.pending.size() >= registry.sweep_size) {
+    for (auto it = registry.pending.begin(); it != registry.pending.end();) {
+      it = it->second.expired() ? registry.pending.erase(it) : std::next(it);
+    }
+    registry.sweep_size = std::max<size_t>(1024, 2 * registry.pending.size());
+  }
+}
+#endif
+
+} // anonymous namespace
+
+void SavedVariableOffload::enable(int64_t threshold_bytes, int64_t prefetch_distance) {
+  if (threshold_bytes <= 0) {
+    throw std::runtime_error("offload threshold must be positive");
+  }
+  if (prefetch_distance < 0) {
+    throw std::runtime_error("prefetch distance must be non-negative");
+  }
+  offload_prefetch_distance = prefetch_distance;
+  offload_threshold = threshold_bytes;
+}
+
+void SavedVariableOffload::disable() {
+  offload_threshold = 0;
+}
+
+bool SavedVariableOffload::is_enabled() {
+  return offload_threshold.load(std::memory_order_relaxed) > 0;
+}
+
+void SavedVariableOffload::prefetch(uint64_t sequence_nr) {
+#ifdef USE_CUDA
+  auto& registry = offload_registry();
+  std::vector<std::shared_ptr<OffloadedData>> to_prefetch;
+  {
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    if (registry.pending.empty()) return;
+    const uint64_t distance = offload_prefetch_distance.load(std::memory_order_relaxed);
+    const uint64_t first = sequence_nr > distance ? sequence_nr - distance : 0;
+    // Tensors after sequence_nr belong to functions that should have run
+    // already; prefetch them too if they are still alive.
+    auto begin = registry.pending.lower_bound(first);
+    for (auto it = begin; it != registry.pending.end(); ++it) {
+      if (auto data = it->second.lock()) {
+        to_prefetch.push_back(std::move(data));
+      }
+    }
+    registry.pending.erase(begin, registry.pending.end());
+  }
+  for (auto& data : to_prefetch) {
+    std::lock_guard<std::mutex> lock(data->mutex);
+    start_prefetch(*data);
+  }
+#endif
+}
+
 SavedVariable::SavedVariable(const Variable& variable, bool is_output) {
   if (variable.defined()) {
     was_default_constructed_ = false;
@@ -21,6 +217,13 @@ SavedVariable::SavedVariable(const Variable& variable, bool is_output) {
     // These copies are all shared_ptr copies, so slightly more expensive.
     // Do them here instead of in the init list in case data is undefined.
     data_ = variable.data();
+#ifdef USE_CUDA
+    if (should_offload(variable, data_)) {
+      offloaded_ = offload(data_);
+      register_offloaded(offloaded_);
+      data_.reset();
+    }
+#endif
     if (variable.is_leaf()) {
       grad_accumulator_ = variable.grad_accumulator();
     } else if (!is_output) {
@@ -32,7 +235,13 @@ SavedVariable::SavedVariable(const Variable& variable, bool is_output) {
 }
 
 Variable SavedVariable::unpack(std::shared_ptr<Function> saved_for) const {
-  if (!data_.defined()) {
+  at::Tensor data = data_;
+#ifdef USE_CUDA
+  if (offloaded_) {
+    data = fetch(*offloaded_);
+  }
+#endif
+  if (!data.defined()) {
     if (!was_default_constructed_) {
       throw std::runtime_error(ERR_BACKWARD_TWICE);
     }
@@ -60,9 +269,9 @@ Variable SavedVariable::unpack(std::shared_ptr<Function> saved_for) const {
   // in-place functions on unpacked variables.
   Variable var;
   if (grad_fn) {
-    var = make_variable(data_, Edge(std::move(grad_fn), output_nr_));
+    var = make_variable(data, Edge(std::move(grad_fn), output_nr_));
   } else {
-    var = make_variable(data_, requires_grad_);
+    var = make_variable(data, requires_grad_);
   }
   var.set_version_counter(saved_version_);
 
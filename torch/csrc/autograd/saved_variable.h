@@ -13,6 +13,7 @@ namespace torch { namespace autograd {
 
 struct Variable;
 struct Function;
+struct OffloadedData;
 
 TORCH_API extern const char* ERR_BACKWARD_TWICE;
 
@@ -31,11 +32,15 @@ class TORCH_API SavedVariable {
   Variable unpack(std::shared_ptr<Function> saved_for = nullptr) const;
 
   void reset_data() {
+    offloaded_.reset();
     return data_.reset();
   }
 
  private:
   at::Tensor data_;
+  // Set instead of data_ if the data was moved to CPU memory, see
+  // Note [Offloading saved variables]
+  std::shared_ptr<OffloadedData> offloaded_;
 
   // The gradient function associated with this node. If has_grad_fn
   // is false, then this is a leaf node. Note that the grad_fn is not saved if
@@ -51,4 +56,20 @@ class TORCH_API SavedVariable {
   bool requires_grad_ = false;
   bool has_grad_fn_ = false;
 };
+
+/// Opt-in policy that moves large saved CUDA tensors to pinned CPU memory
+/// while the graph waits for its backward pass, and brings them back shortly
+/// before they are needed. See Note [Offloading saved variables].
+struct TORCH_API SavedVariableOffload {
+  /// Offloads saved tensors of at least `threshold_bytes`, and prefetches
+  /// the tensors saved up to `prefetch_distance` functions ahead of the
+  /// function that the engine is about to run.
+  static void enable(int64_t threshold_bytes, int64_t prefetch_distance = 4);
+  static void disable();
+  static bool is_enabled();
+  /// Called by the engine before it runs the function with this
+  /// sequence number.
+  static void prefetch(uint64_t sequence_nr);
+};
+
 }} // namespace torch::autograd
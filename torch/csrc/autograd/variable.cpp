@@ -1,5 +1,6 @@
 #include "torch/csrc/autograd/variable.h"
 
+#include "torch/csrc/autograd/cpp_hook.h"
 #include "torch/csrc/autograd/edge.h"
 #include "torch/csrc/autograd/engine.h"
 #include "torch/csrc/autograd/function.h"
@@ -8,6 +9,7 @@
 #include "torch/csrc/autograd/generated/Functions.h"
 #include "torch/csrc/autograd/generated/VariableType.h"
 #include "torch/csrc/autograd/variable_version.h"
+#include "torch/csrc/utils/memory.h"
 
 #include <ATen/ATen.h>
 #include <ATen/core/Error.h>
@@ -217,4 +219,13 @@ void Variable::rebase_history(Edge gradient_edge) {
   }
 }
 
+void Variable::register_hook(std::function<Variable(const Variable&)> hook) {
+  AT_CHECK(requires_grad(), "cannot register a hook on a variable that doesn't require gradient");
+  if (is_leaf()) {
+    add_hook(std::make_shared<CppFunctionPreHook>(std::move(hook), 0));
+  } else {
+    grad_fn()->add_pre_hook(make_unique<CppFunctionPreHook>(std::move(hook), output_nr()));
+  }
+}
+
 }} // namespace torch::autograd
@@ -10,6 +10,7 @@
 #include <ATen/ATen.h>
 #include <ATen/core/Error.h>
 
+#include <functional>
 #include <list>
 #include <memory>
 #include <mutex>
@@ -18,6 +19,10 @@
 #include <utility>
 #include <vector>
 
+namespace torch { namespace jit {
+struct Value;
+}} // namespace torch::jit
+
 namespace torch { namespace autograd {
 
 struct Function;
@@ -213,6 +218,11 @@ struct TORCH_API Variable : public at::Tensor {
   //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
   void add_hook(std::shared_ptr<FunctionPreHook> hook);
+  /// Registers a C++ function to be called on the gradient of this
+  /// `Variable` during the backward pass. It may return a new gradient, or
+  /// an undefined `Variable` to leave the gradient unchanged. Unlike Python
+  /// hooks, it doesn't need the GIL.
+  void register_hook(std::function<Variable(const Variable&)> hook);
   const std::vector<std::shared_ptr<FunctionPreHook>>& hooks() const noexcept;
   void clear_hooks();
 
@@ -241,6 +251,14 @@ struct TORCH_API Variable : public at::Tensor {
   PyObject* pyobj() const noexcept;
   void set_pyobj(PyObject* pyobj) noexcept;
 
+  /// Records that `value` computes this `Variable` in the JIT trace with id
+  /// `trace_id`, so the tracer can find it without a hash map lookup.
+  void set_trace_value(uint64_t trace_id, jit::Value* value) const noexcept;
+
+  /// Returns the value recorded by `set_trace_value()` for the trace with id
+  /// `trace_id`, or nullptr if the last one recorded was for another trace.
+  jit::Value* trace_value(uint64_t trace_id) const noexcept;
+
  private:
   /// Private implementation struct of the `Variable`. This struct declaration
   /// and the `get()` method which exposes it shall forever remain private and
@@ -354,9 +372,14 @@ struct Variable::Impl : public at::TensorImpl {
   uint32_t output_nr_;
   PyObject* pyobj_; // weak reference
 
+  // The value computing this variable in the trace with id trace_id_ (ids
+  // start at 1), see jit::tracer::getValueTrace
+  uint64_t trace_id_ = 0;
+  jit::Value* trace_value_ = nullptr;
+
   // Mutex to ensure that concurrent read operations that modify internal
-  // state are still thread-safe. Used by get_grad_fn and
-  // get_grad_accumulator.
+  // state are still thread-safe. Used by get_grad_fn,
+  // get_grad_accumulator and the trace value accessors.
   std::mutex mutex_;
 };
 
@@ -570,6 +593,21 @@ inline PyObject* Variable::pyobj() const noexcept {
   return get()->pyobj_;
 }
 
+inline void Variable::set_trace_value(
+    uint64_t trace_id,
+    jit::Value* value) const noexcept {
+  // the lock keeps the pair consistent when several threads trace the same
+  // variable, e.g. a shared parameter
+  std::lock_guard<std::mutex> lock(get()->mutex_);
+  get()->trace_id_ = trace_id;
+  get()->trace_value_ = value;
+}
+
+inline jit::Value* Variable::trace_value(uint64_t trace_id) const noexcept {
+  std::lock_guard<std::mutex> lock(get()->mutex_);
+  return get()->trace_id_ == trace_id ? get()->trace_value_ : nullptr;
+}
+
 // Private Methods
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
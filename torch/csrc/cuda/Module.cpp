@@ -247,6 +247,16 @@ PyObject * THCPModule_emptyCache(PyObject *_unused)
   Py_RETURN_NONE;
 }
 
+PyObject * THCPModule_emptyDeviceCache(PyObject *_unused, PyObject *arg)
+{
+  HANDLE_TH_ERRORS
+  THPUtils_assert(THPUtils_checkLong(arg), "invalid argument to empty_cache");
+  int device = (int) THPUtils_unpackLong(arg);
+  THCCachingAllocator_emptyDeviceCache(device);
+  END_HANDLE_TH_ERRORS
+  Py_RETURN_NONE;
+}
+
 PyObject * THCPModule_memoryAllocated(PyObject *_unused, PyObject *arg)
 {
   HANDLE_TH_ERRORS
@@ -287,6 +297,54 @@ PyObject * THCPModule_maxMemoryCached(PyObject *_unused, PyObject *arg)
   END_HANDLE_TH_ERRORS
 }
 
+PyObject * THCPModule_memoryStats(PyObject *_unused, PyObject *arg)
+{
+  HANDLE_TH_ERRORS
+  THPUtils_assert(THPUtils_checkLong(arg), "invalid argument to memory_stats");
+  int device = (int) THPUtils_unpackLong(arg);
+  THCCachingAllocatorStats stats;
+  THCCachingAllocator_getStats(device, &stats);
+  const std::pair<const char*, uint64_t> entries[] = {
+    {"allocated", stats.allocated},
+    {"max_allocated", stats.max_allocated},
+    {"active", stats.active},
+    {"reserved", stats.reserved},
+    {"max_reserved", stats.max_reserved},
+    {"inactive_split", stats.inactive_split},
+    {"num_segments", stats.num_segments},
+    {"num_alloc_retries", stats.num_alloc_retries},
+    {"num_stream_events", stats.num_stream_events},
+    {"external", stats.external},
+  };
+  THPObjectPtr dict(PyDict_New());
+  if (!dict) throw python_error();
+  for (auto& entry : entries) {
+    THPObjectPtr value(PyLong_FromUnsignedLongLong(entry.second));
+    if (!value) throw python_error();
+    if (PyDict_SetItemString(dict.get(), entry.first, value.get()) < 0) {
+      throw python_error();
+    }
+  }
+  return dict.release();
+  END_HANDLE_TH_ERRORS
+}
+
+PyObject * THCPModule_beginStreamUseBatch(PyObject *_unused, PyObject *noargs)
+{
+  HANDLE_TH_ERRORS
+  THCCachingAllocator_beginStreamUseBatch();
+  END_HANDLE_TH_ERRORS
+  Py_RETURN_NONE;
+}
+
+PyObject * THCPModule_endStreamUseBatch(PyObject *_unused, PyObject *noargs)
+{
+  HANDLE_TH_ERRORS
+  THCCachingAllocator_endStreamUseBatch();
+  END_HANDLE_TH_ERRORS
+  Py_RETURN_NONE;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Cuda module initialization
 ////////////////////////////////////////////////////////////////////////////////
@@ -394,10 +452,14 @@ static struct PyMethodDef _THCPModule_methods[] = {
   {"_cuda_getRNGState", (PyCFunction)THCPModule_getRNGState,      METH_NOARGS,  NULL},
   {"_cuda_setRNGState", (PyCFunction)THCPModule_setRNGState,      METH_O,       NULL},
   {"_cuda_emptyCache", (PyCFunction) THCPModule_emptyCache,       METH_NOARGS,  NULL},
+  {"_cuda_emptyDeviceCache", (PyCFunction) THCPModule_emptyDeviceCache, METH_O,  NULL},
   {"_cuda_memoryAllocated", (PyCFunction) THCPModule_memoryAllocated, METH_O,  NULL},
   {"_cuda_maxMemoryAllocated", (PyCFunction) THCPModule_maxMemoryAllocated, METH_O,  NULL},
   {"_cuda_memoryCached", (PyCFunction) THCPModule_memoryCached, METH_O,  NULL},
   {"_cuda_maxMemoryCached", (PyCFunction) THCPModule_maxMemoryCached, METH_O,  NULL},
+  {"_cuda_memoryStats", (PyCFunction) THCPModule_memoryStats, METH_O,  NULL},
+  {"_cuda_beginStreamUseBatch", (PyCFunction) THCPModule_beginStreamUseBatch, METH_NOARGS,  NULL},
+  {"_cuda_endStreamUseBatch", (PyCFunction) THCPModule_endStreamUseBatch, METH_NOARGS,  NULL},
   {"_cuda_manualSeed",  (PyCFunction)THCPModule_manualSeed,       METH_O,       NULL},
   {"_cuda_manualSeedAll", (PyCFunction)THCPModule_manualSeedAll,  METH_O,       NULL},
   {"_cuda_seed",        (PyCFunction)THCPModule_seed,             METH_NOARGS,  NULL},
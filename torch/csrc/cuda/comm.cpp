@@ -12,9 +12,14 @@
 #include <ATen/ATen.h>
 #include <ATen/core/optional.h>
 #include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/CUDAEvent.h>
 #include <ATen/cuda/CUDAGuard.h>
 
+#include <array>
 #include <cstddef>
+#include <map>
+#include <memory>
+#include <utility>
 #include <vector>
 
 namespace torch { namespace cuda {
@@ -67,6 +72,144 @@ std::vector<Tensor> broadcast(const Tensor& tensor, IntList devices) {
   return tensors;
 }
 
+#ifdef USE_NCCL
+namespace {
+
+// Flat buffers on a source device that broadcast_coalesced flattens dense
+// buckets into. They're kept across calls instead of being allocated for
+// every bucket, and alternate between buckets so that flattening one bucket
+// overlaps broadcasting the one before it. All of them are allocated, filled
+// and freed on the same stream, which waits for the last broadcast reading
+// a buffer before touching it again.
+struct FlatBuffer {
+  Tensor tensor;
+  at::cuda::CUDAEvent last_use;
+};
+
+struct FlatBufferCache {
+  at::cuda::CUDAStream flatten_stream;
+  std::map<const at::Type*, std::array<FlatBuffer, 2>> buffers;
+  std::map<const at::Type*, size_t> num_uses;
+};
+
+thread_local std::map<int64_t, FlatBufferCache> flat_buffer_caches;
+
+FlatBufferCache& flat_buffer_cache(int64_t device) {
+  auto it = flat_buffer_caches.find(device);
+  if (it == flat_buffer_caches.end()) {
+    // the events are created on the device they're recorded on
+    at::DeviceGuard device_guard(device);
+    it = flat_buffer_caches.emplace(device, FlatBufferCache()).first;
+    it->second.flatten_stream = at::cuda::getStreamFromPool(false, device);
+  }
+  return it->second;
+}
+
+FlatBuffer& flat_buffer(FlatBufferCache& cache, const at::Type& type) {
+  auto it = cache.buffers.find(&type);
+  if (it == cache.buffers.end()) {
+    at::DeviceGuard device_guard(cache.flatten_stream.device());
+    it = cache.buffers.emplace(&type, std::array<FlatBuffer, 2>()).first;
+  }
+  return it->second[cache.num_uses[&type]++ % 2];
+}
+
+// Broadcasts dense buckets with NCCL on pool streams, so that successive
+// buckets are pipelined: a bucket is flattened on a stream of devices[0]
+// while the previous one is being broadcast on a stream of every device.
+// Buckets that are already adjacent in memory are broadcast without being
+// flattened, and unflattening only takes views of the received buffers.
+// The streams wait for the current streams when the broadcaster is created,
+// and finish() makes the current streams wait for them in turn.
+struct PipelinedBroadcast {
+  PipelinedBroadcast(IntList devices)
+    : devices(devices), cache(flat_buffer_cache(devices[0])) {
+    comm_streams.reserve(devices.size());
+    for (auto device : devices) {
+      at::DeviceGuard device_guard(device);
+      comm_streams.push_back(at::cuda::getStreamFromPool(false, device));
+      at::cuda::CUDAEvent ready;
+      ready.record(at::cuda::getCurrentCUDAStream());
+      comm_streams.back().synchronize_with(ready);
+      if (device == devices[0])
+        cache.flatten_stream.synchronize_with(ready);
+    }
+  }
+
+  // Broadcasts the bucket and appends the copies for devices[i] to
+  // outputs[i], for every i > 0.
+  void broadcast(const std::vector<Tensor>& bucket, tensor_list2d& outputs) {
+    auto & type = bucket[0].type();
+    Tensor source = utils::flatten_adjacent_dense_tensors(bucket);
+    at::cuda::CUDAEvent* source_last_use = nullptr;
+    at::cuda::CUDAGuard cuda_guard;
+    if (!source.defined()) {
+      int64_t numel = 0;
+      for (const auto & tensor : bucket)
+        numel += tensor.numel();
+      auto & buffer = flat_buffer(cache, type);
+      cuda_guard.set_stream(cache.flatten_stream);
+      cache.flatten_stream.synchronize_with(buffer.last_use);
+      if (!buffer.tensor.defined() || buffer.tensor.numel() < numel)
+        buffer.tensor = type.tensor({numel});
+      source = buffer.tensor.narrow(0, 0, numel);
+      int64_t offset = 0;
+      for (const auto & tensor : bucket) {
+        source.narrow(0, offset, tensor.numel()).view(tensor.sizes()).copy_(tensor);
+        offset += tensor.numel();
+      }
+      at::cuda::CUDAEvent flattened;
+      flattened.record(cache.flatten_stream);
+      comm_streams[0].synchronize_with(flattened);
+      source_last_use = &buffer.last_use;
+    }
+
+    std::vector<Tensor> flat_tensors;
+    flat_tensors.reserve(devices.size());
+    flat_tensors.push_back(source);
+    nccl::stream_list streams;
+    streams.reserve(devices.size());
+    streams.push_back(comm_streams[0].internals());
+    for (size_t i = 1, num_devices = devices.size(); i < num_devices; ++i) {
+      // allocated on the current stream, which the results are used on
+      cuda_guard.set_device(devices[i]);
+      flat_tensors.push_back(type.tensor({source.numel()}));
+      streams.push_back(comm_streams[i].internals());
+    }
+    nccl::broadcast(flat_tensors, streams);
+    // the next bucket flattened into the buffer waits for this broadcast
+    if (source_last_use)
+      source_last_use->record(comm_streams[0]);
+
+    for (size_t i = 1, num_devices = devices.size(); i < num_devices; ++i) {
+      for (auto & t : utils::unflatten_dense_tensors(flat_tensors[i], bucket))
+        outputs[i].push_back(std::move(t));
+    }
+  }
+
+  void finish() {
+    for (size_t i = 0, num_devices = devices.size(); i < num_devices; ++i) {
+      at::DeviceGuard device_guard(devices[i]);
+      auto current_stream = at::cuda::getCurrentCUDAStream();
+      at::cuda::CUDAEvent done;
+      done.record(comm_streams[i]);
+      current_stream.synchronize_with(done);
+      if (i == 0) {
+        at::cuda::CUDAEvent flattened;
+        flattened.record(cache.flatten_stream);
+        current_stream.synchronize_with(flattened);
+      }
+    }
+  }
+
+  IntList devices;
+  FlatBufferCache& cache;
+  std::vector<at::cuda::CUDAStream> comm_streams;
+};
+
+} // anonymous namespace
+#endif
+
 tensor_list2d broadcast_coalesced(TensorList tensors, IntList devices, size_t buffer_size) {
   if (!std::all_of(tensors.begin(), tensors.end(),
                    [&](const at::Tensor& t) { return t.get_device() == devices[0]; })) {
@@ -78,6 +221,9 @@ tensor_list2d broadcast_coalesced(TensorList tensors, IntList devices, size_t bu
   for (auto & o : outputs)
     o.reserve(tensors.size());
 
+#ifdef USE_NCCL
+  std::unique_ptr<PipelinedBroadcast> pipeline;
+#endif
   unique_type_checker type_checker;
   for (auto & chunk : utils::take_tensors(tensors, buffer_size)) {
     auto & type = chunk.type();
@@ -97,6 +243,14 @@ tensor_list2d broadcast_coalesced(TensorList tensors, IntList devices, size_t bu
           device_outputs.push_back(std::move(t));
       }
     } else {
+#ifdef USE_NCCL
+      if (nccl::is_available({chunk.tensors[0]})) {
+        if (!pipeline)
+          pipeline.reset(new PipelinedBroadcast(devices));
+        pipeline->broadcast(chunk.tensors, outputs);
+        continue;
+      }
+#endif
       at::DeviceGuard device_guard(devices[0]);
       std::vector<Tensor> results = broadcast(utils::flatten_dense_tensors(chunk.tensors),
                                               devices);
@@ -109,6 +263,11 @@ tensor_list2d broadcast_coalesced(TensorList tensors, IntList devices, size_t bu
     }
   }
 
+#ifdef USE_NCCL
+  if (pipeline)
+    pipeline->finish();
+#endif
+
   // If we only saw a single tensor type, then we can skip expensive reordering
   if (!type_checker.unique) {
     for (auto & o : outputs)
@@ -117,6 +276,80 @@ tensor_list2d broadcast_coalesced(TensorList tensors, IntList devices, size_t bu
   return outputs;
 }
 
+std::vector<at::Tensor> reduce_add_coalesced(const tensor_list2d& inputs,
+                                             int64_t destination_index,
+                                             size_t buffer_size) {
+  AT_CHECK(!inputs.empty(), "Expected at least one list of tensors to reduce");
+  size_t root = inputs.size();
+  for (size_t i = 0, num_devices = inputs.size(); i < num_devices; ++i) {
+    AT_CHECK(inputs[i].size() == inputs[0].size(),
+             "Expected the same number of tensors on every device");
+    if (!inputs[i].empty() && inputs[i][0].get_device() == destination_index)
+      root = i;
+  }
+  AT_CHECK(root < inputs.size(),
+           "reduce_add_coalesced expects the destination to be on the same GPU "
+           "as one of the lists of tensors");
+
+  // the tensors of every device have the same types and sizes, so they're
+  // split into the same chunks
+  std::vector<std::vector<utils::TensorGroup>> chunks;
+  chunks.reserve(inputs.size());
+  for (const auto & device_inputs : inputs)
+    chunks.push_back(utils::take_tensors(device_inputs, buffer_size));
+
+  std::vector<Tensor> outputs;
+  outputs.reserve(inputs[root].size());
+  unique_type_checker type_checker;
+  at::DeviceGuard device_guard(destination_index);
+  for (size_t c = 0, num_chunks = chunks[root].size(); c < num_chunks; ++c) {
+    auto & root_chunk = chunks[root][c];
+    type_checker.show(root_chunk.type());
+    if (root_chunk.type().is_sparse()) {
+      for (size_t t = 0, num_tensors = root_chunk.tensors.size(); t < num_tensors; ++t) {
+        Tensor result = root_chunk.tensors[t].clone();
+        for (size_t i = 0, num_devices = inputs.size(); i < num_devices; ++i) {
+          if (i != root)
+            result.add_(chunks[i][c].tensors[t].to(result.device(), /*non_blocking=*/true));
+        }
+        outputs.push_back(std::move(result));
+      }
+      continue;
+    }
+
+    std::vector<Tensor> flat_tensors;
+    flat_tensors.reserve(inputs.size());
+    for (size_t i = 0, num_devices = inputs.size(); i < num_devices; ++i) {
+      at::DeviceGuard input_device_guard(inputs[i][0].get_device());
+      flat_tensors.push_back(utils::flatten_dense_tensors(chunks[i][c].tensors));
+    }
+    Tensor result;
+#ifdef USE_NCCL
+    if (nccl::is_available(flat_tensors)) {
+      result = flat_tensors[root].type().tensor(flat_tensors[root].sizes());
+      std::vector<Tensor> nccl_outputs = flat_tensors;
+      nccl_outputs[root] = result;
+      nccl::reduce(flat_tensors, nccl_outputs, root);
+    } else {
+#else
+    {
+#endif
+      result = flat_tensors[root].clone();
+      for (size_t i = 0, num_devices = inputs.size(); i < num_devices; ++i) {
+        if (i != root)
+          result.add_(flat_tensors[i].to(result.device(), /*non_blocking=*/true));
+      }
+    }
+    for (auto & t : utils::unflatten_dense_tensors(result, root_chunk.tensors))
+      outputs.push_back(std::move(t));
+  }
+
+  // If we only saw a single tensor type, then we can skip expensive reordering
+  if (!type_checker.unique)
+    utils::reorder_tensors_like(outputs, inputs[root]);
+  return outputs;
+}
+
 std::vector<at::Tensor> scatter(
     const at::Tensor& tensor,
     at::IntList devices,
@@ -17,6 +17,15 @@ std::vector<at::Tensor> broadcast(const at::Tensor& tensor, at::IntList devices)
 tensor_list2d broadcast_coalesced(at::TensorList tensors, at::IntList devices,
                                   size_t buffer_size);
 
+// Sums inputs[0][i], ..., inputs[n - 1][i] for every i on the given
+// device, which must be the device of one of inputs[0], ..., inputs[n - 1].
+// Every inputs[j] holds tensors of the same types and sizes on one device.
+// Like broadcast_coalesced, small tensors are coalesced into buffers of at
+// most buffer_size bytes, which are reduced with NCCL when it's available.
+std::vector<at::Tensor> reduce_add_coalesced(const tensor_list2d& inputs,
+                                             int64_t destination_index,
+                                             size_t buffer_size);
+
 std::vector<at::Tensor> scatter(
     const at::Tensor& tensor,
     at::IntList devices,
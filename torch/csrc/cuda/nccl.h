@@ -47,4 +47,14 @@ void broadcast(at::TensorList tensors,
                const stream_list& streams = {},
                const comm_list& user_comms = {});
 
+// Reduces inputs[i] of every device into outputs[root] with the given
+// ncclRedOp_t. The outputs of the other devices are not written to, and may
+// be the inputs themselves.
+void reduce(at::TensorList inputs,
+            at::TensorList outputs,
+            int32_t root = 0,
+            int32_t op = ncclSum,
+            const stream_list& streams = {},
+            const comm_list& user_comms = {});
+
 }}}
@@ -612,6 +612,26 @@ PyObject* THDPModule_allReduce(PyObject *_unused, PyObject *args)
   END_HANDLE_TH_ERRORS
 }
 
+PyObject* THDPModule_iallReduce(PyObject *_unused, PyObject *args)
+{
+  HANDLE_TH_ERRORS
+  if (PyTuple_GET_SIZE(args) != 3 || !THPVariable_Check(PyTuple_GET_ITEM(args, 0))) {
+    THPUtils_invalidArguments(args, NULL, "iall_reduce", 1, "(tensor in_out, reduce_op op, group gr)");
+    return NULL;
+  }
+
+  THDGroup group = _getGroup(PyTuple_GET_ITEM(args, 2));
+  THDReduceOp op = _getReduceOp(PyTuple_GET_ITEM(args, 1));
+  auto desc = THDPModule_makeDescriptor(PyTuple_GET_ITEM(args, 0));
+  THDRequest* req;
+  {
+    AutoNoGIL guard;
+    req = THDIallReduce(desc, op, group);
+  }
+  return THPWrapper_New(req, (void(*)(void*))THDRequest_free);
+  END_HANDLE_TH_ERRORS
+}
+
 PyObject* THDPModule_reduce(PyObject *_unused, PyObject *args)
 {
   HANDLE_TH_ERRORS
@@ -990,6 +1010,7 @@ static struct PyMethodDef _THDPModule_methods[] = {
   {"_dist_recv_any_source", (PyCFunction)THDPModule_recvAnySource, METH_O, NULL},
   {"_dist_recv", (PyCFunction)THDPModule_recv, METH_VARARGS, NULL},
   {"_dist_all_reduce", (PyCFunction)THDPModule_allReduce, METH_VARARGS, NULL},
+  {"_dist_iall_reduce", (PyCFunction)THDPModule_iallReduce, METH_VARARGS, NULL},
   {"_dist_all_reduce_multigpu", (PyCFunction)THDPModule_allReduceMultiGPU, METH_VARARGS, NULL},
   {"_dist_reduce", (PyCFunction)THDPModule_reduce, METH_VARARGS, NULL},
   {"_dist_reduce_multigpu", (PyCFunction)THDPModule_reduceMultiGPU, METH_VARARGS, NULL},
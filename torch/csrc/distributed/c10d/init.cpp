@@ -19,6 +19,7 @@
 
 #include <torch/csrc/Exceptions.h>
 #include <torch/csrc/distributed/c10d/ddp.h>
+#include <torch/csrc/distributed/c10d/reducer.h>
 #include <torch/csrc/utils/object_ptr.h>
 #include <torch/csrc/utils/pybind.h>
 
@@ -45,9 +46,16 @@ PyObject* c10d_init(PyObject* _unused) {
       .def_readwrite("rootRank", &::c10d::BroadcastOptions::rootRank)
       .def_readwrite("rootTensor", &::c10d::BroadcastOptions::rootTensor);
 
+  py::enum_<::c10d::AllreduceCompression>(module, "AllreduceCompression")
+      .value("NONE", ::c10d::AllreduceCompression::NONE)
+      .value("FP16", ::c10d::AllreduceCompression::FP16);
+
   py::class_<::c10d::AllreduceOptions>(module, "AllreduceOptions")
       .def(py::init<>())
-      .def_readwrite("reduceOp", &::c10d::AllreduceOptions::reduceOp);
+      .def_readwrite("reduceOp", &::c10d::AllreduceOptions::reduceOp)
+      .def_readwrite("compression", &::c10d::AllreduceOptions::compression)
+      .def_readwrite("residuals", &::c10d::AllreduceOptions::residuals)
+      .def_readwrite("gpuDirect", &::c10d::AllreduceOptions::gpuDirect);
 
   py::enum_<::c10d::ReduceOp>(module, "ReduceOp")
       .value("SUM", ::c10d::ReduceOp::SUM)
@@ -69,6 +77,13 @@ PyObject* c10d_init(PyObject* _unused) {
       .def(py::init<>())
       .def_readwrite("rootRank", &::c10d::GatherOptions::rootRank);
 
+  py::class_<::c10d::ReduceScatterOptions>(module, "ReduceScatterOptions")
+      .def(py::init<>())
+      .def_readwrite("reduceOp", &::c10d::ReduceScatterOptions::reduceOp);
+
+  py::class_<::c10d::AllToAllOptions>(module, "AllToAllOptions")
+      .def(py::init<>());
+
   auto store =
       shared_ptr_class_<::c10d::Store>(module, "Store")
           // Convert from std::string to std::vector<uint8>.
@@ -98,7 +113,36 @@ PyObject* c10d_init(PyObject* _unused) {
           .def(
               "wait",
               &::c10d::Store::wait,
-              py::call_guard<py::gil_scoped_release>());
+              py::call_guard<py::gil_scoped_release>())
+          .def(
+              "multi_set",
+              [](::c10d::Store& store,
+                 const std::vector<std::string>& keys,
+                 const std::vector<std::string>& values) {
+                std::vector<std::vector<uint8_t>> values_;
+                values_.reserve(values.size());
+                for (const auto& value : values) {
+                  values_.emplace_back(value.begin(), value.end());
+                }
+                store.multiSet(keys, values_);
+              },
+              py::call_guard<py::gil_scoped_release>())
+          // The values are converted to py::bytes with the GIL held.
+          .def(
+              "multi_get",
+              [](::c10d::Store& store, const std::vector<std::string>& keys) {
+                std::vector<std::vector<uint8_t>> values;
+                {
+                  py::gil_scoped_release release;
+                  values = store.multiGet(keys);
+                }
+                py::list result;
+                for (auto& value : values) {
+                  result.append(py::bytes(
+                      reinterpret_cast<char*>(value.data()), value.size()));
+                }
+                return result;
+              });
 
   shared_ptr_class_<::c10d::FileStore>(module, "FileStore", store)
       .def(py::init<const std::string&>());
@@ -226,6 +270,46 @@ PyObject* c10d_init(PyObject* _unused) {
               py::arg("root"),
               py::call_guard<py::gil_scoped_release>())
 
+          .def(
+              "reduce_scatter",
+              &::c10d::ProcessGroup::reduceScatter,
+              py::call_guard<py::gil_scoped_release>())
+
+          .def(
+              "reduce_scatter",
+              [](::c10d::ProcessGroup& pg,
+                 at::Tensor& output,
+                 std::vector<at::Tensor>& input,
+                 ::c10d::ReduceOp op) {
+                ::c10d::ReduceScatterOptions opts;
+                opts.reduceOp = op;
+                std::vector<std::vector<at::Tensor>> inputs = {input};
+                std::vector<at::Tensor> outputs = {output};
+                return pg.reduceScatter(outputs, inputs, opts);
+              },
+              py::arg("output_tensor"),
+              py::arg("tensors"),
+              py::arg("op") = ::c10d::ReduceOp::SUM,
+              py::call_guard<py::gil_scoped_release>())
+
+          .def(
+              "alltoall",
+              &::c10d::ProcessGroup::alltoall,
+              py::call_guard<py::gil_scoped_release>())
+
+          .def(
+              "alltoall",
+              [](::c10d::ProcessGroup& pg,
+                 std::vector<at::Tensor>& output,
+                 std::vector<at::Tensor>& input) {
+                std::vector<std::vector<at::Tensor>> outputs = {output};
+                std::vector<std::vector<at::Tensor>> inputs = {input};
+                return pg.alltoall(outputs, inputs);
+              },
+              py::arg("output_tensors"),
+              py::arg("tensors"),
+              py::call_guard<py::gil_scoped_release>())
+
           .def(
               "send",
               &::c10d::ProcessGroup::send,
@@ -307,9 +391,40 @@ PyObject* c10d_init(PyObject* _unused) {
           }));
 
 #ifdef USE_C10D_NCCL
-  shared_ptr_class_<::c10d::ProcessGroupNCCL>(
-      module, "ProcessGroupNCCL", processGroup)
-      .def(py::init<const std::shared_ptr<::c10d::Store>&, int, int>());
+  auto processGroupNCCL = shared_ptr_class_<::c10d::ProcessGroupNCCL>(
+      module, "ProcessGroupNCCL", processGroup);
+
+  py::class_<::c10d::ProcessGroupNCCL::Options>(processGroupNCCL, "Options")
+      .def(py::init<>())
+      .def_readwrite(
+          "hierarchicalAllreduce",
+          &::c10d::ProcessGroupNCCL::Options::hierarchicalAllreduce)
+      .def_readwrite(
+          "shareCommunicators",
+          &::c10d::ProcessGroupNCCL::Options::shareCommunicators);
+
+  processGroupNCCL
+      .def(py::init<
+           const std::shared_ptr<::c10d::Store>&,
+           int,
+           int,
+           ::c10d::ProcessGroupNCCL::Options>())
+      .def(py::init<const std::shared_ptr<::c10d::Store>&, int, int>())
+      // Takes lists of CUDA device indices.
+      .def(
+          "init_nccl_comms",
+          [](::c10d::ProcessGroupNCCL& pg,
+             const std::vector<std::vector<int>>& deviceIndices) {
+            std::vector<std::vector<at::Device>> devices;
+            for (const auto& indices : deviceIndices) {
+              devices.emplace_back();
+              for (auto index : indices) {
+                devices.back().emplace_back(at::DeviceType::CUDA, index);
+              }
+            }
+            pg.initNCCLComms(devices);
+          },
+          py::call_guard<py::gil_scoped_release>());
 #endif
 
 #ifdef USE_C10D_MPI
@@ -331,6 +446,17 @@ PyObject* c10d_init(PyObject* _unused) {
 
   module.def("_dist_broadcast_coalesced", &::c10d::distBroadcastCoalesced);
 
+  shared_ptr_class_<::c10d::Reducer>(module, "Reducer")
+      .def(
+          py::init<
+              std::vector<std::vector<torch::autograd::Variable>>,
+              std::shared_ptr<::c10d::ProcessGroup>,
+              int64_t>(),
+          py::arg("replicas"),
+          py::arg("process_group"),
+          py::arg("bucket_bytes_cap") = 25 * 1024 * 1024)
+      .def("num_buckets", &::c10d::Reducer::numBuckets);
+
   Py_RETURN_TRUE;
 }
 
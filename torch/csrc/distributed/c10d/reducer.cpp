@@ -0,0 +1,244 @@
+#include <torch/csrc/distributed/c10d/reducer.h>
+
+#include <torch/csrc/autograd/engine.h>
+#include <torch/csrc/autograd/function_hook.h>
+
+#include <ATen/DeviceGuard.h>
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+namespace c10d {
+namespace {
+
+using torch::autograd::Variable;
+using torch::autograd::variable_list;
+
+// Runs a function after the function it is registered on has been applied.
+class LambdaPostHook : public torch::autograd::FunctionPostHook {
+ public:
+  explicit LambdaPostHook(std::function<void()> fn) : fn_(std::move(fn)) {}
+
+  variable_list operator()(
+      const variable_list& outputs,
+      const variable_list& /* unused */) override {
+    fn_();
+    return outputs;
+  }
+
+ protected:
+  std::function<void()> fn_;
+};
+
+} // namespace
+
+Reducer::Reducer(
+    std::vector<std::vector<Variable>> replicas,
+    std::shared_ptr<ProcessGroup> processGroup,
+    int64_t bucketBytesCap)
+    : replicas_(std::move(replicas)),
+      processGroup_(std::move(processGroup)),
+      nextBucket_(0),
+      finalizerQueued_(false) {
+  AT_CHECK(!replicas_.empty(), "Expected at least one model replica");
+  const auto numVariables = replicas_[0].size();
+  for (const auto& replica : replicas_) {
+    AT_CHECK(
+        replica.size() == numVariables,
+        "Expected all model replicas to have the same number of parameters");
+    for (size_t i = 0; i < numVariables; i++) {
+      AT_CHECK(
+          replica[i].numel() == replicas_[0][i].numel() &&
+              replica[i].type().scalarType() ==
+                  replicas_[0][i].type().scalarType() &&
+              replica[i].requires_grad() == replicas_[0][i].requires_grad(),
+          "Expected parameter ", i, " to be identical in all model replicas");
+    }
+  }
+
+  // Assign the variables to buckets, starting from the last one. A bucket
+  // only holds variables of a single type and is closed once it reaches
+  // the size cap.
+  locators_.resize(numVariables);
+  at::Type* bucketType = nullptr;
+  int64_t bucketBytes = 0;
+  for (size_t i = numVariables; i-- > 0;) {
+    const auto& variable = replicas_[0][i];
+    if (!variable.requires_grad()) {
+      continue;
+    }
+    auto& type = variable.data().type();
+    if (buckets_.empty() || &type != bucketType ||
+        bucketBytes >= bucketBytesCap) {
+      buckets_.emplace_back();
+      bucketType = &type;
+      bucketBytes = 0;
+    }
+    auto& bucket = buckets_.back();
+    locators_[i] =
+        VariableLocator{buckets_.size() - 1, bucket.variables.size()};
+    bucket.variables.push_back(i);
+    bucketBytes += variable.numel() * type.elementSizeInBytes();
+  }
+
+  // Allocate the flattened contents of every bucket on every replica
+  for (auto& bucket : buckets_) {
+    int64_t numel = 0;
+    for (auto variable : bucket.variables) {
+      const auto length = replicas_[0][variable].numel();
+      bucket.offsets.push_back(numel);
+      bucket.lengths.push_back(length);
+      numel += length;
+    }
+    for (const auto& replica : replicas_) {
+      const auto& data = replica[bucket.variables[0]].data();
+      at::DeviceGuard guard(data);
+      bucket.contents.push_back(data.type().tensor({numel}));
+    }
+    bucket.pending = bucket.variables.size() * replicas_.size();
+  }
+
+  // Register the hooks that mark the gradients as ready
+  for (size_t replica = 0; replica < replicas_.size(); replica++) {
+    for (size_t variable = 0; variable < numVariables; variable++) {
+      if (!replicas_[replica][variable].requires_grad()) {
+        continue;
+      }
+      auto gradAccumulator = replicas_[replica][variable].grad_accumulator();
+      AT_CHECK(
+          gradAccumulator,
+          "Expected parameter ",
+          variable,
+          " to be a leaf variable");
+      auto hook = new LambdaPostHook(
+          [=] { this->markVariableReady(replica, variable); });
+      gradAccumulator->add_post_hook(
+          std::unique_ptr<torch::autograd::FunctionPostHook>(hook));
+      gradAccumulators_.push_back(std::move(gradAccumulator));
+      hooks_.push_back(hook);
+    }
+  }
+}
+
+Reducer::~Reducer() {
+  for (size_t i = 0; i < gradAccumulators_.size(); i++) {
+    auto& hooks = gradAccumulators_[i]->post_hooks();
+    auto hook = hooks_[i];
+    hooks.erase(
+        std::remove_if(
+            hooks.begin(),
+            hooks.end(),
+            [hook](const std::unique_ptr<torch::autograd::FunctionPostHook>&
+                       other) { return other.get() == hook; }),
+        hooks.end());
+  }
+}
+
+// Called by the gradient accumulator of a variable, possibly concurrently
+// from the autograd threads of different devices.
+void Reducer::markVariableReady(size_t replica, size_t variable) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // The reductions are finished on the thread that called backward, once
+  // the whole backward pass is done.
+  if (!finalizerQueued_) {
+    finalizerQueued_ = true;
+    torch::autograd::Engine::get_default_engine().queue_callback(
+        [this] { this->finalizeBackward(); });
+  }
+
+  const auto& locator = locators_[variable];
+  auto& bucket = buckets_[locator.bucket];
+  AT_CHECK(
+      bucket.pending > 0,
+      "Expected every parameter to be marked ready only once per backward "
+      "pass, but parameter ",
+      variable,
+      " was marked ready again");
+
+  const auto& grad = replicas_[replica][variable].grad();
+  auto& contents = bucket.contents[replica];
+  at::DeviceGuard guard(contents);
+  auto slice = contents.narrow(
+      0,
+      bucket.offsets[locator.intraBucket],
+      bucket.lengths[locator.intraBucket]);
+  if (grad.defined()) {
+    AT_CHECK(
+        !grad.requires_grad(),
+        "Reducer only works with gradients that don't require grad");
+    const auto& data = torch::autograd::as_variable_ref(grad).data();
+    slice.view(data.sizes()).copy_(data);
+  } else {
+    slice.zero_();
+  }
+
+  if (--bucket.pending > 0) {
+    return;
+  }
+
+  // Launch the allreduce of every complete bucket, in bucket order
+  while (nextBucket_ < buckets_.size() && buckets_[nextBucket_].pending == 0) {
+    auto& next = buckets_[nextBucket_++];
+    next.work = processGroup_->allreduce(next.contents);
+  }
+}
+
+void Reducer::finalizeBackward() {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Reset the state for the next backward pass before anything can throw
+  const auto launched = nextBucket_;
+  std::vector<std::shared_ptr<ProcessGroup::Work>> work;
+  work.reserve(buckets_.size());
+  for (auto& bucket : buckets_) {
+    work.push_back(std::move(bucket.work));
+    bucket.pending = bucket.variables.size() * replicas_.size();
+  }
+  nextBucket_ = 0;
+  finalizerQueued_ = false;
+
+  if (launched != buckets_.size()) {
+    // The launched reductions must still complete before we give up
+    for (size_t i = 0; i < launched; i++) {
+      work[i]->wait();
+    }
+    AT_ERROR(
+        "Expected every parameter that requires grad to receive a gradient "
+        "in the backward pass, but only ",
+        launched,
+        " of ",
+        buckets_.size(),
+        " buckets were reduced");
+  }
+
+  for (size_t i = 0; i < buckets_.size(); i++) {
+    auto& bucket = buckets_[i];
+    if (!work[i]->wait()) {
+      AT_ERROR("Gradient reduction failed: ", work[i]->exception().what());
+    }
+
+    // Average and copy the reduced gradients back into the replicas
+    for (size_t replica = 0; replica < replicas_.size(); replica++) {
+      auto& contents = bucket.contents[replica];
+      at::DeviceGuard guard(contents);
+      contents.div_(processGroup_->getSize());
+      for (size_t j = 0; j < bucket.variables.size(); j++) {
+        auto& variable = replicas_[replica][bucket.variables[j]];
+        auto slice =
+            contents.narrow(0, bucket.offsets[j], bucket.lengths[j])
+                .view(variable.sizes());
+        auto& grad = variable.grad();
+        if (grad.defined()) {
+          torch::autograd::as_variable_ref(grad).data().copy_(slice);
+        } else {
+          grad = torch::autograd::make_variable(slice.clone());
+        }
+      }
+    }
+  }
+}
+
+} // namespace c10d
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <torch/csrc/autograd/function.h>
+#include <torch/csrc/autograd/variable.h>
+
+#include <c10d/ProcessGroup.hpp>
+
+#include <ATen/ATen.h>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace c10d {
+
+// Reducer averages the gradients of a set of module replicas across all
+// processes in a process group while the backward pass is still running.
+//
+// The parameters are grouped into buckets of at most `bucketBytesCap` bytes
+// (a single parameter larger than that gets a bucket of its own). Gradients
+// become ready roughly in the reverse order in which the parameters are used
+// in the forward pass, so buckets are filled starting from the last
+// parameter. Every parameter gets a hook on its `AccumulateGrad` function
+// that copies the accumulated gradient into the flattened contents of its
+// bucket. Once a bucket is complete for all replicas, an asynchronous
+// allreduce is launched for it, overlapping communication with the rest of
+// the backward pass. Buckets are always launched in the same order, so that
+// collectives match up across processes.
+//
+// At the end of the backward pass the reducer waits for all reductions and
+// copies the averaged gradients back into the `grad` of every replica.
+//
+// `replicas[i]` holds the parameters of the module copy on the i-th device.
+// All replicas must have the same parameters in the same order, on every
+// process. Every parameter that requires gradient must receive a gradient
+// in every backward pass.
+class Reducer {
+ public:
+  explicit Reducer(
+      std::vector<std::vector<torch::autograd::Variable>> replicas,
+      std::shared_ptr<ProcessGroup> processGroup,
+      int64_t bucketBytesCap = 25 * 1024 * 1024);
+
+  ~Reducer();
+
+  // Not copyable, the hooks are bound to this instance.
+  Reducer(const Reducer&) = delete;
+  Reducer& operator=(const Reducer&) = delete;
+
+  // Returns the number of buckets the parameters are grouped into.
+  size_t numBuckets() const {
+    return buckets_.size();
+  }
+
+ protected:
+  struct Bucket {
+    // The flattened gradients of the bucket, one tensor per replica.
+    std::vector<at::Tensor> contents;
+
+    // Index, offset in `contents` and number of elements of every variable.
+    std::vector<size_t> variables;
+    std::vector<int64_t> offsets;
+    std::vector<int64_t> lengths;
+
+    // Number of (replica, variable) gradients that are not ready yet.
+    size_t pending = 0;
+
+    // The allreduce of `contents`, once it has been launched.
+    std::shared_ptr<ProcessGroup::Work> work;
+  };
+
+  struct VariableLocator {
+    size_t bucket;
+    size_t intraBucket;
+  };
+
+  void markVariableReady(size_t replica, size_t variable);
+
+  void finalizeBackward();
+
+  std::mutex mutex_;
+  std::vector<std::vector<torch::autograd::Variable>> replicas_;
+  std::shared_ptr<ProcessGroup> processGroup_;
+
+  std::vector<Bucket> buckets_;
+  std::vector<VariableLocator> locators_;
+
+  // The next bucket to launch the allreduce for.
+  size_t nextBucket_;
+
+  // Whether finalizeBackward has been queued for the current backward pass.
+  bool finalizerQueued_;
+
+  // The gradient accumulators the hooks are registered on, and the hooks
+  // themselves so they can be removed again. The accumulators are kept
+  // alive here, since variables only hold a weak reference to them.
+  std::vector<std::shared_ptr<torch::autograd::Function>> gradAccumulators_;
+  std::vector<torch::autograd::FunctionPostHook*> hooks_;
+};
+
+} // namespace c10d
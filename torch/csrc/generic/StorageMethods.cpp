@@ -185,13 +185,18 @@ static PyObject * THPStorage_(fromFile)(PyObject *_unused, PyObject *args, PyObj
   const char *filename;
   Py_ssize_t size = 0;
   int shared = 0;
-  static char *kwlist[] = {"filename", "shared", "size", NULL};
-  if (!PyArg_ParseTupleAndKeywords(args, keywds, "s|in", kwlist,
-              &filename, &shared, &size)) {
+  int readonly = 0;
+  static char *kwlist[] = {"filename", "shared", "size", "readonly", NULL};
+  if (!PyArg_ParseTupleAndKeywords(args, keywds, "s|ini", kwlist,
+              &filename, &shared, &size, &readonly)) {
     return NULL;
   }
+  THPUtils_assert(!(shared && readonly), "from_file: a read-only mapping "
+      "can't be opened in shared mode, it is always shared");
   if (shared)
     shared = TH_ALLOCATOR_MAPPED_SHARED;
+  if (readonly)
+    shared = TH_ALLOCATOR_MAPPED_READONLY;
   THWStorage *storage = THWStorage_(newWithMapping)(LIBRARY_STATE filename, size, shared);
   return (PyObject*)THPStorage_(New)(storage);
   END_HANDLE_TH_ERRORS
@@ -78,12 +78,46 @@ struct ArgumentSpec {
       // each POD has a running tally of all dimensions including its own
       pod.total_dims = total_dims;
     }
-    // we precompute the hash_code to minimize the time inside of hash
-    // table operations where we may need to hold a compiler cache lock.
-    hash_code = hash_combine(0, ninputs);
-    for(auto d : data) {
-      hash_code = hash_combine(hash_code, d);
+    computeHashCode();
+  }
+
+  // Recreates the spec a graph was specialized to by specializeToSpec from
+  // the types it gave to the graph's inputs: a TensorType is a defined
+  // tensor, a DynamicType an undefined one, and anything else is not a
+  // tensor. requires_grad is never set, so this only works for specs under
+  // which no gradient is computed.
+  explicit ArgumentSpec(at::ArrayRef<TypePtr> input_types)
+  :  hash_code(0), ninputs(input_types.size()) {
+    int32_t all_dims = 0;
+    for (auto & type : input_types) {
+      if (auto tensor_type = type->cast<TensorType>())
+        all_dims += tensor_type->sizes().size();
+    }
+    data.resize(ninputs + all_dims*2);
+
+    ArgumentInfoPOD * pods = reinterpret_cast<ArgumentInfoPOD*>(data.data());
+    int64_t * next_dim = sizes_strides();
+    int32_t total_dims = 0;
+    for(int32_t i = 0; i < ninputs; i++) {
+      auto & pod = pods[i];
+      auto tensor_type = input_types[i]->cast<TensorType>();
+      pod.is_tensor = tensor_type || input_types[i]->kind() == TypeKind::DynamicType;
+      if (tensor_type) {
+        pod.defined = true;
+        pod.type = static_cast<int>(tensor_type->scalarType());
+        pod.device = tensor_type->device();
+        pod.requires_grad = false;
+        total_dims += tensor_type->sizes().size();
+        auto & sizes = tensor_type->sizes();
+        std::copy(sizes.begin(), sizes.end(), next_dim);
+        next_dim += sizes.size();
+        auto & strides = tensor_type->strides();
+        std::copy(strides.begin(), strides.end(), next_dim);
+        next_dim += strides.size();
+      }
+      pod.total_dims = total_dims;
     }
+    computeHashCode();
   }
 
   // equality is fast: check ninputs, and then check the raw array data,
@@ -104,6 +138,14 @@ struct ArgumentSpec {
   }
 
 private:
+  // we precompute the hash_code to minimize the time inside of hash
+  // table operations where we may need to hold a compiler cache lock.
+  void computeHashCode() {
+    hash_code = hash_combine(0, ninputs);
+    for(auto d : data) {
+      hash_code = hash_combine(hash_code, d);
+    }
+  }
   ArrayRef<ArgumentInfoPOD> tensor_info() const {
     return ArrayRef<ArgumentInfoPOD>(reinterpret_cast<const ArgumentInfoPOD*>(data.data()), ninputs);
   }
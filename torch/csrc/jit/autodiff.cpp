@@ -43,7 +43,12 @@ bool isDifferentiable(Node * n) {
     "aten::gt(Tensor self, Tensor other) -> Tensor",
     "aten::ge(Tensor self, Tensor other) -> Tensor",
     "aten::eq(Tensor self, Tensor other) -> Tensor",
-    "aten::ne(Tensor self, Tensor other) -> Tensor"
+    "aten::ne(Tensor self, Tensor other) -> Tensor",
+    "aten::softmax(Tensor self, int dim) -> Tensor",
+    "aten::log_softmax(Tensor self, int dim) -> Tensor",
+    "aten::embedding(Tensor weight, Tensor indices, int padding_idx, int scale_grad_by_freq, int sparse) -> Tensor",
+    "aten::sum(Tensor self) -> Tensor",
+    "aten::mean(Tensor self) -> Tensor"
   };
 
   if (n->kind() == prim::Constant || n->kind() == prim::AutogradAdd)
@@ -72,8 +77,29 @@ bool isDifferentiable(Node * n) {
   }
   if (n->matches("aten::view(Tensor self, int[] size) -> Tensor") ||
       n->matches("aten::reshape(Tensor self, int[] shape) -> Tensor")) {
+    return true;
+  }
+  if (n->matches("aten::matmul(Tensor self, Tensor other) -> Tensor")) {
+    auto self_type = n->namedInput(attr::self)->type()->cast<TensorType>();
+    auto other_type = n->namedInput(attr::other)->type()->cast<TensorType>();
+    return self_type && other_type && self_type->sizes().size() >= 2 && other_type->sizes().size() == 2;
+  }
+  if (n->matches("aten::sum(Tensor self, int[] dim, int keepdim) -> Tensor", {attr::dim, attr::keepdim}) ||
+      n->matches("aten::mean(Tensor self, int dim, int keepdim) -> Tensor", {attr::dim, attr::keepdim})) {
     return static_cast<bool>(n->namedInput(attr::self)->type()->cast<TensorType>());
   }
+  if (n->matches("aten::_convolution(Tensor input, Tensor weight, Tensor? bias, int[] stride, int[] padding, "
+                 "int[] dilation, int transposed, int[] output_padding, int groups, int benchmark, "
+                 "int deterministic, int cudnn_enabled) -> Tensor")) {
+    // The rank is needed to reduce the gradient of the bias
+    return n->namedInput(attr::bias)->node()->kind() == prim::Undefined ||
+           n->namedInput(attr::input)->type()->cast<TensorType>();
+  }
+  if (n->matches("aten::batch_norm(Tensor input, Tensor? weight, Tensor? bias, Tensor? running_mean, "
+                 "Tensor? running_var, int training, float momentum, float eps, int cudnn_enabled) -> Tensor",
+                 attr::training)) {
+    return static_cast<bool>(n->namedInput(attr::input)->type()->cast<TensorType>());
+  }
 
   // linear blocks may appear as inputs to graph executors, but they are removed
   // before differentiation occurs
@@ -113,6 +139,66 @@ bool outputRequiresGrad(Node* node, std::function<bool(Value*)> requires_grad) {
   }
 }
 
+// Gradients of aten::batch_norm, computed from the input rather than from
+// statistics saved by the forward, which the op doesn't return. In training
+// mode the batch statistics are recomputed, which are a few reductions over
+// the input that the fuser can fuse with the elementwise parts.
+static std::vector<SymbolicVariable> batchNormGradient(Node* node, SymbolicVariable grad) {
+  SymbolicVariable input = node->namedInput(attr::input);
+  auto defined = [](Value* v) {
+    return v->node()->kind() != prim::Undefined;
+  };
+  Value* weight = node->namedInput(attr::weight);
+  Value* bias = node->namedInput(attr::bias);
+  SymbolicVariable eps = node->namedInput(attr::eps);
+
+  // Statistics have one value per channel, i.e. along dimension 1
+  const auto& sizes = input.sizes();
+  std::vector<int64_t> reduced_dims = {0};
+  std::vector<int64_t> stat_sizes(sizes.size(), 1);
+  stat_sizes.at(1) = -1;
+  int64_t count = sizes.at(0);
+  for (size_t i = 2; i < sizes.size(); ++i) {
+    reduced_dims.push_back(i);
+    count *= sizes[i];
+  }
+
+  SymbolicVariable mean, invstd;
+  if (node->get<int64_t>(attr::training).value()) {
+    mean = input.sum(reduced_dims, true) / at::Scalar(count);
+    auto centered = input - mean;
+    auto var = (centered * centered).sum(reduced_dims, true) / at::Scalar(count);
+    invstd = (var + eps).rsqrt();
+  } else {
+    mean = SymbolicVariable(node->namedInput(attr::running_mean)).view(stat_sizes);
+    invstd = (SymbolicVariable(node->namedInput(attr::running_var)).view(stat_sizes) + eps).rsqrt();
+  }
+  auto normalized = (input - mean) * invstd;
+
+  auto dnormalized = grad;
+  if (defined(weight)) {
+    dnormalized = grad * SymbolicVariable(weight).view(stat_sizes);
+  }
+  SymbolicVariable dinput;
+  if (node->get<int64_t>(attr::training).value()) {
+    // dx = invstd / N * (N * dxhat - sum(dxhat) - xhat * sum(dxhat * xhat))
+    auto term = dnormalized * at::Scalar(count) -
+                dnormalized.sum(reduced_dims, true) -
+                normalized * (dnormalized * normalized).sum(reduced_dims, true);
+    dinput = term * invstd / at::Scalar(count);
+  } else {
+    dinput = dnormalized * invstd;
+  }
+  SymbolicVariable dweight, dbias;
+  if (defined(weight)) {
+    dweight = (grad * normalized).sum(reduced_dims, false);
+  }
+  if (defined(bias)) {
+    dbias = grad.sum(reduced_dims, false);
+  }
+  return {dinput, dweight, dbias, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr};
+}
+
 static std::vector<Value*> gradientForNode(Node* node, ArrayRef<Value*> grad_values) {
   const auto build_sym_grad = [node](const std::vector<SymbolicVariable>& grads) -> std::vector<SymbolicVariable> {
     auto inputs = fmap<SymbolicVariable>(node->inputs());
@@ -151,9 +237,100 @@ static std::vector<Value*> gradientForNode(Node* node, ArrayRef<Value*> grad_val
 
     } else if (node->matches("aten::view(Tensor self, int[] size) -> Tensor") ||
                node->matches("aten::reshape(Tensor self, int[] shape) -> Tensor")) {
-      // TODO: if sizes are not available statically, add an operator that reutrns them as a tuple
-      auto sizes = node->namedInput(attr::self)->type()->expect<TensorType>()->sizes();
-      return {grads.at(0).reshape(sizes), nullptr};
+      // Static sizes don't make the backward keep self alive
+      if (auto type = node->namedInput(attr::self)->type()->cast<TensorType>()) {
+        return {grads.at(0).reshape(type->sizes()), nullptr};
+      }
+      return {grads.at(0).reshape_as(inputs.at(0)), nullptr};
+
+    } else if (node->matches("aten::matmul(Tensor self, Tensor other) -> Tensor")) {
+      // isDifferentiable admits only other of 2 dimensions, e.g. a linear
+      // layer applied to a batch of sequences
+      const auto& self_sizes = inputs.at(0).sizes();
+      const auto& other_sizes = inputs.at(1).sizes();
+      auto dself = grads.at(0).matmul(inputs.at(1).t());
+      auto dother = inputs.at(0).reshape({-1, self_sizes.back()}).t()
+                        .mm(grads.at(0).reshape({-1, other_sizes.back()}));
+      return {dself, dother};
+
+    } else if (node->matches("aten::softmax(Tensor self, int dim) -> Tensor")) {
+      return {SymbolicVariable::create(Symbol::aten("softmax_backward_data"),
+                                       {grads.at(0), outputs.at(0), node->namedInput(attr::dim), inputs.at(0)})[0],
+              nullptr};
+
+    } else if (node->matches("aten::log_softmax(Tensor self, int dim) -> Tensor")) {
+      return {SymbolicVariable::create(Symbol::aten("log_softmax_backward_data"),
+                                       {grads.at(0), outputs.at(0), node->namedInput(attr::dim), inputs.at(0)})[0],
+              nullptr};
+
+    } else if (node->matches("aten::embedding(Tensor weight, Tensor indices, int padding_idx, int scale_grad_by_freq, int sparse) -> Tensor")) {
+      auto dweight = SymbolicVariable::create(Symbol::aten("embedding_backward"),
+                                              {grads.at(0), inputs.at(1), inputs.at(0).size(0),
+                                               node->namedInput(attr::padding_idx),
+                                               node->namedInput(attr::scale_grad_by_freq),
+                                               node->namedInput(attr::sparse)})[0];
+      return {dweight, nullptr, nullptr, nullptr, nullptr};
+
+    } else if (node->matches("aten::sum(Tensor self) -> Tensor")) {
+      return {grads.at(0).expand_as(inputs.at(0))};
+
+    } else if (node->matches("aten::mean(Tensor self) -> Tensor")) {
+      auto grad = grads.at(0).expand_as(inputs.at(0));
+      return {SymbolicVariable::create(aten::div, {grad, inputs.at(0).numel()})[0]};
+
+    } else if (node->matches("aten::sum(Tensor self, int[] dim, int keepdim) -> Tensor", {attr::dim, attr::keepdim})) {
+      auto dims = node->get<std::vector<int64_t>>(attr::dim).value();
+      for (auto& dim : dims) {
+        wrapDim(dim, inputs.at(0).sizes());
+      }
+      auto grad = grads.at(0);
+      if (!node->get<int64_t>(attr::keepdim).value()) {
+        std::sort(dims.begin(), dims.end());
+        for (auto dim : dims) {
+          grad = grad.unsqueeze(dim);
+        }
+      }
+      return {grad.expand_as(inputs.at(0)), nullptr, nullptr};
+
+    } else if (node->matches("aten::mean(Tensor self, int dim, int keepdim) -> Tensor", {attr::dim, attr::keepdim})) {
+      auto dim = node->get<int64_t>(attr::dim).value();
+      wrapDim(dim, inputs.at(0).sizes());
+      auto grad = grads.at(0);
+      if (!node->get<int64_t>(attr::keepdim).value()) {
+        grad = grad.unsqueeze(dim);
+      }
+      grad = grad.expand_as(inputs.at(0));
+      return {SymbolicVariable::create(aten::div, {grad, inputs.at(0).size(dim)})[0], nullptr, nullptr};
+
+    } else if (node->matches("aten::_convolution(Tensor input, Tensor weight, Tensor? bias, int[] stride, int[] padding, "
+                             "int[] dilation, int transposed, int[] output_padding, int groups, int benchmark, "
+                             "int deterministic, int cudnn_enabled) -> Tensor")) {
+      // The gradient of the input is the double backward of the convolution
+      // for a change of the weight by `weight`, and vice versa.
+      auto& graph = *node->owningGraph();
+      auto undef = graph.insertNode(graph.createUndefined())->output();
+      std::vector<SymbolicVariable> args = {inputs.at(0), inputs.at(1), undef, grads.at(0), inputs.at(1), inputs.at(0)};
+      for (size_t i = 3; i < inputs.size(); ++i) {
+        args.push_back(inputs.at(i));
+      }
+      args.push_back(graph.insertConstant(std::vector<int64_t>{0, 1, 1}));
+      auto conv_grads = SymbolicVariable::create(Symbol::aten("_convolution_double_backward"), args, 3);
+      SymbolicVariable dbias;
+      if (node->namedInput(attr::bias)->node()->kind() != prim::Undefined) {
+        std::vector<int64_t> dims = {0};
+        for (size_t i = 2; i < inputs.at(0).sizes().size(); ++i) {
+          dims.push_back(i);
+        }
+        dbias = grads.at(0).sum(dims, false);
+      }
+      std::vector<SymbolicVariable> result = {conv_grads.at(1), conv_grads.at(2), dbias};
+      result.resize(inputs.size());
+      return result;
+
+    } else if (node->matches("aten::batch_norm(Tensor input, Tensor? weight, Tensor? bias, Tensor? running_mean, "
+                             "Tensor? running_var, int training, float momentum, float eps, int cudnn_enabled) -> Tensor",
+                             attr::training)) {
+      return batchNormGradient(node, grads.at(0));
 
     } else if (node->matches("aten::type_as(Tensor self, Tensor other) -> Tensor")) {
       return {grads.at(0).type_as(inputs.at(0)), nullptr};
@@ -0,0 +1,185 @@
+#include "BatchingExecutor.h"
+#include "BatchTensor.h"
+
+#include "torch/csrc/autograd/grad_mode.h"
+
+namespace torch { namespace jit {
+
+BatchingExecutor::BatchingExecutor(
+    std::shared_ptr<Graph> batched_graph,
+    std::vector<at::Tensor> dims,
+    int64_t max_batch_size,
+    std::chrono::microseconds max_delay)
+    : executor_(std::move(batched_graph))
+    , dims_(std::move(dims))
+    , max_batch_size_(max_batch_size)
+    , max_delay_(max_delay) {
+  if (max_batch_size < 1) {
+    throw std::runtime_error("BatchingExecutor: max_batch_size must be positive, got "
+      + std::to_string(max_batch_size));
+  }
+  for (const auto& d : dims_) {
+    std::vector<bool> dynamic;
+    for (int64_t i = 0; i < d.size(0); i++) {
+      dynamic.push_back(*d[i].toByteData() != 0);
+    }
+    dynamic_.push_back(std::move(dynamic));
+  }
+  worker_ = std::thread([this] { workerLoop(); });
+}
+
+BatchingExecutor::~BatchingExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  cv_.notify_all();
+  worker_.join();
+}
+
+std::future<std::vector<at::Tensor>> BatchingExecutor::submit(std::vector<at::Tensor> inputs) {
+  if (inputs.size() != dims_.size()) {
+    throw std::runtime_error("BatchingExecutor: expected " + std::to_string(dims_.size())
+      + " inputs but got " + std::to_string(inputs.size()));
+  }
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (size_t(inputs[i].dim()) != dynamic_[i].size()) {
+      throw std::runtime_error("BatchingExecutor: expected input " + std::to_string(i)
+        + " to have " + std::to_string(dynamic_[i].size()) + " dimensions but it has "
+        + std::to_string(inputs[i].dim()));
+    }
+  }
+  Request request;
+  request.inputs = std::move(inputs);
+  request.arrival = std::chrono::steady_clock::now();
+  auto result = request.result.get_future();
+  bool notify;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopped_) {
+      throw std::runtime_error("BatchingExecutor: submit called during destruction");
+    }
+    queue_.push_back(std::move(request));
+    // the worker only needs waking up for the first request of a batch and
+    // for the one that fills it
+    notify = queue_.size() == 1 || queue_.size() == max_batch_size_;
+  }
+  if (notify)
+    cv_.notify_one();
+  return result;
+}
+
+void BatchingExecutor::workerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return stopped_ || !queue_.empty(); });
+    if (queue_.empty())
+      return;
+    auto deadline = queue_.front().arrival + max_delay_;
+    cv_.wait_until(lock, deadline, [this] {
+      return stopped_ || queue_.size() >= max_batch_size_;
+    });
+    std::vector<Request> batch;
+    while (!queue_.empty() && batch.size() < max_batch_size_) {
+      batch.push_back(std::move(queue_.front()));
+      queue_.pop_front();
+    }
+    lock.unlock();
+    runBatch(batch);
+    lock.lock();
+  }
+}
+
+void BatchingExecutor::runBatch(std::vector<Request>& batch) {
+  // examples are only padded in dynamic dimensions, so the static ones have
+  // to agree across the batch
+  const auto& first = batch[0].inputs;
+  std::vector<Request*> runnable;
+  for (auto& request : batch) {
+    bool matches = true;
+    for (size_t i = 0; i < first.size() && matches; i++) {
+      for (size_t d = 0; d < dynamic_[i].size(); d++) {
+        if (!dynamic_[i][d] && request.inputs[i].size(d) != first[i].size(d)) {
+          matches = false;
+          break;
+        }
+      }
+    }
+    if (matches) {
+      runnable.push_back(&request);
+    } else {
+      request.result.set_exception(std::make_exception_ptr(std::runtime_error(
+        "BatchingExecutor: the static dimensions of the inputs don't match "
+        "those of the other requests in the batch")));
+    }
+  }
+
+  try {
+    autograd::AutoGradMode no_grad(false);
+    Stack stack;
+    for (size_t i = 0; i < dims_.size(); i++) {
+      std::vector<at::Tensor> examples;
+      examples.reserve(runnable.size());
+      for (auto request : runnable) {
+        examples.push_back(request->inputs[i].unsqueeze(0));
+      }
+      BatchTensor input(examples, dims_[i]);
+      stack.emplace_back(input.data);
+      stack.emplace_back(input.mask);
+      stack.emplace_back(input.dims);
+    }
+    executor_.run(stack);
+    JIT_ASSERT(stack.size() % 3 == 0);
+
+    std::vector<std::vector<at::Tensor>> results(runnable.size());
+    for (size_t i = 0; i < stack.size(); i += 3) {
+      BatchTensor output(stack[i].toTensor(), stack[i + 1].toTensor(), stack[i + 2].toTensor());
+      auto examples = output.examples();
+      JIT_ASSERT(examples.size() == runnable.size());
+      for (size_t j = 0; j < runnable.size(); j++) {
+        results[j].push_back(examples[j].squeeze(0));
+      }
+    }
+    for (size_t j = 0; j < runnable.size(); j++) {
+      runnable[j]->result.set_value(std::move(results[j]));
+    }
+  } catch (...) {
+    for (auto request : runnable) {
+      request->result.set_exception(std::current_exception());
+    }
+  }
+}
+
+void initBatchingExecutorBindings(PyObject* module) {
+  auto m = py::handle(module).cast<py::module>();
+  auto jit = m.def_submodule("_jit");
+  py::class_<BatchingExecutor>(jit, "BatchingExecutor")
+      .def(py::init([](std::shared_ptr<Graph> batched_graph, std::vector<at::Tensor> dims,
+                       int64_t max_batch_size, double max_delay) {
+        return new BatchingExecutor(
+            std::move(batched_graph), std::move(dims), max_batch_size,
+            std::chrono::microseconds(static_cast<int64_t>(max_delay * 1e6)));
+      }))
+      .def("__call__", [](BatchingExecutor& self, py::args args) -> py::object {
+        std::vector<at::Tensor> inputs;
+        for (auto arg : args) {
+          inputs.push_back(py::cast<at::Tensor>(arg));
+        }
+        std::vector<at::Tensor> outputs;
+        {
+          // let the other clients queue their requests while this one waits
+          py::gil_scoped_release no_gil;
+          outputs = self.run(std::move(inputs));
+        }
+        if (outputs.size() == 1) {
+          return py::cast(outputs[0]);
+        }
+        py::tuple result(outputs.size());
+        for (size_t i = 0; i < outputs.size(); i++) {
+          result[i] = py::cast(outputs[i]);
+        }
+        return std::move(result);
+      });
+}
+
+}} // namespace torch::jit
@@ -0,0 +1,72 @@
+#pragma once
+#include "ATen/ATen.h"
+#include "torch/csrc/jit/graph_executor.h"
+#include "torch/csrc/jit/pybind.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace torch { namespace jit {
+
+// Runs a graph transformed by to_batch_graph on requests that each carry a
+// single example, so that clients (e.g. the threads of an inference server)
+// get the throughput of batched execution without batching themselves.
+//
+// Requests are queued, and a worker thread takes up to max_batch_size of
+// them at a time: it waits at most max_delay after the oldest one arrived for
+// the batch to fill up. The examples of every input are packed into a
+// BatchTensor, the batched graph runs once, and every request gets its own
+// examples of the outputs.
+//
+// dims has one entry per input of the original graph, in the format of
+// BatchTensor::dims: whether each dimension of the input may vary between
+// requests. Requests whose static dimensions don't match those of the oldest
+// request in their batch fail without affecting the others.
+struct BatchingExecutor {
+  BatchingExecutor(
+      std::shared_ptr<Graph> batched_graph,
+      std::vector<at::Tensor> dims,
+      int64_t max_batch_size,
+      std::chrono::microseconds max_delay);
+  // Finishes the requests that are already queued before returning.
+  ~BatchingExecutor();
+
+  // Safe to call from many threads at once. inputs are the inputs of the
+  // original graph for one example, without a batch dimension, and so are
+  // the results.
+  std::future<std::vector<at::Tensor>> submit(std::vector<at::Tensor> inputs);
+  std::vector<at::Tensor> run(std::vector<at::Tensor> inputs) {
+    return submit(std::move(inputs)).get();
+  }
+
+private:
+  struct Request {
+    std::vector<at::Tensor> inputs;
+    std::promise<std::vector<at::Tensor>> result;
+    std::chrono::steady_clock::time_point arrival;
+  };
+
+  void workerLoop();
+  void runBatch(std::vector<Request>& batch);
+
+  GraphExecutor executor_;
+  const std::vector<at::Tensor> dims_;
+  // dims_ read back, dynamic_[i][d] is whether dimension d of input i is dynamic
+  std::vector<std::vector<bool>> dynamic_;
+  const size_t max_batch_size_;
+  const std::chrono::microseconds max_delay_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Request> queue_;
+  bool stopped_ = false;
+  std::thread worker_;
+};
+
+void initBatchingExecutorBindings(PyObject* module);
+}} // namespace torch::jit
@@ -70,23 +70,25 @@ RegisterOperators reg({
             return 0;
           };
         } else if(type->isSubtypeOf(ListType::ofInts())) {
-          auto is = node->is(attr::value);
+          // lists and strings are immutable, so every run shares the one
+          // built here instead of allocating a copy
+          IValue is(node->is(attr::value));
           return [is](Stack& stack) {
-            push(stack, is);
+            stack.push_back(is);
             return 0;
           };
         } else if(type->isSubtypeOf(ListType::ofTensors())) {
-          auto ts = fmap(node->ts(attr::value), [](const at::Tensor & t) -> at::Tensor {
+          IValue ts(fmap(node->ts(attr::value), [](const at::Tensor & t) -> at::Tensor {
             return autograd::make_variable(t);
-          });
+          }));
           return [ts](Stack& stack) {
-            push(stack, ts);
+            stack.push_back(ts);
             return 0;
           };
         } else if (type == StringType::get()) {
-          auto s = node->s(attr::string);
+          IValue s(node->s(attr::string));
           return [s](Stack& stack) {
-            push(stack, s);
+            stack.push_back(s);
             return 0;
           };
         } else {
@@ -0,0 +1,173 @@
+#include "torch/csrc/jit/cuda_graph_runner.h"
+
+#include "torch/csrc/jit/assertions.h"
+
+#ifdef USE_CUDA
+#include "ATen/DeviceGuard.h"
+#include "ATen/cuda/CUDAContext.h"
+#include "ATen/cuda/CUDAEvent.h"
+#include "ATen/cuda/CUDAGraph.h"
+#endif
+
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace torch { namespace jit {
+
+namespace {
+
+std::atomic<bool>& cudaGraphsFlag() {
+  static std::atomic<bool> enabled([] {
+    const char* env = std::getenv("PYTORCH_JIT_CUDA_GRAPHS");
+    return env && std::string(env) == "1";
+  }());
+  return enabled;
+}
+
+} // anonymous namespace
+
+#ifdef USE_CUDA
+
+struct CUDAGraphRunnerImpl {
+  CUDAGraphRunnerImpl(size_t num_inputs, size_t num_outputs)
+    : num_inputs(num_inputs), num_outputs(num_outputs) {}
+
+  bool run(Stack & stack, const std::function<void(Stack&)> & run_plan) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (unsupported) {
+      return false;
+    }
+    auto inputs = last(stack, num_inputs);
+    if (!checkInputs(inputs)) {
+      unsupported = true;
+      return false;
+    }
+    if (num_runs++ == 0) {
+      return false;
+    }
+    at::DeviceGuard guard(inputs[0].toTensor());
+    if (!graph.has_graph() && !capture(inputs, run_plan)) {
+      unsupported = true;
+      return false;
+    }
+
+    // the previous replay's outputs have been copied out
+    auto stream = at::cuda::getCurrentCUDAStream();
+    stream.synchronize_with(last_use);
+    for (size_t i = 0; i < num_inputs; ++i) {
+      static_inputs[i].copy_(inputs[i].toTensor());
+    }
+    graph.replay();
+    drop(stack, num_inputs);
+    for (auto & output : static_outputs) {
+      stack.emplace_back(output.clone());
+    }
+    last_use.record(stream);
+    return true;
+  }
+
+private:
+  // all inputs are defined CUDA tensors on one device
+  bool checkInputs(at::ArrayRef<IValue> inputs) {
+    int64_t device = -1;
+    for (auto & input : inputs) {
+      if (!input.isTensor()) {
+        return false;
+      }
+      auto & t = input.toTensor();
+      if (!t.defined() || !t.is_cuda()) {
+        return false;
+      }
+      if (device != -1 && t.get_device() != device) {
+        return false;
+      }
+      device = t.get_device();
+    }
+    return device != -1;
+  }
+
+  bool capture(at::ArrayRef<IValue> inputs, const std::function<void(Stack&)> & run_plan) {
+    Stack capture_stack;
+    for (auto & input : inputs) {
+      auto & t = input.toTensor();
+      static_inputs.push_back(at::empty_like(t).copy_(t));
+      capture_stack.emplace_back(static_inputs.back());
+    }
+    graph.capture_begin();
+    try {
+      run_plan(capture_stack);
+    } catch (const std::exception &) {
+      try {
+        graph.capture_end();
+      } catch (const std::exception &) {}
+      graph.reset();
+      static_inputs.clear();
+      return false;
+    }
+    try {
+      graph.capture_end();
+    } catch (const std::exception &) {
+      static_inputs.clear();
+      return false;
+    }
+    JIT_ASSERT(capture_stack.size() == num_outputs);
+    for (auto & output : capture_stack) {
+      if (!output.isTensor() || !output.toTensor().defined()) {
+        graph.reset();
+        static_inputs.clear();
+        static_outputs.clear();
+        return false;
+      }
+      static_outputs.push_back(output.toTensor());
+    }
+    return true;
+  }
+
+  const size_t num_inputs;
+  const size_t num_outputs;
+
+  // guards everything below; replays share the static inputs and outputs
+  std::mutex mutex;
+  size_t num_runs = 0;
+  bool unsupported = false;
+
+  at::cuda::CUDAGraph graph;
+  std::vector<at::Tensor> static_inputs;
+  std::vector<at::Tensor> static_outputs;
+  // recorded after the outputs of the last replay were copied out
+  at::cuda::CUDAEvent last_use;
+};
+
+#else
+
+struct CUDAGraphRunnerImpl {
+  CUDAGraphRunnerImpl(size_t num_inputs, size_t num_outputs) {}
+
+  bool run(Stack & stack, const std::function<void(Stack&)> & run_plan) {
+    return false;
+  }
+};
+
+#endif
+
+CUDAGraphRunner::CUDAGraphRunner(size_t num_inputs, size_t num_outputs)
+  : pImpl(new CUDAGraphRunnerImpl(num_inputs, num_outputs)) {}
+
+CUDAGraphRunner::~CUDAGraphRunner() = default;
+
+bool CUDAGraphRunner::run(Stack & stack, const std::function<void(Stack&)> & run_plan) {
+  return pImpl->run(stack, run_plan);
+}
+
+void setCUDAGraphsEnabled(bool enabled) {
+  cudaGraphsFlag() = enabled;
+}
+
+bool cudaGraphsEnabled() {
+  return cudaGraphsFlag();
+}
+
+}}
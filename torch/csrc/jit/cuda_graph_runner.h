@@ -0,0 +1,43 @@
+#pragma once
+
+#include "torch/csrc/WindowsTorchApiMacro.h"
+#include "torch/csrc/jit/stack.h"
+
+#include <functional>
+#include <memory>
+
+namespace torch { namespace jit {
+
+struct CUDAGraphRunnerImpl;
+
+// Runs an execution plan by replaying a CUDA graph of it (see
+// ATen/cuda/CUDAGraph.h), which launches all of its kernels at once.
+//
+// The first run of the plan runs as usual, so that lazily initialized state
+// (e.g. compiled fusion kernels) exists before the second run is captured.
+// The graph reads its inputs from copies made when it was captured and
+// writes its outputs to the tensors allocated while capturing, so every
+// replay copies the inputs in and returns copies of the outputs. Plans
+// whose inputs or outputs aren't all CUDA tensors on one device, or that
+// can't be captured (e.g. because an op synchronizes with the CPU), are
+// never replayed.
+struct TORCH_API CUDAGraphRunner {
+  CUDAGraphRunner(size_t num_inputs, size_t num_outputs);
+  ~CUDAGraphRunner();
+
+  // Pops the inputs of the plan off the stack and pushes its outputs, using
+  // run_plan to run or capture the plan. Returns false, leaving the stack
+  // alone, if the plan should be run as usual instead.
+  bool run(Stack & stack, const std::function<void(Stack&)> & run_plan);
+
+private:
+  std::unique_ptr<CUDAGraphRunnerImpl> pImpl;
+};
+
+// Whether GraphExecutor replays its execution plans as CUDA graphs. Defaults
+// to false unless the PYTORCH_JIT_CUDA_GRAPHS environment variable is set to
+// 1. Requires CUDA 10.1 or later.
+TORCH_API void setCUDAGraphsEnabled(bool enabled);
+TORCH_API bool cudaGraphsEnabled();
+
+}}
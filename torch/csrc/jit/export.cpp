@@ -10,6 +10,7 @@
 #include <ATen/ATen.h>
 #include <ATen/core/optional.h>
 
+#include <fstream>
 #include <memory>
 #include <vector>
 #include <string>
@@ -328,9 +329,10 @@ class GraphEncoder: public EncoderBase {
                onnx_torch::OperatorExportTypes operator_export_type,
                const std::vector<at::Tensor> &initializers,
                bool defer_weight_export,
-               bool strip_doc);
+               bool strip_doc,
+               std::string external_data_directory = "");
 
-  RawDataExportMap get_raw_data_export_map() {
+  const RawDataExportMap& get_raw_data_export_map() const {
     return raw_data_export_map_;
   }
 
@@ -341,6 +343,7 @@ class GraphEncoder: public EncoderBase {
 
    RawDataExportMap raw_data_export_map_;
    bool defer_weight_export_;
+   std::string external_data_directory_;
 };
 
 GraphEncoder::GraphEncoder(
@@ -349,9 +352,11 @@ GraphEncoder::GraphEncoder(
     onnx_torch::OperatorExportTypes operator_export_type,
     const std::vector<at::Tensor> &initializers,
     bool defer_weight_export,
-    bool strip_doc)
+    bool strip_doc,
+    std::string external_data_directory)
     : EncoderBase(operator_export_type, strip_doc),
-      defer_weight_export_(defer_weight_export) {
+      defer_weight_export_(defer_weight_export),
+      external_data_directory_(std::move(external_data_directory)) {
   if (operator_export_type != onnx_torch::OperatorExportTypes::RAW) {
     validateGraph(graph, operator_export_type);
   }
@@ -380,8 +385,19 @@ void GraphEncoder::EncodeTensor(
     // For now, we use the name of the tensor as the external lookup name to
     // avoid ONNX protobuf changes.
     JIT_ASSERT(external_ref.value() == tensor_proto->name());
-    JIT_ASSERT(raw_data_export_map_.count(external_ref.value()) == 0);
-    raw_data_export_map_[external_ref.value()] = t;
+    if (!external_data_directory_.empty()) {
+      // write it now, so that at most one tensor is held on the CPU at a time
+      JIT_ASSERT(t.is_contiguous());
+      auto filename = external_data_directory_ + "/" + external_ref.value();
+      std::ofstream stream(filename, std::ios::binary);
+      stream.write(static_cast<const char*>(t.data_ptr()), t.type().elementSizeInBytes() * t.numel());
+      if (!stream) {
+        throw std::runtime_error("ONNX export failed: couldn't write " + filename);
+      }
+    } else {
+      JIT_ASSERT(raw_data_export_map_.count(external_ref.value()) == 0);
+      raw_data_export_map_[external_ref.value()] = t;
+    }
     tensor_proto->set_raw_data("__EXTERNAL");
   } else {
     JIT_ASSERT(t.is_contiguous());
@@ -474,16 +490,15 @@ void ModuleEncoder::EncodeTypeInfo(
     TensorTypePtr node_type = type->cast<TensorType>();
     const std::vector<std::int64_t>& sizes = node_type->sizes();
 
-    // store the sizes and strides in the dims field of TensorShapeProto
-    for (size_t i = 0; i < sizes.size(); i++) {
-      shape_proto->add_dim();
-      shape_proto->mutable_dim(i)->set_dim_value(sizes[i]);
+    // store the sizes, the strides and the device in the dims field of
+    // TensorShapeProto
+    for (auto size : sizes) {
+      shape_proto->add_dim()->set_dim_value(size);
     }
-    const std::vector<std::int64_t>& strides = node_type->strides();
-    for (size_t i = 0; i < strides.size(); i++) {
-      shape_proto->add_dim();
-      shape_proto->mutable_dim(i)->set_dim_value(strides[i]);
+    for (auto stride : node_type->strides()) {
+      shape_proto->add_dim()->set_dim_value(stride);
     }
+    shape_proto->add_dim()->set_dim_value(node_type->device());
     tensortype_proto->set_elem_type(ATenTypeToOnnxType(node_type->scalarType()));
   } else if (kind == TypeKind::TupleType) {
     type_proto->set_denotation("TupleType");
@@ -611,6 +626,15 @@ void ModuleEncoder::EncodeMethod(
     }
   }
   EncodeBlock(attr_proto->mutable_g(), method.graph()->block(), {});
+
+  // The plans the method has compiled so far, so that loading the module
+  // doesn't have to optimize it again for the same inputs.
+  for (auto & optimized : method.optimized_graphs()) {
+    auto plan_proto = node_proto->add_attribute();
+    plan_proto->set_name("_plan");
+    plan_proto->set_type(onnx::AttributeProto_AttributeType_GRAPH);
+    EncodeBlock(plan_proto->mutable_g(), optimized->block(), {});
+  }
 }
 
 void ModuleEncoder::EncodeTensor(
@@ -630,13 +654,17 @@ void ModuleEncoder::EncodeTensor(
       t = tensor.type().tensor(
           *tensor.storage(),
           /* storageOffset = */ 0,
-          /* size = */ { static_cast<int64_t>(tensor.type().elementSizeInBytes() * tensor.storage()->pImpl()->size()) },
+          /* size = */ { static_cast<int64_t>(tensor.storage()->pImpl()->size()) },
           /* strides = */ { 1 })
         .cpu();
     }
 
+    // The record holds the whole storage, so that tensors with an offset or
+    // views sharing it can be rebuilt, and its size is exactly that of the
+    // storage, which import relies on when it maps records.
     auto record_number = file_writer_.writeRecord(
-      static_cast<char*>(t.storage()->pImpl()->data()), t.type().elementSizeInBytes() * t.numel());
+      static_cast<char*>(t.storage()->pImpl()->data()),
+      t.type().elementSizeInBytes() * t.storage()->pImpl()->size());
     tensor_proto->add_int64_data(record_number);
     storage_dedup_map_[storage_ptr] = record_number;
   }
@@ -854,9 +882,11 @@ std::tuple<std::string, RawDataExportMap> ExportGraph(
                         const std::vector<at::Tensor> &initializers,
                         int64_t onnx_opset_version,
                         bool defer_weight_export,
-                        ::torch::onnx::OperatorExportTypes operator_export_type) {
+                        ::torch::onnx::OperatorExportTypes operator_export_type,
+                        const std::string& external_data_directory) {
   auto graph_encoder = GraphEncoder(
-    graph, onnx_opset_version, operator_export_type, initializers, defer_weight_export, false);
+    graph, onnx_opset_version, operator_export_type, initializers, defer_weight_export, false,
+    external_data_directory);
   return std::make_tuple(graph_encoder.get_model_proto().SerializeAsString(),
                          graph_encoder.get_raw_data_export_map());
 }
@@ -16,13 +16,20 @@ namespace torch { namespace jit {
 // file contents being the raw tensor data.
 using RawDataExportMap = std::unordered_map<std::string, at::Tensor>;
 
+// If `external_data_directory` is given along with `defer_weight_export`, the
+// deferred parameters are instead written to files in that directory (named
+// like the keys of the export map) as soon as they are encoded, and the
+// returned map is empty. Each file is written straight from the tensor's
+// memory, so neither the serialized proto nor the map ever holds the weights,
+// which lets models past protobuf's 2GB limit be exported.
 TORCH_API std::tuple<std::string, RawDataExportMap> ExportGraph(
     const std::shared_ptr<Graph>& graph,
     const std::vector<at::Tensor>& initializers,
     int64_t onnx_opset_version,
     bool defer_weight_export = false,
     ::torch::onnx::OperatorExportTypes operator_export_type
-      = ::torch::onnx::OperatorExportTypes::ONNX);
+      = ::torch::onnx::OperatorExportTypes::ONNX,
+    const std::string& external_data_directory = "");
 
 // For testing purposes
 TORCH_API std::string PrettyPrintExportedGraph(
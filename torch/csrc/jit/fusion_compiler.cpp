@@ -11,9 +11,12 @@
 #include <torch/csrc/jit/assertions.h>
 
 #include "ATen/ATen.h"
+#include "ATen/Parallel.h"
+#include "ATen/native/DispatchStub.h"
 
 #ifdef USE_CUDA
 #include "ATen/cuda/CUDAContext.h"
+#include "ATen/cuda/PhiloxCudaState.h"
 #include "THC/THC.h"
 #include <THC/THCGenerator.hpp>
 #include "torch/csrc/cuda/cuda_check.h"
@@ -28,6 +31,8 @@
 #include <vector>
 #include <sstream>
 #include <iostream>
+#include <fstream>
+#include <iterator>
 #include <dlfcn.h>
 #include <unistd.h>
 
@@ -51,6 +56,92 @@ std::vector<bool> TensorDesc::findContiguous(
 
 namespace {
 
+struct TempFile {
+  TH_DISALLOW_COPY_AND_ASSIGN(TempFile);
+  TempFile(const std::string & t, int suffix) {
+    // mkstemps edits its first argument in places
+    // so we make a copy of the string here, including null terminator
+    std::vector<char> tt(t.c_str(), t.c_str() + t.size() + 1);
+    int fd = mkstemps(tt.data(), suffix);
+    JIT_ASSERT(fd != -1);
+    file_ = fdopen(fd, "r+");
+
+    // - 1 becuase tt.size() includes the null terminator,
+    // but std::string does not expect one
+    name_ = std::string(tt.begin(), tt.end() - 1);
+  }
+  const std::string & name() const {
+    return name_;
+  }
+  void sync() {
+    fflush(file_);
+  }
+  void write(const std::string & str) {
+    size_t result = fwrite(str.c_str(), 1, str.size(), file_);
+    JIT_ASSERT(str.size() == result);
+  }
+  FILE* file()  {
+    return file_;
+  }
+  ~TempFile() {
+    if(file_ != nullptr) {
+      // unlink first to ensure another mkstemps doesn't
+      // race between close and unlink
+      unlink(name_.c_str());
+      fclose(file_);
+    }
+  }
+private:
+  FILE * file_ = nullptr;
+  std::string name_;
+};
+
+// 64-bit FNV-1a. Used instead of std::hash so that cache keys are stable
+// across processes and standard library implementations.
+static std::string stableHash(const std::string & str) {
+  uint64_t h = 14695981039346656037ULL;
+  for (unsigned char ch : str) {
+    h ^= ch;
+    h *= 1099511628211ULL;
+  }
+  std::ostringstream out;
+  out << std::hex << h;
+  return out.str();
+}
+
+static bool fileExists(const std::string & path) {
+  return access(path.c_str(), R_OK) == 0;
+}
+
+// Moves a fully written temporary file into the disk cache. Renaming within
+// a directory is atomic, so concurrent processes see either no entry or a
+// complete one. Returns false if the file could not be moved.
+static bool publishCacheFile(TempFile & file, const std::string & path) {
+  file.sync();
+  return rename(file.name().c_str(), path.c_str()) == 0;
+}
+
+static std::vector<char> readFile(const std::string & path) {
+  std::ifstream in(path, std::ios::binary);
+  return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// Generated kernels are emitted with a fixed name: each one is loaded into its
+// own module or library, and a fixed name keeps the generated source, and thus
+// the disk cache key, independent of the order kernels are compiled in.
+static const std::string kernel_symbol = "pytorch_fused_kernel";
+
+// Returns the prim::FusedReduce that ends the fusion group, or nullptr if the
+// group is purely pointwise. The graph fuser only creates reduction groups with
+// the reduction as their sole output.
+static Node * findFusedReduce(Graph & graph) {
+  auto outputs = graph.outputs();
+  if (outputs.size() == 1 && outputs[0]->node()->kind() == prim::FusedReduce) {
+    return outputs[0]->node();
+  }
+  return nullptr;
+}
+
 #ifdef USE_CUDA
 
 static int ceilDiv(int a, int b) {
@@ -212,17 +303,29 @@ void ${kernelName}(IndexType totalElements, ${formals} ${RandParam}) {
 }
 )");
 
+// CPU kernels process the range [begin, end) of linear indices; the host
+// splits the full range across threads with at::parallel_for, so the
+// generated code does not depend on OpenMP. When every tensor is contiguous
+// the index computations reduce to linearIndex and the loop is marked as
+// free of loop-carried dependencies so that the compiler vectorizes it.
 auto cpu_compilation_unit_template = CodeTemplate(R"(
 #include <cstddef>
 #include <cstdint>
 #include <math.h>
 ${type_declarations}
 
-#define OMP_THRESHOLD 100000
-static void ${kernelName}_kernel(IndexType totalElements, ${formals}) {
-  #pragma omp parallel for if(totalElements > OMP_THRESHOLD)
-  for (IndexType linearIndex = 0;
-        linearIndex < totalElements;
+#if defined(__clang__)
+#define FUSED_VECTORIZE _Pragma("clang loop vectorize(enable) interleave(enable)")
+#elif defined(__GNUC__)
+#define FUSED_VECTORIZE _Pragma("GCC ivdep")
+#else
+#define FUSED_VECTORIZE
+#endif
+
+static void ${kernelName}_kernel(IndexType begin, IndexType end, ${formals}) {
+  ${vectorizePragma}
+  for (IndexType linearIndex = begin;
+        linearIndex < end;
         linearIndex += 1) {
       // Convert `linearIndex` into an offset of tensor:
       ${tensorOffsets}
@@ -232,8 +335,63 @@ static void ${kernelName}_kernel(IndexType totalElements, ${formals}) {
 }
 
 extern "C"
-void ${kernelName}(IndexType totalElements, void ** args) {
-  ${kernelName}_kernel(totalElements ${,argument_loads});
+void ${kernelName}(IndexType begin, IndexType end, void ** args) {
+  ${kernelName}_kernel(begin, end ${,argument_loads});
+}
+)");
+
+// Reduction kernels iterate over the elements of the output instead. For each
+// of them the fused pointwise ops are evaluated at every position of the map
+// along the reduced dimension, and their result is accumulated in a register.
+// reduceStride is the number of map elements between consecutive positions
+// along that dimension.
+auto reduce_loop_template = CodeTemplate(R"(
+IndexType reduceBase = (outputIndex / reduceStride) * reduceSize * reduceStride + outputIndex % reduceStride;
+float accumulator = 0;
+for (IndexType reduceIndex = 0; reduceIndex < reduceSize; ++reduceIndex) {
+  IndexType linearIndex = reduceBase + reduceIndex * reduceStride;
+  // Convert `linearIndex` into an offset of tensor:
+  ${tensorOffsets}
+  // calculate the values being reduced
+  ${kernelBody}
+  accumulator += ${reduceInput};
+}
+// Convert `outputIndex` into an offset of the output:
+${outputOffsets}
+${outputBody}
+)");
+
+auto cuda_reduce_compilation_unit_template = CodeTemplate(R"(
+${type_declarations}
+
+extern "C" __global__
+void ${kernelName}(IndexType totalElements, IndexType reduceSize, IndexType reduceStride, ${formals}) {
+  for (IndexType outputIndex = blockIdx.x * blockDim.x + threadIdx.x;
+        outputIndex < totalElements;
+        outputIndex += gridDim.x * blockDim.x) {
+      ${reduceLoop}
+    }
+}
+)");
+
+auto cpu_reduce_compilation_unit_template = CodeTemplate(R"(
+#include <cstddef>
+#include <cstdint>
+#include <math.h>
+${type_declarations}
+
+static void ${kernelName}_kernel(IndexType begin, IndexType end, IndexType reduceSize, IndexType reduceStride, ${formals}) {
+  for (IndexType outputIndex = begin;
+        outputIndex < end;
+        outputIndex += 1) {
+      ${reduceLoop}
+    }
+}
+
+extern "C"
+void ${kernelName}(IndexType begin, IndexType end, void ** args) {
+  ${kernelName}_kernel(begin, end,
+    *static_cast<IndexType*>(args[1]), *static_cast<IndexType*>(args[2]) ${,argument_loads});
 }
 )");
 
@@ -284,11 +442,12 @@ size_t ${tensor}_dimIndex${d} = ${tensor}_linearIndex ${mod_sizes};
 ${tensor}_offset += ${tensor}_dimIndex${d} ${times_stride};
 )");
 
-static void emitIndexingFor(std::ostream & out, const std::string & tensor, int ndim, bool last_is_cont) {
+static void emitIndexingFor(std::ostream & out, const std::string & tensor, int ndim, bool last_is_cont, const std::string & index) {
   TemplateEnv env;
   env.s("tensor",tensor);
+  env.s("index",index);
   out << format("IndexType ${tensor}_offset = 0;\n",env);
-  out << format("IndexType ${tensor}_linearIndex = linearIndex;\n",env);
+  out << format("IndexType ${tensor}_linearIndex = ${index};\n",env);
   for(int d = ndim - 1; d >= 0; --d) {
     env.d("d",d);
     env.s("mod_sizes", d > 0 ? format("% ${tensor}.sizes[${d}]",env) : "");
@@ -442,16 +601,31 @@ std::tuple<std::vector<PartitionDesc>,std::vector<PartitionDesc>,bool> emitCompi
   // TODO: handle cases where we need to generate > 2^32 element tensors
   env.s("IndexType","unsigned int"); //avoiding slow header includes to get uint32_t
 
+  Node * reduce = findFusedReduce(subgraph);
+
   std::stringstream body;
   std::stringstream tensorOffsets;
+  // reduction kernels index their output by outputIndex rather than by
+  // linearIndex, and write it after the reduction loop
+  std::stringstream outputBody;
+  std::stringstream outputOffsets;
   std::vector<std::string> formals;
   std::vector<std::string> argument_loads;
-  auto emitFormal = [&](Value * n, const TensorDesc & desc) {
+  // true if every input and output collapses to a single contiguous dim
+  bool all_contiguous = true;
+  auto emitFormal = [&](Value * n, const TensorDesc & desc, bool is_output) {
     std::string tensor = "t" + std::to_string(formals.size()); //can't be unique() because Param may be an output
     size_t nDim = desc.nDim();
-    emitIndexingFor(tensorOffsets, tensor, nDim,  desc.lastIsContiguous());
+    all_contiguous = all_contiguous && nDim <= 1 && desc.lastIsContiguous();
+    if (reduce && is_output) {
+      emitIndexingFor(outputOffsets, tensor, nDim, desc.lastIsContiguous(), "outputIndex");
+    } else {
+      emitIndexingFor(tensorOffsets, tensor, nDim, desc.lastIsContiguous(), "linearIndex");
+    }
     env.s("tensor",tensor);
-    env.d("formal_index", formals.size() + 1); // + 1 because the first argument is the linearIndex
+    // the first argument is numel, followed by the reduction size and stride
+    // for reduction kernels
+    env.d("formal_index", formals.size() + (reduce ? 3 : 1));
     env.d("nDim",nDim);
     env.s("scalar_type",scalarTypeName(desc.scalar_type));
     formals.push_back(format("TensorInfo<${scalar_type},${nDim}> ${tensor}",env));
@@ -479,7 +653,7 @@ std::tuple<std::vector<PartitionDesc>,std::vector<PartitionDesc>,bool> emitCompi
       }
     }
     for (auto & input : flat_inputs) {
-      emitFormal(input.first, input.second);
+      emitFormal(input.first, input.second, false);
     }
   }
 
@@ -490,14 +664,14 @@ std::tuple<std::vector<PartitionDesc>,std::vector<PartitionDesc>,bool> emitCompi
     for(auto o : subgraph.outputs()) {
       auto & desc = agraph.output_desc[i++];
       if(o->node()->kind() != prim::FusedConcat) {
-        emitFormal(o, desc);
+        emitFormal(o, desc, true);
         concat_desc.emplace_back();
         flat_output_nodes.push_back(o);
       } else {
         auto cat = o->node();
         concat_desc.emplace_back(desc, cat->inputs().size(), cat->i(attr::dim));
         for(auto c : cat->inputs()) {
-          emitFormal(c, *concat_desc.back().subtensorDesc);
+          emitFormal(c, *concat_desc.back().subtensorDesc, true);
           flat_output_nodes.push_back(c);
         }
       }
@@ -532,6 +706,9 @@ std::tuple<std::vector<PartitionDesc>,std::vector<PartitionDesc>,bool> emitCompi
       continue;
     if (n->kind() == prim::FusedChunk)
       continue;
+    // FusedReduce is implemented by the reduction loop around the body
+    if (n->kind() == prim::FusedReduce)
+      continue;
     if(n->kind() == aten::rand_like) {
       has_random = true;
       if(!use_cuda)
@@ -545,18 +722,27 @@ std::tuple<std::vector<PartitionDesc>,std::vector<PartitionDesc>,bool> emitCompi
   for(auto o : flat_output_nodes) {
     env.d("formal",formal_count++);
     env.s("access",format("t${formal}.data[t${formal}_offset]",env));
-    env.s("node",valueName(o));
+    if (reduce) {
+      env.s("node", reduce->s(attr::name) == "mean" ? "(accumulator / reduceSize)" : "accumulator");
+    } else {
+      env.s("node",valueName(o));
+    }
 
     // Acquires and converts (if needed) outputs
+    std::ostream & out_body = reduce ? outputBody : body;
     auto ot = o->type()->cast<TensorType>();
     if (use_cuda && ot && ot->scalarType() == at::ScalarType::Half) {
-      body << format("${access} = __float2half(${node});\n",env);
+      out_body << format("${access} = __float2half(${node});\n",env);
       has_half_tensor = true;
     } else {
-      body << format("${access} = ${node};\n",env);
+      out_body << format("${access} = ${node};\n",env);
     }
   }
 
+  if (reduce && has_random) {
+    throw std::runtime_error("Fusion doesn't support rand in reductions");
+  }
+
   // Includes half support if any half tensors are involved
   if (has_half_tensor) {
     env.s("HalfHeader", half_support_literal);
@@ -574,12 +760,23 @@ std::tuple<std::vector<PartitionDesc>,std::vector<PartitionDesc>,bool> emitCompi
     env.s("RandInit", "");
   }
 
+  env.s("vectorizePragma", all_contiguous ? "FUSED_VECTORIZE" : "");
   env.s("tensorOffsets",tensorOffsets.str());
   env.s("kernelBody",body.str());
   env.v("formals",formals);
   env.v("argument_loads",argument_loads);
   env.s("type_declarations", type_declarations_template.format(env));
-  if(use_cuda) {
+  if (reduce) {
+    env.s("reduceInput", valueName(reduce->input()));
+    env.s("outputOffsets", outputOffsets.str());
+    env.s("outputBody", outputBody.str());
+    env.s("reduceLoop", reduce_loop_template.format(env));
+    if(use_cuda) {
+      out << cuda_reduce_compilation_unit_template.format(env);
+    } else {
+      out << cpu_reduce_compilation_unit_template.format(env);
+    }
+  } else if(use_cuda) {
     out << cuda_compilation_unit_template.format(env);
   } else {
     out << cpu_compilation_unit_template.format(env);
@@ -608,7 +805,11 @@ struct TensorInfo {
 CompiledFusionFunction::CompiledFusionFunction(const std::string & name, AnnotatedGraph & agraph)
   : name(name)
   , input_desc(agraph.input_desc)
-  , output_desc(agraph.output_desc) {}
+  , output_desc(agraph.output_desc) {
+  if (Node * reduce = findFusedReduce(*agraph.graph)) {
+    reduce_desc = ReduceDesc(reduce->i(attr::dim), reduce->i(attr::keepdim), reduce->s(attr::name) == "mean");
+  }
+}
 
 namespace {
 
@@ -710,6 +911,27 @@ void CompiledFusionFunction::launch_with_tensors(at::ArrayRef<at::Tensor> inputs
     numel = computeNumel(map_size);
   }
 
+  // For reductions the kernel runs once per output element, and map_size
+  // describes the values being reduced.
+  uint32_t reduce_size = 1;
+  uint32_t reduce_stride = 1;
+  std::vector<int64_t> reduced_size;
+  if (!reduce_desc.isNoop()) {
+    JIT_ASSERT(reduce_desc.dim < map_size.size());
+    reduce_size = map_size[reduce_desc.dim];
+    for (size_t d = reduce_desc.dim + 1; d < map_size.size(); ++d) {
+      reduce_stride *= map_size[d];
+    }
+    for (size_t d = 0; d < map_size.size(); ++d) {
+      if (d != reduce_desc.dim) {
+        reduced_size.push_back(map_size[d]);
+      } else if (reduce_desc.keepdim) {
+        reduced_size.push_back(1);
+      }
+    }
+    numel = computeNumel(reduced_size);
+  }
+
   // Compute the storage needed to store TensorInfo structs for inputs and outputs.
   size_t uncompressedDim = input_desc.at(0).contiguity.size();
   size_t maxPossibleTensorInfoSize = sizeof(TensorInfo) + 2 * sizeof(uint32_t) * uncompressedDim;
@@ -718,7 +940,7 @@ void CompiledFusionFunction::launch_with_tensors(at::ArrayRef<at::Tensor> inputs
   char * buffer_next = buffer.data();
   // A vector of arguments to the kernel. It's (numel, *input_descs, *output_descs)
   std::vector<void*> arguments;
-  arguments.reserve(3 + flat_inputs_size + flat_outputs_size);
+  arguments.reserve(5 + flat_inputs_size + flat_outputs_size);
   auto addTensorInfoRaw = [&](TensorDesc & desc, void* data_ptr, at::IntList sizes, at::IntList strides) {
     size_t nDim = desc.nDim(); // NOTE: this is the compressed dim
     JIT_ASSERT(nDim <= uncompressedDim); // We'd overflow the space otherwise
@@ -734,6 +956,10 @@ void CompiledFusionFunction::launch_with_tensors(at::ArrayRef<at::Tensor> inputs
     addTensorInfoRaw(desc, t.data_ptr(), t.sizes(), t.strides());
   };
   arguments.push_back(&numel);
+  if (!reduce_desc.isNoop()) {
+    arguments.push_back(&reduce_size);
+    arguments.push_back(&reduce_stride);
+  }
   for (size_t i = 0; i < input_desc.size(); ++i) {
     auto & chunk = chunk_desc[i];
     const at::Tensor& tensor = inputs[i];
@@ -751,7 +977,10 @@ void CompiledFusionFunction::launch_with_tensors(at::ArrayRef<at::Tensor> inputs
   for (size_t i = 0; i < output_desc.size(); ++i) {
     auto & c = concat_desc[i];
     at::Tensor o = outputs[i];
-    if(c.isNoop()) {
+    if(!reduce_desc.isNoop()) {
+      o.resize_(reduced_size);
+      addTensorInfo(output_desc[i], outputs[i]);
+    } else if(c.isNoop()) {
       o.resize_(map_size);
       addTensorInfo(output_desc[i], outputs[i]);
     } else {
@@ -775,6 +1004,9 @@ void CompiledFusionFunction::launch_with_tensors(at::ArrayRef<at::Tensor> inputs
   // well.
   #ifdef USE_CUDA
   if(has_random && this->backend() == at::Backend::CUDA) {
+    // the generated kernels take their offset by value
+    AT_CHECK(!at::cuda::philox_capture_underway(),
+        "fused kernels with random ops can't be captured in a CUDA graph");
     auto gen_ = THCRandom_getGenerator(at::globalContext().getTHCState());
     uint64_t offset =
         gen_->state.philox_seed_offset.fetch_add(this->get_rand_offset(numel));
@@ -783,15 +1015,16 @@ void CompiledFusionFunction::launch_with_tensors(at::ArrayRef<at::Tensor> inputs
   }
   #endif
 
-  launch_raw(numel, arguments.data());
+  launch_raw(numel, reduce_size, arguments.data());
 }
 
 void CompiledFusionFunction::launch(at::ArrayRef<at::Tensor> inputs, std::vector<at::Tensor> & outputs) {
   at::DeviceGuard guard(inputs.back());
-  outputs.clear();
-  outputs.reserve(outputDescriptors().size());
-  for(auto & od : outputDescriptors()) {
-    outputs.push_back(torch::getType(backend(),od.scalar_type).tensor());
+  outputs.resize(outputDescriptors().size());
+  for(size_t i = 0; i < outputs.size(); ++i) {
+    if (!outputs[i].defined()) {
+      outputs[i] = torch::getType(backend(),output_desc[i].scalar_type).tensor();
+    }
   }
   launch_with_tensors(inputs, outputs);
 }
@@ -810,7 +1043,7 @@ void checkCUDAVersion(const cudaDeviceProp & prop) {
 }
 
 struct CUDAFusionFunction : public CompiledFusionFunction {
-  CUDAFusionFunction(const std::string & name, AnnotatedGraph & agraph)
+  CUDAFusionFunction(const std::string & name, AnnotatedGraph & agraph, const FusionCompilerConfig & config, FusionDiskCacheStats & stats)
   : CompiledFusionFunction(name, agraph) {
     at::DeviceGuard device_guard(agraph.device);
 
@@ -818,34 +1051,45 @@ struct CUDAFusionFunction : public CompiledFusionFunction {
     checkCUDAVersion(prop);
 
     std::stringstream cu;
-    std::tie(chunk_desc, concat_desc, has_random) = codegen::emitCompilationUnit(cu, name, agraph, true);
+    std::tie(chunk_desc, concat_desc, has_random) = codegen::emitCompilationUnit(cu, kernel_symbol, agraph, true);
     compilation_unit = cu.str();
-    nvrtcProgram program;
-    TORCH_NVRTC_CHECK(nvrtcCreateProgram(&program, compilation_unit.c_str(), NULL, 0, nullptr, nullptr));
 
     std::string compute = "--gpu-architecture=compute_" + std::to_string(prop.major) + std::to_string(prop.minor);
     std::vector<const char *> args = {"--std=c++11", compute.c_str(), "-default-device"};
-    nvrtcResult result = nvrtcCompileProgram(program, args.size(), args.data());
-    if (result == NVRTC_ERROR_COMPILATION) {
-      size_t logsize;
-      nvrtcGetProgramLogSize(program, &logsize);
-      std::vector<char> log(logsize);
-      nvrtcGetProgramLog(program, log.data());
-      cu << log.data();
-      throw std::runtime_error(cu.str());
+
+    std::string ptx_path;
+    if (!config.cache_dir.empty()) {
+      // PTX is only valid for the architecture and toolkit that produced it,
+      // so both are part of the key along with the source and NVRTC flags
+      int nvrtc_major, nvrtc_minor;
+      TORCH_NVRTC_CHECK(nvrtcVersion(&nvrtc_major, &nvrtc_minor));
+      std::stringstream key;
+      key << "cuda " << CUDA_VERSION << " nvrtc " << nvrtc_major << "." << nvrtc_minor << "\n";
+      for (auto arg : args)
+        key << arg << " ";
+      key << "\n" << compilation_unit;
+      ptx_path = config.cache_dir + "/" + stableHash(key.str()) + ".ptx";
+      if (fileExists(ptx_path)) {
+        ptx = readFile(ptx_path);
+      }
+      if (!ptx.empty()) {
+        stats.hits++;
+      } else {
+        stats.misses++;
+      }
     }
-    ResourceGuard holdProgram([&] {
-      TORCH_NVRTC_CHECK(nvrtcDestroyProgram(&program));
-    });
-    TORCH_NVRTC_CHECK(result);
 
-    size_t ptx_size;
-    TORCH_NVRTC_CHECK(nvrtcGetPTXSize(program, &ptx_size));
-    ptx.resize(ptx_size);
-    TORCH_NVRTC_CHECK(nvrtcGetPTX(program, ptx.data()));
+    if (ptx.empty()) {
+      compile(args, cu);
+      if (!ptx_path.empty()) {
+        TempFile ptx_file(config.cache_dir + "/pytorch_fuser_XXXXXX.ptx", 4);
+        ptx_file.write(std::string(ptx.begin(), ptx.end()));
+        publishCacheFile(ptx_file, ptx_path);
+      }
+    }
 
     TORCH_CU_CHECK(cuModuleLoadData(&module, ptx.data()));
-    TORCH_CU_CHECK(cuModuleGetFunction(&function, module, name.c_str()));
+    TORCH_CU_CHECK(cuModuleGetFunction(&function, module, kernel_symbol.c_str()));
 
     TORCH_CU_CHECK(cuOccupancyMaxActiveBlocksPerMultiprocessor(
       &maxBlocks, function, 128, 0));
@@ -862,7 +1106,7 @@ protected:
      int numBlocks = std::min(maxBlocks, ceilDiv(numel, blockSize));
      return 4 * (ceil(numel/(4 * blockSize * numBlocks)) + 1);
   }
-  virtual void launch_raw(uint32_t numel, void ** arguments) override {
+  virtual void launch_raw(uint32_t numel, uint32_t reduce_size, void ** arguments) override {
      int numBlocks = std::min(maxBlocks, ceilDiv(numel, blockSize));
 
      //std::cout << "maxBlocks = " << maxBlocks << " needed blocks: " << ceilDiv(numel,blockSize)
@@ -887,6 +1131,28 @@ protected:
        arguments,
        nullptr));
   }
+  void compile(const std::vector<const char *> & args, std::stringstream & cu) {
+    nvrtcProgram program;
+    TORCH_NVRTC_CHECK(nvrtcCreateProgram(&program, compilation_unit.c_str(), NULL, 0, nullptr, nullptr));
+    nvrtcResult result = nvrtcCompileProgram(program, args.size(), args.data());
+    if (result == NVRTC_ERROR_COMPILATION) {
+      size_t logsize;
+      nvrtcGetProgramLogSize(program, &logsize);
+      std::vector<char> log(logsize);
+      nvrtcGetProgramLog(program, log.data());
+      cu << log.data();
+      throw std::runtime_error(cu.str());
+    }
+    ResourceGuard holdProgram([&] {
+      TORCH_NVRTC_CHECK(nvrtcDestroyProgram(&program));
+    });
+    TORCH_NVRTC_CHECK(result);
+
+    size_t ptx_size;
+    TORCH_NVRTC_CHECK(nvrtcGetPTXSize(program, &ptx_size));
+    ptx.resize(ptx_size);
+    TORCH_NVRTC_CHECK(nvrtcGetPTX(program, ptx.data()));
+  }
   std::vector<char> ptx;
   CUmodule module;
   CUfunction function;
@@ -901,46 +1167,6 @@ protected:
 
 #endif
 
-struct TempFile {
-  TH_DISALLOW_COPY_AND_ASSIGN(TempFile);
-  TempFile(const std::string & t, int suffix) {
-    // mkstemps edits its first argument in places
-    // so we make a copy of the string here, including null terminator
-    std::vector<char> tt(t.c_str(), t.c_str() + t.size() + 1);
-    int fd = mkstemps(tt.data(), suffix);
-    JIT_ASSERT(fd != -1);
-    file_ = fdopen(fd, "r+");
-
-    // - 1 becuase tt.size() includes the null terminator,
-    // but std::string does not expect one
-    name_ = std::string(tt.begin(), tt.end() - 1);
-  }
-  const std::string & name() const {
-    return name_;
-  }
-  void sync() {
-    fflush(file_);
-  }
-  void write(const std::string & str) {
-    size_t result = fwrite(str.c_str(), 1, str.size(), file_);
-    JIT_ASSERT(str.size() == result);
-  }
-  FILE* file()  {
-    return file_;
-  }
-  ~TempFile() {
-    if(file_ != nullptr) {
-      // unlink first to ensure another mkstemps doesn't
-      // race between close and unlink
-      unlink(name_.c_str());
-      fclose(file_);
-    }
-  }
-private:
-  FILE * file_ = nullptr;
-  std::string name_;
-};
-
 static void* checkDL(void * x) {
   if(!x) {
     AT_ERROR("error in dlopen or dlsym: ", dlerror());
@@ -975,33 +1201,42 @@ static const std::string cpp_template = "/tmp/pytorch_fuserXXXXXX.cpp";
 // want.  This probably won't work if you're cross-compiling.
 // NB: -march=native is disabled because it has caused problems where
 // compiler and assembler do not agree on what native instruction they
-// understand for AVX512. When we need better CPU performance this
-// optimization can be re-enabled by tracking down the platforms where
-// this error occurs and only selectively disabling it.
+// understand for AVX512. Instead we enable the same instruction sets that
+// ATen's DispatchStub selected for this machine (see vectorFlags).
 static const std::string compile_string =
-  "\"${cxx}\" -O3 -g "
-#ifndef __PPC64__
-//  "-march=native "
+  "\"${cxx}\" -O3 -g -fno-math-errno ${vector_flags} "
+  "-std=c++11 -fPIC -shared \"${cpp_file}\" -o \"${so_file}\" -lm";
+
+static std::string vectorFlags() {
+#if defined(__x86_64__) || defined(_M_X64)
+  switch (at::native::get_cpu_capability()) {
+    case at::native::CPUCapability::AVX2:
+      return "-mavx2 -mfma";
+    case at::native::CPUCapability::AVX:
+      return "-mavx";
+    default:
+      return "";
+  }
+#else
+  return "";
 #endif
-  "-std=c++11 -fPIC ${fopenmp} -shared \"${cpp_file}\" -o \"${so_file}\" -lm";
+}
 
-static void runCompiler(FusionCompilerConfig & config, const std::string & cpp_file, const std::string & so_file) {
+static std::string compileCommand(const FusionCompilerConfig & config, const std::string & cpp_file, const std::string & so_file) {
   TemplateEnv env;
   env.s("cxx", config.cxx);
-  env.s("fopenmp", config.openmp ? "-fopenmp" : "");
+  env.s("vector_flags", vectorFlags());
   env.s("cpp_file",cpp_file);
   env.s("so_file",so_file);
-  std::string result = format(compile_string,env);
+  return format(compile_string,env);
+}
+
+static void runCompiler(const FusionCompilerConfig & config, const std::string & cpp_file, const std::string & so_file) {
+  std::string result = compileCommand(config, cpp_file, so_file);
   int r = system(result.c_str());
-  if(config.openmp && r != 0) {
-    std::cerr << "warning: pytorch jit fuser failed to compile with openmp, trying without it...\n";
-    config.openmp = false; // disable for future compiles
-    return runCompiler(config, cpp_file, so_file);
-  }
   JIT_ASSERTM(r == 0, "Failed to compile a fused CPU kernel");
 }
 
-
 static const std::string disas_string =
   "objdump -M  intel -d \"${so_file}\"";
 static void disas(const std::string & so_file) {
@@ -1013,24 +1248,43 @@ static void disas(const std::string & so_file) {
 }
 
 struct CPUFusionFunction : public CompiledFusionFunction {
-  CPUFusionFunction(const std::string & name, AnnotatedGraph & agraph, FusionCompilerConfig & config)
+  CPUFusionFunction(const std::string & name, AnnotatedGraph & agraph, const FusionCompilerConfig & config, FusionDiskCacheStats & stats)
   : CompiledFusionFunction(name, agraph) {
-    TempFile so_file(so_template, 3);
-    TempFile cpp_file(cpp_template, 4);
-
     std::stringstream cu;
-    std::tie(chunk_desc, concat_desc, has_random) = codegen::emitCompilationUnit(cu, name, agraph, false);
+    std::tie(chunk_desc, concat_desc, has_random) = codegen::emitCompilationUnit(cu, kernel_symbol, agraph, false);
     JIT_ASSERT(!has_random);
     compilation_unit = cu.str();
-    cpp_file.write(compilation_unit);
-    cpp_file.sync();
-    runCompiler(config, cpp_file.name(), so_file.name());
+
+    std::string so_path;
+    std::unique_ptr<TempFile> so_file;
+    if (!config.cache_dir.empty()) {
+      // the flags are part of the key, so a cache directory shared between
+      // machines with different instruction sets stays correct
+      auto key = stableHash(compileCommand(config, "", "") + "\n" + compilation_unit);
+      so_path = config.cache_dir + "/" + key + ".so";
+      if (fileExists(so_path)) {
+        stats.hits++;
+      } else {
+        stats.misses++;
+        // compile next to the final location and rename, so that concurrent
+        // processes never observe a partially written library
+        so_file.reset(new TempFile(config.cache_dir + "/pytorch_fuser_" + key + "XXXXXX.so", 3));
+        compile(config, so_file->name());
+        if (!publishCacheFile(*so_file, so_path)) {
+          so_path = so_file->name();
+        }
+      }
+    } else {
+      so_file.reset(new TempFile(so_template, 3));
+      compile(config, so_file->name());
+      so_path = so_file->name();
+    }
     if(config.debug) {
-      disas(so_file.name());
+      disas(so_path);
     }
-    so_lib.reset(new DynamicLibrary(so_file.name().c_str()));
+    so_lib.reset(new DynamicLibrary(so_path.c_str()));
 #pragma GCC diagnostic ignored "-Wpedantic"
-    kernel = reinterpret_cast<void(*)(uint32_t, void**)>(so_lib->sym(name.c_str()));
+    kernel = reinterpret_cast<void(*)(uint32_t, uint32_t, void**)>(so_lib->sym(kernel_symbol.c_str()));
 #pragma GCC diagnostic pop
   }
 protected:
@@ -1040,22 +1294,64 @@ protected:
   virtual uint64_t get_rand_offset(uint32_t numel) override {
      return numel;
   }
-  virtual void launch_raw(uint32_t numel, void ** arguments) override {
-    kernel(numel, arguments);
+  virtual void launch_raw(uint32_t numel, uint32_t reduce_size, void ** arguments) override {
+    // every output of a reduction reads reduce_size elements, so fewer of
+    // them make up enough work for a thread
+    int64_t grain_size = std::max<int64_t>(1, at::internal::GRAIN_SIZE / std::max<uint32_t>(reduce_size, 1));
+    at::parallel_for(0, numel, grain_size, [&](int64_t begin, int64_t end) {
+      kernel(begin, end, arguments);
+    });
+  }
+  void compile(const FusionCompilerConfig & config, const std::string & so_file) {
+    TempFile cpp_file(cpp_template, 4);
+    cpp_file.write(compilation_unit);
+    cpp_file.sync();
+    runCompiler(config, cpp_file.name(), so_file);
   }
   std::unique_ptr<DynamicLibrary> so_lib;
-  void (*kernel)(uint32_t, void**) = nullptr;
+  void (*kernel)(uint32_t, uint32_t, void**) = nullptr;
 };
 
-std::shared_ptr<CompiledFusionFunction> FusionCompiler::getOrCompile(AnnotatedGraph & agraph) {
+// A kernel depends on the scalar types and the contiguity of the tensors it
+// reads and writes, but not on their sizes, which are only passed in when it
+// is launched. Sizes are therefore left out of the key, so that a fusion
+// group specialized to many input shapes (e.g. every sequence length of an
+// RNN) compiles a single kernel.
+static std::string kernelKey(AnnotatedGraph & agraph) {
+  auto graph = agraph.graph->copy();
+  auto eraseSizes = [](Value * v) {
+    if (auto t = v->type()->cast<TensorType>()) {
+      v->setType(t->withSizes(std::vector<int64_t>(t->sizes().size(), 1)));
+    }
+  };
+  for (auto i : graph->inputs()) {
+    eraseSizes(i);
+  }
+  for (auto n : graph->nodes()) {
+    for (auto o : n->outputs()) {
+      eraseSizes(o);
+    }
+  }
   std::stringstream key;
-  key << *agraph.graph << "\n";
+  key << *graph << "\n";
   key << "device " << agraph.device << "\n";
   for(auto & i : agraph.input_desc)
     key << i << "\n";
   for(auto & i : agraph.output_desc)
     key << i << "\n";
-  std::string key_ = key.str();
+  // the layout of chunks is the one place where codegen reads the sizes of
+  // the graph
+  for(auto p : agraph.graph->inputs()) {
+    if (auto chunk = codegen::usedInFusedChunk(p)) {
+      PartitionDesc desc(p->type()->expect<TensorType>(), chunk->i(attr::chunks), chunk->i(attr::dim), false);
+      key << "chunk " << *desc.subtensorDesc << "\n";
+    }
+  }
+  return key.str();
+}
+
+std::shared_ptr<CompiledFusionFunction> FusionCompiler::getOrCompile(AnnotatedGraph & agraph) {
+  std::string key_ = kernelKey(agraph);
 
   auto it = cache.find(key_);
   if (it == cache.end()) {
@@ -1063,13 +1359,13 @@ std::shared_ptr<CompiledFusionFunction> FusionCompiler::getOrCompile(AnnotatedGr
     CompiledFusionFunction * raw_func;
     if(agraph.device != kCPUDevice) {
 #ifdef USE_CUDA
-      raw_func = new CUDAFusionFunction(name, agraph);
+      raw_func = new CUDAFusionFunction(name, agraph, config_, disk_cache_stats_);
 #else
       throw std::runtime_error("cannot compile a CUDA fusion group, CUDA is not enabled.");
 #endif
     } else {
       JIT_ASSERT(canCompileOnCPU());
-      raw_func = new CPUFusionFunction(name, agraph, config_);
+      raw_func = new CPUFusionFunction(name, agraph, config_, disk_cache_stats_);
     }
     it = cache.emplace(key_, std::shared_ptr<CompiledFusionFunction>(raw_func)).first;
   }
@@ -1130,6 +1426,15 @@ FusionCompiler::FusionCompiler() {
   }
   const char * debug_env = getenv("PYTORCH_FUSION_DEBUG");
   config_.debug = debug_env && atoi(debug_env) != 0;
+  const char * cache_env = getenv("PYTORCH_FUSION_CACHE_DIR");
+  if (cache_env != nullptr && *cache_env != '\0') {
+    config_.cache_dir = cache_env;
+    if (access(cache_env, W_OK) != 0) {
+      std::cerr << "warning: PYTORCH_FUSION_CACHE_DIR " << cache_env
+                << " is not writable, fused kernels will not be cached\n";
+      config_.cache_dir = "";
+    }
+  }
 }
 
 //TODO: thread safety
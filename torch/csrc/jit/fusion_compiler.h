@@ -5,6 +5,7 @@
 #include <torch/csrc/jit/assertions.h>
 
 #include "ATen/ATen.h"
+#include <atomic>
 #include <string>
 #include <algorithm>
 #include <unordered_map>
@@ -105,6 +106,24 @@ struct PartitionDesc {
   }
 };
 
+// Descriptor for the reduction a fusion group ends in, if any. A reduction
+// kernel iterates over the elements of its (single) output and, for each of
+// them, accumulates the values of the fused map along dim.
+struct ReduceDesc {
+  bool active; // false for groups that are purely pointwise
+  size_t dim; // dimension of the map along which the reduction occurs
+  bool keepdim;
+  bool mean; // divide the sum by the size of the reduced dimension
+  ReduceDesc()
+  : active(false), dim(0), keepdim(false), mean(false) {}
+  ReduceDesc(size_t dim, bool keepdim, bool mean)
+  : active(true), dim(dim), keepdim(keepdim), mean(mean) {}
+
+  bool isNoop() const {
+    return !active;
+  }
+};
+
 struct CompiledFusionFunction {
   TH_DISALLOW_COPY_AND_ASSIGN(CompiledFusionFunction);
 
@@ -114,7 +133,8 @@ struct CompiledFusionFunction {
   // expects outputs to be pre-allocated
   void launch_with_tensors(at::ArrayRef<at::Tensor> inputs, at::ArrayRef<at::Tensor> outputs);
 
-  // creates new tensors for outputs
+  // creates new tensors for outputs, except for those that are already
+  // defined, which must have the sizes the kernel produces
   void launch(at::ArrayRef<at::Tensor> inputs, std::vector<at::Tensor> & outputs);
   const std::vector<TensorDesc> & outputDescriptors() const {
     return output_desc;
@@ -127,11 +147,14 @@ protected:
   // The format of arguments is suitable for directly passing to a call to
   // cuLaunchKernel as the kernel arguments.
   // Currently the first argument is a pointer to numel (for passing to
-  // CUDA code), and the remainder are pointers to the TensorInfo<T> structs
-  // that compiled code uses to load Tensor data.
+  // CUDA code), followed for reductions by pointers to the size and stride
+  // of the reduced dimension, and the remainder are pointers to the
+  // TensorInfo<T> structs that compiled code uses to load Tensor data.
   // launch_with_tensors handles packing at::Tensors into this arguments array.
   // CPU code uses the same convension so that launch_with_tensors can be shared.
-  virtual void launch_raw(uint32_t numel, void ** arguments) = 0;
+  // numel is the number of outputs elements the kernel computes, each of which
+  // reads reduce_size elements of the map (1 when there is no reduction).
+  virtual void launch_raw(uint32_t numel, uint32_t reduce_size, void ** arguments) = 0;
 
   virtual uint64_t get_rand_offset(uint32_t numel) = 0;
   bool has_random;
@@ -150,12 +173,25 @@ protected:
   // input should be broken into subtensors (chunks)
   // to be consumed by the fusion group
   std::vector<PartitionDesc> chunk_desc;
+
+  // describes whether the fusion group ends in a reduction
+  ReduceDesc reduce_desc;
 };
 
 struct FusionCompilerConfig {
   std::string cxx = "g++"; // compiler location
   bool debug = false; // emit debugging information about fusions
-  bool openmp = true;
+  // directory where compiled kernels (CPU shared libraries and CUDA PTX) are
+  // cached across processes, keyed by a hash of their source, compile flags
+  // and, for CUDA, the device architecture and toolkit version. Empty
+  // disables the cache. Set via PYTORCH_FUSION_CACHE_DIR.
+  std::string cache_dir;
+};
+
+// lookups in the on-disk kernel cache, counted only when a cache_dir is set
+struct FusionDiskCacheStats {
+  std::atomic<size_t> hits {0};
+  std::atomic<size_t> misses {0};
 };
 
 // caching compiler
@@ -181,8 +217,12 @@ struct FusionCompiler {
   bool canCompileOnCPU() const {
     return config_.cxx.size() > 0;
   }
+  const FusionDiskCacheStats & diskCacheStats() const {
+    return disk_cache_stats_;
+  }
 private:
   FusionCompilerConfig config_;
+  FusionDiskCacheStats disk_cache_stats_;
   std::unordered_map<std::string, std::shared_ptr<CompiledFusionFunction>> cache;
 };
 
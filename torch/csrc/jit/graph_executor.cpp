@@ -4,7 +4,9 @@
 #include "torch/csrc/autograd/grad_mode.h"
 #include "torch/csrc/jit/argument_spec.h"
 #include "torch/csrc/jit/autodiff.h"
+#include "torch/csrc/jit/cuda_graph_runner.h"
 #include "torch/csrc/jit/interpreter.h"
+#include "torch/csrc/jit/parallel_interpreter.h"
 #include "torch/csrc/jit/ir.h"
 #include "torch/csrc/jit/tracer.h"
 #include "torch/csrc/jit/passes/batch_mm.h"
@@ -13,13 +15,17 @@
 #include "torch/csrc/jit/passes/dead_code_elimination.h"
 #include "torch/csrc/jit/passes/erase_number_types.h"
 #include "torch/csrc/jit/passes/graph_fuser.h"
+#include "torch/csrc/jit/passes/memory_planning.h"
 #include "torch/csrc/jit/passes/inplace_check.h"
+#include "torch/csrc/jit/passes/inplace_rewrite.h"
 #include "torch/csrc/jit/passes/peephole.h"
 #include "torch/csrc/jit/passes/shape_analysis.h"
 #include "torch/csrc/jit/passes/remove_expands.h"
 #include "torch/csrc/jit/passes/decompose_addmm.h"
 #include "torch/csrc/jit/passes/specialize_undef.h"
 #include "torch/csrc/jit/passes/loop_unrolling.h"
+#include "torch/csrc/jit/passes/loop_fusion.h"
+#include "torch/csrc/jit/passes/loop_invariant_code_motion.h"
 #include "torch/csrc/jit/passes/lower_grad_of.h"
 #include "torch/csrc/jit/passes/constant_propagation.h"
 #include "torch/csrc/jit/symbolic_variable.h"
@@ -29,7 +35,10 @@
 #include "torch/csrc/autograd/function.h"
 #include "torch/csrc/jit/script/compiler.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <cstdlib>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
@@ -45,6 +54,19 @@ using tensor_list = std::vector<at::Tensor>;
 using Variable = autograd::Variable;
 using autograd::variable_list;
 
+std::atomic<size_t>& planCacheLimitValue() {
+  static std::atomic<size_t> limit([] {
+    const char* env = std::getenv("PYTORCH_JIT_PLAN_CACHE_LIMIT");
+    return env ? static_cast<size_t>(std::max(0, std::atoi(env))) : 0;
+  }());
+  return limit;
+}
+
+std::atomic<bool>& fusionEnabledValue() {
+  static std::atomic<bool> enabled(true);
+  return enabled;
+}
+
 // this type is in ExecutionPlan to run its Gradient if it is
 // specified. It has a list of inputs captured by ExecutionPlan that
 // it concats with inputs to form the full set of inputs to graph.
@@ -107,11 +129,15 @@ private:
 struct ExecutionPlan {
   ExecutionPlan(std::shared_ptr<Graph>& graph)
       : f(graph),
+        parallel_f(createParallelCode(graph)),
+        cuda_graph(createCUDAGraphRunner(graph)),
         graph(graph),
         num_inputs(graph->inputs().size()),
         num_outputs(graph->outputs().size()) {}
   ExecutionPlan(std::shared_ptr<Graph>& graph, Gradient grad)
       : f(graph),
+        parallel_f(createParallelCode(graph)),
+        cuda_graph(createCUDAGraphRunner(graph)),
         graph(graph),
         grad(std::move(grad)),
         grad_executor(this->grad.df),
@@ -122,13 +148,17 @@ struct ExecutionPlan {
     if (grad) {
       return runWithGrad(stack);
     }
-    InterpreterState(f).runOneStage(stack);
+    runCode(stack);
   }
 
   std::shared_ptr<Graph> get_graph() const {
     return graph;
   }
 
+  bool hasGradient() const {
+    return static_cast<bool>(grad);
+  }
+
   ExecutionPlanState getDebugState() {
     ExecutionPlanState state;
     state.f = &f;
@@ -145,6 +175,66 @@ struct ExecutionPlan {
   }
 
 private:
+  static std::shared_ptr<ParallelCode> createParallelCode(const std::shared_ptr<Graph>& graph) {
+    if (!interOpParallelEnabled() || !ParallelCode::isProfitable(*graph))
+      return nullptr;
+    return std::make_shared<ParallelCode>(graph);
+  }
+
+  static std::shared_ptr<CUDAGraphRunner> createCUDAGraphRunner(const std::shared_ptr<Graph>& graph) {
+    if (!cudaGraphsEnabled())
+      return nullptr;
+    return std::make_shared<CUDAGraphRunner>(graph->inputs().size(), graph->outputs().size());
+  }
+
+  void runCode(Stack & stack) const {
+    if (cuda_graph && cuda_graph->run(stack, [this](Stack & s) { runCodeUncaptured(s); })) {
+      return;
+    }
+    runCodeUncaptured(stack);
+  }
+
+  void runCodeUncaptured(Stack & stack) const {
+    if (parallel_f) {
+      return parallel_f->run(stack);
+    }
+    InterpreterState state = takeInterpreterState();
+    state.runOneStage(stack);
+    // a state is only reused if its run finished without throwing
+    returnInterpreterState(std::move(state));
+  }
+
+  // Each thread keeps the interpreter states of the plans it ran most
+  // recently, so that running a plan doesn't allocate its registers every
+  // time and concurrent runs of a plan don't share anything mutable. A state
+  // keeps its Code alive, which is why there are only a few per thread.
+  static constexpr size_t kCachedStatesPerThread = 8;
+  using StateCache = std::vector<std::pair<uint64_t, InterpreterState>>;
+  static StateCache & threadStateCache() {
+    thread_local StateCache cache;
+    return cache;
+  }
+  InterpreterState takeInterpreterState() const {
+    auto & cache = threadStateCache();
+    for (auto it = cache.begin(); it != cache.end(); ++it) {
+      if (it->first == id) {
+        // removed while running, in case the plan runs itself recursively
+        InterpreterState state = it->second;
+        cache.erase(it);
+        return state;
+      }
+    }
+    return InterpreterState(f);
+  }
+  void returnInterpreterState(InterpreterState state) const {
+    state.reset();
+    auto & cache = threadStateCache();
+    if (cache.size() >= kCachedStatesPerThread) {
+      cache.erase(cache.begin());
+    }
+    cache.emplace_back(id, std::move(state));
+  }
+
   void detachVariables(Stack & stack) const {
     // It would be nice to use an ArrayRef here, but unfortunately those can only
     // return const references, so we need to do a bunch of indexing ourselves.
@@ -185,7 +275,7 @@ private:
     }
 
     detachVariables(stack);
-    InterpreterState(f).runOneStage(stack);
+    runCode(stack);
 
     {
       auto outputs = last(stack, num_outputs);
@@ -212,7 +302,16 @@ private:
     }
   }
 
+  // distinguishes the cached interpreter states of different plans
+  const uint64_t id = next_id++;
+  static std::atomic<uint64_t> next_id;
   Code f;
+  // set when inter-op parallelism is enabled and the graph has independent
+  // branches; used instead of f to run the plan
+  std::shared_ptr<ParallelCode> parallel_f;
+  // set when CUDA graphs are enabled; replays the plan as a CUDA graph once
+  // it has been captured
+  std::shared_ptr<CUDAGraphRunner> cuda_graph;
   // optimized graph for debugging and testing
   std::shared_ptr<Graph> graph;
   // description of gradient as a graph
@@ -224,6 +323,31 @@ private:
   const size_t num_outputs;
 };
 
+std::atomic<uint64_t> ExecutionPlan::next_id{0};
+
+// A counter that many threads can increment without contending on a single
+// cache line. Reading it is comparatively slow.
+struct ShardedCounter {
+  void increment() {
+    static std::atomic<size_t> next_shard{0};
+    thread_local size_t shard = next_shard++ % kNumShards;
+    shards[shard].value.fetch_add(1, std::memory_order_relaxed);
+  }
+  size_t sum() const {
+    size_t total = 0;
+    for (auto & shard : shards) {
+      total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+private:
+  static constexpr size_t kNumShards = 16;
+  struct alignas(64) Shard {
+    std::atomic<size_t> value{0};
+  };
+  Shard shards[kNumShards];
+};
+
 } // anonymous namespace
 
 // a Graph can be created via tracing, or via a language-based frontend
@@ -232,6 +356,15 @@ private:
 // GraphExecutor is completely unaware of tracing or module parameters to keep the
 // tracing concerns separated.
 struct GraphExecutorImpl {
+  // entries of plan_cache, declared first since member functions use them
+  struct CachedPlan {
+    CachedPlan(std::shared_ptr<ExecutionPlan> plan, uint64_t last_used)
+    : plan(std::move(plan)), last_used(last_used) {}
+    std::shared_ptr<ExecutionPlan> plan;
+    // value of plan_cache_clock when the plan was last looked up
+    std::atomic<uint64_t> last_used;
+  };
+  using PlanCache = std::unordered_map<ArgumentSpec, std::shared_ptr<CachedPlan>>;
 
   GraphExecutorImpl(std::shared_ptr<Graph> graph, bool optimize, bool symbolically_differentiable)
   : graph(std::move(graph))
@@ -268,8 +401,40 @@ struct GraphExecutorImpl {
     // either we can symbolically differentiate, or we do not need a gradient.
     // go down the route where we treat the inputs as tensors
     // and fully optimize
-    auto & implementation = getOrCompile(inputs);
-    return implementation.run(stack);
+    auto implementation = getOrCompile(inputs);
+    return implementation->run(stack);
+  }
+
+  void precompile(const Stack & stack) {
+    auto inputs = last(stack, num_inputs);
+    if(!optimize || (!symbolically_differentiable && needsGradient(inputs))) {
+      getOrCreateAutogradFallback();
+      return;
+    }
+    getOrCompile(inputs);
+  }
+
+  std::vector<std::shared_ptr<Graph>> optimizedGraphs() const {
+    std::vector<std::shared_ptr<Graph>> graphs;
+    for (auto & entry : *std::atomic_load(&plan_cache)) {
+      if (!entry.second->plan->hasGradient())
+        graphs.push_back(entry.second->plan->get_graph());
+    }
+    return graphs;
+  }
+
+  void addOptimizedGraph(std::shared_ptr<Graph> optimized) {
+    JIT_ASSERT(optimized->inputs().size() == num_inputs);
+    // a memory plan is only valid if the nodes run in graph order
+    if (interOpParallelEnabled() && usesMemoryPlan(*optimized))
+      return;
+    ArgumentSpec spec(fmap(optimized->inputs(), [](Value * v) { return v->type(); }));
+    // compiles the fusion kernels, so do it before taking the lock
+    auto plan = std::make_shared<ExecutionPlan>(optimized);
+    std::lock_guard<std::mutex> lock(compile_mutex);
+    if (std::atomic_load(&plan_cache)->count(spec) == 0) {
+      publishPlan(std::move(spec), std::move(plan));
+    }
   }
 
   std::shared_ptr<Graph> graphFor(const Stack& stack) const {
@@ -281,9 +446,10 @@ struct GraphExecutorImpl {
       return autograd_fallback_graph;
     }
 
-    auto it = plan_cache.find(spec);
-    JIT_ASSERTM(it != plan_cache.end(), "No graph found for given inputs");
-    return it->second.get_graph();
+    auto cache = std::atomic_load(&plan_cache);
+    auto it = cache->find(spec);
+    JIT_ASSERTM(it != cache->end(), "No graph found for given inputs");
+    return it->second->plan->get_graph();
   }
 
   GraphExecutorState getDebugState() {
@@ -296,9 +462,13 @@ struct GraphExecutorImpl {
       state.autograd_fallback = nullptr;
       state.autograd_fallback_graph = nullptr;
     }
-    for (auto & entry : plan_cache) {
-      state.execution_plans.emplace(entry.first, entry.second.getDebugState());
+    std::lock_guard<std::mutex> lock(compile_mutex);
+    for (auto & entry : *std::atomic_load(&plan_cache)) {
+      state.execution_plans.emplace(entry.first, entry.second->plan->getDebugState());
     }
+    state.plan_cache_hits = plan_cache_hits.sum();
+    state.plan_cache_misses = plan_cache_misses;
+    state.plan_cache_evictions = plan_cache_evictions;
     return state;
   }
 
@@ -375,6 +545,10 @@ private:
   }
 
   const Code & getOrCreateAutogradFallback() {
+    // the fallback is never replaced once created, so runs don't need the lock
+    if(autograd_fallback_ready.load(std::memory_order_acquire)) {
+      return autograd_fallback;
+    }
     std::lock_guard<std::mutex> lock(compile_mutex);
     if(autograd_fallback) {
       return autograd_fallback;
@@ -390,21 +564,66 @@ private:
     }
     autograd_fallback_graph = graph_;
     autograd_fallback = Code(graph_);
+    autograd_fallback_ready.store(true, std::memory_order_release);
     return autograd_fallback;
   }
-  const ExecutionPlan & getOrCompile(at::ArrayRef<IValue> inputs) {
-    // outside lock guard, to minimize the time holding the lock on the fast path
+  // returns a shared_ptr rather than a reference, because another thread may
+  // evict the plan from plan_cache while it is still running
+  std::shared_ptr<ExecutionPlan> getOrCompile(at::ArrayRef<IValue> inputs) {
     // ArgumentSpec even computes its hashCode here.
     ArgumentSpec spec(autograd::GradMode::is_enabled(), inputs);
-    {
-      std::lock_guard<std::mutex> lock(compile_mutex);
-      auto it = plan_cache.find(spec);
-      if(it != plan_cache.end())
-        return it->second;
-      auto plan = compileSpec(spec);
-      auto r = plan_cache.emplace(std::move(spec), std::move(plan));
-      return r.first->second;
+    // fast path: look the plan up in the current snapshot, without locking
+    if (auto plan = lookupPlan(*std::atomic_load(&plan_cache), spec)) {
+      return plan;
+    }
+    std::lock_guard<std::mutex> lock(compile_mutex);
+    // another thread may have compiled it while we were waiting
+    auto cache = std::atomic_load(&plan_cache);
+    if (auto plan = lookupPlan(*cache, spec)) {
+      return plan;
+    }
+    plan_cache_misses++;
+    auto plan = std::make_shared<ExecutionPlan>(compileSpec(spec));
+    publishPlan(std::move(spec), plan);
+    return plan;
+  }
+
+  // requires compile_mutex to be held
+  void publishPlan(ArgumentSpec spec, std::shared_ptr<ExecutionPlan> plan) {
+    auto updated = std::make_shared<PlanCache>(*std::atomic_load(&plan_cache));
+    const size_t limit = planCacheLimit();
+    while(limit > 0 && updated->size() >= limit) {
+      evictLeastRecentlyUsedPlan(*updated);
     }
+    updated->emplace(std::move(spec), std::make_shared<CachedPlan>(std::move(plan), ++plan_cache_clock));
+    std::atomic_store(&plan_cache, std::shared_ptr<const PlanCache>(std::move(updated)));
+  }
+
+  std::shared_ptr<ExecutionPlan> lookupPlan(const PlanCache & cache, const ArgumentSpec & spec) {
+    auto it = cache.find(spec);
+    if (it == cache.end())
+      return nullptr;
+    plan_cache_hits.increment();
+    // Only bump the clock if another plan was used since this one, so that
+    // threads hammering the same plan don't all write to the same memory.
+    auto & last_used = it->second->last_used;
+    if (last_used.load(std::memory_order_relaxed) != plan_cache_clock.load(std::memory_order_relaxed)) {
+      last_used.store(++plan_cache_clock, std::memory_order_relaxed);
+    }
+    return it->second->plan;
+  }
+
+  // requires compile_mutex to be held
+  void evictLeastRecentlyUsedPlan(PlanCache & cache) {
+    // eviction is rare and comes with a compilation, so a linear scan is
+    // cheaper overall than keeping plans ordered on every hit
+    auto lru = std::min_element(cache.begin(), cache.end(),
+      [](const PlanCache::value_type & a, const PlanCache::value_type & b) {
+        return a.second->last_used.load(std::memory_order_relaxed) <
+               b.second->last_used.load(std::memory_order_relaxed);
+      });
+    cache.erase(lru);
+    plan_cache_evictions++;
   }
 
   bool argumentSpecRequiresGradient(const ArgumentSpec & spec) {
@@ -422,6 +641,7 @@ private:
 
     if(!argumentSpecRequiresGradient(spec)) {
       runOptimization(graph_, /*graphMustSupportVariables=*/false);
+      maybePlanMemory(graph_);
       return ExecutionPlan(graph_);
     }
     JIT_ASSERT(symbolically_differentiable);
@@ -434,8 +654,25 @@ private:
     Gradient gradient = differentiate(graph_, requires_grads);
     graph_ = gradient.f;
     runOptimization(graph_, /*graphMustSupportVariables=*/false);
+    maybePlanMemory(graph_);
     return ExecutionPlan(graph_, std::move(gradient));
   }
+
+  static bool usesMemoryPlan(const Graph & graph) {
+    for (auto n : graph.nodes()) {
+      if (n->kind() == prim::AllocateArena)
+        return true;
+    }
+    return false;
+  }
+
+  // Memory planning assumes that nodes run in graph order, so it is skipped
+  // for plans that may run on the inter-op executor.
+  void maybePlanMemory(std::shared_ptr<Graph> & graph) {
+    if (memoryPlanningEnabled() && !interOpParallelEnabled()) {
+      PlanMemory(graph);
+    }
+  }
   // the unoptimized starting graph
   // this is never mutated
   std::shared_ptr<Graph> graph;
@@ -465,17 +702,25 @@ private:
   // and it must work on all sizes (so no optimizations that inspect sizes can run on it)
   std::shared_ptr<Graph> autograd_fallback_graph;
   Code autograd_fallback;
+  std::atomic<bool> autograd_fallback_ready{false};
 
   // optimizable code paths, used when we can differentiate or when no derivative is needed
   // Spec describes input conditions, Plan describes how to execute them.
-  std::unordered_map<ArgumentSpec, ExecutionPlan> plan_cache;
-
-  // GraphExecutor can be accessed from  multiple thread so
-  // anytime we are checking or updating the autograd_fallback or
-  // plan_cache, we must hold the compile mutex.
-  // along the fast path (no compilation) code should
-  // hold this for as little time as possible.
-  std::mutex compile_mutex;
+  // Bounded by planCacheLimit(), evicting the least recently used plan.
+  // The cache is read-mostly, so it is copied on write: lookups atomically
+  // load the current snapshot and never lock, while compiling a new plan
+  // publishes an updated copy. Only use std::atomic_load/atomic_store on it.
+  std::shared_ptr<const PlanCache> plan_cache = std::make_shared<PlanCache>();
+  std::atomic<uint64_t> plan_cache_clock{0};
+  ShardedCounter plan_cache_hits;
+  size_t plan_cache_misses = 0;
+  size_t plan_cache_evictions = 0;
+
+  // GraphExecutor can be accessed from multiple threads. Creating the
+  // autograd_fallback and publishing a new plan_cache must happen under the
+  // compile mutex, so that every plan is compiled once. Running a graph
+  // whose plan is already compiled doesn't take it.
+  mutable std::mutex compile_mutex;
 };
 
 GraphExecutor::GraphExecutor(std::shared_ptr<Graph> graph, bool optimize)
@@ -488,6 +733,18 @@ void GraphExecutor::run(Stack & inputs) {
   return pImpl->run(inputs);
 }
 
+void GraphExecutor::precompile(const Stack & inputs) {
+  pImpl->precompile(inputs);
+}
+
+std::vector<std::shared_ptr<Graph>> GraphExecutor::optimizedGraphs() const {
+  return pImpl->optimizedGraphs();
+}
+
+void GraphExecutor::addOptimizedGraph(std::shared_ptr<Graph> graph) {
+  pImpl->addOptimizedGraph(std::move(graph));
+}
+
 std::shared_ptr<Graph> GraphExecutor::graph() const {
   return pImpl->graph;
 }
@@ -500,6 +757,22 @@ GraphExecutorState GraphExecutor::getDebugState() {
   return pImpl->getDebugState();
 }
 
+void setPlanCacheLimit(size_t limit) {
+  planCacheLimitValue() = limit;
+}
+
+size_t planCacheLimit() {
+  return planCacheLimitValue();
+}
+
+void setFusionEnabled(bool enabled) {
+  fusionEnabledValue() = enabled;
+}
+
+bool fusionEnabled() {
+  return fusionEnabledValue();
+}
+
 
 void runRequiredPasses(const std::shared_ptr<Graph>& g)  {
   LowerGradOf(*g);
@@ -547,15 +820,26 @@ void runOptimization(std::shared_ptr<Graph> & graph, bool graphMustSupportVariab
     // do not work on variables
 
     // They also may assume that concrete sizes/strides are availiable
+    FuseLoops(graph);
+    HoistLoopInvariants(graph);
+    // hoisted nodes may duplicate ones that were already outside the loop
+    EliminateCommonSubexpression(graph);
     UnrollLoops(graph);
     ConstantPropagation(graph);
     //TODO: create peephole optimizations that are safe to run
     // when we are using variables, and when we do not know sizes.
-    PeepholeOptimize(graph);
+    // The graph is specialized to an ArgumentSpec, so its shapes are exact.
+    // Removing no-op views here also lets the memory planner place more
+    // fusion outputs, since views are aliasing uses.
+    PeepholeOptimize(graph, /*specialized_shapes=*/true);
     // TODO: remove mandatory size checking in BatchMM, otherwise
     // it works fine on variables.
     BatchMM(graph);
-    FuseGraph(graph);
+    if (fusionEnabled()) {
+      FuseGraph(graph);
+    }
+    // in-place ops are neither fusible nor differentiable, so this goes last
+    RewriteInplaceOps(graph);
   }
 }
 
@@ -30,6 +30,11 @@ struct GraphExecutorState {
   // Those two fields are optional
   Code* autograd_fallback;
   Graph* autograd_fallback_graph;
+
+  // lookups of execution_plans since the executor was created
+  size_t plan_cache_hits = 0;
+  size_t plan_cache_misses = 0;
+  size_t plan_cache_evictions = 0;
 };
 
 struct GraphExecutorImpl;
@@ -38,7 +43,21 @@ struct TORCH_API GraphExecutor {
   GraphExecutor(std::shared_ptr<Graph> graph, bool optimize = true);
   // note: if not specified, symbolically_differentiable is computed from the graph.
   GraphExecutor(std::shared_ptr<Graph> graph, bool optimize, bool symbolically_differentiable);
+  // Safe to call from many threads at once. Only compiling the plan for a
+  // new ArgumentSpec takes a lock; runs with an already compiled spec share
+  // nothing mutable except a few relaxed counters, so their throughput scales
+  // with the number of threads as far as the kernels they launch allow.
   void run(Stack & inputs);
+  // Compiles the plan for inputs like these, including its fusion kernels,
+  // without running it, so that the first run with them is fast.
+  void precompile(const Stack & inputs);
+  // The optimized graphs of the compiled plans that don't compute gradients.
+  // They can be saved with the model (see ExportModule) and handed to
+  // addOptimizedGraph of an executor of the same graph in another process.
+  std::vector<std::shared_ptr<Graph>> optimizedGraphs() const;
+  // Installs a graph returned by optimizedGraphs() as the plan for the inputs
+  // it was specialized to, without running any passes on it.
+  void addOptimizedGraph(std::shared_ptr<Graph> graph);
   explicit operator bool() const {
     return pImpl != nullptr;
   }
@@ -49,6 +68,20 @@ private:
   std::shared_ptr<GraphExecutorImpl> pImpl;
 };
 
+// The number of execution plans, i.e. of distinct ArgumentSpecs, each
+// GraphExecutor keeps. When a new plan is compiled for an executor that is
+// already at the limit, its least recently used plan is discarded. 0, the
+// default unless the PYTORCH_JIT_PLAN_CACHE_LIMIT environment variable is
+// set, means there is no limit.
+TORCH_API void setPlanCacheLimit(size_t limit);
+TORCH_API size_t planCacheLimit();
+
+// Whether runOptimization fuses elementwise operators into FusionGroups. On
+// by default; only affects the plans compiled after it is changed. Meant for
+// comparing the executors with and without the fusion compiler.
+TORCH_API void setFusionEnabled(bool enabled);
+TORCH_API bool fusionEnabled();
+
 // These passes need to run before it is valid to pass to the interpreter
 // regardless of whether sizes have been specialized or not.
 TORCH_API void runRequiredPasses(const std::shared_ptr<Graph>& g);
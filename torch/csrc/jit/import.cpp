@@ -180,7 +180,8 @@ void DecoderBase::buildBlock(const onnx::GraphProto& graph_proto, Block* block,
 class ModuleDecoder : DecoderBase {
  public:
   ModuleDecoder(std::shared_ptr<script::Module> root_module,
-                const std::string& filename);
+                const std::string& filename,
+                bool map_storages);
 
  private:
   virtual std::shared_ptr<Graph> buildGraph(const onnx::GraphProto& graph_proto) override;
@@ -189,6 +190,8 @@ class ModuleDecoder : DecoderBase {
 
   TypePtr buildType(const onnx::TypeProto& type_proto);
 
+  void registerValueTypes(const onnx::GraphProto& graph_proto);
+
   virtual void buildValue(Value* value, const onnx::ValueInfoProto& valueinfo_proto) override;
 
   virtual void buildIntermediateValue(Value* value, const std::string& name) override;
@@ -205,15 +208,39 @@ class ModuleDecoder : DecoderBase {
       const std::string fullname);
 
   PyTorchFileReader file_reader_;
+  // If set, storages point into a mapping of the file instead of being read
+  bool map_storages_;
   std::unordered_map<uint64_t, std::shared_ptr<at::Tensor>> storage_map_;
   std::unordered_map<std::string, const onnx::TypeProto*> value_type_map_;
+  // Method graphs are loaded without shape information, but the optimized
+  // graphs saved next to them depend on it.
+  bool keep_tensor_types_ = false;
 };
 
 std::shared_ptr<Graph> ModuleDecoder::buildGraph(const onnx::GraphProto& graph_proto) {
+  // graph attributes, like the Subgraph of a FusionGroup, name their values
+  // independently of the graph they are in
+  auto outer_value_types = value_type_map_;
+  registerValueTypes(graph_proto);
+  auto graph = DecoderBase::buildGraph(graph_proto);
+  value_type_map_ = std::move(outer_value_types);
+  return graph;
+}
+
+void ModuleDecoder::registerValueTypes(const onnx::GraphProto& graph_proto) {
   for (auto &subtype : graph_proto.value_info()) {
     value_type_map_[subtype.name()] = &subtype.type();
   }
-  return DecoderBase::buildGraph(graph_proto);
+  // the types of values defined in sub-blocks are stored with the blocks
+  for (auto &node_proto : graph_proto.node()) {
+    for (auto &attr : node_proto.attribute()) {
+      if (attr.name() == "_blocks") {
+        for (auto &block_proto : attr.graphs()) {
+          registerValueTypes(block_proto);
+        }
+      }
+    }
+  }
 }
 
 TypePtr ModuleDecoder::buildType(const onnx::TypeProto& type_proto) {
@@ -223,8 +250,21 @@ TypePtr ModuleDecoder::buildType(const onnx::TypeProto& type_proto) {
   if (kind == "DynamicType") {
     return DynamicType::get();
   } else if (kind == "TensorType") {
-    // TODO: Don't use DynamicType here
-    return DynamicType::get();
+    if (!keep_tensor_types_) {
+      // TODO: Don't use DynamicType here
+      return DynamicType::get();
+    }
+    // dims are the sizes, then the strides, then the device
+    auto num_dims = (shape_proto.dim_size() - 1) / 2;
+    std::vector<int64_t> sizes, strides;
+    for (int i = 0; i < num_dims; i++) {
+      sizes.push_back(shape_proto.dim(i).dim_value());
+      strides.push_back(shape_proto.dim(num_dims + i).dim_value());
+    }
+    auto device = shape_proto.dim(2 * num_dims).dim_value();
+    auto scalar_type = onnxTypeToATenType(
+        static_cast<onnx::TensorProto_DataType>(tensortype_proto.elem_type()));
+    return TensorType::create(scalar_type, device, sizes, strides);
   } else if (kind == "TupleType") {
     std::vector<TypePtr> elems;
     for (auto &subkind : shape_proto.dim()) {
@@ -298,10 +338,21 @@ at::Tensor ModuleDecoder::buildTensorCommon(
   at::Tensor *storage_tensor;
   auto storage_it = storage_map_.find(record_number);
   if (storage_it == storage_map_.end()) {
-    auto storage = std::make_shared<at::Tensor>(at::CPU(type).tensor());
-    auto record = file_reader_.getRecordWithKey(record_number);
-    storage->resize_({ static_cast<int64_t>(std::get<1>(record)) });
-    std::memcpy(storage->storage()->pImpl()->data(), std::get<0>(record).get(), std::get<1>(record));
+    std::shared_ptr<at::Tensor> storage;
+    if (map_storages_) {
+      auto record = file_reader_.mapRecordWithKey(record_number);
+      auto data = std::get<0>(record);
+      auto numel = std::get<1>(record) / at::CPU(type).elementSizeInBytes();
+      // the deleter holds on to the mapping
+      auto blob = at::CPU(type).storageFromBlob(data.get(), numel, [data](void*) {});
+      storage = std::make_shared<at::Tensor>(at::CPU(type).tensor(
+          *blob, /* storageOffset = */ 0, { static_cast<int64_t>(numel) }, { 1 }));
+    } else {
+      storage = std::make_shared<at::Tensor>(at::CPU(type).tensor());
+      auto record = file_reader_.getRecordWithKey(record_number);
+      storage->resize_({ static_cast<int64_t>(std::get<1>(record)) });
+      std::memcpy(storage->storage()->pImpl()->data(), std::get<0>(record).get(), std::get<1>(record));
+    }
     storage_map_.insert(std::make_pair(record_number, storage));
     storage_tensor = storage.get();
   } else {
@@ -336,8 +387,10 @@ std::pair<std::shared_ptr<script::Module>, std::string> ModuleDecoder::parseFull
 
 ModuleDecoder::ModuleDecoder(
     const std::shared_ptr<script::Module> root_module,
-    const std::string &filename) :
-    file_reader_(filename) {
+    const std::string &filename,
+    bool map_storages) :
+    file_reader_(filename),
+    map_storages_(map_storages) {
   auto model_proto = onnx::ModelProto();
   auto record = file_reader_.getLastRecord();
   model_proto.ParsePartialFromArray(std::get<0>(record).get(), std::get<1>(record));
@@ -366,7 +419,20 @@ ModuleDecoder::ModuleDecoder(
     }
 
     auto graph = buildGraph(node_proto.attribute(0).g());
-    parent_module->create_method(name, graph, member_inputs);
+    auto & method = parent_module->create_method(name, graph, member_inputs);
+
+    keep_tensor_types_ = true;
+    for (auto &attr : node_proto.attribute()) {
+      if (attr.name() != "_plan")
+        continue;
+      try {
+        method.add_optimized_graph(buildGraph(attr.g()));
+      } catch (std::exception &) {
+        // e.g. fusion kernels that can't be compiled on this machine; the
+        // method is optimized again when it runs instead
+      }
+    }
+    keep_tensor_types_ = false;
   }
 }
 
@@ -374,13 +440,14 @@ ModuleDecoder::ModuleDecoder(
 
 void ImportIRModule(
     const std::shared_ptr<script::Module> module,
-    const std::string& filename) {
-  ModuleDecoder(module, filename);
+    const std::string& filename,
+    bool map_storages) {
+  ModuleDecoder(module, filename, map_storages);
 }
 
-std::shared_ptr<script::Module> load(const std::string& filename) {
+std::shared_ptr<script::Module> load(const std::string& filename, bool map_storages) {
   auto module = std::make_shared<script::Module>();
-  ModuleDecoder(module, filename);
+  ModuleDecoder(module, filename, map_storages);
   return module;
 }
 
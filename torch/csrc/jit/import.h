@@ -5,10 +5,20 @@
 
 namespace torch { namespace jit {
 
+// With map_storages, the parameters are backed by a private mapping of the
+// file rather than read into memory: loading is nearly free and only the
+// pages that are used get read, but the file must not be modified while the
+// module is alive. Writes to the parameters are not written back to the file.
 TORCH_API void ImportIRModule(
     const std::shared_ptr<script::Module> module,
-    const std::string& filename);
+    const std::string& filename,
+    bool map_storages = false);
 
-TORCH_API std::shared_ptr<script::Module> load(const std::string& filename);
+// Optimized plans saved with the methods (see Method::precompile) are
+// compiled while loading, so the first calls with the inputs they were
+// compiled for don't have to optimize the methods again.
+TORCH_API std::shared_ptr<script::Module> load(
+    const std::string& filename,
+    bool map_storages = false);
 
 }}
@@ -15,17 +15,25 @@
 #include "torch/csrc/jit/passes/peephole.h"
 #include "torch/csrc/jit/passes/canonicalize.h"
 #include "torch/csrc/jit/passes/onnx/peephole.h"
+#include "torch/csrc/jit/passes/onnx/constant_fold.h"
 #include "torch/csrc/jit/passes/onnx/fixup_onnx_loop.h"
 #include "torch/csrc/jit/passes/shape_analysis.h"
 #include "torch/csrc/jit/passes/decompose_addmm.h"
 #include "torch/csrc/jit/passes/constant_propagation.h"
 #include "torch/csrc/jit/passes/loop_unrolling.h"
+#include "torch/csrc/jit/passes/loop_fusion.h"
+#include "torch/csrc/jit/passes/loop_invariant_code_motion.h"
 #include "torch/csrc/jit/passes/to_batch.h"
 #include "torch/csrc/jit/passes/specialize_undef.h"
+#include "torch/csrc/jit/passes/memory_planning.h"
 #include "torch/csrc/jit/graph_executor.h"
+#include "torch/csrc/jit/cuda_graph_runner.h"
+#include "torch/csrc/jit/parallel_interpreter.h"
+#include "torch/csrc/jit/fusion_compiler.h"
 #include "torch/csrc/jit/script/init.h"
 #include "torch/csrc/jit/script/python_tree_views.h"
 #include "torch/csrc/jit/batched/BatchTensor.h"
+#include "torch/csrc/jit/batched/BatchingExecutor.h"
 #include "torch/csrc/jit/pybind_utils.h"
 #include "torch/csrc/jit/function_schema.h"
 #include "torch/csrc/jit/serialization.h"
@@ -68,6 +76,7 @@ void initJITBindings(PyObject *module) {
   m.def("_jit_init", loadPythonClasses)
    .def("_jit_pass_onnx", ToONNX)
    .def("_jit_pass_onnx_peephole", PeepholeOptimizeONNX)
+   .def("_jit_pass_onnx_constant_fold", ConstantFoldONNX)
    .def("_jit_pass_fuse", FuseGraph)
    .def("_jit_pass_dce", [](std::shared_ptr<Graph>& g) {
      return EliminateDeadCode(g); // overload resolution
@@ -75,7 +84,9 @@ void initJITBindings(PyObject *module) {
    .def("_jit_pass_cse", [](std::shared_ptr<Graph>& g) {
      return EliminateCommonSubexpression(g); // overload resolution
    })
-   .def("_jit_pass_peephole", PeepholeOptimize)
+   .def("_jit_pass_peephole", [](std::shared_ptr<Graph>& g, bool specialized_shapes) {
+     return PeepholeOptimize(g, specialized_shapes);
+   }, py::arg("graph"), py::arg("specialized_shapes") = false)
    .def("_jit_pass_canonicalize", [](const std::shared_ptr<Graph>& g) {
      return Canonicalize(g);
    })
@@ -86,9 +97,24 @@ void initJITBindings(PyObject *module) {
    .def("_jit_pass_remove_expands", RemoveExpands)
    .def("_jit_pass_erase_number_types", EraseNumberTypes)
    .def("_jit_pass_loop_unrolling", UnrollLoops)
+   .def("_jit_pass_loop_fusion", FuseLoops)
+   .def("_jit_pass_loop_invariant_code_motion", HoistLoopInvariants)
    .def("_jit_pass_constant_propagation", [](std::shared_ptr<Graph>& g) {
      return ConstantPropagation(g);
    })
+   .def("_jit_pass_plan_memory", PlanMemory)
+   .def("_jit_set_memory_planning_enabled", setMemoryPlanningEnabled)
+   .def("_jit_get_memory_planning_enabled", memoryPlanningEnabled)
+   .def("_jit_set_plan_cache_limit", setPlanCacheLimit)
+   .def("_jit_get_plan_cache_limit", planCacheLimit)
+   .def("_jit_set_inter_op_parallel_enabled", setInterOpParallelEnabled)
+   .def("_jit_get_inter_op_parallel_enabled", interOpParallelEnabled)
+   .def("_jit_set_cuda_graphs_enabled", setCUDAGraphsEnabled)
+   .def("_jit_get_cuda_graphs_enabled", cudaGraphsEnabled)
+   .def("_jit_fusion_disk_cache_stats", [] {
+     auto & stats = sharedFusionCompiler().diskCacheStats();
+     return std::make_pair(stats.hits.load(), stats.misses.load());
+   })
    .def("_jit_run_cpp_tests", [] {
      // We have to release the GIL inside this method, because if we happen to
      // initialize the autograd engine in these tests, the newly spawned worker threads will
@@ -172,6 +198,15 @@ void initJITBindings(PyObject *module) {
     })
     .def_property_readonly("autograd_fallback_graph", [](GraphExecutorState& s) {
       return s.autograd_fallback_graph;
+    })
+    .def_property_readonly("plan_cache_hits", [](GraphExecutorState& s) {
+      return s.plan_cache_hits;
+    })
+    .def_property_readonly("plan_cache_misses", [](GraphExecutorState& s) {
+      return s.plan_cache_misses;
+    })
+    .def_property_readonly("plan_cache_evictions", [](GraphExecutorState& s) {
+      return s.plan_cache_evictions;
     });
 
   py::class_<GraphExecutor>(m, "GraphExecutor", py::dynamic_attr())
@@ -257,6 +292,7 @@ void initJITBindings(PyObject *module) {
   script::initTreeViewBindings(module);
   script::initJitScriptBindings(module);
   initBatchTensorBindings(module);
+  initBatchingExecutorBindings(module);
   initRegisterBatchOpsBindings(module);
 }
 
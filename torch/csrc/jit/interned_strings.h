@@ -54,23 +54,30 @@ _(prim, GradOf) \
 _(prim, AnyDefined) \
 _(prim, FusedConcat) \
 _(prim, FusedChunk) \
+_(prim, FusedReduce) \
+_(prim, AllocateArena) \
 _(aten, __not__) \
+_(aten, detach) \
 FORALL_ATEN_BASE_SYMBOLS(_) \
 _(onnx, Add) \
+_(onnx, BatchNormalization) \
 _(onnx, Concat) \
 _(onnx, Constant) \
 _(onnx, ConstantFill) \
+_(onnx, Conv) \
 _(onnx, Div) \
 _(onnx, GRU) \
 _(onnx, Gather) \
 _(onnx, Gemm) \
 _(onnx, LSTM) \
 _(onnx, Mul) \
+_(onnx, Neg) \
 _(onnx, Pow) \
 _(onnx, RNN) \
 _(onnx, Shape) \
 _(onnx, Size) \
 _(onnx, Slice) \
+_(onnx, Sqrt) \
 _(onnx, Squeeze) \
 _(onnx, Sub) \
 _(onnx, Transpose) \
@@ -94,7 +101,8 @@ _(attr, starts) \
 _(attr, transA) \
 _(attr, transB) \
 _(attr, name) \
-_(attr, string)
+_(attr, string) \
+_(attr, arena_offsets)
 
 
 // 'prim' symbols are synthetic operators that occur only in the IR
@@ -37,7 +37,9 @@ namespace torch { namespace jit {
 //   and ends with a store to the stack
 // *. computes move_flags (see Outputs), and inserts
 // *  Drop nodes are inserted for any node that is unused to create a dummy use
-//    that will cause the interpreter to free the node.
+//    that will cause the interpreter to free the node. Constants are never
+//    dropped or moved, since their registers are filled once per
+//    InterpreterState (see CodeImpl::initial_registers).
 //    A drop node is just a node with no outputs that just pops its inputs off the stack,
 //    to ensure the interpreter release references to nodes that are never used.
 //    Drop nodes are also inserted when the last use of a node is in some conditionally
@@ -178,7 +180,7 @@ void dropUnused(Block *b) {
   auto createDropIfUnused = [&](ArrayRef<Value*> values) -> Node* {
     std::vector<Value*> to_drop;
     for(auto v : values) {
-      if(v->uses().size() == 0)
+      if(v->uses().size() == 0 && v->node()->kind() != prim::Constant)
         to_drop.push_back(v);
     }
     if(to_drop.size() == 0)
@@ -236,6 +238,11 @@ std::unordered_map<Node*, std::vector<uint8_t>> findLastUses(Graph & g) {
     void scanUse(Node * n, size_t i) {
       auto & move_flags_n = move_flags[n];
       auto v = n->inputs()[i];
+      // constants keep their registers for the whole run
+      if(v->node()->kind() == prim::Constant) {
+        move_flags_n[i] = false;
+        return;
+      }
       auto inserted = seen.insert(v).second;
       if(!inserted) {
         move_flags_n[i] = false;
@@ -372,15 +379,116 @@ struct UseList {
   ListHandle<bool> free_flags;
 };
 
+// Note [Direct instructions]
+// Most instructions push their inputs from the registers onto the stack, call
+// an Operation that pops them and pushes its outputs, and finally pop the
+// outputs into registers. For jumps and for the tiny scalar ops that loop
+// counters and conditions are made of, this traffic (and the std::function
+// call) costs more than the op itself. Such instructions instead have a
+// DirectOperation, a plain function that reads its inputs from and writes its
+// outputs to the registers directly, given the register indices of the
+// instruction. Like an Operation, it returns the relative jump to take.
+// Direct instructions only read ints and floats, so they ignore free flags.
+using DirectOperation = int (*)(
+    IValue* registers,
+    const int* inputs,
+    const int* outputs,
+    int jump_offset);
+
 // one instruction plus meta-data
 struct Instruction {
   Operation callback;
+  // if set, it is called instead of callback, see Note [Direct instructions]
+  DirectOperation direct = nullptr;
+  int jump_offset = 0; // for direct jumps
   UseList inputs;
   ListHandle<int> outputs;
   Symbol debug_name; // used in dump to understand the generated code
   std::shared_ptr<SourceLocation> debug_location; // for error reporting
 };
 
+namespace {
+
+int directJumpZ(IValue* registers, const int* inputs, const int* outputs, int jump_offset) {
+  return registers[inputs[0]].toInt() == 0 ? jump_offset : 0;
+}
+
+int directJumpNZ(IValue* registers, const int* inputs, const int* outputs, int jump_offset) {
+  return registers[inputs[0]].toInt() != 0 ? jump_offset : 0;
+}
+
+int directJump(IValue* registers, const int* inputs, const int* outputs, int jump_offset) {
+  return jump_offset;
+}
+
+// these must compute exactly what the ops in register_prim_ops.cpp compute
+#define DEFINE_DIRECT_OP(name, scalar_t, result_t, op)                        int name(IValue* registers, const int* inputs, const int* outputs, int) {     const scalar_t a = registers[inputs[0]].to<scalar_t>();                     const scalar_t b = registers[inputs[1]].to<scalar_t>();                     registers[outputs[0]] = IValue(static_cast<result_t>(op));                  return 0;                                                                 }
+
+#define DEFINE_DIRECT_INT_AND_FLOAT_OPS(name, op, float_result_t)   DEFINE_DIRECT_OP(directInt##name, int64_t, int64_t, op)           DEFINE_DIRECT_OP(directFloat##name, double, float_result_t, op)
+
+DEFINE_DIRECT_INT_AND_FLOAT_OPS(Add, a + b, double)
+DEFINE_DIRECT_INT_AND_FLOAT_OPS(Sub, a - b, double)
+DEFINE_DIRECT_INT_AND_FLOAT_OPS(Mul, a * b, double)
+DEFINE_DIRECT_INT_AND_FLOAT_OPS(Ne, a != b, int64_t)
+DEFINE_DIRECT_INT_AND_FLOAT_OPS(Eq, a == b, int64_t)
+DEFINE_DIRECT_INT_AND_FLOAT_OPS(Lt, a < b, int64_t)
+DEFINE_DIRECT_INT_AND_FLOAT_OPS(Gt, a > b, int64_t)
+DEFINE_DIRECT_INT_AND_FLOAT_OPS(Le, a <= b, int64_t)
+DEFINE_DIRECT_INT_AND_FLOAT_OPS(Ge, a >= b, int64_t)
+DEFINE_DIRECT_OP(directIntAnd, int64_t, int64_t, a && b)
+DEFINE_DIRECT_OP(directIntOr, int64_t, int64_t, a || b)
+
+#undef DEFINE_DIRECT_INT_AND_FLOAT_OPS
+#undef DEFINE_DIRECT_OP
+
+bool allInputsHaveType(Node* node, const TypePtr& type) {
+  for(auto input : node->inputs()) {
+    if(*input->type() != *type)
+      return false;
+  }
+  return true;
+}
+
+// Returns the direct implementation of a binary op on ints or floats,
+// or nullptr if the node is not one
+DirectOperation getDirectOperation(Node* node) {
+  if(node->inputs().size() != 2 || node->outputs().size() != 1)
+    return nullptr;
+  if(allInputsHaveType(node, IntType::get())) {
+    switch(node->kind()) {
+      case aten::add: return &directIntAdd;
+      case aten::sub: return &directIntSub;
+      case aten::mul: return &directIntMul;
+      case aten::ne: return &directIntNe;
+      case aten::eq: return &directIntEq;
+      case aten::lt: return &directIntLt;
+      case aten::gt: return &directIntGt;
+      case aten::le: return &directIntLe;
+      case aten::ge: return &directIntGe;
+      case aten::__and__: return &directIntAnd;
+      case aten::__or__: return &directIntOr;
+      default: return nullptr;
+    }
+  }
+  if(allInputsHaveType(node, FloatType::get())) {
+    switch(node->kind()) {
+      case aten::add: return &directFloatAdd;
+      case aten::sub: return &directFloatSub;
+      case aten::mul: return &directFloatMul;
+      case aten::ne: return &directFloatNe;
+      case aten::eq: return &directFloatEq;
+      case aten::lt: return &directFloatLt;
+      case aten::gt: return &directFloatGt;
+      case aten::le: return &directFloatLe;
+      case aten::ge: return &directFloatGe;
+      default: return nullptr;
+    }
+  }
+  return nullptr;
+}
+
+} // namespace
+
 
 int relativeJump(int from_inst, int to_inst) {
   return to_inst - (from_inst + 1);
@@ -392,17 +500,18 @@ struct CodeImpl {
     graph = preprocess.graph;
     // std::cout << "into code graph:\n" << *graph << "\n";
     insertNodesFromBlock(graph->block());
+    initial_registers.resize(register_size);
+    for(auto & constant : constants) {
+      initial_registers[constant.first] = constant.second;
+    }
   }
 
   // jump when input is 0
   void createJumpZ(int from_inst, int to_inst) {
     auto & inst = instructions[from_inst];
     JIT_ASSERT(inst.debug_name == prim::Placeholder);
-    auto offset = relativeJump(from_inst, to_inst);
-    inst.callback = [offset](Stack & stack) {
-      auto t = pop(stack).toInt();
-      return (t == 0) ? offset : 0;
-    };
+    inst.direct = &directJumpZ;
+    inst.jump_offset = relativeJump(from_inst, to_inst);
     inst.debug_name = prim::JumpZ;
   }
 
@@ -410,21 +519,16 @@ struct CodeImpl {
   void createJumpNZ(int from_inst, int to_inst) {
     auto & inst = instructions[from_inst];
     JIT_ASSERT(inst.debug_name == prim::Placeholder);
-    auto offset = relativeJump(from_inst, to_inst);
-    inst.callback = [offset](Stack & stack) {
-      auto t = pop(stack).toInt();
-      return (t != 0) ? offset : 0;
-    };
+    inst.direct = &directJumpNZ;
+    inst.jump_offset = relativeJump(from_inst, to_inst);
     inst.debug_name = prim::JumpNZ;
   }
 
   void createJump(int from_inst, int to_inst) {
     auto & inst = instructions[from_inst];
     JIT_ASSERT(inst.debug_name == prim::Placeholder);
-    auto offset = relativeJump(from_inst, to_inst);
-    inst.callback = [=](Stack & stack) {
-      return offset;
-    };
+    inst.direct = &directJump;
+    inst.jump_offset = relativeJump(from_inst, to_inst);
     inst.debug_name = prim::Jump;
   }
 
@@ -500,6 +604,13 @@ struct CodeImpl {
           createJumpZ(cond_branch, instructions.size());
           createJumpNZ(cond_branch_end, entry);
         } break;
+        case prim::Constant: {
+          // constants are baked into the initial registers instead of being
+          // recomputed by an instruction on every run
+          auto value = toIValue(node->output());
+          JIT_ASSERT(value);
+          constants.emplace_back(getOrAllocateRegister(node->output()), std::move(*value));
+        } break;
         default: {
           insertInstruction(node);
         } break;
@@ -515,7 +626,11 @@ struct CodeImpl {
 
   size_t insertInstruction(Node * n) {
     auto inst = insertInstruction(n->kind(), n->getSourceLocation(), n->inputs(), moveFlags(n) , n->outputs());
-    instructions[inst].callback = getInterpreterOperation(n);
+    if(auto direct = getDirectOperation(n)) {
+      instructions[inst].direct = direct;
+    } else {
+      instructions[inst].callback = getInterpreterOperation(n);
+    }
     return inst;
   }
   size_t insertInstruction(Symbol sym,
@@ -652,6 +767,9 @@ struct CodeImpl {
     writeUseList(inst.inputs);
   }
   void dump(std::ostream & out) const {
+    for(auto & constant : constants) {
+      out << constant.first << " = Constant " << constant.second << "\n";
+    }
     for(size_t i = 0; i < instructions.size(); ++i) {
       dumpInstruction(out, i);
       out << "\n";
@@ -674,6 +792,11 @@ struct CodeImpl {
   std::vector<size_t> stage_end; // each stage runs while(pc < stage_end[stage])
   int register_size = 0;
 
+  // the registers of constants and their values
+  std::vector<std::pair<int, IValue>> constants;
+  // the registers at the start of a run: constants, and undefined otherwise
+  std::vector<IValue> initial_registers;
+
   // all memory ArrayRef<int> are slices of this, to make sure
   // the interpreter is mostly linearly scanning through memory
   std::vector<int> int_data;
@@ -686,7 +809,7 @@ struct InterpreterStateImpl {
   : function(code.pImpl),
     int_data(function->int_data.data()),
     bool_data(function->bool_data),
-    registers(function->register_size) {
+    registers(function->initial_registers) {
   }
   void runOneStage(Stack & stack) {
     // std::cout << "running stage: " << current_stage << " of " << function->stage_end.size() << "\n";
@@ -701,6 +824,14 @@ struct InterpreterStateImpl {
         // std::cout << "\n";
         try {
           auto & inst = instructions[pc];
+          if(inst.direct) {
+            pc += 1 + inst.direct(
+                registers.data(),
+                int_data + inst.inputs.values.start,
+                int_data + inst.outputs.start,
+                inst.jump_offset);
+            continue;
+          }
           loadTensorsFromRegisters(inst.inputs, stack);
           size_t new_pc = pc + 1 + inst.callback(stack);
           for(int i = inst.outputs.size - 1; i >= 0; i--) {
@@ -719,6 +850,11 @@ struct InterpreterStateImpl {
     current_pc = pc;
     current_stage++;
   }
+  void reset() {
+    current_stage = 0;
+    current_pc = 0;
+    registers = function->initial_registers;
+  }
   const TensorType & tensorTypeForInput(size_t i) const {
     return *function->preprocess.stage_input_types.at(current_stage).at(i)->expect<TensorType>();
   }
@@ -790,6 +926,10 @@ const TensorType & InterpreterState::tensorTypeForInput(size_t i) const {
   return pImpl->tensorTypeForInput(i);
 }
 
+void InterpreterState::reset() {
+  pImpl->reset();
+}
+
 InterpreterState InterpreterState::clone() const {
   return InterpreterState(new InterpreterStateImpl(*pImpl));
 }
@@ -54,6 +54,9 @@ struct InterpreterState {
   // create a copy of InterpreterState with its current state
   // used when retain_graph=True so that stages can be re-run
   InterpreterState clone() const;
+  // rewind to the first stage and drop the values left over from previous
+  // runs, so that the state can run the code again without reallocating
+  void reset();
 private:
   InterpreterState(InterpreterStateImpl * pImpl);
   std::shared_ptr<InterpreterStateImpl> pImpl;
@@ -276,7 +276,7 @@ struct IValue {
   }
   TORCH_API std::ostream& formatString(std::ostream& out) const {
     JIT_ASSERT(isString());
-    out << toRetainable<ConstantString>()->string();
+    out << peekRetainable<ConstantString>()->string();
     return out;
   }
 
@@ -396,6 +396,12 @@ private:
   Shared<T> toRetainable() const {
     return Shared<T>(static_cast<T*>(as_retainable), true);
   }
+  // borrows the payload without touching its refcount; only valid while
+  // this IValue holds it
+  template<typename T>
+  const T* peekRetainable() const {
+    return static_cast<const T*>(as_retainable);
+  }
   void clearToNone() {
     payload = 0;
     tag = Tag::None;
@@ -497,16 +503,22 @@ inline IValue::IValue(Shared<TensorList> v)
 inline IValue::IValue(std::vector<at::Tensor> v)
 : IValue(TensorList::create(std::move(v))) {}
 
+// The *Ref accessors are on the path of every op that takes a list, so they
+// return a reference into the list held by this IValue instead of going
+// through a Shared<>, which would cost a retain/release pair.
 inline const std::vector<int64_t>& IValue::toIntListRef() const {
-  return toIntList()->elements();
+  JIT_ASSERT(isIntList());
+  return peekRetainable<IntList>()->elements();
 }
 
 inline const std::vector<double>& IValue::toDoubleListRef() const {
-  return toDoubleList()->elements();
+  JIT_ASSERT(isDoubleList());
+  return peekRetainable<DoubleList>()->elements();
 }
 
 inline const std::vector<at::Tensor>& IValue::toTensorListRef() const {
-  return toTensorList()->elements();
+  JIT_ASSERT(isTensorList());
+  return peekRetainable<TensorList>()->elements();
 }
 
 
@@ -5,6 +5,8 @@
 
 #include "torch/csrc/jit/script/error_report.h"
 
+#include <cstring>
+
 namespace torch { namespace jit {
 
 namespace script {
@@ -251,9 +253,11 @@ struct OperatorRegistry  {
 private:
   std::mutex lock;
   OperatorMap operators;
-  // list of operators whose schema have not yet been parsed, and must
-  // be registered before any call to lookup an opeator
-  std::vector<std::shared_ptr<Operator>> to_register;
+  // operators that have not been looked up yet, by qualified name. Looking
+  // up a name only parses the schemas of the operators with that name, so
+  // that a process pays for the operators it uses rather than for all the
+  // ones registered by the libraries it loads.
+  std::unordered_map<std::string, std::vector<std::shared_ptr<Operator>>> to_register;
   // Those two maps are used to implement lookupByLiteral, which is needed for the n->match(...) calls.
   // Basically, every function schema is assigned a unique string you can use to match it. However,
   // parsing those strings or comparing and hashing them character by character would be very slow, so
@@ -266,26 +270,33 @@ private:
   std::unordered_map<const char *, std::shared_ptr<Operator>> operators_by_sig_literal;
 
   // XXX - caller must be holding lock
-  void registerPendingOperators() {
-    for(auto op : to_register) {
-      Symbol sym = Symbol::fromQualString(op->schema().name);
+  void registerPendingOperators(const std::string& name) {
+    auto pending = to_register.find(name);
+    if (pending == to_register.end())
+      return;
+    Symbol sym = Symbol::fromQualString(name);
+    for(auto & op : pending->second) {
+      JIT_ASSERTM(op->schema().name == name, "Operator name ", name,
+                  " doesn't match its schema ", op->schema());
       operators[sym].push_back(op);
       operators_by_sig[canonicalSchemaString(op->schema())] = op;
     }
-    to_register.clear();
+    to_register.erase(pending);
   }
 
 public:
   void registerOperator(Operator&& op) {
+    auto name = op.name();
     std::lock_guard<std::mutex> guard(lock);
-    to_register.push_back(std::make_shared<Operator>(std::move(op)));
+    to_register[name].push_back(std::make_shared<Operator>(std::move(op)));
   }
 
   const std::shared_ptr<Operator>& lookupByLiteral(const char * name) {
     std::lock_guard<std::mutex> guard(lock);
-    registerPendingOperators();
     auto it = operators_by_sig_literal.find(name);
     if (it == operators_by_sig_literal.end()) {
+      // the canonical schema string starts with the name of the operator
+      registerPendingOperators(std::string(name, strcspn(name, "(")));
       auto op_ptr_it = operators_by_sig.find(name);
       // Handy debugging code that dumps all operators we know about on mismatch
 #if 0
@@ -304,7 +315,7 @@ public:
 
   const std::vector<std::shared_ptr<Operator>>& getOperators(Symbol name) {
     std::lock_guard<std::mutex> guard(lock);
-    registerPendingOperators();
+    registerPendingOperators(name.toQualString());
     static std::vector<std::shared_ptr<Operator>> empty;
     auto it = operators.find(name);
     if(it != operators.end())
@@ -336,6 +347,22 @@ FunctionSchema parseSchema(const std::string& schema) {
   return script::SchemaParser(schema).parseDeclarations().at(0);
 }
 
+std::string Operator::name() const {
+  if (schema_) {
+    return schema_->name;
+  }
+  // a schema starts with the name, e.g. "aten::add(Tensor self, ...",
+  // anything else is left for the parser to report
+  const auto& schema = schema_string_.value();
+  auto begin = schema.find_first_not_of(" \t\n");
+  auto end = schema.find('(');
+  if (begin == std::string::npos || end == std::string::npos || begin >= end) {
+    return this->schema().name;
+  }
+  end = schema.find_last_not_of(" \t\n", end - 1) + 1;
+  return schema.substr(begin, end - begin);
+}
+
 bool Operator::matches(const Node* node) const {
   // wrong name
   if (node->kind().toQualString() != schema().name) {
@@ -67,6 +67,10 @@ struct TORCH_API Operator {
     }
     return *schema_;
   }
+
+  // The qualified name of the operator. Schemas that are still strings are
+  // not parsed to get it, so that registering an operator stays cheap.
+  std::string name() const;
 private:
   mutable at::optional<std::string> schema_string_;
   // cannot use at::optional because windows has issues that require an assignment operator to be generated
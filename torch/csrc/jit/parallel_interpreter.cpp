@@ -0,0 +1,424 @@
+#include "torch/csrc/jit/parallel_interpreter.h"
+
+#include "torch/csrc/autograd/grad_mode.h"
+#include "torch/csrc/jit/assertions.h"
+#include "torch/csrc/jit/interpreter.h"
+#include "torch/csrc/jit/ir.h"
+#include "torch/csrc/jit/ivalue.h"
+#include "torch/csrc/jit/operator.h"
+
+#include <ATen/core/ThreadPool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace torch { namespace jit {
+
+namespace {
+
+std::atomic<bool>& interOpParallelFlag() {
+  static std::atomic<bool> enabled([] {
+    const char* env = std::getenv("PYTORCH_JIT_INTER_OP");
+    return env && std::string(env) == "1";
+  }());
+  return enabled;
+}
+
+// In-place operators are named with a single trailing underscore (add_),
+// unlike the dunder methods (__and__).
+bool isInplaceKind(Symbol kind) {
+  if (!kind.is_aten())
+    return false;
+  std::string name = kind.toUnqualString();
+  return name.size() > 1 && name.back() == '_' && name[name.size() - 2] != '_';
+}
+
+bool hasSideEffects(const Node * n) {
+  if (n->kind() == prim::Print || n->kind() == prim::PythonOp ||
+      isInplaceKind(n->kind())) {
+    return true;
+  }
+  for (auto b : n->blocks()) {
+    for (auto nested : b->nodes()) {
+      if (hasSideEffects(nested))
+        return true;
+    }
+  }
+  return false;
+}
+
+bool isTopLevelControlFlow(Node * n) {
+  return n->blocks().size() > 0 || n->kind() == prim::GraphExecutor;
+}
+
+// Values used by the nested blocks of 'n' that are defined outside of 'n'.
+// These are implicit inputs of 'n' for the purpose of scheduling.
+std::vector<Value*> freeVariables(Node * n) {
+  std::unordered_set<Value*> defined;
+  std::unordered_set<Value*> seen(n->inputs().begin(), n->inputs().end());
+  std::vector<Value*> free_vars;
+  std::function<void(Block*)> scan = [&](Block * b) {
+    for (auto v : b->inputs())
+      defined.insert(v);
+    auto use = [&](Value * v) {
+      if (defined.count(v) == 0 && seen.insert(v).second)
+        free_vars.push_back(v);
+    };
+    for (auto nested : b->nodes()) {
+      for (auto v : nested->inputs())
+        use(v);
+      for (auto sb : nested->blocks())
+        scan(sb);
+      for (auto v : nested->outputs())
+        defined.insert(v);
+    }
+    for (auto v : b->outputs())
+      use(v);
+  };
+  for (auto b : n->blocks())
+    scan(b);
+  return free_vars;
+}
+
+// Wraps a single node with blocks into a graph of its own so that it can be
+// compiled into a Code and run by the regular interpreter.
+std::shared_ptr<Graph> subgraphForNode(Node * n, at::ArrayRef<Value*> inputs) {
+  auto g = std::make_shared<Graph>();
+  std::unordered_map<Value*, Value*> value_map;
+  for (auto v : inputs) {
+    value_map[v] = g->addInput()->copyMetadata(v);
+  }
+  auto clone = g->appendNode(g->createClone(n, [&](Value * v) {
+    return value_map.at(v);
+  }));
+  for (auto o : clone->outputs()) {
+    g->registerOutput(o);
+  }
+  return g;
+}
+
+} // anonymous namespace
+
+struct ParallelCodeImpl {
+  struct NodeInfo {
+    Operation op;
+    // wrapped nodes (those with blocks) are run through the interpreter
+    std::shared_ptr<Code> code;
+    std::vector<int> inputs;
+    std::vector<int> outputs;
+    std::vector<int> successors;
+    int num_deps = 0;
+    std::shared_ptr<SourceLocation> debug_location;
+  };
+
+  ParallelCodeImpl(std::shared_ptr<Graph> graph_)
+  : graph(std::move(graph_)) {
+    JIT_ASSERTM(graph->stage() == 0, "ParallelCode only supports single-stage graphs");
+    for (auto input : graph->inputs()) {
+      input_slots.push_back(slotFor(input));
+    }
+
+    std::unordered_map<Node*, int> node_index;
+    int last_barrier = -1;
+    std::vector<int> since_barrier;
+    for (auto n : graph->nodes()) {
+      if (n->kind() == prim::Constant || n->kind() == prim::Undefined) {
+        // evaluated once here and copied into every run
+        Stack stack;
+        getOperation(n)(stack);
+        JIT_ASSERT(stack.size() == 1);
+        constants.emplace_back(slotFor(n->output()), std::move(stack.back()));
+        continue;
+      }
+      NodeInfo info;
+      std::vector<Value*> inputs(n->inputs().begin(), n->inputs().end());
+      if (isTopLevelControlFlow(n)) {
+        auto free_vars = freeVariables(n);
+        inputs.insert(inputs.end(), free_vars.begin(), free_vars.end());
+        auto subgraph = subgraphForNode(n, inputs);
+        info.code = std::make_shared<Code>(subgraph);
+      } else {
+        info.op = getOperation(n);
+      }
+      for (auto v : inputs) {
+        info.inputs.push_back(slotFor(v));
+      }
+      for (auto v : n->outputs()) {
+        info.outputs.push_back(slotFor(v));
+      }
+      info.debug_location = n->getSourceLocation();
+      const int idx = nodes.size();
+      nodes.push_back(std::move(info));
+      node_index[n] = idx;
+
+      std::unordered_set<int> deps;
+      for (auto v : inputs) {
+        auto it = node_index.find(v->node());
+        if (it != node_index.end())
+          deps.insert(it->second);
+      }
+      if (hasSideEffects(n)) {
+        for (int prev : since_barrier)
+          deps.insert(prev);
+        since_barrier.clear();
+        last_barrier = idx;
+      } else {
+        since_barrier.push_back(idx);
+      }
+      if (last_barrier >= 0 && last_barrier != idx)
+        deps.insert(last_barrier);
+      for (int d : deps) {
+        nodes[d].successors.push_back(idx);
+      }
+      nodes[idx].num_deps = deps.size();
+    }
+    for (auto output : graph->outputs()) {
+      output_slots.push_back(slotFor(output));
+    }
+
+    // the number of times each slot is read, so that runs can release
+    // intermediate values as soon as their last consumer has finished
+    slot_uses.resize(num_slots, 0);
+    for (auto & info : nodes) {
+      for (int s : info.inputs)
+        slot_uses[s]++;
+    }
+    for (int s : output_slots)
+      slot_uses[s]++;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      if (nodes[i].num_deps == 0)
+        roots.push_back(i);
+    }
+  }
+
+  int slotFor(Value * v) {
+    auto it = value_to_slot.find(v);
+    if (it != value_to_slot.end())
+      return it->second;
+    int s = num_slots++;
+    value_to_slot[v] = s;
+    return s;
+  }
+
+  // state for a single call to run()
+  struct RunState {
+    RunState(const ParallelCodeImpl & code)
+    : slots(code.num_slots),
+      deps(code.nodes.size()),
+      uses(code.num_slots),
+      remaining(code.nodes.size()),
+      grad_mode(autograd::GradMode::is_enabled()) {
+      for (size_t i = 0; i < code.nodes.size(); ++i)
+        deps[i] = code.nodes[i].num_deps;
+      for (size_t i = 0; i < code.slot_uses.size(); ++i)
+        uses[i] = code.slot_uses[i];
+    }
+    std::vector<IValue> slots;
+    std::vector<std::atomic<int>> deps;
+    std::vector<std::atomic<int>> uses;
+    std::atomic<size_t> remaining;
+    std::atomic<bool> failed {false};
+    std::exception_ptr eptr;
+    std::mutex mutex;
+    std::condition_variable done;
+    const bool grad_mode;
+  };
+
+  void runNode(RunState & state, int idx) const {
+    auto & info = nodes[idx];
+    if (!state.failed.load()) {
+      try {
+        Stack stack;
+        stack.reserve(info.inputs.size());
+        for (int s : info.inputs) {
+          // Always copy, then let the last reader clear the slot; moving out
+          // on the last read would race with concurrent copies by other
+          // consumers of the same value.
+          stack.push_back(state.slots[s]);
+          if (--state.uses[s] == 0) {
+            state.slots[s] = IValue();
+          }
+        }
+        if (info.code) {
+          InterpreterState(*info.code).runOneStage(stack);
+        } else {
+          info.op(stack);
+        }
+        JIT_ASSERT(stack.size() == info.outputs.size());
+        for (size_t i = 0; i < info.outputs.size(); ++i) {
+          state.slots[info.outputs[i]] = std::move(stack[i]);
+        }
+      } catch (std::exception & e) {
+        std::exception_ptr eptr;
+        try {
+          if (info.debug_location)
+            info.debug_location->wrapAndRethrowException(e, "operation failed in interpreter");
+          throw;
+        } catch (...) {
+          eptr = std::current_exception();
+        }
+        std::lock_guard<std::mutex> guard(state.mutex);
+        if (!state.eptr)
+          state.eptr = eptr;
+        state.failed = true;
+      }
+    }
+  }
+
+  // runs 'idx' and then, in a loop, one of the successors it made ready;
+  // the remaining ready successors are handed to the pool
+  void runChain(RunState & state, int idx) const {
+    autograd::AutoGradMode grad_guard(state.grad_mode);
+    while (idx >= 0) {
+      runNode(state, idx);
+      int next = -1;
+      for (int succ : nodes[idx].successors) {
+        if (--state.deps[succ] == 0) {
+          if (next < 0) {
+            next = succ;
+          } else {
+            RunState * s = &state;
+            interOpThreadPool().submit([this, s, succ]() { runChain(*s, succ); });
+          }
+        }
+      }
+      {
+        // decrement under the lock: run() may destroy 'state' as soon as it
+        // observes remaining == 0 and acquires the mutex
+        std::lock_guard<std::mutex> guard(state.mutex);
+        if (--state.remaining == 0)
+          state.done.notify_all();
+      }
+      idx = next;
+    }
+  }
+
+  void run(Stack & stack) const {
+    RunState state(*this);
+    const size_t num_inputs = input_slots.size();
+    auto inputs = last(stack, num_inputs);
+    for (size_t i = 0; i < num_inputs; ++i) {
+      state.slots[input_slots[i]] = std::move(inputs[i]);
+    }
+    drop(stack, num_inputs);
+    for (auto & c : constants) {
+      state.slots[c.first] = c.second;
+    }
+
+    if (!roots.empty()) {
+      auto & pool = interOpThreadPool();
+      for (size_t i = 1; i < roots.size(); ++i) {
+        RunState * s = &state;
+        int root = roots[i];
+        pool.submit([this, s, root]() { runChain(*s, root); });
+      }
+      runChain(state, roots[0]);
+
+      // Help with queued work while waiting; a blocked caller must never be
+      // the only thread able to run the tasks it is waiting on (e.g. when
+      // this run is nested inside another ParallelCode node).
+      while (state.remaining.load() > 0) {
+        if (!pool.run_pending_task()) {
+          std::unique_lock<std::mutex> lock(state.mutex);
+          state.done.wait_for(lock, std::chrono::milliseconds(1), [&] {
+            return state.remaining.load() == 0;
+          });
+        }
+      }
+      std::lock_guard<std::mutex> guard(state.mutex);
+      if (state.eptr)
+        std::rethrow_exception(state.eptr);
+    }
+
+    for (int s : output_slots) {
+      if (--state.uses[s] == 0) {
+        stack.push_back(std::move(state.slots[s]));
+      } else {
+        stack.push_back(state.slots[s]);
+      }
+    }
+  }
+
+  // keep the graph alive, operations may reference its meta-data
+  std::shared_ptr<Graph> graph;
+  std::vector<NodeInfo> nodes;
+  std::vector<int> roots;
+  std::vector<std::pair<int, IValue>> constants;
+  std::vector<int> input_slots;
+  std::vector<int> output_slots;
+  std::vector<int> slot_uses;
+  std::unordered_map<Value*, int> value_to_slot;
+  int num_slots = 0;
+};
+
+ParallelCode::ParallelCode(std::shared_ptr<Graph> graph)
+  : pImpl(new ParallelCodeImpl(std::move(graph))) {}
+ParallelCode::~ParallelCode() = default;
+
+void ParallelCode::run(Stack & stack) const {
+  pImpl->run(stack);
+}
+
+bool ParallelCode::isProfitable(const Graph & graph) {
+  if (graph.stage() != 0)
+    return false;
+  // Assign every node the length of the longest dependency chain leading to
+  // it; two real nodes at the same depth can run concurrently.
+  std::unordered_map<const Node*, int> depth;
+  std::unordered_map<int, int> width;
+  int barrier_depth = 0;
+  for (auto n : graph.nodes()) {
+    if (n->kind() == prim::Constant || n->kind() == prim::Undefined)
+      continue;
+    // memory-planned graphs rely on nodes running in graph order
+    if (n->kind() == prim::AllocateArena)
+      return false;
+    int d = barrier_depth;
+    for (auto v : n->inputs()) {
+      auto it = depth.find(v->node());
+      if (it != depth.end())
+        d = std::max(d, it->second + 1);
+    }
+    if (hasSideEffects(n)) {
+      for (auto & entry : depth)
+        d = std::max(d, entry.second + 1);
+      barrier_depth = d + 1;
+    }
+    depth[n] = d;
+    if (++width[d] >= 2)
+      return true;
+  }
+  return false;
+}
+
+void setInterOpParallelEnabled(bool enabled) {
+  interOpParallelFlag() = enabled;
+}
+
+bool interOpParallelEnabled() {
+  return interOpParallelFlag();
+}
+
+at::ThreadPool& interOpThreadPool() {
+  static at::ThreadPool pool([] {
+    const char* env = std::getenv("PYTORCH_JIT_INTER_OP_THREADS");
+    if (env) {
+      return static_cast<size_t>(std::max(0, std::atoi(env)));
+    }
+    return static_cast<size_t>(std::thread::hardware_concurrency());
+  }());
+  return pool;
+}
+
+}}
@@ -0,0 +1,60 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "torch/csrc/WindowsTorchApiMacro.h"
+
+namespace at {
+  class ThreadPool;
+}
+namespace torch { namespace jit {
+
+// ParallelCode runs a Graph by building a dependency DAG over the nodes of
+// its top-level block and dispatching nodes whose inputs are ready to an
+// inter-op thread pool. This lets independent branches of a wide graph
+// (e.g. the towers of a multi-head model) run concurrently within a single
+// request. Nodes with nested blocks (If, Loop) and GraphExecutor nodes are
+// compiled into their own Code and run sequentially as a single DAG node.
+//
+// Nodes that may have side effects (in-place operators, Print, PythonOp)
+// act as barriers: they run after every node before them and before every
+// node after them, so that the sequential semantics of the graph are kept.
+//
+// Only single-stage graphs are supported; use Code/InterpreterState for
+// multi-stage graphs.
+
+struct Graph;
+struct IValue;
+struct ParallelCodeImpl;
+using Stack = std::vector<IValue>;
+
+struct TORCH_API ParallelCode {
+  ParallelCode(std::shared_ptr<Graph> graph);
+  ~ParallelCode();
+
+  // Pops the graph inputs off the stack, runs the graph and pushes its
+  // outputs, matching the behavior of InterpreterState::runOneStage.
+  void run(Stack & stack) const;
+
+  // true if 'graph' can be run by ParallelCode and has at least two
+  // non-constant nodes that could execute concurrently.
+  static bool isProfitable(const Graph & graph);
+
+private:
+  std::shared_ptr<ParallelCodeImpl> pImpl;
+};
+
+// Whether GraphExecutor should use ParallelCode for execution plans where it
+// is profitable. Defaults to false unless the PYTORCH_JIT_INTER_OP environment
+// variable is set to 1.
+TORCH_API void setInterOpParallelEnabled(bool enabled);
+TORCH_API bool interOpParallelEnabled();
+
+// The pool ParallelCode dispatches nodes to. It is separate from the
+// intra-op pool used by at::parallel_for, so that operators running on
+// inter-op threads can still parallelize internally. Its size defaults to
+// std::thread::hardware_concurrency() and can be overridden with the
+// PYTORCH_JIT_INTER_OP_THREADS environment variable.
+TORCH_API at::ThreadPool& interOpThreadPool();
+
+}}
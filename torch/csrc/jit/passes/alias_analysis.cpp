@@ -0,0 +1,180 @@
+#include "torch/csrc/jit/passes/alias_analysis.h"
+
+#include "torch/csrc/jit/assertions.h"
+#include "torch/csrc/jit/interned_strings.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace torch { namespace jit {
+
+namespace {
+
+bool mayContainTensor(const TypePtr & type) {
+  if (type->isSubtypeOf(DynamicType::get()))
+    return true;
+  if (auto list = type->cast<ListType>())
+    return mayContainTensor(list->getElementType());
+  if (auto tuple = type->cast<TupleType>()) {
+    auto elements = tuple->elements();
+    return std::any_of(elements.begin(), elements.end(), mayContainTensor);
+  }
+  return false;
+}
+
+// Ops whose tensor output is always a newly allocated tensor. Anything that
+// can return its input unchanged (contiguous, type_as, to, ...) must not be
+// in this list.
+std::unordered_set<NodeKind> fresh_ops = {
+  prim::FusionGroup,
+  aten::add,
+  aten::addmm,
+  aten::bmm,
+  aten::cat,
+  aten::clone,
+  aten::div,
+  aten::exp,
+  aten::log,
+  aten::log_softmax,
+  aten::matmul,
+  aten::mm,
+  aten::mul,
+  aten::neg,
+  aten::relu,
+  aten::sigmoid,
+  aten::softmax,
+  aten::sub,
+  aten::tanh,
+};
+
+std::unordered_set<NodeKind> view_ops = {
+  prim::ListConstruct,
+  prim::TupleConstruct,
+  prim::TupleUnpack,
+  aten::as_strided,
+  aten::chunk,
+  aten::contiguous,
+  aten::detach,
+  aten::diagonal,
+  aten::expand,
+  aten::expand_as,
+  aten::narrow,
+  aten::permute,
+  aten::reshape,
+  aten::reshape_as,
+  aten::select,
+  aten::slice,
+  aten::split,
+  aten::squeeze,
+  aten::t,
+  aten::transpose,
+  aten::type_as,
+  aten::unsqueeze,
+  aten::view,
+  aten::view_as,
+};
+
+} // anonymous namespace
+
+AliasDb::AliasDb(std::shared_ptr<Graph> graph)
+  : graph_(std::move(graph)) {
+  for (auto input : graph_->inputs()) {
+    newSet(input);
+    if (mayContainTensor(input->type()))
+      sets_[find(input)].escapes = true;
+  }
+  analyze(graph_->block());
+  for (auto output : graph_->outputs()) {
+    sets_[find(output)].escapes = true;
+  }
+}
+
+bool AliasDb::isViewOp(Node * n) {
+  return view_ops.count(n->kind()) > 0;
+}
+
+size_t AliasDb::newSet(Value * v) {
+  size_t id = sets_.size();
+  sets_.emplace_back();
+  sets_.back().values.push_back(v);
+  parent_.push_back(id);
+  set_of_[v] = id;
+  return id;
+}
+
+size_t AliasDb::find(Value * v) const {
+  size_t id = set_of_.at(v);
+  while (parent_[id] != id)
+    id = parent_[id];
+  return id;
+}
+
+void AliasDb::join(Value * a, Value * b) {
+  if (!mayContainTensor(a->type()) || !mayContainTensor(b->type()))
+    return;
+  size_t ra = find(a), rb = find(b);
+  if (ra == rb)
+    return;
+  // attach the smaller set to the larger one
+  if (sets_[ra].values.size() < sets_[rb].values.size())
+    std::swap(ra, rb);
+  auto & into = sets_[ra];
+  auto & from = sets_[rb];
+  into.values.insert(into.values.end(), from.values.begin(), from.values.end());
+  into.escapes = into.escapes || from.escapes;
+  from.values.clear();
+  parent_[rb] = ra;
+}
+
+void AliasDb::analyze(Block * block) {
+  for (auto n : block->nodes()) {
+    for (auto o : n->outputs()) {
+      newSet(o);
+    }
+    for (auto b : n->blocks()) {
+      for (auto input : b->inputs()) {
+        newSet(input);
+      }
+      analyze(b);
+    }
+
+    bool fresh = fresh_ops.count(n->kind()) && n->blocks().empty() &&
+      n->outputs().size() == 1 && n->output()->type()->isSubtypeOf(DynamicType::get());
+    if (fresh)
+      continue;
+
+    // everything a node with sub-blocks touches may be the same tensor;
+    // values only flow through them for the nodes we care about, so there
+    // is no need to be more precise
+    std::vector<Value*> related(n->inputs().begin(), n->inputs().end());
+    for (auto b : n->blocks()) {
+      related.insert(related.end(), b->inputs().begin(), b->inputs().end());
+      related.insert(related.end(), b->outputs().begin(), b->outputs().end());
+    }
+    for (auto o : n->outputs()) {
+      for (auto v : related) {
+        join(o, v);
+      }
+    }
+    if (!isViewOp(n)) {
+      for (auto o : n->outputs()) {
+        if (mayContainTensor(o->type()))
+          sets_[find(o)].escapes = true;
+      }
+    }
+  }
+}
+
+bool AliasDb::mayAlias(Value * a, Value * b) const {
+  return find(a) == find(b);
+}
+
+const std::vector<Value*>& AliasDb::aliases(Value * v) const {
+  return sets_[find(v)].values;
+}
+
+bool AliasDb::escapes(Value * v) const {
+  return sets_[find(v)].escapes;
+}
+
+}}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace torch { namespace jit {
+
+// Conservative may-alias information for the values of a graph that can hold
+// tensors. Values that may share storage are put in the same alias set:
+//
+// - outputs of ops known to allocate their result (add, mm, FusionGroup, ...)
+//   start a set of their own,
+// - outputs of ops that may return a view of, or the same tensor as, one of
+//   their inputs (view, select, contiguous, ListConstruct, ...) join the sets
+//   of their inputs,
+// - outputs of every other node, including nodes with sub-blocks, join the
+//   sets of their inputs and are assumed to escape, since we can't tell where
+//   their storage comes from.
+//
+// A set escapes if it contains a graph input or output, a constant, or a
+// value whose origin is unknown. The storage of a set that doesn't escape is
+// allocated during a run of the graph and is only visible to it.
+struct TORCH_API AliasDb {
+  explicit AliasDb(std::shared_ptr<Graph> graph);
+
+  bool mayAlias(Value * a, Value * b) const;
+  // all values that may share storage with v, including v itself
+  const std::vector<Value*>& aliases(Value * v) const;
+  bool escapes(Value * v) const;
+
+  // true if n returns a view of (or the same tensor as) one of its inputs
+  // and does nothing else with them
+  static bool isViewOp(Node * n);
+
+private:
+  struct Set {
+    std::vector<Value*> values;
+    bool escapes = false;
+  };
+  void analyze(Block * block);
+  size_t newSet(Value * v);
+  void join(Value * a, Value * b);
+  size_t find(Value * v) const;
+
+  std::shared_ptr<Graph> graph_;
+  std::unordered_map<Value*, size_t> set_of_;
+  std::vector<size_t> parent_;
+  std::vector<Set> sets_;
+};
+
+}}
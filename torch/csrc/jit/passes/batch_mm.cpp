@@ -9,7 +9,9 @@
 
 #include <ATen/ATen.h>
 #include <algorithm>
+#include <map>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace torch { namespace jit {
 
@@ -210,8 +212,217 @@ void BatchMMBlock(Block* block) {
   EliminateDeadCode(block);
 }
 
+// Note [Batching sibling matmuls]
+// Independent matmuls that don't form a tree, like the query/key/value
+// projections of attention or the gates of an RNN cell, are batched as well.
+// Three patterns are recognized, in this order:
+//
+// - matmuls sharing the lhs are turned into one mm with the rhs operands
+//   concatenated along dim 1, followed by a narrow per original output.
+//   addmm nodes sharing mat1 (nn.Linear) are batched the same way, with their
+//   biases concatenated too, as long as they use the same alpha and beta,
+// - matmuls sharing the rhs are turned into one mm with the lhs operands
+//   concatenated along dim 0,
+// - matmuls with identical shapes are turned into one bmm over the stacked
+//   operands, followed by a select per original output.
+//
+// A matmul can only join a group if all its operands are already defined at
+// the first matmul of the group, because that's where the batched op goes.
+
+enum class SiblingKind { SharedLHS, SharedRHS, SameShape };
+
+using NodeIndex = std::unordered_map<Node*, size_t>;
+
+std::shared_ptr<TensorType> matrixType(Value * v) {
+  auto type = v->type()->cast<TensorType>();
+  if (!type || type->sizes().size() != 2)
+    return nullptr;
+  return type;
+}
+
+bool isBatchableSibling(Node * node) {
+  if (node->kind() == aten::mm) {
+    return matrixType(node->input(0)) && matrixType(node->input(1)) &&
+      matrixType(node->output());
+  }
+  if (node->matches("aten::addmm(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta, Scalar alpha) -> Tensor")) {
+    auto output = matrixType(node->output());
+    auto bias = node->input(0)->type()->cast<TensorType>();
+    if (!output || !bias || !matrixType(node->input(1)) || !matrixType(node->input(2)))
+      return false;
+    // the biases are concatenated, so they can't broadcast along the
+    // concatenated dimension
+    auto & bias_sizes = bias->sizes();
+    if (bias_sizes.size() == 1)
+      return bias_sizes[0] == output->sizes()[1];
+    return bias_sizes == output->sizes();
+  }
+  return false;
+}
+
+// Matmuls with equal keys can be batched with the given strategy. An empty
+// key means that the matmul doesn't fit it.
+std::vector<int64_t> siblingKey(SiblingKind kind, Node * mm) {
+  auto lhs = mm->kind() == aten::addmm ? mm->input(1) : mm->input(0);
+  auto rhs = mm->kind() == aten::addmm ? mm->input(2) : mm->input(1);
+  auto lhs_type = matrixType(lhs);
+  auto rhs_type = matrixType(rhs);
+  std::vector<int64_t> key = {
+    static_cast<int64_t>(kind), static_cast<int64_t>(mm->kind()),
+    static_cast<int64_t>(lhs_type->scalarType()), lhs_type->device(),
+    static_cast<int64_t>(rhs_type->scalarType()), rhs_type->device()
+  };
+  switch (kind) {
+    case SiblingKind::SharedLHS:
+      key.push_back(lhs->unique());
+      if (mm->kind() == aten::addmm) {
+        key.push_back(mm->input(0)->type()->expect<TensorType>()->sizes().size());
+        key.push_back(mm->namedInput(attr::beta)->unique());
+        key.push_back(mm->namedInput(attr::alpha)->unique());
+      }
+      return key;
+    case SiblingKind::SharedRHS:
+      if (mm->kind() == aten::addmm)
+        return {};
+      key.push_back(rhs->unique());
+      return key;
+    case SiblingKind::SameShape:
+      if (mm->kind() == aten::addmm)
+        return {};
+      key.insert(key.end(), lhs_type->sizes().begin(), lhs_type->sizes().end());
+      key.insert(key.end(), rhs_type->sizes().begin(), rhs_type->sizes().end());
+      return key;
+  }
+  return {};
+}
+
+bool operandsDefinedBefore(Node * mm, Node * first, const NodeIndex & index) {
+  size_t position = index.at(first);
+  return std::all_of(mm->inputs().begin(), mm->inputs().end(), [&](Value * v) {
+    auto it = index.find(v->node());
+    // values of enclosing blocks are always available
+    return it == index.end() || it->second < position;
+  });
+}
+
+void batchSiblings(SiblingKind kind, const std::vector<Node*> & group) {
+  Node * first = group.front();
+  auto graph = first->owningGraph();
+  WithInsertPoint guard { first };
+  bool is_addmm = first->kind() == aten::addmm;
+  auto operand = [&](Node * mm, size_t i) -> SymbolicVariable {
+    return mm->input(is_addmm ? i + 1 : i);
+  };
+  auto out_type = [](Node * mm) {
+    return mm->output()->type()->expect<TensorType>();
+  };
+
+  if (kind == SiblingKind::SameShape) {
+    auto lhs = SymbolicVariable::stack(fmap(group, [&](Node * mm) { return operand(mm, 0); }), 0);
+    auto rhs = SymbolicVariable::stack(fmap(group, [&](Node * mm) { return operand(mm, 1); }), 0);
+    auto type = out_type(first);
+    int64_t n = group.size(), m = type->sizes()[0], k = operand(first, 0).sizes()[1], p = type->sizes()[1];
+    lhs.value()->setType(type->withSizes({n, m, k}));
+    rhs.value()->setType(type->withSizes({n, k, p}));
+    auto result = SymbolicVariable::create(aten::bmm, {lhs, rhs})[0];
+    result.value()->setType(type->withSizes({n, m, p}));
+    for (size_t i = 0; i < group.size(); ++i) {
+      Node * select = graph->insertNode(graph->create(aten::select,
+          {result, graph->insertConstant(0), graph->insertConstant(static_cast<int64_t>(i))}));
+      select->output()->setType(out_type(group[i]));
+      group[i]->output()->replaceAllUsesWith(select->output());
+    }
+    return;
+  }
+
+  // concatenate the operand that differs and narrow the result along the same
+  // dimension
+  int64_t dim = kind == SiblingKind::SharedLHS ? 1 : 0;
+  size_t varying = kind == SiblingKind::SharedLHS ? 1 : 0;
+  auto parts = fmap(group, [&](Node * mm) { return operand(mm, varying); });
+  auto cat = SymbolicVariable::cat(parts, dim);
+  std::vector<int64_t> cat_sizes = parts[0].sizes();
+  int64_t total = 0;
+  for (auto part : parts) {
+    total += part.sizes()[dim];
+  }
+  cat_sizes[dim] = total;
+  cat.value()->setType(out_type(first)->withSizes(cat_sizes));
+
+  auto result_sizes = out_type(first)->sizes();
+  result_sizes[dim] = total;
+  SymbolicVariable result;
+  if (is_addmm) {
+    // the bias is either a row vector or a full matrix, see isBatchableSibling
+    auto biases = fmap(group, [](Node * mm) -> SymbolicVariable { return mm->input(0); });
+    int64_t bias_dim = biases[0].sizes().size() - 1;
+    auto bias = SymbolicVariable::cat(biases, bias_dim);
+    std::vector<int64_t> bias_sizes = biases[0].sizes();
+    bias_sizes[bias_dim] = total;
+    bias.value()->setType(out_type(first)->withSizes(bias_sizes));
+    result = SymbolicVariable::create(aten::addmm,
+        {bias, operand(first, 0), cat, first->namedInput(attr::beta), first->namedInput(attr::alpha)})[0];
+  } else if (kind == SiblingKind::SharedLHS) {
+    result = operand(first, 0).mm(cat);
+  } else {
+    result = cat.mm(operand(first, 1));
+  }
+  result.value()->setType(out_type(first)->withSizes(result_sizes));
+
+  int64_t offset = 0;
+  for (auto mm : group) {
+    auto type = out_type(mm);
+    int64_t length = type->sizes()[dim];
+    auto slice = result.narrow(dim, offset, length);
+    // narrowing the columns of a wider matrix leaves its row stride
+    slice.value()->setType(type->withSizesStrides(type->sizes(), {result_sizes[1], 1}));
+    mm->output()->replaceAllUsesWith(slice);
+    offset += length;
+  }
+}
+
+void BatchMMSiblings(Block * block) {
+  NodeIndex index;
+  std::vector<Node*> candidates;
+  size_t position = 0;
+  for (auto node : block->nodes()) {
+    index[node] = position++;
+    for (auto sub : node->blocks()) {
+      BatchMMSiblings(sub);
+    }
+    if (isBatchableSibling(node))
+      candidates.push_back(node);
+  }
+
+  std::unordered_set<Node*> batched;
+  for (auto kind : {SiblingKind::SharedLHS, SiblingKind::SharedRHS, SiblingKind::SameShape}) {
+    std::map<std::vector<int64_t>, std::vector<Node*>> groups;
+    for (auto mm : candidates) {
+      if (batched.count(mm))
+        continue;
+      auto key = siblingKey(kind, mm);
+      if (key.empty())
+        continue;
+      auto & group = groups[key];
+      if (!group.empty() && !operandsDefinedBefore(mm, group.front(), index))
+        continue;
+      group.push_back(mm);
+    }
+    for (auto & entry : groups) {
+      auto & group = entry.second;
+      if (group.size() < min_fusion_size)
+        continue;
+      batchSiblings(kind, group);
+      batched.insert(group.begin(), group.end());
+    }
+  }
+  EliminateDeadCode(block);
+}
+
 void BatchMM(std::shared_ptr<Graph>& graph) {
   BatchMMBlock(graph->block());
+  // See Note [Batching sibling matmuls]
+  BatchMMSiblings(graph->block());
 }
 
 }}
@@ -1,8 +1,10 @@
 #include "torch/csrc/jit/passes/graph_fuser.h"
 #include "torch/csrc/jit/passes/common_subexpression_elimination.h"
+#include "torch/csrc/jit/passes/dead_code_elimination.h"
 #include "torch/csrc/jit/fusion_compiler.h"
 #include "torch/csrc/jit/autodiff.h"
 #include "torch/csrc/jit/assertions.h"
+#include "torch/csrc/jit/symbolic_variable.h"
 #include "ATen/ExpandUtils.h"
 #include <unordered_map>
 
@@ -283,6 +285,44 @@ struct GraphFuser {
     });
   }
 
+  // Reductions along a single constant dimension can end a fusion group: the
+  // pointwise ops producing their input are evaluated inside the reduction
+  // loop, so the intermediate values never round-trip through memory.
+  bool isFusableReduceNode(Node * node) {
+    if (node->owningBlock() != block) return false;
+    if (node->matches("aten::sum(Tensor self, int[] dim, int keepdim) -> Tensor",
+          /*const=*/{attr::dim, attr::keepdim})) {
+      if (node->get<std::vector<int64_t>>(attr::dim).value().size() != 1) return false;
+    } else if (!node->matches("aten::mean(Tensor self, int dim, int keepdim) -> Tensor",
+          /*const=*/{attr::dim, attr::keepdim})) {
+      return false;
+    }
+    // the fusion compiler does not handle 0-dim outputs
+    auto output_type = node->output()->type()->cast<TensorType>();
+    if (!output_type || output_type->sizes().empty()) return false;
+    return hasSupportedType(node->namedInput(attr::self)) &&
+           haveSupportedType(node->outputs());
+  }
+
+  // Fusion groups ending in a reduction have a single output, computed over
+  // a map that is larger than that output.
+  bool isReductionGroup(Node * node) {
+    if (node->kind() != prim::FusionGroup) return false;
+    auto outputs = getSubgraph(node).outputs();
+    return outputs.size() == 1 && outputs[0]->node()->kind() == prim::FusedReduce;
+  }
+
+  // Random number generation is keyed on the linear index of an element,
+  // which reduction kernels do not iterate over.
+  bool hasRandom(Node * node) {
+    if (node->kind() == aten::rand_like) return true;
+    if (node->kind() != prim::FusionGroup) return false;
+    auto nodes = getSubgraph(node).nodes();
+    return std::any_of(nodes.begin(), nodes.end(), [](Node * n) {
+      return n->kind() == aten::rand_like;
+    });
+  }
+
   // Can this node produce an _output_ of a fusion group?
   // all Fusable nodes can do this, but additionally Concat, which normally cannot be fused
   // because it is not a simple map, can be put in a fusion group
@@ -292,7 +332,8 @@ struct GraphFuser {
   }
 
   bool isFusableOnlyAsExitNode(Node * node) {
-    return isFusableCatNode(node) || node->kind() == prim::FusedConcat;
+    return isFusableCatNode(node) || node->kind() == prim::FusedConcat ||
+           isFusableReduceNode(node) || node->kind() == prim::FusedReduce;
   }
 
   // necessary condition for fusion. If all of the uses of producer are consumer
@@ -381,6 +422,11 @@ struct GraphFuser {
       JIT_ASSERT(type);
       return at::optional<at::IntList>(at::in_place, type->sizes());
     }
+    if (isFusableReduceNode(node)) {
+      // the map is the tensor being reduced, not the reduced output
+      auto type = node->namedInput(attr::self)->type()->cast<TensorType>();
+      return at::optional<at::IntList>(at::in_place, type->sizes());
+    }
     if (node->kind() == aten::cat) {
       // Assuming all inputs to aten::cat are same size. This is
       // a condition for aten::cat to be fusible.
@@ -420,6 +466,12 @@ struct GraphFuser {
     // we can move the consumer up into the producer.
     // but this requires better handling of merging fusion groups so it is not done now
     Node *real_consumer = consumer->kind() == aten::cat ? consumer->namedInput(attr::tensors)->node() : consumer;
+    if (isFusableReduceNode(consumer) || isReductionGroup(consumer)) {
+      // a reduction group cannot expose values of the larger map as extra
+      // outputs, so the producer must be used by the reduction alone
+      if (!allUsersAreThisConsumer(consumer, producer) || hasRandom(producer->node()))
+        return false;
+    }
     return isFusable(producer->node()) &&
       haveSameMapSize(consumer, producer->node()) &&
       allUsersAreThisConsumerOrOccurAfterIt(real_consumer, producer) &&
@@ -628,6 +680,30 @@ struct GraphFuser {
       if (list_construct->output()->uses().empty()) {
         list_construct->destroy();
       }
+    } else if (isFusableReduceNode(consumer)) {
+      Graph * graph = consumer->owningGraph();
+      Value * self = consumer->namedInput(attr::self);
+      int64_t ndim = self->type()->expect<TensorType>()->sizes().size();
+      int64_t dim = consumer->kind() == aten::sum ?
+        consumer->get<std::vector<int64_t>>(attr::dim).value().at(0) :
+        consumer->get<int64_t>(attr::dim).value();
+      if (dim < 0) {
+        dim += ndim;
+      }
+      JIT_ASSERT(dim >= 0 && dim < ndim);
+
+      Node * fused_reduce = graph->create(prim::FusedReduce, {self})
+        ->i_(attr::dim, dim)
+        ->i_(attr::keepdim, consumer->get<int64_t>(attr::keepdim).value())
+        ->s_(attr::name, consumer->kind() == aten::sum ? "sum" : "mean");
+      fused_reduce->insertBefore(consumer);
+      fused_reduce->output()->copyMetadata(consumer->output());
+      consumer->output()->replaceAllUsesWith(fused_reduce->output());
+      topological_index[fused_reduce] = topological_index[consumer];
+
+      // NB: this deletes the fused_reduce node from the original graph
+      group = createSingletonFusionGroup(fused_reduce);
+      consumer->destroy();
     } else if (consumer->kind() != prim::FusionGroup) {
       group = createSingletonFusionGroup(consumer);
     }
@@ -998,9 +1074,55 @@ struct GraphFuser {
   }
 };
 
+// Replaces relu(addmm(bias, x, w.t())), i.e. a linear layer followed by a
+// relu, with linear_relu(x, w, bias), which applies the bias and the relu in
+// a single pass over the GEMM output. This runs before the fusion groups are
+// formed, which would otherwise take the relu away from the addmm.
+void FuseLinearRelu(Block* block) {
+  for (auto it = block->nodes().begin(); it != block->nodes().end(); ++it) {
+    Node* node = *it;
+    for (Block* sub_block : node->blocks()) {
+      FuseLinearRelu(sub_block);
+    }
+    if (!node->matches("aten::relu(Tensor self) -> Tensor")) {
+      continue;
+    }
+    Node* addmm = node->input()->node();
+    if (addmm->owningBlock() != block ||
+        addmm->output()->uses().size() != 1 ||
+        !addmm->matches("aten::addmm(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta, Scalar alpha) -> Tensor",
+                        /*const_inputs=*/{attr::beta, attr::alpha})) {
+      continue;
+    }
+    if (addmm->get<at::Scalar>(attr::beta)->toDouble() != 1. ||
+        addmm->get<at::Scalar>(attr::alpha)->toDouble() != 1.) {
+      continue;
+    }
+    // the bias must be a vector added to every row, not a full matrix
+    auto bias_type = addmm->namedInput(attr::self)->type()->cast<TensorType>();
+    if (!bias_type || bias_type->sizes().size() != 1) {
+      continue;
+    }
+
+    WithInsertPoint guard(node);
+    SymbolicVariable mat2(addmm->namedInput(attr::mat2));
+    Node* mat2_node = mat2.value()->node();
+    SymbolicVariable weight = mat2_node->matches("aten::t(Tensor self) -> Tensor")
+        ? SymbolicVariable(mat2_node->input())
+        : mat2.t();
+    SymbolicVariable linear_relu = SymbolicVariable::create(
+        aten::linear_relu,
+        {addmm->namedInput(attr::mat1), weight, addmm->namedInput(attr::self)})[0];
+    ((Value*)linear_relu)->copyMetadata(node->output());
+    node->output()->replaceAllUsesWith(linear_relu);
+  }
+}
+
 } // anonymous namespace
 
 void FuseGraph(std::shared_ptr<Graph>& graph) {
+  FuseLinearRelu(graph->block());
+  EliminateDeadCode(graph);
   GraphFuser(graph->block()).run();
   // After FuseGraph some common subexpressions may come back
   EliminateCommonSubexpression(graph);
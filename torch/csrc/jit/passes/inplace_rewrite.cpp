@@ -0,0 +1,115 @@
+#include "torch/csrc/jit/passes/inplace_rewrite.h"
+
+#include "torch/csrc/jit/assertions.h"
+#include "torch/csrc/jit/interned_strings.h"
+#include "torch/csrc/jit/passes/alias_analysis.h"
+
+#include <string>
+#include <vector>
+
+namespace torch { namespace jit {
+
+namespace {
+
+// Each of these has an in-place variant with the same arguments, named with a
+// trailing underscore. The variants are registered as JIT operators by
+// tools/jit/gen_jit_dispatch.py (see jit_inplace_ops there).
+const std::vector<const char*> rewritable_ops = {
+  "aten::relu(Tensor self) -> Tensor",
+  "aten::sigmoid(Tensor self) -> Tensor",
+  "aten::tanh(Tensor self) -> Tensor",
+  "aten::neg(Tensor self) -> Tensor",
+  "aten::exp(Tensor self) -> Tensor",
+  "aten::add(Tensor self, Tensor other, *, Scalar alpha) -> Tensor",
+  "aten::add(Tensor self, Scalar other, Scalar alpha) -> Tensor",
+  "aten::sub(Tensor self, Tensor other, *, Scalar alpha) -> Tensor",
+  "aten::sub(Tensor self, Scalar other, Scalar alpha) -> Tensor",
+  "aten::mul(Tensor self, Tensor other) -> Tensor",
+  "aten::mul(Tensor self, Scalar other) -> Tensor",
+  "aten::div(Tensor self, Tensor other) -> Tensor",
+  "aten::div(Tensor self, Scalar other) -> Tensor",
+};
+
+bool isRewritable(Node * n) {
+  for (auto schema : rewritable_ops) {
+    if (n->matches(schema))
+      return true;
+  }
+  return false;
+}
+
+// Broadcasting can make the output larger than self, and type promotion is
+// not something the in-place variants do.
+bool sameShapeAndType(Value * self, Value * output) {
+  auto self_type = self->type()->cast<TensorType>();
+  auto output_type = output->type()->cast<TensorType>();
+  if (!self_type || !output_type)
+    return false;
+  if (self_type->sizes() != output_type->sizes() ||
+      self_type->scalarType() != output_type->scalarType() ||
+      self_type->device() != output_type->device())
+    return false;
+  // writing into an expanded tensor would write the same element many times
+  for (auto stride : self_type->strides()) {
+    if (stride == 0)
+      return false;
+  }
+  return true;
+}
+
+// Is n the only node that reads the storage of self?
+bool isOnlyReader(const AliasDb & db, Node * n, Value * self) {
+  if (db.escapes(self))
+    return false;
+  for (auto v : db.aliases(self)) {
+    for (auto & use : v->uses()) {
+      // uses inside nested blocks may run any number of times
+      if (use.user->owningBlock() != n->owningBlock())
+        return false;
+      if (use.user == n)
+        continue;
+      // views only read sizes and strides; their own uses are checked since
+      // their outputs are in the same set
+      if (!AliasDb::isViewOp(use.user))
+        return false;
+    }
+  }
+  // overlapping in-place updates are undefined unless the operands are the
+  // same tensor
+  for (size_t i = 1; i < n->inputs().size(); ++i) {
+    Value * other = n->inputs()[i];
+    if (other != self && db.mayAlias(self, other))
+      return false;
+  }
+  return true;
+}
+
+} // anonymous namespace
+
+void RewriteInplaceOps(std::shared_ptr<Graph>& graph) {
+  // All decisions are made on the original graph. Rewriting a node makes its
+  // output alias self, but since nothing else reads self, that can't turn
+  // another accepted node into an unsafe one.
+  AliasDb db(graph);
+  std::vector<Node*> to_rewrite;
+  for (auto n : graph->nodes()) {
+    if (!isRewritable(n))
+      continue;
+    Value * self = n->inputs()[0];
+    if (sameShapeAndType(self, n->output()) && isOnlyReader(db, n, self))
+      to_rewrite.push_back(n);
+  }
+
+  for (auto n : to_rewrite) {
+    Symbol inplace = Symbol::aten(std::string(n->kind().toUnqualString()) + "_");
+    Node * replacement = graph->create(inplace, n->inputs(), /*num_outputs=*/1);
+    replacement->insertBefore(n);
+    replacement->setSourceLocation(n->getSourceLocation());
+    replacement->setScope(n->scope());
+    replacement->output()->copyMetadata(n->output());
+    n->output()->replaceAllUsesWith(replacement->output());
+    n->destroy();
+  }
+}
+
+}}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+namespace torch { namespace jit {
+
+// Replaces elementwise ops like relu, sigmoid or add with their in-place
+// variants when the tensor they would overwrite is dead afterwards, so that
+// e.g. the relu in `relu(mm(x, w))` reuses the buffer of the mm instead of
+// allocating a new one.
+//
+// An op is only rewritten if its self argument is a tensor allocated inside
+// the graph (see AliasDb) that nothing but this op reads, either directly or
+// through a view. This makes the result independent of the order in which
+// other nodes run, so rewritten graphs can still be run by the inter-op
+// parallel executor.
+//
+// Requires complete shape information: the output has to have the sizes and
+// type of self. The resulting graph can't be differentiated, so it has to run
+// after all passes that expect functional graphs.
+TORCH_API void RewriteInplaceOps(std::shared_ptr<Graph>& graph);
+
+}}
@@ -0,0 +1,165 @@
+#include "torch/csrc/jit/passes/loop_fusion.h"
+
+#include "torch/csrc/jit/assertions.h"
+#include "torch/csrc/jit/constants.h"
+#include "torch/csrc/jit/interned_strings.h"
+#include "torch/csrc/jit/passes/dead_code_elimination.h"
+
+#include <unordered_set>
+
+namespace torch { namespace jit {
+
+namespace {
+
+std::unordered_set<Symbol> random_ops = {
+  aten::alpha_dropout,
+  aten::bernoulli,
+  aten::dropout,
+  aten::feature_alpha_dropout,
+  aten::feature_dropout,
+  aten::multinomial,
+  aten::normal,
+  aten::poisson,
+  aten::rand,
+  aten::rand_like,
+  aten::randint,
+  aten::randint_like,
+  aten::randn,
+  aten::randn_like,
+  aten::randperm,
+  aten::rrelu,
+};
+
+bool isTrueConstant(Value *val) {
+  at::optional<bool> maybe_value = constant_as<bool>(val);
+  return maybe_value && *maybe_value;
+}
+
+bool isForLoop(Node* node) {
+  if (node->kind() != prim::Loop)
+    return false;
+  Value *start_cond = node->inputs().at(1);
+  Value *continue_cond = node->blocks().at(0)->outputs().at(0);
+  return isTrueConstant(start_cond) && isTrueConstant(continue_cond);
+}
+
+bool isPure(Node * n) {
+  if (n->kind() == prim::Print || n->kind() == prim::PythonOp ||
+      random_ops.count(n->kind()) > 0)
+    return false;
+  for (Block * b : n->blocks()) {
+    for (Node * nested : b->nodes()) {
+      if (!isPure(nested))
+        return false;
+    }
+  }
+  return true;
+}
+
+bool sameTripCount(Node * a, Node * b) {
+  Value * a_count = a->inputs().at(0);
+  Value * b_count = b->inputs().at(0);
+  if (a_count == b_count)
+    return true;
+  auto a_const = constant_as<int64_t>(a_count);
+  auto b_const = constant_as<int64_t>(b_count);
+  return a_const && b_const && *a_const == *b_const;
+}
+
+// Does n, or anything nested in it, use one of values?
+bool usesAny(Node * n, const std::unordered_set<Value*> & values) {
+  for (Value * input : n->inputs()) {
+    if (values.count(input))
+      return true;
+  }
+  for (Block * b : n->blocks()) {
+    if (usesAny(b->return_node(), values))
+      return true;
+    for (Node * nested : b->nodes()) {
+      if (usesAny(nested, values))
+        return true;
+    }
+  }
+  return false;
+}
+
+// Appends the body of second to the body of first and removes second.
+void fuseInto(Node * first, Node * second) {
+  Block * body = first->blocks().at(0);
+  Block * second_body = second->blocks().at(0);
+
+  second_body->inputs().at(0)->replaceAllUsesWith(body->inputs().at(0));
+  size_t num_carried = second->outputs().size();
+  for (size_t i = 0; i < num_carried; ++i) {
+    Value * carried_in = second_body->inputs().at(i + 1);
+    first->addInput(second->inputs().at(i + 2));
+    carried_in->replaceAllUsesWith(body->addInput()->copyMetadata(carried_in));
+  }
+  for (auto it = second_body->nodes().begin(); it != second_body->nodes().end();) {
+    Node * n = *it;
+    ++it; // n is moved
+    n->moveBefore(body->return_node());
+  }
+  for (size_t i = 0; i < num_carried; ++i) {
+    body->registerOutput(second_body->outputs().at(i + 1));
+    second->outputs().at(i)->replaceAllUsesWith(
+        first->addOutput()->copyMetadata(second->outputs().at(i)));
+  }
+  second->destroy();
+}
+
+// Returns the first for-loop after first that can be merged into it, and
+// fills dependent with the values between the two that depend on first.
+Node * findFusionCandidate(Node * first, std::unordered_set<Value*> & dependent) {
+  dependent.insert(first->outputs().begin(), first->outputs().end());
+  auto end = first->owningBlock()->nodes().end();
+  auto it = first->iterator();
+  for (++it; it != end; ++it) {
+    Node * n = *it;
+    if (!isPure(n))
+      return nullptr;
+    if (usesAny(n, dependent)) {
+      dependent.insert(n->outputs().begin(), n->outputs().end());
+    } else if (isForLoop(n) && sameTripCount(first, n)) {
+      return n;
+    }
+  }
+  return nullptr;
+}
+
+void FuseLoops(Block * block) {
+  for (auto it = block->nodes().begin(); it != block->nodes().end(); ++it) {
+    for (Block * sub : it->blocks()) {
+      FuseLoops(sub);
+    }
+    Node * first = *it;
+    if (!isForLoop(first) || !isPure(first))
+      continue;
+    std::unordered_set<Value*> dependent;
+    while (Node * second = findFusionCandidate(first, dependent)) {
+      for (Block * sub : second->blocks()) {
+        FuseLoops(sub);
+      }
+      // second will run where first is, so whatever it depends on has to
+      // move in front of first; none of it depends on first
+      auto pos = first->iterator();
+      for (++pos; *pos != second;) {
+        Node * n = *pos++;
+        if (!usesAny(n, dependent))
+          n->moveBefore(first);
+      }
+      fuseInto(first, second);
+      dependent.clear();
+    }
+  }
+}
+
+} // anonymous namespace
+
+void FuseLoops(std::shared_ptr<Graph>& graph) {
+  FuseLoops(graph->block());
+  // the continue conditions of the merged loops are dead now
+  EliminateDeadCode(graph);
+}
+
+}}
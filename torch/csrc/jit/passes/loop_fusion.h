@@ -0,0 +1,19 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+namespace torch { namespace jit {
+
+// Merges for-loops of the same block that run the same number of iterations
+// and don't depend on each other into a single loop, e.g. the separate loops
+// over timesteps that compute the two directions of a bidirectional decoder.
+// This saves the loop overhead and gives the fuser and CSE a larger body to
+// work with.
+//
+// Only loops whose bodies have no side effects or randomness are merged,
+// since merging interleaves their iterations. Pure nodes between the two
+// loops that the second one doesn't depend on through the first one are
+// moved in front of the first loop.
+TORCH_API void FuseLoops(std::shared_ptr<Graph>& graph);
+
+}}
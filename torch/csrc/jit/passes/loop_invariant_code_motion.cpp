@@ -0,0 +1,110 @@
+#include "torch/csrc/jit/passes/loop_invariant_code_motion.h"
+
+#include "torch/csrc/jit/assertions.h"
+#include "torch/csrc/jit/interned_strings.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace torch { namespace jit {
+
+namespace {
+
+// Running these once instead of once per iteration changes the result.
+std::unordered_set<Symbol> random_ops = {
+  aten::alpha_dropout,
+  aten::bernoulli,
+  aten::dropout,
+  aten::feature_alpha_dropout,
+  aten::feature_dropout,
+  aten::multinomial,
+  aten::normal,
+  aten::poisson,
+  aten::rand,
+  aten::rand_like,
+  aten::randint,
+  aten::randint_like,
+  aten::randn,
+  aten::randn_like,
+  aten::randperm,
+  aten::rrelu,
+};
+
+bool isHoistable(Node * n) {
+  return n->blocks().empty() &&
+    n->kind() != prim::Print &&
+    n->kind() != prim::PythonOp &&
+    random_ops.count(n->kind()) == 0;
+}
+
+// Is v defined in b or in one of the blocks nested in it?
+bool isDefinedIn(Value * v, Block * b) {
+  Block * current = v->node()->owningBlock();
+  while (current) {
+    if (current == b)
+      return true;
+    Node * owner = current->owningNode();
+    current = owner ? owner->owningBlock() : nullptr;
+  }
+  return false;
+}
+
+// Loop nodes have (max_trip_count, start_condition, carried...) as inputs and
+// carried values as outputs; their body has (counter, carried...) as inputs
+// and (continue_condition, carried...) as outputs.
+void removeInvariantCarriedValues(Node * loop) {
+  Block * body = loop->blocks().at(0);
+  for (int64_t i = static_cast<int64_t>(loop->outputs().size()) - 1; i >= 0; --i) {
+    Value * initial = loop->inputs().at(i + 2);
+    Value * carried_in = body->inputs().at(i + 1);
+    Value * carried_out = body->outputs().at(i + 1);
+    if (carried_out != carried_in && carried_out != initial)
+      continue;
+    carried_in->replaceAllUsesWith(initial);
+    loop->outputs().at(i)->replaceAllUsesWith(initial);
+    body->eraseOutput(i + 1);
+    body->eraseInput(i + 1);
+    loop->eraseOutput(i);
+    loop->removeInput(i + 2);
+  }
+}
+
+void hoistFrom(Node * loop) {
+  Block * body = loop->blocks().at(0);
+  // Nodes are visited in order, so a node whose inputs were all hoisted
+  // earlier in this loop is hoisted as well.
+  for (auto it = body->nodes().begin(); it != body->nodes().end();) {
+    Node * n = *it;
+    ++it; // n might be moved
+    if (!isHoistable(n))
+      continue;
+    bool invariant = std::none_of(n->inputs().begin(), n->inputs().end(),
+                                  [&](Value * v) { return isDefinedIn(v, body); });
+    if (invariant)
+      n->moveBefore(loop);
+  }
+}
+
+void HoistLoopInvariants(Block * block) {
+  for (auto it = block->nodes().begin(); it != block->nodes().end(); ++it) {
+    Node * n = *it;
+    // Inner loops go first, so that what they hoist can keep moving out of
+    // the outer loops. Hoisted nodes land in front of n, so the iterator
+    // stays valid.
+    for (Block * sub : n->blocks()) {
+      HoistLoopInvariants(sub);
+    }
+    if (n->kind() == prim::Loop) {
+      removeInvariantCarriedValues(n);
+      hoistFrom(n);
+    }
+  }
+}
+
+} // anonymous namespace
+
+void HoistLoopInvariants(std::shared_ptr<Graph>& graph) {
+  HoistLoopInvariants(graph->block());
+}
+
+}}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+namespace torch { namespace jit {
+
+// Moves nodes of prim::Loop bodies whose inputs are all defined outside of
+// the loop in front of it, so that e.g. a weight transpose in a decoder loop
+// runs once instead of on every step. Loop-carried values that the body
+// passes through unchanged are replaced with their initial value first, so
+// nodes that only depend on them are hoisted as well.
+//
+// Only nodes without side effects or randomness and without sub-blocks are
+// moved. Hoisting is speculative: nodes hoisted out of a loop that runs zero
+// times are still executed.
+TORCH_API void HoistLoopInvariants(std::shared_ptr<Graph>& graph);
+
+}}
@@ -0,0 +1,207 @@
+#include "torch/csrc/jit/passes/memory_planning.h"
+
+#include "torch/csrc/jit/assertions.h"
+#include "torch/csrc/jit/interned_strings.h"
+
+#include <ATen/ATen.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace torch { namespace jit {
+
+namespace {
+
+std::atomic<bool>& memoryPlanningFlag() {
+  static std::atomic<bool> enabled([] {
+    const char* env = std::getenv("PYTORCH_JIT_MEMORY_PLANNING");
+    return env && std::string(env) == "1";
+  }());
+  return enabled;
+}
+
+// Regions start at multiples of 64 bytes, so that kernels see the same
+// alignment they would get from the allocator.
+constexpr size_t kAlignmentBytes = 64;
+
+// Consumers that read their tensor inputs without returning or retaining an
+// alias of them. A planned tensor is reused after its last use, so every use
+// has to be of this kind; anything that might return a view (view, select,
+// chunk, ...) or an input itself (in-place ops) would extend its lifetime
+// past what the graph shows.
+std::unordered_set<NodeKind> non_aliasing_consumers = {
+  prim::FusionGroup,
+  aten::add,
+  aten::addmm,
+  aten::cat,
+  aten::div,
+  aten::mean,
+  aten::mm,
+  aten::mul,
+  aten::relu,
+  aten::sigmoid,
+  aten::sub,
+  aten::sum,
+  aten::tanh,
+};
+
+struct Request {
+  Value * value;
+  size_t size; // in elements, rounded up to the alignment
+  size_t first; // index of the defining node
+  size_t last; // index of the last use
+  size_t offset;
+};
+
+bool overlaps(const Request & a, const Request & b) {
+  bool live = a.first <= b.last && b.first <= a.last;
+  bool placed = a.offset < b.offset + b.size && b.offset < a.offset + a.size;
+  return live && placed;
+}
+
+// Greedy best-fit-by-size, as used by most static planners: the largest
+// tensors are placed first, each at the lowest offset where it does not
+// collide with an already placed tensor whose lifetime overlaps its own.
+// Returns the size of the arena.
+size_t assignOffsets(std::vector<Request> & requests) {
+  std::vector<Request*> order;
+  for (auto & r : requests) {
+    order.push_back(&r);
+  }
+  std::stable_sort(order.begin(), order.end(), [](Request * a, Request * b) {
+    return a->size > b->size;
+  });
+  std::vector<Request*> placed;
+  size_t total = 0;
+  for (auto r : order) {
+    // candidate offsets are 0 and the end of every placed region; the
+    // lowest one that does not collide is the first fit
+    std::vector<size_t> candidates = {0};
+    for (auto p : placed) {
+      candidates.push_back(p->offset + p->size);
+    }
+    std::sort(candidates.begin(), candidates.end());
+    for (size_t offset : candidates) {
+      r->offset = offset;
+      bool collides = std::any_of(placed.begin(), placed.end(), [&](Request * p) {
+        return overlaps(*r, *p);
+      });
+      if (!collides)
+        break;
+    }
+    placed.push_back(r);
+    total = std::max(total, r->offset + r->size);
+  }
+  return total;
+}
+
+// Returns the number of elements to reserve for v, or 0 if v cannot be
+// placed in an arena.
+size_t plannedSize(Value * v, const std::unordered_map<Node*, size_t> & index, size_t & last) {
+  auto type = v->type()->cast<TensorType>();
+  if (!type)
+    return 0;
+  // fusion kernels write their outputs contiguously
+  if (type->strides() != type->contiguous()->strides())
+    return 0;
+  last = index.at(v->node());
+  for (auto & use : v->uses()) {
+    auto it = index.find(use.user);
+    // graph outputs and uses inside nested blocks escape the plan
+    if (it == index.end())
+      return 0;
+    if (non_aliasing_consumers.count(use.user->kind()) == 0)
+      return 0;
+    last = std::max(last, it->second);
+  }
+  if (v->uses().empty())
+    return 0;
+  size_t numel = 1;
+  for (auto s : type->sizes()) {
+    numel *= s;
+  }
+  if (numel == 0)
+    return 0;
+  size_t alignment = kAlignmentBytes / at::elementSize(type->scalarType());
+  return (numel + alignment - 1) / alignment * alignment;
+}
+
+} // anonymous namespace
+
+void PlanMemory(std::shared_ptr<Graph>& graph) {
+  std::unordered_map<Node*, size_t> index;
+  size_t i = 0;
+  for (auto n : graph->nodes()) {
+    index[n] = i++;
+  }
+
+  // one arena per (device, scalar type), since an arena is a typed tensor
+  using ArenaKey = std::tuple<int, at::ScalarType>;
+  std::map<ArenaKey, std::vector<Request>> requests;
+  std::unordered_map<Node*, ArenaKey> group_arena;
+  for (auto n : graph->nodes()) {
+    if (n->kind() != prim::FusionGroup)
+      continue;
+    for (auto o : n->outputs()) {
+      size_t last;
+      size_t size = plannedSize(o, index, last);
+      if (size == 0)
+        continue;
+      auto type = o->type()->expect<TensorType>();
+      ArenaKey key(type->device(), type->scalarType());
+      // a group gets at most one arena input
+      auto it = group_arena.emplace(n, key).first;
+      if (it->second != key)
+        continue;
+      requests[key].push_back(Request{o, size, index.at(n), last, 0});
+    }
+  }
+  if (requests.empty())
+    return;
+
+  std::unordered_map<Value*, int64_t> offsets;
+  std::map<ArenaKey, Value*> arenas;
+  WithInsertPoint guard(*graph->nodes().begin());
+  for (auto & entry : requests) {
+    size_t total = assignOffsets(entry.second);
+    for (auto & r : entry.second) {
+      offsets[r.value] = r.offset;
+    }
+    int device = std::get<0>(entry.first);
+    at::ScalarType scalar_type = std::get<1>(entry.first);
+    Node * arena = graph->create(prim::AllocateArena)
+      ->i_(attr::size, total)
+      ->i_(attr::device, device)
+      ->i_(attr::dtype, static_cast<int64_t>(scalar_type));
+    arena->output()->setType(TensorType::create(scalar_type, device, {static_cast<int64_t>(total)}));
+    graph->insertNode(arena);
+    arenas[entry.first] = arena->output();
+  }
+
+  for (auto & entry : group_arena) {
+    Node * group = entry.first;
+    std::vector<int64_t> group_offsets;
+    for (auto o : group->outputs()) {
+      auto it = offsets.find(o);
+      group_offsets.push_back(it == offsets.end() ? -1 : it->second);
+    }
+    group->addInput(arenas.at(entry.second));
+    group->is_(attr::arena_offsets, group_offsets);
+  }
+}
+
+void setMemoryPlanningEnabled(bool enabled) {
+  memoryPlanningFlag() = enabled;
+}
+
+bool memoryPlanningEnabled() {
+  return memoryPlanningFlag();
+}
+
+}}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+namespace torch { namespace jit {
+
+// Assigns intermediate tensors whose whole lifetime is contained in a single
+// run of the graph to regions of a per-run arena, reusing the region of a
+// tensor once its last use has executed.
+//
+// Only outputs of prim::FusionGroup are planned, since the fusion compiler
+// is the one place where the JIT controls how a tensor is allocated; every
+// other operator allocates its own outputs. Planned groups take the arena,
+// produced by a prim::AllocateArena node at the start of the graph, as an
+// extra last input and record the offset of each output in
+// attr::arena_offsets (-1 for outputs that are allocated as usual).
+//
+// Requires complete shape information, so it has to run after
+// PropagateInputShapes, and assumes that nodes run in graph order.
+TORCH_API void PlanMemory(std::shared_ptr<Graph>& graph);
+
+// Whether GraphExecutor runs PlanMemory on its execution plans. Defaults to
+// false unless the PYTORCH_JIT_MEMORY_PLANNING environment variable is set to
+// 1. Graphs run by the inter-op parallel executor are never planned.
+TORCH_API void setMemoryPlanningEnabled(bool enabled);
+TORCH_API bool memoryPlanningEnabled();
+
+}}
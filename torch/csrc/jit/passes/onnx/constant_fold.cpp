@@ -0,0 +1,242 @@
+#include "torch/csrc/jit/passes/onnx/constant_fold.h"
+#include "torch/csrc/jit/passes/dead_code_elimination.h"
+#include "torch/csrc/jit/assertions.h"
+#include "torch/csrc/autograd/variable.h"
+
+#include <ATen/ATen.h>
+#include <ATen/core/optional.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace torch { namespace jit {
+
+namespace {
+
+using ValueToTensor = std::unordered_map<Value*, at::Tensor>;
+
+// The folding is done on plain tensors, there is nothing to differentiate
+at::Tensor unwrap(const at::Tensor& t) {
+  return t.is_variable() ? autograd::Variable(t).data() : t;
+}
+
+bool isGraphOutput(Graph& graph, Value* v) {
+  auto outputs = graph.outputs();
+  return std::find(outputs.begin(), outputs.end(), v) != outputs.end();
+}
+
+Value* addInitializer(
+    Graph& graph,
+    std::vector<at::Tensor>& params,
+    ValueToTensor& constants,
+    at::Tensor t) {
+  Value* v = graph.addInput();
+  v->inferTypeFrom(t);
+  constants[v] = t;
+  params.push_back(autograd::make_variable(std::move(t)));
+  return v;
+}
+
+// Evaluates an ONNX node, returns nullopt if the node is not supported
+at::optional<at::Tensor> runONNXNode(
+    Node* n,
+    const std::vector<at::Tensor>& inputs) {
+  switch (n->kind()) {
+    case onnx::Transpose: {
+      std::vector<int64_t> perm;
+      if (n->hasAttribute(attr::perm)) {
+        perm = n->is(attr::perm);
+      } else {
+        for (int64_t i = inputs[0].dim() - 1; i >= 0; --i) {
+          perm.push_back(i);
+        }
+      }
+      return inputs[0].permute(perm).contiguous();
+    }
+    case onnx::Unsqueeze: {
+      auto axes = n->is(attr::axes);
+      std::sort(axes.begin(), axes.end());
+      auto t = inputs[0];
+      for (auto axis : axes) {
+        t = t.unsqueeze(axis);
+      }
+      return t;
+    }
+    case onnx::Squeeze: {
+      if (!n->hasAttribute(attr::axes)) {
+        return inputs[0].squeeze();
+      }
+      auto axes = n->is(attr::axes);
+      std::sort(axes.rbegin(), axes.rend());
+      auto t = inputs[0];
+      for (auto axis : axes) {
+        t = t.squeeze(axis);
+      }
+      return t;
+    }
+    case onnx::Reshape: {
+      if (inputs.size() != 2) {
+        return at::nullopt;
+      }
+      auto shape_t = inputs[1].toType(at::CPU(at::kLong)).contiguous();
+      std::vector<int64_t> shape(
+          shape_t.data<int64_t>(), shape_t.data<int64_t>() + shape_t.numel());
+      // 0 copies the size of the input
+      for (size_t i = 0; i < shape.size(); ++i) {
+        if (shape[i] == 0) {
+          JIT_ASSERT(int64_t(i) < inputs[0].dim());
+          shape[i] = inputs[0].size(i);
+        }
+      }
+      return inputs[0].reshape(shape);
+    }
+    case onnx::Concat:
+      return at::cat(inputs, n->i(attr::axis));
+    case onnx::Add:
+    case onnx::Sub:
+    case onnx::Mul:
+    case onnx::Div: {
+      // legacy broadcasting along a given axis
+      if (n->hasAttribute(attr::axis)) {
+        return at::nullopt;
+      }
+      if (n->kind() == onnx::Add) return inputs[0] + inputs[1];
+      if (n->kind() == onnx::Sub) return inputs[0] - inputs[1];
+      if (n->kind() == onnx::Mul) return inputs[0] * inputs[1];
+      return inputs[0] / inputs[1];
+    }
+    case onnx::Neg:
+      return -inputs[0];
+    case onnx::Sqrt:
+      return inputs[0].sqrt();
+    default:
+      return at::nullopt;
+  }
+}
+
+void foldConstantNodes(
+    Graph& graph,
+    std::vector<at::Tensor>& params,
+    ValueToTensor& constants) {
+  for (auto it = graph.nodes().begin(); it != graph.nodes().end();) {
+    Node* n = *it;
+    ++it;
+    if (n->kind() == onnx::Constant) {
+      constants[n->output()] = unwrap(n->t(attr::value));
+      continue;
+    }
+    if (n->outputs().size() != 1 || !n->blocks().empty() ||
+        isGraphOutput(graph, n->output())) {
+      continue;
+    }
+    std::vector<at::Tensor> inputs;
+    for (auto* input : n->inputs()) {
+      auto c = constants.find(input);
+      if (c == constants.end()) {
+        break;
+      }
+      inputs.push_back(c->second);
+    }
+    if (inputs.empty() || inputs.size() != n->inputs().size()) {
+      continue;
+    }
+    auto result = runONNXNode(n, inputs);
+    if (!result) {
+      continue;
+    }
+    n->output()->replaceAllUsesWith(
+        addInitializer(graph, params, constants, *result));
+    n->destroy();
+  }
+}
+
+// Conv(x, W, b) -> BatchNormalization(scale, B, mean, var) becomes
+// Conv(x, W * scale / std, (b - mean) * scale / std + B)
+void foldBatchNormIntoConv(
+    Graph& graph,
+    std::vector<at::Tensor>& params,
+    ValueToTensor& constants) {
+  auto isConstant = [&](Value* v) { return constants.count(v) > 0; };
+  for (auto it = graph.nodes().begin(); it != graph.nodes().end();) {
+    Node* bn = *it;
+    ++it;
+    // training mode BatchNormalization has the running stats as outputs
+    if (bn->kind() != onnx::BatchNormalization || bn->outputs().size() != 1) {
+      continue;
+    }
+    Node* conv = bn->input(0)->node();
+    if (conv->kind() != onnx::Conv || conv->output()->uses().size() != 1 ||
+        !isConstant(conv->input(1)) ||
+        (conv->inputs().size() > 2 && !isConstant(conv->input(2)))) {
+      continue;
+    }
+    bool bn_constant = true;
+    for (size_t i = 1; i < 5; ++i) {
+      bn_constant &= isConstant(bn->input(i));
+    }
+    if (!bn_constant) {
+      continue;
+    }
+
+    auto& weight = constants[conv->input(1)];
+    auto& scale = constants[bn->input(1)];
+    auto& shift = constants[bn->input(2)];
+    auto& mean = constants[bn->input(3)];
+    auto& var = constants[bn->input(4)];
+    double eps = bn->hasAttribute(attr::epsilon) ? bn->f(attr::epsilon) : 1e-5;
+
+    auto factor = scale / (var + eps).sqrt();
+    std::vector<int64_t> factor_shape(weight.dim(), 1);
+    factor_shape[0] = -1;
+    auto new_weight = weight * factor.reshape(factor_shape);
+    auto bias = conv->inputs().size() > 2 ? constants[conv->input(2)]
+                                          : at::zeros_like(mean);
+    auto new_bias = (bias - mean) * factor + shift;
+
+    conv->replaceInput(
+        1, addInitializer(graph, params, constants, new_weight));
+    Value* bias_value = addInitializer(graph, params, constants, new_bias);
+    if (conv->inputs().size() > 2) {
+      conv->replaceInput(2, bias_value);
+    } else {
+      conv->addInput(bias_value);
+    }
+    conv->output()->setType(bn->output()->type());
+    bn->output()->replaceAllUsesWith(conv->output());
+    bn->destroy();
+  }
+}
+
+void eraseUnusedInitializers(Graph& graph, std::vector<at::Tensor>& params) {
+  size_t num_inputs = graph.inputs().size();
+  JIT_ASSERT(num_inputs >= params.size());
+  size_t first_initializer = num_inputs - params.size();
+  for (size_t i = params.size(); i-- > 0;) {
+    if (graph.inputs()[first_initializer + i]->uses().empty()) {
+      graph.eraseInput(first_initializer + i);
+      params.erase(params.begin() + i);
+    }
+  }
+}
+
+} // anonymous namespace
+
+std::vector<at::Tensor> ConstantFoldONNX(
+    std::shared_ptr<Graph>& graph,
+    std::vector<at::Tensor> params) {
+  size_t num_inputs = graph->inputs().size();
+  JIT_ASSERT(num_inputs >= params.size());
+  ValueToTensor constants;
+  for (size_t i = 0; i < params.size(); ++i) {
+    constants[graph->inputs()[num_inputs - params.size() + i]] =
+        unwrap(params[i]);
+  }
+
+  foldConstantNodes(*graph, params, constants);
+  foldBatchNormIntoConv(*graph, params, constants);
+  EliminateDeadCode(graph);
+  eraseUnusedInitializers(*graph, params);
+  return params;
+}
+
+}}  // namespace torch::jit
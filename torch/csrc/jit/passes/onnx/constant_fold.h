@@ -0,0 +1,21 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+namespace torch { namespace jit {
+
+// Optimizes an ONNX graph at export time using the values of its
+// initializers, which are the last `params.size()` inputs of the graph:
+//
+//  - nodes whose inputs are all initializers or constants (e.g. weight
+//    transposes and reshapes) are evaluated and replaced by new initializers,
+//  - inference BatchNormalization nodes following a Conv are folded into the
+//    weight and bias of the Conv,
+//  - initializers that are no longer used are removed.
+//
+// Returns the initializers of the optimized graph.
+std::vector<at::Tensor> ConstantFoldONNX(
+    std::shared_ptr<Graph>& graph,
+    std::vector<at::Tensor> params);
+
+}}
@@ -12,14 +12,87 @@ namespace torch { namespace jit {
 // Right now, it does:
 //    - Eliminate no-op 'expand' nodes
 //    - Simply x.t().t() to x
+//    - With specialized shapes, the eliminations listed in peephole.h, which
+//      move checks that ops would repeat on every call to compile time
 //
 // TODO: Decide what kind of fixed point strategy we will have
-void PeepholeOptimize(Block * block) {
+namespace {
+
+// Returns true if the shape-preserving op `node` doesn't change the shape of
+// its first input, which it then returns (an alias of) as is
+bool isNoOpShapeChange(Node * node) {
+  auto input_type = node->input(0)->type()->cast<TensorType>();
+  auto output_type = node->output()->type()->cast<TensorType>();
+  return input_type && output_type &&
+         input_type->sizes() == output_type->sizes();
+}
+
+bool isContiguous(const TensorType & type) {
+  // strides of dimensions of size 1 don't matter
+  int64_t expected_stride = 1;
+  for (int64_t i = static_cast<int64_t>(type.sizes().size()) - 1; i >= 0; i--) {
+    if (type.sizes()[i] != 1 && type.strides()[i] != expected_stride)
+      return false;
+    expected_stride *= type.sizes()[i];
+  }
+  return true;
+}
+
+// Optimizations that rely on the types of tensors being their exact shapes
+void optimizeSpecializedShapes(Node * node) {
+  if (node->matches("aten::view(Tensor self, int[] size) -> Tensor") ||
+      node->matches("aten::reshape(Tensor self, int[] shape) -> Tensor") ||
+      node->matches("aten::expand(Tensor self, int[] size, *, int implicit) -> Tensor")) {
+    if (isNoOpShapeChange(node)) {
+      node->output()->replaceAllUsesWith(node->input(0));
+    }
+  } else if (node->matches("aten::contiguous(Tensor self) -> Tensor")) {
+    auto input_type = node->input()->type()->cast<TensorType>();
+    if (input_type && isContiguous(*input_type)) {
+      node->output()->replaceAllUsesWith(node->input());
+    }
+  } else if (node->matches("aten::size(Tensor self, int dim) -> int",
+                           /*with_const=*/attr::dim)) {
+    if (auto input_type = node->namedInput(attr::self)->type()->cast<TensorType>()) {
+      auto ndim = static_cast<int64_t>(input_type->sizes().size());
+      auto dim = node->get<int64_t>(attr::dim).value();
+      if (dim < 0)
+        dim += ndim;
+      if (dim >= 0 && dim < ndim) {
+        WithInsertPoint guard(node);
+        node->output()->replaceAllUsesWith(
+            node->owningGraph()->insertConstant(input_type->sizes()[dim]));
+      }
+    }
+  } else if (node->matches("aten::dim(Tensor self) -> int")) {
+    if (auto input_type = node->input()->type()->cast<TensorType>()) {
+      WithInsertPoint guard(node);
+      node->output()->replaceAllUsesWith(node->owningGraph()->insertConstant(
+          static_cast<int64_t>(input_type->sizes().size())));
+    }
+  } else if (node->matches("aten::numel(Tensor self) -> int")) {
+    if (auto input_type = node->input()->type()->cast<TensorType>()) {
+      int64_t numel = 1;
+      for (auto size : input_type->sizes())
+        numel *= size;
+      WithInsertPoint guard(node);
+      node->output()->replaceAllUsesWith(node->owningGraph()->insertConstant(numel));
+    }
+  }
+}
+
+} // anonymous namespace
+
+void PeepholeOptimize(Block * block, bool specialized_shapes) {
   for (auto it = block->nodes().begin(); it != block->nodes().end(); ++it) {
     auto* node = *it;
 
     for (Block * sub_block : node->blocks()) {
-        PeepholeOptimize(sub_block);
+        PeepholeOptimize(sub_block, specialized_shapes);
+    }
+
+    if (specialized_shapes) {
+      optimizeSpecializedShapes(node);
     }
 
     // XXX: remember that if you want to simplify an expression by combining multiple nodes
@@ -78,8 +151,8 @@ void PeepholeOptimize(Block * block) {
   }
 }
 
-void PeepholeOptimize(std::shared_ptr<Graph>& graph) {
-  PeepholeOptimize(graph->block());
+void PeepholeOptimize(std::shared_ptr<Graph>& graph, bool specialized_shapes) {
+  PeepholeOptimize(graph->block(), specialized_shapes);
   // Eliminate dead code created by any peephole passes we've just done
   EliminateDeadCode(graph->block());
 }
@@ -4,6 +4,15 @@
 
 namespace torch { namespace jit {
 
-TORCH_API void PeepholeOptimize(std::shared_ptr<Graph>& graph);
+// With specialized_shapes, the types of tensors are taken to be the exact
+// shapes they will have when the graph runs, as they are in a graph
+// specialized to an ArgumentSpec, and the pass also:
+//    - eliminates view, reshape and expand nodes that don't change the shape
+//    - eliminates contiguous nodes on tensors that are already contiguous
+//    - folds size, dim and numel to constants
+// Traces must not use it: their sizes only describe the example inputs.
+TORCH_API void PeepholeOptimize(
+    std::shared_ptr<Graph>& graph,
+    bool specialized_shapes = false);
 
 }}
@@ -1,4 +1,7 @@
 #include "torch/csrc/jit/passes/to_batch.h"
+#include "torch/csrc/jit/autodiff.h"
+#include "torch/csrc/jit/passes/dead_code_elimination.h"
+#include "torch/csrc/jit/passes/specialize_undef.h"
 #include "torch/csrc/jit/script/compiler.h"
 
 namespace torch { namespace jit {
@@ -533,9 +536,60 @@ std::shared_ptr<Graph> to_batch_graph(std::shared_ptr<Graph>& graph){
   return res_graph;
 }
 
+// Stitches the forward and the backward graph that autodiff produces for
+// `graph` into a single graph, which has all of its inputs, followed by one
+// vjp per output, as inputs, and returns the outputs followed by the
+// gradients of the inputs, and batches that graph. Vjps of intermediates
+// saved for the backward are undefined, so specializeUndef can turn the
+// GradOf blocks and AutogradAdds of the backward into plain aten ops, which
+// have batching rules.
+std::shared_ptr<Graph> to_batch_gradient_graph(std::shared_ptr<Graph>& graph){
+  auto graph_copy = graph->copy();
+  auto grad = differentiate(graph_copy, std::vector<bool>(graph->inputs().size(), true));
+
+  auto fused_graph = std::make_shared<Graph>(graph->scope_root());
+  std::vector<Value*> inputs;
+  for(Value* input : grad.f->inputs()){
+    inputs.push_back(fused_graph->addInput()->copyMetadata(input));
+  }
+  std::vector<Value*> vjps;
+  for(size_t i = 0; i < grad.f_real_outputs; i++){
+    vjps.push_back(fused_graph->addInput()->setType(grad.f->outputs()[i]->type()));
+  }
+
+  WithInsertPoint guard(fused_graph->block());
+  auto outputs = script::inlineCallTo(*fused_graph, *grad.f, inputs);
+  std::vector<Value*> df_inputs;
+  for(size_t offset : grad.df_input_vjps){
+    if(offset < grad.f_real_outputs){
+      df_inputs.push_back(vjps[offset]);
+    } else {
+      df_inputs.push_back(fused_graph->insertNode(fused_graph->createUndefined())->output());
+    }
+  }
+  for(size_t offset : grad.df_input_captured_inputs){
+    df_inputs.push_back(inputs[offset]);
+  }
+  for(size_t offset : grad.df_input_captured_outputs){
+    df_inputs.push_back(outputs[offset]);
+  }
+  auto input_grads = script::inlineCallTo(*fused_graph, *grad.df, df_inputs);
+
+  for(size_t i = 0; i < grad.f_real_outputs; i++){
+    fused_graph->registerOutput(outputs[i]);
+  }
+  for(Value* input_grad : input_grads){
+    fused_graph->registerOutput(input_grad);
+  }
+  specializeUndef(*fused_graph, std::vector<bool>(fused_graph->inputs().size(), true));
+  EliminateDeadCode(fused_graph);
+  return to_batch_graph(fused_graph);
+}
+
 void initRegisterBatchOpsBindings(PyObject* module) {
   auto m = py::handle(module).cast<py::module>();
   m.def("to_batch_graph", &to_batch_graph);
+  m.def("to_batch_gradient_graph", &to_batch_gradient_graph);
   m.def("register_batch_operator", [](std::string name, std::shared_ptr<Graph> graph){
     ToBatch::batch_operator_table[name].push_back(graph);
   });
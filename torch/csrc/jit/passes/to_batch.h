@@ -34,5 +34,9 @@ public:
 };
 
 TORCH_API std::shared_ptr<Graph> to_batch_graph(std::shared_ptr<Graph>& graph);
+// Batches the graph computing both the outputs of `graph` and the gradients
+// of its inputs (in the order of Gradient::df_output_vjps) given a vjp for
+// every output, so e.g. per-example gradients take a single pass.
+TORCH_API std::shared_ptr<Graph> to_batch_gradient_graph(std::shared_ptr<Graph>& graph);
 TORCH_API void initRegisterBatchOpsBindings(PyObject* module);
 }}
@@ -148,11 +148,13 @@ void initPythonIRBindings(PyObject * module_) {
     })
     .def("export", [](const std::shared_ptr<Graph> g, const std::vector<at::Tensor>& initializers,
                       int64_t onnx_opset_version, bool defer_weight_export,
-                      ::torch::onnx::OperatorExportTypes operator_export_type) {
+                      ::torch::onnx::OperatorExportTypes operator_export_type,
+                      const std::string& external_data_directory) {
       std::string graph;
       RawDataExportMap export_map;
       std::tie(graph, export_map) = ExportGraph(
-        g, initializers, onnx_opset_version, defer_weight_export, operator_export_type);
+        g, initializers, onnx_opset_version, defer_weight_export, operator_export_type,
+        external_data_directory);
       std::unordered_map<std::string, py::bytes> python_serialized_export_map;
       for (auto& kv : export_map) {
         auto t = kv.second;
@@ -166,7 +168,8 @@ void initPythonIRBindings(PyObject * module_) {
     }, py::arg("initializers"),
        py::arg("onnx_opset_version")=0,
        py::arg("defer_weight_export")=false,
-       py::arg("operator_export_type")=::torch::onnx::OperatorExportTypes::ONNX)
+       py::arg("operator_export_type")=::torch::onnx::OperatorExportTypes::ONNX,
+       py::arg("external_data_directory")="")
     .def("prettyPrintExport", [](const std::shared_ptr<Graph> g,
           const std::vector<at::Tensor>& initializers,
           int64_t onnx_opset_version, bool defer_weight_export,
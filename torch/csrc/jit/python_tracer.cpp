@@ -146,6 +146,12 @@ void initPythonTracerBindings(PyObject* module) {
   m.def("_set_value_trace", [](const Variable& var, Value* value) {
     return setValueTrace(var, value);
   });
+  m.def("_tracer_set_source_location_interval", [](size_t interval) {
+    setSourceLocationInterval(interval);
+  });
+  m.def("_tracer_get_source_location_interval", []() {
+    return getSourceLocationInterval();
+  });
 }
 
 }}} // namespace torch::jit::tracing
@@ -36,22 +36,65 @@ RegisterOperators reg({
 
     Operator(
         prim::FusionGroup,
-        [](Node* node) {
+        [](Node* node) -> Operation {
           auto fusion_fn = sharedFusionCompiler().getOrCompile(node);
           auto num_inputs = node->inputs().size();
-          return [fusion_fn, num_inputs](Stack& stack) {
+          if (!node->hasAttribute(attr::arena_offsets)) {
+            return [fusion_fn, num_inputs](Stack& stack) {
+              autograd::profiler::RecordFunction record("FusionGroup");
+              std::vector<at::Tensor> toutputs;
+              // TODO: have fusion_fn work off of a stack as well
+              auto tinputs = fmap(last(stack, num_inputs), [](const IValue& v) {
+                return v.toTensor();
+              });
+              fusion_fn->launch(tinputs, toutputs);
+              drop(stack, num_inputs);
+              stack.insert(stack.end(), toutputs.begin(), toutputs.end());
+              return 0;
+            };
+          }
+          // Groups planned by PlanMemory take an arena as their last input and
+          // write the outputs with an offset into views of it.
+          auto offsets = node->is(attr::arena_offsets);
+          std::vector<std::vector<int64_t>> sizes;
+          for (auto o : node->outputs()) {
+            auto type = o->type()->cast<TensorType>();
+            sizes.push_back(type ? type->sizes() : std::vector<int64_t>());
+          }
+          return [fusion_fn, num_inputs, offsets, sizes](Stack& stack) {
             autograd::profiler::RecordFunction record("FusionGroup");
-            std::vector<at::Tensor> toutputs;
-            // TODO: have fusion_fn work off of a stack as well
-            auto tinputs = fmap(last(stack, num_inputs), [](const IValue& v) {
+            at::Tensor arena = pop(stack).toTensor();
+            std::vector<at::Tensor> toutputs(offsets.size());
+            for (size_t i = 0; i < offsets.size(); ++i) {
+              if (offsets[i] < 0)
+                continue;
+              int64_t numel = 1;
+              for (auto s : sizes[i])
+                numel *= s;
+              toutputs[i] = arena.narrow(0, offsets[i], numel).view(sizes[i]);
+            }
+            auto tinputs = fmap(last(stack, num_inputs - 1), [](const IValue& v) {
               return v.toTensor();
             });
             fusion_fn->launch(tinputs, toutputs);
-            drop(stack, num_inputs);
+            drop(stack, num_inputs - 1);
             stack.insert(stack.end(), toutputs.begin(), toutputs.end());
             return 0;
           };
         }),
+    Operator(
+        prim::AllocateArena,
+        [](Node* node) {
+          int64_t size = node->i(attr::size);
+          int device = node->i(attr::device);
+          auto scalar_type = static_cast<at::ScalarType>(node->i(attr::dtype));
+          auto backend = device == kCPUDevice ? at::Backend::CPU : at::Backend::CUDA;
+          return [=](Stack& stack) {
+            at::DeviceGuard guard(device);
+            push(stack, torch::getType(backend, scalar_type).tensor({size}));
+            return 0;
+          };
+        }),
     Operator(
         prim::TensorToNum,
         [](Node* node) -> Operation {
@@ -603,6 +603,12 @@ std::shared_ptr<SugaredValue> BuiltinFunction::call(
     at::ArrayRef<NamedValue> inputs_,
     at::ArrayRef<NamedValue> attributes,
     size_t n_binders) {
+  // a few in-place ops are registered for the optimizer (see
+  // RewriteInplaceOps), but script graphs have to be functional
+  bool is_inplace = !name.empty() && name.back() == '_' && name.compare(0, 2, "__") != 0;
+  if (is_inplace) {
+    throw ErrorReport(loc) << "in-place operator " << name << " is not supported in script";
+  }
   std::vector<NamedValue> inputs;
   if (value)
     inputs.push_back(*value);
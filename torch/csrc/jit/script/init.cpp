@@ -408,9 +408,10 @@ void initJitScriptBindings(PyObject* module) {
       .def(py::init<>())
       .def("save", &Module::save)
       .def("_load", [](const std::shared_ptr<script::Module> module,
-                       const std::string& filename) {
-        ImportIRModule(module, filename);
-      })
+                       const std::string& filename,
+                       bool map_storages) {
+        ImportIRModule(module, filename, map_storages);
+      }, py::arg("filename"), py::arg("map_storages") = false)
       .def("_set_optimized", &Module::set_optimized)
       .def(
           "_define",
@@ -547,6 +548,7 @@ void initJitScriptBindings(PyObject* module) {
     .def("propagate_shapes", &Method::propagate_shapes)
     .def("propagate_and_assign_input_and_output_shapes", &Method::propagate_and_assign_input_and_output_shapes)
     .def("params", &Method::params)
+    .def("precompile", &Method::precompile)
     .def("graph_for", [](Method& self, py::args args) {
       return self.graph_for(evilDeprecatedBadCreateStackDoNotUse(args, self.graph()->inputs()));
     })
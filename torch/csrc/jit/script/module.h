@@ -53,6 +53,9 @@ struct Method {
     }
   }
 
+  // Can be called concurrently, e.g. by an inference server handling many
+  // requests with one module (see GraphExecutor::run). Members are read when
+  // the call starts, so they must not be modified while calls are running.
   void run(Stack & stack) {
     for(at::Tensor* tp : member_inputs) {
       stack.push_back(*tp);
@@ -62,6 +65,26 @@ struct Method {
   std::shared_ptr<Graph> graph_for(const Stack& inputs) {
     return get_executor().graphFor(inputs);
   }
+
+  // Optimizes this method for inputs like these ahead of time (see
+  // GraphExecutor::precompile). The resulting plans are saved with the module.
+  void precompile(std::vector<at::Tensor> inputs) {
+    Stack stack;
+    stack.reserve(inputs.size() + member_inputs.size());
+    for (at::Tensor & i : inputs) {
+      stack.emplace_back(std::move(i));
+    }
+    for (at::Tensor* tp : member_inputs) {
+      stack.push_back(*tp);
+    }
+    get_executor().precompile(stack);
+  }
+  std::vector<std::shared_ptr<Graph>> optimized_graphs() {
+    return get_executor().optimizedGraphs();
+  }
+  void add_optimized_graph(std::shared_ptr<Graph> graph) {
+    get_executor().addOptimizedGraph(std::move(graph));
+  }
   std::shared_ptr<Graph> graph() const {
     return graph_;
   }
@@ -3,6 +3,11 @@
 #include <cstdio>
 #include <cstring>
 #include <cerrno>
+#include <memory>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
 
 namespace torch { namespace jit {
 
@@ -107,6 +112,54 @@ class PyTorchFileReader {
     return getRecordWithKey(last_record_offset);
   }
   std::tuple<std::shared_ptr<void>, size_t> getRecordWithKey(uint64_t key) {
+    auto size = seekToRecordPayload(key);
+    std::shared_ptr<void> retval(malloc(size), free);
+    if (!std::fread(retval.get(), size, 1, fp)) {
+      wrapPErrorAndThrow("Failed to read data from record");
+    }
+    cursor += size;
+    seekToNextAlignmentBoundary();
+    return std::tuple<std::shared_ptr<void>, size_t>(retval, size);
+  }
+  // Like getRecordWithKey, but returns a pointer into a private (copy on
+  // write) mapping of the whole file instead of reading the record into a new
+  // buffer. The mapping is released once all returned pointers are. Falls
+  // back to getRecordWithKey on platforms without mmap.
+  std::tuple<std::shared_ptr<void>, size_t> mapRecordWithKey(uint64_t key) {
+#ifdef _WIN32
+    return getRecordWithKey(key);
+#else
+    auto size = seekToRecordPayload(key);
+    if (!mapping) {
+      void* data = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(fp), 0);
+      if (data == MAP_FAILED) {
+        wrapPErrorAndThrow("Failed to map file");
+      }
+      auto mapped_size = file_size;
+      mapping = std::shared_ptr<void>(data, [mapped_size](void* data) {
+        munmap(data, mapped_size);
+      });
+    }
+    // aliases the mapping, so it is kept alive by the record
+    std::shared_ptr<void> retval(mapping, static_cast<char*>(mapping.get()) + cursor);
+    cursor += size;
+    seekToNextAlignmentBoundary();
+    return std::tuple<std::shared_ptr<void>, size_t>(retval, size);
+#endif
+  }
+  ~PyTorchFileReader() {
+    std::fclose(fp);
+  }
+ private:
+  FILE *fp;
+  size_t cursor = 0;
+  size_t file_size;
+  size_t last_record_offset;
+  std::shared_ptr<void> mapping;
+
+  // Validates the header of the record at `key` and leaves the cursor at the
+  // start of its payload. Returns the size of the payload.
+  uint64_t seekToRecordPayload(uint64_t key) {
     if (key + kFieldAlignment > file_size) {
       throw std::runtime_error("Provided key is larger than the size of the file.");
     }
@@ -122,22 +175,12 @@ class PyTorchFileReader {
     }
     auto size = read64BitIntegerLittleEndian();
     seekToNextAlignmentBoundary();
-    std::shared_ptr<void> retval(malloc(size), free);
-    if (!std::fread(retval.get(), size, 1, fp)) {
-      wrapPErrorAndThrow("Failed to read data from record");
+    if (cursor + size > file_size) {
+      throw std::runtime_error("Record extends past the end of the file. Is this"
+                               " file corrupted?");
     }
-    cursor += size;
-    seekToNextAlignmentBoundary();
-    return std::tuple<std::shared_ptr<void>, size_t>(retval, size);
+    return size;
   }
-  ~PyTorchFileReader() {
-    std::fclose(fp);
-  }
- private:
-  FILE *fp;
-  size_t cursor = 0;
-  size_t file_size;
-  size_t last_record_offset;
 
   // Utility functions
   uint64_t read64BitIntegerLittleEndian() {
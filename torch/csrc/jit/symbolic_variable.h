@@ -100,9 +100,18 @@ struct SymbolicVariable {
   SymbolicVariable mm(const SymbolicVariable rhs) const {
     return create(t("mm"), {*this, rhs})[0];
   }
+  SymbolicVariable matmul(const SymbolicVariable rhs) const {
+    return create(t("matmul"), {*this, rhs})[0];
+  }
   SymbolicVariable t() const {
     return create(t("t"), {*this})[0];
   }
+  SymbolicVariable transpose(int dim0, int dim1) const {
+    return create(t("transpose"), {*this, insertConstant(dim0), insertConstant(dim1)})[0];
+  }
+  SymbolicVariable rsqrt() const {
+    return create(t("rsqrt"), {*this})[0].typeLike(*this);
+  }
   SymbolicVariable sigmoid() const {
     return create(aten::sigmoid, {*this})[0].typeLike(*this);
   }
@@ -144,6 +153,23 @@ struct SymbolicVariable {
   SymbolicVariable sum(int dim, bool keepdim) const {
     return create(t("sum"), {*this, insertConstant(at::IntList{dim}), insertConstant(keepdim)})[0];
   }
+  SymbolicVariable sum(std::vector<int64_t> dims, bool keepdim) const {
+    return create(t("sum"), {*this, insertConstant(dims), insertConstant(keepdim)})[0];
+  }
+  SymbolicVariable expand_as(const SymbolicVariable rhs) const {
+    return create(t("expand_as"), {*this, rhs})[0];
+  }
+  SymbolicVariable reshape_as(const SymbolicVariable rhs) const {
+    return create(t("reshape_as"), {*this, rhs})[0];
+  }
+  // Returns an int Value holding the size of `dim`, for when it isn't known
+  // statically.
+  Value* size(int dim) const {
+    return create(t("size"), {*this, insertConstant(dim)})[0].value()->setType(IntType::get());
+  }
+  Value* numel() const {
+    return create(t("numel"), {*this})[0].value()->setType(IntType::get());
+  }
   SymbolicVariable squeeze(Value* dim) const {
     return create(t("squeeze"), {*this, dim})[0];
   }
@@ -28,6 +28,9 @@ using Catch::StartsWith;
 #include "torch/csrc/jit/passes/shape_analysis.h"
 #include "torch/csrc/jit/passes/dead_code_elimination.h"
 #include "torch/csrc/jit/passes/lower_grad_of.h"
+#include "torch/csrc/jit/passes/memory_planning.h"
+#include "torch/csrc/jit/passes/inplace_rewrite.h"
+#include "torch/csrc/jit/passes/batch_mm.h"
 #include "torch/csrc/jit/operator.h"
 #include "torch/csrc/jit/custom_operator.h"
 #include "torch/csrc/variable_tensor_functions.h"
@@ -37,6 +40,7 @@ using Catch::StartsWith;
 #include "torch/csrc/jit/passes/shape_analysis.h"
 
 #include "torch/csrc/jit/graph_executor.h"
+#include "torch/csrc/jit/parallel_interpreter.h"
 #include "torch/csrc/jit/script/compiler.h"
 #include "torch/csrc/jit/script/module.h"
 #include "torch/csrc/jit/ivalue.h"
@@ -47,12 +51,16 @@ using Catch::StartsWith;
 #include <ATen/ATen.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <cstdlib>
+#include <dirent.h>
 #include <functional>
 #include <iostream>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_set>
 #include <utility>
@@ -253,6 +261,120 @@ static void fusionTests() {
   testConcat(0);
   testConcat(1);
   testConcat(2);
+
+  auto testReduce = [&](int64_t dim, bool keepdim, bool mean) {
+    Graph graph;
+    Var i0 = Var::asNewInput(graph);
+    Var i1 = Var::asNewInput(graph);
+    auto p = (i0 * i1).sigmoid();
+    Node * reduce = graph.create(prim::FusedReduce, {p})
+      ->i_(attr::dim, dim)
+      ->i_(attr::keepdim, keepdim)
+      ->s_(attr::name, mean ? "mean" : "sum");
+    Var(graph.insertNode(reduce)->output()).addAsOutput();
+
+    auto a = at::rand({3,4,5}, at::kCUDA);
+    auto b = at::rand({4,3,5}, at::kCUDA).transpose(0,1);
+    auto p_r = (a * b).sigmoid();
+    auto o_r = mean ? p_r.mean(dim, keepdim) : p_r.sum(dim, keepdim);
+    auto o = at::zeros(o_r.sizes(), at::kCUDA);
+    comp.debugLaunchGraph(graph, 0, {a,b}, {o});
+
+    REQUIRE(o_r.is_same_size(o));
+    float max_diff = (o_r - o).abs().max().toCDouble();
+    REQUIRE(max_diff < 1e-5);
+  };
+  for (int64_t dim = 0; dim < 3; ++dim) {
+    testReduce(dim, false, false);
+    testReduce(dim, true, true);
+  }
+}
+
+static void fusionCPUTests() {
+  char cache_template[] = "/tmp/pytorch_fuser_cacheXXXXXX";
+  std::string cache_dir = mkdtemp(cache_template);
+  setenv("PYTORCH_FUSION_CACHE_DIR", cache_dir.c_str(), 1);
+  FusionCompiler comp;
+  unsetenv("PYTORCH_FUSION_CACHE_DIR");
+  if (!comp.canCompileOnCPU()) {
+    return;
+  }
+
+  auto testSimple = [&](at::Tensor a, at::Tensor b) {
+    Graph graph;
+    Var i0 = Var::asNewInput(graph);
+    Var i1 = Var::asNewInput(graph);
+    auto o0 = (i0 * i1).sigmoid();
+    o0.addAsOutput();
+    auto o = at::zeros(a.sizes(), at::kCPU);
+    comp.debugLaunchGraph(graph, kCPUDevice, {a, b}, {o});
+    float max_diff = ((a * b).sigmoid() - o).abs().max().toCDouble();
+    REQUIRE(max_diff < 1e-6);
+  };
+  // large enough to be split across threads by at::parallel_for
+  testSimple(at::rand({256, 512}, at::kCPU), at::rand({256, 512}, at::kCPU));
+  testSimple(at::rand({256, 512}, at::kCPU), at::rand({512, 256}, at::kCPU).transpose(0, 1));
+
+  // compiled kernels are reused by a fresh compiler through the disk cache
+  auto countCached = [&] {
+    int count = 0;
+    DIR * dir = opendir(cache_dir.c_str());
+    REQUIRE(dir != nullptr);
+    while (struct dirent * entry = readdir(dir)) {
+      std::string name = entry->d_name;
+      if (name.size() > 3 && name.substr(name.size() - 3) == ".so")
+        count++;
+    }
+    closedir(dir);
+    return count;
+  };
+  REQUIRE(countCached() == 2);
+  REQUIRE(comp.diskCacheStats().misses == 2);
+  REQUIRE(comp.diskCacheStats().hits == 0);
+  {
+    setenv("PYTORCH_FUSION_CACHE_DIR", cache_dir.c_str(), 1);
+    FusionCompiler comp2;
+    unsetenv("PYTORCH_FUSION_CACHE_DIR");
+    Graph graph;
+    Var i0 = Var::asNewInput(graph);
+    Var i1 = Var::asNewInput(graph);
+    (i0 * i1).sigmoid().addAsOutput();
+    auto a = at::rand({256, 512}, at::kCPU);
+    auto b = at::rand({256, 512}, at::kCPU);
+    auto o = at::zeros({256, 512}, at::kCPU);
+    comp2.debugLaunchGraph(graph, kCPUDevice, {a, b}, {o});
+    REQUIRE(((a * b).sigmoid() - o).abs().max().toCDouble() < 1e-6);
+    REQUIRE(comp2.diskCacheStats().hits == 1);
+    REQUIRE(comp2.diskCacheStats().misses == 0);
+  }
+  REQUIRE(countCached() == 2);
+
+  auto testReduce = [&](int64_t dim, bool keepdim, bool mean) {
+    Graph graph;
+    Var i0 = Var::asNewInput(graph);
+    Var i1 = Var::asNewInput(graph);
+    auto p = (i0 * i1).sigmoid();
+    Node * reduce = graph.create(prim::FusedReduce, {p})
+      ->i_(attr::dim, dim)
+      ->i_(attr::keepdim, keepdim)
+      ->s_(attr::name, mean ? "mean" : "sum");
+    Var(graph.insertNode(reduce)->output()).addAsOutput();
+
+    auto a = at::rand({3,4,5}, at::kCPU);
+    auto b = at::rand({4,3,5}, at::kCPU).transpose(0,1);
+    auto p_r = (a * b).sigmoid();
+    auto o_r = mean ? p_r.mean(dim, keepdim) : p_r.sum(dim, keepdim);
+    auto o = at::zeros(o_r.sizes(), at::kCPU);
+    comp.debugLaunchGraph(graph, kCPUDevice, {a,b}, {o});
+
+    REQUIRE(o_r.is_same_size(o));
+    float max_diff = (o_r - o).abs().max().toCDouble();
+    REQUIRE(max_diff < 1e-5);
+  };
+  for (int64_t dim = 0; dim < 3; ++dim) {
+    testReduce(dim, false, false);
+    testReduce(dim, true, true);
+  }
 }
 
 struct Attr : public Attributes<Attr> {
@@ -611,6 +733,14 @@ void testADFormulas() {
     {"chunk",   {{10, 12, 15}}, [](const VL& v) -> VL { return fmap<Variable>(v[0].chunk(3, 2)); }},
     {"split",   {{10, 12, 15}}, [](const VL& v) -> VL { return fmap<Variable>(v[0].split(4, 1)); }},
     {"split",   {{10, 12, 15}}, [](const VL& v) -> VL { return fmap<Variable>(v[0].split(3, 2)); }},
+    {"matmul",  {{4, 10, 12}, {12, 15}}, [](const VL& v) -> VL { return {v[0].matmul(v[1])}; }},
+    {"softmax", {{10, 12}}, [](const VL& v) -> VL { return {v[0].softmax(1)}; }},
+    {"log_softmax", {{10, 12}}, [](const VL& v) -> VL { return {v[0].log_softmax(1)}; }},
+    {"sum",     {{10, 12, 15}}, [](const VL& v) -> VL { return {v[0].sum()}; }},
+    {"sum",     {{10, 12, 15}}, [](const VL& v) -> VL { return {v[0].sum({2, 0})}; }},
+    {"mean",    {{10, 12, 15}}, [](const VL& v) -> VL { return {v[0].mean()}; }},
+    {"mean",    {{10, 12, 15}}, [](const VL& v) -> VL { return {v[0].mean(1, true)}; }},
+    {"view",    {{10, 12, 15}}, [](const VL& v) -> VL { return {v[0].view({10, -1})}; }},
   };
 
   for (const auto & test : ad_tests) {
@@ -840,6 +970,39 @@ void testGraphExecutor() {
   REQUIRE(almostEqual(Variable(stack[1].toTensor()).data(), r1));
 }
 
+void testGraphExecutorConcurrentRuns() {
+  constexpr int num_threads = 8;
+  constexpr int runs_per_thread = 50;
+  auto g = std::make_shared<Graph>();
+  auto a = SymbolicVariable::asNewInput(*g);
+  auto b = SymbolicVariable::asNewInput(*g);
+  (a * b + a).addAsOutput();
+  GraphExecutor executor(g);
+
+  auto x = autograd::make_variable(at::randn({16}), false);
+  auto y = autograd::make_variable(at::randn({16}), false);
+  auto expected = Variable(x * y + x).data();
+  std::atomic<int> failures{0};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < runs_per_thread; ++j) {
+        auto stack = createStack({x, y});
+        executor.run(stack);
+        if (!almostEqual(Variable(stack[0].toTensor()).data(), expected))
+          failures++;
+      }
+    });
+  }
+  for (auto & t : threads) {
+    t.join();
+  }
+  REQUIRE(failures == 0);
+  auto state = executor.getDebugState();
+  REQUIRE(state.plan_cache_misses == 1);
+  REQUIRE(state.plan_cache_hits == num_threads * runs_per_thread - 1);
+}
+
 void testBlocks(std::ostream & out) {
   Graph g;
   auto a = Var::asNewInput(g, "a");
@@ -915,6 +1078,158 @@ void testControlFlow() {
   REQUIRE(256 == run_binary("while_test",2,0));
 }
 
+const static auto parallel_examples = R"JIT(
+  def towers(a, b):
+      x = a * b
+      y = a + b
+      z = a - b
+      if a < b:
+        x = x + z
+      else:
+        x = x - y
+      return x + y + z
+  def chain(a, b):
+      return ((a + b) * b) - a
+)JIT";
+void testParallelInterpreter() {
+  script::Module cu;
+  script::defineMethodsInModule(cu, parallel_examples, torch::jit::script::Resolver(), nullptr);
+  auto L = [](int64_t l) { return IValue(autograd::make_variable(at::Scalar(l).toTensor())); };
+  auto V = [](IValue t) { return at::Scalar(std::move(t).toTensor()).toLong(); };
+  auto run_sequential = [&](const std::string & name, int64_t a, int64_t b) {
+    auto graph = cu.get_method(name).graph();
+    Code code(graph);
+    std::vector<IValue> stack = {L(a), L(b)};
+    InterpreterState(code).runOneStage(stack);
+    REQUIRE(stack.size() == 1);
+    return V(stack[0]);
+  };
+  auto run_parallel = [&](const std::string & name, int64_t a, int64_t b) {
+    auto graph = cu.get_method(name).graph();
+    ParallelCode code(graph);
+    std::vector<IValue> stack = {L(a), L(b)};
+    code.run(stack);
+    REQUIRE(stack.size() == 1);
+    return V(stack[0]);
+  };
+  REQUIRE(ParallelCode::isProfitable(*cu.get_method("towers").graph()));
+  REQUIRE(!ParallelCode::isProfitable(*cu.get_method("chain").graph()));
+  for (int64_t a = 0; a < 4; ++a) {
+    REQUIRE(run_sequential("towers", a, 2) == run_parallel("towers", a, 2));
+    REQUIRE(run_sequential("chain", a, 2) == run_parallel("chain", a, 2));
+  }
+}
+
+void testMemoryPlanning() {
+  auto graph = std::make_shared<Graph>();
+  auto type = TensorType::create(at::kFloat, kCPUDevice, {4, 7});
+  auto a = graph->addInput();
+  a->setType(type);
+  auto group = [&](Value * input) {
+    Node * n = graph->insertNode(graph->createFusionGroup(kCPUDevice));
+    n->addInput(input);
+    Value * o = n->addOutput();
+    o->setType(type);
+    return o;
+  };
+  // x, y and z are planned; w escapes as a graph output. z is defined after
+  // the last use of x, so it can reuse its region.
+  auto x = group(a);
+  auto y = group(x);
+  auto z = group(y);
+  auto w = group(z);
+  graph->registerOutput(w);
+  PlanMemory(graph);
+  graph->lint();
+
+  Node * arena = *graph->nodes().begin();
+  REQUIRE(arena->kind() == prim::AllocateArena);
+  // regions of 28 floats are padded to a multiple of 64 bytes
+  REQUIRE(arena->i(attr::size) == 64);
+  auto offset = [&](Value * v) {
+    REQUIRE(v->node()->inputs().back() == arena->output());
+    return v->node()->is(attr::arena_offsets).at(0);
+  };
+  REQUIRE(offset(x) == 0);
+  REQUIRE(offset(y) == 32);
+  REQUIRE(offset(z) == 0);
+  REQUIRE(!w->node()->hasAttribute(attr::arena_offsets));
+}
+
+void testInplaceRewrite() {
+  auto graph = std::make_shared<Graph>();
+  auto type = TensorType::create(at::kFloat, kCPUDevice, {4, 4});
+  auto typed = [&](SymbolicVariable v) {
+    v.value()->setType(type);
+    return v;
+  };
+  auto a = SymbolicVariable::asNewInput(*graph, type);
+  // x is only read by the sigmoid, so it can be overwritten. a is a graph
+  // input, and v is read by both the relu and the mul.
+  auto x = typed(a.mm(a));
+  auto y = typed(x.sigmoid());
+  auto u = typed(a.tanh());
+  auto v = typed(y.mm(u));
+  auto r = typed(SymbolicVariable::create(aten::relu, {v})[0]);
+  auto t = typed(v * r);
+  t.addAsOutput();
+  RewriteInplaceOps(graph);
+  graph->lint();
+
+  std::vector<std::string> kinds;
+  for (auto n : graph->nodes()) {
+    kinds.push_back(n->kind().toQualString());
+  }
+  REQUIRE(kinds == std::vector<std::string>(
+    {"aten::mm", "aten::sigmoid_", "aten::tanh", "aten::mm", "aten::relu", "aten::mul"}));
+}
+
+void testBatchMMSiblings() {
+  auto graph = std::make_shared<Graph>();
+  auto input = [&](std::vector<int64_t> sizes) {
+    return SymbolicVariable::asNewInput(*graph, TensorType::create(at::kFloat, kCPUDevice, sizes));
+  };
+  auto typed = [](SymbolicVariable v, std::vector<int64_t> sizes) {
+    v.value()->setType(TensorType::create(at::kFloat, kCPUDevice, sizes));
+    return v;
+  };
+  // three projections of x (one mm with concatenated weights) and two
+  // unrelated matmuls of the same shape (one bmm)
+  auto x = input({4, 3});
+  auto w1 = input({3, 5}), w2 = input({3, 5}), w3 = input({3, 2});
+  auto a1 = input({2, 2}), b1 = input({2, 2}), a2 = input({2, 2}), b2 = input({2, 2});
+  std::vector<SymbolicVariable> outputs = {
+    typed(x.mm(w1), {4, 5}), typed(x.mm(w2), {4, 5}), typed(x.mm(w3), {4, 2}),
+    typed(a1.mm(b1), {2, 2}), typed(a2.mm(b2), {2, 2}),
+  };
+  for (auto o : outputs) {
+    o.addAsOutput();
+  }
+  auto reference = graph->copy();
+  BatchMM(graph);
+  graph->lint();
+
+  size_t num_mm = 0, num_bmm = 0;
+  for (auto n : graph->nodes()) {
+    num_mm += n->kind() == aten::mm;
+    num_bmm += n->kind() == aten::bmm;
+  }
+  REQUIRE(num_mm == 1);
+  REQUIRE(num_bmm == 1);
+
+  std::vector<at::Tensor> inputs;
+  for (auto i : graph->inputs()) {
+    inputs.push_back(at::randn(i->type()->expect<TensorType>()->sizes()));
+  }
+  std::vector<at::Tensor> expected, actual;
+  InterpreterState reference_interp { Code(reference) }, batched_interp { Code(graph) };
+  runOneStage(reference_interp, inputs, expected);
+  runOneStage(batched_interp, inputs, actual);
+  for (size_t i = 0; i < expected.size(); ++i) {
+    REQUIRE(almostEqual(expected[i], actual[i]));
+  }
+}
+
 void testIValue() {
   Shared<IntList> foo = IntList::create({3, 4, 5});
   JIT_ASSERT(foo->use_count() == 1);
@@ -1168,7 +1483,12 @@ TORCH_API std::string runJITCPPTests() {
   std::stringstream out;
   testIValue();
   testControlFlow();
+  testParallelInterpreter();
+  testMemoryPlanning();
+  testInplaceRewrite();
+  testBatchMMSiblings();
   testGraphExecutor();
+  testGraphExecutorConcurrentRuns();
   testBlocks(out);
   testCreateAutodiffSubgraphs(out);
   testDifferentiate(out);
@@ -1178,6 +1498,7 @@ TORCH_API std::string runJITCPPTests() {
   interpStageTest();
   codeTemplateTest();
   fusionTests();
+  fusionCPUTests();
   attributesTest();
   internedStringsTests();
   fromQualStringTests();
@@ -1195,6 +1516,16 @@ TEST_CASE( "jit test CPU", "[cpu]" ) {
   std::stringstream out;
   SECTION( "control flow" )
     testControlFlow();
+  SECTION( "parallel interpreter" )
+    testParallelInterpreter();
+  SECTION( "memory planning" )
+    testMemoryPlanning();
+  SECTION( "in-place rewrite" )
+    testInplaceRewrite();
+  SECTION( "batch mm siblings" )
+    testBatchMMSiblings();
+  SECTION( "graph executor concurrent runs" )
+    testGraphExecutorConcurrentRuns();
   SECTION( "blocks" )
     testBlocks(out);
   SECTION( "create autodiff subgraphs" )
@@ -1207,6 +1538,8 @@ TEST_CASE( "jit test CPU", "[cpu]" ) {
     testADFormulas();
   SECTION( "code template" )
     codeTemplateTest();
+  SECTION( "CPU fusion" )
+    fusionCPUTests();
   SECTION( "attributes" )
     attributesTest();
   SECTION( "interned strings" )
@@ -8,6 +8,7 @@
 #include "torch/csrc/jit/passes/remove_expands.h"
 #include "torch/csrc/variable_tensor_functions.h"
 
+#include <atomic>
 #include <string>
 #include <sstream>
 #include <memory>
@@ -79,8 +80,10 @@ void setTracingState(std::shared_ptr<TracingState> state) {
   detail::tracing_state = std::move(state);
 }
 
+static std::atomic<uint64_t> next_tracing_state_id{1};
+
 TracingState::TracingState()
-    : graph(new Graph()) {}
+    : graph(new Graph()), id(next_tracing_state_id++) {}
 
 TracingState::~TracingState() = default;
 
@@ -139,11 +142,25 @@ void ArgumentStash::stashIntListElem(const std::string& arg_name, size_t size, s
 // no python present so we just do not record source information
 void defaultRecordSourceLocation(Node* n) {}
 std::atomic<decltype(&defaultRecordSourceLocation)> record_source_location(defaultRecordSourceLocation);
+std::atomic<size_t> source_location_interval(1);
+thread_local size_t nodes_since_source_location = 0;
 void recordSourceLocation(Node* n) {
+  auto interval = source_location_interval.load(std::memory_order_relaxed);
+  if (interval == 0 || ++nodes_since_source_location < interval) {
+    return;
+  }
+  nodes_since_source_location = 0;
   return record_source_location.load()(n);
 }
 void setRecordSourceLocation(void (*v)(Node*)) {
   record_source_location.store(v);
 }
+void setSourceLocationInterval(size_t interval) {
+  source_location_interval.store(interval);
+  nodes_since_source_location = 0;
+}
+size_t getSourceLocationInterval() {
+  return source_location_interval.load();
+}
 
 }}}
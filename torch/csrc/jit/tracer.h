@@ -43,8 +43,14 @@ struct TORCH_API TracingState : public std::enable_shared_from_this<TracingState
     }
   };
 
+  // Every variable's value is also cached on the variable itself (see
+  // Variable::trace_value), which is what lookups hit in the common case.
+  // The map stays authoritative for variables traced by several threads.
   std::unordered_map<WeakTensor, Value*, WeakTensorHasher, WeakTensorEq> value_map;
   std::shared_ptr<Graph> graph;
+  // Unique for the lifetime of the process, so a cache entry left on a
+  // variable by an earlier trace can never be mistaken for one of ours
+  const uint64_t id;
 };
 
 
@@ -98,7 +104,22 @@ inline bool isTracing() {
 // variable know which node in the IR to reference.
 inline void setValueTrace(const Variable& var, Value *value) {
   JIT_ASSERT(var.defined());
-  getTracingState()->value_map[var] = value;
+  auto & state = getTracingState();
+  state->value_map[var] = value;
+  var.set_trace_value(state->id, value);
+}
+
+// Returns the value tracing 'var' in 'state', or nullptr if there is none
+inline Value* findValueTrace(const std::shared_ptr<TracingState>& state, const Variable& var) {
+  if (Value* value = var.trace_value(state->id)) {
+    return value;
+  }
+  auto it = state->value_map.find(var);
+  if (it == state->value_map.end()) {
+    return nullptr;
+  }
+  var.set_trace_value(state->id, it->second);
+  return it->second;
 }
 
 // Given a variable 'var', return the 'node' which represents the instruction
@@ -122,14 +143,13 @@ inline Value* getValueTrace(const Variable& var) {
     return state->graph->appendNode(n)->output();
   }
 
-  auto & value_map = getTracingState()->value_map;
-  auto it = value_map.find(var);
-  if (it == value_map.end()) {
-    Value *constant = state->graph->insertConstant(var.data());
-    constant->inferTypeFrom(var.data());
-    it = value_map.emplace_hint(it, var, constant);
+  if (Value* value = findValueTrace(state, var)) {
+    return value;
   }
-  return it->second;
+  Value *constant = state->graph->insertConstant(var.data());
+  constant->inferTypeFrom(var.data());
+  setValueTrace(var, constant);
+  return constant;
 }
 
 inline Value* getOutputTrace(const std::shared_ptr<TracingState>& state, const Variable& var, size_t output_no) {
@@ -138,21 +158,22 @@ inline Value* getOutputTrace(const std::shared_ptr<TracingState>& state, const V
     return state->graph->appendNode(n)->output();
   }
 
-  auto & value_map = getTracingState()->value_map;
-  auto it = value_map.find(var);
-  if (it == value_map.end()) {
+  Value* value = findValueTrace(state, var);
+  if (!value) {
     std::ostringstream os;
     os << "output " << output_no << " of traced region did not have observable "
        << "data dependence with trace inputs; this probably indicates your program "
        << "cannot be understood by the tracer.";
     throw std::runtime_error(os.str());
   }
-  return it->second;
+  return value;
 }
 
 // Start tracing, treating 'inputs' as inputs to the trace, which can be
 // varied on subsequent invocations of the trace.  Any other variables
 // will be treated as constants.
+// Inputs usually include every parameter of the traced model, so they are
+// added in one pass with the map sized up front.
 inline std::pair<std::shared_ptr<TracingState>, variable_list> enter(
     variable_list inputs) {
   if (isTracing()) {
@@ -160,15 +181,15 @@ inline std::pair<std::shared_ptr<TracingState>, variable_list> enter(
   }
   auto state = std::make_shared<TracingState>();
   setTracingState(state);
+  state->value_map.reserve(inputs.size());
   for (auto& input : inputs) {
-    auto * value_state = state->value_map[input];
-    if (value_state) {
+    if (input.trace_value(state->id)) {
       // See Note [Repeated inputs] in tracer.cpp
       input = input.view(input.sizes());
     }
     auto input_node = state->graph->addInput(input.name());
     input_node->inferTypeFrom(input.data());
-    state->value_map[input] = input_node;
+    setValueTrace(input, input_node);
   }
   return std::make_pair(state, inputs);
 }
@@ -195,6 +216,12 @@ inline void abandon() {
 TORCH_API void recordSourceLocation(Node* n);
 TORCH_API void setRecordSourceLocation(void (*v)(Node*));
 
+// Recording a source location inspects the whole Python stack, which
+// dominates the cost of tracing big models. With an interval of n only every
+// n-th traced node gets a source location, and 0 records none. Defaults to 1.
+TORCH_API void setSourceLocationInterval(size_t interval);
+TORCH_API size_t getSourceLocationInterval();
+
 // NB: those serve both as an intermediate steps in addInputs below,
 // as well as the overloads that terminate template recursion
 void addInputs(Node *n, const char * name, int64_t value);
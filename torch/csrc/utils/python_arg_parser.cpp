@@ -526,6 +526,64 @@ PythonArgParser::PythonArgParser(std::vector<std::string> fmts, bool traceable)
   }
 }
 
+// Note [Overload resolution cache]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Overloads are tried in order until one binds (see Note [Order of overloads
+// matters]), so e.g. x.add(2) checks and rejects the Tensor overloads before
+// it gets to the Scalar one. That is a noticeable part of the cost of calling
+// an op on small tensors.
+//
+// Whether a signature binds a call without keyword arguments only depends on
+// the number of positional arguments, their Python types and, for Variables,
+// on the properties FunctionParameter::check looks at: whether they are
+// zero-dim, require grad or have an integral dtype. Each parser, i.e. each
+// bound function, remembers which signature the last few such combinations
+// resolved to, so that repeated calls go straight to it. The parsers are only
+// used with the GIL held, which also protects their caches.
+enum ResolutionVarFlags : uint8_t {
+  VAR_DEFINED = 1,
+  VAR_ZERO_DIM = 2,
+  VAR_REQUIRES_GRAD = 4,
+  VAR_INTEGRAL = 8,
+};
+
+bool PythonArgParser::ResolutionKey::operator==(const ResolutionKey& other) const {
+  if (nargs != other.nargs) return false;
+  for (ssize_t i = 0; i < nargs; i++) {
+    if (types[i] != other.types[i] || var_flags[i] != other.var_flags[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PythonArgParser::resolution_key(PyObject* args, PyObject* kwargs, ResolutionKey& key, size_t& hash) {
+  auto nargs = PyTuple_GET_SIZE(args);
+  if (nargs > kMaxCachedArgs || (kwargs && PyDict_Size(kwargs) > 0)) {
+    return false;
+  }
+  key.nargs = nargs;
+  hash = nargs;
+  for (ssize_t i = 0; i < nargs; i++) {
+    PyObject* obj = PyTuple_GET_ITEM(args, i);
+    uint8_t flags = 0;
+    if (THPVariable_Check(obj)) {
+      auto& var = ((THPVariable*)obj)->cdata;
+      if (var.defined()) {
+        flags |= VAR_DEFINED;
+        if (var.dim() == 0) flags |= VAR_ZERO_DIM;
+        if (var.requires_grad()) flags |= VAR_REQUIRES_GRAD;
+        if (at::isIntegralType(var.type().scalarType())) flags |= VAR_INTEGRAL;
+      }
+    }
+    key.types[i] = Py_TYPE(obj);
+    key.var_flags[i] = flags;
+    hash = hash * 31 + (reinterpret_cast<uintptr_t>(Py_TYPE(obj)) >> 4);
+    hash = hash * 31 + flags;
+  }
+  return true;
+}
+
 PythonArgs PythonArgParser::raw_parse(PyObject* args, PyObject* kwargs, PyObject* parsed_args[]) {
   if (signatures_.size() == 1) {
     auto& signature = signatures_[0];
@@ -533,9 +591,26 @@ PythonArgs PythonArgParser::raw_parse(PyObject* args, PyObject* kwargs, PyObject
     return PythonArgs(0, traceable, signature, parsed_args);
   }
 
+  ResolutionKey key;
+  size_t hash = 0;
+  CachedResolution* cached = nullptr;
+  if (resolution_key(args, kwargs, key, hash)) {
+    cached = &resolution_cache_[hash % kResolutionCacheSize];
+    if (cached->idx >= 0 && cached->key == key) {
+      auto& signature = signatures_[cached->idx];
+      if (signature.parse(args, kwargs, parsed_args, false)) {
+        return PythonArgs(cached->idx, traceable, signature, parsed_args);
+      }
+    }
+  }
+
   int i = 0;
   for (auto& signature : signatures_) {
     if (signature.parse(args, kwargs, parsed_args, false)) {
+      if (cached) {
+        cached->key = key;
+        cached->idx = i;
+      }
       return PythonArgs(i, traceable, signature, parsed_args);
     }
     i++;
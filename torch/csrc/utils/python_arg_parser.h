@@ -93,10 +93,26 @@ private:
   void print_error(PyObject* args, PyObject* kwargs, PyObject* parsed_args[]);
   PythonArgs raw_parse(PyObject* args, PyObject* kwargs, PyObject* parsed_args[]);
 
+  // See Note [Overload resolution cache]
+  static constexpr int kMaxCachedArgs = 4;
+  static constexpr int kResolutionCacheSize = 8;
+  struct ResolutionKey {
+    ssize_t nargs = -1;
+    PyTypeObject* types[kMaxCachedArgs];
+    uint8_t var_flags[kMaxCachedArgs];
+    bool operator==(const ResolutionKey& other) const;
+  };
+  struct CachedResolution {
+    ResolutionKey key;
+    int idx = -1;
+  };
+  static bool resolution_key(PyObject* args, PyObject* kwargs, ResolutionKey& key, size_t& hash);
+
   std::vector<FunctionSignature> signatures_;
   std::string function_name;
   ssize_t max_args;
   bool traceable;
+  std::array<CachedResolution, kResolutionCacheSize> resolution_cache_;
 };
 
 struct PythonArgs {
@@ -39,6 +39,26 @@ std::vector<TensorGroup> take_tensors(TensorList tensors, size_t size_limit) {
   return results;
 }
 
+Tensor flatten_adjacent_dense_tensors(TensorList tensors) {
+  if (tensors.empty())
+    return Tensor();
+  const auto & first = tensors[0];
+  auto & type = first.type();
+  if (type.is_sparse())
+    return Tensor();
+  auto storage = first.storage();
+  int64_t offset = first.storage_offset();
+  for (const auto & tensor : tensors) {
+    if (&tensor.type() != &type || !tensor.is_contiguous() ||
+        tensor.storage()->pImpl() != storage->pImpl() ||
+        tensor.storage_offset() != offset)
+      return Tensor();
+    offset += tensor.numel();
+  }
+  int64_t numel = offset - first.storage_offset();
+  return type.tensor().set_(*storage, first.storage_offset(), {numel}, {1});
+}
+
 void reorder_tensors_like(std::vector<Tensor>& tensors, TensorList order) {
   AT_ASSERT(tensors.size() == order.size());
   std::unordered_map<at::Type*, std::vector<size_t>> type_indices;
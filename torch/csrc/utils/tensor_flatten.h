@@ -14,6 +14,12 @@ inline at::Tensor flatten_dense_tensors(at::TensorList tensors) {
   return at::cat(fmap(tensors, flatten));
 }
 
+// If the tensors are dense, contiguous, of one type and lie back to back in
+// one storage, returns the 1-d tensor spanning them. Unlike
+// flatten_dense_tensors this doesn't copy, so the result aliases them.
+// Otherwise returns an undefined tensor.
+at::Tensor flatten_adjacent_dense_tensors(at::TensorList tensors);
+
 inline std::vector<at::Tensor> unflatten_dense_tensors(const at::Tensor& flat, at::TensorList tensors) {
   std::vector<at::Tensor> outputs;
   outputs.reserve(tensors.size());
@@ -21,6 +21,7 @@
 #include <ATen/core/optional.h>
 
 #include <stdexcept>
+#include <type_traits>
 #include <vector>
 
 using at::Device;
@@ -190,6 +191,111 @@ void recursive_store(char* data, IntList sizes, IntList strides, int64_t dim,
   }
 }
 
+inline bool is_exact_int(PyObject* obj) {
+#if PY_MAJOR_VERSION == 2
+  return PyInt_CheckExact(obj) || PyLong_CheckExact(obj);
+#else
+  return PyLong_CheckExact(obj);
+#endif
+}
+
+// Whether obj is a nesting of lists and tuples of the given sizes whose
+// elements are all exact Python floats or ints, and which of the two it has
+bool scan_number_list(PyObject* obj, IntList sizes, int64_t dim,
+                      bool& has_float, bool& has_int) {
+  if (!PyList_CheckExact(obj) && !PyTuple_CheckExact(obj)) {
+    return false;
+  }
+  auto n = PySequence_Fast_GET_SIZE(obj);
+  if (n != sizes[dim]) {
+    return false;
+  }
+  PyObject** items = PySequence_Fast_ITEMS(obj);
+  if (dim + 1 < (int64_t)sizes.size()) {
+    for (Py_ssize_t i = 0; i < n; i++) {
+      if (!scan_number_list(items[i], sizes, dim + 1, has_float, has_int)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  for (Py_ssize_t i = 0; i < n; i++) {
+    PyObject* item = items[i];
+    if (PyFloat_CheckExact(item)) {
+      has_float = true;
+    } else if (is_exact_int(item)) {
+      has_int = true;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Stores the elements of a list accepted by scan_number_list contiguously
+// and returns the end of what it wrote
+template <typename scalar_t>
+scalar_t* store_number_list(scalar_t* data, PyObject* obj, IntList sizes, int64_t dim) {
+  auto n = PySequence_Fast_GET_SIZE(obj);
+  PyObject** items = PySequence_Fast_ITEMS(obj);
+  if (dim + 1 < (int64_t)sizes.size()) {
+    for (Py_ssize_t i = 0; i < n; i++) {
+      data = store_number_list(data, items[i], sizes, dim + 1);
+    }
+    return data;
+  }
+  for (Py_ssize_t i = 0; i < n; i++) {
+    PyObject* item = items[i];
+    if (std::is_floating_point<scalar_t>::value) {
+      // ints are converted like store_scalar does
+      double value = PyFloat_CheckExact(item) ? PyFloat_AS_DOUBLE(item) : THPUtils_unpackDouble(item);
+      *data++ = static_cast<scalar_t>(value);
+    } else {
+      *data++ = static_cast<scalar_t>(THPUtils_unpackLong(item));
+    }
+  }
+  return data;
+}
+
+// Fast path for rectangular (nested) lists of Python floats and ints, the
+// usual input of torch.tensor(): infer_scalar_type and recursive_store go
+// through the sequence protocol and a switch on the scalar type for every
+// element, this makes one pass to check the elements and one to store them.
+// Returns an undefined tensor for anything else, e.g. bools, numpy scalars,
+// ragged lists or a scalar_type other than Float, Double, Long and Int, which
+// the generic path handles, including its error messages.
+Tensor new_from_number_list(PyObject* data, IntList sizes, at::optional<ScalarType> scalar_type) {
+  if (sizes.empty()) {
+    return Tensor();
+  }
+  bool has_float = false;
+  bool has_int = false;
+  if (!scan_number_list(data, sizes, 0, has_float, has_int)) {
+    return Tensor();
+  }
+  if (!has_float && !has_int) {
+    return Tensor();
+  }
+  if (!scalar_type) {
+    // same as infer_scalar_type
+    scalar_type = has_float ? torch::tensors::get_default_tensor_type().scalarType() : ScalarType::Long;
+  }
+  auto is_integral = *scalar_type == ScalarType::Long || *scalar_type == ScalarType::Int;
+  auto is_floating = *scalar_type == ScalarType::Float || *scalar_type == ScalarType::Double;
+  if (!is_floating && !(is_integral && !has_float)) {
+    return Tensor();
+  }
+  auto tensor = autograd::make_variable(CPU(*scalar_type).tensor(sizes), /*requires_grad=*/false);
+  switch (*scalar_type) {
+    case ScalarType::Float: store_number_list((float*)tensor.data_ptr(), data, sizes, 0); break;
+    case ScalarType::Double: store_number_list((double*)tensor.data_ptr(), data, sizes, 0); break;
+    case ScalarType::Long: store_number_list((int64_t*)tensor.data_ptr(), data, sizes, 0); break;
+    case ScalarType::Int: store_number_list((int32_t*)tensor.data_ptr(), data, sizes, 0); break;
+    default: AT_ASSERT(false);
+  }
+  return tensor;
+}
+
 Tensor internal_new_from_data(const Type & type, at::optional<Device> device_opt, PyObject* data,
                                      bool copy_variables, bool copy_numpy,
                                      bool type_inference) {
@@ -224,13 +330,31 @@ Tensor internal_new_from_data(const Type & type, at::optional<Device> device_opt
   }
 #endif
 
+  // bytes are sequences of ints to torch.tensor, and looking up
+  // __array_interface__ on the usual lists and numbers would be wasted
+  if (!PyList_Check(data) && !PyTuple_Check(data) && !PyFloat_Check(data) &&
+      !THPUtils_checkLong(data) && !PyBool_Check(data) &&
+      !PyBytes_Check(data) && !PyByteArray_Check(data)) {
+    auto buffer = tensor_from_buffer(data);
+    if (buffer.defined()) {
+      auto tensor = autograd::make_variable(buffer, /*requires_grad=*/false);
+      const auto& type_to_use = type_inference ? type.toScalarType(tensor.type().scalarType()) : type;
+      return copy_numpy ? new_with_tensor_copy(type_to_use, tensor, device_index) :
+                          new_with_type_conversion(type_to_use, tensor, device_index);
+    }
+  }
+
   auto sizes = compute_sizes(data);
-  ScalarType scalarType = type_inference ? infer_scalar_type(data) : type.scalarType();
-  auto tensor = autograd::make_variable(CPU(scalarType).tensor(sizes), /*requires_grad=*/false);
-  recursive_store(
-      (char*)tensor.data_ptr(), tensor.sizes(), tensor.strides(), 0,
-      scalarType, tensor.type().elementSizeInBytes(), data);
-  const auto& type_to_use = type_inference ? type.toScalarType(scalarType) : type;
+  auto tensor = new_from_number_list(
+      data, sizes, type_inference ? at::nullopt : at::make_optional(type.scalarType()));
+  if (!tensor.defined()) {
+    ScalarType scalarType = type_inference ? infer_scalar_type(data) : type.scalarType();
+    tensor = autograd::make_variable(CPU(scalarType).tensor(sizes), /*requires_grad=*/false);
+    recursive_store(
+        (char*)tensor.data_ptr(), tensor.sizes(), tensor.strides(), 0,
+        scalarType, tensor.type().elementSizeInBytes(), data);
+  }
+  const auto& type_to_use = type_inference ? type.toScalarType(tensor.type().scalarType()) : type;
   return new_with_type_conversion(type_to_use, tensor, device_index);
 }
 
@@ -1,6 +1,18 @@
 #include "tensor_numpy.h"
 
+#include "torch/csrc/Exceptions.h"
+#include "torch/csrc/utils/auto_gil.h"
 #include "torch/csrc/utils/numpy_stub.h"
+#include "torch/csrc/utils/object_ptr.h"
+#include "torch/csrc/utils/python_numbers.h"
+#include "torch/csrc/utils/python_strings.h"
+
+#include <ATen/core/optional.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <vector>
 
 #ifndef USE_NUMPY
 namespace torch { namespace utils {
@@ -182,3 +194,218 @@ ScalarType numpy_dtype_to_aten(int dtype) {
 }} // namespace torch::utils
 
 #endif  // USE_NUMPY
+
+namespace torch { namespace utils {
+
+namespace {
+
+bool is_little_endian() {
+  uint16_t one = 1;
+  return *reinterpret_cast<uint8_t*>(&one) == 1;
+}
+
+// The scalar type of elements of the given kind, as in the typestr of the
+// array interface ('f'loat, signed 'i'nt, 'u'nsigned int or 'b'ool), and
+// size in bytes
+at::optional<at::ScalarType> scalar_type_of(char kind, size_t itemsize) {
+  switch (kind) {
+    case 'f':
+      if (itemsize == 2) return at::kHalf;
+      if (itemsize == 4) return at::kFloat;
+      if (itemsize == 8) return at::kDouble;
+      break;
+    case 'i':
+      if (itemsize == 1) return at::kChar;
+      if (itemsize == 2) return at::kShort;
+      if (itemsize == 4) return at::kInt;
+      if (itemsize == 8) return at::kLong;
+      break;
+    case 'u':
+    case 'b':
+      if (itemsize == 1) return at::kByte;
+      break;
+  }
+  return at::nullopt;
+}
+
+// The scalar type of a buffer with the given struct module format, which
+// tensors only have an equivalent of for single native-endian elements
+at::optional<at::ScalarType> scalar_type_of_format(const char* format, size_t itemsize) {
+  if (!format) {
+    return scalar_type_of('u', itemsize);
+  }
+  switch (*format) {
+    case '@':
+    case '=':
+      format++;
+      break;
+    case '<':
+    case '>':
+    case '!':
+      if ((*format == '<') != is_little_endian()) {
+        return at::nullopt;
+      }
+      format++;
+      break;
+  }
+  if (format[0] == '\0' || format[1] != '\0') {
+    return at::nullopt;
+  }
+  switch (format[0]) {
+    case 'e':
+    case 'f':
+    case 'd':
+      return scalar_type_of('f', itemsize);
+    case 'b':
+    case 'h':
+    case 'i':
+    case 'l':
+    case 'q':
+      return scalar_type_of('i', itemsize);
+    case 'B':
+      return scalar_type_of('u', itemsize);
+    case '?':
+      return scalar_type_of('b', itemsize);
+  }
+  return at::nullopt;
+}
+
+// Converts byte strides to element strides, which have to be non-negative
+bool to_element_strides(std::vector<int64_t>& strides, int64_t itemsize) {
+  for (auto& stride : strides) {
+    if (stride < 0 || stride % itemsize != 0) {
+      return false;
+    }
+    stride /= itemsize;
+  }
+  return true;
+}
+
+std::vector<int64_t> contiguous_strides(const std::vector<int64_t>& sizes) {
+  std::vector<int64_t> strides(sizes.size());
+  int64_t stride = 1;
+  for (int64_t i = (int64_t)sizes.size() - 1; i >= 0; i--) {
+    strides[i] = stride;
+    stride *= std::max<int64_t>(sizes[i], 1);
+  }
+  return strides;
+}
+
+at::Tensor tensor_from_buffer_protocol(PyObject* obj) {
+  // tensors are always writable, so read-only buffers (e.g. of bytes) are
+  // left to the caller to copy
+  std::unique_ptr<Py_buffer> view(new Py_buffer());
+  if (PyObject_GetBuffer(obj, view.get(), PyBUF_RECORDS) != 0) {
+    PyErr_Clear();
+    return at::Tensor();
+  }
+  auto scalar_type = scalar_type_of_format(view->format, view->itemsize);
+  std::vector<int64_t> sizes(view->shape, view->shape + view->ndim);
+  std::vector<int64_t> strides(view->strides, view->strides + view->ndim);
+  if (!scalar_type || !to_element_strides(strides, view->itemsize)) {
+    PyBuffer_Release(view.get());
+    return at::Tensor();
+  }
+  auto raw_view = view.release();
+  return at::CPU(*scalar_type).tensorFromBlob(raw_view->buf, sizes, strides, [raw_view](void* data) {
+    AutoGIL gil;
+    PyBuffer_Release(raw_view);
+    delete raw_view;
+  });
+}
+
+// Only handles interfaces whose data is a pointer, not a buffer object
+at::Tensor tensor_from_array_interface(PyObject* obj) {
+  THPObjectPtr interface(PyObject_GetAttrString(obj, "__array_interface__"));
+  if (!interface) {
+    PyErr_Clear();
+    return at::Tensor();
+  }
+  if (!PyDict_Check(interface.get())) {
+    return at::Tensor();
+  }
+  // borrowed references
+  PyObject* shape = PyDict_GetItemString(interface.get(), "shape");
+  PyObject* typestr = PyDict_GetItemString(interface.get(), "typestr");
+  PyObject* data = PyDict_GetItemString(interface.get(), "data");
+  PyObject* byte_strides = PyDict_GetItemString(interface.get(), "strides");
+  if (!shape || !PyTuple_Check(shape) || !typestr || !THPUtils_checkString(typestr) ||
+      !data || !PyTuple_Check(data) || PyTuple_GET_SIZE(data) != 2) {
+    return at::Tensor();
+  }
+
+  // e.g. "<f4"
+  auto type = THPUtils_unpackString(typestr);
+  if (type.size() < 3) {
+    return at::Tensor();
+  }
+  if (type[0] == '<' || type[0] == '>') {
+    if ((type[0] == '<') != is_little_endian()) {
+      return at::Tensor();
+    }
+  } else if (type[0] != '|' && type[0] != '=') {
+    return at::Tensor();
+  }
+  char* end;
+  auto itemsize = std::strtoul(type.c_str() + 2, &end, 10);
+  auto scalar_type = scalar_type_of(type[1], itemsize);
+  if (*end != '\0' || !scalar_type) {
+    return at::Tensor();
+  }
+
+  std::vector<int64_t> sizes;
+  for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(shape); i++) {
+    PyObject* size = PyTuple_GET_ITEM(shape, i);
+    if (!THPUtils_checkLong(size)) {
+      return at::Tensor();
+    }
+    sizes.push_back(THPUtils_unpackLong(size));
+  }
+  std::vector<int64_t> strides;
+  if (!byte_strides || byte_strides == Py_None) {
+    strides = contiguous_strides(sizes);
+  } else {
+    if (!PyTuple_Check(byte_strides) || PyTuple_GET_SIZE(byte_strides) != (Py_ssize_t)sizes.size()) {
+      return at::Tensor();
+    }
+    for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(byte_strides); i++) {
+      PyObject* stride = PyTuple_GET_ITEM(byte_strides, i);
+      if (!THPUtils_checkLong(stride)) {
+        return at::Tensor();
+      }
+      strides.push_back(THPUtils_unpackLong(stride));
+    }
+    if (!to_element_strides(strides, itemsize)) {
+      return at::Tensor();
+    }
+  }
+
+  PyObject* address = PyTuple_GET_ITEM(data, 0);
+  int read_only = PyObject_IsTrue(PyTuple_GET_ITEM(data, 1));
+  if (read_only < 0) {
+    throw python_error();
+  }
+  if (!THPUtils_checkLong(address) || read_only) {
+    return at::Tensor();
+  }
+  void* data_ptr = PyLong_AsVoidPtr(address);
+  if (!data_ptr && PyErr_Occurred()) {
+    throw python_error();
+  }
+  Py_INCREF(obj);
+  return at::CPU(*scalar_type).tensorFromBlob(data_ptr, sizes, strides, [obj](void* data) {
+    AutoGIL gil;
+    Py_DECREF(obj);
+  });
+}
+
+} // anonymous namespace
+
+at::Tensor tensor_from_buffer(PyObject* obj) {
+  if (PyObject_CheckBuffer(obj)) {
+    return tensor_from_buffer_protocol(obj);
+  }
+  return tensor_from_array_interface(obj);
+}
+
+}} // namespace torch::utils
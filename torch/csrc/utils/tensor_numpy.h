@@ -10,4 +10,11 @@ at::Tensor tensor_from_numpy(PyObject* obj);
 
 at::ScalarType numpy_dtype_to_aten(int dtype);
 
+// Wraps the memory of an object that exposes it through the buffer protocol
+// or __array_interface__, e.g. array.array, memoryview or arrays of other
+// libraries, without copying it and without needing NumPy. Returns an
+// undefined tensor if obj doesn't, if the memory is read-only, or if its
+// element type or strides have no tensor equivalent.
+at::Tensor tensor_from_buffer(PyObject* obj);
+
 }} // namespace torch::utils
@@ -19,6 +19,12 @@ from torch._six import raise_from
 from subprocess import Popen, PIPE
 from multiprocessing.util import register_after_fork as _register_after_fork
 
+# Have the driver load each kernel when it is first launched instead of all of
+# them when the context of a device is created, which costs seconds and a lot
+# of device memory (CUDA 11.7 and later, older versions ignore it). It is only
+# read when the driver is initialized, so it has to be set before any CUDA call.
+os.environ.setdefault('CUDA_MODULE_LOADING', 'LAZY')
+
 _initialized = False
 _queued_calls = []  # don't invoke these until initialization occurs
 _in_bad_fork = False  # this global is also used in torch.manual_seed
@@ -351,18 +357,29 @@ def current_blas_handle():
     return torch._C._cuda_getCurrentBlasHandle()
 
 
-def empty_cache():
+def empty_cache(device=None):
     r"""Releases all unoccupied cached memory currently held by the caching
     allocator so that those can be used in other GPU application and visible in
     `nvidia-smi`.
 
+    Only segments that are entirely free can be released. Free memory in segments
+    that also hold tensors stays cached, and is reported as ``inactive_split`` by
+    :meth:`~torch.cuda.memory_stats`.
+
+    Arguments:
+        device (int, optional): selected device. Releases the cache of all
+                                devices if :attr:`device` is ``None`` (default).
+
     .. note::
         :meth:`~torch.cuda.empty_cache` doesn't increase the amount of GPU
         memory available for PyTorch. See :ref:`cuda-memory-management` for
         more details about GPU memory management.
     """
     if _initialized:
-        torch._C._cuda_emptyCache()
+        if device is None:
+            torch._C._cuda_emptyCache()
+        else:
+            torch._C._cuda_emptyDeviceCache(device)
 
 
 def memory_allocated(device=None):
@@ -443,6 +460,66 @@ def max_memory_cached(device=None):
     return torch._C._cuda_maxMemoryCached(device)
 
 
+def memory_stats(device=None):
+    r"""Returns a dictionary of statistics of the caching allocator for a given
+    device. All amounts are in bytes.
+
+    - ``allocated``, ``max_allocated``: memory occupied by tensors, as returned
+      by :meth:`~torch.cuda.memory_allocated` and
+      :meth:`~torch.cuda.max_memory_allocated`.
+    - ``active``: allocated memory, plus memory of freed tensors that is still
+      in use by another stream.
+    - ``reserved``, ``max_reserved``: memory managed by the caching allocator, as
+      returned by :meth:`~torch.cuda.memory_cached` and
+      :meth:`~torch.cuda.max_memory_cached`.
+    - ``inactive_split``: cached memory that is free, but part of a segment that
+      is also allocated, so :meth:`~torch.cuda.empty_cache` can't release it.
+      A large value indicates fragmentation.
+    - ``num_segments``: number of segments obtained with ``cudaMalloc``.
+    - ``num_alloc_retries``: number of times ``cudaMalloc`` failed, and was only
+      retried after releasing the cache.
+    - ``num_stream_events``: number of events recorded to keep memory freed
+      while in use by other streams (see :meth:`~torch.Tensor.record_stream`)
+      from being reused too early.
+    - ``external``: memory allocated outside of the caching allocator that is
+      used by tensors, e.g. tensors imported with
+      :func:`torch.utils.dlpack.from_dlpack`. Not included in ``allocated``.
+
+    Arguments:
+        device (int, optional): selected device. Returns statistics for the
+                                current device, given by
+                                :meth:`~torch.cuda.current_device`, if
+                                :attr:`device` is ``None`` (default).
+
+    .. note::
+        See :ref:`cuda-memory-management` for more details about GPU memory
+        management.
+    """
+    if device is None:
+        device = current_device()
+    return torch._C._cuda_memoryStats(device)
+
+
+@contextlib.contextmanager
+def stream_use_batch():
+    r"""Context-manager that batches the synchronization of tensors freed while
+    in use by other streams.
+
+    Freeing a tensor that was marked with :meth:`~torch.Tensor.record_stream`
+    normally records an event on each stream that used it, and its memory is
+    reused once the events complete. Inside this context, the events are
+    recorded only on exit, once per stream for all tensors freed within it.
+    The memory of these tensors can't be reused before the context exits.
+    Contexts may be nested; the events are recorded when the outermost exits.
+    """
+    _lazy_init()
+    torch._C._cuda_beginStreamUseBatch()
+    try:
+        yield
+    finally:
+        torch._C._cuda_endStreamUseBatch()
+
+
 def _host_allocator():
     _lazy_init()
     return torch._C._cuda_cudaHostAllocator()
@@ -24,7 +24,8 @@ def broadcast(tensor, devices):
 def broadcast_coalesced(tensors, devices, buffer_size=10485760):
     """Broadcasts a sequence tensors to the specified GPUs.
     Small tensors are first coalesced into a buffer to reduce the number
-    of synchronizations.
+    of synchronizations. With NCCL, coalescing a buffer overlaps
+    broadcasting the previous one.
 
     Arguments:
         tensors (sequence): tensors to broadcast.
@@ -310,7 +310,7 @@ def all_reduce_multigpu(tensor_list, op=reduce_op.SUM, group=group.WORLD):
     return torch._C._dist_all_reduce_multigpu(tensor_list, op, group)
 
 
-def all_reduce(tensor, op=reduce_op.SUM, group=group.WORLD):
+def all_reduce(tensor, op=reduce_op.SUM, group=group.WORLD, async_op=False):
     r"""Reduces the tensor data across all machines in such a way that all get
     the final result.
 
@@ -322,9 +322,17 @@ def all_reduce(tensor, op=reduce_op.SUM, group=group.WORLD):
         op (optional): One of the values from ``torch.distributed.reduce_op``
             enum.  Specifies an operation used for element-wise reductions.
         group (optional): Group of the collective.
+        async_op (bool, optional): Whether to return immediately, so that the
+            reduction overlaps with other work. :attr:`tensor` must not be
+            used until the returned request completes.
+
+    Returns:
+        A distributed request object if ``async_op`` is set, None otherwise.
     """
     assert torch.distributed._initialized == _INITIALIZED_PG, \
         "collective only supported in process-group mode"
+    if async_op:
+        return _DistributedRequest(torch._C._dist_iall_reduce(tensor, op, group))
     return torch._C._dist_all_reduce(tensor, op, group)
 
 
@@ -38,9 +38,19 @@ def scope(scope_name):
             tracing_state.pop_scope()
 
 
-def load(filename):
+def load(filename, mmap=False):
+    r"""
+    Loads a ScriptModule saved with ``save``.
+
+    Arguments:
+        filename (str): the file to load from.
+        mmap (bool, optional): if ``True``, the parameters are backed by a
+            private memory mapping of the file instead of being read into
+            memory, so only the pages that are used get read. The file must
+            not be modified while the module is alive. Default: ``False``.
+    """
     m = ScriptModule()
-    m._load(filename)
+    m._load(filename, map_storages=mmap)
     return m
 
 
@@ -412,6 +422,61 @@ def batch(batch_size=1, optimize=True, _frames_up=0):
     return decorator
 
 
+def batch_gradient(batch_size=1, optimize=True, _frames_up=0):
+    r"""
+    Like :func:`batch`, but the decorated function takes a gradient for each
+    output of ``fn`` after its inputs, and returns the outputs of ``fn``
+    followed by the gradients of its inputs, all computed in one batched pass.
+    Tensors (e.g. shared weights) are expanded to the batch, so their
+    gradients are per example.
+    """
+    def decorator(fn):
+        import torch.jit.batchop
+        mod = script(fn, optimize, _frames_up)
+        res_graph = torch.to_batch_gradient_graph(mod.graph)
+        res_mod = ScriptModule()
+        res_mod._create_method_from_graph('forward', res_graph)
+
+        def wrapper(*args):
+            new_args = []
+            for arg in args:
+                if isinstance(arg, torch.Tensor):
+                    arg = BatchTensor(arg, batch_size)
+                new_args.extend([arg.get_data(), arg.get_mask(), arg.get_dims()])
+            res = res_mod(*new_args)
+            return [BatchTensor(*res[i * 3: i * 3 + 3]) for i in range(len(res) // 3)]
+        wrapper.__doc__ = fn.__doc__
+        return wrapper
+    return decorator
+
+
+def batching_executor(fn, dims, max_batch_size=32, max_delay=1e-3, optimize=True, _frames_up=0):
+    r"""
+    Returns a callable that runs ``fn`` on a single example at a time, but
+    coalesces the calls made concurrently (e.g. by the threads of an inference
+    server) into batches that run :func:`batch`'s transformation of ``fn``
+    once. Gradients are not recorded.
+
+    Arguments:
+        fn: the function to run; all its inputs and outputs must be tensors.
+        dims (list of list of bool): for each input of ``fn``, whether each of
+            its dimensions may have a different size in different calls.
+            The other dimensions must be the same in all the calls batched
+            together; calls that don't match the first one of their batch fail.
+        max_batch_size (int): the most calls in a batch.
+        max_delay (float): how long, in seconds, a call may wait for more
+            calls to batch with.
+
+    The callable takes the inputs of ``fn`` without a batch dimension and
+    returns its outputs without one. It releases the GIL while it waits.
+    """
+    import torch.jit.batchop
+    mod = script(fn, optimize, _frames_up)
+    res_graph = torch.to_batch_graph(mod.graph)
+    dims = [torch.tensor(d, dtype=torch.uint8) for d in dims]
+    return torch._C._jit.BatchingExecutor(res_graph, dims, max_batch_size, max_delay)
+
+
 # These OrderedDictWrapper classes replace the actual OrderedDicts in
 # module with versions that get/set properties inside of script::Module.
 # This allows us to reuse most of nn.Module while still storing the
@@ -22,6 +22,12 @@ def batch_relu(data, mask, dims):
     return data, mask, dims
 
 
+@torch.jit.script
+def batch_exp(data, mask, dims):
+    data = torch.exp(data)
+    return data, mask, dims
+
+
 @torch.jit.script
 def batch_neg(data, mask, dims):
     data = torch.neg(data)
@@ -301,6 +307,14 @@ def batch_unsqueeze(data, mask, dims, dim_):
     return data, mask, dims
 
 
+@torch.jit.script
+def batch_t(data, mask, dims):
+    data = data.transpose(1, 2)
+    mask = mask.transpose(1, 2)
+    dims = torch.cat((dims[1:2], dims[:1]))
+    return data, mask, dims
+
+
 @torch.jit.script
 def batch_argmax(data, mask, dims, dim_, keepdim_):
     dim = int(dim_)
@@ -487,6 +501,7 @@ def batch_from_scalar_tensor(data):
 torch.register_batch_operator("tanh", batch_tanh.graph)
 torch.register_batch_operator("sigmoid", batch_sigmoid.graph)
 torch.register_batch_operator("relu", batch_relu.graph)
+torch.register_batch_operator("exp", batch_exp.graph)
 torch.register_batch_operator("neg", batch_neg.graph)
 torch.register_batch_operator("neg", batch_neg_scalar.graph)
 torch.register_batch_operator("add", batch_add.graph)
@@ -517,6 +532,7 @@ torch.register_batch_operator("size", batch_size.graph)
 torch.register_batch_operator("dim", batch_dim.graph)
 torch.register_batch_operator("squeeze", batch_squeeze.graph)
 torch.register_batch_operator("unsqueeze", batch_unsqueeze.graph)
+torch.register_batch_operator("t", batch_t.graph)
 torch.register_batch_operator("argmax", batch_argmax.graph)
 torch.register_batch_operator("topk", batch_topk.graph)
 torch.register_batch_operator("softmax", batch_softmax.graph)
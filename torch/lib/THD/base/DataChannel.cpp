@@ -15,6 +15,15 @@
 #include <tuple>
 
 namespace thd {
+namespace {
+
+// Request of an operation that has already completed when it was issued.
+struct CompletedRequest : DataChannel::Request {
+  bool isCompleted() override { return true; }
+  void wait() override {}
+};
+
+} // namespace
 
 #define GET_CONFIG getInitConfig(init_method, world_size, group_name, rank)
 DataChannel* DataChannel::newChannel(THDChannelType type, std::string init_method,
@@ -58,6 +67,14 @@ DataChannel* DataChannel::newChannel(THDChannelType type, std::string init_metho
 #undef GET_CONFIG
 
 
+DataChannel::Request* DataChannel::iallReduce(at::Tensor& data,
+                                              THDReduceOp operation,
+                                              THDGroup group_id) {
+  allReduce(data, operation, group_id);
+  return new CompletedRequest();
+}
+
+
 DataChannel::Group::Group()
 {}
 
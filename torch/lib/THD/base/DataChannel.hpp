@@ -113,6 +113,13 @@ struct DataChannel {
                          THDGroup group_id = THDGroupWORLD) = 0;
   virtual void allReduce(at::Tensor& data, THDReduceOp operation,
                          THDGroup group_id = THDGroupWORLD) = 0;
+  /**
+   * Asynchronous version of `allReduce`, `data` must not be used until the
+   * returned request completes. The default implementation runs `allReduce`
+   * synchronously and returns a completed request.
+   */
+  virtual Request* iallReduce(at::Tensor& data, THDReduceOp operation,
+                              THDGroup group_id = THDGroupWORLD);
   /**
    * Reduce multiple GPUs on a number of nodes
    * data[0]'s GPU in dstRank will receive the result
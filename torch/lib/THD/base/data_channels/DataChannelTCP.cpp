@@ -16,6 +16,11 @@
 namespace thd {
 namespace {
 
+// Tensors of at least this size are allreduced with the ring algorithm.
+constexpr uint64_t RING_ALLREDUCE_MIN_BYTES = 256 * 1024;
+// Size of the chunks the ring algorithm forwards to the next process.
+constexpr uint64_t RING_ALLREDUCE_CHUNK_BYTES = 256 * 1024;
+
 inline uint32_t log2ceil(uint32_t value) {
   uint32_t dim = 0;
 #if defined(__GNUC__)
@@ -69,6 +74,7 @@ DataChannelTCP::DataChannelTCP(InitMethod::Config config, int timeout)
   , _timeout(timeout)
   , _processes(config.world_size)
   , _poll_events(nullptr)
+  , _pending_collectives(0)
 {
   _rank = config.rank;
 
@@ -258,6 +264,7 @@ void DataChannelTCP::allGather(std::vector<at::Tensor>& output,
    * efficient also for small data (< 512 KB).
    */
 
+  _waitCollectives();
   std::lock_guard<std::mutex> lock(_mutex);
 
   const auto& group = _groups.at(group_id);
@@ -292,6 +299,7 @@ void DataChannelTCP::allGather(std::vector<at::Tensor>& output,
 
 void DataChannelTCP::gather(std::vector<at::Tensor>& output,
                             at::Tensor& input, rank_type dst_rank, THDGroup group_id) {
+  _waitCollectives();
   std::lock_guard<std::mutex> lock(_mutex);
 
   const auto& group = _groups.at(group_id);
@@ -327,6 +335,7 @@ void DataChannelTCP::gather(std::vector<at::Tensor>& output,
 void DataChannelTCP::scatter(std::vector<at::Tensor>& input,
                              at::Tensor& output, rank_type src_rank,
                              THDGroup group_id) {
+  _waitCollectives();
   std::lock_guard<std::mutex> lock(_mutex);
 
   const auto& group = _groups.at(group_id);
@@ -361,12 +370,43 @@ void DataChannelTCP::scatter(std::vector<at::Tensor>& input,
 
 void DataChannelTCP::allReduce(at::Tensor& data, THDReduceOp operation,
                                THDGroup group_id) {
+  _waitCollectives();
+  _allReduce(data, operation, group_id);
+}
+
+
+DataChannelTCP::RequestTCP* DataChannelTCP::iallReduce(at::Tensor& data,
+                                                       THDReduceOp operation,
+                                                       THDGroup group_id) {
+  /*
+   * Collectives are run one after another by the collective worker, so they
+   * are issued in the same order on all processes. Point-to-point operations
+   * are not ordered with the collectives which are still in flight.
+   */
+  ++_pending_collectives;
+  auto request = _collective_worker.push([this, data, operation, group_id]{
+    auto tensor = data;
+    try {
+      this->_allReduce(tensor, operation, group_id);
+    } catch (...) {
+      --this->_pending_collectives;
+      throw;
+    }
+    --this->_pending_collectives;
+  });
+  return new DataChannelTCP::RequestTCP(std::move(request));
+}
+
+
+void DataChannelTCP::_allReduce(at::Tensor& data, THDReduceOp operation,
+                                THDGroup group_id) {
   /*
-   * Allreduce implementation is recursive doubling algorithm. It is good
-   * algorithm for small sizes of message but other (theoratically better)
-   * implementations could not be addapted because of non-commutative
-   * operations on tensors (operation cannot be commutative because this could
-   * introduce different numerical errors on different workers).
+   * Allreduce of small tensors is recursive doubling algorithm, large tensors
+   * use ring algorithm (see `_ringAllReduce`). Recursive doubling is good
+   * algorithm for small sizes of message. Reduction operations are applied
+   * in the same order on all workers, because of non-commutative operations
+   * on tensors (operation cannot be commutative because this could introduce
+   * different numerical errors on different workers).
    *
    * More about efficiency can be found here:
    *   > http://www.mcs.anl.gov/~thakur/papers/ijhpca-coll.pdf (section 4.5)
@@ -386,6 +426,11 @@ void DataChannelTCP::allReduce(at::Tensor& data, THDReduceOp operation,
     return;
 
   uint64_t tensor_bytes = data.type().elementSizeInBytes() * data.numel();
+  if (group.size() > 1 && tensor_bytes >= RING_ALLREDUCE_MIN_BYTES) {
+    _ringAllReduce(data, operation, group, group_rank);
+    return;
+  }
+
   auto tmp_tensor = data.clone();
 
   auto pof2 = pow2(group.size());
@@ -437,6 +482,110 @@ void DataChannelTCP::allReduce(at::Tensor& data, THDReduceOp operation,
 }
 
 
+void DataChannelTCP::_ringAllReduce(at::Tensor& data, THDReduceOp operation,
+                                    const DataChannel::Group& group,
+                                    rank_type group_rank) {
+  /*
+   * Ring allreduce is reduce-scatter followed by allgather. Tensor is split
+   * into one segment per process. In step `s` (out of 2 * (size - 1)) process
+   * sends segment `rank - s` to its right neighbour and receives segment
+   * `rank - s - 1` from its left neighbour. During the first `size - 1` steps
+   * received segments are reduced into the local data, after that every
+   * process holds one fully reduced segment, which is then passed along the
+   * ring. Every segment is reduced by a single chain of processes and then
+   * copied, so all workers end up with exactly the same result.
+   *
+   * Segments are split into chunks and every chunk is forwarded as soon as it
+   * has been received (and reduced), so sending, receiving and reducing of
+   * different chunks overlap. The next chunk is always being received while
+   * the current one is reduced.
+   *
+   * More about efficiency can be found here:
+   *   > http://www.mcs.anl.gov/~thakur/papers/ijhpca-coll.pdf (section 4.5)
+   */
+
+  const uint64_t size = group.size();
+  const uint64_t steps = 2 * (size - 1);
+  const int64_t numel = data.numel();
+  const int64_t chunk_numel = std::max<int64_t>(
+    1, RING_ALLREDUCE_CHUNK_BYTES / data.type().elementSizeInBytes());
+  auto flat = data.view({numel});
+
+  // Returns chunks of segment `segment % size` of the tensor.
+  auto segment_chunks = [&](uint64_t segment) {
+    segment %= size;
+    int64_t begin = numel * segment / size;
+    int64_t end = numel * (segment + 1) / size;
+    std::vector<at::Tensor> chunks;
+    for (int64_t offset = begin; offset < end; offset += chunk_numel)
+      chunks.push_back(flat.narrow(0, offset, std::min(chunk_numel, end - offset)));
+    return chunks;
+  };
+
+  auto left = group.mustGetGlobalRank((group_rank + size - 1) % size);
+  auto right = group.mustGetGlobalRank((group_rank + 1) % size);
+
+  struct Transfer {
+    uint64_t step;
+    size_t index;
+    at::Tensor chunk;  // part of the data
+    at::Tensor target; // where the chunk is received to
+  };
+
+  std::vector<Transfer> transfers;
+  for (uint64_t step = 0; step < steps; ++step) {
+    auto chunks = segment_chunks(group_rank + 2 * size - step - 1);
+    for (size_t index = 0; index < chunks.size(); ++index)
+      transfers.push_back({step, index, chunks[index], at::Tensor()});
+  }
+
+  // `sends[s][i]` sends i-th chunk of the segment forwarded in step `s`.
+  std::vector<std::vector<req_ptr>> sends(steps);
+  for (auto& chunk : segment_chunks(group_rank))
+    sends[0].emplace_back(isend(chunk, right));
+
+  // Chunks which have to be reduced are received into double buffer.
+  at::Tensor buffers[2];
+  for (auto& buffer : buffers)
+    buffer = data.type().tensor({std::min(chunk_numel, numel)});
+
+  auto start_receive = [&](size_t i) {
+    auto& transfer = transfers[i];
+    if (transfer.step < size - 1) {
+      transfer.target = buffers[i % 2].narrow(0, 0, transfer.chunk.numel());
+    } else {
+      // Chunk was sent in reduce-scatter phase, it must not be overwritten
+      // before that send is finished.
+      sends[transfer.step - (size - 1)][transfer.index]->wait();
+      transfer.target = transfer.chunk;
+    }
+    return req_ptr(ireceive(transfer.target, left));
+  };
+
+  req_ptr next_receive;
+  if (!transfers.empty())
+    next_receive = start_receive(0);
+
+  for (size_t i = 0; i < transfers.size(); ++i) {
+    auto receive_request = std::move(next_receive);
+    if (i + 1 < transfers.size())
+      next_receive = start_receive(i + 1);
+    receive_request->wait();
+
+    auto& transfer = transfers[i];
+    if (transfer.step < size - 1)
+      _reduce(transfer.chunk, transfer.target, operation);
+    if (transfer.step + 1 < steps)
+      sends[transfer.step + 1].emplace_back(isend(transfer.chunk, right));
+  }
+
+  for (auto& step_sends : sends) {
+    for (auto& send_request : step_sends)
+      send_request->wait();
+  }
+}
+
+
 void DataChannelTCP::reduce(at::Tensor& data, THDReduceOp operation,
                             rank_type dst_rank, THDGroup group_id) {
   /*
@@ -444,6 +593,7 @@ void DataChannelTCP::reduce(at::Tensor& data, THDReduceOp operation,
    * order and direction of communication.
    */
 
+  _waitCollectives();
   std::lock_guard<std::mutex> lock(_mutex);
 
   const auto& group = _groups.at(group_id);
@@ -493,6 +643,7 @@ void DataChannelTCP::broadcast(at::Tensor& data, rank_type src_rank,
    * virtual ones where `virtual_rank` for `src_rank` is 0.
    */
 
+  _waitCollectives();
   std::lock_guard<std::mutex> lock(_mutex);
 
   const auto& group = _groups.at(group_id);
@@ -622,6 +773,7 @@ void DataChannelTCP::barrier(THDGroup group_id) {
    * we do recv asynchronously (thread), send byte and then wait for recv to complete.
    */
 
+  _waitCollectives();
   std::lock_guard<std::mutex> lock(_mutex);
 
   const auto& group = _groups.at(group_id);
@@ -652,6 +804,15 @@ void DataChannelTCP::barrier(THDGroup group_id) {
 }
 
 
+void DataChannelTCP::_waitCollectives() {
+  if (_pending_collectives == 0)
+    return;
+
+  // Worker runs tasks in order, so this finishes after all pending ones.
+  _collective_worker.push([]{}).wait();
+}
+
+
 THDGroup DataChannelTCP::newGroup(const std::vector<rank_type>& ranks) {
   auto new_group = DataChannel::Group(ranks, _processes.size() - 1);
   THDGroup new_group_id = static_cast<THDGroup>(_groups.size());
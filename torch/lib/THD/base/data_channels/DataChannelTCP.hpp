@@ -4,6 +4,7 @@
 #include "DataChannelUtils.hpp"
 
 #include <sys/poll.h>
+#include <atomic>
 #include <cstdint>
 #include <map>
 #include <memory>
@@ -50,6 +51,8 @@ struct DataChannelTCP : DataChannel {
                  THDGroup group_id = THDGroupWORLD) override;
   void allReduce(at::Tensor& data, THDReduceOp operation,
                  THDGroup group_id = THDGroupWORLD) override;
+  RequestTCP* iallReduce(at::Tensor& data, THDReduceOp operation,
+                         THDGroup group_id = THDGroupWORLD) override;
   void reduce(std::vector<at::Tensor>& data,
               THDReduceOp operation,
               rank_type dstRank,
@@ -93,6 +96,12 @@ private:
   void _receive(const at::Tensor& data, rank_type src_id);
   void _reduce(at::Tensor& result, at::Tensor& data,
                THDReduceOp operation) const;
+  void _allReduce(at::Tensor& data, THDReduceOp operation, THDGroup group_id);
+  void _ringAllReduce(at::Tensor& data, THDReduceOp operation,
+                      const DataChannel::Group& group, rank_type group_rank);
+  // Waits for the collectives started by `iallReduce` to finish, so that
+  // collectives run in the order in which they were issued.
+  void _waitCollectives();
 
 
   rank_type _rank; // Rank of current process, range: [0.._processes.size()-1]
@@ -112,6 +121,11 @@ private:
   // Workers
   QueueWorker _send_worker, _receive_worker;
 
+  // Runs the asynchronous collectives, which use the workers above. Declared
+  // after them so that it is destroyed first.
+  QueueWorker _collective_worker;
+  std::atomic<size_t> _pending_collectives;
+
 };
 
 } // namespace thd
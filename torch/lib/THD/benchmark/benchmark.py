@@ -130,6 +130,35 @@ else:
                 dist.all_reduce(tensor)
 dist.barrier()
 
+# Measures how much of the all reduce is hidden behind computation done while
+# it is in flight; without overlap both loops take about the same time.
+compute_input = torch.randn(256, 256)
+
+
+def all_reduce_with_compute(tensor, async_op):
+    request = dist.all_reduce(tensor, async_op=async_op)
+    compute_input.mm(compute_input)
+    if request is not None:
+        request.wait()
+
+
+for title, async_op in [("all reduce + compute", False),
+                        ("async all reduce + compute", True)]:
+    if rank == 0:
+        print_header(title)
+    for bytes in [2**n for n in range(MIN_BYTES, MAX_BYTES)]:
+        tensor = torch.ByteTensor(bytes).fill_(42)
+        for num_tensors in [10**n for n in range(MIN_NUM_TENSORS, MAX_NUM_TENSORS)]:
+            start = timer()
+            for i in range(0, num_tensors):
+                all_reduce_with_compute(tensor, async_op)
+            end = timer()
+            if rank == 0:
+                print_stats(bytes, num_tensors, end - start)
+    if rank == 0:
+        print()
+    dist.barrier()
+
 if rank == 0:
     print_header("scatter")
     for bytes in [2**n for n in range(MIN_BYTES, MAX_BYTES)]:
@@ -2,7 +2,9 @@
 #include "Functions.hpp"
 #include "../../base/ChannelUtils.hpp"
 
+#include <sys/uio.h>
 #include <unistd.h>
+#include <algorithm>
 #include <climits>
 #include <cstdlib>
 #include <cstring>
@@ -16,28 +18,50 @@
 namespace thd {
 namespace {
 
-void sendMessage(int socket, std::unique_ptr<rpc::RPCMessage> msg) {
-  auto& bytes = msg.get()->bytes();
-  uint64_t msg_length = static_cast<uint64_t>(bytes.length());
-
-  send_bytes<uint64_t>(socket, &msg_length, 1, true);
-  send_bytes<std::uint8_t>(
-    socket,
-    reinterpret_cast<const std::uint8_t*>(bytes.data()),
-    msg_length
-  );
-}
-
-std::unique_ptr<rpc::RPCMessage> receiveMessage(int socket) {
-  uint64_t msg_length;
-  recv_bytes<uint64_t>(socket, &msg_length, 1);
-
-  std::unique_ptr<std::uint8_t[]> bytes(new std::uint8_t[msg_length]);
-  recv_bytes<std::uint8_t>(socket, bytes.get(), msg_length);
+constexpr size_t kReadBufferSize = 64 * 1024;
+
+/*
+ * Writes the messages, each prefixed with its length, with as few system
+ * calls as possible. The messages are gathered from their own buffers rather
+ * than copied into one.
+ */
+void sendMessages(int socket,
+                  const std::vector<std::unique_ptr<rpc::RPCMessage>>& msgs) {
+  std::vector<uint64_t> lengths;
+  lengths.reserve(msgs.size());
+  std::vector<struct iovec> buffers;
+  buffers.reserve(2 * msgs.size());
+  for (auto& msg : msgs) {
+    auto& bytes = msg->bytes();
+    lengths.push_back(static_cast<uint64_t>(bytes.length()));
+    buffers.push_back({&lengths.back(), sizeof(uint64_t)});
+    if (bytes.length() > 0) {
+      buffers.push_back({const_cast<char*>(bytes.data()), bytes.length()});
+    }
+  }
 
-  return std::unique_ptr<rpc::RPCMessage>(
-    new rpc::RPCMessage(reinterpret_cast<char*>(bytes.get()), msg_length)
-  );
+  size_t next = 0;
+  while (next < buffers.size()) {
+    int count = static_cast<int>(std::min<size_t>(buffers.size() - next, IOV_MAX));
+    ssize_t bytes_sent;
+    SYSCHECK(bytes_sent = ::writev(socket, buffers.data() + next, count))
+    if (bytes_sent == 0)
+      throw std::system_error(ECONNRESET, std::system_category());
+
+    // skip what was written, which may end in the middle of a buffer
+    size_t written = static_cast<size_t>(bytes_sent);
+    while (written > 0) {
+      auto& buffer = buffers[next];
+      if (written >= buffer.iov_len) {
+        written -= buffer.iov_len;
+        ++next;
+      } else {
+        buffer.iov_base = static_cast<char*>(buffer.iov_base) + written;
+        buffer.iov_len -= written;
+        written = 0;
+      }
+    }
+  }
 }
 
 } // anonymous namespace
@@ -49,6 +73,7 @@ MasterCommandChannel::MasterCommandChannel(InitMethod::Config config)
   , _error_pipe(-1)
   , _error(nullptr)
   , _mutexes(config.world_size)
+  , _pending(config.world_size)
 {
   _sockets[0] = config.master.listen_socket;
 }
@@ -69,6 +94,7 @@ MasterCommandChannel::~MasterCommandChannel() {
     if (socket == -1) continue;
     try {
       sendMessage(rpc::packMessage(Functions::exit), i);
+      flush(i);
     } catch(...) {}
     ::close(socket);
   }
@@ -116,7 +142,7 @@ void MasterCommandChannel::errorHandler() {
   }
 }
 
-void MasterCommandChannel::sendMessage(std::unique_ptr<rpc::RPCMessage> msg, int rank) {
+void MasterCommandChannel::checkRank(int rank) {
   // Throw error received from a worker.
   if (_error) {
     throw std::runtime_error(*_error);
@@ -125,9 +151,35 @@ void MasterCommandChannel::sendMessage(std::unique_ptr<rpc::RPCMessage> msg, int
   if ((rank <= 0) || (rank >= _sockets.size())) {
     throw std::domain_error("sendMessage received invalid rank as parameter");
   }
+}
+
+void MasterCommandChannel::sendMessage(std::unique_ptr<rpc::RPCMessage> msg, int rank) {
+  checkRank(rank);
+
+  std::lock_guard<std::mutex> guard(_mutexes[rank]);
+  auto& pending = _pending[rank];
+  pending.bytes += sizeof(uint64_t) + msg->bytes().length();
+  pending.messages.push_back(std::move(msg));
+  if (pending.bytes >= kMaxBatchBytes) {
+    flushLocked(rank);
+  }
+}
+
+void MasterCommandChannel::flush(int rank) {
+  checkRank(rank);
 
   std::lock_guard<std::mutex> guard(_mutexes[rank]);
-  ::thd::sendMessage(_sockets[rank], std::move(msg));
+  flushLocked(rank);
+}
+
+void MasterCommandChannel::flushLocked(int rank) {
+  auto& pending = _pending[rank];
+  if (pending.messages.empty()) return;
+  // the queue is emptied even if sending fails, the worker is unusable then
+  auto messages = std::move(pending.messages);
+  pending.messages.clear();
+  pending.bytes = 0;
+  ::thd::sendMessages(_sockets[rank], messages);
 }
 
 std::tuple<rank_type, std::string> MasterCommandChannel::recvError() {
@@ -183,6 +235,9 @@ WorkerCommandChannel::WorkerCommandChannel(InitMethod::Config config)
   , _socket(-1)
   , _master_addr(config.worker.master_addr)
   , _master_port(config.worker.master_port)
+  , _buffer(kReadBufferSize)
+  , _buffer_begin(0)
+  , _buffer_end(0)
 {}
 
 WorkerCommandChannel::~WorkerCommandChannel() {
@@ -199,8 +254,47 @@ bool WorkerCommandChannel::init() {
   return true;
 }
 
+void WorkerCommandChannel::fillBuffer(size_t length) {
+  if (_buffer_end - _buffer_begin >= length) return;
+  // move the unread bytes to the front
+  std::copy(_buffer.begin() + _buffer_begin, _buffer.begin() + _buffer_end,
+            _buffer.begin());
+  _buffer_end -= _buffer_begin;
+  _buffer_begin = 0;
+  if (_buffer.size() < length) {
+    _buffer.resize(length);
+  }
+  while (_buffer_end < length) {
+    ssize_t bytes_received;
+    SYSCHECK(bytes_received = ::recv(_socket, _buffer.data() + _buffer_end,
+                                     _buffer.size() - _buffer_end, 0))
+    if (bytes_received == 0)
+      throw std::system_error(ECONNRESET, std::system_category());
+    _buffer_end += bytes_received;
+  }
+}
+
 std::unique_ptr<rpc::RPCMessage> WorkerCommandChannel::recvMessage() {
-  return ::thd::receiveMessage(_socket);
+  uint64_t msg_length;
+  fillBuffer(sizeof(msg_length));
+  std::memcpy(&msg_length, _buffer.data() + _buffer_begin, sizeof(msg_length));
+  _buffer_begin += sizeof(msg_length);
+
+  std::unique_ptr<rpc::RPCMessage> msg;
+  if (msg_length <= kReadBufferSize) {
+    fillBuffer(msg_length);
+    msg.reset(new rpc::RPCMessage(_buffer.data() + _buffer_begin, msg_length));
+    _buffer_begin += msg_length;
+  } else {
+    // receive the rest of large messages directly, without buffering
+    size_t buffered = _buffer_end - _buffer_begin;
+    std::unique_ptr<char[]> bytes(new char[msg_length]);
+    std::memcpy(bytes.get(), _buffer.data() + _buffer_begin, buffered);
+    _buffer_begin = _buffer_end = 0;
+    recv_bytes<char>(_socket, bytes.get() + buffered, msg_length - buffered);
+    msg.reset(new rpc::RPCMessage(bytes.get(), msg_length));
+  }
+  return msg;
 }
 
 void WorkerCommandChannel::sendError(const std::string& error) {
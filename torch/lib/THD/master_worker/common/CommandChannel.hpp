@@ -13,6 +13,13 @@
 
 namespace thd {
 
+/*
+ * Messages sent to a worker are queued and written together, with one
+ * scatter-gather write, when the queue grows past kMaxBatchBytes or is
+ * flushed. Commands that don't return anything thus don't cost a round trip
+ * each. Anything that communicates with a worker over the data channel, like
+ * receiving a return value, has to flush its queue first.
+ */
 struct MasterCommandChannel {
   MasterCommandChannel(InitMethod::Config config);
   ~MasterCommandChannel();
@@ -20,8 +27,19 @@ struct MasterCommandChannel {
   bool init();
 
   void sendMessage(std::unique_ptr<rpc::RPCMessage> msg, int rank);
+  // sends the messages queued for the worker
+  void flush(int rank);
 
 private:
+  struct PendingMessages {
+    std::vector<std::unique_ptr<rpc::RPCMessage>> messages;
+    size_t bytes = 0;
+  };
+
+  static constexpr size_t kMaxBatchBytes = 64 * 1024;
+
+  void checkRank(int rank);
+  void flushLocked(int rank);
   std::tuple<rank_type, std::string> recvError();
   void errorHandler();
 
@@ -33,6 +51,7 @@ private:
   std::unique_ptr<std::string> _error;
   std::thread _error_thread;
   std::vector<std::mutex> _mutexes;
+  std::vector<PendingMessages> _pending; // guarded by _mutexes
 };
 
 struct WorkerCommandChannel {
@@ -45,11 +64,20 @@ struct WorkerCommandChannel {
   void sendError(const std::string& error);
 
 private:
+  // makes at least `length` received bytes available in the read buffer
+  void fillBuffer(size_t length);
+
   rank_type _rank;
   int _socket;
 
   std::string _master_addr;
   port_type _master_port;
+
+  // the master writes messages in batches, so they are read into a buffer
+  // several at a time
+  std::vector<char> _buffer;
+  size_t _buffer_begin;
+  size_t _buffer_end;
 };
 
 } // namespace thd
@@ -27,6 +27,11 @@ void THDAllReduce(THDTensorDescriptor& desc, THDReduceOp operation, THDGroup gro
   dataChannel->allReduce(desc, operation, group);
 }
 
+THDRequest* THDIallReduce(THDTensorDescriptor& desc, THDReduceOp operation,
+                          THDGroup group) {
+  return dataChannel->iallReduce(desc, operation, group);
+}
+
 void THDReduceMultiGPU(THDTensorDescriptor* desc,
                        size_t len,
                        THDReduceOp operation,
@@ -11,6 +11,8 @@ THD_API void THDAllReduceMultiGPU(THDTensorDescriptor* data,
                                   THDGroup group);
 THD_API void THDAllReduce(THDTensorDescriptor& desc, THDReduceOp operation,
                           THDGroup group);
+THD_API THDRequest* THDIallReduce(THDTensorDescriptor& desc,
+                                  THDReduceOp operation, THDGroup group);
 THD_API void THDReduceMultiGPU(THDTensorDescriptor* desc,
                                size_t len,
                                THDReduceOp operation,
@@ -143,6 +143,29 @@ void test_allReduce(std::shared_ptr<thd::DataChannel> data_channel, int workers)
                          -1, data_channel->getNumProcesses() - 1);
 }
 
+void test_iallReduce(std::shared_ptr<thd::DataChannel> data_channel, int workers) {
+  auto value = data_channel->getRank() == 0 ? 2 : data_channel->getRank();
+  auto large_tensor = buildTensor<int>({1, 2, 3, 4, 5, 6, 7, 100}, value);
+  auto small_tensor = buildTensor<int>({1, 2, 3}, value);
+  std::unique_ptr<thd::DataChannel::Request> large_request(
+    data_channel->iallReduce(*large_tensor, THDReduceOp::THDReduceSUM, 0)
+  );
+  std::unique_ptr<thd::DataChannel::Request> small_request(
+    data_channel->iallReduce(*small_tensor, THDReduceOp::THDReduceSUM, 0)
+  );
+
+  // synchronous collective has to run after the pending ones
+  auto int_tensor = buildTensor<int>({1, 2, 3, 4, 5}, value);
+  data_channel->allReduce(*int_tensor, THDReduceOp::THDReduceSUM, 0);
+  ASSERT_TENSOR_VALUE(int, *int_tensor, 2 + (workers * (workers + 1) / 2))
+
+  large_request->wait();
+  small_request->wait();
+  assert(large_request->isCompleted());
+  ASSERT_TENSOR_VALUE(int, *large_tensor, 2 + (workers * (workers + 1) / 2))
+  ASSERT_TENSOR_VALUE(int, *small_tensor, 2 + (workers * (workers + 1) / 2))
+}
+
 void test_scatter(std::shared_ptr<thd::DataChannel> data_channel) {
   if (g_data_channel_type == "gloo") {
     return; // XXX: Gloo does not support scatter
@@ -618,6 +641,7 @@ void run_all_tests(std::shared_ptr<thd::DataChannel> data_channel, int workers)
   test_broadcast(data_channel);
   test_reduce(data_channel, workers);
   test_allReduce(data_channel, workers);
+  test_iallReduce(data_channel, workers);
   test_scatter(data_channel);
   test_gather(data_channel);
   test_allGather(data_channel);
@@ -15,6 +15,12 @@
     }                                                                     \
   } while (0)
 
+// Point-to-point primitives (ncclSend/ncclRecv) are available since NCCL 2.7
+#if defined(NCCL_MAJOR) && \
+    ((NCCL_MAJOR > 2) || (NCCL_MAJOR == 2 && NCCL_MINOR >= 7))
+#define C10D_NCCL_HAS_SEND_RECV
+#endif
+
 namespace c10d {
 
 // RAII wrapper for NCCL communicator
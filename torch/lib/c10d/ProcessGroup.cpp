@@ -1,11 +1,336 @@
 #include "ProcessGroup.hpp"
 
+#include <functional>
+#include <mutex>
+
 namespace c10d {
 
+namespace {
+
+// Work of an allreduce on compressed copies of the tensors. The reduced
+// values are cast back into the tensors once the work has completed, on the
+// current streams of the caller.
+class CompressedWork : public ProcessGroup::Work {
+ public:
+  CompressedWork(
+      std::shared_ptr<ProcessGroup::Work> work,
+      std::vector<at::Tensor> tensors,
+      std::vector<at::Tensor> compressed)
+      : work_(std::move(work)),
+        tensors_(std::move(tensors)),
+        compressed_(std::move(compressed)),
+        decompressed_(false) {}
+
+  bool isCompleted() const override {
+    return work_->isCompleted();
+  }
+
+  bool isSuccess() const override {
+    return work_->isSuccess();
+  }
+
+  void synchronize() override {
+    work_->synchronize();
+    decompress();
+  }
+
+  bool wait() override {
+    if (!work_->wait()) {
+      return false;
+    }
+    decompress();
+    return true;
+  }
+
+  const std::exception& exception() const override {
+    return work_->exception();
+  }
+
+ protected:
+  void decompress() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (decompressed_) {
+      return;
+    }
+    for (size_t i = 0; i < tensors_.size(); i++) {
+      at::DeviceGuard guard(tensors_[i]);
+      tensors_[i].copy_(compressed_[i]);
+    }
+    decompressed_ = true;
+  }
+
+  std::shared_ptr<ProcessGroup::Work> work_;
+  std::vector<at::Tensor> tensors_;
+  std::vector<at::Tensor> compressed_;
+  std::mutex mutex_;
+  bool decompressed_;
+};
+
+// Work of the collectives of a sparse allreduce. `finish` assembles the
+// reduced sparse tensor from their outputs once they have all completed.
+class SparseAllreduceWork : public ProcessGroup::Work {
+ public:
+  SparseAllreduceWork(
+      std::vector<std::shared_ptr<ProcessGroup::Work>> works,
+      std::function<void()> finish)
+      : works_(std::move(works)),
+        finish_(std::move(finish)),
+        finished_(false) {}
+
+  bool isCompleted() const override {
+    for (const auto& work : works_) {
+      if (!work->isCompleted()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool isSuccess() const override {
+    for (const auto& work : works_) {
+      if (!work->isSuccess()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void synchronize() override {
+    for (auto& work : works_) {
+      work->synchronize();
+    }
+    finish();
+  }
+
+  bool wait() override {
+    for (auto& work : works_) {
+      if (!work->wait()) {
+        return false;
+      }
+    }
+    finish();
+    return true;
+  }
+
+  const std::exception& exception() const override {
+    for (const auto& work : works_) {
+      if (work->isCompleted() && !work->isSuccess()) {
+        return work->exception();
+      }
+    }
+    return works_.front()->exception();
+  }
+
+ protected:
+  void finish() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (finished_) {
+      return;
+    }
+    finish_();
+    finished_ = true;
+  }
+
+  std::vector<std::shared_ptr<ProcessGroup::Work>> works_;
+  std::function<void()> finish_;
+  std::mutex mutex_;
+  bool finished_;
+};
+
+at::ScalarType compressedType(AllreduceCompression compression) {
+  switch (compression) {
+    case AllreduceCompression::FP16:
+      return at::kHalf;
+    case AllreduceCompression::NONE:
+      break;
+  }
+  throw std::invalid_argument("Unhandled AllreduceCompression");
+}
+
+} // namespace
+
 ProcessGroup::Work::~Work() {}
 
 ProcessGroup::ProcessGroup(int rank, int size) : rank_(rank), size_(size) {}
 
 ProcessGroup::~ProcessGroup() {}
 
+std::shared_ptr<ProcessGroup::Work> ProcessGroup::allreduceCompressed(
+    std::vector<at::Tensor>& tensors,
+    const AllreduceOptions& opts) {
+  const auto type = compressedType(opts.compression);
+  const auto& residuals = opts.residuals;
+  if (!residuals.empty() && residuals.size() != tensors.size()) {
+    throw std::invalid_argument(
+        "allreduce: expected one residual tensor per tensor");
+  }
+
+  std::vector<at::Tensor> compressed(tensors.size());
+  for (size_t i = 0; i < tensors.size(); i++) {
+    auto& tensor = tensors[i];
+    if (tensor.type().scalarType() != at::kFloat) {
+      throw std::invalid_argument(
+          "allreduce: compression is only supported for float tensors");
+    }
+    at::DeviceGuard guard(tensor);
+    if (residuals.empty()) {
+      compressed[i] = tensor.toType(type);
+      continue;
+    }
+
+    // Compress the tensor together with the error of the previous call,
+    // and keep the new error for the next one
+    auto& residual = residuals[i];
+    if (residual.type() != tensor.type() ||
+        !residual.sizes().equals(tensor.sizes())) {
+      throw std::invalid_argument(
+          "allreduce: residual tensors should have the same type and shape "
+          "as the tensors");
+    }
+    auto compensated = tensor + residual;
+    compressed[i] = compensated.toType(type);
+    // `residuals` only holds handles, the residual is updated in place
+    at::Tensor(residual).copy_(compensated - compressed[i].toType(at::kFloat));
+  }
+
+  AllreduceOptions compressedOpts;
+  compressedOpts.reduceOp = opts.reduceOp;
+  auto work = allreduce(compressed, compressedOpts);
+  return std::make_shared<CompressedWork>(
+      std::move(work), tensors, std::move(compressed));
+}
+
+// Sparse tensors can't be reduced element-wise, and their number of
+// nonzeros differs between processes. The nonzero counts are exchanged
+// first, which blocks. The indices and values are then gathered into
+// buffers padded to the largest count, with every process writing its own
+// slot and summing the zeros of the others, so that backends without
+// allgather can run it. The gathered entries are concatenated and coalesced,
+// which sums the duplicate indices.
+//
+// Gathering costs size * maxNnz rows, so if that is more than the number of
+// rows of the dense tensor, the dense tensor is reduced instead, and only its
+// nonzero rows are kept.
+std::shared_ptr<ProcessGroup::Work> ProcessGroup::allreduceSparse(
+    std::vector<at::Tensor>& tensors,
+    const AllreduceOptions& opts) {
+  if (tensors.size() != 1) {
+    throw std::invalid_argument(
+        "allreduce: only a single sparse tensor is supported");
+  }
+  if (opts.reduceOp != ReduceOp::SUM) {
+    throw std::invalid_argument(
+        "allreduce: only ReduceOp::SUM is supported for sparse tensors");
+  }
+  if (opts.compression != AllreduceCompression::NONE) {
+    throw std::invalid_argument(
+        "allreduce: compression is not supported for sparse tensors");
+  }
+
+  auto tensor = tensors[0];
+  at::DeviceGuard guard(tensor);
+  const auto input = tensor.coalesce();
+  const auto indices = input._indices();
+  const auto values = input._values();
+  const auto sparseDims = input._sparseDims();
+  const auto sizes = input.sizes().vec();
+  const std::vector<int64_t> sparseSizes(
+      sizes.begin(), sizes.begin() + sparseDims);
+  const std::vector<int64_t> denseSizes(
+      sizes.begin() + sparseDims, sizes.end());
+  const auto nnz = input._nnz();
+
+  std::vector<at::Tensor> counts = {at::zeros({size_}, indices.options())};
+  counts[0][rank_].fill_(nnz);
+  allreduce(counts)->wait();
+  const auto allCounts = counts[0].cpu();
+  const auto* countsData = allCounts.data<int64_t>();
+  int64_t maxNnz = 0;
+  for (int i = 0; i < size_; i++) {
+    maxNnz = std::max(maxNnz, countsData[i]);
+  }
+  if (maxNnz == 0) {
+    return std::make_shared<SparseAllreduceWork>(
+        std::vector<std::shared_ptr<Work>>(), [] {});
+  }
+
+  int64_t numRows = 1;
+  for (auto size : sparseSizes) {
+    numRows *= size;
+  }
+  int64_t rowNumel = 1;
+  for (auto size : denseSizes) {
+    rowNumel *= size;
+  }
+  const double rowBytes =
+      static_cast<double>(rowNumel) * values.type().elementSizeInBytes();
+  const double sparseBytes = static_cast<double>(size_) * maxNnz *
+      (rowBytes + sparseDims * sizeof(int64_t));
+  const double denseBytes = numRows * rowBytes;
+
+  std::vector<std::shared_ptr<Work>> works;
+  if (sparseBytes >= denseBytes) {
+    auto dense = std::make_shared<std::vector<at::Tensor>>(
+        1, input.to_dense());
+    works.push_back(allreduce(*dense));
+    return std::make_shared<SparseAllreduceWork>(
+        std::move(works),
+        [tensor, dense, sparseSizes, denseSizes, numRows, rowNumel]() mutable {
+          at::DeviceGuard guard(tensor);
+          auto rows = (*dense)[0].contiguous().view({numRows, rowNumel});
+          auto nonzero = rows.ne(0).any(1).nonzero().view({-1});
+          // Unravel the row numbers into indices
+          std::vector<at::Tensor> rowIndices(sparseSizes.size());
+          auto flat = nonzero;
+          for (size_t i = sparseSizes.size(); i-- > 0;) {
+            rowIndices[i] = flat.remainder(sparseSizes[i]);
+            flat = flat.div(sparseSizes[i]);
+          }
+          std::vector<int64_t> valuesSizes = {-1};
+          valuesSizes.insert(
+              valuesSizes.end(), denseSizes.begin(), denseSizes.end());
+          auto result = at::_sparse_coo_tensor_unsafe(
+              at::stack(rowIndices),
+              rows.index_select(0, nonzero).view(valuesSizes),
+              (*dense)[0].sizes());
+          at::raw_copy_sparse_(tensor, result);
+        });
+  }
+
+  std::vector<int64_t> valuesSizes = {size_, maxNnz};
+  valuesSizes.insert(valuesSizes.end(), denseSizes.begin(), denseSizes.end());
+  auto buffers = std::make_shared<std::vector<at::Tensor>>(2);
+  auto& gatheredIndices = (*buffers)[0];
+  auto& gatheredValues = (*buffers)[1];
+  gatheredIndices = at::zeros({size_, sparseDims, maxNnz}, indices.options());
+  gatheredValues = at::zeros(valuesSizes, values.options());
+  if (nnz > 0) {
+    gatheredIndices[rank_].narrow(1, 0, nnz).copy_(indices);
+    gatheredValues[rank_].narrow(0, 0, nnz).copy_(values);
+  }
+  // The buffers differ in type, so they are reduced separately
+  std::vector<at::Tensor> indicesBuffer = {gatheredIndices};
+  std::vector<at::Tensor> valuesBuffer = {gatheredValues};
+  works.push_back(allreduce(indicesBuffer));
+  works.push_back(allreduce(valuesBuffer));
+  std::vector<int64_t> allNnz(countsData, countsData + size_);
+  return std::make_shared<SparseAllreduceWork>(
+      std::move(works), [tensor, buffers, allNnz, sizes]() mutable {
+        at::DeviceGuard guard(tensor);
+        std::vector<at::Tensor> indices;
+        std::vector<at::Tensor> values;
+        for (size_t i = 0; i < allNnz.size(); i++) {
+          if (allNnz[i] == 0) {
+            continue;
+          }
+          indices.push_back((*buffers)[0][i].narrow(1, 0, allNnz[i]));
+          values.push_back((*buffers)[1][i].narrow(0, 0, allNnz[i]));
+        }
+        auto result = at::_sparse_coo_tensor_unsafe(
+                          at::cat(indices, 1), at::cat(values, 0), sizes)
+                          .coalesce();
+        at::raw_copy_sparse_(tensor, result);
+      });
+}
+
 } // namespace c10d
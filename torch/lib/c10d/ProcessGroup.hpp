@@ -112,6 +112,22 @@ class ProcessGroup {
       std::vector<std::vector<at::Tensor>>& inputTensors,
       const ScatterOptions& opts = ScatterOptions()) = 0;
 
+  // Reduces the inputs of all processes element-wise and leaves every
+  // process with one slice of the result. inputTensors[i] holds one
+  // tensor per participant (process, or GPU for multi-device backends)
+  // and outputTensors[i] receives the reduced slice of this participant.
+  virtual std::shared_ptr<ProcessGroup::Work> reduceScatter(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensors,
+      const ReduceScatterOptions& opts = ReduceScatterOptions()) = 0;
+
+  // Sends inputTensors[i][j] to participant j, which receives it in
+  // outputTensors[i][k], where k is the index of the sender.
+  virtual std::shared_ptr<ProcessGroup::Work> alltoall(
+      std::vector<std::vector<at::Tensor>>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensors,
+      const AllToAllOptions& opts = AllToAllOptions()) = 0;
+
   virtual std::shared_ptr<ProcessGroup::Work> send(
       std::vector<at::Tensor>& tensors,
       int dstRank) = 0;
@@ -127,6 +143,22 @@ class ProcessGroup {
   virtual std::shared_ptr<ProcessGroup::Work> barrier() = 0;
 
  protected:
+  // Helper for backends to implement AllreduceOptions::compression:
+  // compresses the tensors, calls allreduce on the compressed tensors, and
+  // returns work that decompresses them back into the tensors when waited
+  // upon.
+  std::shared_ptr<ProcessGroup::Work> allreduceCompressed(
+      std::vector<at::Tensor>& tensors,
+      const AllreduceOptions& opts);
+
+  // Helper for backends to allreduce a sparse tensor: gathers the indices
+  // and values of all processes, or reduces the dense tensor if that moves
+  // fewer bytes, and returns work that writes the coalesced sum into the
+  // tensor when waited upon. Only ReduceOp::SUM is supported.
+  std::shared_ptr<ProcessGroup::Work> allreduceSparse(
+      std::vector<at::Tensor>& tensors,
+      const AllreduceOptions& opts);
+
   const int rank_;
   const int size_;
 };
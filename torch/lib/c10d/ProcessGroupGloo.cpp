@@ -6,9 +6,11 @@
 #include <gloo/cuda_allreduce_halving_doubling.h>
 #include <gloo/cuda_allreduce_ring_chunked.h>
 #include <gloo/cuda_broadcast_one_to_all.h>
+#include <gloo/cuda_workspace.h>
 #include <gloo/rendezvous/context.h>
 #include <gloo/transport/tcp/device.h>
 
+#include <ATen/core/StaticTracepoint.h>
 #include <THC.h>
 
 #include <c10d/private/CUDAUtils.hpp>
@@ -47,6 +49,19 @@ using EntryType = std::unique_ptr<AlgorithmEntry>;
 
 namespace {
 
+const char* collectiveName(CollectiveType type) {
+  switch (type) {
+    case CollectiveType::BROADCAST:
+      return "broadcast";
+    case CollectiveType::ALLREDUCE:
+      return "allreduce";
+    case CollectiveType::REDUCE_SCATTER:
+      return "reduceScatter";
+    default:
+      return "unknown";
+  }
+}
+
 // Wrap c10d store as Gloo store
 class GlooStore : public ::gloo::rendezvous::Store {
  public:
@@ -284,12 +299,15 @@ void ProcessGroupGloo::runSingle(WorkType tuple) {
   auto& entry = std::get<0>(tuple);
   auto& work = std::get<1>(tuple);
 
+  const char* name = collectiveName(entry->key.collectiveType);
+  AT_SDT(c10d_collective_start, this, name);
   try {
     entry->run();
     work->finish(*entry);
   } catch (const ::gloo::Exception& ex) {
     work->finishWithException(ex);
   }
+  AT_SDT(c10d_collective_end, this, name);
 
   // Unblock anyone waiting for this algorithm entry
   std::unique_lock<std::mutex> lock(entry->m);
@@ -306,6 +324,12 @@ void ProcessGroupGloo::createAlgorithm(AlgorithmEntry& entry) {
     case CollectiveType::BROADCAST:
       GENERATE_ALL_TYPES(key.type->scalarType(), createBroadcast, entry);
       return;
+    case CollectiveType::REDUCE_SCATTER:
+      // Gloo has no reduce-scatter algorithm that works with multiple
+      // devices; reduce the flattened inputs with allreduce and let
+      // every process keep its own slice.
+      GENERATE_ALL_TYPES(key.type->scalarType(), createAllreduce, entry);
+      return;
     case CollectiveType::UNUSED:
       break;
   }
@@ -342,20 +366,10 @@ void ProcessGroupGloo::createAllreduce(AlgorithmEntry& entry) {
   }
 
   if (backend == at::Backend::CUDA) {
-    if (getSize() < 16) {
-      entry.algorithm = std::unique_ptr<::gloo::Algorithm>(
-          new ::gloo::CudaAllreduceRingChunked<T>(
-              context,
-              getDataPointers<T>(entry.src),
-              entry.src[0].numel(),
-              getStreamVector(entry)));
+    if (key.gpuDirect) {
+      createCudaAllreduce<T, ::gloo::CudaDeviceWorkspace<T>>(entry);
     } else {
-      entry.algorithm = std::unique_ptr<::gloo::Algorithm>(
-          new ::gloo::CudaAllreduceHalvingDoubling<T>(
-              context,
-              getDataPointers<T>(entry.src),
-              entry.src[0].numel(),
-              getStreamVector(entry)));
+      createCudaAllreduce<T, ::gloo::CudaHostWorkspace<T>>(entry);
     }
     return;
   }
@@ -364,6 +378,32 @@ void ProcessGroupGloo::createAllreduce(AlgorithmEntry& entry) {
       "Unhandled backend: " + std::string(at::toString(backend)));
 }
 
+template <typename T, typename W>
+void ProcessGroupGloo::createCudaAllreduce(AlgorithmEntry& entry) {
+  // Create algorithm against first context
+  auto& context = contexts_[0];
+  at::DeviceGuard guard(entry.src[0]);
+
+  // The algorithm allocates its workspace (pinned host or device buffers)
+  // when it is constructed. It is cached with the entry, so the workspace
+  // is reused by every call with the same signature.
+  if (getSize() < 16) {
+    entry.algorithm = std::unique_ptr<::gloo::Algorithm>(
+        new ::gloo::CudaAllreduceRingChunked<T, W>(
+            context,
+            getDataPointers<T>(entry.src),
+            entry.src[0].numel(),
+            getStreamVector(entry)));
+  } else {
+    entry.algorithm = std::unique_ptr<::gloo::Algorithm>(
+        new ::gloo::CudaAllreduceHalvingDoubling<T, W>(
+            context,
+            getDataPointers<T>(entry.src),
+            entry.src[0].numel(),
+            getStreamVector(entry)));
+  }
+}
+
 template <typename T>
 void ProcessGroupGloo::createBroadcast(AlgorithmEntry& entry) {
   const auto& key = entry.key;
@@ -528,12 +568,21 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allreduce(
     const AllreduceOptions& opts) {
   assertSameSizeAndType(tensors);
 
+  if (tensors[0].is_sparse()) {
+    return allreduceSparse(tensors, opts);
+  }
+
+  if (opts.compression != AllreduceCompression::NONE) {
+    return allreduceCompressed(tensors, opts);
+  }
+
   AlgorithmKey key;
   key.collectiveType = CollectiveType::ALLREDUCE;
   key.type = &tensors[0].type();
   key.srcSizes = getSizes(tensors);
   key.devices = getDevices(tensors);
   key.reduceOp = opts.reduceOp;
+  key.gpuDirect = key.type->is_cuda() && opts.gpuDirect;
 
   // Retrieve (create or wait for) cache entry
   auto entry = checkout(key);
@@ -569,6 +618,87 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allreduce(
   return enqueue(entry);
 }
 
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::reduceScatter(
+    std::vector<at::Tensor>& outputTensors,
+    std::vector<std::vector<at::Tensor>>& inputTensors,
+    const ReduceScatterOptions& opts) {
+  assertSameSizeAndType(outputTensors);
+  if (inputTensors.size() != outputTensors.size()) {
+    throw std::invalid_argument(
+        "reduce_scatter: input and output size mismatch");
+  }
+  for (auto& tensors : inputTensors) {
+    if (tensors.size() != static_cast<size_t>(getSize())) {
+      throw std::invalid_argument(
+          "reduce_scatter: number of input tensors should equal "
+          "to the world size");
+    }
+    assertSameSizeAndType(tensors);
+    if (tensors[0].type() != outputTensors[0].type() ||
+        !tensors[0].sizes().equals(outputTensors[0].sizes())) {
+      throw std::invalid_argument(
+          "reduce_scatter: input and output tensors should have the same "
+          "type and shape");
+    }
+  }
+
+  // Every entry reduces the inputs of a device, flattened into one tensor
+  std::vector<int64_t> flatSizes{static_cast<int64_t>(getSize())};
+  auto sizes = outputTensors[0].sizes();
+  flatSizes.insert(flatSizes.end(), sizes.begin(), sizes.end());
+
+  AlgorithmKey key;
+  key.collectiveType = CollectiveType::REDUCE_SCATTER;
+  key.type = &outputTensors[0].type();
+  key.srcSizes.assign(outputTensors.size(), flatSizes);
+  key.devices = getDevices(outputTensors);
+  key.reduceOp = opts.reduceOp;
+
+  // Retrieve (create or wait for) cache entry
+  auto entry = checkout(key);
+
+  // Copy input tensors
+  for (size_t i = 0; i < inputTensors.size(); i++) {
+    for (size_t j = 0; j < inputTensors[i].size(); j++) {
+      entry->src[i][j].copy_(inputTensors[i][j]);
+    }
+  }
+
+  const auto rank = getRank();
+
+  // In case of CUDA, ensure that operations that are queued after
+  // this collective wait for the collective to complete.
+  if (key.type->is_cuda()) {
+    synchronizeStreams(thcState_, entry);
+    entry->run = [=]() mutable {
+      entry->algorithm->run();
+      for (size_t i = 0; i < outputTensors.size(); i++) {
+        // The THCStreamGuard is a RAII wrapper for temporarily
+        // overriding the current THCStream. This also sets the
+        // current device to the stream's device.
+        THCStreamGuard guard(thcState_, entry->streams[i]);
+        outputTensors[i].copy_(entry->src[i][rank]);
+      }
+    };
+  } else {
+    entry->run = [=]() mutable {
+      entry->algorithm->run();
+      for (size_t i = 0; i < outputTensors.size(); i++) {
+        outputTensors[i].copy_(entry->src[i][rank]);
+      }
+    };
+  }
+
+  return enqueue(entry);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::alltoall(
+    std::vector<std::vector<at::Tensor>>& /* unused */,
+    std::vector<std::vector<at::Tensor>>& /* unused */,
+    const AllToAllOptions& /* unused */) {
+  throw std::runtime_error("ProcessGroupGloo does not support alltoall");
+}
+
 std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::reduce(
     std::vector<at::Tensor>& /* unused */,
     const ReduceOptions& /* unused */) {
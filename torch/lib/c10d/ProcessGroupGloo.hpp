@@ -43,7 +43,8 @@ struct AlgorithmKey {
         (devices == other.devices) && (srcSizes == other.srcSizes) &&
         (dstSizes == other.dstSizes) && (srcRank == other.srcRank) &&
         (dstRank == other.dstRank) && (srcTensor == other.srcTensor) &&
-        (dstTensor == other.dstTensor) && (reduceOp == other.reduceOp);
+        (dstTensor == other.dstTensor) && (reduceOp == other.reduceOp) &&
+        (gpuDirect == other.gpuDirect);
   }
 
   CollectiveType collectiveType = CollectiveType::UNUSED;
@@ -56,6 +57,7 @@ struct AlgorithmKey {
   int srcTensor = -1;
   int dstTensor = -1;
   ReduceOp reduceOp = ReduceOp::UNUSED;
+  bool gpuDirect = false;
 
   // This function is called by torch::hash<AlgorithmKey>
   static size_t hash(const AlgorithmKey& k) {
@@ -69,7 +71,8 @@ struct AlgorithmKey {
         k.dstRank,
         k.srcTensor,
         k.dstTensor,
-        k.reduceOp);
+        k.reduceOp,
+        k.gpuDirect);
   }
 };
 
@@ -262,6 +265,16 @@ class ProcessGroupGloo : public ProcessGroup {
       std::vector<std::vector<at::Tensor>>& inputTensors,
       const ScatterOptions& opts = ScatterOptions()) override;
 
+  std::shared_ptr<ProcessGroup::Work> reduceScatter(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensors,
+      const ReduceScatterOptions& opts = ReduceScatterOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> alltoall(
+      std::vector<std::vector<at::Tensor>>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensors,
+      const AllToAllOptions& opts = AllToAllOptions()) override;
+
   std::shared_ptr<ProcessGroup::Work> send(
       std::vector<at::Tensor>& tensors,
       int dstRank) override;
@@ -296,6 +309,11 @@ class ProcessGroupGloo : public ProcessGroup {
   template <typename T>
   void createAllreduce(AlgorithmEntry& entry);
 
+  // W is the Gloo workspace that determines where the CUDA algorithm keeps
+  // its buffers, in pinned host memory or in device memory (GPUDirect).
+  template <typename T, typename W>
+  void createCudaAllreduce(AlgorithmEntry& entry);
+
   template <typename T>
   void createBroadcast(AlgorithmEntry& entry);
 
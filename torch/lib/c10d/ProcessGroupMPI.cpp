@@ -5,6 +5,8 @@
 #include <mpi.h>
 #include <mpi-ext.h> // Needed for CUDA-aware check
 
+#include <ATen/core/StaticTracepoint.h>
+
 namespace c10d {
 
 #define MPI_CHECK(cmd)                                                   \
@@ -38,15 +40,13 @@ std::map<at::ScalarType, MPI_Datatype> mpiDatatype = {
     {at::kShort, MPI_SHORT},
 };
 
-// Checking CUDA-aware MPI support
+// Checking CUDA-aware MPI support. With it, device pointers are passed to MPI
+// directly.
 bool cudaAwareMpiCheck() {
-// Run time check
+// Run time check, only done once
 #if defined(MPIX_CUDA_AWARE_SUPPORT)
-  if (MPIX_Query_cuda_support() == 1) {
-    return true;
-  } else {
-    return false;
-  }
+  static const bool cudaAware = MPIX_Query_cuda_support() == 1;
+  return cudaAware;
 #else // !defined(MPIX_CUDA_AWARE_SUPPORT)
   return false;
 #endif // MPIX_CUDA_AWARE_SUPPORT
@@ -94,11 +94,25 @@ void mpiExit() {
 } // namespace
 
 // ProcessGroupMPI::WorkMPI
-ProcessGroupMPI::WorkMPI::WorkMPI() : completed_(false) {}
+ProcessGroupMPI::WorkMPI::WorkMPI()
+    : completed_(false), request_(MPI_REQUEST_NULL) {}
 
-ProcessGroupMPI::WorkMPI::~WorkMPI() {}
+ProcessGroupMPI::WorkMPI::~WorkMPI() {
+  // MPI may still be using the tensors of an in-flight request
+  std::unique_lock<std::mutex> lock(workMutex_);
+  if (request_ != MPI_REQUEST_NULL) {
+    completeRequest(true);
+  }
+}
 
 bool ProcessGroupMPI::WorkMPI::isCompleted() const {
+  if (completed_) {
+    return true;
+  }
+  std::unique_lock<std::mutex> lock(workMutex_);
+  if (request_ != MPI_REQUEST_NULL) {
+    completeRequest(false);
+  }
   return completed_;
 }
 
@@ -110,12 +124,46 @@ void ProcessGroupMPI::WorkMPI::synchronize() {}
 
 bool ProcessGroupMPI::WorkMPI::wait() {
   std::unique_lock<std::mutex> lock(workMutex_);
-  while (!completed_) {
+  while (!completed_ && request_ == MPI_REQUEST_NULL) {
     workCV_.wait(lock);
   }
+  if (!completed_) {
+    completeRequest(true);
+  }
   return isSuccess();
 }
 
+void ProcessGroupMPI::WorkMPI::start(
+    MPI_Request request,
+    std::vector<at::Tensor> tensors) {
+  {
+    std::unique_lock<std::mutex> lock(workMutex_);
+    request_ = request;
+    tensors_ = std::move(tensors);
+  }
+  workCV_.notify_all();
+}
+
+void ProcessGroupMPI::WorkMPI::completeRequest(bool blocking) const {
+  try {
+    int flag = 1;
+    if (blocking) {
+      MPI_CHECK(MPI_Wait(&request_, MPI_STATUS_IGNORE));
+    } else {
+      MPI_CHECK(MPI_Test(&request_, &flag, MPI_STATUS_IGNORE));
+    }
+    if (!flag) {
+      return;
+    }
+  } catch (...) {
+    workException_ = std::current_exception();
+  }
+  request_ = MPI_REQUEST_NULL;
+  tensors_.clear();
+  completed_ = true;
+  workCV_.notify_all();
+}
+
 void ProcessGroupMPI::WorkMPI::finish() {
   {
     std::unique_lock<std::mutex> lock(workMutex_);
@@ -253,19 +301,34 @@ void ProcessGroupMPI::runLoop() {
 
     lock.unlock();
 
+    AT_SDT(c10d_collective_start, this, workEntry->name);
     try {
       workEntry->run(workEntry);
-      work->finish();
+      if (workEntry->request == MPI_REQUEST_NULL) {
+        work->finish();
+      } else if (mpiThreadSupport_ == MPI_THREAD_MULTIPLE) {
+        // Leave the request in flight and start the next operation. Any
+        // thread may call MPI, so the work completes it.
+        work->start(
+            workEntry->request,
+            workEntry->src ? *workEntry->src : std::vector<at::Tensor>());
+      } else {
+        MPI_CHECK(MPI_Wait(&workEntry->request, MPI_STATUS_IGNORE));
+        work->finish();
+      }
     } catch (...) {
       work->finishWithException(std::current_exception());
     }
+    AT_SDT(c10d_collective_end, this, workEntry->name);
 
     lock.lock();
   }
 }
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::enqueue(
-    std::unique_ptr<WorkEntry> entry) {
+    std::unique_ptr<WorkEntry> entry,
+    const char* name) {
+  entry->name = name;
   auto work = std::make_shared<WorkMPI>();
   std::unique_lock<std::mutex> lock(pgMutex_);
   queue_.push_back(std::make_tuple(std::move(entry), work));
@@ -280,16 +343,17 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::broadcast(
   std::function<void(std::unique_ptr<WorkEntry>&)> runFunc =
       [opts](std::unique_ptr<WorkEntry>& entry) {
         auto data = (*entry->src)[0];
-        MPI_CHECK(MPI_Bcast(
+        MPI_CHECK(MPI_Ibcast(
             data.data_ptr(),
             data.numel(),
             mpiDatatype.at(data.type().scalarType()),
             opts.rootRank,
-            MPI_COMM_WORLD));
+            MPI_COMM_WORLD,
+            &entry->request));
       };
   auto entry = std::unique_ptr<WorkEntry>(
       new WorkEntry(&tensors, nullptr, std::move(runFunc)));
-  return enqueue(std::move(entry));
+  return enqueue(std::move(entry), __func__);
 }
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::allreduce(
@@ -299,17 +363,18 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::allreduce(
   std::function<void(std::unique_ptr<WorkEntry>&)> runFunc =
       [opts](std::unique_ptr<WorkEntry>& entry) {
         auto data = (*entry->src)[0];
-        MPI_CHECK(MPI_Allreduce(
+        MPI_CHECK(MPI_Iallreduce(
             MPI_IN_PLACE,
             data.data_ptr(),
             data.numel(),
             mpiDatatype.at(data.type().scalarType()),
             mpiOp.at(opts.reduceOp),
-            MPI_COMM_WORLD));
+            MPI_COMM_WORLD,
+            &entry->request));
       };
   auto entry = std::unique_ptr<WorkEntry>(
       new WorkEntry(&tensors, nullptr, std::move(runFunc)));
-  return enqueue(std::move(entry));
+  return enqueue(std::move(entry), __func__);
 }
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::reduce(
@@ -324,18 +389,19 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::reduce(
         void* sendbuf = (rank_ == opts.rootRank) ? MPI_IN_PLACE : dataPtr;
         void* recvbuf = (rank_ == opts.rootRank) ? dataPtr : nullptr;
 
-        MPI_CHECK(MPI_Reduce(
+        MPI_CHECK(MPI_Ireduce(
             sendbuf,
             recvbuf,
             data.numel(),
             mpiDatatype.at(data.type().scalarType()),
             mpiOp.at(opts.reduceOp),
             opts.rootRank,
-            MPI_COMM_WORLD));
+            MPI_COMM_WORLD,
+            &entry->request));
       };
   auto entry = std::unique_ptr<WorkEntry>(
       new WorkEntry(&tensors, nullptr, std::move(runFunc)));
-  return enqueue(std::move(entry));
+  return enqueue(std::move(entry), __func__);
 }
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::allgather(
@@ -376,7 +442,7 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::allgather(
       };
   auto entry = std::unique_ptr<WorkEntry>(
       new WorkEntry(&inputTensors, &outputTensors[0], std::move(runFunc)));
-  return enqueue(std::move(entry));
+  return enqueue(std::move(entry), __func__);
 }
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::gather(
@@ -436,11 +502,11 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::gather(
   if (rank_ == opts.rootRank) {
     auto entry = std::unique_ptr<WorkEntry>(
         new WorkEntry(&inputTensors, &outputTensors[0], std::move(runFunc)));
-    return enqueue(std::move(entry));
+    return enqueue(std::move(entry), __func__);
   } else {
     auto entry = std::unique_ptr<WorkEntry>(
         new WorkEntry(&inputTensors, nullptr, std::move(runFunc)));
-    return enqueue(std::move(entry));
+    return enqueue(std::move(entry), __func__);
   }
 }
 
@@ -500,12 +566,103 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::scatter(
   if (rank_ == opts.rootRank) {
     auto entry = std::unique_ptr<WorkEntry>(
         new WorkEntry(&inputTensors[0], &outputTensors, std::move(runFunc)));
-    return enqueue(std::move(entry));
+    return enqueue(std::move(entry), __func__);
   } else {
     auto entry = std::unique_ptr<WorkEntry>(
         new WorkEntry(nullptr, &outputTensors, std::move(runFunc)));
-    return enqueue(std::move(entry));
+    return enqueue(std::move(entry), __func__);
+  }
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::reduceScatter(
+    std::vector<at::Tensor>& outputTensors,
+    std::vector<std::vector<at::Tensor>>& inputTensors,
+    const ReduceScatterOptions& opts) {
+  checkSingleTensor(outputTensors);
+  if (inputTensors.size() != 1) {
+    throw std::runtime_error(
+        "MPI process group only supports a single "
+        "tensor op");
+  }
+  if (static_cast<size_t>(size_) != inputTensors[0].size()) {
+    throw std::runtime_error(
+        "Reduce scatter: number of input tensors should equal "
+        "to the world size");
+  }
+
+  checkSameSizeAndType(outputTensors[0], inputTensors[0]);
+
+  std::function<void(std::unique_ptr<WorkEntry>&)> runFunc =
+      [opts](std::unique_ptr<WorkEntry>& entry) {
+        auto data = (*entry->dst)[0];
+        std::vector<at::Tensor>& inputDataVec = *(entry->src);
+        auto flatInputTensor = newLikeFlat(inputDataVec);
+
+        // copy the input tensors to the flatten large send buffer
+        for (size_t i = 0; i < inputDataVec.size(); ++i) {
+          flatInputTensor[i].copy_(inputDataVec[i]);
+        }
+
+        MPI_CHECK(MPI_Reduce_scatter_block(
+            flatInputTensor.data_ptr(),
+            data.data_ptr(),
+            data.numel(),
+            mpiDatatype.at(data.type().scalarType()),
+            mpiOp.at(opts.reduceOp),
+            MPI_COMM_WORLD));
+      };
+  auto entry = std::unique_ptr<WorkEntry>(
+      new WorkEntry(&inputTensors[0], &outputTensors, std::move(runFunc)));
+  return enqueue(std::move(entry), __func__);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::alltoall(
+    std::vector<std::vector<at::Tensor>>& outputTensors,
+    std::vector<std::vector<at::Tensor>>& inputTensors,
+    const AllToAllOptions& /* unused */) {
+  if (inputTensors.size() != 1 || outputTensors.size() != 1) {
+    throw std::runtime_error(
+        "MPI process group only supports a single "
+        "tensor op");
   }
+  if (static_cast<size_t>(size_) != inputTensors[0].size() ||
+      static_cast<size_t>(size_) != outputTensors[0].size()) {
+    throw std::runtime_error(
+        "All to all: number of input and output tensors should equal "
+        "to the world size");
+  }
+
+  checkSameSizeAndType(inputTensors[0][0], inputTensors[0]);
+  checkSameSizeAndType(inputTensors[0][0], outputTensors[0]);
+
+  std::function<void(std::unique_ptr<WorkEntry>&)> runFunc =
+      [](std::unique_ptr<WorkEntry>& entry) {
+        std::vector<at::Tensor>& inputDataVec = *(entry->src);
+        std::vector<at::Tensor>& outputDataVec = *(entry->dst);
+        auto flatInputTensor = newLikeFlat(inputDataVec);
+        auto flatOutputTensor = newLikeFlat(outputDataVec);
+        auto& data = inputDataVec[0];
+
+        for (size_t i = 0; i < inputDataVec.size(); ++i) {
+          flatInputTensor[i].copy_(inputDataVec[i]);
+        }
+
+        MPI_CHECK(MPI_Alltoall(
+            flatInputTensor.data_ptr(),
+            data.numel(),
+            mpiDatatype.at(data.type().scalarType()),
+            flatOutputTensor.data_ptr(),
+            data.numel(),
+            mpiDatatype.at(data.type().scalarType()),
+            MPI_COMM_WORLD));
+
+        for (size_t i = 0; i < outputDataVec.size(); ++i) {
+          outputDataVec[i].copy_(flatOutputTensor[i]);
+        }
+      };
+  auto entry = std::unique_ptr<WorkEntry>(
+      new WorkEntry(&inputTensors[0], &outputTensors[0], std::move(runFunc)));
+  return enqueue(std::move(entry), __func__);
 }
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::send(
@@ -525,7 +682,7 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::send(
       };
   auto entry = std::unique_ptr<WorkEntry>(
       new WorkEntry(&tensors, nullptr, std::move(runFunc)));
-  return enqueue(std::move(entry));
+  return enqueue(std::move(entry), __func__);
 }
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::recv(
@@ -546,7 +703,7 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::recv(
       };
   auto entry = std::unique_ptr<WorkEntry>(
       new WorkEntry(&tensors, nullptr, std::move(runFunc)));
-  return enqueue(std::move(entry));
+  return enqueue(std::move(entry), __func__);
 }
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::recvAnysource(
@@ -570,17 +727,17 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::recvAnysource(
   auto entry = std::unique_ptr<WorkEntry>(
       new WorkEntry(&tensors, nullptr, std::move(runFunc)));
   entry->srcRank = srcRank;
-  return enqueue(std::move(entry));
+  return enqueue(std::move(entry), __func__);
 }
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::barrier() {
   std::function<void(std::unique_ptr<WorkEntry>&)> runFunc =
       [](std::unique_ptr<WorkEntry>& entry) {
-        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+        MPI_CHECK(MPI_Ibarrier(MPI_COMM_WORLD, &entry->request));
       };
   auto entry = std::unique_ptr<WorkEntry>(
       new WorkEntry(nullptr, nullptr, std::move(runFunc)));
-  return enqueue(std::move(entry));
+  return enqueue(std::move(entry), __func__);
 }
 
 } // namespace c10d
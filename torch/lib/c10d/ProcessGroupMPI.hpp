@@ -8,6 +8,8 @@
 #include <thread>
 #include <vector>
 
+#include <mpi.h>
+
 #include <c10d/ProcessGroup.hpp>
 #include <c10d/Types.hpp>
 #include <c10d/Utils.hpp>
@@ -34,6 +36,10 @@ struct WorkEntry {
   std::vector<at::Tensor>* dst;
   // src rank returned, for recv only
   int* srcRank;
+  // name of the operation, for the c10d_collective_start/end tracepoints
+  const char* name = nullptr;
+  // set by run functions that start a non-blocking MPI call
+  MPI_Request request = MPI_REQUEST_NULL;
   std::function<void(std::unique_ptr<WorkEntry>&)> run;
 };
 
@@ -56,6 +62,13 @@ struct WorkEntry {
 // implemenation to have a thread support value of MPI_THREAD_MULTIPLE, that is,
 // multiple threads may call MPI, with no restriction.
 //
+// broadcast, allreduce, reduce and barrier are started with the non-blocking
+// MPI calls (MPI_Ibcast, MPI_Iallreduce, ...). With MPI_THREAD_MULTIPLE, the
+// worker thread moves on to the next queued operation as soon as one is
+// started, so several of them can be in flight at once, and the request is
+// completed by WorkMPI::isCompleted() and WorkMPI::wait(). Otherwise the worker
+// thread waits for each request before starting the next operation.
+//
 // Also note that ProcessGroupMPI only supports a single Tensor operation. In
 // other words, the size of the input Tensor vector should always be 1.
 //
@@ -89,11 +102,22 @@ class ProcessGroupMPI : public ProcessGroup {
     void finish();
     void finishWithException(std::exception_ptr caughtWorkException);
 
-    std::mutex workMutex_;
-    std::condition_variable workCV_;
-    std::atomic<bool> completed_;
+    // Hands over a request started by the worker thread, along with the
+    // tensors it reads or writes, which have to stay alive until it completes
+    void start(MPI_Request request, std::vector<at::Tensor> tensors);
+    // Tests or waits for the in-flight request, with workMutex_ held
+    void completeRequest(bool blocking) const;
+
+    // isCompleted() polls the in-flight request, so the state it updates is
+    // mutable
+    mutable std::mutex workMutex_;
+    mutable std::condition_variable workCV_;
+    mutable std::atomic<bool> completed_;
 
-    std::exception_ptr workException_;
+    mutable std::exception_ptr workException_;
+
+    mutable MPI_Request request_;
+    mutable std::vector<at::Tensor> tensors_;
 
     friend class ProcessGroupMPI;
   };
@@ -132,6 +156,16 @@ class ProcessGroupMPI : public ProcessGroup {
       std::vector<std::vector<at::Tensor>>& inputTensors,
       const ScatterOptions& opts = ScatterOptions()) override;
 
+  std::shared_ptr<ProcessGroup::Work> reduceScatter(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensors,
+      const ReduceScatterOptions& opts = ReduceScatterOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> alltoall(
+      std::vector<std::vector<at::Tensor>>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensors,
+      const AllToAllOptions& opts = AllToAllOptions()) override;
+
   std::shared_ptr<ProcessGroup::Work> send(
       std::vector<at::Tensor>& tensors,
       int dstRank);
@@ -157,7 +191,9 @@ class ProcessGroupMPI : public ProcessGroup {
   // Helper function that is called by the destructor
   void destroy();
 
-  std::shared_ptr<ProcessGroup::Work> enqueue(std::unique_ptr<WorkEntry> entry);
+  std::shared_ptr<ProcessGroup::Work> enqueue(
+      std::unique_ptr<WorkEntry> entry,
+      const char* name);
 
   bool stop_;
 
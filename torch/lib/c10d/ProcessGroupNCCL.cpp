@@ -1,8 +1,17 @@
 #include "ProcessGroupNCCL.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <climits>
 #include <map>
+#include <system_error>
+#include <tuple>
 #include <unordered_set>
 
+#include <unistd.h>
+
+#include <ATen/core/StaticTracepoint.h>
 #include <THC.h>
 #include <THC/THCGeneral.hpp>
 
@@ -84,6 +93,45 @@ void syncStreams(
   }
 }
 
+// Helper that checks that all tensors of a per-device tensor list match the
+// number of elements of the given tensor
+void checkSameNumel(
+    const at::Tensor& tensor,
+    const std::vector<at::Tensor>& tensors) {
+  for (auto& t : tensors) {
+    if (t.numel() != tensor.numel()) {
+      throw std::runtime_error(
+          "Expecting all tensors of a device to have identical "
+          "number of elements");
+    }
+  }
+}
+
+// The NCCL communicators shared between process groups, see
+// Options::shareCommunicators. The store is kept alive so that its address
+// can't be reused by another store while it is part of the key.
+struct SharedNCCLComms {
+  std::shared_ptr<Store> store;
+  int rank;
+  std::vector<std::shared_ptr<NCCLComm>> comms;
+  std::vector<CUDAStream> streams;
+};
+
+std::mutex sharedNCCLCommsLock;
+
+// Number of NCCL unique ID batches created for shared communicators
+ssize_t sharedNCCLIDCnt = -1;
+
+// Keyed by store, process group size and device list. Never destroyed, so
+// that the communicators aren't torn down after CUDA at exit.
+std::map<std::tuple<const Store*, int, std::string>, SharedNCCLComms>&
+sharedNCCLComms() {
+  static auto cache = new std::map<
+      std::tuple<const Store*, int, std::string>,
+      SharedNCCLComms>();
+  return *cache;
+}
+
 } // namespace
 
 ProcessGroupNCCL::WorkNCCL::WorkNCCL(const std::vector<at::Device>& devices)
@@ -157,11 +205,22 @@ std::unordered_map<ssize_t, ssize_t> ProcessGroupNCCL::pgUniqueNCCLIDCnt_;
 ssize_t ProcessGroupNCCL::processGroupCounter_ = -1;
 std::mutex ProcessGroupNCCL::pgTrackingLock_;
 
+ProcessGroupNCCL::Options::Options()
+    : hierarchicalAllreduce(false), shareCommunicators(false) {}
+
 ProcessGroupNCCL::ProcessGroupNCCL(
     const std::shared_ptr<Store>& store,
     int rank,
-    int size)
-    : ProcessGroup(rank, size), store_(store) {
+    int size,
+    Options options)
+    : ProcessGroup(rank, size),
+      store_(store),
+      options_(options),
+      hierarchicalInitialized_(false),
+      hierarchicalEnabled_(false),
+      hierarchicalDevice_(-1),
+      localRank_(-1),
+      localSize_(-1) {
   thcState_ = ::at::globalContext().lazyInitCUDA();
   // Generate the Process Group ID for current PG, this needs to be identical
   // for all processes
@@ -176,23 +235,39 @@ ProcessGroupNCCL::~ProcessGroupNCCL() {
   pgUniqueNCCLIDCnt_.erase(std::stoull(processGroupID_));
 }
 
-void ProcessGroupNCCL::broadcastUniqueNCCLID(ncclUniqueId* ncclID) {
-  // Every time when we create a new unique NCCL ID, we need to use a new
-  // global key to access/update the store.
-  // The key is a combination of processGroupID_ and the current count of
-  // NCCL unique ID created
-  std::unique_lock<std::mutex> lock(pgTrackingLock_);
-  auto processGroupIDKey = std::stoull(processGroupID_);
-  auto uniqueNCCLIDCnt = pgUniqueNCCLIDCnt_[processGroupIDKey] + 1;
-  pgUniqueNCCLIDCnt_[processGroupIDKey] = uniqueNCCLIDCnt;
-
-  lock.unlock();
-
-  std::string storeKey =
-      processGroupID_ + "_" + std::to_string(uniqueNCCLIDCnt);
-
+void ProcessGroupNCCL::broadcastUniqueNCCLIDs(
+    std::vector<ncclUniqueId>& ncclIDs,
+    const std::vector<std::string>& storeKeys) {
   // Rank 0 writes to the store as bcast
   if (rank_ == 0) {
+    std::vector<std::vector<uint8_t>> ncclIDVals;
+    for (auto& ncclID : ncclIDs) {
+      ncclIDVals.emplace_back(
+          reinterpret_cast<uint8_t*>(&ncclID),
+          reinterpret_cast<uint8_t*>(&ncclID) + NCCL_UNIQUE_ID_BYTES);
+    }
+    store_->multiSet(storeKeys, ncclIDVals);
+    // Other ranks get to the store
+  } else {
+    auto ncclIDVals = store_->multiGet(storeKeys);
+    for (size_t i = 0; i < ncclIDs.size(); ++i) {
+      // Just a sanity check
+      if (ncclIDVals[i].size() != NCCL_UNIQUE_ID_BYTES) {
+        throw std::runtime_error(
+            "Unexpected NCCL unique ID length received "
+            "from the store");
+      }
+      // Now put the data back to the input pointer
+      memcpy(&ncclIDs[i], ncclIDVals[i].data(), NCCL_UNIQUE_ID_BYTES);
+    }
+  }
+}
+
+void ProcessGroupNCCL::exchangeNCCLID(
+    ncclUniqueId* ncclID,
+    const std::string& storeKey,
+    bool isRoot) {
+  if (isRoot) {
     auto ncclIDVal = std::vector<uint8_t>(
         reinterpret_cast<uint8_t*>(ncclID),
         reinterpret_cast<uint8_t*>(ncclID) + NCCL_UNIQUE_ID_BYTES);
@@ -214,66 +289,264 @@ void ProcessGroupNCCL::broadcastUniqueNCCLID(ncclUniqueId* ncclID) {
 std::vector<std::shared_ptr<NCCLComm>>& ProcessGroupNCCL::getNCCLComm(
     const std::string& devicesKey,
     const std::vector<at::Device>& devices) {
-  // Sanity check
-  if (devicesKey.empty()) {
-    throw std::runtime_error(
-        "Not able to create/get the NCCL Communicator since "
-        "the GPU devices are not known");
-  }
-  if (devNCCLCommMap_.find(devicesKey) != devNCCLCommMap_.end()) {
+  auto it = devNCCLCommMap_.find(devicesKey);
+  if (it != devNCCLCommMap_.end()) {
     // Reuse the cached communicator if there is one.
-    return devNCCLCommMap_[devicesKey];
+    return it->second;
   }
   // NCCL communicator not cached, create a new entry
-  std::vector<std::shared_ptr<NCCLComm>> ncclComms;
-  ncclComms.resize(devices.size());
+  createNCCLComms({devices});
+  return devNCCLCommMap_[devicesKey];
+}
 
-  // Create the unique NCCL ID and broadcast it
-  ncclUniqueId ncclID;
+void ProcessGroupNCCL::initNCCLComms(
+    const std::vector<std::vector<at::Device>>& devices) {
+  createNCCLComms(devices);
+}
 
-  if (rank_ == 0) {
-    C10D_NCCL_CHECK(ncclGetUniqueId(&ncclID));
+bool ProcessGroupNCCL::lookupSharedNCCLComms(const std::string& devicesKey) {
+  std::unique_lock<std::mutex> lock(sharedNCCLCommsLock);
+  auto& cache = sharedNCCLComms();
+  auto it = cache.find(std::make_tuple(store_.get(), size_, devicesKey));
+  if (it == cache.end()) {
+    return false;
+  }
+  auto& shared = it->second;
+  if (shared.rank != rank_) {
+    throw std::runtime_error(
+        "Expecting process groups sharing NCCL communicators to have the "
+        "same rank, got " +
+        std::to_string(rank_) + " and " + std::to_string(shared.rank));
   }
-
-  // Broadcast so that each process can have a unique NCCL ID
-  broadcastUniqueNCCLID(&ncclID);
 
   at::DeviceGuard gpuGuard;
-
-  std::vector<CUDAEvent> eventVal;
   std::vector<CUDAStream> streamVal;
+  std::vector<CUDAEvent> eventVal;
+  for (auto& stream : shared.streams) {
+    gpuGuard.set_index(THCStream_device(stream.getTHCStream()));
+    // The streams are shared as well, so that the operations of all
+    // process groups run in order on the communicators
+    THCStream_retain(stream.getTHCStream());
+    streamVal.emplace_back(stream.getTHCStream());
+    eventVal.push_back(CUDAEvent::create(cudaEventDisableTiming));
+  }
+  devNCCLCommMap_.emplace(devicesKey, shared.comms);
+  ncclStreams_.emplace(devicesKey, std::move(streamVal));
+  ncclEvents_.emplace(devicesKey, std::move(eventVal));
+  return true;
+}
 
-  eventVal.resize(devices.size());
-  streamVal.resize(devices.size());
+void ProcessGroupNCCL::createNCCLComms(
+    const std::vector<std::vector<at::Device>>& devices) {
+  // Collect the device lists without cached communicators
+  std::vector<std::string> devicesKeys;
+  std::vector<const std::vector<at::Device>*> pendingDevices;
+  for (auto& deviceList : devices) {
+    auto devicesKey = getKeyFromDevices(deviceList);
+    // Sanity check
+    if (devicesKey.empty()) {
+      throw std::runtime_error(
+          "Not able to create/get the NCCL Communicator since "
+          "the GPU devices are not known");
+    }
+    if (devNCCLCommMap_.find(devicesKey) != devNCCLCommMap_.end() ||
+        std::find(devicesKeys.begin(), devicesKeys.end(), devicesKey) !=
+            devicesKeys.end()) {
+      continue;
+    }
+    if (options_.shareCommunicators && lookupSharedNCCLComms(devicesKey)) {
+      continue;
+    }
+    devicesKeys.push_back(devicesKey);
+    pendingDevices.push_back(&deviceList);
+  }
+  if (devicesKeys.empty()) {
+    return;
+  }
 
-  // Create the NCCL communicators for each GPU
-  C10D_NCCL_CHECK(ncclGroupStart());
+  // Every time when we create new unique NCCL IDs, we need to use new
+  // global keys to access/update the store. The key is a combination of
+  // processGroupID_ (or a process wide prefix for shared communicators,
+  // which may be created by any of the process groups sharing them), the
+  // current count of NCCL unique ID batches created and the index within
+  // the batch.
+  std::string storeKeyPrefix;
+  if (options_.shareCommunicators) {
+    std::unique_lock<std::mutex> lock(sharedNCCLCommsLock);
+    storeKeyPrefix = "shared_" + std::to_string(++sharedNCCLIDCnt);
+  } else {
+    std::unique_lock<std::mutex> lock(pgTrackingLock_);
+    auto processGroupIDKey = std::stoull(processGroupID_);
+    auto uniqueNCCLIDCnt = pgUniqueNCCLIDCnt_[processGroupIDKey] + 1;
+    pgUniqueNCCLIDCnt_[processGroupIDKey] = uniqueNCCLIDCnt;
+    storeKeyPrefix = processGroupID_ + "_" + std::to_string(uniqueNCCLIDCnt);
+  }
+  std::vector<std::string> storeKeys;
+  for (size_t i = 0; i < devicesKeys.size(); ++i) {
+    storeKeys.push_back(storeKeyPrefix + "_" + std::to_string(i));
+  }
 
-  for (size_t i = 0; i < devices.size(); ++i) {
-    // GPU world size and GPU rank
-    int numRanks = getSize() * devices.size();
-    int rank = getRank() * devices.size() + i;
+  // Create the unique NCCL IDs and broadcast them
+  std::vector<ncclUniqueId> ncclIDs(devicesKeys.size());
+  if (rank_ == 0) {
+    for (auto& ncclID : ncclIDs) {
+      C10D_NCCL_CHECK(ncclGetUniqueId(&ncclID));
+    }
+  }
+  broadcastUniqueNCCLIDs(ncclIDs, storeKeys);
 
-    gpuGuard.set_index(devices[i].index());
-    ncclComms[i] = NCCLComm::create(numRanks, rank, ncclID);
+  at::DeviceGuard gpuGuard;
 
-    // Also create the NCCL streams and events
-    streamVal[i] = CUDAStream::create();
-    // Event created using cudaEventDisableTiming flag and not
-    // cudaEventBlockingSync flag will provide the best performance when used
-    // with cudaStreamWaitEvent() and cudaEventQuery(). Since we here don't
-    // measure the performance using cudaEvent, this should be set.
-    eventVal[i] = CUDAEvent::create(cudaEventDisableTiming);
+  std::vector<std::vector<std::shared_ptr<NCCLComm>>> ncclComms(
+      devicesKeys.size());
+  std::vector<std::vector<CUDAEvent>> eventVals(devicesKeys.size());
+  std::vector<std::vector<CUDAStream>> streamVals(devicesKeys.size());
+
+  // Create the NCCL communicators for each GPU of every device list
+  C10D_NCCL_CHECK(ncclGroupStart());
+
+  for (size_t j = 0; j < devicesKeys.size(); ++j) {
+    auto& deviceList = *pendingDevices[j];
+    ncclComms[j].resize(deviceList.size());
+    eventVals[j].resize(deviceList.size());
+    streamVals[j].resize(deviceList.size());
+
+    for (size_t i = 0; i < deviceList.size(); ++i) {
+      // GPU world size and GPU rank
+      int numRanks = getSize() * deviceList.size();
+      int rank = getRank() * deviceList.size() + i;
+
+      gpuGuard.set_index(deviceList[i].index());
+      ncclComms[j][i] = NCCLComm::create(numRanks, rank, ncclIDs[j]);
+
+      // Also create the NCCL streams and events
+      streamVals[j][i] = CUDAStream::create();
+      // Event created using cudaEventDisableTiming flag and not
+      // cudaEventBlockingSync flag will provide the best performance when
+      // used with cudaStreamWaitEvent() and cudaEventQuery(). Since we here
+      // don't measure the performance using cudaEvent, this should be set.
+      eventVals[j][i] = CUDAEvent::create(cudaEventDisableTiming);
+    }
   }
 
   C10D_NCCL_CHECK(ncclGroupEnd());
 
+  // Offer the new communicators to the other process groups
+  if (options_.shareCommunicators) {
+    std::unique_lock<std::mutex> lock(sharedNCCLCommsLock);
+    auto& cache = sharedNCCLComms();
+    for (size_t j = 0; j < devicesKeys.size(); ++j) {
+      SharedNCCLComms shared;
+      shared.store = store_;
+      shared.rank = rank_;
+      shared.comms = ncclComms[j];
+      for (auto& stream : streamVals[j]) {
+        THCStream_retain(stream.getTHCStream());
+        shared.streams.emplace_back(stream.getTHCStream());
+      }
+      cache.emplace(
+          std::make_tuple(store_.get(), size_, devicesKeys[j]),
+          std::move(shared));
+    }
+  }
+
   // Move the NCCL resource to cache
-  devNCCLCommMap_.emplace(devicesKey, std::move(ncclComms));
-  ncclStreams_.emplace(devicesKey, std::move(streamVal));
-  ncclEvents_.emplace(devicesKey, std::move(eventVal));
+  for (size_t j = 0; j < devicesKeys.size(); ++j) {
+    devNCCLCommMap_.emplace(devicesKeys[j], std::move(ncclComms[j]));
+    ncclStreams_.emplace(devicesKeys[j], std::move(streamVals[j]));
+    ncclEvents_.emplace(devicesKeys[j], std::move(eventVals[j]));
+  }
+}
 
-  return devNCCLCommMap_[devicesKey];
+bool ProcessGroupNCCL::initHierarchicalComms(const at::Device& device) {
+  if (hierarchicalInitialized_) {
+    // The decision must be identical on all ranks, so a different device
+    // can't simply fall back to the flat allreduce
+    if (hierarchicalEnabled_ && device.index() != hierarchicalDevice_) {
+      throw std::runtime_error(
+          "Hierarchical allreduce expects the tensors of a process to be "
+          "on the same GPU device in every call");
+    }
+    return hierarchicalEnabled_;
+  }
+  hierarchicalInitialized_ = true;
+
+  // Publish the host of this rank and collect the hosts of all ranks
+  std::array<char, HOST_NAME_MAX + 1> hostname{};
+  if (gethostname(hostname.data(), HOST_NAME_MAX) != 0) {
+    throw std::system_error(errno, std::system_category());
+  }
+  const std::string host(hostname.data());
+  const std::string hostKeyPrefix = processGroupID_ + "_host_";
+  store_->set(
+      hostKeyPrefix + std::to_string(rank_),
+      std::vector<uint8_t>(host.begin(), host.end()));
+
+  // Group the ranks by host, the hosts are ordered by their lowest rank
+  std::vector<std::string> hosts;
+  std::vector<std::vector<int>> hostRanks;
+  std::vector<std::string> hostKeys;
+  for (int rank = 0; rank < size_; ++rank) {
+    hostKeys.push_back(hostKeyPrefix + std::to_string(rank));
+  }
+  const auto hostValues = store_->multiGet(hostKeys);
+  for (int rank = 0; rank < size_; ++rank) {
+    const auto& value = hostValues[rank];
+    std::string rankHost(value.begin(), value.end());
+    auto it = std::find(hosts.begin(), hosts.end(), rankHost);
+    if (it == hosts.end()) {
+      hosts.push_back(rankHost);
+      hostRanks.emplace_back();
+      it = hosts.end() - 1;
+    }
+    hostRanks[it - hosts.begin()].push_back(rank);
+  }
+
+  const int node = std::find(hosts.begin(), hosts.end(), host) - hosts.begin();
+  const auto& localRanks = hostRanks[node];
+  localSize_ = localRanks.size();
+  localRank_ =
+      std::find(localRanks.begin(), localRanks.end(), rank_) -
+      localRanks.begin();
+
+  // All ranks see the same host list, so they all take the same decision
+  bool uniform = true;
+  for (const auto& ranks : hostRanks) {
+    uniform = uniform && static_cast<int>(ranks.size()) == localSize_;
+  }
+  if (hosts.size() < 2 || localSize_ < 2 || !uniform) {
+    return false;
+  }
+
+  at::DeviceGuard gpuGuard(device.index());
+
+  // One communicator between the ranks on this host, rooted at the lowest
+  // rank on the host
+  ncclUniqueId intraNodeID;
+  if (localRank_ == 0) {
+    C10D_NCCL_CHECK(ncclGetUniqueId(&intraNodeID));
+  }
+  exchangeNCCLID(
+      &intraNodeID,
+      processGroupID_ + "_intra_node_" + std::to_string(node),
+      localRank_ == 0);
+  intraNodeComm_ = NCCLComm::create(localSize_, localRank_, intraNodeID);
+
+  // One communicator between the ranks with this local rank on every host,
+  // rooted at the one on the first host
+  ncclUniqueId interNodeID;
+  if (node == 0) {
+    C10D_NCCL_CHECK(ncclGetUniqueId(&interNodeID));
+  }
+  exchangeNCCLID(
+      &interNodeID,
+      processGroupID_ + "_inter_node_" + std::to_string(localRank_),
+      node == 0);
+  interNodeComm_ = NCCLComm::create(hosts.size(), node, interNodeID);
+
+  hierarchicalDevice_ = device.index();
+  hierarchicalEnabled_ = true;
+  return true;
 }
 
 // Helper function that checks the input and output tensors for validity
@@ -356,8 +629,21 @@ void ProcessGroupNCCL::tensorCheckHelper(
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allreduce(
     std::vector<at::Tensor>& tensors,
     const AllreduceOptions& opts) {
+  if (!tensors.empty() && tensors[0].is_sparse()) {
+    return allreduceSparse(tensors, opts);
+  }
+
   tensorCheckHelper(tensors, tensors);
 
+  if (opts.compression != AllreduceCompression::NONE) {
+    return allreduceCompressed(tensors, opts);
+  }
+
+  if (options_.hierarchicalAllreduce && tensors.size() == 1 &&
+      initHierarchicalComms(tensors[0].device())) {
+    return hierarchicalAllreduce(tensors, opts);
+  }
+
   auto devices = getDeviceList(tensors);
   auto key = getKeyFromDevices(devices);
   auto& ncclComms = getNCCLComm(key, devices);
@@ -373,6 +659,9 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allreduce(
   std::unique_lock<std::mutex> cudaFreeMutexLock(
       *(THCCachingAllocator_getCudaFreeMutex()));
 
+  // NCCL runs asynchronously, so the c10d_collective_start/end tracepoints
+  // only bracket enqueueing the collective on the NCCL streams
+  AT_SDT(c10d_collective_start, this, __func__);
   C10D_NCCL_CHECK(ncclGroupStart());
 
   for (size_t i = 0; i < tensors.size(); ++i) {
@@ -390,6 +679,7 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allreduce(
   }
 
   C10D_NCCL_CHECK(ncclGroupEnd());
+  AT_SDT(c10d_collective_end, this, __func__);
 
   // Event should only be recorded after the ncclGroupEnd()
   for (size_t i = 0; i < tensors.size(); ++i) {
@@ -403,6 +693,99 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allreduce(
   return work;
 }
 
+std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::hierarchicalAllreduce(
+    std::vector<at::Tensor>& tensors,
+    const AllreduceOptions& opts) {
+  auto devices = getDeviceList(tensors);
+  auto key = getKeyFromDevices(devices);
+  auto& tensor = tensors[0];
+
+  at::DeviceGuard gpuGuard(devices[0].index());
+
+  // Hierarchical allreduce never uses the flat communicator, only create the
+  // NCCL stream and event
+  if (ncclStreams_.find(key) == ncclStreams_.end()) {
+    std::vector<CUDAStream> streamVal(1);
+    std::vector<CUDAEvent> eventVal(1);
+    streamVal[0] = CUDAStream::create();
+    eventVal[0] = CUDAEvent::create(cudaEventDisableTiming);
+    ncclStreams_.emplace(key, std::move(streamVal));
+    ncclEvents_.emplace(key, std::move(eventVal));
+  }
+  CUDAStream& ncclStream = ncclStreams_[key][0];
+
+  // Every local rank reduces one shard, pad the tensor if it doesn't split
+  // evenly
+  const int64_t shardNumel = (tensor.numel() + localSize_ - 1) / localSize_;
+  const bool padded = shardNumel * localSize_ != tensor.numel();
+  at::Tensor buffer = tensor;
+  if (padded) {
+    buffer = tensor.type().zeros({shardNumel * localSize_});
+    buffer.narrow(0, 0, tensor.numel()).copy_(tensor.view({-1}));
+  }
+
+  // First let NCCL streams wait for THC stream, this also orders the
+  // NCCL kernels after the copy to the padded buffer
+  syncStreams(thcState_, devices, ncclEvents_[key], ncclStreams_[key]);
+
+  // Work itself will create the CUDA events on all GPUs of tensors
+  auto work = std::make_shared<ProcessGroupNCCL::WorkNCCL>(devices);
+
+  std::unique_lock<std::mutex> cudaFreeMutexLock(
+      *(THCCachingAllocator_getCudaFreeMutex()));
+
+  if (padded) {
+    // The padded buffer is freed when this function returns, keep the
+    // caching allocator from reusing it before the NCCL stream is done
+    THCCachingAllocator_recordStream(
+        buffer.data_ptr(), ncclStream.getTHCStream());
+  }
+
+  auto dataType = getNcclDataType(tensor.type().scalarType());
+  auto data = static_cast<char*>(buffer.data_ptr());
+  auto shard =
+      data + localRank_ * shardNumel * tensor.type().elementSizeInBytes();
+
+  // All three steps run in place: the shard of this rank is the slice of
+  // the buffer at its local rank
+  C10D_NCCL_CHECK(ncclReduceScatter(
+      data,
+      shard,
+      shardNumel,
+      dataType,
+      ncclOp[opts.reduceOp],
+      intraNodeComm_->getNcclComm(),
+      ncclStream.getStream()));
+
+  C10D_NCCL_CHECK(ncclAllReduce(
+      shard,
+      shard,
+      shardNumel,
+      dataType,
+      ncclOp[opts.reduceOp],
+      interNodeComm_->getNcclComm(),
+      ncclStream.getStream()));
+
+  C10D_NCCL_CHECK(ncclAllGather(
+      shard,
+      data,
+      shardNumel,
+      dataType,
+      intraNodeComm_->getNcclComm(),
+      ncclStream.getStream()));
+
+  if (padded) {
+    THCStreamGuard guard(thcState_, ncclStream);
+    tensor.view({-1}).copy_(buffer.narrow(0, 0, tensor.numel()));
+  }
+
+  CUDAEvent& cudaEvent = work->cudaEvents_[0];
+  C10D_CUDA_CHECK(
+      cudaEventRecord(cudaEvent.getEvent(), ncclStream.getStream()));
+
+  return work;
+}
+
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::broadcast(
     std::vector<at::Tensor>& tensors,
     const BroadcastOptions& opts) {
@@ -423,6 +806,7 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::broadcast(
   std::unique_lock<std::mutex> cudaFreeMutexLock(
       *(THCCachingAllocator_getCudaFreeMutex()));
 
+  AT_SDT(c10d_collective_start, this, __func__);
   C10D_NCCL_CHECK(ncclGroupStart());
 
   for (size_t i = 0; i < tensors.size(); ++i) {
@@ -441,6 +825,7 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::broadcast(
   }
 
   C10D_NCCL_CHECK(ncclGroupEnd());
+  AT_SDT(c10d_collective_end, this, __func__);
 
   // Event should only be recorded after the ncclGroupEnd()
   for (size_t i = 0; i < tensors.size(); ++i) {
@@ -474,6 +859,7 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::reduce(
   std::unique_lock<std::mutex> cudaFreeMutexLock(
       *(THCCachingAllocator_getCudaFreeMutex()));
 
+  AT_SDT(c10d_collective_start, this, __func__);
   C10D_NCCL_CHECK(ncclGroupStart());
 
   for (size_t i = 0; i < tensors.size(); ++i) {
@@ -494,6 +880,7 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::reduce(
   }
 
   C10D_NCCL_CHECK(ncclGroupEnd());
+  AT_SDT(c10d_collective_end, this, __func__);
 
   // Event should only be recorded after the ncclGroupEnd()
   for (size_t i = 0; i < tensors.size(); ++i) {
@@ -538,6 +925,7 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allgather(
   std::unique_lock<std::mutex> cudaFreeMutexLock(
       *(THCCachingAllocator_getCudaFreeMutex()));
 
+  AT_SDT(c10d_collective_start, this, __func__);
   C10D_NCCL_CHECK(ncclGroupStart());
 
   for (size_t i = 0; i < inputTensors.size(); ++i) {
@@ -561,6 +949,7 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allgather(
   }
 
   C10D_NCCL_CHECK(ncclGroupEnd());
+  AT_SDT(c10d_collective_end, this, __func__);
 
   // Copy the flattened output tensors to the outputs
   for (size_t i = 0; i < outputTensors.size(); ++i) {
@@ -580,6 +969,210 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allgather(
   return work;
 }
 
+std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::reduceScatter(
+    std::vector<at::Tensor>& outputTensors,
+    std::vector<std::vector<at::Tensor>>& inputTensors,
+    const ReduceScatterOptions& opts) {
+  if (outputTensors.size() != inputTensors.size()) {
+    throw std::runtime_error("reduce_scatter: input and output size mismatch");
+  }
+  // Every GPU of every process is a participant of the NCCL communicator
+  int numRanks = getSize() * outputTensors.size();
+
+  std::vector<at::Tensor> flattenInputTensors;
+  flattenInputTensors.resize(inputTensors.size());
+
+  for (size_t i = 0; i < inputTensors.size(); ++i) {
+    tensorCheckHelper(
+        std::vector<at::Tensor>{outputTensors[i]}, inputTensors[i], numRanks);
+    checkSameNumel(outputTensors[i], inputTensors[i]);
+    // Flatten the input tensors (for all ranks) to a single big tensor
+    flattenInputTensors[i] = newLikeFlat(inputTensors[i]);
+    for (size_t j = 0; j < inputTensors[i].size(); ++j) {
+      flattenInputTensors[i][j].copy_(inputTensors[i][j], true);
+    }
+  }
+
+  auto devices = getDeviceList(outputTensors);
+  auto key = getKeyFromDevices(devices);
+  auto& ncclComms = getNCCLComm(key, devices);
+
+  // First let NCCL streams wait for THC stream, this also orders the
+  // NCCL kernels after the copies to the flattened input tensors
+  syncStreams(thcState_, devices, ncclEvents_[key], ncclStreams_[key]);
+
+  // Work itself will create the CUDA events on all GPUs of tensors
+  auto work = std::make_shared<ProcessGroupNCCL::WorkNCCL>(devices);
+
+  at::DeviceGuard gpuGuard;
+
+  std::unique_lock<std::mutex> cudaFreeMutexLock(
+      *(THCCachingAllocator_getCudaFreeMutex()));
+
+  AT_SDT(c10d_collective_start, this, __func__);
+  C10D_NCCL_CHECK(ncclGroupStart());
+
+  for (size_t i = 0; i < outputTensors.size(); ++i) {
+    gpuGuard.set_index(devices[i].index());
+    CUDAStream& ncclStream = ncclStreams_[key][i];
+
+    // The flattened input is freed when this function returns, keep the
+    // caching allocator from reusing it before the NCCL stream is done
+    THCCachingAllocator_recordStream(
+        flattenInputTensors[i].data_ptr(), ncclStream.getTHCStream());
+
+    C10D_NCCL_CHECK(ncclReduceScatter(
+        flattenInputTensors[i].data_ptr(),
+        outputTensors[i].data_ptr(),
+        outputTensors[i].numel(),
+        getNcclDataType(outputTensors[i].type().scalarType()),
+        ncclOp[opts.reduceOp],
+        ncclComms[i]->getNcclComm(),
+        ncclStream.getStream()));
+  }
+
+  C10D_NCCL_CHECK(ncclGroupEnd());
+  AT_SDT(c10d_collective_end, this, __func__);
+
+  // Event should only be recorded after the ncclGroupEnd()
+  for (size_t i = 0; i < outputTensors.size(); ++i) {
+    CUDAStream& ncclStream = ncclStreams_[key][i];
+    CUDAEvent& cudaEvent = work->cudaEvents_[i];
+
+    C10D_CUDA_CHECK(
+        cudaEventRecord(cudaEvent.getEvent(), ncclStream.getStream()));
+  }
+
+  return work;
+}
+
+#ifdef C10D_NCCL_HAS_SEND_RECV
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::alltoall(
+    std::vector<std::vector<at::Tensor>>& outputTensors,
+    std::vector<std::vector<at::Tensor>>& inputTensors,
+    const AllToAllOptions& /* unused */) {
+  if (outputTensors.size() != inputTensors.size()) {
+    throw std::runtime_error("alltoall: input and output size mismatch");
+  }
+  // Every GPU of every process is a participant of the NCCL communicator
+  int numRanks = getSize() * inputTensors.size();
+
+  std::vector<at::Tensor> flattenInputTensors;
+  std::vector<at::Tensor> flattenOutputTensors;
+  flattenInputTensors.resize(inputTensors.size());
+  flattenOutputTensors.resize(outputTensors.size());
+
+  for (size_t i = 0; i < inputTensors.size(); ++i) {
+    if (inputTensors[i].empty()) {
+      throw std::runtime_error("alltoall: received an empty input list");
+    }
+    auto& first = inputTensors[i][0];
+    tensorCheckHelper(
+        std::vector<at::Tensor>{first}, inputTensors[i], numRanks);
+    tensorCheckHelper(
+        std::vector<at::Tensor>{first}, outputTensors[i], numRanks);
+    checkSameNumel(first, inputTensors[i]);
+    checkSameNumel(first, outputTensors[i]);
+    // Flatten the tensors (to and from all ranks) to single big tensors
+    flattenInputTensors[i] = newLikeFlat(inputTensors[i]);
+    flattenOutputTensors[i] = newLikeFlat(outputTensors[i]);
+    for (size_t j = 0; j < inputTensors[i].size(); ++j) {
+      flattenInputTensors[i][j].copy_(inputTensors[i][j], true);
+    }
+  }
+
+  std::vector<at::Tensor> firstInputTensors;
+  firstInputTensors.reserve(inputTensors.size());
+  for (auto& tensors : inputTensors) {
+    firstInputTensors.push_back(tensors[0]);
+  }
+
+  auto devices = getDeviceList(firstInputTensors);
+  auto key = getKeyFromDevices(devices);
+  auto& ncclComms = getNCCLComm(key, devices);
+
+  // First let NCCL streams wait for THC stream, this also orders the
+  // NCCL kernels after the copies to the flattened input tensors
+  syncStreams(thcState_, devices, ncclEvents_[key], ncclStreams_[key]);
+
+  // Work itself will create the CUDA events on all GPUs of tensors
+  auto work = std::make_shared<ProcessGroupNCCL::WorkNCCL>(devices);
+
+  at::DeviceGuard gpuGuard;
+
+  std::unique_lock<std::mutex> cudaFreeMutexLock(
+      *(THCCachingAllocator_getCudaFreeMutex()));
+
+  // A single group of send/recv pairs, so NCCL can schedule all transfers
+  // concurrently without deadlocking on their order
+  AT_SDT(c10d_collective_start, this, __func__);
+  C10D_NCCL_CHECK(ncclGroupStart());
+
+  for (size_t i = 0; i < inputTensors.size(); ++i) {
+    gpuGuard.set_index(devices[i].index());
+    CUDAStream& ncclStream = ncclStreams_[key][i];
+    auto numel = flattenInputTensors[i][0].numel();
+    auto dataType =
+        getNcclDataType(inputTensors[i][0].type().scalarType());
+
+    THCCachingAllocator_recordStream(
+        flattenInputTensors[i].data_ptr(), ncclStream.getTHCStream());
+    THCCachingAllocator_recordStream(
+        flattenOutputTensors[i].data_ptr(), ncclStream.getTHCStream());
+
+    for (int r = 0; r < numRanks; ++r) {
+      C10D_NCCL_CHECK(ncclSend(
+          flattenInputTensors[i][r].data_ptr(),
+          numel,
+          dataType,
+          r,
+          ncclComms[i]->getNcclComm(),
+          ncclStream.getStream()));
+      C10D_NCCL_CHECK(ncclRecv(
+          flattenOutputTensors[i][r].data_ptr(),
+          numel,
+          dataType,
+          r,
+          ncclComms[i]->getNcclComm(),
+          ncclStream.getStream()));
+    }
+  }
+
+  C10D_NCCL_CHECK(ncclGroupEnd());
+  AT_SDT(c10d_collective_end, this, __func__);
+
+  // Copy the flattened output tensors to the outputs on the NCCL streams,
+  // then record the events so that wait() also covers the copies
+  for (size_t i = 0; i < outputTensors.size(); ++i) {
+    CUDAStream& ncclStream = ncclStreams_[key][i];
+    CUDAEvent& cudaEvent = work->cudaEvents_[i];
+    {
+      THCStreamGuard guard(thcState_, ncclStream);
+      for (size_t j = 0; j < outputTensors[i].size(); ++j) {
+        outputTensors[i][j].copy_(flattenOutputTensors[i][j], true);
+      }
+    }
+
+    C10D_CUDA_CHECK(
+        cudaEventRecord(cudaEvent.getEvent(), ncclStream.getStream()));
+  }
+
+  return work;
+}
+
+#else // !defined(C10D_NCCL_HAS_SEND_RECV)
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::alltoall(
+    std::vector<std::vector<at::Tensor>>& /* unused */,
+    std::vector<std::vector<at::Tensor>>& /* unused */,
+    const AllToAllOptions& /* unused */) {
+  throw std::runtime_error(
+      "ProcessGroupNCCL only supports alltoall with NCCL 2.7 or newer");
+}
+
+#endif // C10D_NCCL_HAS_SEND_RECV
+
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::gather(
     std::vector<std::vector<at::Tensor>>& /* unused */,
     std::vector<at::Tensor>& /* unused */,
@@ -96,8 +96,39 @@ class ProcessGroupNCCL : public ProcessGroup {
     friend class ProcessGroupNCCL;
   };
 
+  struct Options {
+    explicit Options();
+
+    // Perform allreduce hierarchically: reduce-scatter among the processes
+    // on the same host, allreduce every shard across hosts, and allgather
+    // among the processes on the same host again. This moves only 1/n-th
+    // of the data over the inter-node fabric, where n is the number of
+    // processes per host. The hosts are discovered through the store.
+    //
+    // Only applies to allreduce calls with a single tensor, and if there
+    // are at least two hosts with the same number (at least two) of
+    // processes each. Otherwise the flat allreduce is used.
+    // The default value is false.
+    bool hierarchicalAllreduce;
+
+    // Reuse the NCCL communicators, and the streams they run on, of other
+    // process groups that set this option and were created with the same
+    // store, rank and size, i.e. that have the same members. This saves
+    // the communicator setup for every such group after the first one.
+    //
+    // Since the operations of these process groups run on the same
+    // communicators, they must be called in the same global order across
+    // all processes, not just within each process group.
+    // The default value is false.
+    bool shareCommunicators;
+  };
+
   // Constructor will also check the number of available GPUs in the system
-  ProcessGroupNCCL(const std::shared_ptr<Store>& store, int rank, int size);
+  ProcessGroupNCCL(
+      const std::shared_ptr<Store>& store,
+      int rank,
+      int size,
+      Options options = Options());
 
   virtual ~ProcessGroupNCCL();
 
@@ -117,6 +148,16 @@ class ProcessGroupNCCL : public ProcessGroup {
       std::vector<std::vector<at::Tensor>>& outputTensors,
       std::vector<at::Tensor>& inputTensors) override;
 
+  std::shared_ptr<ProcessGroup::Work> reduceScatter(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensors,
+      const ReduceScatterOptions& opts = ReduceScatterOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> alltoall(
+      std::vector<std::vector<at::Tensor>>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensors,
+      const AllToAllOptions& opts = AllToAllOptions()) override;
+
   // Unsupported Ops
   std::shared_ptr<ProcessGroup::Work> gather(
       std::vector<std::vector<at::Tensor>>& outputTensors,
@@ -142,9 +183,39 @@ class ProcessGroupNCCL : public ProcessGroup {
 
   std::shared_ptr<ProcessGroup::Work> barrier() override;
 
+  // Creates the NCCL communicators for all the given device lists up front,
+  // instead of on the first operation that uses each of them. The unique
+  // IDs of all communicators are exchanged with a single store operation
+  // and the communicators are initialized together. Device lists that
+  // already have communicators are skipped.
+  //
+  // Must be called with the same device lists, in the same order, on all
+  // processes.
+  void initNCCLComms(const std::vector<std::vector<at::Device>>& devices);
+
  protected:
-  // Helper that broadcasts nccl unique ID to all ranks through the store
-  void broadcastUniqueNCCLID(ncclUniqueId* ncclID);
+  // Helper that broadcasts nccl unique IDs to all ranks through the store,
+  // with one store operation for all of them
+  void broadcastUniqueNCCLIDs(
+      std::vector<ncclUniqueId>& ncclIDs,
+      const std::vector<std::string>& storeKeys);
+
+  // Helper that publishes the nccl unique ID under the given store key if
+  // isRoot is true, or reads it from there otherwise
+  void exchangeNCCLID(
+      ncclUniqueId* ncclID,
+      const std::string& storeKey,
+      bool isRoot);
+
+  // Helper that sets up the intra- and inter-node communicators used by
+  // hierarchical allreduce on the first call. Returns whether hierarchical
+  // allreduce applies to this process group.
+  bool initHierarchicalComms(const at::Device& device);
+
+  // Hierarchical implementation of allreduce, see Options
+  std::shared_ptr<ProcessGroup::Work> hierarchicalAllreduce(
+      std::vector<at::Tensor>& tensors,
+      const AllreduceOptions& opts);
 
   // Helper that either looks up the cached NCCL communicators or creates
   // a new set of NCCL communicators as a cache entry
@@ -152,6 +223,14 @@ class ProcessGroupNCCL : public ProcessGroup {
       const std::string& devicesKey,
       const std::vector<at::Device>& devices);
 
+  // Helper that creates the cache entries of all device lists that don't
+  // have one yet
+  void createNCCLComms(const std::vector<std::vector<at::Device>>& devices);
+
+  // Helper that adds the communicators shared by another process group to
+  // the cache, returns false if there are none for the devices yet
+  bool lookupSharedNCCLComms(const std::string& devicesKey);
+
   // Tensor checker helper
   void tensorCheckHelper(
       const std::vector<at::Tensor>& input,
@@ -189,6 +268,19 @@ class ProcessGroupNCCL : public ProcessGroup {
   // The CUDA events used to sync NCCL streams
   std::unordered_map<std::string, std::vector<CUDAEvent>> ncclEvents_;
 
+  const Options options_;
+
+  // The communicators of hierarchical allreduce, between the processes on
+  // the same host and between the processes with the same local rank on
+  // every host. They are created on the first hierarchical allreduce.
+  bool hierarchicalInitialized_;
+  bool hierarchicalEnabled_;
+  int hierarchicalDevice_;
+  int localRank_;
+  int localSize_;
+  std::shared_ptr<NCCLComm> intraNodeComm_;
+  std::shared_ptr<NCCLComm> interNodeComm_;
+
   // Store copy of pointer to THCState retrieved from ::at::globalContext().
   THCState* thcState_;
 
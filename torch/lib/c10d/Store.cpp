@@ -8,4 +8,28 @@ constexpr std::chrono::milliseconds Store::kNoTimeout;
 // Define destructor symbol for abstract base class.
 Store::~Store() {}
 
+void Store::multiSet(
+    const std::vector<std::string>& keys,
+    const std::vector<std::vector<uint8_t>>& values) {
+  if (keys.size() != values.size()) {
+    throw std::invalid_argument(
+        "multiSet expects as many values as keys, got " +
+        std::to_string(values.size()) + " values for " +
+        std::to_string(keys.size()) + " keys");
+  }
+  for (size_t i = 0; i < keys.size(); i++) {
+    set(keys[i], values[i]);
+  }
+}
+
+std::vector<std::vector<uint8_t>> Store::multiGet(
+    const std::vector<std::string>& keys) {
+  std::vector<std::vector<uint8_t>> values;
+  values.reserve(keys.size());
+  for (const auto& key : keys) {
+    values.push_back(get(key));
+  }
+  return values;
+}
+
 } // namespace c10d
@@ -30,6 +30,18 @@ class Store {
   virtual void wait(
       const std::vector<std::string>& keys,
       const std::chrono::milliseconds& timeout = kDefaultTimeout) = 0;
+
+  // Sets every key to the value at the same index. Stores that can batch
+  // the updates into a single request should override this, the default
+  // calls set for every key.
+  virtual void multiSet(
+      const std::vector<std::string>& keys,
+      const std::vector<std::vector<uint8_t>>& values);
+
+  // Waits for all keys to be set and returns their values, in order. The
+  // default calls get for every key.
+  virtual std::vector<std::vector<uint8_t>> multiGet(
+      const std::vector<std::string>& keys);
 };
 
 } // namespace c10d
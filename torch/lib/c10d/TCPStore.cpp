@@ -1,6 +1,6 @@
 #include "TCPStore.hpp"
 
-#include <poll.h>
+#include <sys/epoll.h>
 
 #include <unistd.h>
 #include <algorithm>
@@ -10,12 +10,23 @@ namespace c10d {
 
 namespace {
 
-enum class QueryType : uint8_t { SET, GET, ADD, CHECK, WAIT };
+enum class QueryType : uint8_t {
+  SET,
+  GET,
+  ADD,
+  CHECK,
+  WAIT,
+  MULTI_SET,
+  MULTI_GET
+};
 
 enum class CheckResponseType : uint8_t { READY, NOT_READY };
 
 enum class WaitResponseType : uint8_t { STOP_WAITING };
 
+// Maximum number of events handled per epoll_wait call
+constexpr int kMaxEvents = 64;
+
 } // anonymous namespace
 
 // TCPStoreDaemon class methods
@@ -32,9 +43,10 @@ TCPStoreDaemon::~TCPStoreDaemon() {
   join();
   // Close unclosed sockets
   for (auto socket : sockets_) {
-    if (socket != -1) {
-      ::close(socket);
-    }
+    ::close(socket);
+  }
+  if (epollFd_ != -1) {
+    ::close(epollFd_);
   }
   // Now close the rest control pipe
   for (auto fd : controlPipeFd_) {
@@ -48,6 +60,35 @@ void TCPStoreDaemon::join() {
   daemonThread_.join();
 }
 
+void TCPStoreDaemon::watchSocket(int socket, uint32_t events, bool add) {
+  struct epoll_event event = {};
+  event.events = events;
+  event.data.fd = socket;
+  SYSCHECK(::epoll_ctl(
+      epollFd_, add ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, socket, &event));
+}
+
+void TCPStoreDaemon::closeSocket(int socket) {
+  // Closing the socket also removes it from the epoll set
+  ::close(socket);
+  sockets_.erase(socket);
+
+  // Remove all the tracking state of the closed socket
+  if (keysAwaited_.erase(socket) == 0) {
+    return;
+  }
+  for (auto it = waitingSockets_.begin(); it != waitingSockets_.end();) {
+    auto& sockets = it->second;
+    sockets.erase(
+        std::remove(sockets.begin(), sockets.end(), socket), sockets.end());
+    if (sockets.empty()) {
+      it = waitingSockets_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
 void TCPStoreDaemon::run() {
   // Create the control pipe
   if (pipe(controlPipeFd_.data()) == -1) {
@@ -56,65 +97,66 @@ void TCPStoreDaemon::run() {
         "TCPStoreDaemon run");
   }
 
-  std::vector<struct pollfd> fds;
-  fds.push_back({.fd = storeListenSocket_, .events = POLLIN});
-  // Push the read end of the pipe to signal the stopping of the daemon run
-  fds.push_back({.fd = controlPipeFd_[0], .events = POLLHUP});
-
-  // receive the queries
-  bool finished = false;
-  while (!finished) {
-    for (size_t i = 0; i < sockets_.size(); i++) {
-      fds[i].revents = 0;
-    }
-
-    SYSCHECK(::poll(fds.data(), fds.size(), -1));
-
-    // TCPStore's listening socket has an event and it should now be able to
-    // accept new connections.
-    if (fds[0].revents != 0) {
-      if (fds[0].revents ^ POLLIN) {
-        throw std::system_error(
-            ECONNABORTED,
-            std::system_category(),
-            "Unexpected poll revent on the master's listening socket: " +
-                std::to_string(fds[0].revents));
+  // Unlike poll, epoll doesn't scan every connection on every wakeup, which
+  // matters once thousands of workers are connected to the store.
+  SYSCHECK(epollFd_ = ::epoll_create1(EPOLL_CLOEXEC));
+  watchSocket(storeListenSocket_, EPOLLIN, true);
+  // Watch the read end of the pipe to signal the stopping of the daemon run
+  watchSocket(controlPipeFd_[0], EPOLLIN, true);
+
+  std::vector<struct epoll_event> events(kMaxEvents);
+  while (true) {
+    int numEvents;
+    SYSCHECK(numEvents = ::epoll_wait(epollFd_, events.data(), kMaxEvents, -1));
+
+    for (int i = 0; i < numEvents; i++) {
+      const int fd = events[i].data.fd;
+      const uint32_t revents = events[i].events;
+
+      // TCPStore's listening socket has an event and it should now be able
+      // to accept new connections.
+      if (fd == storeListenSocket_) {
+        if (revents ^ EPOLLIN) {
+          throw std::system_error(
+              ECONNABORTED,
+              std::system_category(),
+              "Unexpected epoll event on the master's listening socket: " +
+                  std::to_string(revents));
+        }
+        int sockFd = std::get<0>(tcputil::accept(storeListenSocket_));
+        sockets_.insert(sockFd);
+        watchSocket(sockFd, EPOLLIN, true);
+        continue;
       }
-      int sockFd = std::get<0>(tcputil::accept(storeListenSocket_));
-      sockets_.push_back(sockFd);
-      fds.push_back({.fd = sockFd, .events = POLLIN});
-    }
-    // The pipe receives an event which tells us to shutdown the daemon
-    if (fds[1].revents != 0) {
-      // Will be POLLUP when the pipe is closed
-      if (fds[1].revents ^ POLLHUP) {
-        throw std::system_error(
-            ECONNABORTED,
-            std::system_category(),
-            "Unexpected poll revent on the control pipe's reading fd: " +
-                std::to_string(fds[1].revents));
+
+      // The pipe receives an event which tells us to shutdown the daemon
+      if (fd == controlPipeFd_[0]) {
+        // Will be EPOLLHUP when the pipe is closed
+        if (!(revents & EPOLLHUP)) {
+          throw std::system_error(
+              ECONNABORTED,
+              std::system_category(),
+              "Unexpected epoll event on the control pipe's reading fd: " +
+                  std::to_string(revents));
+        }
+        return;
       }
-      finished = true;
-      break;
-    }
-    // Skipping the fds[0] and fds[1],
-    // fds[0] is master's listening socket
-    // fds[1] is control pipe's reading fd
-    for (size_t fdIdx = 2; fdIdx < fds.size(); ++fdIdx) {
-      if (fds[fdIdx].revents == 0) {
+
+      // The socket may have been closed while handling an earlier event
+      if (sockets_.count(fd) == 0) {
         continue;
       }
 
-      if (fds[fdIdx].revents ^ POLLIN) {
-        throw std::system_error(
-            ECONNABORTED,
-            std::system_category(),
-            "Unexpected poll revent: " + std::to_string(fds[fdIdx].revents) +
-                " on socket: " + std::to_string(fds[fdIdx].fd));
+      // A client that is blocked in wait is only watched for hangups, its
+      // pipelined queries are read once the wait is over.
+      if (keysAwaited_.count(fd) > 0) {
+        closeSocket(fd);
+        continue;
       }
+
       // Now query the socket that has the event
       try {
-        query(fds[fdIdx].fd);
+        query(fd);
       } catch (...) {
         // There was an error when processing query. Probably an exception
         // occurred in recv/send what would indicate that socket on the other
@@ -123,34 +165,7 @@ void TCPStoreDaemon::run() {
         // exception, other connections will get an exception once they try to
         // use the store. We will go ahead and close this connection whenever
         // we hit an exception here.
-        ::close(fds[fdIdx].fd);
-
-        // Remove all the tracking state of the close FD
-        for (auto it = waitingSockets_.begin(); it != waitingSockets_.end();) {
-          for (auto vecIt = it->second.begin(); vecIt != it->second.end();) {
-            if (*vecIt == fds[fdIdx].fd) {
-              vecIt = it->second.erase(vecIt);
-            } else {
-              ++vecIt;
-            }
-          }
-          if (it->second.size() == 0) {
-            it = waitingSockets_.erase(it);
-          } else {
-            ++it;
-          }
-        }
-        for (auto it = keysAwaited_.begin(); it != keysAwaited_.end();) {
-          if (it->first == fds[fdIdx].fd) {
-            it = keysAwaited_.erase(it);
-          } else {
-            ++it;
-          }
-        }
-        fds.erase(fds.begin() + fdIdx);
-        sockets_.erase(sockets_.begin() + fdIdx - 2);
-        --fdIdx;
-        continue;
+        closeSocket(fd);
       }
     }
   }
@@ -167,8 +182,11 @@ void TCPStoreDaemon::stop() {
 // query communicates with the worker. The format
 // of the query is as follows:
 // type of query | size of arg1 | arg1 | size of arg2 | arg2 | ...
-// or, in the case of wait
+// or, in the case of check, wait and multi get
 // type of query | number of args | size of arg1 | arg1 | ...
+// or, in the case of multi set
+// type of query | number of keys | size of key1 | key1 | size of value1 |
+// value1 | ...
 void TCPStoreDaemon::query(int socket) {
   QueryType qt;
   tcputil::recvBytes<QueryType>(socket, &qt, 1);
@@ -188,6 +206,12 @@ void TCPStoreDaemon::query(int socket) {
   } else if (qt == QueryType::WAIT) {
     waitHandler(socket);
 
+  } else if (qt == QueryType::MULTI_SET) {
+    multiSetHandler(socket);
+
+  } else if (qt == QueryType::MULTI_GET) {
+    multiGetHandler(socket);
+
   } else {
     throw std::runtime_error("Unexpected query type");
   }
@@ -196,13 +220,27 @@ void TCPStoreDaemon::query(int socket) {
 void TCPStoreDaemon::wakeupWaitingClients(const std::string& key) {
   auto socketsToWait = waitingSockets_.find(key);
   if (socketsToWait != waitingSockets_.end()) {
+    // Clients that went away can only be closed once we are done with the
+    // waiting state of this key.
+    std::vector<int> failedSockets;
     for (int socket : socketsToWait->second) {
-      if (--keysAwaited_[socket] == 0) {
-        tcputil::sendValue<WaitResponseType>(
-            socket, WaitResponseType::STOP_WAITING);
+      auto it = keysAwaited_.find(socket);
+      if (--it->second == 0) {
+        keysAwaited_.erase(it);
+        try {
+          tcputil::sendValue<WaitResponseType>(
+              socket, WaitResponseType::STOP_WAITING);
+          // Resume reading the queries of the client
+          watchSocket(socket, EPOLLIN);
+        } catch (...) {
+          failedSockets.push_back(socket);
+        }
       }
     }
     waitingSockets_.erase(socketsToWait);
+    for (auto socket : failedSockets) {
+      closeSocket(socket);
+    }
   }
 }
 
@@ -213,6 +251,16 @@ void TCPStoreDaemon::setHandler(int socket) {
   wakeupWaitingClients(key);
 }
 
+void TCPStoreDaemon::multiSetHandler(int socket) {
+  SizeType nargs;
+  tcputil::recvBytes<SizeType>(socket, &nargs, 1);
+  for (size_t i = 0; i < nargs; i++) {
+    std::string key = tcputil::recvString(socket);
+    tcpStore_[key] = tcputil::recvVector<uint8_t>(socket);
+    wakeupWaitingClients(key);
+  }
+}
+
 void TCPStoreDaemon::addHandler(int socket) {
   std::string key = tcputil::recvString(socket);
   int64_t addVal = tcputil::recvValue<int64_t>(socket);
@@ -236,6 +284,24 @@ void TCPStoreDaemon::getHandler(int socket) const {
   tcputil::sendVector<uint8_t>(socket, data);
 }
 
+void TCPStoreDaemon::multiGetHandler(int socket) const {
+  SizeType nargs;
+  tcputil::recvBytes<SizeType>(socket, &nargs, 1);
+  std::vector<std::string> keys(nargs);
+  for (size_t i = 0; i < nargs; i++) {
+    keys[i] = tcputil::recvString(socket);
+  }
+  // Look up all keys before sending anything, so that a missing key
+  // doesn't leave a partial response behind
+  std::vector<const std::vector<uint8_t>*> values(nargs);
+  for (size_t i = 0; i < nargs; i++) {
+    values[i] = &tcpStore_.at(keys[i]);
+  }
+  for (size_t i = 0; i < nargs; i++) {
+    tcputil::sendVector<uint8_t>(socket, *values[i], (i != (nargs - 1)));
+  }
+}
+
 void TCPStoreDaemon::checkHandler(int socket) const {
   SizeType nargs;
   tcputil::recvBytes<SizeType>(socket, &nargs, 1);
@@ -262,10 +328,18 @@ void TCPStoreDaemon::waitHandler(int socket) {
     tcputil::sendValue<WaitResponseType>(
         socket, WaitResponseType::STOP_WAITING);
   } else {
+    // Only the keys that are missing can wake up the client
+    size_t numAwaited = 0;
     for (auto& key : keys) {
-      waitingSockets_[key].push_back(socket);
+      if (tcpStore_.count(key) == 0) {
+        waitingSockets_[key].push_back(socket);
+        numAwaited++;
+      }
     }
-    keysAwaited_[socket] = keys.size();
+    keysAwaited_[socket] = numAwaited;
+    // Any query the client sent after the wait must only be answered once
+    // the wait is over, so stop reading from the socket until then.
+    watchSocket(socket, EPOLLRDHUP);
   }
 }
 
@@ -311,12 +385,49 @@ void TCPStore::set(const std::string& key, const std::vector<uint8_t>& data) {
 }
 
 std::vector<uint8_t> TCPStore::get(const std::string& key) {
-  wait({key});
-  tcputil::sendValue<QueryType>(storeSocket_, QueryType::GET);
+  // Send the get right behind the wait, saving a round trip
+  sendWait({key}, true);
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::GET, true);
   tcputil::sendString(storeSocket_, key);
+  recvWait(kDefaultTimeout);
   return tcputil::recvVector<uint8_t>(storeSocket_);
 }
 
+void TCPStore::multiSet(
+    const std::vector<std::string>& keys,
+    const std::vector<std::vector<uint8_t>>& values) {
+  if (keys.size() != values.size()) {
+    throw std::invalid_argument(
+        "multiSet expects as many values as keys, got " +
+        std::to_string(values.size()) + " values for " +
+        std::to_string(keys.size()) + " keys");
+  }
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::MULTI_SET, true);
+  SizeType nkeys = keys.size();
+  tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, (nkeys > 0));
+  for (size_t i = 0; i < nkeys; i++) {
+    tcputil::sendString(storeSocket_, keys[i], true);
+    tcputil::sendVector<uint8_t>(storeSocket_, values[i], (i != (nkeys - 1)));
+  }
+}
+
+std::vector<std::vector<uint8_t>> TCPStore::multiGet(
+    const std::vector<std::string>& keys) {
+  sendWait(keys, true);
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::MULTI_GET, true);
+  SizeType nkeys = keys.size();
+  tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, (nkeys > 0));
+  for (size_t i = 0; i < nkeys; i++) {
+    tcputil::sendString(storeSocket_, keys[i], (i != (nkeys - 1)));
+  }
+  recvWait(kDefaultTimeout);
+  std::vector<std::vector<uint8_t>> values(nkeys);
+  for (size_t i = 0; i < nkeys; i++) {
+    values[i] = tcputil::recvVector<uint8_t>(storeSocket_);
+  }
+  return values;
+}
+
 int64_t TCPStore::add(const std::string& key, int64_t value) {
   tcputil::sendValue<QueryType>(storeSocket_, QueryType::ADD);
   tcputil::sendString(storeSocket_, key, true);
@@ -344,6 +455,22 @@ bool TCPStore::check(const std::vector<std::string>& keys) {
 void TCPStore::wait(
     const std::vector<std::string>& keys,
     const std::chrono::milliseconds& timeout) {
+  sendWait(keys);
+  recvWait(timeout);
+}
+
+void TCPStore::sendWait(const std::vector<std::string>& keys, bool moreData) {
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::WAIT, true);
+  SizeType nkeys = keys.size();
+  tcputil::sendBytes<SizeType>(
+      storeSocket_, &nkeys, 1, (nkeys > 0) || moreData);
+  for (size_t i = 0; i < nkeys; i++) {
+    tcputil::sendString(
+        storeSocket_, keys[i], (i != (nkeys - 1)) || moreData);
+  }
+}
+
+void TCPStore::recvWait(const std::chrono::milliseconds& timeout) {
   // Set the socket timeout if there is a wait timeout
   if (timeout != kNoTimeout) {
     struct timeval timeoutTV = {.tv_sec = timeout.count() / 1000,
@@ -355,12 +482,6 @@ void TCPStore::wait(
         reinterpret_cast<char*>(&timeoutTV),
         sizeof(timeoutTV)));
   }
-  tcputil::sendValue<QueryType>(storeSocket_, QueryType::WAIT);
-  SizeType nkeys = keys.size();
-  tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, (nkeys > 0));
-  for (size_t i = 0; i < nkeys; i++) {
-    tcputil::sendString(storeSocket_, keys[i], (i != (nkeys - 1)));
-  }
   auto waitResponse = tcputil::recvValue<WaitResponseType>(storeSocket_);
   if (waitResponse != WaitResponseType::STOP_WAITING) {
     throw std::runtime_error("Stop_waiting response is expected");
@@ -3,6 +3,7 @@
 #include <memory>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <c10d/Store.hpp>
 #include <c10d/Utils.hpp>
@@ -23,14 +24,19 @@ class TCPStoreDaemon {
   void query(int socket);
 
   void setHandler(int socket);
+  void multiSetHandler(int socket);
   void addHandler(int socket);
   void getHandler(int socket) const;
+  void multiGetHandler(int socket) const;
   void checkHandler(int socket) const;
   void waitHandler(int socket);
 
   bool checkKeys(const std::vector<std::string>& keys) const;
   void wakeupWaitingClients(const std::string& key);
 
+  void watchSocket(int socket, uint32_t events, bool add = false);
+  void closeSocket(int socket);
+
   std::thread daemonThread_;
   std::unordered_map<std::string, std::vector<uint8_t>> tcpStore_;
   // From key -> the list of sockets waiting on it
@@ -38,8 +44,9 @@ class TCPStoreDaemon {
   // From socket -> number of keys awaited
   std::unordered_map<int, size_t> keysAwaited_;
 
-  std::vector<int> sockets_;
+  std::unordered_set<int> sockets_;
   int storeListenSocket_;
+  int epollFd_ = -1;
   std::vector<int> controlPipeFd_{-1, -1};
 };
 
@@ -64,7 +71,20 @@ class TCPStore : public Store {
       const std::vector<std::string>& keys,
       const std::chrono::milliseconds& timeout = kDefaultTimeout) override;
 
+  void multiSet(
+      const std::vector<std::string>& keys,
+      const std::vector<std::vector<uint8_t>>& values) override;
+
+  std::vector<std::vector<uint8_t>> multiGet(
+      const std::vector<std::string>& keys) override;
+
  protected:
+  // The daemon answers the queries of a connection in order, so a wait can
+  // be sent together with the query that depends on it, and both responses
+  // are received afterwards.
+  void sendWait(const std::vector<std::string>& keys, bool moreData = false);
+  void recvWait(const std::chrono::milliseconds& timeout);
+
   bool isServer_;
   int storeSocket_ = -1;
   int masterListenSocket_ = -1;
@@ -1,12 +1,16 @@
 #pragma once
 
 #include <cstdint>
+#include <vector>
+
+#include <ATen/ATen.h>
 
 namespace c10d {
 
 enum class CollectiveType : std::uint8_t {
   BROADCAST,
   ALLREDUCE,
+  REDUCE_SCATTER,
   UNUSED,
 };
 
@@ -23,8 +27,31 @@ struct BroadcastOptions {
   int rootTensor = 0;
 };
 
+// Lower precision representation of float tensors on the wire.
+enum class AllreduceCompression : std::uint8_t {
+  NONE = 0,
+  FP16,
+};
+
 struct AllreduceOptions {
   ReduceOp reduceOp = ReduceOp::SUM;
+
+  // If not NONE, float tensors are reduced in the compressed representation
+  // and cast back into the tensors by the wait() or synchronize() of the
+  // returned work.
+  AllreduceCompression compression = AllreduceCompression::NONE;
+
+  // Optional error feedback for compression: one float tensor per tensor,
+  // of the same shape. The residual is added to the tensor before it is
+  // compressed, and the compression error replaces it afterwards, so the
+  // error is not lost but carried into the next call.
+  std::vector<at::Tensor> residuals;
+
+  // Gloo only: reduce CUDA tensors in device memory and let the transport
+  // send and receive it directly, instead of staging the data through
+  // pinned host memory. Requires a transport with GPUDirect RDMA support,
+  // such as ibverbs on suitable hardware. Ignored for CPU tensors.
+  bool gpuDirect = false;
 };
 
 struct ReduceOptions {
@@ -41,4 +68,10 @@ struct GatherOptions {
   int rootRank = 0;
 };
 
+struct ReduceScatterOptions {
+  ReduceOp reduceOp = ReduceOp::SUM;
+};
+
+struct AllToAllOptions {};
+
 } // namespace c10d
@@ -21,7 +21,9 @@ namespace tcputil {
 
 namespace {
 
-constexpr int LISTEN_QUEUE_SIZE = 64;
+// The kernel caps this at net.core.somaxconn. A short queue makes a large
+// number of workers connecting at once retry for seconds.
+constexpr int LISTEN_QUEUE_SIZE = 2048;
 
 void setSocketNoDelay(int socket) {
   int flag = 1;
@@ -188,6 +188,107 @@ void testAllgather(int iter = 10000) {
   }
 }
 
+void testReduceScatter(int iter = 10000) {
+  auto pg = c10d::ProcessGroupMPI::createProcessGroupMPI();
+  std::vector<std::vector<std::vector<at::Tensor>>> allTensors(iter);
+  std::vector<std::vector<at::Tensor>> allOutputTensors(iter);
+
+  // Get the world size
+  auto worldSize = pg->getSize();
+  auto rank = pg->getRank();
+
+  // Generate inputs, rank r contributes i * (r + j) to the slice of rank j
+  for (auto i = 0; i < iter; ++i) {
+    allTensors[i] = std::vector<std::vector<at::Tensor>>(1);
+    allTensors[i][0].resize(worldSize);
+    for (auto j = 0; j < worldSize; ++j) {
+      allTensors[i][0][j] = at::ones({16, 16}) * i * (rank + j);
+    }
+    allOutputTensors[i] = std::vector<at::Tensor>({at::zeros({16, 16})});
+  }
+
+  std::vector<std::shared_ptr<::c10d::ProcessGroup::Work>> works;
+  for (size_t i = 0; i < allTensors.size(); ++i) {
+    // Kick off work
+    std::shared_ptr<::c10d::ProcessGroup::Work> work =
+        pg->reduceScatter(allOutputTensors[i], allTensors[i]);
+    works.push_back(std::move(work));
+  }
+
+  for (auto& work : works) {
+    // Wait for work to complete
+    if (!work->wait()) {
+      std::cerr << "Exception received: " << work->exception().what()
+                << std::endl;
+      pg->abort();
+    }
+  }
+
+  // Verify outputs
+  for (int i = 0; i < iter; ++i) {
+    const auto expected =
+        i * (worldSize * (worldSize - 1) / 2 + worldSize * rank);
+    auto data = allOutputTensors[i][0].data<float>();
+    for (auto k = 0; k < allOutputTensors[i][0].numel(); ++k) {
+      if (data[k] != expected) {
+        throw std::runtime_error("BOOM!");
+      }
+    }
+  }
+}
+
+void testAlltoall(int iter = 10000) {
+  auto pg = c10d::ProcessGroupMPI::createProcessGroupMPI();
+  std::vector<std::vector<std::vector<at::Tensor>>> allTensors(iter);
+  std::vector<std::vector<std::vector<at::Tensor>>> allOutputTensors(iter);
+
+  // Get the world size
+  auto worldSize = pg->getSize();
+  auto rank = pg->getRank();
+
+  // Generate inputs, rank r sends i * (r * worldSize + j) to rank j
+  for (auto i = 0; i < iter; ++i) {
+    allTensors[i] = std::vector<std::vector<at::Tensor>>(1);
+    allOutputTensors[i] = std::vector<std::vector<at::Tensor>>(1);
+    allTensors[i][0].resize(worldSize);
+    allOutputTensors[i][0].resize(worldSize);
+    for (auto j = 0; j < worldSize; ++j) {
+      allTensors[i][0][j] = at::ones({16, 16}) * i * (rank * worldSize + j);
+      allOutputTensors[i][0][j] = at::zeros({16, 16});
+    }
+  }
+
+  std::vector<std::shared_ptr<::c10d::ProcessGroup::Work>> works;
+  for (size_t i = 0; i < allTensors.size(); ++i) {
+    // Kick off work
+    std::shared_ptr<::c10d::ProcessGroup::Work> work =
+        pg->alltoall(allOutputTensors[i], allTensors[i]);
+    works.push_back(std::move(work));
+  }
+
+  for (auto& work : works) {
+    // Wait for work to complete
+    if (!work->wait()) {
+      std::cerr << "Exception received: " << work->exception().what()
+                << std::endl;
+      pg->abort();
+    }
+  }
+
+  // Verify outputs
+  for (int i = 0; i < iter; ++i) {
+    for (int j = 0; j < worldSize; ++j) {
+      const auto expected = i * (j * worldSize + rank);
+      auto data = allOutputTensors[i][0][j].data<float>();
+      for (auto k = 0; k < allOutputTensors[i][0][j].numel(); ++k) {
+        if (data[k] != expected) {
+          throw std::runtime_error("BOOM!");
+        }
+      }
+    }
+  }
+}
+
 void testGather(int iter = 10000) {
   auto pg = c10d::ProcessGroupMPI::createProcessGroupMPI();
   std::vector<std::vector<at::Tensor>> allTensors(iter);
@@ -383,6 +484,8 @@ int main(int argc, char** argv) {
   testAllgather();
   testGather();
   testScatter();
+  testReduceScatter();
+  testAlltoall();
   testSendRecv(false);
   testSendRecv(true);
 
@@ -18,6 +18,36 @@ int main(int argc, char** argv) {
   c10d::test::check(serverStore, "key1", "value1");
   c10d::test::check(serverStore, "key2", "value2");
 
+  // Batched set/get on a client store
+  {
+    c10d::TCPStore clientStore("127.0.0.1", 29500, false);
+    std::vector<std::string> keys = {"multi0", "multi1", "multi2"};
+    std::vector<std::vector<uint8_t>> values;
+    for (const auto& key : keys) {
+      auto value = key + "_value";
+      values.emplace_back(value.begin(), value.end());
+    }
+    clientStore.multiSet(keys, values);
+    if (serverStore.multiGet(keys) != values) {
+      throw std::runtime_error("multiGet returned unexpected values");
+    }
+
+    // A get blocks until the key is set, without losing the pipelined query
+    std::thread setter([&serverStore] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      c10d::test::set(serverStore, "late1", "value1");
+      c10d::test::set(serverStore, "late0", "value0");
+    });
+    auto lateValues = clientStore.multiGet({"late0", "multi0", "late1"});
+    setter.join();
+    if (std::string(lateValues[0].begin(), lateValues[0].end()) != "value0" ||
+        lateValues[1] != values[0] ||
+        std::string(lateValues[2].begin(), lateValues[2].end()) != "value1") {
+      throw std::runtime_error("multiGet returned unexpected values");
+    }
+    c10d::test::check(clientStore, "late1", "value1");
+  }
+
   // Hammer on TCPStore
   std::vector<std::thread> threads;
   const auto numThreads = 16;
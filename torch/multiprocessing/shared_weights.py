@@ -0,0 +1,213 @@
+"""
+Sharing of read-only weights between the processes of a host.
+
+A state dict is written once, either to a named shared memory region or to a
+checkpoint file, in a layout that can be memory mapped. Other processes attach
+to it read-only: their tensors are backed directly by the shared pages, so the
+weights are held in host memory only once and attaching doesn't copy them.
+
+Example::
+
+    # in the loading process
+    state_dict = share_state_dict(torch.load('model.pt'), 'model')
+
+    # in every worker
+    model = Model()
+    bind_state_dict(model, attach_state_dict('model'))
+
+The attached tensors are read-only, writing to them crashes the process. They
+are meant for inference, e.g. under :func:`torch.no_grad`.
+"""
+import collections
+import os
+import pickle
+import struct
+
+import torch
+
+__all__ = ['save_shared', 'load_shared', 'share_state_dict',
+           'attach_state_dict', 'unlink_state_dict', 'bind_state_dict']
+
+_MAGIC = b'PTSHW001'
+_HEADER = struct.Struct('<8sQ')
+# offsets of the tensors in the file, enough for any element type
+_ALIGNMENT = 64
+_SHM_DIR = '/dev/shm'
+_SHM_PREFIX = 'torch_weights_'
+
+
+def _align(offset):
+    return (offset + _ALIGNMENT - 1) // _ALIGNMENT * _ALIGNMENT
+
+
+def _dtype_name(dtype):
+    return str(dtype).split('.')[-1]
+
+
+def _map_file(path, dtype, file_size, shared):
+    storage_type = type(torch.empty(0, dtype=dtype).storage())
+    element_size = torch.empty(0, dtype=dtype).element_size()
+    size = file_size // element_size
+    if shared:
+        return storage_type.from_file(path, shared=True, size=size), element_size
+    return storage_type.from_file(path, size=size, readonly=True), element_size
+
+
+def _data_offset(metadata_size):
+    return _align(_HEADER.size + metadata_size)
+
+
+def _views(path, entries, data_offset, file_size, shared):
+    """Tensors of the entries, backed by mappings of the file (one per dtype)."""
+    mappings = {}
+    tensors = collections.OrderedDict()
+    for key, dtype_name, size, offset in entries:
+        offset += data_offset
+        dtype = getattr(torch, dtype_name)
+        if dtype not in mappings:
+            mappings[dtype] = _map_file(path, dtype, file_size, shared)
+        storage, element_size = mappings[dtype]
+        tensor = torch.empty(0, dtype=dtype)
+        tensor.set_(storage, offset // element_size, torch.Size(size))
+        tensors[key] = tensor
+    return tensors
+
+
+def save_shared(state_dict, path):
+    r"""Writes the tensors of a state dict to a file that can be mapped with
+    :func:`load_shared`.
+
+    The file is written under a temporary name and then renamed, so processes
+    never map a partially written file.
+
+    Arguments:
+        state_dict (dict): the tensors to save, CUDA tensors are saved on the
+            CPU.
+        path (str): the file to write.
+    """
+    tensors = collections.OrderedDict(
+        (key, value.detach().cpu().contiguous()) for key, value in state_dict.items())
+
+    entries = []
+    offset = 0
+    for key, tensor in tensors.items():
+        entries.append((key, _dtype_name(tensor.dtype), tuple(tensor.size()), offset))
+        offset = _align(offset + tensor.numel() * tensor.element_size())
+    metadata = pickle.dumps(entries, protocol=2)
+    data_offset = _data_offset(len(metadata))
+    file_size = max(data_offset + offset, data_offset + 1)
+
+    tmp_path = '{}.tmp{}'.format(path, os.getpid())
+    try:
+        with open(tmp_path, 'wb') as f:
+            f.write(_HEADER.pack(_MAGIC, len(metadata)))
+            f.write(metadata)
+            f.truncate(file_size)
+        # copy the data through shared mappings of the file
+        views = _views(tmp_path, entries, data_offset, file_size, shared=True)
+        for key, tensor in tensors.items():
+            views[key].copy_(tensor)
+        del views
+        os.rename(tmp_path, path)
+    except BaseException:
+        if os.path.exists(tmp_path):
+            os.unlink(tmp_path)
+        raise
+
+
+def load_shared(path):
+    r"""Maps a file written by :func:`save_shared` read-only.
+
+    The returned tensors are backed by the pages of the file, which are shared
+    by every process that maps it.
+
+    Arguments:
+        path (str): the file to map.
+
+    Returns:
+        An ordered dict of read-only CPU tensors.
+    """
+    with open(path, 'rb') as f:
+        magic, metadata_size = _HEADER.unpack(f.read(_HEADER.size))
+        if magic != _MAGIC:
+            raise RuntimeError("{} is not a shared weights file".format(path))
+        entries = pickle.loads(f.read(metadata_size))
+    return _views(path, entries, _data_offset(metadata_size), os.path.getsize(path),
+                  shared=False)
+
+
+def _shm_path(name):
+    if not os.path.isdir(_SHM_DIR):
+        raise RuntimeError("named shared weights require {}, use save_shared and "
+                           "load_shared with a file instead".format(_SHM_DIR))
+    if not name or '/' in name:
+        raise ValueError("invalid shared weights name: '{}'".format(name))
+    return os.path.join(_SHM_DIR, _SHM_PREFIX + name)
+
+
+def share_state_dict(state_dict, name):
+    r"""Copies the tensors of a state dict to a named shared memory region and
+    attaches to it.
+
+    The region lives until :func:`unlink_state_dict` is called, even after the
+    processes using it exit.
+
+    Arguments:
+        state_dict (dict): the tensors to share.
+        name (str): name of the region, used by other processes to attach to
+            it with :func:`attach_state_dict`.
+
+    Returns:
+        The result of ``attach_state_dict(name)``; the original tensors can be
+        freed.
+    """
+    save_shared(state_dict, _shm_path(name))
+    return attach_state_dict(name)
+
+
+def attach_state_dict(name):
+    r"""Attaches read-only to a region created by :func:`share_state_dict`.
+
+    Arguments:
+        name (str): name of the region.
+
+    Returns:
+        An ordered dict of read-only CPU tensors backed by the region.
+    """
+    return load_shared(_shm_path(name))
+
+
+def unlink_state_dict(name):
+    r"""Removes a region created by :func:`share_state_dict`. Processes
+    attached to it keep their mappings."""
+    os.unlink(_shm_path(name))
+
+
+def bind_state_dict(module, state_dict, strict=True):
+    r"""Makes the parameters and buffers of a module use the tensors of a state
+    dict, e.g. one returned by :func:`attach_state_dict`, without copying them
+    (unlike :meth:`~torch.nn.Module.load_state_dict`).
+
+    Arguments:
+        module (torch.nn.Module): the module to bind.
+        state_dict (dict): the tensors to use, with the keys of
+            ``module.state_dict()``.
+        strict (bool, default True): whether the keys of :attr:`state_dict`
+            must match the parameters and buffers of :attr:`module` exactly.
+    """
+    own = collections.OrderedDict(module.named_parameters())
+    own.update(module.named_buffers())
+    if strict:
+        missing = [key for key in own if key not in state_dict]
+        unexpected = [key for key in state_dict if key not in own]
+        if missing or unexpected:
+            raise KeyError("unexpected keys in state_dict: {}, missing keys in "
+                           "state_dict: {}".format(unexpected, missing))
+    for key, tensor in state_dict.items():
+        if key not in own:
+            continue
+        if own[key].size() != tensor.size() or own[key].dtype != tensor.dtype:
+            raise RuntimeError("size or type mismatch for {}: {} {} in state_dict, {} {} "
+                               "in module".format(key, tensor.dtype, tuple(tensor.size()),
+                                                  own[key].dtype, tuple(own[key].size())))
+        own[key].data = tensor
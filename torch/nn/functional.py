@@ -1152,7 +1152,8 @@ def embedding(input, weight, padding_idx=None, max_norm=None, norm_type=2,
 
 
 def embedding_bag(input, weight, offsets=None, max_norm=None, norm_type=2,
-                  scale_grad_by_freq=False, mode='mean', sparse=False):
+                  scale_grad_by_freq=False, mode='mean', sparse=False,
+                  per_sample_weights=None):
     r"""Computes sums or means of 'bags' of embeddings, without instantiating the
     intermediate embeddings.
 
@@ -1176,6 +1177,9 @@ def embedding_bag(input, weight, offsets=None, max_norm=None, norm_type=2,
         sparse (bool, optional): if ``True``, gradient w.r.t. :attr:`weight` will be a sparse tensor. See Notes under
                                  :class:`torch.nn.Embedding` for more details regarding sparse gradients.
                                  Note: this option is not supported when ``mode="max"``.
+        per_sample_weights (Tensor, optional): weights of the same shape as :attr:`input` that scale every
+                                               embedding before it is summed. Only supported for
+                                               ``mode="sum"`` on the CPU. Default ``None``.
 
     Shape:
 
@@ -1232,6 +1236,8 @@ def embedding_bag(input, weight, offsets=None, max_norm=None, norm_type=2,
                                    dtype=torch.long, device=input.device)
 
             input = input.reshape(-1)
+            if per_sample_weights is not None:
+                per_sample_weights = per_sample_weights.reshape(-1)
     elif input.dim() == 1:
         if offsets is None:
             raise ValueError("offsets has to be a 1D Tensor but got None")
@@ -1265,6 +1271,14 @@ def embedding_bag(input, weight, offsets=None, max_norm=None, norm_type=2,
     else:
         raise ValueError("mode has to be one of sum or mean")
 
+    if per_sample_weights is not None:
+        if mode != 0:
+            raise ValueError("per_sample_weights is only supported for mode='sum'")
+        if per_sample_weights.shape != input.shape:
+            raise ValueError("per_sample_weights has to have the same shape as input"
+                             " ({}), but got shape {}"
+                             .format(tuple(input.shape), tuple(per_sample_weights.shape)))
+
     if max_norm is not None:
         with torch.no_grad():
             torch.embedding_renorm_(weight, input, max_norm, norm_type)
@@ -1275,7 +1289,8 @@ def embedding_bag(input, weight, offsets=None, max_norm=None, norm_type=2,
         offsets,
         scale_grad_by_freq,
         mode,
-        sparse)
+        sparse,
+        per_sample_weights)
     return ret
 
 
@@ -1623,6 +1638,9 @@ def cross_entropy(input, target, weight=None, size_average=None, ignore_index=-1
     """
     if size_average is not None or reduce is not None:
         reduction = _Reduction.legacy_get_string(size_average, reduce)
+    if input.dim() == 2 and target.dim() == 1 and input.size(0) == target.size(0):
+        # Fused, doesn't materialize the log-probabilities
+        return torch.cross_entropy(input, target, weight, _Reduction.get_enum(reduction), ignore_index)
     return nll_loss(log_softmax(input, 1), target, weight, None, ignore_index, None, reduction)
 
 
@@ -193,7 +193,8 @@ class EmbeddingBag(Module):
         weight (Tensor): the learnable weights of the module of shape ``(num_embeddings x embedding_dim)``
                          initialized from :math:`\mathcal{N}(0, 1)`.
 
-    Inputs: :attr:`input` (LongTensor) and :attr:`offsets` (LongTensor, optional)
+    Inputs: :attr:`input` (LongTensor), :attr:`offsets` (LongTensor, optional), and
+        :attr:`per_sample_weights` (Tensor, optional)
 
         - If :attr:`input` is 2D of shape ``B x N``,
 
@@ -210,6 +211,10 @@ class EmbeddingBag(Module):
           having ``B`` bags. Empty bags (i.e., having 0-length) will have
           returned vectors filled by zeros.
 
+        - If :attr:`per_sample_weights` is given, it must have the same shape
+          as :attr:`input`, and every embedding is multiplied by its weight
+          before the reduction. Only supported for ``mode="sum"`` on the CPU.
+
     Output shape: ``B x embedding_dim``
 
     Examples::
@@ -242,10 +247,11 @@ class EmbeddingBag(Module):
     def reset_parameters(self):
         init.normal_(self.weight)
 
-    def forward(self, input, offsets=None):
+    def forward(self, input, offsets=None, per_sample_weights=None):
         return F.embedding_bag(input, self.weight, offsets,
                                self.max_norm, self.norm_type,
-                               self.scale_grad_by_freq, self.mode, self.sparse)
+                               self.scale_grad_by_freq, self.mode, self.sparse,
+                               per_sample_weights)
 
     def extra_repr(self):
         s = '{num_embeddings}, {embedding_dim}'
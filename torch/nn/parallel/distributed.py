@@ -6,7 +6,7 @@ import copy
 import torch
 from torch.autograd import Variable
 from torch._utils import _flatten_dense_tensors, _unflatten_dense_tensors, \
-    _take_tensors
+    _flatten_adjacent_dense_tensors, _unflatten_dense_tensors_, _take_tensors
 
 from torch.cuda.comm import broadcast_coalesced
 from torch.cuda import nccl
@@ -80,6 +80,13 @@ class DistributedDataParallel(Module):
         (e.g. BatchNorm stats) are broadcast from the module in process of rank
         0, to all other replicas in the system in every iteration.
 
+    .. note::
+        After the first backward pass, the ``.grad`` attributes of the
+        parameters are views of one flat buffer per bucket, which later
+        backward passes accumulate into and which is all-reduced without
+        copying. Replacing a ``.grad`` (rather than modifying it in place)
+        costs one copy in the next reduction.
+
     .. warning::
         Forward and backward hooks defined on :attr:`module` and its submodules
         won't be invoked anymore, unless the hooks are initialized in the
@@ -184,11 +191,14 @@ class DistributedDataParallel(Module):
                                            "with Nccl and Gloo backend")
                 if not param_tuple[0].requires_grad:
                     continue
+                # Gradients are kept in parameter order within a bucket, so that
+                # once they are views of one buffer they stay adjacent
                 for p in param_tuple:
-                    self.bucket_map[p] = bucket_idx
+                    self.bucket_map[p] = (bucket_idx, self.bucket_sizes[bucket_idx])
                 self.bucket_sizes[bucket_idx] += 1
 
-        self.buckets = [[[] for _ in range(len(self.device_ids))] for _ in range(len(self.bucket_sizes))]
+        self.buckets = [[[None] * size for _ in range(len(self.device_ids))] for size in self.bucket_sizes]
+        self.bucket_counts = [[0] * len(self.device_ids) for _ in range(len(self.bucket_sizes))]
         self.bucket_events = [[None] * len(self.device_ids) for _ in range(len(self.bucket_sizes))]
         self.reduced = [False] * len(self.bucket_sizes)
 
@@ -326,11 +336,17 @@ class DistributedDataParallel(Module):
             # Now reduce each bucket one after another
             for grads_batch in zip(*all_grads_buckets_iters):
                 grads_batch_coalesced = []
-                # Coalesce each bucket
+                # Coalesce each bucket. After the first reduction the gradients
+                # of the first device are views of one buffer per bucket, which
+                # is reduced in place.
+                grads_batch_aliased = _flatten_adjacent_dense_tensors(grads_batch[0])
                 for dev_idx, dev_grads_batch in enumerate(grads_batch):
                     dev_id = self.device_ids[dev_idx]
                     with torch.cuda.device(dev_id):
-                        dev_grads_batch_coalesced = _flatten_dense_tensors(dev_grads_batch)
+                        if dev_idx == 0 and grads_batch_aliased is not None:
+                            dev_grads_batch_coalesced = grads_batch_aliased
+                        else:
+                            dev_grads_batch_coalesced = _flatten_dense_tensors(dev_grads_batch)
                         grads_batch_coalesced.append(dev_grads_batch_coalesced)
 
                 # We will only use device 0's results, but this single op should be
@@ -343,9 +359,8 @@ class DistributedDataParallel(Module):
                 # Now only work on the first device of self.device_ids, uncoalesce
                 # the gradients for each bucket
                 grads_batch_coalesced[0] /= dist.get_world_size()
-                grads_batch_reduced = _unflatten_dense_tensors(grads_batch_coalesced[0], grads_batch[0])
-                for grad, reduced in zip(grads_batch[0], grads_batch_reduced):
-                    grad.copy_(reduced)
+                if grads_batch_aliased is None:
+                    _unflatten_dense_tensors_(grads_batch_coalesced[0], grads_batch[0])
 
             # clear the gradients and save memory for replicas
             for module in self._module_copies[1:]:
@@ -366,14 +381,15 @@ class DistributedDataParallel(Module):
 
     def _make_param_hook(self, param, device_idx):
 
-        bucket_idx = self.bucket_map[param]
+        bucket_idx, bucket_offset = self.bucket_map[param]
 
         def distributed_data_parallel_hook(*unused):
             if param.grad.requires_grad:
                 raise RuntimeError("DistributedDataParallel only works with "
                                    "gradients that don't require grad")
             bucket = self.buckets[bucket_idx][device_idx]
-            bucket.append(param.grad.data)
+            bucket[bucket_offset] = param.grad.data
+            self.bucket_counts[bucket_idx][device_idx] += 1
 
             # We can flush these and save memory for replicas
             if device_idx > 0:
@@ -381,7 +397,7 @@ class DistributedDataParallel(Module):
                 param.data.set_()
 
             # Current device's bucket is full
-            if len(bucket) == self.bucket_sizes[bucket_idx]:
+            if self.bucket_counts[bucket_idx][device_idx] == self.bucket_sizes[bucket_idx]:
                 with torch.cuda.device(self.device_ids[device_idx]):
                     event = torch.cuda.Event()
                     event.record()
@@ -405,7 +421,8 @@ class DistributedDataParallel(Module):
         Variable._execution_engine.queue_callback(lambda: event.wait())
 
         # Reset bucket state
-        self.buckets[bucket_idx] = [[] for _ in range(len(self.device_ids))]
+        self.buckets[bucket_idx] = [[None] * self.bucket_sizes[bucket_idx] for _ in range(len(self.device_ids))]
+        self.bucket_counts[bucket_idx] = [0] * len(self.device_ids)
         self.bucket_events[bucket_idx] = [None] * len(self.device_ids)
         self.reduced[bucket_idx] = True
         if all(self.reduced):
@@ -454,11 +471,17 @@ class DistributedDataParallel(Module):
         def _process_batch():
             dev_grad_batch, dev_events, job_event = queue.get()
             dev_coalesced = []
+            # After the first reduction the gradients of the first device are
+            # views of one buffer per bucket, which is reduced in place
+            aliased = _flatten_adjacent_dense_tensors(dev_grad_batch[0])
             # Coalesce the tensors on all devices and start a local reduction
             for dev_id, grad_batch, event, stream in zip(device_ids, dev_grad_batch, dev_events, reduction_streams):
                 with torch.cuda.device(dev_id), torch.cuda.stream(stream):
                     stream.wait_event(event)
-                    coalesced = _flatten_dense_tensors(grad_batch)
+                    if aliased is not None and len(dev_coalesced) == 0:
+                        coalesced = aliased
+                    else:
+                        coalesced = _flatten_dense_tensors(grad_batch)
                     dev_coalesced.append(coalesced)
             # Wait for all copies to complete before starting the NCCL kernel
             for stream in reduction_streams:
@@ -473,8 +496,8 @@ class DistributedDataParallel(Module):
                 reduce_stream.wait_stream(nccl_streams[0])
                 coalesced /= dist.get_world_size()
                 dist.all_reduce(coalesced, group=group_id)
-                for grad, reduced in zip(grad_batch, _unflatten_dense_tensors(coalesced, grad_batch)):
-                    grad.copy_(reduced)
+                if aliased is None:
+                    _unflatten_dense_tensors_(coalesced, grad_batch)
             job_event.set()
 
         with torch.cuda.device(device_ids[0]):
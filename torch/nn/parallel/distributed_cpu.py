@@ -1,5 +1,6 @@
 import torch
-from torch._utils import _flatten_dense_tensors, _unflatten_dense_tensors
+from torch._utils import _flatten_dense_tensors, _flatten_adjacent_dense_tensors, \
+    _unflatten_dense_tensors_
 import torch.distributed as dist
 from torch.nn.modules import Module
 from collections import defaultdict
@@ -53,6 +54,13 @@ class DistributedDataParallelCPU(Module):
         module performs an all-reduce step on gradients and assumes that they
         will be modified by the optimizer in all nodes in the same way.
 
+    .. note::
+        After the first backward pass, the ``.grad`` attributes of the
+        parameters are views of one flat buffer per bucket, which later
+        backward passes accumulate into and which is all-reduced without
+        copying. Replacing a ``.grad`` (rather than modifying it in place)
+        costs one copy in the next reduction.
+
     .. warning::
         Forward and backward hooks defined on :attr:`module` and its submodules
         won't be invoked anymore, unless the hooks are initialized in the
@@ -83,11 +91,14 @@ class DistributedDataParallelCPU(Module):
 
                 for bucket in buckets.values():
                     grads = [param.grad.data for param in bucket]
-                    coalesced = _flatten_dense_tensors(grads)
+                    # After the first reduction the gradients are views of
+                    # one buffer per bucket, which is reduced in place
+                    coalesced = _flatten_adjacent_dense_tensors(grads)
+                    if coalesced is None:
+                        coalesced = _flatten_dense_tensors(grads)
+                        _unflatten_dense_tensors_(coalesced, grads)
                     dist.all_reduce(coalesced)
                     coalesced /= dist.get_world_size()
-                    for buf, synced in zip(grads, _unflatten_dense_tensors(coalesced, grads)):
-                        buf.copy_(synced)
 
         for param in list(self.module.parameters()):
             def allreduce_hook(*unused):
@@ -329,14 +329,17 @@ def embedding(g, weight, indices, padding_idx, scale_grad_by_freq, sparse):
     return g.op("Gather", weight, indices)
 
 
-@parse_args('v', 'v', 'v', 'i', 'i', 'i')
+@parse_args('v', 'v', 'v', 'i', 'i', 'i', 'v')
 def embedding_bag(g,
                   embedding_matrix,
                   indices,
                   offsets,
                   scale_grad_by_freq,
                   mode,
-                  sparse):
+                  sparse,
+                  per_sample_weights):
+    if per_sample_weights.node().kind() != "prim::Undefined":
+        return _unimplemented("embedding_bag", "per_sample_weights")
     return g.op("ATen",
                 embedding_matrix,
                 indices,
@@ -716,10 +719,11 @@ def index_select(g, self, dim, index):
     return g.op("Gather", self, index, axis_i=dim)
 
 
-def index_put(g, self, indices_list_value, values):
+@parse_args('v', 'v', 'v', 'i')
+def index_put(g, self, indices_list_value, values, accumulate):
     indices_list = list(_unpack_list(indices_list_value))
     args = [self] + indices_list + [values]
-    return g.op("ATen", *args, operator_s='index_put')
+    return g.op("ATen", *args, accumulate_i=accumulate, operator_s='index_put')
 
 
 def type_as(g, self, other):
@@ -8,6 +8,7 @@ import torch
 import torch.jit
 import torch.autograd
 import torch.serialization
+import os
 import re
 import collections
 import contextlib
@@ -43,7 +44,7 @@ def set_training(model, mode):
 
 def export(model, args, f, export_params=True, verbose=False, training=False,
            input_names=None, output_names=None, aten=False, export_raw_ir=False,
-           operator_export_type=None):
+           operator_export_type=None, do_constant_folding=False):
     r"""
     Export a model into ONNX format.  This exporter runs your model
     once in order to get a trace of its execution to be exported;
@@ -83,6 +84,11 @@ def export(model, args, f, export_params=True, verbose=False, training=False,
             by the functions in symbolic.py are exported as ATen ops.
         export_raw_ir (bool, default False): [DEPRECATED. use operator_export_type]
             export the internal IR directly instead of converting it to ONNX ops.
+        do_constant_folding (bool, default False): if specified (and the
+            parameters are exported), the computations that only depend on
+            the parameters, such as weight transposes, are done at export time,
+            BatchNormalization is folded into a preceding Conv, and the
+            parameters that are no longer used are not exported.
     """
     if aten or export_raw_ir:
         assert operator_export_type is None
@@ -91,7 +97,7 @@ def export(model, args, f, export_params=True, verbose=False, training=False,
     elif operator_export_type is None:
         operator_export_type = OperatorExportTypes.ONNX
     _export(model, args, f, export_params, verbose, training, input_names, output_names,
-            operator_export_type=operator_export_type)
+            operator_export_type=operator_export_type, do_constant_folding=do_constant_folding)
 
 
 def _list_constant_prop(g, block):
@@ -175,7 +181,7 @@ def _trace_and_get_graph_from_model(model, args, training):
 def _model_to_graph(model, args, f, verbose=False, training=False,
                     input_names=None, output_names=None,
                     operator_export_type=OperatorExportTypes.ONNX,
-                    example_outputs=None, propagate=False):
+                    example_outputs=None, propagate=False, do_constant_folding=False):
     # Special case for common case of passing a single Variable
     if isinstance(args, torch.Tensor):
         args = (args, )
@@ -200,6 +206,11 @@ def _model_to_graph(model, args, f, verbose=False, training=False,
 
     graph = _optimize_graph(graph, operator_export_type)
 
+    if do_constant_folding and operator_export_type != OperatorExportTypes.RAW:
+        with torch.no_grad():
+            params = torch._C._jit_pass_onnx_constant_fold(graph, params)
+        torch._C._jit_pass_lint(graph)
+
     _set_input_and_output_names(graph, input_names, output_names)
     if verbose:
         print(graph)
@@ -210,7 +221,8 @@ def _model_to_graph(model, args, f, verbose=False, training=False,
 def export_to_pretty_string(model, args, f, export_params=True, verbose=False, training=False,
                             input_names=None, output_names=None, aten=False, export_raw_ir=False,
                             operator_export_type=None, export_type=ExportTypes.PROTOBUF_FILE,
-                            example_outputs=None, propagate=False, google_printer=False):
+                            example_outputs=None, propagate=False, google_printer=False,
+                            do_constant_folding=False):
     if aten or export_raw_ir:
         assert operator_export_type is None
         assert aten ^ export_raw_ir
@@ -219,17 +231,19 @@ def export_to_pretty_string(model, args, f, export_params=True, verbose=False, t
         operator_export_type = OperatorExportTypes.ONNX
     return _export_to_pretty_string(model, args, f, export_params, verbose, training,
                                     input_names, output_names, operator_export_type,
-                                    export_type, example_outputs, propagate, google_printer)
+                                    export_type, example_outputs, propagate, google_printer,
+                                    do_constant_folding)
 
 
 def _export_to_pretty_string(model, args, f, export_params=True, verbose=False, training=False,
                              input_names=None, output_names=None, operator_export_type=OperatorExportTypes.ONNX,
                              export_type=ExportTypes.PROTOBUF_FILE, example_outputs=None, propagate=False,
-                             google_printer=False):
+                             google_printer=False, do_constant_folding=False):
     graph, params, torch_out = _model_to_graph(model, args, f, verbose,
                                                training, input_names,
                                                output_names, operator_export_type,
-                                               example_outputs, propagate)
+                                               example_outputs, propagate,
+                                               do_constant_folding and export_params)
 
     from torch.onnx.symbolic import _onnx_opset_version
     return graph.prettyPrintExport(params, _onnx_opset_version, False, operator_export_type, google_printer)
@@ -241,17 +255,28 @@ def _export_to_pretty_string(model, args, f, export_params=True, verbose=False,
 # directly extracting the graph.
 def _export(model, args, f, export_params=True, verbose=False, training=False,
             input_names=None, output_names=None, operator_export_type=OperatorExportTypes.ONNX,
-            export_type=ExportTypes.PROTOBUF_FILE, example_outputs=None, propagate=False):
+            export_type=ExportTypes.PROTOBUF_FILE, example_outputs=None, propagate=False,
+            do_constant_folding=False):
     graph, params, torch_out = _model_to_graph(model, args, f, verbose,
                                                training, input_names,
                                                output_names, operator_export_type,
-                                               example_outputs, propagate)
+                                               example_outputs, propagate,
+                                               do_constant_folding and export_params)
 
     # TODO: Don't allocate a in-memory string for the protobuf
     from torch.onnx.symbolic import _onnx_opset_version
     defer_weight_export = export_type is not ExportTypes.PROTOBUF_FILE
+    external_data_directory = ""
+    if export_type == ExportTypes.DIRECTORY:
+        if os.path.exists(f):
+            assert(os.path.isdir(f))
+        else:
+            os.makedirs(f)
+        # the weights are written to the directory while exporting
+        external_data_directory = f
     if export_params:
-        proto, export_map = graph.export(params, _onnx_opset_version, defer_weight_export, operator_export_type)
+        proto, export_map = graph.export(params, _onnx_opset_version, defer_weight_export, operator_export_type,
+                                         external_data_directory)
     else:
         proto, export_map = graph.export([], _onnx_opset_version, False, operator_export_type)
 
@@ -268,20 +293,10 @@ def _export(model, args, f, export_params=True, verbose=False, training=False,
             for k, v in export_map.items():
                 z.writestr(k, v)
     elif export_type == ExportTypes.DIRECTORY:
-        import os
-        if os.path.exists(f):
-            assert(os.path.isdir(f))
-        else:
-            os.makedirs(f)
-
+        assert(len(export_map) == 0)
         model_proto_file = os.path.join(f, ONNX_ARCHIVE_MODEL_PROTO_NAME)
         torch.serialization._with_file_like(
             model_proto_file, "wb", lambda f: f.write(proto))
-
-        for k, v in export_map.items():
-            weight_proto_file = os.path.join(f, k)
-            torch.serialization._with_file_like(
-                weight_proto_file, "wb", lambda f: f.write(v))
     else:
         raise RuntimeError('Unknown export type')
     return torch_out
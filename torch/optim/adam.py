@@ -20,6 +20,9 @@ class Adam(Optimizer):
         amsgrad (boolean, optional): whether to use the AMSGrad variant of this
             algorithm from the paper `On the Convergence of Adam and Beyond`_
             (default: False)
+        fused (bool, optional): updates all parameters of a group with a few
+            kernel launches, which is faster for models with many small
+            parameters, in particular on CUDA (default: False)
 
     .. _Adam\: A Method for Stochastic Optimization:
         https://arxiv.org/abs/1412.6980
@@ -28,7 +31,7 @@ class Adam(Optimizer):
     """
 
     def __init__(self, params, lr=1e-3, betas=(0.9, 0.999), eps=1e-8,
-                 weight_decay=0, amsgrad=False):
+                 weight_decay=0, amsgrad=False, fused=False):
         if not 0.0 <= lr:
             raise ValueError("Invalid learning rate: {}".format(lr))
         if not 0.0 <= eps:
@@ -38,13 +41,15 @@ class Adam(Optimizer):
         if not 0.0 <= betas[1] < 1.0:
             raise ValueError("Invalid beta parameter at index 1: {}".format(betas[1]))
         defaults = dict(lr=lr, betas=betas, eps=eps,
-                        weight_decay=weight_decay, amsgrad=amsgrad)
+                        weight_decay=weight_decay, amsgrad=amsgrad,
+                        fused=fused)
         super(Adam, self).__init__(params, defaults)
 
     def __setstate__(self, state):
         super(Adam, self).__setstate__(state)
         for group in self.param_groups:
             group.setdefault('amsgrad', False)
+            group.setdefault('fused', False)
 
     def step(self, closure=None):
         """Performs a single optimization step.
@@ -58,6 +63,10 @@ class Adam(Optimizer):
             loss = closure()
 
         for group in self.param_groups:
+            if group['fused']:
+                self._fused_step(group)
+                continue
+
             for p in group['params']:
                 if p.grad is None:
                     continue
@@ -70,14 +79,7 @@ class Adam(Optimizer):
 
                 # State initialization
                 if len(state) == 0:
-                    state['step'] = 0
-                    # Exponential moving average of gradient values
-                    state['exp_avg'] = torch.zeros_like(p.data)
-                    # Exponential moving average of squared gradient values
-                    state['exp_avg_sq'] = torch.zeros_like(p.data)
-                    if amsgrad:
-                        # Maintains max of all exp. moving avg. of sq. grad. values
-                        state['max_exp_avg_sq'] = torch.zeros_like(p.data)
+                    self._init_state(state, p, amsgrad)
 
                 exp_avg, exp_avg_sq = state['exp_avg'], state['exp_avg_sq']
                 if amsgrad:
@@ -107,3 +109,45 @@ class Adam(Optimizer):
                 p.data.addcdiv_(-step_size, exp_avg, denom)
 
         return loss
+
+    def _init_state(self, state, p, amsgrad):
+        state['step'] = 0
+        # Exponential moving average of gradient values
+        state['exp_avg'] = torch.zeros_like(p.data)
+        # Exponential moving average of squared gradient values
+        state['exp_avg_sq'] = torch.zeros_like(p.data)
+        if amsgrad:
+            # Maintains max of all exp. moving avg. of sq. grad. values
+            state['max_exp_avg_sq'] = torch.zeros_like(p.data)
+
+    def _fused_step(self, group):
+        amsgrad = group['amsgrad']
+        beta1, beta2 = group['betas']
+        # The step size depends on the step, so parameters at different steps
+        # are updated by separate calls.
+        by_step = {}
+        for p in group['params']:
+            if p.grad is None:
+                continue
+            if p.grad.is_sparse:
+                raise RuntimeError('Adam does not support sparse gradients, please consider SparseAdam instead')
+            state = self.state[p]
+            if len(state) == 0:
+                self._init_state(state, p, amsgrad)
+            state['step'] += 1
+            lists = by_step.setdefault(state['step'], ([], [], [], [], []))
+            lists[0].append(p.data)
+            lists[1].append(p.grad.data)
+            lists[2].append(state['exp_avg'])
+            lists[3].append(state['exp_avg_sq'])
+            if amsgrad:
+                lists[4].append(state['max_exp_avg_sq'])
+
+        for step, lists in by_step.items():
+            bias_correction1 = 1 - beta1 ** step
+            bias_correction2 = 1 - beta2 ** step
+            step_size = group['lr'] * math.sqrt(bias_correction2) / bias_correction1
+            torch._fused_adam_step(*lists, step_size=step_size, beta1=beta1,
+                                   beta2=beta2, eps=group['eps'],
+                                   weight_decay=group['weight_decay'],
+                                   amsgrad=amsgrad)
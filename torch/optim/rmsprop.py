@@ -22,10 +22,14 @@ class RMSprop(Optimizer):
         centered (bool, optional) : if ``True``, compute the centered RMSProp,
             the gradient is normalized by an estimation of its variance
         weight_decay (float, optional): weight decay (L2 penalty) (default: 0)
+        fused (bool, optional): updates all parameters of a group with a few
+            kernel launches, which is faster for models with many small
+            parameters, in particular on CUDA (default: False)
 
     """
 
-    def __init__(self, params, lr=1e-2, alpha=0.99, eps=1e-8, weight_decay=0, momentum=0, centered=False):
+    def __init__(self, params, lr=1e-2, alpha=0.99, eps=1e-8, weight_decay=0, momentum=0, centered=False,
+                 fused=False):
         if not 0.0 <= lr:
             raise ValueError("Invalid learning rate: {}".format(lr))
         if not 0.0 <= eps:
@@ -37,7 +41,8 @@ class RMSprop(Optimizer):
         if not 0.0 <= alpha:
             raise ValueError("Invalid alpha value: {}".format(alpha))
 
-        defaults = dict(lr=lr, momentum=momentum, alpha=alpha, eps=eps, centered=centered, weight_decay=weight_decay)
+        defaults = dict(lr=lr, momentum=momentum, alpha=alpha, eps=eps, centered=centered, weight_decay=weight_decay,
+                        fused=fused)
         super(RMSprop, self).__init__(params, defaults)
 
     def __setstate__(self, state):
@@ -45,6 +50,7 @@ class RMSprop(Optimizer):
         for group in self.param_groups:
             group.setdefault('momentum', 0)
             group.setdefault('centered', False)
+            group.setdefault('fused', False)
 
     def step(self, closure=None):
         """Performs a single optimization step.
@@ -58,6 +64,10 @@ class RMSprop(Optimizer):
             loss = closure()
 
         for group in self.param_groups:
+            if group['fused']:
+                self._fused_step(group)
+                continue
+
             for p in group['params']:
                 if p.grad is None:
                     continue
@@ -68,12 +78,7 @@ class RMSprop(Optimizer):
 
                 # State initialization
                 if len(state) == 0:
-                    state['step'] = 0
-                    state['square_avg'] = torch.zeros_like(p.data)
-                    if group['momentum'] > 0:
-                        state['momentum_buffer'] = torch.zeros_like(p.data)
-                    if group['centered']:
-                        state['grad_avg'] = torch.zeros_like(p.data)
+                    self._init_state(state, p, group)
 
                 square_avg = state['square_avg']
                 alpha = group['alpha']
@@ -100,3 +105,35 @@ class RMSprop(Optimizer):
                     p.data.addcdiv_(-group['lr'], grad, avg)
 
         return loss
+
+    def _init_state(self, state, p, group):
+        state['step'] = 0
+        state['square_avg'] = torch.zeros_like(p.data)
+        if group['momentum'] > 0:
+            state['momentum_buffer'] = torch.zeros_like(p.data)
+        if group['centered']:
+            state['grad_avg'] = torch.zeros_like(p.data)
+
+    def _fused_step(self, group):
+        params, grads, square_avgs, bufs, grad_avgs = [], [], [], [], []
+        for p in group['params']:
+            if p.grad is None:
+                continue
+            if p.grad.is_sparse:
+                raise RuntimeError('RMSprop does not support sparse gradients')
+            state = self.state[p]
+            if len(state) == 0:
+                self._init_state(state, p, group)
+            state['step'] += 1
+            params.append(p.data)
+            grads.append(p.grad.data)
+            square_avgs.append(state['square_avg'])
+            if group['momentum'] > 0:
+                bufs.append(state['momentum_buffer'])
+            if group['centered']:
+                grad_avgs.append(state['grad_avg'])
+
+        torch._fused_rmsprop_step(params, grads, square_avgs, bufs, grad_avgs,
+                                  group['lr'], group['alpha'], group['eps'],
+                                  group['weight_decay'], group['momentum'],
+                                  group['centered'])
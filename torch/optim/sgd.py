@@ -16,6 +16,11 @@ class SGD(Optimizer):
         weight_decay (float, optional): weight decay (L2 penalty) (default: 0)
         dampening (float, optional): dampening for momentum (default: 0)
         nesterov (bool, optional): enables Nesterov momentum (default: False)
+        fused (bool, optional): updates all parameters of a group with a few
+            kernel launches, which is faster for models with many small
+            parameters, in particular on CUDA. Unlike the default
+            implementation, the gradients aren't modified by the weight decay.
+            Sparse gradients aren't supported (default: False)
 
     Example:
         >>> optimizer = torch.optim.SGD(model.parameters(), lr=0.1, momentum=0.9)
@@ -49,7 +54,7 @@ class SGD(Optimizer):
     """
 
     def __init__(self, params, lr=required, momentum=0, dampening=0,
-                 weight_decay=0, nesterov=False):
+                 weight_decay=0, nesterov=False, fused=False):
         if lr is not required and lr < 0.0:
             raise ValueError("Invalid learning rate: {}".format(lr))
         if momentum < 0.0:
@@ -58,7 +63,8 @@ class SGD(Optimizer):
             raise ValueError("Invalid weight_decay value: {}".format(weight_decay))
 
         defaults = dict(lr=lr, momentum=momentum, dampening=dampening,
-                        weight_decay=weight_decay, nesterov=nesterov)
+                        weight_decay=weight_decay, nesterov=nesterov,
+                        fused=fused)
         if nesterov and (momentum <= 0 or dampening != 0):
             raise ValueError("Nesterov momentum requires a momentum and zero dampening")
         super(SGD, self).__init__(params, defaults)
@@ -67,6 +73,7 @@ class SGD(Optimizer):
         super(SGD, self).__setstate__(state)
         for group in self.param_groups:
             group.setdefault('nesterov', False)
+            group.setdefault('fused', False)
 
     def step(self, closure=None):
         """Performs a single optimization step.
@@ -85,6 +92,10 @@ class SGD(Optimizer):
             dampening = group['dampening']
             nesterov = group['nesterov']
 
+            if group['fused']:
+                self._fused_step(group)
+                continue
+
             for p in group['params']:
                 if p.grad is None:
                     continue
@@ -107,3 +118,33 @@ class SGD(Optimizer):
                 p.data.add_(-group['lr'], d_p)
 
         return loss
+
+    def _fused_step(self, group):
+        momentum = group['momentum']
+        # New momentum buffers start at zero and are set to the gradients,
+        # without dampening, by a separate call.
+        params, grads, bufs = [], [], []
+        new_params, new_grads, new_bufs = [], [], []
+        for p in group['params']:
+            if p.grad is None:
+                continue
+            if p.grad.is_sparse:
+                raise RuntimeError('fused SGD does not support sparse gradients')
+            param_state = self.state[p]
+            if momentum != 0 and 'momentum_buffer' not in param_state:
+                param_state['momentum_buffer'] = torch.zeros_like(p.data)
+                new_params.append(p.data)
+                new_grads.append(p.grad.data)
+                new_bufs.append(param_state['momentum_buffer'])
+            else:
+                params.append(p.data)
+                grads.append(p.grad.data)
+                if momentum != 0:
+                    bufs.append(param_state['momentum_buffer'])
+
+        torch._fused_sgd_step(params, grads, bufs, group['lr'], momentum,
+                              group['dampening'], group['weight_decay'],
+                              group['nesterov'])
+        torch._fused_sgd_step(new_params, new_grads, new_bufs, group['lr'],
+                              momentum, 0, group['weight_decay'],
+                              group['nesterov'])
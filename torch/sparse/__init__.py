@@ -1 +1,56 @@
 # The Tensor classes are added to this module by python_tensor.cpp
+import torch
+
+__all__ = [
+    'to_csr',
+    'from_csr',
+]
+
+
+def to_csr(input):
+    r"""Returns the compressed sparse row (CSR) form of a sparse matrix
+    :attr:`input` as a tuple ``(crow_indices, col_indices, values)``.
+
+    The entries of row ``r`` are ``values[crow_indices[r]:crow_indices[r + 1]]``
+    in the columns ``col_indices[crow_indices[r]:crow_indices[r + 1]]``.
+    :attr:`input` is coalesced first. The row pointers are cached on the
+    coalesced tensor, which also speeds up repeated :func:`torch.mm` calls
+    with it.
+
+    Args:
+        input (Tensor): a sparse matrix with scalar values
+
+    Example::
+
+        >>> i = torch.tensor([[0, 1, 1], [2, 0, 2]])
+        >>> v = torch.tensor([3., 4., 5.])
+        >>> torch.sparse.to_csr(torch.sparse_coo_tensor(i, v, (3, 3)))
+        (tensor([0, 1, 3, 3]), tensor([2, 0, 2]), tensor([3., 4., 5.]))
+    """
+    input = input.coalesce()
+    return input._crow_indices(), input._indices()[1], input._values()
+
+
+def from_csr(crow_indices, col_indices, values, size):
+    r"""Constructs a sparse matrix of the given :attr:`size` from its
+    compressed sparse row (CSR) form; see :func:`to_csr`.
+
+    If the column indices of every row are strictly increasing, the result is
+    coalesced and keeps :attr:`crow_indices` as its cached row pointers.
+
+    Args:
+        crow_indices (LongTensor): the ``size[0] + 1`` row pointers
+        col_indices (LongTensor): the column of every value
+        values (Tensor): the values, in row order
+        size (list, tuple, or :class:`torch.Size`): the size of the matrix
+
+    Example::
+
+        >>> crow = torch.tensor([0, 1, 3, 3])
+        >>> col = torch.tensor([2, 0, 2])
+        >>> torch.sparse.from_csr(crow, col, torch.tensor([3., 4., 5.]), (3, 3)).to_dense()
+        tensor([[0., 0., 3.],
+                [4., 0., 5.],
+                [0., 0., 0.]])
+    """
+    return torch._sparse_coo_tensor_from_csr(crow_indices, col_indices, values, size)
@@ -72,9 +72,11 @@ else:
             return os.getppid() == self.manager_pid
 
 
-def _worker_loop(dataset, index_queue, data_queue, done_event, collate_fn, seed, init_fn, worker_id):
+def _worker_loop(dataset, index_queue, data_queue, done_event, collate_fn, seed, init_fn, worker_id,
+                 ring=None):
     global _use_shared_memory
-    _use_shared_memory = True
+    # batches sent through the ring are copied into its buffers instead
+    _use_shared_memory = ring is None
 
     # Intialize C side signal handlers for SIGBUS and SIGSEGV. Python signal
     # module's handlers are executed after Python returns from C low-level
@@ -114,11 +116,13 @@ def _worker_loop(dataset, index_queue, data_queue, done_event, collate_fn, seed,
         except Exception:
             data_queue.put((idx, ExceptionWrapper(sys.exc_info())))
         else:
+            if ring is not None:
+                samples = ring.pack(samples, done_event, watchdog)
             data_queue.put((idx, samples))
             del samples
 
 
-def _pin_memory_loop(in_queue, out_queue, done_event, pin_memory, device_id):
+def _pin_memory_loop(in_queue, out_queue, done_event, pin_memory, device_id, rings=None):
     if pin_memory:
         torch.cuda.set_device(device_id)
 
@@ -136,7 +140,9 @@ def _pin_memory_loop(in_queue, out_queue, done_event, pin_memory, device_id):
             continue
         idx, batch = r
         try:
-            if pin_memory:
+            if isinstance(batch, _SharedMemoryRingBatch):
+                batch = rings[batch.worker_id].unpack(batch, pin_memory)
+            elif pin_memory:
                 batch = pin_memory_batch(batch)
         except Exception:
             out_queue.put((idx, ExceptionWrapper(sys.exc_info())))
@@ -197,18 +203,146 @@ def default_collate(batch):
 
 
 def pin_memory_batch(batch):
+    # dense tensors of the same type are pinned into one buffer, instead of a
+    # pinned allocation each, which is costly for batches of many small tensors
+    groups = collections.OrderedDict()
+    for tensor in _batch_tensors(batch):
+        if not tensor.is_sparse:
+            groups.setdefault(tensor.type(), []).append(tensor)
+    pinned = {}
+    for tensors in groups.values():
+        for tensor, pinned_tensor in zip(tensors, torch._pin_memory_coalesced(tensors)):
+            pinned[id(tensor)] = pinned_tensor
+    return _map_batch(batch, lambda t: pinned[id(t)] if id(t) in pinned else t.pin_memory())
+
+
+def _batch_tensors(batch):
     if isinstance(batch, torch.Tensor):
-        return batch.pin_memory()
+        yield batch
+    elif isinstance(batch, string_classes):
+        return
+    elif isinstance(batch, collections.Mapping):
+        for sample in batch.values():
+            for tensor in _batch_tensors(sample):
+                yield tensor
+    elif isinstance(batch, collections.Sequence):
+        for sample in batch:
+            for tensor in _batch_tensors(sample):
+                yield tensor
+
+
+def _map_batch(batch, fn, leaf_type=torch.Tensor):
+    if isinstance(batch, leaf_type):
+        return fn(batch)
     elif isinstance(batch, string_classes):
         return batch
     elif isinstance(batch, collections.Mapping):
-        return {k: pin_memory_batch(sample) for k, sample in batch.items()}
+        return {k: _map_batch(sample, fn, leaf_type) for k, sample in batch.items()}
     elif isinstance(batch, collections.Sequence):
-        return [pin_memory_batch(sample) for sample in batch]
+        return [_map_batch(sample, fn, leaf_type) for sample in batch]
     else:
         return batch
 
 
+class _SharedMemoryRingTensor(object):
+    r"""Placeholder for a tensor of a batch stored in a shared memory ring"""
+
+    def __init__(self, tensor_type, offset, size):
+        self.tensor_type = tensor_type
+        self.offset = offset
+        self.size = size
+
+
+class _SharedMemoryRingBatch(object):
+    r"""A batch stored in a slot of a worker's shared memory ring, along with
+    the buffers the main process has not seen yet"""
+
+    def __init__(self, worker_id, slot, new_buffers, layout):
+        self.worker_id = worker_id
+        self.slot = slot
+        self.new_buffers = new_buffers
+        self.layout = layout
+
+
+class _SharedMemoryRing(object):
+    r"""Transfers the batches of a worker through a few slots of shared memory
+    buffers, one per tensor type, that are reused across batches. Sharing a
+    tensor otherwise costs a new shared memory segment for every batch.
+
+    The worker and the main process each keep the buffers of every slot. A
+    buffer is only sent along with the first batch stored in it, so a batch
+    that fits the buffers of its slot only carries offsets and sizes. The main
+    process copies the batch out of the slot and hands the slot back.
+    """
+
+    def __init__(self, worker_id, num_slots=2):
+        self.worker_id = worker_id
+        self.free_slots = multiprocessing.Queue()
+        for slot in range(num_slots):
+            self.free_slots.put(slot)
+        self.buffers = [{} for _ in range(num_slots)]
+
+    def pack(self, batch, done_event, watchdog):
+        r"""Called by the worker; returns batch unchanged if it can't be stored"""
+        tensors = list(_batch_tensors(batch))
+        if not tensors or any(t.is_sparse or t.is_cuda for t in tensors):
+            return batch
+        slot = None
+        while slot is None and watchdog.is_alive() and not done_event.is_set():
+            try:
+                slot = self.free_slots.get(timeout=MANAGER_STATUS_CHECK_INTERVAL)
+            except queue.Empty:
+                continue
+            if slot is None:
+                # the loader is shutting down
+                return batch
+        if slot is None:
+            return batch
+
+        numels = collections.OrderedDict()
+        examples = {}
+        for t in tensors:
+            numels[t.type()] = numels.get(t.type(), 0) + t.numel()
+            examples.setdefault(t.type(), t)
+        buffers = self.buffers[slot]
+        new_buffers = {}
+        for tensor_type, numel in numels.items():
+            if tensor_type not in buffers or buffers[tensor_type].numel() < numel:
+                example = examples[tensor_type]
+                buffer = example.new(example.storage()._new_shared(numel))
+                buffers[tensor_type] = new_buffers[tensor_type] = buffer
+
+        offsets = collections.defaultdict(int)
+
+        def store(t):
+            tensor_type = t.type()
+            offset = offsets[tensor_type]
+            buffers[tensor_type].narrow(0, offset, t.numel()).view_as(t).copy_(t)
+            offsets[tensor_type] += t.numel()
+            return _SharedMemoryRingTensor(tensor_type, offset, t.size())
+
+        layout = _map_batch(batch, store)
+        return _SharedMemoryRingBatch(self.worker_id, slot, new_buffers, layout)
+
+    def unpack(self, ring_batch, pin_memory=False):
+        r"""Called by the main process; copies the batch out of its slot"""
+        buffers = self.buffers[ring_batch.slot]
+        buffers.update(ring_batch.new_buffers)
+
+        def view(placeholder):
+            buffer = buffers[placeholder.tensor_type]
+            numel = functools.reduce(lambda x, y: x * y, placeholder.size, 1)
+            return buffer.narrow(0, placeholder.offset, numel).view(placeholder.size)
+
+        batch = _map_batch(ring_batch.layout, view, _SharedMemoryRingTensor)
+        try:
+            if pin_memory:
+                return pin_memory_batch(batch)
+            return _map_batch(batch, lambda t: t.clone())
+        finally:
+            self.free_slots.put(ring_batch.slot)
+
+
 _SIGCHLD_handler_set = False
 r"""Whether SIGCHLD handler is set for DataLoader worker failures. Only one
 handler needs to be set for all DataLoaders in a process."""
@@ -266,6 +400,10 @@ class _DataLoaderIter(object):
             self.rcvd_idx = 0
             self.reorder_dict = {}
             self.done_event = multiprocessing.Event()
+            if loader.reuse_shared_memory:
+                self.rings = [_SharedMemoryRing(i) for i in range(self.num_workers)]
+            else:
+                self.rings = [None] * self.num_workers
 
             self.workers = [
                 multiprocessing.Process(
@@ -273,7 +411,7 @@ class _DataLoaderIter(object):
                     args=(self.dataset, self.index_queues[i],
                           self.worker_result_queue, self.done_event,
                           self.collate_fn, base_seed + i,
-                          self.worker_init_fn, i))
+                          self.worker_init_fn, i, self.rings[i]))
                 for i in range(self.num_workers)]
 
             if self.pin_memory:
@@ -281,7 +419,7 @@ class _DataLoaderIter(object):
                 self.pin_memory_thread = threading.Thread(
                     target=_pin_memory_loop,
                     args=(self.worker_result_queue, self.data_queue, self.done_event, self.pin_memory,
-                          torch.cuda.current_device()))
+                          torch.cuda.current_device(), self.rings))
                 self.pin_memory_thread.daemon = True
                 self.pin_memory_thread.start()
             else:
@@ -332,6 +470,9 @@ class _DataLoaderIter(object):
             assert (not self.shutdown and self.batches_outstanding > 0)
             idx, batch = self._get_batch()
             self.batches_outstanding -= 1
+            if isinstance(batch, _SharedMemoryRingBatch):
+                # copy the batch out right away, so the worker can reuse the slot
+                batch = self.rings[batch.worker_id].unpack(batch)
             if idx != self.rcvd_idx:
                 # store out-of-order samples
                 self.reorder_dict[idx] = batch
@@ -377,6 +518,10 @@ class _DataLoaderIter(object):
                 _remove_worker_pids(id(self))
                 self.worker_pids_set = False
             self.done_event.set()
+            # wakes up workers waiting for a free slot
+            for ring in self.rings:
+                if ring is not None:
+                    ring.free_slots.put(None)
             if self.pin_memory:
                 # Sending `None` to `pin_memory_thread` must be before
                 # stopping worker processes because the workers may leave
@@ -429,6 +574,11 @@ class DataLoader(object):
         worker_init_fn (callable, optional): If not None, this will be called on each
             worker subprocess with the worker id (an int in ``[0, num_workers - 1]``) as
             input, after seeding and before data loading. (default: None)
+        reuse_shared_memory (bool, optional): If ``True``, workers send batches of
+            CPU tensors through a few shared memory buffers that are reused across
+            batches, instead of allocating shared memory for every batch. The main
+            process copies the batches out of these buffers. This is faster for
+            batches of many small tensors. (default: False)
 
     .. note:: By default, each worker will have its PyTorch seed set to
               ``base_seed + worker_id``, where ``base_seed`` is a long generated
@@ -448,7 +598,7 @@ class DataLoader(object):
 
     def __init__(self, dataset, batch_size=1, shuffle=False, sampler=None, batch_sampler=None,
                  num_workers=0, collate_fn=default_collate, pin_memory=False, drop_last=False,
-                 timeout=0, worker_init_fn=None):
+                 timeout=0, worker_init_fn=None, reuse_shared_memory=False):
         self.dataset = dataset
         self.batch_size = batch_size
         self.num_workers = num_workers
@@ -457,6 +607,7 @@ class DataLoader(object):
         self.drop_last = drop_last
         self.timeout = timeout
         self.worker_init_fn = worker_init_fn
+        self.reuse_shared_memory = reuse_shared_memory
 
         if timeout < 0:
             raise ValueError('timeout option should be non-negative')
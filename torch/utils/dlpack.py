@@ -1,27 +1,49 @@
 import torch
 
-from torch._C import _from_dlpack as from_dlpack
-from torch._C import _to_dlpack as to_dlpack
 
-torch._C._add_docstr(from_dlpack, r"""from_dlpack(dlpack) -> Tensor
+def _stream_handle(stream):
+    if stream is None or isinstance(stream, int):
+        return stream
+    # a torch.cuda.Stream
+    return stream.cuda_stream
 
-Decodes a DLPack to a tensor.
 
-Args:
-    dlpack: a PyCapsule object with the dltensor
+def from_dlpack(dlpack, stream=None):
+    r"""from_dlpack(dlpack, stream=None) -> Tensor
 
-The tensor will share the memory with the object represented
-in the dlpack.
-Note that each dlpack can only be consumed once.
-""")
+    Decodes a DLPack to a tensor.
 
-torch._C._add_docstr(to_dlpack, r"""to_dlpack(tensor) -> PyCapsule
+    Args:
+        dlpack: a PyCapsule object with the dltensor
+        stream (torch.cuda.Stream or int, optional): for CUDA tensors, the
+            stream the producer of the dlpack queued its work on, as a
+            :class:`torch.cuda.Stream` or the address of a ``cudaStream_t``
+            (``1`` is the legacy default stream). The current stream waits
+            for it, so that the tensor can be used right away. By default,
+            synchronizing is left to the caller.
 
-Returns a DLPack representing the tensor.
+    The tensor will share the memory with the object represented
+    in the dlpack.
+    Note that each dlpack can only be consumed once.
+    """
+    return torch._C._from_dlpack(dlpack, _stream_handle(stream))
 
-Args:
-    tensor: a tensor to be exported
 
-The dlpack shares the tensors memory.
-Note that each dlpack can only be consumed once.
-""")
+def to_dlpack(tensor, stream=None):
+    r"""to_dlpack(tensor, stream=None) -> PyCapsule
+
+    Returns a DLPack representing the tensor.
+
+    Args:
+        tensor: a tensor to be exported
+        stream (torch.cuda.Stream or int, optional): for CUDA tensors, the
+            stream the consumer will use the tensor on, as a
+            :class:`torch.cuda.Stream` or the address of a ``cudaStream_t``
+            (``1`` is the legacy default stream). It waits for the work
+            queued on the current stream so far. By default, synchronizing
+            is left to the caller.
+
+    The dlpack shares the tensors memory.
+    Note that each dlpack can only be consumed once.
+    """
+    return torch._C._to_dlpack(tensor, _stream_handle(stream))